@@ -20,12 +20,14 @@ class HostUtilsConan(ConanFile):
         "fPIC": [True, False],
         "fvisibility": ["default", "protected", "hidden"],
         "with_tests": [True, False],
+        "vlog_max_level": ["-1", "0", "1", "2"],
     }
     default_options = {
         "shared": False,
         "fPIC": True,
         "fvisibility": "default",
-        "with_tests": False
+        "with_tests": False,
+        "vlog_max_level": "2",
     }
 
     python_requires = "conan-common/[>=1.1.0 <2.0.0]"
@@ -84,7 +86,8 @@ class HostUtilsConan(ConanFile):
                 }
 
         components = {
-            "logging": component_template("logging"),
+            "logging": dict(component_template("logging"),
+                            defines=[f"ET_VLOG_MAX_LEVEL={self.options.vlog_max_level}"]),
             "debug": component_template("debug"),
             "debugging": {
                 "cmake_target": f"hostUtils::debugging",
@@ -155,6 +158,7 @@ class HostUtilsConan(ConanFile):
 
         tc = CMakeToolchain(self)
         tc.variables["BUILD_TESTS"] = self.options.with_tests
+        tc.variables["ET_VLOG_MAX_LEVEL"] = self.options.vlog_max_level
         tc.variables["CMAKE_MODULE_PATH"] = os.path.join(self.dependencies.build["cmake-modules"].package_folder, "cmake")
         tc.variables["CMAKE_ASM_VISIBILITY_PRESET"] = self.options.fvisibility
         tc.variables["CMAKE_C_VISIBILITY_PRESET"] = self.options.fvisibility
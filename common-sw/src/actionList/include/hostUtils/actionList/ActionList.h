@@ -10,13 +10,31 @@
 #include <atomic>
 #include <condition_variable>
 #include <cstddef>
+#include <cstdint>
 #include <list>
+#include <memory>
 
 namespace actionList {
 
+// identifies something actions wait for (ie. bytes of a memory pool, the completion of an event); its meaning is up to
+// the actions and whoever notifies the Runner
+using ResourceId = uint64_t;
+// actions waiting for it are updated again on any notification
+constexpr ResourceId kAnyResource = 0;
+
+// what an action which is not finished needs before updating it again makes sense
+struct WaitFor {
+  ResourceId resource_ = kAnyResource;
+  size_t amount_ = 0; // units of the resource needed, 0 if any notification of the resource will do
+};
+
 struct ACTION_LIST_API IAction {
   virtual bool update() = 0;    // returns true if the action is finished
   virtual void onFinish(){};    // called when the action is finished, defaults to do nothing
+  // what the action needs to progress, asked before its first update and every time it returns false
+  virtual WaitFor getWaitFor() const {
+    return {};
+  }
   virtual ~IAction() = default; // virtual destructor
 };
 
@@ -25,6 +43,7 @@ public:
   void addAction(std::unique_ptr<IAction> action); // add an action to the list
   void update(); // update first action, remove it if finished and call the next one, until one is not finished
   size_t getNumActions() const; // get number of actions in the list
+  std::list<std::unique_ptr<IAction>> takeActions(); // moves all the actions out of the list, in order
 
 private:
   // using list to allow pushing new actions without invalidating iterators
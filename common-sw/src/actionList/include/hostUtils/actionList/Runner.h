@@ -8,29 +8,56 @@
 #include <hostUtils/actionList/ActionListExport.h>
 
 #include <condition_variable>
+#include <deque>
+#include <limits>
 #include <thread>
+#include <unordered_map>
 
 namespace actionList {
 
-/// \brief Runner instance manages a  thread that executes actions from an ActionList; it will execute an update cycle
-/// and then it will block.
+/// \brief Runner instance manages a thread that executes actions; it updates the actions which can make progress and
+/// then it will block.
+///
+/// An action which is not finished waits in the list of the resource it is waiting for (see \ref IAction::getWaitFor)
+/// until that resource is notified. Each list is kept in the order the actions were added, and an action never
+/// overtakes an older one waiting for the same resource. Actions are updated without holding the lock, so adding
+/// actions and notifying resources does not wait for an update cycle.
 class ACTION_LIST_API Runner {
 public:
   explicit Runner(ActionList actionList = {});
   ~Runner();
 
-  /// instructs the thread to perform an update cycle. This will wake up the thread if it was blocked.
+  /// wakes up all the waiting actions, whatever they are waiting for.
   void update();
 
-  /// adds an action to the action list and performs an update cycle.
+  /// wakes up, in order, the actions waiting for the resource while the amount they need fits in the available amount,
+  /// and the actions waiting for kAnyResource.
+  void notify(ResourceId resource, size_t available = std::numeric_limits<size_t>::max());
+
+  /// adds an action; it is updated once the actions added before which wait for the same resource have progressed.
   void addAction(std::unique_ptr<IAction> action);
 
 private:
-  ActionList actionList_;
+  struct Entry {
+    std::unique_ptr<IAction> action_;
+    uint64_t order_;
+    WaitFor waitFor_;
+  };
+
+  void run();
+  void process(Entry entry, uint64_t notifications);
+  bool hasOlderWaiters(const Entry& entry) const;
+  void wait(Entry entry);
+  void wake(std::deque<Entry>& waiting);
+
+  std::deque<Entry> ready_;
+  std::unordered_map<ResourceId, std::deque<Entry>> waiting_; // per resource, oldest first
+  uint64_t nextOrder_ = 0;
+  uint64_t notifications_ = 0;
   std::thread runner_;
   std::mutex mutex_;
   std::condition_variable cv_;
   bool running_ = true;
 };
 
-} // namespace actionList
\ No newline at end of file
+} // namespace actionList
@@ -5,6 +5,7 @@
  *-------------------------------------------------------------------------*/
 #include "hostUtils/actionList/ActionList.h"
 #include <chrono>
+#include <utility>
 
 using namespace actionList;
 
@@ -12,6 +13,10 @@ void ActionList::addAction(std::unique_ptr<IAction> action) {
   actions_.push_back(std::move(action));
 }
 
+std::list<std::unique_ptr<IAction>> ActionList::takeActions() {
+  return std::exchange(actions_, {});
+}
+
 size_t ActionList::getNumActions() const {
   return actions_.size();
 }
@@ -5,41 +5,128 @@
 
 #include "hostUtils/actionList/Runner.h"
 #include "Log.h"
+#include <algorithm>
+#include <utility>
 
 using namespace actionList;
 
-Runner::Runner(ActionList actionList)
-  : actionList_(std::move(actionList)) {
-  runner_ = std::thread([this] {
-    while (running_) {
-      AL_VLOG(MID) << "Calling update on actionList.";
-      std::unique_lock lock(mutex_);
-      actionList_.update();
-      if (running_) {
-        AL_VLOG(MID) << "Update finished. Locking the mutex.";
-        cv_.wait(lock);
-      }
-    }
-  });
+Runner::Runner(ActionList actionList) {
+  for (auto& action : actionList.takeActions()) {
+    ready_.push_back({std::move(action), nextOrder_++, {}});
+  }
+  runner_ = std::thread([this] { run(); });
 }
 
 Runner::~Runner() {
   AL_LOG(INFO) << "Destroying Runner.";
-  running_ = false;
-  update();
+  {
+    std::lock_guard lock(mutex_);
+    running_ = false;
+  }
+  cv_.notify_one();
   runner_.join();
-  AL_LOG_IF(WARNING, actionList_.getNumActions() > 0)
-    << "Runner destroyed with " << actionList_.getNumActions() << " actions still in queue.";
+  auto pending = ready_.size();
+  for (const auto& [resource, waiting] : waiting_) {
+    pending += waiting.size();
+  }
+  AL_LOG_IF(WARNING, pending > 0) << "Runner destroyed with " << pending << " actions still in queue.";
+}
+
+void Runner::run() {
+  std::unique_lock lock(mutex_);
+  while (running_) {
+    if (ready_.empty()) {
+      AL_VLOG(MID) << "No action can progress, waiting for a notification.";
+      cv_.wait(lock, [this] { return !running_ || !ready_.empty(); });
+      continue;
+    }
+    auto batch = std::exchange(ready_, {});
+    auto notifications = notifications_;
+    lock.unlock();
+    AL_VLOG(MID) << "Updating " << batch.size() << " actions.";
+    for (auto& entry : batch) {
+      process(std::move(entry), notifications);
+    }
+    lock.lock();
+  }
+}
+
+void Runner::process(Entry entry, uint64_t notifications) {
+  entry.waitFor_ = entry.action_->getWaitFor();
+  {
+    std::lock_guard lock(mutex_);
+    if (hasOlderWaiters(entry)) {
+      wait(std::move(entry));
+      return;
+    }
+  }
+  if (entry.action_->update()) {
+    entry.action_->onFinish();
+    return;
+  }
+  entry.waitFor_ = entry.action_->getWaitFor();
+  std::lock_guard lock(mutex_);
+  if (notifications != notifications_) {
+    // there were notifications while it was updated, what it waits for could be available already
+    ready_.push_back(std::move(entry));
+  } else {
+    wait(std::move(entry));
+  }
+}
+
+bool Runner::hasOlderWaiters(const Entry& entry) const {
+  auto it = waiting_.find(entry.waitFor_.resource_);
+  return it != end(waiting_) && !it->second.empty() && it->second.front().order_ < entry.order_;
+}
+
+void Runner::wait(Entry entry) {
+  auto& waiting = waiting_[entry.waitFor_.resource_];
+  // usually at the end, or at the front when an action which was woken up has to wait again
+  auto pos = std::find_if(waiting.rbegin(), waiting.rend(), [&entry](const Entry& e) {
+               return e.order_ < entry.order_;
+             }).base();
+  waiting.insert(pos, std::move(entry));
+}
+
+void Runner::wake(std::deque<Entry>& waiting) {
+  std::move(begin(waiting), end(waiting), std::back_inserter(ready_));
+  waiting.clear();
 }
 
 void Runner::update() {
   AL_VLOG(MID) << "Updating Runner.";
+  std::unique_lock lock(mutex_);
+  ++notifications_;
+  for (auto& [resource, waiting] : waiting_) {
+    wake(waiting);
+  }
+  std::sort(begin(ready_), end(ready_), [](const Entry& a, const Entry& b) { return a.order_ < b.order_; });
+  lock.unlock();
+  cv_.notify_one();
+}
+
+void Runner::notify(ResourceId resource, size_t available) {
+  AL_VLOG(MID) << "Notifying resource " << resource << " available: " << available;
+  std::unique_lock lock(mutex_);
+  ++notifications_;
+  if (auto it = waiting_.find(resource); resource != kAnyResource && it != end(waiting_)) {
+    auto& waiting = it->second;
+    while (!waiting.empty() && waiting.front().waitFor_.amount_ <= available) {
+      available -= waiting.front().waitFor_.amount_;
+      ready_.push_back(std::move(waiting.front()));
+      waiting.pop_front();
+    }
+  }
+  if (auto it = waiting_.find(kAnyResource); it != end(waiting_)) {
+    wake(it->second);
+  }
+  lock.unlock();
   cv_.notify_one();
 }
 
 void Runner::addAction(std::unique_ptr<IAction> action) {
   std::unique_lock lock(mutex_);
-  actionList_.addAction(std::move(action));
+  ready_.push_back({std::move(action), nextOrder_++, {}});
   lock.unlock();
-  update();
-}
\ No newline at end of file
+  cv_.notify_one();
+}
@@ -11,6 +11,7 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include <thread>
+#include <vector>
 
 #include "gtest/gtest.h"
 
@@ -170,6 +171,128 @@ TEST(RunnerTest, AddMultipleAction) {
   runner.reset();
 }
 
+namespace {
+// polls until the condition holds or a second has passed
+template <typename Func> bool eventually(Func&& condition) {
+  for (int i = 0; i < 1000 && !condition(); ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return condition();
+}
+
+constexpr ResourceId kPool = 1;
+
+// the actions are destroyed once finished, so they count their updates here
+struct Updates {
+  std::atomic<int> total_ = 0;
+  std::atomic<int> failed_ = 0;
+};
+
+// takes `need` units of a pool in one go, and waits for them while they are not available
+class PoolAction : public IAction {
+public:
+  PoolAction(std::atomic<size_t>& pool, size_t need, std::atomic<int>& finished, int id, std::vector<int>& order,
+             Updates& updates)
+    : pool_(pool)
+    , need_(need)
+    , finished_(finished)
+    , id_(id)
+    , order_(order)
+    , updates_(updates) {
+  }
+  bool update() override {
+    ++updates_.total_;
+    if (pool_ < need_) {
+      ++updates_.failed_;
+      return false;
+    }
+    pool_ -= need_;
+    order_.emplace_back(id_);
+    ++finished_;
+    return true;
+  }
+  WaitFor getWaitFor() const override {
+    return {kPool, need_};
+  }
+
+private:
+  std::atomic<size_t>& pool_;
+  size_t need_;
+  std::atomic<int>& finished_;
+  int id_;
+  std::vector<int>& order_;
+  Updates& updates_;
+};
+} // namespace
+
+TEST(RunnerTest, ResourceWaitersInOrder) {
+  std::atomic<size_t> pool = 0;
+  std::atomic<int> finished = 0;
+  std::vector<int> order;
+  Updates bigUpdates;
+  Updates smallUpdates;
+  auto runner = std::make_unique<Runner>();
+  runner->addAction(std::make_unique<PoolAction>(pool, 4, finished, 0, order, bigUpdates));
+  ASSERT_TRUE(eventually([&] { return bigUpdates.total_ == 1; }));
+  runner->addAction(std::make_unique<PoolAction>(pool, 1, finished, 1, order, smallUpdates));
+
+  // not enough for the big one, which is first; the small one must not overtake it
+  pool = 1;
+  runner->notify(kPool, 1);
+  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  EXPECT_EQ(finished, 0);
+
+  pool = 4;
+  runner->notify(kPool, 4);
+  ASSERT_TRUE(eventually([&] { return finished == 1; }));
+
+  pool = 1;
+  runner->notify(kPool, 1);
+  ASSERT_TRUE(eventually([&] { return finished == 2; }));
+  runner.reset();
+
+  EXPECT_EQ(order, (std::vector<int>{0, 1}));
+  // the small one was only updated once there was enough for it
+  EXPECT_EQ(smallUpdates.failed_, 0);
+}
+
+TEST(RunnerTest, OnlyNotifiedResourceWakesUp) {
+  constexpr ResourceId kEvent = 42;
+  struct EventAction : IAction {
+    EventAction(std::atomic<bool>& done, std::atomic<int>& updates)
+      : done_(done)
+      , updates_(updates) {
+    }
+    bool update() override {
+      ++updates_;
+      return done_;
+    }
+    WaitFor getWaitFor() const override {
+      return {kEvent, 0};
+    }
+    std::atomic<bool>& done_;
+    std::atomic<int>& updates_;
+  };
+  std::atomic<bool> done = false;
+  std::atomic<int> actionUpdates = 0;
+  auto runner = std::make_unique<Runner>();
+  runner->addAction(std::make_unique<EventAction>(done, actionUpdates));
+  ASSERT_TRUE(eventually([&] { return actionUpdates >= 1; }));
+  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  auto updates = actionUpdates.load();
+
+  // other resources don't update it
+  runner->notify(kPool);
+  runner->notify(kPool + 1);
+  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  EXPECT_EQ(actionUpdates, updates);
+
+  done = true;
+  runner->notify(kEvent);
+  ASSERT_TRUE(eventually([&] { return actionUpdates == updates + 1; }));
+  runner.reset();
+}
+
 int main(int argc, char** argv) {
   logging::LoggerDefault logger_;
   testing::InitGoogleTest(&argc, argv);
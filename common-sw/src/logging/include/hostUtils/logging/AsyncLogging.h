@@ -0,0 +1,76 @@
+/*-------------------------------------------------------------------------
+* Copyright (c) 2025 Ainekko, Co.
+* SPDX-License-Identifier: Apache-2.0
+*-------------------------------------------------------------------------*/
+
+#pragma once
+#include <hostUtils/logging/LoggingExport.h>
+
+#include <g3log/loglevels.hpp>
+
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace logging {
+
+/// While an instance exists, the verbose logs (ET_VLOG) are not handed to g3log on the calling thread: each thread
+/// writes its formatted messages into its own lock-free ring buffer, and a background writer hands them to g3log in
+/// batches. The error, warning and info logs are not affected. Messages keep their order per thread, unless a ring is
+/// full: then the message is logged synchronously, ahead of the ones still in the ring. The log timestamps are those of
+/// the writer.
+///
+/// It must be destroyed before the g3 log worker; the pending messages are written on destruction.
+class LOGGING_API AsyncLogging {
+public:
+  explicit AsyncLogging(size_t recordsPerThread = 1024);
+  ~AsyncLogging();
+  AsyncLogging(const AsyncLogging&) = delete;
+  AsyncLogging& operator=(const AsyncLogging&) = delete;
+
+  /// returns true if there is an instance, so verbose logs go through it
+  static bool isActive();
+
+  struct Ring;
+
+private:
+  friend class AsyncCapture;
+  void writerFunc();
+  size_t drain();
+
+  const size_t recordsPerThread_;
+  std::vector<std::shared_ptr<Ring>> rings_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::thread writer_;
+  bool running_ = true;
+};
+
+/// Stream for one verbose message, see ET_VLOG. On destruction it goes to the calling thread ring buffer if
+/// AsyncLogging is active, or straight to g3log otherwise.
+class LOGGING_API AsyncCapture {
+public:
+  AsyncCapture(const char* file, int line, const char* function, const LEVELS& level)
+    : file_(file)
+    , line_(line)
+    , function_(function)
+    , level_(level) {
+  }
+  ~AsyncCapture();
+  std::ostringstream& stream() {
+    return stream_;
+  }
+
+private:
+  const char* file_;
+  int line_;
+  const char* function_;
+  const LEVELS& level_;
+  std::ostringstream stream_;
+};
+
+} // end namespace logging
@@ -6,12 +6,14 @@
 #pragma once
 #include <hostUtils/logging/LoggingExport.h>
 
+#include "AsyncLogging.h"
 #include "DefaultSinks.h"
 
 #include <g3log/g3log.hpp>
 #include <g3log/logworker.hpp>
 #include <g3log/loglevels.hpp>
 #include <cstdlib>
+#include <string>
 
 namespace logging {
 
@@ -31,13 +33,22 @@ public:
   void init() {
     initializeLogging(logWorker_.get());    
   }
+
+  /// hands the verbose logs to g3log from a background thread, see AsyncLogging
+  void enableAsync() {
+    if (!asyncLogging_) {
+      asyncLogging_ = std::make_unique<AsyncLogging>();
+    }
+  }
 protected:
   std::unique_ptr<g3::LogWorker> logWorker_;
+  std::unique_ptr<AsyncLogging> asyncLogging_; // destroyed before the log worker
 };
 
 class LOGGING_API LoggerDefault : public Logger {
 public:
-  explicit LoggerDefault(bool initialize = true) {
+  /// the verbose logs are asynchronous if async is set or the ET_LOG_ASYNC environment variable is not 0
+  explicit LoggerDefault(bool initialize = true, bool async = false) {
     logWorker_->addSink(std::make_unique<ColoredOutput>(),
                                       &ColoredOutput::ReceiveLogMessage);
 
@@ -63,6 +74,10 @@ public:
     if (initialize) {
       init();
     }
+    auto etLogAsync = getenv("ET_LOG_ASYNC");
+    if (async || (etLogAsync != nullptr && std::string(etLogAsync) != "0")) {
+      enableAsync();
+    }
   }
 };
 
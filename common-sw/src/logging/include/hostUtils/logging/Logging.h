@@ -5,14 +5,31 @@
 
  #pragma once
 
+#include "AsyncLogging.h"
 #include "DefaultSinks.h"
 #include "Logger.h"
 #include <thread>
 
+// verbose logs above this level are compiled out, so they cost nothing when disabled: -1 for none, 0 for LOW, 1 for
+// MID and 2 for HIGH (all of them, the default). Set by the ET_VLOG_MAX_LEVEL CMake cache variable
+#ifndef ET_VLOG_MAX_LEVEL
+#define ET_VLOG_MAX_LEVEL 2
+#endif
+
+namespace logging::vlog_level {
+constexpr int LOW = 0;
+constexpr int MID = 1;
+constexpr int HIGH = 2;
+} // namespace logging::vlog_level
+
 #define ET_MSG(channel) "ET [" << #channel << "][TH:" << std::this_thread::get_id() << "]: "
 
 #define ET_LOG(channel, severity) LOG(severity) << ET_MSG(channel)
 #define ET_DLOG(channel, severity) LOG(DEBUG) << ET_MSG(channel)
 #define CAT_NX(A, B) A##B
-#define ET_VLOG(channel, level) LOG(CAT_NX(logging::VLOG_, level)) << ET_MSG(channel)
+#define ET_VLOG(channel, level)                                                                                       \
+  if (logging::vlog_level::level > ET_VLOG_MAX_LEVEL || !g3::logLevel(CAT_NX(logging::VLOG_, level))) {             \
+  } else                                                                                                               \
+    logging::AsyncCapture(__FILE__, __LINE__, __PRETTY_FUNCTION__, CAT_NX(logging::VLOG_, level)).stream()            \
+      << ET_MSG(channel)
 #define ET_LOG_IF(channel, severity, condition) LOG_IF(severity, condition) << ET_MSG(channel)
\ No newline at end of file
@@ -0,0 +1,173 @@
+/*-------------------------------------------------------------------------
+* Copyright (c) 2025 Ainekko, Co.
+* SPDX-License-Identifier: Apache-2.0
+*-------------------------------------------------------------------------*/
+#include "hostUtils/logging/AsyncLogging.h"
+
+#include <g3log/g3log.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string>
+
+using namespace logging;
+
+namespace {
+// records handed to g3log from each ring per pass, so a busy thread does not delay the others
+constexpr size_t kBatchSize = 256;
+// how often an idle writer looks for new records; the logging threads never wake it up
+constexpr auto kWriterPeriod = std::chrono::milliseconds(5);
+
+struct Record {
+  const char* file_ = nullptr;
+  int line_ = 0;
+  const char* function_ = nullptr;
+  const LEVELS* level_ = nullptr;
+  std::string message_;
+};
+
+void saveMessage(const char* message, const char* file, int line, const char* function, const LEVELS& level) {
+  g3::internal::saveMessage(message, file, line, function, level, "", 0, "");
+}
+
+std::atomic<AsyncLogging*> g_instance{nullptr};
+// incremented for every new instance, so threads register again to a new one
+std::atomic<uint64_t> g_generation{0};
+// threads using the instance right now, it waits for them before the last drain
+std::atomic<int> g_users{0};
+} // namespace
+
+// single producer (the logging thread), single consumer (the writer) ring
+struct AsyncLogging::Ring {
+  explicit Ring(size_t capacity)
+    : records_(capacity) {
+  }
+
+  bool push(Record&& record) {
+    auto tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_.load(std::memory_order_acquire) >= records_.size()) {
+      return false;
+    }
+    records_[tail % records_.size()] = std::move(record);
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  size_t write(size_t maxRecords) {
+    auto head = head_.load(std::memory_order_relaxed);
+    auto count = std::min(tail_.load(std::memory_order_acquire) - head, maxRecords);
+    for (auto i = 0UL; i < count; ++i) {
+      auto& record = records_[(head + i) % records_.size()];
+      saveMessage(record.message_.c_str(), record.file_, record.line_, record.function_, *record.level_);
+      record.message_.clear();
+    }
+    head_.store(head + count, std::memory_order_release);
+    return count;
+  }
+
+  bool empty() const {
+    return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+  }
+
+  std::vector<Record> records_;
+  alignas(64) std::atomic<size_t> head_{0};
+  alignas(64) std::atomic<size_t> tail_{0};
+  std::atomic<bool> orphaned_{false}; // its thread has exited, it is removed once written
+};
+
+namespace {
+struct ThreadRing {
+  ~ThreadRing() {
+    if (ring_) {
+      ring_->orphaned_ = true;
+    }
+  }
+  std::shared_ptr<AsyncLogging::Ring> ring_;
+  uint64_t generation_ = 0;
+};
+thread_local ThreadRing t_ring;
+} // namespace
+
+AsyncLogging::AsyncLogging(size_t recordsPerThread)
+  : recordsPerThread_(std::max(recordsPerThread, size_t{1})) {
+  writer_ = std::thread(&AsyncLogging::writerFunc, this);
+  g_generation.fetch_add(1, std::memory_order_acq_rel);
+  AsyncLogging* expected = nullptr;
+  if (!g_instance.compare_exchange_strong(expected, this, std::memory_order_acq_rel)) {
+    LOG(WARNING) << "There is another AsyncLogging instance already, this one will not be used.";
+  }
+}
+
+AsyncLogging::~AsyncLogging() {
+  AsyncLogging* expected = this;
+  g_instance.compare_exchange_strong(expected, nullptr, std::memory_order_acq_rel);
+  while (g_users.load(std::memory_order_acquire) > 0) {
+    std::this_thread::yield();
+  }
+  {
+    std::lock_guard lock(mutex_);
+    running_ = false;
+  }
+  cv_.notify_one();
+  writer_.join();
+  while (drain() > 0) {
+  }
+}
+
+bool AsyncLogging::isActive() {
+  return g_instance.load(std::memory_order_acquire) != nullptr;
+}
+
+size_t AsyncLogging::drain() {
+  std::vector<std::shared_ptr<Ring>> rings;
+  {
+    std::lock_guard lock(mutex_);
+    rings = rings_;
+  }
+  auto written = 0UL;
+  auto orphans = false;
+  for (auto& ring : rings) {
+    written += ring->write(kBatchSize);
+    orphans = orphans || (ring->orphaned_ && ring->empty());
+  }
+  if (orphans) {
+    std::lock_guard lock(mutex_);
+    rings_.erase(std::remove_if(begin(rings_), end(rings_), [](const auto& r) { return r->orphaned_ && r->empty(); }),
+                 end(rings_));
+  }
+  return written;
+}
+
+void AsyncLogging::writerFunc() {
+  std::unique_lock lock(mutex_);
+  while (running_) {
+    lock.unlock();
+    auto written = drain();
+    lock.lock();
+    if (written == 0) {
+      cv_.wait_for(lock, kWriterPeriod, [this] { return !running_; });
+    }
+  }
+}
+
+AsyncCapture::~AsyncCapture() {
+  g_users.fetch_add(1, std::memory_order_acq_rel);
+  auto instance = g_instance.load(std::memory_order_acquire);
+  if (instance != nullptr) {
+    auto generation = g_generation.load(std::memory_order_acquire);
+    if (!t_ring.ring_ || t_ring.generation_ != generation) {
+      t_ring.ring_ = std::make_shared<AsyncLogging::Ring>(instance->recordsPerThread_);
+      t_ring.generation_ = generation;
+      std::lock_guard lock(instance->mutex_);
+      instance->rings_.emplace_back(t_ring.ring_);
+    }
+    if (t_ring.ring_->push({file_, line_, function_, &level_, stream_.str()})) {
+      g_users.fetch_sub(1, std::memory_order_acq_rel);
+      return;
+    }
+  }
+  g_users.fetch_sub(1, std::memory_order_acq_rel);
+  // not active or the ring is full, log it from this thread
+  saveMessage(stream_.str().c_str(), file_, line_, function_, level_);
+}
@@ -15,6 +15,7 @@
 #include <mutex>
 #include <queue>
 #include <thread>
+#include <vector>
 
 namespace threadPool {
 
@@ -24,8 +25,12 @@ public:
   // if resizable, the threadpool will automatically grow if all threads are busy when pushing a new task
   // if waitPendingTasks when destroying the threadpool it will block the caller until all task have been executed. If
   // not, it will clear the pending tasks and wait only for the running tasks.
-  explicit ThreadPool(size_t numThreads, bool resizable = false, bool waitPendingTasks = false);
+  // if onThreadStart is set, every thread of the pool runs it before executing any task (ie. to set its affinity)
+  explicit ThreadPool(size_t numThreads, bool resizable = false, bool waitPendingTasks = false,
+                      std::function<void()> onThreadStart = nullptr);
   void pushTask(Task task);
+  // pushes all the tasks taking the lock once
+  void pushBatch(std::vector<Task> tasks);
   ~ThreadPool();
 
   // this will block the caller until the threadpool has no more tasks
@@ -39,6 +44,7 @@ private:
   mutable std::mutex mutex_;
   std::condition_variable condVar_;
   std::queue<Task> tasks_;
+  std::function<void()> onThreadStart_;
   bool running_;
   bool resizable_;
   bool waitPendingTasks_;
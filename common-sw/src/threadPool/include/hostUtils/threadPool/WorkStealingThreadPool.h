@@ -0,0 +1,64 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) 2025 Ainekko, Co.
+ * SPDX-License-Identifier: Apache-2.0
+ *-------------------------------------------------------------------------*/
+
+#pragma once
+#include <hostUtils/threadPool/ThreadPoolExport.h>
+#include "ThreadPool.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace threadPool {
+
+// Thread pool for many short tasks pushed from several threads. Every worker owns a lock-free (Chase-Lev) deque: tasks
+// pushed from a worker go to its own deque, tasks pushed from any other thread go to a global injection queue, which
+// idle workers drain in batches into their deques. A worker without tasks steals from the other deques, spins a while
+// and only then sleeps. Tasks have no ordering guarantees.
+class THREAD_POOL_API WorkStealingThreadPool {
+public:
+  using Task = ThreadPool::Task;
+  // if waitPendingTasks when destroying the threadpool it will block the caller until all task have been executed. If
+  // not, it will clear the pending tasks and wait only for the running tasks.
+  // if onThreadStart is set, every thread of the pool runs it before executing any task (ie. to set its affinity)
+  explicit WorkStealingThreadPool(size_t numThreads, bool waitPendingTasks = false,
+                                  std::function<void()> onThreadStart = nullptr);
+  void pushTask(Task task);
+  // pushes all the tasks taking the injection queue lock once and waking up as many workers as needed
+  void pushBatch(std::vector<Task> tasks);
+  ~WorkStealingThreadPool();
+
+  // this will block the caller until the threadpool has no more tasks
+  void blockUntilDrained();
+
+  WorkStealingThreadPool(const WorkStealingThreadPool&) = delete;
+  WorkStealingThreadPool& operator=(const WorkStealingThreadPool&) = delete;
+
+private:
+  struct Worker;
+
+  void workerFunc(size_t index);
+  Task* findTask(size_t index);
+  Task* popInjected(Worker& worker);
+  void notify(size_t numTasks);
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::mutex injectionMutex_;
+  std::deque<Task*> injected_;
+  std::mutex sleepMutex_;
+  std::condition_variable sleepCondVar_;
+  std::function<void()> onThreadStart_;
+  std::atomic<size_t> pendingTasks_{0};
+  std::atomic<size_t> sleepingWorkers_{0};
+  std::atomic<bool> running_{true};
+  bool waitPendingTasks_;
+};
+
+} // namespace threadPool
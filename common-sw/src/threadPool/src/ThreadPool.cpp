@@ -17,8 +17,9 @@
 #define TP_LOG_IF(severity, condition) ET_LOG_IF(THREADPOOL, severity, condition)
 
 using namespace threadPool;
-ThreadPool::ThreadPool(size_t numThreads, bool resizable, bool waitPendingTasks)
-  : running_(true)
+ThreadPool::ThreadPool(size_t numThreads, bool resizable, bool waitPendingTasks, std::function<void()> onThreadStart)
+  : onThreadStart_(std::move(onThreadStart))
+  , running_(true)
   , resizable_(resizable)
   , waitPendingTasks_(waitPendingTasks) {
   addThreads(numThreads);
@@ -42,12 +43,34 @@ void ThreadPool::pushTask(Task task) {
   }
 }
 
+void ThreadPool::pushBatch(std::vector<Task> tasks) {
+  if (threads_.empty()) {
+    TP_VLOG(MID) << "Running thread pool with no threads (debugging), so execute the tasks directly";
+    for (auto& task : tasks) {
+      task();
+    }
+  } else if (!tasks.empty()) {
+    TP_VLOG(MID) << "Pushing " << tasks.size() << " tasks into threadpool " << std::hex << this;
+    std::unique_lock lock(mutex_);
+    for (auto& task : tasks) {
+      tasks_.emplace(std::move(task));
+    }
+    lock.unlock();
+    if (tasks.size() == 1) {
+      condVar_.notify_one();
+    } else {
+      condVar_.notify_all();
+    }
+  }
+}
+
 void ThreadPool::blockUntilDrained() {
   std::unique_lock lock(mutex_);
   while (!tasks_.empty()) {
     TP_VLOG(MID) << "Waiting until tasks are drained: " << tasks_.size();
     lock.unlock();
     std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    lock.lock();
   }
   TP_VLOG(MID) << "All tasks are drained.";
 }
@@ -79,6 +102,9 @@ void ThreadPool::addThreads(size_t numThreads) {
 }
 
 void ThreadPool::workerFunc() {
+  if (onThreadStart_) {
+    onThreadStart_();
+  }
   while (running_) {
     std::unique_lock lock(mutex_);
     if (tasks_.empty()) {
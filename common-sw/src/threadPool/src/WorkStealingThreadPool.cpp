@@ -0,0 +1,300 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) 2025 Ainekko, Co.
+ * SPDX-License-Identifier: Apache-2.0
+ *-------------------------------------------------------------------------*/
+#include "hostUtils/threadPool/WorkStealingThreadPool.h"
+#include <chrono>
+#include <cstdint>
+#include <g3log/loglevels.hpp>
+#include <hostUtils/logging/Logger.h>
+#include <hostUtils/logging/Logging.h>
+#include <thread>
+
+#define TP_LOG(severity) ET_LOG(THREADPOOL, severity)
+#define TP_VLOG(severity) ET_VLOG(THREADPOOL, severity)
+
+using namespace threadPool;
+
+namespace {
+// times an idle worker looks for tasks again before going to sleep
+constexpr auto kSpinIterations = 64U;
+// tasks a worker moves from the injection queue into its own deque at once, so the others can steal them
+constexpr auto kInjectionBatch = 16U;
+constexpr auto kInitialDequeCapacity = 256;
+
+// Chase-Lev deque, as in "Correct and Efficient Work-Stealing for Weak Memory Models" (Le et al., PPoPP'13). Only the
+// owner pushes and pops at the bottom, any thread steals from the top
+class TaskDeque {
+public:
+  TaskDeque()
+    : array_(new Array(kInitialDequeCapacity)) {
+    arrays_.emplace_back(array_.load(std::memory_order_relaxed));
+  }
+
+  // owner only
+  void push(WorkStealingThreadPool::Task* task) {
+    auto bottom = bottom_.load(std::memory_order_relaxed);
+    auto top = top_.load(std::memory_order_acquire);
+    auto array = array_.load(std::memory_order_relaxed);
+    if (bottom - top > array->capacity_ - 1) {
+      array = grow(array, top, bottom);
+    }
+    array->at(bottom).store(task, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom_.store(bottom + 1, std::memory_order_relaxed);
+  }
+
+  // owner only
+  WorkStealingThreadPool::Task* pop() {
+    auto bottom = bottom_.load(std::memory_order_relaxed) - 1;
+    auto array = array_.load(std::memory_order_relaxed);
+    bottom_.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto top = top_.load(std::memory_order_relaxed);
+    WorkStealingThreadPool::Task* task = nullptr;
+    if (top <= bottom) {
+      task = array->at(bottom).load(std::memory_order_relaxed);
+      if (top == bottom) {
+        // last task, race against the thieves for it
+        if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+          task = nullptr;
+        }
+        bottom_.store(bottom + 1, std::memory_order_relaxed);
+      }
+    } else {
+      bottom_.store(bottom + 1, std::memory_order_relaxed);
+    }
+    return task;
+  }
+
+  // any thread; returns nullptr if the deque is empty or another thread took the task first
+  WorkStealingThreadPool::Task* steal() {
+    auto top = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto bottom = bottom_.load(std::memory_order_acquire);
+    if (top >= bottom) {
+      return nullptr;
+    }
+    auto task = array_.load(std::memory_order_acquire)->at(top).load(std::memory_order_relaxed);
+    if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+      return nullptr;
+    }
+    return task;
+  }
+
+  // not thread safe, only once the workers are gone
+  std::vector<WorkStealingThreadPool::Task*> clear() {
+    std::vector<WorkStealingThreadPool::Task*> tasks;
+    for (auto task = steal(); task != nullptr; task = steal()) {
+      tasks.emplace_back(task);
+    }
+    return tasks;
+  }
+
+private:
+  struct Array {
+    explicit Array(int64_t capacity)
+      : capacity_(capacity)
+      , slots_(new std::atomic<WorkStealingThreadPool::Task*>[static_cast<size_t>(capacity)]) {
+    }
+    std::atomic<WorkStealingThreadPool::Task*>& at(int64_t index) {
+      return slots_[static_cast<size_t>(index & (capacity_ - 1))];
+    }
+    const int64_t capacity_;
+    std::unique_ptr<std::atomic<WorkStealingThreadPool::Task*>[]> slots_;
+  };
+
+  Array* grow(Array* array, int64_t top, int64_t bottom) {
+    auto bigger = new Array(array->capacity_ * 2);
+    for (auto i = top; i < bottom; ++i) {
+      bigger->at(i).store(array->at(i).load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+    // thieves may still read the old array, keep all of them until the deque is destroyed
+    arrays_.emplace_back(bigger);
+    array_.store(bigger, std::memory_order_release);
+    return bigger;
+  }
+
+  alignas(64) std::atomic<int64_t> top_{0};
+  alignas(64) std::atomic<int64_t> bottom_{0};
+  std::atomic<Array*> array_;
+  std::vector<std::unique_ptr<Array>> arrays_;
+};
+
+// pool and worker index of the current thread, if it is a worker
+thread_local const WorkStealingThreadPool* currentPool = nullptr;
+thread_local size_t currentWorker = 0;
+} // namespace
+
+struct WorkStealingThreadPool::Worker {
+  TaskDeque deque_;
+  std::thread thread_;
+};
+
+WorkStealingThreadPool::WorkStealingThreadPool(size_t numThreads, bool waitPendingTasks,
+                                               std::function<void()> onThreadStart)
+  : onThreadStart_(std::move(onThreadStart))
+  , waitPendingTasks_(waitPendingTasks) {
+  for (auto i = 0U; i < numThreads; ++i) {
+    workers_.emplace_back(std::make_unique<Worker>());
+  }
+  // all the deques must exist before any worker tries to steal
+  for (auto i = 0U; i < numThreads; ++i) {
+    workers_[i]->thread_ = std::thread(&WorkStealingThreadPool::workerFunc, this, i);
+  }
+}
+
+void WorkStealingThreadPool::pushTask(Task task) {
+  if (workers_.empty()) {
+    TP_VLOG(MID) << "Running thread pool with no threads (debugging), so execute the task directly";
+    task();
+    return;
+  }
+  TP_VLOG(MID) << "Pushing a new task into threadpool " << std::hex << this;
+  auto newTask = new Task(std::move(task));
+  if (currentPool == this) {
+    workers_[currentWorker]->deque_.push(newTask);
+  } else {
+    std::lock_guard lock(injectionMutex_);
+    injected_.emplace_back(newTask);
+  }
+  notify(1);
+}
+
+void WorkStealingThreadPool::pushBatch(std::vector<Task> tasks) {
+  if (tasks.empty()) {
+    return;
+  }
+  if (workers_.empty()) {
+    TP_VLOG(MID) << "Running thread pool with no threads (debugging), so execute the tasks directly";
+    for (auto& task : tasks) {
+      task();
+    }
+    return;
+  }
+  TP_VLOG(MID) << "Pushing " << tasks.size() << " tasks into threadpool " << std::hex << this;
+  if (currentPool == this) {
+    auto& deque = workers_[currentWorker]->deque_;
+    for (auto& task : tasks) {
+      deque.push(new Task(std::move(task)));
+    }
+  } else {
+    std::vector<Task*> newTasks;
+    newTasks.reserve(tasks.size());
+    for (auto& task : tasks) {
+      newTasks.emplace_back(new Task(std::move(task)));
+    }
+    std::lock_guard lock(injectionMutex_);
+    injected_.insert(end(injected_), begin(newTasks), end(newTasks));
+  }
+  notify(tasks.size());
+}
+
+void WorkStealingThreadPool::notify(size_t numTasks) {
+  // pairs with the increment of sleepingWorkers_ before a worker checks pendingTasks_, both seq_cst: either the worker
+  // sees the new tasks or this sees the sleeping worker
+  pendingTasks_.fetch_add(numTasks, std::memory_order_seq_cst);
+  if (sleepingWorkers_.load(std::memory_order_seq_cst) > 0) {
+    std::lock_guard lock(sleepMutex_);
+    if (numTasks == 1) {
+      sleepCondVar_.notify_one();
+    } else {
+      sleepCondVar_.notify_all();
+    }
+  }
+}
+
+void WorkStealingThreadPool::blockUntilDrained() {
+  while (pendingTasks_.load(std::memory_order_acquire) > 0) {
+    TP_VLOG(MID) << "Waiting until tasks are drained: " << pendingTasks_.load(std::memory_order_relaxed);
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  TP_VLOG(MID) << "All tasks are drained.";
+}
+
+WorkStealingThreadPool::~WorkStealingThreadPool() {
+  TP_LOG(INFO) << "Destroying threadpool " << std::hex << this;
+  if (waitPendingTasks_) {
+    blockUntilDrained();
+  }
+  {
+    std::lock_guard lock(sleepMutex_);
+    running_ = false;
+  }
+  sleepCondVar_.notify_all();
+  TP_VLOG(LOW) << "Waiting for all threads in threadpool " << std::hex << this;
+  for (auto& w : workers_) {
+    w->thread_.join();
+  }
+  // the workers stop after their running task, drop the pending ones
+  for (auto& w : workers_) {
+    for (auto task : w->deque_.clear()) {
+      delete task;
+    }
+  }
+  for (auto task : injected_) {
+    delete task;
+  }
+  injected_.clear();
+  workers_.clear();
+  TP_VLOG(LOW) << "Threadpool " << std::hex << this << " destroyed.";
+}
+
+WorkStealingThreadPool::Task* WorkStealingThreadPool::popInjected(Worker& worker) {
+  std::unique_lock lock(injectionMutex_, std::try_to_lock);
+  if (!lock.owns_lock() || injected_.empty()) {
+    return nullptr;
+  }
+  auto task = injected_.front();
+  injected_.pop_front();
+  for (auto i = 1U; i < kInjectionBatch && !injected_.empty(); ++i) {
+    worker.deque_.push(injected_.front());
+    injected_.pop_front();
+  }
+  return task;
+}
+
+WorkStealingThreadPool::Task* WorkStealingThreadPool::findTask(size_t index) {
+  auto& worker = *workers_[index];
+  if (auto task = worker.deque_.pop()) {
+    return task;
+  }
+  if (auto task = popInjected(worker)) {
+    return task;
+  }
+  for (auto i = 1U; i < workers_.size(); ++i) {
+    if (auto task = workers_[(index + i) % workers_.size()]->deque_.steal()) {
+      return task;
+    }
+  }
+  return nullptr;
+}
+
+void WorkStealingThreadPool::workerFunc(size_t index) {
+  currentPool = this;
+  currentWorker = index;
+  if (onThreadStart_) {
+    onThreadStart_();
+  }
+  auto spins = 0U;
+  while (running_.load(std::memory_order_acquire)) {
+    if (auto task = findTask(index)) {
+      pendingTasks_.fetch_sub(1, std::memory_order_acq_rel);
+      TP_VLOG(MID) << "Executing task.";
+      (*task)();
+      delete task;
+      spins = 0;
+    } else if (++spins < kSpinIterations) {
+      std::this_thread::yield();
+    } else {
+      TP_VLOG(MID) << "No tasks to execute, waiting for next task.";
+      std::unique_lock lock(sleepMutex_);
+      sleepingWorkers_.fetch_add(1, std::memory_order_seq_cst);
+      sleepCondVar_.wait(lock, [this] {
+        return !running_.load(std::memory_order_relaxed) || pendingTasks_.load(std::memory_order_seq_cst) > 0;
+      });
+      sleepingWorkers_.fetch_sub(1, std::memory_order_relaxed);
+      spins = 0;
+    }
+  }
+}
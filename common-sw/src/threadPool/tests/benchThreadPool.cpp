@@ -0,0 +1,87 @@
+//******************************************************************************
+// Copyright (c) 2025 Ainekko, Co.
+// SPDX-License-Identifier: Apache-2.0
+//------------------------------------------------------------------------------
+
+// Compares ThreadPool and WorkStealingThreadPool with many short tasks pushed from several producer threads, one by one
+// or in batches (as the runtime does with the cma copies of concurrent memcpys). It is not run by ctest.
+#include "hostUtils/threadPool/ThreadPool.h"
+#include "hostUtils/threadPool/WorkStealingThreadPool.h"
+#include <atomic>
+#include <chrono>
+#include <gtest/gtest.h>
+#include <hostUtils/logging/Logger.h>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace threadPool;
+using namespace std::chrono;
+
+namespace {
+constexpr auto kWorkers = 4U;
+constexpr auto kProducers = 4U;
+constexpr auto kTasksPerProducer = 100000U;
+constexpr auto kBatchSize = 64U;
+
+// a few hundred ns of work, about a small cma copy
+void work(std::atomic<uint64_t>& acum, uint64_t seed) {
+  auto value = seed;
+  for (auto i = 0; i < 100; ++i) {
+    value = value * 6364136223846793005ULL + 1442695040888963407ULL;
+  }
+  acum.fetch_add((value & 1) + 1, std::memory_order_relaxed);
+}
+
+template <typename Pool> void run(const std::string& name, std::unique_ptr<Pool> pool, bool batch) {
+  std::atomic<uint64_t> acum = 0;
+  auto start = steady_clock::now();
+  std::vector<std::thread> producers;
+  for (auto p = 0U; p < kProducers; ++p) {
+    producers.emplace_back([&pool, &acum, batch] {
+      std::vector<typename Pool::Task> tasks;
+      for (auto i = 0U; i < kTasksPerProducer; ++i) {
+        auto task = [&acum, i] { work(acum, i); };
+        if (!batch) {
+          pool->pushTask(task);
+          continue;
+        }
+        tasks.emplace_back(task);
+        if (tasks.size() == kBatchSize) {
+          pool->pushBatch(std::move(tasks));
+          tasks.clear();
+        }
+      }
+      pool->pushBatch(std::move(tasks));
+    });
+  }
+  for (auto& p : producers) {
+    p.join();
+  }
+  // the pools wait for their pending tasks on destruction
+  pool.reset();
+  auto elapsed = duration_cast<microseconds>(steady_clock::now() - start).count();
+  std::cout << name << (batch ? " (batches of " + std::to_string(kBatchSize) + ")" : "") << ": "
+            << kProducers * kTasksPerProducer << " tasks in " << elapsed << " us, "
+            << static_cast<double>(kProducers * kTasksPerProducer) * 1e6 / static_cast<double>(elapsed)
+            << " tasks/s" << std::endl;
+  ASSERT_GE(acum, kProducers * kTasksPerProducer);
+}
+} // namespace
+
+TEST(ThreadPoolBenchmark, ThreadPool) {
+  run("ThreadPool", std::make_unique<ThreadPool>(kWorkers, false, true), false);
+  run("ThreadPool", std::make_unique<ThreadPool>(kWorkers, false, true), true);
+}
+
+TEST(ThreadPoolBenchmark, WorkStealingThreadPool) {
+  run("WorkStealingThreadPool", std::make_unique<WorkStealingThreadPool>(kWorkers, true), false);
+  run("WorkStealingThreadPool", std::make_unique<WorkStealingThreadPool>(kWorkers, true), true);
+}
+
+int main(int argc, char** argv) {
+  logging::LoggerDefault logger_;
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -4,6 +4,7 @@
 //------------------------------------------------------------------------------
 
 #include "hostUtils/threadPool/ThreadPool.h"
+#include "hostUtils/threadPool/WorkStealingThreadPool.h"
 #include <atomic>
 #include <chrono>
 #include <gtest/gtest.h>
@@ -30,6 +31,103 @@ TEST(ThreadPool, 1000tasks) {
   ASSERT_EQ(acum, (1000 * 1001) / 2);
 }
 
+TEST(ThreadPool, pushBatch) {
+  std::atomic<int> acum = 0;
+  {
+    ThreadPool tp(4, false, true);
+    std::vector<ThreadPool::Task> tasks;
+    for (int i = 1; i <= 1000; ++i) {
+      tasks.emplace_back([&acum, i] { acum += i; });
+    }
+    tp.pushBatch(std::move(tasks));
+  }
+  ASSERT_EQ(acum, (1000 * 1001) / 2);
+}
+
+TEST(WorkStealingThreadPool, simple) {
+  bool taskExecuted = false;
+  {
+    WorkStealingThreadPool tp(5, true);
+    tp.pushTask([&taskExecuted] { taskExecuted = true; });
+  }
+  ASSERT_TRUE(taskExecuted);
+}
+
+TEST(WorkStealingThreadPool, noThreads) {
+  bool taskExecuted = false;
+  WorkStealingThreadPool tp(0);
+  tp.pushTask([&taskExecuted] { taskExecuted = true; });
+  ASSERT_TRUE(taskExecuted);
+}
+
+TEST(WorkStealingThreadPool, 1000tasks) {
+  std::atomic<int> acum = 0;
+  {
+    WorkStealingThreadPool tp(20, true);
+    for (int i = 1; i <= 1000; ++i) {
+      tp.pushTask([&acum, i] { acum += i; });
+    }
+  }
+  ASSERT_EQ(acum, (1000 * 1001) / 2);
+}
+
+TEST(WorkStealingThreadPool, pushBatch) {
+  std::atomic<int> acum = 0;
+  {
+    WorkStealingThreadPool tp(4, true);
+    std::vector<WorkStealingThreadPool::Task> tasks;
+    for (int i = 1; i <= 1000; ++i) {
+      tasks.emplace_back([&acum, i] { acum += i; });
+    }
+    tp.pushBatch(std::move(tasks));
+    tp.blockUntilDrained();
+  }
+  ASSERT_EQ(acum, (1000 * 1001) / 2);
+}
+
+// tasks pushed from the workers go to their own deques and must be stolen by the others (more than the initial deque
+// capacity, so they grow)
+TEST(WorkStealingThreadPool, nestedTasks) {
+  std::atomic<int> executed = 0;
+  std::atomic<int> parallel = 0;
+  std::atomic<int> maxParallel = 0;
+  {
+    WorkStealingThreadPool tp(4, true);
+    tp.pushTask([&] {
+      for (int i = 0; i < 1000; ++i) {
+        tp.pushTask([&] {
+          auto current = ++parallel;
+          for (auto max = maxParallel.load(); current > max && !maxParallel.compare_exchange_weak(max, current);) {
+          }
+          std::this_thread::sleep_for(std::chrono::microseconds(10));
+          --parallel;
+          ++executed;
+        });
+      }
+    });
+    // the pool is drained for a while once the first task starts, wait for the nested ones instead
+    while (executed < 1000) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+  ASSERT_EQ(executed, 1000);
+  ASSERT_GT(maxParallel, 1);
+}
+
+TEST(WorkStealingThreadPool, dropPendingTasks) {
+  std::atomic<int> executed = 0;
+  {
+    WorkStealingThreadPool tp(1);
+    for (int i = 0; i < 100; ++i) {
+      tp.pushTask([&executed] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        ++executed;
+      });
+    }
+  }
+  ASSERT_LT(executed, 100);
+}
+
 int main(int argc, char** argv) {
   logging::LoggerDefault logger_;
   testing::InitGoogleTest(&argc, argv);
@@ -15,6 +15,7 @@
 #include "hwinc/sp_cru_reset.h"
 
 #include "bl2_emmc_controller_impl.h"
+#include "interrupt.h"
 
 #include "delays.h"
 
@@ -1346,6 +1347,36 @@ static int emmc_HS200_tuning_sequence(const ET_EMMC_DEV_t *dev)
     return SUCCESS;
 } // emmc_HS200_tuning_sequence()
 
+static void emmc_isr(void)
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    /* The status bits are left for the waiting task, which reads them as when polling */
+    gs_emmc_dev.regs->crypto.NORMAL_INT_SIGNAL_EN_R = 0;
+    gs_emmc_dev.regs->crypto.ERROR_INT_SIGNAL_EN_R = 0;
+    xSemaphoreGiveFromISR(gs_emmc_dev.xfer_done_handle, &xHigherPriorityTaskWoken);
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+static int emmc_enable_irq(ET_EMMC_DEV_t *dev)
+{
+    if (dev->irqEnabled == false)
+    {
+        dev->xfer_done_handle = xSemaphoreCreateBinaryStatic(&dev->xfer_done);
+        if (!dev->xfer_done_handle)
+        {
+            return ERROR_EMMC_GENERAL;
+        }
+
+        dev->regs->crypto.NORMAL_INT_SIGNAL_EN_R = 0;
+        dev->regs->crypto.ERROR_INT_SIGNAL_EN_R = 0;
+        INT_enableInterrupt(PU_PLIC_EMMC_INTR, 1, emmc_isr);
+        dev->irqEnabled = true;
+    }
+
+    return SUCCESS;
+}
+
 static int emmc_diag_iomode(EMMC_MODE_t mode)
 {
     int status = Emmc_Iomode_Blk_Rd(0x100, (uint32_t *)0x8000000000, 512, 1, mode);
@@ -1427,6 +1458,12 @@ int Emmc_Setup(EMMC_MODE_t mode)
 
     print_id_and_capacity(&gs_emmc_dev);
 
+    // ADMA2 transfers sleep on the completion interrupt once the scheduler runs
+    if (SUCCESS != emmc_enable_irq(&gs_emmc_dev))
+    {
+        Log_Write(LOG_LEVEL_WARNING, "EMMC:[txt] eMMC interrupt setup failed, polling DMA transfers\r\n");
+    }
+
     if (SUCCESS != emmc_diag_iomode(mode))
     {
         Log_Write(LOG_LEVEL_ERROR, "EMMC:[txt] eMMC IOMODE diag failed\r\n");
@@ -1453,6 +1490,7 @@ static int cmd_dt_adma2(const ET_EMMC_DEV_t *dev, uint16_t cmd, uint32_t arg, ui
     uint8_t resp_int = 0;
 
     uint8_t multi_block = block_count > 1;
+    bool irq = dev->irqEnabled && (xTaskGetSchedulerState() == taskSCHEDULER_RUNNING);
 
     // disable cmd23 enable
     dev->regs->crypto.HOST_CTRL2_R &= (uint16_t)(~HOST_CTRL2_R__CMD23_ENABLE__MASK);
@@ -1488,6 +1526,14 @@ static int cmd_dt_adma2(const ET_EMMC_DEV_t *dev, uint16_t cmd, uint32_t arg, ui
                                                NORMAL_INT_STAT_EN_R__BUF_WR_READY_STAT_EN__MASK |
                                                NORMAL_INT_STAT_EN_R__BUF_RD_READY_STAT_EN__MASK);
 
+    if (irq)
+    {
+        // drop a completion left by a transfer which timed out, then signal the end of this one
+        (void)xSemaphoreTake(dev->xfer_done_handle, 0);
+        dev->regs->crypto.NORMAL_INT_SIGNAL_EN_R = NORMAL_INT_SIGNAL_EN_R__XFER_COMPLETE_SIGNAL_EN__MASK;
+        dev->regs->crypto.ERROR_INT_SIGNAL_EN_R = ERROR_INT_SIGNAL_EN_R__ADMA_ERR_SIGNAL_EN__MASK;
+    }
+
     if (err_chk)
         resp_int = 0x1;
     dev->regs->crypto.XFER_MODE_R =
@@ -1534,8 +1580,19 @@ static int cmd_dt_adma2(const ET_EMMC_DEV_t *dev, uint16_t cmd, uint32_t arg, ui
 #endif
     }
 
-    timeout = 100000; // x 0.1ms
-    while (--timeout)
+    if (irq)
+    {
+        // the task sleeps till the transfer completes or fails, the status is then checked once
+        (void)xSemaphoreTake(dev->xfer_done_handle, pdMS_TO_TICKS(ADMA2_XFER_TIMEOUT_MS));
+        dev->regs->crypto.NORMAL_INT_SIGNAL_EN_R = 0;
+        dev->regs->crypto.ERROR_INT_SIGNAL_EN_R = 0;
+        timeout = 1;
+    }
+    else
+    {
+        timeout = ADMA2_XFER_TIMEOUT_MS * 10; // x 0.1ms
+    }
+    while (timeout)
     {
         if (dev->regs->crypto.ERROR_INT_STAT_R & ERROR_INT_STAT_R__ADMA_ERR__MASK)
         {
@@ -1559,7 +1616,10 @@ static int cmd_dt_adma2(const ET_EMMC_DEV_t *dev, uint16_t cmd, uint32_t arg, ui
             break;
         }
 
-        usdelay(100);
+        if (--timeout)
+        {
+            usdelay(100);
+        }
     } // while
     if (timeout == 0)
     {
@@ -1595,61 +1655,122 @@ int Emmc_Iomode_Blk_Rd(uint32_t addr, uint32_t *data_buff, uint16_t block_size,
     return cmd_dt_no_dma(&gs_emmc_dev, command, addr, block_size, block_count, data_buff, mode);
 }
 
-int Emmc_Adma2_Wr(uint32_t addr, uint32_t *data_buff, uint16_t block_size, uint32_t block_count)
+/* Fills the descriptor table with the head of a transfer, returns the number of blocks it
+   covers. Each descriptor moves whole blocks, the table holds ADMA2_MAX_DESCRIPTORS of them */
+static uint32_t adma2_fill_desc_table(desc_line_t *desc_table, const uint32_t *data_buff,
+                                      uint16_t block_size, uint32_t block_count)
 {
-    int status;
-    desc_line_t *desc_table;
+    uint32_t desc_blocks = ADMA2_MAX_DESC_LEN / block_size;
+    uint32_t blocks = 0;
+    uint32_t idx = 0;
 
-    desc_table = (desc_line_t *)R_PU_SRAM_LO_BASEADDR;                // We must use PU_SRAM here
-                                                                      // because EMMC can't
-                                                                      // access SP_SRAM
-    desc_table->len_10b = ((block_size * block_count) >> 16) & 0x3FF; // upper 10
-    desc_table->len_16b = (block_size * block_count) & 0x0FFFF;
-    desc_table->address = (long)data_buff;
-    desc_table->act = ADMA2_ATTR_TRAN;
-    desc_table->interr = 1;
-    desc_table->end = 1;
-    desc_table->valid = 1;
+    while ((blocks < block_count) && (idx < ADMA2_MAX_DESCRIPTORS))
+    {
+        uint32_t count = block_count - blocks;
+        if (count > desc_blocks)
+        {
+            count = desc_blocks;
+        }
 
-    status = cmd_dt_adma2(&gs_emmc_dev, EMMC_JEDEC_CMD25, addr, ADMA2_SELECT, (uint64_t)desc_table,
-                          block_size, block_count);
+        desc_table[idx].len_10b = 0;
+        desc_table[idx].len_16b = (count * block_size) & 0x0FFFF;
+        desc_table[idx].address = (long)((uintptr_t)data_buff + (uintptr_t)blocks * block_size);
+        desc_table[idx].reserved = 0;
+        desc_table[idx].act = ADMA2_ATTR_TRAN;
+        desc_table[idx].interr = 0;
+        desc_table[idx].end = 0;
+        desc_table[idx].valid = 1;
+
+        blocks += count;
+        idx++;
+    }
+    desc_table[idx - 1].interr = 1;
+    desc_table[idx - 1].end = 1;
 
-    return status;
+    return blocks;
 }
 
-int Emmc_Adma2_Rd(uint32_t addr, uint32_t *data_buff, uint16_t block_size, uint32_t block_count)
+/* Multi block transfer, split in commands of ADMA2_MAX_DESCRIPTORS descriptors */
+static int adma2_transfer(uint16_t cmd, uint32_t addr, uint32_t *data_buff, uint16_t block_size,
+                          uint32_t block_count)
 {
-    int status;
+    int status = SUCCESS;
     desc_line_t *desc_table;
 
     desc_table = (desc_line_t *)R_PU_SRAM_LO_BASEADDR; // We must use PU_SRAM here
                                                        // because EMMC can't
                                                        // access SP_SRAM
 
-    desc_table->len_10b = ((block_size * block_count) >> 16) & 0x3FF; // upper 10
-    desc_table->len_16b = (block_size * block_count) & 0x0FFFF;
-    desc_table->address = (long)data_buff;
-    desc_table->act = ADMA2_ATTR_TRAN;
-    desc_table->interr = 1;
-    desc_table->end = 1;
-    desc_table->valid = 1;
+    if (block_size == 0)
+    {
+        Log_Write(LOG_LEVEL_ERROR, "ERROR: Unexpected block size: 0x%X\r\n", block_size);
+        return ERROR_EMMC_UNEXPECTED_BLOCK_SIZE;
+    }
 
-    status = cmd_dt_adma2(&gs_emmc_dev, EMMC_JEDEC_CMD18, addr, ADMA2_SELECT, (uint64_t)desc_table,
-                          block_size, block_count);
+    while ((status == SUCCESS) && (block_count > 0))
+    {
+        uint32_t blocks = adma2_fill_desc_table(desc_table, data_buff, block_size, block_count);
+
+        status = cmd_dt_adma2(&gs_emmc_dev, cmd, addr, ADMA2_SELECT, (uint64_t)desc_table,
+                              block_size, blocks);
+
+        // sector addressing, the next command starts after the blocks moved
+        addr += blocks;
+        data_buff = (uint32_t *)((uintptr_t)data_buff + (uintptr_t)blocks * block_size);
+        block_count -= blocks;
+    }
 
     return status;
 }
 
+int Emmc_Adma2_Wr(uint32_t addr, uint32_t *data_buff, uint16_t block_size, uint32_t block_count)
+{
+    return adma2_transfer(EMMC_JEDEC_CMD25, addr, data_buff, block_size, block_count);
+}
+
+int Emmc_Adma2_Rd(uint32_t addr, uint32_t *data_buff, uint16_t block_size, uint32_t block_count)
+{
+    return adma2_transfer(EMMC_JEDEC_CMD18, addr, data_buff, block_size, block_count);
+}
+
 union AlignedBuffer
 {
     uint8_t bytes[EMMC_BLOCK_SIZE];
     uint64_t dummy; // Ensure proper alignment for 64-bit data
 };
 
+/* The controller can't access SP SRAM, ADMA2 data addresses are 8 bytes aligned */
+static bool emmc_is_dma_reachable(const void *buffer)
+{
+    uintptr_t address = (uintptr_t)buffer;
+
+    return ((address % 8) == 0) &&
+           ((address < R_SP_SRAM_BASEADDR) || (address >= (R_SP_SRAM_BASEADDR + R_SP_SRAM_SIZE)));
+}
+
 int Emmc_read_to_buffer(uint8_t *buffer, size_t size, uint64_t sector)
 {
     union AlignedBuffer loc_dataBuff;
 
+    // Image sized reads are moved by ADMA2, only the partial last block goes through the CPU
+    if ((size >= ADMA2_MIN_READ_BLOCKS * EMMC_BLOCK_SIZE) && emmc_is_dma_reachable(buffer))
+    {
+        uint32_t num_blocks = (uint32_t)(size / EMMC_BLOCK_SIZE);
+
+        if (SUCCESS != Emmc_Adma2_Rd((uint32_t)sector, (uint32_t *)(void *)buffer,
+                                     EMMC_BLOCK_SIZE, num_blocks))
+        {
+            return -1;
+        }
+        buffer += (size_t)num_blocks * EMMC_BLOCK_SIZE;
+        size -= (size_t)num_blocks * EMMC_BLOCK_SIZE;
+        sector += num_blocks;
+        if (size == 0)
+        {
+            return SUCCESS;
+        }
+    }
+
     // Multi-block transfers
     if (size > EMMC_BLOCK_SIZE)
     {
@@ -26,6 +26,8 @@
         flash_fs_get_part_number
         flash_fs_set_part_number
         flash_fs_get_serial_number
+        flash_fs_read_ddr_training_cache
+        flash_fs_write_ddr_training_cache
         flash_fs_get_module_rev
         flash_fs_get_memory_size
         flash_fs_get_form_factor
@@ -72,6 +74,12 @@ static_assert(SPI_FLASH_SECTOR_SIZE >= sizeof(ESPERANTO_RAW_IMAGE_FILE_HEADER_t)
                                            sizeof(ESPERANTO_CONFIG_DATA_t),
               "flash_fs_set_part_number(): ESPERANTO_CONFIG_DATA_t not in the expected sector!");
 
+/* Assertion to make sure that the DDR training cache doesn't overlap the config data */
+static_assert(FLASH_FS_DDR_TRAINING_CACHE_OFFSET >= sizeof(ESPERANTO_RAW_IMAGE_FILE_HEADER_t) +
+                                                        sizeof(ESPERANTO_CONFIG_HEADER_t) +
+                                                        sizeof(ESPERANTO_CONFIG_DATA_t),
+              "DDR training cache overlaps ESPERANTO_CONFIG_DATA_t!");
+
 /*! \def INVALID_REGION_INDEX
     \brief invalid region index value.
 */
@@ -1042,6 +1050,92 @@ int flash_fs_erase_partition(uint32_t partition_address, uint32_t partition_size
     return 0;
 }
 
+/************************************************************************
+*
+*   FUNCTION
+*
+*       flash_fs_is_blank
+*
+*   DESCRIPTION
+*
+*       This function checks if data is all 0xFF, the content of erased flash.
+*
+*   INPUTS
+*
+*       data                   data to check, 8 bytes aligned
+*       size                   size of the data, multiple of 8 bytes
+*
+*   OUTPUTS
+*
+*       true if the data is blank
+*
+***********************************************************************/
+static bool flash_fs_is_blank(const void *data, uint32_t size)
+{
+    const uint64_t *words = (const uint64_t *)data;
+
+    for (uint32_t i = 0; i < size / sizeof(uint64_t); i++)
+    {
+        if (words[i] != UINT64_MAX)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       flash_fs_block_state
+*
+*   DESCRIPTION
+*
+*       This function reads a flash block and checks if it already holds
+*       the data to write, or if it is already erased.
+*
+*   INPUTS
+*
+*       block_address          address of the block
+*       data                   data to write to the block
+*       matches                set if the block already holds the data
+*       blank                  set if the whole block reads as erased
+*
+*   OUTPUTS
+*
+*       none
+*
+***********************************************************************/
+static void flash_fs_block_state(uint32_t block_address, const uint8_t *data, bool *matches,
+                                 bool *blank)
+{
+    uint64_t page[SPI_FLASH_PAGE_SIZE / sizeof(uint64_t)];
+
+    *matches = true;
+    *blank = true;
+    for (uint32_t offset = 0; (*matches || *blank) && (offset < SPI_FLASH_BLOCK_SIZE);
+         offset += SPI_FLASH_PAGE_SIZE)
+    {
+        if (0 != SPI_Flash_Read_Page(sg_flash_fs_bl2_info.flash_id, block_address + offset,
+                                     (uint32_t *)page, SPI_FLASH_PAGE_SIZE))
+        {
+            *matches = false;
+            *blank = false;
+            return;
+        }
+        if (*matches && (0 != memcmp(page, data + offset, SPI_FLASH_PAGE_SIZE)))
+        {
+            *matches = false;
+        }
+        if (*blank && !flash_fs_is_blank(page, SPI_FLASH_PAGE_SIZE))
+        {
+            *blank = false;
+        }
+    }
+}
+
 /************************************************************************
 *
 *   FUNCTION
@@ -1051,6 +1145,11 @@ int flash_fs_erase_partition(uint32_t partition_address, uint32_t partition_size
 *   DESCRIPTION
 *
 *       This function erase the data inside flash partition and writes new data.
+*       It goes one block at a time: blocks which already hold their data, e.g.
+*       the regions an update did not change since the firmware on the passive
+*       partition, are left alone, blocks already erased are not erased again
+*       and pages of the image that are blank (the padding up to the partition
+*       size) are not programmed, since erased flash already holds them.
 *
 *   INPUTS
 *
@@ -1068,6 +1167,11 @@ int flash_fs_update_partition(void *buffer, uint64_t buffer_size, uint32_t chunk
 {
     uint32_t passive_partition_address;
     uint32_t partition_size;
+    uint32_t unchanged_blocks = 0;
+    uint32_t erased_blocks = 0;
+    uint32_t programmed_chunks = 0;
+    bool matches;
+    bool blank;
 
     partition_size = sg_flash_fs_bl2_info.flash_size / 2;
 
@@ -1079,6 +1183,19 @@ int flash_fs_update_partition(void *buffer, uint64_t buffer_size, uint32_t chunk
         return ERROR_SPI_FLASH_INVALID_ARGUMENTS;
     }
 
+    if ((0 == chunk_size) || (SPI_FLASH_PAGE_SIZE < chunk_size) ||
+        (0 != (SPI_FLASH_BLOCK_SIZE % chunk_size)) || (0 != (chunk_size % sizeof(uint64_t))))
+    {
+        MESSAGE_ERROR("flash_fs_update_partition: invalid chunk_size!\n");
+        return ERROR_SPI_FLASH_INVALID_ARGUMENTS;
+    }
+
+    if (0 != (partition_size & SPI_FLASH_BLOCK_MASK))
+    {
+        MESSAGE_ERROR("flash_fs_update_partition: partition_size need to be multiple of 64kB!\n");
+        return ERROR_SPI_FLASH_INVALID_ARGUMENTS;
+    }
+
     /* Check for active partition and get the passive partition address to store the
      new firmware image */
     if (0 == sg_flash_fs_bl2_info.active_partition)
@@ -1098,27 +1215,54 @@ int flash_fs_update_partition(void *buffer, uint64_t buffer_size, uint32_t chunk
               "passive partition address:%x  partition size:%x  buffer:%lx  buffer_size:%x!\n",
               passive_partition_address, partition_size, (uint64_t)buffer, (uint32_t)buffer_size);
 
-    Log_Write(LOG_LEVEL_CRITICAL, "[ETFP] Erasing affected sectors ...\n");
+    Log_Write(LOG_LEVEL_CRITICAL, "[ETFP] Erasing and programming target (%d bytes) ...\n",
+              partition_size);
 
-    if (0 != flash_fs_erase_partition(passive_partition_address, partition_size))
+    for (uint32_t offset = 0; offset < partition_size; offset += SPI_FLASH_BLOCK_SIZE)
     {
-        MESSAGE_ERROR("flash_fs_erase_partition. failed !\n");
-        return ERROR_SPI_FLASH_PARTITION_ERASE_FAILED;
-    }
+        const uint8_t *block = (const uint8_t *)buffer + offset;
+        uint32_t block_address = passive_partition_address + offset;
 
-    Log_Write(LOG_LEVEL_CRITICAL, "[ETFP] Erase operation completed successfully\n");
-    Log_Write(LOG_LEVEL_CRITICAL, "[ETFP] Programming target (%d bytes) ...\n", partition_size);
+        flash_fs_block_state(block_address, block, &matches, &blank);
+        if (matches)
+        {
+            unchanged_blocks++;
+            continue;
+        }
 
-    if (0 !=
-        flash_fs_write_partition(passive_partition_address, buffer, partition_size, chunk_size))
-    {
-        MESSAGE_ERROR("flash_fs_write_file: failed to write data  passive partition address:%x  \
-            buffer:%lx  buffer_size:%x!\n",
-                      passive_partition_address, (uint64_t)buffer, (uint32_t)buffer_size);
-        return ERROR_SPI_FLASH_PARTITION_PROGRAM_FAILED;
+        if (!blank)
+        {
+            if (0 != spi_flash_block_erase(sg_flash_fs_bl2_info.flash_id, block_address))
+            {
+                MESSAGE_ERROR("flash_fs_update_partition: failed to erase block %x!\n",
+                              block_address);
+                return ERROR_SPI_FLASH_PARTITION_ERASE_FAILED;
+            }
+            erased_blocks++;
+        }
+
+        for (uint32_t chunk = 0; chunk < SPI_FLASH_BLOCK_SIZE; chunk += chunk_size)
+        {
+            if (flash_fs_is_blank(block + chunk, chunk_size))
+            {
+                continue;
+            }
+
+            if (0 != spi_flash_page_program(sg_flash_fs_bl2_info.flash_id, block_address + chunk,
+                                            block + chunk, chunk_size))
+            {
+                MESSAGE_ERROR("flash_fs_update_partition: failed to write data at %x!\n",
+                              block_address + chunk);
+                return ERROR_SPI_FLASH_PARTITION_PROGRAM_FAILED;
+            }
+            programmed_chunks++;
+        }
     }
 
-    Log_Write(LOG_LEVEL_CRITICAL, "[ETFP] Target programmed successfully\n");
+    Log_Write(LOG_LEVEL_CRITICAL,
+              "[ETFP] Target programmed successfully (%d blocks unchanged, %d blocks erased, "
+              "%d bytes programmed)\n",
+              unchanged_blocks, erased_blocks, programmed_chunks * chunk_size);
 
     return 0;
 }
@@ -1881,6 +2025,141 @@ int flash_fs_write_config_region(uint32_t partition, bool write_non_persistant)
     return 0;
 }
 
+/************************************************************************
+*
+*   FUNCTION
+*
+*       flash_fs_read_ddr_training_cache
+*
+*   DESCRIPTION
+*
+*       This function reads the DDR training cache kept in the config region
+*       sector of the active partition, past the config data. The content is
+*       returned as is, validating it is up to the caller.
+*
+*   INPUTS
+*
+*       size                 size of the cache to read
+*
+*   OUTPUTS
+*
+*       buffer               cache content
+*
+***********************************************************************/
+
+int flash_fs_read_ddr_training_cache(void *buffer, uint32_t size)
+{
+    uint32_t config_region_address;
+    int status;
+
+    if ((NULL == buffer) || (size > FLASH_FS_DDR_TRAINING_CACHE_MAX_SIZE))
+    {
+        return ERROR_SPI_FLASH_INVALID_ARGUMENTS;
+    }
+
+    status = get_config_region_address(&config_region_address);
+    if (status != STATUS_SUCCESS)
+    {
+        return status;
+    }
+
+    if (0 != spi_flash_normal_read(sg_flash_fs_bl2_info.flash_id,
+                                   config_region_address + FLASH_FS_DDR_TRAINING_CACHE_OFFSET,
+                                   (uint8_t *)buffer, size))
+    {
+        MESSAGE_ERROR("flash_fs_read_ddr_training_cache: failed to read the cache!\n");
+        return ERROR_SPI_FLASH_NORMAL_RD_FAILED;
+    }
+
+    return STATUS_SUCCESS;
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       flash_fs_write_ddr_training_cache
+*
+*   DESCRIPTION
+*
+*       This function writes the DDR training cache in the config region
+*       sector of the active partition. The rest of the sector, config data
+*       included, is preserved. A firmware update writes the config region
+*       of the other partition from the new image, so the new firmware
+*       always starts without a cache.
+*
+*   INPUTS
+*
+*       buffer               cache content
+*       size                 size of the cache
+*
+*   OUTPUTS
+*
+*       none
+*
+***********************************************************************/
+
+int flash_fs_write_ddr_training_cache(const void *buffer, uint32_t size)
+{
+    uint32_t config_region_address;
+    uint32_t scratch_buffer_size;
+    void *scratch_buffer;
+    int status;
+
+    if ((NULL == buffer) || (size > FLASH_FS_DDR_TRAINING_CACHE_MAX_SIZE))
+    {
+        return ERROR_SPI_FLASH_INVALID_ARGUMENTS;
+    }
+
+    /* Since Flash sector size is 4KB, get scratch buffer to use */
+    scratch_buffer = get_scratch_buffer(&scratch_buffer_size);
+    if (scratch_buffer_size < SPI_FLASH_SECTOR_SIZE)
+    {
+        return ERROR_INSUFFICIENT_MEMORY;
+    }
+
+    status = get_config_region_address(&config_region_address);
+    if (status != STATUS_SUCCESS)
+    {
+        return status;
+    }
+
+    /* Read the whole sector */
+    if (0 != spi_flash_normal_read(sg_flash_fs_bl2_info.flash_id, config_region_address,
+                                   (uint8_t *)scratch_buffer, SPI_FLASH_SECTOR_SIZE))
+    {
+        MESSAGE_ERROR("flash_fs_write_ddr_training_cache: failed to read config region!\n");
+        return ERROR_SPI_FLASH_NORMAL_RD_FAILED;
+    }
+
+    memcpy((uint8_t *)scratch_buffer + FLASH_FS_DDR_TRAINING_CACHE_OFFSET, buffer, size);
+
+    status = flash_fs_update_sector_and_read_back_for_validation(
+        sg_flash_fs_bl2_info.flash_id, config_region_address, scratch_buffer, scratch_buffer_size);
+    if (status != STATUS_SUCCESS)
+    {
+        return status;
+    }
+
+    if (memcmp((uint8_t *)scratch_buffer + FLASH_FS_DDR_TRAINING_CACHE_OFFSET, buffer, size))
+    {
+        MESSAGE_ERROR("flash_fs_write_ddr_training_cache: cache validation failed!\n");
+        return ERROR_SPI_FLASH_DDR_CACHE_MISMATCH;
+    }
+
+    /* Compare with the persistent data in flash with bl2 global data */
+    if (memcmp(((uint8_t *)scratch_buffer) + sizeof(ESPERANTO_RAW_IMAGE_FILE_HEADER_t) +
+                   sizeof(ESPERANTO_CONFIG_HEADER_t),
+               (uint8_t *)&(sg_flash_fs_bl2_info.asset_config_data.persistent_config),
+               sizeof(ESPERANTO_CONFIG_PERSISTENT_DATA_t)))
+    {
+        MESSAGE_ERROR("flash_fs_write_ddr_training_cache: persistant data validation failed!\n");
+        return ERROR_SPI_FLASH_BL2_INFO_CFG_PERS_MISMATCH;
+    }
+
+    return STATUS_SUCCESS;
+}
+
 /************************************************************************
 *
 *   FUNCTION
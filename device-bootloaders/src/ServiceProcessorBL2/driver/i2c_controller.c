@@ -4,7 +4,9 @@
 ************************************************************************/
 /*! \file i2c_controller.c
     \brief A C module that implements the I2C controller services. It
-    provides functionality of I2C read/write.
+    provides functionality of I2C read/write, polled or interrupt
+    driven. Interrupt driven transfers move up to 64K bytes in a single
+    transaction while the calling task is blocked.
 
     Public interfaces:
         i2c_init
@@ -14,6 +16,12 @@
         i2c_enable
         i2c_disable
         i2c_soft_reset
+        i2c_enable_irq
+        i2c_isr
+        i2c_read_start
+        i2c_write_start
+        i2c_transfer_wait
+        i2c_burst_read
 */
 /***********************************************************************/
 #include <stdint.h>
@@ -23,6 +31,7 @@
 #include "bl_error_code.h"
 #include "interrupt.h"
 #include "delays.h"
+#include "task.h"
 
 #define ET_SS_MIN_SCL_HIGH       4400
 #define ET_SS_MIN_SCL_LOW        5200
@@ -35,9 +44,15 @@
 #define ET_IC_CLK_MHZ          25
 
 #define I2C_MAX_TIMEOUT_MS 1000
-#define I2C_IRQ_ALL        0xFFF
+#define I2C_IRQ_NONE       0
 #define MAX_T_POLL_COUNT   10
 
+/* Interrupts of interrupt driven transfers, a set bit unmasks */
+#define I2C_IRQ_XFER_DONE \
+    (I2C_IC_INTR_MASK_M_TX_ABRT_SET(1) | I2C_IC_INTR_MASK_M_STOP_DET_SET(1))
+#define I2C_IRQ_XFER_RX      I2C_IC_INTR_MASK_M_RX_FULL_SET(1)
+#define I2C_IRQ_XFER_TX      I2C_IC_INTR_MASK_M_TX_EMPTY_SET(1)
+
 static void i2c_enable_module(ET_I2C_DEV_t *dev)
 {
     dev->regs->IC_ENABLE = I2C_IC_ENABLE_RESET_VALUE |
@@ -128,8 +143,8 @@ int i2c_init(ET_I2C_DEV_t *dev, ET_I2C_SPEED_t speed, uint8_t addr_slave)
     /* disable */
     dev->regs->IC_ENABLE = I2C_IC_ENABLE_ENABLE_SET(I2C_IC_ENABLE_ENABLE_ENABLE_DISABLED);
 
-    /* mask all interrupts */
-    dev->regs->IC_INTR_MASK = I2C_IRQ_ALL;
+    /* mask all interrupts, interrupt driven transfers unmask the ones they use */
+    dev->regs->IC_INTR_MASK = I2C_IRQ_NONE;
 
     /* clear all interrupts */
     volatile uint32_t dummyRegRead;
@@ -432,3 +447,243 @@ int i2c_soft_reset(ET_I2C_DEV_t *dev)
 
     return status;
 }
+
+/* Pushes the next data commands of the transfer, the last one carries the STOP
+   condition. Reads are throttled so the RX FIFO can't overflow. */
+static void i2c_xfer_fill_tx_fifo(ET_I2C_DEV_t *dev)
+{
+    ET_I2C_XFER_t *xfer = &dev->xfer;
+    uint32_t mask = I2C_IRQ_XFER_DONE | (xfer->read ? I2C_IRQ_XFER_RX : 0);
+
+    while ((xfer->cmdIssued < xfer->dataCount) &&
+           (I2C_IC_TXFLR_TXFLR_GET(dev->regs->IC_TXFLR) < xfer->txDepth) &&
+           (!xfer->read || ((uint16_t)(xfer->cmdIssued - xfer->rxCount) < xfer->rxDepth)))
+    {
+        uint32_t cmd = I2C_IC_DATA_CMD_RESET_VALUE;
+
+        if (xfer->read)
+        {
+            cmd |= I2C_IC_DATA_CMD_CMD_SET(I2C_IC_DATA_CMD_CMD_CMD_READ);
+        }
+        else
+        {
+            cmd |= I2C_IC_DATA_CMD_CMD_SET(I2C_IC_DATA_CMD_CMD_CMD_WRITE) |
+                   I2C_IC_DATA_CMD_DAT_SET(xfer->txDataBuff[xfer->cmdIssued]);
+        }
+        if (xfer->cmdIssued == (xfer->dataCount - 1))
+        {
+            cmd |= I2C_IC_DATA_CMD_STOP_SET(I2C_IC_DATA_CMD_STOP_STOP_ENABLE);
+        }
+        dev->regs->IC_DATA_CMD = cmd;
+        xfer->cmdIssued++;
+    }
+
+    /* TX empty is a level interrupt, only unmask it while it can be served. Reads
+       throttled by the RX FIFO are resumed when it's drained. */
+    if ((xfer->cmdIssued < xfer->dataCount) &&
+        (!xfer->read || ((uint16_t)(xfer->cmdIssued - xfer->rxCount) < xfer->rxDepth)))
+    {
+        mask |= I2C_IRQ_XFER_TX;
+    }
+    dev->regs->IC_INTR_MASK = mask;
+}
+
+static void i2c_xfer_drain_rx_fifo(ET_I2C_DEV_t *dev)
+{
+    ET_I2C_XFER_t *xfer = &dev->xfer;
+    uint32_t level = I2C_IC_RXFLR_RXFLR_GET(dev->regs->IC_RXFLR);
+
+    while ((level-- > 0) && (xfer->rxCount < xfer->dataCount))
+    {
+        xfer->rxDataBuff[xfer->rxCount++] = I2C_IC_DATA_CMD_DAT_GET(dev->regs->IC_DATA_CMD);
+    }
+
+    /* Interrupt on the last byte of the transfer, or when the FIFO is full */
+    if (xfer->rxCount < xfer->dataCount)
+    {
+        uint16_t left = (uint16_t)(xfer->dataCount - xfer->rxCount);
+        dev->regs->IC_RX_TL =
+            I2C_IC_RX_TL_RX_TL_SET(((left < xfer->rxDepth) ? left : xfer->rxDepth) - 1U);
+    }
+}
+
+static int i2c_xfer_start(ET_I2C_DEV_t *dev, bool read, uint8_t regAddr,
+                          const uint8_t *txDataBuff, uint8_t *rxDataBuff, uint16_t dataCount)
+{
+    ET_I2C_XFER_t *xfer = &dev->xfer;
+    volatile uint32_t dummyRegRead;
+    uint32_t params;
+
+    if (dev->isInitialized == false)
+        return ET_I2C_ERROR_DEV_NOT_INITIALIZED;
+
+    if ((dev->irqEnabled == false) || (xTaskGetSchedulerState() != taskSCHEDULER_RUNNING))
+        return ET_I2C_ERROR_IRQ_NOT_ENABLED;
+
+    if (dataCount == 0)
+        return ET_I2C_ERROR_BAD_LENGTH;
+
+    if (INT_Is_Trap_Context() ||
+        (xSemaphoreTake(dev->bus_lock_handle, pdMS_TO_TICKS(I2C_MAX_TIMEOUT_MS)) != pdTRUE))
+    {
+        return ET_I2C_ERROR_BUS_LOCK;
+    }
+
+    int32_t status = wait_pmic_ready();
+    if (status != SUCCESS)
+    {
+        xSemaphoreGive(dev->bus_lock_handle);
+        return status;
+    }
+
+    /* Drop the completion of a transfer which timed out after all */
+    (void)xSemaphoreTake(dev->xfer_done_handle, 0);
+    dummyRegRead = dev->regs->IC_CLR_INTR;
+    (void)dummyRegRead;
+
+    /* FIFO depths are encoded minus one */
+    params = dev->regs->IC_COMP_PARAM_1;
+    xfer->txDepth = (uint16_t)(I2C_IC_COMP_PARAM_1_TX_BUFFER_DEPTH_GET(params) + 1U);
+    xfer->rxDepth = (uint16_t)(I2C_IC_COMP_PARAM_1_RX_BUFFER_DEPTH_GET(params) + 1U);
+    xfer->txDataBuff = txDataBuff;
+    xfer->rxDataBuff = rxDataBuff;
+    xfer->dataCount = dataCount;
+    xfer->cmdIssued = 0;
+    xfer->rxCount = 0;
+    xfer->read = read;
+    xfer->status = ET_I2C_OK;
+
+    /* Refill when the TX FIFO is half empty */
+    dev->regs->IC_TX_TL = I2C_IC_TX_TL_TX_TL_SET(xfer->txDepth / 2U);
+    dev->regs->IC_RX_TL = I2C_IC_RX_TL_RX_TL_SET(
+        ((dataCount < xfer->rxDepth) ? dataCount : xfer->rxDepth) - 1U);
+
+    /* Send register address, as the polled transfers do */
+    uint32_t cmd = I2C_IC_DATA_CMD_RESET_VALUE |
+                   I2C_IC_DATA_CMD_CMD_SET(I2C_IC_DATA_CMD_CMD_CMD_WRITE) |
+                   I2C_IC_DATA_CMD_DAT_SET(regAddr);
+    if (read)
+    {
+        cmd |= I2C_IC_DATA_CMD_RESTART_SET(I2C_IC_DATA_CMD_RESTART_RESTART_ENABLE);
+    }
+    dev->regs->IC_DATA_CMD = cmd;
+
+    /* The ISR takes over once the interrupts are unmasked */
+    portENTER_CRITICAL();
+    i2c_xfer_fill_tx_fifo(dev);
+    portEXIT_CRITICAL();
+
+    return ET_I2C_OK;
+}
+
+int i2c_enable_irq(ET_I2C_DEV_t *dev, interrupt_t irq, void (*isr)(void))
+{
+    if (dev->isInitialized == false)
+    {
+        return ET_I2C_ERROR_DEV_NOT_INITIALIZED;
+    }
+
+    if (dev->irqEnabled == false)
+    {
+        dev->xfer_done_handle = xSemaphoreCreateBinaryStatic(&dev->xfer_done);
+        if (!dev->xfer_done_handle)
+        {
+            return ET_I2C_ERROR_BUS_LOCK_INIT;
+        }
+
+        dev->regs->IC_INTR_MASK = I2C_IRQ_NONE;
+        INT_enableInterrupt(irq, 1, isr);
+        dev->irqEnabled = true;
+    }
+
+    return ET_I2C_OK;
+}
+
+void i2c_isr(ET_I2C_DEV_t *dev)
+{
+    ET_I2C_XFER_t *xfer = &dev->xfer;
+    uint32_t intr_stat = dev->regs->IC_INTR_STAT;
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    volatile uint32_t dummyRegRead;
+    bool done = false;
+
+    if (I2C_IC_INTR_STAT_R_TX_ABRT_GET(intr_stat))
+    {
+        /* The FIFOs are flushed by the controller until the abort is cleared */
+        dummyRegRead = *(volatile uint32_t *)&dev->regs->IC_CLR_TX_ABRT;
+        xfer->status = ET_I2C_ERROR_TX_ABORT;
+        done = true;
+    }
+    else
+    {
+        if (xfer->read)
+        {
+            i2c_xfer_drain_rx_fifo(dev);
+        }
+
+        if (I2C_IC_INTR_STAT_R_STOP_DET_GET(intr_stat))
+        {
+            dummyRegRead = dev->regs->IC_CLR_STOP_DET;
+            if (xfer->read && (xfer->rxCount < xfer->dataCount))
+            {
+                xfer->status = ET_I2C_ERROR_TX_ABORT;
+            }
+            done = true;
+        }
+        else
+        {
+            i2c_xfer_fill_tx_fifo(dev);
+        }
+    }
+    (void)dummyRegRead;
+
+    if (done)
+    {
+        dev->regs->IC_INTR_MASK = I2C_IRQ_NONE;
+        xSemaphoreGiveFromISR(dev->xfer_done_handle, &xHigherPriorityTaskWoken);
+        portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+    }
+}
+
+int i2c_read_start(ET_I2C_DEV_t *dev, uint8_t regAddr, uint8_t *rxDataBuff, uint16_t rxDataCount)
+{
+    return i2c_xfer_start(dev, true, regAddr, NULL, rxDataBuff, rxDataCount);
+}
+
+int i2c_write_start(ET_I2C_DEV_t *dev, uint8_t regAddr, const uint8_t *txDataBuff,
+                    uint16_t txDataCount)
+{
+    return i2c_xfer_start(dev, false, regAddr, txDataBuff, NULL, txDataCount);
+}
+
+int i2c_transfer_wait(ET_I2C_DEV_t *dev, uint32_t timeout_ms)
+{
+    int status;
+
+    if (xSemaphoreTake(dev->xfer_done_handle, pdMS_TO_TICKS(timeout_ms)) == pdTRUE)
+    {
+        status = dev->xfer.status;
+    }
+    else
+    {
+        dev->regs->IC_INTR_MASK = I2C_IRQ_NONE;
+        (void)i2c_abort(dev);
+        status = ET_I2C_ERROR_TIMEOUT;
+    }
+
+    xSemaphoreGive(dev->bus_lock_handle);
+
+    return status;
+}
+
+int i2c_burst_read(ET_I2C_DEV_t *dev, uint8_t regAddr, uint8_t *rxDataBuff, uint16_t rxDataCount)
+{
+    int status = i2c_read_start(dev, regAddr, rxDataBuff, rxDataCount);
+
+    if (status == ET_I2C_OK)
+    {
+        status = i2c_transfer_wait(dev, I2C_MAX_TIMEOUT_MS);
+    }
+
+    return status;
+}
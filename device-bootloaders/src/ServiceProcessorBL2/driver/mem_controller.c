@@ -23,8 +23,13 @@
         ddr_get_memory_type
 */
 /***********************************************************************/
+#include <stddef.h>
+#include <string.h>
 #include "mem_controller.h"
 #include "bl2_sp_memshire_pll.h"
+#include "bl2_flash_fs.h"
+#include "bl2_pvt_controller.h"
+#include "crc32.h"
 #include "dm_event_control.h"
 #include "hal_ddr_init.h"
 #include "delays.h"
@@ -192,6 +197,335 @@ static void ms_patch_phy_ram_before_training(uint32_t memshire)
     ms_write_phy_ram(memshire, 0x54036, 0x0040 | mr14);        // MR14 Channel B
 }
 
+#if DDR_TRAINING_CACHE
+/*! \def DDR_TRAINING_CACHE_MAGIC
+    \brief Tag of a valid DDR training cache ("DDRT")
+*/
+#define DDR_TRAINING_CACHE_MAGIC 0x54524444U
+
+/*! \def DDR_TRAINING_CACHE_VERSION
+    \brief Bump when the list of cached registers or the cache layout changes
+*/
+#define DDR_TRAINING_CACHE_VERSION 1U
+
+/*! \def DDR_RESTORE_VERIFY_SIZE
+    \brief Bytes of DRAM written and read back to verify a restored training
+*/
+#define DDR_RESTORE_VERIFY_SIZE 0x10000U
+
+/*! \def DDR_RESTORE_VERIFY_PATTERN
+    \brief Pattern XORed with the address of every word written to verify a restored training
+*/
+#define DDR_RESTORE_VERIFY_PATTERN 0xA5A5A5A55A5A5A5AULL
+
+/* Trained registers of a PHY DBYTE */
+#define DDR_TRAINED_DBYTE_REGS(dbyte)                                                          \
+    dbyte##_DFIMRL_p0, dbyte##_PptCtlStatic, dbyte##_PptDqsCntInvTrnTg0_p0,                    \
+        dbyte##_PptDqsCntInvTrnTg1_p0, dbyte##_RxEnDlyTg0_u0_p0, dbyte##_RxEnDlyTg0_u1_p0,     \
+        dbyte##_TxDqDlyTg0_r0_p0, dbyte##_TxDqDlyTg0_r1_p0, dbyte##_TxDqDlyTg0_r2_p0,          \
+        dbyte##_TxDqDlyTg0_r3_p0, dbyte##_TxDqDlyTg0_r4_p0, dbyte##_TxDqDlyTg0_r5_p0,          \
+        dbyte##_TxDqDlyTg0_r6_p0, dbyte##_TxDqDlyTg0_r7_p0, dbyte##_TxDqDlyTg0_r8_p0,          \
+        dbyte##_TxDqsDlyTg0_u0_p0, dbyte##_TxDqsDlyTg0_u1_p0
+
+/* PHY registers set by the training firmware, they are the ones the skiptrain
+   sequence programs with fixed values instead */
+static const uint32_t ddr_trained_phy_regs[] = {
+    DDR_TRAINED_DBYTE_REGS(DBYTE0), DDR_TRAINED_DBYTE_REGS(DBYTE1),
+    DDR_TRAINED_DBYTE_REGS(DBYTE2), DDR_TRAINED_DBYTE_REGS(DBYTE3),
+    ACSM0_AcsmCtrl23,               INITENG0_PhyInLP3,
+    INITENG0_Seq0BGPR1_p0,          INITENG0_Seq0BGPR2_p0,
+    INITENG0_Seq0BGPR3_p0,          MASTER0_HwtCAMode,
+    MASTER0_HwtLpCsEnA,             MASTER0_HwtLpCsEnB,
+    MASTER0_HwtMRL_p0,              MASTER0_PllCtrl3
+};
+
+#define DDR_TRAINED_PHY_REGS_NUM (sizeof(ddr_trained_phy_regs) / sizeof(ddr_trained_phy_regs[0]))
+
+/* A trained PHY register of all the memshires. The config region sector has room for 8-bit
+   offsets from the lowest value, the memshires train within a couple of UIs of each other */
+struct ddr_trained_phy_reg_t
+{
+    uint16_t base;
+    uint8_t offset[NUMBER_OF_MEMSHIRE];
+};
+
+/* Controller registers post_train_update_regs derives from the training */
+struct ddr_trained_ddrc_regs_t
+{
+    uint32_t dfitmg1;     // wrdata_delay from the TxDqsDly
+    uint32_t dramtmg2[2]; // per controller, rd2wr from the training message block
+};
+
+/* The cache is only valid for the same DRAM setup on the same board */
+struct ddr_training_cache_key_t
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;
+    uint32_t frequency;
+    uint32_t ecc;
+    uint32_t module_rev;
+    uint64_t serial_num;
+};
+
+struct ddr_training_cache_t
+{
+    struct ddr_training_cache_key_t key;
+    uint32_t temperature; // minion average at training, in degrees C
+    struct ddr_trained_phy_reg_t phy[DDR_TRAINED_PHY_REGS_NUM];
+    struct ddr_trained_ddrc_regs_t ddrc[NUMBER_OF_MEMSHIRE];
+    uint32_t crc; // of all the fields above
+};
+
+static_assert(sizeof(struct ddr_training_cache_t) <= FLASH_FS_DDR_TRAINING_CACHE_MAX_SIZE,
+              "DDR training cache doesn't fit in the config region!");
+
+static struct ddr_training_cache_t ddr_training_cache;
+static bool ddr_training_cache_restored;
+
+static void ddr_training_cache_get_key(struct ddr_training_cache_key_t *key,
+                                       const DDR_MODE *ddr_mode)
+{
+    memset(key, 0, sizeof(*key));
+    key->magic = DDR_TRAINING_CACHE_MAGIC;
+    key->version = DDR_TRAINING_CACHE_VERSION;
+    key->size = sizeof(struct ddr_training_cache_t);
+    key->frequency = ddr_mode->frequency;
+    key->ecc = ddr_mode->ecc ? 1 : 0;
+    flash_fs_get_module_rev((char *)&key->module_rev);
+    flash_fs_get_serial_number((char *)&key->serial_num);
+}
+
+static uint32_t ddr_training_cache_crc(const struct ddr_training_cache_t *cache)
+{
+    uint32_t crc = 0;
+
+    crc32(cache, offsetof(struct ddr_training_cache_t, crc), &crc);
+    return crc;
+}
+
+/* Reads the cache from flash, returns whether it is valid for ddr_mode */
+static bool ddr_training_cache_read(const DDR_MODE *ddr_mode)
+{
+    struct ddr_training_cache_key_t key;
+
+    if (0 != flash_fs_read_ddr_training_cache(&ddr_training_cache, sizeof(ddr_training_cache)))
+    {
+        return false;
+    }
+
+    ddr_training_cache_get_key(&key, ddr_mode);
+    return (0 == memcmp(&key, &ddr_training_cache.key, sizeof(key))) &&
+           (ddr_training_cache.crc == ddr_training_cache_crc(&ddr_training_cache));
+}
+
+/* Loads the cache, returns whether it can be restored at the current temperature */
+static bool ddr_training_cache_load(const DDR_MODE *ddr_mode)
+{
+    uint8_t temperature;
+
+    /* A blank cache is expected after a firmware update */
+    if (!ddr_training_cache_read(ddr_mode))
+    {
+        Log_Write(LOG_LEVEL_INFO, "DDR:[-1][txt]No valid DDR training cache\n");
+        return false;
+    }
+
+    /* The delays drift with the temperature, train again when it is too far off */
+    if (0 != pvt_get_minion_avg_temperature(&temperature))
+    {
+        return false;
+    }
+
+    if (((uint32_t)temperature > ddr_training_cache.temperature + DDR_TRAINING_CACHE_TEMP_DELTA) ||
+        ((uint32_t)temperature + DDR_TRAINING_CACHE_TEMP_DELTA < ddr_training_cache.temperature))
+    {
+        Log_Write(LOG_LEVEL_INFO, "DDR:[-1][txt]DDR trained at %u C, now %u C: training again\n",
+                  ddr_training_cache.temperature, temperature);
+        return false;
+    }
+
+    return true;
+}
+
+/* Reads a trained PHY register of all the memshires into the cache. Returns false when the
+   values are too far apart to be cached, sets changed when they differ from the cache */
+static bool ddr_training_cache_get_phy_reg(uint32_t reg, bool *changed)
+{
+    struct ddr_trained_phy_reg_t *cached = &ddr_training_cache.phy[reg];
+    uint16_t value[NUMBER_OF_MEMSHIRE];
+    uint16_t base = 0xFFFF;
+    uint32_t memshire;
+
+    FOR_EACH_MEMSHIRE(
+        value[memshire - MEMSHIRE_BASE] =
+            (uint16_t)ms_read_ddrc_reg(memshire, 2, ddr_trained_phy_regs[reg]);
+        base = (value[memshire - MEMSHIRE_BASE] < base) ? value[memshire - MEMSHIRE_BASE] : base;)
+
+    *changed |= (cached->base != base);
+    cached->base = base;
+
+    for (uint32_t i = 0; i < NUMBER_OF_MEMSHIRE; i++)
+    {
+        if ((value[i] - base) > 0xFF)
+        {
+            Log_Write(LOG_LEVEL_WARNING,
+                      "DDR:[%d][txt]Trained PHY register 0x%08x spread too wide to cache\n",
+                      i + MEMSHIRE_BASE, ddr_trained_phy_regs[reg]);
+            return false;
+        }
+        *changed |= (cached->offset[i] != (uint8_t)(value[i] - base));
+        cached->offset[i] = (uint8_t)(value[i] - base);
+    }
+
+    return true;
+}
+
+/* Saves the training in flash, unless the cache already holds it */
+static void ddr_training_cache_save(const DDR_MODE *ddr_mode)
+{
+    struct ddr_trained_ddrc_regs_t trained;
+    bool cacheable = true;
+    uint8_t temperature;
+    uint32_t memshire;
+    bool changed;
+    int status;
+
+    if (0 != pvt_get_minion_avg_temperature(&temperature))
+    {
+        return;
+    }
+
+    changed = !ddr_training_cache_read(ddr_mode);
+    if (changed)
+    {
+        memset(&ddr_training_cache, 0, sizeof(ddr_training_cache));
+        ddr_training_cache_get_key(&ddr_training_cache.key, ddr_mode);
+    }
+
+    // make PHY CSRs accessable from the APB and turn on the clock
+    FOR_EACH_MEMSHIRE(
+        ms_write_ddrc_reg(memshire, 2, APBONLY0_MicroContMuxSel, 0x00000000);
+        ms_write_ddrc_reg(memshire, 2, DRTUB0_UcclkHclkEnables, 0x00000003);
+        ms_read_ddrc_reg(memshire, 2, DRTUB0_UcclkHclkEnables); // make sure writes are done
+    )
+
+    for (uint32_t reg = 0; (reg < DDR_TRAINED_PHY_REGS_NUM) && cacheable; reg++)
+    {
+        cacheable = ddr_training_cache_get_phy_reg(reg, &changed);
+    }
+
+    // turn off the clocks now
+    FOR_EACH_MEMSHIRE(ms_write_ddrc_reg(memshire, 2, APBONLY0_MicroContMuxSel, 0x00000001);
+                      ms_write_ddrc_reg(memshire, 2, DRTUB0_UcclkHclkEnables, 0x00000002);)
+
+    if (!cacheable)
+    {
+        return;
+    }
+
+    FOR_EACH_MEMSHIRE(
+        trained.dfitmg1 = ms_read_ddrc_reg(memshire, 0, DFITMG1);
+        trained.dramtmg2[0] = ms_read_ddrc_reg(memshire, 0, DRAMTMG2);
+        trained.dramtmg2[1] = ms_read_ddrc_reg(memshire, 1, DRAMTMG2);
+        changed |= (0 != memcmp(&ddr_training_cache.ddrc[memshire - MEMSHIRE_BASE], &trained,
+                                sizeof(trained)));
+        ddr_training_cache.ddrc[memshire - MEMSHIRE_BASE] = trained;)
+
+    /* The same training at another temperature isn't worth a sector erase */
+    if (!changed)
+    {
+        return;
+    }
+
+    ddr_training_cache.temperature = temperature;
+    ddr_training_cache.crc = ddr_training_cache_crc(&ddr_training_cache);
+
+    status = flash_fs_write_ddr_training_cache(&ddr_training_cache, sizeof(ddr_training_cache));
+    if (0 != status)
+    {
+        Log_Write(LOG_LEVEL_WARNING, "DDR:[-1][txt]Failed to save the DDR training: %d\n",
+                  status);
+        return;
+    }
+    Log_Write(LOG_LEVEL_INFO, "DDR:[-1][txt]DDR training saved at %u C\n", temperature);
+}
+
+/* Erases the cache in flash, a restore that failed once would fail on every boot */
+static void ddr_training_cache_invalidate(void)
+{
+    memset(&ddr_training_cache, 0xFF, sizeof(ddr_training_cache));
+    if (0 != flash_fs_write_ddr_training_cache(&ddr_training_cache, sizeof(ddr_training_cache)))
+    {
+        Log_Write(LOG_LEVEL_WARNING, "DDR:[-1][txt]Failed to erase the DDR training cache\n");
+    }
+}
+
+/* Overwrites the fixed values of the skiptrain sequence with the trained ones */
+static void ddr_training_cache_restore_phy(uint32_t memshire)
+{
+    for (uint32_t reg = 0; reg < DDR_TRAINED_PHY_REGS_NUM; reg++)
+    {
+        const struct ddr_trained_phy_reg_t *cached = &ddr_training_cache.phy[reg];
+
+        ms_write_ddrc_reg(memshire, 2, ddr_trained_phy_regs[reg],
+                          cached->base + cached->offset[memshire - MEMSHIRE_BASE]);
+    }
+}
+
+/* Restores what post_train_update_regs derives from the training. These are quasi-dynamic
+   registers, phase4_02 sets sw_done again to apply them */
+static void ddr_training_cache_restore_ddrc(uint32_t memshire)
+{
+    const struct ddr_trained_ddrc_regs_t *regs = &ddr_training_cache.ddrc[memshire - MEMSHIRE_BASE];
+
+    ms_write_both_ddrc_reg(memshire, SWCTL, 0x00000000); // sw_done=0
+    ms_write_both_ddrc_reg(memshire, DFITMG1, regs->dfitmg1);
+    ms_write_ddrc_reg(memshire, 0, DRAMTMG2, regs->dramtmg2[0]);
+    ms_write_ddrc_reg(memshire, 1, DRAMTMG2, regs->dramtmg2[1]);
+}
+
+/* Quick check of a restored training: all the controllers out of init and a pattern
+   written and read back at the start of DRAM */
+static bool ddr_training_cache_verify(void)
+{
+    volatile uint64_t *dram = (volatile uint64_t *)R_L3_MCODE_BASEADDR;
+    const uint32_t words = DDR_RESTORE_VERIFY_SIZE / sizeof(uint64_t);
+    uint32_t memshire;
+    bool normal = true;
+
+    FOR_EACH_MEMSHIRE(normal = normal && ((ms_read_ddrc_reg(memshire, 0, STAT) & 0x7) == 0x1) &&
+                               ((ms_read_ddrc_reg(memshire, 1, STAT) & 0x7) == 0x1);)
+    if (!normal)
+    {
+        Log_Write(LOG_LEVEL_WARNING, "DDR:[-1][txt]Restored controllers not in normal mode\n");
+        return false;
+    }
+
+    for (uint32_t pass = 0; pass < 2; pass++)
+    {
+        uint64_t pattern = pass ? ~DDR_RESTORE_VERIFY_PATTERN : DDR_RESTORE_VERIFY_PATTERN;
+
+        for (uint32_t i = 0; i < words; i++)
+        {
+            dram[i] = (uint64_t)&dram[i] ^ pattern;
+        }
+        for (uint32_t i = 0; i < words; i++)
+        {
+            if (dram[i] != ((uint64_t)&dram[i] ^ pattern))
+            {
+                Log_Write(LOG_LEVEL_WARNING,
+                          "DDR:[-1][txt]Restored DRAM mismatch at 0x%016lx: 0x%016lx\n",
+                          (uint64_t)&dram[i], dram[i]);
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+#endif // DDR_TRAINING_CACHE
+
 int ddr_config(DDR_MODE *ddr_mode)
 {
     // algorithm/flow and config parameters are from hardware team
@@ -211,6 +545,7 @@ int ddr_config(DDR_MODE *ddr_mode)
     uint32_t ddr_density = 0;
     bool config_training;
     bool config_training_2d;
+    bool config_restore = false;
 
     // local variables
     uint32_t memshire;
@@ -250,6 +585,16 @@ int ddr_config(DDR_MODE *ddr_mode)
         1000; // unit in ns.  less than 1000ns will simply do task yield
     config_training_2d = true;
 
+#if DDR_TRAINING_CACHE
+    /* Restoring replaces the training with the skiptrain sequence and the cached registers */
+    if (config_training && !config_sim_only && ddr_mode->training_cache)
+    {
+        config_restore = ddr_training_cache_load(ddr_mode);
+        config_training = !config_restore;
+    }
+    ddr_training_cache_restored = config_restore;
+#endif
+
     Log_Write(LOG_LEVEL_DEBUG, "DDR:[-1][txt]ddr_config: config_ecc=0x%08x\n", config_ecc);
     Log_Write(LOG_LEVEL_DEBUG, "DDR:[-1][txt]ddr_config: config_real_pll=0x%08x\n",
               config_real_pll);
@@ -275,6 +620,8 @@ int ddr_config(DDR_MODE *ddr_mode)
               config_training);
     Log_Write(LOG_LEVEL_DEBUG, "DDR:[-1][txt]ddr_config: config_training_2d=0x%08x\n",
               config_training_2d);
+    Log_Write(LOG_LEVEL_DEBUG, "DDR:[-1][txt]ddr_config: config_restore=0x%08x\n",
+              config_restore);
     Log_Write(LOG_LEVEL_INFO, "DDR:[-1][txt]ddr_config: start\n");
 
     FOR_EACH_MEMSHIRE(CHECK_MEMSHIRE_ID(memshire);)
@@ -288,10 +635,19 @@ int ddr_config(DDR_MODE *ddr_mode)
                       ms_init_seq_phase2(memshire, config_real_pll);)
 
     FOR_EACH_MEMSHIRE(Log_Write(LOG_LEVEL_DEBUG, "DDR:[%d][txt]ddr_config: phase3_01\n", memshire);
-                      if (config_sim_only)
+                      if (config_sim_only || config_restore)
                           ms_init_seq_phase3_01_skiptrain(memshire, config_800mhz, config_933mhz);
                       else ms_init_seq_phase3_01(memshire, config_800mhz, config_933mhz);)
 
+#if DDR_TRAINING_CACHE
+    if (config_restore)
+    {
+        FOR_EACH_MEMSHIRE(
+            Log_Write(LOG_LEVEL_DEBUG, "DDR:[%d][txt]ddr_config: restore training\n", memshire);
+            ddr_training_cache_restore_phy(memshire); ms_set_dram_status(memshire, WORKING);)
+    }
+#endif
+
     if (config_training)
     {
         FOR_EACH_MEMSHIRE(
@@ -343,16 +699,31 @@ int ddr_config(DDR_MODE *ddr_mode)
                                   config_8gb, config_32gb);)
     }
     FOR_EACH_MEMSHIRE(Log_Write(LOG_LEVEL_DEBUG, "DDR:[%d][txt]ddr_config: phase4_01\n", memshire);
-                      if (config_sim_only)
+                      if (config_sim_only || config_restore)
                           ms_init_seq_phase4_01_skiptrain(memshire, config_800mhz, config_933mhz);
                       else ms_init_seq_phase4_01(memshire, config_800mhz, config_933mhz);)
 
+#if DDR_TRAINING_CACHE
+    if (config_restore)
+    {
+        FOR_EACH_MEMSHIRE(ddr_training_cache_restore_ddrc(memshire);)
+    }
+#endif
+
     FOR_EACH_MEMSHIRE(if (dram_status_ptr->physical_memshire_status[memshire] == WORKING) {
         Log_Write(LOG_LEVEL_DEBUG, "DDR:[%d][txt]ddr_config: phase4_02\n", memshire);
         /* Unused clocks are disabled at the end */
         ms_init_seq_phase4_02(memshire, config_auto_precharge, 0, config_training);
     })
 
+#if DDR_TRAINING_CACHE
+    if (config_restore && !ddr_training_cache_verify())
+    {
+        Log_Write(LOG_LEVEL_WARNING, "DDR:[-1][txt]ddr_config: restored training failed\n");
+        return -1;
+    }
+#endif
+
     Log_Write(LOG_LEVEL_INFO, "DDR:[-1][txt]DRAM status (bit=1: failure) = 0x%08x\n",
               dram_status_ptr->system_status);
     for (int i = 0; i < HW_NUMBER_OF_MEMSHIRE; ++i)
@@ -419,6 +790,14 @@ int ddr_config(DDR_MODE *ddr_mode)
             break;
     }
 
+#if DDR_TRAINING_CACHE
+    /* The PHY CSRs can't be read once the pclks are off */
+    if (config_training && !config_sim_only && (dram_status_ptr->system_status == 0x0))
+    {
+        ddr_training_cache_save(ddr_mode);
+    }
+#endif
+
     /* Disable the unused clocks */
     if (config_disable_unused_clks)
     {
@@ -644,7 +1023,8 @@ int32_t configure_memshire(void)
                           .capacity = DDR_CAPACITY_16GB,
                           .ecc = false,
                           .training = true,
-                          .sim_only = false };
+                          .sim_only = false,
+                          .training_cache = true };
 
     //TODO: decide ddr_mode based on, e.g. from storage
 
@@ -662,7 +1042,23 @@ int32_t configure_memshire(void)
     }
     Log_Write(LOG_LEVEL_INFO, "configure_memshire: configure_memshire_plls completed\n");
 #if !(FAST_BOOT || TEST_FRAMEWORK)
-    if (0 != ddr_config(&ddr_mode))
+    int status = ddr_config(&ddr_mode);
+#if DDR_TRAINING_CACHE
+    /* Start over and train when the restored training doesn't work */
+    if ((0 != status) && ddr_training_cache_restored)
+    {
+        Log_Write(LOG_LEVEL_WARNING, "configure_memshire: training the DDR again\n");
+        ddr_training_cache_invalidate();
+        ddr_mode.training_cache = false;
+        assert_memshire_reset();
+        if ((0 != release_memshire_from_reset()) || (0 != configure_memshire_plls(&ddr_mode)))
+        {
+            return MEMSHIRE_PLL_CONFIG_ERROR;
+        }
+        status = ddr_config(&ddr_mode);
+    }
+#endif
+    if (0 != status)
     {
         Log_Write(LOG_LEVEL_ERROR, "ddr_config() failed!\n");
         return MEMSHIRE_DDR_CONFIG_ERROR;
@@ -59,6 +59,12 @@
 #include "thermal_pwr_mgmt.h"
 #include "bl2_flash_fs.h"
 #include "noc_configuration.h"
+#include "bl2_timer.h"
+#include "bl2_firmware_loader.h"
+
+/* The broadcast PLL helpers define NOP again, spelled differently from etsoc/isa/utils.h */
+#undef NOP
+#include "hwinc/minion_lvdpll_program.h"
 
 /*!
  * @struct struct minion_event_control_block
@@ -87,6 +93,14 @@ static StaticTimer_t MM_Timer_Buffer;
 
 #define BYTES_IN_GB(x) (x * 1024UL * 1024UL * 1024UL)
 
+/*! \def MINION_BROADCAST_PLL_CONFIG
+    \brief Program the DLLs and LVDPLLs of all the shires at once with broadcast ESR writes
+    instead of shire by shire, and poll their lock status together
+*/
+#ifndef MINION_BROADCAST_PLL_CONFIG
+#define MINION_BROADCAST_PLL_CONFIG 1
+#endif
+
 /* Macro for encoding the DRAM size for MPROT */
 #define MPROT_ENCODE_DDR_SIZE(size_in_bytes, encoded_value) \
     {                                                       \
@@ -357,6 +371,105 @@ static uint8_t get_highest_set_bit_offset(uint64_t shire_mask)
                       ETSOC_SHIRE_OTHER_ESR_DEBUG_CLK_GATE_CTRL_BYTE_ADDRESS, 0x1, 0); \
     }
 
+#if MINION_BROADCAST_PLL_CONFIG
+/************************************************************************
+*
+*   FUNCTION
+*
+*       wait_for_shires_lock
+*
+*   DESCRIPTION
+*
+*       This function polls the DLL or PLL lock status of all the shires
+*       in the mask together, under a single timeout
+*
+*   INPUTS
+*
+*       shire_mask shires to be polled
+*       dll        poll the DLLs instead of the PLLs
+*
+*   OUTPUTS
+*
+*       Mask of the shires that did not lock
+*
+***********************************************************************/
+static uint64_t wait_for_shires_lock(uint64_t shire_mask, bool dll)
+{
+    const uint32_t address = dll ? ETSOC_SHIRE_OTHER_ESR_SHIRE_DLL_READ_DATA_ADDRESS :
+                                   ETSOC_SHIRE_OTHER_ESR_SHIRE_PLL_READ_DATA_ADDRESS;
+    uint64_t pending = shire_mask;
+
+    for (int timeout = LOCK_TIMEOUT; (0 != pending) && (timeout > 0); timeout--)
+    {
+        uint64_t mask = pending;
+        while (0 != mask)
+        {
+            const uint8_t shire_id = (uint8_t)__builtin_ctzl(mask);
+            const uint64_t value = read_esr_new(PP_MACHINE, shire_id, REGION_OTHER,
+                                                ESR_OTHER_SUBREGION_OTHER, address, 0);
+            const bool locked = dll ? ETSOC_SHIRE_OTHER_ESR_SHIRE_DLL_READ_DATA_LOCKED_GET(value) :
+                                      ETSOC_SHIRE_OTHER_ESR_SHIRE_PLL_READ_DATA_LOCKED_GET(value);
+            if (locked)
+            {
+                pending &= ~(1ULL << shire_id);
+            }
+            mask &= mask - 1;
+        }
+    }
+
+    return pending;
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       clear_shires_lock_monitor
+*
+*   DESCRIPTION
+*
+*       This function clears the LVDPLL lock monitors of all the shires
+*       in the mask with broadcast writes
+*
+*   INPUTS
+*
+*       shire_mask shires to be cleared
+*       num_shires offset of the highest shire in the mask plus one
+*
+*   OUTPUTS
+*
+*       The function call status, pass/fail
+*
+***********************************************************************/
+static int clear_shires_lock_monitor(uint64_t shire_mask, uint8_t num_shires)
+{
+    int status;
+
+    /* Enable PLL auto config */
+    pll_broadcast_req(PP_MACHINE, REGION_OTHER, ETSOC_SHIRE_OTHER_ESR_SHIRE_PLL_AUTO_CONFIG_ADDRESS,
+                      shire_mask,
+                      ETSOC_SHIRE_OTHER_ESR_SHIRE_PLL_AUTO_CONFIG_PCLK_SEL_SET(2) |
+                          ETSOC_SHIRE_OTHER_ESR_SHIRE_PLL_AUTO_CONFIG_REG_FIRST_SET(0x19) |
+                          ETSOC_SHIRE_OTHER_ESR_SHIRE_PLL_AUTO_CONFIG_ENABLE_SET(0x1));
+
+    pll_broadcast_req(PP_MACHINE, REGION_OTHER,
+                      ETSOC_SHIRE_OTHER_ESR_SHIRE_PLL_CONFIG_DATA_0_ADDRESS, shire_mask, 0x3);
+    status = pll_broadcast_register_write(0x19, 0x0, shire_mask, num_shires, true);
+    if (0 == status)
+    {
+        pll_broadcast_req(PP_MACHINE, REGION_OTHER,
+                          ETSOC_SHIRE_OTHER_ESR_SHIRE_PLL_CONFIG_DATA_0_ADDRESS, shire_mask, 0x0);
+        status = pll_broadcast_register_write(0x19, 0x0, shire_mask, num_shires, true);
+    }
+
+    /* Disable the PLL auto config */
+    pll_broadcast_req(PP_MACHINE, REGION_OTHER, ETSOC_SHIRE_OTHER_ESR_SHIRE_PLL_AUTO_CONFIG_ADDRESS,
+                      shire_mask, ETSOC_SHIRE_OTHER_ESR_SHIRE_PLL_AUTO_CONFIG_PCLK_SEL_SET(2));
+
+    return status;
+}
+#endif
+
 /************************************************************************
 *
 *   FUNCTION
@@ -390,6 +503,25 @@ static int minion_configure_plls_and_dlls(uint64_t shire_mask, uint8_t mode)
     {
         return MINION_INVALID_SHIRE_MASK;
     }
+#if MINION_BROADCAST_PLL_CONFIG
+    /* All the shires get the same settings, so all the PLLs are programmed with broadcast
+       writes and lock concurrently, the shires switch to the PLL output once all are locked */
+    if (0 != update_minion_pll_freq_full(mode, shire_mask, num_shires))
+    {
+        status = MINION_PLL_CONFIG_ERROR;
+        pll_fail_mask = wait_for_shires_lock(shire_mask, false);
+
+        /* The shires whose PLL locked still switch to it, the others stay on the step clock */
+        if (0 != (shire_mask & ~pll_fail_mask))
+        {
+            pll_broadcast_req(PP_MACHINE, REGION_OTHER,
+                              ETSOC_SHIRE_OTHER_ESR_SHIRE_CTRL_CLOCKMUX_ADDRESS,
+                              shire_mask & ~pll_fail_mask, SELECT_PLL_CLOCK_0);
+        }
+    }
+
+    clear_shires_lock_monitor(shire_mask, num_shires);
+#else
     for (uint8_t i = 0; i <= num_shires; i++)
     {
         if (shire_mask & 1)
@@ -410,6 +542,7 @@ static int minion_configure_plls_and_dlls(uint64_t shire_mask, uint8_t mode)
         }
         shire_mask >>= 1;
     }
+#endif
     if (status != SUCCESS)
     {
         Log_Write(LOG_LEVEL_ERROR, "minion_configure_plls_and_dlls(): PLL failed mask %lu!\n",
@@ -862,6 +995,12 @@ int Master_Minion_Reset(void)
     UPDATE_ALL_SHIRE(shiremask, CONFIG_SHIRE_NEIGH, 0 /* Disable SC */, 0x0 /* Disable all Neigh */,
                      false, false)
 
+    /* Start MM from the image verified at boot, not from the data of the previous run */
+    if (0 != restore_master_minion_firmware())
+    {
+        Log_Write(LOG_LEVEL_WARNING, "Master_Minion_Reset: no MM firmware copy to restore\n");
+    }
+
     shiremask = Minion_State_MM_Iface_Get_Active_Shire_Mask();
 
     /* Enable Minion neighs. Master shire threads will be enabled later below and
@@ -1125,6 +1264,21 @@ int Minion_Configure_Minion_Shire_PLL(uint64_t minion_shires_mask, uint8_t hpdpl
         return MINION_INVALID_SHIRE_MASK;
     }
 
+#if MINION_BROADCAST_PLL_CONFIG
+    (void)num_shires;
+    if (0 == gs_dlls_initialized)
+    {
+        /* Select ref clock for the DLL input and enable the DLLs of all the shires at once */
+        pll_broadcast_req(PP_MACHINE, REGION_OTHER,
+                          ETSOC_SHIRE_OTHER_ESR_SHIRE_CTRL_CLOCKMUX_ADDRESS, shire_mask,
+                          SELECT_REF_CLOCK);
+        pll_broadcast_req(PP_MACHINE, REGION_OTHER,
+                          ETSOC_SHIRE_OTHER_ESR_SHIRE_DLL_AUTO_CONFIG_ADDRESS, shire_mask,
+                          ETSOC_SHIRE_OTHER_ESR_SHIRE_DLL_AUTO_CONFIG_PCLK_SEL_SET(2) |
+                              ETSOC_SHIRE_OTHER_ESR_SHIRE_DLL_AUTO_CONFIG_DLL_ENABLE_SET(0x1));
+        dll_fail_mask = wait_for_shires_lock(shire_mask, true);
+    }
+#else
     for (uint8_t i = 0; i <= num_shires; i++)
     {
         if ((shire_mask & 1) && (0 == gs_dlls_initialized))
@@ -1137,6 +1291,7 @@ int Minion_Configure_Minion_Shire_PLL(uint64_t minion_shires_mask, uint8_t hpdpl
         }
         shire_mask >>= 1;
     }
+#endif
 
     if (0 != dll_fail_mask)
     {
@@ -1348,6 +1503,8 @@ uint64_t Minion_Get_Active_Compute_Minion_Mask(void)
 ***********************************************************************/
 int Minion_Load_Authenticate_Firmware(void)
 {
+    uint64_t start_ticks = timer_get_ticks_count();
+
     if (0 != load_sw_certificates_chain())
     {
         Log_Write(LOG_LEVEL_ERROR, "Failed to load SW ROOT/Issuing Certificate chain!\n");
@@ -1374,6 +1531,8 @@ int Minion_Load_Authenticate_Firmware(void)
         return FW_CM_LOAD_ERROR;
     }
     Log_Write(LOG_LEVEL_INFO, "WM FW loaded.\n");
+    Log_Write(LOG_LEVEL_CRITICAL, "Minion firmware loaded in %lu ticks.\n",
+              timer_get_ticks_count() - start_ticks);
 
     return SUCCESS;
 }
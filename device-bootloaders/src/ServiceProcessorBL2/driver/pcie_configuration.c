@@ -110,6 +110,11 @@ static void reconfig_noc_pshire(void);
 */
 #define MSI_FOUR_VECTORS 0x2
 
+/*! \def MSI_EIGHT_VECTORS
+    \brief MSI eight vector enable
+*/
+#define MSI_EIGHT_VECTORS 0x3
+
 /* The driver can populate this structure with the defaults that will be used during the init
     phase.*/
 
@@ -456,10 +461,11 @@ static void pcie_init_ints(void)
     msi_ctrl = (uint32_t)
         PE0_DWC_EP_PCIE_CTL_DBI_SLAVE_PF0_MSI_CAP_PCI_MSI_CAP_ID_NEXT_CTRL_REG_PCI_MSI_ENABLE_MODIFY(
             msi_ctrl, 1);
-    /* Request 4 interrupt vectors (2 each for Management and Ops node) */
+    /* Request 8 interrupt vectors (2 for Management, 1 for Ops SQs and up to 5 for Ops CQs),
+    the host enables 4 of them at least */
     msi_ctrl = (uint32_t)
         PE0_DWC_EP_PCIE_CTL_DBI_SLAVE_PF0_MSI_CAP_PCI_MSI_CAP_ID_NEXT_CTRL_REG_PCI_MSI_MULTIPLE_MSG_CAP_MODIFY(
-            msi_ctrl, MSI_FOUR_VECTORS);
+            msi_ctrl, MSI_EIGHT_VECTORS);
     msi_ctrl = (uint32_t)
         PE0_DWC_EP_PCIE_CTL_DBI_SLAVE_PF0_MSI_CAP_PCI_MSI_CAP_ID_NEXT_CTRL_REG_PCI_MSI_MULTIPLE_MSG_EN_MODIFY(
             msi_ctrl, MSI_FOUR_VECTORS);
@@ -26,6 +26,7 @@
         pmic_disable_etsoc_reset_after_perst
         pmic_get_reset_cause
         pmic_get_voltage
+        pmic_get_module_voltages
         pmic_set_voltage
         pmic_get_minion_group_voltage
         pmic_set_minion_group_voltage
@@ -159,6 +160,32 @@ static void set_pmic_i2c_dev(void)
     g_pmic_i2c_dev_reg.isInitialized = false;
 }
 
+/************************************************************************
+*
+*   FUNCTION
+*
+*       pmic_i2c_isr
+*
+*   DESCRIPTION
+*
+*       This function is the ISR of the PMIC I2C controller, serving the
+*       interrupt driven transfers.
+*
+*   INPUTS
+*
+*       none
+*
+*   OUTPUTS
+*
+*       none
+*
+***********************************************************************/
+
+static void pmic_i2c_isr(void)
+{
+    i2c_isr(&g_pmic_i2c_dev_reg);
+}
+
 /************************************************************************
 *
 *   FUNCTION
@@ -353,6 +380,66 @@ static int set_pmic_reg(uint8_t reg, const uint8_t *value, uint8_t reg_size)
     return 0;
 }
 
+/************************************************************************
+*
+*   FUNCTION
+*
+*       get_pmic_regs
+*
+*   DESCRIPTION
+*
+*       This function reads consecutive PMIC registers via I2C, in a single
+*       interrupt driven transaction. The calling task is blocked, instead of
+*       holding the SP in a critical section. Before the scheduler starts, it
+*       falls back to the polled get_pmic_reg().
+*
+*   INPUTS
+*
+*       reg        address of the first register
+*       size       bytes to read
+*
+*   OUTPUTS
+*
+*       reg_values values of the registers
+*
+***********************************************************************/
+
+static int get_pmic_regs(uint8_t reg, uint8_t *reg_values, uint16_t size)
+{
+    int retries = 3;
+    int status = STATUS_SUCCESS;
+
+    do
+    {
+        status = i2c_burst_read(&g_pmic_i2c_dev_reg, reg, reg_values, size);
+        if ((status == ET_I2C_ERROR_IRQ_NOT_ENABLED) && (size <= UINT8_MAX))
+        {
+            return get_pmic_reg(reg, reg_values, (uint8_t)size);
+        }
+        else if (status != STATUS_SUCCESS)
+        {
+            Log_Write(
+                LOG_LEVEL_DEBUG,
+                "get_pmic_regs: PMIC read reg: %d failed, status: %d! Resetting I2C and retrying.\r\n",
+                reg, status);
+            status = i2c_soft_reset(&g_pmic_i2c_dev_reg);
+        }
+        else
+        {
+            break;
+        }
+    } while ((--retries) && (status == STATUS_SUCCESS));
+
+    if (STATUS_SUCCESS != status)
+    {
+        Log_Write(LOG_LEVEL_ERROR, "get_pmic_regs: PMIC read reg: %d failed, status: %d!\n", reg,
+                  status);
+        return ERROR_PMIC_I2C_READ_FAILED;
+    }
+
+    return 0;
+}
+
 /************************************************************************
 *
 *   FUNCTION
@@ -378,21 +465,21 @@ static int pmic_get_pmb_rstat(struct pmb_reading_type_t *stat_reading)
     int status = STATUS_SUCCESS;
     uint32_t temp_val = 0;
 
-    status = get_pmic_reg(PMIC_I2C_PMB_RW_ADDRESS, (uint8_t *)&temp_val, PMB_READ_BYTES);
+    status = get_pmic_regs(PMIC_I2C_PMB_RW_ADDRESS, (uint8_t *)&temp_val, PMB_READ_BYTES);
     if (status == STATUS_SUCCESS)
     {
         stat_reading->current = (temp_val & PMB_STATS_MASK);
-        status = get_pmic_reg(PMIC_I2C_PMB_RW_ADDRESS, (uint8_t *)&temp_val, PMB_READ_BYTES);
+        status = get_pmic_regs(PMIC_I2C_PMB_RW_ADDRESS, (uint8_t *)&temp_val, PMB_READ_BYTES);
     }
     if (status == STATUS_SUCCESS)
     {
         stat_reading->min = (temp_val & PMB_STATS_MASK);
-        status = get_pmic_reg(PMIC_I2C_PMB_RW_ADDRESS, (uint8_t *)&temp_val, PMB_READ_BYTES);
+        status = get_pmic_regs(PMIC_I2C_PMB_RW_ADDRESS, (uint8_t *)&temp_val, PMB_READ_BYTES);
     }
     if (status == STATUS_SUCCESS)
     {
         stat_reading->max = (temp_val & PMB_STATS_MASK);
-        status = get_pmic_reg(PMIC_I2C_PMB_RW_ADDRESS, (uint8_t *)&temp_val, PMB_READ_BYTES);
+        status = get_pmic_regs(PMIC_I2C_PMB_RW_ADDRESS, (uint8_t *)&temp_val, PMB_READ_BYTES);
     }
     if (status == STATUS_SUCCESS)
     {
@@ -483,6 +570,12 @@ void setup_pmic(void)
         MESSAGE_ERROR("PMIC connection failed to establish link\n");
     }
 
+    /* Telemetry is read with interrupt driven transfers once the scheduler runs */
+    if (0 != i2c_enable_irq(&g_pmic_i2c_dev_reg, SPIO_PLIC_I2C0_INTR, pmic_i2c_isr))
+    {
+        MESSAGE_ERROR("Failed to enable PMIC I2C interrupt!");
+    }
+
     /* Configure and enable GPIO interrupt */
     if (0 != gpio_config_interrupt(GPIO_CONTROLLER_ID_SPIO, PMIC_GPIO_INT_PIN_NUMBER, GPIO_INT_EDGE,
                                    GPIO_INT_LOW, GPIO_INT_DEBOUNCE_OFF))
@@ -1499,6 +1592,51 @@ int pmic_get_voltage(module_e voltage_type, uint8_t *voltage)
     }
 }
 
+/************************************************************************
+*
+*   FUNCTION
+*
+*       pmic_get_module_voltages
+*
+*   DESCRIPTION
+*
+*       This function returns the voltage settings of all the modules, read
+*       in a single burst from the consecutive voltage registers, VDDQLP to
+*       Minion.
+*
+*   INPUTS
+*
+*       none
+*
+*   OUTPUTS
+*
+*       module_voltage    voltage values (binary encoded)
+*
+***********************************************************************/
+
+int pmic_get_module_voltages(struct module_voltage_t *module_voltage)
+{
+    uint8_t regs[PMIC_I2C_MINION_ALL_VOLTAGE_ADDRESS - PMIC_I2C_VDDQLP_VOLTAGE_ADDRESS + 1];
+    int status = get_pmic_regs(PMIC_I2C_VDDQLP_VOLTAGE_ADDRESS, regs, sizeof(regs));
+
+    if (status == STATUS_SUCCESS)
+    {
+#define PMIC_MODULE_VOLTAGE(reg) regs[(reg) - PMIC_I2C_VDDQLP_VOLTAGE_ADDRESS]
+        module_voltage->ddr = PMIC_MODULE_VOLTAGE(PMIC_I2C_DDR_VOLTAGE_ADDRESS);
+        module_voltage->l2_cache = PMIC_MODULE_VOLTAGE(PMIC_I2C_L2_CACHE_VOLTAGE_ADDRESS);
+        module_voltage->maxion = PMIC_MODULE_VOLTAGE(PMIC_I2C_MAXION_VOLTAGE_ADDRESS);
+        module_voltage->minion = PMIC_MODULE_VOLTAGE(PMIC_I2C_MINION_ALL_VOLTAGE_ADDRESS);
+        module_voltage->pcie = PMIC_MODULE_VOLTAGE(PMIC_I2C_PCIE_VOLTAGE_ADDRESS);
+        module_voltage->noc = PMIC_MODULE_VOLTAGE(PMIC_I2C_NOC_VOLTAGE_ADDRESS);
+        module_voltage->pcie_logic = PMIC_MODULE_VOLTAGE(PMIC_I2C_PCIE_LOGIC_VOLTAGE_ADDRESS);
+        module_voltage->vddqlp = PMIC_MODULE_VOLTAGE(PMIC_I2C_VDDQLP_VOLTAGE_ADDRESS);
+        module_voltage->vddq = PMIC_MODULE_VOLTAGE(PMIC_I2C_VDDQ_VOLTAGE_ADDRESS);
+#undef PMIC_MODULE_VOLTAGE
+    }
+
+    return status;
+}
+
 static int pmic_validate_voltage(module_e voltage_type, uint8_t voltage)
 {
 #if !FAST_BOOT
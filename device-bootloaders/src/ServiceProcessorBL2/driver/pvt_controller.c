@@ -4,10 +4,14 @@
 * SPDX-License-Identifier: Apache-2.0
 *
 ************************************************************************/
+#include <stdbool.h>
 #include "bl2_pvt_controller.h"
 #include "log.h"
 #include <hwinc/sp_pvt0.h>
 #include "hwinc/hal_device.h"
+#include "hwinc/sp_plic.h"
+#include "etsoc/isa/io.h"
+#include <interrupt.h>
 
 /*! \def MAX(x,y)
     \brief Returns max
@@ -359,6 +363,9 @@ static PVTC_VM_mapping pvtc_ext_analog_vm_map[PVTC_EXT_ANALOG_VM_NUM] = { { // E
 /* Global representing the bad Minion shire mask */
 static uint64_t pvt_bad_min_shire_mask = 0;
 
+/* Called from the PVT ISR when a TS alarm fires */
+static void (*pvt_ts_alarm_cb)(void) = NULL;
+
 static void pvt_configure_controller(uint8_t pvt_id)
 {
     /* Disable unsused TS IPs */
@@ -584,6 +591,26 @@ static int16_t pvt_ts_conversion(uint16_t ts_sample)
     return (int16_t)result;
 }
 
+static uint16_t pvt_ts_inverse_conversion(uint8_t temperature_c)
+{
+    int result;
+    uint8_t run_mode = PVT_TS_RUN_MODE;
+
+    if (run_mode == PVT_TS_RUN_MODE_RUN_1)
+    {
+        int g = PVT_TS_G_PARAMETER;
+        int h = PVT_TS_H_PARAMETER;
+        int cal5 = PVT_TS_CAL5_PARAMETER;
+        result = ((temperature_c * 1000 - g + h / 2) * cal5) / h;
+    }
+    else
+    {
+        result = temperature_c;
+    }
+
+    return (uint16_t)((result < 0) ? 0 : result);
+}
+
 static uint16_t pvt_pd_conversion(uint16_t pd_sample)
 {
     uint16_t result;
@@ -1104,6 +1131,98 @@ int pvt_init(void)
     return 0;
 }
 
+static void pvt_ts_alarm_isr(void)
+{
+    uint32_t ulMaxID = ioread32(R_SP_PLIC_BASEADDR + SPIO_PLIC_MAXID_T0_ADDRESS);
+    uint32_t ts_status;
+    uint8_t pvt_id;
+    bool alarm = false;
+
+    if ((ulMaxID < SPIO_PLIC_PVTC0_INTR) || (ulMaxID > SPIO_PLIC_PVTC4_INTR))
+    {
+        Log_Write(LOG_LEVEL_CRITICAL, "Wrong interrupt handler");
+        return;
+    }
+    pvt_id = (uint8_t)(ulMaxID - SPIO_PLIC_PVTC0_INTR);
+
+    ts_status = IRQ_IRQ_TS_STATUS_STATUS_GET(pReg_Pvtc[pvt_id]->irq.irq_ts_status);
+    for (uint8_t i = 0; i < PVTC_TS_NUM; i++)
+    {
+        if ((ts_status >> i) & 1U)
+        {
+            if (TS_PD_INDIVIDUAL_IP_IRQ_STATUS_IRQ_STATUS_ALARMA_GET(
+                    pReg_Pvtc[pvt_id]->ts.ts_individual[i].irq_status))
+            {
+                alarm = true;
+            }
+            pReg_Pvtc[pvt_id]->ts.ts_individual[i].irq_clr =
+                TS_PD_INDIVIDUAL_IP_IRQ_CLR_IRQ_CLR_ALARMA_SET(0x1u);
+        }
+    }
+
+    if (alarm && (pvt_ts_alarm_cb != NULL))
+    {
+        pvt_ts_alarm_cb();
+    }
+}
+
+int pvt_set_temperature_alarm_threshold(uint8_t threshold_c)
+{
+    uint32_t alarm_cfg;
+    uint8_t hyst_c = (threshold_c > PVT_TS_ALARM_HYSTERESIS_C) ?
+                         (uint8_t)(threshold_c - PVT_TS_ALARM_HYSTERESIS_C) :
+                         0;
+
+    /* The alarm asserts over the threshold and deasserts under the hysteresis one */
+    alarm_cfg =
+        TS_PD_INDIVIDUAL_IP_ALARMA_CFG_ALARM_THRESH_SET(pvt_ts_inverse_conversion(threshold_c)) |
+        TS_PD_INDIVIDUAL_IP_ALARMA_CFG_HYST_THRESH_SET(pvt_ts_inverse_conversion(hyst_c));
+
+    for (uint8_t pvt_id = 0; pvt_id < PVTC_NUM; pvt_id++)
+    {
+        for (uint8_t i = 0; i < PVTC_TS_NUM; i++)
+        {
+            if (!((pvtc_ip_disable_mask[pvt_id].ts_disable_mask >> i) & 1U))
+            {
+                pReg_Pvtc[pvt_id]->ts.ts_individual[i].alarma_cfg = alarm_cfg;
+            }
+        }
+    }
+
+    return 0;
+}
+
+int pvt_enable_temperature_alarm(uint8_t threshold_c, void (*alarm_cb)(void))
+{
+    pvt_ts_alarm_cb = alarm_cb;
+
+    pvt_set_temperature_alarm_threshold(threshold_c);
+
+    for (uint8_t pvt_id = 0; pvt_id < PVTC_NUM; pvt_id++)
+    {
+        for (uint8_t i = 0; i < PVTC_TS_NUM; i++)
+        {
+            if (!((pvtc_ip_disable_mask[pvt_id].ts_disable_mask >> i) & 1U))
+            {
+                pReg_Pvtc[pvt_id]->ts.ts_individual[i].irq_clr =
+                    TS_PD_INDIVIDUAL_IP_IRQ_CLR_IRQ_CLR_ALARMA_SET(0x1u);
+                pReg_Pvtc[pvt_id]->ts.ts_individual[i].irq_enable =
+                    TS_PD_INDIVIDUAL_IP_IRQ_ENABLE_IRQ_EN_ALARMA_SET(0x1u);
+            }
+        }
+
+        /* Mask the unused TSs and route the TS interrupts to the PLIC */
+        pReg_Pvtc[pvt_id]->irq.irq_ts_mask =
+            IRQ_IRQ_TS_MASK_MASK_SET(pvtc_ip_disable_mask[pvt_id].ts_disable_mask);
+        pReg_Pvtc[pvt_id]->irq.irq_en =
+            pReg_Pvtc[pvt_id]->irq.irq_en | IRQ_IRQ_EN_TS_IRQ_ENBALE_SET(0x1u);
+
+        INT_enableInterrupt(SPIO_PLIC_PVTC0_INTR + pvt_id, 1, pvt_ts_alarm_isr);
+    }
+
+    return 0;
+}
+
 static void pvt_print_ioshire_temperature_sampled_values(void)
 {
     int ret;
@@ -12,6 +12,7 @@
 
     Public interfaces:
         release_memshire_from_reset
+        assert_memshire_reset
         release_minions_from_cold_reset
         release_minions_from_warm_reset
         release_etsoc_reset
@@ -62,6 +63,15 @@ int release_memshire_from_reset(void)
     return 0;
 }
 
+int assert_memshire_reset(void)
+{
+    iowrite32(R_SP_CRU_BASEADDR + RESET_MANAGER_RM_MEMSHIRE_WARM_ADDRESS, 0);
+    iowrite32(R_SP_CRU_BASEADDR + RESET_MANAGER_RM_MEMSHIRE_COLD_ADDRESS,
+              RESET_MANAGER_RM_MEMSHIRE_COLD_RSTN_SET(0x00));
+
+    return 0;
+}
+
 int release_minions_from_cold_reset(void)
 {
     iowrite32(R_SP_CRU_BASEADDR + RESET_MANAGER_RM_MINION_ADDRESS,
@@ -440,9 +440,20 @@ static int spi_controller_rx32_data(uintptr_t spi_regs, const uint8_t *spi_comma
             {
                 read_value.u32 = reverse_endian(ioread32(spi_regs + SSI_DR0_ADDRESS));
 
-                ALIGN_START_ADDRESS(data, data_size, read_value.u8, skip_read_size)
-
-                MEM_COPY_DATA(data, data_size, rx_data, rx_data_size)
+                if ((0 == skip_read_size) && (rx_data_size >= 4))
+                {
+                    /* no more bytes to skip, so the frames land aligned: store them
+                       whole, it is one write instead of four when rx_data is in DRAM */
+                    *(uint32_t *)(void *)rx_data = read_value.u32;
+                    rx_data += 4;
+                    rx_data_size -= 4;
+                }
+                else
+                {
+                    ALIGN_START_ADDRESS(data, data_size, read_value.u8, skip_read_size)
+
+                    MEM_COPY_DATA(data, data_size, rx_data, rx_data_size)
+                }
 
                 read_frames--;
                 timeout = 0;
@@ -463,7 +463,7 @@ int spi_flash_fast_read(SPI_FLASH_ID_t flash_id, uint32_t address, uint8_t *data
         command.dummy_bytes = 1;
         command.data_receive = true;
         command.address = address;
-        command.data_size = data_buffer_size;
+        command.data_size = read_size;
         command.data_buffer = data_buffer;
 
         if (0 != spi_controller_command(controller_id, slave_index, &command))
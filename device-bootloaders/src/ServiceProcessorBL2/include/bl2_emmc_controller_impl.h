@@ -75,6 +75,9 @@ typedef struct EMMC_DEVICE
     Emmc *regs;
     StaticSemaphore_t lock;
     SemaphoreHandle_t lock_handle;
+    StaticSemaphore_t xfer_done;
+    SemaphoreHandle_t xfer_done_handle;
+    bool irqEnabled;
 
 } ET_EMMC_DEV_t;
 
@@ -149,6 +152,14 @@ enum emmc_command_type
 #define ADMA2_ATTR_LINK 0x6
 #define ADMA2_LEN_OFF   0x6
 #define ADMA2_ADR_OFF   32
+// descriptor lengths are 16 bits wide, HOST_CTRL2_R.ADMA2_LEN_MODE is not set
+#define ADMA2_MAX_DESC_LEN 0xFFFFu
+// descriptors of a single command, the table is the first 2KB of PU SRAM LO
+#define ADMA2_MAX_DESCRIPTORS 128
+// time given to an ADMA2 transfer to complete
+#define ADMA2_XFER_TIMEOUT_MS 10000
+// reads smaller than this are done by the CPU through a bounce buffer
+#define ADMA2_MIN_READ_BLOCKS 8
 
 // eMMC frequency and dividers
 // for PLL1 = 2GHz
@@ -23,6 +23,13 @@
     \returns none
 */
 int load_firmware(const ESPERANTO_IMAGE_TYPE_t image_type);
+
+/*! \fn int restore_master_minion_firmware(void)
+    \brief Copies the Master Minion image verified by load_firmware back to its
+    load addresses, for MM resets. The MM threads must be stopped.
+    \returns 0 on success, -1 when there is no verified copy
+*/
+int restore_master_minion_firmware(void);
 ESPERANTO_IMAGE_FILE_HEADER_t *get_master_minion_image_file_header(void);
 ESPERANTO_IMAGE_FILE_HEADER_t *get_worker_minion_image_file_header(void);
 ESPERANTO_IMAGE_FILE_HEADER_t *get_machine_minion_image_file_header(void);
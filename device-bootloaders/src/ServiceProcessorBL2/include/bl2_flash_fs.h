@@ -106,6 +106,8 @@ int flash_fs_erase_partition(uint32_t partition_address, uint32_t partition_size
 
 /*! \fn int flash_fs_update_partition(void *buffer, uint64_t buffer_size, uint32_t chunk_size)
     \brief This function erase the data inside flash partition and writes new data.
+           Blocks which already hold their data are skipped, blocks already erased are not
+           erased again and blank chunks are not programmed.
     \param buffer - data to be written
     \param buffer_size - size of the data buffer
     \param chunk_size - size of data to be written to flash at the time (up to 256B)
@@ -360,6 +362,35 @@ int flash_fs_get_fw_release_rev(char *fw_release_rev);
 */
 int flash_fs_write_config_region(uint32_t partition, bool write_non_persistant);
 
+/*! \def FLASH_FS_DDR_TRAINING_CACHE_MAX_SIZE
+    \brief Space for the DDR training cache at the end of the config region sector
+*/
+#define FLASH_FS_DDR_TRAINING_CACHE_MAX_SIZE 960U
+
+/*! \def FLASH_FS_DDR_TRAINING_CACHE_OFFSET
+    \brief Offset of the DDR training cache in the config region sector, past the config data
+*/
+#define FLASH_FS_DDR_TRAINING_CACHE_OFFSET \
+    (SPI_FLASH_SECTOR_SIZE - FLASH_FS_DDR_TRAINING_CACHE_MAX_SIZE)
+
+/*! \fn int flash_fs_read_ddr_training_cache(void *buffer, uint32_t size)
+    \brief This function reads the DDR training cache from the config region of the active
+           partition. The content is not validated.
+    \param buffer - buffer to hold the cache
+    \param size - size of the cache, at most FLASH_FS_DDR_TRAINING_CACHE_MAX_SIZE
+    \return The function call status, pass/fail.
+*/
+int flash_fs_read_ddr_training_cache(void *buffer, uint32_t size);
+
+/*! \fn int flash_fs_write_ddr_training_cache(const void *buffer, uint32_t size)
+    \brief This function writes the DDR training cache to the config region of the active
+           partition, preserving the config data.
+    \param buffer - cache to write
+    \param size - size of the cache, at most FLASH_FS_DDR_TRAINING_CACHE_MAX_SIZE
+    \return The function call status, pass/fail.
+*/
+int flash_fs_write_ddr_training_cache(const void *buffer, uint32_t size);
+
 /*! \fn int flash_fs_update_shire_cache_config(uint16_t scp_size, uint16_t l2_size, uint16_t l3_size)
 
     \brief This function updates the shire cache configuration with supplied parameters.
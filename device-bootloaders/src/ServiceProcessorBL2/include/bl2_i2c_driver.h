@@ -16,6 +16,24 @@
 #include "FreeRTOS.h"
 #include "portmacro.h"
 #include "semphr.h"
+#include "interrupt.h"
+
+/*!
+ * @struct struct ET_I2C_XFER
+ * @brief State of an interrupt driven transfer, shared with the I2C ISR
+ */
+typedef struct ET_I2C_XFER
+{
+    const uint8_t *txDataBuff;
+    uint8_t *rxDataBuff;
+    uint16_t dataCount; /* data bytes of the transfer, register address excluded */
+    uint16_t cmdIssued; /* data commands pushed to the TX FIFO so far */
+    uint16_t rxCount;   /* bytes drained from the RX FIFO so far */
+    uint16_t txDepth;
+    uint16_t rxDepth;
+    bool read;
+    volatile int32_t status;
+} ET_I2C_XFER_t;
 
 /*!
  * @struct struct ET_I2C_DEV
@@ -27,6 +45,10 @@ typedef struct ET_I2C_DEV
     bool isInitialized;
     StaticSemaphore_t bus_lock;
     SemaphoreHandle_t bus_lock_handle;
+    bool irqEnabled;
+    StaticSemaphore_t xfer_done;
+    SemaphoreHandle_t xfer_done_handle;
+    ET_I2C_XFER_t xfer;
 } ET_I2C_DEV_t;
 
 /*!
@@ -56,7 +78,7 @@ typedef enum ET_I2C_SPEED
  */
 enum ET_I2C_ERROR_CODES
 {
-
+    ET_I2C_ERROR_BAD_LENGTH = -1100,
     ET_I2C_ERROR_DEV_ALREADY_INITIALIZED = -1000,
     ET_I2C_ERROR_DEV_NOT_INITIALIZED = -900,
     ET_I2C_ERROR_SPEED_BAD_VALUE = -800,
@@ -65,6 +87,8 @@ enum ET_I2C_ERROR_CODES
     ET_I2C_ERROR_TIMEOUT = -500,
     ET_I2C_ERROR_DISABLE_FAILED = -400,
     ET_I2C_ERROR_ABORT_FAILED = -300,
+    ET_I2C_ERROR_IRQ_NOT_ENABLED = -200,
+    ET_I2C_ERROR_TX_ABORT = -100,
     ET_I2C_OK = 0
 };
 
@@ -124,3 +148,66 @@ int i2c_disable(ET_I2C_DEV_t *dev);
     \return Status indicating success or negative error
 */
 int i2c_soft_reset(ET_I2C_DEV_t *dev);
+
+/*! \fn int i2c_enable_irq(ET_I2C_DEV_t *dev, interrupt_t irq, void (*isr)(void))
+    \brief This function enables interrupt driven transfers on an initialized I2C
+    controller. The owner of the controller provides the ISR, which only calls
+    i2c_isr() with the device control block.
+    \param dev pointer to I2C device control block
+    \param irq PLIC interrupt of the controller
+    \param isr interrupt handler of the controller
+    \return Status indicating success or negative error
+*/
+int i2c_enable_irq(ET_I2C_DEV_t *dev, interrupt_t irq, void (*isr)(void));
+
+/*! \fn void i2c_isr(ET_I2C_DEV_t *dev)
+    \brief Interrupt handler of interrupt driven transfers. It refills the TX FIFO,
+    drains the RX FIFO and completes the transfer on STOP or abort.
+    \param dev pointer to I2C device control block
+*/
+void i2c_isr(ET_I2C_DEV_t *dev);
+
+/*! \fn int i2c_read_start(ET_I2C_DEV_t *dev, uint8_t regAddr, uint8_t *rxDataBuff, uint16_t rxDataCount)
+    \brief Starts an interrupt driven read of consecutive bytes from the I2C slave, in a
+    single transaction. The bus is held until i2c_transfer_wait() is called by the same
+    task, which can do other work meanwhile. The PMIC ready back pressure is checked once
+    before the transaction, not before each byte as the polled transfers do.
+    \param dev pointer to I2C device control block
+    \param regAddr address of the first register
+    \param rxDataBuff buffer for rx data, valid until the transfer completes
+    \param rxDataCount data size
+    \return Status indicating success or negative error, ET_I2C_ERROR_IRQ_NOT_ENABLED
+    if the interrupt isn't enabled or the scheduler isn't running
+*/
+int i2c_read_start(ET_I2C_DEV_t *dev, uint8_t regAddr, uint8_t *rxDataBuff, uint16_t rxDataCount);
+
+/*! \fn int i2c_write_start(ET_I2C_DEV_t *dev, uint8_t regAddr, const uint8_t *txDataBuff, uint16_t txDataCount)
+    \brief Starts an interrupt driven write to the I2C slave, see i2c_read_start()
+    \param dev pointer to I2C device control block
+    \param regAddr register address
+    \param txDataBuff buffer containing data to be written, valid until the transfer completes
+    \param txDataCount data size
+    \return Status indicating success or negative error
+*/
+int i2c_write_start(ET_I2C_DEV_t *dev, uint8_t regAddr, const uint8_t *txDataBuff,
+                    uint16_t txDataCount);
+
+/*! \fn int i2c_transfer_wait(ET_I2C_DEV_t *dev, uint32_t timeout_ms)
+    \brief Blocks the calling task until the started transfer completes, aborting it
+    on timeout, and releases the bus.
+    \param dev pointer to I2C device control block
+    \param timeout_ms timeout in ms
+    \return Status of the transfer
+*/
+int i2c_transfer_wait(ET_I2C_DEV_t *dev, uint32_t timeout_ms);
+
+/*! \fn int i2c_burst_read(ET_I2C_DEV_t *dev, uint8_t regAddr, uint8_t *rxDataBuff, uint16_t rxDataCount)
+    \brief Interrupt driven read of consecutive bytes in a single transaction, the
+    calling task is blocked until it completes.
+    \param dev pointer to I2C device control block
+    \param regAddr address of the first register
+    \param rxDataBuff buffer for rx data
+    \param rxDataCount data size
+    \return Status indicating success or negative error
+*/
+int i2c_burst_read(ET_I2C_DEV_t *dev, uint8_t regAddr, uint8_t *rxDataBuff, uint16_t rxDataCount);
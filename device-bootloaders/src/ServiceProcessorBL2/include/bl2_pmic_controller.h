@@ -442,6 +442,14 @@ int pmic_get_reset_cause(uint32_t *reset_cause);
 */
 int pmic_get_voltage(module_e voltage_type, uint8_t *voltage);
 
+/*! \fn int pmic_get_module_voltages(struct module_voltage_t *module_voltage)
+    \brief This function returns the voltage settings of all the modules, read
+    in a single I2C burst.
+    \param module_voltage - voltage values (binary encoded)
+    \return The function call status, pass/fail.
+*/
+int pmic_get_module_voltages(struct module_voltage_t *module_voltage);
+
 /*! \fn int pmic_set_voltage(module_e voltage_type, uint8_t voltage)
     \brief This function returns specific voltage setting.
     \param voltage_type - voltage type to be set:
@@ -166,6 +166,11 @@
 */
 #define PVT_TS_CAL5_PARAMETER 4096
 
+/*! \def PVT_TS_ALARM_HYSTERESIS_C
+    \brief Degrees below the threshold a TS must cool down to before its alarm can fire again
+*/
+#define PVT_TS_ALARM_HYSTERESIS_C 2
+
 /*! \def PVT_VM_VREF_PARAMETER
     \brief PVT VM VREF parameter used for conversion of digital output
 */
@@ -678,4 +683,20 @@ int pvt_get_minion_avg_low_high_voltage(MinShire_VM_sample *minshire_voltage);
 */
 int pvt_get_memshire_avg_low_high_voltage(MemShire_VM_sample *memshire_voltage);
 
+/*! \fn int pvt_enable_temperature_alarm(uint8_t threshold_c, void (*alarm_cb)(void))
+    \brief This function arms the alarm A of all used TSs and enables the PVT interrupts,
+           alarm_cb is called from the ISR when a TS goes over threshold_c
+    \param threshold_c  Temperature threshold in degrees C
+    \param alarm_cb     Callback invoked in interrupt context
+    \return Status indicating success or negative error
+*/
+int pvt_enable_temperature_alarm(uint8_t threshold_c, void (*alarm_cb)(void));
+
+/*! \fn int pvt_set_temperature_alarm_threshold(uint8_t threshold_c)
+    \brief This function moves the alarm A threshold of all used TSs
+    \param threshold_c  Temperature threshold in degrees C
+    \return Status indicating success or negative error
+*/
+int pvt_set_temperature_alarm_threshold(uint8_t threshold_c);
+
 #endif
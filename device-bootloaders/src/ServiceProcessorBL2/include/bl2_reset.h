@@ -76,6 +76,13 @@ void Maxion_Reset_PLL_Core_Release(void);
 */
 int release_memshire_from_reset(void);
 
+/*! \fn int assert_memshire_reset(void)
+    \brief This function puts all the memshires back in reset
+    \param None
+    \return Status indicating success or negative error
+*/
+int assert_memshire_reset(void);
+
 /*! \fn int release_minions_from_cold_reset(void)
     \brief This function releases minionshore from cold reset state
     \param None 
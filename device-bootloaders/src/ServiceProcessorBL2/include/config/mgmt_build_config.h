@@ -424,10 +424,24 @@
 // Sampler
 #define DM_TASK_PRIORITY 2
 #define DM_TASK_STACK    1024
-#define DM_TASK_DELAY_MS 10
+// Sampling periods: power and temperature while throttling can happen and while not,
+// MM perf stats, and the slow changing asset data (uptime, DRAM capacity)
+#define DM_TASK_POWER_FAST_PERIOD_MS 10
+#define DM_TASK_POWER_SLOW_PERIOD_MS 50
+#define DM_TASK_PERF_PERIOD_MS       100
+#define DM_TASK_ASSET_PERIOD_MS      1000
 // Power Management
 #define TT_TASK_PRIORITY   2
 #define TT_TASK_STACK_SIZE 1024
+// DVFS governor: MM compute utilization (percent) over which the minion operating point
+// steps up, over which it boosts straight to the max frequency, and under which it steps
+// down once seen for DVFS_DOWN_HYSTERESIS_SAMPLES power samples in a row. MM idle gaps
+// shorter than DVFS_IDLE_HOLD_MS keep the operating point.
+#define DVFS_UTIL_UP_PERCENT         60
+#define DVFS_UTIL_BOOST_PERCENT      90
+#define DVFS_UTIL_DOWN_PERCENT       30
+#define DVFS_DOWN_HYSTERESIS_SAMPLES 5
+#define DVFS_IDLE_HOLD_MS            50
 // SMBUS
 #define SMBUS_TASK_PRIORITY 1
 // Vault IP
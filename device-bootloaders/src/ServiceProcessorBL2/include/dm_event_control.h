@@ -54,6 +54,16 @@ void pmic_event_callback(enum error_type type, struct event_message_t *msg);
 #define DM_EVENT_QUEUE_ITEM_SIZE sizeof (struct event_message_t)
 #define DM_EVENT_QUEUE_SIZE             DM_EVENT_QUEUE_LENGTH * DM_EVENT_QUEUE_ITEM_SIZE
 
+/* Event coalescing: in a window, only the first event of each coalesced ID is
+   pushed to the host, the following ones are counted and logged to the SP
+   trace buffer (custom type TRACE_CUSTOM_TYPE_SP_DM_EVENT, up to
+   DM_EVENT_COALESCE_TRACE_MAX of them). When the window ends the counts are
+   pushed as one SP_EVENT_SUMMARY event. The coalesced IDs, in the order of
+   their counts in the summary syndrome, are PCIE_CE, DRAM_CE, SRAM_CE,
+   THERMAL_LOW, PCIE_UCE, DRAM_UCE and SRAM_UCE. */
+#define DM_EVENT_COALESCE_WINDOW_MS     1000
+#define DM_EVENT_COALESCE_TRACE_MAX     32
+
 #define TEST_EVENT_GEN
 #ifdef TEST_EVENT_GEN
 
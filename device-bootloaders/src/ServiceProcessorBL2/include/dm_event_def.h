@@ -54,6 +54,7 @@ enum event_ids
     SP_RUNTIME_ERROR,      /** < SP runtime error event */
     SP_WATCHDOG_RESET,     /** < Watchdog reset event */
     SP_TRACE_BUFFER_FULL,  /** < SP trace buffer full or threshold reached */
+    SP_EVENT_SUMMARY,      /** < Counts of the events coalesced in a window */
     MAX_ERROR_EVENT = 511, /**< Max limit for error IDs. */
 };
 
@@ -100,6 +101,13 @@ struct event_message_t
     (payload)->syndrome[0] = (syndrome1);                                                   \
     (payload)->syndrome[1] = (syndrome2);
 
+/* Summary event syndrome: 16-bit count of each coalesced event ID, see
+   dm_event_control.h. syndrome[1][63:48] holds the events dropped by the
+   queue */
+#define EVENT_SUMMARY_COUNT_MASK      0xFFFFU
+#define EVENT_SUMMARY_COUNTS_PER_WORD 4
+#define EVENT_SUMMARY_DROPPED_SHIFT   48
+
 #define EVENT_PAYLOAD_GET_EVENT_CLASS(payload) (((payload)->class_count) & EVENT_ERROR_CLASS_MASK)
 #define EVENT_PAYLOAD_GET_ERROR_COUNT(payload) \
     ((((payload)->class_count) >> 2) & EVENT_ERROR_COUNT_MASK)
@@ -80,6 +80,22 @@
 #define DDR_DIAG_VERIFY_REGISTER_WRITE (0x01 << 2)
 #define DDR_DIAG_VERIFY_SRAM_WRITE     (0x01 << 3)
 
+/*! \def DDR_TRAINING_CACHE
+    \brief Save the trained PHY registers in flash after a training and restore them on the
+    next boots instead of training again, as long as the board and the temperature match.
+*/
+#if TEST_FRAMEWORK
+#define DDR_TRAINING_CACHE 0
+#else
+#define DDR_TRAINING_CACHE 1
+#endif
+
+/*! \def DDR_TRAINING_CACHE_TEMP_DELTA
+    \brief Maximum difference in degrees C between the temperature at training and the
+    temperature at boot for the training cache to be restored.
+*/
+#define DDR_TRAINING_CACHE_TEMP_DELTA 20
+
 #if (DDR_DIAG & DDR_DIAG_MEMSHIRE_ID)
 #define CHECK_MEMSHIRE_ID(memshire) check_memshire_revision_id(memshire)
 #else
@@ -168,6 +184,7 @@ typedef struct
     bool ecc;
     bool training;
     bool sim_only;
+    bool training_cache; // restore the training from flash when valid
 } DDR_MODE;
 
 /*!
@@ -197,6 +214,15 @@ uint64_t ms_read_chip_reg(uint32_t memshire, uint32_t mr_num);
 */
 const ms_dram_status_t *ms_get_dram_status(void);
 
+/*! \fn void ms_set_dram_status(uint32_t memshire, ms_status_t status)
+    \brief This function sets the status of a memshire when it isn't set by the training,
+           and updates the system status
+    \param memshire id of a specific memshire, 0-based
+    \param status status of the memshire
+    \return none
+*/
+void ms_set_dram_status(uint32_t memshire, ms_status_t status);
+
 /*! \fn void check_memshire_revision_id(uint32_t memshire)
     \brief This function prints out ms_memory_revision_id to debug print
     \param memshire id of a specific memshire, 0-based
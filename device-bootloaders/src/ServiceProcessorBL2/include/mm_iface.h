@@ -133,4 +133,12 @@ int8_t MM_Iface_Push_Rsp_To_MM2SP_CQ(const void *p_rsp, uint32_t rsp_size);
     \return Status indicating success or negative error
 */
 int32_t MM_Iface_Send_Update_Freq_Cmd(uint16_t freq);
+
+/*! \fn int32_t MM_Iface_Send_Operating_Point_Event(uint16_t freq, bool throttled)
+    \brief This notifies Master Minion Firmware of a new Minion operating point.
+    \param freq New Minion frequency in MHz
+    \param throttled True if the frequency was lowered by a power or thermal throttle
+    \return Status indicating success or negative error
+*/
+int32_t MM_Iface_Send_Operating_Point_Event(uint16_t freq, bool throttled);
 #endif
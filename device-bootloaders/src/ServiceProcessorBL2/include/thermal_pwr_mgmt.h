@@ -386,6 +386,13 @@ int pwr_svc_find_hpdpll_mode(uint16_t freq, uint8_t *hpdpll_mode);
 */
 void Thermal_Pwr_Mgmt_Update_MM_State(uint64_t state);
 
+/*! \fn bool Thermal_Pwr_Mgmt_Is_Throttling_Active(void)
+    \brief This function checks if active power management is on and MM is busy
+    \param None
+    \returns true if power and temperature samples can trigger throttling
+*/
+bool Thermal_Pwr_Mgmt_Is_Throttling_Active(void);
+
 /*! \fn int Thermal_Pwr_Mgmt_Validate_Vmin_Lut(char *vmin_lut)
     \brief This function validates vmin lut frequency and voltage values
     before they are written to persisted memory.
@@ -583,6 +583,65 @@ int32_t MM_Iface_Send_Update_Freq_Cmd(uint16_t freq)
     return status;
 }
 
+/************************************************************************
+*
+*   FUNCTION
+*
+*       MM_Iface_Send_Operating_Point_Event
+*
+*   DESCRIPTION
+*
+*       This notifies Master Minion Firmware of a new Minion operating point.
+*       It doesn't wait for a response, and it is dropped if the interface
+*       is not initialized yet (Master Minion reads the boot frequency then).
+*
+*   INPUTS
+*
+*       freq       new Minion frequency in MHz
+*       throttled  true if lowered by a power or thermal throttle
+*
+*   OUTPUTS
+*
+*       int32_t  Success or error code.
+*
+***********************************************************************/
+int32_t MM_Iface_Send_Operating_Point_Event(uint16_t freq, bool throttled)
+{
+    int32_t status = MM_IFACE_SP2MM_CMD_ERROR;
+    struct sp2mm_operating_point_event_t event = { 0 };
+
+    if (mm_cmd_lock == NULL)
+    {
+        return MM_IFACE_SP2MM_CMD_ERROR;
+    }
+
+    /* Initialize event header */
+    SP_MM_IFACE_INIT_MSG_HDR(&event.msg_hdr, SP2MM_EVENT_OPERATING_POINT,
+                             sizeof(struct sp2mm_operating_point_event_t), SP2MM_CMD_NOTIFY_HART)
+    event.freq = freq;
+    event.throttled = throttled ? 1U : 0U;
+    if (xSemaphoreTake(mm_cmd_lock, SP2MM_CMD_TIMEOUT) == pdTRUE)
+    {
+        /* Send event to MM. */
+        status = MM_Iface_Push_Cmd_To_SP2MM_SQ((void *)&event, sizeof(event));
+        if (status != STATUS_SUCCESS)
+        {
+            Log_Write(LOG_LEVEL_ERROR,
+                      "MM_Iface_Push_Cmd_To_SP2MM_SQ: CQ push error! status code: %d\r\n", status);
+            xSemaphoreGive(mm_cmd_lock);
+            return MM_IFACE_SP2MM_CMD_PUSH_ERROR;
+        }
+
+        xSemaphoreGive(mm_cmd_lock);
+    }
+    else
+    {
+        return MM_IFACE_SP2MM_TIMEOUT_ERROR;
+    }
+
+    return status;
+}
+
 /************************************************************************
 *
 *   FUNCTION
@@ -21,6 +21,7 @@
 #include "FreeRTOS.h"
 #include "task.h"
 #include "semphr.h"
+#include "timers.h"
 #include "config/mgmt_build_config.h"
 #include "bl2_pmic_controller.h"
 #include "mem_controller.h"
@@ -40,6 +41,21 @@ static StaticTask_t g_staticTask_ptr;
 SemaphoreHandle_t dm_sampling_semaphore_handle = NULL;
 StaticSemaphore_t dm_sampling_semaphore_buffer;
 
+/* Sampling events notified to the DM task */
+#define DM_SAMPLING_EVENT_POWER     (1U << 0)
+#define DM_SAMPLING_EVENT_PERF      (1U << 1)
+#define DM_SAMPLING_EVENT_ASSET     (1U << 2)
+#define DM_SAMPLING_EVENT_PVT_ALARM (1U << 3)
+
+/* Sampling timers */
+static TimerHandle_t g_dm_power_timer = NULL;
+static StaticTimer_t g_dm_power_timer_buffer;
+static TimerHandle_t g_dm_perf_timer = NULL;
+static StaticTimer_t g_dm_perf_timer_buffer;
+static TimerHandle_t g_dm_asset_timer = NULL;
+static StaticTimer_t g_dm_asset_timer_buffer;
+static uint32_t g_dm_power_period_ms = DM_TASK_POWER_SLOW_PERIOD_MS;
+
 /* Task entry functions */
 static void dm_task_entry(void *pvParameters);
 
@@ -141,6 +157,253 @@ void dm_sampling_task_semaphore_give(void)
     }
 }
 
+/************************************************************************
+*
+*   FUNCTION
+*
+*       dm_sampling_timer_cb
+*
+*   DESCRIPTION
+*
+*       Callback of the sampling timers, runs in the timer task and
+*       notifies the DM task of the event kept as timer ID.
+*
+*   INPUTS
+*
+*       timer    Expired timer
+*
+*   OUTPUTS
+*
+*       None
+*
+***********************************************************************/
+static void dm_sampling_timer_cb(TimerHandle_t timer)
+{
+    xTaskNotify(g_dm_task_handle, (uint32_t)(uintptr_t)pvTimerGetTimerID(timer), eSetBits);
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       dm_pvt_alarm_cb
+*
+*   DESCRIPTION
+*
+*       Callback of the PVT temperature alarm, runs in interrupt context
+*       and makes the DM task sample the temperature right away.
+*
+*   INPUTS
+*
+*       None
+*
+*   OUTPUTS
+*
+*       None
+*
+***********************************************************************/
+static void dm_pvt_alarm_cb(void)
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    xTaskNotifyFromISR(g_dm_task_handle, DM_SAMPLING_EVENT_PVT_ALARM, eSetBits,
+                       &xHigherPriorityTaskWoken);
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       dm_start_sampling_timer
+*
+*   DESCRIPTION
+*
+*       This function creates and starts an auto reload sampling timer
+*       which notifies the DM task with the given event.
+*
+*   INPUTS
+*
+*       name        Timer name
+*       period_ms   Sampling period
+*       event       Event bit notified to the DM task
+*       buffer      Static timer buffer
+*
+*   OUTPUTS
+*
+*       TimerHandle_t  Timer handle, NULL on failure
+*
+***********************************************************************/
+static TimerHandle_t dm_start_sampling_timer(const char *name, uint32_t period_ms, uint32_t event,
+                                             StaticTimer_t *buffer)
+{
+    TimerHandle_t timer = xTimerCreateStatic(name, pdMS_TO_TICKS(period_ms), pdTRUE,
+                                             (void *)(uintptr_t)event, dm_sampling_timer_cb,
+                                             buffer);
+
+    if ((timer == NULL) || (xTimerStart(timer, 0) != pdPASS))
+    {
+        Log_Write(LOG_LEVEL_ERROR, "%s : DM sampling timer %s start failed\n", __func__, name);
+    }
+
+    return timer;
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       dm_sample_power
+*
+*   DESCRIPTION
+*
+*       This function samples the temperature and, unless only the PVT
+*       alarm fired, the PMB stats and SOC power, then checks the power
+*       throttle conditions. The power sampling period follows whether
+*       throttling can happen.
+*
+*   INPUTS
+*
+*       sample_power   Sample the power too
+*
+*   OUTPUTS
+*
+*       None
+*
+***********************************************************************/
+static void dm_sample_power(bool sample_power)
+{
+    int ret;
+    bool temperature_updated = true;
+    bool pwr_updated = sample_power;
+    uint32_t period_ms;
+
+    // Update temperature
+    ret = update_module_current_temperature();
+    if (0 != ret)
+    {
+        temperature_updated = false;
+        Log_Write(LOG_LEVEL_ERROR,
+                  "thermal pwr mgmt svc error : update_module_current_temperature()\r\n");
+    }
+
+    if (sample_power)
+    {
+        // Update PMB stats, it updates voltage, current and power for minion, NOC and SRAM modules
+        ret = update_pmb_stats(false);
+        if (0 != ret)
+        {
+            Log_Write(LOG_LEVEL_ERROR, "thermal pwr mgmt svc error : update_pmb_stats()\r\n");
+        }
+
+        // Module Power in watts
+        ret = update_module_soc_power();
+        if (0 != ret)
+        {
+            pwr_updated = false;
+            Log_Write(LOG_LEVEL_ERROR,
+                      "thermal pwr mgmt svc error : update_module_soc_power()\r\n");
+        }
+    }
+
+    // Check if power throttling is required
+    check_power_throttle_conditions(temperature_updated, pwr_updated);
+
+    // Sample fast only while the samples can trigger throttling
+    period_ms = Thermal_Pwr_Mgmt_Is_Throttling_Active() ? DM_TASK_POWER_FAST_PERIOD_MS :
+                                                          DM_TASK_POWER_SLOW_PERIOD_MS;
+    if ((period_ms != g_dm_power_period_ms) && (g_dm_power_timer != NULL) &&
+        (xTimerChangePeriod(g_dm_power_timer, pdMS_TO_TICKS(period_ms), 0) == pdPASS))
+    {
+        g_dm_power_period_ms = period_ms;
+    }
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       dm_sample_perf
+*
+*   DESCRIPTION
+*
+*       This function samples the module frequencies, MM stats and DRAM BW.
+*
+*   INPUTS
+*
+*       None
+*
+*   OUTPUTS
+*
+*       None
+*
+***********************************************************************/
+static void dm_sample_perf(void)
+{
+    int ret;
+
+    // Module frequencies
+    ret = update_module_frequencies();
+    if (0 != ret)
+    {
+        Log_Write(LOG_LEVEL_ERROR,
+                  "thermal pwr mgmt svc error : update_module_frequencies()\r\n");
+    }
+
+    // Update MM stats
+    ret = update_mm_stats();
+    if (0 != ret)
+    {
+        Log_Write(LOG_LEVEL_ERROR, "perf mgmt svc error : update_mm_stats()\r\n");
+    }
+
+    // Update the DRAM BW(Read/Write request) details
+    ret = update_dram_bw();
+    if (0 != ret)
+    {
+        Log_Write(LOG_LEVEL_ERROR, "perf mgmt svc error : update_dram_bw()\r\n");
+    }
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       dm_sample_asset
+*
+*   DESCRIPTION
+*
+*       This function samples the slow changing module uptime and DRAM
+*       capacity.
+*
+*   INPUTS
+*
+*       None
+*
+*   OUTPUTS
+*
+*       None
+*
+***********************************************************************/
+static void dm_sample_asset(void)
+{
+    int ret;
+
+    // Update the module uptime
+    ret = update_module_uptime();
+    if (0 != ret)
+    {
+        Log_Write(LOG_LEVEL_ERROR, "update_module_uptime error : update_module_uptime()\r\n");
+    }
+
+    // DRAM capacity
+    ret = update_dram_capacity_percent();
+    if (0 != ret)
+    {
+        Log_Write(LOG_LEVEL_ERROR, "perf mgmt svc error : update_dram_capacity_percent()\r\n");
+    }
+}
+
 /************************************************************************
 *
 *   FUNCTION
@@ -150,9 +413,10 @@ void dm_sampling_task_semaphore_give(void)
 *   DESCRIPTION
 *
 *       This DM sampling task entry point. The DM sampling task
-*       periodically samples different thermal and perf parameters
-*       and save them in globals which are used by the respective
-*       request handlers.
+*       samples different thermal and perf parameters when their
+*       sampling timers expire, or the temperature when a PVT alarm
+*       fires, and saves them in globals which are used by the
+*       respective request handlers.
 *
 *
 *   INPUTS
@@ -168,8 +432,11 @@ static void dm_task_entry(void *pvParameters)
 {
     (void)pvParameters;
     int ret;
-    bool temperature_updated;
-    bool pwr_updated;
+    uint32_t events;
+    struct temperature_threshold_t temperature_threshold;
+
+    /* Set the handle here, the task runs before its creation returns */
+    g_dm_task_handle = xTaskGetCurrentTaskHandle();
 
     ret = Thermal_Pwr_Mgmt_Init_OP_Stats();
     if (ret != STATUS_SUCCESS)
@@ -193,86 +460,52 @@ static void dm_task_entry(void *pvParameters)
         dm_sampling_task_semaphore_give();
     }
 
-    while (1)
-    {
-        temperature_updated = true;
-        pwr_updated = true;
-
-        dm_sampling_task_semaphore_take();
-
-        Log_Write(LOG_LEVEL_DEBUG, "Updating the periodically sampled parameters: %s\n", __func__);
+    g_dm_power_timer = dm_start_sampling_timer("DM_POWER", g_dm_power_period_ms,
+                                               DM_SAMPLING_EVENT_POWER, &g_dm_power_timer_buffer);
+    g_dm_perf_timer = dm_start_sampling_timer("DM_PERF", DM_TASK_PERF_PERIOD_MS,
+                                              DM_SAMPLING_EVENT_PERF, &g_dm_perf_timer_buffer);
+    g_dm_asset_timer = dm_start_sampling_timer("DM_ASSET", DM_TASK_ASSET_PERIOD_MS,
+                                               DM_SAMPLING_EVENT_ASSET, &g_dm_asset_timer_buffer);
 
-        // Update temperature
-        ret = update_module_current_temperature();
-        if (0 != ret)
-        {
-            temperature_updated = false;
-            Log_Write(LOG_LEVEL_ERROR,
-                      "thermal pwr mgmt svc error : update_module_current_temperature()\r\n");
-        }
+    /* Over temperature does not wait for the next power sample */
+    get_module_temperature_threshold(&temperature_threshold);
+    pvt_enable_temperature_alarm(temperature_threshold.sw_temperature_c, dm_pvt_alarm_cb);
 
-        // Update PMB stats, it updates voltage, current and power for minion, NOC and SRAM modules
-        ret = update_pmb_stats(false);
-        if (0 != ret)
-        {
-            Log_Write(LOG_LEVEL_ERROR, "thermal pwr mgmt svc error : update_pmb_stats()\r\n");
-        }
+    /* Fill in all the samples before the first timer expires */
+    events = DM_SAMPLING_EVENT_POWER | DM_SAMPLING_EVENT_PERF | DM_SAMPLING_EVENT_ASSET;
 
-        // Module Power in watts
-        ret = update_module_soc_power();
-        if (0 != ret)
-        {
-            pwr_updated = false;
-            Log_Write(LOG_LEVEL_ERROR,
-                      "thermal pwr mgmt svc error : update_module_soc_power()\r\n");
-        }
-
-        // Module frequencies
-        ret = update_module_frequencies();
-        if (0 != ret)
-        {
-            Log_Write(LOG_LEVEL_ERROR,
-                      "thermal pwr mgmt svc error : update_module_frequencies()\r\n");
-        }
+    while (1)
+    {
+        dm_sampling_task_semaphore_take();
 
-        // Update the module uptime
-        ret = update_module_uptime();
-        if (0 != ret)
-        {
-            Log_Write(LOG_LEVEL_ERROR, "update_module_uptime error : update_module_uptime()\r\n");
-        }
+        Log_Write(LOG_LEVEL_DEBUG, "Updating the sampled parameters 0x%" PRIx32 ": %s\n", events,
+                  __func__);
 
-        // Update MM stats
-        ret = update_mm_stats();
-        if (0 != ret)
+        if (events & (DM_SAMPLING_EVENT_POWER | DM_SAMPLING_EVENT_PVT_ALARM))
         {
-            Log_Write(LOG_LEVEL_ERROR, "perf mgmt svc error : update_mm_stats()\r\n");
+            dm_sample_power((events & DM_SAMPLING_EVENT_POWER) != 0);
         }
 
-        // Update the DRAM BW(Read/Write request) details
-        ret = update_dram_bw();
-        if (0 != ret)
+        if (events & DM_SAMPLING_EVENT_PERF)
         {
-            Log_Write(LOG_LEVEL_ERROR, "perf mgmt svc error : update_dram_bw()\r\n");
+            dm_sample_perf();
         }
 
-        // DRAM capacity
-        ret = update_dram_capacity_percent();
-        if (0 != ret)
+        if (events & DM_SAMPLING_EVENT_ASSET)
         {
-            Log_Write(LOG_LEVEL_ERROR, "perf mgmt svc error : update_dram_capacity_percent()\r\n");
+            dm_sample_asset();
         }
 
-        // Check if power throttling is required
-        check_power_throttle_conditions(temperature_updated, pwr_updated);
-
         dm_sampling_task_semaphore_give();
 
         // Log op stats to trace
-        dm_log_operating_point_stats();
+        if (events & DM_SAMPLING_EVENT_POWER)
+        {
+            dm_log_operating_point_stats();
+        }
 
-        // Wait for the sampling period
-        vTaskDelay(pdMS_TO_TICKS(DM_TASK_DELAY_MS));
+        // Wait for the next sampling event
+        xTaskNotifyWait(0, 0xFFFFFFFFU, &events, portMAX_DELAY);
     }
 }
 
@@ -4,7 +4,9 @@
  *-------------------------------------------------------------------------
  */
 #include <inttypes.h>
+#include <stdbool.h>
 #include <stdio.h>
+#include <string.h>
 #include "log.h"
 #include "dm_task.h"
 #include "FreeRTOS.h"
@@ -17,6 +19,7 @@
 #include "bl2_watchdog.h"
 #include "minion_configuration.h"
 #include "pcie_configuration.h"
+#include "trace.h"
 
 /* The variable used to hold the queue's data structure. */
 static StaticQueue_t g_staticQueue;
@@ -39,6 +42,25 @@ static StackType_t g_dm_stack[DM_EVENT_TASK_STACK];
 /* The variable used to hold the task's data structure. */
 static StaticTask_t g_staticTask_ptr;
 
+/* Coalesced event IDs, in the order of their counts in the summary syndrome */
+static const uint16_t g_coalesced_ids[] = { PCIE_CE,  DRAM_CE,  SRAM_CE, THERMAL_LOW,
+                                            PCIE_UCE, DRAM_UCE, SRAM_UCE };
+
+#define DM_EVENT_COALESCED_COUNT (sizeof(g_coalesced_ids) / sizeof(g_coalesced_ids[0]))
+
+/* State of the current coalescing window */
+struct dm_event_window_t
+{
+    TickType_t start;                         /**< tick count at the first event */
+    bool active;                              /**< a window is open */
+    uint32_t traced;                          /**< events logged to the trace */
+    bool forwarded[DM_EVENT_COALESCED_COUNT]; /**< first event pushed to the host */
+    uint16_t counts[DM_EVENT_COALESCED_COUNT]; /**< events coalesced */
+};
+
+/* Events lost because the queue was full */
+static uint32_t g_dropped_events;
+
 /* Global control block for max error count */
 struct max_error_count_t g_max_error_count __attribute__((section(".data")));
 
@@ -107,8 +129,102 @@ int32_t dm_event_control_init(void)
     return status;
 }
 
+/* Returns true if the event was coalesced in the window, false if it has to
+   be pushed to the host */
+static bool dm_event_coalesce(struct dm_event_window_t *window, const struct event_message_t *msg)
+{
+    uint32_t idx;
+
+    for (idx = 0; idx < DM_EVENT_COALESCED_COUNT; idx++)
+    {
+        if (g_coalesced_ids[idx] == msg->header.msg_id)
+        {
+            break;
+        }
+    }
+    if (idx == DM_EVENT_COALESCED_COUNT)
+    {
+        return false;
+    }
+
+    if (!window->active)
+    {
+        memset(window, 0, sizeof(*window));
+        window->active = true;
+        window->start = xTaskGetTickCount();
+    }
+
+    if (!window->forwarded[idx])
+    {
+        window->forwarded[idx] = true;
+        return false;
+    }
+
+    if (window->counts[idx] < EVENT_SUMMARY_COUNT_MASK)
+    {
+        window->counts[idx]++;
+    }
+
+    /* Keep the detail of the first ones for the host to fetch with the SP trace */
+    if (window->traced < DM_EVENT_COALESCE_TRACE_MAX)
+    {
+        Trace_Custom_Event(Trace_Get_SP_CB(), TRACE_CUSTOM_TYPE_SP_DM_EVENT, (const uint8_t *)msg,
+                           sizeof(*msg));
+        window->traced++;
+    }
+
+    return true;
+}
+
+/* Pushes the summary of the window to the host if events were coalesced */
+static void dm_event_window_close(struct dm_event_window_t *window)
+{
+    struct event_message_t summary;
+    uint64_t syndrome[2] = { 0, 0 };
+    uint32_t total;
+    uint32_t dropped;
+
+    window->active = false;
+
+    dropped = __atomic_exchange_n(&g_dropped_events, 0, __ATOMIC_RELAXED);
+    total = dropped;
+    for (uint32_t idx = 0; idx < DM_EVENT_COALESCED_COUNT; idx++)
+    {
+        syndrome[idx / EVENT_SUMMARY_COUNTS_PER_WORD] |=
+            (uint64_t)window->counts[idx] << (16U * (idx % EVENT_SUMMARY_COUNTS_PER_WORD));
+        total += window->counts[idx];
+    }
+    if (total == 0)
+    {
+        return;
+    }
+    if (dropped > EVENT_SUMMARY_COUNT_MASK)
+    {
+        dropped = EVENT_SUMMARY_COUNT_MASK;
+    }
+    syndrome[1] |= (uint64_t)dropped << EVENT_SUMMARY_DROPPED_SHIFT;
+    if (total > EVENT_ERROR_COUNT_MASK)
+    {
+        total = EVENT_ERROR_COUNT_MASK;
+    }
+
+    if (window->traced)
+    {
+        Trace_Update_SP_Buffer_Header();
+    }
+
+    FILL_EVENT_HEADER(&summary.header, SP_EVENT_SUMMARY, sizeof(struct event_message_t))
+    FILL_EVENT_PAYLOAD(&summary.payload, WARNING, total, syndrome[0], syndrome[1])
+    if (SP_Host_Iface_CQ_Push_Cmd((void *)&summary, sizeof(summary)))
+    {
+        Log_Write(LOG_LEVEL_ERROR, "dm_event_handler_task_error :  push of summary to CQ failed!\n");
+    }
+}
+
 static void dm_event_task_entry(void *pvParameters)
 {
+    const TickType_t window_ticks = pdMS_TO_TICKS(DM_EVENT_COALESCE_WINDOW_MS);
+    struct dm_event_window_t window = { 0 };
     struct event_message_t msg;
     int status;
 
@@ -116,8 +232,16 @@ static void dm_event_task_entry(void *pvParameters)
 
     while (1)
     {
-        /* block until a message is received */
-        if (xQueueReceive(q_handle, &msg, portMAX_DELAY) == pdTRUE)
+        TickType_t wait = portMAX_DELAY;
+
+        if (window.active)
+        {
+            TickType_t elapsed = xTaskGetTickCount() - window.start;
+            wait = (elapsed < window_ticks) ? (window_ticks - elapsed) : 0;
+        }
+
+        /* block until a message is received or the window ends */
+        if (xQueueReceive(q_handle, &msg, wait) == pdTRUE)
         {
             Log_Write(LOG_LEVEL_DEBUG, "DM event received: msg_id: %d, %s\n", msg.header.msg_id,
                       __func__);
@@ -129,6 +253,10 @@ static void dm_event_task_entry(void *pvParameters)
                     break;
                 }
                 default: {
+                    if (dm_event_coalesce(&window, &msg))
+                    {
+                        break;
+                    }
                     status = SP_Host_Iface_CQ_Push_Cmd((void *)&msg, sizeof(msg));
                     if (status)
                     {
@@ -139,6 +267,11 @@ static void dm_event_task_entry(void *pvParameters)
                 }
             }
         }
+
+        if (window.active && ((xTaskGetTickCount() - window.start) >= window_ticks))
+        {
+            dm_event_window_close(&window);
+        }
     }
 }
 
@@ -157,7 +290,10 @@ void pcie_event_callback(enum error_type type, struct event_message_t *msg)
     }
 
     /* Post message to the queue - must be called from ISR context */
-    xQueueSendFromISR(q_handle, msg, (BaseType_t *)NULL);
+    if (xQueueSendFromISR(q_handle, msg, (BaseType_t *)NULL) != pdTRUE)
+    {
+        __atomic_add_fetch(&g_dropped_events, 1, __ATOMIC_RELAXED);
+    }
 }
 
 void sram_event_callback(enum error_type type, struct event_message_t *msg)
@@ -176,7 +312,10 @@ void sram_event_callback(enum error_type type, struct event_message_t *msg)
     }
 
     /* Post message to the queue - must be called from ISR context */
-    xQueueSendFromISR(q_handle, msg, (BaseType_t *)NULL);
+    if (xQueueSendFromISR(q_handle, msg, (BaseType_t *)NULL) != pdTRUE)
+    {
+        __atomic_add_fetch(&g_dropped_events, 1, __ATOMIC_RELAXED);
+    }
 }
 
 void ddr_event_callback(enum error_type type, struct event_message_t *msg)
@@ -195,7 +334,10 @@ void ddr_event_callback(enum error_type type, struct event_message_t *msg)
     }
 
     /* Post message to the queue - must be called from ISR context */
-    xQueueSendFromISR(q_handle, msg, (BaseType_t *)NULL);
+    if (xQueueSendFromISR(q_handle, msg, (BaseType_t *)NULL) != pdTRUE)
+    {
+        __atomic_add_fetch(&g_dropped_events, 1, __ATOMIC_RELAXED);
+    }
 }
 
 void power_event_callback(enum error_type type, struct event_message_t *msg)
@@ -211,7 +353,10 @@ void wdog_timeout_callback(enum error_type type, struct event_message_t *msg)
     (void)type;
 
     /* Post message to the queue - must be called from ISR context */
-    xQueueSendFromISR(q_handle, msg, (BaseType_t *)NULL);
+    if (xQueueSendFromISR(q_handle, msg, (BaseType_t *)NULL) != pdTRUE)
+    {
+        __atomic_add_fetch(&g_dropped_events, 1, __ATOMIC_RELAXED);
+    }
 }
 
 void minion_event_callback(enum error_type type, struct event_message_t *msg)
@@ -227,7 +372,10 @@ void pmic_event_callback(enum error_type type, struct event_message_t *msg)
     (void)type;
 
     /* Post message to the queue - must be called from ISR context */
-    xQueueSendFromISR(q_handle, msg, (BaseType_t *)NULL);
+    if (xQueueSendFromISR(q_handle, msg, (BaseType_t *)NULL) != pdTRUE)
+    {
+        __atomic_add_fetch(&g_dropped_events, 1, __ATOMIC_RELAXED);
+    }
 }
 
 #ifdef TEST_EVENT_GEN
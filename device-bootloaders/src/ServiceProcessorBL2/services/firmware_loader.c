@@ -21,6 +21,8 @@
 #include "bl2_certificates.h"
 #include "bl2_firmware_loader.h"
 #include "bl2_vaultip_controller.h"
+#include "bl2_timer.h"
+#include "system/layout.h"
 #include "sp_otp.h"
 #include "constant_memory_compare.h"
 
@@ -56,6 +58,17 @@ static bool gs_aes_context_created;
 static bool gs_vaultip_disabled;
 static bool gs_ignore_signatures;
 
+/* Load regions of the verified Master Minion image copied to FW_MASTER_SNAPSHOT_BASEADDR,
+   in order. No regions means there is no copy to restore. */
+typedef struct
+{
+    uint64_t address;
+    uint32_t size;
+} FW_SNAPSHOT_REGION_t;
+
+static FW_SNAPSHOT_REGION_t gs_mm_snapshot_regions[MAX_EXECUTABLE_IMAGE_LOAD_REGIONS_COUNT];
+static uint32_t gs_mm_snapshot_regions_count;
+
 ESPERANTO_IMAGE_FILE_HEADER_t *get_master_minion_image_file_header(void)
 {
     return &(get_service_processor_bl2_data()->master_minion_header);
@@ -647,6 +660,81 @@ static int load_image_code_and_data(ESPERANTO_FLASH_REGION_ID_t region_id,
     return 0;
 }
 
+static void save_master_minion_snapshot(const ESPERANTO_IMAGE_FILE_HEADER_t *image_file_header)
+{
+    const ESPERANTO_IMAGE_INFO_t *image_info =
+        &(image_file_header->info.image_info_and_signaure.info);
+    uint64_t snapshot_address = FW_MASTER_SNAPSHOT_BASEADDR;
+    uint64_t snapshot_end = FW_MASTER_SNAPSHOT_BASEADDR + FW_MASTER_SNAPSHOT_SIZE;
+    load_address_t load_address;
+    uint32_t size;
+
+    gs_mm_snapshot_regions_count = 0;
+    remap_load_address(&snapshot_address, FW_MASTER_SNAPSHOT_SIZE);
+    remap_load_address(&snapshot_end, 1);
+
+    for (uint32_t n = 0; n < image_info->secret_info.load_regions_count; n++)
+    {
+        load_address.lo = image_info->secret_info.load_regions[n].load_address_lo;
+        load_address.hi = image_info->secret_info.load_regions[n].load_address_hi;
+        size = image_info->secret_info.load_regions[n].memory_size;
+        if (remap_load_address(&load_address.u64, size) || (size > snapshot_end - snapshot_address))
+        {
+            Log_Write(LOG_LEVEL_WARNING,
+                      "load_firmware: MASTER_MINION image does not fit the snapshot!\n");
+            gs_mm_snapshot_regions_count = 0;
+            return;
+        }
+        memcpy((void *)snapshot_address, (const void *)load_address.u64, size);
+        gs_mm_snapshot_regions[n].address = load_address.u64;
+        gs_mm_snapshot_regions[n].size = size;
+        snapshot_address += size;
+    }
+    gs_mm_snapshot_regions_count = image_info->secret_info.load_regions_count;
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       restore_master_minion_firmware
+*
+*   DESCRIPTION
+*
+*       This function copies the Master Minion image verified at boot back
+*       to its load addresses, undoing what the previous run wrote to its
+*       data. The MM threads must not be running.
+*
+*   INPUTS
+*
+*       None
+*
+*   OUTPUTS
+*
+*       0 on success, -1 if there is no copy and the image must be loaded
+*       from flash
+*
+***********************************************************************/
+int restore_master_minion_firmware(void)
+{
+    uint64_t snapshot_address = FW_MASTER_SNAPSHOT_BASEADDR;
+
+    if (0 == gs_mm_snapshot_regions_count)
+    {
+        return -1;
+    }
+
+    remap_load_address(&snapshot_address, FW_MASTER_SNAPSHOT_SIZE);
+    for (uint32_t n = 0; n < gs_mm_snapshot_regions_count; n++)
+    {
+        memcpy((void *)gs_mm_snapshot_regions[n].address, (const void *)snapshot_address,
+               gs_mm_snapshot_regions[n].size);
+        snapshot_address += gs_mm_snapshot_regions[n].size;
+    }
+
+    return 0;
+}
+
 int load_firmware(const ESPERANTO_IMAGE_TYPE_t image_type)
 {
     int rv;
@@ -655,6 +743,10 @@ int load_firmware(const ESPERANTO_IMAGE_TYPE_t image_type)
     const char *image_name;
     ESPERANTO_IMAGE_FILE_HEADER_t *image_file_header;
     SERVICE_PROCESSOR_BL2_DATA_t *bl2_data = get_service_processor_bl2_data();
+    /* timer ticks at the start of each phase, reported once the image is loaded */
+    uint64_t start_ticks;
+    uint64_t verify_ticks;
+    uint64_t load_ticks;
 
     gs_kdk_created = false;
     gs_mack_created = false;
@@ -697,6 +789,7 @@ int load_firmware(const ESPERANTO_IMAGE_TYPE_t image_type)
     }
 
     /* load the image */
+    start_ticks = timer_get_ticks_count();
     if (0 != flashfs_drv_get_file_size(region_id, &image_file_size))
     {
         Log_Write(LOG_LEVEL_ERROR, "load_firmware: flashfs_drv_get_file_size(%s) failed!\n",
@@ -718,6 +811,8 @@ int load_firmware(const ESPERANTO_IMAGE_TYPE_t image_type)
     }
     Log_Write(LOG_LEVEL_INFO, "Loaded %s header...\n", image_name);
 
+    verify_ticks = timer_get_ticks_count();
+
     if (0 != verify_image_file_header(image_type, image_file_header, image_file_size))
     {
         Log_Write(LOG_LEVEL_ERROR, "load_firmware: verify_image_file_header() failed!\n");
@@ -726,6 +821,8 @@ int load_firmware(const ESPERANTO_IMAGE_TYPE_t image_type)
     }
     Log_Write(LOG_LEVEL_INFO, "Verified %s header...\n", image_name);
 
+    load_ticks = timer_get_ticks_count();
+
     if (0 != load_image_code_and_data(region_id, image_file_header))
     {
         Log_Write(LOG_LEVEL_ERROR, "load_firmware: load_image_code_and_data() failed!\n");
@@ -734,8 +831,17 @@ int load_firmware(const ESPERANTO_IMAGE_TYPE_t image_type)
     }
 
     Log_Write(LOG_LEVEL_CRITICAL, "load_firmware: Loaded %s firmware.\n", image_name);
+    Log_Write(LOG_LEVEL_CRITICAL,
+              "load_firmware: %s ticks: header read %lu, verify %lu, load and hash %lu\n",
+              image_name, verify_ticks - start_ticks, load_ticks - verify_ticks,
+              timer_get_ticks_count() - load_ticks);
     rv = 0;
 
+    if (ESPERANTO_IMAGE_TYPE_MASTER_MINION == image_type)
+    {
+        save_master_minion_snapshot(image_file_header);
+    }
+
 DONE:
     if (gs_aes_context_created && (0 != crypto_aes_decrypt_final(&gs_aes_context, NULL, 0, NULL)))
     {
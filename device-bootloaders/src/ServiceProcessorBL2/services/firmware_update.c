@@ -627,6 +627,132 @@ static int32_t verify_image_header(void *fw_addr)
     return 0;
 }
 
+/************************************************************************
+*
+*   FUNCTION
+*
+*       expand_image_patch
+*
+*   DESCRIPTION
+*
+*       If the host wrote a patch (see ESPERANTO_FLASH_PATCH_HEADER_t)
+*       instead of a partition image to the scratch region, this function
+*       builds the partition image in its place: the patch is moved past
+*       the partition, the active partition is read back from flash and
+*       the chunks of the patch replace the regions which changed.
+*
+*   INPUTS
+*
+*       image           Start of scratch region
+*       partition_size  Size of a partition in bytes
+*
+*   OUTPUTS
+*
+*       Status, success if there was no patch
+*
+***********************************************************************/
+static int32_t expand_image_patch(uint8_t *image, uint32_t partition_size)
+{
+    const ESPERANTO_FLASH_PATCH_HEADER_t *header = (const ESPERANTO_FLASH_PATCH_HEADER_t *)image;
+    const ESPERANTO_FLASH_PATCH_CHUNK_t *chunk;
+    const uint8_t *patch;
+    uint32_t patch_size;
+    uint32_t chunks_count;
+    uint32_t offset;
+    uint32_t page = 0;
+    uint32_t crc = 0;
+
+    if (ESPERANTO_PATCH_TAG != header->patch_tag)
+    {
+        return 0;
+    }
+
+    crc32(header, offsetof(ESPERANTO_FLASH_PATCH_HEADER_t, patch_header_checksum), &crc);
+    if ((crc != header->patch_header_checksum) ||
+        (sizeof(ESPERANTO_FLASH_PATCH_HEADER_t) != header->patch_header_size) ||
+        ((uint64_t)header->partition_size * FLASH_PAGE_SIZE != partition_size) ||
+        (header->patch_size < sizeof(ESPERANTO_FLASH_PATCH_HEADER_t)) ||
+        (header->patch_size > SP_DM_SCRATCH_REGION_SIZE - partition_size))
+    {
+        Log_Write(LOG_LEVEL_ERROR, "expand_image_patch: invalid patch header!\n");
+        return ERROR_FW_UPDATE_PATCH_INVALID;
+    }
+    patch_size = header->patch_size;
+    chunks_count = header->chunks_count;
+
+    Log_Write(LOG_LEVEL_CRITICAL, "[ETFP] Expanding patch (%d bytes, %d chunks)\n", patch_size,
+              chunks_count);
+
+    /* Make room for the partition image, header is not valid anymore */
+    memmove(image + partition_size, image, patch_size);
+    patch = image + partition_size;
+    header = (const ESPERANTO_FLASH_PATCH_HEADER_t *)patch;
+
+    for (uint32_t i = 0; i < partition_size; i = i + SPI_FLASH_PAGE_SIZE)
+    {
+        if (0 != flash_fs_read(true, image + i, SPI_FLASH_PAGE_SIZE, i))
+        {
+            Log_Write(LOG_LEVEL_ERROR, "expand_image_patch: read of active partition failed!\n");
+            return ERROR_FW_UPDATE_READ_PARTITON;
+        }
+    }
+
+    /* The pages the patch does not replace must be those of the partition it was made from */
+    crc = 0;
+    offset = sizeof(ESPERANTO_FLASH_PATCH_HEADER_t);
+    for (uint32_t n = 0; n < chunks_count; n++)
+    {
+        uint32_t data_crc = 0;
+
+        chunk = (const ESPERANTO_FLASH_PATCH_CHUNK_t *)(patch + offset);
+        if ((patch_size - offset < sizeof(ESPERANTO_FLASH_PATCH_CHUNK_t)) ||
+            (0 == chunk->chunk_size) || (chunk->chunk_offset < page) ||
+            (chunk->chunk_offset > header->partition_size) ||
+            (chunk->chunk_size > header->partition_size - chunk->chunk_offset) ||
+            ((patch_size - offset - sizeof(ESPERANTO_FLASH_PATCH_CHUNK_t)) / FLASH_PAGE_SIZE <
+             chunk->chunk_size))
+        {
+            Log_Write(LOG_LEVEL_ERROR, "expand_image_patch: chunk %d is invalid!\n", n);
+            return ERROR_FW_UPDATE_PATCH_INVALID;
+        }
+        crc32(chunk + 1, chunk->chunk_size * FLASH_PAGE_SIZE, &data_crc);
+        if (data_crc != chunk->chunk_data_crc)
+        {
+            Log_Write(LOG_LEVEL_ERROR, "expand_image_patch: chunk %d CRC mismatch!\n", n);
+            return ERROR_FW_UPDATE_PATCH_CRC_MISMATCH;
+        }
+        crc32(image + page * FLASH_PAGE_SIZE, (chunk->chunk_offset - page) * FLASH_PAGE_SIZE, &crc);
+        page = chunk->chunk_offset + chunk->chunk_size;
+        offset += (uint32_t)sizeof(ESPERANTO_FLASH_PATCH_CHUNK_t) + chunk->chunk_size * FLASH_PAGE_SIZE;
+    }
+    crc32(image + page * FLASH_PAGE_SIZE, partition_size - page * FLASH_PAGE_SIZE, &crc);
+    if ((offset != patch_size) || (crc != header->base_partition_crc))
+    {
+        Log_Write(LOG_LEVEL_ERROR,
+                  "expand_image_patch: active partition is not the base of the patch!\n");
+        return ERROR_FW_UPDATE_PATCH_BASE_MISMATCH;
+    }
+
+    offset = sizeof(ESPERANTO_FLASH_PATCH_HEADER_t);
+    for (uint32_t n = 0; n < chunks_count; n++)
+    {
+        chunk = (const ESPERANTO_FLASH_PATCH_CHUNK_t *)(patch + offset);
+        memcpy(image + chunk->chunk_offset * FLASH_PAGE_SIZE, chunk + 1,
+               chunk->chunk_size * FLASH_PAGE_SIZE);
+        offset += (uint32_t)sizeof(ESPERANTO_FLASH_PATCH_CHUNK_t) + chunk->chunk_size * FLASH_PAGE_SIZE;
+    }
+
+    crc = 0;
+    crc32(image, partition_size, &crc);
+    if (crc != header->new_partition_crc)
+    {
+        Log_Write(LOG_LEVEL_ERROR, "expand_image_patch: patched partition CRC mismatch!\n");
+        return ERROR_FW_UPDATE_PATCH_CRC_MISMATCH;
+    }
+
+    return 0;
+}
+
 /************************************************************************
 *
 *   FUNCTION
@@ -641,6 +767,8 @@ static int32_t verify_image_header(void *fw_addr)
 *       scratch region of device memory. Input image is composed of two
 *       2 MB partition images. Since partition size is 2 MBs, only
 *       1st half of input image is always used in firmware update.
+*       Host may write a patch of the active partition instead, which is
+*       expanded to the partition image first.
 *       First, passive partition is erased and then image is flashed.
 *       After this, verification is performed which involves comparing
 *       input image residing in scratch region with that on passive
@@ -692,6 +820,13 @@ static int32_t dm_svc_firmware_update(void)
 
     partition_size = sp_bl2_data->flash_fs_bl2_info.flash_size / 2;
 
+    ret = expand_image_patch((uint8_t *)SP_DM_SCRATCH_REGION_BEGIN, partition_size);
+    if (ret != 0)
+    {
+        Log_Write(LOG_LEVEL_ERROR, "expand_image_patch: update patch could not be applied!\n");
+        return ret;
+    }
+
     ret = verify_image_header((void *)SP_DM_SCRATCH_REGION_BEGIN);
     if (ret != 0)
     {
@@ -38,6 +38,9 @@ void start_test_events(tag_id_t tag_id, msg_id_t msg_id)
     FILL_EVENT_PAYLOAD(&message.payload, CRITICAL, 1024, 1, 0)
     generate_test_event(&message);
 
+    /* Repeat it, it is coalesced and reported in the next event summary */
+    generate_test_event(&message);
+
     /* Generate PCIE Un-Correctable Error */
     FILL_EVENT_HEADER(&message.header, PCIE_UCE, sizeof(struct event_message_t))
     FILL_EVENT_PAYLOAD(&message.payload, FATAL, 100, 16, 0)
@@ -36,6 +36,7 @@
        Thermal_Pwr_Mgmt_Init_OP_Stats
        Thermal_Pwr_Mgmt_Validate_Vmin_Lut
        Thermal_Pwr_Mgmt_Set_Min_Max_Limits_From_Vmin_Lut
+       Thermal_Pwr_Mgmt_Is_Throttling_Active
 */
 /***********************************************************************/
 #include <math.h>
@@ -49,6 +50,7 @@
 #include "FreeRTOS.h"
 #include "task.h"
 #include "semphr.h"
+#include "timers.h"
 #include "bl2_main.h"
 #include "bl_error_code.h"
 #include "hwinc/minion_lvdpll_program.h"
@@ -57,6 +59,7 @@
 #include "delays.h"
 #include "bl2_flash_fs.h"
 #include "service_processor_BL2_data.h"
+#include "mm_iface.h"
 
 #define MNN_HEX_TO_MILLIVOLT(hex_val)                                                        \
     PMIC_HEX_TO_MILLIVOLT(hex_val, PMIC_MINION_VOLTAGE_BASE, PMIC_MINION_VOLTAGE_MULTIPLIER, \
@@ -155,6 +158,14 @@ static StackType_t g_pm_task[TT_TASK_STACK_SIZE];
 /* The variable used to hold the task's data structure. */
 static StaticTask_t g_staticTask_ptr;
 
+/* Notified along with POWER_THROTTLE_STATE_POWER_UP to go straight to the max frequency */
+#define POWER_THROTTLE_BOOST_EVENT (1U << 31)
+
+/* DVFS governor state, the timer delays the idle state over short MM idle gaps */
+static TimerHandle_t g_dvfs_idle_timer = NULL;
+static StaticTimer_t g_dvfs_idle_timer_buffer;
+static uint32_t g_dvfs_low_util_samples = 0;
+
 // The variable used to track master minion state (idle/busy)
 // mm_state is used in different RTOS tasks, so its access is guarded with the mutex
 static uint32_t mm_state = MM_STATE_IDLE;
@@ -313,6 +324,7 @@ volatile struct pmic_power_reg_t *get_pmic_power_reg(void)
 
 /* The PMIC isr callback function, called from PMIC isr. */
 static void pmic_isr_callback(uint8_t int_cause);
+static void dvfs_idle_timer_cb(TimerHandle_t timer);
 
 #if !(FAST_BOOT || TEST_FRAMEWORK)
 /* This function ensure voltage stability after changing voltage through pmic.
@@ -639,7 +651,8 @@ int update_module_temperature_threshold(uint8_t sw_threshold)
 {
     g_soc_power_reg.temperature_threshold.sw_temperature_c = sw_threshold;
 
-    return 0;
+    /* Keep the PVT alarm that wakes up the DM task in line with the threshold */
+    return pvt_set_temperature_alarm_threshold(sw_threshold);
 }
 
 /************************************************************************
@@ -872,6 +885,17 @@ void check_power_throttle_conditions(bool temperature_updated, bool pwr_updated)
     uint16_t minion_curr_frequency = (uint16_t)Get_Minion_Frequency();
     uint16_t minion_max_frequency = g_soc_power_reg.vmin_lut_limits.mnn_frequency_max_limit;
     uint16_t minion_min_frequency = g_soc_power_reg.vmin_lut_limits.mnn_frequency_min_limit;
+    volatile struct soc_perf_reg_t const *perf_reg = get_soc_perf_reg();
+    // Without any utilization from MM yet, let power alone drive the operating point
+    uint64_t cm_utilization = (perf_reg->mm_stats.cm_utilization.max != 0) ?
+                                  perf_reg->mm_stats.cm_utilization.avg :
+                                  100;
+
+    // The governor steps down only after several low utilization samples in a row
+    if (cm_utilization > DVFS_UTIL_DOWN_PERCENT)
+    {
+        g_dvfs_low_util_samples = 0;
+    }
 
     // Switch power throttle state if active power management is enabled
     // and if minion is not in idle state
@@ -907,16 +931,37 @@ void check_power_throttle_conditions(bool temperature_updated, bool pwr_updated)
             xTaskNotify(g_pm_handle, 1 << POWER_THROTTLE_STATE_POWER_DOWN, eSetBits);
         }
         // Check if power value has been updated and it's below the threshold value
+        // and if the MM keeps the minions busy enough to need a higher frequency
         else if (pwr_updated && (avg_soc_pwr_mW < tdp_level_mW) &&
-                 (minion_curr_frequency < minion_max_frequency))
+                 (minion_curr_frequency < minion_max_frequency) &&
+                 (cm_utilization >= DVFS_UTIL_UP_PERCENT))
         {
             // Log the event
             Log_Write(LOG_LEVEL_CRITICAL,
-                      "Power throttle up event, current pwr %u  tdp level: %u\n", avg_soc_pwr_mW,
-                      tdp_level_mW);
+                      "Power throttle up event, current pwr %u  tdp level: %u utilization: %u\n",
+                      avg_soc_pwr_mW, tdp_level_mW, (uint32_t)cm_utilization);
+
+            // Do the power throttling up, straight to the max frequency on high utilization
+            xTaskNotify(g_pm_handle,
+                        (1 << POWER_THROTTLE_STATE_POWER_UP) |
+                            ((cm_utilization >= DVFS_UTIL_BOOST_PERCENT) ?
+                                 POWER_THROTTLE_BOOST_EVENT :
+                                 0),
+                        eSetBits);
+        }
+        // Check if the minions have been mostly waiting for a while
+        else if (pwr_updated && (cm_utilization <= DVFS_UTIL_DOWN_PERCENT) &&
+                 (minion_curr_frequency > minion_min_frequency) &&
+                 (++g_dvfs_low_util_samples >= DVFS_DOWN_HYSTERESIS_SAMPLES))
+        {
+            g_dvfs_low_util_samples = 0;
+
+            // Log the event
+            Log_Write(LOG_LEVEL_INFO, "Low utilization throttle down event, utilization: %u\n",
+                      (uint32_t)cm_utilization);
 
-            // Do the power throttling up
-            xTaskNotify(g_pm_handle, 1 << POWER_THROTTLE_STATE_POWER_UP, eSetBits);
+            // Do the power throttling down
+            xTaskNotify(g_pm_handle, 1 << POWER_THROTTLE_STATE_POWER_DOWN, eSetBits);
         }
         else
         {
@@ -1009,105 +1054,18 @@ int get_module_soc_power(uint16_t *soc_pwr_10mw)
 ***********************************************************************/
 int get_module_voltage(struct module_voltage_t *module_voltage)
 {
+    struct module_voltage_t voltage = { 0 };
     int status;
-    uint8_t temp = 0;
-
-    status = pmic_get_voltage(MODULE_DDR, &temp);
-    if (status == STATUS_SUCCESS)
-    {
-        g_pmic_power_reg.module_voltage.ddr = temp;
-    }
-    else
-    {
-        Log_Write(LOG_LEVEL_ERROR, "%s: Unable to get DDR voltage from PMIC. Status: %d\r\n",
-                  __func__, status);
-    }
-
-    status = pmic_get_voltage(MODULE_L2CACHE, &temp);
-    if (status == STATUS_SUCCESS)
-    {
-        g_pmic_power_reg.module_voltage.l2_cache = temp;
-    }
-    else
-    {
-        Log_Write(LOG_LEVEL_ERROR, "%s: Unable to get L2 Cache voltage from PMIC. Status: %d\r\n",
-                  __func__, status);
-    }
-
-    status = pmic_get_voltage(MODULE_MAXION, &temp);
-    if (status == STATUS_SUCCESS)
-    {
-        g_pmic_power_reg.module_voltage.maxion = temp;
-    }
-    else
-    {
-        Log_Write(LOG_LEVEL_ERROR, "%s: Unable to get Maxion voltage from PMIC. Status: %d\r\n",
-                  __func__, status);
-    }
-
-    status = pmic_get_voltage(MODULE_MINION, &temp);
-    if (status == STATUS_SUCCESS)
-    {
-        g_pmic_power_reg.module_voltage.minion = temp;
-    }
-    else
-    {
-        Log_Write(LOG_LEVEL_ERROR, "%s: Unable to get Minion voltage from PMIC. Status: %d\r\n",
-                  __func__, status);
-    }
-
-    status = pmic_get_voltage(MODULE_PCIE, &temp);
-    if (status == STATUS_SUCCESS)
-    {
-        g_pmic_power_reg.module_voltage.pcie = temp;
-    }
-    else
-    {
-        Log_Write(LOG_LEVEL_ERROR, "%s: Unable to get PCIe voltage from PMIC. Status: %d\r\n",
-                  __func__, status);
-    }
 
-    status = pmic_get_voltage(MODULE_NOC, &temp);
+    /* All the voltage registers are read in a single I2C burst */
+    status = pmic_get_module_voltages(&voltage);
     if (status == STATUS_SUCCESS)
     {
-        g_pmic_power_reg.module_voltage.noc = temp;
+        g_pmic_power_reg.module_voltage = voltage;
     }
     else
     {
-        Log_Write(LOG_LEVEL_ERROR, "%s: Unable to get NOC voltage from PMIC. Status: %d\r\n",
-                  __func__, status);
-    }
-
-    status = pmic_get_voltage(MODULE_PCIE_LOGIC, &temp);
-    if (status == STATUS_SUCCESS)
-    {
-        g_pmic_power_reg.module_voltage.pcie_logic = temp;
-    }
-    else
-    {
-        Log_Write(LOG_LEVEL_ERROR, "%s: Unable to get PCIE Logic voltage from PMIC. Status: %d\r\n",
-                  __func__, status);
-    }
-
-    status = pmic_get_voltage(MODULE_VDDQLP, &temp);
-    if (status == STATUS_SUCCESS)
-    {
-        g_pmic_power_reg.module_voltage.vddqlp = temp;
-    }
-    else
-    {
-        Log_Write(LOG_LEVEL_ERROR, "%s: Unable to get VDDQLP voltage from PMIC. Status: %d\r\n",
-                  __func__, status);
-    }
-
-    status = pmic_get_voltage(MODULE_VDDQ, &temp);
-    if (status == STATUS_SUCCESS)
-    {
-        g_pmic_power_reg.module_voltage.vddq = temp;
-    }
-    else
-    {
-        Log_Write(LOG_LEVEL_ERROR, "%s: Unable to get VDDQ voltage from PMIC. Status: %d\r\n",
+        Log_Write(LOG_LEVEL_ERROR, "%s: Unable to get module voltages from PMIC. Status: %d\r\n",
                   __func__, status);
     }
 
@@ -1666,6 +1624,17 @@ int init_thermal_pwr_mgmt_service(void)
         }
     }
 
+    if (status == STATUS_SUCCESS)
+    {
+        g_dvfs_idle_timer = xTimerCreateStatic("DVFS_IDLE", pdMS_TO_TICKS(DVFS_IDLE_HOLD_MS),
+                                               pdFALSE, (void *)0, dvfs_idle_timer_cb,
+                                               &g_dvfs_idle_timer_buffer);
+        if (!g_dvfs_idle_timer)
+        {
+            Log_Write(LOG_LEVEL_WARNING, "DVFS idle timer creation failed, no idle hold\n");
+        }
+    }
+
     if (status == STATUS_SUCCESS)
     {
         /* Set default parameters */
@@ -1850,6 +1819,15 @@ set_minion_operating_point_and_update_pwr_status(uint16_t new_freq,
 
     Update_Minion_Frequency_Global_Reg(new_freq);
 
+    /* Let MM know, it reports the frequency and throttle events of the kernels to the host */
+    if (MM_Iface_Send_Operating_Point_Event(
+            new_freq, (power_status->throttle_state == POWER_THROTTLE_STATE_POWER_DOWN) ||
+                          (power_status->throttle_state == POWER_THROTTLE_STATE_POWER_SAFE)) !=
+        STATUS_SUCCESS)
+    {
+        Log_Write(LOG_LEVEL_WARNING, "Failed to notify MM of the new operating point\n");
+    }
+
     power_status->tgt_freq = new_freq;
     power_status->tgt_voltage = g_pmic_power_reg.module_voltage.minion;
 
@@ -1920,6 +1898,7 @@ reduce_minion_operating_point_and_update_pwr_status(struct trace_event_power_sta
 *   INPUTS
 *
 *       power_status              power status trace log entry
+*       boost                     go to the max frequency instead of the next point
 *
 *   OUTPUTS
 *
@@ -1927,7 +1906,7 @@ reduce_minion_operating_point_and_update_pwr_status(struct trace_event_power_sta
 *
 ***********************************************************************/
 static int increase_minion_operating_point_and_update_pwr_status(
-    struct trace_event_power_status_t *power_status)
+    struct trace_event_power_status_t *power_status, bool boost)
 {
     uint16_t minion_curr_frequency = (uint16_t)Get_Minion_Frequency();
     uint16_t minion_max_frequency = g_soc_power_reg.vmin_lut_limits.mnn_frequency_max_limit;
@@ -1939,6 +1918,11 @@ static int increase_minion_operating_point_and_update_pwr_status(
         // Allow increasing minion operation point from the SAFE state
         new_freq = g_soc_power_reg.vmin_lut_limits.mnn_frequency_min_limit;
     }
+    else if (boost)
+    {
+        // Bursts of work go straight to the highest point of the vmin lut
+        new_freq = minion_max_frequency;
+    }
     else
     {
         status = flash_fs_get_vmin_lut_minion_next_frequency_point(minion_curr_frequency,
@@ -2146,7 +2130,7 @@ update_module_throttle_time_on_state_change(power_throttle_state_e current_throt
 static int processPowerThrottling(power_throttle_state_e current_throttle_state,
                                   power_throttle_state_e new_throttle_state,
                                   struct trace_event_power_status_t *power_status,
-                                  uint64_t *start_time)
+                                  uint64_t *start_time, bool boost)
 {
     int status;
 
@@ -2186,7 +2170,7 @@ static int processPowerThrottling(power_throttle_state_e current_throttle_state,
         }
         case POWER_THROTTLE_STATE_POWER_UP: {
             // Set minion operation point
-            status = increase_minion_operating_point_and_update_pwr_status(power_status);
+            status = increase_minion_operating_point_and_update_pwr_status(power_status, boost);
             break;
         }
         default: {
@@ -2285,7 +2269,7 @@ void thermal_power_task_entry(void *pvParameter)
 
         // Process event
         status = processPowerThrottling(current_throttle_state, new_throttle_state, &power_status,
-                                        &start_time);
+                                        &start_time, (value & POWER_THROTTLE_BOOST_EVENT) != 0);
         if (status == SUCCESS)
         {
             // Update current throttle state
@@ -3088,6 +3072,37 @@ static void set_mm_state(uint32_t state)
     }
 }
 
+/************************************************************************
+*
+*   FUNCTION
+*
+*       dvfs_idle_timer_cb
+*
+*   DESCRIPTION
+*
+*       Callback of the DVFS idle timer, runs in the timer task once MM
+*       has been idle for DVFS_IDLE_HOLD_MS. The timer is stopped when MM
+*       turns busy again.
+*
+*   INPUTS
+*
+*       timer    Expired timer
+*
+*   OUTPUTS
+*
+*       None
+*
+***********************************************************************/
+static void dvfs_idle_timer_cb(TimerHandle_t timer)
+{
+    (void)timer;
+
+    // Log the event
+    Log_Write(LOG_LEVEL_INFO, "Power idle state event\n");
+    // Go to idle state
+    xTaskNotify(g_pm_handle, 1 << POWER_THROTTLE_STATE_POWER_IDLE, eSetBits);
+}
+
 /************************************************************************
 *
 *   FUNCTION
@@ -3109,20 +3124,70 @@ static void set_mm_state(uint32_t state)
 ***********************************************************************/
 void Thermal_Pwr_Mgmt_Update_MM_State(uint64_t state)
 { //called in context of mm_cmd_hdlr_task
+    uint32_t current_state = get_mm_state();
 
-    // Switch to power throttling idle state if minion has turned to idle
-    if ((get_mm_state() != MM_STATE_IDLE) && (state == MM_STATE_IDLE))
+    // Switch to power throttling idle state if minion stays idle for DVFS_IDLE_HOLD_MS
+    if ((current_state != MM_STATE_IDLE) && (state == MM_STATE_IDLE))
     {
-        // Log the event
-        Log_Write(LOG_LEVEL_INFO, "Power idle state event\n");
-        // Go to idle state
-        xTaskNotify(g_pm_handle, 1 << POWER_THROTTLE_STATE_POWER_IDLE, eSetBits);
+        if ((g_dvfs_idle_timer == NULL) || (xTimerReset(g_dvfs_idle_timer, 0) != pdPASS))
+        {
+            // Log the event
+            Log_Write(LOG_LEVEL_INFO, "Power idle state event\n");
+            // Go to idle state
+            xTaskNotify(g_pm_handle, 1 << POWER_THROTTLE_STATE_POWER_IDLE, eSetBits);
+        }
+    }
+    // Boost a new burst of work, unless it comes within the idle hold time
+    else if ((current_state == MM_STATE_IDLE) && (state != MM_STATE_IDLE))
+    {
+        bool idle_pending = (g_dvfs_idle_timer != NULL) && xTimerIsTimerActive(g_dvfs_idle_timer);
+
+        if (idle_pending)
+        {
+            xTimerStop(g_dvfs_idle_timer, 0);
+        }
+        else if ((g_soc_power_reg.active_power_management == ACTIVE_POWER_MANAGEMENT_TURN_ON) &&
+                 (Get_Minion_Frequency() < g_soc_power_reg.vmin_lut_limits.mnn_frequency_max_limit))
+        {
+            // Log the event
+            Log_Write(LOG_LEVEL_INFO, "Power boost event\n");
+            xTaskNotify(g_pm_handle,
+                        (1 << POWER_THROTTLE_STATE_POWER_UP) | POWER_THROTTLE_BOOST_EVENT,
+                        eSetBits);
+        }
     }
 
     // update Master Minion(MM) state
     set_mm_state((uint32_t)state);
 }
 
+/************************************************************************
+*
+*   FUNCTION
+*
+*       Thermal_Pwr_Mgmt_Is_Throttling_Active
+*
+*   DESCRIPTION
+*
+*       This function checks if the power and thermal samples can lead
+*       to throttling, that is if active power management is on and MM
+*       is not idle.
+*
+*   INPUTS
+*
+*       None
+*
+*   OUTPUTS
+*
+*       bool     true if the throttling conditions are checked
+*
+***********************************************************************/
+bool Thermal_Pwr_Mgmt_Is_Throttling_Active(void)
+{
+    return (g_soc_power_reg.active_power_management == ACTIVE_POWER_MANAGEMENT_TURN_ON) &&
+           (get_mm_state() != MM_STATE_IDLE);
+}
+
 static int validate_vmin_lut_values_unset(uint16_t freq, uint8_t voltage)
 {
     if ((freq == 0) && (voltage != 0))
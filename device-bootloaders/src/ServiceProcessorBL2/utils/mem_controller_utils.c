@@ -73,6 +73,13 @@ static void ms_update_dram_status_system_memshire(void)
     }
 }
 
+void ms_set_dram_status(uint32_t memshire, ms_status_t status)
+{
+    ms_setup_dram_status();
+    ms_set_dram_status_physical_memshire(memshire, status);
+    ms_update_dram_status_system_memshire();
+}
+
 static inline uint32_t ms_peek_ddrc_reg(uint32_t memshire, uint32_t blk, uint64_t reg,
                                         uint32_t wait_value, uint32_t wait_mask)
 {
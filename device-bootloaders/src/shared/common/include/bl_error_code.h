@@ -85,6 +85,7 @@
 #define ERROR_SPI_FLASH_PARTITION_CRC_MISMATCH     -5028
 #define ERROR_SPI_FLASH_BL2_INFO_VMIN_MISMATCH     -5029
 #define ERROR_SPI_FLASH_BL2_INFO_CFG_PERS_MISMATCH -5030
+#define ERROR_SPI_FLASH_DDR_CACHE_MISMATCH         -5031
 
 /*! \def PMIC I2C Error Codes. */
 #define ERROR_PMIC_I2C_READ_FAILED                   -6000
@@ -228,4 +229,7 @@
 #define ERROR_FW_UPDATE_IMG_REGION_CFG_DATA_WRONG_SIZE     -16021
 #define ERROR_FW_UPDATE_WRITE_CFG_REGION                   -16022
 #define ERROR_FW_UPDATE_WRITE_CFG_REGION_MEMCOMPARE        -16023
+#define ERROR_FW_UPDATE_PATCH_INVALID                      -16024
+#define ERROR_FW_UPDATE_PATCH_BASE_MISMATCH                -16025
+#define ERROR_FW_UPDATE_PATCH_CRC_MISMATCH                 -16026
 #endif
@@ -6,6 +6,7 @@
 #include "device-layer/IDeviceLayer.h"
 #include "deviceManagement/DeviceManagement.h"
 #include "esperanto/et-trace/layout.h"
+#include <algorithm>
 #include <array>
 #include <atomic>
 #include <chrono>
@@ -23,6 +24,7 @@
 #include <iomanip>
 #include <iostream>
 #include <memory>
+#include <poll.h>
 #include <regex>
 #include <sstream>
 #include <string>
@@ -101,7 +103,7 @@ struct vq_stats_t {
 class EtTop {
 public:
   EtTop(int defDevNum, std::unique_ptr<dev::IDeviceLayer>& dl, device_management::DeviceManagement& dm, bool batchMode,
-        uint64_t updateLimit);
+        uint64_t updateLimit, std::chrono::milliseconds refreshInterval);
   void processInput(void);
   void displayStatsGraph(void);
   void displayStats(void);
@@ -113,6 +115,7 @@ public:
   struct mem_stats_t getMemStats(void);
   device_mgmt_api::asic_frequencies_t getFreqStats(void);
   device_mgmt_api::module_voltage_t getModuleVoltStats(void);
+  std::chrono::milliseconds getRefreshInterval(void);
 
 private:
   void collectDeviceDetails(void);
@@ -129,14 +132,16 @@ private:
   void collectErrStats(void);
   void collectAerStats(void);
   void collectVqStats(void);
-  void collectSpStats(void);
-  void collectMmStats(void);
-  void collectFreqStats(void);
-  void collectVoltStats(void);
+  void collectDeviceStats(void);
+  void updateSpStats(const device_mgmt_api::get_sp_stats_t& spStats);
+  void updateMmStats(const device_mgmt_api::get_mm_stats_t& mmStats);
+  void dumpStatsBuffers(void);
+  void renderFrame(const std::string& frame);
 
   int devNum_;
   bool batchMode_;
   uint64_t updateLimit_;
+  std::chrono::milliseconds refreshInterval_;
   bool stop_;
   bool refreshDeviceDetails_;
   bool displayWattsBars_;
@@ -161,6 +166,7 @@ private:
   device_mgmt_api::asic_frequencies_t freqStats_;
   device_mgmt_api::module_voltage_t moduleVoltStats_;
   device_mgmt_api::asic_voltage_t asicVoltStats_;
+  std::vector<std::string> lastFrame_; // lines on screen, empty to redraw the whole screen
 };
 
 const char* opUnitToString(op_value_unit unit);
\ No newline at end of file
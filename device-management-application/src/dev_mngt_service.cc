@@ -385,6 +385,28 @@ void dumpRawTraceBuffer(int deviceIdx, const std::vector<std::byte>& traceBuf, T
   }
 }
 
+// Reads the valid data of a trace buffer. For the buffers without sub-buffers the header tells how much data there
+// is, so only that is copied instead of the whole buffer
+bool getTraceBuffer(DeviceManagement& dm, TraceBufferType bufferType, std::vector<std::byte>& buf) {
+  buf.resize(sizeof(trace_buffer_std_header_t));
+  if (dm.readTraceBufferServiceProcessor(node, bufferType, 0, buf) == device_mgmt_api::DM_STATUS_SUCCESS &&
+      buf.size() == sizeof(trace_buffer_std_header_t)) {
+    auto traceHdr = templ::bit_cast<const trace_buffer_std_header_t*>(buf.data());
+    uint32_t dataSize = traceHdr->data_size;
+    if (traceHdr->magic_header == TRACE_MAGIC_HEADER && traceHdr->sub_buffer_count <= 1 &&
+        dataSize >= sizeof(trace_buffer_std_header_t)) {
+      std::vector<std::byte> data(dataSize - sizeof(trace_buffer_std_header_t));
+      if (dm.readTraceBufferServiceProcessor(node, bufferType, sizeof(trace_buffer_std_header_t), data) ==
+            device_mgmt_api::DM_STATUS_SUCCESS &&
+          data.size() == dataSize - sizeof(trace_buffer_std_header_t)) {
+        buf.insert(buf.end(), data.begin(), data.end());
+        return true;
+      }
+    }
+  }
+  return dm.getTraceBufferServiceProcessor(node, bufferType, buf) == device_mgmt_api::DM_STATUS_SUCCESS;
+}
+
 void check_dm_events(DeviceManagement& dm) {
   std::vector<std::byte> response;
   bool event_occured = dm.getDMEvent(node, response, 10);
@@ -393,8 +415,7 @@ void check_dm_events(DeviceManagement& dm) {
     if (rCB->info.event_hdr.msg_id == device_mgmt_api::DM_EVENT_SP_TRACE_BUFFER_FULL) {
       DM_VLOG(LOW) << "SP Buffer FULL event recieved, extracting traces" << std::endl;
       std::vector<std::byte> buf;
-      if (dm.getTraceBufferServiceProcessor(node, TraceBufferType::TraceBufferSP, buf) !=
-          device_mgmt_api::DM_STATUS_SUCCESS) {
+      if (!getTraceBuffer(dm, TraceBufferType::TraceBufferSP, buf)) {
         DM_LOG(INFO) << "Unable to get trace buffer for node: " << node << std::endl;
       }
       dumpRawTraceBuffer(node, buf, TraceBufferType::TraceBufferSP);
@@ -2325,7 +2346,7 @@ bool doTraceOperation() {
   };
   auto extractTrace = [&]() {
     std::vector<std::byte> buf;
-    if (dm.getTraceBufferServiceProcessor(node, given_trace_type, buf) != device_mgmt_api::DM_STATUS_SUCCESS) {
+    if (!getTraceBuffer(dm, given_trace_type, buf)) {
       DM_LOG(INFO) << "Unable to get trace buffer for node: " << node << std::endl;
       return false;
     }
@@ -46,6 +46,17 @@ const char* opUnitToString(op_value_unit unit) {
   }
 }
 
+// Waits up to timeout milliseconds (forever if negative) for input on stdin, returns true if there is some
+static inline bool waitForStdin(int timeout) {
+  struct pollfd pfd = {STDIN_FILENO, POLLIN, 0};
+  auto rc = poll(&pfd, 1, timeout);
+  if (rc == -1 && errno != EINTR) {
+    std::cerr << "poll on stdin error: " << std::strerror(errno);
+    exit(1);
+  }
+  return rc > 0;
+}
+
 static inline char getCharFromStdin(bool echoOnStdout = false) {
   char ch = 0;
   while (true) {
@@ -53,7 +64,9 @@ static inline char getCharFromStdin(bool echoOnStdout = false) {
     if (rc == -1) {
       std::cerr << "read on stdin error: " << std::strerror(errno);
       exit(1);
-    } else if (rc > 0) {
+    } else if (rc == 0) {
+      waitForStdin(-1);
+    } else {
       if (echoOnStdout) {
         std::cout << ch;
       }
@@ -76,10 +89,11 @@ static inline std::string getLineFromStdin(size_t strLength, bool echoOnStdout =
 }
 
 EtTop::EtTop(int defDevNum, std::unique_ptr<dev::IDeviceLayer>& dl, device_management::DeviceManagement& dm,
-             bool batchMode, uint64_t updateLimit)
+             bool batchMode, uint64_t updateLimit, std::chrono::milliseconds refreshInterval)
   : devNum_(defDevNum)
   , batchMode_(batchMode)
   , updateLimit_(updateLimit)
+  , refreshInterval_(refreshInterval)
   , stop_(false)
   , refreshDeviceDetails_(true)
   , displayWattsBars_(false)
@@ -97,6 +111,10 @@ EtTop::EtTop(int defDevNum, std::unique_ptr<dev::IDeviceLayer>& dl, device_manag
   mmStats_.cycle = 0;
 }
 
+std::chrono::milliseconds EtTop::getRefreshInterval(void) {
+  return refreshInterval_;
+}
+
 bool EtTop::stopStats(void) {
   return stop_;
 }
@@ -110,14 +128,7 @@ void EtTop::collectStats(void) {
   collectErrStats();
   collectAerStats();
   collectVqStats();
-  collectSpStats();
-  collectMmStats();
-  if (displayFreqDetails_) {
-    collectFreqStats();
-  }
-  if (displayVoltDetails_) {
-    collectVoltStats();
-  }
+  collectDeviceStats();
   return;
 }
 
@@ -290,88 +301,97 @@ void EtTop::collectAerStats(void) {
   return;
 }
 
-void EtTop::collectSpStats(void) {
-  uint32_t hostLatency;
-  uint64_t deviceLatency;
-  std::vector<char> outputBuff(sizeof(device_mgmt_api::get_sp_stats_t), 0);
-
-  auto ret = dm_.serviceRequest(devNum_, device_mgmt_api::DM_CMD::DM_CMD_GET_SP_STATS, nullptr, 0, outputBuff.data(),
-                                outputBuff.size(), &hostLatency, &deviceLatency, kDmServiceRequestTimeout);
-  if (ret != device_mgmt_api::DM_STATUS_SUCCESS) {
-    DV_LOG(ERROR) << "Service request get sp stats failed with return code: " << std::dec << ret << std::endl;
-  } else {
-    auto* sp_stats = static_cast<device_mgmt_api::get_sp_stats_t*>(static_cast<void*>(outputBuff.data()));
-
-    spStats_.op.system.power.avg = sp_stats->system_power_avg;
-    spStats_.op.system.power.min = sp_stats->system_power_min;
-    spStats_.op.system.power.max = sp_stats->system_power_max;
-    spStats_.op.system.temperature.avg = sp_stats->system_temperature_avg;
-    spStats_.op.system.temperature.min = sp_stats->system_temperature_min;
-    spStats_.op.system.temperature.max = sp_stats->system_temperature_max;
-
-    spStats_.op.minion.power.avg = sp_stats->minion_power_avg;
-    spStats_.op.minion.power.min = sp_stats->minion_power_min;
-    spStats_.op.minion.power.max = sp_stats->minion_power_max;
-    spStats_.op.minion.temperature.avg = sp_stats->minion_temperature_avg;
-    spStats_.op.minion.temperature.min = sp_stats->minion_temperature_min;
-    spStats_.op.minion.temperature.max = sp_stats->minion_temperature_max;
-    spStats_.op.minion.voltage.avg = sp_stats->minion_voltage_avg;
-    spStats_.op.minion.voltage.min = sp_stats->minion_voltage_min;
-    spStats_.op.minion.voltage.max = sp_stats->minion_voltage_max;
-    spStats_.op.minion.freq.avg = sp_stats->minion_freq_avg;
-    spStats_.op.minion.freq.min = sp_stats->minion_freq_min;
-    spStats_.op.minion.freq.max = sp_stats->minion_freq_max;
-
-    spStats_.op.sram.power.avg = sp_stats->sram_power_avg;
-    spStats_.op.sram.power.min = sp_stats->sram_power_min;
-    spStats_.op.sram.power.max = sp_stats->sram_power_max;
-    spStats_.op.sram.temperature.avg = sp_stats->sram_temperature_avg;
-    spStats_.op.sram.temperature.min = sp_stats->sram_temperature_min;
-    spStats_.op.sram.temperature.max = sp_stats->sram_temperature_max;
-    spStats_.op.sram.voltage.avg = sp_stats->sram_voltage_avg;
-    spStats_.op.sram.voltage.min = sp_stats->sram_voltage_min;
-    spStats_.op.sram.voltage.max = sp_stats->sram_voltage_max;
-    spStats_.op.sram.freq.avg = sp_stats->sram_freq_avg;
-    spStats_.op.sram.freq.min = sp_stats->sram_freq_min;
-    spStats_.op.sram.freq.max = sp_stats->sram_freq_max;
-
-    spStats_.op.noc.power.avg = sp_stats->noc_power_avg;
-    spStats_.op.noc.power.min = sp_stats->noc_power_min;
-    spStats_.op.noc.power.max = sp_stats->noc_power_max;
-    spStats_.op.noc.temperature.avg = sp_stats->noc_temperature_avg;
-    spStats_.op.noc.temperature.min = sp_stats->noc_temperature_min;
-    spStats_.op.noc.temperature.max = sp_stats->noc_temperature_max;
-    spStats_.op.noc.voltage.avg = sp_stats->noc_voltage_avg;
-    spStats_.op.noc.voltage.min = sp_stats->noc_voltage_min;
-    spStats_.op.noc.voltage.max = sp_stats->noc_voltage_max;
-    spStats_.op.noc.freq.avg = sp_stats->noc_freq_avg;
-    spStats_.op.noc.freq.min = sp_stats->noc_freq_min;
-    spStats_.op.noc.freq.max = sp_stats->noc_freq_max;
+void EtTop::collectDeviceStats(void) {
+  // All the device stats go in one batch, which costs one round-trip to the SP per refresh
+  device_mgmt_api::get_sp_stats_t spStats = {};
+  device_mgmt_api::get_mm_stats_t mmStats = {};
+  std::vector<device_management::dm_request> requests;
+  auto addRequest = [&requests](device_mgmt_api::DM_CMD cmd, void* output, uint32_t size) {
+    device_management::dm_request request;
+    request.cmd_code = cmd;
+    request.output_buff = static_cast<char*>(output);
+    request.output_size = size;
+    requests.push_back(request);
+  };
+  addRequest(device_mgmt_api::DM_CMD::DM_CMD_GET_SP_STATS, &spStats, sizeof(spStats));
+  addRequest(device_mgmt_api::DM_CMD::DM_CMD_GET_MM_STATS, &mmStats, sizeof(mmStats));
+  if (displayFreqDetails_) {
+    addRequest(device_mgmt_api::DM_CMD_GET_ASIC_FREQUENCIES, &freqStats_, sizeof(freqStats_));
+  }
+  if (displayVoltDetails_) {
+    addRequest(device_mgmt_api::DM_CMD_GET_MODULE_VOLTAGE, &moduleVoltStats_, sizeof(moduleVoltStats_));
+    addRequest(device_mgmt_api::DM_CMD_GET_ASIC_VOLTAGE, &asicVoltStats_, sizeof(asicVoltStats_));
   }
 
-  if (dumpNextSpStatsBuffer_) {
-    dumpNextSpStatsBuffer_ = false;
-
-    std::vector<std::byte> response;
-    if (dm_.getTraceBufferServiceProcessor(devNum_, TraceBufferType::TraceBufferSPStats, response) !=
-        device_mgmt_api::DM_STATUS_SUCCESS) {
-      DV_LOG(ERROR) << "getTraceBufferServiceProcessor SPStats error";
-    } else {
-      auto fileName = getNewFileName(devNum_, true /* SP */);
-      std::ofstream spTrace;
-      spTrace.open(fileName, std::ios_base::binary | std::ios_base::out | std::ios_base::trunc);
-      if (!spTrace.is_open()) {
-        DV_LOG(ERROR) << "Error: unable to open file " << fileName << std::endl;
-      } else {
-        spTrace.write(reinterpret_cast<const char*>(response.data()), response.size());
-        spTrace.close();
+  uint32_t hostLatency;
+  auto ret = dm_.serviceRequests(devNum_, requests, &hostLatency, kDmServiceRequestTimeout);
+  if (ret != device_mgmt_api::DM_STATUS_SUCCESS) {
+    for (const auto& request : requests) {
+      if (request.status != device_mgmt_api::DM_STATUS_SUCCESS) {
+        DV_LOG(ERROR) << "Service request " << request.cmd_code << " failed with return code: " << std::dec
+                      << request.status << std::endl;
       }
     }
   }
+  if (requests[0].status == device_mgmt_api::DM_STATUS_SUCCESS) {
+    updateSpStats(spStats);
+  }
+  if (requests[1].status == device_mgmt_api::DM_STATUS_SUCCESS) {
+    updateMmStats(mmStats);
+  }
 
+  dumpStatsBuffers();
   return;
 }
 
+void EtTop::updateSpStats(const device_mgmt_api::get_sp_stats_t& spStats) {
+  spStats_.op.system.power.avg = spStats.system_power_avg;
+  spStats_.op.system.power.min = spStats.system_power_min;
+  spStats_.op.system.power.max = spStats.system_power_max;
+  spStats_.op.system.temperature.avg = spStats.system_temperature_avg;
+  spStats_.op.system.temperature.min = spStats.system_temperature_min;
+  spStats_.op.system.temperature.max = spStats.system_temperature_max;
+
+  spStats_.op.minion.power.avg = spStats.minion_power_avg;
+  spStats_.op.minion.power.min = spStats.minion_power_min;
+  spStats_.op.minion.power.max = spStats.minion_power_max;
+  spStats_.op.minion.temperature.avg = spStats.minion_temperature_avg;
+  spStats_.op.minion.temperature.min = spStats.minion_temperature_min;
+  spStats_.op.minion.temperature.max = spStats.minion_temperature_max;
+  spStats_.op.minion.voltage.avg = spStats.minion_voltage_avg;
+  spStats_.op.minion.voltage.min = spStats.minion_voltage_min;
+  spStats_.op.minion.voltage.max = spStats.minion_voltage_max;
+  spStats_.op.minion.freq.avg = spStats.minion_freq_avg;
+  spStats_.op.minion.freq.min = spStats.minion_freq_min;
+  spStats_.op.minion.freq.max = spStats.minion_freq_max;
+
+  spStats_.op.sram.power.avg = spStats.sram_power_avg;
+  spStats_.op.sram.power.min = spStats.sram_power_min;
+  spStats_.op.sram.power.max = spStats.sram_power_max;
+  spStats_.op.sram.temperature.avg = spStats.sram_temperature_avg;
+  spStats_.op.sram.temperature.min = spStats.sram_temperature_min;
+  spStats_.op.sram.temperature.max = spStats.sram_temperature_max;
+  spStats_.op.sram.voltage.avg = spStats.sram_voltage_avg;
+  spStats_.op.sram.voltage.min = spStats.sram_voltage_min;
+  spStats_.op.sram.voltage.max = spStats.sram_voltage_max;
+  spStats_.op.sram.freq.avg = spStats.sram_freq_avg;
+  spStats_.op.sram.freq.min = spStats.sram_freq_min;
+  spStats_.op.sram.freq.max = spStats.sram_freq_max;
+
+  spStats_.op.noc.power.avg = spStats.noc_power_avg;
+  spStats_.op.noc.power.min = spStats.noc_power_min;
+  spStats_.op.noc.power.max = spStats.noc_power_max;
+  spStats_.op.noc.temperature.avg = spStats.noc_temperature_avg;
+  spStats_.op.noc.temperature.min = spStats.noc_temperature_min;
+  spStats_.op.noc.temperature.max = spStats.noc_temperature_max;
+  spStats_.op.noc.voltage.avg = spStats.noc_voltage_avg;
+  spStats_.op.noc.voltage.min = spStats.noc_voltage_min;
+  spStats_.op.noc.voltage.max = spStats.noc_voltage_max;
+  spStats_.op.noc.freq.avg = spStats.noc_freq_avg;
+  spStats_.op.noc.freq.min = spStats.noc_freq_min;
+  spStats_.op.noc.freq.max = spStats.noc_freq_max;
+}
+
 void EtTop::collectDeviceDetails(void) {
   uint32_t hostLatency;
   uint64_t deviceLatency;
@@ -399,81 +419,62 @@ void EtTop::collectDeviceDetails(void) {
   }
 }
 
-void EtTop::collectFreqStats(void) {
-  uint32_t hostLatency;
-  uint64_t deviceLatency;
-  auto ret = dm_.serviceRequest(devNum_, device_mgmt_api::DM_CMD_GET_ASIC_FREQUENCIES, nullptr, 0,
-                                static_cast<char*>(static_cast<void*>(&freqStats_)), sizeof(freqStats_), &hostLatency,
-                                &deviceLatency, kDmServiceRequestTimeout);
-  if (ret != device_mgmt_api::DM_STATUS_SUCCESS) {
-    DV_LOG(ERROR) << "Service request get asic frequencies failed with return code: " << std::dec << ret << std::endl;
-  }
+void EtTop::updateMmStats(const device_mgmt_api::get_mm_stats_t& mmStats) {
+  mmStats_.computeResources.cm_bw.avg = mmStats.cm_bw_avg;
+  mmStats_.computeResources.cm_bw.min = mmStats.cm_bw_min;
+  mmStats_.computeResources.cm_bw.max = mmStats.cm_bw_max;
+  mmStats_.computeResources.cm_utilization.avg = mmStats.cm_utilization_avg;
+  mmStats_.computeResources.cm_utilization.min = mmStats.cm_utilization_min;
+  mmStats_.computeResources.cm_utilization.max = mmStats.cm_utilization_max;
+
+  mmStats_.computeResources.pcie_dma_read_utilization.avg = mmStats.pcie_dma_read_utilization_avg;
+  mmStats_.computeResources.pcie_dma_read_utilization.min = mmStats.pcie_dma_read_utilization_min;
+  mmStats_.computeResources.pcie_dma_read_utilization.max = mmStats.pcie_dma_read_utilization_max;
+  mmStats_.computeResources.pcie_dma_write_utilization.avg = mmStats.pcie_dma_write_utilization_avg;
+  mmStats_.computeResources.pcie_dma_write_utilization.min = mmStats.pcie_dma_write_utilization_min;
+  mmStats_.computeResources.pcie_dma_write_utilization.max = mmStats.pcie_dma_write_utilization_max;
+
+  mmStats_.computeResources.pcie_dma_read_bw.avg = mmStats.pcie_dma_read_bw_avg;
+  mmStats_.computeResources.pcie_dma_read_bw.min = mmStats.pcie_dma_read_bw_min;
+  mmStats_.computeResources.pcie_dma_read_bw.max = mmStats.pcie_dma_read_bw_max;
+  mmStats_.computeResources.pcie_dma_write_bw.avg = mmStats.pcie_dma_write_bw_avg;
+  mmStats_.computeResources.pcie_dma_write_bw.min = mmStats.pcie_dma_write_bw_min;
+  mmStats_.computeResources.pcie_dma_write_bw.max = mmStats.pcie_dma_write_bw_max;
+
+  mmStats_.computeResources.ddr_read_bw.avg = mmStats.ddr_read_bw_avg;
+  mmStats_.computeResources.ddr_read_bw.min = mmStats.ddr_read_bw_min;
+  mmStats_.computeResources.ddr_read_bw.max = mmStats.ddr_read_bw_max;
+  mmStats_.computeResources.ddr_write_bw.avg = mmStats.ddr_write_bw_avg;
+  mmStats_.computeResources.ddr_write_bw.min = mmStats.ddr_write_bw_min;
+  mmStats_.computeResources.ddr_write_bw.max = mmStats.ddr_write_bw_max;
+
+  mmStats_.computeResources.l2_l3_read_bw.avg = mmStats.l2_l3_read_bw_avg;
+  mmStats_.computeResources.l2_l3_read_bw.min = mmStats.l2_l3_read_bw_min;
+  mmStats_.computeResources.l2_l3_read_bw.max = mmStats.l2_l3_read_bw_max;
+  mmStats_.computeResources.l2_l3_write_bw.avg = mmStats.l2_l3_write_bw_avg;
+  mmStats_.computeResources.l2_l3_write_bw.min = mmStats.l2_l3_write_bw_min;
+  mmStats_.computeResources.l2_l3_write_bw.max = mmStats.l2_l3_write_bw_max;
 }
 
-void EtTop::collectVoltStats(void) {
-  uint32_t hostLatency;
-  uint64_t deviceLatency;
-  auto ret = dm_.serviceRequest(devNum_, device_mgmt_api::DM_CMD_GET_MODULE_VOLTAGE, nullptr, 0,
-                                static_cast<char*>(static_cast<void*>(&moduleVoltStats_)), sizeof(moduleVoltStats_),
-                                &hostLatency, &deviceLatency, kDmServiceRequestTimeout);
-  if (ret != device_mgmt_api::DM_STATUS_SUCCESS) {
-    DV_LOG(ERROR) << "Service request get module voltage failed with return code: " << std::dec << ret << std::endl;
-  }
-  ret = dm_.serviceRequest(devNum_, device_mgmt_api::DM_CMD_GET_ASIC_VOLTAGE, nullptr, 0,
-                           static_cast<char*>(static_cast<void*>(&asicVoltStats_)), sizeof(asicVoltStats_),
-                           &hostLatency, &deviceLatency, kDmServiceRequestTimeout);
-  if (ret != device_mgmt_api::DM_STATUS_SUCCESS) {
-    DV_LOG(ERROR) << "Service request get asic voltage failed with return code: " << std::dec << ret << std::endl;
-  }
-}
-
-void EtTop::collectMmStats(void) {
-  uint32_t hostLatency;
-  uint64_t deviceLatency;
-  std::vector<char> outputBuff(sizeof(device_mgmt_api::get_mm_stats_t), 0);
-
-  auto ret = dm_.serviceRequest(devNum_, device_mgmt_api::DM_CMD::DM_CMD_GET_MM_STATS, nullptr, 0, outputBuff.data(),
-                                outputBuff.size(), &hostLatency, &deviceLatency, kDmServiceRequestTimeout);
+void EtTop::dumpStatsBuffers(void) {
+  if (dumpNextSpStatsBuffer_) {
+    dumpNextSpStatsBuffer_ = false;
 
-  if (ret != device_mgmt_api::DM_STATUS_SUCCESS) {
-    DV_LOG(ERROR) << "Service request get mm stats failed with return code: " << std::dec << ret << std::endl;
-  } else {
-    auto* mm_stats = static_cast<device_mgmt_api::get_mm_stats_t*>(static_cast<void*>(outputBuff.data()));
-
-    mmStats_.computeResources.cm_bw.avg = mm_stats->cm_bw_avg;
-    mmStats_.computeResources.cm_bw.min = mm_stats->cm_bw_min;
-    mmStats_.computeResources.cm_bw.max = mm_stats->cm_bw_max;
-    mmStats_.computeResources.cm_utilization.avg = mm_stats->cm_utilization_avg;
-    mmStats_.computeResources.cm_utilization.min = mm_stats->cm_utilization_min;
-    mmStats_.computeResources.cm_utilization.max = mm_stats->cm_utilization_max;
-
-    mmStats_.computeResources.pcie_dma_read_utilization.avg = mm_stats->pcie_dma_read_utilization_avg;
-    mmStats_.computeResources.pcie_dma_read_utilization.min = mm_stats->pcie_dma_read_utilization_min;
-    mmStats_.computeResources.pcie_dma_read_utilization.max = mm_stats->pcie_dma_read_utilization_max;
-    mmStats_.computeResources.pcie_dma_write_utilization.avg = mm_stats->pcie_dma_write_utilization_avg;
-    mmStats_.computeResources.pcie_dma_write_utilization.min = mm_stats->pcie_dma_write_utilization_min;
-    mmStats_.computeResources.pcie_dma_write_utilization.max = mm_stats->pcie_dma_write_utilization_max;
-
-    mmStats_.computeResources.pcie_dma_read_bw.avg = mm_stats->pcie_dma_read_bw_avg;
-    mmStats_.computeResources.pcie_dma_read_bw.min = mm_stats->pcie_dma_read_bw_min;
-    mmStats_.computeResources.pcie_dma_read_bw.max = mm_stats->pcie_dma_read_bw_max;
-    mmStats_.computeResources.pcie_dma_write_bw.avg = mm_stats->pcie_dma_write_bw_avg;
-    mmStats_.computeResources.pcie_dma_write_bw.min = mm_stats->pcie_dma_write_bw_min;
-    mmStats_.computeResources.pcie_dma_write_bw.max = mm_stats->pcie_dma_write_bw_max;
-
-    mmStats_.computeResources.ddr_read_bw.avg = mm_stats->ddr_read_bw_avg;
-    mmStats_.computeResources.ddr_read_bw.min = mm_stats->ddr_read_bw_min;
-    mmStats_.computeResources.ddr_read_bw.max = mm_stats->ddr_read_bw_max;
-    mmStats_.computeResources.ddr_write_bw.avg = mm_stats->ddr_write_bw_avg;
-    mmStats_.computeResources.ddr_write_bw.min = mm_stats->ddr_write_bw_min;
-    mmStats_.computeResources.ddr_write_bw.max = mm_stats->ddr_write_bw_max;
-
-    mmStats_.computeResources.l2_l3_read_bw.avg = mm_stats->l2_l3_read_bw_avg;
-    mmStats_.computeResources.l2_l3_read_bw.min = mm_stats->l2_l3_read_bw_min;
-    mmStats_.computeResources.l2_l3_read_bw.max = mm_stats->l2_l3_read_bw_max;
-    mmStats_.computeResources.l2_l3_write_bw.avg = mm_stats->l2_l3_write_bw_avg;
-    mmStats_.computeResources.l2_l3_write_bw.min = mm_stats->l2_l3_write_bw_min;
-    mmStats_.computeResources.l2_l3_write_bw.max = mm_stats->l2_l3_write_bw_max;
+    std::vector<std::byte> response;
+    if (dm_.getTraceBufferServiceProcessor(devNum_, TraceBufferType::TraceBufferSPStats, response) !=
+        device_mgmt_api::DM_STATUS_SUCCESS) {
+      DV_LOG(ERROR) << "getTraceBufferServiceProcessor SPStats error";
+    } else {
+      auto fileName = getNewFileName(devNum_, true /* SP */);
+      std::ofstream spTrace;
+      spTrace.open(fileName, std::ios_base::binary | std::ios_base::out | std::ios_base::trunc);
+      if (!spTrace.is_open()) {
+        DV_LOG(ERROR) << "Error: unable to open file " << fileName << std::endl;
+      } else {
+        spTrace.write(reinterpret_cast<const char*>(response.data()), response.size());
+        spTrace.close();
+      }
+    }
   }
 
   if (dumpNextMmStatsBuffer_) {
@@ -496,8 +497,6 @@ void EtTop::collectMmStats(void) {
       }
     }
   }
-
-  return;
 }
 
 void EtTop::resetStats(void) {
@@ -532,6 +531,9 @@ void EtTop::processInput(void) {
     }
 
     if (rc == 0) {
+      if (help) {
+        waitForStdin(-1);
+      }
       continue;
     }
 
@@ -557,6 +559,7 @@ void EtTop::processInput(void) {
         std::cerr << "error calling system\n";
         exit(EXIT_FAILURE);
       }
+      lastFrame_.clear();
       std::cout << "Switch to device [0-" << dl_->getDevicesCount() - 1 << "] (<ENTER> to continue): ";
       while (true) {
         auto str = getLineFromStdin(2 /* 2-digit string */, true);
@@ -583,6 +586,7 @@ void EtTop::processInput(void) {
         std::cerr << "error calling system\n";
         exit(EXIT_FAILURE);
       }
+      lastFrame_.clear();
       std::cout << "d\tDump next trace stats buffers to mm_stats.bin and sp_stats.bin files\n"
                 << "e\tToggle display of error details\n"
                 << "f\tToggle display of frequency details\n"
@@ -755,13 +759,13 @@ void EtTop::displayStats(void) {
     stop_ = true;
   }
 
+  // Outside batch mode the frame is built off screen, then only the lines which changed are drawn
+  std::ostringstream frame;
+  std::streambuf* stdoutBuf = nullptr;
   if (batchMode_) {
     std::cout << std::endl;
   } else {
-    if (system("clear") == -1) {
-      std::cerr << "error calling system\n";
-      exit(EXIT_FAILURE);
-    }
+    stdoutBuf = std::cout.rdbuf(frame.rdbuf());
   }
   time_t now;
   char nowbuf[30];
@@ -873,11 +877,56 @@ void EtTop::displayStats(void) {
   }
   if (!batchMode_) {
     std::cout << "Type 'h' for help ";
+    std::cout.rdbuf(stdoutBuf);
+    renderFrame(frame.str());
   }
 
   return;
 }
 
+void EtTop::renderFrame(const std::string& frame) {
+  std::vector<std::string> lines;
+  std::istringstream is(frame);
+  for (std::string line; std::getline(is, line);) {
+    // Expand the tabs, so that the columns of a line match its characters
+    std::string expanded;
+    for (auto ch : line) {
+      if (ch == '\t') {
+        expanded.append(8 - expanded.size() % 8, ' ');
+      } else {
+        expanded.push_back(ch);
+      }
+    }
+    lines.push_back(std::move(expanded));
+  }
+
+  std::string out;
+  if (lastFrame_.empty()) {
+    out = "\033[H\033[2J";
+  }
+  for (size_t row = 0; row < lines.size(); row++) {
+    size_t col = 0;
+    if (row < lastFrame_.size()) {
+      if (lines[row] == lastFrame_[row]) {
+        continue;
+      }
+      auto& old = lastFrame_[row];
+      auto diff = std::mismatch(lines[row].begin(), lines[row].end(), old.begin(), old.end());
+      col = static_cast<size_t>(diff.first - lines[row].begin());
+    }
+    out += "\033[" + std::to_string(row + 1) + ";" + std::to_string(col + 1) + "H" + lines[row].substr(col) + "\033[K";
+  }
+  for (size_t row = lines.size(); row < lastFrame_.size(); row++) {
+    out += "\033[" + std::to_string(row + 1) + ";1H\033[K";
+  }
+  if (!lines.empty()) {
+    out += "\033[" + std::to_string(lines.size()) + ";" + std::to_string(lines.back().size() + 1) + "H";
+  }
+
+  std::cout << out << std::flush;
+  lastFrame_ = std::move(lines);
+}
+
 int main(int argc, char** argv) {
   char* endptr = NULL;
   long int devNum = 0;
@@ -973,7 +1022,7 @@ int main(int argc, char** argv) {
 
     struct termios new_termios = orig_termios;
     new_termios.c_lflag &= ~(ICANON | ECHO);
-    new_termios.c_cc[VTIME] = 1;
+    new_termios.c_cc[VTIME] = 0;
     new_termios.c_cc[VMIN] = 0;
     if (tcsetattr(STDIN_FILENO, TCSANOW, &new_termios) != 0) {
       DV_LOG(ERROR) << "tcsetattr on stdin error: " << std::strerror(errno);
@@ -986,7 +1035,7 @@ int main(int argc, char** argv) {
    */
   std::unique_ptr<dev::IDeviceLayer> dl = dev::IDeviceLayer::createPcieDeviceLayer(false, true);
   device_management::DeviceManagement& dm = device_management::DeviceManagement::getInstance(dl.get());
-  EtTop etTop(devNum, dl, dm, batchMode, updateLimit);
+  EtTop etTop(devNum, dl, dm, batchMode, updateLimit, delay);
 
   auto checkPoint = std::chrono::steady_clock::now();
   if (resetStats) {
@@ -997,14 +1046,16 @@ int main(int argc, char** argv) {
     etTop.displayStatsGraph();
   } else {
     while (!etTop.stopStats()) {
-      if (!batchMode) {
-        etTop.processInput();
-      }
-
-      if (checkPoint > std::chrono::steady_clock::now()) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      // Sleep until the next update, unless a key is pressed
+      auto now = std::chrono::steady_clock::now();
+      if (checkPoint > now) {
+        if (batchMode) {
+          std::this_thread::sleep_until(checkPoint);
+        } else if (waitForStdin(std::chrono::ceil<std::chrono::milliseconds>(checkPoint - now).count())) {
+          etTop.processInput();
+        }
       } else {
-        checkPoint = std::chrono::steady_clock::now() + delay;
+        checkPoint = now + delay;
         etTop.collectStats();
         etTop.displayStats();
       }
@@ -618,10 +618,15 @@ void renderMainDisplay(Component powerView, Component ddrView, Component scView,
   // TODO:Spin new threads
   std::atomic<bool> refreshUiContinue = true;
   std::thread refreshUi([&] {
+    // The UI ticks every 30ms, the device is only asked for stats at the refresh interval
+    auto nextCollect = std::chrono::steady_clock::now();
     while (refreshUiContinue) {
       using namespace std::chrono_literals;
       std::this_thread::sleep_for(0.03s);
-      etTop->collectStats();
+      if (auto now = std::chrono::steady_clock::now(); now >= nextCollect) {
+        nextCollect = now + etTop->getRefreshInterval();
+        etTop->collectStats();
+      }
       getAllData(etTop->getMmStats(), etTop->getSpStats(), etTop->getFreqStats(), etTop->getModuleVoltStats(), cWIDTH);
       // The |shift| variable belong to the main thread. `screen.Post(task)`
       // will execute the update on the thread where |screen| lives (e.g. the
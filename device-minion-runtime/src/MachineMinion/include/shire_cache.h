@@ -81,4 +81,27 @@ static inline void sc_cache_bank_op(uint64_t shire, uint64_t bank, uint64_t op)
     sc_idx_cop_sm_ctl_wait_idle(addr);
 }
 
+/* Value of a SC_SCP_CACHE_CTL, SC_L2_CACHE_CTL or SC_L3_CACHE_CTL ESR (they share the same
+   layout) for a region of size sets starting at set base, with the set and tag masks computed
+   as the SP BL2 does when it configures the shire cache at boot */
+static inline uint64_t sc_cache_ctl_value(uint64_t base, uint64_t size)
+{
+    const uint64_t high_bit = (size <= 1) ? 0 : 64U - (uint64_t)__builtin_clzll(size - 1);
+    const uint64_t set_mask = (high_bit > 0) ? ((1ULL << high_bit) - 1) : 0;
+    uint64_t tag_mask = 0;
+
+    if (high_bit > 0)
+    {
+        tag_mask = ((1ULL << high_bit) == size) ? ((1ULL << high_bit) - 1) :
+                                                  ((1ULL << (high_bit - 1)) - 1);
+    }
+
+    return ((base & 0xFFFULL) << 48) | ((size & 0x1FFFULL) << 32) | ((set_mask & 0xFFFULL) << 16) |
+           (tag_mask & 0xFFFULL);
+}
+
+/* Set base and set size fields of a shire cache region control ESR value */
+#define SC_CACHE_CTL_SET_BASE(value) (((value) >> 48) & 0xFFFULL)
+#define SC_CACHE_CTL_SET_SIZE(value) (((value) >> 32) & 0x1FFFULL)
+
 #endif // ! SHIRE_CACHE_H
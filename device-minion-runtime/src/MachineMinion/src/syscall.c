@@ -55,6 +55,7 @@ static int64_t evict_l3(void);
 static int64_t evict_l1_l2_all(void);
 
 static int64_t shire_cache_bank_op_with_params(uint64_t shire, uint64_t bank, uint64_t op);
+static int64_t shire_cache_config(uint64_t scp_sets, uint64_t l2_sets);
 
 static inline void l1_shared_to_split(
     uint64_t scp_en, uint64_t cacheop_reprate, uint64_t cacheop_max);
@@ -139,6 +140,9 @@ int64_t syscall_handler(uint64_t number, uint64_t arg1, uint64_t arg2, uint64_t
         case SYSCALL_PMC_MS_SAMPLE_ALL_INT:
             ret = sample_ms_pmcs_all(arg1, (shire_pmc_cnt_t *)arg2);
             break;
+        case SYSCALL_SHIRE_CACHE_CONFIG_INT:
+            ret = shire_cache_config(arg1, arg2);
+            break;
         default:
             ret = SYSCALL_INTERNAL_INVALID_ID;
             break;
@@ -547,6 +551,71 @@ static int64_t shire_cache_bank_op_with_params(uint64_t shire, uint64_t bank, ui
     }
 }
 
+/************************************************************************
+*
+*   FUNCTION
+*
+*       shire_cache_config
+*
+*   DESCRIPTION
+*
+*       Repartitions the SCP and L2 regions of all the shire cache banks of
+*       this shire. The L3 region is shared by all the shires, so it is kept
+*       as configured at boot and the new SCP and L2 regions must fill the
+*       sets below it. Nothing is done if the partition is already the
+*       requested one. Otherwise the L2 is evicted and invalidated around the
+*       update, so the caller must make sure no other hart of the shire
+*       accesses memory until it returns.
+*
+*   INPUTS
+*
+*       scp_sets       SCP sets per bank
+*       l2_sets        L2 sets per bank
+*
+*   OUTPUTS
+*
+*       int64_t        SYSCALL_INTERNAL_SUCCESS or SYSCALL_INTERNAL_INVALID_ARGS
+*
+***********************************************************************/
+static int64_t shire_cache_config(uint64_t scp_sets, uint64_t l2_sets)
+{
+    volatile uint64_t *const scp_ctl =
+        (volatile uint64_t *)ESR_CACHE(THIS_SHIRE, 0xF, SC_SCP_CACHE_CTL);
+    volatile uint64_t *const l2_ctl =
+        (volatile uint64_t *)ESR_CACHE(THIS_SHIRE, 0xF, SC_L2_CACHE_CTL);
+    const uint64_t l3_base =
+        SC_CACHE_CTL_SET_BASE(*(volatile uint64_t *)ESR_CACHE(THIS_SHIRE, 0, SC_L3_CACHE_CTL));
+    const uint64_t scp_cur = *(volatile uint64_t *)ESR_CACHE(THIS_SHIRE, 0, SC_SCP_CACHE_CTL);
+    const uint64_t l2_cur = *(volatile uint64_t *)ESR_CACHE(THIS_SHIRE, 0, SC_L2_CACHE_CTL);
+
+    /* Same constraints as the boot time configuration: even sizes and at least 0x40 L2 sets */
+    if (((scp_sets + l2_sets) != l3_base) || ((scp_sets % 2) != 0) || ((l2_sets % 2) != 0) ||
+        (l2_sets < 0x40U))
+    {
+        return SYSCALL_INTERNAL_INVALID_ARGS;
+    }
+
+    if ((SC_CACHE_CTL_SET_SIZE(scp_cur) == scp_sets) && (SC_CACHE_CTL_SET_SIZE(l2_cur) == l2_sets))
+    {
+        return SYSCALL_INTERNAL_SUCCESS;
+    }
+
+    /* Write back and drop all the L2 lines, they would be looked up in the wrong sets */
+    sc_idx_cop_sm_ctl_all_banks_wait_idle(THIS_SHIRE);
+    sc_idx_cop_sm_ctl_all_banks_go(THIS_SHIRE, SC_CACHEOP_OPCODE_L2_EVICT);
+    sc_idx_cop_sm_ctl_all_banks_wait_idle(THIS_SHIRE);
+
+    /* Broadcast the new partition to all the banks */
+    *scp_ctl = sc_cache_ctl_value(0, scp_sets);
+    *l2_ctl = sc_cache_ctl_value(scp_sets, l2_sets);
+
+    /* Invalidate the sets that changed region */
+    sc_idx_cop_sm_ctl_all_banks_go(THIS_SHIRE, SC_CACHEOP_OPCODE_L2_INV);
+    sc_idx_cop_sm_ctl_all_banks_wait_idle(THIS_SHIRE);
+
+    return SYSCALL_INTERNAL_SUCCESS;
+}
+
 // change L1 configuration from Shared to Split, optionally with Scratchpad enabled
 static inline void l1_shared_to_split(
     uint64_t scp_en, uint64_t cacheop_reprate, uint64_t cacheop_max)
@@ -138,15 +138,47 @@
 
 /*! \def MM_SQ_COUNT
     \brief A macro that provides the Master Minion submission queue
-    count
+    count. Each SQ has its own SQ Worker, so it can be raised at build time
+    (up to MM_SQ_MAX_SUPPORTED) for hosts driving many streams. The host
+    gets it from the DIRs.
 */
+#ifndef MM_SQ_COUNT
 #define MM_SQ_COUNT 2
+#endif
 
 /*! \def MM_SQ_MAX_SUPPORTED
     \brief Maximum supported submission queues by Master Minion
 */
 #define MM_SQ_MAX_SUPPORTED 4
 
+/*! \def MM_SQ_PRIORITY_IDX
+    \brief Index of the submission queue used by the host runtime for high
+    priority streams. It is serviced first by the Dispatcher and it is the only
+    SQ allowed to use the DMA channels reserved by MM_SQ_PRIORITY_DMA_CHANNELS.
+    Its kernels also take the kernel slots and shires they wait for ahead of
+    the kernels of the other SQs.
+    \warning Must be kept in sync with the host runtime (QueueHelper).
+*/
+#define MM_SQ_PRIORITY_IDX (MM_SQ_COUNT - 1U)
+
+/*! \def MM_SQ_PRIORITY_DMA_CHANNELS
+    \brief Number of DMA read and write channels which can only be reserved
+    by the priority submission queue, so its transfers don't wait behind big
+    transfers submitted to the other SQs.
+*/
+#define MM_SQ_PRIORITY_DMA_CHANNELS 1U
+
+/*! \def DMAW_STRIPE_MIN_SIZE
+    \brief Minimum number of bytes transferred by each channel a DMA list is
+    striped across. Lists smaller than twice this size use a single channel.
+*/
+#define DMAW_STRIPE_MIN_SIZE SIZE_1MB
+
+/*! \def DMAW_STRIPE_ALIGNMENT
+    \brief Alignment of the boundaries between the stripes of a DMA list.
+*/
+#define DMAW_STRIPE_ALIGNMENT 0x1000U
+
 /*! \def MM_SQ_HP_SIZE
     \brief A macro that provides size of the Master Minion
     high priority submission queue. All HP submision queues will be of same size.
@@ -174,6 +206,12 @@
 */
 #define MM_SQ_MEM_TYPE UNCACHED
 
+/*! \def MM_SQ_PREFETCH_ALIGNMENT
+    \brief A macro that provides the alignment kept by the SQ commands when they are
+    prefetched into L2 SCP, so the prefetch can copy them with 256-bit accesses
+*/
+#define MM_SQ_PREFETCH_ALIGNMENT 32U
+
 /*! \def MM_SQ_HP_OFFSET
     \brief A macro that provides the PCI BAR region offset relative to
     MM_VQ_BAR using which the Master Minion high priority submission queues can be accessed
@@ -205,26 +243,40 @@
 */
 #define MM_CQ_OFFSET (MM_SQ_HP_OFFSET + (MM_SQ_HP_COUNT * MM_SQ_HP_SIZE))
 
-/*! \def MM_CQ_SIZE
-    \brief A macro that provides size of the Master Minion
-    completion queue.
-*/
-#define MM_CQ_SIZE 0x600UL
-
 /*! \def MM_CQ_COUNT
     \brief A macro that provides the Master Minion completion queue
-    count
+    count. Each CQ gets the responses of the SQs paired with it, see MM_CQ_FOR_SQ
 */
-#define MM_CQ_COUNT 1
+#define MM_CQ_COUNT MM_SQ_COUNT
 
 /*! \def MM_CQ_MAX_SUPPORTED
     \brief Maximum supported completion queues by Master Minion
 */
-#define MM_CQ_MAX_SUPPORTED 1
+#define MM_CQ_MAX_SUPPORTED 4
+
+/*! \def MM_CQS_SIZE
+    \brief A macro that provides the size of the memory shared by
+    all the Master Minion completion queues.
+*/
+#define MM_CQS_SIZE 0x600UL
+
+/*! \def MM_CQ_SIZE
+    \brief A macro that provides size of the Master Minion
+    completion queue. All completion queues will be of same size.
+*/
+#define MM_CQ_SIZE (MM_CQS_SIZE / MM_CQ_COUNT)
+
+/*! \def MM_CQ_FOR_SQ
+    \brief A macro that provides the completion queue receiving the
+    responses of the commands popped from the given submission queue.
+    Asynchronous events (not tied to any SQ) go to CQ 0.
+*/
+#define MM_CQ_FOR_SQ(sq_id) ((uint8_t)((sq_id) % MM_CQ_COUNT))
 
 /*! \def MM_CQ_NOTIFY_VECTOR
     \brief A macro that provides the starting PCIe interrupt vector for
-    CQ notifications
+    CQ notifications. CQ[i] notifies on MM_CQ_NOTIFY_VECTOR + i, the
+    remaining CQs share the last vector enabled by the host.
 */
 #define MM_CQ_NOTIFY_VECTOR 3
 
@@ -246,9 +298,12 @@
 #define MM_BASE_ID 2048U
 
 /*! \def MM_MAX_PARALLEL_KERNELS
-    \brief Maximum number of kerenls in parallel supported by MM runtime
+    \brief Maximum number of kernels in parallel supported by MM runtime.
+    Each kernel needs its own Kernel Worker, and kernels running in parallel
+    must be launched on disjoint shire masks.
+    \warning Must be kept in sync with the host runtime (kMaxConcurrentKernels).
 */
-#define MM_MAX_PARALLEL_KERNELS 1
+#define MM_MAX_PARALLEL_KERNELS 2
 
 /*! \def DISPATCHER_BASE_HART_ID
     \brief Base HART ID for the Dispatcher
@@ -274,7 +329,8 @@
 
 /*! \def SQW_BASE_HART_ID
     \brief Base HART ID for the Submission Queue Worker
-    Note that SQ workers use even harts of the same Minion.
+    Note that SQ workers use even harts of the same Minion. The workers
+    below are laid out one after the other from it, one Minion each.
     \warning DO NOT MODIFY!
 */
 #define SQW_BASE_HART_ID 2050U
@@ -311,9 +367,9 @@
 #define SQW_HP_NUM MM_SQ_HP_COUNT
 
 /*! \def KW_BASE_HART_ID
-    \brief Base HART ID for the Kernel Worker
+    \brief Base HART ID for the Kernel Worker, right after the SQ Workers
 */
-#define KW_BASE_HART_ID 2054U
+#define KW_BASE_HART_ID (SQW_BASE_HART_ID + (SQW_NUM * HARTS_PER_MINION))
 
 /*! \def KW_MS_BASE_HART
     \brief Base HART number in Master Shire for the kernel workers
@@ -332,20 +388,38 @@
 */
 #define KW_NUM MM_MAX_PARALLEL_KERNELS
 
+/*! \def KW_LAUNCH_PREFETCH_ARGS_LINES
+    \brief Cache lines of non embedded kernel arguments prefetched into L3 before a launch
+    requesting it (KERNEL_LAUNCH_CONFIG_FLAGS_PREFETCH).
+    Embedded arguments don't need it, they are copied and evicted to L3 by the Kernel Worker.
+*/
+#define KW_LAUNCH_PREFETCH_ARGS_LINES 16U
+
 /*! \def DMAW_BASE_HART_ID
-    \brief Base HART ID for the DMA Worker
+    \brief Base HART ID for the DMA Worker, right after the Kernel Workers
 */
-#define DMAW_BASE_HART_ID 2058U
+#define DMAW_BASE_HART_ID (KW_BASE_HART_ID + (KW_NUM * HARTS_PER_MINION))
+
+/*! \def DMAW_NUM_PER_DIRECTION
+    \brief Number of DMA Workers polling the channels of each DMA direction.
+    Channels are split among the workers of their direction, so it can be
+    raised at build time (up to the channels per direction) when a single
+    worker can't keep up with the completions.
+*/
+#ifndef DMAW_NUM_PER_DIRECTION
+#define DMAW_NUM_PER_DIRECTION 1
+#endif
 
 /*! \def DMAW_NUM
-    \brief Number of DMA Workers
+    \brief Number of DMA Workers, the read ones go first
 */
-#define DMAW_NUM 2
+#define DMAW_NUM (2 * DMAW_NUM_PER_DIRECTION)
 
 /*! \def STATW_BASE_HART_ID
-    \brief Base HART ID for the Device Statistics Sampler Hart.
+    \brief Base HART ID for the Device Statistics Sampler Hart, right after
+    the DMA Workers.
 */
-#define STATW_BASE_HART_ID 2062U
+#define STATW_BASE_HART_ID (DMAW_BASE_HART_ID + (DMAW_NUM * HARTS_PER_MINION))
 
 /*! \def STATW_NUM
     \brief Number of DMA Workers
@@ -378,6 +452,10 @@ static_assert((MM_CQS_BASE_ADDRESS + (MM_CQ_COUNT * MM_CQ_SIZE)) <=
 static_assert(
     MM_SQ_COUNT <= MM_SQ_MAX_SUPPORTED, "Number of MM Submission Queues not within limits.");
 
+/* Ensure that MM CQs are within limits */
+static_assert(
+    MM_CQ_COUNT <= MM_CQ_MAX_SUPPORTED, "Number of MM Completion Queues not within limits.");
+
 /* Ensure that MM SQs, HP SQs and CQs size is within limits */
 static_assert(((MM_SQ_COUNT * MM_SQ_SIZE) + (MM_SQ_HP_COUNT * MM_SQ_HP_SIZE) +
                   (MM_CQ_COUNT * MM_CQ_SIZE)) <= MM_VQ_SIZE,
@@ -391,6 +469,22 @@ static_assert((SPW_BASE_HART_ID > DISPATCHER_BASE_HART_ID) && (SPW_BASE_HART_ID
 static_assert(MM_SQ_COUNT <= MM_SQ_COUNT_MAX,
     "Number of MM Submission Queues not synced with memory layout file.");
 
+/* Ensure that kernel slots are in sync with FW memory layout */
+static_assert(MM_MAX_PARALLEL_KERNELS <= MAX_SIMULTANEOUS_KERNELS,
+    "Number of parallel kernels not synced with memory layout file.");
+
+/* Ensure that KW Hart IDs don't overlap with DMA workers */
+static_assert((KW_BASE_HART_ID + (KW_NUM * HARTS_PER_MINION)) <= DMAW_BASE_HART_ID,
+    "Kernel Worker Hart ID overlapping");
+
+/* Ensure that there is one DMA worker per direction at least */
+static_assert(DMAW_NUM_PER_DIRECTION >= 1, "Number of DMA Workers per direction not within limits.");
+
+/* Ensure that all the workers fit in the Master Minion harts */
+static_assert((STATW_BASE_HART_ID + STATW_NUM) <=
+                  (MM_BASE_ID + HARTS_PER_SHIRE - MASTER_SHIRE_COMPUTE_HARTS),
+    "Master Minion workers don't fit in the Master Minion harts.");
+
 /* Ensure that MM SQ size is in sync with FW memory layout */
 static_assert(MM_SQ_SIZE <= MM_SQ_SIZE_MAX,
     "Size of MM Submission Queues not synced with memory layout file.");
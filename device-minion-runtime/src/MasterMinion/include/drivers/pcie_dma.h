@@ -151,6 +151,38 @@ int32_t dma_config_read_add_link_node(dma_read_chan_id_e chan, uint32_t index);
 */
 int32_t dma_config_write_add_link_node(dma_write_chan_id_e chan, uint32_t index);
 
+/*! \fn int32_t dma_config_read_add_chain(uint64_t chain_addr, uint32_t elem_count,
+    uint64_t host_addr, uint64_t host_size, dma_read_chan_id_e chan, uint64_t *size)
+    \brief This function makes the DMA transfer list run a chain of data
+    elements resident in device DRAM, followed by a spare element overwritten
+    with the link element ending the chain.
+    \param chain_addr Address of the chain in device DRAM
+    \param elem_count Number of data elements of the chain
+    \param host_addr Bus address of the host buffer the data elements refer to
+    \param host_size Size of the host buffer
+    \param chan DMA channel ID
+    \param size Pointer to the total size of the chain transfers
+    \return Status success or error
+*/
+int32_t dma_config_read_add_chain(uint64_t chain_addr, uint32_t elem_count, uint64_t host_addr,
+    uint64_t host_size, dma_read_chan_id_e chan, uint64_t *size);
+
+/*! \fn int32_t dma_config_write_add_chain(uint64_t chain_addr, uint32_t elem_count,
+    uint64_t host_addr, uint64_t host_size, dma_write_chan_id_e chan, uint64_t *size)
+    \brief This function makes the DMA transfer list run a chain of data
+    elements resident in device DRAM, followed by a spare element overwritten
+    with the link element ending the chain.
+    \param chain_addr Address of the chain in device DRAM
+    \param elem_count Number of data elements of the chain
+    \param host_addr Bus address of the host buffer the data elements refer to
+    \param host_size Size of the host buffer
+    \param chan DMA channel ID
+    \param size Pointer to the total size of the chain transfers
+    \return Status success or error
+*/
+int32_t dma_config_write_add_chain(uint64_t chain_addr, uint32_t elem_count, uint64_t host_addr,
+    uint64_t host_size, dma_write_chan_id_e chan, uint64_t *size);
+
 /*! \fn int32_t dma_start_read(dma_read_chan_id_e chan)
     \brief This function triggers DMA read for specified channel.
     \param chan DMA channel ID
@@ -34,6 +34,737 @@ typedef struct execution_cycles_ {
     uint64_t wait_cycles;
 } __attribute__((packed, aligned(8))) execution_cycles_t;
 
+/*! \def DEV_OPS_API_MID_DEVICE_OPS_STREAM_SYNC_CMD
+    \brief Message ID of the stream sync command. Taken from the end of the
+    device ops reserved range until the command is part of the device-api spec.
+    \warning Must be kept in sync with the host runtime (DeviceOpsExt.h).
+*/
+#define DEV_OPS_API_MID_DEVICE_OPS_STREAM_SYNC_CMD 1020U
+
+/*! \def DEV_OPS_API_MID_DEVICE_OPS_STREAM_SYNC_RSP
+    \brief Message ID of the stream sync command response.
+*/
+#define DEV_OPS_API_MID_DEVICE_OPS_STREAM_SYNC_RSP 1021U
+
+/*! \def MM_STREAM_SYNC_SLOTS
+    \brief Number of sync slots which can be signaled and waited on by the
+    stream sync command.
+*/
+#define MM_STREAM_SYNC_SLOTS 64U
+
+/*! \enum stream_sync_op_e
+    \brief Operation done by the stream sync command.
+    A signal (sent with the barrier flag, so all previous commands of its SQ are
+    complete) stores the token in the slot. A wait holds its SQ until the slot
+    contains the token and then clears the slot.
+*/
+enum stream_sync_op_e {
+    STREAM_SYNC_OP_SIGNAL = 0,
+    STREAM_SYNC_OP_WAIT = 1
+};
+
+/*! \enum stream_sync_response_e
+    \brief Status of the stream sync command response.
+*/
+enum stream_sync_response_e {
+    STREAM_SYNC_RESPONSE_SUCCESS = 0,
+    STREAM_SYNC_RESPONSE_HOST_ABORTED = 1,
+    STREAM_SYNC_RESPONSE_INVALID_SLOT = 2
+};
+
+/*! \struct device_ops_stream_sync_cmd_t
+    \brief Stream sync command, used to resolve dependencies between SQs
+    on the device without going through the host.
+*/
+struct device_ops_stream_sync_cmd_t {
+    struct cmd_header_t command_info;
+    uint16_t slot;  /* Sync slot, < MM_STREAM_SYNC_SLOTS */
+    uint16_t token; /* Value signaled/waited, non zero */
+    uint8_t op;     /* stream_sync_op_e */
+    uint8_t pad[3];
+} __attribute__((packed, aligned(8)));
+
+/*! \struct device_ops_stream_sync_rsp_t
+    \brief Stream sync command response.
+*/
+struct device_ops_stream_sync_rsp_t {
+    struct rsp_header_t response_info;
+    uint32_t status; /* stream_sync_response_e */
+    uint32_t pad;
+} __attribute__((packed, aligned(8)));
+
+/*! \def DEV_OPS_API_MID_DEVICE_OPS_CMD_CHAIN_CMD
+    \brief Message ID of the command chain command. Taken from the end of the
+    device ops reserved range until the command is part of the device-api spec.
+    \warning Must be kept in sync with the host runtime (DeviceOpsExt.h).
+*/
+#define DEV_OPS_API_MID_DEVICE_OPS_CMD_CHAIN_CMD 1018U
+
+/*! \def DEV_OPS_API_MID_DEVICE_OPS_CMD_CHAIN_RSP
+    \brief Message ID of the command chain command response.
+*/
+#define DEV_OPS_API_MID_DEVICE_OPS_CMD_CHAIN_RSP 1019U
+
+/*! \def MM_CMD_CHAIN_STAGES_MAX
+    \brief Maximum number of stages of a command chain.
+*/
+#define MM_CMD_CHAIN_STAGES_MAX 4U
+
+/*! \enum cmd_chain_response_e
+    \brief Status of the command chain response.
+*/
+enum cmd_chain_response_e {
+    CMD_CHAIN_RESPONSE_SUCCESS = 0,
+    CMD_CHAIN_RESPONSE_STAGE_FAILED = 1,
+    CMD_CHAIN_RESPONSE_HOST_ABORTED = 2,
+    CMD_CHAIN_RESPONSE_INVALID_STAGES = 3
+};
+
+/*! \struct device_ops_cmd_chain_cmd_t
+    \brief Command chain command. Its payload holds stage_count DMA writelist,
+    kernel launch or DMA readlist commands (P2P variants included), each one
+    starting 8 bytes aligned. The MM runs each stage once the previous one has
+    completed, and only the chain response is sent to the host: the stages'
+    own responses are consumed by the MM.
+*/
+struct device_ops_cmd_chain_cmd_t {
+    struct cmd_header_t command_info;
+    uint8_t stage_count; /* Number of stages, <= MM_CMD_CHAIN_STAGES_MAX */
+    uint8_t pad[7];
+    uint64_t stages[];   /* Stage commands */
+} __attribute__((packed, aligned(8)));
+
+/*! \struct device_ops_cmd_chain_rsp_t
+    \brief Command chain command response.
+*/
+struct device_ops_cmd_chain_rsp_t {
+    struct rsp_header_t response_info;
+    uint64_t device_cmd_start_ts;
+    uint64_t device_cmd_wait_dur;
+    uint64_t device_cmd_execute_dur;
+    uint32_t status;       /* cmd_chain_response_e */
+    uint32_t stage_status; /* Response status of the failed stage */
+    uint8_t failed_stage;  /* Index of the failed stage, stage_count if none */
+    uint8_t pad[7];
+} __attribute__((packed, aligned(8)));
+
+/*! \def DEV_OPS_API_MID_DEVICE_OPS_CMD_LIST_EXECUTE_CMD
+    \brief Message ID of the command list execute command. Taken from the end
+    of the device ops reserved range until the command is part of the
+    device-api spec.
+    \warning Must be kept in sync with the host runtime (DeviceOpsExt.h).
+*/
+#define DEV_OPS_API_MID_DEVICE_OPS_CMD_LIST_EXECUTE_CMD 1004U
+
+/*! \def DEV_OPS_API_MID_DEVICE_OPS_CMD_LIST_EXECUTE_RSP
+    \brief Message ID of the command list execute command response.
+*/
+#define DEV_OPS_API_MID_DEVICE_OPS_CMD_LIST_EXECUTE_RSP 1005U
+
+/*! \def MM_CMD_LIST_PATCHES_MAX
+    \brief Maximum number of patches of a command list execute command.
+*/
+#define MM_CMD_LIST_PATCHES_MAX 8U
+
+/*! \def MM_CMD_LIST_STAGE_SIZE_MAX
+    \brief Maximum size in bytes of a command of a command list.
+*/
+#define MM_CMD_LIST_STAGE_SIZE_MAX 512U
+
+/*! \enum cmd_list_response_e
+    \brief Status of the command list execute response.
+*/
+enum cmd_list_response_e {
+    CMD_LIST_RESPONSE_SUCCESS = 0,
+    CMD_LIST_RESPONSE_STAGE_FAILED = 1,
+    CMD_LIST_RESPONSE_HOST_ABORTED = 2,
+    CMD_LIST_RESPONSE_INVALID_LIST = 3 /* Malformed stage, or patch out of the list */
+};
+
+/*! \struct device_ops_cmd_list_patch_t
+    \brief 64-bit value replacing the one at the given offset of the command list,
+    only for one execution. The list in device memory is not modified.
+*/
+struct device_ops_cmd_list_patch_t {
+    uint64_t value;
+    uint32_t offset; /* Bytes from the beginning of the list, 8 bytes aligned */
+    uint32_t pad;
+} __attribute__((packed, aligned(8)));
+
+/*! \struct device_ops_cmd_list_execute_cmd_t
+    \brief Command list execute command. The list is uploaded once by the host
+    to device memory, and holds stage_count commands of the ones accepted by
+    a command chain, memset, device memcpy and kernel flush ranges commands
+    included, each one starting 8 bytes aligned. The MM runs them as the
+    stages of a command chain: in order, each one once the previous one has
+    completed, with the tag ID of this command, and only the list response
+    is sent to the host.
+*/
+struct device_ops_cmd_list_execute_cmd_t {
+    struct cmd_header_t command_info;
+    uint64_t list_address;     /* Device address of the list, 8 bytes aligned */
+    uint64_t exception_buffer; /* Replaces the kernel launches' one if not 0 */
+    uint64_t args_buffer;      /* Replaces the embedded args address of kernel launches if not 0 */
+    uint32_t list_size;        /* Size in bytes of the list */
+    uint32_t stage_count;      /* Number of commands in the list */
+    uint32_t patch_count;      /* Up to MM_CMD_LIST_PATCHES_MAX */
+    uint32_t pad;
+    struct device_ops_cmd_list_patch_t patches[MM_CMD_LIST_PATCHES_MAX];
+} __attribute__((packed, aligned(8)));
+
+/*! \struct device_ops_cmd_list_execute_rsp_t
+    \brief Command list execute command response.
+*/
+struct device_ops_cmd_list_execute_rsp_t {
+    struct rsp_header_t response_info;
+    uint64_t device_cmd_start_ts;
+    uint64_t device_cmd_wait_dur;
+    uint64_t device_cmd_execute_dur;
+    uint32_t status;       /* cmd_list_response_e */
+    uint32_t stage_status; /* Response status of the failed stage */
+    uint32_t failed_stage; /* Index of the failed stage, stage_count if none */
+    uint16_t stage_msg_id; /* Response message ID of the failed stage */
+    uint16_t pad;
+} __attribute__((packed, aligned(8)));
+
+/*! \def DEV_OPS_API_MID_DEVICE_OPS_MEMSET_CMD
+    \brief Message ID of the device memory fill command. Taken from the end of
+    the device ops reserved range until the command is part of the device-api spec.
+    \warning Must be kept in sync with the host runtime (DeviceOpsExt.h).
+*/
+#define DEV_OPS_API_MID_DEVICE_OPS_MEMSET_CMD 1016U
+
+/*! \def DEV_OPS_API_MID_DEVICE_OPS_MEMSET_RSP
+    \brief Message ID of the device memory fill command response.
+*/
+#define DEV_OPS_API_MID_DEVICE_OPS_MEMSET_RSP 1017U
+
+/*! \def MM_MEMSET_CHUNK_SIZE
+    \brief Bytes filled and evicted at once by the memset command. The SQ abort
+    state is checked between chunks.
+*/
+#define MM_MEMSET_CHUNK_SIZE (64U * 1024U)
+
+/*! \enum memset_response_e
+    \brief Status of the memset command response.
+*/
+enum memset_response_e {
+    MEMSET_RESPONSE_SUCCESS = 0,
+    MEMSET_RESPONSE_HOST_ABORTED = 1,
+    MEMSET_RESPONSE_INVALID_ADDRESS = 2,
+    MEMSET_RESPONSE_INVALID_PATTERN = 3
+};
+
+/*! \struct device_ops_memset_cmd_t
+    \brief Device memory fill command. The MM fills the host managed DRAM range
+    with the pattern, repeated, and evicts it to L3 so it is visible to the
+    compute minions and to the DMA engines. There is no PCIe traffic.
+*/
+struct device_ops_memset_cmd_t {
+    struct cmd_header_t command_info;
+    uint64_t dst_device_phy_addr; /* Aligned to pattern_size */
+    uint64_t size;                /* Multiple of pattern_size */
+    uint64_t pattern;             /* Little endian, only the first pattern_size bytes are used */
+    uint8_t pattern_size;         /* 1, 2, 4 or 8 bytes */
+    uint8_t pad[7];
+} __attribute__((packed, aligned(8)));
+
+/*! \struct device_ops_memset_rsp_t
+    \brief Device memory fill command response.
+*/
+struct device_ops_memset_rsp_t {
+    struct rsp_header_t response_info;
+    uint32_t status; /* memset_response_e */
+    uint32_t pad;
+} __attribute__((packed, aligned(8)));
+
+/*! \def DEV_OPS_API_MID_DEVICE_OPS_DEVICE_MEMCPY_CMD
+    \brief Message ID of the copy within the device memory command. Taken from
+    the end of the device ops reserved range until the command is part of the
+    device-api spec.
+    \warning Must be kept in sync with the host runtime (DeviceOpsExt.h).
+*/
+#define DEV_OPS_API_MID_DEVICE_OPS_DEVICE_MEMCPY_CMD 1014U
+
+/*! \def DEV_OPS_API_MID_DEVICE_OPS_DEVICE_MEMCPY_RSP
+    \brief Message ID of the copy within the device memory command response.
+*/
+#define DEV_OPS_API_MID_DEVICE_OPS_DEVICE_MEMCPY_RSP 1015U
+
+/*! \def MM_DEVICE_MEMCPY_CHUNK_SIZE
+    \brief Bytes copied and evicted at once by the device memcpy command. The SQ
+    abort state is checked between chunks.
+*/
+#define MM_DEVICE_MEMCPY_CHUNK_SIZE (64U * 1024U)
+
+/*! \enum device_memcpy_response_e
+    \brief Status of the device memcpy command response.
+*/
+enum device_memcpy_response_e {
+    DEVICE_MEMCPY_RESPONSE_SUCCESS = 0,
+    DEVICE_MEMCPY_RESPONSE_HOST_ABORTED = 1,
+    DEVICE_MEMCPY_RESPONSE_INVALID_ADDRESS = 2
+};
+
+/*! \struct device_ops_device_memcpy_cmd_t
+    \brief Copy between two host managed DRAM ranges of the same device. The MM
+    evicts the source lines from its caches, copies the data and evicts the
+    destination to L3. The ranges can overlap (memmove semantics).
+*/
+struct device_ops_device_memcpy_cmd_t {
+    struct cmd_header_t command_info;
+    uint64_t src_device_phy_addr;
+    uint64_t dst_device_phy_addr;
+    uint64_t size;
+} __attribute__((packed, aligned(8)));
+
+/*! \struct device_ops_device_memcpy_rsp_t
+    \brief Device memcpy command response.
+*/
+struct device_ops_device_memcpy_rsp_t {
+    struct rsp_header_t response_info;
+    uint32_t status; /* device_memcpy_response_e */
+    uint32_t pad;
+} __attribute__((packed, aligned(8)));
+
+/*! \def DEV_OPS_API_MID_DEVICE_OPS_DMA_CHAIN_CMD
+    \brief Message ID of the DMA chain command. Taken from the end of the
+    device ops reserved range until the command is part of the device-api spec.
+    \warning Must be kept in sync with the host runtime (DeviceOpsExt.h).
+*/
+#define DEV_OPS_API_MID_DEVICE_OPS_DMA_CHAIN_CMD 1012U
+
+/*! \def DEV_OPS_API_MID_DEVICE_OPS_DMA_CHAIN_RSP
+    \brief Message ID of the DMA chain command response.
+*/
+#define DEV_OPS_API_MID_DEVICE_OPS_DMA_CHAIN_RSP 1013U
+
+/*! \def MM_DMA_CHAIN_ELEMS_MAX
+    \brief Max number of data elements of a DMA chain.
+*/
+#define MM_DMA_CHAIN_ELEMS_MAX (64U * 1024U)
+
+/*! \def MM_DMA_CHAIN_ELEM_SIZE
+    \brief Size of a PCIe DMA linked list element of a DMA chain.
+*/
+#define MM_DMA_CHAIN_ELEM_SIZE 24U
+
+/*! \def MM_DMA_CHAIN_ALIGN
+    \brief Alignment of a DMA chain in device DRAM.
+*/
+#define MM_DMA_CHAIN_ALIGN 8U
+
+/*! \enum dma_chain_direction_e
+    \brief Direction of the data elements of a DMA chain.
+*/
+enum dma_chain_direction_e {
+    DMA_CHAIN_DIRECTION_HOST_TO_DEVICE = 0,
+    DMA_CHAIN_DIRECTION_DEVICE_TO_HOST = 1
+};
+
+/*! \struct device_ops_dma_chain_cmd_t
+    \brief Runs a chain of DMA linked list data elements already resident in
+    host managed DRAM (uploaded beforehand by the host) as a single transfer of
+    one DMA channel, whatever its number of elements. The chain is an array of
+    elem_count + 1 PCIe DMA linked list elements (MM_DMA_CHAIN_ELEM_SIZE bytes
+    each) aligned to MM_DMA_CHAIN_ALIGN: the data elements hold the size, and
+    the source and destination addresses. Their host side address is an offset
+    in the host buffer, whose bus address is filled in by the host driver: the
+    MM checks it against host_size and rewrites it with the bus address, so a
+    chain is consumed by the command. Their control words are rewritten by the
+    MM too, and the extra element is overwritten with the link element ending
+    the chain.
+*/
+struct device_ops_dma_chain_cmd_t {
+    struct cmd_header_t command_info;
+    uint64_t chain_device_phy_addr;
+    uint64_t host_virt_addr; /* Host buffer, only used by the host driver */
+    uint64_t host_phy_addr;  /* Bus address of the host buffer */
+    uint64_t host_size;      /* Size of the host buffer */
+    uint32_t elem_count;
+    uint8_t direction; /* dma_chain_direction_e */
+    uint8_t pad[3];
+} __attribute__((packed, aligned(8)));
+
+/*! \struct device_ops_dma_chain_rsp_t
+    \brief DMA chain command response, its status is a dma_response_e. Same
+    layout as the DMA list command responses.
+*/
+struct device_ops_dma_chain_rsp_t {
+    struct rsp_header_t response_info;
+    uint64_t device_cmd_start_ts;
+    uint64_t device_cmd_wait_dur;
+    uint64_t device_cmd_execute_dur;
+    uint32_t status; /* dma_response_e */
+    uint32_t pad;
+} __attribute__((packed, aligned(8)));
+
+/*! \def DEV_OPS_API_MID_DEVICE_OPS_KERNEL_HEAP_CONFIG_CMD
+    \brief Message ID of the kernel heap configuration command. Taken from the
+    end of the device ops reserved range until the command is part of the
+    device-api spec.
+    \warning Must be kept in sync with the host runtime (DeviceOpsExt.h).
+*/
+#define DEV_OPS_API_MID_DEVICE_OPS_KERNEL_HEAP_CONFIG_CMD 1010U
+
+/*! \def DEV_OPS_API_MID_DEVICE_OPS_KERNEL_HEAP_CONFIG_RSP
+    \brief Message ID of the kernel heap configuration command response.
+*/
+#define DEV_OPS_API_MID_DEVICE_OPS_KERNEL_HEAP_CONFIG_RSP 1011U
+
+/*! \enum kernel_heap_config_response_e
+    \brief Status of the kernel heap configuration command response.
+*/
+enum kernel_heap_config_response_e {
+    KERNEL_HEAP_CONFIG_RESPONSE_SUCCESS = 0,
+    KERNEL_HEAP_CONFIG_RESPONSE_HOST_ABORTED = 1,
+    KERNEL_HEAP_CONFIG_RESPONSE_INVALID_ADDRESS = 2,
+    KERNEL_HEAP_CONFIG_RESPONSE_KERNELS_RUNNING = 3
+};
+
+/*! \struct device_ops_kernel_heap_config_cmd_t
+    \brief Kernel heap configuration command. The host managed DRAM region is
+    split in an arena per compute shire (see system/abi.h), which kernels
+    allocate from with etsoc/common/heap.h. A size of 0 disables the heap.
+    It's refused while kernels are running, so it is sent with the barrier flag.
+*/
+struct device_ops_kernel_heap_config_cmd_t {
+    struct cmd_header_t command_info;
+    uint64_t heap_device_phy_addr; /* Aligned to a cache line */
+    uint64_t size;                 /* At least a header per arena, 0 to disable */
+} __attribute__((packed, aligned(8)));
+
+/*! \struct device_ops_kernel_heap_config_rsp_t
+    \brief Kernel heap configuration command response.
+*/
+struct device_ops_kernel_heap_config_rsp_t {
+    struct rsp_header_t response_info;
+    uint32_t status; /* kernel_heap_config_response_e */
+    uint32_t pad;
+} __attribute__((packed, aligned(8)));
+
+/*! \def DEV_OPS_API_MID_DEVICE_OPS_KERNEL_FLUSH_RANGES_CMD
+    \brief Message ID of the kernel flush ranges command. Taken from the end
+    of the device ops reserved range until the command is part of the
+    device-api spec.
+    \warning Must be kept in sync with the host runtime (DeviceOpsExt.h).
+*/
+#define DEV_OPS_API_MID_DEVICE_OPS_KERNEL_FLUSH_RANGES_CMD 1008U
+
+/*! \def DEV_OPS_API_MID_DEVICE_OPS_KERNEL_FLUSH_RANGES_RSP
+    \brief Message ID of the kernel flush ranges command response.
+*/
+#define DEV_OPS_API_MID_DEVICE_OPS_KERNEL_FLUSH_RANGES_RSP 1009U
+
+/*! \def MM_KERNEL_FLUSH_RANGES_MAX
+    \brief Number of ranges of a kernel flush ranges command, the ranges a
+    kernel slot holds (CM_KERNEL_FLUSH_RANGES_MAX).
+*/
+#define MM_KERNEL_FLUSH_RANGES_MAX 15U
+
+/*! \enum kernel_flush_ranges_response_e
+    \brief Status of the kernel flush ranges command response.
+*/
+enum kernel_flush_ranges_response_e {
+    KERNEL_FLUSH_RANGES_RESPONSE_SUCCESS = 0,
+    KERNEL_FLUSH_RANGES_RESPONSE_HOST_ABORTED = 1,
+    KERNEL_FLUSH_RANGES_RESPONSE_INVALID_ADDRESS = 2
+};
+
+/*! \struct device_ops_flush_range_t
+    \brief Range of a kernel flush ranges command.
+*/
+struct device_ops_flush_range_t {
+    uint64_t device_phy_addr;
+    uint64_t size;
+} __attribute__((packed, aligned(8)));
+
+/*! \struct device_ops_kernel_flush_ranges_cmd_t
+    \brief Kernel flush ranges command. Sets the output buffers of the next
+    kernel launched from the same submission queue, which are flushed to
+    memory at its completion instead of the whole L3. A count of 0 clears
+    them.
+*/
+struct device_ops_kernel_flush_ranges_cmd_t {
+    struct cmd_header_t command_info;
+    uint32_t count; /* Up to MM_KERNEL_FLUSH_RANGES_MAX */
+    uint32_t pad;
+    struct device_ops_flush_range_t ranges[MM_KERNEL_FLUSH_RANGES_MAX];
+} __attribute__((packed, aligned(8)));
+
+/*! \struct device_ops_kernel_flush_ranges_rsp_t
+    \brief Kernel flush ranges command response.
+*/
+struct device_ops_kernel_flush_ranges_rsp_t {
+    struct rsp_header_t response_info;
+    uint32_t status; /* kernel_flush_ranges_response_e */
+    uint32_t pad;
+} __attribute__((packed, aligned(8)));
+
+/*! \def DEV_OPS_API_MID_DEVICE_OPS_KERNEL_SHIRE_ARGS_CMD
+    \brief Message ID of the kernel shire args command. Taken from the end
+    of the device ops reserved range until the command is part of the
+    device-api spec.
+    \warning Must be kept in sync with the host runtime (DeviceOpsExt.h).
+*/
+#define DEV_OPS_API_MID_DEVICE_OPS_KERNEL_SHIRE_ARGS_CMD 1002U
+
+/*! \def DEV_OPS_API_MID_DEVICE_OPS_KERNEL_SHIRE_ARGS_RSP
+    \brief Message ID of the kernel shire args command response.
+*/
+#define DEV_OPS_API_MID_DEVICE_OPS_KERNEL_SHIRE_ARGS_RSP 1003U
+
+/*! \enum kernel_shire_args_response_e
+    \brief Status of the kernel shire args command response.
+*/
+enum kernel_shire_args_response_e {
+    KERNEL_SHIRE_ARGS_RESPONSE_SUCCESS = 0,
+    KERNEL_SHIRE_ARGS_RESPONSE_HOST_ABORTED = 1,
+    KERNEL_SHIRE_ARGS_RESPONSE_INVALID_STRIDE = 2 /* Not a multiple of 8 bytes */
+};
+
+/*! \struct device_ops_kernel_shire_args_cmd_t
+    \brief Kernel shire args command. Makes the arguments of the next kernel
+    launched from the same submission queue an array with a slice of stride
+    bytes per shire of its mask, and each shire receives a pointer to its
+    own slice. A stride of 0 clears it.
+*/
+struct device_ops_kernel_shire_args_cmd_t {
+    struct cmd_header_t command_info;
+    uint32_t stride;
+    uint32_t pad;
+} __attribute__((packed, aligned(8)));
+
+/*! \struct device_ops_kernel_shire_args_rsp_t
+    \brief Kernel shire args command response.
+*/
+struct device_ops_kernel_shire_args_rsp_t {
+    struct rsp_header_t response_info;
+    uint32_t status; /* kernel_shire_args_response_e */
+    uint32_t pad;
+} __attribute__((packed, aligned(8)));
+
+/*! \def DEV_OPS_API_MID_DEVICE_OPS_KERNEL_WATCHDOG_CMD
+    \brief Message ID of the kernel watchdog command. Taken from the end
+    of the device ops reserved range until the command is part of the
+    device-api spec.
+    \warning Must be kept in sync with the host runtime (DeviceOpsExt.h).
+*/
+#define DEV_OPS_API_MID_DEVICE_OPS_KERNEL_WATCHDOG_CMD 1000U
+
+/*! \def DEV_OPS_API_MID_DEVICE_OPS_KERNEL_WATCHDOG_RSP
+    \brief Message ID of the kernel watchdog command response.
+*/
+#define DEV_OPS_API_MID_DEVICE_OPS_KERNEL_WATCHDOG_RSP 1001U
+
+/*! \enum kernel_watchdog_response_e
+    \brief Status of the kernel watchdog command response.
+*/
+enum kernel_watchdog_response_e {
+    KERNEL_WATCHDOG_RESPONSE_SUCCESS = 0,
+    KERNEL_WATCHDOG_RESPONSE_HOST_ABORTED = 1
+};
+
+/*! \struct device_ops_kernel_watchdog_cmd_t
+    \brief Kernel watchdog command. Arms a watchdog for the next kernel
+    launched from the same submission queue: if it doesn't complete within
+    the timeout, only its shires are aborted and the launch completes with
+    DEV_OPS_API_KERNEL_LAUNCH_RESPONSE_TIMEOUT_HANG. A timeout of 0 clears it.
+*/
+struct device_ops_kernel_watchdog_cmd_t {
+    struct cmd_header_t command_info;
+    uint32_t timeout; /* In SW timer ticks (seconds) */
+    uint32_t pad;
+} __attribute__((packed, aligned(8)));
+
+/*! \struct device_ops_kernel_watchdog_rsp_t
+    \brief Kernel watchdog command response.
+*/
+struct device_ops_kernel_watchdog_rsp_t {
+    struct rsp_header_t response_info;
+    uint32_t status; /* kernel_watchdog_response_e */
+    uint32_t pad;
+} __attribute__((packed, aligned(8)));
+
+/*! \def DEV_OPS_API_MID_DEVICE_OPS_KERNEL_POWER_REPORT_CMD
+    \brief Message ID of the kernel power report command. Taken from the end
+    of the device ops reserved range until the command is part of the
+    device-api spec.
+    \warning Must be kept in sync with the host runtime (DeviceOpsExt.h).
+*/
+#define DEV_OPS_API_MID_DEVICE_OPS_KERNEL_POWER_REPORT_CMD 998U
+
+/*! \def DEV_OPS_API_MID_DEVICE_OPS_KERNEL_POWER_REPORT_RSP
+    \brief Message ID of the kernel power report command response.
+*/
+#define DEV_OPS_API_MID_DEVICE_OPS_KERNEL_POWER_REPORT_RSP 999U
+
+/*! \enum kernel_power_report_response_e
+    \brief Status of the kernel power report command response.
+*/
+enum kernel_power_report_response_e {
+    KERNEL_POWER_REPORT_RESPONSE_SUCCESS = 0,
+    KERNEL_POWER_REPORT_RESPONSE_HOST_ABORTED = 1,
+    KERNEL_POWER_REPORT_RESPONSE_NO_KERNEL = 2 /* No report of the kernel launch */
+};
+
+/*! \struct device_ops_kernel_power_report_cmd_t
+    \brief Kernel power report command. Reports the Minion frequency and
+    the power/thermal throttle events seen by a kernel launched on its own
+    (not in a multi-launch) from the same submission queue. Sent with the
+    barrier flag after the launch, so the kernel has completed.
+*/
+struct device_ops_kernel_power_report_cmd_t {
+    struct cmd_header_t command_info;
+    uint16_t kernel_launch_tag_id; /* Tag ID of the kernel launch to report */
+    uint16_t pad16;
+    uint32_t pad;
+} __attribute__((packed, aligned(8)));
+
+/*! \struct device_ops_kernel_power_report_rsp_t
+    \brief Kernel power report command response.
+*/
+struct device_ops_kernel_power_report_rsp_t {
+    struct rsp_header_t response_info;
+    uint32_t status;          /* kernel_power_report_response_e */
+    uint16_t start_freq_mhz;  /* Minion frequency when the kernel started */
+    uint16_t end_freq_mhz;    /* Minion frequency when the kernel completed */
+    uint32_t throttle_events; /* Frequency throttles reported by SP while it ran */
+    uint32_t pad;
+} __attribute__((packed, aligned(8)));
+
+/*! \def DEV_OPS_API_MID_DEVICE_OPS_KERNEL_LAUNCH_CONFIG_CMD
+    \brief Message ID of the kernel launch config command. Taken from the end
+    of the device ops reserved range until the command is part of the
+    device-api spec.
+    \warning Must be kept in sync with the host runtime (DeviceOpsExt.h).
+*/
+#define DEV_OPS_API_MID_DEVICE_OPS_KERNEL_LAUNCH_CONFIG_CMD 996U
+
+/*! \def DEV_OPS_API_MID_DEVICE_OPS_KERNEL_LAUNCH_CONFIG_RSP
+    \brief Message ID of the kernel launch config command response.
+*/
+#define DEV_OPS_API_MID_DEVICE_OPS_KERNEL_LAUNCH_CONFIG_RSP 997U
+
+/*! \def KERNEL_LAUNCH_CONFIG_FLAGS_NO_TENSOR_OPS
+    \brief The kernel doesn't use tensor instructions, so its shires can skip the
+    tensor state reset before the next kernel.
+*/
+#define KERNEL_LAUNCH_CONFIG_FLAGS_NO_TENSOR_OPS (1U << 0)
+
+/*! \def KERNEL_LAUNCH_CONFIG_FLAGS_SHIRE_CACHE_CONFIG
+    \brief Repartition the SCP and L2 of the compute shires of the kernel as given by
+    scp_sets and l2_sets. The partition stays until a later kernel requests another one.
+*/
+#define KERNEL_LAUNCH_CONFIG_FLAGS_SHIRE_CACHE_CONFIG (1U << 1)
+
+/*! \def KERNEL_LAUNCH_CONFIG_FLAGS_PREFETCH
+    \brief Prefetch the kernel entry code and arguments into L3 before the launch multicast,
+    and the entry code into the I-caches of the shires once they have invalidated them.
+*/
+#define KERNEL_LAUNCH_CONFIG_FLAGS_PREFETCH (1U << 2)
+
+/*! \def KERNEL_LAUNCH_CONFIG_FLAGS_REPORT_AND_CONTINUE
+    \brief Report the tensor errors of the kernel to the error rings of its shires and let it
+    complete, instead of failing the launch.
+*/
+#define KERNEL_LAUNCH_CONFIG_FLAGS_REPORT_AND_CONTINUE (1U << 3)
+
+/*! \enum kernel_launch_config_response_e
+    \brief Status of the kernel launch config command response.
+*/
+enum kernel_launch_config_response_e {
+    KERNEL_LAUNCH_CONFIG_RESPONSE_SUCCESS = 0,
+    KERNEL_LAUNCH_CONFIG_RESPONSE_HOST_ABORTED = 1,
+    KERNEL_LAUNCH_CONFIG_RESPONSE_INVALID_CACHE_CONFIG = 2 /* Odd sets or less than 0x40 L2 sets */
+};
+
+/*! \struct device_ops_kernel_launch_config_cmd_t
+    \brief Kernel launch config command. Sets the launch flags of the next
+    kernel launched from the same submission queue.
+*/
+struct device_ops_kernel_launch_config_cmd_t {
+    struct cmd_header_t command_info;
+    uint32_t flags;    /* KERNEL_LAUNCH_CONFIG_FLAGS_* */
+    uint16_t scp_sets; /* SCP sets per shire cache bank, with SHIRE_CACHE_CONFIG */
+    uint16_t l2_sets;  /* L2 sets per shire cache bank, scp_sets + l2_sets fill the sets below L3 */
+} __attribute__((packed, aligned(8)));
+
+/*! \struct device_ops_kernel_launch_config_rsp_t
+    \brief Kernel launch config command response.
+*/
+struct device_ops_kernel_launch_config_rsp_t {
+    struct rsp_header_t response_info;
+    uint32_t status; /* kernel_launch_config_response_e */
+    uint32_t pad;
+} __attribute__((packed, aligned(8)));
+
+/*! \def DEV_OPS_API_MID_DEVICE_OPS_KERNEL_MULTI_LAUNCH_CMD
+    \brief Message ID of the kernel multi-launch command. Taken from the end
+    of the device ops reserved range until the command is part of the
+    device-api spec.
+    \warning Must be kept in sync with the host runtime (DeviceOpsExt.h).
+*/
+#define DEV_OPS_API_MID_DEVICE_OPS_KERNEL_MULTI_LAUNCH_CMD 1006U
+
+/*! \def DEV_OPS_API_MID_DEVICE_OPS_KERNEL_MULTI_LAUNCH_RSP
+    \brief Message ID of the kernel multi-launch command response.
+*/
+#define DEV_OPS_API_MID_DEVICE_OPS_KERNEL_MULTI_LAUNCH_RSP 1007U
+
+/*! \def MM_KERNEL_MULTI_LAUNCH_MAX
+    \brief Maximum number of kernels of a kernel multi-launch command.
+*/
+#define MM_KERNEL_MULTI_LAUNCH_MAX 8U
+
+/*! \enum kernel_multi_launch_response_e
+    \brief Status of the kernel multi-launch command response.
+*/
+enum kernel_multi_launch_response_e {
+    KERNEL_MULTI_LAUNCH_RESPONSE_COMPLETED = 0,
+    KERNEL_MULTI_LAUNCH_RESPONSE_HOST_ABORTED = 1,
+    KERNEL_MULTI_LAUNCH_RESPONSE_INVALID_ARGS = 2, /* Bad count, or empty or overlapping masks */
+    KERNEL_MULTI_LAUNCH_RESPONSE_ENTRY_FAILED = 3  /* See the status of each entry */
+};
+
+/*! \struct device_ops_kernel_multi_launch_entry_t
+    \brief Kernel of a kernel multi-launch command. The arguments are
+    already in device memory, there is no optional payload.
+*/
+struct device_ops_kernel_multi_launch_entry_t {
+    uint64_t code_start_address;
+    uint64_t pointer_to_args;
+    uint64_t shire_mask;
+} __attribute__((packed, aligned(8)));
+
+/*! \struct device_ops_kernel_multi_launch_cmd_t
+    \brief Kernel multi-launch command. Launches kernels on disjoint shire
+    masks together, with a single response once all of them complete. The
+    exception buffer is shared, as it's indexed by hart.
+*/
+struct device_ops_kernel_multi_launch_cmd_t {
+    struct cmd_header_t command_info;
+    uint64_t exception_buffer;
+    uint32_t count; /* Up to MM_KERNEL_MULTI_LAUNCH_MAX */
+    uint32_t pad;
+    struct device_ops_kernel_multi_launch_entry_t entries[MM_KERNEL_MULTI_LAUNCH_MAX];
+} __attribute__((packed, aligned(8)));
+
+/*! \struct device_ops_kernel_multi_launch_rsp_t
+    \brief Kernel multi-launch command response. The execution duration
+    goes from the first launch to the last completion.
+*/
+struct device_ops_kernel_multi_launch_rsp_t {
+    struct rsp_header_t response_info;
+    uint64_t device_cmd_start_ts;
+    uint64_t device_cmd_wait_dur;
+    uint64_t device_cmd_execute_dur;
+    uint64_t cm_error_shire_mask; /* Shires of the entries which failed */
+    uint32_t status;              /* kernel_multi_launch_response_e */
+    uint32_t count;
+    uint32_t entry_status[MM_KERNEL_MULTI_LAUNCH_MAX]; /* DEV_OPS_API_KERNEL_LAUNCH_RESPONSE */
+} __attribute__((packed, aligned(8)));
+
 /*! \fn int32_t Host_Command_Handler(void* command_buffer, uint8_t sqw_idx,
         uint64_t start_cycles)
     \brief Interface to handle host side commands
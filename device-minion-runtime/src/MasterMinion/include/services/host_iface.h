@@ -63,6 +63,14 @@ int32_t Host_Iface_CQs_Init(void);
 */
 uint32_t Host_Iface_Peek_SQ_Cmd_Size(uint8_t sq_id);
 
+/*! \fn uint32_t Host_Iface_Get_SQ_Used_Space(uint8_t sq_id)
+    \brief Interface to get the bytes submitted by the host and not yet
+    processed in the submission queue identified by the sq_id
+    \param sq_id Submission queue ID
+    \returns Bytes used in the submission queue
+*/
+uint32_t Host_Iface_Get_SQ_Used_Space(uint8_t sq_id);
+
 /*! \fn int32_t Host_Iface_Peek_SQ_Cmd_Hdr(uint8_t sq_id, const void *cmd)
     \brief Interface to peek into submission queue identiefied by
     the submission queue identifier and obtain the first valid command
@@ -93,6 +101,26 @@ int32_t Host_Iface_SQ_Pop_Cmd(uint8_t sq_id, void *rx_buff);
 */
 int32_t Host_Iface_CQ_Push_Cmd(uint8_t cq_id, const void *p_cmd, uint32_t cmd_size);
 
+/*! \fn void Host_Iface_CQ_Capture_Rsp(uint8_t cq_id, uint16_t tag_id, void *rsp_buff,
+        uint32_t buff_size)
+    \brief Makes the next response with the given tag ID pushed to the CQ be copied
+    to rsp_buff instead of being sent to the host. Only one response can be captured
+    at a time on each CQ. The calling hart gets a SQW wake up credit once the
+    response is captured.
+    \param cq_id Completion queue ID
+    \param tag_id Tag ID of the response to capture
+    \param rsp_buff Buffer to copy the response to
+    \param buff_size Size of the buffer, larger responses are truncated
+*/
+void Host_Iface_CQ_Capture_Rsp(uint8_t cq_id, uint16_t tag_id, void *rsp_buff, uint32_t buff_size);
+
+/*! \fn uint32_t Host_Iface_CQ_Get_Captured_Rsp_Size(uint8_t cq_id)
+    \brief Returns the size of the response captured on the CQ
+    \param cq_id Completion queue ID
+    \return Size in bytes copied to the capture buffer, 0 while the response was not pushed
+*/
+uint32_t Host_Iface_CQ_Get_Captured_Rsp_Size(uint8_t cq_id);
+
 /*! \fn bool Host_Iface_Interrupt_Status(void)
     \brief Query host interface interrupt status to check if host iface
     processing is needed
@@ -19,8 +19,6 @@
 */
 #define SW_TIMER_MAX_SLOTS 16
 
-#define SW_TIME_FREE_SLOT_FLAG 0xFFFFFFFFFFFFFFFFull
-
 /*! \def SW_TIMER_HW_COUNT_PER_SEC
     \brief The clock speed of timer is 1MHz.
     NOTE: This 1Mhz is silicon timer clock. Other platforms like Zebu could have different clock.
@@ -69,8 +67,8 @@ void SW_Timer_Cancel_Timeout(uint8_t sw_timer_idx);
 uint32_t SW_Timer_Get_Elapsed_Time(void);
 
 /*! \fn void SW_Timer_Processing(void)
-    \brief Function to handle periodic PU Timer triggers
-    and check the timeout for added timers so far
+    \brief Function to handle periodic PU Timer triggers, it advances the
+    timer wheel one SW tick and calls the callbacks of the timeouts expired in it
 */
 void SW_Timer_Processing(void);
 
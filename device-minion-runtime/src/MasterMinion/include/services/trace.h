@@ -11,7 +11,9 @@
 #ifndef MM_TRACE_H
 #define MM_TRACE_H
 
-/* et_trace */
+/* et_trace, its inline guards read the enable byte like the encoder does */
+#include <etsoc/isa/atomic.h>
+#define ET_TRACE_READ_ENABLE(var) atomic_load_local_8(&(var))
 #include <et-trace/encoder.h>
 
 /* mm_rt_svcs */
@@ -21,18 +23,28 @@
 #include "cm_mm_defines.h"
 
 #ifdef MM_ENABLE_CMD_EXECUTION_TRACE
-#define TRACE_LOG_CMD_STATUS(message_id, sqw_idx, tag_id, status)              \
-    {                                                                          \
-        struct trace_event_cmd_status_t cmd_data = { .queue_slot_id = sqw_idx, \
-            .mesg_id = message_id,                                             \
-            .trans_id = tag_id,                                                \
-            .cmd_status = status };                                            \
-        Trace_Cmd_Status(Trace_Get_MM_CB(), &cmd_data);                        \
+#define TRACE_LOG_CMD_STATUS(message_id, sqw_idx, tag_id, status)                      \
+    {                                                                                  \
+        struct trace_control_block_t *const mm_trace_cb = Trace_Get_MM_CB();           \
+        if (ET_TRACE_CLASS_CMD_STATUS && Trace_Is_Enabled(mm_trace_cb))                \
+        {                                                                              \
+            struct trace_event_cmd_status_t cmd_data = { .queue_slot_id = sqw_idx,     \
+                .mesg_id = message_id,                                                 \
+                .trans_id = tag_id,                                                    \
+                .cmd_status = status };                                                \
+            Trace_Cmd_Status(mm_trace_cb, &cmd_data);                                  \
+        }                                                                              \
     }
 #else
 #define TRACE_LOG_CMD_STATUS(message_id, sqw_idx, tag_id, status)
 #endif
 
+/*! \def TRACE_TAG_KW_LAUNCH_PREFETCH
+    \brief Tag of the value traced with the code lines (upper 32 bits) and argument lines
+    (lower 32 bits) prefetched by the Kernel Worker before a kernel launch.
+*/
+#define TRACE_TAG_KW_LAUNCH_PREFETCH 0x4B570001U
+
 /*! \def TRACE_CONFIG_CHECK_MM_HART
     \brief Helper macro to check if given shire and thread masks contains any MM HART.
 */
@@ -103,6 +115,25 @@ void Trace_RT_Control_MM(uint32_t control);
 */
 uint32_t Trace_Evict_Buffer_MM(void);
 
+/*! \fn uint64_t Trace_Drain_Buffer_MM(uint32_t *size)
+    \brief This function returns the MM Trace sub-buffer to send to the host, the full one
+            waiting to be drained if any, else the one being logged. It is evicted upto its
+            used size.
+    \param size Returns the used size of the sub-buffer.
+    \return Base address of the sub-buffer.
+*/
+uint64_t Trace_Drain_Buffer_MM(uint32_t *size);
+
+/*! \fn void Trace_Drain_Started_MM(uint64_t base, uint8_t chan, uint16_t tag_id)
+    \brief This function records the host DMA transfer reading a sub-buffer returned by
+            Trace_Drain_Buffer_MM(), so it is not logged into till the transfer is done.
+    \param base Base address of the sub-buffer being read.
+    \param chan DMA write channel of the transfer.
+    \param tag_id Tag ID of the host command.
+    \return None
+*/
+void Trace_Drain_Started_MM(uint64_t base, uint8_t chan, uint16_t tag_id);
+
 /*! \fn uint32_t Trace_Evict_Buffer_MM_Stats(uint8_t trace_buf_type)
     \brief  This function Evict the MM Stats Trace buffer upto current used buffer,
             it also updates the trace buffer header to include buffer usage.
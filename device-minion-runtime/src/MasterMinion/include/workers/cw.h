@@ -79,6 +79,12 @@ uint64_t CW_Get_Physically_Enabled_Shires(void);
 */
 uint64_t CW_Get_Booted_Shires(void);
 
+/*! \fn uint64_t CW_Get_Busy_Shires(void)
+    \brief Get the shires reserved by kernels.
+    \return Busy shires mask
+*/
+uint64_t CW_Get_Busy_Shires(void);
+
 /*! \fn int32_t CW_CM_Configure_And_Wait_For_Boot(void)
     \brief Configure and reset CW minions for warmboot
     \return None
@@ -34,16 +34,17 @@
 #define DMAW_MAX_HART_ID DMAW_BASE_HART_ID + (DMAW_NUM * HARTS_PER_MINION)
 
 /*! \def DMAW_FOR_READ
-    \brief A macro that provides HART ID for the DMAW that processes
-    DMA read commands
+    \brief A macro that provides HART ID for the first DMAW that processes
+    DMA read commands. The DMAW_NUM_PER_DIRECTION read DMAWs go one Minion
+    after the other.
 */
 #define DMAW_FOR_READ DMAW_BASE_HART_ID
 
 /*! \def DMAW_FOR_WRITE
-    \brief A macro that provides HART ID for the DMAW that processes
-    DMA write commands
+    \brief A macro that provides HART ID for the first DMAW that processes
+    DMA write commands, right after the read DMAWs.
 */
-#define DMAW_FOR_WRITE DMAW_FOR_READ + HARTS_PER_MINION
+#define DMAW_FOR_WRITE (DMAW_FOR_READ + (DMAW_NUM_PER_DIRECTION * HARTS_PER_MINION))
 
 /*! \def DMAW_MAX_ELEMENT_SIZE
     \brief A macro that provides the max size of a DMA node in bytes
@@ -59,7 +60,8 @@ typedef enum {
     DMA_CHAN_STATE_RESERVED = 1,
     DMA_CHAN_STATE_IN_USE = 2,
     DMA_CHAN_STATE_ERROR = 3,
-    DMA_CHAN_STATE_ABORTING = 4
+    DMA_CHAN_STATE_ABORTING = 4,
+    DMA_CHAN_STATE_STRIPE_DONE = 5 /* Stripe done, waiting for the other stripes of its transfer */
 } dma_chan_state_e;
 
 /*! \enum dma_chan_type_e
@@ -95,8 +97,16 @@ typedef struct dma_channel_status_cb {
     uint64_t prev_cycles;      /* previous cycles froma continued transaction */
     uint64_t transfer_size;    /* Transfer size of data. This is only valid when channel state
                                        is 'in use'. */
+    uint32_t stripe_pending;   /* Stripes of the transfer still in flight. This is only valid in
+                                       the leader channel of the transfer. */
+    uint32_t stripe_rsp_status; /* Response status of the whole striped transfer. This is only
+                                       valid in the leader channel of the transfer. */
     uint16_t rsp_id;           /* Holds the response ID of the command */
-    uint8_t pad[6];            /* Padding for alignment */
+    uint8_t stripe_leader;     /* Channel holding the attributes of the transfer this channel is
+                                       a stripe of. It is the channel itself if not striped. */
+    uint8_t stripe_mask;       /* Channels the transfer is striped across. This is only valid in
+                                       the leader channel of the transfer. */
+    uint8_t pad[4];            /* Padding for alignment */
 } dma_channel_status_cb_t;
 
 /*! \fn void DMAW_Init(void)
@@ -128,27 +138,66 @@ int32_t DMAW_Read_Find_Idle_Chan_And_Reserve(dma_read_chan_id_e *chan_id, uint8_
 */
 int32_t DMAW_Write_Find_Idle_Chan_And_Reserve(dma_write_chan_id_e *chan_id, uint8_t sqw_idx);
 
-/*! \fn int32_t DMAW_Read_Trigger_Transfer(dma_read_chan_id_e chan_id,
+/*! \fn bool DMAW_Write_Is_Transfer_Done(dma_write_chan_id_e chan_id, uint16_t tag_id)
+    \brief Checks if the transfer of a command is no longer using a DMA write channel
+    \param chan_id DMA channel ID the command was started on
+    \param tag_id Tag ID of the command
+    \return True if the channel is not busy with the command
+*/
+bool DMAW_Write_Is_Transfer_Done(dma_write_chan_id_e chan_id, uint16_t tag_id);
+
+/*! \fn uint8_t DMAW_Read_Reserve_Stripe_Chans(dma_read_chan_id_e chan_id,
+    const struct cmd_header_t *cmd_info, uint8_t xfer_count, uint8_t sqw_idx)
+    \brief Reserves the idle DMA read channels a big DMA list can be striped
+    across, besides the already reserved one. It doesn't wait for busy channels.
+    \param chan_id DMA channel ID already reserved for the command
+    \param cmd_info Pointer to command buffer
+    \param xfer_count Number of transfer nodes in command.
+    \param sqw_idx Index of the submission queue worker
+    \return Mask of the channels reserved for the command, chan_id included
+*/
+uint8_t DMAW_Read_Reserve_Stripe_Chans(dma_read_chan_id_e chan_id,
+    const struct cmd_header_t *cmd_info, uint8_t xfer_count, uint8_t sqw_idx);
+
+/*! \fn uint8_t DMAW_Write_Reserve_Stripe_Chans(dma_write_chan_id_e chan_id,
+    const struct cmd_header_t *cmd_info, uint8_t xfer_count, uint8_t sqw_idx)
+    \brief Reserves the idle DMA write channels a big DMA list can be striped
+    across, besides the already reserved one. It doesn't wait for busy channels.
+    \param chan_id DMA channel ID already reserved for the command
+    \param cmd_info Pointer to command buffer
+    \param xfer_count Number of transfer nodes in command.
+    \param sqw_idx Index of the submission queue worker
+    \return Mask of the channels reserved for the command, chan_id included
+*/
+uint8_t DMAW_Write_Reserve_Stripe_Chans(dma_write_chan_id_e chan_id,
+    const struct cmd_header_t *cmd_info, uint8_t xfer_count, uint8_t sqw_idx);
+
+/*! \fn int32_t DMAW_Read_Trigger_Transfer(dma_read_chan_id_e chan_id, uint8_t chan_mask,
     const struct cmd_header_t *cmd_info, uint16_t xfer_count, uint8_t sqw_idx,
     execution_cycles_t *cycles, uint8_t sw_timer_idx)
     \brief This function is used to trigger a DMA read transaction by calling the
-    PCIe device driver routine
+    PCIe device driver routine. The list is striped across all the channels of
+    chan_mask, and a single response is sent once all the stripes are done.
     \param chan_id DMA channel ID
+    \param chan_mask Mask of the channels reserved for the command, chan_id included
     \param cmd Pointer to command buffer
     \param xfer_count Number of transfer nodes in command.
     \param sqw_idx SQW ID
     \param cycles Pointer to latency cycles struct
     \return Status success or error
 */
-int32_t DMAW_Read_Trigger_Transfer(dma_read_chan_id_e chan_id, const struct cmd_header_t *cmd_info,
-    uint8_t xfer_count, uint8_t sqw_idx, const execution_cycles_t *cycles);
+int32_t DMAW_Read_Trigger_Transfer(dma_read_chan_id_e chan_id, uint8_t chan_mask,
+    const struct cmd_header_t *cmd_info, uint8_t xfer_count, uint8_t sqw_idx,
+    const execution_cycles_t *cycles);
 
-/*! \fn int32_t DMAW_Write_Trigger_Transfer(dma_write_chan_id_e chan_id,
+/*! \fn int32_t DMAW_Write_Trigger_Transfer(dma_write_chan_id_e chan_id, uint8_t chan_mask,
     const struct cmd_header_t *cmd_info, uint16_t xfer_count, uint8_t sqw_idx,
     execution_cycles_t *cycles, uint8_t sw_timer_idx, dma_flags_e flags)
     \brief This function is used to trigger a DMA write transaction by calling the
-    PCIe device driver routine
+    PCIe device driver routine. The list is striped across all the channels of
+    chan_mask, and a single response is sent once all the stripes are done.
     \param chan_id DMA channel ID
+    \param chan_mask Mask of the channels reserved for the command, chan_id included
     \param cmd Pointer to command buffer
     \param xfer_count Number of transfer nodes in command.
     \param sqw_idx SQW ID
@@ -156,20 +205,59 @@ int32_t DMAW_Read_Trigger_Transfer(dma_read_chan_id_e chan_id, const struct cmd_
     \param flags DMA flag to set a specific DMA action.
     \return Status success or error
 */
-int32_t DMAW_Write_Trigger_Transfer(dma_write_chan_id_e chan_id,
+int32_t DMAW_Write_Trigger_Transfer(dma_write_chan_id_e chan_id, uint8_t chan_mask,
     const struct cmd_header_t *cmd_info, uint8_t xfer_count, uint8_t sqw_idx,
     const execution_cycles_t *cycles, dma_flags_e flags);
 
+/*! \fn int32_t DMAW_Read_Trigger_Chain(dma_read_chan_id_e chan_id,
+    const struct cmd_header_t *cmd_info, uint64_t chain_addr, uint32_t elem_count,
+    uint64_t host_addr, uint64_t host_size, uint8_t sqw_idx, const execution_cycles_t *cycles)
+    \brief This function is used to trigger a DMA read transaction running a
+    chain of data elements resident in device DRAM on a single channel.
+    \param chan_id DMA channel ID
+    \param cmd_info Pointer to command buffer
+    \param chain_addr Address of the chain in device DRAM
+    \param elem_count Number of data elements of the chain
+    \param host_addr Bus address of the host buffer the data elements refer to
+    \param host_size Size of the host buffer
+    \param sqw_idx SQW ID
+    \param cycles Pointer to latency cycles struct
+    \return Status success or error
+*/
+int32_t DMAW_Read_Trigger_Chain(dma_read_chan_id_e chan_id, const struct cmd_header_t *cmd_info,
+    uint64_t chain_addr, uint32_t elem_count, uint64_t host_addr, uint64_t host_size,
+    uint8_t sqw_idx, const execution_cycles_t *cycles);
+
+/*! \fn int32_t DMAW_Write_Trigger_Chain(dma_write_chan_id_e chan_id,
+    const struct cmd_header_t *cmd_info, uint64_t chain_addr, uint32_t elem_count,
+    uint64_t host_addr, uint64_t host_size, uint8_t sqw_idx, const execution_cycles_t *cycles)
+    \brief This function is used to trigger a DMA write transaction running a
+    chain of data elements resident in device DRAM on a single channel.
+    \param chan_id DMA channel ID
+    \param cmd_info Pointer to command buffer
+    \param chain_addr Address of the chain in device DRAM
+    \param elem_count Number of data elements of the chain
+    \param host_addr Bus address of the host buffer the data elements refer to
+    \param host_size Size of the host buffer
+    \param sqw_idx SQW ID
+    \param cycles Pointer to latency cycles struct
+    \return Status success or error
+*/
+int32_t DMAW_Write_Trigger_Chain(dma_write_chan_id_e chan_id, const struct cmd_header_t *cmd_info,
+    uint64_t chain_addr, uint32_t elem_count, uint64_t host_addr, uint64_t host_size,
+    uint8_t sqw_idx, const execution_cycles_t *cycles);
+
 /*! \fn uint64_t DMAW_Get_Average_Exec_Cycles(void)
     \brief This function gets DMA write utlization. It caclulates per
     channel utlization then returns the average of all channels.
     \param chan_type DMA channel type read or write
     \param interval_start start cycles for sampling interval
     \param interval_end end cycles for sampling interval
+    \param chan_cycles Optional, returns the consumed cycles of each channel of the type
     \return Average consumed cycles
 */
-uint64_t DMAW_Get_Average_Exec_Cycles(
-    dma_chan_type_e chan_type, uint64_t interval_start, uint64_t interval_end);
+uint64_t DMAW_Get_Average_Exec_Cycles(dma_chan_type_e chan_type, uint64_t interval_start,
+    uint64_t interval_end, uint64_t *chan_cycles);
 
 /*! \fn void DMAW_Abort_All_Dispatched_Write_Channels(uint8_t sqw_idx)
     \brief Blocking call to abort all DMA write channels
@@ -17,6 +17,8 @@
 #include "config/mm_config.h"
 #include "services/host_cmd_hdlr.h"
 
+#include <etsoc/isa/cacheops_common.h>
+
 /* common-api, device_ops_api */
 #include <esperanto/device-apis/operations-api/device_ops_api_spec.h>
 #include <esperanto/device-apis/operations-api/device_ops_api_rpc_types.h>
@@ -122,4 +124,120 @@ uint64_t KW_Get_Average_Exec_Cycles(uint64_t interval_start, uint64_t interval_e
 */
 uint64_t KW_Get_Kernel_State(void);
 
+/*! \fn void KW_Set_Kernel_Heap(uint64_t heap_base, uint64_t arena_size)
+    \brief Sets the kernel heap region in the environment of all the kernel slots.
+    It must only be called while no kernels are running.
+    \param heap_base Start of the kernel heap region, 0 to disable it
+    \param arena_size Size of the arena of each Compute Shire
+    \return none
+*/
+void KW_Set_Kernel_Heap(uint64_t heap_base, uint64_t arena_size);
+
+/*! \fn void KW_Set_Kernel_Flush_Ranges(uint8_t sqw_idx, const cache_ops_range_t *ranges,
+        uint32_t count)
+    \brief Sets the ranges flushed to memory at the completion of the next kernel launched
+    from the SQW, instead of the whole L3. Must be called by the SQW itself.
+    \param sqw_idx Submission queue worker index
+    \param ranges Ranges to flush, already verified
+    \param count Number of ranges, up to CM_KERNEL_FLUSH_RANGES_MAX, 0 to clear them
+    \return none
+*/
+void KW_Set_Kernel_Flush_Ranges(uint8_t sqw_idx, const cache_ops_range_t *ranges, uint32_t count);
+
+/*! \fn void KW_Set_Kernel_Shire_Args(uint8_t sqw_idx, uint32_t stride)
+    \brief Makes the arguments of the next kernel launched from the SQW an array with a slice
+    of stride bytes per shire. Must be called by the SQW itself.
+    \param sqw_idx Submission queue worker index
+    \param stride Bytes of each shire slice, already verified, 0 to clear it
+    \return none
+*/
+void KW_Set_Kernel_Shire_Args(uint8_t sqw_idx, uint32_t stride);
+
+/*! \fn void KW_Set_Kernel_Watchdog(uint8_t sqw_idx, uint32_t timeout)
+    \brief Arms a watchdog for the next kernel launched from the SQW, which aborts its shires
+    if it doesn't complete in time. Must be called by the SQW itself.
+    \param sqw_idx Submission queue worker index
+    \param timeout Timeout in SW timer ticks, 0 to clear it
+    \return none
+*/
+void KW_Set_Kernel_Watchdog(uint8_t sqw_idx, uint32_t timeout);
+
+/*! \fn void KW_Set_Kernel_Launch_Config(uint8_t sqw_idx, uint32_t flags, uint16_t scp_sets,
+        uint16_t l2_sets)
+    \brief Sets the launch config of the next kernel launched from the SQW. Must be called
+    by the SQW itself.
+    \param sqw_idx Submission queue worker index
+    \param flags KERNEL_LAUNCH_CONFIG_FLAGS_* of the launch, 0 to clear them
+    \param scp_sets SCP sets per shire cache bank, with the SHIRE_CACHE_CONFIG flag
+    \param l2_sets L2 sets per shire cache bank, with the SHIRE_CACHE_CONFIG flag
+    \return none
+*/
+void KW_Set_Kernel_Launch_Config(
+    uint8_t sqw_idx, uint32_t flags, uint16_t scp_sets, uint16_t l2_sets);
+
+/*! \fn void KW_Clear_Kernel_Launch_State(uint8_t sqw_idx)
+    \brief Clears the flush ranges, shire args stride, watchdog and launch config set for the
+    next kernel launched from the SQW, ie. when the command list setting them failed before
+    its kernel launch. Must be called by the SQW itself.
+    \param sqw_idx Submission queue worker index
+    \return none
+*/
+void KW_Clear_Kernel_Launch_State(uint8_t sqw_idx);
+
+/*! \fn bool KW_Get_Kernel_Power_Report(uint8_t sqw_idx, uint16_t launch_tag_id,
+        uint16_t *start_freq_mhz, uint16_t *end_freq_mhz, uint32_t *throttle_events)
+    \brief Gets the Minion frequency and the throttle events seen by a kernel launched
+    on its own from the SQW. Must be called by the SQW itself, once the kernel completed
+    (ie. by a barrier command). Only the reports of the last kernels completed are kept.
+    \param sqw_idx Submission queue worker index
+    \param launch_tag_id Tag ID of the kernel launch
+    \param start_freq_mhz Frequency when the kernel started
+    \param end_freq_mhz Frequency when the kernel completed
+    \param throttle_events Frequency throttles reported by SP while it ran
+    \return false if the SQW has no report of the kernel
+*/
+bool KW_Get_Kernel_Power_Report(uint8_t sqw_idx, uint16_t launch_tag_id,
+    uint16_t *start_freq_mhz, uint16_t *end_freq_mhz, uint32_t *throttle_events);
+
+/*! \fn int32_t KW_Reserve_Multi_Launch(uint8_t sqw_idx, uint16_t tag_id, uint32_t count,
+        const execution_cycles_t *cycles, uint8_t *group_idx)
+    \brief Reserves the group tracking the kernels of a multi-launch command, which sends its
+    response once all of them are completed. Blocks till a group is free or the SQW is aborted.
+    \param sqw_idx Submission queue worker index
+    \param tag_id Tag ID of the command
+    \param count Number of kernels, up to MM_KERNEL_MULTI_LAUNCH_MAX
+    \param cycles Start and wait cycles of the command
+    \param group_idx Pointer to get the group index
+    \return Status success or error
+*/
+int32_t KW_Reserve_Multi_Launch(uint8_t sqw_idx, uint16_t tag_id, uint32_t count,
+    const execution_cycles_t *cycles, uint8_t *group_idx);
+
+/*! \fn void KW_Notify_Multi_Launch_Entry(uint8_t kw_idx, uint8_t group_idx, uint8_t entry,
+        const execution_cycles_t *cycle)
+    \brief Like KW_Notify, for a kernel dispatched as an entry of a multi-launch group. The KW
+    completes the entry instead of sending a kernel launch response.
+    \param kw_idx Kernel worker index returned by KW_Dispatch_Kernel_Launch_Cmd
+    \param group_idx Group index returned by KW_Reserve_Multi_Launch
+    \param entry Index of the kernel in the command
+    \param cycle Cycles of the kernel launch
+    \return none
+*/
+void KW_Notify_Multi_Launch_Entry(
+    uint8_t kw_idx, uint8_t group_idx, uint8_t entry, const execution_cycles_t *cycle);
+
+/*! \fn void KW_Complete_Multi_Launch_Entry(uint8_t group_idx, uint8_t entry, uint32_t status,
+        uint64_t cm_error_shire_mask)
+    \brief Sets the completion status of an entry of a multi-launch group. Completing the last
+    entry sends the response of the command and frees the group. Called by the KWs, and by the
+    SQW for the entries which failed to be dispatched.
+    \param group_idx Group index returned by KW_Reserve_Multi_Launch
+    \param entry Index of the kernel in the command
+    \param status Kernel launch response status of the entry
+    \param cm_error_shire_mask Shires which reported an error
+    \return none
+*/
+void KW_Complete_Multi_Launch_Entry(
+    uint8_t group_idx, uint8_t entry, uint32_t status, uint64_t cm_error_shire_mask);
+
 #endif /* KW_DEFS_H */
@@ -89,4 +89,25 @@ void SQW_Abort_All_Pending_Commands(uint8_t sqw_idx);
 */
 sqw_state_e SQW_Get_State(uint8_t sqw_idx);
 
+/*! \fn uint32_t SQW_Get_Command_Count(uint8_t sqw_idx)
+    \brief Returns the number of commands being processed by a SQW
+    \param sqw_idx Submission Queue Worker index
+    \return Outstanding commands count of SQW
+*/
+uint32_t SQW_Get_Command_Count(uint8_t sqw_idx);
+
+/*! \fn void SQW_Wakeup_Hart(uint32_t hart_id)
+    \brief Sends a SQW wake up credit to a master shire hart
+    \param hart_id Hart ID to wake up
+    \return none
+*/
+void SQW_Wakeup_Hart(uint32_t hart_id);
+
+/*! \fn void SQW_Wait_For_Wakeup(void)
+    \brief Blocks the calling hart until it gets a SQW wake up credit, the wait
+    condition must be checked again once woken up
+    \return none
+*/
+void SQW_Wait_For_Wakeup(void);
+
 #endif /* SQW_DEFS_H */
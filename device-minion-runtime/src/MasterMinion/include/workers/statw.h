@@ -42,6 +42,14 @@ enum statw_pmu_sampling_state {
 */
 #define STATW_SAMPLING_INTERVAL 1UL
 
+/*! \def STATW_UTILIZATION_SAMPLING_INTERVAL_US
+    \brief Interval in microseconds of the utilization time series samples logged
+    into the MM stats trace buffer. Set at build time, 0 disables them.
+*/
+#ifndef STATW_UTILIZATION_SAMPLING_INTERVAL_US
+#define STATW_UTILIZATION_SAMPLING_INTERVAL_US 100UL
+#endif
+
 /*! \def STATW_UTILIZATION_CMA_SAMPLE_COUNT
     \brief Device utilization statistics moving average sample count.
 */
@@ -150,6 +158,21 @@ void STATW_Add_New_Sample_Atomically(statw_resource_type_e resource_type, uint64
 */
 uint32_t STATW_Get_Minion_Freq(void);
 
+/*! \fn void STATW_Update_Minion_Freq(uint32_t freq_mhz, bool throttled)
+    \brief Records the Minion frequency set by SP.
+    \param freq_mhz New frequency in mega hertz.
+    \param throttled True if it was lowered by a power or thermal throttle,
+    which is counted as a throttle event.
+    \return None.
+*/
+void STATW_Update_Minion_Freq(uint32_t freq_mhz, bool throttled);
+
+/*! \fn uint32_t STATW_Get_Throttle_Events(void)
+    \brief Returns the number of throttle events reported by SP since boot.
+    \return Number of throttle events, it wraps around.
+*/
+uint32_t STATW_Get_Throttle_Events(void);
+
 /*! \fn int32_t STATW_Get_MM_Stats(struct compute_resources_sample *sample)
     \brief Get the current MM stats.
     \param sample Pointer to sample to populate.
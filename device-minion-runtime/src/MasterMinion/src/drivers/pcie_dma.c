@@ -210,6 +210,98 @@ static inline int32_t dma_bounds_check(uint64_t soc_addr, uint64_t size)
     return DMA_DRIVER_ERROR_INVALID_ADDRESS;
 }
 
+/************************************************************************
+*
+*   FUNCTION
+*
+*       write_xfer_chain
+*
+*   DESCRIPTION
+*
+*       Prepares a chain of data elements resident in device DRAM, and links
+*       the DMA list of the channel to it. The host side address of the data
+*       elements is an offset in the host buffer, it's rewritten with its bus
+*       address once checked. Their control words are rewritten too, and the
+*       element following the last one is overwritten with the link element
+*       ending the chain. The DMA engine goes through the chain without any
+*       other copy, whatever its number of elements.
+*
+*   INPUTS
+*
+*       ll_address  Address of DMA link list base for required DMA channel.
+*       chain_addr  Address of the chain in device DRAM
+*       elem_count  Number of data elements of the chain
+*       host_addr   Bus address of the host buffer
+*       host_size   Size of the host buffer
+*       soc_is_dst  true if the SoC address of the data elements is the
+*                   destination one, false if it is the source one
+*       size        Pointer to the total size of the data elements
+*
+*   OUTPUTS
+*
+*       int32_t     Status success or error
+*
+***********************************************************************/
+static int32_t write_xfer_chain(uint64_t ll_address, uint64_t chain_addr, uint32_t elem_count,
+    uint64_t host_addr, uint64_t host_size, bool soc_is_dst, uint64_t *size)
+{
+    transfer_list_elem_t *chain = (transfer_list_elem_t *)chain_addr;
+    transfer_list_elem_t *transfer = (transfer_list_elem_t *)ll_address;
+    const uint64_t chain_size = sizeof(transfer_list_elem_t) * ((uint64_t)elem_count + 1U);
+    int32_t status = STATUS_SUCCESS;
+    uint64_t total_size = 0;
+
+    /* The chain was written by the host, drop any stale line of it */
+    ETSOC_MEM_EVICT(chain, chain_size, to_L3)
+
+    for (uint32_t index = 0; (index < elem_count) && (status == STATUS_SUCCESS); index++)
+    {
+        uint64_t soc_addr = soc_is_dst ? chain[index].data.dar : chain[index].data.sar;
+        uint64_t host_offset = soc_is_dst ? chain[index].data.sar : chain[index].data.dar;
+        uint32_t elem_size = chain[index].data.size;
+
+        status = ((elem_size == 0) || (host_offset > host_size) ||
+                     (elem_size > (host_size - host_offset))) ?
+                     DMA_DRIVER_ERROR_INVALID_ADDRESS :
+                     dma_bounds_check(soc_addr, elem_size);
+
+        if (status == STATUS_SUCCESS)
+        {
+            if (soc_is_dst)
+            {
+                chain[index].data.sar = host_addr + host_offset;
+            }
+            else
+            {
+                chain[index].data.dar = host_addr + host_offset;
+            }
+
+
+            /* Enable completion interrupt for the last element only */
+            chain[index].data.ctrl.R =
+                (index == (elem_count - 1U)) ? (CTRL_CB | CTRL_LIE) : CTRL_CB;
+            total_size += elem_size;
+        }
+    }
+
+    if (status == STATUS_SUCCESS)
+    {
+        /* End the chain as a DMA list of its own */
+        chain[elem_count].link.ctrl.R = CTRL_TCB | CTRL_LLP;
+        chain[elem_count].link.ptr = chain_addr;
+        ETSOC_MEM_EVICT(chain, chain_size, to_L3)
+
+        /* Jump from the DMA list of the channel to the chain, keeping the cycle bit */
+        transfer[0].link.ctrl.R = CTRL_CB | CTRL_LLP;
+        transfer[0].link.ptr = chain_addr;
+        ETSOC_MEM_EVICT(transfer, sizeof(transfer_list_elem_t), to_L3)
+
+        *size = total_size;
+    }
+
+    return status;
+}
+
 /************************************************************************
 *
 *   FUNCTION
@@ -403,6 +495,86 @@ int32_t dma_config_write_add_link_node(dma_write_chan_id_e chan, uint32_t index)
     return DMA_DRIVER_ERROR_INVALID_CHAN_ID;
 }
 
+/************************************************************************
+*
+*   FUNCTION
+*
+*       dma_config_read_add_chain
+*
+*   DESCRIPTION
+*
+*       This function makes the DMA read transfer list of the channel run a
+*       chain of data elements resident in device DRAM. No other node must be
+*       added to the transfer list.
+*
+*   INPUTS
+*
+*       chain_addr      Address of the chain in device DRAM
+*       elem_count      Number of data elements of the chain
+*       host_addr       Bus address of the host buffer
+*       host_size       Size of the host buffer
+*       chan            DMA channel ID
+*       size            Pointer to the total size of the chain transfers
+*
+*   OUTPUTS
+*
+*       int32_t     status success or error
+*
+***********************************************************************/
+int32_t dma_config_read_add_chain(uint64_t chain_addr, uint32_t elem_count, uint64_t host_addr,
+    uint64_t host_size, dma_read_chan_id_e chan, uint64_t *size)
+{
+    if (IS_DMA_READ_CHAN_VALID(chan))
+    {
+        /* Read: source is on host, dest is on SoC */
+        return write_xfer_chain(
+            DMA_READ_CHAN_GET_LL_BASE(chan), chain_addr, elem_count, host_addr, host_size,
+            true, size);
+    }
+
+    return DMA_DRIVER_ERROR_INVALID_CHAN_ID;
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       dma_config_write_add_chain
+*
+*   DESCRIPTION
+*
+*       This function makes the DMA write transfer list of the channel run a
+*       chain of data elements resident in device DRAM. No other node must be
+*       added to the transfer list.
+*
+*   INPUTS
+*
+*       chain_addr      Address of the chain in device DRAM
+*       elem_count      Number of data elements of the chain
+*       host_addr       Bus address of the host buffer
+*       host_size       Size of the host buffer
+*       chan            DMA channel ID
+*       size            Pointer to the total size of the chain transfers
+*
+*   OUTPUTS
+*
+*       int32_t     status success or error
+*
+***********************************************************************/
+int32_t dma_config_write_add_chain(uint64_t chain_addr, uint32_t elem_count, uint64_t host_addr,
+    uint64_t host_size, dma_write_chan_id_e chan, uint64_t *size)
+{
+    if (IS_DMA_WRITE_CHAN_VALID(chan))
+    {
+        /* Write: source is on SoC, dest is on host */
+        return write_xfer_chain(
+            DMA_WRITE_CHAN_GET_LL_BASE(chan), chain_addr, elem_count, host_addr, host_size,
+            false, size);
+    }
+
+    return DMA_DRIVER_ERROR_INVALID_CHAN_ID;
+}
+
 /************************************************************************
 *
 *   FUNCTION
@@ -16,6 +16,8 @@
 /* mm_et_svcs */
 #include <etsoc/drivers/pmu/pmu.h>
 #include <etsoc/isa/cacheops.h>
+#include <etsoc/isa/etsoc_memory.h>
+#include <system/abi.h>
 #include <system/layout.h>
 
 /* mm specific headers */
@@ -43,6 +45,20 @@
 */
 #define TRACE_NODE_INDEX 0
 
+/*! \var stream_sync_slots
+    \brief Tokens signaled by the stream sync command, waited on by other SQWs
+*/
+static uint32_t stream_sync_slots[MM_STREAM_SYNC_SLOTS] __attribute__((aligned(64))) = { 0 };
+
+/*! \var cmd_list_stage_buffers
+    \brief Copy of the command list stage being run by each SQW, with its patches applied
+*/
+static uint8_t cmd_list_stage_buffers[MM_SQ_COUNT][MM_CMD_LIST_STAGE_SIZE_MAX]
+    __attribute__((aligned(64)));
+
+/* DMA chains are run in place by the DMA engine */
+static_assert(MM_DMA_CHAIN_ELEM_SIZE == DMA_PER_ENTRY_SIZE, "Invalid DMA chain element size.");
+
 /*! \def DMA_TO_DEVICEAPI_STATUS
     \brief Helper macro to convert DMA Error to DEVICE API Errors
 */
@@ -220,7 +236,7 @@ static inline int32_t abort_cmd_handler(void *command_buffer, uint8_t sqw_hp_idx
 #else
     rsp.response_info.rsp_hdr.size =
         sizeof(struct device_ops_abort_rsp_t) - sizeof(struct cmn_header_t);
-    status = Host_Iface_CQ_Push_Cmd(0, &rsp, sizeof(rsp));
+    status = Host_Iface_CQ_Push_Cmd(MM_CQ_FOR_SQ(sqw_hp_idx), &rsp, sizeof(rsp));
 #endif
 
     if (status == STATUS_SUCCESS)
@@ -325,7 +341,7 @@ static inline int32_t cm_reset_cmd_handler(void *command_buffer, uint8_t sqw_hp_
         sizeof(struct device_ops_cm_reset_rsp_t) - sizeof(struct cmn_header_t);
 
     /* Push the response to CQ */
-    status = Host_Iface_CQ_Push_Cmd(0, &rsp, sizeof(rsp));
+    status = Host_Iface_CQ_Push_Cmd(MM_CQ_FOR_SQ(sqw_hp_idx), &rsp, sizeof(rsp));
 
     if (status == STATUS_SUCCESS)
     {
@@ -436,7 +452,7 @@ static inline int32_t compatibility_cmd_handler(void *command_buffer, uint8_t sq
         rsp.status = DEV_OPS_API_COMPATIBILITY_RESPONSE_UNEXPECTED_ERROR;
     }
 
-    status = Host_Iface_CQ_Push_Cmd(0, &rsp, sizeof(rsp));
+    status = Host_Iface_CQ_Push_Cmd(MM_CQ_FOR_SQ(sqw_idx), &rsp, sizeof(rsp));
 
     if (status == STATUS_SUCCESS)
     {
@@ -612,7 +628,7 @@ static inline int32_t fw_version_cmd_handler(void *command_buffer, uint8_t sqw_i
     rsp.response_info.rsp_hdr.size =
         sizeof(struct device_ops_fw_version_rsp_t) - sizeof(struct cmn_header_t);
     /* Push response to Host */
-    status = Host_Iface_CQ_Push_Cmd(0, &rsp, sizeof(rsp));
+    status = Host_Iface_CQ_Push_Cmd(MM_CQ_FOR_SQ(sqw_idx), &rsp, sizeof(rsp));
 #endif
 
     if (status == STATUS_SUCCESS)
@@ -719,7 +735,7 @@ static inline int32_t echo_cmd_handler(void *command_buffer, uint8_t sqw_idx, ui
 #else
     rsp.response_info.rsp_hdr.size =
         sizeof(struct device_ops_echo_rsp_t) - sizeof(struct cmn_header_t);
-    status = Host_Iface_CQ_Push_Cmd(0, &rsp, sizeof(rsp));
+    status = Host_Iface_CQ_Push_Cmd(MM_CQ_FOR_SQ(sqw_idx), &rsp, sizeof(rsp));
 #endif
 
     if (status == STATUS_SUCCESS)
@@ -749,20 +765,1828 @@ static inline int32_t echo_cmd_handler(void *command_buffer, uint8_t sqw_idx, ui
             cmd->command_info.cmd_hdr.tag_id, sqw_idx, cmd->command_info.cmd_hdr.tag_id);
         SP_Iface_Report_Error(MM_RECOVERABLE_FW_MM_SQW_ERROR, MM_CQ_PUSH_ERROR);
     }
-
-#if !TEST_FRAMEWORK
-    /* Decrement commands count being processed by given SQW */
-    SQW_Decrement_Command_Count(sqw_idx);
-
-    /* Check for device API error */
-    if (rsp.status != DEV_OPS_API_ECHO_RESPONSE_SUCCESS)
+
+#if !TEST_FRAMEWORK
+    /* Decrement commands count being processed by given SQW */
+    SQW_Decrement_Command_Count(sqw_idx);
+
+    /* Check for device API error */
+    if (rsp.status != DEV_OPS_API_ECHO_RESPONSE_SUCCESS)
+    {
+        /* Report device API error to SP */
+        SP_Iface_Report_Error(MM_RECOVERABLE_OPS_API_ECHO, (int16_t)rsp.status);
+    }
+#endif
+
+    return status;
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       stream_sync_cmd_handler
+*
+*   DESCRIPTION
+*
+*       Process host stream sync command, and transmit response.
+*       A wait blocks the SQW (so all the following commands of the SQ)
+*       until the slot is signaled from another SQ, or the SQ is aborted.
+*
+*   INPUTS
+*
+*       command_buffer   Buffer containing command to process
+*       sqw_idx          Submission queue index
+*       start_cycle      Cycle count to measure wait latency
+*
+*   OUTPUTS
+*
+*       int32_t           Successful status or error code.
+*
+***********************************************************************/
+static inline int32_t stream_sync_cmd_handler(
+    void *command_buffer, uint8_t sqw_idx, uint64_t start_cycles)
+{
+    const struct device_ops_stream_sync_cmd_t *cmd =
+        (struct device_ops_stream_sync_cmd_t *)command_buffer;
+    struct device_ops_stream_sync_rsp_t rsp = { 0 };
+    int32_t status = STATUS_SUCCESS;
+    sqw_state_e sqw_state = SQW_Get_State(sqw_idx);
+
+    (void)start_cycles;
+
+    TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_STREAM_SYNC_CMD, sqw_idx,
+        cmd->command_info.cmd_hdr.tag_id, CMD_STATUS_RECEIVED)
+
+    Log_Write(LOG_LEVEL_DEBUG,
+        "TID[%u]:SQW[%d]:HostCommandHandler:Processing:STREAM_SYNC_CMD:op=%d:slot=%d\r\n",
+        cmd->command_info.cmd_hdr.tag_id, sqw_idx, cmd->op, cmd->slot);
+
+    rsp.status = STREAM_SYNC_RESPONSE_SUCCESS;
+
+    if (cmd->slot >= MM_STREAM_SYNC_SLOTS)
+    {
+        rsp.status = STREAM_SYNC_RESPONSE_INVALID_SLOT;
+        status = HOST_CMD_ERROR_INVALID_SYNC_SLOT;
+    }
+    else if (cmd->op == STREAM_SYNC_OP_SIGNAL)
+    {
+        /* Barrier flag made the SQW wait for all the previous commands. Signal even if
+        the SQ was aborted, otherwise the waiting SQ would be blocked forever */
+        atomic_store_local_32(&stream_sync_slots[cmd->slot], cmd->token);
+    }
+    else if (sqw_state != SQW_STATE_ABORTED)
+    {
+        TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_STREAM_SYNC_CMD, sqw_idx,
+            cmd->command_info.cmd_hdr.tag_id, CMD_STATUS_EXECUTING)
+
+        /* Hold the SQ till the slot gets signaled, then consume it */
+        while ((atomic_compare_and_exchange_local_32(&stream_sync_slots[cmd->slot],
+                    cmd->token, 0) != cmd->token) &&
+               (sqw_state != SQW_STATE_ABORTED))
+        {
+            sqw_state = SQW_Get_State(sqw_idx);
+        }
+    }
+
+    if (sqw_state == SQW_STATE_ABORTED)
+    {
+        rsp.status = STREAM_SYNC_RESPONSE_HOST_ABORTED;
+    }
+
+    /* Construct and transmit response */
+    rsp.response_info.rsp_hdr.tag_id = cmd->command_info.cmd_hdr.tag_id;
+    rsp.response_info.rsp_hdr.msg_id = DEV_OPS_API_MID_DEVICE_OPS_STREAM_SYNC_RSP;
+    rsp.response_info.rsp_hdr.size =
+        sizeof(struct device_ops_stream_sync_rsp_t) - sizeof(struct cmn_header_t);
+
+    if (Host_Iface_CQ_Push_Cmd(MM_CQ_FOR_SQ(sqw_idx), &rsp, sizeof(rsp)) == STATUS_SUCCESS)
+    {
+        if (rsp.status == STREAM_SYNC_RESPONSE_SUCCESS)
+        {
+            TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_STREAM_SYNC_CMD, sqw_idx,
+                cmd->command_info.cmd_hdr.tag_id, CMD_STATUS_SUCCEEDED)
+        }
+        else if (rsp.status == STREAM_SYNC_RESPONSE_HOST_ABORTED)
+        {
+            TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_STREAM_SYNC_CMD, sqw_idx,
+                cmd->command_info.cmd_hdr.tag_id, CMD_STATUS_ABORTED)
+        }
+        else
+        {
+            TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_STREAM_SYNC_CMD, sqw_idx,
+                cmd->command_info.cmd_hdr.tag_id, CMD_STATUS_FAILED)
+        }
+
+        Log_Write(LOG_LEVEL_DEBUG,
+            "TID[%u]:SQW[%d]:HostCommandHandler:CQ_Push:STREAM_SYNC_CMD_RSP\r\n",
+            cmd->command_info.cmd_hdr.tag_id, sqw_idx);
+    }
+    else
+    {
+        TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_STREAM_SYNC_CMD, sqw_idx,
+            cmd->command_info.cmd_hdr.tag_id, CMD_STATUS_FAILED)
+
+        Log_Write(LOG_LEVEL_ERROR,
+            "TID[%u]:SQW[%d]:HostCommandHandler:Tag_ID=%u:CQ_Push:Failed\r\n",
+            cmd->command_info.cmd_hdr.tag_id, sqw_idx, cmd->command_info.cmd_hdr.tag_id);
+        SP_Iface_Report_Error(MM_RECOVERABLE_FW_MM_SQW_ERROR, MM_CQ_PUSH_ERROR);
+    }
+
+    /* Decrement commands count being processed by given SQW */
+    SQW_Decrement_Command_Count(sqw_idx);
+
+    return status;
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       cmd_chain_is_stage_cmd
+*
+*   DESCRIPTION
+*
+*       Checks if a command can be a stage of a command chain.
+*
+*   INPUTS
+*
+*       msg_id           Message ID of the command
+*
+*   OUTPUTS
+*
+*       bool             true if the command can be chained
+*
+***********************************************************************/
+static inline bool cmd_chain_is_stage_cmd(uint16_t msg_id)
+{
+    return (msg_id == DEV_OPS_API_MID_DEVICE_OPS_DMA_WRITELIST_CMD) ||
+           (msg_id == DEV_OPS_API_MID_DEVICE_OPS_P2PDMA_WRITELIST_CMD) ||
+           (msg_id == DEV_OPS_API_MID_DEVICE_OPS_KERNEL_LAUNCH_CMD) ||
+           (msg_id == DEV_OPS_API_MID_DEVICE_OPS_DMA_READLIST_CMD) ||
+           (msg_id == DEV_OPS_API_MID_DEVICE_OPS_P2PDMA_READLIST_CMD);
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       cmd_chain_get_stage_status
+*
+*   DESCRIPTION
+*
+*       Gets the status of a captured stage response.
+*
+*   INPUTS
+*
+*       stage_rsp        Captured stage response
+*       stage_status     Returns the status field of the response
+*
+*   OUTPUTS
+*
+*       bool             true if the stage completed successfully
+*
+***********************************************************************/
+static inline bool cmd_chain_get_stage_status(const void *stage_rsp, uint32_t *stage_status)
+{
+    const struct rsp_header_t *hdr = stage_rsp;
+    bool completed = false;
+
+    switch (hdr->rsp_hdr.msg_id)
+    {
+        case DEV_OPS_API_MID_DEVICE_OPS_KERNEL_LAUNCH_RSP:
+            *stage_status = ((const struct device_ops_kernel_launch_rsp_t *)stage_rsp)->status;
+            completed = (*stage_status == DEV_OPS_API_KERNEL_LAUNCH_RESPONSE_KERNEL_COMPLETED);
+            break;
+        case DEV_OPS_API_MID_DEVICE_OPS_DMA_WRITELIST_RSP:
+            *stage_status = ((const struct device_ops_dma_writelist_rsp_t *)stage_rsp)->status;
+            completed = (*stage_status == DEV_OPS_API_DMA_RESPONSE_COMPLETE);
+            break;
+        case DEV_OPS_API_MID_DEVICE_OPS_P2PDMA_WRITELIST_RSP:
+            *stage_status = ((const struct device_ops_p2pdma_writelist_rsp_t *)stage_rsp)->status;
+            completed = (*stage_status == DEV_OPS_API_DMA_RESPONSE_COMPLETE);
+            break;
+        case DEV_OPS_API_MID_DEVICE_OPS_DMA_READLIST_RSP:
+            *stage_status = ((const struct device_ops_dma_readlist_rsp_t *)stage_rsp)->status;
+            completed = (*stage_status == DEV_OPS_API_DMA_RESPONSE_COMPLETE);
+            break;
+        case DEV_OPS_API_MID_DEVICE_OPS_P2PDMA_READLIST_RSP:
+            *stage_status = ((const struct device_ops_p2pdma_readlist_rsp_t *)stage_rsp)->status;
+            completed = (*stage_status == DEV_OPS_API_DMA_RESPONSE_COMPLETE);
+            break;
+        case DEV_OPS_API_MID_DEVICE_OPS_MEMSET_RSP:
+            *stage_status = ((const struct device_ops_memset_rsp_t *)stage_rsp)->status;
+            completed = (*stage_status == MEMSET_RESPONSE_SUCCESS);
+            break;
+        case DEV_OPS_API_MID_DEVICE_OPS_DEVICE_MEMCPY_RSP:
+            *stage_status = ((const struct device_ops_device_memcpy_rsp_t *)stage_rsp)->status;
+            completed = (*stage_status == DEVICE_MEMCPY_RESPONSE_SUCCESS);
+            break;
+        case DEV_OPS_API_MID_DEVICE_OPS_KERNEL_FLUSH_RANGES_RSP:
+            *stage_status = ((const struct device_ops_kernel_flush_ranges_rsp_t *)stage_rsp)->status;
+            completed = (*stage_status == KERNEL_FLUSH_RANGES_RESPONSE_SUCCESS);
+            break;
+        case DEV_OPS_API_MID_DEVICE_OPS_KERNEL_SHIRE_ARGS_RSP:
+            *stage_status = ((const struct device_ops_kernel_shire_args_rsp_t *)stage_rsp)->status;
+            completed = (*stage_status == KERNEL_SHIRE_ARGS_RESPONSE_SUCCESS);
+            break;
+        case DEV_OPS_API_MID_DEVICE_OPS_KERNEL_WATCHDOG_RSP:
+            *stage_status = ((const struct device_ops_kernel_watchdog_rsp_t *)stage_rsp)->status;
+            completed = (*stage_status == KERNEL_WATCHDOG_RESPONSE_SUCCESS);
+            break;
+        case DEV_OPS_API_MID_DEVICE_OPS_KERNEL_LAUNCH_CONFIG_RSP:
+            *stage_status =
+                ((const struct device_ops_kernel_launch_config_rsp_t *)stage_rsp)->status;
+            completed = (*stage_status == KERNEL_LAUNCH_CONFIG_RESPONSE_SUCCESS);
+            break;
+        default:
+            *stage_status = 0;
+            break;
+    }
+
+    return completed;
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       cmd_chain_run_stage
+*
+*   DESCRIPTION
+*
+*       Dispatches a stage through its own handler and waits for it to
+*       complete, capturing its response from the CQ.
+*
+*   INPUTS
+*
+*       stage            Stage command
+*       sqw_idx          Submission queue index
+*       start_cycle      Cycle count to measure wait latency
+*       stage_status     Returns the status field of the stage response
+*       stage_msg_id     Returns the message ID of the stage response, can be NULL
+*       status           Returns the status of the stage handler
+*
+*   OUTPUTS
+*
+*       bool             true if the stage completed successfully
+*
+***********************************************************************/
+static bool cmd_chain_run_stage(const struct cmd_header_t *stage, uint8_t sqw_idx,
+    uint64_t start_cycles, uint32_t *stage_status, uint16_t *stage_msg_id, int32_t *status)
+{
+    /* Large enough for a kernel launch response with its error pointers */
+    uint8_t stage_rsp[64] __attribute__((aligned(8))) = { 0 };
+
+    /* Every path of the stage handlers ends pushing a response, capture it */
+    Host_Iface_CQ_Capture_Rsp(
+        MM_CQ_FOR_SQ(sqw_idx), stage->cmd_hdr.tag_id, stage_rsp, sizeof(stage_rsp));
+
+    /* Stage handlers decrement the SQW command count once they complete */
+    SQW_Increment_Command_Count(sqw_idx);
+
+    *status = Host_Command_Handler((void *)(uintptr_t)stage, sqw_idx, start_cycles);
+
+    /* Block until the stage completes instead of spinning on the capture,
+    capturing the stage response wakes up this hart */
+    while (Host_Iface_CQ_Get_Captured_Rsp_Size(MM_CQ_FOR_SQ(sqw_idx)) == 0)
+    {
+        SQW_Wait_For_Wakeup();
+    }
+
+    /* Response was written with local atomics by another hart */
+    ETSOC_Memory_Read_Local_Atomic(stage_rsp, stage_rsp, sizeof(stage_rsp));
+
+    if (stage_msg_id != NULL)
+    {
+        *stage_msg_id = ((const struct rsp_header_t *)(const void *)stage_rsp)->rsp_hdr.msg_id;
+    }
+
+    return cmd_chain_get_stage_status(stage_rsp, stage_status);
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       cmd_chain_cmd_handler
+*
+*   DESCRIPTION
+*
+*       Process host command chain command, and transmit response.
+*       Each stage is dispatched through its own handler once the previous
+*       one completed, without SQW barriers. The stage responses are
+*       captured from the CQ, so the host only gets the chain response.
+*
+*   INPUTS
+*
+*       command_buffer   Buffer containing command to process
+*       sqw_idx          Submission queue index
+*       start_cycle      Cycle count to measure wait latency
+*
+*   OUTPUTS
+*
+*       int32_t           Successful status or error code.
+*
+***********************************************************************/
+static inline int32_t cmd_chain_cmd_handler(
+    void *command_buffer, uint8_t sqw_idx, uint64_t start_cycles)
+{
+    const struct device_ops_cmd_chain_cmd_t *cmd =
+        (struct device_ops_cmd_chain_cmd_t *)command_buffer;
+    struct device_ops_cmd_chain_rsp_t rsp = { 0 };
+    const uint8_t *stages = (const uint8_t *)cmd->stages;
+    uint32_t stages_size = cmd->command_info.cmd_hdr.size - (uint32_t)sizeof(*cmd);
+    uint32_t offset = 0;
+    uint64_t exec_start_cycles = PMC_Get_Current_Cycles();
+    int32_t status = STATUS_SUCCESS;
+
+    TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_CMD_CHAIN_CMD, sqw_idx,
+        cmd->command_info.cmd_hdr.tag_id, CMD_STATUS_RECEIVED)
+
+    Log_Write(LOG_LEVEL_DEBUG,
+        "TID[%u]:SQW[%d]:HostCommandHandler:Processing:CMD_CHAIN_CMD:stages=%d\r\n",
+        cmd->command_info.cmd_hdr.tag_id, sqw_idx, cmd->stage_count);
+
+    rsp.status = CMD_CHAIN_RESPONSE_SUCCESS;
+    rsp.failed_stage = cmd->stage_count;
+
+    if ((cmd->command_info.cmd_hdr.size < sizeof(*cmd)) || (cmd->stage_count == 0) ||
+        (cmd->stage_count > MM_CMD_CHAIN_STAGES_MAX))
+    {
+        rsp.status = CMD_CHAIN_RESPONSE_INVALID_STAGES;
+        status = HOST_CMD_ERROR_INVALID_CMD_CHAIN;
+    }
+    else
+    {
+        TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_CMD_CHAIN_CMD, sqw_idx,
+            cmd->command_info.cmd_hdr.tag_id, CMD_STATUS_EXECUTING)
+    }
+
+    for (uint8_t i = 0; (i < cmd->stage_count) && (rsp.status == CMD_CHAIN_RESPONSE_SUCCESS); i++)
+    {
+        const struct cmd_header_t *stage = (const void *)&stages[offset];
+
+        /* Verify the stage fits in the chain payload and can be chained */
+        if (((offset + DEVICE_CMD_HEADER_SIZE) > stages_size) ||
+            (stage->cmd_hdr.size < DEVICE_CMD_HEADER_SIZE) ||
+            ((offset + stage->cmd_hdr.size) > stages_size) ||
+            !cmd_chain_is_stage_cmd(stage->cmd_hdr.msg_id))
+        {
+            rsp.status = CMD_CHAIN_RESPONSE_INVALID_STAGES;
+            rsp.failed_stage = i;
+            status = HOST_CMD_ERROR_INVALID_CMD_CHAIN;
+        }
+        else if (SQW_Get_State(sqw_idx) == SQW_STATE_ABORTED)
+        {
+            rsp.status = CMD_CHAIN_RESPONSE_HOST_ABORTED;
+            rsp.failed_stage = i;
+        }
+        else
+        {
+            if (!cmd_chain_run_stage(
+                    stage, sqw_idx, start_cycles, &rsp.stage_status, NULL, &status))
+            {
+                rsp.status = CMD_CHAIN_RESPONSE_STAGE_FAILED;
+                rsp.failed_stage = i;
+            }
+
+            offset += (uint32_t)ALIGN_TO(stage->cmd_hdr.size, 8U);
+        }
+    }
+
+    /* Construct and transmit response */
+    rsp.response_info.rsp_hdr.tag_id = cmd->command_info.cmd_hdr.tag_id;
+    rsp.response_info.rsp_hdr.msg_id = DEV_OPS_API_MID_DEVICE_OPS_CMD_CHAIN_RSP;
+    rsp.response_info.rsp_hdr.size =
+        sizeof(struct device_ops_cmd_chain_rsp_t) - sizeof(struct cmn_header_t);
+    rsp.device_cmd_start_ts = start_cycles;
+    rsp.device_cmd_wait_dur = exec_start_cycles - start_cycles;
+    rsp.device_cmd_execute_dur = PMC_GET_LATENCY(exec_start_cycles);
+
+    if (Host_Iface_CQ_Push_Cmd(MM_CQ_FOR_SQ(sqw_idx), &rsp, sizeof(rsp)) == STATUS_SUCCESS)
+    {
+        if (rsp.status == CMD_CHAIN_RESPONSE_SUCCESS)
+        {
+            TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_CMD_CHAIN_CMD, sqw_idx,
+                cmd->command_info.cmd_hdr.tag_id, CMD_STATUS_SUCCEEDED)
+        }
+        else if (rsp.status == CMD_CHAIN_RESPONSE_HOST_ABORTED)
+        {
+            TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_CMD_CHAIN_CMD, sqw_idx,
+                cmd->command_info.cmd_hdr.tag_id, CMD_STATUS_ABORTED)
+        }
+        else
+        {
+            TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_CMD_CHAIN_CMD, sqw_idx,
+                cmd->command_info.cmd_hdr.tag_id, CMD_STATUS_FAILED)
+        }
+
+        Log_Write(LOG_LEVEL_DEBUG,
+            "TID[%u]:SQW[%d]:HostCommandHandler:CQ_Push:CMD_CHAIN_CMD_RSP:status=%d:stage=%d\r\n",
+            cmd->command_info.cmd_hdr.tag_id, sqw_idx, rsp.status, rsp.failed_stage);
+    }
+    else
+    {
+        TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_CMD_CHAIN_CMD, sqw_idx,
+            cmd->command_info.cmd_hdr.tag_id, CMD_STATUS_FAILED)
+
+        Log_Write(LOG_LEVEL_ERROR,
+            "TID[%u]:SQW[%d]:HostCommandHandler:Tag_ID=%u:CQ_Push:Failed\r\n",
+            cmd->command_info.cmd_hdr.tag_id, sqw_idx, cmd->command_info.cmd_hdr.tag_id);
+        SP_Iface_Report_Error(MM_RECOVERABLE_FW_MM_SQW_ERROR, MM_CQ_PUSH_ERROR);
+    }
+
+    /* Decrement commands count being processed by given SQW */
+    SQW_Decrement_Command_Count(sqw_idx);
+
+    return status;
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       cmd_list_is_stage_cmd
+*
+*   DESCRIPTION
+*
+*       Checks if a command can be a stage of a command list.
+*
+*   INPUTS
+*
+*       msg_id           Message ID of the command
+*
+*   OUTPUTS
+*
+*       bool             true if the command can be in a list
+*
+***********************************************************************/
+static inline bool cmd_list_is_stage_cmd(uint16_t msg_id)
+{
+    return cmd_chain_is_stage_cmd(msg_id) || (msg_id == DEV_OPS_API_MID_DEVICE_OPS_MEMSET_CMD) ||
+           (msg_id == DEV_OPS_API_MID_DEVICE_OPS_DEVICE_MEMCPY_CMD) ||
+           (msg_id == DEV_OPS_API_MID_DEVICE_OPS_KERNEL_FLUSH_RANGES_CMD) ||
+           (msg_id == DEV_OPS_API_MID_DEVICE_OPS_KERNEL_SHIRE_ARGS_CMD) ||
+           (msg_id == DEV_OPS_API_MID_DEVICE_OPS_KERNEL_WATCHDOG_CMD) ||
+           (msg_id == DEV_OPS_API_MID_DEVICE_OPS_KERNEL_LAUNCH_CONFIG_CMD);
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       cmd_list_prepare_stage
+*
+*   DESCRIPTION
+*
+*       Applies to the copy of a command list stage the patches falling in
+*       it and the buffers given by the list execute command, and gives it
+*       the tag ID of the list execute command.
+*
+*   INPUTS
+*
+*       cmd              Command list execute command
+*       stage            Copy of the stage
+*       offset           Offset of the stage in the list
+*
+*   OUTPUTS
+*
+*       None
+*
+***********************************************************************/
+static inline void cmd_list_prepare_stage(
+    const struct device_ops_cmd_list_execute_cmd_t *cmd, uint8_t *stage, uint32_t offset)
+{
+    struct cmd_header_t *hdr = (void *)stage;
+    uint32_t size = hdr->cmd_hdr.size;
+
+    for (uint32_t i = 0; i < cmd->patch_count; i++)
+    {
+        if ((cmd->patches[i].offset >= offset) && (cmd->patches[i].offset < (offset + size)))
+        {
+            *(uint64_t *)(uintptr_t)&stage[cmd->patches[i].offset - offset] =
+                cmd->patches[i].value;
+        }
+    }
+
+    if (hdr->cmd_hdr.msg_id == DEV_OPS_API_MID_DEVICE_OPS_KERNEL_LAUNCH_CMD)
+    {
+        struct device_ops_kernel_launch_cmd_t *launch = (void *)stage;
+
+        if (cmd->exception_buffer != 0)
+        {
+            launch->exception_buffer = cmd->exception_buffer;
+        }
+        if ((cmd->args_buffer != 0) &&
+            (launch->command_info.cmd_hdr.flags & CMD_FLAGS_KERNEL_LAUNCH_ARGS_EMBEDDED))
+        {
+            launch->pointer_to_args = cmd->args_buffer;
+        }
+    }
+
+    /* No other command of the SQ can be in flight with the tag of the list */
+    hdr->cmd_hdr.tag_id = cmd->command_info.cmd_hdr.tag_id;
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       cmd_list_execute_cmd_handler
+*
+*   DESCRIPTION
+*
+*       Process host command list execute command, and transmit response.
+*       The stages are read one by one from device memory, and run as the
+*       stages of a command chain, so the host only gets the list response.
+*
+*   INPUTS
+*
+*       command_buffer   Buffer containing command to process
+*       sqw_idx          Submission queue index
+*       start_cycle      Cycle count to measure wait latency
+*
+*   OUTPUTS
+*
+*       int32_t           Successful status or error code.
+*
+***********************************************************************/
+static inline int32_t cmd_list_execute_cmd_handler(
+    void *command_buffer, uint8_t sqw_idx, uint64_t start_cycles)
+{
+    const struct device_ops_cmd_list_execute_cmd_t *cmd =
+        (struct device_ops_cmd_list_execute_cmd_t *)command_buffer;
+    struct device_ops_cmd_list_execute_rsp_t rsp = { 0 };
+    uint8_t *stage = cmd_list_stage_buffers[sqw_idx];
+    const struct cmd_header_t *stage_hdr = (const void *)stage;
+    uint64_t dram_end = MM_Config_Get_DRAM_End_Address();
+    uint64_t exec_start_cycles = PMC_Get_Current_Cycles();
+    uint32_t offset = 0;
+    uint16_t stage_msg_id = 0;
+    int32_t status = STATUS_SUCCESS;
+
+    TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_CMD_LIST_EXECUTE_CMD, sqw_idx,
+        cmd->command_info.cmd_hdr.tag_id, CMD_STATUS_RECEIVED)
+
+    Log_Write(LOG_LEVEL_DEBUG,
+        "TID[%u]:SQW[%d]:HostCommandHandler:Processing:CMD_LIST_EXECUTE_CMD:addr=%" PRIx64
+        ":size=%d:stages=%d:patches=%d\r\n",
+        cmd->command_info.cmd_hdr.tag_id, sqw_idx, cmd->list_address, cmd->list_size,
+        cmd->stage_count, cmd->patch_count);
+
+    rsp.status = CMD_LIST_RESPONSE_SUCCESS;
+    rsp.failed_stage = cmd->stage_count;
+
+    if ((cmd->stage_count == 0) || (cmd->patch_count > MM_CMD_LIST_PATCHES_MAX) ||
+        !IS_ALIGNED(cmd->list_address, 8) || (cmd->list_address < HOST_MANAGED_DRAM_START) ||
+        (cmd->list_address > dram_end) || (cmd->list_size > (dram_end - cmd->list_address)))
+    {
+        rsp.status = CMD_LIST_RESPONSE_INVALID_LIST;
+        status = HOST_CMD_ERROR_INVALID_CMD_LIST;
+    }
+
+    for (uint32_t i = 0; (i < cmd->patch_count) && (rsp.status == CMD_LIST_RESPONSE_SUCCESS); i++)
+    {
+        if (!IS_ALIGNED(cmd->patches[i].offset, 8) || (cmd->list_size < sizeof(uint64_t)) ||
+            (cmd->patches[i].offset > (cmd->list_size - sizeof(uint64_t))))
+        {
+            rsp.status = CMD_LIST_RESPONSE_INVALID_LIST;
+            status = HOST_CMD_ERROR_INVALID_CMD_LIST;
+        }
+    }
+
+    if (rsp.status == CMD_LIST_RESPONSE_SUCCESS)
+    {
+        TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_CMD_LIST_EXECUTE_CMD, sqw_idx,
+            cmd->command_info.cmd_hdr.tag_id, CMD_STATUS_EXECUTING)
+    }
+
+    for (uint32_t i = 0; (i < cmd->stage_count) && (rsp.status == CMD_LIST_RESPONSE_SUCCESS); i++)
+    {
+        if ((offset + DEVICE_CMD_HEADER_SIZE) > cmd->list_size)
+        {
+            rsp.status = CMD_LIST_RESPONSE_INVALID_LIST;
+            rsp.failed_stage = i;
+            status = HOST_CMD_ERROR_INVALID_CMD_LIST;
+            break;
+        }
+
+        /* The list was written by the host through DMA, read it from L3 */
+        ETSOC_Memory_Read_Global_Atomic(
+            (void *)(uintptr_t)(cmd->list_address + offset), stage, DEVICE_CMD_HEADER_SIZE);
+
+        /* Verify the stage fits in the list and in the stage buffer, and can be listed */
+        if ((stage_hdr->cmd_hdr.size < DEVICE_CMD_HEADER_SIZE) ||
+            (stage_hdr->cmd_hdr.size > MM_CMD_LIST_STAGE_SIZE_MAX) ||
+            ((offset + stage_hdr->cmd_hdr.size) > cmd->list_size) ||
+            !cmd_list_is_stage_cmd(stage_hdr->cmd_hdr.msg_id))
+        {
+            rsp.status = CMD_LIST_RESPONSE_INVALID_LIST;
+            rsp.failed_stage = i;
+            status = HOST_CMD_ERROR_INVALID_CMD_LIST;
+        }
+        else if (SQW_Get_State(sqw_idx) == SQW_STATE_ABORTED)
+        {
+            rsp.status = CMD_LIST_RESPONSE_HOST_ABORTED;
+            rsp.failed_stage = i;
+        }
+        else
+        {
+            uint32_t stage_size = stage_hdr->cmd_hdr.size;
+
+            ETSOC_Memory_Read_Global_Atomic(
+                (void *)(uintptr_t)(cmd->list_address + offset), stage, stage_size);
+            cmd_list_prepare_stage(cmd, stage, offset);
+
+            if (!cmd_chain_run_stage(stage_hdr, sqw_idx, start_cycles, &rsp.stage_status,
+                    &stage_msg_id, &status))
+            {
+                rsp.stage_msg_id = stage_msg_id;
+                rsp.status = CMD_LIST_RESPONSE_STAGE_FAILED;
+                rsp.failed_stage = i;
+            }
+
+            offset += (uint32_t)ALIGN_TO(stage_size, 8U);
+        }
+    }
+
+    /* A failed or aborted list may have stopped between the stages setting up a kernel launch
+    and the launch itself, they must not apply to the next kernel of the SQ */
+    if (rsp.status != CMD_LIST_RESPONSE_SUCCESS)
+    {
+        KW_Clear_Kernel_Launch_State(sqw_idx);
+    }
+
+    /* Construct and transmit response */
+    rsp.response_info.rsp_hdr.tag_id = cmd->command_info.cmd_hdr.tag_id;
+    rsp.response_info.rsp_hdr.msg_id = DEV_OPS_API_MID_DEVICE_OPS_CMD_LIST_EXECUTE_RSP;
+    rsp.response_info.rsp_hdr.size =
+        sizeof(struct device_ops_cmd_list_execute_rsp_t) - sizeof(struct cmn_header_t);
+    rsp.device_cmd_start_ts = start_cycles;
+    rsp.device_cmd_wait_dur = exec_start_cycles - start_cycles;
+    rsp.device_cmd_execute_dur = PMC_GET_LATENCY(exec_start_cycles);
+
+    if (Host_Iface_CQ_Push_Cmd(MM_CQ_FOR_SQ(sqw_idx), &rsp, sizeof(rsp)) == STATUS_SUCCESS)
+    {
+        if (rsp.status == CMD_LIST_RESPONSE_SUCCESS)
+        {
+            TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_CMD_LIST_EXECUTE_CMD, sqw_idx,
+                cmd->command_info.cmd_hdr.tag_id, CMD_STATUS_SUCCEEDED)
+        }
+        else if (rsp.status == CMD_LIST_RESPONSE_HOST_ABORTED)
+        {
+            TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_CMD_LIST_EXECUTE_CMD, sqw_idx,
+                cmd->command_info.cmd_hdr.tag_id, CMD_STATUS_ABORTED)
+        }
+        else
+        {
+            TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_CMD_LIST_EXECUTE_CMD, sqw_idx,
+                cmd->command_info.cmd_hdr.tag_id, CMD_STATUS_FAILED)
+        }
+
+        Log_Write(LOG_LEVEL_DEBUG,
+            "TID[%u]:SQW[%d]:HostCommandHandler:CQ_Push:CMD_LIST_EXECUTE_RSP:status=%d:stage=%d\r\n",
+            cmd->command_info.cmd_hdr.tag_id, sqw_idx, rsp.status, rsp.failed_stage);
+    }
+    else
+    {
+        TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_CMD_LIST_EXECUTE_CMD, sqw_idx,
+            cmd->command_info.cmd_hdr.tag_id, CMD_STATUS_FAILED)
+
+        Log_Write(LOG_LEVEL_ERROR,
+            "TID[%u]:SQW[%d]:HostCommandHandler:Tag_ID=%u:CQ_Push:Failed\r\n",
+            cmd->command_info.cmd_hdr.tag_id, sqw_idx, cmd->command_info.cmd_hdr.tag_id);
+        SP_Iface_Report_Error(MM_RECOVERABLE_FW_MM_SQW_ERROR, MM_CQ_PUSH_ERROR);
+    }
+
+    /* Decrement commands count being processed by given SQW */
+    SQW_Decrement_Command_Count(sqw_idx);
+
+    return status;
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       memset_fill_chunk
+*
+*   DESCRIPTION
+*
+*       Fills a chunk of device memory with the pattern and evicts it to L3.
+*       The bytes before and after the 8 bytes aligned part are stored one by
+*       one; the pattern fits an aligned 64 bits word as the destination is
+*       aligned to the pattern size.
+*
+*   INPUTS
+*
+*       dst              Start of the chunk
+*       size             Size of the chunk in bytes
+*       pattern          Pattern repeated to 64 bits
+*       pattern_size     Size of the pattern in bytes, dst is aligned to it
+*
+*   OUTPUTS
+*
+*       None
+*
+***********************************************************************/
+static inline void memset_fill_chunk(
+    uint8_t *dst, uint64_t size, uint64_t pattern, uint8_t pattern_size)
+{
+    uint8_t *end = dst + size;
+    uint8_t *ptr = dst;
+    uint8_t pattern_offset = 0;
+    uint64_t evict_start;
+    uint64_t evict_end;
+
+    while ((ptr < end) && (((uintptr_t)ptr & 0x7U) != 0U))
+    {
+        *ptr = (uint8_t)(pattern >> (8U * pattern_offset));
+        pattern_offset = (uint8_t)((pattern_offset + 1U) % pattern_size);
+        ptr++;
+    }
+
+    /* Aligned words start on a pattern boundary, as 8 is a multiple of the pattern size */
+    while ((ptr + sizeof(uint64_t)) <= end)
+    {
+        *(uint64_t *)(uintptr_t)ptr = pattern;
+        ptr += sizeof(uint64_t);
+    }
+
+    pattern_offset = 0;
+    while (ptr < end)
+    {
+        *ptr = (uint8_t)(pattern >> (8U * pattern_offset));
+        pattern_offset = (uint8_t)((pattern_offset + 1U) % pattern_size);
+        ptr++;
+    }
+
+    /* Evict whole cache lines, the partial ones at both ends included */
+    evict_start = (uintptr_t)dst & ~((uint64_t)CACHE_LINE_SIZE - 1U);
+    evict_end = ((uintptr_t)end + CACHE_LINE_SIZE - 1U) & ~((uint64_t)CACHE_LINE_SIZE - 1U);
+    ETSOC_MEM_EVICT((void *)(uintptr_t)evict_start, evict_end - evict_start, to_L3)
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       memset_cmd_handler
+*
+*   DESCRIPTION
+*
+*       Process host memset command, and transmit response.
+*       The SQW fills the device memory itself, in chunks of
+*       MM_MEMSET_CHUNK_SIZE bytes, checking for an abort between them.
+*
+*   INPUTS
+*
+*       command_buffer   Buffer containing command to process
+*       sqw_idx          Submission queue index
+*       start_cycle      Cycle count to measure wait latency
+*
+*   OUTPUTS
+*
+*       int32_t           Successful status or error code.
+*
+***********************************************************************/
+static inline int32_t memset_cmd_handler(
+    void *command_buffer, uint8_t sqw_idx, uint64_t start_cycles)
+{
+    const struct device_ops_memset_cmd_t *cmd = (struct device_ops_memset_cmd_t *)command_buffer;
+    struct device_ops_memset_rsp_t rsp = { 0 };
+    int32_t status = STATUS_SUCCESS;
+    sqw_state_e sqw_state = SQW_Get_State(sqw_idx);
+    uint64_t pattern = cmd->pattern;
+    uint64_t dram_end = MM_Config_Get_DRAM_End_Address();
+
+    (void)start_cycles;
+
+    TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_MEMSET_CMD, sqw_idx,
+        cmd->command_info.cmd_hdr.tag_id, CMD_STATUS_RECEIVED)
+
+    Log_Write(LOG_LEVEL_DEBUG,
+        "TID[%u]:SQW[%d]:HostCommandHandler:Processing:MEMSET_CMD:addr=%" PRIx64
+        ":size=%" PRIx64 ":pattern_size=%d\r\n",
+        cmd->command_info.cmd_hdr.tag_id, sqw_idx, cmd->dst_device_phy_addr, cmd->size,
+        cmd->pattern_size);
+
+    rsp.status = MEMSET_RESPONSE_SUCCESS;
+
+    if ((cmd->pattern_size != 1U) && (cmd->pattern_size != 2U) && (cmd->pattern_size != 4U) &&
+        (cmd->pattern_size != 8U))
+    {
+        rsp.status = MEMSET_RESPONSE_INVALID_PATTERN;
+        status = HOST_CMD_ERROR_INVALID_MEMSET;
+    }
+    else if ((cmd->dst_device_phy_addr % cmd->pattern_size != 0U) ||
+             (cmd->size % cmd->pattern_size != 0U))
+    {
+        rsp.status = MEMSET_RESPONSE_INVALID_PATTERN;
+        status = HOST_CMD_ERROR_INVALID_MEMSET;
+    }
+    else if ((cmd->dst_device_phy_addr < HOST_MANAGED_DRAM_START) ||
+             (cmd->dst_device_phy_addr > dram_end) ||
+             (cmd->size > (dram_end - cmd->dst_device_phy_addr)))
+    {
+        rsp.status = MEMSET_RESPONSE_INVALID_ADDRESS;
+        status = HOST_CMD_ERROR_INVALID_MEMSET;
+    }
+    else if (sqw_state != SQW_STATE_ABORTED)
+    {
+        TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_MEMSET_CMD, sqw_idx,
+            cmd->command_info.cmd_hdr.tag_id, CMD_STATUS_EXECUTING)
+
+        /* Repeat the pattern to fill a 64 bits word */
+        for (uint8_t width = cmd->pattern_size; width < sizeof(uint64_t);
+             width = (uint8_t)(width * 2U))
+        {
+            pattern &= (1ULL << (8U * width)) - 1U;
+            pattern |= pattern << (8U * width);
+        }
+
+        for (uint64_t offset = 0; (offset < cmd->size) && (sqw_state != SQW_STATE_ABORTED);
+             offset += MM_MEMSET_CHUNK_SIZE)
+        {
+            uint64_t chunk = cmd->size - offset;
+            if (chunk > MM_MEMSET_CHUNK_SIZE)
+            {
+                chunk = MM_MEMSET_CHUNK_SIZE;
+            }
+            /* Chunks start on a pattern boundary, as the chunk size is a multiple of 8 */
+            memset_fill_chunk((uint8_t *)(uintptr_t)(cmd->dst_device_phy_addr + offset), chunk,
+                pattern, cmd->pattern_size);
+            sqw_state = SQW_Get_State(sqw_idx);
+        }
+    }
+
+    if ((rsp.status == MEMSET_RESPONSE_SUCCESS) && (sqw_state == SQW_STATE_ABORTED))
+    {
+        rsp.status = MEMSET_RESPONSE_HOST_ABORTED;
+    }
+
+    /* Construct and transmit response */
+    rsp.response_info.rsp_hdr.tag_id = cmd->command_info.cmd_hdr.tag_id;
+    rsp.response_info.rsp_hdr.msg_id = DEV_OPS_API_MID_DEVICE_OPS_MEMSET_RSP;
+    rsp.response_info.rsp_hdr.size =
+        sizeof(struct device_ops_memset_rsp_t) - sizeof(struct cmn_header_t);
+
+    if (Host_Iface_CQ_Push_Cmd(MM_CQ_FOR_SQ(sqw_idx), &rsp, sizeof(rsp)) == STATUS_SUCCESS)
+    {
+        if (rsp.status == MEMSET_RESPONSE_SUCCESS)
+        {
+            TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_MEMSET_CMD, sqw_idx,
+                cmd->command_info.cmd_hdr.tag_id, CMD_STATUS_SUCCEEDED)
+        }
+        else if (rsp.status == MEMSET_RESPONSE_HOST_ABORTED)
+        {
+            TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_MEMSET_CMD, sqw_idx,
+                cmd->command_info.cmd_hdr.tag_id, CMD_STATUS_ABORTED)
+        }
+        else
+        {
+            TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_MEMSET_CMD, sqw_idx,
+                cmd->command_info.cmd_hdr.tag_id, CMD_STATUS_FAILED)
+        }
+
+        Log_Write(LOG_LEVEL_DEBUG,
+            "TID[%u]:SQW[%d]:HostCommandHandler:CQ_Push:MEMSET_CMD_RSP:status=%d\r\n",
+            cmd->command_info.cmd_hdr.tag_id, sqw_idx, rsp.status);
+    }
+    else
+    {
+        TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_MEMSET_CMD, sqw_idx,
+            cmd->command_info.cmd_hdr.tag_id, CMD_STATUS_FAILED)
+
+        Log_Write(LOG_LEVEL_ERROR,
+            "TID[%u]:SQW[%d]:HostCommandHandler:Tag_ID=%u:CQ_Push:Failed\r\n",
+            cmd->command_info.cmd_hdr.tag_id, sqw_idx, cmd->command_info.cmd_hdr.tag_id);
+        SP_Iface_Report_Error(MM_RECOVERABLE_FW_MM_SQW_ERROR, MM_CQ_PUSH_ERROR);
+    }
+
+    /* Decrement commands count being processed by given SQW */
+    SQW_Decrement_Command_Count(sqw_idx);
+
+    return status;
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       device_memcpy_range_is_valid
+*
+*   DESCRIPTION
+*
+*       Checks that a range is within the host managed DRAM.
+*
+*   INPUTS
+*
+*       addr             Start of the range
+*       size             Size of the range in bytes
+*
+*   OUTPUTS
+*
+*       bool             true if the range is valid
+*
+***********************************************************************/
+static inline bool device_memcpy_range_is_valid(uint64_t addr, uint64_t size)
+{
+    uint64_t dram_end = MM_Config_Get_DRAM_End_Address();
+
+    return (addr >= HOST_MANAGED_DRAM_START) && (addr <= dram_end) && (size <= (dram_end - addr));
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       device_memcpy_chunk
+*
+*   DESCRIPTION
+*
+*       Copies a chunk within the device memory. The source lines are evicted
+*       first so stale lines in the MM caches are not read, and the
+*       destination lines are evicted to L3 once written. Overlapping source
+*       and destination are copied byte by byte in the safe direction.
+*
+*   INPUTS
+*
+*       dst              Destination of the chunk
+*       src              Source of the chunk
+*       size             Size of the chunk in bytes
+*
+*   OUTPUTS
+*
+*       None
+*
+***********************************************************************/
+static inline void device_memcpy_chunk(uint8_t *dst, const uint8_t *src, uint64_t size)
+{
+    uint64_t line_mask = (uint64_t)CACHE_LINE_SIZE - 1U;
+    uint64_t src_start = (uintptr_t)src & ~line_mask;
+    uint64_t src_end = ((uintptr_t)src + size + line_mask) & ~line_mask;
+    uint64_t dst_start = (uintptr_t)dst & ~line_mask;
+    uint64_t dst_end = ((uintptr_t)dst + size + line_mask) & ~line_mask;
+
+    ETSOC_MEM_EVICT((void *)(uintptr_t)src_start, src_end - src_start, to_L3)
+    if ((dst + size <= src) || (src + size <= dst))
+    {
+        memcpy(dst, src, size);
+    }
+    else if (dst < src)
+    {
+        for (uint64_t i = 0; i < size; i++)
+        {
+            dst[i] = src[i];
+        }
+    }
+    else
+    {
+        for (uint64_t i = size; i > 0; i--)
+        {
+            dst[i - 1] = src[i - 1];
+        }
+    }
+    ETSOC_MEM_EVICT((void *)(uintptr_t)dst_start, dst_end - dst_start, to_L3)
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       device_memcpy_cmd_handler
+*
+*   DESCRIPTION
+*
+*       Process host device memcpy command, and transmit response.
+*       The SQW copies the data itself, in chunks of
+*       MM_DEVICE_MEMCPY_CHUNK_SIZE bytes, checking for an abort between
+*       them. When the destination overlaps the end of the source the chunks
+*       are copied from the last one.
+*
+*   INPUTS
+*
+*       command_buffer   Buffer containing command to process
+*       sqw_idx          Submission queue index
+*       start_cycle      Cycle count to measure wait latency
+*
+*   OUTPUTS
+*
+*       int32_t           Successful status or error code.
+*
+***********************************************************************/
+static inline int32_t device_memcpy_cmd_handler(
+    void *command_buffer, uint8_t sqw_idx, uint64_t start_cycles)
+{
+    const struct device_ops_device_memcpy_cmd_t *cmd =
+        (struct device_ops_device_memcpy_cmd_t *)command_buffer;
+    struct device_ops_device_memcpy_rsp_t rsp = { 0 };
+    int32_t status = STATUS_SUCCESS;
+    sqw_state_e sqw_state = SQW_Get_State(sqw_idx);
+    uint64_t src = cmd->src_device_phy_addr;
+    uint64_t dst = cmd->dst_device_phy_addr;
+    bool backwards = (dst > src) && ((dst - src) < cmd->size);
+
+    (void)start_cycles;
+
+    TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_DEVICE_MEMCPY_CMD, sqw_idx,
+        cmd->command_info.cmd_hdr.tag_id, CMD_STATUS_RECEIVED)
+
+    Log_Write(LOG_LEVEL_DEBUG,
+        "TID[%u]:SQW[%d]:HostCommandHandler:Processing:DEVICE_MEMCPY_CMD:src=%" PRIx64
+        ":dst=%" PRIx64 ":size=%" PRIx64 "\r\n",
+        cmd->command_info.cmd_hdr.tag_id, sqw_idx, src, dst, cmd->size);
+
+    rsp.status = DEVICE_MEMCPY_RESPONSE_SUCCESS;
+
+    if (!device_memcpy_range_is_valid(src, cmd->size) ||
+        !device_memcpy_range_is_valid(dst, cmd->size))
+    {
+        rsp.status = DEVICE_MEMCPY_RESPONSE_INVALID_ADDRESS;
+        status = HOST_CMD_ERROR_INVALID_DEVICE_MEMCPY;
+    }
+    else if (sqw_state != SQW_STATE_ABORTED)
+    {
+        TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_DEVICE_MEMCPY_CMD, sqw_idx,
+            cmd->command_info.cmd_hdr.tag_id, CMD_STATUS_EXECUTING)
+
+        for (uint64_t done = 0; (done < cmd->size) && (sqw_state != SQW_STATE_ABORTED);)
+        {
+            uint64_t chunk = cmd->size - done;
+            uint64_t offset;
+            if (chunk > MM_DEVICE_MEMCPY_CHUNK_SIZE)
+            {
+                chunk = MM_DEVICE_MEMCPY_CHUNK_SIZE;
+            }
+            /* Copying from the end keeps the source chunks intact until they are read */
+            offset = backwards ? (cmd->size - done - chunk) : done;
+            device_memcpy_chunk((uint8_t *)(uintptr_t)(dst + offset),
+                (const uint8_t *)(uintptr_t)(src + offset), chunk);
+            done += chunk;
+            sqw_state = SQW_Get_State(sqw_idx);
+        }
+    }
+
+    if ((rsp.status == DEVICE_MEMCPY_RESPONSE_SUCCESS) && (sqw_state == SQW_STATE_ABORTED))
+    {
+        rsp.status = DEVICE_MEMCPY_RESPONSE_HOST_ABORTED;
+    }
+
+    /* Construct and transmit response */
+    rsp.response_info.rsp_hdr.tag_id = cmd->command_info.cmd_hdr.tag_id;
+    rsp.response_info.rsp_hdr.msg_id = DEV_OPS_API_MID_DEVICE_OPS_DEVICE_MEMCPY_RSP;
+    rsp.response_info.rsp_hdr.size =
+        sizeof(struct device_ops_device_memcpy_rsp_t) - sizeof(struct cmn_header_t);
+
+    if (Host_Iface_CQ_Push_Cmd(MM_CQ_FOR_SQ(sqw_idx), &rsp, sizeof(rsp)) == STATUS_SUCCESS)
+    {
+        if (rsp.status == DEVICE_MEMCPY_RESPONSE_SUCCESS)
+        {
+            TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_DEVICE_MEMCPY_CMD, sqw_idx,
+                cmd->command_info.cmd_hdr.tag_id, CMD_STATUS_SUCCEEDED)
+        }
+        else if (rsp.status == DEVICE_MEMCPY_RESPONSE_HOST_ABORTED)
+        {
+            TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_DEVICE_MEMCPY_CMD, sqw_idx,
+                cmd->command_info.cmd_hdr.tag_id, CMD_STATUS_ABORTED)
+        }
+        else
+        {
+            TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_DEVICE_MEMCPY_CMD, sqw_idx,
+                cmd->command_info.cmd_hdr.tag_id, CMD_STATUS_FAILED)
+        }
+
+        Log_Write(LOG_LEVEL_DEBUG,
+            "TID[%u]:SQW[%d]:HostCommandHandler:CQ_Push:DEVICE_MEMCPY_CMD_RSP:status=%d\r\n",
+            cmd->command_info.cmd_hdr.tag_id, sqw_idx, rsp.status);
+    }
+    else
+    {
+        TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_DEVICE_MEMCPY_CMD, sqw_idx,
+            cmd->command_info.cmd_hdr.tag_id, CMD_STATUS_FAILED)
+
+        Log_Write(LOG_LEVEL_ERROR,
+            "TID[%u]:SQW[%d]:HostCommandHandler:Tag_ID=%u:CQ_Push:Failed\r\n",
+            cmd->command_info.cmd_hdr.tag_id, sqw_idx, cmd->command_info.cmd_hdr.tag_id);
+        SP_Iface_Report_Error(MM_RECOVERABLE_FW_MM_SQW_ERROR, MM_CQ_PUSH_ERROR);
+    }
+
+    /* Decrement commands count being processed by given SQW */
+    SQW_Decrement_Command_Count(sqw_idx);
+
+    return status;
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       kernel_flush_ranges_cmd_handler
+*
+*   DESCRIPTION
+*
+*       Process host kernel flush ranges command, and transmit response.
+*       The ranges are kept by the KW until the next kernel launched from
+*       the same submission queue, which flushes them at its completion.
+*
+*   INPUTS
+*
+*       command_buffer   Buffer containing command to process
+*       sqw_idx          Submission queue index
+*       start_cycle      Cycle count to measure wait latency
+*
+*   OUTPUTS
+*
+*       int32_t           Successful status or error code.
+*
+***********************************************************************/
+static inline int32_t kernel_flush_ranges_cmd_handler(
+    void *command_buffer, uint8_t sqw_idx, uint64_t start_cycles)
+{
+    const struct device_ops_kernel_flush_ranges_cmd_t *cmd =
+        (struct device_ops_kernel_flush_ranges_cmd_t *)command_buffer;
+    struct device_ops_kernel_flush_ranges_rsp_t rsp = { 0 };
+    cache_ops_range_t ranges[MM_KERNEL_FLUSH_RANGES_MAX];
+    int32_t status = STATUS_SUCCESS;
+
+    (void)start_cycles;
+
+    TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_KERNEL_FLUSH_RANGES_CMD, sqw_idx,
+        cmd->command_info.cmd_hdr.tag_id, CMD_STATUS_RECEIVED)
+
+    Log_Write(LOG_LEVEL_DEBUG,
+        "TID[%u]:SQW[%d]:HostCommandHandler:Processing:KERNEL_FLUSH_RANGES_CMD:count=%u\r\n",
+        cmd->command_info.cmd_hdr.tag_id, sqw_idx, cmd->count);
+
+    rsp.status = KERNEL_FLUSH_RANGES_RESPONSE_SUCCESS;
+
+    if (SQW_Get_State(sqw_idx) == SQW_STATE_ABORTED)
+    {
+        rsp.status = KERNEL_FLUSH_RANGES_RESPONSE_HOST_ABORTED;
+    }
+    else if (cmd->count > MM_KERNEL_FLUSH_RANGES_MAX)
+    {
+        rsp.status = KERNEL_FLUSH_RANGES_RESPONSE_INVALID_ADDRESS;
+        status = HOST_CMD_ERROR_INVALID_FLUSH_RANGES;
+    }
+    else
+    {
+        for (uint32_t i = 0; i < cmd->count; i++)
+        {
+            ranges[i].address = cmd->ranges[i].device_phy_addr;
+            ranges[i].size = cmd->ranges[i].size;
+
+            if ((ranges[i].size == 0U) ||
+                !device_memcpy_range_is_valid(ranges[i].address, ranges[i].size))
+            {
+                rsp.status = KERNEL_FLUSH_RANGES_RESPONSE_INVALID_ADDRESS;
+                status = HOST_CMD_ERROR_INVALID_FLUSH_RANGES;
+                break;
+            }
+        }
+
+        if (rsp.status == KERNEL_FLUSH_RANGES_RESPONSE_SUCCESS)
+        {
+            KW_Set_Kernel_Flush_Ranges(sqw_idx, ranges, cmd->count);
+        }
+    }
+
+    /* Construct and transmit response */
+    rsp.response_info.rsp_hdr.tag_id = cmd->command_info.cmd_hdr.tag_id;
+    rsp.response_info.rsp_hdr.msg_id = DEV_OPS_API_MID_DEVICE_OPS_KERNEL_FLUSH_RANGES_RSP;
+    rsp.response_info.rsp_hdr.size =
+        sizeof(struct device_ops_kernel_flush_ranges_rsp_t) - sizeof(struct cmn_header_t);
+
+    if (Host_Iface_CQ_Push_Cmd(MM_CQ_FOR_SQ(sqw_idx), &rsp, sizeof(rsp)) == STATUS_SUCCESS)
+    {
+        if (rsp.status == KERNEL_FLUSH_RANGES_RESPONSE_SUCCESS)
+        {
+            TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_KERNEL_FLUSH_RANGES_CMD, sqw_idx,
+                cmd->command_info.cmd_hdr.tag_id, CMD_STATUS_SUCCEEDED)
+        }
+        else if (rsp.status == KERNEL_FLUSH_RANGES_RESPONSE_HOST_ABORTED)
+        {
+            TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_KERNEL_FLUSH_RANGES_CMD, sqw_idx,
+                cmd->command_info.cmd_hdr.tag_id, CMD_STATUS_ABORTED)
+        }
+        else
+        {
+            TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_KERNEL_FLUSH_RANGES_CMD, sqw_idx,
+                cmd->command_info.cmd_hdr.tag_id, CMD_STATUS_FAILED)
+        }
+
+        Log_Write(LOG_LEVEL_DEBUG,
+            "TID[%u]:SQW[%d]:HostCommandHandler:CQ_Push:KERNEL_FLUSH_RANGES_CMD_RSP:status=%d\r\n",
+            cmd->command_info.cmd_hdr.tag_id, sqw_idx, rsp.status);
+    }
+    else
+    {
+        TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_KERNEL_FLUSH_RANGES_CMD, sqw_idx,
+            cmd->command_info.cmd_hdr.tag_id, CMD_STATUS_FAILED)
+
+        Log_Write(LOG_LEVEL_ERROR,
+            "TID[%u]:SQW[%d]:HostCommandHandler:Tag_ID=%u:CQ_Push:Failed\r\n",
+            cmd->command_info.cmd_hdr.tag_id, sqw_idx, cmd->command_info.cmd_hdr.tag_id);
+        SP_Iface_Report_Error(MM_RECOVERABLE_FW_MM_SQW_ERROR, MM_CQ_PUSH_ERROR);
+    }
+
+    /* Decrement commands count being processed by given SQW */
+    SQW_Decrement_Command_Count(sqw_idx);
+
+    return status;
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       kernel_shire_args_cmd_handler
+*
+*   DESCRIPTION
+*
+*       Process host kernel shire args command, and transmit response.
+*       The stride is kept by the KW until the next kernel launched from
+*       the same submission queue, whose shires then get a pointer to
+*       their own slice of its arguments.
+*
+*   INPUTS
+*
+*       command_buffer   Buffer containing command to process
+*       sqw_idx          Submission queue index
+*       start_cycle      Cycle count to measure wait latency
+*
+*   OUTPUTS
+*
+*       int32_t           Successful status or error code.
+*
+***********************************************************************/
+static inline int32_t kernel_shire_args_cmd_handler(
+    void *command_buffer, uint8_t sqw_idx, uint64_t start_cycles)
+{
+    const struct device_ops_kernel_shire_args_cmd_t *cmd =
+        (struct device_ops_kernel_shire_args_cmd_t *)command_buffer;
+    struct device_ops_kernel_shire_args_rsp_t rsp = { 0 };
+    int32_t status = STATUS_SUCCESS;
+
+    (void)start_cycles;
+
+    TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_KERNEL_SHIRE_ARGS_CMD, sqw_idx,
+        cmd->command_info.cmd_hdr.tag_id, CMD_STATUS_RECEIVED)
+
+    Log_Write(LOG_LEVEL_DEBUG,
+        "TID[%u]:SQW[%d]:HostCommandHandler:Processing:KERNEL_SHIRE_ARGS_CMD:stride=%u\r\n",
+        cmd->command_info.cmd_hdr.tag_id, sqw_idx, cmd->stride);
+
+    rsp.status = KERNEL_SHIRE_ARGS_RESPONSE_SUCCESS;
+
+    if (SQW_Get_State(sqw_idx) == SQW_STATE_ABORTED)
+    {
+        rsp.status = KERNEL_SHIRE_ARGS_RESPONSE_HOST_ABORTED;
+    }
+    else if ((cmd->stride % 8U) != 0U)
+    {
+        /* Each slice must keep the 64-bit alignment of the arguments */
+        rsp.status = KERNEL_SHIRE_ARGS_RESPONSE_INVALID_STRIDE;
+        status = HOST_CMD_ERROR_INVALID_SHIRE_ARGS;
+    }
+    else
+    {
+        KW_Set_Kernel_Shire_Args(sqw_idx, cmd->stride);
+    }
+
+    /* Construct and transmit response */
+    rsp.response_info.rsp_hdr.tag_id = cmd->command_info.cmd_hdr.tag_id;
+    rsp.response_info.rsp_hdr.msg_id = DEV_OPS_API_MID_DEVICE_OPS_KERNEL_SHIRE_ARGS_RSP;
+    rsp.response_info.rsp_hdr.size =
+        sizeof(struct device_ops_kernel_shire_args_rsp_t) - sizeof(struct cmn_header_t);
+
+    if (Host_Iface_CQ_Push_Cmd(MM_CQ_FOR_SQ(sqw_idx), &rsp, sizeof(rsp)) == STATUS_SUCCESS)
+    {
+        if (rsp.status == KERNEL_SHIRE_ARGS_RESPONSE_SUCCESS)
+        {
+            TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_KERNEL_SHIRE_ARGS_CMD, sqw_idx,
+                cmd->command_info.cmd_hdr.tag_id, CMD_STATUS_SUCCEEDED)
+        }
+        else if (rsp.status == KERNEL_SHIRE_ARGS_RESPONSE_HOST_ABORTED)
+        {
+            TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_KERNEL_SHIRE_ARGS_CMD, sqw_idx,
+                cmd->command_info.cmd_hdr.tag_id, CMD_STATUS_ABORTED)
+        }
+        else
+        {
+            TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_KERNEL_SHIRE_ARGS_CMD, sqw_idx,
+                cmd->command_info.cmd_hdr.tag_id, CMD_STATUS_FAILED)
+        }
+
+        Log_Write(LOG_LEVEL_DEBUG,
+            "TID[%u]:SQW[%d]:HostCommandHandler:CQ_Push:KERNEL_SHIRE_ARGS_CMD_RSP:status=%d\r\n",
+            cmd->command_info.cmd_hdr.tag_id, sqw_idx, rsp.status);
+    }
+    else
+    {
+        TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_KERNEL_SHIRE_ARGS_CMD, sqw_idx,
+            cmd->command_info.cmd_hdr.tag_id, CMD_STATUS_FAILED)
+
+        Log_Write(LOG_LEVEL_ERROR,
+            "TID[%u]:SQW[%d]:HostCommandHandler:Tag_ID=%u:CQ_Push:Failed\r\n",
+            cmd->command_info.cmd_hdr.tag_id, sqw_idx, cmd->command_info.cmd_hdr.tag_id);
+        SP_Iface_Report_Error(MM_RECOVERABLE_FW_MM_SQW_ERROR, MM_CQ_PUSH_ERROR);
+    }
+
+    /* Decrement commands count being processed by given SQW */
+    SQW_Decrement_Command_Count(sqw_idx);
+
+    return status;
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       kernel_watchdog_cmd_handler
+*
+*   DESCRIPTION
+*
+*       Process host kernel watchdog command, and transmit response.
+*       The timeout is kept by the KW until the next kernel launched from
+*       the same submission queue, which has its shires aborted if it
+*       doesn't complete in time.
+*
+*   INPUTS
+*
+*       command_buffer   Buffer containing command to process
+*       sqw_idx          Submission queue index
+*       start_cycle      Cycle count to measure wait latency
+*
+*   OUTPUTS
+*
+*       int32_t           Successful status or error code.
+*
+***********************************************************************/
+static inline int32_t kernel_watchdog_cmd_handler(
+    void *command_buffer, uint8_t sqw_idx, uint64_t start_cycles)
+{
+    const struct device_ops_kernel_watchdog_cmd_t *cmd =
+        (struct device_ops_kernel_watchdog_cmd_t *)command_buffer;
+    struct device_ops_kernel_watchdog_rsp_t rsp = { 0 };
+    int32_t status = STATUS_SUCCESS;
+
+    (void)start_cycles;
+
+    TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_KERNEL_WATCHDOG_CMD, sqw_idx,
+        cmd->command_info.cmd_hdr.tag_id, CMD_STATUS_RECEIVED)
+
+    Log_Write(LOG_LEVEL_DEBUG,
+        "TID[%u]:SQW[%d]:HostCommandHandler:Processing:KERNEL_WATCHDOG_CMD:timeout=%u\r\n",
+        cmd->command_info.cmd_hdr.tag_id, sqw_idx, cmd->timeout);
+
+    rsp.status = KERNEL_WATCHDOG_RESPONSE_SUCCESS;
+
+    if (SQW_Get_State(sqw_idx) == SQW_STATE_ABORTED)
+    {
+        rsp.status = KERNEL_WATCHDOG_RESPONSE_HOST_ABORTED;
+    }
+    else
+    {
+        KW_Set_Kernel_Watchdog(sqw_idx, cmd->timeout);
+    }
+
+    /* Construct and transmit response */
+    rsp.response_info.rsp_hdr.tag_id = cmd->command_info.cmd_hdr.tag_id;
+    rsp.response_info.rsp_hdr.msg_id = DEV_OPS_API_MID_DEVICE_OPS_KERNEL_WATCHDOG_RSP;
+    rsp.response_info.rsp_hdr.size =
+        sizeof(struct device_ops_kernel_watchdog_rsp_t) - sizeof(struct cmn_header_t);
+
+    if (Host_Iface_CQ_Push_Cmd(MM_CQ_FOR_SQ(sqw_idx), &rsp, sizeof(rsp)) == STATUS_SUCCESS)
+    {
+        if (rsp.status == KERNEL_WATCHDOG_RESPONSE_SUCCESS)
+        {
+            TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_KERNEL_WATCHDOG_CMD, sqw_idx,
+                cmd->command_info.cmd_hdr.tag_id, CMD_STATUS_SUCCEEDED)
+        }
+        else
+        {
+            TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_KERNEL_WATCHDOG_CMD, sqw_idx,
+                cmd->command_info.cmd_hdr.tag_id, CMD_STATUS_ABORTED)
+        }
+
+        Log_Write(LOG_LEVEL_DEBUG,
+            "TID[%u]:SQW[%d]:HostCommandHandler:CQ_Push:KERNEL_WATCHDOG_CMD_RSP:status=%d\r\n",
+            cmd->command_info.cmd_hdr.tag_id, sqw_idx, rsp.status);
+    }
+    else
+    {
+        TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_KERNEL_WATCHDOG_CMD, sqw_idx,
+            cmd->command_info.cmd_hdr.tag_id, CMD_STATUS_FAILED)
+
+        Log_Write(LOG_LEVEL_ERROR,
+            "TID[%u]:SQW[%d]:HostCommandHandler:Tag_ID=%u:CQ_Push:Failed\r\n",
+            cmd->command_info.cmd_hdr.tag_id, sqw_idx, cmd->command_info.cmd_hdr.tag_id);
+        SP_Iface_Report_Error(MM_RECOVERABLE_FW_MM_SQW_ERROR, MM_CQ_PUSH_ERROR);
+    }
+
+    /* Decrement commands count being processed by given SQW */
+    SQW_Decrement_Command_Count(sqw_idx);
+
+    return status;
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       kernel_launch_config_cmd_handler
+*
+*   DESCRIPTION
+*
+*       Process host kernel launch config command, and transmit response.
+*       The config is kept by the KW until the next kernel launched from
+*       the same submission queue.
+*
+*   INPUTS
+*
+*       command_buffer   Buffer containing command to process
+*       sqw_idx          Submission queue index
+*       start_cycle      Cycle count to measure wait latency
+*
+*   OUTPUTS
+*
+*       int32_t           Successful status or error code.
+*
+***********************************************************************/
+static inline int32_t kernel_launch_config_cmd_handler(
+    void *command_buffer, uint8_t sqw_idx, uint64_t start_cycles)
+{
+    const struct device_ops_kernel_launch_config_cmd_t *cmd =
+        (struct device_ops_kernel_launch_config_cmd_t *)command_buffer;
+    struct device_ops_kernel_launch_config_rsp_t rsp = { 0 };
+    int32_t status = STATUS_SUCCESS;
+
+    (void)start_cycles;
+
+    TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_KERNEL_LAUNCH_CONFIG_CMD, sqw_idx,
+        cmd->command_info.cmd_hdr.tag_id, CMD_STATUS_RECEIVED)
+
+    Log_Write(LOG_LEVEL_DEBUG,
+        "TID[%u]:SQW[%d]:HostCommandHandler:Processing:KERNEL_LAUNCH_CONFIG_CMD:flags=0x%x:"
+        "scp_sets=%u:l2_sets=%u\r\n",
+        cmd->command_info.cmd_hdr.tag_id, sqw_idx, cmd->flags, cmd->scp_sets, cmd->l2_sets);
+
+    rsp.status = KERNEL_LAUNCH_CONFIG_RESPONSE_SUCCESS;
+
+    if (SQW_Get_State(sqw_idx) == SQW_STATE_ABORTED)
+    {
+        rsp.status = KERNEL_LAUNCH_CONFIG_RESPONSE_HOST_ABORTED;
+    }
+    else if ((cmd->flags & KERNEL_LAUNCH_CONFIG_FLAGS_SHIRE_CACHE_CONFIG) &&
+             (((cmd->scp_sets % 2U) != 0U) || ((cmd->l2_sets % 2U) != 0U) ||
+                 (cmd->l2_sets < 0x40U)))
+    {
+        /* Same constraints as the boot time configuration. Whether the sets fill the ones
+        below L3 is only known by the shires, which keep their partition if they don't */
+        rsp.status = KERNEL_LAUNCH_CONFIG_RESPONSE_INVALID_CACHE_CONFIG;
+        status = HOST_CMD_ERROR_INVALID_LAUNCH_CONFIG;
+    }
+    else
+    {
+        KW_Set_Kernel_Launch_Config(sqw_idx, cmd->flags, cmd->scp_sets, cmd->l2_sets);
+    }
+
+    /* Construct and transmit response */
+    rsp.response_info.rsp_hdr.tag_id = cmd->command_info.cmd_hdr.tag_id;
+    rsp.response_info.rsp_hdr.msg_id = DEV_OPS_API_MID_DEVICE_OPS_KERNEL_LAUNCH_CONFIG_RSP;
+    rsp.response_info.rsp_hdr.size =
+        sizeof(struct device_ops_kernel_launch_config_rsp_t) - sizeof(struct cmn_header_t);
+
+    if (Host_Iface_CQ_Push_Cmd(MM_CQ_FOR_SQ(sqw_idx), &rsp, sizeof(rsp)) == STATUS_SUCCESS)
+    {
+        if (rsp.status == KERNEL_LAUNCH_CONFIG_RESPONSE_SUCCESS)
+        {
+            TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_KERNEL_LAUNCH_CONFIG_CMD, sqw_idx,
+                cmd->command_info.cmd_hdr.tag_id, CMD_STATUS_SUCCEEDED)
+        }
+        else
+        {
+            TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_KERNEL_LAUNCH_CONFIG_CMD, sqw_idx,
+                cmd->command_info.cmd_hdr.tag_id, CMD_STATUS_ABORTED)
+        }
+
+        Log_Write(LOG_LEVEL_DEBUG,
+            "TID[%u]:SQW[%d]:HostCommandHandler:CQ_Push:KERNEL_LAUNCH_CONFIG_CMD_RSP:status=%d\r\n",
+            cmd->command_info.cmd_hdr.tag_id, sqw_idx, rsp.status);
+    }
+    else
+    {
+        TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_KERNEL_LAUNCH_CONFIG_CMD, sqw_idx,
+            cmd->command_info.cmd_hdr.tag_id, CMD_STATUS_FAILED)
+
+        Log_Write(LOG_LEVEL_ERROR,
+            "TID[%u]:SQW[%d]:HostCommandHandler:Tag_ID=%u:CQ_Push:Failed\r\n",
+            cmd->command_info.cmd_hdr.tag_id, sqw_idx, cmd->command_info.cmd_hdr.tag_id);
+        SP_Iface_Report_Error(MM_RECOVERABLE_FW_MM_SQW_ERROR, MM_CQ_PUSH_ERROR);
+    }
+
+    /* Decrement commands count being processed by given SQW */
+    SQW_Decrement_Command_Count(sqw_idx);
+
+    return status;
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       kernel_power_report_cmd_handler
+*
+*   DESCRIPTION
+*
+*       Process host kernel power report command, and transmit response
+*       with the Minion frequency and throttle events seen by the kernel
+*       launch it names, from the same submission queue. The host sends it
+*       with the barrier flag, so that kernel has completed.
+*
+*   INPUTS
+*
+*       command_buffer   Buffer containing command to process
+*       sqw_idx          Submission queue index
+*       start_cycle      Cycle count to measure wait latency
+*
+*   OUTPUTS
+*
+*       int32_t           Successful status or error code.
+*
+***********************************************************************/
+static inline int32_t kernel_power_report_cmd_handler(
+    void *command_buffer, uint8_t sqw_idx, uint64_t start_cycles)
+{
+    const struct device_ops_kernel_power_report_cmd_t *cmd =
+        (struct device_ops_kernel_power_report_cmd_t *)command_buffer;
+    struct device_ops_kernel_power_report_rsp_t rsp = { 0 };
+    uint16_t start_freq_mhz = 0;
+    uint16_t end_freq_mhz = 0;
+    uint32_t throttle_events = 0;
+    int32_t status = STATUS_SUCCESS;
+
+    (void)start_cycles;
+
+    TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_KERNEL_POWER_REPORT_CMD, sqw_idx,
+        cmd->command_info.cmd_hdr.tag_id, CMD_STATUS_RECEIVED)
+
+    Log_Write(LOG_LEVEL_DEBUG,
+        "TID[%u]:SQW[%d]:HostCommandHandler:Processing:KERNEL_POWER_REPORT_CMD\r\n",
+        cmd->command_info.cmd_hdr.tag_id, sqw_idx);
+
+    rsp.status = KERNEL_POWER_REPORT_RESPONSE_SUCCESS;
+
+    if (SQW_Get_State(sqw_idx) == SQW_STATE_ABORTED)
+    {
+        rsp.status = KERNEL_POWER_REPORT_RESPONSE_HOST_ABORTED;
+    }
+    else if (!KW_Get_Kernel_Power_Report(sqw_idx, cmd->kernel_launch_tag_id, &start_freq_mhz,
+                 &end_freq_mhz, &throttle_events))
+    {
+        rsp.status = KERNEL_POWER_REPORT_RESPONSE_NO_KERNEL;
+    }
+
+    /* Construct and transmit response */
+    rsp.response_info.rsp_hdr.tag_id = cmd->command_info.cmd_hdr.tag_id;
+    rsp.response_info.rsp_hdr.msg_id = DEV_OPS_API_MID_DEVICE_OPS_KERNEL_POWER_REPORT_RSP;
+    rsp.response_info.rsp_hdr.size =
+        sizeof(struct device_ops_kernel_power_report_rsp_t) - sizeof(struct cmn_header_t);
+    rsp.start_freq_mhz = start_freq_mhz;
+    rsp.end_freq_mhz = end_freq_mhz;
+    rsp.throttle_events = throttle_events;
+
+    if (Host_Iface_CQ_Push_Cmd(MM_CQ_FOR_SQ(sqw_idx), &rsp, sizeof(rsp)) == STATUS_SUCCESS)
+    {
+        if (rsp.status == KERNEL_POWER_REPORT_RESPONSE_SUCCESS)
+        {
+            TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_KERNEL_POWER_REPORT_CMD, sqw_idx,
+                cmd->command_info.cmd_hdr.tag_id, CMD_STATUS_SUCCEEDED)
+        }
+        else if (rsp.status == KERNEL_POWER_REPORT_RESPONSE_HOST_ABORTED)
+        {
+            TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_KERNEL_POWER_REPORT_CMD, sqw_idx,
+                cmd->command_info.cmd_hdr.tag_id, CMD_STATUS_ABORTED)
+        }
+        else
+        {
+            TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_KERNEL_POWER_REPORT_CMD, sqw_idx,
+                cmd->command_info.cmd_hdr.tag_id, CMD_STATUS_FAILED)
+        }
+
+        Log_Write(LOG_LEVEL_DEBUG,
+            "TID[%u]:SQW[%d]:HostCommandHandler:CQ_Push:KERNEL_POWER_REPORT_CMD_RSP:status=%d\r\n",
+            cmd->command_info.cmd_hdr.tag_id, sqw_idx, rsp.status);
+    }
+    else
+    {
+        TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_KERNEL_POWER_REPORT_CMD, sqw_idx,
+            cmd->command_info.cmd_hdr.tag_id, CMD_STATUS_FAILED)
+
+        Log_Write(LOG_LEVEL_ERROR,
+            "TID[%u]:SQW[%d]:HostCommandHandler:Tag_ID=%u:CQ_Push:Failed\r\n",
+            cmd->command_info.cmd_hdr.tag_id, sqw_idx, cmd->command_info.cmd_hdr.tag_id);
+        SP_Iface_Report_Error(MM_RECOVERABLE_FW_MM_SQW_ERROR, MM_CQ_PUSH_ERROR);
+    }
+
+    /* Decrement commands count being processed by given SQW */
+    SQW_Decrement_Command_Count(sqw_idx);
+
+    return status;
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       kernel_heap_config_cmd_handler
+*
+*   DESCRIPTION
+*
+*       Process host kernel heap configuration command, and transmit
+*       response. The region is split in KERNEL_HEAP_ARENA_COUNT arenas,
+*       their headers are cleared and evicted to L3 before the region is
+*       set in the kernel environments.
+*
+*   INPUTS
+*
+*       command_buffer   Buffer containing command to process
+*       sqw_idx          Submission queue index
+*       start_cycle      Cycle count to measure wait latency
+*
+*   OUTPUTS
+*
+*       int32_t           Successful status or error code.
+*
+***********************************************************************/
+static inline int32_t kernel_heap_config_cmd_handler(
+    void *command_buffer, uint8_t sqw_idx, uint64_t start_cycles)
+{
+    const struct device_ops_kernel_heap_config_cmd_t *cmd =
+        (struct device_ops_kernel_heap_config_cmd_t *)command_buffer;
+    struct device_ops_kernel_heap_config_rsp_t rsp = { 0 };
+    int32_t status = STATUS_SUCCESS;
+    uint64_t base = cmd->heap_device_phy_addr;
+    uint64_t arena_size =
+        (cmd->size / KERNEL_HEAP_ARENA_COUNT) & ~((uint64_t)CACHE_LINE_SIZE - 1U);
+
+    (void)start_cycles;
+
+    TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_KERNEL_HEAP_CONFIG_CMD, sqw_idx,
+        cmd->command_info.cmd_hdr.tag_id, CMD_STATUS_RECEIVED)
+
+    Log_Write(LOG_LEVEL_DEBUG,
+        "TID[%u]:SQW[%d]:HostCommandHandler:Processing:KERNEL_HEAP_CONFIG_CMD:addr=%" PRIx64
+        ":size=%" PRIx64 "\r\n",
+        cmd->command_info.cmd_hdr.tag_id, sqw_idx, base, cmd->size);
+
+    rsp.status = KERNEL_HEAP_CONFIG_RESPONSE_SUCCESS;
+
+    if (SQW_Get_State(sqw_idx) == SQW_STATE_ABORTED)
+    {
+        rsp.status = KERNEL_HEAP_CONFIG_RESPONSE_HOST_ABORTED;
+    }
+    else if ((cmd->size != 0U) &&
+             (((base % CACHE_LINE_SIZE) != 0U) ||
+                 (arena_size <= KERNEL_HEAP_ARENA_HEADER_SIZE) ||
+                 !device_memcpy_range_is_valid(base, cmd->size)))
+    {
+        rsp.status = KERNEL_HEAP_CONFIG_RESPONSE_INVALID_ADDRESS;
+        status = HOST_CMD_ERROR_INVALID_KERNEL_HEAP;
+    }
+    else if (KW_Get_Kernel_State() == MM_STATE_BUSY)
+    {
+        /* The kernels running could be using the current arenas */
+        rsp.status = KERNEL_HEAP_CONFIG_RESPONSE_KERNELS_RUNNING;
+        status = HOST_CMD_ERROR_INVALID_KERNEL_HEAP;
+    }
+    else if (cmd->size == 0U)
+    {
+        KW_Set_Kernel_Heap(0U, 0U);
+    }
+    else
+    {
+        /* An arena with a zeroed header is empty */
+        for (uint32_t i = 0; i < KERNEL_HEAP_ARENA_COUNT; i++)
+        {
+            uint64_t *header = (uint64_t *)(uintptr_t)(base + (i * arena_size));
+
+            for (uint32_t word = 0; word < (KERNEL_HEAP_ARENA_HEADER_SIZE / 8U); word++)
+            {
+                header[word] = 0U;
+            }
+            ETSOC_MEM_EVICT((void *)header, KERNEL_HEAP_ARENA_HEADER_SIZE, to_L3)
+        }
+        KW_Set_Kernel_Heap(base, arena_size);
+    }
+
+    /* Construct and transmit response */
+    rsp.response_info.rsp_hdr.tag_id = cmd->command_info.cmd_hdr.tag_id;
+    rsp.response_info.rsp_hdr.msg_id = DEV_OPS_API_MID_DEVICE_OPS_KERNEL_HEAP_CONFIG_RSP;
+    rsp.response_info.rsp_hdr.size =
+        sizeof(struct device_ops_kernel_heap_config_rsp_t) - sizeof(struct cmn_header_t);
+
+    if (Host_Iface_CQ_Push_Cmd(MM_CQ_FOR_SQ(sqw_idx), &rsp, sizeof(rsp)) == STATUS_SUCCESS)
+    {
+        if (rsp.status == KERNEL_HEAP_CONFIG_RESPONSE_SUCCESS)
+        {
+            TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_KERNEL_HEAP_CONFIG_CMD, sqw_idx,
+                cmd->command_info.cmd_hdr.tag_id, CMD_STATUS_SUCCEEDED)
+        }
+        else if (rsp.status == KERNEL_HEAP_CONFIG_RESPONSE_HOST_ABORTED)
+        {
+            TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_KERNEL_HEAP_CONFIG_CMD, sqw_idx,
+                cmd->command_info.cmd_hdr.tag_id, CMD_STATUS_ABORTED)
+        }
+        else
+        {
+            TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_KERNEL_HEAP_CONFIG_CMD, sqw_idx,
+                cmd->command_info.cmd_hdr.tag_id, CMD_STATUS_FAILED)
+        }
+
+        Log_Write(LOG_LEVEL_DEBUG,
+            "TID[%u]:SQW[%d]:HostCommandHandler:CQ_Push:KERNEL_HEAP_CONFIG_CMD_RSP:status=%d\r\n",
+            cmd->command_info.cmd_hdr.tag_id, sqw_idx, rsp.status);
+    }
+    else
+    {
+        TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_KERNEL_HEAP_CONFIG_CMD, sqw_idx,
+            cmd->command_info.cmd_hdr.tag_id, CMD_STATUS_FAILED)
+
+        Log_Write(LOG_LEVEL_ERROR,
+            "TID[%u]:SQW[%d]:HostCommandHandler:Tag_ID=%u:CQ_Push:Failed\r\n",
+            cmd->command_info.cmd_hdr.tag_id, sqw_idx, cmd->command_info.cmd_hdr.tag_id);
+        SP_Iface_Report_Error(MM_RECOVERABLE_FW_MM_SQW_ERROR, MM_CQ_PUSH_ERROR);
+    }
+
+    /* Decrement commands count being processed by given SQW */
+    SQW_Decrement_Command_Count(sqw_idx);
+
+    return status;
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       kernel_launch_get_rsp_status
+*
+*   DESCRIPTION
+*
+*       Maps a kernel launch dispatch error onto its device api status
+*
+*   INPUTS
+*
+*       status           Error returned by the kernel launch dispatch
+*
+*   OUTPUTS
+*
+*       uint32_t          Kernel launch response status
+*
+***********************************************************************/
+static uint32_t kernel_launch_get_rsp_status(int32_t status)
+{
+    uint32_t rsp_status;
+
+    if (status == KW_ERROR_KERNEL_INVALID_SHIRE_MASK)
+    {
+        rsp_status = DEV_OPS_API_KERNEL_LAUNCH_RESPONSE_INVALID_ARGS_INVALID_SHIRE_MASK;
+    }
+    else if (status == KW_ERROR_CW_SHIRES_NOT_READY)
+    {
+        rsp_status = DEV_OPS_API_KERNEL_LAUNCH_RESPONSE_SHIRES_NOT_READY;
+    }
+    else if (status == KW_ERROR_KERNEL_INVALID_ADDRESS)
+    {
+        rsp_status = DEV_OPS_API_KERNEL_LAUNCH_RESPONSE_INVALID_ADDRESS;
+    }
+    else if (status == KW_ERROR_KERNEL_INVALID_ARGS_SIZE)
+    {
+        rsp_status = DEV_OPS_API_KERNEL_LAUNCH_RESPONSE_INVALID_ARGS_PAYLOAD_SIZE;
+    }
+    else if ((status == KW_ABORTED_KERNEL_SLOT_SEARCH) ||
+             (status == KW_ABORTED_KERNEL_SHIRES_SEARCH) || (status == HOST_CMD_STATUS_ABORTED))
+    {
+        rsp_status = DEV_OPS_API_KERNEL_LAUNCH_RESPONSE_HOST_ABORTED;
+    }
+    else if (status == KW_ERROR_CM_IFACE_MULTICAST_FAILED)
     {
-        /* Report device API error to SP */
-        SP_Iface_Report_Error(MM_RECOVERABLE_OPS_API_ECHO, (int16_t)rsp.status);
+        rsp_status = DEV_OPS_API_KERNEL_LAUNCH_RESPONSE_CM_IFACE_MULTICAST_FAILED;
+    }
+    else if (status == KW_ERROR_KERNEL_UMODE_STACK_INVALID_CONFIG)
+    {
+        rsp_status = DEV_OPS_API_KERNEL_LAUNCH_RESPONSE_INVALID_ARGS_INVALID_STACK_CFG;
+    }
+    else
+    {
+        /* Unexpected error. It should never come here.*/
+        rsp_status = DEV_OPS_API_KERNEL_LAUNCH_RESPONSE_UNEXPECTED_ERROR;
     }
-#endif
 
-    return status;
+    return rsp_status;
 }
 
 /************************************************************************
@@ -856,40 +2680,10 @@ static inline int32_t kernel_launch_cmd_handler(
         rsp->device_cmd_execute_dur = 0U;
 
         /* Map device internal errors onto device api errors */
-        if (status == KW_ERROR_KERNEL_INVALID_SHIRE_MASK)
-        {
-            rsp->status = DEV_OPS_API_KERNEL_LAUNCH_RESPONSE_INVALID_ARGS_INVALID_SHIRE_MASK;
-        }
-        else if (status == KW_ERROR_CW_SHIRES_NOT_READY)
-        {
-            rsp->status = DEV_OPS_API_KERNEL_LAUNCH_RESPONSE_SHIRES_NOT_READY;
-        }
-        else if (status == KW_ERROR_KERNEL_INVALID_ADDRESS)
-        {
-            rsp->status = DEV_OPS_API_KERNEL_LAUNCH_RESPONSE_INVALID_ADDRESS;
-        }
-        else if (status == KW_ERROR_KERNEL_INVALID_ARGS_SIZE)
-        {
-            rsp->status = DEV_OPS_API_KERNEL_LAUNCH_RESPONSE_INVALID_ARGS_PAYLOAD_SIZE;
-        }
-        else if ((status == KW_ABORTED_KERNEL_SLOT_SEARCH) ||
-                 (status == KW_ABORTED_KERNEL_SHIRES_SEARCH) || (status == HOST_CMD_STATUS_ABORTED))
+        rsp->status = kernel_launch_get_rsp_status(status);
+        if (rsp->status == DEV_OPS_API_KERNEL_LAUNCH_RESPONSE_HOST_ABORTED)
         {
             strncpy(kernel_fail_msg, "Aborted", sizeof(kernel_fail_msg));
-            rsp->status = DEV_OPS_API_KERNEL_LAUNCH_RESPONSE_HOST_ABORTED;
-        }
-        else if (status == KW_ERROR_CM_IFACE_MULTICAST_FAILED)
-        {
-            rsp->status = DEV_OPS_API_KERNEL_LAUNCH_RESPONSE_CM_IFACE_MULTICAST_FAILED;
-        }
-        else if (status == KW_ERROR_KERNEL_UMODE_STACK_INVALID_CONFIG)
-        {
-            rsp->status = DEV_OPS_API_KERNEL_LAUNCH_RESPONSE_INVALID_ARGS_INVALID_STACK_CFG;
-        }
-        else
-        {
-            /* Unexpected error. It should never come here.*/
-            rsp->status = DEV_OPS_API_KERNEL_LAUNCH_RESPONSE_UNEXPECTED_ERROR;
         }
 
         Log_Write(LOG_LEVEL_ERROR,
@@ -908,7 +2702,7 @@ static inline int32_t kernel_launch_cmd_handler(
 #else
         rsp->response_info.rsp_hdr.size =
             (uint16_t)(sizeof(rsp_data) - sizeof(struct cmn_header_t));
-        status = Host_Iface_CQ_Push_Cmd(0, rsp, sizeof(rsp_data));
+        status = Host_Iface_CQ_Push_Cmd(MM_CQ_FOR_SQ(sqw_idx), rsp, sizeof(rsp_data));
 #endif
         /* Check for abort status for trace logging.
         Since we are in failure path, we will ignore CQ push status for logging to trace. */
@@ -949,6 +2743,173 @@ static inline int32_t kernel_launch_cmd_handler(
     return status;
 }
 
+/************************************************************************
+*
+*   FUNCTION
+*
+*       kernel_multi_launch_cmd_handler
+*
+*   DESCRIPTION
+*
+*       Process host kernel multi-launch command. Each kernel is
+*       dispatched like a kernel launch; the KW completing the last of
+*       them transmits the single response of the command.
+*
+*   INPUTS
+*
+*       command_buffer   Buffer containing command to process
+*       sqw_idx          Submission queue index
+*       start_cycle      Cycle count to measure wait latency
+*
+*   OUTPUTS
+*
+*       int32_t           Successful status or error code.
+*
+***********************************************************************/
+static inline int32_t kernel_multi_launch_cmd_handler(
+    void *command_buffer, uint8_t sqw_idx, uint64_t start_cycles)
+{
+    const struct device_ops_kernel_multi_launch_cmd_t *cmd =
+        (struct device_ops_kernel_multi_launch_cmd_t *)command_buffer;
+    struct device_ops_kernel_multi_launch_rsp_t rsp = { 0 };
+    struct device_ops_kernel_launch_cmd_t launch_cmd;
+    execution_cycles_t cycles;
+    uint64_t used_shire_mask = 0;
+    uint8_t group_idx;
+    uint8_t kw_idx;
+    int32_t status = STATUS_SUCCESS;
+
+    TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_KERNEL_MULTI_LAUNCH_CMD, sqw_idx,
+        cmd->command_info.cmd_hdr.tag_id, CMD_STATUS_RECEIVED)
+
+    Log_Write(LOG_LEVEL_DEBUG,
+        "TID[%u]:SQW[%d]:HostCommandHandler:Processing:KERNEL_MULTI_LAUNCH_CMD:count=%u\r\n",
+        cmd->command_info.cmd_hdr.tag_id, sqw_idx, cmd->count);
+
+    rsp.status = KERNEL_MULTI_LAUNCH_RESPONSE_COMPLETED;
+
+    if (SQW_Get_State(sqw_idx) == SQW_STATE_ABORTED)
+    {
+        rsp.status = KERNEL_MULTI_LAUNCH_RESPONSE_HOST_ABORTED;
+    }
+    else if ((cmd->count == 0U) || (cmd->count > MM_KERNEL_MULTI_LAUNCH_MAX))
+    {
+        rsp.status = KERNEL_MULTI_LAUNCH_RESPONSE_INVALID_ARGS;
+        status = HOST_CMD_ERROR_INVALID_MULTI_LAUNCH;
+    }
+    else
+    {
+        /* The kernels run at the same time, so their shires can't overlap */
+        for (uint32_t i = 0; i < cmd->count; i++)
+        {
+            if ((cmd->entries[i].shire_mask == 0U) ||
+                ((cmd->entries[i].shire_mask & used_shire_mask) != 0U))
+            {
+                rsp.status = KERNEL_MULTI_LAUNCH_RESPONSE_INVALID_ARGS;
+                status = HOST_CMD_ERROR_INVALID_MULTI_LAUNCH;
+                break;
+            }
+            used_shire_mask |= cmd->entries[i].shire_mask;
+        }
+    }
+
+    /* Compute Wait Cycles (cycles the command waits to
+    launch on Compute Minions) Snapshot current cycle */
+    cycles.cmd_start_cycles = start_cycles;
+    cycles.wait_cycles = PMC_GET_LATENCY(start_cycles);
+    cycles.exec_start_cycles = PMC_Get_Current_Cycles();
+
+    if ((rsp.status == KERNEL_MULTI_LAUNCH_RESPONSE_COMPLETED) &&
+        (KW_Reserve_Multi_Launch(sqw_idx, cmd->command_info.cmd_hdr.tag_id, cmd->count, &cycles,
+             &group_idx) != STATUS_SUCCESS))
+    {
+        rsp.status = KERNEL_MULTI_LAUNCH_RESPONSE_HOST_ABORTED;
+    }
+
+    if (rsp.status == KERNEL_MULTI_LAUNCH_RESPONSE_COMPLETED)
+    {
+        for (uint8_t i = 0; i < cmd->count; i++)
+        {
+            /* Each kernel is dispatched as a kernel launch without optional payload */
+            memset(&launch_cmd, 0, sizeof(launch_cmd));
+            launch_cmd.command_info.cmd_hdr.tag_id = cmd->command_info.cmd_hdr.tag_id;
+            launch_cmd.command_info.cmd_hdr.msg_id = DEV_OPS_API_MID_DEVICE_OPS_KERNEL_LAUNCH_CMD;
+            launch_cmd.command_info.cmd_hdr.size = sizeof(launch_cmd);
+            launch_cmd.code_start_address = cmd->entries[i].code_start_address;
+            launch_cmd.pointer_to_args = cmd->entries[i].pointer_to_args;
+            launch_cmd.shire_mask = cmd->entries[i].shire_mask;
+            launch_cmd.exception_buffer = cmd->exception_buffer;
+
+            /* Blocking call to launch kernel */
+            status = KW_Dispatch_Kernel_Launch_Cmd(&launch_cmd, sqw_idx, &kw_idx);
+
+            if (status == STATUS_SUCCESS)
+            {
+                cycles.exec_start_cycles = PMC_Get_Current_Cycles();
+                KW_Notify_Multi_Launch_Entry(kw_idx, group_idx, i, &cycles);
+
+                Log_Write(LOG_LEVEL_DEBUG,
+                    "TID[%u]:SQW[%d]:KW[%d]:HostCommandHandler:MultiLaunch:Entry:%d:Notified\r\n",
+                    cmd->command_info.cmd_hdr.tag_id, sqw_idx, kw_idx, i);
+            }
+            else
+            {
+                Log_Write(LOG_LEVEL_ERROR,
+                    "TID[%u]:SQW[%d]:HostCmdHdlr:MultiLaunch:Entry:%d:shire_mask:0x%lx Status:%d\r\n",
+                    cmd->command_info.cmd_hdr.tag_id, sqw_idx, i, cmd->entries[i].shire_mask,
+                    status);
+
+                /* The response is sent here if every other entry is already completed */
+                KW_Complete_Multi_Launch_Entry(
+                    group_idx, i, kernel_launch_get_rsp_status(status), 0U);
+            }
+        }
+
+        return STATUS_SUCCESS;
+    }
+
+    /* The command was refused as a whole, construct and transmit response */
+    rsp.response_info.rsp_hdr.tag_id = cmd->command_info.cmd_hdr.tag_id;
+    rsp.response_info.rsp_hdr.msg_id = DEV_OPS_API_MID_DEVICE_OPS_KERNEL_MULTI_LAUNCH_RSP;
+    rsp.response_info.rsp_hdr.size =
+        sizeof(struct device_ops_kernel_multi_launch_rsp_t) - sizeof(struct cmn_header_t);
+    rsp.device_cmd_start_ts = start_cycles;
+    rsp.device_cmd_wait_dur = cycles.wait_cycles;
+
+    if (Host_Iface_CQ_Push_Cmd(MM_CQ_FOR_SQ(sqw_idx), &rsp, sizeof(rsp)) == STATUS_SUCCESS)
+    {
+        if (rsp.status == KERNEL_MULTI_LAUNCH_RESPONSE_HOST_ABORTED)
+        {
+            TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_KERNEL_MULTI_LAUNCH_CMD, sqw_idx,
+                cmd->command_info.cmd_hdr.tag_id, CMD_STATUS_ABORTED)
+        }
+        else
+        {
+            TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_KERNEL_MULTI_LAUNCH_CMD, sqw_idx,
+                cmd->command_info.cmd_hdr.tag_id, CMD_STATUS_FAILED)
+        }
+
+        Log_Write(LOG_LEVEL_DEBUG,
+            "TID[%u]:SQW[%d]:HostCommandHandler:CQ_Push:KERNEL_MULTI_LAUNCH_CMD_RSP:status=%d\r\n",
+            cmd->command_info.cmd_hdr.tag_id, sqw_idx, rsp.status);
+    }
+    else
+    {
+        TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_KERNEL_MULTI_LAUNCH_CMD, sqw_idx,
+            cmd->command_info.cmd_hdr.tag_id, CMD_STATUS_FAILED)
+
+        Log_Write(LOG_LEVEL_ERROR,
+            "TID[%u]:SQW[%d]:HostCommandHandler:Tag_ID=%u:CQ_Push:Failed\r\n",
+            cmd->command_info.cmd_hdr.tag_id, sqw_idx, cmd->command_info.cmd_hdr.tag_id);
+        SP_Iface_Report_Error(MM_RECOVERABLE_FW_MM_SQW_ERROR, MM_CQ_PUSH_ERROR);
+    }
+
+    /* Decrement commands count being processed by given SQW */
+    SQW_Decrement_Command_Count(sqw_idx);
+
+    return status;
+}
+
 /************************************************************************
 *
 *   FUNCTION
@@ -1021,7 +2982,7 @@ static inline int32_t kernel_abort_cmd_handler(void *command_buffer, uint8_t sqw
             rsp.status = DEV_OPS_API_KERNEL_ABORT_RESPONSE_ERROR;
         }
 
-        status = Host_Iface_CQ_Push_Cmd(0, &rsp, sizeof(rsp));
+        status = Host_Iface_CQ_Push_Cmd(MM_CQ_FOR_SQ(sqw_idx), &rsp, sizeof(rsp));
 
         /* Check for abort status for trace logging.
         Since we are in failure path, we will ignore CQ push status for logging to trace. */
@@ -1153,10 +3114,16 @@ static inline int32_t dma_readlist_cmd_process_trace_flags(struct cmd_header_t *
     {
         if (cmd->list[TRACE_NODE_INDEX].size <= MM_TRACE_BUFFER_SIZE)
         {
-            /* Evict MM Trace.*/
-            Trace_Evict_Buffer_MM();
+            uint32_t data_size;
 
-            cmd->list[TRACE_NODE_INDEX].src_device_phy_addr = MM_TRACE_BUFFER_BASE;
+            /* Drain the full MM Trace sub-buffer if any, else the one being logged. */
+            cmd->list[TRACE_NODE_INDEX].src_device_phy_addr = Trace_Drain_Buffer_MM(&data_size);
+
+            /* Don't read past the sub-buffer data */
+            if (cmd->list[TRACE_NODE_INDEX].size > data_size)
+            {
+                cmd->list[TRACE_NODE_INDEX].size = data_size;
+            }
         }
         else
         {
@@ -1263,6 +3230,7 @@ static inline int32_t dma_readlist_cmd_handler(
     struct device_ops_dma_readlist_rsp_t rsp;
     dma_flags_e dma_flag;
     dma_write_chan_id_e chan = DMA_CHAN_ID_WRITE_INVALID;
+    uint8_t chan_mask = 0;
     int32_t status = STATUS_SUCCESS;
     uint8_t dma_xfer_count = 0;
     uint8_t loop_cnt;
@@ -1313,6 +3281,14 @@ static inline int32_t dma_readlist_cmd_handler(
             /* Obtain the next available DMA write channel */
             status = DMAW_Write_Find_Idle_Chan_And_Reserve(&chan, sqw_idx);
         }
+
+        if (status == STATUS_SUCCESS)
+        {
+            /* Stripe big lists across the other idle channels, trace buffers use a single one */
+            chan_mask = (dma_flag == DMA_NORMAL) ?
+                            DMAW_Write_Reserve_Stripe_Chans(chan, cmd_info, dma_xfer_count, sqw_idx) :
+                            (uint8_t)(1U << chan);
+        }
     }
 
     if (status == STATUS_SUCCESS)
@@ -1382,8 +3358,20 @@ static inline int32_t dma_readlist_cmd_handler(
         cycles.exec_start_cycles = PMC_Get_Current_Cycles();
 
         /* Initiate DMA write transfer */
-        status =
-            DMAW_Write_Trigger_Transfer(chan, cmd_info, dma_xfer_count, sqw_idx, &cycles, dma_flag);
+        status = DMAW_Write_Trigger_Transfer(
+            chan, chan_mask, cmd_info, dma_xfer_count, sqw_idx, &cycles, dma_flag);
+
+        /* The drained MM Trace sub-buffer must not be logged into till the transfer is done */
+        if ((status == STATUS_SUCCESS) && (dma_flag == DMA_SOC_NO_BOUNDS_CHECK) &&
+            (cmd_info->cmd_hdr.flags & CMD_FLAGS_MMFW_TRACEBUF) &&
+            !(cmd_info->cmd_hdr.flags & CMD_FLAGS_CMFW_TRACEBUF))
+        {
+            Trace_Drain_Started_MM(
+                ((const struct device_ops_dma_readlist_cmd_t *)command_buffer)
+                    ->list[TRACE_NODE_INDEX]
+                    .src_device_phy_addr,
+                (uint8_t)chan, cmd_info->cmd_hdr.tag_id);
+        }
     }
 
     if (status != STATUS_SUCCESS)
@@ -1462,7 +3450,7 @@ static inline int32_t dma_readlist_cmd_handler(
             "TID[%u]:SQW[%d]:HostCommandHandler:Pushing:%s_READLIST_RSP:Host_CQ\r\n",
             rsp.response_info.rsp_hdr.tag_id, sqw_idx, read_cmds[read_type]);
 
-        status = Host_Iface_CQ_Push_Cmd(0, &rsp, sizeof(rsp));
+        status = Host_Iface_CQ_Push_Cmd(MM_CQ_FOR_SQ(sqw_idx), &rsp, sizeof(rsp));
 
         /* Check for abort status for trace logging.
         Since we are in failure path, we will ignore CQ push status for logging to trace. */
@@ -1576,6 +3564,7 @@ static inline int32_t dma_writelist_cmd_handler(
     const struct cmd_header_t *cmd_info = (const struct cmd_header_t *)command_buffer;
     struct device_ops_dma_writelist_rsp_t rsp;
     dma_read_chan_id_e chan = DMA_CHAN_ID_READ_INVALID;
+    uint8_t chan_mask = 0;
     uint8_t dma_xfer_count = 0;
     uint8_t loop_cnt;
     int32_t status = STATUS_SUCCESS;
@@ -1611,6 +3600,12 @@ static inline int32_t dma_writelist_cmd_handler(
             /* Obtain the next available DMA read channel */
             status = DMAW_Read_Find_Idle_Chan_And_Reserve(&chan, sqw_idx);
         }
+
+        if (status == STATUS_SUCCESS)
+        {
+            /* Stripe big lists across the other idle channels */
+            chan_mask = DMAW_Read_Reserve_Stripe_Chans(chan, cmd_info, dma_xfer_count, sqw_idx);
+        }
     }
 
     if (status == STATUS_SUCCESS)
@@ -1685,7 +3680,8 @@ static inline int32_t dma_writelist_cmd_handler(
         cycles.exec_start_cycles = PMC_Get_Current_Cycles();
 
         /* Initiate DMA read transfer */
-        status = DMAW_Read_Trigger_Transfer(chan, cmd_info, dma_xfer_count, sqw_idx, &cycles);
+        status =
+            DMAW_Read_Trigger_Transfer(chan, chan_mask, cmd_info, dma_xfer_count, sqw_idx, &cycles);
     }
 
     if (status != STATUS_SUCCESS)
@@ -1760,7 +3756,7 @@ static inline int32_t dma_writelist_cmd_handler(
             }
         }
 
-        status = Host_Iface_CQ_Push_Cmd(0, &rsp, sizeof(rsp));
+        status = Host_Iface_CQ_Push_Cmd(MM_CQ_FOR_SQ(sqw_idx), &rsp, sizeof(rsp));
 
         /* Check for abort status for trace logging.
         Since we are in failure path, we will ignore CQ push status for logging to trace. */
@@ -1800,6 +3796,147 @@ static inline int32_t dma_writelist_cmd_handler(
     return status;
 }
 
+/************************************************************************
+*
+*   FUNCTION
+*
+*       dma_chain_cmd_handler
+*
+*   DESCRIPTION
+*
+*       Process host DMA chain command, and transmit response as needed.
+*       The chain resident in device DRAM is run by a single DMA read
+*       channel (host to device) or write channel (device to host), the
+*       response is sent by DMAW once the whole chain is done. The host side
+*       of its elements are offsets in the host buffer of the command.
+*
+*   INPUTS
+*
+*       command_buffer   Buffer containing command to process
+*       sqw_idx          Submission queue index
+*       start_cycle      Cycle count to measure wait latency
+*
+*   OUTPUTS
+*
+*       int32_t           Successful status or error code.
+*
+***********************************************************************/
+static inline int32_t dma_chain_cmd_handler(
+    const void *command_buffer, uint8_t sqw_idx, uint64_t start_cycles)
+{
+    const struct device_ops_dma_chain_cmd_t *cmd =
+        (const struct device_ops_dma_chain_cmd_t *)command_buffer;
+    const struct cmd_header_t *cmd_info = &cmd->command_info;
+    struct device_ops_dma_chain_rsp_t rsp = { 0 };
+    dma_read_chan_id_e read_chan = DMA_CHAN_ID_READ_INVALID;
+    dma_write_chan_id_e write_chan = DMA_CHAN_ID_WRITE_INVALID;
+    int32_t status = STATUS_SUCCESS;
+    execution_cycles_t cycles;
+    uint64_t chain_addr = cmd->chain_device_phy_addr;
+    uint32_t elem_count = cmd->elem_count;
+
+    TRACE_LOG_CMD_STATUS(
+        cmd_info->cmd_hdr.msg_id, sqw_idx, cmd_info->cmd_hdr.tag_id, CMD_STATUS_RECEIVED)
+
+    Log_Write(LOG_LEVEL_DEBUG,
+        "TID[%u]:SQW[%d]:HostCommandHandler:Processing:DMA_CHAIN_CMD:chain=%" PRIx64
+        ":elems=%u:dir=%u\r\n",
+        cmd_info->cmd_hdr.tag_id, sqw_idx, chain_addr, elem_count, cmd->direction);
+
+    /* Get the SQW state to check for command abort */
+    if (SQW_Get_State(sqw_idx) == SQW_STATE_ABORTED)
+    {
+        status = HOST_CMD_STATUS_ABORTED;
+    }
+    else if ((elem_count == 0) || (elem_count > MM_DMA_CHAIN_ELEMS_MAX) ||
+             (cmd->direction > DMA_CHAIN_DIRECTION_DEVICE_TO_HOST))
+    {
+        status = DMAW_ERROR_INVALID_XFER_COUNT;
+    }
+    else if (((chain_addr % MM_DMA_CHAIN_ALIGN) != 0) ||
+             !device_memcpy_range_is_valid(
+                 chain_addr, ((uint64_t)elem_count + 1U) * MM_DMA_CHAIN_ELEM_SIZE))
+    {
+        status = DMAW_ERROR_DRIVER_INAVLID_DEV_ADDRESS;
+    }
+    else if (cmd->direction == DMA_CHAIN_DIRECTION_HOST_TO_DEVICE)
+    {
+        /* Host to device data goes through a DMA read channel */
+        status = DMAW_Read_Find_Idle_Chan_And_Reserve(&read_chan, sqw_idx);
+    }
+    else
+    {
+        /* Device to host data goes through a DMA write channel */
+        status = DMAW_Write_Find_Idle_Chan_And_Reserve(&write_chan, sqw_idx);
+    }
+
+    if (status == STATUS_SUCCESS)
+    {
+        /* Compute Wait Cycles (cycles the command was sitting in
+        SQ prior to launch) Snapshot current cycle */
+        cycles.cmd_start_cycles = start_cycles;
+        cycles.wait_cycles = PMC_GET_LATENCY(start_cycles);
+        cycles.exec_start_cycles = PMC_Get_Current_Cycles();
+
+        /* Run the whole chain as a single transfer */
+        status = (cmd->direction == DMA_CHAIN_DIRECTION_HOST_TO_DEVICE) ?
+                     DMAW_Read_Trigger_Chain(
+                         read_chan, cmd_info, chain_addr, elem_count, cmd->host_phy_addr,
+                         cmd->host_size, sqw_idx, &cycles) :
+                     DMAW_Write_Trigger_Chain(write_chan, cmd_info, chain_addr, elem_count,
+                         cmd->host_phy_addr, cmd->host_size, sqw_idx, &cycles);
+    }
+
+    if (status != STATUS_SUCCESS)
+    {
+        char dma_fail_msg[8] = "Failed\0";
+        dma_fail_msg[sizeof(dma_fail_msg) - 1] = 0;
+
+        /* Construct and transit command response */
+        rsp.response_info.rsp_hdr.tag_id = cmd_info->cmd_hdr.tag_id;
+        rsp.response_info.rsp_hdr.msg_id = DEV_OPS_API_MID_DEVICE_OPS_DMA_CHAIN_RSP;
+        rsp.response_info.rsp_hdr.size = sizeof(rsp) - sizeof(struct cmn_header_t);
+        rsp.device_cmd_start_ts = start_cycles;
+        rsp.device_cmd_wait_dur = PMC_GET_LATENCY(start_cycles);
+        rsp.device_cmd_execute_dur = 0U;
+
+        /* Populate the error type response */
+        DMA_TO_DEVICEAPI_STATUS(status, rsp.status, dma_fail_msg)
+
+        Log_Write(LOG_LEVEL_ERROR,
+            "TID[%u]:SQW[%d]:HostCmdHdlr:DMA_CHAIN:%s:%d:chain=0x%lx:elems=%u\r\n",
+            cmd_info->cmd_hdr.tag_id, sqw_idx, dma_fail_msg, status, chain_addr, elem_count);
+
+        status = Host_Iface_CQ_Push_Cmd(MM_CQ_FOR_SQ(sqw_idx), &rsp, sizeof(rsp));
+
+        /* Since we are in failure path, we will ignore CQ push status for logging to trace. */
+        if (rsp.status == DEV_OPS_API_DMA_RESPONSE_HOST_ABORTED)
+        {
+            TRACE_LOG_CMD_STATUS(
+                cmd_info->cmd_hdr.msg_id, sqw_idx, cmd_info->cmd_hdr.tag_id, CMD_STATUS_ABORTED)
+        }
+        else
+        {
+            TRACE_LOG_CMD_STATUS(
+                cmd_info->cmd_hdr.msg_id, sqw_idx, cmd_info->cmd_hdr.tag_id, CMD_STATUS_FAILED)
+        }
+
+        if (status != STATUS_SUCCESS)
+        {
+            Log_Write(LOG_LEVEL_ERROR,
+                "TID[%u]::SQW[%d]:HostCommandHandler:Push:DMA_CHAIN_RSP:Host_CQ:Failed\r\n",
+                cmd_info->cmd_hdr.tag_id, sqw_idx);
+
+            SP_Iface_Report_Error(MM_RECOVERABLE_FW_MM_SQW_ERROR, MM_CQ_PUSH_ERROR);
+        }
+
+        /* Decrement commands count being processed by given SQW */
+        SQW_Decrement_Command_Count(sqw_idx);
+    }
+
+    return status;
+}
+
 /************************************************************************
 *
 *   FUNCTION
@@ -1902,7 +4039,7 @@ static inline int32_t trace_rt_control_cmd_handler(void *command_buffer, uint8_t
     rsp.response_info.rsp_hdr.size = sizeof(struct device_ops_trace_rt_control_rsp_t);
     status = SP_Iface_Push_Rsp_To_SP2MM_CQ(&rsp, sizeof(rsp));
 #else
-    status = Host_Iface_CQ_Push_Cmd(0, &rsp, sizeof(rsp));
+    status = Host_Iface_CQ_Push_Cmd(MM_CQ_FOR_SQ(sqw_idx), &rsp, sizeof(rsp));
 #endif
 
     if (status != STATUS_SUCCESS)
@@ -2063,7 +4200,7 @@ static inline int32_t trace_rt_config_cmd_handler(void *command_buffer, uint8_t
     rsp.response_info.rsp_hdr.size = sizeof(struct device_ops_trace_rt_config_rsp_t);
     status = SP_Iface_Push_Rsp_To_SP2MM_CQ(&rsp, sizeof(rsp));
 #else
-    status = Host_Iface_CQ_Push_Cmd(0, &rsp, sizeof(rsp));
+    status = Host_Iface_CQ_Push_Cmd(MM_CQ_FOR_SQ(sqw_idx), &rsp, sizeof(rsp));
 #endif
 
     if (status != STATUS_SUCCESS)
@@ -2203,12 +4340,51 @@ int32_t Host_Command_Handler(void *command_buffer, uint8_t sqw_idx, uint64_t sta
         case DEV_OPS_API_MID_DEVICE_OPS_P2PDMA_WRITELIST_CMD:
             status = dma_writelist_cmd_handler(command_buffer, sqw_idx, start_cycles);
             break;
+        case DEV_OPS_API_MID_DEVICE_OPS_DMA_CHAIN_CMD:
+            status = dma_chain_cmd_handler(command_buffer, sqw_idx, start_cycles);
+            break;
         case DEV_OPS_API_MID_DEVICE_OPS_TRACE_RT_CONTROL_CMD:
             status = trace_rt_control_cmd_handler(command_buffer, sqw_idx);
             break;
         case DEV_OPS_API_MID_DEVICE_OPS_TRACE_RT_CONFIG_CMD:
             status = trace_rt_config_cmd_handler(command_buffer, sqw_idx);
             break;
+        case DEV_OPS_API_MID_DEVICE_OPS_STREAM_SYNC_CMD:
+            status = stream_sync_cmd_handler(command_buffer, sqw_idx, start_cycles);
+            break;
+        case DEV_OPS_API_MID_DEVICE_OPS_CMD_CHAIN_CMD:
+            status = cmd_chain_cmd_handler(command_buffer, sqw_idx, start_cycles);
+            break;
+        case DEV_OPS_API_MID_DEVICE_OPS_CMD_LIST_EXECUTE_CMD:
+            status = cmd_list_execute_cmd_handler(command_buffer, sqw_idx, start_cycles);
+            break;
+        case DEV_OPS_API_MID_DEVICE_OPS_MEMSET_CMD:
+            status = memset_cmd_handler(command_buffer, sqw_idx, start_cycles);
+            break;
+        case DEV_OPS_API_MID_DEVICE_OPS_DEVICE_MEMCPY_CMD:
+            status = device_memcpy_cmd_handler(command_buffer, sqw_idx, start_cycles);
+            break;
+        case DEV_OPS_API_MID_DEVICE_OPS_KERNEL_HEAP_CONFIG_CMD:
+            status = kernel_heap_config_cmd_handler(command_buffer, sqw_idx, start_cycles);
+            break;
+        case DEV_OPS_API_MID_DEVICE_OPS_KERNEL_FLUSH_RANGES_CMD:
+            status = kernel_flush_ranges_cmd_handler(command_buffer, sqw_idx, start_cycles);
+            break;
+        case DEV_OPS_API_MID_DEVICE_OPS_KERNEL_SHIRE_ARGS_CMD:
+            status = kernel_shire_args_cmd_handler(command_buffer, sqw_idx, start_cycles);
+            break;
+        case DEV_OPS_API_MID_DEVICE_OPS_KERNEL_WATCHDOG_CMD:
+            status = kernel_watchdog_cmd_handler(command_buffer, sqw_idx, start_cycles);
+            break;
+        case DEV_OPS_API_MID_DEVICE_OPS_KERNEL_POWER_REPORT_CMD:
+            status = kernel_power_report_cmd_handler(command_buffer, sqw_idx, start_cycles);
+            break;
+        case DEV_OPS_API_MID_DEVICE_OPS_KERNEL_LAUNCH_CONFIG_CMD:
+            status = kernel_launch_config_cmd_handler(command_buffer, sqw_idx, start_cycles);
+            break;
+        case DEV_OPS_API_MID_DEVICE_OPS_KERNEL_MULTI_LAUNCH_CMD:
+            status = kernel_multi_launch_cmd_handler(command_buffer, sqw_idx, start_cycles);
+            break;
         default:
             Log_Write(LOG_LEVEL_ERROR, "TID[%u]:SQW[%d]:HostCmdHdlr:UnsupportedCmd\r\n",
                 hdr->cmd_hdr.tag_id, sqw_idx);
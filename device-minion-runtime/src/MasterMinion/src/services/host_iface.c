@@ -12,9 +12,12 @@
         Host_Iface_CQs_Init
         Host_Iface_Peek_SQ_Cmd_Size
         Host_Iface_Peek_SQ_Cmd
+        Host_Iface_Get_SQ_Used_Space
         Host_Iface_SQ_Pop_Cmd
         Host_Iface_Optimized_SQ_Update_Tail
         Host_Iface_CQ_Push_Cmd
+        Host_Iface_CQ_Capture_Rsp
+        Host_Iface_CQ_Get_Captured_Rsp_Size
         Host_Iface_Interrupt_Status
         Host_Iface_Processing
         Host_Iface_SQs_Deinit
@@ -24,6 +27,7 @@
 /* mm_rt_svcs */
 #include <transports/vq/vq.h>
 #include <etsoc/drivers/pcie/pcie_int.h>
+#include <etsoc/isa/hart.h>
 
 /* etsoc_hal */
 #include "hwinc/hal_device.h"
@@ -56,6 +60,20 @@ typedef struct host_iface_sqs_cb_ {
     vq_cb_t vqueues[MM_SQ_COUNT];
 } host_iface_sqs_cb_t;
 
+/*! \struct host_iface_cq_capture_t
+    \brief Response of a CQ to be captured by the MM instead of being sent
+    to the host, used by the command chain to track its stages
+*/
+typedef struct host_iface_cq_capture_ {
+    uint64_t rsp_buff;
+    uint32_t buff_size;
+    uint32_t rsp_size; /* Set once the response is captured */
+    uint32_t waiter;   /* Hart ID woken up once the response is captured */
+    uint16_t tag_id;
+    uint8_t armed;
+    uint8_t pad;
+} host_iface_cq_capture_t;
+
 /*! \struct host_iface_cqs_cb_t
     \brief Host interface control block that manages
     completion queues
@@ -64,6 +82,8 @@ typedef struct host_iface_cqs_cb_ {
     uint32_t vqueues_base; /* This is a 32 bit offset from 64 dram base */
     uint32_t per_vqueue_size;
     spinlock_t vqueue_locks[MM_CQ_COUNT];
+    uint32_t notify_pending[MM_CQ_COUNT]; /* Responses pushed since the last notification */
+    host_iface_cq_capture_t captures[MM_CQ_COUNT];
     vq_cb_t vqueues[MM_CQ_COUNT];
 } host_iface_cqs_cb_t;
 
@@ -282,6 +302,9 @@ int32_t Host_Iface_CQs_Init(void)
         /* Initialize the spinlock */
         init_local_spinlock(&Host_CQs.vqueue_locks[cq_index], 0);
 
+        /* No response pending for notification */
+        Host_CQs.notify_pending[cq_index] = 0;
+
         /* Initialize the CQ circular buffer */
         status = VQ_Init(&Host_CQs.vqueues[cq_index],
             VQ_CIRCBUFF_BASE_ADDR(MM_CQS_BASE_ADDRESS, cq_index, MM_CQ_SIZE), MM_CQ_SIZE, 0,
@@ -350,6 +373,37 @@ uint32_t Host_Iface_Peek_SQ_Cmd_Size(uint8_t sq_id)
     return command_size;
 }
 
+/************************************************************************
+*
+*   FUNCTION
+*
+*       Host_Iface_Get_SQ_Used_Space
+*
+*   DESCRIPTION
+*
+*       This function reads the SQ head and tail from the shared memory
+*       and returns the number of bytes the host submitted which are not
+*       yet processed.
+*
+*   INPUTS
+*
+*       sq_id      ID of the SQ.
+*
+*   OUTPUTS
+*
+*       uint32_t   Bytes used in the SQ.
+*
+***********************************************************************/
+uint32_t Host_Iface_Get_SQ_Used_Space(uint8_t sq_id)
+{
+    vq_cb_t *sq = &Host_SQs.vqueues[sq_id];
+    const circ_buff_cb_t *sq_cb =
+        (circ_buff_cb_t *)(uintptr_t)ETSOC_RT_MEM_READ_64((uint64_t *)&sq->circbuff_cb);
+
+    /* Read the SQ CB from the shared memory */
+    return (uint32_t)Circbuffer_Get_Used_Space(sq_cb, ETSOC_RT_MEM_READ_32(&sq->flags));
+}
+
 /************************************************************************
 *
 *   FUNCTION
@@ -386,11 +440,14 @@ int32_t Host_Iface_Peek_SQ_Cmd_Hdr(uint8_t sq_id, const void *cmd)
 *   DESCRIPTION
 *
 *       This function is used to push a command to host completion queue.
+*       The host is notified once the number of responses pushed since
+*       the last notification reaches the threshold it set in the CQ
+*       circular buffer CB, or right away if the CQ gets full.
 *
 *   INPUTS
 *
-*       sq_id      ID of the SQ to pop command from.
-*       rx_buff    Pointer to the RX buffer.
+*       cq_id      ID of the CQ to push the command to, see MM_CQ_FOR_SQ
+*       p_cmd      Pointer to the command.
 *       cmd_size   Command size
 *
 *   OUTPUTS
@@ -401,6 +458,46 @@ int32_t Host_Iface_Peek_SQ_Cmd_Hdr(uint8_t sq_id, const void *cmd)
 int32_t Host_Iface_CQ_Push_Cmd(uint8_t cq_id, const void *p_cmd, uint32_t cmd_size)
 {
     int32_t status;
+    uint64_t threshold;
+    uint32_t notify_vec = MM_CQ_NOTIFY_VECTOR + (uint32_t)cq_id;
+    uint32_t last_vec = pcie_get_interrupt_vectors() - 1U;
+    host_iface_cq_capture_t *capture = &Host_CQs.captures[cq_id];
+
+    /* Hand the response over to the MM if it was asked to be captured */
+    if ((atomic_load_local_8(&capture->armed) != 0U) &&
+        (((const struct rsp_header_t *)p_cmd)->rsp_hdr.tag_id ==
+            atomic_load_local_16(&capture->tag_id)))
+    {
+        uint32_t size = atomic_load_local_32(&capture->buff_size);
+        uint32_t waiter = atomic_load_local_32(&capture->waiter);
+
+        if (cmd_size < size)
+        {
+            size = cmd_size;
+        }
+
+        /* The capturing hart may not share the L1 with this one */
+        ETSOC_Memory_Write_Local_Atomic(
+            p_cmd, (void *)(uintptr_t)atomic_load_local_64(&capture->rsp_buff), size);
+        atomic_store_local_8(&capture->armed, 0U);
+        FENCE
+        atomic_store_local_32(&capture->rsp_size, size);
+
+        /* Release the capturing hart, unless it pushed the response itself */
+        if (waiter != get_hart_id())
+        {
+            FENCE
+            SQW_Wakeup_Hart(waiter);
+        }
+
+        return STATUS_SUCCESS;
+    }
+
+    /* The remaining CQs share the last vector enabled by the host */
+    if (notify_vec > last_vec)
+    {
+        notify_vec = last_vec;
+    }
 
     /* Acquire the lock. Multiple threads can call this function. */
     acquire_local_spinlock(&Host_CQs.vqueue_locks[cq_id]);
@@ -414,13 +511,29 @@ int32_t Host_Iface_CQ_Push_Cmd(uint8_t cq_id, const void *p_cmd, uint32_t cmd_si
         {
             Log_Write(LOG_LEVEL_WARNING, "HostIface:CQ[%d] push warning: status code: %d\n", cq_id,
                 status);
+
+            /* Flush the coalesced notification so the host drains the CQ */
+            if ((status == CIRCBUFF_ERROR_FULL) && (Host_CQs.notify_pending[cq_id] != 0))
+            {
+                Host_CQs.notify_pending[cq_id] = 0;
+                FENCE
+                pcie_interrupt_host(notify_vec);
+            }
         }
     } while (status == CIRCBUFF_ERROR_FULL);
 
     if (status == STATUS_SUCCESS)
     {
-        FENCE
-        status = pcie_interrupt_host(MM_CQ_NOTIFY_VECTOR);
+        /* Get the number of responses to coalesce per notification set by the host */
+        threshold = Circbuffer_Get_Notify_Threshold(
+            Host_CQs.vqueues[cq_id].circbuff_cb, Host_CQs.vqueues[cq_id].flags);
+
+        if (++Host_CQs.notify_pending[cq_id] >= threshold)
+        {
+            Host_CQs.notify_pending[cq_id] = 0;
+            FENCE
+            status = pcie_interrupt_host(notify_vec);
+        }
 
         /* Release the lock */
         release_local_spinlock(&Host_CQs.vqueue_locks[cq_id]);
@@ -442,6 +555,68 @@ int32_t Host_Iface_CQ_Push_Cmd(uint8_t cq_id, const void *p_cmd, uint32_t cmd_si
     return status;
 }
 
+/************************************************************************
+*
+*   FUNCTION
+*
+*       Host_Iface_CQ_Capture_Rsp
+*
+*   DESCRIPTION
+*
+*       This function makes the next response with the given tag ID
+*       pushed to the CQ be copied to the given buffer, instead of being
+*       sent to the host. The calling hart gets a SQW wake up credit once
+*       the response is captured, see SQW_Wait_For_Wakeup.
+*
+*   INPUTS
+*
+*       cq_id      ID of the CQ the response will be pushed to
+*       tag_id     Tag ID of the response
+*       rsp_buff   Buffer to copy the response to
+*       buff_size  Size of the buffer
+*
+*   OUTPUTS
+*
+*       None
+*
+***********************************************************************/
+void Host_Iface_CQ_Capture_Rsp(uint8_t cq_id, uint16_t tag_id, void *rsp_buff, uint32_t buff_size)
+{
+    host_iface_cq_capture_t *capture = &Host_CQs.captures[cq_id];
+
+    atomic_store_local_64(&capture->rsp_buff, (uint64_t)(uintptr_t)rsp_buff);
+    atomic_store_local_32(&capture->buff_size, buff_size);
+    atomic_store_local_32(&capture->rsp_size, 0U);
+    atomic_store_local_32(&capture->waiter, get_hart_id());
+    atomic_store_local_16(&capture->tag_id, tag_id);
+    FENCE
+    atomic_store_local_8(&capture->armed, 1U);
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       Host_Iface_CQ_Get_Captured_Rsp_Size
+*
+*   DESCRIPTION
+*
+*       This function returns the size of the response captured on the CQ.
+*
+*   INPUTS
+*
+*       cq_id      ID of the CQ
+*
+*   OUTPUTS
+*
+*       uint32_t   Size of the captured response, 0 if not pushed yet
+*
+***********************************************************************/
+uint32_t Host_Iface_CQ_Get_Captured_Rsp_Size(uint8_t cq_id)
+{
+    return atomic_load_local_32(&Host_CQs.captures[cq_id].rsp_size);
+}
+
 /************************************************************************
 *
 *   FUNCTION
@@ -539,9 +714,10 @@ void Host_Iface_Processing(void)
         asm volatile("fence");
     }
 
-    /* Scan all SQs for available command */
-    for (sq_id = 0; sq_id < MM_SQ_COUNT; sq_id++)
+    /* Scan all SQs for available command, starting by the priority SQ */
+    for (uint8_t i = 0; i < MM_SQ_COUNT; i++)
     {
+        sq_id = (uint8_t)((MM_SQ_PRIORITY_IDX + i) % MM_SQ_COUNT);
         status = VQ_Data_Avail(&Host_SQs.vqueues[sq_id]);
 
         if (status == true)
@@ -354,6 +354,20 @@ static int32_t sp_command_handler(const void *cmd_buffer)
 
             break;
         }
+        case SP2MM_EVENT_OPERATING_POINT:
+        {
+            const struct sp2mm_operating_point_event_t *op_event = (const void *)hdr;
+
+            Log_Write(LOG_LEVEL_DEBUG,
+                "SP2MM:EVENT:SP_Command_Handler:OperatingPoint:%s%d%s%d%s%d%s%d%s", ":msg_id:",
+                hdr->msg_id, ":msg_size:", hdr->msg_size, ":freq:", op_event->freq, ":throttled:",
+                op_event->throttled, "\r\n");
+
+            /* SP already changed the PLL, only its new frequency is recorded */
+            STATW_Update_Minion_Freq(op_event->freq, op_event->throttled != 0U);
+
+            break;
+        }
         case SP2MM_CMD_TEARDOWN_MM:
         {
             /* struct sp2mm_teardown_mm_cmd_t *teardown_mm_cmd = (const void*) hdr */
@@ -7,9 +7,12 @@
 /*! \file sw_timer.c
     \brief A C module that implements the software timer to register the
     timeouts for commands while launching. SW_TIMER uses a PU Timer
-    chanel underneath, which triggers a callback periodically. At each
-    triger, the callback will check if some commands is to abort due to
-    timeout and will call the abort callback for the specific command.
+    chanel underneath, which triggers periodically. Each trigger is a SW
+    tick, the timeouts are kept in a two level timer wheel indexed by the
+    tick they expire at, so registering and cancelling a timeout take
+    constant time and each tick only visits the timeouts expiring in it.
+    Expired timeouts are re-armed with their period and their callbacks
+    are called in a batch, once the wheel lock is released.
 
     Public interfaces:
         SW_Timer_Init
@@ -30,27 +33,62 @@
 /* mm_rt_helpers */
 #include "error_codes.h"
 
+/*! \def SW_TIMER_WHEEL_BITS
+    \brief Log2 of the number of buckets of each wheel level
+*/
+#define SW_TIMER_WHEEL_BITS 6U
+
+/*! \def SW_TIMER_WHEEL_SIZE
+    \brief Number of buckets of each wheel level. The first level holds the
+    timeouts expiring in the next SW_TIMER_WHEEL_SIZE ticks, one tick per bucket,
+    and the second one the later ones, SW_TIMER_WHEEL_SIZE ticks per bucket.
+*/
+#define SW_TIMER_WHEEL_SIZE (1U << SW_TIMER_WHEEL_BITS)
+
+/*! \def SW_TIMER_WHEEL_MASK
+    \brief Mask of the bucket index in a wheel level
+*/
+#define SW_TIMER_WHEEL_MASK (SW_TIMER_WHEEL_SIZE - 1U)
+
+/*! \def SW_TIMER_NIL
+    \brief Index used to terminate the timeout lists and to mark free slots
+*/
+#define SW_TIMER_NIL 0xFFU
+
 /*! \struct cmd_timeout_instance_
-    \brief Holds the information to register a timeout
+    \brief Holds the information to register a timeout, linked in the
+    bucket of the tick it expires at, or in the free list.
 */
 typedef struct cmd_timeout_instance_ {
-    uint64_t expiration_time; /* Time at/after which timeout triggers */
-    uint64_t timer_period;    /* Timer load count in SW ticks */
-    void (*timeout_callback_fn)(uint8_t);
+    uint64_t expiration_tick; /* SW tick at which the timeout triggers */
+    uint32_t timer_period;    /* Timeout period in SW ticks */
+    uint8_t next;             /* Next slot in the bucket or free list */
+    uint8_t prev;             /* Previous slot in the bucket */
+    uint8_t bucket;           /* Bucket holding the slot, SW_TIMER_NIL if free */
     uint8_t callback_arg;
+    void (*timeout_callback_fn)(uint8_t);
 } cmd_timeout_t;
 
 /*! \struct sw_timer_cb_
-    \brief SW Timer Control Block structure. Used to maintain the list
-    of timeouts, PU Timer channel being used and global time elasped
-    till now
+    \brief SW Timer Control Block structure. Used to maintain the timer
+    wheel, the free timeout slots and the SW ticks elapsed till now.
 */
 typedef CACHE_STRUCT({
-    uint64_t accum_period;
+    uint64_t current_tick;
     spinlock_t resource_lock;
+    uint8_t free_head;
+    uint8_t bucket_head[2U * SW_TIMER_WHEEL_SIZE];
     cmd_timeout_t cmd_timeout_cb[SW_TIMER_MAX_SLOTS];
 }) sw_timer_cb_t;
 
+/*! \struct sw_timer_expired_
+    \brief A timeout callback to call once the wheel lock is released
+*/
+typedef struct sw_timer_expired_ {
+    void (*timeout_callback_fn)(uint8_t);
+    uint8_t callback_arg;
+} sw_timer_expired_t;
+
 /*! \var sw_timer_cb_t SW_TIMER_CB
     \brief Global SW Timer Control Block
     \warning Not thread safe!
@@ -63,22 +101,87 @@ static sw_timer_cb_t SW_TIMER_CB = {{ 0 }};
 */
 static volatile bool SW_Timer_Interrupt_Flag __attribute__((aligned(64))) = false;
 
-/*! \fn static inline int32_t get_free_slot(void)
-    \brief Returns the index of free timeout slot
-    \return Index of free slot
+/* The wheel helpers below must be called with the resource lock held */
+
+/*! \fn static inline void sw_timer_link(uint8_t slot, uint64_t current_tick)
+    \brief Links a timeout slot in the bucket of its expiration tick
+    \param slot Timeout slot to link
+    \param current_tick Last SW tick processed
 */
-static inline int32_t get_free_slot(void)
+static inline void sw_timer_link(uint8_t slot, uint64_t current_tick)
 {
-    for (int32_t sw_timer_idx = 0; sw_timer_idx < SW_TIMER_MAX_SLOTS; sw_timer_idx++)
+    cmd_timeout_t *timeout = &SW_TIMER_CB.cmd_timeout_cb[slot];
+    uint64_t expiration_tick = atomic_load_local_64(&timeout->expiration_tick);
+    uint64_t blocks = (expiration_tick >> SW_TIMER_WHEEL_BITS) -
+                      (current_tick >> SW_TIMER_WHEEL_BITS);
+    uint8_t bucket;
+    uint8_t head;
+
+    if ((expiration_tick - current_tick) < SW_TIMER_WHEEL_SIZE)
     {
-        if (atomic_load_local_64(&SW_TIMER_CB.cmd_timeout_cb[sw_timer_idx].expiration_time) ==
-            SW_TIME_FREE_SLOT_FLAG)
-        {
-            return sw_timer_idx;
-        }
+        bucket = (uint8_t)(expiration_tick & SW_TIMER_WHEEL_MASK);
+    }
+    else if (blocks < SW_TIMER_WHEEL_SIZE)
+    {
+        bucket = (uint8_t)(SW_TIMER_WHEEL_SIZE +
+                           ((expiration_tick >> SW_TIMER_WHEEL_BITS) & SW_TIMER_WHEEL_MASK));
+    }
+    else
+    {
+        /* Beyond the wheel range, park it in the last block and link it again on cascade */
+        bucket = (uint8_t)(SW_TIMER_WHEEL_SIZE +
+                           (((current_tick >> SW_TIMER_WHEEL_BITS) + SW_TIMER_WHEEL_MASK) &
+                               SW_TIMER_WHEEL_MASK));
+    }
+
+    head = atomic_load_local_8(&SW_TIMER_CB.bucket_head[bucket]);
+    atomic_store_local_8(&timeout->bucket, bucket);
+    atomic_store_local_8(&timeout->prev, SW_TIMER_NIL);
+    atomic_store_local_8(&timeout->next, head);
+    if (head != SW_TIMER_NIL)
+    {
+        atomic_store_local_8(&SW_TIMER_CB.cmd_timeout_cb[head].prev, slot);
+    }
+    atomic_store_local_8(&SW_TIMER_CB.bucket_head[bucket], slot);
+}
+
+/*! \fn static inline void sw_timer_unlink(uint8_t slot)
+    \brief Unlinks a timeout slot from its bucket
+    \param slot Timeout slot to unlink
+*/
+static inline void sw_timer_unlink(uint8_t slot)
+{
+    cmd_timeout_t *timeout = &SW_TIMER_CB.cmd_timeout_cb[slot];
+    uint8_t next = atomic_load_local_8(&timeout->next);
+    uint8_t prev = atomic_load_local_8(&timeout->prev);
+
+    if (prev != SW_TIMER_NIL)
+    {
+        atomic_store_local_8(&SW_TIMER_CB.cmd_timeout_cb[prev].next, next);
+    }
+    else
+    {
+        atomic_store_local_8(
+            &SW_TIMER_CB.bucket_head[atomic_load_local_8(&timeout->bucket)], next);
+    }
+    if (next != SW_TIMER_NIL)
+    {
+        atomic_store_local_8(&SW_TIMER_CB.cmd_timeout_cb[next].prev, prev);
     }
+}
+
+/*! \fn static inline uint8_t sw_timer_detach_bucket(uint8_t bucket)
+    \brief Empties a bucket, returning the list of the timeouts it held
+    \param bucket Bucket to empty
+    \return First timeout slot of the list
+*/
+static inline uint8_t sw_timer_detach_bucket(uint8_t bucket)
+{
+    uint8_t head = atomic_load_local_8(&SW_TIMER_CB.bucket_head[bucket]);
+
+    atomic_store_local_8(&SW_TIMER_CB.bucket_head[bucket], SW_TIMER_NIL);
 
-    return SW_TIMER_NO_FREE_TIMESLOT_AVAILABLE;
+    return head;
 }
 
 /*! \fn bool SW_Timer_Interrupt_Status(void)
@@ -98,8 +201,9 @@ _Bool SW_Timer_Interrupt_Status(void)
 *
 *   DESCRIPTION
 *
-*       Function to handle periodic PU Timer triggers
-*       and check the timeout for added timers so far.
+*       Function to handle periodic PU Timer triggers. Advances the wheel
+*       one SW tick, re-arms the timeouts expiring in it and calls their
+*       callbacks once the lock is released.
 *
 *   INPUTS
 *
@@ -112,31 +216,71 @@ _Bool SW_Timer_Interrupt_Status(void)
 ***********************************************************************/
 void SW_Timer_Processing(void)
 {
-    uint64_t accum_period;
-    void (*timeout_callback_fn)(uint8_t);
+    sw_timer_expired_t expired[SW_TIMER_MAX_SLOTS];
+    uint32_t expired_count = 0;
+    uint64_t current_tick;
+    uint8_t slot;
+    uint8_t next;
+
+    acquire_local_spinlock(&SW_TIMER_CB.resource_lock);
 
-    if (SW_Timer_Interrupt_Flag)
+    /* Another hart may have processed this tick already */
+    if (!SW_Timer_Interrupt_Flag)
     {
-        SW_Timer_Interrupt_Flag = false;
-        asm volatile("fence");
+        release_local_spinlock(&SW_TIMER_CB.resource_lock);
+        return;
     }
+    SW_Timer_Interrupt_Flag = false;
+    asm volatile("fence");
 
-    accum_period = atomic_add_local_64(&SW_TIMER_CB.accum_period, SW_TIMER_HW_COUNT_PER_SEC);
-    accum_period += SW_TIMER_HW_COUNT_PER_SEC;
+    current_tick = atomic_load_local_64(&SW_TIMER_CB.current_tick) + 1U;
+    atomic_store_local_64(&SW_TIMER_CB.current_tick, current_tick);
 
-    for (uint8_t i = 0; i < SW_TIMER_MAX_SLOTS; i++)
+    /* At the start of each block, move its second level timeouts to the first level */
+    if ((current_tick & SW_TIMER_WHEEL_MASK) == 0U)
     {
-        if (atomic_load_local_64(&SW_TIMER_CB.cmd_timeout_cb[i].expiration_time) <= accum_period)
+        slot = sw_timer_detach_bucket((uint8_t)(SW_TIMER_WHEEL_SIZE +
+                                                ((current_tick >> SW_TIMER_WHEEL_BITS) &
+                                                    SW_TIMER_WHEEL_MASK)));
+        while (slot != SW_TIMER_NIL)
         {
-            atomic_add_local_64(&SW_TIMER_CB.cmd_timeout_cb[i].expiration_time,
-                atomic_load_local_64(&SW_TIMER_CB.cmd_timeout_cb[i].timer_period));
-            timeout_callback_fn = (void *)(uint64_t)atomic_load_local_64(
-                (void *)&SW_TIMER_CB.cmd_timeout_cb[i].timeout_callback_fn);
-            if (timeout_callback_fn != 0)
-            {
-                timeout_callback_fn(
-                    atomic_load_local_8(&SW_TIMER_CB.cmd_timeout_cb[i].callback_arg));
-            }
+            next = atomic_load_local_8(&SW_TIMER_CB.cmd_timeout_cb[slot].next);
+            sw_timer_link(slot, current_tick);
+            slot = next;
+        }
+    }
+
+    slot = sw_timer_detach_bucket((uint8_t)(current_tick & SW_TIMER_WHEEL_MASK));
+    while (slot != SW_TIMER_NIL)
+    {
+        cmd_timeout_t *timeout = &SW_TIMER_CB.cmd_timeout_cb[slot];
+        uint64_t expiration_tick = atomic_load_local_64(&timeout->expiration_tick);
+
+        next = atomic_load_local_8(&timeout->next);
+        if (expiration_tick <= current_tick)
+        {
+            expired[expired_count].timeout_callback_fn = (void *)(uint64_t)atomic_load_local_64(
+                (void *)&timeout->timeout_callback_fn);
+            expired[expired_count].callback_arg = atomic_load_local_8(&timeout->callback_arg);
+            expired_count++;
+
+            /* Re-arm the timeout, it triggers periodically till cancelled */
+            uint32_t period = atomic_load_local_32(&timeout->timer_period);
+            atomic_store_local_64(
+                &timeout->expiration_tick, current_tick + ((period != 0U) ? period : 1U));
+        }
+        sw_timer_link(slot, current_tick);
+        slot = next;
+    }
+
+    release_local_spinlock(&SW_TIMER_CB.resource_lock);
+
+    /* Callbacks may register or cancel timeouts, so they are called without the lock */
+    for (uint32_t i = 0; i < expired_count; i++)
+    {
+        if (expired[i].timeout_callback_fn != 0)
+        {
+            expired[i].timeout_callback_fn(expired[i].callback_arg);
         }
     }
 }
@@ -190,13 +334,22 @@ static void SW_Timer_isr(void)
 ***********************************************************************/
 int32_t SW_Timer_Init(void)
 {
+    atomic_store_local_64(&SW_TIMER_CB.current_tick, 0U);
+
+    for (uint8_t i = 0; i < (2U * SW_TIMER_WHEEL_SIZE); i++)
+    {
+        atomic_store_local_8(&SW_TIMER_CB.bucket_head[i], SW_TIMER_NIL);
+    }
+
+    /* Chain all the timeout slots in the free list */
     for (uint8_t i = 0; i < SW_TIMER_MAX_SLOTS; i++)
     {
         atomic_store_local_64((void *)&SW_TIMER_CB.cmd_timeout_cb[i].timeout_callback_fn, 0U);
-        /* Use max uint64_t value as flag to mark this slot of time as free */
-        atomic_store_local_64(
-            &SW_TIMER_CB.cmd_timeout_cb[i].expiration_time, SW_TIME_FREE_SLOT_FLAG);
+        atomic_store_local_8(&SW_TIMER_CB.cmd_timeout_cb[i].bucket, SW_TIMER_NIL);
+        atomic_store_local_8(&SW_TIMER_CB.cmd_timeout_cb[i].next,
+            (i < (SW_TIMER_MAX_SLOTS - 1)) ? (uint8_t)(i + 1U) : SW_TIMER_NIL);
     }
+    atomic_store_local_8(&SW_TIMER_CB.free_head, 0U);
 
     /* Init the HW timer */
     PU_Timer_Init(SW_Timer_isr, SW_TIMER_HW_COUNT_PER_SEC);
@@ -229,26 +382,27 @@ int32_t SW_Timer_Init(void)
 int32_t SW_Timer_Create_Timeout(
     void (*timeout_callback_fn)(uint8_t), uint8_t callback_arg, uint32_t sw_ticks)
 {
-    int32_t free_timer_slot;
+    int32_t free_timer_slot = SW_TIMER_NO_FREE_TIMESLOT_AVAILABLE;
+    uint8_t slot;
 
     /* Acquire the lock */
     acquire_local_spinlock(&SW_TIMER_CB.resource_lock);
 
-    free_timer_slot = get_free_slot();
-    if (free_timer_slot >= 0)
+    slot = atomic_load_local_8(&SW_TIMER_CB.free_head);
+    if (slot != SW_TIMER_NIL)
     {
+        cmd_timeout_t *timeout = &SW_TIMER_CB.cmd_timeout_cb[slot];
+        uint64_t current_tick = atomic_load_local_64(&SW_TIMER_CB.current_tick);
+
+        atomic_store_local_8(&SW_TIMER_CB.free_head, atomic_load_local_8(&timeout->next));
         atomic_store_local_64(
-            (void *)&SW_TIMER_CB.cmd_timeout_cb[free_timer_slot].timeout_callback_fn,
-            (uint64_t)timeout_callback_fn);
-        atomic_store_local_8(
-            &SW_TIMER_CB.cmd_timeout_cb[free_timer_slot].callback_arg, callback_arg);
-        /* Save the Timer load count in SW ticks */
-        atomic_store_local_64(&SW_TIMER_CB.cmd_timeout_cb[free_timer_slot].timer_period,
-            SW_TIMER_SW_TICKS_TO_HW_COUNT(sw_ticks));
-        /* Store expiration_time = sw_ticks + accum_period + elapsed_time */
-        atomic_store_local_64(&SW_TIMER_CB.cmd_timeout_cb[free_timer_slot].expiration_time,
-            SW_TIMER_SW_TICKS_TO_HW_COUNT(sw_ticks) +
-                atomic_load_local_64(&SW_TIMER_CB.accum_period) + SW_Timer_Get_Elapsed_Time());
+            (void *)&timeout->timeout_callback_fn, (uint64_t)timeout_callback_fn);
+        atomic_store_local_8(&timeout->callback_arg, callback_arg);
+        atomic_store_local_32(&timeout->timer_period, sw_ticks);
+        /* Part of the current tick already elapsed, so it expires at the end of the last tick */
+        atomic_store_local_64(&timeout->expiration_tick, current_tick + sw_ticks + 1U);
+        sw_timer_link(slot, current_tick);
+        free_timer_slot = slot;
     }
 
     /* Release the lock */
@@ -278,13 +432,23 @@ int32_t SW_Timer_Create_Timeout(
 ***********************************************************************/
 void SW_Timer_Cancel_Timeout(uint8_t sw_timer_idx)
 {
-    /* Use max uint64_t value as flag to mark this slot of timer as free */
-    atomic_store_local_64(
-        &SW_TIMER_CB.cmd_timeout_cb[sw_timer_idx].expiration_time, SW_TIME_FREE_SLOT_FLAG);
+    cmd_timeout_t *timeout = &SW_TIMER_CB.cmd_timeout_cb[sw_timer_idx];
 
-    /* Clear the callback */
-    atomic_store_local_64(
-        (void *)&SW_TIMER_CB.cmd_timeout_cb[sw_timer_idx].timeout_callback_fn, 0U);
+    acquire_local_spinlock(&SW_TIMER_CB.resource_lock);
+
+    /* Already cancelled slots are left as they are */
+    if (atomic_load_local_8(&timeout->bucket) != SW_TIMER_NIL)
+    {
+        sw_timer_unlink(sw_timer_idx);
+
+        /* Clear the callback and give back the slot */
+        atomic_store_local_64((void *)&timeout->timeout_callback_fn, 0U);
+        atomic_store_local_8(&timeout->bucket, SW_TIMER_NIL);
+        atomic_store_local_8(&timeout->next, atomic_load_local_8(&SW_TIMER_CB.free_head));
+        atomic_store_local_8(&SW_TIMER_CB.free_head, sw_timer_idx);
+    }
+
+    release_local_spinlock(&SW_TIMER_CB.resource_lock);
 }
 
 /************************************************************************
@@ -16,6 +16,8 @@
         Trace_Configure_CM_RT
         Trace_RT_Control_MM
         Trace_Evict_Buffer_MM
+        Trace_Drain_Buffer_MM
+        Trace_Drain_Started_MM
         Trace_RT_Control_MM_Stats
 
 */
@@ -39,6 +41,7 @@
 #include "workers/cw.h"
 #include "services/host_cmd_hdlr.h"
 #include "services/host_iface.h"
+#include "workers/dmaw.h"
 
 /* mm_rt_helpers */
 #include "common_utils.h"
@@ -97,9 +100,42 @@ static inline void et_trace_write_float(void *addr, float value)
 */
 #define MM_DEFAULT_THREAD_MASK                                                                     \
     ((1UL << (DISPATCHER_BASE_HART_ID - MM_BASE_ID)) | (1UL << (DMAW_BASE_HART_ID - MM_BASE_ID)) | \
-        (1UL << (DMAW_BASE_HART_ID + HARTS_PER_MINION - MM_BASE_ID)) |                             \
+        (1UL << (DMAW_BASE_HART_ID + (DMAW_NUM_PER_DIRECTION * HARTS_PER_MINION) - MM_BASE_ID)) | \
         (1UL << (SQW_BASE_HART_ID - MM_BASE_ID)) | (1UL << (KW_BASE_HART_ID - MM_BASE_ID)))
 
+/*! \def MM_TRACE_SUB_BUFFER_COUNT
+    \brief The MM Trace buffer is split in two sub-buffers. Trace is logged into one of them while
+        the host drains the other one.
+*/
+#define MM_TRACE_SUB_BUFFER_COUNT 2U
+
+/*! \def MM_TRACE_SUB_BUFFER_SIZE
+    \brief Size of each MM Trace sub-buffer. Each one starts with its own standard header, so it
+        can be decoded on its own.
+*/
+#define MM_TRACE_SUB_BUFFER_SIZE (MM_TRACE_BUFFER_SIZE / MM_TRACE_SUB_BUFFER_COUNT)
+
+/*! \def MM_TRACE_SWAP_THRESHOLD
+    \brief Max threshold of the MM Trace sub-buffers. The room left after it holds the entries
+        reserved by other harts till the sub-buffers are swapped.
+*/
+#define MM_TRACE_SWAP_THRESHOLD (MM_TRACE_SUB_BUFFER_SIZE - SIZE_4KB)
+
+/*! \def MM_TRACE_SUB_BUFFER_BASE
+    \brief Base address of a MM Trace sub-buffer.
+*/
+#define MM_TRACE_SUB_BUFFER_BASE(idx) \
+    (MM_TRACE_BUFFER_BASE + ((uint64_t)(idx) * MM_TRACE_SUB_BUFFER_SIZE))
+
+/*! \enum mm_trace_drain_state_e
+    \brief State of the MM Trace sub-buffer which is not being logged.
+*/
+typedef enum {
+    MM_TRACE_DRAIN_NONE = 0,      /**< Free to be swapped in */
+    MM_TRACE_DRAIN_PENDING = 1,   /**< Full, the host was notified to drain it */
+    MM_TRACE_DRAIN_IN_FLIGHT = 2, /**< Being read by the host DMA */
+} mm_trace_drain_state_e;
+
 /*
  * Master Minion Trace control block.
  */
@@ -110,6 +146,11 @@ typedef CACHE_STRUCT({
     spinlock_t mm_trace_cb_lock;     /**!< Lock to serialize operations on MM trace CB */
     spinlock_t
         trace_internal_cb_lock; /**!< Lock to serialize operation on CB internal fields other than MM CB (it has its own lock). */
+    uint32_t drain_size;        /**!< Data size of the sub-buffer to drain. */
+    uint16_t drain_tag_id;      /**!< Tag ID of the host command draining the sub-buffer. */
+    uint8_t drain_chan;         /**!< DMA write channel draining the sub-buffer. */
+    uint8_t drain_state;        /**!< One of mm_trace_drain_state_e. */
+    uint8_t active_sub_buffer;  /**!< Sub-buffer Trace is logged into. */
 })  mm_trace_control_block_t;
 
 /* A local Trace control block for all Master Minions. */
@@ -149,21 +190,139 @@ void et_trace_mm_stats_cb_lock_release(void)
     release_local_spinlock(&MM_Stats_Trace_CB.mm_trace_cb_lock);
 }
 
+/************************************************************************
+*
+*   FUNCTION
+*
+*       mm_trace_init_sub_buffer_header
+*
+*   DESCRIPTION
+*
+*       Helper function to initialize the standard header of a MM Trace
+*       sub-buffer with no data.
+*
+*   INPUTS
+*
+*       idx    Index of the sub-buffer
+*
+*   OUTPUTS
+*
+*       None
+*
+***********************************************************************/
+static inline void mm_trace_init_sub_buffer_header(uint32_t idx)
+{
+    struct trace_buffer_std_header_t *trace_header =
+        (struct trace_buffer_std_header_t *)MM_TRACE_SUB_BUFFER_BASE(idx);
+
+    trace_header->magic_header = TRACE_MAGIC_HEADER;
+    trace_header->type = TRACE_MM_BUFFER;
+    trace_header->data_size = sizeof(struct trace_buffer_std_header_t);
+    trace_header->sub_buffer_size = MM_TRACE_SUB_BUFFER_SIZE;
+    trace_header->sub_buffer_count = 1;
+    trace_header->version.major = TRACE_VERSION_MAJOR;
+    trace_header->version.minor = TRACE_VERSION_MINOR;
+    trace_header->version.patch = TRACE_VERSION_PATCH;
+
+    ETSOC_MEM_EVICT((void *)trace_header, sizeof(struct trace_buffer_std_header_t), to_L3)
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       mm_trace_swap_sub_buffers
+*
+*   DESCRIPTION
+*
+*       Helper function to continue logging into the other MM Trace
+*       sub-buffer, leaving the current one to be drained by the host.
+*       The swap is not done while the other sub-buffer was not drained,
+*       then the current one wraps as a single buffer does.
+*       NOTE: The sub-buffer is only evicted when the host drains it, so
+*       the entries reserved in it before the swap are complete by then.
+*
+*   INPUTS
+*
+*       None
+*
+*   OUTPUTS
+*
+*       uint32_t    Data size of the sub-buffer to drain, 0 if not swapped.
+*
+***********************************************************************/
+static inline uint32_t mm_trace_swap_sub_buffers(void)
+{
+    uint32_t drain_size = 0;
+
+    et_trace_mm_cb_lock_acquire();
+
+    uint8_t drain_state = atomic_load_local_8(&MM_Trace_CB.drain_state);
+
+    /* The drained sub-buffer can be reused once the host DMA is done with it */
+    if ((drain_state == MM_TRACE_DRAIN_IN_FLIGHT) &&
+        DMAW_Write_Is_Transfer_Done(
+            (dma_write_chan_id_e)atomic_load_local_8(&MM_Trace_CB.drain_chan),
+            atomic_load_local_16(&MM_Trace_CB.drain_tag_id)))
+    {
+        drain_state = MM_TRACE_DRAIN_NONE;
+    }
+
+    if (drain_state == MM_TRACE_DRAIN_NONE)
+    {
+        uint8_t active = atomic_load_local_8(&MM_Trace_CB.active_sub_buffer);
+        uint8_t next = (uint8_t)((active + 1U) % MM_TRACE_SUB_BUFFER_COUNT);
+        struct trace_buffer_std_header_t *trace_header =
+            (struct trace_buffer_std_header_t *)MM_TRACE_SUB_BUFFER_BASE(active);
+        struct trace_buffer_std_header_t *next_header =
+            (struct trace_buffer_std_header_t *)MM_TRACE_SUB_BUFFER_BASE(next);
+
+        drain_size = atomic_load_local_32(&MM_Trace_CB.cb.offset_per_hart);
+
+        /* Close the current sub-buffer and start logging into the next one */
+        atomic_store_local_32(&trace_header->data_size, drain_size);
+        atomic_store_local_32(&next_header->data_size, sizeof(struct trace_buffer_std_header_t));
+        atomic_store_local_64(&MM_Trace_CB.cb.base_per_hart, MM_TRACE_SUB_BUFFER_BASE(next));
+        atomic_store_local_32(
+            &MM_Trace_CB.cb.offset_per_hart, sizeof(struct trace_buffer_std_header_t));
+        atomic_store_local_8(&MM_Trace_CB.cb.threshold_notified, 0);
+
+        atomic_store_local_8(&MM_Trace_CB.active_sub_buffer, next);
+        atomic_store_local_32(&MM_Trace_CB.drain_size, drain_size);
+        atomic_store_local_8(&MM_Trace_CB.drain_state, MM_TRACE_DRAIN_PENDING);
+    }
+    else
+    {
+        atomic_store_local_8(&MM_Trace_CB.drain_state, drain_state);
+    }
+
+    et_trace_mm_cb_lock_release();
+
+    return drain_size;
+}
+
 static inline void et_trace_threshold_notify(const struct trace_control_block_t *cb)
 {
     struct device_ops_trace_buffer_full_event_t event;
-    const struct trace_buffer_std_header_t *trace_header =
-        (const struct trace_buffer_std_header_t *)(uintptr_t)ET_TRACE_READ_U64(cb->base_per_hart);
-
-    /* Fill the event */
-    event.event_info.event_hdr.tag_id = 0xffff; /* Async Event Tag ID. */
-    event.event_info.event_hdr.size = sizeof(event) - sizeof(struct cmn_header_t);
-    event.event_info.event_hdr.msg_id = DEV_OPS_API_MID_DEVICE_OPS_TRACE_BUFFER_FULL_EVENT;
-    event.buffer_type = (uint8_t)ET_TRACE_READ_U16(trace_header->type);
-    event.data_size = ET_TRACE_READ_U32(cb->threshold);
-
-    /* Push the event to CQ - ignore error in case of failure */
-    Host_Iface_CQ_Push_Cmd(0, &event, sizeof(event));
+    uint32_t drain_size;
+
+    (void)cb;
+
+    /* Swap the sub-buffers, nothing to notify if the host didn't drain the previous one yet */
+    drain_size = mm_trace_swap_sub_buffers();
+
+    if (drain_size > 0)
+    {
+        /* Fill the event */
+        event.event_info.event_hdr.tag_id = 0xffff; /* Async Event Tag ID. */
+        event.event_info.event_hdr.size = sizeof(event) - sizeof(struct cmn_header_t);
+        event.event_info.event_hdr.msg_id = DEV_OPS_API_MID_DEVICE_OPS_TRACE_BUFFER_FULL_EVENT;
+        event.buffer_type = TRACE_MM_BUFFER;
+        event.data_size = drain_size;
+
+        /* Push the event to CQ - ignore error in case of failure */
+        Host_Iface_CQ_Push_Cmd(0, &event, sizeof(event));
+    }
 }
 
 /************************************************************************
@@ -200,7 +359,7 @@ int32_t Trace_Init_MM(const struct trace_init_info_t *mm_init_info)
         hart_init_info.event_mask = TRACE_EVENT_STRING;
         /* Set Trace default log level to Debug. This log level is independent from Log component. */
         hart_init_info.filter_mask = TRACE_EVENT_STRING_DEBUG;
-        hart_init_info.threshold = MM_TRACE_BUFFER_SIZE;
+        hart_init_info.threshold = MM_TRACE_SWAP_THRESHOLD;
     }
     /* Check if shire mask is of Master Minion and atleast one thread is enabled. */
     else if (!(mm_init_info->shire_mask & MM_SHIRE_MASK))
@@ -224,7 +383,13 @@ int32_t Trace_Init_MM(const struct trace_init_info_t *mm_init_info)
         hart_init_info.thread_mask = MM_HART_MASK;
         hart_init_info.filter_mask = mm_init_info->filter_mask;
         hart_init_info.event_mask = mm_init_info->event_mask;
+        /* The sub-buffers are swapped at the threshold, it must leave room for the swap */
         hart_init_info.threshold = mm_init_info->threshold;
+
+        if ((hart_init_info.threshold == 0) || (hart_init_info.threshold > MM_TRACE_SWAP_THRESHOLD))
+        {
+            hart_init_info.threshold = MM_TRACE_SWAP_THRESHOLD;
+        }
     }
 
     if (status == STATUS_SUCCESS)
@@ -233,9 +398,12 @@ int32_t Trace_Init_MM(const struct trace_init_info_t *mm_init_info)
         init_local_spinlock(&MM_Trace_CB.mm_trace_cb_lock, 0);
         init_local_spinlock(&MM_Trace_CB.trace_internal_cb_lock, 0);
 
-        /* Common buffer for all MM Harts. */
-        MM_Trace_CB.cb.size_per_hart = MM_TRACE_BUFFER_SIZE;
-        MM_Trace_CB.cb.base_per_hart = MM_TRACE_BUFFER_BASE;
+        /* Common sub-buffer for all MM Harts, starting with the first one. */
+        MM_Trace_CB.cb.size_per_hart = MM_TRACE_SUB_BUFFER_SIZE;
+        MM_Trace_CB.cb.base_per_hart = MM_TRACE_SUB_BUFFER_BASE(0);
+        MM_Trace_CB.active_sub_buffer = 0;
+        MM_Trace_CB.drain_state = MM_TRACE_DRAIN_NONE;
+        MM_Trace_CB.drain_size = 0;
 
         /* Register locks for MM trace */
         MM_Trace_CB.cb.buffer_lock_acquire = et_trace_mm_cb_lock_acquire;
@@ -252,22 +420,12 @@ int32_t Trace_Init_MM(const struct trace_init_info_t *mm_init_info)
             status = TRACE_ERROR_MM_TRACE_CONFIG_FAILED;
         }
 
-        /* Initialize trace buffer header. */
-        struct trace_buffer_std_header_t *trace_header =
-            (struct trace_buffer_std_header_t *)MM_TRACE_BUFFER_BASE;
-
-        /* Update trace buffer header for buffer layout version and partitioning information.
-           One common buffer is used by all Harts to log Tracing. */
-        trace_header->magic_header = TRACE_MAGIC_HEADER;
-        trace_header->type = TRACE_MM_BUFFER;
-        trace_header->data_size = sizeof(struct trace_buffer_std_header_t);
-        trace_header->sub_buffer_size = MM_TRACE_BUFFER_SIZE;
-        trace_header->sub_buffer_count = 1;
-        trace_header->version.major = TRACE_VERSION_MAJOR;
-        trace_header->version.minor = TRACE_VERSION_MINOR;
-        trace_header->version.patch = TRACE_VERSION_PATCH;
-
-        ETSOC_MEM_EVICT((void *)trace_header, sizeof(struct trace_buffer_std_header_t), to_L3)
+        /* Initialize the header of each sub-buffer for buffer layout version and partitioning
+           information. One common sub-buffer at a time is used by all Harts to log Tracing. */
+        for (uint32_t idx = 0; idx < MM_TRACE_SUB_BUFFER_COUNT; idx++)
+        {
+            mm_trace_init_sub_buffer_header(idx);
+        }
     }
 
     /* Evict an updated control block to L2 memory. */
@@ -304,10 +462,18 @@ int32_t Trace_Configure_MM(const struct trace_config_info_t *mm_config_info)
     /* Check if init information pointer is NULL. */
     if (mm_config_info != NULL)
     {
+        struct trace_config_info_t config_info = *mm_config_info;
+
+        /* The sub-buffers are swapped at the threshold, it must leave room for the swap */
+        if ((config_info.threshold == 0) || (config_info.threshold > MM_TRACE_SWAP_THRESHOLD))
+        {
+            config_info.threshold = MM_TRACE_SWAP_THRESHOLD;
+        }
+
         /* Acquire the lock */
         et_trace_mm_cb_lock_acquire();
 
-        status = Trace_Config(mm_config_info, &MM_Trace_CB.cb);
+        status = Trace_Config(&config_info, &MM_Trace_CB.cb);
 
         /* Release the lock */
         et_trace_mm_cb_lock_release();
@@ -468,6 +634,13 @@ void Trace_RT_Control_MM(uint32_t control)
     {
         atomic_store_local_32(
             &(MM_Trace_CB.cb.offset_per_hart), sizeof(struct trace_buffer_std_header_t));
+        atomic_store_local_8(&(MM_Trace_CB.cb.threshold_notified), 0);
+
+        /* The sub-buffer waiting to be drained is dropped too, unless the host is reading it */
+        if (atomic_load_local_8(&MM_Trace_CB.drain_state) == MM_TRACE_DRAIN_PENDING)
+        {
+            atomic_store_local_8(&MM_Trace_CB.drain_state, MM_TRACE_DRAIN_NONE);
+        }
     }
 
     /* Check flag to Enable/Disable Trace. */
@@ -504,8 +677,9 @@ void Trace_RT_Control_MM(uint32_t control)
 *
 *   DESCRIPTION
 *
-*       This function Evict the MM Trace buffer upto current used buffer,
-*       it also updates the trace buffer header to include buffer usage.
+*       This function Evict the MM Trace sub-buffers upto current used
+*       buffer, it also updates the trace buffer header of the sub-buffer
+*       being logged to include buffer usage.
 *
 *   INPUTS
 *
@@ -513,26 +687,130 @@ void Trace_RT_Control_MM(uint32_t control)
 *
 *   OUTPUTS
 *
-*       uint32_t    Size of buffer that was used and evicted.
+*       uint32_t    Size of the logged sub-buffer that was used and evicted.
 *
 ***********************************************************************/
 uint32_t Trace_Evict_Buffer_MM(void)
 {
-    struct trace_buffer_std_header_t *trace_header =
-        (struct trace_buffer_std_header_t *)MM_TRACE_BUFFER_BASE;
+    const struct trace_buffer_std_header_t *sub_header;
     et_trace_mm_cb_lock_acquire();
+    uint8_t active = atomic_load_local_8(&MM_Trace_CB.active_sub_buffer);
     uint32_t offset = atomic_load_local_32(&(MM_Trace_CB.cb.offset_per_hart));
 
     /* Store used buffer size in buffer header. */
-    atomic_store_local_32(&trace_header->data_size, offset);
+    atomic_store_local_32(
+        &((struct trace_buffer_std_header_t *)MM_TRACE_SUB_BUFFER_BASE(active))->data_size,
+        offset);
 
-    ETSOC_MEM_EVICT((uint64_t *)MM_TRACE_BUFFER_BASE, offset, to_L3)
+    for (uint32_t idx = 0; idx < MM_TRACE_SUB_BUFFER_COUNT; idx++)
+    {
+        sub_header = (const struct trace_buffer_std_header_t *)MM_TRACE_SUB_BUFFER_BASE(idx);
+        ETSOC_MEM_EVICT((uint64_t *)MM_TRACE_SUB_BUFFER_BASE(idx),
+            atomic_load_local_32(&sub_header->data_size), to_L3)
+    }
 
     et_trace_mm_cb_lock_release();
 
     return offset;
 }
 
+/************************************************************************
+*
+*   FUNCTION
+*
+*       Trace_Drain_Buffer_MM
+*
+*   DESCRIPTION
+*
+*       This function returns the MM Trace sub-buffer to send to the host:
+*       the one waiting to be drained if any, else the one being logged.
+*       It evicts the sub-buffer upto its used size.
+*
+*   INPUTS
+*
+*       size        Returns the used size of the sub-buffer.
+*
+*   OUTPUTS
+*
+*       uint64_t    Base address of the sub-buffer.
+*
+***********************************************************************/
+uint64_t Trace_Drain_Buffer_MM(uint32_t *size)
+{
+    struct trace_buffer_std_header_t *trace_header;
+    uint32_t data_size;
+    uint8_t idx;
+
+    et_trace_mm_cb_lock_acquire();
+
+    idx = atomic_load_local_8(&MM_Trace_CB.active_sub_buffer);
+
+    if (atomic_load_local_8(&MM_Trace_CB.drain_state) == MM_TRACE_DRAIN_PENDING)
+    {
+        /* The full sub-buffer is the other one, its header was updated when swapped */
+        idx = (uint8_t)((idx + 1U) % MM_TRACE_SUB_BUFFER_COUNT);
+        data_size = atomic_load_local_32(&MM_Trace_CB.drain_size);
+    }
+    else
+    {
+        trace_header = (struct trace_buffer_std_header_t *)MM_TRACE_SUB_BUFFER_BASE(idx);
+        data_size = atomic_load_local_32(&(MM_Trace_CB.cb.offset_per_hart));
+
+        /* Store used buffer size in buffer header. */
+        atomic_store_local_32(&trace_header->data_size, data_size);
+    }
+
+    ETSOC_MEM_EVICT((uint64_t *)MM_TRACE_SUB_BUFFER_BASE(idx), data_size, to_L3)
+
+    et_trace_mm_cb_lock_release();
+
+    *size = data_size;
+
+    return MM_TRACE_SUB_BUFFER_BASE(idx);
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       Trace_Drain_Started_MM
+*
+*   DESCRIPTION
+*
+*       This function records the host DMA transfer reading the MM Trace
+*       sub-buffer returned by Trace_Drain_Buffer_MM(). If it is the one
+*       waiting to be drained, it is not swapped in till the transfer is
+*       done.
+*
+*   INPUTS
+*
+*       base        Base address of the sub-buffer being read
+*       chan        DMA write channel of the transfer
+*       tag_id      Tag ID of the host command
+*
+*   OUTPUTS
+*
+*       None
+*
+***********************************************************************/
+void Trace_Drain_Started_MM(uint64_t base, uint8_t chan, uint16_t tag_id)
+{
+    et_trace_mm_cb_lock_acquire();
+
+    uint8_t idx = (uint8_t)((atomic_load_local_8(&MM_Trace_CB.active_sub_buffer) + 1U) %
+                            MM_TRACE_SUB_BUFFER_COUNT);
+
+    if ((atomic_load_local_8(&MM_Trace_CB.drain_state) == MM_TRACE_DRAIN_PENDING) &&
+        (base == MM_TRACE_SUB_BUFFER_BASE(idx)))
+    {
+        atomic_store_local_8(&MM_Trace_CB.drain_chan, chan);
+        atomic_store_local_16(&MM_Trace_CB.drain_tag_id, tag_id);
+        atomic_store_local_8(&MM_Trace_CB.drain_state, MM_TRACE_DRAIN_IN_FLIGHT);
+    }
+
+    et_trace_mm_cb_lock_release();
+}
+
 /************************************************************************
 *
 *   FUNCTION
@@ -20,6 +20,8 @@
         CW_Update_Shire_State
         CW_Check_Shires_Available_And_Ready
         CW_Get_Physically_Enabled_Shires
+        CW_Get_Booted_Shires
+        CW_Get_Busy_Shires
 */
 /***********************************************************************/
 /* mm_rt_svcs */
@@ -407,6 +409,30 @@ uint64_t CW_Get_Booted_Shires(void)
     return atomic_load_local_64(&CW_CB.booted_shires_mask);
 }
 
+/************************************************************************
+*
+*   FUNCTION
+*
+*       CW_Get_Busy_Shires
+*
+*   DESCRIPTION
+*
+*       Get the shires reserved by kernels
+*
+*   INPUTS
+*
+*       None
+*
+*   OUTPUTS
+*
+*       uint64_t    Returns busy shires mask
+*
+***********************************************************************/
+uint64_t CW_Get_Busy_Shires(void)
+{
+    return atomic_load_local_64(&CW_CB.shire_state);
+}
+
 /************************************************************************
 *
 *   FUNCTION
@@ -24,8 +24,13 @@
         DMAW_Init
         DMAW_Read_Find_Idle_Chan_And_Reserve
         DMAW_Write_Find_Idle_Chan_And_Reserve
+        DMAW_Write_Is_Transfer_Done
+        DMAW_Read_Reserve_Stripe_Chans
+        DMAW_Write_Reserve_Stripe_Chans
         DMAW_Read_Trigger_Transfer
         DMAW_Write_Trigger_Transfer
+        DMAW_Read_Trigger_Chain
+        DMAW_Write_Trigger_Chain
         DMAW_Launch
         DMAW_Read_Get_Average_Exec_Cycles
         DMAW_Write_Get_Average_Exec_Cycles
@@ -79,6 +84,14 @@ static dmaw_read_cb_t DMAW_Read_CB = { 0 };
 */
 static dmaw_write_cb_t DMAW_Write_CB = { 0 };
 
+/*! \struct dmaw_stripe_cursor_t
+    \brief Position in a DMA list while it is split in stripes.
+*/
+typedef struct {
+    uint8_t node;    /* Node of the list the next piece starts at */
+    uint32_t offset; /* Bytes of that node already assigned to previous stripes */
+} dmaw_stripe_cursor_t;
+
 /*! \def DMAW_BYTES_PER_CYCLE_TO_MBPS
     \brief A helper macro to convert DMA bandwidth to MB/Sec using following formulae
            Total DMA BW = (Total Transfer size (in bytes) * Minion Freq in Mhz) / DMA duration cycles
@@ -86,6 +99,18 @@ static dmaw_write_cb_t DMAW_Write_CB = { 0 };
 #define DMAW_BYTES_PER_CYCLE_TO_MBPS(bytes, cycles) \
     ((bytes * STATW_Get_Minion_Freq()) / (cycles ? cycles : 1))
 
+/* Ensure that each DMA worker polls one channel at least */
+static_assert((DMAW_NUM_PER_DIRECTION <= PCIE_DMA_RD_CHANNEL_COUNT) &&
+                  (DMAW_NUM_PER_DIRECTION <= PCIE_DMA_WRT_CHANNEL_COUNT),
+    "Number of DMA Workers per direction not within limits.");
+
+/* DMA chain responses are sent as DMA list responses */
+static_assert((sizeof(struct device_ops_dma_chain_rsp_t) ==
+                  sizeof(struct device_ops_dma_writelist_rsp_t)) &&
+                  (sizeof(struct device_ops_dma_chain_rsp_t) ==
+                      sizeof(struct device_ops_dma_readlist_rsp_t)),
+    "DMA chain response layout not matching the DMA list responses.");
+
 /************************************************************************
 *
 *   FUNCTION
@@ -165,12 +190,16 @@ int32_t DMAW_Read_Find_Idle_Chan_And_Reserve(dma_read_chan_id_e *chan_id, uint8_
     int32_t status = STATUS_SUCCESS;
     bool read_chan_reserved = false;
     sqw_state_e sqw_state;
+    /* The last channels are reserved for the priority SQ */
+    const uint8_t chan_count = (sqw_idx == MM_SQ_PRIORITY_IDX) ?
+                                   PCIE_DMA_RD_CHANNEL_COUNT :
+                                   (PCIE_DMA_RD_CHANNEL_COUNT - MM_SQ_PRIORITY_DMA_CHANNELS);
 
     /* Try to find idle channel until aborted */
     do
     {
         /* Find the idle channel and reserve it */
-        for (uint8_t ch = 0; ch < PCIE_DMA_RD_CHANNEL_COUNT; ch++)
+        for (uint8_t ch = 0; ch < chan_count; ch++)
         {
             /* Compare for idle state and reserve */
             if (atomic_compare_and_exchange_local_32(
@@ -231,12 +260,16 @@ int32_t DMAW_Write_Find_Idle_Chan_And_Reserve(dma_write_chan_id_e *chan_id, uint
     int32_t status = STATUS_SUCCESS;
     bool write_chan_reserved = false;
     sqw_state_e sqw_state;
+    /* The last channels are reserved for the priority SQ */
+    const uint8_t chan_count = (sqw_idx == MM_SQ_PRIORITY_IDX) ?
+                                   PCIE_DMA_WRT_CHANNEL_COUNT :
+                                   (PCIE_DMA_WRT_CHANNEL_COUNT - MM_SQ_PRIORITY_DMA_CHANNELS);
 
     /* Try to find idle channel until aborted */
     do
     {
         /* Find the idle channel and reserve it */
-        for (uint8_t ch = 0; ch < PCIE_DMA_WRT_CHANNEL_COUNT; ch++)
+        for (uint8_t ch = 0; ch < chan_count; ch++)
         {
             /* Compare for idle state and reserve */
             if (atomic_compare_and_exchange_local_32(
@@ -270,6 +303,483 @@ int32_t DMAW_Write_Find_Idle_Chan_And_Reserve(dma_write_chan_id_e *chan_id, uint
     return status;
 }
 
+/************************************************************************
+*
+*   FUNCTION
+*
+*       DMAW_Write_Is_Transfer_Done
+*
+*   DESCRIPTION
+*
+*       This function checks if the transfer of a command is no longer
+*       using the given DMA write channel.
+*
+*   INPUTS
+*
+*       chan_id    DMA channel ID the command was started on
+*       tag_id     Tag ID of the command
+*
+*   OUTPUTS
+*
+*       bool       True if the channel is not busy with the command
+*
+***********************************************************************/
+bool DMAW_Write_Is_Transfer_Done(dma_write_chan_id_e chan_id, uint16_t tag_id)
+{
+    dma_channel_status_t chan_status;
+
+    chan_status.raw_u64 =
+        atomic_load_local_64(&DMAW_Write_CB.chan_status_cb[chan_id].status.raw_u64);
+
+    return (chan_status.tag_id != tag_id) || (chan_status.channel_state == DMA_CHAN_STATE_IDLE);
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       dmaw_get_xfer_node
+*
+*   DESCRIPTION
+*
+*       Helper function to get the addresses and the size of a transfer node
+*       of any DMA list command.
+*
+*   INPUTS
+*
+*       cmd_info        Pointer to command buffer
+*       xfer_index      Index of the transfer node
+*       src_addr        Pointer to the source address of the node
+*       dst_addr        Pointer to the destination address of the node
+*       size            Pointer to the size of the node
+*
+*   OUTPUTS
+*
+*       None
+*
+***********************************************************************/
+static inline void dmaw_get_xfer_node(const struct cmd_header_t *cmd_info, uint8_t xfer_index,
+    uint64_t *src_addr, uint64_t *dst_addr, uint32_t *size)
+{
+    switch (cmd_info->cmd_hdr.msg_id)
+    {
+        case DEV_OPS_API_MID_DEVICE_OPS_DMA_WRITELIST_CMD:
+        {
+            const struct device_ops_dma_writelist_cmd_t *dmalist_cmd =
+                (const struct device_ops_dma_writelist_cmd_t *)cmd_info;
+
+            *src_addr = dmalist_cmd->list[xfer_index].src_host_phy_addr;
+            *dst_addr = dmalist_cmd->list[xfer_index].dst_device_phy_addr;
+            *size = dmalist_cmd->list[xfer_index].size;
+            break;
+        }
+        case DEV_OPS_API_MID_DEVICE_OPS_P2PDMA_WRITELIST_CMD:
+        {
+            const struct device_ops_p2pdma_writelist_cmd_t *p2p_dmalist_cmd =
+                (const struct device_ops_p2pdma_writelist_cmd_t *)cmd_info;
+
+            *src_addr = p2p_dmalist_cmd->list[xfer_index].src_device_bus_addr;
+            *dst_addr = p2p_dmalist_cmd->list[xfer_index].dst_device_phy_addr;
+            *size = p2p_dmalist_cmd->list[xfer_index].size;
+            break;
+        }
+        case DEV_OPS_API_MID_DEVICE_OPS_DMA_READLIST_CMD:
+        {
+            const struct device_ops_dma_readlist_cmd_t *dmalist_cmd =
+                (const struct device_ops_dma_readlist_cmd_t *)cmd_info;
+
+            *src_addr = dmalist_cmd->list[xfer_index].src_device_phy_addr;
+            *dst_addr = dmalist_cmd->list[xfer_index].dst_host_phy_addr;
+            *size = dmalist_cmd->list[xfer_index].size;
+            break;
+        }
+        default:
+        {
+            const struct device_ops_p2pdma_readlist_cmd_t *p2p_dmalist_cmd =
+                (const struct device_ops_p2pdma_readlist_cmd_t *)cmd_info;
+
+            *src_addr = p2p_dmalist_cmd->list[xfer_index].src_device_phy_addr;
+            *dst_addr = p2p_dmalist_cmd->list[xfer_index].dst_device_bus_addr;
+            *size = p2p_dmalist_cmd->list[xfer_index].size;
+            break;
+        }
+    }
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       dmaw_get_transfer_size
+*
+*   DESCRIPTION
+*
+*       Helper function to get the total number of bytes of a DMA list.
+*
+*   INPUTS
+*
+*       cmd_info        Pointer to command buffer
+*       xfer_count      Number of transfer nodes in command.
+*
+*   OUTPUTS
+*
+*       uint64_t        Transfer size in bytes
+*
+***********************************************************************/
+static inline uint64_t dmaw_get_transfer_size(
+    const struct cmd_header_t *cmd_info, uint8_t xfer_count)
+{
+    uint64_t transfer_size = 0;
+    uint64_t src_addr;
+    uint64_t dst_addr;
+    uint32_t size;
+
+    for (uint8_t xfer_index = 0; xfer_index < xfer_count; xfer_index++)
+    {
+        dmaw_get_xfer_node(cmd_info, xfer_index, &src_addr, &dst_addr, &size);
+        transfer_size += size;
+    }
+
+    return transfer_size;
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       dmaw_get_stripe_piece
+*
+*   DESCRIPTION
+*
+*       Helper function to get the next data node of a stripe. Stripes are
+*       contiguous ranges of the DMA list, so a node is split in pieces when
+*       it spans two stripes. Nodes are only split at offsets multiple of
+*       DMAW_STRIPE_ALIGNMENT.
+*
+*   INPUTS
+*
+*       cmd_info        Pointer to command buffer
+*       xfer_count      Number of transfer nodes in command.
+*       cursor          Position in the DMA list, it is moved past the piece
+*       stripe_left     Pointer to the bytes left in the stripe
+*       src_addr        Pointer to the source address of the piece
+*       dst_addr        Pointer to the destination address of the piece
+*       size            Pointer to the size of the piece
+*       last            Pointer set to true for the last piece of the stripe
+*
+*   OUTPUTS
+*
+*       bool            false when the stripe has no more pieces
+*
+***********************************************************************/
+static inline bool dmaw_get_stripe_piece(const struct cmd_header_t *cmd_info, uint8_t xfer_count,
+    dmaw_stripe_cursor_t *cursor, uint64_t *stripe_left, uint64_t *src_addr, uint64_t *dst_addr,
+    uint32_t *size, bool *last)
+{
+    uint64_t node_src_addr;
+    uint64_t node_dst_addr;
+    uint32_t node_size;
+    uint64_t end;
+
+    if ((*stripe_left == 0) || (cursor->node >= xfer_count))
+    {
+        return false;
+    }
+
+    dmaw_get_xfer_node(cmd_info, cursor->node, &node_src_addr, &node_dst_addr, &node_size);
+
+    /* The piece ends where the stripe does, or at the end of the node */
+    end = (cursor->offset + *stripe_left + DMAW_STRIPE_ALIGNMENT - 1) &
+          ~((uint64_t)DMAW_STRIPE_ALIGNMENT - 1);
+    if (end > node_size)
+    {
+        end = node_size;
+    }
+
+    *src_addr = node_src_addr + cursor->offset;
+    *dst_addr = node_dst_addr + cursor->offset;
+    *size = (uint32_t)(end - cursor->offset);
+    *stripe_left = (*size >= *stripe_left) ? 0 : (*stripe_left - *size);
+
+    if (end == node_size)
+    {
+        cursor->node++;
+        cursor->offset = 0;
+    }
+    else
+    {
+        cursor->offset = (uint32_t)end;
+    }
+
+    *last = ((*stripe_left == 0) || (cursor->node >= xfer_count));
+
+    return true;
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       dmaw_reserve_stripe_chans
+*
+*   DESCRIPTION
+*
+*       Helper function to reserve the idle channels a DMA list can be
+*       striped across. Each channel transfers at least DMAW_STRIPE_MIN_SIZE
+*       bytes. Busy channels are skipped, it does not wait for them.
+*
+*   INPUTS
+*
+*       chan_status_cb  Status of the DMA channels of one direction
+*       chan_count      Number of channels the SQ is allowed to use
+*       chan_id         Channel already reserved for the command
+*       transfer_size   Transfer size in bytes
+*
+*   OUTPUTS
+*
+*       uint8_t         Mask of the channels reserved, chan_id included
+*
+***********************************************************************/
+static inline uint8_t dmaw_reserve_stripe_chans(dma_channel_status_cb_t *chan_status_cb,
+    uint8_t chan_count, uint8_t chan_id, uint64_t transfer_size)
+{
+    uint8_t chan_mask = (uint8_t)(1U << chan_id);
+    uint64_t stripes_left = transfer_size / DMAW_STRIPE_MIN_SIZE;
+
+    for (uint8_t ch = 0; (ch < chan_count) && (stripes_left > 1); ch++)
+    {
+        /* Compare for idle state and reserve */
+        if ((ch != chan_id) &&
+            (atomic_compare_and_exchange_local_32(&chan_status_cb[ch].status.channel_state,
+                 DMA_CHAN_STATE_IDLE, DMA_CHAN_STATE_RESERVED) == DMA_CHAN_STATE_IDLE))
+        {
+            chan_mask |= (uint8_t)(1U << ch);
+            stripes_left--;
+        }
+    }
+
+    return chan_mask;
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       dmaw_get_stripe_chans
+*
+*   DESCRIPTION
+*
+*       Helper function to get the channels of a mask in stripe order. The
+*       channel reserved first leads the transfer, so it goes first.
+*
+*   INPUTS
+*
+*       chan_id         Leader channel
+*       chan_mask       Mask of the channels reserved, chan_id included
+*       chan_count      Number of channels of the direction
+*       stripe_chans    Array filled with the channels in stripe order
+*
+*   OUTPUTS
+*
+*       uint8_t         Number of channels
+*
+***********************************************************************/
+static inline uint8_t dmaw_get_stripe_chans(
+    uint8_t chan_id, uint8_t chan_mask, uint8_t chan_count, uint8_t *stripe_chans)
+{
+    uint8_t stripe_count = 0;
+
+    stripe_chans[stripe_count++] = chan_id;
+    for (uint8_t ch = 0; ch < chan_count; ch++)
+    {
+        if ((ch != chan_id) && (chan_mask & (1U << ch)))
+        {
+            stripe_chans[stripe_count++] = ch;
+        }
+    }
+
+    return stripe_count;
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       dmaw_release_chan
+*
+*   DESCRIPTION
+*
+*       Helper function to make a DMA channel idle.
+*
+*   INPUTS
+*
+*       chan_status_cb  Status of the DMA channel
+*
+*   OUTPUTS
+*
+*       None
+*
+***********************************************************************/
+static inline void dmaw_release_chan(dma_channel_status_cb_t *chan_status_cb)
+{
+    dma_channel_status_t chan_status;
+
+    chan_status.tag_id = 0;
+    chan_status.sqw_idx = 0;
+    chan_status.channel_state = DMA_CHAN_STATE_IDLE;
+
+    atomic_store_local_64(&chan_status_cb->status.raw_u64, chan_status.raw_u64);
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       dmaw_complete_stripe
+*
+*   DESCRIPTION
+*
+*       Helper function to account for a finished stripe in its transfer.
+*       Any stripe error is kept as the status of the whole transfer. The
+*       channel waits in STRIPE_DONE state, so all the channels are released
+*       at once by the last stripe after the single response.
+*
+*   INPUTS
+*
+*       chan_status_cb  Status of the DMA channels of one direction
+*       chan            Channel of the finished stripe
+*       rsp_status      Response status of the stripe
+*       leader          Pointer to the leader channel of the transfer
+*
+*   OUTPUTS
+*
+*       bool            true if it was the last stripe of the transfer
+*
+***********************************************************************/
+static inline bool dmaw_complete_stripe(
+    dma_channel_status_cb_t *chan_status_cb, uint8_t chan, uint32_t rsp_status, uint8_t *leader)
+{
+    *leader = atomic_load_local_8(&chan_status_cb[chan].stripe_leader);
+
+    /* Keep the first error of the stripes */
+    if (rsp_status != DEV_OPS_API_DMA_RESPONSE_COMPLETE)
+    {
+        atomic_compare_and_exchange_local_32(&chan_status_cb[*leader].stripe_rsp_status,
+            DEV_OPS_API_DMA_RESPONSE_COMPLETE, rsp_status);
+    }
+
+    /* Park the channel before accounting for the stripe: stripes can finish in
+    different DMA workers and the last one releases all the channels */
+    atomic_store_local_32(&chan_status_cb[chan].status.channel_state, DMA_CHAN_STATE_STRIPE_DONE);
+
+    /* Other stripes in flight, the channel is released with the last one */
+    return (atomic_add_local_32(&chan_status_cb[*leader].stripe_pending, (uint32_t)-1) == 1U);
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       dmaw_release_stripe_chans
+*
+*   DESCRIPTION
+*
+*       Helper function to make idle all the channels of a transfer.
+*       NOTE: It must be called once all the transfer attributes are read.
+*
+*   INPUTS
+*
+*       chan_status_cb  Status of the DMA channels of one direction
+*       chan_mask       Mask of the channels of the transfer
+*
+*   OUTPUTS
+*
+*       None
+*
+***********************************************************************/
+static inline void dmaw_release_stripe_chans(
+    dma_channel_status_cb_t *chan_status_cb, uint8_t chan_mask)
+{
+    for (uint8_t ch = 0; chan_mask != 0; ch++, chan_mask = (uint8_t)(chan_mask >> 1))
+    {
+        if (chan_mask & 1U)
+        {
+            atomic_store_local_32(&chan_status_cb[ch].status.channel_state, DMA_CHAN_STATE_IDLE);
+        }
+    }
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       dmaw_add_stripe_trans_cycles
+*
+*   DESCRIPTION
+*
+*       Helper function to accumulate the execution cycles of a transfer in
+*       all the channels it was striped across.
+*
+*   INPUTS
+*
+*       chan_status_cb  Status of the DMA channels of one direction
+*       chan_mask       Mask of the channels of the transfer
+*       exec_duration   Execution cycles of the transfer
+*
+*   OUTPUTS
+*
+*       None
+*
+***********************************************************************/
+static inline void dmaw_add_stripe_trans_cycles(
+    dma_channel_status_cb_t *chan_status_cb, uint8_t chan_mask, uint64_t exec_duration)
+{
+    for (uint8_t ch = 0; chan_mask != 0; ch++, chan_mask = (uint8_t)(chan_mask >> 1))
+    {
+        if (chan_mask & 1U)
+        {
+            atomic_add_local_64(&chan_status_cb[ch].dma_trans_cycles, exec_duration);
+        }
+    }
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       DMAW_Read_Reserve_Stripe_Chans
+*
+*   DESCRIPTION
+*
+*       Reserves the idle DMA read channels a big DMA list can be striped
+*       across, besides the one already reserved for the command. Channels
+*       are only reserved while each of them gets DMAW_STRIPE_MIN_SIZE bytes
+*       at least, and the busy ones are skipped instead of waited for.
+*
+*   INPUTS
+*
+*       chan_id    DMA channel ID already reserved
+*       cmd_info   Pointer to command buffer
+*       xfer_count Number of transfer nodes in command.
+*       sqw_idx    Submission queue index
+*
+*   OUTPUTS
+*
+*       uint8_t    Mask of the channels reserved, chan_id included
+*
+***********************************************************************/
+uint8_t DMAW_Read_Reserve_Stripe_Chans(dma_read_chan_id_e chan_id,
+    const struct cmd_header_t *cmd_info, uint8_t xfer_count, uint8_t sqw_idx)
+{
+    /* The last channels are reserved for the priority SQ */
+    const uint8_t chan_count = (sqw_idx == MM_SQ_PRIORITY_IDX) ?
+                                   PCIE_DMA_RD_CHANNEL_COUNT :
+                                   (PCIE_DMA_RD_CHANNEL_COUNT - MM_SQ_PRIORITY_DMA_CHANNELS);
+
+    return dmaw_reserve_stripe_chans(DMAW_Read_CB.chan_status_cb, chan_count, chan_id,
+        dmaw_get_transfer_size(cmd_info, xfer_count));
+}
+
 /************************************************************************
 *
 *   FUNCTION
@@ -279,11 +789,16 @@ int32_t DMAW_Write_Find_Idle_Chan_And_Reserve(dma_write_chan_id_e *chan_id, uint
 *   DESCRIPTION
 *
 *       This function is used to trigger a DMA Read transaction by calling
-*       the PCIe device driver routine.
+*       the PCIe device driver routine. The DMA list is split in contiguous
+*       stripes, one per channel of chan_mask, which are transferred in
+*       parallel. The first channel leads the transfer: it holds the
+*       attributes used for the single response sent once all the stripes
+*       are done.
 *
 *   INPUTS
 *
 *       read_chan_id    DMA channel ID
+*       chan_mask       Mask of the channels reserved for the command
 *       cmd_info        Pointer to command buffer
 *       xfer_count      Number of transfer nodes in command.
 *       sqw_idx         SQW ID
@@ -294,13 +809,21 @@ int32_t DMAW_Write_Find_Idle_Chan_And_Reserve(dma_write_chan_id_e *chan_id, uint
 *       int32_t          status success or error
 *
 ***********************************************************************/
-int32_t DMAW_Read_Trigger_Transfer(dma_read_chan_id_e read_chan_id,
+int32_t DMAW_Read_Trigger_Transfer(dma_read_chan_id_e read_chan_id, uint8_t chan_mask,
     const struct cmd_header_t *cmd_info, uint8_t xfer_count, uint8_t sqw_idx,
     const execution_cycles_t *cycles)
 {
-    uint64_t transfer_size = 0;
+    uint8_t stripe_chans[PCIE_DMA_RD_CHANNEL_COUNT];
+    dmaw_stripe_cursor_t cursor = { 0 };
     int32_t status = STATUS_SUCCESS;
     dma_channel_status_t chan_status;
+    uint8_t started_count = 0;
+    uint8_t started_mask = 0;
+    const uint8_t reserved_count =
+        dmaw_get_stripe_chans(read_chan_id, chan_mask, PCIE_DMA_RD_CHANNEL_COUNT, stripe_chans);
+    uint8_t stripe_count = reserved_count;
+    const uint64_t transfer_size = dmaw_get_transfer_size(cmd_info, xfer_count);
+    const uint64_t stripe_size = (transfer_size + stripe_count - 1) / stripe_count;
 
     /* Set tag ID, set channel state to active, set SQW Index */
     chan_status.tag_id = cmd_info->cmd_hdr.tag_id;
@@ -311,88 +834,333 @@ int32_t DMAW_Read_Trigger_Transfer(dma_read_chan_id_e read_chan_id,
             DEV_OPS_API_MID_DEVICE_OPS_DMA_WRITELIST_RSP :
             DEV_OPS_API_MID_DEVICE_OPS_P2PDMA_WRITELIST_RSP);
 
-    /* To start indexing from zero, decrement the count by one. */
-    uint8_t last_i = (uint8_t)(xfer_count - 1);
+    /* Configure DMA for each stripe, the last one takes all the bytes left */
+    for (uint8_t stripe = 0; (stripe < stripe_count) && (status == STATUS_SUCCESS); stripe++)
+    {
+        uint64_t stripe_left = (stripe == (stripe_count - 1)) ? transfer_size : stripe_size;
+        uint8_t xfer_index = 0;
+        uint64_t src_addr;
+        uint64_t dst_addr;
+        uint32_t size;
+        bool last;
+
+        while ((status == STATUS_SUCCESS) &&
+               dmaw_get_stripe_piece(cmd_info, xfer_count, &cursor, &stripe_left, &src_addr,
+                   &dst_addr, &size, &last))
+        {
+            /* Add DMA list data node for current piece of the stripe. Enable completion interrupt for last node. */
+            status = dma_config_read_add_data_node(
+                src_addr, dst_addr, size, stripe_chans[stripe], xfer_index, last);
+
+            if (status == DMA_DRIVER_ERROR_INVALID_ADDRESS)
+            {
+                Log_Write(LOG_LEVEL_ERROR,
+                    "SQ[%d]:TID:%u:DMAW:Config:Invalid dst Address 0x%lx\r\n", sqw_idx,
+                    cmd_info->cmd_hdr.tag_id, dst_addr);
+
+                status = DMAW_ERROR_DRIVER_INAVLID_DEV_ADDRESS;
+            }
+            else if (status != STATUS_SUCCESS)
+            {
+                Log_Write(LOG_LEVEL_ERROR,
+                    "SQ[%d]:TID:%u:DMAW_Read:Config:Add data node failed:Status:%d\r\n", sqw_idx,
+                    cmd_info->cmd_hdr.tag_id, status);
+
+                status = DMAW_ERROR_DRIVER_DATA_CONFIG_FAILED;
+            }
+
+            Log_Write(LOG_LEVEL_DEBUG, "DMAW_Read:Config:Added read data node No:%u:Chan:%u\r\n",
+                xfer_index, stripe_chans[stripe]);
+
+            xfer_index++;
+        }
+
+        if ((status == STATUS_SUCCESS) && (xfer_index == 0))
+        {
+            /* Nothing left to transfer, the remaining channels are released below */
+            stripe_count = stripe;
+        }
+        else if (status == STATUS_SUCCESS)
+        {
+            /* Add DMA list link node at the end ot transfer list. */
+            status = dma_config_read_add_link_node(stripe_chans[stripe], xfer_index);
+
+            if (status != STATUS_SUCCESS)
+            {
+                Log_Write(LOG_LEVEL_ERROR,
+                    "SQ[%d]:TID:%u:DMAW_Read:Config: Add link node failed: Status: %d\r\n", sqw_idx,
+                    cmd_info->cmd_hdr.tag_id, status);
+                status = DMAW_ERROR_DRIVER_LINK_CONFIG_FAILED;
+            }
+
+            Log_Write(LOG_LEVEL_DEBUG,
+                "DMAW_Read:Config:Added DMA read Link node at the end of list transfer.\r\n");
+        }
+    }
+
+    /* Start the DMA channels. The transfer goes on with the started stripes if one fails */
+    while ((status == STATUS_SUCCESS) && (started_count < stripe_count))
+    {
+        if (dma_start_read(stripe_chans[started_count]) != STATUS_SUCCESS)
+        {
+            Log_Write(LOG_LEVEL_DEBUG, "SQ[%d]:Failed to started DMA read channel:%u!\r\n",
+                sqw_idx, stripe_chans[started_count]);
+            break;
+        }
+
+        started_mask |= (uint8_t)(1U << stripe_chans[started_count]);
+        started_count++;
+    }
+
+    if ((status == STATUS_SUCCESS) && (started_count == 0))
+    {
+        status = DMAW_ERROR_DRIVER_CHAN_START_FAILED;
+    }
+
+    if (status == STATUS_SUCCESS)
+    {
+        /* Log the command state in trace */
+        TRACE_LOG_CMD_STATUS(
+            cmd_info->cmd_hdr.msg_id, sqw_idx, cmd_info->cmd_hdr.tag_id, CMD_STATUS_EXECUTING)
+
+        /* Update cycles value into the Global Channel Status data structure */
+        atomic_store_local_64(
+            &DMAW_Read_CB.chan_status_cb[read_chan_id].dmaw_cycles.cmd_start_cycles,
+            cycles->cmd_start_cycles);
+        atomic_store_local_64(
+            &DMAW_Read_CB.chan_status_cb[read_chan_id].dmaw_cycles.exec_start_cycles,
+            cycles->exec_start_cycles);
+        atomic_store_local_64(&DMAW_Read_CB.chan_status_cb[read_chan_id].dmaw_cycles.wait_cycles,
+            cycles->wait_cycles);
+        atomic_store_local_64(
+            &DMAW_Read_CB.chan_status_cb[read_chan_id].transfer_size, transfer_size);
+
+        /* Stripes which could not be started make the whole transfer fail */
+        atomic_store_local_32(
+            &DMAW_Read_CB.chan_status_cb[read_chan_id].stripe_pending, started_count);
+        atomic_store_local_32(&DMAW_Read_CB.chan_status_cb[read_chan_id].stripe_rsp_status,
+            (started_count == stripe_count) ? DEV_OPS_API_DMA_RESPONSE_COMPLETE :
+                                              DEV_OPS_API_DMA_RESPONSE_DRIVER_CHAN_START_FAILED);
+        atomic_store_local_8(
+            &DMAW_Read_CB.chan_status_cb[read_chan_id].stripe_mask, started_mask);
+
+        /* Update the global structure to make it visible to DMAW, release the unused channels */
+        for (uint8_t stripe = 0; stripe < reserved_count; stripe++)
+        {
+            dma_channel_status_cb_t *stripe_cb =
+                &DMAW_Read_CB.chan_status_cb[stripe_chans[stripe]];
+
+            if (stripe < started_count)
+            {
+                atomic_store_local_8(&stripe_cb->stripe_leader, read_chan_id);
+                atomic_store_local_64(&stripe_cb->status.raw_u64, chan_status.raw_u64);
+            }
+            else
+            {
+                dmaw_release_chan(stripe_cb);
+            }
+        }
+
+        if (started_count < stripe_count)
+        {
+            Log_Write(LOG_LEVEL_ERROR, "SQ[%d]:TID:%u:DMAW Read Start Failed:Stripes:%u/%u!\r\n",
+                sqw_idx, cmd_info->cmd_hdr.tag_id, started_count, stripe_count);
+
+            SP_Iface_Report_Error(MM_RECOVERABLE_FW_MM_DMAW_ERROR, MM_DMA_WRITE_CONFIG_ERROR);
+        }
+
+        Log_Write(LOG_LEVEL_DEBUG, "SQ[%d]:DMAW_Read_Trigger_Transfer:Success:Stripes:%u!\r\n",
+            sqw_idx, started_count);
+    }
+    else
+    {
+        /* Release the DMA resources */
+        for (uint8_t stripe = 0; stripe < reserved_count; stripe++)
+        {
+            dmaw_release_chan(&DMAW_Read_CB.chan_status_cb[stripe_chans[stripe]]);
+        }
+
+        Log_Write(LOG_LEVEL_ERROR, "SQ[%d]:TID:%u:DMAW Read Config Failed:%d!\r\n", sqw_idx,
+            cmd_info->cmd_hdr.tag_id, status);
+
+        SP_Iface_Report_Error(MM_RECOVERABLE_FW_MM_DMAW_ERROR, MM_DMA_WRITE_CONFIG_ERROR);
+    }
+
+    return status;
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       DMAW_Write_Reserve_Stripe_Chans
+*
+*   DESCRIPTION
+*
+*       Reserves the idle DMA write channels a big DMA list can be striped
+*       across, besides the one already reserved for the command. Channels
+*       are only reserved while each of them gets DMAW_STRIPE_MIN_SIZE bytes
+*       at least, and the busy ones are skipped instead of waited for.
+*
+*   INPUTS
+*
+*       chan_id    DMA channel ID already reserved
+*       cmd_info   Pointer to command buffer
+*       xfer_count Number of transfer nodes in command.
+*       sqw_idx    Submission queue index
+*
+*   OUTPUTS
+*
+*       uint8_t    Mask of the channels reserved, chan_id included
+*
+***********************************************************************/
+uint8_t DMAW_Write_Reserve_Stripe_Chans(dma_write_chan_id_e chan_id,
+    const struct cmd_header_t *cmd_info, uint8_t xfer_count, uint8_t sqw_idx)
+{
+    /* The last channels are reserved for the priority SQ */
+    const uint8_t chan_count = (sqw_idx == MM_SQ_PRIORITY_IDX) ?
+                                   PCIE_DMA_WRT_CHANNEL_COUNT :
+                                   (PCIE_DMA_WRT_CHANNEL_COUNT - MM_SQ_PRIORITY_DMA_CHANNELS);
+
+    return dmaw_reserve_stripe_chans(DMAW_Write_CB.chan_status_cb, chan_count, chan_id,
+        dmaw_get_transfer_size(cmd_info, xfer_count));
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       DMAW_Write_Trigger_Transfer
+*
+*   DESCRIPTION
+*
+*       This function is used to trigger a DMA write transaction by calling
+*       the PCIe device driver routine. The DMA list is split in contiguous
+*       stripes, one per channel of chan_mask, which are transferred in
+*       parallel. The first channel leads the transfer: it holds the
+*       attributes used for the single response sent once all the stripes
+*       are done.
+*
+*   INPUTS
+*
+*       write_chan_id    DMA channel ID
+*       chan_mask       Mask of the channels reserved for the command
+*       cmd_info        Pointer to command buffer
+*       xfer_count      Number of transfer nodes in command.
+*       sqw_idx         SQW ID
+*       cycles          Pointer to latency cycles struct
+*       flags           DMA flag to set a specific DMA action.
+*
+*   OUTPUTS
+*
+*       int32_t          status success or error
+*
+***********************************************************************/
+int32_t DMAW_Write_Trigger_Transfer(dma_write_chan_id_e write_chan_id, uint8_t chan_mask,
+    const struct cmd_header_t *cmd_info, uint8_t xfer_count, uint8_t sqw_idx,
+    const execution_cycles_t *cycles, dma_flags_e flags)
+{
+    uint8_t stripe_chans[PCIE_DMA_WRT_CHANNEL_COUNT];
+    dmaw_stripe_cursor_t cursor = { 0 };
+    int32_t status = STATUS_SUCCESS;
+    dma_channel_status_t chan_status;
+    uint8_t started_count = 0;
+    uint8_t started_mask = 0;
+    const uint8_t reserved_count =
+        dmaw_get_stripe_chans(write_chan_id, chan_mask, PCIE_DMA_WRT_CHANNEL_COUNT, stripe_chans);
+    uint8_t stripe_count = reserved_count;
+    const uint64_t transfer_size = dmaw_get_transfer_size(cmd_info, xfer_count);
+    const uint64_t stripe_size = (transfer_size + stripe_count - 1) / stripe_count;
+
+    /* Set tag ID, set channel state to active, set SQW Index */
+    chan_status.tag_id = cmd_info->cmd_hdr.tag_id;
+    chan_status.sqw_idx = sqw_idx;
+    chan_status.channel_state = DMA_CHAN_STATE_IN_USE;
+    atomic_store_local_16(&DMAW_Write_CB.chan_status_cb[write_chan_id].rsp_id,
+        (cmd_info->cmd_hdr.msg_id == DEV_OPS_API_MID_DEVICE_OPS_DMA_READLIST_CMD) ?
+            DEV_OPS_API_MID_DEVICE_OPS_DMA_READLIST_RSP :
+            DEV_OPS_API_MID_DEVICE_OPS_P2PDMA_READLIST_RSP);
 
-    /* Configure DMA for all transfers one-by-one. */
-    for (uint8_t xfer_index = 0; (xfer_index <= last_i) && (status == STATUS_SUCCESS); ++xfer_index)
+    /* Configure DMA for each stripe, the last one takes all the bytes left */
+    for (uint8_t stripe = 0; (stripe < stripe_count) && (status == STATUS_SUCCESS); stripe++)
     {
+        uint64_t stripe_left = (stripe == (stripe_count - 1)) ? transfer_size : stripe_size;
+        uint8_t xfer_index = 0;
         uint64_t src_addr;
         uint64_t dst_addr;
         uint32_t size;
+        bool last;
 
-        if (cmd_info->cmd_hdr.msg_id == DEV_OPS_API_MID_DEVICE_OPS_DMA_WRITELIST_CMD)
+        while ((status == STATUS_SUCCESS) &&
+               dmaw_get_stripe_piece(cmd_info, xfer_count, &cursor, &stripe_left, &src_addr,
+                   &dst_addr, &size, &last))
         {
-            const struct device_ops_dma_writelist_cmd_t *dmalist_cmd =
-                (const struct device_ops_dma_writelist_cmd_t *)cmd_info;
+            /* Add DMA list data node for current piece of the stripe. Enable completion interrupt for last node. */
+            status = dma_config_write_add_data_node(
+                src_addr, dst_addr, size, stripe_chans[stripe], xfer_index, flags, last);
 
-            src_addr = dmalist_cmd->list[xfer_index].src_host_phy_addr;
-            dst_addr = dmalist_cmd->list[xfer_index].dst_device_phy_addr;
-            size = dmalist_cmd->list[xfer_index].size;
-        }
-        else
-        {
-            const struct device_ops_p2pdma_writelist_cmd_t *p2p_dmalist_cmd =
-                (const struct device_ops_p2pdma_writelist_cmd_t *)cmd_info;
+            if (status == DMA_DRIVER_ERROR_INVALID_ADDRESS)
+            {
+                Log_Write(LOG_LEVEL_ERROR,
+                    "SQ[%d]:TID:%u:DMAW_Write:Config:Invalid src Address 0x%lx\r\n", sqw_idx,
+                    cmd_info->cmd_hdr.tag_id, src_addr);
+                status = DMAW_ERROR_DRIVER_INAVLID_DEV_ADDRESS;
+            }
+            else if (status != STATUS_SUCCESS)
+            {
+                Log_Write(LOG_LEVEL_ERROR,
+                    "SQ[%d]:TID:%u:DMAW_Write:Config:Add data node failed:Status:%d\r\n", sqw_idx,
+                    cmd_info->cmd_hdr.tag_id, status);
 
-            src_addr = p2p_dmalist_cmd->list[xfer_index].src_device_bus_addr;
-            dst_addr = p2p_dmalist_cmd->list[xfer_index].dst_device_phy_addr;
-            size = p2p_dmalist_cmd->list[xfer_index].size;
-        }
+                status = DMAW_ERROR_DRIVER_DATA_CONFIG_FAILED;
+            }
 
-        /* Add DMA list data node for current transfer in the list.Enable completion interrupt for last transfer node. */
-        status = dma_config_read_add_data_node(src_addr, dst_addr, size, read_chan_id, xfer_index,
-            (xfer_index == last_i ? true : false));
+            Log_Write(LOG_LEVEL_DEBUG, "DMAW_Write:Config:Added write data node No:%u:Chan:%u\r\n",
+                xfer_index, stripe_chans[stripe]);
 
-        transfer_size += size;
+            xfer_index++;
+        }
 
-        if (status == DMA_DRIVER_ERROR_INVALID_ADDRESS)
+        if ((status == STATUS_SUCCESS) && (xfer_index == 0))
         {
-            Log_Write(LOG_LEVEL_ERROR, "SQ[%d]:TID:%u:DMAW:Config:Invalid dst Address 0x%lx\r\n",
-                sqw_idx, cmd_info->cmd_hdr.tag_id, dst_addr);
-
-            status = DMAW_ERROR_DRIVER_INAVLID_DEV_ADDRESS;
+            /* Nothing left to transfer, the remaining channels are released below */
+            stripe_count = stripe;
         }
-        else if (status != STATUS_SUCCESS)
+        else if (status == STATUS_SUCCESS)
         {
-            Log_Write(LOG_LEVEL_ERROR,
-                "SQ[%d]:TID:%u:DMAW_Read:Config:Add data node failed:Status:%d\r\n", sqw_idx,
-                cmd_info->cmd_hdr.tag_id, status);
+            /* Add DMA list link node at the end ot transfer list. */
+            status = dma_config_write_add_link_node(stripe_chans[stripe], xfer_index);
 
-            status = DMAW_ERROR_DRIVER_DATA_CONFIG_FAILED;
-        }
+            if (status != STATUS_SUCCESS)
+            {
+                Log_Write(LOG_LEVEL_ERROR,
+                    "SQ[%d]:TID:%u:DMAW_Write:Config: Add link node failed: Status: %d\r\n",
+                    sqw_idx, cmd_info->cmd_hdr.tag_id, status);
+                status = DMAW_ERROR_DRIVER_LINK_CONFIG_FAILED;
+            }
 
-        Log_Write(LOG_LEVEL_DEBUG, "DMAW_Read:Config:Added read data node No:%u\r\n", xfer_index);
+            Log_Write(LOG_LEVEL_DEBUG,
+                "DMAW_Write:Config:Added DMA write Link node at the end of list transfer.\r\n");
+        }
     }
 
-    if (status == STATUS_SUCCESS)
+    /* Start the DMA channels. The transfer goes on with the started stripes if one fails */
+    while ((status == STATUS_SUCCESS) && (started_count < stripe_count))
     {
-        /* Add DMA list link node at the end ot transfer list. */
-        status = dma_config_read_add_link_node(read_chan_id, xfer_count);
-
-        if (status != STATUS_SUCCESS)
+        if (dma_start_write(stripe_chans[started_count]) != STATUS_SUCCESS)
         {
-            Log_Write(LOG_LEVEL_ERROR,
-                "SQ[%d]:TID:%u:DMAW_Read:Config: Add link node failed: Status: %d\r\n", sqw_idx,
-                cmd_info->cmd_hdr.tag_id, status);
-            status = DMAW_ERROR_DRIVER_LINK_CONFIG_FAILED;
+            Log_Write(LOG_LEVEL_DEBUG, "SQ[%d]:Failed to started DMA write channel:%u!\r\n",
+                sqw_idx, stripe_chans[started_count]);
+            break;
         }
 
-        Log_Write(LOG_LEVEL_DEBUG,
-            "DMAW_Read:Config:Added DMA red Link node at the end of list transfer.\r\n");
+        started_mask |= (uint8_t)(1U << stripe_chans[started_count]);
+        started_count++;
     }
 
-    if (status == STATUS_SUCCESS)
+    if ((status == STATUS_SUCCESS) && (started_count == 0))
     {
-        /* Start the DMA channel */
-        status = dma_start_read(read_chan_id);
-
-        if (status != STATUS_SUCCESS)
-        {
-            Log_Write(LOG_LEVEL_DEBUG, "SQ[%d]:Failed to started DMA read channel:Status:%d!\r\n",
-                sqw_idx, status);
-            status = DMAW_ERROR_DRIVER_CHAN_START_FAILED;
-        }
+        status = DMAW_ERROR_DRIVER_CHAN_START_FAILED;
     }
 
     if (status == STATUS_SUCCESS)
@@ -403,35 +1171,62 @@ int32_t DMAW_Read_Trigger_Transfer(dma_read_chan_id_e read_chan_id,
 
         /* Update cycles value into the Global Channel Status data structure */
         atomic_store_local_64(
-            &DMAW_Read_CB.chan_status_cb[read_chan_id].dmaw_cycles.cmd_start_cycles,
+            &DMAW_Write_CB.chan_status_cb[write_chan_id].dmaw_cycles.cmd_start_cycles,
             cycles->cmd_start_cycles);
         atomic_store_local_64(
-            &DMAW_Read_CB.chan_status_cb[read_chan_id].dmaw_cycles.exec_start_cycles,
+            &DMAW_Write_CB.chan_status_cb[write_chan_id].dmaw_cycles.exec_start_cycles,
             cycles->exec_start_cycles);
-        atomic_store_local_64(&DMAW_Read_CB.chan_status_cb[read_chan_id].dmaw_cycles.wait_cycles,
+        atomic_store_local_64(&DMAW_Write_CB.chan_status_cb[write_chan_id].dmaw_cycles.wait_cycles,
             cycles->wait_cycles);
         atomic_store_local_64(
-            &DMAW_Read_CB.chan_status_cb[read_chan_id].transfer_size, transfer_size);
+            &DMAW_Write_CB.chan_status_cb[write_chan_id].transfer_size, transfer_size);
 
-        /* Update the global structure to make it visible to DMAW */
-        atomic_store_local_64(
-            &DMAW_Read_CB.chan_status_cb[read_chan_id].status.raw_u64, chan_status.raw_u64);
+        /* Stripes which could not be started make the whole transfer fail */
+        atomic_store_local_32(
+            &DMAW_Write_CB.chan_status_cb[write_chan_id].stripe_pending, started_count);
+        atomic_store_local_32(&DMAW_Write_CB.chan_status_cb[write_chan_id].stripe_rsp_status,
+            (started_count == stripe_count) ? DEV_OPS_API_DMA_RESPONSE_COMPLETE :
+                                              DEV_OPS_API_DMA_RESPONSE_DRIVER_CHAN_START_FAILED);
+        atomic_store_local_8(
+            &DMAW_Write_CB.chan_status_cb[write_chan_id].stripe_mask, started_mask);
+
+        /* Update the global structure to make it visible to DMAW, release the unused channels */
+        for (uint8_t stripe = 0; stripe < reserved_count; stripe++)
+        {
+            dma_channel_status_cb_t *stripe_cb =
+                &DMAW_Write_CB.chan_status_cb[stripe_chans[stripe]];
+
+            if (stripe < started_count)
+            {
+                atomic_store_local_8(&stripe_cb->stripe_leader, write_chan_id);
+                atomic_store_local_64(&stripe_cb->status.raw_u64, chan_status.raw_u64);
+            }
+            else
+            {
+                dmaw_release_chan(stripe_cb);
+            }
+        }
+
+        if (started_count < stripe_count)
+        {
+            Log_Write(LOG_LEVEL_ERROR, "SQ[%d]:TID:%u:DMAW Write Start Failed:Stripes:%u/%u!\r\n",
+                sqw_idx, cmd_info->cmd_hdr.tag_id, started_count, stripe_count);
 
-        Log_Write(LOG_LEVEL_DEBUG, "SQ[%d]:DMAW_Read_Trigger_Transfer:Success!\r\n", sqw_idx);
+            SP_Iface_Report_Error(MM_RECOVERABLE_FW_MM_DMAW_ERROR, MM_DMA_WRITE_CONFIG_ERROR);
+        }
 
-        status = STATUS_SUCCESS;
+        Log_Write(LOG_LEVEL_DEBUG, "SQ[%d]:DMAW_Write_Trigger_Transfer:Success:Stripes:%u!\r\n",
+            sqw_idx, started_count);
     }
     else
     {
         /* Release the DMA resources */
-        chan_status.tag_id = 0;
-        chan_status.sqw_idx = 0;
-        chan_status.channel_state = DMA_CHAN_STATE_IDLE;
-
-        atomic_store_local_64(
-            &DMAW_Read_CB.chan_status_cb[read_chan_id].status.raw_u64, chan_status.raw_u64);
+        for (uint8_t stripe = 0; stripe < reserved_count; stripe++)
+        {
+            dmaw_release_chan(&DMAW_Write_CB.chan_status_cb[stripe_chans[stripe]]);
+        }
 
-        Log_Write(LOG_LEVEL_ERROR, "SQ[%d]:TID:%u:DMAW Read Config Failed:%d!\r\n", sqw_idx,
+        Log_Write(LOG_LEVEL_ERROR, "SQ[%d]:TID:%u:DMAW Write Config Failed:%d!\r\n", sqw_idx,
             cmd_info->cmd_hdr.tag_id, status);
 
         SP_Iface_Report_Error(MM_RECOVERABLE_FW_MM_DMAW_ERROR, MM_DMA_WRITE_CONFIG_ERROR);
@@ -444,125 +1239,185 @@ int32_t DMAW_Read_Trigger_Transfer(dma_read_chan_id_e read_chan_id,
 *
 *   FUNCTION
 *
-*       DMAW_Write_Trigger_Transfer
+*       dmaw_set_chain_in_use
 *
 *   DESCRIPTION
 *
-*       This function is used to trigger a DMA write transaction by calling
-*       the PCIe device driver routine.
+*       Helper function to make a channel running a DMA chain visible to
+*       DMAW. The chain is a transfer of a single stripe, so it completes
+*       through the same path as the DMA lists.
 *
 *   INPUTS
 *
-*       write_chan_id   DMA channel ID
+*       chan_status_cb  Status of the DMA channels of one direction
+*       chan            Channel running the chain
 *       cmd_info        Pointer to command buffer
-*       xfer_count      Number of transfer nodes in command.
 *       sqw_idx         SQW ID
 *       cycles          Pointer to latency cycles struct
-*       flags           DMA flag to set a specific DMA action.
+*       transfer_size   Total size of the chain transfers
 *
 *   OUTPUTS
 *
-*       int32_t          status success or error
+*       None
 *
 ***********************************************************************/
-int32_t DMAW_Write_Trigger_Transfer(dma_write_chan_id_e write_chan_id,
-    const struct cmd_header_t *cmd_info, uint8_t xfer_count, uint8_t sqw_idx,
-    const execution_cycles_t *cycles, dma_flags_e flags)
+static inline void dmaw_set_chain_in_use(dma_channel_status_cb_t *chan_status_cb, uint8_t chan,
+    const struct cmd_header_t *cmd_info, uint8_t sqw_idx, const execution_cycles_t *cycles,
+    uint64_t transfer_size)
 {
-    uint64_t transfer_size = 0;
-    int32_t status = STATUS_SUCCESS;
     dma_channel_status_t chan_status;
 
-    /* Set tag ID, set channel state to active, set SQW Index */
     chan_status.tag_id = cmd_info->cmd_hdr.tag_id;
     chan_status.sqw_idx = sqw_idx;
     chan_status.channel_state = DMA_CHAN_STATE_IN_USE;
-    atomic_store_local_16(&DMAW_Write_CB.chan_status_cb[write_chan_id].rsp_id,
-        (cmd_info->cmd_hdr.msg_id == DEV_OPS_API_MID_DEVICE_OPS_DMA_READLIST_CMD) ?
-            DEV_OPS_API_MID_DEVICE_OPS_DMA_READLIST_RSP :
-            DEV_OPS_API_MID_DEVICE_OPS_P2PDMA_READLIST_RSP);
 
-    /* To start indexing from zero, decrement the count by one. */
-    uint8_t last_i = (uint8_t)(xfer_count - 1);
-
-    /* Configure DMA for all transfers one-by-one. */
-    for (uint8_t xfer_index = 0; (xfer_index <= last_i) && (status == STATUS_SUCCESS); ++xfer_index)
-    {
-        uint64_t src_addr;
-        uint64_t dst_addr;
-        uint32_t size;
+    atomic_store_local_16(&chan_status_cb[chan].rsp_id, DEV_OPS_API_MID_DEVICE_OPS_DMA_CHAIN_RSP);
+    atomic_store_local_64(
+        &chan_status_cb[chan].dmaw_cycles.cmd_start_cycles, cycles->cmd_start_cycles);
+    atomic_store_local_64(
+        &chan_status_cb[chan].dmaw_cycles.exec_start_cycles, cycles->exec_start_cycles);
+    atomic_store_local_64(&chan_status_cb[chan].dmaw_cycles.wait_cycles, cycles->wait_cycles);
+    atomic_store_local_64(&chan_status_cb[chan].transfer_size, transfer_size);
+    atomic_store_local_32(&chan_status_cb[chan].stripe_pending, 1U);
+    atomic_store_local_32(
+        &chan_status_cb[chan].stripe_rsp_status, DEV_OPS_API_DMA_RESPONSE_COMPLETE);
+    atomic_store_local_8(&chan_status_cb[chan].stripe_mask, (uint8_t)(1U << chan));
+    atomic_store_local_8(&chan_status_cb[chan].stripe_leader, chan);
 
-        if (cmd_info->cmd_hdr.msg_id == DEV_OPS_API_MID_DEVICE_OPS_DMA_READLIST_CMD)
-        {
-            const struct device_ops_dma_readlist_cmd_t *dmalist_cmd =
-                (const struct device_ops_dma_readlist_cmd_t *)cmd_info;
+    /* Update the global structure to make it visible to DMAW */
+    atomic_store_local_64(&chan_status_cb[chan].status.raw_u64, chan_status.raw_u64);
+}
 
-            src_addr = dmalist_cmd->list[xfer_index].src_device_phy_addr;
-            dst_addr = dmalist_cmd->list[xfer_index].dst_host_phy_addr;
-            size = dmalist_cmd->list[xfer_index].size;
-        }
-        else
-        {
-            const struct device_ops_p2pdma_readlist_cmd_t *p2p_dmalist_cmd =
-                (const struct device_ops_p2pdma_readlist_cmd_t *)cmd_info;
+/************************************************************************
+*
+*   FUNCTION
+*
+*       DMAW_Read_Trigger_Chain
+*
+*   DESCRIPTION
+*
+*       This function is used to trigger a DMA Read transaction running a
+*       chain of data elements resident in device DRAM on a single channel.
+*       The chain isn't striped: its elements are only read by the DMA
+*       engine, so any number of them is a single transfer.
+*
+*   INPUTS
+*
+*       read_chan_id    DMA channel ID
+*       cmd_info        Pointer to command buffer
+*       chain_addr      Address of the chain in device DRAM
+*       elem_count      Number of data elements of the chain
+*       host_addr       Bus address of the host buffer
+*       host_size       Size of the host buffer
+*       sqw_idx         SQW ID
+*       cycles          Pointer to latency cycles struct
+*
+*   OUTPUTS
+*
+*       int32_t          status success or error
+*
+***********************************************************************/
+int32_t DMAW_Read_Trigger_Chain(dma_read_chan_id_e read_chan_id,
+    const struct cmd_header_t *cmd_info, uint64_t chain_addr, uint32_t elem_count,
+    uint64_t host_addr, uint64_t host_size, uint8_t sqw_idx, const execution_cycles_t *cycles)
+{
+    uint64_t transfer_size = 0;
+    int32_t status = dma_config_read_add_chain(
+        chain_addr, elem_count, host_addr, host_size, read_chan_id, &transfer_size);
 
-            src_addr = p2p_dmalist_cmd->list[xfer_index].src_device_phy_addr;
-            dst_addr = p2p_dmalist_cmd->list[xfer_index].dst_device_bus_addr;
-            size = p2p_dmalist_cmd->list[xfer_index].size;
-        }
+    if (status == DMA_DRIVER_ERROR_INVALID_ADDRESS)
+    {
+        Log_Write(LOG_LEVEL_ERROR, "SQ[%d]:TID:%u:DMAW_Read:Chain:Invalid element:0x%lx\r\n",
+            sqw_idx, cmd_info->cmd_hdr.tag_id, chain_addr);
 
-        /* Add DMA list data node for current transfer in the list. Enable completion interrupt for last transfer node.*/
-        status = dma_config_write_add_data_node(src_addr, dst_addr, size, write_chan_id, xfer_index,
-            flags, (xfer_index == last_i ? true : false));
+        status = DMAW_ERROR_DRIVER_INAVLID_DEV_ADDRESS;
+    }
+    else if (status != STATUS_SUCCESS)
+    {
+        status = DMAW_ERROR_DRIVER_DATA_CONFIG_FAILED;
+    }
+    else if (dma_start_read(read_chan_id) != STATUS_SUCCESS)
+    {
+        status = DMAW_ERROR_DRIVER_CHAN_START_FAILED;
+    }
 
-        transfer_size += size;
+    if (status == STATUS_SUCCESS)
+    {
+        /* Log the command state in trace */
+        TRACE_LOG_CMD_STATUS(
+            cmd_info->cmd_hdr.msg_id, sqw_idx, cmd_info->cmd_hdr.tag_id, CMD_STATUS_EXECUTING)
 
-        if (status == DMA_DRIVER_ERROR_INVALID_ADDRESS)
-        {
-            Log_Write(LOG_LEVEL_ERROR,
-                "SQ[%d]:TID:%u:DMAW_Write:Config:Invalid src Address 0x%lx\r\n", sqw_idx,
-                cmd_info->cmd_hdr.tag_id, src_addr);
-            status = DMAW_ERROR_DRIVER_INAVLID_DEV_ADDRESS;
-        }
-        else if (status != STATUS_SUCCESS)
-        {
-            Log_Write(LOG_LEVEL_ERROR,
-                "SQ[%d]:TID:%u:DMAW_Write:Config:Add data node failed:Status:%d\r\n", sqw_idx,
-                cmd_info->cmd_hdr.tag_id, status);
-            status = DMAW_ERROR_DRIVER_DATA_CONFIG_FAILED;
-        }
+        dmaw_set_chain_in_use(
+            DMAW_Read_CB.chan_status_cb, read_chan_id, cmd_info, sqw_idx, cycles, transfer_size);
 
-        Log_Write(LOG_LEVEL_DEBUG, "DMAW_Write:Config:Added write data node No:%u\r\n", xfer_index);
+        Log_Write(LOG_LEVEL_DEBUG, "SQ[%d]:DMAW_Read_Trigger_Chain:Success:Elements:%u!\r\n",
+            sqw_idx, elem_count);
     }
-
-    if (status == STATUS_SUCCESS)
+    else
     {
-        /* Add DMA list link node at the end ot transfer list. */
-        status = dma_config_write_add_link_node(write_chan_id, xfer_count);
+        /* Release the DMA resources */
+        dmaw_release_chan(&DMAW_Read_CB.chan_status_cb[read_chan_id]);
 
-        if (status != STATUS_SUCCESS)
-        {
-            Log_Write(LOG_LEVEL_ERROR,
-                "SQ[%d]:TID:%u:DMAW:Config: Add link node failed: Stauts: %d\r\n", sqw_idx,
-                cmd_info->cmd_hdr.tag_id, status);
-            status = DMAW_ERROR_DRIVER_LINK_CONFIG_FAILED;
-        }
+        Log_Write(LOG_LEVEL_ERROR, "SQ[%d]:TID:%u:DMAW Read Chain Failed:%d!\r\n", sqw_idx,
+            cmd_info->cmd_hdr.tag_id, status);
 
-        Log_Write(LOG_LEVEL_DEBUG,
-            "DMAW:Config:Added DMA write Link node at the end of list transfer.\r\n");
+        SP_Iface_Report_Error(MM_RECOVERABLE_FW_MM_DMAW_ERROR, MM_DMA_WRITE_CONFIG_ERROR);
     }
 
-    if (status == STATUS_SUCCESS)
+    return status;
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       DMAW_Write_Trigger_Chain
+*
+*   DESCRIPTION
+*
+*       This function is used to trigger a DMA write transaction running a
+*       chain of data elements resident in device DRAM on a single channel.
+*       The chain isn't striped: its elements are only read by the DMA
+*       engine, so any number of them is a single transfer.
+*
+*   INPUTS
+*
+*       write_chan_id   DMA channel ID
+*       cmd_info        Pointer to command buffer
+*       chain_addr      Address of the chain in device DRAM
+*       elem_count      Number of data elements of the chain
+*       host_addr       Bus address of the host buffer
+*       host_size       Size of the host buffer
+*       sqw_idx         SQW ID
+*       cycles          Pointer to latency cycles struct
+*
+*   OUTPUTS
+*
+*       int32_t          status success or error
+*
+***********************************************************************/
+int32_t DMAW_Write_Trigger_Chain(dma_write_chan_id_e write_chan_id,
+    const struct cmd_header_t *cmd_info, uint64_t chain_addr, uint32_t elem_count,
+    uint64_t host_addr, uint64_t host_size, uint8_t sqw_idx, const execution_cycles_t *cycles)
+{
+    uint64_t transfer_size = 0;
+    int32_t status = dma_config_write_add_chain(
+        chain_addr, elem_count, host_addr, host_size, write_chan_id, &transfer_size);
+
+    if (status == DMA_DRIVER_ERROR_INVALID_ADDRESS)
     {
-        /* Start the DMA channel */
-        status = dma_start_write(write_chan_id);
+        Log_Write(LOG_LEVEL_ERROR, "SQ[%d]:TID:%u:DMAW_Write:Chain:Invalid element:0x%lx\r\n",
+            sqw_idx, cmd_info->cmd_hdr.tag_id, chain_addr);
 
-        if (status != STATUS_SUCCESS)
-        {
-            Log_Write(LOG_LEVEL_DEBUG, "SQ[%d]:Failed to started DMA write channel:Status:%d!\r\n",
-                sqw_idx, status);
-            status = DMAW_ERROR_DRIVER_CHAN_START_FAILED;
-        }
+        status = DMAW_ERROR_DRIVER_INAVLID_DEV_ADDRESS;
+    }
+    else if (status != STATUS_SUCCESS)
+    {
+        status = DMAW_ERROR_DRIVER_DATA_CONFIG_FAILED;
+    }
+    else if (dma_start_write(write_chan_id) != STATUS_SUCCESS)
+    {
+        status = DMAW_ERROR_DRIVER_CHAN_START_FAILED;
     }
 
     if (status == STATUS_SUCCESS)
@@ -571,37 +1426,18 @@ int32_t DMAW_Write_Trigger_Transfer(dma_write_chan_id_e write_chan_id,
         TRACE_LOG_CMD_STATUS(
             cmd_info->cmd_hdr.msg_id, sqw_idx, cmd_info->cmd_hdr.tag_id, CMD_STATUS_EXECUTING)
 
-        /* Update cycles value into the Global Channel Status data structure */
-        atomic_store_local_64(
-            &DMAW_Write_CB.chan_status_cb[write_chan_id].dmaw_cycles.cmd_start_cycles,
-            cycles->cmd_start_cycles);
-        atomic_store_local_64(
-            &DMAW_Write_CB.chan_status_cb[write_chan_id].dmaw_cycles.exec_start_cycles,
-            cycles->exec_start_cycles);
-        atomic_store_local_64(&DMAW_Write_CB.chan_status_cb[write_chan_id].dmaw_cycles.wait_cycles,
-            cycles->wait_cycles);
-        atomic_store_local_64(
-            &DMAW_Write_CB.chan_status_cb[write_chan_id].transfer_size, transfer_size);
-
-        /* Update the global structure to make it visible to DMAW */
-        atomic_store_local_64(
-            &DMAW_Write_CB.chan_status_cb[write_chan_id].status.raw_u64, chan_status.raw_u64);
-
-        Log_Write(LOG_LEVEL_DEBUG, "SQ[%d]:DMAW_Write_Trigger_Transfer:Success!\r\n", sqw_idx);
+        dmaw_set_chain_in_use(
+            DMAW_Write_CB.chan_status_cb, write_chan_id, cmd_info, sqw_idx, cycles, transfer_size);
 
-        status = STATUS_SUCCESS;
+        Log_Write(LOG_LEVEL_DEBUG, "SQ[%d]:DMAW_Write_Trigger_Chain:Success:Elements:%u!\r\n",
+            sqw_idx, elem_count);
     }
     else
     {
         /* Release the DMA resources */
-        chan_status.tag_id = 0;
-        chan_status.sqw_idx = 0;
-        chan_status.channel_state = DMA_CHAN_STATE_IDLE;
-
-        atomic_store_local_64(
-            &DMAW_Write_CB.chan_status_cb[write_chan_id].status.raw_u64, chan_status.raw_u64);
+        dmaw_release_chan(&DMAW_Write_CB.chan_status_cb[write_chan_id]);
 
-        Log_Write(LOG_LEVEL_ERROR, "SQ[%d]:TID:%u:DMAW Write Config Failed:%d!\r\n", sqw_idx,
+        Log_Write(LOG_LEVEL_ERROR, "SQ[%d]:TID:%u:DMAW Write Chain Failed:%d!\r\n", sqw_idx,
             cmd_info->cmd_hdr.tag_id, status);
 
         SP_Iface_Report_Error(MM_RECOVERABLE_FW_MM_DMAW_ERROR, MM_DMA_WRITE_CONFIG_ERROR);
@@ -652,6 +1488,8 @@ static inline void process_dma_read_chan_in_use(dma_read_chan_id_e read_chan)
     {
         uint64_t exec_duration;
         uint32_t rsp_status;
+        uint8_t stripe_mask;
+        uint8_t leader;
 
         /* Read the channel status from CB */
         read_chan_status.raw_u64 =
@@ -674,31 +1512,39 @@ static inline void process_dma_read_chan_in_use(dma_read_chan_id_e read_chan)
                 read_chan_status.tag_id);
         }
 
+        /* Wait for the other stripes of the transfer, the leader channel holds its attributes */
+        if (!dmaw_complete_stripe(DMAW_Read_CB.chan_status_cb, read_chan, rsp_status, &leader))
+        {
+            return;
+        }
+        rsp_status = atomic_load_local_32(&DMAW_Read_CB.chan_status_cb[leader].stripe_rsp_status);
+        stripe_mask = atomic_load_local_8(&DMAW_Read_CB.chan_status_cb[leader].stripe_mask);
+
         Log_Write(LOG_LEVEL_DEBUG, "SQ[%d] DMAW: Read Tag ID:%d Chan ID:%d \r\n",
             read_chan_status.sqw_idx, read_chan_status.tag_id, read_chan);
         /* Obtain wait latency, start cycles measured
         for the command and obtain current cycles */
         dma_rd_cycles.cmd_start_cycles = atomic_load_local_64(
-            &DMAW_Read_CB.chan_status_cb[read_chan].dmaw_cycles.cmd_start_cycles);
+            &DMAW_Read_CB.chan_status_cb[leader].dmaw_cycles.cmd_start_cycles);
         dma_rd_cycles.exec_start_cycles = atomic_load_local_64(
-            &DMAW_Read_CB.chan_status_cb[read_chan].dmaw_cycles.exec_start_cycles);
+            &DMAW_Read_CB.chan_status_cb[leader].dmaw_cycles.exec_start_cycles);
         dma_rd_cycles.wait_cycles =
-            atomic_load_local_64(&DMAW_Read_CB.chan_status_cb[read_chan].dmaw_cycles.wait_cycles);
-        transfer_size = atomic_load_local_64(&DMAW_Read_CB.chan_status_cb[read_chan].transfer_size);
+            atomic_load_local_64(&DMAW_Read_CB.chan_status_cb[leader].dmaw_cycles.wait_cycles);
+        transfer_size = atomic_load_local_64(&DMAW_Read_CB.chan_status_cb[leader].transfer_size);
 
         /* Read the response ID */
-        uint16_t rsp_id = atomic_load_local_16(&DMAW_Read_CB.chan_status_cb[read_chan].rsp_id);
+        uint16_t rsp_id = atomic_load_local_16(&DMAW_Read_CB.chan_status_cb[leader].rsp_id);
 
         /* Update global DMA channel status
         NOTE: Channel state must be made idle once all resources are read */
-        atomic_store_local_32(
-            &DMAW_Read_CB.chan_status_cb[read_chan].status.channel_state, DMA_CHAN_STATE_IDLE);
+        dmaw_release_stripe_chans(DMAW_Read_CB.chan_status_cb, stripe_mask);
 
         /* Decrement the commands count being processed by the
         given SQW. Should be done after clearing channel state */
         SQW_Decrement_Command_Count(read_chan_status.sqw_idx);
 
-        if (rsp_id == DEV_OPS_API_MID_DEVICE_OPS_DMA_WRITELIST_RSP)
+        if ((rsp_id == DEV_OPS_API_MID_DEVICE_OPS_DMA_WRITELIST_RSP) ||
+        (rsp_id == DEV_OPS_API_MID_DEVICE_OPS_DMA_CHAIN_RSP))
         {
             struct device_ops_dma_writelist_rsp_t writelist_rsp;
 
@@ -717,8 +1563,8 @@ static inline void process_dma_read_chan_in_use(dma_read_chan_id_e read_chan)
             Log_Write(LOG_LEVEL_DEBUG, "DMAW:Pushing:DMA_WRITELIST_CMD_RSP:tag_id=%x->Host_CQ\r\n",
                 writelist_rsp.response_info.rsp_hdr.tag_id);
 
-            status = Host_Iface_CQ_Push_Cmd(
-                0, &writelist_rsp, sizeof(struct device_ops_dma_writelist_rsp_t));
+            status = Host_Iface_CQ_Push_Cmd(MM_CQ_FOR_SQ(read_chan_status.sqw_idx),
+                &writelist_rsp, sizeof(struct device_ops_dma_writelist_rsp_t));
         }
         else
         {
@@ -740,14 +1586,13 @@ static inline void process_dma_read_chan_in_use(dma_read_chan_id_e read_chan)
                 "DMAW:Pushing:P2PDMA_WRITELIST_CMD_RSP:tag_id=%x->Host_CQ\r\n",
                 p2p_writelist_rsp.response_info.rsp_hdr.tag_id);
 
-            status = Host_Iface_CQ_Push_Cmd(
-                0, &p2p_writelist_rsp, sizeof(struct device_ops_p2pdma_writelist_rsp_t));
+            status = Host_Iface_CQ_Push_Cmd(MM_CQ_FOR_SQ(read_chan_status.sqw_idx),
+                &p2p_writelist_rsp, sizeof(struct device_ops_p2pdma_writelist_rsp_t));
         }
 
         /* Accumulate DMA execution cycles. Any previous exceution cycles will be
         deducted from total transaction cycles and previous execution cycles will be reset. */
-        atomic_add_local_64(
-            &DMAW_Read_CB.chan_status_cb[read_chan].dma_trans_cycles, exec_duration);
+        dmaw_add_stripe_trans_cycles(DMAW_Read_CB.chan_status_cb, stripe_mask, exec_duration);
 
         /* Calculate and log the DMA BW */
         STATW_Add_New_Sample_Atomically(
@@ -819,6 +1664,8 @@ static inline void process_dma_read_chan_aborting(
     uint32_t abort_rsp_status;
     int32_t status = STATUS_SUCCESS;
     int32_t dma_status = STATUS_SUCCESS;
+    uint8_t stripe_mask;
+    uint8_t leader;
 
     if (!channel_aborted[read_chan])
     {
@@ -859,43 +1706,52 @@ static inline void process_dma_read_chan_aborting(
         status = DMAW_ERROR_DRIVER_ABORT_FAILED;
     }
 
+    if (status == DMAW_ERROR_DRIVER_ABORT_FAILED)
+    {
+        abort_rsp_status = DEV_OPS_API_DMA_RESPONSE_DRIVER_ABORT_FAILED;
+    }
+    else
+    {
+        abort_rsp_status = DEV_OPS_API_DMA_RESPONSE_HOST_ABORTED;
+    }
+
+    /* Wait for the other stripes of the transfer, the leader channel holds its attributes */
+    if (!dmaw_complete_stripe(DMAW_Read_CB.chan_status_cb, read_chan, abort_rsp_status, &leader))
+    {
+        return;
+    }
+    abort_rsp_status =
+        atomic_load_local_32(&DMAW_Read_CB.chan_status_cb[leader].stripe_rsp_status);
+    stripe_mask = atomic_load_local_8(&DMAW_Read_CB.chan_status_cb[leader].stripe_mask);
+
     /* Read the channel status from CB */
     read_chan_status.raw_u64 =
-        atomic_load_local_64(&DMAW_Read_CB.chan_status_cb[read_chan].status.raw_u64);
+        atomic_load_local_64(&DMAW_Read_CB.chan_status_cb[leader].status.raw_u64);
 
     /* Obtain wait latency, start cycles measured for the command
     and obtain current cycles */
     dma_read_cycles.cmd_start_cycles =
-        atomic_load_local_64(&DMAW_Read_CB.chan_status_cb[read_chan].dmaw_cycles.cmd_start_cycles);
+        atomic_load_local_64(&DMAW_Read_CB.chan_status_cb[leader].dmaw_cycles.cmd_start_cycles);
     dma_read_cycles.exec_start_cycles =
-        atomic_load_local_64(&DMAW_Read_CB.chan_status_cb[read_chan].dmaw_cycles.exec_start_cycles);
+        atomic_load_local_64(&DMAW_Read_CB.chan_status_cb[leader].dmaw_cycles.exec_start_cycles);
     dma_read_cycles.wait_cycles =
-        atomic_load_local_64(&DMAW_Read_CB.chan_status_cb[read_chan].dmaw_cycles.wait_cycles);
+        atomic_load_local_64(&DMAW_Read_CB.chan_status_cb[leader].dmaw_cycles.wait_cycles);
     abort_transfer_size =
-        atomic_load_local_64(&DMAW_Read_CB.chan_status_cb[read_chan].transfer_size);
+        atomic_load_local_64(&DMAW_Read_CB.chan_status_cb[leader].transfer_size);
 
     /* Read the response ID */
-    uint16_t rsp_id = atomic_load_local_16(&DMAW_Read_CB.chan_status_cb[read_chan].rsp_id);
+    uint16_t rsp_id = atomic_load_local_16(&DMAW_Read_CB.chan_status_cb[leader].rsp_id);
 
     /* Update global DMA channel status
     NOTE: Channel state must be made idle once all resources are read */
-    atomic_store_local_32(
-        &DMAW_Read_CB.chan_status_cb[read_chan].status.channel_state, DMA_CHAN_STATE_IDLE);
+    dmaw_release_stripe_chans(DMAW_Read_CB.chan_status_cb, stripe_mask);
 
     /* Decrement the commands count being processed by the
     given SQW. Should be done after clearing channel state */
     SQW_Decrement_Command_Count(read_chan_status.sqw_idx);
 
-    if (status == DMAW_ERROR_DRIVER_ABORT_FAILED)
-    {
-        abort_rsp_status = DEV_OPS_API_DMA_RESPONSE_DRIVER_ABORT_FAILED;
-    }
-    else
-    {
-        abort_rsp_status = DEV_OPS_API_DMA_RESPONSE_HOST_ABORTED;
-    }
-
-    if (rsp_id == DEV_OPS_API_MID_DEVICE_OPS_DMA_WRITELIST_RSP)
+    if ((rsp_id == DEV_OPS_API_MID_DEVICE_OPS_DMA_WRITELIST_RSP) ||
+        (rsp_id == DEV_OPS_API_MID_DEVICE_OPS_DMA_CHAIN_RSP))
     {
         struct device_ops_dma_writelist_rsp_t abort_writelist_rsp;
 
@@ -911,8 +1767,8 @@ static inline void process_dma_read_chan_aborting(
         abort_exec_duration = PMC_GET_LATENCY(dma_read_cycles.exec_start_cycles);
         abort_writelist_rsp.device_cmd_execute_dur = abort_exec_duration;
 
-        status = Host_Iface_CQ_Push_Cmd(
-            0, &abort_writelist_rsp, sizeof(struct device_ops_dma_writelist_rsp_t));
+        status = Host_Iface_CQ_Push_Cmd(MM_CQ_FOR_SQ(read_chan_status.sqw_idx),
+            &abort_writelist_rsp, sizeof(struct device_ops_dma_writelist_rsp_t));
     }
     else
     {
@@ -930,14 +1786,13 @@ static inline void process_dma_read_chan_aborting(
         abort_exec_duration = PMC_GET_LATENCY(dma_read_cycles.exec_start_cycles);
         abort_p2p_rsp.device_cmd_execute_dur = abort_exec_duration;
 
-        status = Host_Iface_CQ_Push_Cmd(
-            0, &abort_p2p_rsp, sizeof(struct device_ops_p2pdma_writelist_rsp_t));
+        status = Host_Iface_CQ_Push_Cmd(MM_CQ_FOR_SQ(read_chan_status.sqw_idx),
+            &abort_p2p_rsp, sizeof(struct device_ops_p2pdma_writelist_rsp_t));
     }
 
     /* Accumulate DMA execution cycles. Any previous exceution cycles will be
     deducted from total transaction cycles and previous execution cycles will be reset. */
-    atomic_add_local_64(
-        &DMAW_Read_CB.chan_status_cb[read_chan].dma_trans_cycles, abort_exec_duration);
+    dmaw_add_stripe_trans_cycles(DMAW_Read_CB.chan_status_cb, stripe_mask, abort_exec_duration);
 
     /* Calculate and log the DMA BW */
     /* TODO: In case of abort, read the actual number of bytes transferred from DMA engine instead of total transfer size */
@@ -1008,6 +1863,8 @@ static inline void process_dma_write_chan_in_use(dma_write_chan_id_e write_chan)
     {
         uint64_t exec_duration;
         uint32_t rsp_status;
+        uint8_t stripe_mask;
+        uint8_t leader;
 
         /* Read the channel status from CB */
         write_chan_status.raw_u64 =
@@ -1030,32 +1887,40 @@ static inline void process_dma_write_chan_in_use(dma_write_chan_id_e write_chan)
                 write_chan_status.tag_id);
         }
 
+        /* Wait for the other stripes of the transfer, the leader channel holds its attributes */
+        if (!dmaw_complete_stripe(DMAW_Write_CB.chan_status_cb, write_chan, rsp_status, &leader))
+        {
+            return;
+        }
+        rsp_status = atomic_load_local_32(&DMAW_Write_CB.chan_status_cb[leader].stripe_rsp_status);
+        stripe_mask = atomic_load_local_8(&DMAW_Write_CB.chan_status_cb[leader].stripe_mask);
+
         Log_Write(LOG_LEVEL_DEBUG, "SQ[%d] DMAW: Write Tag ID:%d Chan ID:%d \r\n",
             write_chan_status.sqw_idx, write_chan_status.tag_id, write_chan);
         /* Obtain wait latency, start cycles measured
         for the command and obtain current cycles */
         dma_write_cycles.cmd_start_cycles = atomic_load_local_64(
-            &DMAW_Write_CB.chan_status_cb[write_chan].dmaw_cycles.cmd_start_cycles);
+            &DMAW_Write_CB.chan_status_cb[leader].dmaw_cycles.cmd_start_cycles);
         dma_write_cycles.exec_start_cycles = atomic_load_local_64(
-            &DMAW_Write_CB.chan_status_cb[write_chan].dmaw_cycles.exec_start_cycles);
+            &DMAW_Write_CB.chan_status_cb[leader].dmaw_cycles.exec_start_cycles);
         dma_write_cycles.wait_cycles =
-            atomic_load_local_64(&DMAW_Write_CB.chan_status_cb[write_chan].dmaw_cycles.wait_cycles);
+            atomic_load_local_64(&DMAW_Write_CB.chan_status_cb[leader].dmaw_cycles.wait_cycles);
         transfer_size =
-            atomic_load_local_64(&DMAW_Write_CB.chan_status_cb[write_chan].transfer_size);
+            atomic_load_local_64(&DMAW_Write_CB.chan_status_cb[leader].transfer_size);
 
         /* Read the response ID */
-        uint16_t rsp_id = atomic_load_local_16(&DMAW_Write_CB.chan_status_cb[write_chan].rsp_id);
+        uint16_t rsp_id = atomic_load_local_16(&DMAW_Write_CB.chan_status_cb[leader].rsp_id);
 
         /* Update global DMA channel status
         NOTE: Channel state must be made idle once all resources are read */
-        atomic_store_local_32(
-            &DMAW_Write_CB.chan_status_cb[write_chan].status.channel_state, DMA_CHAN_STATE_IDLE);
+        dmaw_release_stripe_chans(DMAW_Write_CB.chan_status_cb, stripe_mask);
 
         /* Decrement the commands count being processed by the
         given SQW. Should be done after clearing channel state */
         SQW_Decrement_Command_Count(write_chan_status.sqw_idx);
 
-        if (rsp_id == DEV_OPS_API_MID_DEVICE_OPS_DMA_READLIST_RSP)
+        if ((rsp_id == DEV_OPS_API_MID_DEVICE_OPS_DMA_READLIST_RSP) ||
+        (rsp_id == DEV_OPS_API_MID_DEVICE_OPS_DMA_CHAIN_RSP))
         {
             struct device_ops_dma_readlist_rsp_t readlist_rsp;
 
@@ -1071,8 +1936,8 @@ static inline void process_dma_write_chan_in_use(dma_write_chan_id_e write_chan)
             exec_duration = PMC_GET_LATENCY(dma_write_cycles.exec_start_cycles);
             readlist_rsp.device_cmd_execute_dur = exec_duration;
 
-            status = Host_Iface_CQ_Push_Cmd(
-                0, &readlist_rsp, sizeof(struct device_ops_dma_readlist_rsp_t));
+            status = Host_Iface_CQ_Push_Cmd(MM_CQ_FOR_SQ(write_chan_status.sqw_idx),
+                &readlist_rsp, sizeof(struct device_ops_dma_readlist_rsp_t));
         }
         else
         {
@@ -1090,14 +1955,13 @@ static inline void process_dma_write_chan_in_use(dma_write_chan_id_e write_chan)
             exec_duration = PMC_GET_LATENCY(dma_write_cycles.exec_start_cycles);
             p2p_readlist_rsp.device_cmd_execute_dur = exec_duration;
 
-            status = Host_Iface_CQ_Push_Cmd(
-                0, &p2p_readlist_rsp, sizeof(struct device_ops_p2pdma_readlist_rsp_t));
+            status = Host_Iface_CQ_Push_Cmd(MM_CQ_FOR_SQ(write_chan_status.sqw_idx),
+                &p2p_readlist_rsp, sizeof(struct device_ops_p2pdma_readlist_rsp_t));
         }
 
         /* Accumulate DMA execution cycles. Any previous exceution cycles will be
         deducted from total transaction cycles and previous execution cycles will be reset. */
-        atomic_add_local_64(
-            &DMAW_Write_CB.chan_status_cb[write_chan].dma_trans_cycles, exec_duration);
+        dmaw_add_stripe_trans_cycles(DMAW_Write_CB.chan_status_cb, stripe_mask, exec_duration);
 
         /* Calculate and log the DMA BW */
         STATW_Add_New_Sample_Atomically(
@@ -1172,6 +2036,8 @@ static inline void process_dma_write_chan_aborting(
     uint32_t dma_write_status;
     int32_t status = STATUS_SUCCESS;
     int32_t dma_status = STATUS_SUCCESS;
+    uint8_t stripe_mask;
+    uint8_t leader;
 
     if (!channel_aborted[write_chan])
     {
@@ -1212,43 +2078,52 @@ static inline void process_dma_write_chan_aborting(
         status = DMAW_ERROR_DRIVER_ABORT_FAILED;
     }
 
+    if (status == DMAW_ERROR_DRIVER_ABORT_FAILED)
+    {
+        abort_rsp_status = DEV_OPS_API_DMA_RESPONSE_DRIVER_ABORT_FAILED;
+    }
+    else
+    {
+        abort_rsp_status = DEV_OPS_API_DMA_RESPONSE_HOST_ABORTED;
+    }
+
+    /* Wait for the other stripes of the transfer, the leader channel holds its attributes */
+    if (!dmaw_complete_stripe(DMAW_Write_CB.chan_status_cb, write_chan, abort_rsp_status, &leader))
+    {
+        return;
+    }
+    abort_rsp_status =
+        atomic_load_local_32(&DMAW_Write_CB.chan_status_cb[leader].stripe_rsp_status);
+    stripe_mask = atomic_load_local_8(&DMAW_Write_CB.chan_status_cb[leader].stripe_mask);
+
     /* Read the channel status from CB */
     write_chan_status.raw_u64 =
-        atomic_load_local_64(&DMAW_Write_CB.chan_status_cb[write_chan].status.raw_u64);
+        atomic_load_local_64(&DMAW_Write_CB.chan_status_cb[leader].status.raw_u64);
 
     /* Obtain wait latency, start cycles measured for the command
     and obtain current cycles */
     dma_write_cycles.cmd_start_cycles = atomic_load_local_64(
-        &DMAW_Write_CB.chan_status_cb[write_chan].dmaw_cycles.cmd_start_cycles);
+        &DMAW_Write_CB.chan_status_cb[leader].dmaw_cycles.cmd_start_cycles);
     dma_write_cycles.exec_start_cycles = atomic_load_local_64(
-        &DMAW_Write_CB.chan_status_cb[write_chan].dmaw_cycles.exec_start_cycles);
+        &DMAW_Write_CB.chan_status_cb[leader].dmaw_cycles.exec_start_cycles);
     dma_write_cycles.wait_cycles =
-        atomic_load_local_64(&DMAW_Write_CB.chan_status_cb[write_chan].dmaw_cycles.wait_cycles);
+        atomic_load_local_64(&DMAW_Write_CB.chan_status_cb[leader].dmaw_cycles.wait_cycles);
     abort_transfer_size =
-        atomic_load_local_64(&DMAW_Write_CB.chan_status_cb[write_chan].transfer_size);
+        atomic_load_local_64(&DMAW_Write_CB.chan_status_cb[leader].transfer_size);
 
     /* Read the response ID */
-    uint16_t rsp_id = atomic_load_local_16(&DMAW_Write_CB.chan_status_cb[write_chan].rsp_id);
+    uint16_t rsp_id = atomic_load_local_16(&DMAW_Write_CB.chan_status_cb[leader].rsp_id);
 
     /* Update global DMA channel status
     NOTE: Channel state must be made idle once all resources are read */
-    atomic_store_local_32(
-        &DMAW_Write_CB.chan_status_cb[write_chan].status.channel_state, DMA_CHAN_STATE_IDLE);
+    dmaw_release_stripe_chans(DMAW_Write_CB.chan_status_cb, stripe_mask);
 
     /* Decrement the commands count being processed by the
     given SQW. Should be done after clearing channel state */
     SQW_Decrement_Command_Count(write_chan_status.sqw_idx);
 
-    if (status == DMAW_ERROR_DRIVER_ABORT_FAILED)
-    {
-        abort_rsp_status = DEV_OPS_API_DMA_RESPONSE_DRIVER_ABORT_FAILED;
-    }
-    else
-    {
-        abort_rsp_status = DEV_OPS_API_DMA_RESPONSE_HOST_ABORTED;
-    }
-
-    if (rsp_id == DEV_OPS_API_MID_DEVICE_OPS_DMA_READLIST_RSP)
+    if ((rsp_id == DEV_OPS_API_MID_DEVICE_OPS_DMA_READLIST_RSP) ||
+        (rsp_id == DEV_OPS_API_MID_DEVICE_OPS_DMA_CHAIN_RSP))
     {
         struct device_ops_dma_readlist_rsp_t abort_readlist_rsp;
 
@@ -1264,8 +2139,8 @@ static inline void process_dma_write_chan_aborting(
         abort_exec_duration = PMC_GET_LATENCY(dma_write_cycles.exec_start_cycles);
         abort_readlist_rsp.device_cmd_execute_dur = abort_exec_duration;
 
-        status = Host_Iface_CQ_Push_Cmd(
-            0, &abort_readlist_rsp, sizeof(struct device_ops_dma_readlist_rsp_t));
+        status = Host_Iface_CQ_Push_Cmd(MM_CQ_FOR_SQ(write_chan_status.sqw_idx),
+            &abort_readlist_rsp, sizeof(struct device_ops_dma_readlist_rsp_t));
     }
     else
     {
@@ -1283,14 +2158,13 @@ static inline void process_dma_write_chan_aborting(
         abort_exec_duration = PMC_GET_LATENCY(dma_write_cycles.exec_start_cycles);
         abort_p2p_rsp.device_cmd_execute_dur = abort_exec_duration;
 
-        status = Host_Iface_CQ_Push_Cmd(
-            0, &abort_p2p_rsp, sizeof(struct device_ops_p2pdma_readlist_rsp_t));
+        status = Host_Iface_CQ_Push_Cmd(MM_CQ_FOR_SQ(write_chan_status.sqw_idx),
+            &abort_p2p_rsp, sizeof(struct device_ops_p2pdma_readlist_rsp_t));
     }
 
     /* Accumulate DMA execution cycles. Any previous exceution cycles will be
     deducted from total transaction cycles and previous execution cycles will be reset. */
-    atomic_add_local_64(
-        &DMAW_Write_CB.chan_status_cb[write_chan].dma_trans_cycles, abort_exec_duration);
+    dmaw_add_stripe_trans_cycles(DMAW_Write_CB.chan_status_cb, stripe_mask, abort_exec_duration);
 
     /* Calculate and log the DMA BW */
     /* TODO: In case of abort, read the actual number of bytes transferred from DMA engine instead of total transfer size */
@@ -1325,25 +2199,29 @@ static inline void process_dma_write_chan_aborting(
 *
 *   DESCRIPTION
 *
-*       Launch a DMA Worker on HART ID requested
+*       Launch a DMA Worker on HART ID requested. It polls the read
+*       channels assigned to it: one every DMAW_NUM_PER_DIRECTION.
 *
 *   INPUTS
 *
 *       uint32_t   HART ID to launch the DMA Worker
+*       uint8_t    Index of the worker among the read DMA workers
 *
 *   OUTPUTS
 *
 *       None
 *
 ***********************************************************************/
-__attribute__((noreturn)) static inline void dmaw_launch_read_worker(uint32_t hart_id)
+__attribute__((noreturn)) static inline void dmaw_launch_read_worker(
+    uint32_t hart_id, uint8_t worker_idx)
 {
     uint32_t read_chan_state;
     bool channel_aborted[PCIE_DMA_RD_CHANNEL_COUNT] = { false, false, false, false };
 
     while (1)
     {
-        for (uint8_t read_ch_index = 0; read_ch_index < PCIE_DMA_RD_CHANNEL_COUNT; read_ch_index++)
+        for (uint8_t read_ch_index = worker_idx; read_ch_index < PCIE_DMA_RD_CHANNEL_COUNT;
+             read_ch_index += DMAW_NUM_PER_DIRECTION)
         {
             read_chan_state = atomic_load_local_32(
                 &DMAW_Read_CB.chan_status_cb[read_ch_index].status.channel_state);
@@ -1376,26 +2254,29 @@ __attribute__((noreturn)) static inline void dmaw_launch_read_worker(uint32_t ha
 *
 *   DESCRIPTION
 *
-*       Launch a DMA Worker on HART ID requested
+*       Launch a DMA Worker on HART ID requested. It polls the write
+*       channels assigned to it: one every DMAW_NUM_PER_DIRECTION.
 *
 *   INPUTS
 *
 *       uint32_t   HART ID to launch the DMA Worker
+*       uint8_t    Index of the worker among the write DMA workers
 *
 *   OUTPUTS
 *
 *       None
 *
 ***********************************************************************/
-__attribute__((noreturn)) static inline void dmaw_launch_write_worker(uint32_t hart_id)
+__attribute__((noreturn)) static inline void dmaw_launch_write_worker(
+    uint32_t hart_id, uint8_t worker_idx)
 {
     uint32_t write_chan_state;
     bool channel_aborted[PCIE_DMA_WRT_CHANNEL_COUNT] = { false, false, false, false };
 
     while (1)
     {
-        for (uint8_t write_ch_index = 0; write_ch_index < PCIE_DMA_WRT_CHANNEL_COUNT;
-             write_ch_index++)
+        for (uint8_t write_ch_index = worker_idx; write_ch_index < PCIE_DMA_WRT_CHANNEL_COUNT;
+             write_ch_index += DMAW_NUM_PER_DIRECTION)
         {
             write_chan_state = atomic_load_local_32(
                 &DMAW_Write_CB.chan_status_cb[write_ch_index].status.channel_state);
@@ -1440,6 +2321,7 @@ __attribute__((noreturn)) static inline void dmaw_launch_write_worker(uint32_t h
 void DMAW_Launch(uint32_t hart_id)
 {
     uint8_t dma_chan_id;
+    uint8_t worker_idx;
 
     Log_Write(LOG_LEVEL_INFO, "DMAW:H%d\r\n", hart_id);
 
@@ -1448,31 +2330,39 @@ void DMAW_Launch(uint32_t hart_id)
     data from host to device, similarly a read command from host will
     trigger the implementation to configure a DMA write channel on device
     to move data from device to host */
-    if (hart_id == DMAW_FOR_READ)
+    if ((hart_id >= DMAW_FOR_READ) && (hart_id < DMAW_FOR_WRITE))
     {
-        /* Enable the DMA read engine */
+        worker_idx = (uint8_t)((hart_id - DMAW_FOR_READ) / HARTS_PER_MINION);
+
+        /* Enable the DMA read engine, each worker sets the same enable bit */
         dma_enable_read_engine();
 
-        for (dma_chan_id = DMA_CHAN_ID_READ_0; dma_chan_id <= DMA_CHAN_ID_READ_3; dma_chan_id++)
+        /* Configure the channels polled by this worker */
+        for (dma_chan_id = worker_idx; dma_chan_id <= DMA_CHAN_ID_READ_3;
+             dma_chan_id += DMAW_NUM_PER_DIRECTION)
         {
             dma_configure_read(dma_chan_id);
         }
 
         /* Launch DMA read worker, this function never returns. */
-        dmaw_launch_read_worker(hart_id);
+        dmaw_launch_read_worker(hart_id, worker_idx);
     }
-    else if (hart_id == DMAW_FOR_WRITE)
+    else if ((hart_id >= DMAW_FOR_WRITE) && (hart_id < DMAW_MAX_HART_ID))
     {
-        /* Enable the DMA write engine */
+        worker_idx = (uint8_t)((hart_id - DMAW_FOR_WRITE) / HARTS_PER_MINION);
+
+        /* Enable the DMA write engine, each worker sets the same enable bit */
         dma_enable_write_engine();
 
-        for (dma_chan_id = DMA_CHAN_ID_WRITE_0; dma_chan_id <= DMA_CHAN_ID_WRITE_3; dma_chan_id++)
+        /* Configure the channels polled by this worker */
+        for (dma_chan_id = worker_idx; dma_chan_id <= DMA_CHAN_ID_WRITE_3;
+             dma_chan_id += DMAW_NUM_PER_DIRECTION)
         {
             dma_configure_write(dma_chan_id);
         }
 
-        /* Launch DMA read worker, this function never returns. */
-        dmaw_launch_write_worker(hart_id);
+        /* Launch DMA write worker, this function never returns. */
+        dmaw_launch_write_worker(hart_id, worker_idx);
     }
     else
     {
@@ -1499,6 +2389,8 @@ void DMAW_Launch(uint32_t hart_id)
 *       chan_type           DMA channel type read/write
 *       interval_start      start cycles of sampling interval
 *       interval_end        end cycles of sampling interval
+*       chan_cycles         optional, returns consumed cycles of each
+*                           channel of the type
 *
 *   OUTPUTS
 *
@@ -1506,8 +2398,8 @@ void DMAW_Launch(uint32_t hart_id)
 *
 ***********************************************************************/
 
-uint64_t DMAW_Get_Average_Exec_Cycles(
-    dma_chan_type_e chan_type, uint64_t interval_start, uint64_t interval_end)
+uint64_t DMAW_Get_Average_Exec_Cycles(dma_chan_type_e chan_type, uint64_t interval_start,
+    uint64_t interval_end, uint64_t *chan_cycles)
 {
     uint64_t accum_cycles = 0;
     uint8_t active_channel = 0;
@@ -1535,6 +2427,13 @@ uint64_t DMAW_Get_Average_Exec_Cycles(
 
     for (int chan = 0; chan < dma_chan_count; chan++)
     {
+        uint64_t prev_accum_cycles = accum_cycles;
+
+        if (chan_cycles != NULL)
+        {
+            chan_cycles[chan] = 0;
+        }
+
         /* get execution start cycles and dma transaction cycles to calculate execution end cycles.
         this will help identifying dma transaction boundries within sampling interval. */
         exec_start_cycles = atomic_load_local_64(&chan_cb[chan].dmaw_cycles.exec_start_cycles);
@@ -1661,6 +2560,11 @@ uint64_t DMAW_Get_Average_Exec_Cycles(
                 active_channel++;
             }
         }
+
+        if (chan_cycles != NULL)
+        {
+            chan_cycles[chan] = accum_cycles - prev_accum_cycles;
+        }
     }
 
     return (active_channel > 0 ? (accum_cycles / (uint64_t)active_channel) : accum_cycles);
@@ -23,6 +23,14 @@
         KW_Dispatch_Kernel_Abort_Cmd
         KW_Abort_All_Dispatched_Kernels
         KW_Get_Average_Exec_Cycles
+        KW_Set_Kernel_Heap
+        KW_Set_Kernel_Flush_Ranges
+        KW_Set_Kernel_Shire_Args
+        KW_Set_Kernel_Watchdog
+        KW_Get_Kernel_Power_Report
+        KW_Reserve_Multi_Launch
+        KW_Notify_Multi_Launch_Entry
+        KW_Complete_Multi_Launch_Entry
 */
 /***********************************************************************/
 /* mm_rt_svcs */
@@ -86,20 +94,20 @@
         }                                                                              \
     }
 
-/*! \def KERNEL_SAVE_UMODE_TRACE_PTR(kernel, cmd)
+/*! \def KERNEL_SAVE_UMODE_TRACE_PTR(kernel, slot, cmd)
     \brief Macro used to save user mode trace pointer in KW CB.
 */
-#define KW_SAVE_UMODE_TRACE_PTR(kernel, cmd)                                                   \
-    {                                                                                          \
-        if (cmd->command_info.cmd_hdr.flags & CMD_FLAGS_COMPUTE_KERNEL_TRACE_ENABLE)           \
-        {                                                                                      \
-            atomic_store_local_64(&kernel->umode_trace_buffer_ptr,                             \
-                ((struct trace_init_info_t *)(uintptr_t)CM_UMODE_TRACE_CFG_BASEADDR)->buffer); \
-        }                                                                                      \
-        else                                                                                   \
-        {                                                                                      \
-            atomic_store_local_64(&kernel->umode_trace_buffer_ptr, 0);                         \
-        }                                                                                      \
+#define KW_SAVE_UMODE_TRACE_PTR(kernel, slot, cmd)                                                   \
+    {                                                                                                \
+        if (cmd->command_info.cmd_hdr.flags & CMD_FLAGS_COMPUTE_KERNEL_TRACE_ENABLE)                 \
+        {                                                                                            \
+            atomic_store_local_64(&kernel->umode_trace_buffer_ptr,                                   \
+                ((struct trace_init_info_t *)(uintptr_t)CM_UMODE_TRACE_CFG_SLOT_ADDR(slot))->buffer); \
+        }                                                                                            \
+        else                                                                                         \
+        {                                                                                            \
+            atomic_store_local_64(&kernel->umode_trace_buffer_ptr, 0);                               \
+        }                                                                                            \
     }
 
 #define KW_REGISTER_CM_ABORT_TIMER(kw_abort_timer, kw_idx, status)                                    \
@@ -130,17 +138,28 @@
 
 #define KW_COPY_CM_UMODE_TRACE_CFG_OPTIONALLY(slot, kernel_cmd)                                    \
     {                                                                                              \
-        /* TODO: SW-16477: make the CM U-mode trace cfg per slot */                                \
+        /* Each kernel slot has its own CM U-mode trace cfg */                                     \
         if (kernel_cmd->command_info.cmd_hdr.flags & CMD_FLAGS_COMPUTE_KERNEL_TRACE_ENABLE)        \
         {                                                                                          \
             /* Copy the Trace config from command payload to provided address */                   \
             /* NOTE: Trace config is always present at the begining of payload with fixed size. */ \
-            ETSOC_MEM_COPY_AND_EVICT((void *)(uintptr_t)CM_UMODE_TRACE_CFG_BASEADDR,               \
+            ETSOC_MEM_COPY_AND_EVICT((void *)(uintptr_t)CM_UMODE_TRACE_CFG_SLOT_ADDR(slot),        \
                 (void *)(uintptr_t)kernel_cmd->argument_payload, sizeof(struct trace_init_info_t), \
                 to_L3)                                                                             \
         }                                                                                          \
     }
 
+/*! \def KW_MULTI_LAUNCH_NONE
+    \brief Multi-launch group index of a kernel launched on its own.
+*/
+#define KW_MULTI_LAUNCH_NONE 0xFFU
+
+/*! \def KW_MULTI_LAUNCH_GROUPS
+    \brief Number of multi-launch groups. Each SQW dispatches a single group at
+    a time, and every other group in use has at least a kernel slot running.
+*/
+#define KW_MULTI_LAUNCH_GROUPS (MM_MAX_PARALLEL_KERNELS + SQW_NUM)
+
 /*! \typedef kernel_instance_t
     \brief Kernel Instance Control Block structure.
     Kernel instance maintains information related to
@@ -155,11 +174,57 @@ typedef struct kernel_instance_ {
     uint64_t umode_exception_buffer_ptr;
     uint64_t umode_trace_buffer_ptr;
     uint32_t kernel_state;
+    uint32_t watchdog_timeout; /* SW ticks before the kernel shires are aborted, 0 if none */
     tag_id_t launch_tag_id;
     uint8_t sqw_idx;
     uint8_t cm_abort_wait_timeout_flag;
+    uint8_t watchdog_expired_flag;
+    uint8_t host_abort_flag;    /* Set by host aborts, even if the watchdog aborted it first */
+    uint8_t multi_launch_idx;   /* KW_MULTI_LAUNCH_NONE if launched on its own */
+    uint8_t multi_launch_entry; /* Index of the kernel in the multi-launch command */
 } kernel_instance_t;
 
+/*! \def KW_POWER_REPORTS_PER_SQW
+    \brief Power reports kept per SQW, one for each kernel of the SQW that can run at once.
+*/
+#define KW_POWER_REPORTS_PER_SQW MM_MAX_PARALLEL_KERNELS
+
+/*! \typedef kw_power_report_t
+    \brief Frequency and throttle events seen by a kernel completed from a SQW,
+    see KW_Get_Kernel_Power_Report.
+*/
+typedef struct kw_power_report_ {
+    uint32_t valid;
+    uint32_t tag_id; /* Launch tag ID of the kernel */
+    uint32_t start_freq_mhz;
+    uint32_t end_freq_mhz;
+    uint32_t throttle_events;
+} kw_power_report_t;
+
+/*! \typedef kw_launch_config_t
+    \brief Launch config of the next kernel of a SQW, see KW_Set_Kernel_Launch_Config.
+*/
+typedef struct kw_launch_config_ {
+    uint32_t flags; /* KERNEL_LAUNCH_CONFIG_FLAGS_* */
+    uint16_t scp_sets;
+    uint16_t l2_sets;
+} kw_launch_config_t;
+
+/*! \typedef kw_multi_launch_t
+    \brief Kernels of a multi-launch command. The response is sent by whoever
+    completes the last of them, a KW or the SQW if it failed to be dispatched.
+*/
+typedef struct kw_multi_launch_ {
+    execution_cycles_t cycles;
+    uint64_t cm_error_shire_mask;
+    uint32_t state; /* KERNEL_STATE_UN_USED or KERNEL_STATE_IN_USE */
+    uint32_t pending;
+    uint32_t count;
+    uint32_t entry_status[MM_KERNEL_MULTI_LAUNCH_MAX];
+    uint16_t tag_id;
+    uint8_t sqw_idx;
+} kw_multi_launch_t;
+
 /*! \typedef kw_cb_t
     \brief Kernel Worker Control Block structure.
     Used to maintain kernel instance and related resources
@@ -170,9 +235,32 @@ typedef CACHE_STRUCT({
     fcc_sync_cb_t host2kw[MM_MAX_PARALLEL_KERNELS];
     spinlock_t resource_lock;
     kernel_instance_t kernels[MM_MAX_PARALLEL_KERNELS];
+    kw_multi_launch_t multi_launches[KW_MULTI_LAUNCH_GROUPS];
     uint32_t launch_wait_timeout_flag[SQW_NUM];
+    /* Flush ranges of the next kernel launched from each SQW, only accessed by the SQW */
+    cm_kernel_flush_ranges_t pending_flush_ranges[SQW_NUM];
+    /* Per shire arguments stride of the next kernel launched from each SQW, only accessed by the SQW */
+    uint32_t pending_args_shire_stride[SQW_NUM];
+    /* Watchdog timeout of the next kernel launched from each SQW, only accessed by the SQW */
+    uint32_t pending_watchdog_timeout[SQW_NUM];
+    /* Launch config of the next kernel launched from each SQW, only accessed by the SQW */
+    kw_launch_config_t pending_launch_config[SQW_NUM];
+    /* Shires a kernel of the priority SQW waits for, the other SQWs don't reserve them meanwhile.
+    Only written by the priority SQW, with the resource lock held */
+    uint64_t priority_wait_shire_mask;
+    /* Set while the priority SQW waits for a kernel slot, the other SQWs don't take one meanwhile */
+    uint32_t priority_wait_slot;
+    /* Written by the KW completing a kernel of each SQW, before its response is sent.
+    The next entry to write is power_report_next modulo KW_POWER_REPORTS_PER_SQW */
+    kw_power_report_t power_reports[SQW_NUM][KW_POWER_REPORTS_PER_SQW];
+    uint32_t power_report_next[SQW_NUM];
 }) kw_cb_t;
 
+static_assert(sizeof(cm_kernel_flush_ranges_t) == CM_KERNEL_FLUSH_RANGES_SLOT_SIZE,
+    "cm_kernel_flush_ranges_t must fill a kernel flush ranges slot");
+static_assert(MM_KERNEL_FLUSH_RANGES_MAX == CM_KERNEL_FLUSH_RANGES_MAX,
+    "The kernel flush ranges command must match the kernel flush ranges slot");
+
 /*! \struct kw_internal_status
     \brief Kernel Worker's internal status structure to
     track different types of errors.
@@ -183,6 +271,8 @@ struct kw_internal_status {
     bool kernel_done;
     bool cw_exception;
     bool cw_error;
+    bool watchdog_expired;
+    bool host_aborted;
 };
 
 /*! \var kw_cb_t KW_CB
@@ -236,6 +326,35 @@ static void kw_cm_abort_wait_timeout_callback(uint8_t kw_idx)
         MASTER_SHIRE, 0);
 }
 
+/************************************************************************
+*
+*   FUNCTION
+*
+*       kw_watchdog_timeout_callback
+*
+*   DESCRIPTION
+*
+*       Callback for the watchdog timeout of a kernel launch
+*
+*   INPUTS
+*
+*       kw_idx    Kernel worker index
+*
+*   OUTPUTS
+*
+*       None
+*
+***********************************************************************/
+static void kw_watchdog_timeout_callback(uint8_t kw_idx)
+{
+    /* Set the flag to indicate the kernel didn't complete in time */
+    atomic_store_local_8(&KW_CB.kernels[kw_idx].watchdog_expired_flag, 1);
+
+    /* Trigger IPI to KW */
+    syscall(SYSCALL_IPI_TRIGGER_INT, 1ULL << ((KW_BASE_HART_ID + (kw_idx * HARTS_PER_MINION)) % 64),
+        MASTER_SHIRE, 0);
+}
+
 /************************************************************************
 *
 *   FUNCTION
@@ -405,10 +524,19 @@ static int32_t kw_reserve_kernel_slot(
     int32_t status = STATUS_SUCCESS;
     sqw_state_e sqw_state;
     bool slot_reserved = false;
+    bool priority = (sqw_idx == MM_SQ_PRIORITY_IDX);
 
     do
     {
-        for (uint8_t i = 0; i < MM_MAX_PARALLEL_KERNELS; i++)
+        /* Kernels of the priority SQW go ahead of the ones of the other SQWs */
+        if (priority)
+        {
+            atomic_store_local_32(&KW_CB.priority_wait_slot, 1U);
+        }
+
+        for (uint8_t i = 0; (i < MM_MAX_PARALLEL_KERNELS) &&
+                            (priority || (atomic_load_local_32(&KW_CB.priority_wait_slot) == 0U));
+             i++)
         {
             /* Find unused kernel slot and reserve it */
             if (atomic_compare_and_exchange_local_32(&KW_CB.kernels[i].kernel_state,
@@ -417,12 +545,18 @@ static int32_t kw_reserve_kernel_slot(
                 *kernel = &KW_CB.kernels[i];
                 *slot_index = i;
                 slot_reserved = true;
+                break;
             }
         }
         /* Read the SQW state */
         sqw_state = SQW_Get_State(sqw_idx);
     } while (!slot_reserved && (sqw_state != SQW_STATE_ABORTED));
 
+    if (priority)
+    {
+        atomic_store_local_32(&KW_CB.priority_wait_slot, 0U);
+    }
+
     /* Verify SQW state */
     if (sqw_state == SQW_STATE_ABORTED)
     {
@@ -490,34 +624,56 @@ static int32_t kw_reserve_kernel_shires(uint8_t sqw_idx, uint16_t tag_id, uint64
 {
     int32_t status;
     sqw_state_e sqw_state;
+    bool shires_reserved = false;
+    bool priority = (sqw_idx == MM_SQ_PRIORITY_IDX);
 
-    /* Acquire the lock */
-    acquire_local_spinlock(&KW_CB.resource_lock);
-
-    /* Find and wait for the requested shire mask to get free */
+    /* Find and wait for the requested shire mask to get free.
+    The lock is only held while checking and marking the shires, so kernels
+    on disjoint shire masks can be reserved while this one waits */
     do
     {
+        /* Acquire the lock */
+        acquire_local_spinlock(&KW_CB.resource_lock);
+
         /* Check the required shires are available and ready */
         status = CW_Check_Shires_Available_And_Free(req_shire_mask);
 
         /* Read the SQW state */
         sqw_state = SQW_Get_State(sqw_idx);
-    } while ((status != STATUS_SUCCESS) && (status != CW_SHIRE_UNAVAILABLE) &&
-             (sqw_state != SQW_STATE_ABORTED));
 
-    if ((status == STATUS_SUCCESS) && (sqw_state != SQW_STATE_ABORTED))
-    {
-        /* Mark the shires as busy */
-        CW_Update_Shire_State(req_shire_mask, CW_SHIRE_STATE_BUSY);
+        /* Shires freed while a kernel of the priority SQW waits for them are kept for it */
+        if ((status == STATUS_SUCCESS) && !priority &&
+            ((req_shire_mask & atomic_load_local_64(&KW_CB.priority_wait_shire_mask)) != 0U))
+        {
+            status = CW_SHIRES_NOT_FREE;
+        }
+
+        if ((status == STATUS_SUCCESS) && (sqw_state != SQW_STATE_ABORTED))
+        {
+            /* Mark the shires as busy */
+            CW_Update_Shire_State(req_shire_mask, CW_SHIRE_STATE_BUSY);
+            shires_reserved = true;
+        }
+
+        /* The priority SQW claims the shires while waiting for them, and gives them up once
+        reserved or if it stops waiting */
+        if (priority && !shires_reserved && (status != CW_SHIRE_UNAVAILABLE) &&
+            (sqw_state != SQW_STATE_ABORTED))
+        {
+            atomic_store_local_64(&KW_CB.priority_wait_shire_mask, req_shire_mask);
+        }
+        else if (priority)
+        {
+            atomic_store_local_64(&KW_CB.priority_wait_shire_mask, 0U);
+        }
 
         /* Release the lock */
         release_local_spinlock(&KW_CB.resource_lock);
-    }
-    else
-    {
-        /* Release the lock */
-        release_local_spinlock(&KW_CB.resource_lock);
+    } while (!shires_reserved && (status != CW_SHIRE_UNAVAILABLE) &&
+             (sqw_state != SQW_STATE_ABORTED));
 
+    if (!shires_reserved)
+    {
         /* Verify SQW state */
         if (sqw_state == SQW_STATE_ABORTED)
         {
@@ -818,6 +974,90 @@ static inline int32_t process_kernel_launch_cmd_payload(uint8_t sqw_idx,
     return status;
 }
 
+/************************************************************************
+*
+*   FUNCTION
+*
+*       kw_prefetch_lines_to_l3
+*
+*   DESCRIPTION
+*
+*       Local fn helper to prefetch consecutive cache lines into L3.
+*
+*   INPUTS
+*
+*       address     Address of the first line
+*       num_lines   Number of lines to prefetch
+*
+*   OUTPUTS
+*
+*       None
+*
+***********************************************************************/
+static inline void kw_prefetch_lines_to_l3(uint64_t address, uint64_t num_lines)
+{
+    /* Each prefetch covers up to 16 lines */
+    for (uint64_t line = 0; line < num_lines; line += 16)
+    {
+        uint64_t count = ((num_lines - line) < 16) ? (num_lines - line) : 16;
+
+        prefetch_va(0, to_L3, address + (line * CACHE_LINE_SIZE), count - 1, CACHE_LINE_SIZE, 0);
+    }
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       kw_prefetch_kernel_launch
+*
+*   DESCRIPTION
+*
+*       Prefetches into L3 the kernel code at the entry point and the
+*       kernel arguments not embedded in the command, so the first accesses
+*       of the shires after the launch don't go to DRAM. It also sets the
+*       kernel launch flag for the shires to prefetch the code into their
+*       I-caches, once they have invalidated them.
+*
+*   INPUTS
+*
+*       cmd          Kernel launch command
+*       launch_args  CM kernel launch message
+*
+*   OUTPUTS
+*
+*       None
+*
+***********************************************************************/
+static void kw_prefetch_kernel_launch(
+    const struct device_ops_kernel_launch_cmd_t *cmd, mm_to_cm_message_kernel_launch_t *launch_args)
+{
+    uint64_t code_lines = 0;
+    uint64_t args_lines = 0;
+
+    /* Only prefetch lines within the host managed DRAM */
+    if (kw_check_address_bounds(
+            cmd->code_start_address + (KERNEL_LAUNCH_PREFETCH_CODE_LINES * CACHE_LINE_SIZE) - 1,
+            false))
+    {
+        code_lines = KERNEL_LAUNCH_PREFETCH_CODE_LINES;
+        launch_args->kernel.flags |= KERNEL_LAUNCH_FLAGS_PREFETCH_CODE;
+    }
+
+    if ((cmd->pointer_to_args != 0) &&
+        !(cmd->command_info.cmd_hdr.flags & CMD_FLAGS_KERNEL_LAUNCH_ARGS_EMBEDDED) &&
+        kw_check_address_bounds(
+            cmd->pointer_to_args + (KW_LAUNCH_PREFETCH_ARGS_LINES * CACHE_LINE_SIZE) - 1, false))
+    {
+        args_lines = KW_LAUNCH_PREFETCH_ARGS_LINES;
+    }
+
+    kw_prefetch_lines_to_l3(cmd->code_start_address, code_lines);
+    kw_prefetch_lines_to_l3(cmd->pointer_to_args, args_lines);
+
+    Trace_Value_u64(Trace_Get_MM_CB(), TRACE_TAG_KW_LAUNCH_PREFETCH, (code_lines << 32) | args_lines);
+}
+
 /************************************************************************
 *
 *   FUNCTION
@@ -846,6 +1086,21 @@ int32_t KW_Dispatch_Kernel_Launch_Cmd(
     mm_to_cm_message_kernel_launch_t launch_args = { 0 };
     int32_t status = KW_ERROR_KERNEL_INVALID_ADDRESS;
     uint8_t slot_index;
+    cm_kernel_flush_ranges_t flush_ranges;
+    uint32_t args_shire_stride;
+    uint32_t watchdog_timeout;
+    kw_launch_config_t launch_config;
+
+    /* Take the state set for this launch by the previous commands of the SQW, so a launch
+    failing below doesn't leave it to the next kernel of the SQW */
+    flush_ranges = KW_CB.pending_flush_ranges[sqw_idx];
+    KW_CB.pending_flush_ranges[sqw_idx].count = 0U;
+    args_shire_stride = KW_CB.pending_args_shire_stride[sqw_idx];
+    KW_CB.pending_args_shire_stride[sqw_idx] = 0U;
+    watchdog_timeout = KW_CB.pending_watchdog_timeout[sqw_idx];
+    KW_CB.pending_watchdog_timeout[sqw_idx] = 0U;
+    launch_config = KW_CB.pending_launch_config[sqw_idx];
+    KW_CB.pending_launch_config[sqw_idx].flags = 0U;
 
     /* Verify the shire mask */
     if (cmd->shire_mask == 0)
@@ -884,6 +1139,22 @@ int32_t KW_Dispatch_Kernel_Launch_Cmd(
             launch_args.kernel.flags |= KERNEL_LAUNCH_FLAGS_EVICT_L3_BEFORE_LAUNCH;
         }
 
+        /* Flags set by the kernel launch config command */
+        if (launch_config.flags & KERNEL_LAUNCH_CONFIG_FLAGS_NO_TENSOR_OPS)
+        {
+            launch_args.kernel.flags |= KERNEL_LAUNCH_FLAGS_NO_TENSOR_OPS;
+        }
+        if (launch_config.flags & KERNEL_LAUNCH_CONFIG_FLAGS_SHIRE_CACHE_CONFIG)
+        {
+            launch_args.kernel.flags |= KERNEL_LAUNCH_FLAGS_SHIRE_CACHE_CONFIG;
+            launch_args.kernel.scp_sets = launch_config.scp_sets;
+            launch_args.kernel.l2_sets = launch_config.l2_sets;
+        }
+        if (launch_config.flags & KERNEL_LAUNCH_CONFIG_FLAGS_REPORT_AND_CONTINUE)
+        {
+            launch_args.kernel.flags |= KERNEL_LAUNCH_FLAGS_REPORT_AND_CONTINUE;
+        }
+
         /* First we allocate resources needed for the kernel launch */
         /* Reserve a slot for the kernel */
         status =
@@ -891,6 +1162,39 @@ int32_t KW_Dispatch_Kernel_Launch_Cmd(
 
         if (status == STATUS_SUCCESS)
         {
+            /* Prepare everything the launch needs from the slot while the shires may still be
+            running the previous kernel, so the multicast goes out as soon as they are freed.
+            The kernel arguments were already copied while processing the command payload */
+
+            /* Populate the assigned slot ID in the CM kernel launch msg */
+            launch_args.kernel.slot_index = slot_index;
+
+            /* Copy the CM U-mode config to S-mode region - config verification was done above */
+            KW_COPY_CM_UMODE_TRACE_CFG_OPTIONALLY(slot_index, cmd)
+
+            /* Hand the flush ranges of the launch over to the slot, they were verified by the
+            kernel flush ranges command */
+            if (flush_ranges.count != 0U)
+            {
+                ETSOC_MEM_COPY_AND_EVICT(
+                    (void *)(uintptr_t)CM_KERNEL_FLUSH_RANGES_SLOT_ADDR(slot_index),
+                    (void *)&flush_ranges, sizeof(cm_kernel_flush_ranges_t), to_L3)
+                launch_args.kernel.flags |= KERNEL_LAUNCH_FLAGS_FLUSH_RANGES;
+            }
+
+            /* Same for the per shire arguments stride, set by the kernel shire args command */
+            launch_args.kernel.args_shire_stride = args_shire_stride;
+
+            /* And the watchdog timeout, set by the kernel watchdog command */
+            atomic_store_local_32(&kernel->watchdog_timeout, watchdog_timeout);
+            atomic_store_local_8(&kernel->host_abort_flag, 0);
+
+            /* Setup kernel environment shire mask */
+            KW_INIT_KERNEL_ENV_SHIRE_MASK(slot_index, cmd->shire_mask)
+
+            /* Reset the L2 SCP kernel launched flag for the acquired kernel worker slot */
+            atomic_store_global_32(&CM_KERNEL_LAUNCHED_FLAG[slot_index].flag, 0);
+
             /* Reserve compute shires needed for the requested
             kernel launch */
             status = kw_reserve_kernel_shires(
@@ -909,21 +1213,16 @@ int32_t KW_Dispatch_Kernel_Launch_Cmd(
 
         if (status == STATUS_SUCCESS)
         {
-            /* Populate the assigned slot ID in the CM kernel launch msg */
-            launch_args.kernel.slot_index = slot_index;
-
-            /* Copy the CM U-mode config to S-mode region - config verification was done above */
-            KW_COPY_CM_UMODE_TRACE_CFG_OPTIONALLY(slot_index, cmd)
-
-            /* Setup kernel environment shire mask */
-            KW_INIT_KERNEL_ENV_SHIRE_MASK(slot_index, cmd->shire_mask)
-
             /* Populate the tag_id and sqw_idx for KW */
             atomic_store_local_16(&kernel->launch_tag_id, cmd->command_info.cmd_hdr.tag_id);
             atomic_store_local_8(&kernel->sqw_idx, sqw_idx);
 
-            /* Reset the L2 SCP kernel launched flag for the acquired kernel worker slot */
-            atomic_store_global_32(&CM_KERNEL_LAUNCHED_FLAG[slot_index].flag, 0);
+            /* Warm the L3 up with the kernel code and arguments before notifying the shires,
+            if the kernel launch config command asked for it */
+            if (launch_config.flags & KERNEL_LAUNCH_CONFIG_FLAGS_PREFETCH)
+            {
+                kw_prefetch_kernel_launch(cmd, &launch_args);
+            }
 
             TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_KERNEL_LAUNCH_CMD, sqw_idx,
                 cmd->command_info.cmd_hdr.tag_id, CMD_STATUS_EXECUTING)
@@ -938,9 +1237,10 @@ int32_t KW_Dispatch_Kernel_Launch_Cmd(
                 atomic_store_local_32(&kernel->kernel_state, KERNEL_STATE_IN_USE);
                 *kw_idx = slot_index;
                 atomic_store_local_64(&kernel->umode_exception_buffer_ptr, cmd->exception_buffer);
+                atomic_store_local_8(&kernel->multi_launch_idx, KW_MULTI_LAUNCH_NONE);
 
                 /* Save the U-mode trace ptr in KW CB */
-                KW_SAVE_UMODE_TRACE_PTR(kernel, cmd)
+                KW_SAVE_UMODE_TRACE_PTR(kernel, slot_index, cmd)
             }
             else
             {
@@ -1002,6 +1302,7 @@ int32_t KW_Dispatch_Kernel_Abort_Cmd(
         if (status == STATUS_SUCCESS)
         {
             /* Update the kernel state to aborted */
+            atomic_store_local_8(&KW_CB.kernels[slot_index].host_abort_flag, 1);
             atomic_store_local_32(
                 &KW_CB.kernels[slot_index].kernel_state, KERNEL_STATE_ABORTED_BY_HOST);
 
@@ -1038,7 +1339,7 @@ int32_t KW_Dispatch_Kernel_Abort_Cmd(
             }
 
             /* Send kernel abort response to host */
-            status = Host_Iface_CQ_Push_Cmd(0, &abort_rsp, sizeof(abort_rsp));
+            status = Host_Iface_CQ_Push_Cmd(MM_CQ_FOR_SQ(sqw_idx), &abort_rsp, sizeof(abort_rsp));
 
             if (status == STATUS_SUCCESS)
             {
@@ -1101,6 +1402,14 @@ void KW_Abort_All_Dispatched_Kernels(uint8_t sqw_idx)
         } while (atomic_load_local_32(&KW_CB.kernels[kw_idx].kernel_state) ==
                  KERNEL_STATE_SLOT_RESERVED);
 
+        /* Record the host abort of the kernels of the given sqw_idx first, so a kernel the
+        watchdog is already aborting completes as aborted by the host. The flag is cleared
+        when the slot is dispatched again */
+        if (atomic_load_local_8(&KW_CB.kernels[kw_idx].sqw_idx) == sqw_idx)
+        {
+            atomic_store_local_8(&KW_CB.kernels[kw_idx].host_abort_flag, 1);
+        }
+
         /* Check if this kernel slot is used by the given sqw_idx
         and kernel slot is in use, then abort it */
         if ((atomic_load_local_8(&KW_CB.kernels[kw_idx].sqw_idx) == sqw_idx) &&
@@ -1165,6 +1474,7 @@ void KW_Init(void)
         atomic_store_local_64(&KW_CB.kernels[i].kw_cycles.cmd_start_cycles, 0U);
         atomic_store_local_64(&KW_CB.kernels[i].kw_cycles.wait_cycles, 0U);
         atomic_store_local_64(&KW_CB.kernels[i].kw_cycles.prev_cycles, 0U);
+        atomic_store_local_8(&KW_CB.kernels[i].multi_launch_idx, KW_MULTI_LAUNCH_NONE);
 
         kernel_environment_t *kernel_env =
             (kernel_environment_t *)(CM_KERNEL_ENVS_BASEADDR + i * KERNEL_ENV_SIZE);
@@ -1174,11 +1484,19 @@ void KW_Init(void)
         kernel_env->version.minor = ABI_VERSION_MINOR;
         kernel_env->version.patch = ABI_VERSION_PATCH;
         kernel_env->frequency = MM_Config_Get_Minion_Boot_Freq();
+        kernel_env->heap_base = 0U;
+        kernel_env->heap_arena_size = 0U;
 
         /* Evict the data to L2 SCP */
         ETSOC_MEM_EVICT((void *)(uintptr_t)kernel_env, sizeof(kernel_environment_t), to_L2)
     }
 
+    /* Mark all multi-launch groups - unused */
+    for (uint32_t i = 0; i < KW_MULTI_LAUNCH_GROUPS; i++)
+    {
+        atomic_store_local_32(&KW_CB.multi_launches[i].state, KERNEL_STATE_UN_USED);
+    }
+
     /* Initialize DDR size */
     atomic_store_local_64(&KW_CB.host_managed_dram_end, MM_Config_Get_DRAM_End_Address());
 
@@ -1345,6 +1663,15 @@ static inline void kw_cm_to_mm_process_messages(uint32_t kw_idx, uint16_t tag_id
                     "TID[%u]:KW[%d]:from CW:CM_TO_MM_MESSAGE_ID_KERNEL_COMPLETE from S%d:Status:%d\r\n",
                     tag_id, kw_idx, completed->shire_id, completed->status);
 
+                /* Errors of kernels launched in report and continue mode don't fail the launch,
+                their records are in the error rings of the shires */
+                if (completed->reported_errors != 0)
+                {
+                    Log_Write(LOG_LEVEL_WARNING,
+                        "TID[%u]:KW[%d]:CM_TO_MM_MESSAGE_ID_KERNEL_COMPLETE:%u errors reported to the CM error rings\r\n",
+                        tag_id, kw_idx, completed->reported_errors);
+                }
+
                 /* Check the completion status for any error. */
                 if (completed->status == KERNEL_COMPLETE_STATUS_ERROR)
                 {
@@ -1436,7 +1763,13 @@ static inline uint32_t kw_get_kernel_launch_completion_status(
     if ((kernel_state == KERNEL_STATE_ABORTED_BY_HOST) || (kernel_state == KERNEL_STATE_ABORTING))
     {
         /* Check for any errors */
-        if (status_internal->status == STATUS_SUCCESS)
+        if ((status_internal->status == STATUS_SUCCESS) && status_internal->watchdog_expired &&
+            !status_internal->host_aborted && (kernel_state == KERNEL_STATE_ABORTING))
+        {
+            /* The watchdog aborted the kernel shires, and the host didn't abort it meanwhile */
+            status = DEV_OPS_API_KERNEL_LAUNCH_RESPONSE_TIMEOUT_HANG;
+        }
+        else if (status_internal->status == STATUS_SUCCESS)
         {
             /* Update the kernel launch response to indicate that it was aborted by host */
             status = DEV_OPS_API_KERNEL_LAUNCH_RESPONSE_HOST_ABORTED;
@@ -1514,7 +1847,14 @@ __attribute__((noreturn)) void KW_Launch(uint32_t kw_idx)
     uint16_t tag_id;
     int32_t status;
     int32_t kw_abort_timer;
+    int32_t kw_watchdog_timer;
+    uint32_t watchdog_timeout;
     uint32_t kernel_state;
+    uint32_t start_freq_mhz;
+    uint32_t start_throttle_events;
+    uint32_t power_report_idx;
+    kw_power_report_t *power_report;
+    uint8_t multi_launch_idx;
     uint64_t kernel_shire_mask;
     struct kw_internal_status status_internal;
     /* Allocate memory for response message, it includes optional payload. */
@@ -1540,17 +1880,39 @@ __attribute__((noreturn)) void KW_Launch(uint32_t kw_idx)
         status_internal.kernel_done = false;
         status_internal.cw_exception = false;
         status_internal.cw_error = false;
+        status_internal.watchdog_expired = false;
         kw_abort_serviced = false;
         status_internal.status = STATUS_SUCCESS;
         status_internal.cm_error_shire_mask = 0;
         wait_for_ipi = true;
         kw_abort_timer = -1;
+        kw_watchdog_timer = -1;
         atomic_store_local_8(&kernel->cm_abort_wait_timeout_flag, 0);
+        atomic_store_local_8(&kernel->watchdog_expired_flag, 0);
 
         /* Read the shire mask and tag ID for the current kernel */
         kernel_shire_mask = atomic_load_local_64(&kernel->kernel_shire_mask);
         tag_id = atomic_load_local_16(&kernel->launch_tag_id);
 
+        /* Operating point at the start, for the power report of the kernel */
+        start_freq_mhz = STATW_Get_Minion_Freq();
+        start_throttle_events = STATW_Get_Throttle_Events();
+
+        /* Arm the watchdog of the launch, if it has one */
+        watchdog_timeout = atomic_load_local_32(&kernel->watchdog_timeout);
+        if (watchdog_timeout != 0U)
+        {
+            kw_watchdog_timer = SW_Timer_Create_Timeout(
+                &kw_watchdog_timeout_callback, (uint8_t)kw_idx, watchdog_timeout);
+
+            if (kw_watchdog_timer < 0)
+            {
+                Log_Write(LOG_LEVEL_WARNING,
+                    "TID[%u]:KW[%d]:Unable to register the kernel watchdog! A hang won't be detected\r\n",
+                    tag_id, kw_idx);
+            }
+        }
+
         /* Process kernel command responses from CM, for all shires
         associated with the kernel launch */
         while (!status_internal.kernel_done && (status_internal.status == STATUS_SUCCESS))
@@ -1558,6 +1920,21 @@ __attribute__((noreturn)) void KW_Launch(uint32_t kw_idx)
             /* Wait and clear IPI */
             KW_WAIT_AND_CLEAR_SW_INTERRUPT(wait_for_ipi)
 
+            /* If the kernel didn't complete in time, abort it the same way the host would abort
+            all the kernels of its SQ. This only aborts the shires of this kernel, which the abort
+            completion gives back, and the CMs dump the context of their harts to its exception
+            buffer, so the other kernels keep running and there is no need to reset the device */
+            if ((!status_internal.watchdog_expired) &&
+                (atomic_load_local_8(&kernel->watchdog_expired_flag) == 1) &&
+                (atomic_compare_and_exchange_local_32(&kernel->kernel_state, KERNEL_STATE_IN_USE,
+                     KERNEL_STATE_ABORTING) == KERNEL_STATE_IN_USE))
+            {
+                status_internal.watchdog_expired = true;
+                Log_Write(LOG_LEVEL_ERROR,
+                    "TID[%u]:KW[%d]:Watchdog expired:Aborting kernel shires:0x%lx\r\n", tag_id,
+                    kw_idx, kernel_shire_mask);
+            }
+
             /* Get the kernel state */
             kernel_state = atomic_load_local_32(&kernel->kernel_state);
 
@@ -1609,6 +1986,17 @@ __attribute__((noreturn)) void KW_Launch(uint32_t kw_idx)
             SW_Timer_Cancel_Timeout((uint8_t)kw_abort_timer);
         }
 
+        /* Check if the watchdog was registered */
+        if (kw_watchdog_timer >= 0)
+        {
+            /* Free the registered SW Timeout slot */
+            SW_Timer_Cancel_Timeout((uint8_t)kw_watchdog_timer);
+        }
+
+        /* Give back the reserved compute shires right away, so a launch waiting for them can
+        be multicast while the response of this one is prepared */
+        kw_unreserve_kernel_shires(kernel_shire_mask);
+
         /* Kernel run complete with host abort, exception or success.
         reclaim resources and Prepare response */
 
@@ -1627,7 +2015,9 @@ __attribute__((noreturn)) void KW_Launch(uint32_t kw_idx)
 
         local_sqw_idx = atomic_load_local_8(&kernel->sqw_idx);
 
-        /* Get completion status of kernel launch. */
+        /* Get completion status of kernel launch, a host abort takes precedence over the
+        watchdog */
+        status_internal.host_aborted = (atomic_load_local_8(&kernel->host_abort_flag) == 1);
         launch_rsp->status = kw_get_kernel_launch_completion_status(kernel_state, &status_internal);
 
         if (launch_rsp->status != DEV_OPS_API_KERNEL_LAUNCH_RESPONSE_KERNEL_COMPLETED)
@@ -1646,8 +2036,48 @@ __attribute__((noreturn)) void KW_Launch(uint32_t kw_idx)
             rsp_size = (uint16_t)(rsp_size + sizeof(error_ptrs));
         }
 
-        /* Give back the reserved compute shires. */
-        kw_unreserve_kernel_shires(kernel_shire_mask);
+        /* Accumlate kernel execution cycles. */
+        atomic_add_local_64(&kernel->kernel_exec_cycles, launch_rsp->device_cmd_execute_dur);
+
+        /* Update kernel running time for stats Trace. Reporting unit is kernels/second */
+        STATW_Add_New_Sample_Atomically(STATW_RESOURCE_CM,
+            (STATW_Get_Minion_Freq() * 1000000UL / launch_rsp->device_cmd_execute_dur));
+
+        /* Kernels of a multi-launch command are reported in its single response */
+        multi_launch_idx = atomic_load_local_8(&kernel->multi_launch_idx);
+        if (multi_launch_idx != KW_MULTI_LAUNCH_NONE)
+        {
+            uint8_t entry = atomic_load_local_8(&kernel->multi_launch_entry);
+
+            /* Make reserved kernel slot available again */
+            kw_unreserve_kernel_slot(kernel);
+
+            KW_Complete_Multi_Launch_Entry(
+                multi_launch_idx, entry, launch_rsp->status, status_internal.cm_error_shire_mask);
+
+#if !TEST_FRAMEWORK
+            if (launch_rsp->status != DEV_OPS_API_KERNEL_LAUNCH_RESPONSE_KERNEL_COMPLETED)
+            {
+                /* Report device API error to SP */
+                SP_Iface_Report_Error(
+                    MM_RECOVERABLE_OPS_API_KERNEL_LAUNCH, (int16_t)launch_rsp->status);
+            }
+#endif
+            continue;
+        }
+
+        /* Keep the power report of the kernel, read by a barrier command of its SQW.
+        It replaces the oldest report of the SQW */
+        power_report_idx = atomic_add_local_32(&KW_CB.power_report_next[local_sqw_idx], 1U) %
+                           KW_POWER_REPORTS_PER_SQW;
+        power_report = &KW_CB.power_reports[local_sqw_idx][power_report_idx];
+        atomic_store_local_32(&power_report->valid, 0U);
+        atomic_store_local_32(&power_report->tag_id, tag_id);
+        atomic_store_local_32(&power_report->start_freq_mhz, start_freq_mhz);
+        atomic_store_local_32(&power_report->end_freq_mhz, STATW_Get_Minion_Freq());
+        atomic_store_local_32(
+            &power_report->throttle_events, STATW_Get_Throttle_Events() - start_throttle_events);
+        atomic_store_local_32(&power_report->valid, 1U);
 
         /* Make reserved kernel slot available again */
         kw_unreserve_kernel_slot(kernel);
@@ -1660,16 +2090,9 @@ __attribute__((noreturn)) void KW_Launch(uint32_t kw_idx)
 #else
         launch_rsp->response_info.rsp_hdr.size = (uint16_t)(rsp_size - sizeof(struct cmn_header_t));
         /* Send kernel launch response to host */
-        status = Host_Iface_CQ_Push_Cmd(0, launch_rsp, rsp_size);
+        status = Host_Iface_CQ_Push_Cmd(MM_CQ_FOR_SQ(local_sqw_idx), launch_rsp, rsp_size);
 #endif
 
-        /* Accumlate kernel execution cycles. */
-        atomic_add_local_64(&kernel->kernel_exec_cycles, launch_rsp->device_cmd_execute_dur);
-
-        /* Update kernel running time for stats Trace. Reporting unit is kernels/second */
-        STATW_Add_New_Sample_Atomically(STATW_RESOURCE_CM,
-            (STATW_Get_Minion_Freq() * 1000000UL / launch_rsp->device_cmd_execute_dur));
-
         if (status == STATUS_SUCCESS)
         {
             /* Log to command status to trace */
@@ -1928,3 +2351,440 @@ uint64_t KW_Get_Kernel_State(void)
 
     return kernel_state;
 }
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       KW_Set_Kernel_Heap
+*
+*   DESCRIPTION
+*
+*       Describes the kernel heap region in the environment of all the
+*       kernel slots, so it is seen by the next kernels launched. The arena
+*       headers must already be reset by the caller.
+*
+*   INPUTS
+*
+*       heap_base        Start of the kernel heap region, 0 to disable it
+*       arena_size       Size of the arena of each Compute Shire
+*
+*   OUTPUTS
+*
+*       None
+*
+***********************************************************************/
+void KW_Set_Kernel_Heap(uint64_t heap_base, uint64_t arena_size)
+{
+    for (uint32_t i = 0; i < MM_MAX_PARALLEL_KERNELS; i++)
+    {
+        kernel_environment_t *kernel_env =
+            (kernel_environment_t *)(CM_KERNEL_ENVS_BASEADDR + i * KERNEL_ENV_SIZE);
+
+        kernel_env->heap_base = heap_base;
+        kernel_env->heap_arena_size = arena_size;
+
+        /* Evict the data to L2 SCP */
+        ETSOC_MEM_EVICT((void *)(uintptr_t)kernel_env, sizeof(kernel_environment_t), to_L2)
+    }
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       KW_Set_Kernel_Flush_Ranges
+*
+*   DESCRIPTION
+*
+*       Sets the ranges flushed to memory at the completion of the next
+*       kernel launched from the SQW. Must be called by the SQW itself,
+*       with verified ranges.
+*
+*   INPUTS
+*
+*       sqw_idx          Submission queue index
+*       ranges           Ranges to flush, NULL if count is 0
+*       count            Number of ranges, 0 to clear them
+*
+*   OUTPUTS
+*
+*       None
+*
+***********************************************************************/
+void KW_Set_Kernel_Flush_Ranges(uint8_t sqw_idx, const cache_ops_range_t *ranges, uint32_t count)
+{
+    cm_kernel_flush_ranges_t *pending = &KW_CB.pending_flush_ranges[sqw_idx];
+
+    count = (count < CM_KERNEL_FLUSH_RANGES_MAX) ? count : CM_KERNEL_FLUSH_RANGES_MAX;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        pending->ranges[i] = ranges[i];
+    }
+    pending->count = count;
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       KW_Set_Kernel_Shire_Args
+*
+*   DESCRIPTION
+*
+*       Sets the per shire arguments stride of the next kernel launched
+*       from the SQW. Must be called by the SQW itself, with a verified
+*       stride.
+*
+*   INPUTS
+*
+*       sqw_idx          Submission queue index
+*       stride           Bytes of the arguments slice of each shire, 0 to
+*                        clear it
+*
+*   OUTPUTS
+*
+*       None
+*
+***********************************************************************/
+void KW_Set_Kernel_Shire_Args(uint8_t sqw_idx, uint32_t stride)
+{
+    KW_CB.pending_args_shire_stride[sqw_idx] = stride;
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       KW_Set_Kernel_Watchdog
+*
+*   DESCRIPTION
+*
+*       Sets the watchdog timeout of the next kernel launched from the
+*       SQW. If the kernel doesn't complete in time its KW aborts its
+*       shires, and the launch completes with a timeout hang status.
+*       Must be called by the SQW itself.
+*
+*   INPUTS
+*
+*       sqw_idx          Submission queue index
+*       timeout          Timeout in SW timer ticks, 0 to clear it
+*
+*   OUTPUTS
+*
+*       None
+*
+***********************************************************************/
+void KW_Set_Kernel_Watchdog(uint8_t sqw_idx, uint32_t timeout)
+{
+    KW_CB.pending_watchdog_timeout[sqw_idx] = timeout;
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       KW_Set_Kernel_Launch_Config
+*
+*   DESCRIPTION
+*
+*       Sets the launch config of the next kernel launched from the SQW.
+*       Must be called by the SQW itself.
+*
+*   INPUTS
+*
+*       sqw_idx          Submission queue index
+*       flags            KERNEL_LAUNCH_CONFIG_FLAGS_*, 0 to clear them
+*       scp_sets         SCP sets per shire cache bank
+*       l2_sets          L2 sets per shire cache bank
+*
+*   OUTPUTS
+*
+*       None
+*
+***********************************************************************/
+void KW_Set_Kernel_Launch_Config(
+    uint8_t sqw_idx, uint32_t flags, uint16_t scp_sets, uint16_t l2_sets)
+{
+    KW_CB.pending_launch_config[sqw_idx].flags = flags;
+    KW_CB.pending_launch_config[sqw_idx].scp_sets = scp_sets;
+    KW_CB.pending_launch_config[sqw_idx].l2_sets = l2_sets;
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       KW_Clear_Kernel_Launch_State
+*
+*   DESCRIPTION
+*
+*       Clears the flush ranges, shire args stride, watchdog and launch
+*       config set for the next kernel launched from the SQW, so they
+*       don't apply to an unrelated later launch when the commands which
+*       set them never got to their own launch. Must be called by the SQW
+*       itself.
+*
+*   INPUTS
+*
+*       sqw_idx          Submission queue index
+*
+*   OUTPUTS
+*
+*       None
+*
+***********************************************************************/
+void KW_Clear_Kernel_Launch_State(uint8_t sqw_idx)
+{
+    KW_CB.pending_flush_ranges[sqw_idx].count = 0U;
+    KW_CB.pending_args_shire_stride[sqw_idx] = 0U;
+    KW_CB.pending_watchdog_timeout[sqw_idx] = 0U;
+    KW_CB.pending_launch_config[sqw_idx].flags = 0U;
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       KW_Get_Kernel_Power_Report
+*
+*   DESCRIPTION
+*
+*       Gets the Minion frequency at the start and at the completion of
+*       a kernel launched on its own from the SQW, and the number of
+*       frequency throttles SP reported while it ran. Must be called by
+*       the SQW itself once the kernel completed.
+*
+*   INPUTS
+*
+*       sqw_idx          Submission queue index
+*       launch_tag_id    Tag ID of the kernel launch
+*       start_freq_mhz   Frequency when the kernel started
+*       end_freq_mhz     Frequency when the kernel completed
+*       throttle_events  Throttle events while it ran
+*
+*   OUTPUTS
+*
+*       bool             false if the SQW has no report of the kernel
+*
+***********************************************************************/
+bool KW_Get_Kernel_Power_Report(uint8_t sqw_idx, uint16_t launch_tag_id,
+    uint16_t *start_freq_mhz, uint16_t *end_freq_mhz, uint32_t *throttle_events)
+{
+    for (uint32_t i = 0; i < KW_POWER_REPORTS_PER_SQW; i++)
+    {
+        kw_power_report_t *report = &KW_CB.power_reports[sqw_idx][i];
+
+        if ((atomic_load_local_32(&report->valid) != 0U) &&
+            (atomic_load_local_32(&report->tag_id) == launch_tag_id))
+        {
+            *start_freq_mhz = (uint16_t)atomic_load_local_32(&report->start_freq_mhz);
+            *end_freq_mhz = (uint16_t)atomic_load_local_32(&report->end_freq_mhz);
+            *throttle_events = atomic_load_local_32(&report->throttle_events);
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       KW_Reserve_Multi_Launch
+*
+*   DESCRIPTION
+*
+*       Reserves the group of a kernel multi-launch command. It waits for
+*       a free group like the kernel slots, until the SQW is aborted.
+*
+*   INPUTS
+*
+*       sqw_idx          Submission queue index
+*       tag_id           Tag ID of the command
+*       count            Number of kernels of the command
+*       cycles           Start and wait cycles of the command
+*       group_idx        Pointer to get the group index
+*
+*   OUTPUTS
+*
+*       int32_t           status success or error
+*
+***********************************************************************/
+int32_t KW_Reserve_Multi_Launch(uint8_t sqw_idx, uint16_t tag_id, uint32_t count,
+    const execution_cycles_t *cycles, uint8_t *group_idx)
+{
+    kw_multi_launch_t *group = NULL;
+    sqw_state_e sqw_state;
+
+    do
+    {
+        for (uint8_t i = 0; i < KW_MULTI_LAUNCH_GROUPS; i++)
+        {
+            if (atomic_compare_and_exchange_local_32(&KW_CB.multi_launches[i].state,
+                    KERNEL_STATE_UN_USED, KERNEL_STATE_IN_USE) == KERNEL_STATE_UN_USED)
+            {
+                group = &KW_CB.multi_launches[i];
+                *group_idx = i;
+                break;
+            }
+        }
+        sqw_state = SQW_Get_State(sqw_idx);
+    } while ((group == NULL) && (sqw_state != SQW_STATE_ABORTED));
+
+    if (sqw_state == SQW_STATE_ABORTED)
+    {
+        Log_Write(LOG_LEVEL_ERROR, "TID[%u]:SQW[%d]:KW:ABORTED:multi-launch group search\r\n",
+            tag_id, sqw_idx);
+
+        if (group != NULL)
+        {
+            atomic_store_local_32(&group->state, KERNEL_STATE_UN_USED);
+        }
+
+        return KW_ABORTED_MULTI_LAUNCH_SEARCH;
+    }
+
+    atomic_store_local_64(&group->cycles.cmd_start_cycles, cycles->cmd_start_cycles);
+    atomic_store_local_64(&group->cycles.wait_cycles, cycles->wait_cycles);
+    atomic_store_local_64(&group->cycles.exec_start_cycles, cycles->exec_start_cycles);
+    atomic_store_local_64(&group->cm_error_shire_mask, 0U);
+    atomic_store_local_32(&group->count, count);
+    atomic_store_local_16(&group->tag_id, tag_id);
+    atomic_store_local_8(&group->sqw_idx, sqw_idx);
+
+    /* The response can only be sent once every entry is completed or failed to dispatch */
+    atomic_store_local_32(&group->pending, count);
+
+    return STATUS_SUCCESS;
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       KW_Notify_Multi_Launch_Entry
+*
+*   DESCRIPTION
+*
+*       Notify KW Worker of a kernel dispatched as an entry of a
+*       multi-launch group.
+*
+*   INPUTS
+*
+*       kw_idx           ID of the kernel worker
+*       group_idx        Index of the multi-launch group
+*       entry            Index of the kernel in the command
+*       cycle            Cycles of the kernel launch
+*
+*   OUTPUTS
+*
+*       None
+*
+***********************************************************************/
+void KW_Notify_Multi_Launch_Entry(
+    uint8_t kw_idx, uint8_t group_idx, uint8_t entry, const execution_cycles_t *cycle)
+{
+    /* The KW reads the group only once notified */
+    atomic_store_local_8(&KW_CB.kernels[kw_idx].multi_launch_entry, entry);
+    atomic_store_local_8(&KW_CB.kernels[kw_idx].multi_launch_idx, group_idx);
+
+    KW_Notify(kw_idx, cycle);
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       KW_Complete_Multi_Launch_Entry
+*
+*   DESCRIPTION
+*
+*       Sets the status of an entry of a multi-launch group. The last
+*       entry completed transmits the response of the command to the
+*       host, and frees the group.
+*
+*   INPUTS
+*
+*       group_idx            Index of the multi-launch group
+*       entry                Index of the kernel in the command
+*       status               Kernel launch response status
+*       cm_error_shire_mask  Shires which reported an error
+*
+*   OUTPUTS
+*
+*       None
+*
+***********************************************************************/
+void KW_Complete_Multi_Launch_Entry(
+    uint8_t group_idx, uint8_t entry, uint32_t status, uint64_t cm_error_shire_mask)
+{
+    kw_multi_launch_t *group = &KW_CB.multi_launches[group_idx];
+    struct device_ops_kernel_multi_launch_rsp_t rsp = { 0 };
+    int32_t push_status;
+    uint8_t sqw_idx;
+
+    atomic_store_local_32(&group->entry_status[entry], status);
+    if (status != DEV_OPS_API_KERNEL_LAUNCH_RESPONSE_KERNEL_COMPLETED)
+    {
+        atomic_or_local_64(&group->cm_error_shire_mask, cm_error_shire_mask);
+    }
+
+    /* Only the last entry sends the response */
+    if (atomic_add_local_32(&group->pending, (uint32_t)-1) != 1U)
+    {
+        return;
+    }
+
+    rsp.response_info.rsp_hdr.tag_id = atomic_load_local_16(&group->tag_id);
+    rsp.response_info.rsp_hdr.msg_id = DEV_OPS_API_MID_DEVICE_OPS_KERNEL_MULTI_LAUNCH_RSP;
+    rsp.device_cmd_start_ts = atomic_load_local_64(&group->cycles.cmd_start_cycles);
+    rsp.device_cmd_wait_dur = atomic_load_local_64(&group->cycles.wait_cycles);
+    rsp.device_cmd_execute_dur =
+        PMC_GET_LATENCY(atomic_load_local_64(&group->cycles.exec_start_cycles));
+    rsp.cm_error_shire_mask = atomic_load_local_64(&group->cm_error_shire_mask);
+    rsp.count = atomic_load_local_32(&group->count);
+    rsp.status = KERNEL_MULTI_LAUNCH_RESPONSE_COMPLETED;
+
+    for (uint32_t i = 0; i < rsp.count; i++)
+    {
+        rsp.entry_status[i] = atomic_load_local_32(&group->entry_status[i]);
+        if (rsp.entry_status[i] != DEV_OPS_API_KERNEL_LAUNCH_RESPONSE_KERNEL_COMPLETED)
+        {
+            rsp.status = KERNEL_MULTI_LAUNCH_RESPONSE_ENTRY_FAILED;
+        }
+    }
+
+    sqw_idx = atomic_load_local_8(&group->sqw_idx);
+
+    /* Make the group available again */
+    atomic_store_local_32(&group->state, KERNEL_STATE_UN_USED);
+
+    rsp.response_info.rsp_hdr.size = (uint16_t)(sizeof(rsp) - sizeof(struct cmn_header_t));
+    push_status = Host_Iface_CQ_Push_Cmd(MM_CQ_FOR_SQ(sqw_idx), &rsp, sizeof(rsp));
+
+    if (push_status == STATUS_SUCCESS)
+    {
+        TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_KERNEL_MULTI_LAUNCH_CMD, sqw_idx,
+            rsp.response_info.rsp_hdr.tag_id,
+            (rsp.status == KERNEL_MULTI_LAUNCH_RESPONSE_COMPLETED) ? CMD_STATUS_SUCCEEDED :
+                                                                     CMD_STATUS_FAILED)
+
+        Log_Write(LOG_LEVEL_DEBUG, "TID[%u]:SQW[%d]:KW:CQ_Push:KERNEL_MULTI_LAUNCH_CMD_RSP\r\n",
+            rsp.response_info.rsp_hdr.tag_id, sqw_idx);
+    }
+    else
+    {
+        TRACE_LOG_CMD_STATUS(DEV_OPS_API_MID_DEVICE_OPS_KERNEL_MULTI_LAUNCH_CMD, sqw_idx,
+            rsp.response_info.rsp_hdr.tag_id, CMD_STATUS_FAILED)
+
+        Log_Write(LOG_LEVEL_ERROR, "TID[%u]:SQW[%d]:KW:CQ_Push:Failed\r\n",
+            rsp.response_info.rsp_hdr.tag_id, sqw_idx);
+        SP_Iface_Report_Error(MM_RECOVERABLE_FW_MM_KW_ERROR, MM_CQ_PUSH_ERROR);
+    }
+
+    /* Decrement commands count being processed by given SQW */
+    SQW_Decrement_Command_Count(sqw_idx);
+}
@@ -30,6 +30,9 @@
         SQW_Increment_Command_Count
         SQW_Abort_All_Pending_Commands
         SQW_Get_State
+        SQW_Get_Command_Count
+        SQW_Wakeup_Hart
+        SQW_Wait_For_Wakeup
 */
 /***********************************************************************/
 /* comon-api, device_ops_api */
@@ -38,6 +41,8 @@
 /* mm_rt_svcs */
 #include <etsoc/drivers/pmu/pmu.h>
 #include <etsoc/isa/etsoc_memory.h>
+#include <etsoc/isa/fcc.h>
+#include <etsoc/isa/hart.h>
 
 /* mm_rt_helpers */
 #include "error_codes.h"
@@ -63,12 +68,32 @@ typedef struct sqw_cmds_status_ {
     };
 } sqw_cmds_status_t;
 
+/*! \def SQW_WAKEUP_FCC
+    \brief FCC used to wake up the harts blocked in a SQW barrier or abort.
+    FCC_0 is used to notify the SQWs, so a wake up never consumes a SQ notification.
+*/
+#define SQW_WAKEUP_FCC FCC_1
+
+/*! \def SQW_NO_WAITER
+    \brief Value of sqw_waiters_t abort_waiter when no hart is waiting for an abort.
+*/
+#define SQW_NO_WAITER 0xFFFFFFFFU
+
+/*! \typedef sqw_waiters_t
+    \brief Harts blocked on an SQW, to be woken up with SQW_WAKEUP_FCC credits
+*/
+typedef struct sqw_waiters_ {
+    uint32_t barrier_armed; /* The SQW waits for its commands count to be zero */
+    uint32_t abort_waiter;  /* Hart ID waiting for the SQW to leave the aborted state */
+} sqw_waiters_t;
+
 /*! \typedef sqw_cb_t
     \brief Submission Queue Worker Control Block structure
 */
 typedef CACHE_STRUCT({
     sqw_cmds_status_t sqw_status[MM_SQ_COUNT];
     local_fcc_flag_t sqw_fcc_flags[MM_SQ_COUNT];
+    sqw_waiters_t sqw_waiters[MM_SQ_COUNT];
 }) sqw_cb_t;
 
 /*! \var sqw_cb_t SQW_CB
@@ -77,6 +102,35 @@ typedef CACHE_STRUCT({
 */
 static sqw_cb_t SQW_CB = { 0 };
 
+/* Ensure that the commands of a full SQ fit in its L2 SCP prefetch buffer once realigned */
+static_assert(
+    (MM_SQ_SIZE - sizeof(circ_buff_cb_t) + MM_SQ_PREFETCH_ALIGNMENT - 1U) <= MM_SQ_SIZE_MAX,
+    "MM SQ prefetch buffer can't hold a realigned Submission Queue.");
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       sqw_wakeup_hart
+*
+*   DESCRIPTION
+*
+*       Local fn helper to send a SQW wake up credit to a master shire hart
+*
+*   INPUTS
+*
+*       hart_id        Hart ID to wake up
+*
+*   OUTPUTS
+*
+*       None
+*
+***********************************************************************/
+static inline void sqw_wakeup_hart(uint32_t hart_id)
+{
+    SEND_FCC(THIS_SHIRE, hart_id & 1U, SQW_WAKEUP_FCC, 1U << ((hart_id >> 1) & 0x1FU));
+}
+
 /************************************************************************
 *
 *   FUNCTION
@@ -103,16 +157,23 @@ static inline int32_t sqw_command_barrier(uint8_t sqw_idx)
 
     Log_Write(LOG_LEVEL_DEBUG, "SQW[%d]:Command Barrier\r\n", sqw_idx);
 
+    /* Arm the barrier before reading the count, so the last decrement sends a wake up credit */
+    atomic_store_local_32(&SQW_CB.sqw_waiters[sqw_idx].barrier_armed, 1U);
+    FENCE
+
     cmds_status.raw_u64 = atomic_load_local_64(&SQW_CB.sqw_status[sqw_idx].raw_u64);
     Log_Write(LOG_LEVEL_DEBUG, "SQW[%d]:Outstanding Cmd Cnt: %d\r\n", sqw_idx,
         (uint32_t)cmds_status.cmds_count);
 
-    /* Spin-wait until the commands count is zero */
-    do
+    /* Block until the commands count is zero, instead of spinning on the shared L2 line.
+    Credits are counted, so a wake up sent before blocking is not lost. */
+    while (((uint32_t)cmds_status.cmds_count != 0U) && (cmds_status.state == SQW_STATE_BUSY))
     {
+        WAIT_FCC(SQW_WAKEUP_FCC);
         cmds_status.raw_u64 = atomic_load_local_64(&SQW_CB.sqw_status[sqw_idx].raw_u64);
-        asm volatile("fence\n" ::: "memory");
-    } while (((uint32_t)cmds_status.cmds_count != 0U) && (cmds_status.state == SQW_STATE_BUSY));
+    }
+
+    atomic_store_local_32(&SQW_CB.sqw_waiters[sqw_idx].barrier_armed, 0U);
 
     /* check for barrier abort flag */
     if (cmds_status.state == SQW_STATE_ABORTED)
@@ -152,6 +213,8 @@ void SQW_Init(void)
         local_fcc_flag_init(&SQW_CB.sqw_fcc_flags[i]);
 
         atomic_store_local_64(&SQW_CB.sqw_status[i].raw_u64, 0U);
+        atomic_store_local_32(&SQW_CB.sqw_waiters[i].barrier_armed, 0U);
+        atomic_store_local_32(&SQW_CB.sqw_waiters[i].abort_waiter, SQW_NO_WAITER);
     }
 
     return;
@@ -225,6 +288,11 @@ static inline void sqw_process_waiting_commands(uint32_t sqw_idx, vq_cb_t *vq_ca
     int32_t status;
     uint64_t start_cycles = PMC_Get_Current_Cycles();
 
+    /* Keep in the shadow copy the alignment the commands have in the SQ, so that the bulk of
+    them is copied with 256-bit accesses instead of 64-bit uncached reads */
+    cmd_buff += ((uintptr_t)shared_mem_ptr + vq_cached->circbuff_cb->tail_offset) &
+                (MM_SQ_PREFETCH_ALIGNMENT - 1U);
+
     /* Create a shadow copy of data from SQ to L2 SCP */
     status = VQ_Prefetch_Buffer(vq_cached, vq_used_space, shared_mem_ptr, cmd_buff);
 
@@ -357,6 +425,15 @@ __attribute__((noreturn)) void SQW_Launch(uint32_t sqw_idx)
     {
         /* Update the SQW state to idle */
         atomic_store_local_32(&SQW_CB.sqw_status[sqw_idx].state, SQW_STATE_IDLE);
+        FENCE
+
+        /* Wake up the hart waiting for an abort to complete, if any */
+        uint32_t abort_waiter =
+            atomic_exchange_local_32(&SQW_CB.sqw_waiters[sqw_idx].abort_waiter, SQW_NO_WAITER);
+        if (abort_waiter != SQW_NO_WAITER)
+        {
+            sqw_wakeup_hart(abort_waiter);
+        }
 
         Log_Write(LOG_LEVEL_DEBUG, "SQW[%d]:State Idle\r\n", sqw_idx);
 
@@ -440,6 +517,12 @@ void SQW_Decrement_Command_Count(uint8_t sqw_idx)
     /* Decrement commands count being processed by current SQW */
     int32_t original_val = atomic_add_signed_local_32(&SQW_CB.sqw_status[sqw_idx].cmds_count, -1);
 
+    /* Wake up the SQW if it is blocked in a barrier waiting for this command */
+    if ((original_val == 1) && (atomic_load_local_32(&SQW_CB.sqw_waiters[sqw_idx].barrier_armed)))
+    {
+        sqw_wakeup_hart(SQW_BASE_HART_ID + (2U * sqw_idx));
+    }
+
     if ((original_val - 1) < 0)
     {
         Log_Write(LOG_LEVEL_ERROR, "SQW[%d] Decrement:Command Counter is Negative : %d\r\n",
@@ -519,11 +602,22 @@ void SQW_Abort_All_Pending_Commands(uint8_t sqw_idx)
     {
         Log_Write(LOG_LEVEL_ERROR, "SQW[%d]: Aborting all pending commands\r\n", sqw_idx);
 
-        /* Spin-wait if the SQW state is aborted */
-        do
+        /* Release the SQW if it is blocked in a barrier */
+        if (atomic_load_local_32(&SQW_CB.sqw_waiters[sqw_idx].barrier_armed))
         {
-            asm volatile("fence\n" ::: "memory");
-        } while (atomic_load_local_32(&SQW_CB.sqw_status[sqw_idx].state) == SQW_STATE_ABORTED);
+            sqw_wakeup_hart(SQW_BASE_HART_ID + (2U * sqw_idx));
+        }
+
+        /* Block until the SQW leaves the aborted state, it wakes up the registered waiter */
+        atomic_store_local_32(&SQW_CB.sqw_waiters[sqw_idx].abort_waiter, get_hart_id());
+        FENCE
+
+        while (atomic_load_local_32(&SQW_CB.sqw_status[sqw_idx].state) == SQW_STATE_ABORTED)
+        {
+            WAIT_FCC(SQW_WAKEUP_FCC);
+        }
+
+        (void)atomic_exchange_local_32(&SQW_CB.sqw_waiters[sqw_idx].abort_waiter, SQW_NO_WAITER);
 
         Log_Write(LOG_LEVEL_DEBUG, "SQW[%d]: Aborted all pending commands\r\n", sqw_idx);
     }
@@ -552,3 +646,82 @@ sqw_state_e SQW_Get_State(uint8_t sqw_idx)
 {
     return atomic_load_local_32(&SQW_CB.sqw_status[sqw_idx].state);
 }
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       SQW_Get_Command_Count
+*
+*   DESCRIPTION
+*
+*       Function that returns the number of commands being processed
+*       by a submission queue worker
+*
+*   INPUTS
+*
+*       sqw_idx     Submission Queue Worker index
+*
+*   OUTPUTS
+*
+*       uint32_t    Outstanding commands count of the SQW
+*
+***********************************************************************/
+uint32_t SQW_Get_Command_Count(uint8_t sqw_idx)
+{
+    int32_t cmds_count = atomic_load_signed_local_32(&SQW_CB.sqw_status[sqw_idx].cmds_count);
+
+    return (cmds_count > 0) ? (uint32_t)cmds_count : 0U;
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       SQW_Wakeup_Hart
+*
+*   DESCRIPTION
+*
+*       Function that sends a SQW wake up credit to a master shire hart
+*       blocked in SQW_Wait_For_Wakeup
+*
+*   INPUTS
+*
+*       hart_id     Hart ID to wake up
+*
+*   OUTPUTS
+*
+*       None
+*
+***********************************************************************/
+void SQW_Wakeup_Hart(uint32_t hart_id)
+{
+    sqw_wakeup_hart(hart_id);
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       SQW_Wait_For_Wakeup
+*
+*   DESCRIPTION
+*
+*       Function that blocks the calling hart until it gets a SQW wake up
+*       credit. Credits are counted, so a wake up sent before blocking is
+*       not lost, but a credit can also be a stale one. Callers must
+*       check their wait condition again once woken up.
+*
+*   INPUTS
+*
+*       None
+*
+*   OUTPUTS
+*
+*       None
+*
+***********************************************************************/
+void SQW_Wait_For_Wakeup(void)
+{
+    WAIT_FCC(SQW_WAKEUP_FCC);
+}
@@ -15,6 +15,8 @@
     Public interfaces:
         STATW_Launch
         STATW_Get_Minion_Freq
+        STATW_Update_Minion_Freq
+        STATW_Get_Throttle_Events
         STATW_Get_MM_Stats
         STATW_Reset_MM_Stats
         STATW_Add_New_Sample_Atomically
@@ -42,8 +44,11 @@
 #include "services/sp_iface.h"
 #include "config/mm_config.h"
 #include "workers/statw.h"
+#include "services/host_iface.h"
 #include "workers/kw.h"
+#include "workers/cw.h"
 #include "workers/dmaw.h"
+#include "workers/sqw.h"
 
 /*! \def STATW_RECALC_MIN_MAX(resource, current_sample)
     \brief It re-calculates the min, and max each time.
@@ -133,6 +138,11 @@
 */
 #define DDR_FREQUENCY 933UL
 
+/*! \def STATW_CLAMP_TO_U32
+    \brief Clamps a cycles count to fit in 32 bits.
+*/
+#define STATW_CLAMP_TO_U32(cycles) (((cycles) > UINT32_MAX) ? UINT32_MAX : (uint32_t)(cycles))
+
 /*! \def STATW_PMU_SAMPLING_STATE_TIMEOUT
     \brief Timeout value for PMU state change.
 */
@@ -157,6 +167,7 @@ typedef CACHE_STRUCT({
     uint32_t sampling_flag;
     uint32_t reset_sampling_flag;
     uint32_t minion_freq_mhz;
+    uint32_t throttle_events;
     uint32_t pmu_sampling_state;
     uint32_t pmu_sampling_timeout_flag;
 })  __attribute__((packed)) statw_cb;
@@ -173,6 +184,25 @@ typedef struct {
     uint64_t prev_l2_l3_write_counter[NUM_SHIRES][BANKS_PER_SC];
 } __attribute__((packed, aligned(CACHE_LINE_SIZE))) pmc_prev_counters;
 
+/*! \typedef statw_utilization_acc
+    \brief Busy cycles accumulated by the utilization samples since the last stats sample.
+    DMA read/write are the device channels.
+*/
+typedef struct {
+    uint64_t timestamp; /* End of the last utilization sample */
+    uint64_t total_cycles;
+    uint64_t dma_read_cycles;
+    uint64_t dma_write_cycles;
+    uint64_t cm_cycles;
+} statw_utilization_acc;
+
+/* Ensure the utilization samples can hold the per SQ and per channel data */
+static_assert(MM_SQ_COUNT <= TRACE_MM_UTILIZATION_SQ_COUNT,
+    "MM utilization sample can't hold all the Submission Queues.");
+static_assert((PCIE_DMA_RD_CHANNEL_COUNT <= TRACE_MM_UTILIZATION_DMA_CHANNEL_COUNT) &&
+                  (PCIE_DMA_WRT_CHANNEL_COUNT <= TRACE_MM_UTILIZATION_DMA_CHANNEL_COUNT),
+    "MM utilization sample can't hold all the DMA channels.");
+
 typedef struct {
     shire_pmc_cnt_t ms_pmcs[NUM_MEM_SHIRES];
     shire_pmc_cnt_t avg_ms_pmcs;
@@ -540,6 +570,61 @@ uint32_t STATW_Get_Minion_Freq(void)
     return atomic_load_local_32(&STATW_CB.minion_freq_mhz);
 }
 
+/************************************************************************
+*
+*   FUNCTION
+*
+*       STATW_Update_Minion_Freq
+*
+*   DESCRIPTION
+*
+*       This function records the Minion frequency set by SP, counting it as
+*       a throttle event if it was lowered by a power or thermal throttle.
+*
+*   INPUTS
+*
+*       freq_mhz     New frequency in MHz
+*       throttled    True if it was lowered by a throttle
+*
+*   OUTPUTS
+*
+*       None
+*
+***********************************************************************/
+void STATW_Update_Minion_Freq(uint32_t freq_mhz, bool throttled)
+{
+    atomic_store_local_32(&STATW_CB.minion_freq_mhz, freq_mhz);
+    if (throttled)
+    {
+        atomic_add_local_32(&STATW_CB.throttle_events, 1U);
+    }
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       STATW_Get_Throttle_Events
+*
+*   DESCRIPTION
+*
+*       This function returns the number of throttle events reported by SP
+*       since boot. It wraps around.
+*
+*   INPUTS
+*
+*       void
+*
+*   OUTPUTS
+*
+*       Number of throttle events.
+*
+***********************************************************************/
+uint32_t STATW_Get_Throttle_Events(void)
+{
+    return atomic_load_local_32(&STATW_CB.throttle_events);
+}
+
 /************************************************************************
 *
 *   FUNCTION
@@ -687,6 +772,82 @@ void STATW_Add_New_Sample_Atomically(statw_resource_type_e resource_type, uint64
     atomic_store_local_64(&resource->max, MAX(prev_max, current_sample));
 }
 
+/************************************************************************
+*
+*   FUNCTION
+*
+*       statw_sample_utilization
+*
+*   DESCRIPTION
+*
+*       This functions samples the utilization since the previous sample,
+*       accumulates it for the utilization stats and logs it into the MM
+*       stats trace as a time series point.
+*
+*   INPUTS
+*
+*       util_acc             Utilization accumulated since the last stats
+*
+*   OUTPUTS
+*
+*       None
+*
+***********************************************************************/
+static void statw_sample_utilization(statw_utilization_acc *util_acc)
+{
+    struct mm_utilization_sample sample = { 0 };
+    uint64_t dma_read_chan_cycles[PCIE_DMA_RD_CHANNEL_COUNT];
+    uint64_t dma_write_chan_cycles[PCIE_DMA_WRT_CHANNEL_COUNT];
+    uint64_t current_timestamp = PMC_Get_Current_Cycles();
+    uint64_t prev_timestamp = util_acc->timestamp;
+
+    /* Busy cycles are consumed by the workers accounting, so every sample must be accumulated */
+    uint64_t dma_read_cycles = DMAW_Get_Average_Exec_Cycles(
+        DMA_CHAN_TYPE_READ, prev_timestamp, current_timestamp, dma_read_chan_cycles);
+    uint64_t dma_write_cycles = DMAW_Get_Average_Exec_Cycles(
+        DMA_CHAN_TYPE_WRITE, prev_timestamp, current_timestamp, dma_write_chan_cycles);
+    uint64_t cm_cycles = KW_Get_Average_Exec_Cycles(prev_timestamp, current_timestamp);
+
+    util_acc->total_cycles += current_timestamp - prev_timestamp;
+    util_acc->dma_read_cycles += dma_read_cycles;
+    util_acc->dma_write_cycles += dma_write_cycles;
+    util_acc->cm_cycles += cm_cycles;
+    util_acc->timestamp = current_timestamp;
+
+#if STATW_UTILIZATION_SAMPLING_INTERVAL_US != 0
+    struct trace_custom_event_t *entry;
+
+    sample.interval_cycles = current_timestamp - prev_timestamp;
+    sample.busy_shire_mask = CW_Get_Busy_Shires();
+    sample.kernel_busy_cycles = cm_cycles;
+    sample.sq_count = MM_SQ_COUNT;
+
+    for (uint8_t sq_idx = 0; sq_idx < MM_SQ_COUNT; sq_idx++)
+    {
+        sample.sq_pending_bytes[sq_idx] = Host_Iface_Get_SQ_Used_Space(sq_idx);
+        sample.sq_inflight_cmds[sq_idx] = SQW_Get_Command_Count(sq_idx);
+    }
+
+    /* Stats are logged from host's perspective, DMA read channels do host to device transfers */
+    for (uint8_t chan = 0; chan < PCIE_DMA_RD_CHANNEL_COUNT; chan++)
+    {
+        sample.dma_h2d_busy_cycles[chan] = STATW_CLAMP_TO_U32(dma_read_chan_cycles[chan]);
+    }
+    for (uint8_t chan = 0; chan < PCIE_DMA_WRT_CHANNEL_COUNT; chan++)
+    {
+        sample.dma_d2h_busy_cycles[chan] = STATW_CLAMP_TO_U32(dma_write_chan_cycles[chan]);
+    }
+
+    entry = (struct trace_custom_event_t *)Trace_Custom_Event(Trace_Get_MM_Stats_CB(),
+        TRACE_CUSTOM_TYPE_MM_UTILIZATION, (const uint8_t *)&sample, sizeof(sample));
+
+    /* Evict the event so the host reads it with the MM stats trace buffer */
+    Trace_Evict_Event_MM_Stats(entry, (sizeof(struct trace_custom_event_t) + sizeof(sample)));
+#else
+    (void)sample;
+#endif
+}
+
 /************************************************************************
 *
 *   FUNCTION
@@ -696,45 +857,49 @@ void STATW_Add_New_Sample_Atomically(statw_resource_type_e resource_type, uint64
 *   DESCRIPTION
 *
 *       This functions fills the utilization stats int the given data
-*       sample struct.
+*       sample struct, from the utilization accumulated since the
+*       previous stats.
 *
 *   INPUTS
 *
 *       data_sample          Pointer to the compute resources
-*       prev_timestamp       Timestamp of previously sampled utilization
-*
+*       util_acc             Utilization accumulated since the last stats
 *
 *   OUTPUTS
 *
-*       current_timestamp    Timestamp at which the stats were calculated
+*       None
 *
 ***********************************************************************/
-static uint64_t statw_fill_utilization_stats(
-    struct compute_resources_sample *data_sample, uint64_t prev_timestamp)
+static void statw_fill_utilization_stats(
+    struct compute_resources_sample *data_sample, statw_utilization_acc *util_acc)
 {
+    /* Take a last utilization sample to cover the whole stats interval */
+    statw_sample_utilization(util_acc);
+
     /* Percent utilization = trasnsaction accumulated cycles * 100 / Cycles in sampling interval. */
-    uint64_t current_timestamp = PMC_Get_Current_Cycles();
-    uint64_t total_cycles = current_timestamp - prev_timestamp;
-    uint64_t dma_write_util_cycles =
-        DMAW_Get_Average_Exec_Cycles(DMA_CHAN_TYPE_READ, prev_timestamp, current_timestamp);
-    uint64_t dma_read_util_cycles =
-        DMAW_Get_Average_Exec_Cycles(DMA_CHAN_TYPE_WRITE, prev_timestamp, current_timestamp);
-    uint64_t cm_util_cycles = KW_Get_Average_Exec_Cycles(prev_timestamp, current_timestamp);
-
-    /* Caclulate the instantaneous average for utilization. */
-    uint64_t instant_average = (dma_read_util_cycles * STATW_PERCENTAGE_MULTIPLIER) / total_cycles;
-    STATW_RECALC_CMA_MIN_MAX(
-        data_sample->pcie_dma_read_utilization, instant_average, STATW_UTILIZATION_CMA_SAMPLE_COUNT)
-
-    instant_average = (dma_write_util_cycles * STATW_PERCENTAGE_MULTIPLIER) / total_cycles;
-    STATW_RECALC_CMA_MIN_MAX(data_sample->pcie_dma_write_utilization, instant_average,
-        STATW_UTILIZATION_CMA_SAMPLE_COUNT)
-
-    instant_average = (cm_util_cycles * STATW_PERCENTAGE_MULTIPLIER) / total_cycles;
-    STATW_RECALC_CMA_MIN_MAX(
-        data_sample->cm_utilization, instant_average, STATW_UTILIZATION_CMA_SAMPLE_COUNT)
-
-    return current_timestamp;
+    uint64_t total_cycles = util_acc->total_cycles;
+
+    if (total_cycles != 0)
+    {
+        /* Caclulate the instantaneous average for utilization. */
+        uint64_t instant_average =
+            (util_acc->dma_write_cycles * STATW_PERCENTAGE_MULTIPLIER) / total_cycles;
+        STATW_RECALC_CMA_MIN_MAX(data_sample->pcie_dma_read_utilization, instant_average,
+            STATW_UTILIZATION_CMA_SAMPLE_COUNT)
+
+        instant_average = (util_acc->dma_read_cycles * STATW_PERCENTAGE_MULTIPLIER) / total_cycles;
+        STATW_RECALC_CMA_MIN_MAX(data_sample->pcie_dma_write_utilization, instant_average,
+            STATW_UTILIZATION_CMA_SAMPLE_COUNT)
+
+        instant_average = (util_acc->cm_cycles * STATW_PERCENTAGE_MULTIPLIER) / total_cycles;
+        STATW_RECALC_CMA_MIN_MAX(
+            data_sample->cm_utilization, instant_average, STATW_UTILIZATION_CMA_SAMPLE_COUNT)
+    }
+
+    util_acc->total_cycles = 0;
+    util_acc->dma_read_cycles = 0;
+    util_acc->dma_write_cycles = 0;
+    util_acc->cm_cycles = 0;
 }
 
 /************************************************************************
@@ -842,7 +1007,8 @@ static void statw_init(struct compute_resources_sample *local_stats_cb)
 __attribute__((noreturn)) void STATW_Launch(uint32_t hart_id)
 {
     struct compute_resources_sample data_sample = { 0 };
-    uint64_t prev_timestamp;
+    statw_utilization_acc util_acc = { 0 };
+    uint64_t util_interval_cycles;
     uint64_t shire_mask;
     struct trace_custom_event_t *entry;
 
@@ -874,11 +1040,22 @@ __attribute__((noreturn)) void STATW_Launch(uint32_t hart_id)
     /* Set the bit for MM shire */
     shire_mask = MASK_SET_BIT(shire_mask, MASTER_SHIRE);
 
+    /* Utilization time series interval, the sampling timer granularity is too coarse for it */
+    util_interval_cycles =
+        STATW_UTILIZATION_SAMPLING_INTERVAL_US * atomic_load_local_32(&STATW_CB.minion_freq_mhz);
+
     /* Take the initial timestamp */
-    prev_timestamp = PMC_Get_Current_Cycles();
+    util_acc.timestamp = PMC_Get_Current_Cycles();
 
     while (1)
     {
+        /* Log an utilization sample when its interval elapsed */
+        if ((util_interval_cycles != 0) &&
+            ((PMC_Get_Current_Cycles() - util_acc.timestamp) >= util_interval_cycles))
+        {
+            statw_sample_utilization(&util_acc);
+        }
+
         /* Check the flag to sample device stats. */
         if (atomic_compare_and_exchange_local_32(
                 &STATW_CB.sampling_flag, STATW_SAMPLING_FLAG_SET, STATW_SAMPLING_FLAG_CLEAR))
@@ -899,7 +1076,7 @@ __attribute__((noreturn)) void STATW_Launch(uint32_t hart_id)
                 STATW_RESOURCE_DMA_WRITE, &data_sample.pcie_dma_write_bw);
 
             /* Fill the utilization stats */
-            prev_timestamp = statw_fill_utilization_stats(&data_sample, prev_timestamp);
+            statw_fill_utilization_stats(&data_sample, &util_acc);
 
             /* Log the event in trace */
             entry = (struct trace_custom_event_t *)Trace_Custom_Event(Trace_Get_MM_Stats_CB(),
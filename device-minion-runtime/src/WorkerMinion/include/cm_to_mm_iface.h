@@ -52,4 +52,24 @@ int8_t CM_To_MM_Save_Execution_Context(execution_context_t *context_buffer, uint
 int8_t CM_To_MM_Save_Kernel_Error(
     execution_context_t *context_buffer, uint64_t hart_id, uint64_t error_type, int64_t error_code);
 
+/*! \fn void CM_To_MM_Error_Ring_Init(uint32_t shire_id)
+    \brief Function to empty the error ring of a shire
+    \param shire_id Shire ID of the ring
+*/
+void CM_To_MM_Error_Ring_Init(uint32_t shire_id);
+
+/*! \fn uint64_t CM_To_MM_Report_Error(uint32_t shire_id, uint64_t hart_id, uint8_t error_type,
+    uint8_t slot_index, uint64_t error)
+    \brief Function to append a compact error record to the error ring of a shire, without
+    stopping the kernel. Lock free, any hart of the shire can report at any time.
+    \param shire_id Shire ID of the ring
+    \param hart_id Hart ID of thread that took error
+    \param error_type Type of error (cm_context_type_e)
+    \param slot_index Kernel slot of the launch
+    \param error Error value to be saved
+    \return Position of the record in the ring
+*/
+uint64_t CM_To_MM_Report_Error(
+    uint32_t shire_id, uint64_t hart_id, uint8_t error_type, uint8_t slot_index, uint64_t error);
+
 #endif
@@ -12,6 +12,8 @@
         CM_To_MM_Iface_Unicast_Send
         CM_To_MM_Save_Execution_Context
         CM_To_MM_Save_Kernel_Error
+        CM_To_MM_Error_Ring_Init
+        CM_To_MM_Report_Error
 
 */
 /***********************************************************************/
@@ -91,3 +93,33 @@ int8_t CM_To_MM_Save_Kernel_Error(
 
     return 0;
 }
+
+void CM_To_MM_Error_Ring_Init(uint32_t shire_id)
+{
+    cm_error_ring_t *ring = (cm_error_ring_t *)CM_ERROR_RING_ADDR(shire_id);
+
+    for (uint32_t i = 0; i < CM_ERROR_RING_ENTRIES; i++)
+    {
+        atomic_store_global_64(&ring->records[i].seq, 0);
+    }
+    atomic_store_global_64(&ring->head, 0);
+}
+
+uint64_t CM_To_MM_Report_Error(
+    uint32_t shire_id, uint64_t hart_id, uint8_t error_type, uint8_t slot_index, uint64_t error)
+{
+    cm_error_ring_t *ring = (cm_error_ring_t *)CM_ERROR_RING_ADDR(shire_id);
+    const uint64_t position = atomic_add_global_64(&ring->head, 1);
+    cm_error_record_t *record = &ring->records[position % CM_ERROR_RING_ENTRIES];
+    uint64_t info = hart_id | ((uint64_t)error_type << 32) | ((uint64_t)slot_index << 40);
+
+    /* Readers check seq to skip records still being written or already overwritten */
+    atomic_store_global_64(&record->seq, 0);
+    atomic_store_global_64(&record->error, error);
+    atomic_store_global_64(&record->cycles, PMC_Get_Current_Cycles());
+    atomic_store_global_64((uint64_t *)(void *)&record->hart_id, info);
+    FENCE
+    atomic_store_global_64(&record->seq, position + 1);
+
+    return position;
+}
@@ -23,6 +23,7 @@
 #include <etsoc/isa/macros.h>
 #include <etsoc/isa/syscall.h>
 #include <etsoc/drivers/pmu/pmu.h>
+#include <system/abi.h>
 #include <system/layout.h>
 #include <transports/mm_cm_iface/message_types.h>
 #include <etsoc/isa/riscv_encoding.h>
@@ -97,23 +98,39 @@ typedef CACHE_STRUCT ({
     };
 }) kernel_launch_info_t;
 
+/* Align the struct to cache line so that each kernel slot uses its own cache line */
+typedef CACHE_STRUCT ({
+    uint64_t shire_mask; /* Shires pending to complete the kernel launch */
+    uint64_t exception_mask;
+    uint64_t system_abort_mask;
+    uint32_t execution_status;
+    uint32_t reported_errors; /* Errors reported to the shire error rings in report and continue mode */
+}) kernel_launch_global_t;
+
 /***************/
 /* Global Data */
 /***************/
 static const uint8_t tensor_zeros[64] __attribute__((aligned(64))) = { 0 };
 static spinlock_t pre_launch_local_barrier[NUM_SHIRES] = { 0 };
-static spinlock_t pre_launch_global_barrier = { 0 };
 static local_fcc_barrier_t post_launch_barrier[NUM_SHIRES] = { 0 };
 static kernel_launch_info_t kernel_launch_info[NUM_SHIRES] = { 0 };
-static uint64_t kernel_launch_shire_mask __attribute__((aligned(64))) = 0;
-static uint64_t kernel_launch_global_exception_mask __attribute__((aligned(64))) = 0;
-static uint64_t kernel_launch_global_system_abort_mask __attribute__((aligned(64))) = 0;
-static uint32_t kernel_launch_global_execution_status __attribute__((aligned(64))) = 0;
+/* Kernels on disjoint shire masks can run at the same time, so the state shared by all
+the shires of a kernel launch is kept per kernel slot */
+static spinlock_t pre_launch_global_barrier[MAX_SIMULTANEOUS_KERNELS] = { 0 };
+static kernel_launch_global_t kernel_launch_global[MAX_SIMULTANEOUS_KERNELS] = { 0 };
+/* Non zero in the shires whose tensor state (TenC, L1 SCP, pending TensorLoadSetupB) is clean:
+reset before the last kernel launched, which didn't use tensor instructions */
+static spinlock_t tensor_state_clean[NUM_SHIRES] = { 0 };
+/* SCP and L2 sets per bank requested by the last kernel that repartitioned the shire cache,
+encoded as (scp_sets << 16) | l2_sets. Zero while the shire keeps the boot partition */
+static spinlock_t shire_cache_partition[NUM_SHIRES] = { 0 };
+static spinlock_t shire_cache_partition_barrier[NUM_SHIRES] = { 0 };
 
 /***********************/
 /* Function Prototypes */
 /***********************/
 static void pre_kernel_setup(const mm_to_cm_message_kernel_params_t *kernel);
+static void shire_cache_repartition(const mm_to_cm_message_kernel_params_t *kernel);
 static void kernel_launch_post_cleanup(
     const mm_to_cm_message_kernel_params_t *kernel, int64_t return_value, uint64_t return_type);
 
@@ -131,8 +148,10 @@ static inline bool find_last_thread(spinlock_t *lock, uint32_t num_threads)
 }
 
 // This barrier is required to synchronize all Shires before launching the Kernels
+// If icache_prefetch is not zero, the last thread of each shire writes it to ICACHE_UPREFETCH,
+// so the I-caches get filled while it waits for the other shires
 static bool pre_launch_synchronize_shires(
-    spinlock_t *global_lock, spinlock_t *local_lock, uint32_t num_shires)
+    spinlock_t *global_lock, spinlock_t *local_lock, uint32_t num_shires, uint64_t icache_prefetch)
 {
     const uint64_t shire_id = get_shire_id();
     const uint32_t thread_count = (shire_id == MASTER_SHIRE) ? 32 : 64;
@@ -144,20 +163,36 @@ static bool pre_launch_synchronize_shires(
     /* Last thread per shire increments global counter */
     if (last)
     {
-        uint32_t prev_shire = atomic_add_global_32(&global_lock->flag, 1U);
-
-        do
+        /* All the threads of the shire are past pre_kernel_setup, the I-caches were invalidated */
+        if (icache_prefetch != 0)
         {
-            asm volatile("fence\n" ::: "memory");
-        } while (atomic_load_global_32(&global_lock->flag) != num_shires);
+            volatile uint64_t *const icache_prefetch_ptr =
+                (volatile uint64_t *)ESR_SHIRE(THIS_SHIRE, ICACHE_UPREFETCH);
+            *icache_prefetch_ptr = icache_prefetch;
+        }
 
-        /* Last shire resets the global barrier */
-        if (prev_shire == (num_shires - 1))
+        /* A single shire kernel has no other shire to wait for */
+        if (num_shires == 1)
         {
-            init_global_spinlock(&pre_launch_global_barrier, 0);
-
             kernel_last_thread = true;
         }
+        else
+        {
+            uint32_t prev_shire = atomic_add_global_32(&global_lock->flag, 1U);
+
+            do
+            {
+                asm volatile("fence\n" ::: "memory");
+            } while (atomic_load_global_32(&global_lock->flag) != num_shires);
+
+            /* Last shire resets the global barrier */
+            if (prev_shire == (num_shires - 1))
+            {
+                init_global_spinlock(global_lock, 0);
+
+                kernel_last_thread = true;
+            }
+        }
         /* Reset the local barrier flag */
         init_local_spinlock(&local_lock[shire_id], 0);
     }
@@ -168,19 +203,34 @@ static bool pre_launch_synchronize_shires(
     return kernel_last_thread;
 }
 
+/* Slot of the kernel running in the given shire */
+static inline uint8_t kernel_info_get_slot_index(uint32_t shire_id)
+{
+    kernel_launch_info_t kernel_info;
+
+    kernel_info.raw_u32 = atomic_load_local_32(&kernel_launch_info[shire_id].raw_u32);
+
+    return kernel_info.slot_index;
+}
+
 uint64_t kernel_launch_set_global_exception_mask(uint32_t shire_id)
 {
-    return atomic_or_global_64(&kernel_launch_global_exception_mask, (1ULL << shire_id));
+    return atomic_or_global_64(
+        &kernel_launch_global[kernel_info_get_slot_index(shire_id)].exception_mask,
+        (1ULL << shire_id));
 }
 
 uint64_t kernel_launch_get_pending_shire_mask(void)
 {
-    return atomic_load_global_64(&kernel_launch_shire_mask);
+    return atomic_load_global_64(
+        &kernel_launch_global[kernel_info_get_slot_index(get_shire_id())].shire_mask);
 }
 
 static inline uint64_t kernel_launch_reset_shire_mask(uint32_t shire_id)
 {
-    return atomic_and_global_64(&kernel_launch_shire_mask, ~(1ULL << shire_id));
+    return atomic_and_global_64(
+        &kernel_launch_global[kernel_info_get_slot_index(shire_id)].shire_mask,
+        ~(1ULL << shire_id));
 }
 
 uint64_t kernel_info_reset_launched_thread(uint32_t shire_id, uint64_t thread_id)
@@ -309,6 +359,30 @@ static inline void kernel_check_tensor_errors(uint32_t shire_id, uint32_t hart_i
 }
 #endif
 
+/* Report and continue mode: tensor errors are appended to the error ring of the shire,
+without failing the launch or saving the execution context */
+static inline void kernel_report_tensor_errors(
+    const mm_to_cm_message_kernel_params_t *kernel, uint32_t shire_id, uint32_t hart_id)
+{
+    uint64_t tensor_error;
+    asm volatile("csrr %0, tensor_error\n" : "=r"(tensor_error));
+
+    if (tensor_error != 0)
+    {
+        uint64_t position = CM_To_MM_Report_Error(
+            shire_id, hart_id, CM_CONTEXT_TYPE_TENSOR_ERROR, kernel->slot_index, tensor_error);
+
+        atomic_add_global_32(&kernel_launch_global[kernel->slot_index].reported_errors, 1);
+
+        Log_Write(LOG_LEVEL_WARNING,
+            "Post kernel launch:Tensor error: %ld reported:ring position:%ld\n", tensor_error,
+            position);
+
+        /* Clear it, so the next kernel only reports its own errors */
+        asm volatile("csrw tensor_error, zero\n");
+    }
+}
+
 __attribute__((optimize("-fomit-frame-pointer")))
 int64_t launch_kernel(mm_to_cm_message_kernel_params_t kernel)
 {
@@ -319,14 +393,38 @@ int64_t launch_kernel(mm_to_cm_message_kernel_params_t kernel)
     uint64_t kernel_stack_addr;
     uint64_t kernel_env_addr =
         CM_KERNEL_ENVS_BASEADDR + ((uint32_t)kernel.slot_index * KERNEL_ENV_SIZE);
+    const uint64_t first_worker = (get_shire_id() == MASTER_SHIRE) ? 32 : 0;
+    /* Prefetch the kernel entry code into the I-cache of the neighborhoods running the kernel,
+    only neighborhoods 2 and 3 in the master shire */
+    const uint64_t icache_prefetch = (kernel.flags & KERNEL_LAUNCH_FLAGS_PREFETCH_CODE) ?
+        ((((get_shire_id() == MASTER_SHIRE) ? 0xCULL : 0xFULL) << 48) |
+            (kernel.code_start_address & 0xFFFFFFFFFFC0ULL) | KERNEL_LAUNCH_PREFETCH_CODE_LINES) :
+        0;
     bool kernel_last_thread;
 
     asm volatile("csrr  %0, sscratch \n"
                  "addi  %0, %0, 8    \n"
                  : "=r"(firmware_sp));
 
+    /* First worker of each shire samples the cycles before and after the launch setup,
+    to measure the launch overhead (and the cycles saved by the single shire and clean
+    tensor state shortcuts) in the CM trace */
+    if ((hart_id % HARTS_PER_SHIRE) == first_worker)
+    {
+        Trace_PMC_Counter(Trace_Get_CM_CB(), PMC_COUNTER_HPMCOUNTER3);
+    }
+
     pre_kernel_setup(&kernel);
 
+    /* Per shire arguments, pass the shire its own slice of the arguments array: slices follow
+    the order of the shires in the mask */
+    if (kernel.args_shire_stride != 0U)
+    {
+        const uint64_t lower_shires = kernel.shire_mask & ((1ULL << get_shire_id()) - 1ULL);
+        kernel.pointer_to_args +=
+            (uint64_t)__builtin_popcountll(lower_shires) * kernel.args_shire_stride;
+    }
+
     /* Setup the kernel stack */
     if (kernel.flags & KERNEL_LAUNCH_FLAGS_COMPUTE_KERNEL_STACK_CONFIG)
     {
@@ -341,8 +439,17 @@ int64_t launch_kernel(mm_to_cm_message_kernel_params_t kernel)
     }
 
     /* Wait until all the Shires involved in the kernel launch reach this sync point */
-    kernel_last_thread = pre_launch_synchronize_shires(&pre_launch_global_barrier,
-        pre_launch_local_barrier, (uint32_t)__builtin_popcountll(kernel.shire_mask));
+    kernel_last_thread = pre_launch_synchronize_shires(
+        &pre_launch_global_barrier[kernel.slot_index], pre_launch_local_barrier,
+        (uint32_t)__builtin_popcountll(kernel.shire_mask), icache_prefetch);
+
+    /* All the threads of the shire are past pre_kernel_setup, record if this kernel leaves
+    the tensor state clean for the next one */
+    if ((hart_id % HARTS_PER_SHIRE) == (first_worker + 1))
+    {
+        atomic_store_local_32(&tensor_state_clean[get_shire_id()].flag,
+            (kernel.flags & KERNEL_LAUNCH_FLAGS_NO_TENSOR_OPS) ? 1U : 0U);
+    }
 
     /* Set the thread state to kernel launched */
     kernel_info_set_thread_launched(get_shire_id(), hart_id & (HARTS_PER_SHIRE - 1));
@@ -354,6 +461,11 @@ int64_t launch_kernel(mm_to_cm_message_kernel_params_t kernel)
         atomic_store_global_32(&CM_KERNEL_LAUNCHED_FLAG[kernel.slot_index].flag, 1);
     }
 
+    if ((hart_id % HARTS_PER_SHIRE) == first_worker)
+    {
+        Trace_PMC_Counter(Trace_Get_CM_CB(), PMC_COUNTER_HPMCOUNTER3);
+    }
+
     // -Save firmware context on supervisor stack and sp to supervisor stack SP region
     // -Switch sp to kernel_stack_addr
     // -Setup ra and user stack frame so the kernel can ret to kernel_return_function
@@ -496,12 +608,21 @@ static void pre_kernel_setup(const mm_to_cm_message_kernel_params_t *kernel)
     const uint64_t hart_id = get_hart_id();
     const uint32_t minion_mask = (shire_id == MASTER_SHIRE) ? 0xFFFF0000U : 0xFFFFFFFFU;
     const uint64_t first_worker = (shire_id == MASTER_SHIRE) ? 32 : 0;
+    /* Read before the shire is synchronized, the flag is only updated after it */
+    const bool tensor_state_reset = (atomic_load_local_32(&tensor_state_clean[shire_id].flag) == 0);
+    /* Read before the shire is synchronized too, the partition is only updated once all the
+    harts of the shire are waiting for it */
+    const uint32_t partition = ((uint32_t)kernel->scp_sets << 16) | kernel->l2_sets;
+    const bool repartition = (kernel->flags & KERNEL_LAUNCH_FLAGS_SHIRE_CACHE_CONFIG) &&
+                             (shire_id != MASTER_SHIRE) &&
+                             (atomic_load_local_32(&shire_cache_partition[shire_id].flag) != partition);
 
     /* Check if Trace is enabled */
     if (kernel->flags & KERNEL_LAUNCH_FLAGS_COMPUTE_KERNEL_TRACE_ENABLE)
     {
         /* Initialize Trace for CM UMode. */
-        Trace_Init_UMode((struct trace_init_info_t *)(uintptr_t)CM_UMODE_TRACE_CFG_BASEADDR);
+        Trace_Init_UMode(
+            (struct trace_init_info_t *)(uintptr_t)CM_UMODE_TRACE_CFG_SLOT_ADDR(kernel->slot_index));
     }
     else
     {
@@ -514,6 +635,13 @@ static void pre_kernel_setup(const mm_to_cm_message_kernel_params_t *kernel)
     //   arg2 = first worker hart of the shire
     syscall(SYSCALL_PRE_KERNEL_SETUP_INT, minion_mask, first_worker, 0);
 
+    /* Resize the SCP and L2 if the kernel asks for another partition than the current one.
+    The master shire SCP holds the firmware data structures, so it keeps the boot partition */
+    if (repartition)
+    {
+        shire_cache_repartition(kernel);
+    }
+
     // Second worker HART (first minion thread 1) in the shire
     // Thread 0s have more init to do than thread 1s, so use a thread 1 for per-shire init
     if ((hart_id % 64U) == (first_worker + 1))
@@ -528,11 +656,12 @@ static void pre_kernel_setup(const mm_to_cm_message_kernel_params_t *kernel)
         atomic_store_local_64(&kernel_launch_info[shire_id].system_abort_mask, 0);
         /* TODO: Improvement: The global atomic to reset kernel launch globals should be done
         by the first shire involved in kernel launch only, not all shires. */
-        atomic_store_global_64(&kernel_launch_shire_mask, kernel->shire_mask);
-        atomic_store_global_64(&kernel_launch_global_exception_mask, 0);
-        atomic_store_global_64(&kernel_launch_global_system_abort_mask, 0);
-        atomic_store_global_32(
-            &kernel_launch_global_execution_status, KERNEL_COMPLETE_STATUS_SUCCESS);
+        kernel_launch_global_t *launch_global = &kernel_launch_global[kernel->slot_index];
+        atomic_store_global_64(&launch_global->shire_mask, kernel->shire_mask);
+        atomic_store_global_64(&launch_global->exception_mask, 0);
+        atomic_store_global_64(&launch_global->system_abort_mask, 0);
+        atomic_store_global_32(&launch_global->execution_status, KERNEL_COMPLETE_STATUS_SUCCESS);
+        atomic_store_global_32(&launch_global->reported_errors, 0);
 
         /* Init all FLBs */
         for (uint64_t barrier = 0; barrier < FLB_COUNT; barrier++)
@@ -556,8 +685,8 @@ static void pre_kernel_setup(const mm_to_cm_message_kernel_params_t *kernel)
     {
         /* Before evicting L3, make sure all the accesses to L3
         are complete and all the shires reach this sync point */
-        pre_launch_synchronize_shires(&pre_launch_global_barrier, pre_launch_local_barrier,
-            (uint32_t)__builtin_popcountll(kernel->shire_mask));
+        pre_launch_synchronize_shires(&pre_launch_global_barrier[kernel->slot_index],
+            pre_launch_local_barrier, (uint32_t)__builtin_popcountll(kernel->shire_mask), 0);
 
         if ((hart_id % 64U == 0) && (shire_id < 32))
         {
@@ -576,8 +705,8 @@ static void pre_kernel_setup(const mm_to_cm_message_kernel_params_t *kernel)
                  "csrwi portctrl2, 0 \n"
                  "csrwi portctrl3, 0 \n");
 
-    // Thread 0 in each minion
-    if (get_thread_id() == 0)
+    // Thread 0 in each minion, skipped if the previous kernel left the tensor state clean
+    if ((get_thread_id() == 0) && tensor_state_reset)
     {
         uint64_t temp;
         uint64_t temp2;
@@ -620,6 +749,12 @@ static void pre_kernel_setup(const mm_to_cm_message_kernel_params_t *kernel)
         // Ensure all cache evicts are complete
         WAIT_CACHEOPS
     }
+    else if (get_thread_id() == 0)
+    {
+        asm volatile("csrwi tensor_mask,  0 \n"
+                     "csrwi tensor_error, 0 \n"
+                     "csrwi tensor_coop,  0 \n");
+    }
     else /* Thread 1 */
     {
         /* Zero out the tensor errors */
@@ -639,6 +774,44 @@ static void pre_kernel_setup(const mm_to_cm_message_kernel_params_t *kernel)
     asm volatile("fence");
 }
 
+/* Repartitions the shire cache with all the harts of the shire stopped: the L2 is evicted and
+its sets change region, so no hart may access memory until it is done. The harts wait on a FCC
+instead, and the last one to arrive does the repartition and releases them */
+static void shire_cache_repartition(const mm_to_cm_message_kernel_params_t *kernel)
+{
+    const uint32_t shire_id = get_shire_id();
+
+    /* Drop any stale credit, FCCs are initialized again later in pre_kernel_setup */
+    init_fcc(FCC_1);
+
+    if (find_last_thread(&shire_cache_partition_barrier[shire_id], HARTS_PER_SHIRE))
+    {
+        init_local_spinlock(&shire_cache_partition_barrier[shire_id], 0);
+
+        int64_t rv = syscall(SYSCALL_SHIRE_CACHE_CONFIG_INT, kernel->scp_sets, kernel->l2_sets, 0);
+
+        if (rv == SYSCALL_INTERNAL_SUCCESS)
+        {
+            atomic_store_local_32(&shire_cache_partition[shire_id].flag,
+                ((uint32_t)kernel->scp_sets << 16) | kernel->l2_sets);
+        }
+
+        SEND_FCC(THIS_SHIRE, THREAD_0, FCC_1, 0xFFFFFFFFU);
+        SEND_FCC(THIS_SHIRE, THREAD_1, FCC_1, 0xFFFFFFFFU);
+
+        if (rv != SYSCALL_INTERNAL_SUCCESS)
+        {
+            Log_Write(LOG_LEVEL_ERROR,
+                "pre_kernel_setup:Invalid shire cache partition SCP:0x%x L2:0x%x, keeping the current one\r\n",
+                kernel->scp_sets, kernel->l2_sets);
+        }
+    }
+    else
+    {
+        WAIT_FCC(FCC_1);
+    }
+}
+
 static void process_kernel_completion_status(int64_t return_value, uint64_t return_type)
 {
     const uint32_t shire_id = get_shire_id();
@@ -661,7 +834,9 @@ static void process_kernel_completion_status(int64_t return_value, uint64_t retu
                  &kernel_launch_info[shire_id].system_abort_mask, 1ULL << thread_id) == 0))
         {
             /* Set the global system abort flag to indicate that this particular shire was aborted */
-            atomic_or_global_64(&kernel_launch_global_system_abort_mask, 1ULL << shire_id);
+            atomic_or_global_64(
+                &kernel_launch_global[kernel_info_get_slot_index(shire_id)].system_abort_mask,
+                1ULL << shire_id);
         }
         else if (return_type == KERNEL_RETURN_BUS_ERROR)
         {
@@ -683,6 +858,55 @@ static void process_kernel_completion_status(int64_t return_value, uint64_t retu
     }
 }
 
+/* Empties the kernel heap arena of the shire (see etsoc/common/heap.h), so the blocks not freed by
+the kernel are not leaked to the next one. Must be called once all the threads of the shire are done
+with the kernel, before the L2 eviction of the post kernel cleanup */
+static inline void kernel_heap_reset_arena(
+    const mm_to_cm_message_kernel_params_t *kernel, uint32_t shire_id)
+{
+    const kernel_environment_t *kernel_env =
+        (const kernel_environment_t *)(CM_KERNEL_ENVS_BASEADDR +
+                                       ((uint32_t)kernel->slot_index * KERNEL_ENV_SIZE));
+
+    if ((kernel_env->heap_base != 0) && (shire_id < KERNEL_HEAP_ARENA_COUNT))
+    {
+        volatile uint64_t *header =
+            (volatile uint64_t *)(uintptr_t)(kernel_env->heap_base +
+                                             (shire_id * kernel_env->heap_arena_size));
+
+        /* The arena header is only accessed with local atomics */
+        for (uint32_t word = 0; word < (KERNEL_HEAP_ARENA_HEADER_SIZE / 8U); word++)
+        {
+            atomic_store_local_64(&header[word], 0U);
+        }
+    }
+}
+
+/* Flushes the output buffers of the kernel slot to memory, instead of the whole L3. Must be called
+by the last hart of the kernel, once the L2s of all its shires are evicted */
+static inline void kernel_flush_ranges(const mm_to_cm_message_kernel_params_t *kernel)
+{
+    const cm_kernel_flush_ranges_t *flush_ranges =
+        (const cm_kernel_flush_ranges_t *)CM_KERNEL_FLUSH_RANGES_SLOT_ADDR(kernel->slot_index);
+    const uint64_t count = (flush_ranges->count < CM_KERNEL_FLUSH_RANGES_MAX) ?
+                               flush_ranges->count :
+                               CM_KERNEL_FLUSH_RANGES_MAX;
+
+    for (uint64_t i = 0; i < count; i++)
+    {
+        if (flush_ranges->ranges[i].size != 0)
+        {
+            flush(to_Mem, (const void *)(uintptr_t)flush_ranges->ranges[i].address,
+                flush_ranges->ranges[i].size);
+        }
+    }
+
+    /* Don't keep the slot cached, the MM rewrites it in L3 for the next kernel */
+    evict(to_L3, flush_ranges, sizeof(cm_kernel_flush_ranges_t));
+
+    WAIT_CACHEOPS
+}
+
 static void kernel_launch_post_cleanup(
     const mm_to_cm_message_kernel_params_t *kernel, int64_t return_value, uint64_t return_type)
 {
@@ -712,6 +936,10 @@ static void kernel_launch_post_cleanup(
     /* Check for tensor errors - must be after tensor ops wait */
     /* SW-11250: Enable once Glow models are fixed to remove tensor errors */
     // kernel_check_tensor_errors(shire_id, hart_id);
+    if (kernel->flags & KERNEL_LAUNCH_FLAGS_REPORT_AND_CONTINUE)
+    {
+        kernel_report_tensor_errors(kernel, shire_id, hart_id);
+    }
 
     /* Empty all FCCs before blocking on FCC barrier */
     init_fcc(FCC_0);
@@ -723,6 +951,11 @@ static void kernel_launch_post_cleanup(
     We have to make sure all threads have finished before evicting caches */
     local_fcc_barrier(&post_launch_barrier[shire_id], thread_count, minion_mask);
 
+    if (thread_id == 0)
+    {
+        kernel_heap_reset_arena(kernel, shire_id);
+    }
+
     /* Cleanup hart state after kernel launch */
     syscall(SYSCALL_POST_KERNEL_CLEANUP_INT, thread_count, 0, 0);
 
@@ -742,7 +975,8 @@ static void kernel_launch_post_cleanup(
         {
             /* Collect the first error generated by a shire
             involved in kernel launch and save it globally */
-            atomic_compare_and_exchange_global_32(&kernel_launch_global_execution_status,
+            atomic_compare_and_exchange_global_32(
+                &kernel_launch_global[kernel->slot_index].execution_status,
                 KERNEL_COMPLETE_STATUS_SUCCESS, exec_status);
         }
 
@@ -753,16 +987,26 @@ static void kernel_launch_post_cleanup(
         if ((prev_shire_mask & ~(1ULL << shire_id)) == 0)
         {
             cm_to_mm_message_kernel_launch_completed_t msg = { 0 };
+
+            if (kernel->flags & KERNEL_LAUNCH_FLAGS_FLUSH_RANGES)
+            {
+                kernel_flush_ranges(kernel);
+            }
+
             msg.header.id = CM_TO_MM_MESSAGE_ID_KERNEL_COMPLETE;
             msg.shire_id = shire_id;
             msg.slot_index = kernel->slot_index;
-            msg.status = atomic_load_global_32(&kernel_launch_global_execution_status);
+            msg.status =
+                atomic_load_global_32(&kernel_launch_global[kernel->slot_index].execution_status);
+            msg.reported_errors =
+                atomic_load_global_32(&kernel_launch_global[kernel->slot_index].reported_errors);
 
             if (msg.status != KERNEL_COMPLETE_STATUS_SUCCESS)
             {
-                msg.exception_mask = atomic_load_global_64(&kernel_launch_global_exception_mask);
-                msg.system_abort_mask =
-                    atomic_load_global_64(&kernel_launch_global_system_abort_mask);
+                msg.exception_mask =
+                    atomic_load_global_64(&kernel_launch_global[kernel->slot_index].exception_mask);
+                msg.system_abort_mask = atomic_load_global_64(
+                    &kernel_launch_global[kernel->slot_index].system_abort_mask);
             }
 
             Log_Write(LOG_LEVEL_DEBUG,
@@ -770,7 +1014,8 @@ static void kernel_launch_post_cleanup(
 
             /* Send the message to KW */
             status =
-                CM_To_MM_Iface_Unicast_Send((uint64_t)(kernel->kw_base_id + kernel->slot_index),
+                CM_To_MM_Iface_Unicast_Send(
+                    (uint64_t)(kernel->kw_base_id + (kernel->slot_index * HARTS_PER_MINION)),
                     (uint64_t)(CM_MM_KW_HART_UNICAST_BUFF_BASE_IDX + kernel->slot_index),
                     (cm_iface_message_t *)&msg);
 
@@ -91,6 +91,9 @@ int main(void)
         /* Reset the thread boot counter */
         init_local_spinlock(&CM_Thread_Boot_Counter[shire_id], 0);
 
+        /* Empty the error ring of the shire */
+        CM_To_MM_Error_Ring_Init(shire_id);
+
         /* Set the shire ID bit in the global CM shire boot mask */
         atomic_or_global_64(CM_BOOT_MASK_PTR, (1ULL << shire_id));
 
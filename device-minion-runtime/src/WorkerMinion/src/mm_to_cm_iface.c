@@ -25,6 +25,7 @@ typedef struct {
 #define CURRENT_THREAD_MASK      ((0x1UL << (get_hart_id() % 64)))
 #define GET_SHIRE_MASK(shire_id) (1ULL << shire_id)
 #define GET_CM_INDEX(hart_id)    ((hart_id < 2048U) ? hart_id : (hart_id - 32U))
+#define HARTS_PER_NEIGH          16U
 #define MM_NOTIFY_ASYNC_MSG(shire_id, msg_header)            \
     {                                                        \
         if (!(msg_header.flags & CM_IFACE_FLAG_SYNC_CMD))    \
@@ -45,6 +46,7 @@ typedef struct {
 /* MM -> CM global variables */
 #define mm_cm_msg_number ((cm_iface_message_number_internal_t *)CM_MM_HART_MESSAGE_COUNTER)
 static spinlock_t mm_cm_msg_read[NUM_SHIRES] = { 0 };
+static spinlock_t mm_cm_msg_read_neigh[NUM_SHIRES][NEIGH_PER_SHIRE] = { 0 };
 
 /* MM -> CM message buffers */
 #define master_to_worker_broadcast_message_buffer_ptr \
@@ -56,20 +58,31 @@ static spinlock_t mm_cm_msg_read[NUM_SHIRES] = { 0 };
 static void mm_to_cm_iface_handle_message(
     cm_iface_message_t *const message_ptr, void *const optional_arg);
 
-/* Finds the last shire involved in MM->CM message and notifies the MM */
+/* Finds the last shire involved in MM->CM message and notifies the MM. The acks are gathered
+per neighborhood first, so at most 16 harts meet on each L2 line instead of the whole shire */
 static inline void notify_mm(uint64_t shire_id)
 {
-    const uint32_t thread_count = (shire_id == MASTER_SHIRE) ? 32 : 64;
+    const uint32_t neigh = (uint32_t)((get_hart_id() % HARTS_PER_SHIRE) / HARTS_PER_NEIGH);
+    /* Only the upper two neighborhoods of the master shire run the Worker FW */
+    const uint32_t neigh_count = (shire_id == MASTER_SHIRE) ? 2 : NEIGH_PER_SHIRE;
 
-    /* Last thread per shire clears the global shire bitmask */
-    if (atomic_add_local_32(&mm_cm_msg_read[shire_id].flag, 1U) == (thread_count - 1))
+    /* Last thread per neighborhood acks for its neighborhood */
+    if (atomic_add_local_32(&mm_cm_msg_read_neigh[shire_id][neigh].flag, 1U) ==
+        (HARTS_PER_NEIGH - 1))
     {
-        /* Reset the MM-CM msg read counter */
-        init_local_spinlock(&mm_cm_msg_read[shire_id], 0);
+        /* Reset the neighborhood MM-CM msg read counter */
+        init_local_spinlock(&mm_cm_msg_read_neigh[shire_id][neigh], 0);
 
-        /* Clear bit for current shire to send msg acknowledgment to MM */
-        atomic_and_global_64(
-            &master_to_worker_broadcast_message_ctrl_ptr->shire_mask, ~GET_SHIRE_MASK(shire_id));
+        /* Last neighborhood per shire clears the global shire bitmask */
+        if (atomic_add_local_32(&mm_cm_msg_read[shire_id].flag, 1U) == (neigh_count - 1))
+        {
+            /* Reset the MM-CM msg read counter */
+            init_local_spinlock(&mm_cm_msg_read[shire_id], 0);
+
+            /* Clear bit for current shire to send msg acknowledgment to MM */
+            atomic_and_global_64(&master_to_worker_broadcast_message_ctrl_ptr->shire_mask,
+                ~GET_SHIRE_MASK(shire_id));
+        }
     }
 }
 
@@ -177,6 +190,9 @@ static void mm_to_cm_iface_handle_message(
                 kernel.exception_buffer = launch->kernel.exception_buffer;
                 kernel.stack_base_address = launch->kernel.stack_base_address;
                 kernel.stack_size = launch->kernel.stack_size;
+                kernel.scp_sets = launch->kernel.scp_sets;
+                kernel.l2_sets = launch->kernel.l2_sets;
+                kernel.args_shire_stride = launch->kernel.args_shire_stride;
 
                 /* Notify MM after copying the msg locally */
                 MM_NOTIFY_ASYNC_MSG(shire, msg_header)
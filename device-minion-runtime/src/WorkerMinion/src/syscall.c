@@ -12,15 +12,118 @@
         syscall_handler
 */
 /***********************************************************************/
+#include <etsoc/isa/cacheops.h>
 #include <etsoc/isa/syscall.h>
+#include <system/layout.h>
 #include "syscall_internal.h"
 #include "kernel.h"
 
+#include <stdbool.h>
 #include <stdint.h>
 
 int64_t syscall_handler(
     uint64_t number, uint64_t arg1, uint64_t arg2, uint64_t arg3, uint64_t stack_frame);
 
+/************************************************************************
+*
+*   FUNCTION
+*
+*       umode_range_is_valid
+*
+*   DESCRIPTION
+*
+*       Checks that a range is within the DRAM accessible to U-mode kernels,
+*       from their stacks to the end of the host managed DRAM.
+*
+*   INPUTS
+*
+*       addr             Start of the range
+*       size             Size of the range in bytes
+*
+*   OUTPUTS
+*
+*       bool             true if the range is valid
+*
+***********************************************************************/
+static inline bool umode_range_is_valid(uint64_t addr, uint64_t size)
+{
+    const uint64_t umode_end = HOST_MANAGED_DRAM_START + HOST_MANAGED_DRAM_SIZE_MAX;
+
+    return (addr >= KERNEL_UMODE_STACK_END) && (addr < umode_end) && (size <= (umode_end - addr));
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       cache_ops_ranges
+*
+*   DESCRIPTION
+*
+*       Evicts or flushes the cache lines of a list of ranges given by a
+*       U-mode kernel up to the destination level, and waits for the
+*       cache ops to complete. Each range is copied before being checked,
+*       so other harts can't change it in between. Stops at the first
+*       invalid range.
+*
+*   INPUTS
+*
+*       flush_only       Flush the dirty lines instead of evicting them
+*       ranges_addr      Address of the cache_ops_range_t list
+*       count            Number of ranges, up to CACHE_OPS_RANGES_MAX
+*       dest             Destination level (enum cop_dest)
+*
+*   OUTPUTS
+*
+*       int64_t          SYSCALL_SUCCESS or SYSCALL_INVALID_ARGS
+*
+***********************************************************************/
+static int64_t cache_ops_ranges(bool flush_only, uint64_t ranges_addr, uint64_t count, uint64_t dest)
+{
+    const volatile cache_ops_range_t *ranges =
+        (const volatile cache_ops_range_t *)(uintptr_t)ranges_addr;
+    int64_t ret = SYSCALL_SUCCESS;
+
+    if ((count > CACHE_OPS_RANGES_MAX) || (dest > to_Mem) ||
+        !umode_range_is_valid(ranges_addr, count * sizeof(cache_ops_range_t)))
+    {
+        return SYSCALL_INVALID_ARGS;
+    }
+
+    /* Make the stores of the kernel visible to the cache ops */
+    FENCE
+
+    for (uint64_t i = 0; i < count; i++)
+    {
+        const uint64_t address = ranges[i].address;
+        const uint64_t size = ranges[i].size;
+
+        if (!umode_range_is_valid(address, size))
+        {
+            ret = SYSCALL_INVALID_ARGS;
+            break;
+        }
+
+        if (size == 0)
+        {
+            continue;
+        }
+
+        if (flush_only)
+        {
+            flush((enum cop_dest)dest, (const void *)(uintptr_t)address, size);
+        }
+        else
+        {
+            evict((enum cop_dest)dest, (const void *)(uintptr_t)address, size);
+        }
+    }
+
+    WAIT_CACHEOPS
+
+    return ret;
+}
+
 int64_t syscall_handler(
     uint64_t number, uint64_t arg1, uint64_t arg2, uint64_t arg3, uint64_t stack_frame)
 {
@@ -52,6 +155,12 @@ int64_t syscall_handler(
         case SYSCALL_CACHE_OPS_EVICT_WHOLE_L1_L2:
             ret = syscall(SYSCALL_CACHE_OPS_EVICT_WHOLE_L1_L2_INT, arg1, arg2, arg3);
             break;
+        case SYSCALL_CACHE_OPS_EVICT_RANGES:
+            ret = cache_ops_ranges(false, arg1, arg2, arg3);
+            break;
+        case SYSCALL_CACHE_OPS_FLUSH_RANGES:
+            ret = cache_ops_ranges(true, arg1, arg2, arg3);
+            break;
         case SYSCALL_RETURN_FROM_KERNEL:
             /* Dump U-mode context in case of kernel self abort */
             if (arg2 == KERNEL_RETURN_SELF_ABORT)
@@ -576,6 +576,9 @@ void Trace_Init_UMode(const struct trace_init_info_t *init_info)
     /* TODO: Need to send notification for U-mode kernels? */
     cb->threshold_notify = NULL;
 
+    /* No buffer lines evicted by the U-mode encoder yet */
+    cb->evict_offset = 0;
+
     /* Buffer settings for current Hart. */
     cb->base_per_hart = init_info->buffer + (trace_get_umode_buffer_idx(init_info->shire_mask,
                                                  init_info->thread_mask, hart_id) *
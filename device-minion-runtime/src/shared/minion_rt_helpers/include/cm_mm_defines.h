@@ -12,6 +12,7 @@
 #ifndef CM_TO_MM_DEFS_H
 #define CM_TO_MM_DEFS_H
 
+#include <etsoc/isa/cacheops_common.h>
 #include <etsoc/isa/sync.h>
 #include <stdio.h>
 
@@ -73,6 +74,53 @@ typedef struct {
     uint64_t gpr[31];
 } __attribute__((packed, aligned(64))) execution_context_t;
 
+/*! \def CM_ERROR_RING_ENTRIES
+    \brief A macro that provides the number of records kept in the error ring of each shire.
+*/
+#define CM_ERROR_RING_ENTRIES 64U
+
+/*! \struct cm_error_record_t
+    \brief A structure that is used to store a compact record of an error reported
+    by a hart without stopping the kernel.
+*/
+typedef struct {
+    uint64_t seq;       /* Position + 1 of the record in the ring, written last */
+    uint64_t error;     /* Error value, e.g. the tensor_error CSR */
+    uint64_t cycles;
+    uint32_t hart_id;
+    uint8_t type;       /* cm_context_type_e */
+    uint8_t slot_index; /* Kernel slot of the launch */
+    uint8_t pad[2];
+} __attribute__((aligned(32))) cm_error_record_t;
+
+/*! \struct cm_error_ring_t
+    \brief A structure that is used to store the errors reported by the harts of a shire
+    without stopping the kernel. Record p is written in records[p % CM_ERROR_RING_ENTRIES],
+    so only the last CM_ERROR_RING_ENTRIES are kept. All the fields are accessed with
+    global atomics.
+*/
+typedef struct {
+    uint64_t head; /* Records written to the ring since boot */
+    uint8_t pad[56];
+    cm_error_record_t records[CM_ERROR_RING_ENTRIES];
+} __attribute__((aligned(64))) cm_error_ring_t;
+
+/*! \def CM_KERNEL_FLUSH_RANGES_MAX
+    \brief A macro that provides the number of ranges flushed at the completion of a kernel.
+*/
+#define CM_KERNEL_FLUSH_RANGES_MAX 15U
+
+/*! \struct cm_kernel_flush_ranges_t
+    \brief A structure that is used to store the output buffers of a kernel launched with
+    KERNEL_LAUNCH_FLAGS_FLUSH_RANGES. Written by the MM before the launch, and read by the
+    last hart of the kernel, which flushes them to memory.
+*/
+typedef struct {
+    uint64_t count; /* Valid entries of ranges */
+    uint64_t reserved;
+    cache_ops_range_t ranges[CM_KERNEL_FLUSH_RANGES_MAX];
+} __attribute__((aligned(64))) cm_kernel_flush_ranges_t;
+
 /*! \struct cm_kernel_launched_flag_t
     \brief A structure that is used to store the kernel launch status on Compute
     Minion side.
@@ -231,6 +231,11 @@ RESERVED
 */
 #define KW_ERROR_KERNEL_UMODE_STACK_INVALID_CONFIG -1016
 
+/*! \def KW_ABORTED_MULTI_LAUNCH_SEARCH
+    \brief Kernel Worker - Kernel multi-launch group search aborted
+*/
+#define KW_ABORTED_MULTI_LAUNCH_SEARCH -1017
+
 /**************************************
  * Define Compute Worker error codes. *
  **************************************/
@@ -415,6 +420,56 @@ RESERVED
 */
 #define HOST_CMD_ERROR_CM_RESET_FAILED -2008
 
+/*! \def HOST_CMD_ERROR_INVALID_SYNC_SLOT
+    \brief Host command handler - Stream sync slot out of range
+*/
+#define HOST_CMD_ERROR_INVALID_SYNC_SLOT -2009
+
+/*! \def HOST_CMD_ERROR_INVALID_CMD_CHAIN
+    \brief Host command handler - Malformed command chain stages
+*/
+#define HOST_CMD_ERROR_INVALID_CMD_CHAIN -2010
+
+/*! \def HOST_CMD_ERROR_INVALID_MEMSET
+    \brief Host command handler - Memset range or pattern not valid
+*/
+#define HOST_CMD_ERROR_INVALID_MEMSET -2011
+
+/*! \def HOST_CMD_ERROR_INVALID_DEVICE_MEMCPY
+    \brief Host command handler - Device memcpy range not valid
+*/
+#define HOST_CMD_ERROR_INVALID_DEVICE_MEMCPY -2012
+
+/*! \def HOST_CMD_ERROR_INVALID_KERNEL_HEAP
+    \brief Host command handler - Kernel heap region not valid or kernels running
+*/
+#define HOST_CMD_ERROR_INVALID_KERNEL_HEAP -2013
+
+/*! \def HOST_CMD_ERROR_INVALID_FLUSH_RANGES
+    \brief Host command handler - Kernel flush ranges not valid
+*/
+#define HOST_CMD_ERROR_INVALID_FLUSH_RANGES -2014
+
+/*! \def HOST_CMD_ERROR_INVALID_MULTI_LAUNCH
+    \brief Host command handler - Kernel multi-launch count or shire masks not valid
+*/
+#define HOST_CMD_ERROR_INVALID_MULTI_LAUNCH -2015
+
+/*! \def HOST_CMD_ERROR_INVALID_CMD_LIST
+    \brief Host command handler - Malformed device command list or patches
+*/
+#define HOST_CMD_ERROR_INVALID_CMD_LIST -2016
+
+/*! \def HOST_CMD_ERROR_INVALID_SHIRE_ARGS
+    \brief Host command handler - Kernel shire args stride not valid
+*/
+#define HOST_CMD_ERROR_INVALID_SHIRE_ARGS -2017
+
+/*! \def HOST_CMD_ERROR_INVALID_LAUNCH_CONFIG
+    \brief Host command handler - Kernel launch config not valid
+*/
+#define HOST_CMD_ERROR_INVALID_LAUNCH_CONFIG -2018
+
 /**************************************
  * Define Software Timer error codes. *
  **************************************/
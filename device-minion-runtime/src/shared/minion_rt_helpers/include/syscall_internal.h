@@ -25,9 +25,11 @@
 #define SYSCALL_ENABLE_NEIGH                    22
 #define SYSCALL_PMC_SC_SAMPLE_ALL_INT           23
 #define SYSCALL_PMC_MS_SAMPLE_ALL_INT           24
+#define SYSCALL_SHIRE_CACHE_CONFIG_INT          25
 
 /* SYSCALL error codes */
-#define SYSCALL_INTERNAL_SUCCESS    0
-#define SYSCALL_INTERNAL_INVALID_ID -1
+#define SYSCALL_INTERNAL_SUCCESS      0
+#define SYSCALL_INTERNAL_INVALID_ID   -1
+#define SYSCALL_INTERNAL_INVALID_ARGS -2
 
 #endif // SYSCALL_INTERNAL_H
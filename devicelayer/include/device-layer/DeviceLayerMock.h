@@ -44,6 +44,7 @@ public:
   MOCK_CONST_METHOD0(getDevicesCount, int());
   MOCK_CONST_METHOD2(getDeviceAttribute, std::string(int, std::string));
   MOCK_CONST_METHOD2(clearDeviceAttributes, void(int, std::string));
+  MOCK_CONST_METHOD1(getDeviceStatsSnapshot, DeviceStatsSnapshot(int));
   MOCK_METHOD3(allocDmaBuffer, void*(int, size_t sizeInBytes, bool));
   MOCK_METHOD1(freeDmaBuffer, void(void*));
   MOCK_METHOD2(getTraceBufferSizeMasterMinion, size_t(int, TraceBufferType));
@@ -139,6 +140,9 @@ public:
     ON_CALL(*this, clearDeviceAttributes).WillByDefault([this](int device, std::string relGroupPath) {
       delegate_->clearDeviceAttributes(device, relGroupPath);
     });
+    ON_CALL(*this, getDeviceStatsSnapshot).WillByDefault([this](int device) {
+      return delegate_->getDeviceStatsSnapshot(device);
+    });
     ON_CALL(*this, reinitDeviceInstance)
       .WillByDefault([this](int device, bool masterMinionOnly, std::chrono::milliseconds timeout) {
         delegate_->reinitDeviceInstance(device, masterMinionOnly, timeout);
@@ -9,10 +9,12 @@
 #include <hostUtils/debug/StackException.h>
 #include <sw-sysemu/SysEmuOptions.h>
 
+#include <algorithm>
 #include <array>
 #include <chrono>
 #include <cstddef>
 #include <memory>
+#include <string>
 #include <vector>
 
 /// \defgroup device_api Device API
@@ -123,6 +125,7 @@ struct DEVICE_LAYER_EXPORT CmdFlagMM {
   bool isDma_ = false;
   bool isHpSq_ = false;
   bool isP2pDma_ = false;
+  bool isDmaChain_ = false; ///< the driver fills in the bus address of the host buffer of a DMA chain command
 };
 
 /// \brief This enum contains possible trace buffer types to extract from SP
@@ -135,6 +138,55 @@ enum class TraceBufferType {
   TraceBufferTypeNum
 };
 
+/// \brief Statistics of a virtual queue (VQ) of a device, see \ref DeviceStatsSnapshot
+struct DEVICE_LAYER_EXPORT VqStats {
+  enum class Type { MgmtSQ, MgmtCQ, OpsHpSQ, OpsSQ, OpsCQ };
+  Type type_;                   ///< device and kind of the VQ
+  uint16_t index_;              ///< index of the VQ in its device
+  uint32_t utilizationPercent_; ///< used space of the VQ buffer
+  uint64_t msgCount_;           ///< messages sent/received
+  uint64_t byteCount_;          ///< bytes sent/received
+  uint64_t msgRate_;            ///< messages per second
+  uint64_t byteRate_;           ///< bytes per second
+  uint64_t overflowCount_;      ///< responses held back by the driver, CQs only
+};
+
+/// \brief Snapshot of the VQ, memory and error statistics of a device, all taken in one read. These are the
+/// statistics of the attribute groups mgmt_vq_stats, ops_vq_stats, mem_stats and err_stats.
+struct DEVICE_LAYER_EXPORT DeviceStatsSnapshot {
+  /// Error counters, correctable (CE) and uncorrectable (UCE), in the order of errorCounters_
+  enum class ErrorCounter {
+    DramCE,
+    MinionCE,
+    PcieCE,
+    PmicCE,
+    SpCE,
+    SpExceptCE,
+    SramCE,
+    ThermOvershootCE,
+    ThermThrottleCE,
+    DramUCE,
+    MinionHangUCE,
+    PcieUCE,
+    SpHangUCE,
+    SpWdogUCE,
+    SramUCE,
+    SpTraceFullCE
+  };
+  uint32_t version_ = 0;                   ///< version of the driver snapshot layout, 0 if not supported
+  std::chrono::nanoseconds timestamp_{0};  ///< monotonic time of the snapshot
+  std::vector<uint64_t> errorCounters_;    ///< indexed by ErrorCounter, empty if the mgmt device is not ready
+  uint64_t cmaAllocated_ = 0;              ///< CMA allocated in bytes
+  uint64_t cmaAllocationRate_ = 0;         ///< CMA allocation rate in bytes/sec
+  std::vector<VqStats> vqs_;               ///< VQs of the ready devices
+
+  /// \brief returns an error counter, 0 if it is not in the snapshot
+  uint64_t getErrorCounter(ErrorCounter counter) const {
+    auto idx = static_cast<size_t>(counter);
+    return idx < errorCounters_.size() ? errorCounters_[idx] : 0;
+  }
+};
+
 class DEVICE_LAYER_EXPORT Exception : public dbg::StackException {
   using dbg::StackException::StackException;
 };
@@ -155,6 +207,32 @@ public:
   virtual bool sendCommandMasterMinion(int device, int sqIdx, std::byte* command, size_t commandSize,
                                        CmdFlagMM flags) = 0;
 
+  /// \brief Sends several commands to the master minion in a single call, so the device is notified just once. This
+  /// is meant to reduce the per-command overhead of bursts of small commands. Commands are sent in order until the
+  /// first one which doesn't fit in the submission queue. DMA commands can't be batched. The default implementation
+  /// calls `sendCommandMasterMinion()` repeatedly.
+  ///
+  /// @param[in] device indicating which device to send the commands.
+  /// @param[in] sqIdx indicates which submission queue to send the commands to.
+  /// @param[in] commands its a buffer which contains the commands back to back.
+  /// @param[in] commandSizes the size of each command in the buffer.
+  /// @param[in] flags indicates command options as defined by `CmdFlagMM`, common to all commands.
+  ///
+  /// @returns the number of commands sent, those are the first ones of the buffer. 0 if there was not enough space.
+  ///
+  virtual size_t sendCommandsMasterMinion(int device, int sqIdx, std::byte* commands,
+                                          const std::vector<size_t>& commandSizes, CmdFlagMM flags) {
+    size_t count = 0;
+    for (auto size : commandSizes) {
+      if (!sendCommandMasterMinion(device, sqIdx, commands, size, flags)) {
+        break;
+      }
+      commands += size;
+      ++count;
+    }
+    return count;
+  }
+
   /// \brief Set the submission queue availability threshold. Submission queue epoll event will be generated only if
   /// space on submission queue is greater or equal to this threshold set. Default threshold value is one forth of size
   /// of submission queue buffer returned by `getSubmissionQueueSizeMasterMinion()`.
@@ -188,6 +266,56 @@ public:
   ///
   virtual bool receiveResponseMasterMinion(int device, std::vector<std::byte>& response) = 0;
 
+  /// \brief Receives several responses from the device in a single call, a non-blocking interface. This is meant to
+  /// reduce the per-response overhead when there are many responses waiting. The default implementation calls
+  /// `receiveResponseMasterMinion()` repeatedly.
+  ///
+  /// @param[in] device indicating which device to receive the responses from.
+  /// @param[inout] responses buffers where responses will be stored; its size is the maximum number of responses to
+  /// receive. Buffers are resized as needed.
+  ///
+  /// @returns the number of responses received, those are the first elements of responses. 0 if there was no response.
+  ///
+  virtual size_t receiveResponsesMasterMinion(int device, std::vector<std::vector<std::byte>>& responses) {
+    size_t count = 0;
+    while (count < responses.size() && receiveResponseMasterMinion(device, responses[count])) {
+      ++count;
+    }
+    return count;
+  }
+
+  /// \brief Receives several responses from one of the completion queues of the device, a non-blocking interface. The
+  /// responses of the commands sent to a submission queue always come back through the same completion queue, so each
+  /// completion queue can be drained by a thread of its own. The default implementation only knows about one
+  /// completion queue.
+  ///
+  /// @param[in] device indicating which device to receive the responses from.
+  /// @param[in] cqIdx indicates which completion queue to receive from, within `getCompletionQueuesCount()`
+  /// @param[inout] responses same as in `receiveResponsesMasterMinion()`
+  ///
+  /// @returns the number of responses received, those are the first elements of responses. 0 if there was no response.
+  ///
+  virtual size_t receiveResponsesFromCqMasterMinion(int device, int cqIdx,
+                                                    std::vector<std::vector<std::byte>>& responses) {
+    return cqIdx == 0 ? receiveResponsesMasterMinion(device, responses) : 0;
+  }
+
+  /// \brief Blocks the caller thread until the given completion queue may have responses to be received, or the
+  /// timeout expires. The default implementation waits for any epoll event of the device.
+  ///
+  /// @param[in] device indicating which device to wait on.
+  /// @param[in] cqIdx indicates which completion queue to wait on, within `getCompletionQueuesCount()`
+  /// @param[in] timeout the operation will be aborted if no event happen in given timeout
+  ///
+  /// @returns false if the timeout expired.
+  ///
+  virtual bool waitForCqEventMasterMinion(int device, [[maybe_unused]] int cqIdx, std::chrono::milliseconds timeout) {
+    uint64_t sqBitmap;
+    bool cqAvailable;
+    waitForEpollEventsMasterMinion(device, sqBitmap, cqAvailable, timeout);
+    return cqAvailable;
+  }
+
   /// \brief Sends a command to the service processor. If the method returns false, the caller should try later when the
   /// queue has enough space indicated by availability from `waitForEpollEventsServiceProcessor()`
   ///
@@ -262,12 +390,21 @@ public:
   ///
   virtual int getSubmissionQueuesCount(int device) const = 0;
 
+  /// \brief Returns the number of completion queues associated to given device, each of them receiving the responses
+  /// of one or several submission queues
+  ///
+  /// @returns the number of completion queues
+  ///
+  virtual int getCompletionQueuesCount([[maybe_unused]] int device) const {
+    return 1;
+  }
+
   /// \brief Gets device state associated to given Master Minion device and returns enum DeviceState
   /// If the caller didn't send any command in current session and received DeviceState::PendingCommands,
   /// then caller may choose to reset the device by sending abort commands and discard any previous
   /// responses. If received DeviceState::NotResponding, then caller should try to recover by sending
-  /// abort commands. Caller should be careful in polling on this method because it directly gets status
-  /// from device and hence can be expensive in I/O transactions with device.
+  /// abort commands. Implementations may answer from a cached snapshot of the device state, which is
+  /// refreshed whenever it could have changed (see \ref invalidateCachedState).
   ///
   /// @returns enum DeviceState
   ///
@@ -277,8 +414,8 @@ public:
   /// If the caller didn't send any command in current session and received DeviceState::PendingCommands,
   /// then caller may choose to reset the device by sending abort commands and discard any previous
   /// responses. If received DeviceState::NotResponding, then caller should try to recover by sending
-  /// abort commands. Caller should be careful in polling on this method because it directly gets status
-  /// from device and hence can be expensive in I/O transactions with device.
+  /// abort commands. Implementations may answer from a cached snapshot of the device state, which is
+  /// refreshed whenever it could have changed (see \ref invalidateCachedState).
   ///
   /// @returns enum DeviceState
   ///
@@ -320,6 +457,29 @@ public:
   virtual bool getTraceBufferServiceProcessor(int device, TraceBufferType traceType,
                                               std::vector<std::byte>& traceBuf) = 0;
 
+  /// \brief Reads part of a Service Processor's trace buffer, so that a consumer following the buffer only copies the
+  /// data added since its last read instead of the whole buffer. The default implementation extracts the whole buffer
+  /// with \ref getTraceBufferServiceProcessor and keeps the requested range.
+  ///
+  /// @param[in] device indicating which device to read the buffer from.
+  /// @param[in] traceType indicating the type of trace buffer to read.
+  /// @param[in] offset in bytes from the start of the trace buffer.
+  /// @param[out] buf memory receiving the data.
+  /// @param[in] size in bytes of buf.
+  ///
+  /// @returns the number of bytes read, 0 if offset is past the end of the buffer or there was no buffer.
+  ///
+  virtual size_t readTraceBufferServiceProcessor(int device, TraceBufferType traceType, size_t offset, std::byte* buf,
+                                                 size_t size) {
+    std::vector<std::byte> traceBuf;
+    if (!getTraceBufferServiceProcessor(device, traceType, traceBuf) || offset >= traceBuf.size()) {
+      return 0;
+    }
+    auto count = std::min(size, traceBuf.size() - offset);
+    std::copy_n(traceBuf.begin() + static_cast<long>(offset), count, buf);
+    return count;
+  }
+
   /// \brief Writes firmware image on DRAM of given device
   ///
   /// @param[in] device indicating which device's DRAM to be written.
@@ -415,6 +575,27 @@ public:
   ///
   virtual void clearDeviceAttributes(int device, std::string relGroupPath) const = 0;
 
+  /// \brief Get all the device statistics in one read, instead of one \ref getDeviceAttribute call and one text
+  /// attribute file per statistic. The default implementation returns an empty snapshot (version_ 0).
+  ///
+  /// @param[in] device the device which will be queried
+  ///
+  /// @returns the snapshot of the device statistics
+  ///
+  virtual DeviceStatsSnapshot getDeviceStatsSnapshot([[maybe_unused]] int device) const {
+    return DeviceStatsSnapshot{};
+  }
+
+  /// \brief Drops the device state and attributes cached by the device-layer, so the next queries reach the device
+  /// again. Caches are already refreshed on the state changes the device-layer goes through (commands sent, resets,
+  /// reinitializations), this is only needed after changes made from outside of it, e.g. through sysfs. The default
+  /// implementation does nothing.
+  ///
+  /// @param[in] device the device whose cached state is dropped
+  ///
+  virtual void invalidateCachedState([[maybe_unused]] int device) {
+  }
+
   /// \brief Reinitialize the device master minion or both master minion and service processor
   /// NOTE: During master minion reinitialization other master minion APIs cannot be used. During both
   /// devices' reinitialization no other API should be used.
@@ -441,6 +622,77 @@ public:
   /// @returns true if deviceA and deviceB are compatible for P2P DMA, false otherwise
   ///
   virtual bool checkP2pDmaCompatibility(int deviceA, int deviceB) const = 0;
+
+  /// \brief Pins a range of host memory so it can be used directly as source or destination of DMA commands, without
+  /// going through a buffer allocated with \ref allocDmaBuffer. The memory must be kept alive until it's unregistered
+  /// with \ref unregisterHostMemory.
+  ///
+  /// @param[in] device the device which will access the host memory
+  /// @param[in] hostPtr start of the host memory range
+  /// @param[in] sizeInBytes size, in bytes, of the host memory range
+  /// @param[in] toDeviceOnly true if the memory is only used as source of DMA commands; it's then pinned without write
+  /// access, so read-only memory can be registered too, and it must not be used as destination of DMA commands
+  ///
+  /// @returns the number of DMA contiguous segments backing the memory range; 0 if this device-layer doesn't support
+  /// registering host memory, in which case the memory can't be used directly in DMA commands
+  ///
+  virtual size_t registerHostMemory([[maybe_unused]] int device, [[maybe_unused]] const void* hostPtr,
+                                    [[maybe_unused]] size_t sizeInBytes, [[maybe_unused]] bool toDeviceOnly) {
+    return 0;
+  }
+
+  /// \brief Unpins a range of host memory previously registered with \ref registerHostMemory. There must not be any
+  /// DMA command in flight using this memory.
+  ///
+  /// @param[in] device the device where the memory was registered
+  /// @param[in] hostPtr start of the host memory range, as given to \ref registerHostMemory
+  ///
+  virtual void unregisterHostMemory([[maybe_unused]] int device, [[maybe_unused]] const void* hostPtr) {
+  }
+
+  /// \brief Tells if any host memory, even not registered with \ref registerHostMemory, can be used directly as source
+  /// or destination of DMA commands. The device-layer then pins and maps the memory only while each DMA command is in
+  /// flight, so the memory must be kept alive until the command is completed.
+  ///
+  /// @param[in] device the device which will access the host memory
+  ///
+  /// @returns true if the host memory of DMA commands can be used directly, false if it has to be in a buffer
+  /// allocated with \ref allocDmaBuffer or registered with \ref registerHostMemory
+  ///
+  virtual bool canStreamHostMemory([[maybe_unused]] int device) const {
+    return false;
+  }
+
+  /// \brief Returns the host managed DRAM of the device (from \ref getDramBaseAddress, \ref getDramSize bytes) mapped
+  /// in the process, so small transfers can be done with plain loads and stores instead of DMA commands. Stores are
+  /// write-combined: they must be followed by a store fence before sending any command which uses that memory. Loads
+  /// are uncached, and so slow.
+  ///
+  /// @param[in] device the device whose DRAM to map
+  ///
+  /// @returns the host address of \ref getDramBaseAddress; nullptr if this device-layer, or the driver, doesn't allow
+  /// mapping the DRAM
+  ///
+  virtual std::byte* getMappedDram([[maybe_unused]] int device) const {
+    return nullptr;
+  }
+
+  /// \brief Same as \ref allocDmaBuffer, but the memory is backed by hugepages (1GB if sizeInBytes is a multiple of
+  /// 1GB, 2MB otherwise) and registered for DMA with \ref registerHostMemory instead of taken from CMA. Hugepages need
+  /// far fewer IOMMU and TLB entries, and DMA list nodes, than the same size in 4KB pages. It must be deallocated with
+  /// \ref freeDmaBuffer.
+  ///
+  /// @param[in] device the device which will access the memory
+  /// @param[in] sizeInBytes size, in bytes, for the memory allocation; it's rounded up to the hugepage size
+  /// @param[in] writeable indicates if the memory should be writeable or, if false, readonly.
+  ///
+  /// @returns a chunk of memory which is suitable to be used in DMA operations; nullptr if this device-layer doesn't
+  /// support it or there are not enough free hugepages, in which case \ref allocDmaBuffer has to be used instead
+  ///
+  virtual void* allocHugePageDmaBuffer([[maybe_unused]] int device, [[maybe_unused]] size_t sizeInBytes,
+                                       [[maybe_unused]] bool writeable) {
+    return nullptr;
+  }
 };
 
 class DEVICE_LAYER_EXPORT IDeviceLayer : public IDeviceAsync, public IDeviceSync {
@@ -476,6 +728,40 @@ public:
   static std::unique_ptr<IDeviceLayer> createPcieDeviceLayer(bool enableMasterMinion = true,
                                                              bool enableServiceProcessor = false);
 
+  /// \brief Factory method to instantiate a IDeviceApi implementation, based on Pcie backend, which submits the bursts
+  /// of commands and the pops of all the completion queues to the driver through io_uring, with a single syscall.
+  /// Falls back to IOCTLs if the kernel or the driver don't support io_uring passthrough commands.
+  ///
+  /// @param[in] enableMasterMinion same as in `createPcieDeviceLayer()`
+  /// @param[in] enableServiceProcessor same as in `createPcieDeviceLayer()`
+  /// @returns std::unique_ptr<IDeviceApi> is the IDeviceApi implementation
+  ///
+  static std::unique_ptr<IDeviceLayer> createPcieUringDeviceLayer(bool enableMasterMinion = true,
+                                                                  bool enableServiceProcessor = false);
+
+  /// \brief Factory method to instantiate a IDeviceApi implementation which forwards everything to another one,
+  /// recording the commands sent to the master minion and service processor and the responses received, with their
+  /// timestamps. The data moved by the DMA commands is not recorded. See \ref createReplayDeviceLayer
+  ///
+  /// @param[in] deviceLayer the IDeviceApi implementation whose traffic is recorded, usually a Pcie one
+  /// @param[in] path file the recording is written to, overwritten if it exists
+  /// @returns std::unique_ptr<IDeviceApi> is the IDeviceApi implementation
+  ///
+  static std::unique_ptr<IDeviceLayer> createRecordingDeviceLayer(std::unique_ptr<IDeviceLayer> deviceLayer,
+                                                                  const std::string& path);
+
+  /// \brief Factory method to instantiate a IDeviceApi implementation which needs no device: it serves the responses
+  /// of a recording made by \ref createRecordingDeviceLayer, each one once the commands which preceded it in the
+  /// recording have been sent again. Meant to benchmark the host side of the stack replaying the recorded program;
+  /// the SQs are never full and the DMA commands don't move any data.
+  ///
+  /// @param[in] path file of the recording
+  /// @param[in] recordedLatency if this is true, each response is delayed by the time it took in the recording since
+  /// the last command which preceded it; otherwise the responses are available as soon as these commands are sent
+  /// @returns std::unique_ptr<IDeviceApi> is the IDeviceApi implementation
+  ///
+  static std::unique_ptr<IDeviceLayer> createReplayDeviceLayer(const std::string& path, bool recordedLatency = true);
+
   /// \brief Virtual Destructor to enable polymorphic release of the IDeviceApi
   /// instances
   virtual ~IDeviceLayer() = default;
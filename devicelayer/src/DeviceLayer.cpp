@@ -4,6 +4,8 @@
  *-------------------------------------------------------------------------*/
 
 #include "DevicePcie.h"
+#include "DeviceRecorder.h"
+#include "DeviceReplay.h"
 #include "DeviceSysEmuMulti.h"
 #include <sw-sysemu/SysEmuOptions.h>
 
@@ -27,3 +29,16 @@ std::unique_ptr<IDeviceLayer> IDeviceLayer::createPcieDeviceLayer(bool enableMas
   return std::make_unique<DevicePcie>(enableMasterMinion, enableServiceProcessor);
 }
 
+std::unique_ptr<IDeviceLayer> IDeviceLayer::createPcieUringDeviceLayer(bool enableMasterMinion,
+                                                                       bool enableServiceProcessor) {
+  return std::make_unique<DevicePcie>(enableMasterMinion, enableServiceProcessor, true);
+}
+
+std::unique_ptr<IDeviceLayer> IDeviceLayer::createRecordingDeviceLayer(std::unique_ptr<IDeviceLayer> deviceLayer,
+                                                                       const std::string& path) {
+  return std::make_unique<DeviceRecorder>(std::move(deviceLayer), path);
+}
+
+std::unique_ptr<IDeviceLayer> IDeviceLayer::createReplayDeviceLayer(const std::string& path, bool recordedLatency) {
+  return std::make_unique<DeviceReplay>(path, recordedLatency);
+}
@@ -4,6 +4,8 @@
  *-------------------------------------------------------------------------*/
 #include "DevicePcie.h"
 #include "Utils.h"
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstring>
 #include <dirent.h>
@@ -11,12 +13,16 @@
 #include <fstream>
 #include <iomanip>
 #include <mutex>
+#include <numeric>
+#include <poll.h>
 #include <regex>
 #include <stdio.h>
 #include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <sys/ioctl.h>
 #include <sys/mman.h>
 #include <unistd.h>
+#include <unordered_set>
 
 #if __has_include(<filesystem>)
 #include <filesystem>
@@ -87,6 +93,9 @@ inline cmd_desc_flag parseCmdFlagMM(CmdFlagMM flags) {
   if (flags.isP2pDma_) {
     descFlags |= static_cast<std::byte>(CMD_DESC_FLAG_P2PDMA);
   }
+  if (flags.isDmaChain_) {
+    descFlags |= static_cast<std::byte>(CMD_DESC_FLAG_DMA_CHAIN);
+  }
   return static_cast<cmd_desc_flag>(static_cast<uint8_t>(descFlags));
 }
 
@@ -213,6 +222,9 @@ int openAndConfigEpoll(int fd) {
   return epFd;
 }
 
+// number of failed ioctls, any of them invalidates the cached device states
+std::atomic<uint64_t> ioctlErrors = 0;
+
 template <typename... Types> IoctlResult wrap_ioctl(int fd, unsigned long int request, Types&&... args) {
   std::stringstream params;
   ((params << ", " << std::forward<Types>(args)), ...);
@@ -220,11 +232,97 @@ template <typename... Types> IoctlResult wrap_ioctl(int fd, unsigned long int re
   auto res = ::ioctl(fd, request, args...);
   if (res < 0 && errno != EAGAIN) {
     DV_LOG(WARNING) << "IOCTL failed. FD: " << fd << " request: " << request << " args: " << params.str();
+    ioctlErrors.fetch_add(1, std::memory_order_acq_rel);
     throw Exception("Failed to execute IOCTL: '"s + std::strerror(errno) + "'"s);
   }
   return {res};
 }
 
+// control block of the circular buffers shared with the device, see et_circbuffer.h in the driver
+struct CircBuffer {
+  uint64_t head_;
+  uint64_t tail_;
+  uint64_t len_;
+  uint64_t pad_;
+};
+
+// pushes the data on a SQ circular buffer mmap()ed from the device. Returns false if there is not enough room
+bool pushCircBuffer(std::byte* cbMem, const std::byte* data, size_t size) {
+  auto cb = reinterpret_cast<volatile CircBuffer*>(cbMem);
+  uint64_t head = cb->head_;
+  uint64_t tail = cb->tail_;
+  uint64_t len = cb->len_;
+  if (len == 0 || head >= len || tail >= len) {
+    throw Exception("Invalid SQ circular buffer header");
+  }
+  auto used = head >= tail ? head - tail : len + head - tail;
+  if (size > len - 1 - used) {
+    return false;
+  }
+  auto buf = cbMem + sizeof(CircBuffer);
+  auto first = std::min<uint64_t>(size, len - head);
+  std::memcpy(buf + head, data, first);
+  std::memcpy(buf, data + first, size - first);
+  // the device must see the data before the new head
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  cb->head_ = (head + size) % len;
+  return true;
+}
+
+// pops one response from a CQ circular buffer mmap()ed from the device. Returns false if there is none
+bool popCircBuffer(std::byte* cbMem, std::vector<std::byte>& response) {
+  auto cb = reinterpret_cast<volatile CircBuffer*>(cbMem);
+  uint64_t head = cb->head_;
+  uint64_t tail = cb->tail_;
+  uint64_t len = cb->len_;
+  if (len == 0 || head >= len || tail >= len) {
+    throw Exception("Invalid CQ circular buffer header");
+  }
+  auto used = head >= tail ? head - tail : len + head - tail;
+  auto buf = cbMem + sizeof(CircBuffer);
+  auto read = [buf, len](uint64_t offset, std::byte* dst, size_t size) {
+    auto first = std::min<uint64_t>(size, len - offset);
+    std::memcpy(dst, buf + offset, first);
+    std::memcpy(dst + first, buf, size - first);
+  };
+  // all messages start with a cmn_header_t, its first field is the size of the response after the header
+  constexpr size_t kHeaderSize = 8;
+  if (used < kHeaderSize) {
+    return false;
+  }
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  uint16_t payloadSize;
+  read(tail, reinterpret_cast<std::byte*>(&payloadSize), sizeof(payloadSize));
+  if (used < kHeaderSize + payloadSize) {
+    return false;
+  }
+  response.resize(kHeaderSize + payloadSize);
+  read(tail, response.data(), response.size());
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  cb->tail_ = (tail + response.size()) % len;
+  return true;
+}
+
+void ringDoorbell(std::byte* doorbell, const vq_map_desc& info) {
+  auto reg = doorbell + info.doorbell_offset;
+  switch (info.doorbell_size) {
+  case 1:
+    *reinterpret_cast<volatile uint8_t*>(reg) = info.doorbell_value;
+    break;
+  case 2:
+    *reinterpret_cast<volatile uint16_t*>(reg) = info.doorbell_value;
+    break;
+  case 4:
+    *reinterpret_cast<volatile uint32_t*>(reg) = info.doorbell_value;
+    break;
+  case 8:
+    *reinterpret_cast<volatile uint64_t*>(reg) = info.doorbell_value;
+    break;
+  default:
+    throw Exception("Invalid doorbell size: " + std::to_string(info.doorbell_size));
+  }
+}
+
 DeviceState getDeviceState(int fd) {
   uint32_t devState;
   wrap_ioctl(fd, ETSOC1_IOCTL_GET_DEVICE_STATE, &devState);
@@ -301,6 +399,17 @@ int openWhenReady(const std::string path, std::chrono::seconds timeout) {
 }
 
 constexpr int kMaxEpollEvents = 6;
+// commands submitted per io_uring syscall at most
+constexpr unsigned kUringEntries = 64;
+constexpr auto kCmaFreeCacheTime = std::chrono::milliseconds(100);
+
+// attributes which don't change while the device is bound to the driver, the rest are read from sysfs every time
+bool isStaticAttribute(const std::string& relAttrPath) {
+  static const std::unordered_set<std::string> kStaticAttributes = {
+    "class",          "device",         "vendor",    "subsystem_device", "subsystem_vendor", "revision",
+    "max_link_speed", "max_link_width", "numa_node", "local_cpulist",    "local_cpus",       "driver/module/version"};
+  return kStaticAttributes.count(relAttrPath) > 0;
+}
 } // namespace
 namespace dev {
 
@@ -349,8 +458,16 @@ void DevicePcie::setupDeviceInfo(int device, DevInfo& deviceInfo, bool enableMgm
 
     wrap_ioctl(deviceInfo.fdOps_, ETSOC1_IOCTL_GET_USER_DRAM_INFO, &deviceInfo.userDram_);
     wrap_ioctl(deviceInfo.fdOps_, ETSOC1_IOCTL_GET_SQ_COUNT, &deviceInfo.mmSqCount_);
+    // not using wrap_ioctl here because older drivers don't implement this ioctl; those only handle one CQ
+    if (::ioctl(deviceInfo.fdOps_, ETSOC1_IOCTL_GET_CQ_COUNT, &deviceInfo.mmCqCount_) < 0) {
+      deviceInfo.mmCqCount_ = 1;
+    }
     wrap_ioctl(deviceInfo.fdOps_, ETSOC1_IOCTL_GET_SQ_MAX_MSG_SIZE, &deviceInfo.mmSqMaxMsgSize_);
     wrap_ioctl(deviceInfo.fdOps_, ETSOC1_IOCTL_GET_P2PDMA_DEVICE_COMPAT_BITMAP, &deviceInfo.p2pCompatBitmap_);
+    setupUserVqs(deviceInfo);
+    setupCqEventFds(deviceInfo);
+    setupMappedDram(deviceInfo);
+    setupUringVqs(deviceInfo);
 
     logs << std::endl;
     logInfoLine(logs, "PCIe target:", path);
@@ -358,8 +475,12 @@ void DevicePcie::setupDeviceInfo(int device, DevInfo& deviceInfo, bool enableMgm
     logInfoLine(logs, "DRAM size (B):", deviceInfo.userDram_.size, true);
     logInfoLine(logs, "DRAM alignment (bits):", deviceInfo.userDram_.align_in_bits);
     logInfoLine(logs, "MM SQ count:", deviceInfo.mmSqCount_, true);
+    logInfoLine(logs, "MM CQ count:", deviceInfo.mmCqCount_, true);
     logInfoLine(logs, "MM VQ Maximum message size (B):", deviceInfo.mmSqMaxMsgSize_, true);
     logInfoLine(logs, "P2P compatibility bitmap:", deviceInfo.p2pCompatBitmap_, true);
+    logInfoLine(logs, "User-space VQs:", deviceInfo.userVqs_ ? "yes" : "no");
+    logInfoLine(logs, "Mapped DRAM:", deviceInfo.mappedDram_ ? "yes" : "no");
+    logInfoLine(logs, "io_uring VQs:", deviceInfo.uringVqs_ ? "yes" : "no");
   }
 
   auto fd = mgmtEnabled_ ? deviceInfo.fdMgmt_ : deviceInfo.fdOps_;
@@ -459,8 +580,133 @@ void DevicePcie::setupDeviceInfo(int device, DevInfo& deviceInfo, bool enableMgm
   DV_DLOG(DEBUG) << logs.str();
 }
 
+void DevicePcie::setupUserVqs(DevInfo& deviceInfo) const {
+  deviceInfo.userVqs_.reset();
+  auto eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (eventFd < 0) {
+    throw Exception("Error creating eventfd: '"s + std::strerror(errno) + "'");
+  }
+  vq_map_desc info{};
+  info.eventfd = eventFd;
+  // not using wrap_ioctl here because the driver only allows it when loaded with user_vq=1 and for processes with
+  // CAP_SYS_RAWIO; keep pushing and popping through the driver otherwise
+  if (::ioctl(deviceInfo.fdOps_, ETSOC1_IOCTL_MAP_VQS, &info) < 0) {
+    DV_VLOG(HIGH) << "User-space VQs not available: '" << std::strerror(errno) << "'";
+    close(eventFd);
+    return;
+  }
+
+  // from here on the driver doesn't push on the SQs nor pop from the CQs anymore, so there is no fallback
+  auto vqs = std::make_unique<UserVqs>(info.sq_count, info.cq_count);
+  vqs->info_ = info;
+  vqs->eventFd_ = eventFd;
+  auto vqBuffer = mmap(nullptr, info.vq_buf_size, PROT_READ | PROT_WRITE, MAP_SHARED, deviceInfo.fdOps_,
+                       static_cast<off_t>(ETSOC1_MMAP_OFFSET_VQ_BUFFER));
+  if (vqBuffer == MAP_FAILED) {
+    throw Exception("Error mmap of VQ buffer: '"s + std::strerror(errno) + "'");
+  }
+  vqs->vqBuffer_ = static_cast<std::byte*>(vqBuffer);
+  auto doorbell = mmap(nullptr, static_cast<size_t>(sysconf(_SC_PAGESIZE)), PROT_WRITE, MAP_SHARED,
+                       deviceInfo.fdOps_, static_cast<off_t>(ETSOC1_MMAP_OFFSET_DOORBELL));
+  if (doorbell == MAP_FAILED) {
+    throw Exception("Error mmap of VQ doorbell: '"s + std::strerror(errno) + "'");
+  }
+  vqs->doorbell_ = static_cast<std::byte*>(doorbell);
+
+  epoll_event epEvent;
+  epEvent.events = EPOLLIN | EPOLLET;
+  epEvent.data.fd = eventFd;
+  if (epoll_ctl(deviceInfo.epFdOps_, EPOLL_CTL_ADD, eventFd, &epEvent) < 0) {
+    throw Exception("Error setting up epoll for CQ eventfd: '"s + std::strerror(errno) + "'"s);
+  }
+  deviceInfo.userVqs_ = std::move(vqs);
+}
+
+void DevicePcie::setupMappedDram(DevInfo& deviceInfo) const {
+  deviceInfo.mappedDram_ = nullptr;
+  // the driver only allows it when loaded with user_dram=1 and for processes with CAP_SYS_RAWIO; small memcpys keep
+  // going through DMA commands otherwise
+  auto dram = mmap(nullptr, deviceInfo.userDram_.size, PROT_READ | PROT_WRITE, MAP_SHARED, deviceInfo.fdOps_,
+                   static_cast<off_t>(ETSOC1_MMAP_OFFSET_DEVICE_DRAM));
+  if (dram == MAP_FAILED) {
+    DV_VLOG(HIGH) << "Mapped DRAM not available: '" << std::strerror(errno) << "'";
+    return;
+  }
+  deviceInfo.mappedDram_ = static_cast<std::byte*>(dram);
+}
+
+void DevicePcie::setupUringVqs(DevInfo& deviceInfo) const {
+  deviceInfo.uringVqs_.reset();
+  if (!useIoUring_ || deviceInfo.userVqs_) {
+    // user-space VQs are not pushed nor popped by the driver
+    return;
+  }
+  std::unique_ptr<UringVqs> vqs;
+  try {
+    vqs = std::make_unique<UringVqs>(kUringEntries);
+  } catch (const Exception& ex) {
+    DV_LOG(WARNING) << "io_uring not available, using IOCTLs: " << ex.what();
+    return;
+  }
+  // a pop without buffer fails with EINVAL if the driver supports io_uring commands, EOPNOTSUPP otherwise
+  rsp_desc rspInfo{};
+  vqs->pop_.queueCommand(deviceInfo.fdOps_, ETSOC1_IOCTL_POP_CQ, &rspInfo, sizeof(rspInfo), false);
+  if (auto res = vqs->pop_.submitAndWait().front(); res == -EOPNOTSUPP) {
+    DV_LOG(INFO) << "Driver does not support io_uring commands, using IOCTLs";
+    return;
+  }
+  vqs->rspInfos_.resize(kUringEntries * ETSOC1_POP_CQ_BATCH_MAX_COUNT);
+  deviceInfo.uringVqs_ = std::move(vqs);
+}
+
+void DevicePcie::setupCqEventFds(DevInfo& deviceInfo) const {
+  deviceInfo.cqEventFds_.clear();
+  if (deviceInfo.userVqs_ || deviceInfo.mmCqCount_ <= 1) {
+    // user-space VQs only get the eventfd of the CQ interrupts
+    return;
+  }
+  for (uint16_t cqIdx = 0; cqIdx < deviceInfo.mmCqCount_; ++cqIdx) {
+    auto eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (eventFd < 0) {
+      throw Exception("Error creating eventfd: '"s + std::strerror(errno) + "'");
+    }
+    vq_eventfd_desc info{};
+    info.eventfd = eventFd;
+    info.cq_index = cqIdx;
+    info.type = VQ_EVENTFD_CQ_AVAIL;
+    // not using wrap_ioctl here because older drivers don't implement this ioctl; in that case all CQs are waited
+    // through the epoll of the ops file
+    if (::ioctl(deviceInfo.fdOps_, ETSOC1_IOCTL_SET_VQ_EVENTFD, &info) < 0) {
+      DV_VLOG(HIGH) << "CQ eventfds not available: '" << std::strerror(errno) << "'";
+      close(eventFd);
+      for (auto fd : deviceInfo.cqEventFds_) {
+        close(fd);
+      }
+      deviceInfo.cqEventFds_.clear();
+      return;
+    }
+    deviceInfo.cqEventFds_.emplace_back(eventFd);
+  }
+}
+
 void DevicePcie::teardownDeviceInfo(const DevInfo& deviceInfo, bool disableMgmt, bool disableOps) const {
+  if (disableOps && deviceInfo.userVqs_) {
+    // the mappings keep the ops file open
+    const auto& vqs = *deviceInfo.userVqs_;
+    if (munmap(vqs.vqBuffer_, vqs.info_.vq_buf_size) != 0 ||
+        munmap(vqs.doorbell_, static_cast<size_t>(sysconf(_SC_PAGESIZE))) != 0) {
+      throw Exception("Error munmap of VQs: '"s + std::strerror(errno) + "'");
+    }
+    close(vqs.eventFd_);
+  }
+  if (disableOps && deviceInfo.mappedDram_ && munmap(deviceInfo.mappedDram_, deviceInfo.userDram_.size) != 0) {
+    throw Exception("Error munmap of DRAM: '"s + std::strerror(errno) + "'");
+  }
   if (disableOps) {
+    // the driver drops its references to the CQ eventfds when the ops file is closed
+    for (auto fd : deviceInfo.cqEventFds_) {
+      close(fd);
+    }
     auto res = close(deviceInfo.fdOps_);
     if (res < 0) {
       throw Exception("Failed to close ops file, error: '"s + std::strerror(errno) + "'"s);
@@ -483,9 +729,10 @@ void DevicePcie::teardownDeviceInfo(const DevInfo& deviceInfo, bool disableMgmt,
   }
 }
 
-DevicePcie::DevicePcie(bool enableOps, bool enableMgmt)
+DevicePcie::DevicePcie(bool enableOps, bool enableMgmt, bool useIoUring)
   : opsEnabled_(enableOps)
-  , mgmtEnabled_(enableMgmt) {
+  , mgmtEnabled_(enableMgmt)
+  , useIoUring_(useIoUring) {
   if (!(enableOps || enableMgmt)) {
     throw Exception("Ops or Mgmt must be enabled");
   }
@@ -518,7 +765,15 @@ DevicePcie::~DevicePcie() {
  * Common Mgmt and Ops APIs
  ***************************/
 size_t DevicePcie::getFreeCmaMemory() const {
-  return getCmaFreeMem();
+  auto now = std::chrono::steady_clock::now().time_since_epoch();
+  auto readTime = std::chrono::nanoseconds(cmaFreeTime_.load(std::memory_order_acquire));
+  if (readTime.count() != 0 && now - readTime < kCmaFreeCacheTime) {
+    return cmaFree_.load(std::memory_order_relaxed);
+  }
+  auto cmaFree = getCmaFreeMem();
+  cmaFree_.store(cmaFree, std::memory_order_relaxed);
+  cmaFreeTime_.store(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count(), std::memory_order_release);
+  return cmaFree;
 }
 
 int DevicePcie::getDevicesCount() const {
@@ -553,7 +808,75 @@ uint32_t DevicePcie::getFrequencyMHz(int device) {
 
 std::string DevicePcie::getDeviceAttribute(int device, std::string relAttrPath) const {
   CHECK_VALID_DEVICE(device);
-  return getDeviceAttributeByName(std::string(devices_[static_cast<uint32_t>(device)].devName_.data()), relAttrPath);
+  const auto& deviceInfo = devices_[static_cast<uint32_t>(device)];
+  if (!isStaticAttribute(relAttrPath)) {
+    return getDeviceAttributeByName(std::string(deviceInfo.devName_.data()), relAttrPath);
+  }
+  auto& cache = *deviceInfo.stateCache_;
+  std::lock_guard lock(cache.attributesMutex_);
+  if (auto it = cache.attributes_.find(relAttrPath); it != end(cache.attributes_)) {
+    return it->second;
+  }
+  auto value = getDeviceAttributeByName(std::string(deviceInfo.devName_.data()), relAttrPath);
+  cache.attributes_.emplace(relAttrPath, value);
+  return value;
+}
+
+DeviceStatsSnapshot DevicePcie::getDeviceStatsSnapshot(int device) const {
+  CHECK_VALID_DEVICE(device);
+  fs::path absAttrPath = fs::path("/sys/bus/pci/devices") /
+                         fs::path(std::string(devices_[static_cast<uint32_t>(device)].devName_.data())) /
+                         fs::path("stats_snapshot");
+  // The driver takes the snapshot again on every read, so it must be read at once
+  std::vector<std::byte> buffer(ET_STATS_SNAPSHOT_MAX_SIZE);
+  auto fd = open(absAttrPath.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    throw Exception("Unable to access '" + absAttrPath.string() + "': " + std::strerror(errno));
+  }
+  auto bytes = read(fd, buffer.data(), buffer.size());
+  auto readErrno = errno;
+  close(fd);
+  if (bytes < 0) {
+    throw Exception("Unable to read '" + absAttrPath.string() + "': " + std::strerror(readErrno));
+  }
+
+  et_stats_snapshot_header header;
+  if (static_cast<size_t>(bytes) < sizeof(header)) {
+    throw Exception("Invalid stats snapshot size: " + std::to_string(bytes));
+  }
+  std::memcpy(&header, buffer.data(), sizeof(header));
+  auto entriesSize = static_cast<size_t>(header.err_count + header.mem_count) * sizeof(uint64_t) +
+                     static_cast<size_t>(header.vq_count) * header.vq_entry_size;
+  if (header.version == 0 || header.size > static_cast<size_t>(bytes) ||
+      sizeof(header) + entriesSize > header.size) {
+    throw Exception("Invalid stats snapshot, version: " + std::to_string(header.version) +
+                    " size: " + std::to_string(header.size));
+  }
+
+  DeviceStatsSnapshot snapshot;
+  snapshot.version_ = header.version;
+  snapshot.timestamp_ = std::chrono::nanoseconds(header.timestamp_ns);
+  auto data = buffer.data() + sizeof(header);
+  snapshot.errorCounters_.resize(header.err_count);
+  std::memcpy(snapshot.errorCounters_.data(), data, header.err_count * sizeof(uint64_t));
+  data += header.err_count * sizeof(uint64_t);
+
+  std::vector<uint64_t> memStats(header.mem_count);
+  std::memcpy(memStats.data(), data, header.mem_count * sizeof(uint64_t));
+  data += header.mem_count * sizeof(uint64_t);
+  if (header.mem_count > ET_STATS_MEM_CMA_ALLOCATION_RATE) {
+    snapshot.cmaAllocated_ = memStats[ET_STATS_MEM_CMA_ALLOCATED];
+    snapshot.cmaAllocationRate_ = memStats[ET_STATS_MEM_CMA_ALLOCATION_RATE];
+  }
+
+  for (uint16_t i = 0; i < header.vq_count; i++, data += header.vq_entry_size) {
+    et_stats_snapshot_vq entry{};
+    std::memcpy(&entry, data, std::min<size_t>(sizeof(entry), header.vq_entry_size));
+    snapshot.vqs_.push_back(VqStats{static_cast<VqStats::Type>(entry.type), entry.index, entry.utilization_percent,
+                                    entry.msg_count, entry.byte_count, entry.msg_rate, entry.byte_rate,
+                                    entry.overflow_count});
+  }
+  return snapshot;
 }
 
 void DevicePcie::clearDeviceAttributes(int device, std::string relGroupPath) const {
@@ -561,11 +884,43 @@ void DevicePcie::clearDeviceAttributes(int device, std::string relGroupPath) con
   clearDeviceAttributeByName(std::string(devices_[static_cast<uint32_t>(device)].devName_.data()), relGroupPath);
 }
 
+void DevicePcie::invalidateCachedState(int device) {
+  CHECK_VALID_DEVICE(device);
+  auto& cache = *devices_[static_cast<unsigned long>(device)].stateCache_;
+  cache.ops_.invalidate();
+  cache.mgmt_.invalidate();
+  std::lock_guard lock(cache.attributesMutex_);
+  cache.attributes_.clear();
+  cmaFreeTime_.store(0, std::memory_order_release);
+}
+
 void DevicePcie::reinitDeviceInstance(int device, bool masterMinionOnly, std::chrono::milliseconds timeout) {
   CHECK_VALID_DEVICE(device);
   auto& deviceInfo = devices_[static_cast<unsigned long>(device)];
   teardownDeviceInfo(deviceInfo, mgmtEnabled_ && !masterMinionOnly, opsEnabled_);
   setupDeviceInfo(device, deviceInfo, mgmtEnabled_ && !masterMinionOnly, opsEnabled_, timeout);
+  invalidateCachedState(device);
+}
+
+DeviceState DevicePcie::getCachedDeviceState(StateSnapshot& snapshot, int fd) const {
+  // both counters only grow, so their sum changes whenever one of them does
+  auto generation =
+    snapshot.generation_.load(std::memory_order_acquire) + ioctlErrors.load(std::memory_order_acquire);
+  auto value = snapshot.value_.load(std::memory_order_acquire);
+  auto now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch());
+  if ((value >> 8) == generation && now.count() < snapshot.expiry_.load(std::memory_order_acquire)) {
+    return static_cast<DeviceState>(value & 0xFF);
+  }
+  auto state = getDeviceState(fd);
+  // the device pops the pending commands on its own, the other states remain till the host changes them or the device
+  // fails. The snapshot has to be invalidated after the changes (e.g. after pushing the commands), so a state read
+  // before a change is never stored with the generation following it
+  if (state != DeviceState::PendingCommands) {
+    auto expiry = now + std::chrono::duration_cast<std::chrono::nanoseconds>(StateSnapshot::kTtl);
+    snapshot.expiry_.store(expiry.count(), std::memory_order_release);
+    snapshot.value_.store(generation << 8 | static_cast<uint64_t>(state), std::memory_order_release);
+  }
+  return state;
 }
 
 /******************
@@ -600,13 +955,15 @@ DmaInfo DevicePcie::getDmaInfo(int device) const {
 DeviceState DevicePcie::getDeviceStateMasterMinion(int device) const {
   CHECK_OPS_ENABLED();
   CHECK_VALID_DEVICE(device);
-  return getDeviceState(devices_[static_cast<unsigned long>(device)].fdOps_);
+  auto& deviceInfo = devices_[static_cast<unsigned long>(device)];
+  return getCachedDeviceState(deviceInfo.stateCache_->ops_, deviceInfo.fdOps_);
 }
 
 DeviceState DevicePcie::getDeviceStateServiceProcessor(int device) const {
   CHECK_MGMT_ENABLED();
   CHECK_VALID_DEVICE(device);
-  return getDeviceState(devices_[static_cast<unsigned long>(device)].fdMgmt_);
+  auto& deviceInfo = devices_[static_cast<unsigned long>(device)];
+  return getCachedDeviceState(deviceInfo.stateCache_->mgmt_, deviceInfo.fdMgmt_);
 }
 
 int DevicePcie::getSubmissionQueuesCount(int device) const {
@@ -615,6 +972,12 @@ int DevicePcie::getSubmissionQueuesCount(int device) const {
   return devices_[static_cast<unsigned long>(device)].mmSqCount_;
 }
 
+int DevicePcie::getCompletionQueuesCount(int device) const {
+  CHECK_OPS_ENABLED();
+  CHECK_VALID_DEVICE(device);
+  return devices_[static_cast<unsigned long>(device)].mmCqCount_;
+}
+
 size_t DevicePcie::getSubmissionQueueSizeMasterMinion(int device) const {
   CHECK_OPS_ENABLED();
   CHECK_VALID_DEVICE(device);
@@ -629,6 +992,41 @@ bool DevicePcie::checkP2pDmaCompatibility(int deviceA, int deviceB) const {
          devices_[static_cast<unsigned long>(deviceA)].p2pCompatBitmap_;
 }
 
+size_t DevicePcie::registerHostMemory(int device, const void* hostPtr, size_t sizeInBytes, bool toDeviceOnly) {
+  CHECK_OPS_ENABLED();
+  CHECK_VALID_DEVICE(device);
+  host_mem_desc desc{};
+  desc.addr = reinterpret_cast<uint64_t>(hostPtr);
+  desc.size = sizeInBytes;
+  desc.flags = toDeviceOnly ? ETSOC1_HOST_MEM_FLAG_TO_DEVICE : 0;
+  auto res = wrap_ioctl(devices_[static_cast<uint32_t>(device)].fdOps_, ETSOC1_IOCTL_REGISTER_HOST_MEM, &desc);
+  if (!res) {
+    throw Exception("Error registering host memory: '"s + std::strerror(errno) + "'");
+  }
+  DV_VLOG(LOW) << "Registered host memory " << hostPtr << " size: " << sizeInBytes << " DMA segments: " << res.rc_;
+  return static_cast<size_t>(res.rc_);
+}
+
+void DevicePcie::unregisterHostMemory(int device, const void* hostPtr) {
+  CHECK_OPS_ENABLED();
+  CHECK_VALID_DEVICE(device);
+  host_mem_desc desc{};
+  desc.addr = reinterpret_cast<uint64_t>(hostPtr);
+  wrap_ioctl(devices_[static_cast<uint32_t>(device)].fdOps_, ETSOC1_IOCTL_UNREGISTER_HOST_MEM, &desc);
+}
+
+bool DevicePcie::canStreamHostMemory(int device) const {
+  CHECK_VALID_DEVICE(device);
+  // the driver maps the memory of the DMA commands it pushes until their response is popped. Commands pushed on the
+  // SQs owned by user-space are only translated by the driver, it can't tell when their mapping could be released
+  return opsEnabled_ && !devices_[static_cast<uint32_t>(device)].userVqs_;
+}
+
+std::byte* DevicePcie::getMappedDram(int device) const {
+  CHECK_VALID_DEVICE(device);
+  return opsEnabled_ ? devices_[static_cast<uint32_t>(device)].mappedDram_ : nullptr;
+}
+
 void* DevicePcie::allocDmaBuffer(int device, size_t sizeInBytes, bool writeable) {
   std::lock_guard lock(mutex_);
   CHECK_VALID_DEVICE(device);
@@ -642,7 +1040,42 @@ void* DevicePcie::allocDmaBuffer(int device, size_t sizeInBytes, bool writeable)
   if (res == MAP_FAILED) {
     throw Exception("Error mmap: '"s + std::strerror(errno) + "'");
   }
-  dmaBuffers_[res] = sizeInBytes;
+  dmaBuffers_[res] = DmaBuffer{sizeInBytes};
+  cmaFreeTime_.store(0, std::memory_order_release);
+  return res;
+}
+
+void* DevicePcie::allocHugePageDmaBuffer(int device, size_t sizeInBytes, bool writeable) {
+  CHECK_OPS_ENABLED();
+  CHECK_VALID_DEVICE(device);
+  constexpr auto k2MB = 2UL << 20;
+  constexpr auto k1GB = 1UL << 30;
+  auto size = sizeInBytes;
+  auto hugeFlags = 30 << MAP_HUGE_SHIFT;
+  if (size == 0 || size % k1GB != 0) {
+    size = (size + k2MB - 1) & ~(k2MB - 1);
+    hugeFlags = 21 << MAP_HUGE_SHIFT;
+  }
+  // the pages are taken from the hugetlb pool at mmap, so there are no page faults to take later. The driver pins them
+  // for writing, so they are made readonly only once registered
+  auto res = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                  MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | hugeFlags | MAP_POPULATE, -1, 0);
+  if (res == MAP_FAILED) {
+    DV_VLOG(LOW) << "Can't allocate " << size << " bytes of hugepages: '" << std::strerror(errno) << "'";
+    return nullptr;
+  }
+  try {
+    registerHostMemory(device, res, size, false);
+  } catch (const Exception& e) {
+    DV_LOG(WARNING) << "Can't register hugepages for DMA: " << e.what();
+    munmap(res, size);
+    return nullptr;
+  }
+  if (!writeable) {
+    mprotect(res, size, PROT_READ);
+  }
+  std::lock_guard lock(mutex_);
+  dmaBuffers_[res] = DmaBuffer{size, device};
   return res;
 }
 
@@ -652,9 +1085,15 @@ void DevicePcie::freeDmaBuffer(void* dmaBuffer) {
   if (it == end(dmaBuffers_)) {
     throw Exception("Can't free a non previously allocated DmaBuffer");
   }
-  if (munmap(dmaBuffer, it->second) != 0) {
+  if (it->second.hugePageDevice_ >= 0) {
+    unregisterHostMemory(it->second.hugePageDevice_, dmaBuffer);
+  }
+  if (munmap(dmaBuffer, it->second.size_) != 0) {
     throw Exception("Error munmap: '"s + std::strerror(errno) + "'");
   }
+  if (it->second.hugePageDevice_ < 0) {
+    cmaFreeTime_.store(0, std::memory_order_release);
+  }
   dmaBuffers_.erase(it);
 }
 
@@ -662,16 +1101,191 @@ bool DevicePcie::sendCommandMasterMinion(int device, int sqIdx, std::byte* comma
                                          CmdFlagMM flags) {
   CHECK_OPS_ENABLED();
   CHECK_VALID_DEVICE(device);
-  const auto& deviceInfo = devices_[static_cast<unsigned long>(device)];
+  auto& deviceInfo = devices_[static_cast<unsigned long>(device)];
   if (sqIdx >= deviceInfo.mmSqCount_) {
     throw Exception("Invalid queue");
   }
+  if (deviceInfo.userVqs_ && !flags.isHpSq_) {
+    return pushUserSq(deviceInfo, sqIdx, command, {commandSize}, flags) == 1;
+  }
   cmd_desc cmdInfo;
   cmdInfo.cmd = command;
   cmdInfo.size = static_cast<uint16_t>(commandSize);
   cmdInfo.sq_index = static_cast<uint16_t>(sqIdx);
   cmdInfo.flags = parseCmdFlagMM(flags);
-  return wrap_ioctl(deviceInfo.fdOps_, ETSOC1_IOCTL_PUSH_SQ, &cmdInfo);
+  bool sent = wrap_ioctl(deviceInfo.fdOps_, ETSOC1_IOCTL_PUSH_SQ, &cmdInfo);
+  deviceInfo.stateCache_->ops_.invalidate();
+  return sent;
+}
+
+size_t DevicePcie::sendCommandsMasterMinion(int device, int sqIdx, std::byte* commands,
+                                           const std::vector<size_t>& commandSizes, CmdFlagMM flags) {
+  CHECK_OPS_ENABLED();
+  CHECK_VALID_DEVICE(device);
+  auto& deviceInfo = devices_[static_cast<unsigned long>(device)];
+  auto totalSize = std::accumulate(begin(commandSizes), end(commandSizes), size_t{0});
+  if (deviceInfo.userVqs_ && !flags.isHpSq_ && !flags.isDma_ && !flags.isP2pDma_ && !flags.isDmaChain_) {
+    if (sqIdx >= deviceInfo.mmSqCount_) {
+      throw Exception("Invalid queue");
+    }
+    return pushUserSq(deviceInfo, sqIdx, commands, commandSizes, flags);
+  }
+  // the commands which can't be pushed with a single IOCTL go through io_uring
+  if (deviceInfo.uringVqs_ && commandSizes.size() > 1 &&
+      (!deviceInfo.batchPushSqSupported_ || flags.isDma_ || flags.isP2pDma_ || flags.isDmaChain_ ||
+       totalSize > ETSOC1_PUSH_SQ_BATCH_MAX_SIZE)) {
+    if (sqIdx >= deviceInfo.mmSqCount_) {
+      throw Exception("Invalid queue");
+    }
+    return pushUringSq(deviceInfo, sqIdx, commands, commandSizes, flags);
+  }
+  if (!deviceInfo.batchPushSqSupported_ || commandSizes.size() <= 1 || flags.isDma_ || flags.isP2pDma_ ||
+      flags.isDmaChain_ || totalSize > ETSOC1_PUSH_SQ_BATCH_MAX_SIZE) {
+    return IDeviceAsync::sendCommandsMasterMinion(device, sqIdx, commands, commandSizes, flags);
+  }
+  if (sqIdx >= deviceInfo.mmSqCount_) {
+    throw Exception("Invalid queue");
+  }
+  cmd_batch_desc batchInfo;
+  batchInfo.cmds = commands;
+  batchInfo.size = static_cast<uint32_t>(totalSize);
+  batchInfo.sq_index = static_cast<uint16_t>(sqIdx);
+  batchInfo.flags = parseCmdFlagMM(flags);
+
+  // not using wrap_ioctl here because older drivers don't implement this ioctl; in that case fallback to single pushes
+  auto res = ::ioctl(deviceInfo.fdOps_, ETSOC1_IOCTL_PUSH_SQ_BATCH, &batchInfo);
+  deviceInfo.stateCache_->ops_.invalidate();
+  if (res < 0) {
+    if (errno == EAGAIN) {
+      return 0;
+    }
+    if (errno == ENOTTY) {
+      DV_LOG(INFO) << "Driver does not support batched SQ pushes, falling back to single pushes. Device: " << device;
+      deviceInfo.batchPushSqSupported_ = false;
+      return IDeviceAsync::sendCommandsMasterMinion(device, sqIdx, commands, commandSizes, flags);
+    }
+    DV_LOG(WARNING) << "IOCTL failed. FD: " << deviceInfo.fdOps_ << " request: " << ETSOC1_IOCTL_PUSH_SQ_BATCH;
+    throw Exception("Failed to execute IOCTL: '"s + std::strerror(errno) + "'"s);
+  }
+  return static_cast<size_t>(res);
+}
+
+size_t DevicePcie::pushUserSq(DevInfo& deviceInfo, int sqIdx, std::byte* commands,
+                              const std::vector<size_t>& commandSizes, CmdFlagMM flags) {
+  auto& vqs = *deviceInfo.userVqs_;
+  std::vector<std::byte> translated;
+  if (flags.isDma_ || flags.isP2pDma_ || flags.isDmaChain_) {
+    // the driver translates the host addresses of the DMA list command, it's pushed from here afterwards
+    translated.resize(deviceInfo.mmSqMaxMsgSize_);
+    cmd_translate_desc translateInfo;
+    translateInfo.cmd = commands;
+    translateInfo.size = static_cast<uint16_t>(commandSizes.front());
+    translateInfo.out = translated.data();
+    translateInfo.out_size = static_cast<uint16_t>(translated.size());
+    translateInfo.flags = parseCmdFlagMM(flags);
+    auto res = wrap_ioctl(deviceInfo.fdOps_, ETSOC1_IOCTL_TRANSLATE_CMD, &translateInfo);
+    translated.resize(static_cast<size_t>(res.rc_));
+  }
+  auto cbMem = vqs.vqBuffer_ + vqs.info_.sq_offset + static_cast<size_t>(sqIdx) * vqs.info_.sq_size;
+  size_t count = 0;
+  {
+    std::lock_guard lock(vqs.sqMutexes_[static_cast<size_t>(sqIdx)]);
+    if (!translated.empty()) {
+      count = pushCircBuffer(cbMem, translated.data(), translated.size()) ? 1 : 0;
+    } else {
+      for (auto size : commandSizes) {
+        if (!pushCircBuffer(cbMem, commands, size)) {
+          break;
+        }
+        commands += size;
+        ++count;
+      }
+    }
+  }
+  if (count > 0) {
+    ringDoorbell(vqs.doorbell_, vqs.info_);
+    deviceInfo.stateCache_->ops_.invalidate();
+  }
+  return count;
+}
+
+size_t DevicePcie::pushUringSq(DevInfo& deviceInfo, int sqIdx, std::byte* commands,
+                               const std::vector<size_t>& commandSizes, CmdFlagMM flags) {
+  auto& vqs = *deviceInfo.uringVqs_;
+  std::lock_guard lock(vqs.pushMutex_);
+  size_t count = 0;
+  while (count < commandSizes.size()) {
+    auto queued = std::min(commandSizes.size() - count, static_cast<size_t>(vqs.push_.getEntries()));
+    for (size_t i = 0; i < queued; ++i) {
+      cmd_desc cmdInfo;
+      cmdInfo.cmd = commands;
+      cmdInfo.size = static_cast<uint16_t>(commandSizes[count + i]);
+      cmdInfo.sq_index = static_cast<uint16_t>(sqIdx);
+      cmdInfo.flags = parseCmdFlagMM(flags);
+      // linked, so the commands following one which doesn't fit are cancelled and the order is kept
+      vqs.push_.queueCommand(deviceInfo.fdOps_, ETSOC1_IOCTL_PUSH_SQ, &cmdInfo, sizeof(cmdInfo), i + 1 < queued);
+      commands += commandSizes[count + i];
+    }
+    const auto& results = vqs.push_.submitAndWait();
+    deviceInfo.stateCache_->ops_.invalidate();
+    for (auto res : results) {
+      if (res == -EBUSY || res == -ECANCELED) {
+        return count;
+      }
+      if (res < 0) {
+        DV_LOG(WARNING) << "io_uring SQ push failed. FD: " << deviceInfo.fdOps_;
+        throw Exception("Failed to push SQ: '"s + std::strerror(-res) + "'"s);
+      }
+      ++count;
+    }
+  }
+  return count;
+}
+
+size_t DevicePcie::popUringCqs(DevInfo& deviceInfo, std::vector<std::vector<std::byte>>& responses) {
+  auto& vqs = *deviceInfo.uringVqs_;
+  std::lock_guard lock(vqs.popMutex_);
+  // each CQ gets a slice of the responses, the popped ones are moved to the front afterwards
+  auto cqCount = std::min({static_cast<size_t>(deviceInfo.mmCqCount_), responses.size(),
+                           static_cast<size_t>(vqs.pop_.getEntries())});
+  auto perCq = std::min(responses.size() / cqCount, static_cast<size_t>(ETSOC1_POP_CQ_BATCH_MAX_COUNT));
+  for (size_t cqIdx = 0; cqIdx < cqCount; ++cqIdx) {
+    for (auto i = cqIdx * perCq; i < (cqIdx + 1) * perCq; ++i) {
+      responses[i].resize(deviceInfo.mmSqMaxMsgSize_);
+      vqs.rspInfos_[i].rsp = responses[i].data();
+      vqs.rspInfos_[i].size = deviceInfo.mmSqMaxMsgSize_;
+      vqs.rspInfos_[i].cq_index = static_cast<uint16_t>(cqIdx);
+    }
+    rsp_batch_desc batchInfo;
+    batchInfo.rsps = &vqs.rspInfos_[cqIdx * perCq];
+    batchInfo.count = static_cast<uint16_t>(perCq);
+    batchInfo.cq_index = static_cast<uint16_t>(cqIdx);
+    vqs.pop_.queueCommand(deviceInfo.fdOps_, ETSOC1_IOCTL_POP_CQ_BATCH, &batchInfo, sizeof(batchInfo), false);
+  }
+  const auto& results = vqs.pop_.submitAndWait();
+  size_t count = 0;
+  for (size_t cqIdx = 0; cqIdx < cqCount; ++cqIdx) {
+    auto res = results[cqIdx];
+    if (res == -EBUSY) {
+      continue;
+    }
+    if (res < 0) {
+      DV_LOG(WARNING) << "io_uring CQ pop failed. FD: " << deviceInfo.fdOps_;
+      throw Exception("Failed to pop CQ: '"s + std::strerror(-res) + "'"s);
+    }
+    for (auto i = cqIdx * perCq; i < cqIdx * perCq + static_cast<size_t>(res); ++i) {
+      responses[i].resize(vqs.rspInfos_[i].size);
+      std::swap(responses[count++], responses[i]);
+    }
+  }
+  return count;
+}
+
+bool DevicePcie::popUserCq(DevInfo& deviceInfo, int cqIdx, std::vector<std::byte>& response) {
+  auto& vqs = *deviceInfo.userVqs_;
+  std::lock_guard lock(vqs.cqMutexes_[static_cast<size_t>(cqIdx)]);
+  auto cbMem = vqs.vqBuffer_ + vqs.info_.cq_offset + static_cast<size_t>(cqIdx) * vqs.info_.cq_size;
+  return popCircBuffer(cbMem, response);
 }
 
 void DevicePcie::setSqThresholdMasterMinion(int device, int sqIdx, uint32_t bytesNeeded) {
@@ -709,7 +1323,14 @@ void DevicePcie::waitForEpollEventsMasterMinion(int device, uint64_t& sq_bitmap,
         if (eventList[i].events & EPOLLIN) {
           cq_available = true;
         }
+        if (deviceInfo.userVqs_ && eventList[i].data.fd == deviceInfo.userVqs_->eventFd_) {
+          // CQ interrupt(s) signaled by the driver, reset the counter
+          eventfd_t count;
+          eventfd_read(deviceInfo.userVqs_->eventFd_, &count);
+        }
       } else if (eventList[i].events & EPOLLHUP) {
+        deviceInfo.stateCache_->ops_.invalidate();
+        deviceInfo.stateCache_->mgmt_.invalidate();
         throw Exception("Epoll connection dropped, device in bad state?");
       } else {
         throw Exception("Unknown epoll event");
@@ -720,19 +1341,124 @@ void DevicePcie::waitForEpollEventsMasterMinion(int device, uint64_t& sq_bitmap,
   }
 }
 
-bool DevicePcie::receiveResponseMasterMinion(int device, std::vector<std::byte>& response) {
-  CHECK_OPS_ENABLED();
-  CHECK_VALID_DEVICE(device);
-  auto& deviceInfo = devices_[static_cast<unsigned long>(device)];
+bool DevicePcie::popCq(DevInfo& deviceInfo, int cqIdx, std::vector<std::byte>& response) {
+  if (deviceInfo.userVqs_) {
+    return popUserCq(deviceInfo, cqIdx, response);
+  }
 
   response.resize(deviceInfo.mmSqMaxMsgSize_);
   rsp_desc rspInfo;
   rspInfo.rsp = response.data();
   rspInfo.size = deviceInfo.mmSqMaxMsgSize_;
-  rspInfo.cq_index = 0;
+  rspInfo.cq_index = static_cast<uint16_t>(cqIdx);
   return wrap_ioctl(deviceInfo.fdOps_, ETSOC1_IOCTL_POP_CQ, &rspInfo);
 }
 
+bool DevicePcie::receiveResponseMasterMinion(int device, std::vector<std::byte>& response) {
+  CHECK_OPS_ENABLED();
+  CHECK_VALID_DEVICE(device);
+  auto& deviceInfo = devices_[static_cast<unsigned long>(device)];
+  for (int cqIdx = 0; cqIdx < deviceInfo.mmCqCount_; ++cqIdx) {
+    if (popCq(deviceInfo, cqIdx, response)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+size_t DevicePcie::receiveResponsesMasterMinion(int device, std::vector<std::vector<std::byte>>& responses) {
+  CHECK_OPS_ENABLED();
+  CHECK_VALID_DEVICE(device);
+  auto& deviceInfo = devices_[static_cast<unsigned long>(device)];
+  if (deviceInfo.uringVqs_ && deviceInfo.batchPopCqSupported_ && deviceInfo.mmCqCount_ > 1 && !responses.empty()) {
+    return popUringCqs(deviceInfo, responses);
+  }
+  // the caller keeps receiving till there are no responses, so it's enough to return those of the first non empty CQ
+  for (int cqIdx = 0; cqIdx < deviceInfo.mmCqCount_; ++cqIdx) {
+    if (auto count = receiveResponsesFromCqMasterMinion(device, cqIdx, responses)) {
+      return count;
+    }
+  }
+  return 0;
+}
+
+size_t DevicePcie::receiveResponsesFromCqMasterMinion(int device, int cqIdx,
+                                                      std::vector<std::vector<std::byte>>& responses) {
+  CHECK_OPS_ENABLED();
+  CHECK_VALID_DEVICE(device);
+  auto& deviceInfo = devices_[static_cast<unsigned long>(device)];
+  if (cqIdx < 0 || cqIdx >= deviceInfo.mmCqCount_) {
+    throw Exception("Invalid queue");
+  }
+  if (!deviceInfo.batchPopCqSupported_ || responses.size() <= 1 || deviceInfo.userVqs_) {
+    size_t count = 0;
+    while (count < responses.size() && popCq(deviceInfo, cqIdx, responses[count])) {
+      ++count;
+    }
+    return count;
+  }
+
+  std::array<rsp_desc, ETSOC1_POP_CQ_BATCH_MAX_COUNT> rspInfos;
+  auto count = std::min(responses.size(), rspInfos.size());
+  for (size_t i = 0; i < count; ++i) {
+    responses[i].resize(deviceInfo.mmSqMaxMsgSize_);
+    rspInfos[i].rsp = responses[i].data();
+    rspInfos[i].size = deviceInfo.mmSqMaxMsgSize_;
+    rspInfos[i].cq_index = static_cast<uint16_t>(cqIdx);
+  }
+  rsp_batch_desc batchInfo;
+  batchInfo.rsps = rspInfos.data();
+  batchInfo.count = static_cast<uint16_t>(count);
+  batchInfo.cq_index = static_cast<uint16_t>(cqIdx);
+
+  // not using wrap_ioctl here because older drivers don't implement this ioctl; in that case fallback to single pops
+  auto res = ::ioctl(deviceInfo.fdOps_, ETSOC1_IOCTL_POP_CQ_BATCH, &batchInfo);
+  if (res < 0) {
+    if (errno == EAGAIN) {
+      return 0;
+    }
+    if (errno == ENOTTY) {
+      DV_LOG(INFO) << "Driver does not support batched CQ pops, falling back to single pops. Device: " << device;
+      deviceInfo.batchPopCqSupported_ = false;
+      return receiveResponsesFromCqMasterMinion(device, cqIdx, responses);
+    }
+    DV_LOG(WARNING) << "IOCTL failed. FD: " << deviceInfo.fdOps_ << " request: " << ETSOC1_IOCTL_POP_CQ_BATCH;
+    throw Exception("Failed to execute IOCTL: '"s + std::strerror(errno) + "'"s);
+  }
+  auto popped = static_cast<size_t>(res);
+  for (size_t i = 0; i < popped; ++i) {
+    responses[i].resize(rspInfos[i].size);
+  }
+  return popped;
+}
+
+bool DevicePcie::waitForCqEventMasterMinion(int device, int cqIdx, std::chrono::milliseconds timeout) {
+  CHECK_OPS_ENABLED();
+  CHECK_VALID_DEVICE(device);
+  const auto& deviceInfo = devices_[static_cast<unsigned long>(device)];
+  if (cqIdx < 0 || cqIdx >= deviceInfo.mmCqCount_) {
+    throw Exception("Invalid queue");
+  }
+  if (deviceInfo.cqEventFds_.empty()) {
+    return IDeviceAsync::waitForCqEventMasterMinion(device, cqIdx, timeout);
+  }
+
+  pollfd pfd;
+  pfd.fd = deviceInfo.cqEventFds_[static_cast<size_t>(cqIdx)];
+  pfd.events = POLLIN;
+  auto res = poll(&pfd, 1, static_cast<int>(timeout.count()));
+  if (res < 0) {
+    throw Exception("poll() failed: '"s + std::strerror(errno) + "'"s);
+  }
+  if (res == 0) {
+    return false;
+  }
+  // reset the counter, the driver signals it again once the CQ is emptied and gets a new response
+  eventfd_t count;
+  eventfd_read(pfd.fd, &count);
+  return true;
+}
+
 size_t DevicePcie::getTraceBufferSizeMasterMinion(int device, TraceBufferType traceType) {
   CHECK_OPS_ENABLED();
   CHECK_VALID_DEVICE(device);
@@ -760,7 +1486,12 @@ bool DevicePcie::sendCommandServiceProcessor(int device, std::byte* command, siz
   cmdInfo.size = static_cast<uint16_t>(commandSize);
   cmdInfo.sq_index = 0;
   cmdInfo.flags = parseCmdFlagSP(flags);
-  return wrap_ioctl(deviceInfo.fdMgmt_, ETSOC1_IOCTL_PUSH_SQ, &cmdInfo);
+  bool sent = wrap_ioctl(deviceInfo.fdMgmt_, ETSOC1_IOCTL_PUSH_SQ, &cmdInfo);
+  deviceInfo.stateCache_->mgmt_.invalidate();
+  if (flags.isMmReset_ || flags.isEtsocReset_) {
+    deviceInfo.stateCache_->ops_.invalidate();
+  }
+  return sent;
 }
 
 void DevicePcie::setSqThresholdServiceProcessor(int device, uint32_t bytesNeeded) {
@@ -797,6 +1528,8 @@ void DevicePcie::waitForEpollEventsServiceProcessor(int device, bool& sq_availab
           cq_available = true;
         }
       } else if (eventList[i].events & EPOLLHUP) {
+        deviceInfo.stateCache_->ops_.invalidate();
+        deviceInfo.stateCache_->mgmt_.invalidate();
         throw Exception("Epoll connection dropped, device in bad state?");
       } else {
         throw Exception("Unknown epoll event");
@@ -834,6 +1567,20 @@ bool DevicePcie::getTraceBufferServiceProcessor(int device, TraceBufferType trac
   return wrap_ioctl(deviceInfo.fdMgmt_, ETSOC1_IOCTL_EXTRACT_TRACE_BUFFER, &traceInfo);
 }
 
+size_t DevicePcie::readTraceBufferServiceProcessor(int device, TraceBufferType traceType, size_t offset,
+                                                   std::byte* buf, size_t size) {
+  CHECK_MGMT_ENABLED();
+  CHECK_VALID_DEVICE(device);
+  auto& deviceInfo = devices_[static_cast<unsigned long>(device)];
+
+  trace_read_desc readInfo;
+  readInfo.trace_type = static_cast<uint8_t>(traceType);
+  readInfo.offset = static_cast<uint32_t>(offset);
+  readInfo.size = static_cast<uint32_t>(size);
+  readInfo.buf = buf;
+  return static_cast<size_t>(wrap_ioctl(deviceInfo.fdMgmt_, ETSOC1_IOCTL_READ_TRACE_BUFFER, &readInfo).rc_);
+}
+
 int DevicePcie::updateFirmwareImage(int device, std::vector<unsigned char>& fwImage) {
   CHECK_MGMT_ENABLED();
   CHECK_VALID_DEVICE(device);
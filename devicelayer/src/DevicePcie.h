@@ -3,24 +3,37 @@
  * SPDX-License-Identifier: Apache-2.0
  *-------------------------------------------------------------------------*/
 #pragma once
+#include "IoUring.h"
 #include "device-layer/IDeviceLayer.h"
 #include <et_ioctl.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
 #include <mutex>
+#include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace dev {
 
 class DevicePcie final : public IDeviceLayer {
 public:
-  explicit DevicePcie(bool enableOps = true, bool enableMgmt = true);
+  // useIoUring submits the bursts of SQ pushes and CQ pops to the driver through io_uring, if it supports it
+  explicit DevicePcie(bool enableOps = true, bool enableMgmt = true, bool useIoUring = false);
   ~DevicePcie();
 
   // IDeviceAsync
   bool sendCommandMasterMinion(int device, int sqIdx, std::byte* command, size_t commandSize, CmdFlagMM flags) override;
+  size_t sendCommandsMasterMinion(int device, int sqIdx, std::byte* commands, const std::vector<size_t>& commandSizes,
+                                  CmdFlagMM flags) override;
   void setSqThresholdMasterMinion(int device, int sqIdx, uint32_t bytesNeeded) override;
   void waitForEpollEventsMasterMinion(int device, uint64_t& sq_bitmap, bool& cq_available,
                                       std::chrono::milliseconds timeout = std::chrono::seconds(10)) override;
   bool receiveResponseMasterMinion(int device, std::vector<std::byte>& response) override;
+  size_t receiveResponsesMasterMinion(int device, std::vector<std::vector<std::byte>>& responses) override;
+  size_t receiveResponsesFromCqMasterMinion(int device, int cqIdx,
+                                            std::vector<std::vector<std::byte>>& responses) override;
+  bool waitForCqEventMasterMinion(int device, int cqIdx, std::chrono::milliseconds timeout) override;
 
   bool sendCommandServiceProcessor(int device, std::byte* command, size_t commandSize, CmdFlagSP flags) override;
   void setSqThresholdServiceProcessor(int device, uint32_t bytesNeeded) override;
@@ -32,12 +45,15 @@ public:
   DmaInfo getDmaInfo(int device) const override;
   int getDevicesCount() const override;
   int getSubmissionQueuesCount(int device) const override;
+  int getCompletionQueuesCount(int device) const override;
   DeviceState getDeviceStateMasterMinion(int device) const override;
   DeviceState getDeviceStateServiceProcessor(int device) const override;
   size_t getSubmissionQueueSizeMasterMinion(int device) const override;
   size_t getSubmissionQueueSizeServiceProcessor(int device) const override;
   bool getTraceBufferServiceProcessor(int device, TraceBufferType trace_type,
                                       std::vector<std::byte>& response) override;
+  size_t readTraceBufferServiceProcessor(int device, TraceBufferType traceType, size_t offset, std::byte* buf,
+                                         size_t size) override;
   size_t getTraceBufferSizeMasterMinion(int device, TraceBufferType traceType) override;
   int updateFirmwareImage(int device, std::vector<unsigned char>& fwImage) override;
   int getDmaAlignment() const override;
@@ -45,22 +61,80 @@ public:
   uint64_t getDramBaseAddress(int device) const override;
   void* allocDmaBuffer(int device, size_t sizeInBytes, bool writeable) override;
   void freeDmaBuffer(void* dmaBuffer) override;
+  void* allocHugePageDmaBuffer(int device, size_t sizeInBytes, bool writeable) override;
   DeviceConfig getDeviceConfig(int device) override;
   int getActiveShiresNum(int device) override;
   uint32_t getFrequencyMHz(int device) override;
   size_t getFreeCmaMemory() const override;
   std::string getDeviceAttribute(int device, std::string relAttrPath) const override;
+  DeviceStatsSnapshot getDeviceStatsSnapshot(int device) const override;
   void clearDeviceAttributes(int device, std::string relGroupPath) const override;
+  void invalidateCachedState(int device) override;
   void reinitDeviceInstance(int device, bool masterMinionOnly, std::chrono::milliseconds timeout) override;
   void hintInactivity(int) override;
   bool checkP2pDmaCompatibility(int deviceA, int deviceB) const override;
+  size_t registerHostMemory(int device, const void* hostPtr, size_t sizeInBytes, bool toDeviceOnly) override;
+  void unregisterHostMemory(int device, const void* hostPtr) override;
+  bool canStreamHostMemory(int device) const override;
+  std::byte* getMappedDram(int device) const override;
 
 private:
+  // SQs and CQs pushed and popped directly through their mmap()ed memory, when the driver allows it (see
+  // ETSOC1_IOCTL_MAP_VQS). HPSQs remain pushed through the driver
+  struct UserVqs {
+    UserVqs(size_t sqCount, size_t cqCount)
+      : sqMutexes_(sqCount)
+      , cqMutexes_(cqCount) {
+    }
+    vq_map_desc info_;
+    std::byte* vqBuffer_ = nullptr;
+    std::byte* doorbell_ = nullptr;
+    int eventFd_ = -1; // signaled by the driver on CQ interrupts
+    std::vector<std::mutex> sqMutexes_;
+    std::vector<std::mutex> cqMutexes_;
+  };
+
+  // SQ pushes and CQ pops submitted to the driver as io_uring passthrough commands, several of them with a single
+  // syscall. One ring for the senders and another one for the receivers, so they don't wait for each other
+  struct UringVqs {
+    explicit UringVqs(unsigned entries)
+      : push_(entries)
+      , pop_(entries) {
+    }
+    std::mutex pushMutex_;
+    IoUring push_;
+    std::mutex popMutex_;
+    IoUring pop_;
+    std::vector<rsp_desc> rspInfos_; // guarded by popMutex_
+  };
+
+  // last state read from the driver. It's valid till the generation changes, which happens whenever the host does
+  // something which could change the state (sending commands, resetting or reinitializing the device) or an ioctl
+  // fails. The device can also change it on its own (e.g. it stops responding after a PCIe error), so it's read again
+  // once it's older than kTtl
+  struct StateSnapshot {
+    static constexpr auto kTtl = std::chrono::milliseconds(100);
+    void invalidate() {
+      generation_.fetch_add(1, std::memory_order_acq_rel);
+    }
+    std::atomic<uint64_t> generation_ = 1;
+    std::atomic<uint64_t> value_ = 0; // generation it was read at in the upper bits, DeviceState in the lowest byte
+    std::atomic<int64_t> expiry_ = 0; // steady clock time in ns at which value_ has to be read again
+  };
+  struct StateCache {
+    StateSnapshot ops_;
+    StateSnapshot mgmt_;
+    std::mutex attributesMutex_;
+    // only the attributes which can't change while the device is bound, see getDeviceAttribute
+    std::unordered_map<std::string, std::string> attributes_;
+  };
+
   struct DevInfo {
     std::array<char, 32> devName_;
     dram_info userDram_;
     DeviceConfig cfg_;
     uint16_t mmSqCount_;
+    uint16_t mmCqCount_ = 1;
     uint16_t spSqMaxMsgSize_;
     uint16_t mmSqMaxMsgSize_;
     int fdOps_;
@@ -68,18 +142,57 @@ private:
     int fdMgmt_;
     int epFdMgmt_;
     uint64_t p2pCompatBitmap_;
+    bool batchPopCqSupported_ = true;
+    bool batchPushSqSupported_ = true;
+    std::unique_ptr<UserVqs> userVqs_;
+    // nullptr if not using io_uring or the driver doesn't support it
+    std::unique_ptr<UringVqs> uringVqs_;
+    // host managed DRAM mapped write-combined, nullptr if the driver doesn't allow it (see
+    // ETSOC1_MMAP_OFFSET_DEVICE_DRAM)
+    std::byte* mappedDram_ = nullptr;
+    // signaled by the driver when a response is available on the CQ, indexed by CQ. Empty if the driver doesn't
+    // support them or there is only one CQ, then the CQs are waited through the epoll of the ops file
+    std::vector<int> cqEventFds_;
+    std::unique_ptr<StateCache> stateCache_ = std::make_unique<StateCache>();
   };
 
   void setupDeviceInfo(int device, DevInfo& deviceInfo, bool enableMgmt, bool enableOps,
                        std::chrono::milliseconds timeout = std::chrono::seconds(30)) const;
   void teardownDeviceInfo(const DevInfo& deviceInfo, bool disableMgmt, bool disableOps) const;
+  void setupUserVqs(DevInfo& deviceInfo) const;
+  void setupMappedDram(DevInfo& deviceInfo) const;
+  void setupCqEventFds(DevInfo& deviceInfo) const;
+  void setupUringVqs(DevInfo& deviceInfo) const;
+  // pushes the commands on a SQ owned by user-space and notifies the device once, returns the number of commands pushed
+  size_t pushUserSq(DevInfo& deviceInfo, int sqIdx, std::byte* commands, const std::vector<size_t>& commandSizes,
+                    CmdFlagMM flags);
+  bool popUserCq(DevInfo& deviceInfo, int cqIdx, std::vector<std::byte>& response);
+  // pushes the commands through io_uring with a single syscall, returns the number of commands pushed
+  size_t pushUringSq(DevInfo& deviceInfo, int sqIdx, std::byte* commands, const std::vector<size_t>& commandSizes,
+                     CmdFlagMM flags);
+  // pops responses from all the CQs through io_uring with a single syscall, returns the number of responses popped
+  size_t popUringCqs(DevInfo& deviceInfo, std::vector<std::vector<std::byte>>& responses);
+  // pops one response from the CQ, through the driver or directly if the CQ is owned by user-space
+  bool popCq(DevInfo& deviceInfo, int cqIdx, std::vector<std::byte>& response);
+  // returns the snapshot if still valid, otherwise reads the state from the driver
+  DeviceState getCachedDeviceState(StateSnapshot& snapshot, int fd) const;
 
-  std::unordered_map<void*, size_t> dmaBuffers_;
+  struct DmaBuffer {
+    size_t size_;
+    // device the buffer is registered in if it's backed by hugepages, -1 if it's a CMA buffer
+    int hugePageDevice_ = -1;
+  };
+  std::unordered_map<void*, DmaBuffer> dmaBuffers_;
   std::vector<DevInfo> devices_;
   // this mutex is only needed to keep the map of dmaBuffers, if at some point we decide we don't need them, we can
   // remove the mutex
   std::mutex mutex_;
+  // free CMA memory and when it was read, in ns since the clock epoch. Other processes allocate CMA memory too, so it's
+  // only kept for a short while
+  mutable std::atomic<size_t> cmaFree_ = 0;
+  mutable std::atomic<int64_t> cmaFreeTime_ = 0;
   bool opsEnabled_;
   bool mgmtEnabled_;
+  bool useIoUring_;
 };
 } // namespace dev
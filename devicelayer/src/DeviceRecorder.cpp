@@ -0,0 +1,289 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) 2025 Ainekko, Co.
+ * SPDX-License-Identifier: Apache-2.0
+ *-------------------------------------------------------------------------*/
+
+#include "DeviceRecorder.h"
+#include "Utils.h"
+
+using namespace dev;
+using namespace dev::recording;
+
+namespace {
+template <typename T> void write(std::ofstream& file, const T& value) {
+  file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+} // namespace
+
+DeviceRecorder::DeviceRecorder(std::unique_ptr<IDeviceLayer> deviceLayer, const std::string& path)
+  : deviceLayer_(std::move(deviceLayer))
+  , file_(path, std::ios::binary | std::ios::trunc) {
+  if (!file_) {
+    throw Exception("Can't open the recording file " + path);
+  }
+  Header header;
+  header.magic_ = kMagic;
+  header.version_ = kVersion;
+  header.deviceInfoSize_ = sizeof(DeviceInfo);
+  header.eventHeaderSize_ = sizeof(EventHeader);
+  header.numDevices_ = deviceLayer_->getDevicesCount();
+  header.dmaAlignment_ = deviceLayer_->getDmaAlignment();
+  header.freeCmaMemory_ = deviceLayer_->getFreeCmaMemory();
+  write(file_, header);
+  for (int device = 0; device < header.numDevices_; ++device) {
+    DeviceInfo info;
+    info.submissionQueuesCount_ = deviceLayer_->getSubmissionQueuesCount(device);
+    info.completionQueuesCount_ = deviceLayer_->getCompletionQueuesCount(device);
+    info.submissionQueueSizeMasterMinion_ = deviceLayer_->getSubmissionQueueSizeMasterMinion(device);
+    info.submissionQueueSizeServiceProcessor_ = deviceLayer_->getSubmissionQueueSizeServiceProcessor(device);
+    info.dmaInfo_ = deviceLayer_->getDmaInfo(device);
+    info.config_ = deviceLayer_->getDeviceConfig(device);
+    info.dramSize_ = deviceLayer_->getDramSize(device);
+    info.dramBaseAddress_ = deviceLayer_->getDramBaseAddress(device);
+    info.activeShiresNum_ = deviceLayer_->getActiveShiresNum(device);
+    info.frequencyMHz_ = deviceLayer_->getFrequencyMHz(device);
+    write(file_, info);
+  }
+  file_.flush();
+  start_ = std::chrono::steady_clock::now();
+  DV_LOG(INFO) << "Recording the device traffic to " << path;
+}
+
+void DeviceRecorder::record(EventKind kind, int device, int queue, std::chrono::steady_clock::time_point time,
+                            const std::byte* data, size_t size) {
+  EventHeader event;
+  event.timestamp_ = std::chrono::duration_cast<std::chrono::nanoseconds>(time - start_).count();
+  event.device_ = device;
+  event.queue_ = static_cast<uint16_t>(queue);
+  event.kind_ = kind;
+  event.reserved_ = 0;
+  event.size_ = static_cast<uint32_t>(size);
+  std::lock_guard lock(mutex_);
+  write(file_, event);
+  file_.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+  if (!file_) {
+    throw Exception("Failed writing to the recording file");
+  }
+}
+
+bool DeviceRecorder::sendCommandMasterMinion(int device, int sqIdx, std::byte* command, size_t commandSize,
+                                             CmdFlagMM flags) {
+  auto time = std::chrono::steady_clock::now();
+  auto sent = deviceLayer_->sendCommandMasterMinion(device, sqIdx, command, commandSize, flags);
+  if (sent) {
+    record(EventKind::MmCommand, device, sqIdx, time, command, commandSize);
+  }
+  return sent;
+}
+
+size_t DeviceRecorder::sendCommandsMasterMinion(int device, int sqIdx, std::byte* commands,
+                                                const std::vector<size_t>& commandSizes, CmdFlagMM flags) {
+  auto time = std::chrono::steady_clock::now();
+  auto count = deviceLayer_->sendCommandsMasterMinion(device, sqIdx, commands, commandSizes, flags);
+  for (size_t i = 0; i < count; ++i) {
+    record(EventKind::MmCommand, device, sqIdx, time, commands, commandSizes[i]);
+    commands += commandSizes[i];
+  }
+  return count;
+}
+
+void DeviceRecorder::setSqThresholdMasterMinion(int device, int sqIdx, uint32_t bytesNeeded) {
+  deviceLayer_->setSqThresholdMasterMinion(device, sqIdx, bytesNeeded);
+}
+
+void DeviceRecorder::waitForEpollEventsMasterMinion(int device, uint64_t& sqBitmap, bool& cqAvailable,
+                                                    std::chrono::milliseconds timeout) {
+  deviceLayer_->waitForEpollEventsMasterMinion(device, sqBitmap, cqAvailable, timeout);
+}
+
+bool DeviceRecorder::receiveResponseMasterMinion(int device, std::vector<std::byte>& response) {
+  auto received = deviceLayer_->receiveResponseMasterMinion(device, response);
+  if (received) {
+    record(EventKind::MmResponse, device, 0, std::chrono::steady_clock::now(), response.data(), response.size());
+  }
+  return received;
+}
+
+size_t DeviceRecorder::receiveResponsesMasterMinion(int device, std::vector<std::vector<std::byte>>& responses) {
+  auto count = deviceLayer_->receiveResponsesMasterMinion(device, responses);
+  auto time = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < count; ++i) {
+    record(EventKind::MmResponse, device, 0, time, responses[i].data(), responses[i].size());
+  }
+  return count;
+}
+
+size_t DeviceRecorder::receiveResponsesFromCqMasterMinion(int device, int cqIdx,
+                                                          std::vector<std::vector<std::byte>>& responses) {
+  auto count = deviceLayer_->receiveResponsesFromCqMasterMinion(device, cqIdx, responses);
+  auto time = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < count; ++i) {
+    record(EventKind::MmResponse, device, cqIdx, time, responses[i].data(), responses[i].size());
+  }
+  return count;
+}
+
+bool DeviceRecorder::waitForCqEventMasterMinion(int device, int cqIdx, std::chrono::milliseconds timeout) {
+  return deviceLayer_->waitForCqEventMasterMinion(device, cqIdx, timeout);
+}
+
+bool DeviceRecorder::sendCommandServiceProcessor(int device, std::byte* command, size_t commandSize,
+                                                 CmdFlagSP flags) {
+  auto time = std::chrono::steady_clock::now();
+  auto sent = deviceLayer_->sendCommandServiceProcessor(device, command, commandSize, flags);
+  if (sent) {
+    record(EventKind::SpCommand, device, 0, time, command, commandSize);
+  }
+  return sent;
+}
+
+void DeviceRecorder::setSqThresholdServiceProcessor(int device, uint32_t bytesNeeded) {
+  deviceLayer_->setSqThresholdServiceProcessor(device, bytesNeeded);
+}
+
+void DeviceRecorder::waitForEpollEventsServiceProcessor(int device, bool& sqAvailable, bool& cqAvailable,
+                                                        std::chrono::milliseconds timeout) {
+  deviceLayer_->waitForEpollEventsServiceProcessor(device, sqAvailable, cqAvailable, timeout);
+}
+
+bool DeviceRecorder::receiveResponseServiceProcessor(int device, std::vector<std::byte>& response) {
+  auto received = deviceLayer_->receiveResponseServiceProcessor(device, response);
+  if (received) {
+    record(EventKind::SpResponse, device, 0, std::chrono::steady_clock::now(), response.data(), response.size());
+  }
+  return received;
+}
+
+DmaInfo DeviceRecorder::getDmaInfo(int device) const {
+  return deviceLayer_->getDmaInfo(device);
+}
+
+int DeviceRecorder::getDevicesCount() const {
+  return deviceLayer_->getDevicesCount();
+}
+
+int DeviceRecorder::getSubmissionQueuesCount(int device) const {
+  return deviceLayer_->getSubmissionQueuesCount(device);
+}
+
+int DeviceRecorder::getCompletionQueuesCount(int device) const {
+  return deviceLayer_->getCompletionQueuesCount(device);
+}
+
+DeviceState DeviceRecorder::getDeviceStateMasterMinion(int device) const {
+  return deviceLayer_->getDeviceStateMasterMinion(device);
+}
+
+DeviceState DeviceRecorder::getDeviceStateServiceProcessor(int device) const {
+  return deviceLayer_->getDeviceStateServiceProcessor(device);
+}
+
+size_t DeviceRecorder::getSubmissionQueueSizeMasterMinion(int device) const {
+  return deviceLayer_->getSubmissionQueueSizeMasterMinion(device);
+}
+
+size_t DeviceRecorder::getSubmissionQueueSizeServiceProcessor(int device) const {
+  return deviceLayer_->getSubmissionQueueSizeServiceProcessor(device);
+}
+
+size_t DeviceRecorder::getTraceBufferSizeMasterMinion(int device, TraceBufferType traceType) {
+  return deviceLayer_->getTraceBufferSizeMasterMinion(device, traceType);
+}
+
+bool DeviceRecorder::getTraceBufferServiceProcessor(int device, TraceBufferType traceType,
+                                                    std::vector<std::byte>& traceBuf) {
+  return deviceLayer_->getTraceBufferServiceProcessor(device, traceType, traceBuf);
+}
+
+size_t DeviceRecorder::readTraceBufferServiceProcessor(int device, TraceBufferType traceType, size_t offset,
+                                                       std::byte* buf, size_t size) {
+  return deviceLayer_->readTraceBufferServiceProcessor(device, traceType, offset, buf, size);
+}
+
+int DeviceRecorder::updateFirmwareImage(int device, std::vector<unsigned char>& fwImage) {
+  return deviceLayer_->updateFirmwareImage(device, fwImage);
+}
+
+int DeviceRecorder::getDmaAlignment() const {
+  return deviceLayer_->getDmaAlignment();
+}
+
+uint64_t DeviceRecorder::getDramSize(int device) const {
+  return deviceLayer_->getDramSize(device);
+}
+
+uint64_t DeviceRecorder::getDramBaseAddress(int device) const {
+  return deviceLayer_->getDramBaseAddress(device);
+}
+
+void* DeviceRecorder::allocDmaBuffer(int device, size_t sizeInBytes, bool writeable) {
+  return deviceLayer_->allocDmaBuffer(device, sizeInBytes, writeable);
+}
+
+void DeviceRecorder::freeDmaBuffer(void* dmaBuffer) {
+  deviceLayer_->freeDmaBuffer(dmaBuffer);
+}
+
+DeviceConfig DeviceRecorder::getDeviceConfig(int device) {
+  return deviceLayer_->getDeviceConfig(device);
+}
+
+int DeviceRecorder::getActiveShiresNum(int device) {
+  return deviceLayer_->getActiveShiresNum(device);
+}
+
+uint32_t DeviceRecorder::getFrequencyMHz(int device) {
+  return deviceLayer_->getFrequencyMHz(device);
+}
+
+size_t DeviceRecorder::getFreeCmaMemory() const {
+  return deviceLayer_->getFreeCmaMemory();
+}
+
+std::string DeviceRecorder::getDeviceAttribute(int device, std::string relAttrPath) const {
+  return deviceLayer_->getDeviceAttribute(device, std::move(relAttrPath));
+}
+
+void DeviceRecorder::clearDeviceAttributes(int device, std::string relGroupPath) const {
+  deviceLayer_->clearDeviceAttributes(device, std::move(relGroupPath));
+}
+
+DeviceStatsSnapshot DeviceRecorder::getDeviceStatsSnapshot(int device) const {
+  return deviceLayer_->getDeviceStatsSnapshot(device);
+}
+
+void DeviceRecorder::invalidateCachedState(int device) {
+  deviceLayer_->invalidateCachedState(device);
+}
+
+void DeviceRecorder::reinitDeviceInstance(int device, bool masterMinionOnly, std::chrono::milliseconds timeout) {
+  deviceLayer_->reinitDeviceInstance(device, masterMinionOnly, timeout);
+}
+
+void DeviceRecorder::hintInactivity(int device) {
+  deviceLayer_->hintInactivity(device);
+}
+
+bool DeviceRecorder::checkP2pDmaCompatibility(int deviceA, int deviceB) const {
+  return deviceLayer_->checkP2pDmaCompatibility(deviceA, deviceB);
+}
+
+size_t DeviceRecorder::registerHostMemory(int device, const void* hostPtr, size_t sizeInBytes, bool toDeviceOnly) {
+  return deviceLayer_->registerHostMemory(device, hostPtr, sizeInBytes, toDeviceOnly);
+}
+
+void DeviceRecorder::unregisterHostMemory(int device, const void* hostPtr) {
+  deviceLayer_->unregisterHostMemory(device, hostPtr);
+}
+
+bool DeviceRecorder::canStreamHostMemory(int device) const {
+  return deviceLayer_->canStreamHostMemory(device);
+}
+
+std::byte* DeviceRecorder::getMappedDram(int device) const {
+  return deviceLayer_->getMappedDram(device);
+}
+
+void* DeviceRecorder::allocHugePageDmaBuffer(int device, size_t sizeInBytes, bool writeable) {
+  return deviceLayer_->allocHugePageDmaBuffer(device, sizeInBytes, writeable);
+}
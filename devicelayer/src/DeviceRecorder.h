@@ -0,0 +1,87 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) 2025 Ainekko, Co.
+ * SPDX-License-Identifier: Apache-2.0
+ *-------------------------------------------------------------------------*/
+#pragma once
+#include "Recording.h"
+#include "device-layer/IDeviceLayer.h"
+
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <string>
+
+namespace dev {
+
+// forwards everything to another device layer, writing the commands sent to the master minion and service processor
+// SQs and the responses read from their CQs to a recording, to be replayed later by DeviceReplay. The data moved by
+// the DMA commands is not recorded, only the commands themselves
+class DeviceRecorder final : public IDeviceLayer {
+public:
+  DeviceRecorder(std::unique_ptr<IDeviceLayer> deviceLayer, const std::string& path);
+
+  // IDeviceAsync
+  bool sendCommandMasterMinion(int device, int sqIdx, std::byte* command, size_t commandSize, CmdFlagMM flags) override;
+  size_t sendCommandsMasterMinion(int device, int sqIdx, std::byte* commands, const std::vector<size_t>& commandSizes,
+                                  CmdFlagMM flags) override;
+  void setSqThresholdMasterMinion(int device, int sqIdx, uint32_t bytesNeeded) override;
+  void waitForEpollEventsMasterMinion(int device, uint64_t& sqBitmap, bool& cqAvailable,
+                                      std::chrono::milliseconds timeout = std::chrono::seconds(10)) override;
+  bool receiveResponseMasterMinion(int device, std::vector<std::byte>& response) override;
+  size_t receiveResponsesMasterMinion(int device, std::vector<std::vector<std::byte>>& responses) override;
+  size_t receiveResponsesFromCqMasterMinion(int device, int cqIdx,
+                                            std::vector<std::vector<std::byte>>& responses) override;
+  bool waitForCqEventMasterMinion(int device, int cqIdx, std::chrono::milliseconds timeout) override;
+
+  bool sendCommandServiceProcessor(int device, std::byte* command, size_t commandSize, CmdFlagSP flags) override;
+  void setSqThresholdServiceProcessor(int device, uint32_t bytesNeeded) override;
+  void waitForEpollEventsServiceProcessor(int device, bool& sqAvailable, bool& cqAvailable,
+                                          std::chrono::milliseconds timeout = std::chrono::seconds(10)) override;
+  bool receiveResponseServiceProcessor(int device, std::vector<std::byte>& response) override;
+
+  // IDeviceSync
+  DmaInfo getDmaInfo(int device) const override;
+  int getDevicesCount() const override;
+  int getSubmissionQueuesCount(int device) const override;
+  int getCompletionQueuesCount(int device) const override;
+  DeviceState getDeviceStateMasterMinion(int device) const override;
+  DeviceState getDeviceStateServiceProcessor(int device) const override;
+  size_t getSubmissionQueueSizeMasterMinion(int device) const override;
+  size_t getSubmissionQueueSizeServiceProcessor(int device) const override;
+  size_t getTraceBufferSizeMasterMinion(int device, TraceBufferType traceType) override;
+  bool getTraceBufferServiceProcessor(int device, TraceBufferType traceType, std::vector<std::byte>& traceBuf) override;
+  size_t readTraceBufferServiceProcessor(int device, TraceBufferType traceType, size_t offset, std::byte* buf,
+                                         size_t size) override;
+  int updateFirmwareImage(int device, std::vector<unsigned char>& fwImage) override;
+  int getDmaAlignment() const override;
+  uint64_t getDramSize(int device) const override;
+  uint64_t getDramBaseAddress(int device) const override;
+  void* allocDmaBuffer(int device, size_t sizeInBytes, bool writeable) override;
+  void freeDmaBuffer(void* dmaBuffer) override;
+  DeviceConfig getDeviceConfig(int device) override;
+  int getActiveShiresNum(int device) override;
+  uint32_t getFrequencyMHz(int device) override;
+  size_t getFreeCmaMemory() const override;
+  std::string getDeviceAttribute(int device, std::string relAttrPath) const override;
+  void clearDeviceAttributes(int device, std::string relGroupPath) const override;
+  DeviceStatsSnapshot getDeviceStatsSnapshot(int device) const override;
+  void invalidateCachedState(int device) override;
+  void reinitDeviceInstance(int device, bool masterMinionOnly, std::chrono::milliseconds timeout) override;
+  void hintInactivity(int device) override;
+  bool checkP2pDmaCompatibility(int deviceA, int deviceB) const override;
+  size_t registerHostMemory(int device, const void* hostPtr, size_t sizeInBytes, bool toDeviceOnly) override;
+  void unregisterHostMemory(int device, const void* hostPtr) override;
+  bool canStreamHostMemory(int device) const override;
+  std::byte* getMappedDram(int device) const override;
+  void* allocHugePageDmaBuffer(int device, size_t sizeInBytes, bool writeable) override;
+
+private:
+  void record(recording::EventKind kind, int device, int queue, std::chrono::steady_clock::time_point time,
+              const std::byte* data, size_t size);
+
+  std::unique_ptr<IDeviceLayer> deviceLayer_;
+  std::chrono::steady_clock::time_point start_;
+  std::mutex mutex_;
+  std::ofstream file_;
+};
+} // namespace dev
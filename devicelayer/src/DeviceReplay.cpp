@@ -0,0 +1,340 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) 2025 Ainekko, Co.
+ * SPDX-License-Identifier: Apache-2.0
+ *-------------------------------------------------------------------------*/
+
+#include "DeviceReplay.h"
+#include "Utils.h"
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+using namespace dev;
+using namespace dev::recording;
+
+namespace {
+template <typename T> bool read(std::ifstream& file, T& value) {
+  return static_cast<bool>(file.read(reinterpret_cast<char*>(&value), sizeof(value)));
+}
+
+uint16_t getHeaderField(const std::byte* message, size_t offset) {
+  uint16_t value;
+  std::memcpy(&value, message + offset, sizeof(value));
+  return value;
+}
+} // namespace
+
+DeviceReplay::DeviceReplay(const std::string& path, bool recordedLatency)
+  : recordedLatency_(recordedLatency) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    throw Exception("Can't open the recording file " + path);
+  }
+  Header header;
+  if (!read(file, header) || header.magic_ != kMagic) {
+    throw Exception(path + " is not a device layer recording");
+  }
+  if (header.version_ != kVersion || header.deviceInfoSize_ != sizeof(DeviceInfo) ||
+      header.eventHeaderSize_ != sizeof(EventHeader)) {
+    throw Exception("The recording " + path + " was written by an incompatible device layer");
+  }
+  dmaAlignment_ = header.dmaAlignment_;
+  freeCmaMemory_ = header.freeCmaMemory_;
+  for (int i = 0; i < header.numDevices_; ++i) {
+    auto device = std::make_unique<Device>();
+    if (!read(file, device->info_)) {
+      throw Exception("Truncated recording " + path);
+    }
+    device->mm_.responses_.resize(static_cast<size_t>(std::max(device->info_.completionQueuesCount_, 1)));
+    device->sp_.responses_.resize(1);
+    devices_.emplace_back(std::move(device));
+  }
+
+  // timestamp of the last command of each endpoint
+  std::vector<std::array<int64_t, 2>> lastCommands(devices_.size(), {0, 0});
+  EventHeader event;
+  auto numEvents = 0UL;
+  while (read(file, event)) {
+    std::vector<std::byte> data(event.size_);
+    if (!file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size()))) {
+      throw Exception("Truncated recording " + path);
+    }
+    if (event.device_ < 0 || static_cast<size_t>(event.device_) >= devices_.size()) {
+      throw Exception("Invalid device in the recording " + path);
+    }
+    auto& device = *devices_[static_cast<size_t>(event.device_)];
+    auto isMasterMinion = event.kind_ == EventKind::MmCommand || event.kind_ == EventKind::MmResponse;
+    auto& endpoint = isMasterMinion ? device.mm_ : device.sp_;
+    auto& lastCommand = lastCommands[static_cast<size_t>(event.device_)][isMasterMinion ? 0 : 1];
+    if (event.kind_ == EventKind::MmCommand || event.kind_ == EventKind::SpCommand) {
+      RecordedCommand command{0, 0};
+      if (data.size() >= kHeaderSize) {
+        command.tagId_ = getHeaderField(data.data(), kTagIdOffset);
+        command.msgId_ = getHeaderField(data.data(), kTagIdOffset + sizeof(uint16_t));
+      }
+      endpoint.commands_.emplace_back(command);
+      lastCommand = event.timestamp_;
+    } else {
+      if (event.queue_ >= endpoint.responses_.size()) {
+        endpoint.responses_.resize(event.queue_ + 1UL);
+      }
+      endpoint.responses_[event.queue_].push_back(
+        Response{endpoint.commands_.size(), std::chrono::nanoseconds(event.timestamp_ - lastCommand), std::move(data)});
+    }
+    ++numEvents;
+  }
+  DV_LOG(INFO) << "Replaying " << numEvents << " events of " << devices_.size() << " devices from " << path
+               << (recordedLatency_ ? " with the recorded latency" : " with zero latency");
+}
+
+DeviceReplay::Device& DeviceReplay::getDevice(int device) const {
+  if (device < 0 || static_cast<size_t>(device) >= devices_.size()) {
+    throw Exception("Invalid device " + std::to_string(device));
+  }
+  return *devices_[static_cast<size_t>(device)];
+}
+
+void DeviceReplay::send(Device& dev, Endpoint& endpoint, const std::byte* command, size_t commandSize) {
+  {
+    std::lock_guard lock(dev.mutex_);
+    auto index = endpoint.sendTimes_.size();
+    if (index < endpoint.commands_.size() && commandSize >= kHeaderSize) {
+      const auto& recorded = endpoint.commands_[index];
+      if (recorded.msgId_ != getHeaderField(command, kTagIdOffset + sizeof(uint16_t)) && !endpoint.diverged_) {
+        DV_LOG(WARNING) << "The replayed commands diverge from the recording at command " << index
+                        << ", the responses could not match them";
+        endpoint.diverged_ = true;
+      }
+      endpoint.tagIds_[recorded.tagId_] = getHeaderField(command, kTagIdOffset);
+    } else if (index == endpoint.commands_.size() && !endpoint.diverged_) {
+      DV_LOG(WARNING) << "More commands than in the recording, they won't get a response";
+      endpoint.diverged_ = true;
+    }
+    endpoint.sendTimes_.emplace_back(Clock::now());
+  }
+  dev.condVar_.notify_all();
+}
+
+DeviceReplay::Clock::time_point DeviceReplay::getReadyTime(const Endpoint& endpoint, size_t cqIdx) const {
+  if (cqIdx >= endpoint.responses_.size() || endpoint.responses_[cqIdx].empty()) {
+    return Clock::time_point::max();
+  }
+  const auto& response = endpoint.responses_[cqIdx].front();
+  if (endpoint.sendTimes_.size() < response.commandsBefore_) {
+    return Clock::time_point::max();
+  }
+  if (!recordedLatency_ || response.commandsBefore_ == 0) {
+    return Clock::time_point::min();
+  }
+  return endpoint.sendTimes_[response.commandsBefore_ - 1] +
+         std::chrono::duration_cast<Clock::duration>(response.delay_);
+}
+
+bool DeviceReplay::receive(Device& dev, Endpoint& endpoint, size_t cqIdx, std::vector<std::byte>& response) {
+  std::lock_guard lock(dev.mutex_);
+  if (getReadyTime(endpoint, cqIdx) > Clock::now()) {
+    return false;
+  }
+  auto& queue = endpoint.responses_[cqIdx];
+  response = std::move(queue.front().data_);
+  queue.pop_front();
+  if (response.size() >= kHeaderSize) {
+    auto it = endpoint.tagIds_.find(getHeaderField(response.data(), kTagIdOffset));
+    if (it != end(endpoint.tagIds_)) {
+      std::memcpy(response.data() + kTagIdOffset, &it->second, sizeof(it->second));
+    }
+  }
+  return true;
+}
+
+bool DeviceReplay::wait(Device& dev, Endpoint& endpoint, int cqIdx, std::chrono::milliseconds timeout) {
+  auto deadline = Clock::now() + timeout;
+  std::unique_lock lock(dev.mutex_);
+  for (;;) {
+    auto readyTime = Clock::time_point::max();
+    if (cqIdx < 0) {
+      for (size_t i = 0; i < endpoint.responses_.size(); ++i) {
+        readyTime = std::min(readyTime, getReadyTime(endpoint, i));
+      }
+    } else {
+      readyTime = getReadyTime(endpoint, static_cast<size_t>(cqIdx));
+    }
+    auto now = Clock::now();
+    if (readyTime <= now) {
+      return true;
+    }
+    if (now >= deadline) {
+      return false;
+    }
+    // woken up by the commands sent, which can make a response available
+    dev.condVar_.wait_until(lock, std::min(deadline, readyTime));
+  }
+}
+
+bool DeviceReplay::sendCommandMasterMinion(int device, int, std::byte* command, size_t commandSize, CmdFlagMM) {
+  auto& dev = getDevice(device);
+  send(dev, dev.mm_, command, commandSize);
+  return true;
+}
+
+void DeviceReplay::setSqThresholdMasterMinion(int, int, uint32_t) {
+}
+
+void DeviceReplay::waitForEpollEventsMasterMinion(int device, uint64_t& sqBitmap, bool& cqAvailable,
+                                                  std::chrono::milliseconds) {
+  auto& dev = getDevice(device);
+  auto sqCount = dev.info_.submissionQueuesCount_;
+  sqBitmap = sqCount >= 64 ? ~0UL : (1UL << sqCount) - 1;
+  cqAvailable = wait(dev, dev.mm_, -1, std::chrono::milliseconds(0));
+}
+
+bool DeviceReplay::receiveResponseMasterMinion(int device, std::vector<std::byte>& response) {
+  auto& dev = getDevice(device);
+  return receive(dev, dev.mm_, 0, response);
+}
+
+size_t DeviceReplay::receiveResponsesFromCqMasterMinion(int device, int cqIdx,
+                                                        std::vector<std::vector<std::byte>>& responses) {
+  auto& dev = getDevice(device);
+  size_t count = 0;
+  while (count < responses.size() && receive(dev, dev.mm_, static_cast<size_t>(cqIdx), responses[count])) {
+    ++count;
+  }
+  return count;
+}
+
+bool DeviceReplay::waitForCqEventMasterMinion(int device, int cqIdx, std::chrono::milliseconds timeout) {
+  auto& dev = getDevice(device);
+  return wait(dev, dev.mm_, cqIdx, timeout);
+}
+
+bool DeviceReplay::sendCommandServiceProcessor(int device, std::byte* command, size_t commandSize, CmdFlagSP) {
+  auto& dev = getDevice(device);
+  send(dev, dev.sp_, command, commandSize);
+  return true;
+}
+
+void DeviceReplay::setSqThresholdServiceProcessor(int, uint32_t) {
+}
+
+void DeviceReplay::waitForEpollEventsServiceProcessor(int device, bool& sqAvailable, bool& cqAvailable,
+                                                      std::chrono::milliseconds timeout) {
+  auto& dev = getDevice(device);
+  sqAvailable = true;
+  cqAvailable = wait(dev, dev.sp_, 0, timeout);
+}
+
+bool DeviceReplay::receiveResponseServiceProcessor(int device, std::vector<std::byte>& response) {
+  auto& dev = getDevice(device);
+  return receive(dev, dev.sp_, 0, response);
+}
+
+DmaInfo DeviceReplay::getDmaInfo(int device) const {
+  return getDevice(device).info_.dmaInfo_;
+}
+
+int DeviceReplay::getDevicesCount() const {
+  return static_cast<int>(devices_.size());
+}
+
+int DeviceReplay::getSubmissionQueuesCount(int device) const {
+  return getDevice(device).info_.submissionQueuesCount_;
+}
+
+int DeviceReplay::getCompletionQueuesCount(int device) const {
+  return getDevice(device).info_.completionQueuesCount_;
+}
+
+DeviceState DeviceReplay::getDeviceStateMasterMinion(int device) const {
+  getDevice(device);
+  return DeviceState::Ready;
+}
+
+DeviceState DeviceReplay::getDeviceStateServiceProcessor(int device) const {
+  getDevice(device);
+  return DeviceState::Ready;
+}
+
+size_t DeviceReplay::getSubmissionQueueSizeMasterMinion(int device) const {
+  return getDevice(device).info_.submissionQueueSizeMasterMinion_;
+}
+
+size_t DeviceReplay::getSubmissionQueueSizeServiceProcessor(int device) const {
+  return getDevice(device).info_.submissionQueueSizeServiceProcessor_;
+}
+
+size_t DeviceReplay::getTraceBufferSizeMasterMinion(int, TraceBufferType) {
+  return 0;
+}
+
+bool DeviceReplay::getTraceBufferServiceProcessor(int, TraceBufferType, std::vector<std::byte>&) {
+  return false;
+}
+
+int DeviceReplay::updateFirmwareImage(int, std::vector<unsigned char>&) {
+  throw Exception("Firmware updates are not supported by the replay device layer");
+}
+
+int DeviceReplay::getDmaAlignment() const {
+  return dmaAlignment_;
+}
+
+uint64_t DeviceReplay::getDramSize(int device) const {
+  return getDevice(device).info_.dramSize_;
+}
+
+uint64_t DeviceReplay::getDramBaseAddress(int device) const {
+  return getDevice(device).info_.dramBaseAddress_;
+}
+
+void* DeviceReplay::allocDmaBuffer(int device, size_t sizeInBytes, bool) {
+  getDevice(device);
+  auto alignment = static_cast<size_t>(std::max(dmaAlignment_, static_cast<int>(sizeof(void*))));
+  auto size = (sizeInBytes + alignment - 1) / alignment * alignment;
+  auto buffer = std::aligned_alloc(alignment, size);
+  if (buffer == nullptr) {
+    throw Exception("Can't allocate a DMA buffer of " + std::to_string(sizeInBytes) + " bytes");
+  }
+  return buffer;
+}
+
+void DeviceReplay::freeDmaBuffer(void* dmaBuffer) {
+  std::free(dmaBuffer);
+}
+
+DeviceConfig DeviceReplay::getDeviceConfig(int device) {
+  return getDevice(device).info_.config_;
+}
+
+int DeviceReplay::getActiveShiresNum(int device) {
+  return getDevice(device).info_.activeShiresNum_;
+}
+
+uint32_t DeviceReplay::getFrequencyMHz(int device) {
+  return getDevice(device).info_.frequencyMHz_;
+}
+
+size_t DeviceReplay::getFreeCmaMemory() const {
+  return freeCmaMemory_;
+}
+
+std::string DeviceReplay::getDeviceAttribute(int device, std::string) const {
+  getDevice(device);
+  return "";
+}
+
+void DeviceReplay::clearDeviceAttributes(int device, std::string) const {
+  getDevice(device);
+}
+
+void DeviceReplay::reinitDeviceInstance(int device, bool, std::chrono::milliseconds) {
+  getDevice(device);
+}
+
+void DeviceReplay::hintInactivity(int device) {
+  getDevice(device);
+}
+
+bool DeviceReplay::checkP2pDmaCompatibility(int, int) const {
+  return false;
+}
@@ -0,0 +1,114 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) 2025 Ainekko, Co.
+ * SPDX-License-Identifier: Apache-2.0
+ *-------------------------------------------------------------------------*/
+#pragma once
+#include "Recording.h"
+#include "device-layer/IDeviceLayer.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace dev {
+
+// serves the responses of a recording written by DeviceRecorder, without any device. A response is available once
+// as many commands as had been sent when it was received have been sent again to the same device, and, with the
+// recorded latency, once the time between the last of them and the response in the recording has elapsed. The tag
+// ids of the responses are replaced by the tag ids of the replayed commands, matched by their order.
+//
+// The SQs are never full and the DMA commands don't move any data, the bytes read from the device are meaningless.
+// Meant to measure the host side of the stack, the commands sent should be the ones of the recorded run
+class DeviceReplay final : public IDeviceLayer {
+public:
+  DeviceReplay(const std::string& path, bool recordedLatency);
+
+  // IDeviceAsync
+  bool sendCommandMasterMinion(int device, int sqIdx, std::byte* command, size_t commandSize, CmdFlagMM flags) override;
+  void setSqThresholdMasterMinion(int device, int sqIdx, uint32_t bytesNeeded) override;
+  void waitForEpollEventsMasterMinion(int device, uint64_t& sqBitmap, bool& cqAvailable,
+                                      std::chrono::milliseconds timeout = std::chrono::seconds(10)) override;
+  bool receiveResponseMasterMinion(int device, std::vector<std::byte>& response) override;
+  size_t receiveResponsesFromCqMasterMinion(int device, int cqIdx,
+                                            std::vector<std::vector<std::byte>>& responses) override;
+  bool waitForCqEventMasterMinion(int device, int cqIdx, std::chrono::milliseconds timeout) override;
+
+  bool sendCommandServiceProcessor(int device, std::byte* command, size_t commandSize, CmdFlagSP flags) override;
+  void setSqThresholdServiceProcessor(int device, uint32_t bytesNeeded) override;
+  void waitForEpollEventsServiceProcessor(int device, bool& sqAvailable, bool& cqAvailable,
+                                          std::chrono::milliseconds timeout = std::chrono::seconds(10)) override;
+  bool receiveResponseServiceProcessor(int device, std::vector<std::byte>& response) override;
+
+  // IDeviceSync
+  DmaInfo getDmaInfo(int device) const override;
+  int getDevicesCount() const override;
+  int getSubmissionQueuesCount(int device) const override;
+  int getCompletionQueuesCount(int device) const override;
+  DeviceState getDeviceStateMasterMinion(int device) const override;
+  DeviceState getDeviceStateServiceProcessor(int device) const override;
+  size_t getSubmissionQueueSizeMasterMinion(int device) const override;
+  size_t getSubmissionQueueSizeServiceProcessor(int device) const override;
+  size_t getTraceBufferSizeMasterMinion(int device, TraceBufferType traceType) override;
+  bool getTraceBufferServiceProcessor(int device, TraceBufferType traceType, std::vector<std::byte>& traceBuf) override;
+  int updateFirmwareImage(int device, std::vector<unsigned char>& fwImage) override;
+  int getDmaAlignment() const override;
+  uint64_t getDramSize(int device) const override;
+  uint64_t getDramBaseAddress(int device) const override;
+  void* allocDmaBuffer(int device, size_t sizeInBytes, bool writeable) override;
+  void freeDmaBuffer(void* dmaBuffer) override;
+  DeviceConfig getDeviceConfig(int device) override;
+  int getActiveShiresNum(int device) override;
+  uint32_t getFrequencyMHz(int device) override;
+  size_t getFreeCmaMemory() const override;
+  std::string getDeviceAttribute(int device, std::string relAttrPath) const override;
+  void clearDeviceAttributes(int device, std::string relGroupPath) const override;
+  void reinitDeviceInstance(int device, bool masterMinionOnly, std::chrono::milliseconds timeout) override;
+  void hintInactivity(int device) override;
+  bool checkP2pDmaCompatibility(int deviceA, int deviceB) const override;
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  struct RecordedCommand {
+    uint16_t tagId_;
+    uint16_t msgId_;
+  };
+  struct Response {
+    size_t commandsBefore_;         ///< commands sent to the device when the response was received
+    std::chrono::nanoseconds delay_; ///< since the last of these commands
+    std::vector<std::byte> data_;
+  };
+  // the master minion or the service processor of a device
+  struct Endpoint {
+    std::vector<RecordedCommand> commands_;
+    std::vector<std::deque<Response>> responses_; ///< by CQ
+    std::vector<Clock::time_point> sendTimes_;    ///< of the replayed commands
+    std::unordered_map<uint16_t, uint16_t> tagIds_; ///< recorded tag id to replayed tag id
+    bool diverged_ = false;
+  };
+  struct Device {
+    recording::DeviceInfo info_;
+    Endpoint mm_;
+    Endpoint sp_;
+    std::mutex mutex_;
+    std::condition_variable condVar_;
+  };
+
+  Device& getDevice(int device) const;
+  void send(Device& dev, Endpoint& endpoint, const std::byte* command, size_t commandSize);
+  // time the next response of the CQ becomes available, Clock::time_point::max() if it's waiting for commands or if
+  // there are no more responses
+  Clock::time_point getReadyTime(const Endpoint& endpoint, size_t cqIdx) const;
+  bool receive(Device& dev, Endpoint& endpoint, size_t cqIdx, std::vector<std::byte>& response);
+  // waits till a response of the CQ, any of them if cqIdx is -1, is available
+  bool wait(Device& dev, Endpoint& endpoint, int cqIdx, std::chrono::milliseconds timeout);
+
+  std::vector<std::unique_ptr<Device>> devices_;
+  int dmaAlignment_;
+  size_t freeCmaMemory_;
+  bool recordedLatency_;
+};
+} // namespace dev
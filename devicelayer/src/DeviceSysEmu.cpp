@@ -5,10 +5,13 @@
 #include "DeviceSysEmu.h"
 #include "SysEmuHostListener.h"
 #include "Utils.h"
+#include <algorithm>
+#include <atomic>
 #include <boost/crc.hpp>
 #include <chrono>
 #include <elfio/elfio.hpp>
 #include <cassert>
+#include <cstring>
 #include <future>
 #include <mutex>
 #include <stdio.h>
@@ -42,6 +45,8 @@ constexpr int kNumDevices = 1;
 constexpr auto kCommonHeaderSize = 8U;
 // This is the max possible size of the device API commands (DMA list with all 4 entries)
 constexpr auto kMMThresholdBytes = 136U;
+// the MM CQs notify from MSI vector 3 (MM_CQ) up, one vector per CQ while the device has vectors enough
+constexpr uint32_t kMMCqInterrupts = 0xFFU & ~(static_cast<uint32_t>(MM_CQ) - 1U);
 
 constexpr auto kDmaElemSize = 64 << 20;
 constexpr auto kDmaElemCount = 4;
@@ -95,6 +100,10 @@ int DeviceSysEmu::getSubmissionQueuesCount(int) const {
   return mmInfo_.vq_attr.sq_count;
 }
 
+int DeviceSysEmu::getCompletionQueuesCount(int) const {
+  return mmInfo_.vq_attr.cq_count;
+}
+
 DeviceState DeviceSysEmu::getDeviceStateMasterMinion(int) const {
   return DeviceState::Ready;
 }
@@ -162,15 +171,15 @@ DeviceSysEmu::DeviceSysEmu(const emu::SysEmuOptions& options) {
       //  - MSI Vector[1] - Mgmt CQ
       // Device Operations:
       //  - MSI Vector[2] - Ops SQ(s)
-      //  - MSI Vector[3] - Ops CQ
-      auto bitmap = sysEmu_->waitForInterrupt(SP_SQ | SP_CQ | MM_SQ | MM_CQ);
+      //  - MSI Vector[3..7] - Ops CQ(s)
+      auto bitmap = sysEmu_->waitForInterrupt(SP_SQ | SP_CQ | MM_SQ | kMMCqInterrupts);
       std::lock_guard lock(mutex_);
       if (bitmap & (SP_SQ | SP_CQ)) {
         spIntrptBitmap_ |= bitmap & (SP_SQ | SP_CQ);
         spEpollBlock_.notify_all();
       }
-      if (bitmap & (MM_SQ | MM_CQ)) {
-        mmIntrptBitmap_ |= bitmap & (MM_SQ | MM_CQ);
+      if (bitmap & (MM_SQ | kMMCqInterrupts)) {
+        mmIntrptBitmap_ |= bitmap & (MM_SQ | kMMCqInterrupts);
         mmEpollBlock_.notify_all();
       }
     }
@@ -195,6 +204,39 @@ DeviceSysEmu::~DeviceSysEmu() {
   DV_LOG(INFO) << "Interrupt listener joined";
 }
 
+void DeviceSysEmu::mapQueue(QueueInfo& queue) {
+  // the circular buffers live in plain device memory, mapping them saves a round trip through the sysemu thread per
+  // access. The device is notified through the doorbell interrupts as usual
+  queue.mapped_ = sysEmu_->mapMmio(queue.bufferAddress_, queue.size_);
+  if (!queue.mapped_) {
+    DV_LOG(WARNING) << "Couldn't map queue at: " << std::hex << queue.bufferAddress_ << ", using mmio accesses";
+  }
+  readQueue(queue, 0, sizeof(queue.cb_), reinterpret_cast<std::byte*>(&queue.cb_));
+}
+
+void DeviceSysEmu::readQueue(const QueueInfo& queue, size_t offset, size_t size, std::byte* dst) const {
+  if (!queue.mapped_) {
+    sysEmu_->mmioRead(queue.bufferAddress_ + offset, size, dst);
+    return;
+  }
+  // as mmio accesses do, wake up sysemu in case it was paused on inactivity
+  sysEmu_->resume();
+  std::memcpy(dst, queue.mapped_ + offset, size);
+  // the data is read after the offsets saying it's there
+  std::atomic_thread_fence(std::memory_order_acquire);
+}
+
+void DeviceSysEmu::writeQueue(const QueueInfo& queue, size_t offset, size_t size, const std::byte* src) const {
+  if (!queue.mapped_) {
+    sysEmu_->mmioWrite(queue.bufferAddress_ + offset, size, src);
+    return;
+  }
+  sysEmu_->resume();
+  // the offsets are written after the data they point to
+  std::atomic_thread_fence(std::memory_order_release);
+  std::memcpy(queue.mapped_ + offset, src, size);
+}
+
 bool DeviceSysEmu::sendCommand(QueueInfo& queueInfo, std::byte* command, size_t commandSize, bool& clearEvent) {
   Checker checker{*this};
   clearEvent = true;
@@ -204,8 +246,8 @@ bool DeviceSysEmu::sendCommand(QueueInfo& queueInfo, std::byte* command, size_t
   }
 
   // read tail_offset
-  sysEmu_->mmioRead(queueInfo.bufferAddress_ + offsetof(CircBuffCb, tail_offset), sizeof(queueInfo.cb_.tail_offset),
-                    reinterpret_cast<std::byte*>(&queueInfo.cb_.tail_offset));
+  readQueue(queueInfo, offsetof(CircBuffCb, tail_offset), sizeof(queueInfo.cb_.tail_offset),
+            reinterpret_cast<std::byte*>(&queueInfo.cb_.tail_offset));
 
   // check if there is enough space
   if (getAvailSpace(queueInfo.cb_) < commandSize) {
@@ -215,19 +257,18 @@ bool DeviceSysEmu::sendCommand(QueueInfo& queueInfo, std::byte* command, size_t
   // Check if buffer wrap is required
   if (queueInfo.cb_.head_offset + commandSize > queueInfo.cb_.length) {
     auto bytesUntilEnd = queueInfo.cb_.length - queueInfo.cb_.head_offset;
-    sysEmu_->mmioWrite(queueInfo.bufferAddress_ + sizeof(CircBuffCb) + queueInfo.cb_.head_offset, bytesUntilEnd,
-                       command);
+    writeQueue(queueInfo, sizeof(CircBuffCb) + queueInfo.cb_.head_offset, bytesUntilEnd, command);
     queueInfo.cb_.head_offset = 0;
     commandSize -= bytesUntilEnd;
     command += bytesUntilEnd;
   }
 
-  sysEmu_->mmioWrite(queueInfo.bufferAddress_ + sizeof(CircBuffCb) + queueInfo.cb_.head_offset, commandSize, command);
+  writeQueue(queueInfo, sizeof(CircBuffCb) + queueInfo.cb_.head_offset, commandSize, command);
 
   // Update the head offset
   queueInfo.cb_.head_offset = (queueInfo.cb_.head_offset + commandSize) % queueInfo.cb_.length;
-  sysEmu_->mmioWrite(queueInfo.bufferAddress_ + offsetof(CircBuffCb, head_offset), sizeof(queueInfo.cb_.head_offset),
-                     reinterpret_cast<std::byte*>(&queueInfo.cb_.head_offset));
+  writeQueue(queueInfo, offsetof(CircBuffCb, head_offset), sizeof(queueInfo.cb_.head_offset),
+             reinterpret_cast<std::byte*>(&queueInfo.cb_.head_offset));
 
   // The availability of queue after the command is sent
   if (getAvailSpace(queueInfo.cb_) >= queueInfo.thresholdBytes_) {
@@ -284,7 +325,7 @@ bool DeviceSysEmu::checkForEventEPOLLIN(const QueueInfo& queueInfo) const {
   Checker checker{*this};
   // Pull the latest state of buffer
   CircBuffCb cb;
-  sysEmu_->mmioRead(queueInfo.bufferAddress_, sizeof(cb), reinterpret_cast<std::byte*>(&cb));
+  readQueue(queueInfo, 0, sizeof(cb), reinterpret_cast<std::byte*>(&cb));
 
   return getUsedSpace(cb) > 0;
 }
@@ -295,7 +336,7 @@ bool DeviceSysEmu::checkForEventEPOLLOUT(const QueueInfo& queueInfo) const {
   Checker checker{*this};
   // Pull the latest state of buffer
   CircBuffCb cb;
-  sysEmu_->mmioRead(queueInfo.bufferAddress_, sizeof(cb), reinterpret_cast<std::byte*>(&cb));
+  readQueue(queueInfo, 0, sizeof(cb), reinterpret_cast<std::byte*>(&cb));
 
   return getAvailSpace(cb) >= queueInfo.thresholdBytes_;
 }
@@ -318,10 +359,11 @@ bool DeviceSysEmu::foundEventsMasterMinion(uint64_t& sqBitmap, bool& cqAvailable
   }
 
   // Check for CQ availability if it's corresponding interrupt is received
-  if ((mmIntrptBitmap_ & MM_CQ) && !mmCqReady_) {
+  if ((mmIntrptBitmap_ & kMMCqInterrupts) && !mmCqReady_) {
     // Clear interrupt
-    mmIntrptBitmap_ &= ~static_cast<uint32_t>(MM_CQ);
-    tempCqAvailable = checkForEventEPOLLIN(completionQueueMM_);
+    mmIntrptBitmap_ &= ~kMMCqInterrupts;
+    tempCqAvailable = std::any_of(completionQueuesMM_.begin(), completionQueuesMM_.end(),
+                                  [this](const auto& cq) { return checkForEventEPOLLIN(cq); });
   }
   // return true if edge-trigger event(s) found i.e., some bit from sqBitmap or cqReady activates
   // (changes from  0 -> 1), mimic the PCIe driver
@@ -419,8 +461,8 @@ bool DeviceSysEmu::receiveResponse(QueueInfo& queue, std::vector<std::byte>& res
   clearEvent = true;
 
   // read queue info
-  sysEmu_->mmioRead(queue.bufferAddress_ + offsetof(CircBuffCb, head_offset), sizeof(queue.cb_.head_offset),
-                    reinterpret_cast<std::byte*>(&queue.cb_.head_offset));
+  readQueue(queue, offsetof(CircBuffCb, head_offset), sizeof(queue.cb_.head_offset),
+            reinterpret_cast<std::byte*>(&queue.cb_.head_offset));
 
   // helper function to pop from the circular buffer till size (in bytes) into dst, warping the tail offset if needed
   auto bufferPopWraping = [this, &queue](size_t size, std::byte* dst) {
@@ -430,12 +472,12 @@ bool DeviceSysEmu::receiveResponse(QueueInfo& queue, std::vector<std::byte>& res
     }
     if (queue.cb_.tail_offset + size > queue.cb_.length) {
       auto bytesUntillEnd = queue.cb_.length - queue.cb_.tail_offset;
-      sysEmu_->mmioRead(queue.bufferAddress_ + sizeof(CircBuffCb) + queue.cb_.tail_offset, bytesUntillEnd, dst);
+      readQueue(queue, sizeof(CircBuffCb) + queue.cb_.tail_offset, bytesUntillEnd, dst);
       queue.cb_.tail_offset = 0;
       size -= bytesUntillEnd;
       dst += bytesUntillEnd;
     }
-    sysEmu_->mmioRead(queue.bufferAddress_ + sizeof(CircBuffCb) + queue.cb_.tail_offset, size, dst);
+    readQueue(queue, sizeof(CircBuffCb) + queue.cb_.tail_offset, size, dst);
     queue.cb_.tail_offset = (queue.cb_.tail_offset + size) % queue.cb_.length;
     return size;
   };
@@ -462,8 +504,8 @@ bool DeviceSysEmu::receiveResponse(QueueInfo& queue, std::vector<std::byte>& res
   }
 
   // write the tail offset in circular buffer shared memory
-  sysEmu_->mmioWrite(queue.bufferAddress_ + offsetof(CircBuffCb, tail_offset), sizeof(queue.cb_.tail_offset),
-                     reinterpret_cast<std::byte*>(&queue.cb_.tail_offset));
+  writeQueue(queue, offsetof(CircBuffCb, tail_offset), sizeof(queue.cb_.tail_offset),
+             reinterpret_cast<std::byte*>(&queue.cb_.tail_offset));
 
   // The availability of queue after the response is received
   if (getUsedSpace(queue.cb_) > 0) {
@@ -476,8 +518,17 @@ bool DeviceSysEmu::receiveResponse(QueueInfo& queue, std::vector<std::byte>& res
 bool DeviceSysEmu::receiveResponseMasterMinion(int, std::vector<std::byte>& response) {
   DV_VLOG(HIGH) << "Start receiving response from Master Minion";
   std::lock_guard lock(mutex_);
+  bool tmp = false;
   bool clearEvent = true;
-  auto tmp = receiveResponse(completionQueueMM_, response, clearEvent);
+  for (auto& cq : completionQueuesMM_) {
+    bool cqEmpty = true;
+    if (!tmp) {
+      tmp = receiveResponse(cq, response, cqEmpty);
+    } else {
+      cqEmpty = !checkForEventEPOLLIN(cq);
+    }
+    clearEvent = clearEvent && cqEmpty;
+  }
   if (clearEvent) {
     mmCqReady_ = false;
   }
@@ -485,6 +536,25 @@ bool DeviceSysEmu::receiveResponseMasterMinion(int, std::vector<std::byte>& resp
   return tmp;
 }
 
+size_t DeviceSysEmu::receiveResponsesFromCqMasterMinion(int, int cqIdx,
+                                                        std::vector<std::vector<std::byte>>& responses) {
+  std::lock_guard lock(mutex_);
+  if (cqIdx < 0 || static_cast<size_t>(cqIdx) >= completionQueuesMM_.size()) {
+    throw Exception("Invalid queue");
+  }
+  auto& cq = completionQueuesMM_[static_cast<size_t>(cqIdx)];
+  size_t count = 0;
+  bool clearEvent = true;
+  while (count < responses.size() && receiveResponse(cq, responses[count], clearEvent)) {
+    ++count;
+  }
+  // the other CQs may still have responses, resetting it only costs a spurious event
+  if (clearEvent) {
+    mmCqReady_ = false;
+  }
+  return count;
+}
+
 bool DeviceSysEmu::receiveResponseServiceProcessor(int, std::vector<std::byte>& response) {
   DV_VLOG(HIGH) << "Start receiving response from Service Processor";
   std::lock_guard lock(mutex_);
@@ -538,13 +608,11 @@ void DeviceSysEmu::setupServiceProcessor() {
       submissionQueueSP_.bufferAddress_ = barAddress_[bar] + barOffset + sqOffset;
       submissionQueueSP_.size_ = sqSize * sqCount;
       submissionQueueSP_.thresholdBytes_ = static_cast<uint32_t>(submissionQueueSP_.size_ - sizeof(CircBuffCb)) / 4;
-      sysEmu_->mmioRead(submissionQueueSP_.bufferAddress_, sizeof(submissionQueueSP_.cb_),
-                        reinterpret_cast<std::byte*>(&submissionQueueSP_.cb_));
+      mapQueue(submissionQueueSP_);
       // single completion queue model
       completionQueueSP_.bufferAddress_ = barAddress_[bar] + barOffset + cqOffset;
       completionQueueSP_.size_ = cqSize * cqCount;
-      sysEmu_->mmioRead(completionQueueSP_.bufferAddress_, sizeof(completionQueueSP_.cb_),
-                        reinterpret_cast<std::byte*>(&completionQueueSP_.cb_));
+      mapQueue(completionQueueSP_);
       DV_DLOG(INFO) << "SP Submission and Completion queue initialized!";
       return;
     } else if (status < 0) {
@@ -599,7 +667,7 @@ void DeviceSysEmu::setupMasterMinion() {
         hpSqInfo.bufferAddress_ = barAddress_[bar] + barOffset + hpSqOffset + hpSqIdx * hpSqSize;
         hpSqInfo.size_ = hpSqSize;
         hpSqInfo.thresholdBytes_ = static_cast<uint32_t>(hpSqSize);
-        sysEmu_->mmioRead(hpSqInfo.bufferAddress_, sizeof(hpSqInfo.cb_), reinterpret_cast<std::byte*>(&hpSqInfo.cb_));
+        mapQueue(hpSqInfo);
         hpSubmissionQueuesMM_.emplace_back(hpSqInfo);
       }
 
@@ -609,15 +677,18 @@ void DeviceSysEmu::setupMasterMinion() {
         sqInfo.bufferAddress_ = barAddress_[bar] + barOffset + sqOffset + i * sqSize;
         sqInfo.size_ = sqSize;
         sqInfo.thresholdBytes_ = kMMThresholdBytes;
-        sysEmu_->mmioRead(sqInfo.bufferAddress_, sizeof(sqInfo.cb_), reinterpret_cast<std::byte*>(&sqInfo.cb_));
+        mapQueue(sqInfo);
         submissionQueuesMM_.emplace_back(sqInfo);
       }
 
-      // single completion queue model
-      completionQueueMM_.bufferAddress_ = barAddress_[bar] + barOffset + cqOffset;
-      completionQueueMM_.size_ = cqSize;
-      sysEmu_->mmioRead(completionQueueMM_.bufferAddress_, sizeof(completionQueueMM_.cb_),
-                        reinterpret_cast<std::byte*>(&completionQueueMM_.cb_));
+      // init CQs
+      for (uint8_t i = 0; i < cqCount; ++i) {
+        QueueInfo cqInfo;
+        cqInfo.bufferAddress_ = barAddress_[bar] + barOffset + cqOffset + i * cqSize;
+        cqInfo.size_ = cqSize;
+        mapQueue(cqInfo);
+        completionQueuesMM_.emplace_back(cqInfo);
+      }
       return;
     } else if (status < 0) {
       throw Exception("MM DIRs and VQs discovery failed!");
@@ -737,3 +808,12 @@ bool DeviceSysEmu::checkP2pDmaCompatibility(int, int) const {
   // No implementation for DeviceSysEmu class
   return false;
 }
+
+size_t DeviceSysEmu::registerHostMemory(int, const void*, size_t, bool) {
+  // sysemu accesses host memory through its virtual addresses, any host memory can be used directly
+  return 1;
+}
+
+bool DeviceSysEmu::canStreamHostMemory(int) const {
+  return true;
+}
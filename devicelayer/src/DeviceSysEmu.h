@@ -22,10 +22,10 @@
 namespace dev {
 
 struct CircBuffCb {
-  uint64_t head_offset; /**< Offset of the circular buffer to write data to */
-  uint64_t tail_offset; /**< Offset of the circular buffer to read data from */
-  uint64_t length;      /**< Total length (in bytes) of the circular buffer */
-  uint64_t pad;         /**< Padding to make the struct 32-bytes aligned */
+  uint64_t head_offset;      /**< Offset of the circular buffer to write data to */
+  uint64_t tail_offset;      /**< Offset of the circular buffer to read data from */
+  uint64_t length;           /**< Total length (in bytes) of the circular buffer */
+  uint64_t notify_threshold; /**< Entries to coalesce per notification, set by the consumer */
 } __attribute__((__packed__));
 
 class DeviceSysEmu final : public IDeviceLayer {
@@ -39,6 +39,8 @@ public:
   void waitForEpollEventsMasterMinion(int device, uint64_t& sqBitmap, bool& cqAvailable,
                                       std::chrono::milliseconds timeout = std::chrono::seconds(10)) override;
   bool receiveResponseMasterMinion(int device, std::vector<std::byte>& response) override;
+  size_t receiveResponsesFromCqMasterMinion(int device, int cqIdx,
+                                            std::vector<std::vector<std::byte>>& responses) override;
 
   bool sendCommandServiceProcessor(int device, std::byte* command, size_t commandSize, CmdFlagSP flags) override;
   void setSqThresholdServiceProcessor(int device, uint32_t bytesNeeded) override;
@@ -50,6 +52,7 @@ public:
   DmaInfo getDmaInfo(int device) const override;
   int getDevicesCount() const override;
   int getSubmissionQueuesCount(int device) const override;
+  int getCompletionQueuesCount(int device) const override;
   DeviceState getDeviceStateMasterMinion(int device) const override;
   DeviceState getDeviceStateServiceProcessor(int device) const override;
   size_t getSubmissionQueueSizeMasterMinion(int device) const override;
@@ -71,6 +74,8 @@ public:
   void reinitDeviceInstance(int device, bool masterMinionOnly, std::chrono::milliseconds timeout) override;
   void hintInactivity(int device) override;
   bool checkP2pDmaCompatibility(int deviceA, int deviceB) const override;
+  size_t registerHostMemory(int device, const void* hostPtr, size_t sizeInBytes, bool toDeviceOnly) override;
+  bool canStreamHostMemory(int device) const override;
 
 private:
   struct QueueInfo {
@@ -78,6 +83,7 @@ private:
     size_t size_;
     uint32_t thresholdBytes_;
     CircBuffCb cb_;
+    std::byte* mapped_ = nullptr; // host view of the queue memory, if sysemu could map it
   };
 
   friend struct Checker;
@@ -95,6 +101,11 @@ private:
 
   void checkSysemuLastError() const;
 
+  // access the queue memory at the given offset, directly when it's mapped and through mmio otherwise
+  void mapQueue(QueueInfo& queue);
+  void readQueue(const QueueInfo& queue, size_t offset, size_t size, std::byte* dst) const;
+  void writeQueue(const QueueInfo& queue, size_t offset, size_t size, const std::byte* src) const;
+
   bool sendCommand(QueueInfo& queue, std::byte* command, size_t commandSize, bool& clearEvent);
   bool receiveResponse(QueueInfo& queue, std::vector<std::byte>& response, bool& clearEvent);
 
@@ -134,7 +145,7 @@ private:
 
   std::vector<QueueInfo> submissionQueuesMM_;
   std::vector<QueueInfo> hpSubmissionQueuesMM_;
-  QueueInfo completionQueueMM_;
+  std::vector<QueueInfo> completionQueuesMM_;
 
   QueueInfo submissionQueueSP_;
   QueueInfo completionQueueSP_;
@@ -30,6 +30,8 @@ DmaInfo DeviceSysEmuMulti::getDmaInfo(int device) const {
 
 DeviceSysEmuMulti::DeviceSysEmuMulti(std::vector<emu::SysEmuOptions> options) {
   for (auto& o : options) {
+    // All the devices usually boot the same firmware, load it once
+    o.shareImages = options.size() > 1;
     devices_.emplace_back(std::make_unique<DeviceSysEmu>(o));
   }
 }
@@ -48,6 +50,10 @@ void DeviceSysEmuMulti::waitForEpollEventsMasterMinion(int device, uint64_t& sqB
 bool DeviceSysEmuMulti::receiveResponseMasterMinion(int device, std::vector<std::byte>& response) {
   return getDevice(device).receiveResponseMasterMinion(device, response);
 }
+size_t DeviceSysEmuMulti::receiveResponsesFromCqMasterMinion(int device, int cqIdx,
+                                                             std::vector<std::vector<std::byte>>& responses) {
+  return getDevice(device).receiveResponsesFromCqMasterMinion(device, cqIdx, responses);
+}
 
 bool DeviceSysEmuMulti::sendCommandServiceProcessor(int device, std::byte* command, size_t commandSize,
                                                     CmdFlagSP flags) {
@@ -72,6 +78,9 @@ int DeviceSysEmuMulti::getDevicesCount() const {
 int DeviceSysEmuMulti::getSubmissionQueuesCount(int device) const {
   return getDevice(device).getSubmissionQueuesCount(device);
 }
+int DeviceSysEmuMulti::getCompletionQueuesCount(int device) const {
+  return getDevice(device).getCompletionQueuesCount(device);
+}
 
 DeviceState DeviceSysEmuMulti::getDeviceStateMasterMinion(int device) const {
   return getDevice(device).getDeviceStateMasterMinion(device);
@@ -137,3 +146,10 @@ void DeviceSysEmuMulti::hintInactivity(int device) {
 bool DeviceSysEmuMulti::checkP2pDmaCompatibility(int deviceA, int deviceB) const {
   return getDevice(deviceA).checkP2pDmaCompatibility(deviceA, deviceB);
 }
+size_t DeviceSysEmuMulti::registerHostMemory(int device, const void* hostPtr, size_t sizeInBytes,
+                                             bool toDeviceOnly) {
+  return getDevice(device).registerHostMemory(device, hostPtr, sizeInBytes, toDeviceOnly);
+}
+bool DeviceSysEmuMulti::canStreamHostMemory(int device) const {
+  return getDevice(device).canStreamHostMemory(device);
+}
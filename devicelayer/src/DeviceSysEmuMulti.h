@@ -17,6 +17,8 @@ public:
   void waitForEpollEventsMasterMinion(int device, uint64_t& sqBitmap, bool& cqAvailable,
                                       std::chrono::milliseconds timeout = std::chrono::seconds(10)) override;
   bool receiveResponseMasterMinion(int device, std::vector<std::byte>& response) override;
+  size_t receiveResponsesFromCqMasterMinion(int device, int cqIdx,
+                                            std::vector<std::vector<std::byte>>& responses) override;
 
   bool sendCommandServiceProcessor(int device, std::byte* command, size_t commandSize, CmdFlagSP flags) override;
   void setSqThresholdServiceProcessor(int device, uint32_t bytesNeeded) override;
@@ -27,6 +29,7 @@ public:
   // IDeviceSync
   int getDevicesCount() const override;
   int getSubmissionQueuesCount(int device) const override;
+  int getCompletionQueuesCount(int device) const override;
   DeviceState getDeviceStateMasterMinion(int device) const override;
   DeviceState getDeviceStateServiceProcessor(int device) const override;
   size_t getSubmissionQueueSizeMasterMinion(int device) const override;
@@ -49,6 +52,8 @@ public:
   void reinitDeviceInstance(int device, bool masterMinionOnly, std::chrono::milliseconds timeout) override;
   void hintInactivity(int device) override;
   bool checkP2pDmaCompatibility(int deviceA, int deviceB) const override;
+  size_t registerHostMemory(int device, const void* hostPtr, size_t sizeInBytes, bool toDeviceOnly) override;
+  bool canStreamHostMemory(int device) const override;
 
 private:
   DeviceSysEmu& getDevice(int device);
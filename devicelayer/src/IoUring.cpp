@@ -0,0 +1,146 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) 2025 Ainekko, Co.
+ * SPDX-License-Identifier: Apache-2.0
+ *-------------------------------------------------------------------------*/
+#include "IoUring.h"
+#include "device-layer/IDeviceLayer.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <linux/io_uring.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+using namespace dev;
+using namespace std::string_literals;
+
+namespace {
+int ioUringSetup(unsigned entries, io_uring_params* params) {
+  return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int ioUringEnter(int ringFd, unsigned toSubmit, unsigned minComplete, unsigned flags) {
+  return static_cast<int>(syscall(__NR_io_uring_enter, ringFd, toSubmit, minComplete, flags, nullptr, 0));
+}
+
+void* mapRing(int ringFd, size_t size, off_t offset) {
+  auto ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, offset);
+  if (ptr == MAP_FAILED) {
+    throw Exception("Error mmap of io_uring: '"s + std::strerror(errno) + "'");
+  }
+  return ptr;
+}
+
+template <typename T> T* at(void* base, uint32_t offset) {
+  return reinterpret_cast<T*>(static_cast<std::byte*>(base) + offset);
+}
+} // namespace
+
+IoUring::IoUring(unsigned entries) {
+  io_uring_params params{};
+  ringFd_ = ioUringSetup(entries, &params);
+  if (ringFd_ < 0) {
+    throw Exception("Error creating io_uring: '"s + std::strerror(errno) + "'");
+  }
+  sqRingSize_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cqRingSize_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  sqesSize_ = params.sq_entries * sizeof(io_uring_sqe);
+  try {
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+      sqRingSize_ = cqRingSize_ = std::max(sqRingSize_, cqRingSize_);
+      sqRing_ = cqRing_ = mapRing(ringFd_, sqRingSize_, IORING_OFF_SQ_RING);
+    } else {
+      sqRing_ = mapRing(ringFd_, sqRingSize_, IORING_OFF_SQ_RING);
+      cqRing_ = mapRing(ringFd_, cqRingSize_, IORING_OFF_CQ_RING);
+    }
+    sqes_ = static_cast<io_uring_sqe*>(mapRing(ringFd_, sqesSize_, IORING_OFF_SQES));
+  } catch (...) {
+    release();
+    throw;
+  }
+  sqTail_ = at<unsigned>(sqRing_, params.sq_off.tail);
+  sqArray_ = at<unsigned>(sqRing_, params.sq_off.array);
+  sqMask_ = *at<unsigned>(sqRing_, params.sq_off.ring_mask);
+  sqEntries_ = params.sq_entries;
+  cqHead_ = at<unsigned>(cqRing_, params.cq_off.head);
+  cqTail_ = at<unsigned>(cqRing_, params.cq_off.tail);
+  cqMask_ = *at<unsigned>(cqRing_, params.cq_off.ring_mask);
+  cqes_ = at<io_uring_cqe>(cqRing_, params.cq_off.cqes);
+  // the SQ is always submitted whole, so its entries are used in order
+  for (unsigned i = 0; i < sqEntries_; ++i) {
+    sqArray_[i] = i;
+  }
+  results_.reserve(sqEntries_);
+}
+
+IoUring::~IoUring() {
+  release();
+}
+
+void IoUring::release() {
+  if (sqes_ != nullptr) {
+    munmap(sqes_, sqesSize_);
+  }
+  if (cqRing_ != nullptr && cqRing_ != sqRing_) {
+    munmap(cqRing_, cqRingSize_);
+  }
+  if (sqRing_ != nullptr) {
+    munmap(sqRing_, sqRingSize_);
+  }
+  if (ringFd_ >= 0) {
+    close(ringFd_);
+  }
+  sqes_ = nullptr;
+  cqRing_ = sqRing_ = nullptr;
+  ringFd_ = -1;
+}
+
+void IoUring::queueCommand(int fd, uint32_t cmdOp, const void* payload, size_t size, bool link) {
+  if (queued_ == sqEntries_) {
+    throw Exception("io_uring SQ is full");
+  }
+  // only the kernel moves the SQ head, and all the entries are consumed on each submission
+  auto tail = *sqTail_;
+  auto& sqe = sqes_[tail & sqMask_];
+  std::memset(&sqe, 0, sizeof(sqe));
+  sqe.opcode = IORING_OP_URING_CMD;
+  sqe.fd = fd;
+  sqe.cmd_op = cmdOp;
+  sqe.user_data = queued_;
+  sqe.flags = link ? IOSQE_IO_LINK : 0;
+  // the cmd area of a 64 bytes SQE starts at addr3 and is 16 bytes long
+  if (size > sizeof(sqe) - offsetof(io_uring_sqe, addr3)) {
+    throw Exception("io_uring command payload too big");
+  }
+  std::memcpy(&sqe.addr3, payload, size);
+  __atomic_store_n(sqTail_, tail + 1, __ATOMIC_RELEASE);
+  ++queued_;
+}
+
+const std::vector<int>& IoUring::submitAndWait() {
+  results_.assign(queued_, 0);
+  auto pending = queued_;
+  auto toSubmit = queued_;
+  queued_ = 0;
+  while (pending > 0) {
+    auto res = ioUringEnter(ringFd_, toSubmit, pending, IORING_ENTER_GETEVENTS);
+    if (res < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw Exception("Error submitting io_uring commands: '"s + std::strerror(errno) + "'");
+    }
+    toSubmit -= std::min(toSubmit, static_cast<unsigned>(res));
+    auto head = *cqHead_;
+    auto tail = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+    for (; head != tail; ++head) {
+      const auto& cqe = cqes_[head & cqMask_];
+      results_[cqe.user_data] = cqe.res;
+      --pending;
+    }
+    __atomic_store_n(cqHead_, head, __ATOMIC_RELEASE);
+  }
+  return results_;
+}
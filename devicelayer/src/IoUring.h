@@ -0,0 +1,63 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) 2025 Ainekko, Co.
+ * SPDX-License-Identifier: Apache-2.0
+ *-------------------------------------------------------------------------*/
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace dev {
+
+// Minimal io_uring, only for passthrough commands (IORING_OP_URING_CMD) used synchronously: the commands are queued,
+// then submitted and waited for all together with a single io_uring_enter(). It's not thread safe
+class IoUring {
+public:
+  // throws if the kernel doesn't support io_uring
+  explicit IoUring(unsigned entries);
+  ~IoUring();
+  IoUring(const IoUring&) = delete;
+  IoUring& operator=(const IoUring&) = delete;
+
+  // max commands queued before submitting them
+  unsigned getEntries() const {
+    return sqEntries_;
+  }
+  unsigned getQueued() const {
+    return queued_;
+  }
+
+  // queues a passthrough command of the file, the payload (up to 16 bytes) is copied into the SQE. If link is true,
+  // the next command only runs once this one succeeds, otherwise it completes with -ECANCELED
+  void queueCommand(int fd, uint32_t cmdOp, const void* payload, size_t size, bool link);
+
+  // submits the queued commands and waits for all of them. Returns their results, in the order they were queued
+  const std::vector<int>& submitAndWait();
+
+private:
+  void release();
+
+  int ringFd_ = -1;
+  void* sqRing_ = nullptr;
+  size_t sqRingSize_ = 0;
+  void* cqRing_ = nullptr;
+  size_t cqRingSize_ = 0;
+  io_uring_sqe* sqes_ = nullptr;
+  size_t sqesSize_ = 0;
+
+  unsigned* sqTail_ = nullptr;
+  unsigned* sqArray_ = nullptr;
+  unsigned sqMask_ = 0;
+  unsigned sqEntries_ = 0;
+  unsigned* cqHead_ = nullptr;
+  unsigned* cqTail_ = nullptr;
+  unsigned cqMask_ = 0;
+  io_uring_cqe* cqes_ = nullptr;
+
+  unsigned queued_ = 0;
+  std::vector<int> results_;
+};
+} // namespace dev
@@ -0,0 +1,61 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) 2025 Ainekko, Co.
+ * SPDX-License-Identifier: Apache-2.0
+ *-------------------------------------------------------------------------*/
+#pragma once
+#include "device-layer/IDeviceLayer.h"
+
+#include <array>
+#include <cstdint>
+
+// Layout of the files written by DeviceRecorder and read by DeviceReplay. The structs are written as they are in
+// memory, a recording is only meant to be replayed by a build of the same device layer version on the same host
+// architecture; the header keeps the sizes to detect mismatches.
+//
+// A recording is a Header, Header::numDevices_ DeviceInfo and then the Events till the end of the file, each one an
+// EventHeader followed by EventHeader::size_ bytes of message
+namespace dev::recording {
+
+constexpr std::array<char, 8> kMagic = {'E', 'T', 'D', 'L', 'R', 'E', 'C', '1'};
+constexpr uint32_t kVersion = 1;
+
+struct Header {
+  std::array<char, 8> magic_;
+  uint32_t version_;
+  uint32_t deviceInfoSize_;  ///< sizeof(DeviceInfo) of the recorder
+  uint32_t eventHeaderSize_; ///< sizeof(EventHeader) of the recorder
+  int32_t numDevices_;
+  int32_t dmaAlignment_;
+  uint64_t freeCmaMemory_;
+};
+
+/// \brief results of the synchronous queries of a device, taken once when the recording starts
+struct DeviceInfo {
+  int32_t submissionQueuesCount_;
+  int32_t completionQueuesCount_;
+  uint64_t submissionQueueSizeMasterMinion_;
+  uint64_t submissionQueueSizeServiceProcessor_;
+  DmaInfo dmaInfo_;
+  DeviceConfig config_;
+  uint64_t dramSize_;
+  uint64_t dramBaseAddress_;
+  int32_t activeShiresNum_;
+  uint32_t frequencyMHz_;
+};
+
+enum class EventKind : uint8_t { MmCommand, MmResponse, SpCommand, SpResponse };
+
+struct EventHeader {
+  int64_t timestamp_; ///< nanoseconds since the recording started
+  int32_t device_;
+  uint16_t queue_; ///< SQ index of the commands, CQ index of the responses; 0 for the service processor
+  EventKind kind_;
+  uint8_t reserved_;
+  uint32_t size_;
+};
+
+// all messages start with a cmn_header_t: size, tag_id, msg_id and flags, 16 bits each
+constexpr size_t kHeaderSize = 8;
+constexpr size_t kTagIdOffset = 2;
+
+} // namespace dev::recording
@@ -19,6 +19,12 @@ void SysEmuHostListener::memoryWriteFromHost(uint64_t address, size_t size, cons
   IHostListener::memoryWriteFromHost(address, size, src);
 }
 
+std::byte* SysEmuHostListener::mapHostMemory(uint64_t address, size_t size) {
+  // sysemu runs in this process, so the host addresses of the DMAs are plain pointers
+  DV_VLOG(HIGH) << "Device mapped host memory: addr: " << std::hex << address << ", size: " << size;
+  return reinterpret_cast<std::byte*>(address);
+}
+
 std::future<void> SysEmuHostListener::getPcieReadyFuture() {
   return pcieReady_.get_future();
 }
@@ -0,0 +1,104 @@
+//******************************************************************************
+// Copyright (c) 2025 Ainekko, Co.
+// SPDX-License-Identifier: Apache-2.0
+//------------------------------------------------------------------------------
+
+#include <device-layer/DeviceLayerMock.h>
+#include <device-layer/IDeviceLayer.h>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <hostUtils/logging/Logging.h>
+
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+
+using namespace dev;
+using namespace testing;
+
+namespace {
+// a message with a cmn_header_t: size, tag_id, msg_id and flags
+std::vector<std::byte> makeMessage(uint16_t tagId, uint16_t msgId) {
+  std::vector<std::byte> message(16);
+  uint16_t header[] = {static_cast<uint16_t>(message.size()), tagId, msgId, 0};
+  std::memcpy(message.data(), header, sizeof(header));
+  return message;
+}
+
+uint16_t getTagId(const std::vector<std::byte>& message) {
+  uint16_t tagId;
+  std::memcpy(&tagId, message.data() + 2, sizeof(tagId));
+  return tagId;
+}
+
+class Recording : public Test {
+public:
+  void SetUp() override {
+    path_ = "device_layer_recording_" + std::to_string(::getpid()) + ".bin";
+  }
+  void TearDown() override {
+    std::remove(path_.c_str());
+  }
+
+  // records two commands, the first one with a response received after the second was sent
+  void record() {
+    auto mock = std::make_unique<NiceMock<DeviceLayerMock>>();
+    ON_CALL(*mock, getDevicesCount).WillByDefault(Return(1));
+    ON_CALL(*mock, getSubmissionQueuesCount).WillByDefault(Return(2));
+    ON_CALL(*mock, getDmaInfo).WillByDefault(Return(DmaInfo{4096, 4}));
+    ON_CALL(*mock, sendCommandMasterMinion).WillByDefault(Return(true));
+    EXPECT_CALL(*mock, receiveResponseMasterMinion)
+      .WillOnce(DoAll(SetArgReferee<1>(makeMessage(7, 100)), Return(true)))
+      .WillRepeatedly(Return(false));
+
+    auto recorder = IDeviceLayer::createRecordingDeviceLayer(std::move(mock), path_);
+    auto first = makeMessage(7, 1);
+    auto second = makeMessage(8, 2);
+    ASSERT_TRUE(recorder->sendCommandMasterMinion(0, 0, first.data(), first.size(), {}));
+    ASSERT_TRUE(recorder->sendCommandMasterMinion(0, 1, second.data(), second.size(), {}));
+    std::vector<std::byte> response;
+    ASSERT_TRUE(recorder->receiveResponseMasterMinion(0, response));
+    ASSERT_FALSE(recorder->receiveResponseMasterMinion(0, response));
+  }
+
+  std::string path_;
+};
+} // namespace
+
+TEST_F(Recording, replaysTheSyncQueries) {
+  record();
+  auto replay = IDeviceLayer::createReplayDeviceLayer(path_, false);
+  EXPECT_EQ(replay->getDevicesCount(), 1);
+  EXPECT_EQ(replay->getSubmissionQueuesCount(0), 2);
+  EXPECT_EQ(replay->getDmaInfo(0).maxElementSize_, 4096);
+  EXPECT_EQ(replay->getDmaInfo(0).maxElementCount_, 4);
+  EXPECT_THROW(replay->getDmaInfo(1), Exception);
+}
+
+TEST_F(Recording, replaysResponsesAfterTheirCommands) {
+  record();
+  auto replay = IDeviceLayer::createReplayDeviceLayer(path_, false);
+  std::vector<std::byte> response;
+  EXPECT_FALSE(replay->waitForCqEventMasterMinion(0, 0, std::chrono::milliseconds(1)));
+
+  // the replayed tag ids are not the recorded ones
+  auto first = makeMessage(20, 1);
+  auto second = makeMessage(21, 2);
+  ASSERT_TRUE(replay->sendCommandMasterMinion(0, 0, first.data(), first.size(), {}));
+  EXPECT_FALSE(replay->receiveResponseMasterMinion(0, response));
+  ASSERT_TRUE(replay->sendCommandMasterMinion(0, 1, second.data(), second.size(), {}));
+  EXPECT_TRUE(replay->waitForCqEventMasterMinion(0, 0, std::chrono::milliseconds(1)));
+  ASSERT_TRUE(replay->receiveResponseMasterMinion(0, response));
+  EXPECT_EQ(getTagId(response), 20);
+  EXPECT_FALSE(replay->receiveResponseMasterMinion(0, response));
+}
+
+TEST(RecordingFormat, rejectsOtherFiles) {
+  EXPECT_THROW(IDeviceLayer::createReplayDeviceLayer("/nonexistent/recording.bin"), Exception);
+}
+
+int main(int argc, char** argv) {
+  logging::LoggerDefault loggerDefault_;
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
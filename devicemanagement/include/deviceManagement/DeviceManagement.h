@@ -12,7 +12,9 @@
 #include "deviceManagement/dm.h"
 
 #include <atomic>
+#include <cerrno>
 #include <cstdint>
+#include <future>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -151,6 +153,26 @@ struct dm_evt {
   char payload[1];
 };
 
+/// @brief One command of a serviceRequests() batch
+struct dm_request {
+  uint32_t cmd_code;
+  const char* input_buff = nullptr;
+  uint32_t input_size = 0;
+  char* output_buff = nullptr;
+  uint32_t output_size = 0;
+  uint64_t dev_latency = 0; ///< out: microseconds spent on the device side
+  int status = -EAGAIN;     ///< out: zero if the command succeeded
+};
+
+/// @brief Outcome of a service request on one device, see serviceRequestAsync()
+struct dm_device_result {
+  uint32_t device_node = 0;
+  int status = -EAGAIN;      ///< zero if the command succeeded
+  uint32_t host_latency = 0; ///< miliseconds spent on the host side
+  uint64_t dev_latency = 0;  ///< microseconds spent on the device side
+  std::vector<char> output;  ///< data received from the device
+};
+
 typedef std::unordered_map<std::string, device_mgmt_api::DM_CMD>::const_iterator itCmd;
 
 /// @class DeviceManagement
@@ -188,6 +210,67 @@ public:
                      char* output_buff, const uint32_t output_size, uint32_t* host_latency, uint64_t* dev_latency,
                      uint32_t timeout);
 
+  /// @brief Send a batch of service requests to device and wait for all the
+  /// responses
+  ///
+  /// All the commands are queued back to back before waiting, so the batch
+  /// costs one round-trip instead of one per command. Firmware update, root
+  /// certificate and reset commands are not allowed in a batch.
+  ///
+  /// @param[in] device_node  device index to use
+  /// @param[inout] requests  commands to service; the status, dev_latency and
+  /// output_buff of each one are filled in
+  /// @param[inout] host_latency  Total time in miliseconds spent on the
+  /// host side servicing the batch
+  /// @param[in] timeout  Time to wait for the whole batch to complete
+  ///
+  /// @return Zero if all the requests were succesfull; otherwise the status
+  /// of the batch as a whole, see each request for its own
+  int serviceRequests(const uint32_t device_node, std::vector<dm_request>& requests, uint32_t* host_latency,
+                      uint32_t timeout);
+
+  /// @brief Send service request to device without waiting for the response
+  ///
+  /// The request is serviced as by serviceRequest() on a thread of its own,
+  /// so requests to different devices, each with its own SP SQ, run
+  /// concurrently. Requests to the same device are still serialized.
+  ///
+  /// @param[in] device_node  device index to use
+  /// @param[in] cmd_code  Command code to service
+  /// @param[in] input  data to send to device accompanying the command, e.g.
+  /// the null terminated image path of DM_CMD_SET_FIRMWARE_UPDATE
+  /// @param[in] output_size  size in bytes of the data to receive from the
+  /// device
+  /// @param[in] timeout  Time to wait for the request to complete, from the
+  /// call
+  ///
+  /// @return Future result of the request; a device layer exception is
+  /// reported as an -EIO status
+  std::future<dm_device_result> serviceRequestAsync(const uint32_t device_node, uint32_t cmd_code,
+                                                    std::vector<char> input, const uint32_t output_size,
+                                                    uint32_t timeout);
+
+  /// @brief Send the same service request to several devices concurrently and
+  /// wait for all the responses
+  ///
+  /// E.g. a firmware rollout to all the cards takes as long as the slowest
+  /// card instead of the sum of all of them.
+  ///
+  /// @param[in] device_nodes  device indexes to use
+  /// @param[in] cmd_code  Command code to service
+  /// @param[in] input_buff  pointer to data to send to each device
+  /// accompanying the command to service
+  /// @param[in] input_size  size in bytes of the input_buff data
+  /// @param[in] output_size  size in bytes of the data to receive from each
+  /// device
+  /// @param[in] timeout  Time to wait for the request to complete on each
+  /// device; a slow device does not shorten the time left to the others
+  ///
+  /// @return Result of the request on each device, in device_nodes order
+  std::vector<dm_device_result> serviceRequestMulti(const std::vector<uint32_t>& device_nodes, uint32_t cmd_code,
+                                                    const char* input_buff, const uint32_t input_size,
+                                                    const uint32_t output_size, uint32_t timeout);
+
   /// @brief Get Service Process's trace buffer
   ///
   /// @param[in] device_node  device index to use
@@ -198,6 +281,19 @@ public:
   int getTraceBufferServiceProcessor(const uint32_t device_node, TraceBufferType buf_type,
                                      std::vector<std::byte>& response);
 
+  /// @brief Read part of Service Process's trace buffer, e.g. only the data
+  /// added since the last read
+  ///
+  /// @param[in] device_node  device index to use
+  /// @param[in] buf_type  trace buffer to read
+  /// @param[in] offset  offset in bytes from the start of the trace buffer
+  /// @param[inout] response  filled with up to response.size() bytes of the
+  /// trace buffer, then resized to the bytes read
+  ///
+  /// @return Zero if the call was succesfull.
+  int readTraceBufferServiceProcessor(const uint32_t device_node, TraceBufferType buf_type, uint32_t offset,
+                                      std::vector<std::byte>& response);
+
   /// @brief Gets the MDI event type
   ///
   /// @param[in] device_node  device index to use
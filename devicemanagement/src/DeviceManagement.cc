@@ -369,6 +369,18 @@ int DeviceManagement::getTraceBufferServiceProcessor(const uint32_t device_node,
   return 0;
 }
 
+int DeviceManagement::readTraceBufferServiceProcessor(const uint32_t device_node, TraceBufferType trace_type,
+                                                      uint32_t offset, std::vector<std::byte>& response) {
+  if (!isValidDeviceNode(device_node)) {
+    return -EINVAL;
+  }
+
+  auto count =
+    devLayer_->readTraceBufferServiceProcessor(device_node, trace_type, offset, response.data(), response.size());
+  response.resize(count);
+  return 0;
+}
+
 bool DeviceManagement::isValidActivePowerManagement(const char* input_buff) {
   for (auto it = activePowerManagementTable.begin(); it != activePowerManagementTable.end(); ++it) {
     if (it->second == *input_buff) {
@@ -613,6 +625,164 @@ int DeviceManagement::serviceRequest(const uint32_t device_node, uint32_t cmd_co
   return -EAGAIN;
 }
 
+int DeviceManagement::serviceRequests(const uint32_t device_node, std::vector<dm_request>& requests,
+                                      uint32_t* host_latency, uint32_t timeout) {
+
+  auto start = std::chrono::steady_clock::now();
+  auto end = start + std::chrono::milliseconds(timeout);
+
+  if (!isValidDeviceNode(device_node) || !host_latency || !devLayer_ || requests.empty()) {
+    return -EINVAL;
+  }
+
+  for (auto& req : requests) {
+    switch (req.cmd_code) {
+    case device_mgmt_api::DM_CMD::DM_CMD_SET_FIRMWARE_UPDATE:
+    case device_mgmt_api::DM_CMD::DM_CMD_SET_SP_BOOT_ROOT_CERT:
+    case device_mgmt_api::DM_CMD::DM_CMD_SET_SW_BOOT_ROOT_CERT:
+    case device_mgmt_api::DM_CMD::DM_CMD_MM_RESET:
+    case device_mgmt_api::DM_CMD::DM_CMD_RESET_ETSOC:
+      return -EINVAL;
+    default:
+      break;
+    }
+    auto cmd = isValidCommand(req.cmd_code);
+    if (cmd == commandCodeTable.end()) {
+      return -EINVAL;
+    }
+    if (isSetCommand(cmd) && (!req.input_buff || !req.input_size)) {
+      return -EINVAL;
+    }
+    if (isGetCommand(cmd) && (!req.output_buff || !req.output_size)) {
+      return -EINVAL;
+    }
+    if (req.input_size && !req.input_buff) {
+      return -EINVAL;
+    }
+    if (!isInputBufferValid(req.cmd_code, req.input_buff)) {
+      return -EINVAL;
+    }
+    req.status = -EAGAIN;
+  }
+
+  auto lockable = getDeviceInstance(device_node);
+  if (!lockable->sqGuard.try_lock_for(end - std::chrono::steady_clock::now())) {
+    return -EAGAIN;
+  }
+  const std::lock_guard<std::timed_mutex> lock(lockable->sqGuard, std::adopt_lock_t());
+
+  std::vector<std::future<std::vector<std::byte>>> futures(requests.size());
+  size_t oldest = 0;
+
+  // Waits for the response of the oldest command still pending, returns false on timeout
+  auto collect = [&]() {
+    auto& future = futures[oldest];
+    if (future.wait_for(end - std::chrono::steady_clock::now()) != std::future_status::ready) {
+      return false;
+    }
+    auto message = future.get();
+    auto rCB = reinterpret_cast<dm_rsp*>(message.data());
+    auto& req = requests[oldest++];
+    DV_DLOG(DEBUG) << "Read rsp to cmd: " << rCB->info.rsp_hdr.msg_id << " with header size: " << rCB->info.rsp_hdr.size
+                   << std::endl;
+    if (req.output_buff && req.output_size) {
+      memcpy(req.output_buff, rCB->payload, req.output_size);
+    }
+    if (rCB->info.rsp_hdr_ext.status) {
+      DV_LOG(INFO) << "Received incorrect rsp status: " << rCB->info.rsp_hdr_ext.status << std::endl;
+      req.status = -EIO;
+    } else {
+      req.dev_latency = rCB->info.rsp_hdr_ext.device_latency_usec;
+      req.status = 0;
+    }
+    return true;
+  };
+
+  for (size_t i = 0; i < requests.size(); i++) {
+    auto& req = requests[i];
+    device_mgmt_api::dev_mgmt_cmd_header_t info{};
+    info.cmd_hdr.tag_id = tag_id_++;
+    info.cmd_hdr.msg_id = req.cmd_code;
+    info.cmd_hdr.size = sizeof(info) + req.input_size;
+
+    auto buffer = std::make_unique<std::byte[]>(info.cmd_hdr.size);
+    memcpy(buffer.get(), &info, sizeof(info));
+    if (req.input_size) {
+      memcpy(buffer.get() + sizeof(info), req.input_buff, req.input_size);
+    }
+    futures[i] = lockable->getRespReceiveFuture(info.cmd_hdr.tag_id);
+
+    // When the SQ is full, make room by waiting for the responses of the commands already sent
+    while (!devLayer_->sendCommandServiceProcessor(lockable->idx, buffer.get(), info.cmd_hdr.size, CmdFlagSP())) {
+      if (oldest == i) {
+        return -EIO;
+      }
+      if (!collect()) {
+        return -EAGAIN;
+      }
+    }
+    DV_DLOG(DEBUG) << "Sent cmd: " << info.cmd_hdr.msg_id << " with header size: " << info.cmd_hdr.size << std::endl;
+  }
+
+  while (oldest < requests.size()) {
+    if (!collect()) {
+      return -EAGAIN;
+    }
+  }
+
+  *host_latency =
+    std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+  for (auto& req : requests) {
+    if (req.status) {
+      return -EIO;
+    }
+  }
+  return 0;
+}
+
+std::future<dm_device_result> DeviceManagement::serviceRequestAsync(const uint32_t device_node, uint32_t cmd_code,
+                                                                    std::vector<char> input,
+                                                                    const uint32_t output_size, uint32_t timeout) {
+  return std::async(std::launch::async, [this, device_node, cmd_code, input = std::move(input), output_size, timeout]() {
+    dm_device_result result;
+    result.device_node = device_node;
+    result.output.resize(output_size);
+    try {
+      result.status = serviceRequest(device_node, cmd_code, input.empty() ? nullptr : input.data(), input.size(),
+                                     output_size ? result.output.data() : nullptr, output_size, &result.host_latency,
+                                     &result.dev_latency, timeout);
+    } catch (const std::exception& ex) {
+      DV_LOG(INFO) << "Service request on device " << device_node << " failed: " << ex.what();
+      result.status = -EIO;
+    }
+    return result;
+  });
+}
+
+std::vector<dm_device_result> DeviceManagement::serviceRequestMulti(const std::vector<uint32_t>& device_nodes,
+                                                                    uint32_t cmd_code, const char* input_buff,
+                                                                    const uint32_t input_size,
+                                                                    const uint32_t output_size, uint32_t timeout) {
+  std::vector<char> input;
+  if (input_buff && input_size) {
+    input.assign(input_buff, input_buff + input_size);
+  }
+
+  std::vector<std::future<dm_device_result>> futures;
+  futures.reserve(device_nodes.size());
+  for (auto device_node : device_nodes) {
+    futures.push_back(serviceRequestAsync(device_node, cmd_code, input, output_size, timeout));
+  }
+
+  std::vector<dm_device_result> results;
+  results.reserve(futures.size());
+  for (auto& future : futures) {
+    results.push_back(future.get());
+  }
+  return results;
+}
+
 extern "C" DeviceManagement& getInstance(IDeviceLayer* devLayer) {
   return DeviceManagement::getInstance(devLayer);
 }
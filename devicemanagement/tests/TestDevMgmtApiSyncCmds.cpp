@@ -20,6 +20,7 @@
 #include <glog/logging.h>
 #include <iostream>
 #include <memory>
+#include <numeric>
 #include <regex>
 #include <string>
 #include <unistd.h>
@@ -1833,6 +1834,70 @@ void TestDevMgmtApiSyncCmds::getModuleCurrentTemperature(bool singleDevice) {
   }
 }
 
+void TestDevMgmtApiSyncCmds::getModuleTelemetryBatch(bool singleDevice) {
+  getDM_t dmi = getInstance();
+  ASSERT_TRUE(dmi);
+  DeviceManagement& dm = (*dmi)(devLayer_.get());
+  auto end = Clock::now() + std::chrono::milliseconds(FLAGS_exec_timeout_ms);
+
+  auto deviceCount = singleDevice ? 1 : dm.getDevicesCount();
+  for (int deviceIdx = 0; deviceIdx < deviceCount; deviceIdx++) {
+    device_mgmt_api::module_power_t power = {0};
+    device_mgmt_api::current_temperature_t cur_temp = {0};
+    device_mgmt_api::asic_frequencies_t frequencies = {0};
+    device_mgmt_api::module_uptime_t uptime = {0};
+    auto hst_latency = std::make_unique<uint32_t>();
+
+    std::vector<device_management::dm_request> requests(4);
+    requests[0].cmd_code = device_mgmt_api::DM_CMD::DM_CMD_GET_MODULE_POWER;
+    requests[0].output_buff = reinterpret_cast<char*>(&power);
+    requests[0].output_size = sizeof(power);
+    requests[1].cmd_code = device_mgmt_api::DM_CMD::DM_CMD_GET_MODULE_CURRENT_TEMPERATURE;
+    requests[1].output_buff = reinterpret_cast<char*>(&cur_temp);
+    requests[1].output_size = sizeof(cur_temp);
+    requests[2].cmd_code = device_mgmt_api::DM_CMD::DM_CMD_GET_ASIC_FREQUENCIES;
+    requests[2].output_buff = reinterpret_cast<char*>(&frequencies);
+    requests[2].output_size = sizeof(frequencies);
+    requests[3].cmd_code = device_mgmt_api::DM_CMD::DM_CMD_GET_MODULE_UPTIME;
+    requests[3].output_buff = reinterpret_cast<char*>(&uptime);
+    requests[3].output_size = sizeof(uptime);
+
+    ASSERT_EQ(dm.serviceRequests(deviceIdx, requests, hst_latency.get(), DURATION2MS(end - Clock::now())),
+              device_mgmt_api::DM_STATUS_SUCCESS);
+    for (auto& req : requests) {
+      EXPECT_EQ(req.status, device_mgmt_api::DM_STATUS_SUCCESS);
+    }
+    DV_LOG(INFO) << "Service Requests Completed for Device: " << deviceIdx << " in " << *hst_latency << " ms";
+
+    // Skip validation if loopback driver or SysEMU
+    if (!targetInList({Target::Loopback, Target::SysEMU})) {
+      EXPECT_NE(power.power, 0);
+      EXPECT_NE(cur_temp.pmic_sys, 0);
+    }
+  }
+}
+
+void TestDevMgmtApiSyncCmds::getModuleUptimeMultiDevice() {
+  getDM_t dmi = getInstance();
+  ASSERT_TRUE(dmi);
+  DeviceManagement& dm = (*dmi)(devLayer_.get());
+  auto end = Clock::now() + std::chrono::milliseconds(FLAGS_exec_timeout_ms);
+
+  std::vector<uint32_t> devices(dm.getDevicesCount());
+  std::iota(devices.begin(), devices.end(), 0);
+
+  auto results = dm.serviceRequestMulti(devices, device_mgmt_api::DM_CMD::DM_CMD_GET_MODULE_UPTIME, nullptr, 0,
+                                        sizeof(device_mgmt_api::module_uptime_t), DURATION2MS(end - Clock::now()));
+  ASSERT_EQ(results.size(), devices.size());
+  for (size_t i = 0; i < results.size(); i++) {
+    EXPECT_EQ(results[i].device_node, devices[i]);
+    EXPECT_EQ(results[i].status, device_mgmt_api::DM_STATUS_SUCCESS);
+    ASSERT_EQ(results[i].output.size(), sizeof(device_mgmt_api::module_uptime_t));
+    DV_LOG(INFO) << "Service Request Completed for Device: " << results[i].device_node << " in "
+                 << results[i].host_latency << " ms";
+  }
+}
+
 void TestDevMgmtApiSyncCmds::getModuleMaxTemperature(bool singleDevice) {
   getDM_t dmi = getInstance();
   ASSERT_TRUE(dmi);
@@ -111,6 +111,8 @@ protected:
   void getModuleVoltage(bool singleDevice);
   void setAndGetModuleVoltage(bool singleDevice);
   void getModuleCurrentTemperature(bool singleDevice);
+  void getModuleTelemetryBatch(bool singleDevice);
+  void getModuleUptimeMultiDevice();
   void getModuleResidencyPowerState(bool singleDevice);
   void setModuleActivePowerManagement(bool singleDevice);
   void setThrottlePowerStatus(bool singleDevice);
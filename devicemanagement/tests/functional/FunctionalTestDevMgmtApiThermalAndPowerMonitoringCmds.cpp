@@ -69,6 +69,14 @@ TEST_F(FunctionalTestDevMgmtApiThermalAndPowerMonitoringCmds, getModuleCurrentTe
   getModuleCurrentTemperature(false /* Multiple devices */);
 }
 
+TEST_F(FunctionalTestDevMgmtApiThermalAndPowerMonitoringCmds, getModuleTelemetryBatch) {
+  getModuleTelemetryBatch(false /* Multiple devices */);
+}
+
+TEST_F(FunctionalTestDevMgmtApiThermalAndPowerMonitoringCmds, getModuleUptimeMultiDevice) {
+  getModuleUptimeMultiDevice();
+}
+
 TEST_F(FunctionalTestDevMgmtApiThermalAndPowerMonitoringCmds, getModuleResidencyPowerState) {
   getModuleResidencyPowerState(false /* Multiple devices */);
 }
@@ -169,6 +169,7 @@ class RuntimeConan(ConanFile):
         self.requires("deviceApi/2.1.0")
         self.requires("deviceLayer/4.0.0")
         self.requires("et-host-utils/0.4.0")
+        self.requires("esperantoTrace/2.1.0")
 
         self.requires("cereal/1.3.2")
         self.requires("elfio/3.8")
@@ -0,0 +1,117 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) 2025 Ainekko, Co.
+ * SPDX-License-Identifier: Apache-2.0
+ *-------------------------------------------------------------------------*/
+#pragma once
+
+#include "IRuntime.h"
+#include "Types.h"
+#include <runtime/IRuntimeExport.h>
+
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/// \defgroup runtime_autotuner Autotuner API
+///
+/// The autotuner picks, for each problem shape, the fastest of a set of candidate kernel launches (kernel variants,
+/// shire counts, barrier modes...). The first time a shape is seen the candidates are benchmarked on the device, timed
+/// with the device cycles of their launches (see \ref rt::IRuntime::getEventTiming), and the best one is stored in a
+/// database on disk, so later launches of that shape, in this or later processes, go straight to it.
+///
+/// @{
+namespace rt {
+
+/// \brief One of the ways of running an operation given to \ref Autotuner::launch
+struct ETRT_API TuningCandidate {
+  /// identifies the candidate in the tuning database, it has to be unique among the candidates of an operation and
+  /// must not contain whitespaces
+  std::string name_;
+  /// kernel to launch, previously loaded with \ref IRuntime::loadCode in the device the operation runs on
+  KernelId kernel_;
+  /// kernel arguments
+  std::vector<std::byte> args_;
+  /// sets the launch options of the candidate, ie. its shire count or barrier; may be empty to use the defaults
+  std::function<void(KernelLaunchOptions&)> setOptions_;
+};
+
+/// \brief Launches operations with the best of their candidates for each shape, benchmarking them the first time a
+/// shape is seen. The benchmarks run in an internal stream of the device, after the work previously submitted to the
+/// stream the operation runs on (the call waits for it), so they are not disturbed by other work of the caller.
+///
+/// Candidates are launched several times while being benchmarked, hence they must produce the same results when run
+/// again with the same arguments (ie. not accumulate into their outputs). Candidates failing in the device are
+/// discarded. An Autotuner is not thread safe, and several processes should not tune into the same database at once.
+class ETRT_API Autotuner {
+public:
+  /// \brief Default number of timed launches of each candidate, after a warm up launch
+  static constexpr int kDefaultIterations = 3;
+
+  /// \brief Creates an autotuner, loading the tunings found in the database.
+  ///
+  /// @param[in] runtime the runtime used to launch the candidates, it must outlive the autotuner
+  /// @param[in] databasePath file keeping the tunings across processes, created if it doesn't exist. If empty, the
+  /// tunings are only kept in memory
+  /// @param[in] iterations number of timed launches of each candidate; the fastest of them is its score
+  ///
+  explicit Autotuner(IRuntime& runtime, std::string databasePath = {}, int iterations = kDefaultIterations);
+
+  /// \brief Destroys the internal benchmark streams
+  ~Autotuner();
+
+  Autotuner(const Autotuner&) = delete;
+  Autotuner& operator=(const Autotuner&) = delete;
+
+  /// \brief Launches the operation into the stream with its best candidate for the given shape, benchmarking the
+  /// candidates first if the shape was not tuned yet (or its tuned candidate is not among the given ones). Throws an
+  /// \ref Exception if there are no candidates or all of them fail.
+  ///
+  /// @param[in] device the device the stream belongs to and where the candidate kernels are loaded
+  /// @param[in] stream the stream where the chosen candidate is launched
+  /// @param[in] operation name of the operation, without whitespaces
+  /// @param[in] shape the problem size, ie. the dimensions of the operation tensors
+  /// @param[in] candidates the possible launches of the operation
+  ///
+  /// @returns the event of the kernel launch
+  ///
+  EventId launch(DeviceId device, StreamId stream, const std::string& operation, const std::vector<size_t>& shape,
+                 const std::vector<TuningCandidate>& candidates);
+
+  /// \brief Benchmarks the candidates of the operation for the given shape, if it was not tuned yet, without
+  /// launching it. Returns the index of the best candidate.
+  size_t tune(DeviceId device, StreamId stream, const std::string& operation, const std::vector<size_t>& shape,
+              const std::vector<TuningCandidate>& candidates);
+
+  /// \brief Returns the name of the candidate tuned for the operation and shape, if any
+  std::optional<std::string> getTuned(const std::string& operation, const std::vector<size_t>& shape) const;
+
+  /// \brief Forgets all the tunings, also removing them from the database
+  void clear();
+
+private:
+  struct Tuning {
+    std::string candidate_;
+    uint64_t cycles_;
+  };
+
+  static std::string getKey(const std::string& operation, const std::vector<size_t>& shape);
+  EventId launchCandidate(StreamId stream, const TuningCandidate& candidate);
+  // fastest execution cycles of the candidate, std::nullopt if it failed
+  std::optional<uint64_t> benchmark(StreamId stream, const TuningCandidate& candidate);
+  StreamId getBenchmarkStream(DeviceId device);
+  void load();
+  void save() const;
+
+  IRuntime& runtime_;
+  std::string databasePath_;
+  int iterations_;
+  std::unordered_map<std::string, Tuning> tunings_;
+  std::unordered_map<DeviceId, StreamId> benchmarkStreams_;
+};
+
+} // namespace rt
+  /// @}
+  // End of runtime_autotuner
@@ -0,0 +1,105 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) 2025 Ainekko, Co.
+ * SPDX-License-Identifier: Apache-2.0
+ *-------------------------------------------------------------------------*/
+#pragma once
+
+#include "runtime/IProfileEvent.h"
+#include "runtime/IProfiler.h"
+#include "runtime/Types.h"
+#include <runtime/IRuntimeExport.h>
+
+#include <cstddef>
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+/// \defgroup runtime_trace_exporter_api Runtime Trace Exporter API
+///
+/// Merges the host profiling events gathered through \ref rt::IProfiler and the device firmware trace buffers in a
+/// single timeline, written in Chrome trace event format (which can be opened with Perfetto UI or chrome://tracing).
+/// @{
+namespace rt::profiling {
+
+/// \brief Relation between the device cycle counter and the host steady clock
+struct ClockCalibration {
+  ProfileEvent::TimePoint hostTime_; ///< host time at which the device cycle counter was deviceCycle_
+  uint64_t deviceCycle_ = 0;
+  uint32_t frequency_ = 0; ///< device cycle counter frequency in Mhz
+};
+
+/// \brief Device firmware trace buffer kinds which can be merged in the timeline
+enum class DeviceTraceType { MasterMinion, ComputeMinion };
+
+/// \brief Builds a single Chrome trace from host profile events and device trace buffers. Host events are placed in
+/// the host process with a track per thread; each device gets its own process with a track for the commands executed
+/// by the device (taken from the host responses timestamps and the Master Minion trace) and a track per shire (taken
+/// from the Compute Minion trace), where the kernel execution spans of each shire are drawn.
+///
+/// Device timestamps are converted to host time with the device \ref ClockCalibration. If not given explicitly, it is
+/// derived from the host events: the frequency from the device properties event and the offset from the responses,
+/// taking the one received soonest after its command completed on the device.
+///
+class ETRT_API ChromeTraceExporter {
+public:
+  /// \brief Adds the events of a trace recorded by \ref rt::IProfiler. Reads till the end of the stream.
+  ///
+  /// @param[in] input stream with the trace, as written by the profiler
+  /// @param[in] type format the trace was written with
+  ///
+  void addHostEvents(std::istream& input, IProfiler::OutputType type);
+
+  /// \brief Adds a single host event.
+  ///
+  void addHostEvent(const ProfileEvent& event);
+
+  /// \brief Adds a device firmware trace buffer, as returned by dev::IDeviceLayer::getTraceBufferServiceProcessor.
+  ///
+  /// @param[in] device the trace buffer belongs to
+  /// @param[in] type of the trace buffer
+  /// @param[in] buffer contents of the trace buffer, starting with its standard header
+  ///
+  void addDeviceTrace(DeviceId device, DeviceTraceType type, std::vector<std::byte> buffer);
+
+  /// \brief Adds an ELF image executed by a device (firmware or kernel), to format the deferred strings of its
+  /// traces. These only hold the device address of their format string and the raw arguments, the format and the
+  /// strings given as arguments are read from the image LOAD segments. Deferred strings which can't be resolved are
+  /// written with the address of their format.
+  ///
+  /// @param[in] device the image is executed by
+  /// @param[in] elf stream with the ELF image
+  /// @param[in] loadBias difference between the address the image was loaded at and its link address, for relocated
+  /// kernels
+  ///
+  void addDeviceImage(DeviceId device, std::istream& elf, uint64_t loadBias = 0);
+
+  /// \brief Sets the clock calibration of a device, instead of deriving it from the host events.
+  ///
+  void setClockCalibration(DeviceId device, const ClockCalibration& calibration);
+
+  /// \brief Returns the clock calibration used for given device, if any could be given or derived.
+  ///
+  std::optional<ClockCalibration> getClockCalibration(DeviceId device) const;
+
+  /// \brief Writes the merged trace in Chrome trace event JSON format.
+  ///
+  void write(std::ostream& output) const;
+
+private:
+  struct ImageSegment {
+    uint64_t address_;
+    std::vector<char> data_;
+  };
+  std::vector<ProfileEvent> hostEvents_;
+  std::unordered_map<DeviceId, std::vector<std::vector<std::byte>>> mmTraces_;
+  std::unordered_map<DeviceId, std::vector<std::vector<std::byte>>> cmTraces_;
+  std::unordered_map<DeviceId, ClockCalibration> calibrations_;
+  std::unordered_map<DeviceId, std::vector<ImageSegment>> images_;
+};
+
+} // namespace rt::profiling
+
+/// @}
+// End of runtime_trace_exporter_api
@@ -0,0 +1,168 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) 2025 Ainekko, Co.
+ * SPDX-License-Identifier: Apache-2.0
+ *-------------------------------------------------------------------------*/
+#pragma once
+
+#include "IRuntime.h"
+#include "Types.h"
+#include <runtime/IRuntimeExport.h>
+
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/// \defgroup runtime_collectives Collectives API
+///
+/// The collectives API builds broadcast, all-gather and all-reduce operations across a group of devices on top of the
+/// P2P memcpys of the runtime API (see \ref rt::IRuntime::memcpyDeviceToDevice). Data is split in chunks which are
+/// pipelined through the devices, so the transfers of different chunks (and their reductions) overlap.
+///
+/// @{
+namespace rt {
+
+/// \brief Device side reduction used by \ref Communicator::allReduce. The kernel is launched each time a chunk
+/// arrives to a device, to reduce it into the local buffer (dst = dst op src).
+struct ETRT_API ReduceOp {
+  /// kernel doing the reduction on each device of the communicator, previously loaded with \ref IRuntime::loadCode
+  std::unordered_map<DeviceId, KernelId> kernels_;
+  /// returns the kernel arguments which make the kernel reduce size bytes from src into dst
+  std::function<std::vector<std::byte>(std::byte* dst, const std::byte* src, size_t size)> makeArgs_;
+  /// launch options of the reduction kernels; the barrier is always enabled so they run after the chunk arrival
+  KernelLaunchOptions options_;
+};
+
+/// \brief How the devices of a \ref Communicator are connected, see \ref Communicator::getTopology
+enum class CollectiveTopology {
+  Ring, ///< each device sends to the next one, closing a cycle of P2P capable links through all the devices
+  Tree  ///< there is no such cycle, data goes through a spanning tree of the P2P capable links
+};
+
+/// \brief Group of devices running collective operations. The communicator owns one stream per device, where it
+/// queues the memcpys and reductions of the collectives; these start once the work previously submitted to those
+/// streams is done (the call waits for it). Dependencies between devices are resolved in the host because stream waits
+/// can't span devices (see \ref IRuntime::streamWaitEvent), so the calls return once all the commands are submitted,
+/// not when they complete. A Communicator is not thread safe.
+///
+/// Buffers (one per device, in the order the devices were given) must be allocated with \ref IRuntime::mallocDevice
+/// and must not be used by other work till the returned events complete.
+class ETRT_API Communicator {
+public:
+  /// \brief Default maximum size of the chunks the collectives data is split in
+  static constexpr size_t kDefaultChunkSize = 1UL << 20;
+
+  /// \brief Creates a communicator over the given devices, picking the topology from their P2P capabilities (see
+  /// \ref IRuntime::isP2PEnabled). Throws an \ref Exception if some device can't be reached through P2P memcpys.
+  ///
+  /// @param[in] runtime the runtime used to submit the operations, it must outlive the communicator
+  /// @param[in] devices the devices taking part in the collectives, without repetitions
+  /// @param[in] chunkSize maximum size of the chunks data is pipelined in, it's limited to the max DMA element size
+  ///
+  Communicator(IRuntime& runtime, std::vector<DeviceId> devices, size_t chunkSize = kDefaultChunkSize);
+
+  /// \brief Creates a communicator over the devices of a device group (see \ref IRuntime::createDeviceGroup). The
+  /// collectives are queued into the group streams instead of streams of their own, so the work launched afterwards on
+  /// the group (ie. \ref IRuntime::launchOnGroup) runs after them without any further synchronization. The group must
+  /// outlive the communicator.
+  ///
+  /// @param[in] runtime the runtime used to submit the operations, it must outlive the communicator
+  /// @param[in] group the device group; its devices take part in the collectives in the group order
+  /// @param[in] chunkSize maximum size of the chunks data is pipelined in, it's limited to the max DMA element size
+  ///
+  Communicator(IRuntime& runtime, DeviceGroupId group, size_t chunkSize = kDefaultChunkSize);
+
+  /// \brief Destroys the communicator streams, unless they belong to a device group, and releases its scratch buffers
+  ~Communicator();
+
+  Communicator(const Communicator&) = delete;
+  Communicator& operator=(const Communicator&) = delete;
+
+  /// \brief Returns the topology used by the collectives
+  CollectiveTopology getTopology() const;
+
+  /// \brief Returns the devices in the order data goes around the ring; empty if the topology is not Ring
+  std::vector<DeviceId> getRing() const;
+
+  /// \brief Returns the stream of the communicator in the given device
+  StreamId getStream(DeviceId device) const;
+
+  /// \brief Copies size bytes from the root buffer to the buffers of all the other devices
+  ///
+  /// @param[in] root the device holding the data
+  /// @param[in] buffers device buffers of at least size bytes, one per device
+  /// @param[in] size the amount of bytes to broadcast
+  ///
+  /// @returns the events to wait for to know the collective has completed
+  ///
+  std::vector<EventId> broadcast(DeviceId root, const std::vector<std::byte*>& buffers, size_t size);
+
+  /// \brief Gathers the blocks of all the devices into every buffer. Buffers hold one block of size bytes per device,
+  /// in the order of the devices; each device contributes with its own block, which is copied to the others.
+  ///
+  /// @param[in] buffers device buffers of at least size * number of devices bytes, one per device
+  /// @param[in] size the block size in bytes
+  ///
+  /// @returns the events to wait for to know the collective has completed
+  ///
+  std::vector<EventId> allGather(const std::vector<std::byte*>& buffers, size_t size);
+
+  /// \brief Reduces the buffers of all the devices, leaving the result in all of them. Chunk boundaries are multiple
+  /// of \ref kCacheLineSize, hence the reduction elements can't be bigger.
+  ///
+  /// @param[in] buffers device buffers of at least size bytes, one per device
+  /// @param[in] size the amount of bytes to reduce
+  /// @param[in] op the device side reduction, see \ref ReduceOp
+  ///
+  /// @returns the events to wait for to know the collective has completed
+  ///
+  std::vector<EventId> allReduce(const std::vector<std::byte*>& buffers, size_t size, const ReduceOp& op);
+
+private:
+  Communicator(IRuntime& runtime, std::vector<DeviceId> devices, size_t chunkSize, std::optional<DeviceGroupId> group);
+
+  struct Chunk {
+    size_t offset_;
+    size_t size_;
+  };
+  // events after which a chunk is available, indexed by device and chunk. Empty if it already was
+  using ChunkEvents = std::vector<std::vector<std::optional<EventId>>>;
+  // parent of each device and the devices in the order they are reached from the root
+  using Tree = std::pair<std::vector<size_t>, std::vector<size_t>>;
+
+  void checkBuffers(const std::vector<std::byte*>& buffers) const;
+  size_t getIndex(DeviceId device) const;
+  std::vector<Chunk> split(size_t offset, size_t size) const;
+  // spanning tree rooted at root: a chain following the ring, or breadth first if there is no ring
+  Tree buildTree(size_t root) const;
+  std::byte* getScratch(size_t idx, size_t size);
+  void waitForPreviousWork();
+  void wait(const std::optional<EventId>& event);
+  // queues into dst stream a copy from src device
+  EventId copy(size_t src, size_t dst, const std::byte* d_src, std::byte* d_dst, size_t size, bool barrier);
+  EventId reduce(size_t idx, std::byte* d_dst, const std::byte* d_src, size_t size, const ReduceOp& op);
+  std::vector<EventId> getLastEvents();
+
+  void ringAllReduce(const std::vector<std::byte*>& buffers, size_t size, const ReduceOp& op);
+  void treeAllReduce(const std::vector<std::byte*>& buffers, size_t size, const ReduceOp& op);
+  // copies size bytes at each offset down its tree
+  void propagate(const std::vector<Tree>& trees, const std::vector<std::byte*>& buffers,
+                 const std::vector<size_t>& offsets, size_t size);
+
+  IRuntime& runtime_;
+  std::vector<DeviceId> devices_;
+  std::vector<StreamId> streams_;
+  bool ownsStreams_; // false if the streams belong to a device group
+  std::vector<std::vector<bool>> links_;
+  std::vector<size_t> ring_; // device indices, empty if there is no ring
+  size_t chunkSize_;
+  std::vector<std::byte*> scratch_;
+  std::vector<size_t> scratchSizes_;
+  std::vector<std::optional<EventId>> lastEvents_; // last event queued into each stream by the ongoing collective
+};
+
+} // namespace rt
+  /// @}
+  // End of runtime_collectives
@@ -3,23 +3,48 @@
  * SPDX-License-Identifier: Apache-2.0
  *-------------------------------------------------------------------------*/
 #pragma once
+#include "runtime/DeviceOpsExt.h"
 #include "runtime/Types.h"
 #include <runtime/IRuntimeExport.h>
 
 #include <device-layer/IDeviceLayer.h>
 #include <esperanto/device-apis/operations-api/device_ops_api_cxx.h>
 
+#include <algorithm>
+#include <chrono>
 #include <condition_variable>
+#include <cstddef>
 #include <cstdlib>
 #include <cstring>
+#include <map>
 #include <mutex>
 #include <queue>
 #include <string>
+#include <vector>
 
 namespace dev {
 
 class ETRT_API DeviceLayerFake : public IDeviceLayer {
 public:
+  using Clock = std::chrono::steady_clock;
+
+  // Device timing of the commands. Each device has a compute engine running the kernel launches and a DMA engine
+  // running the DMA lists, in order; commands with the barrier flag (and stream syncs) wait for both engines to be
+  // idle, the rest of the commands don't use any engine. The defaults complete every command right away.
+  struct LatencyModel {
+    std::chrono::nanoseconds kernelLaunch_{0};
+    std::chrono::nanoseconds dmaCommand_{0}; // fixed cost of each DMA list, on top of its transfer time
+    std::chrono::nanoseconds otherCommand_{0};
+    uint64_t dmaBytesPerSecond_ = 0; // zero means the transfers take no time
+    uint32_t sqDepth_ = 0;           // maximum commands in flight per device, zero means unlimited
+    uint32_t cqBatch_ = 1; // responses are delivered in groups of this size, or less if nothing else is in flight
+
+    bool isEnabled() const {
+      return kernelLaunch_.count() > 0 || dmaCommand_.count() > 0 || otherCommand_.count() > 0 ||
+             dmaBytesPerSecond_ > 0 || sqDepth_ > 0 || cqBatch_ > 1;
+    }
+  };
+
   struct Parameters {
     size_t bytesDram_ = 1UL << (10 + 10 + 10 + 5);
     size_t dramBaseAddress_ = 0x8000;
@@ -60,6 +85,7 @@ public:
       255,                                // onPkgDRAMInterleavedChipletLSb_
       255,                                // onPkgDRAMInterleavedChipletBits_
     };
+    LatencyModel latency_;
 
     static Parameters getDefault() {
       return Parameters{};
@@ -67,10 +93,12 @@ public:
   };
   explicit DeviceLayerFake(int numDevices = 1, Parameters params = Parameters::getDefault())
     : numDevices_(numDevices)
-    , params_(params) {
+    , params_(params)
+    , modelled_(params.latency_.isEnabled()) {
     if (numDevices <= 0) {
       throw Exception("Num devices needs to be > 0");
     }
+    models_.resize(static_cast<size_t>(numDevices_));
     for (int i = 0; i < numDevices_; ++i) {
       responsesMasterMinion_[i] = {};
       responsesServiceProcessor_[i] = {};
@@ -113,10 +141,57 @@ public:
     case device_ops_api::DEV_OPS_API_MID_CHECK_DEVICE_OPS_API_COMPATIBILITY_CMD:
       rsp.rsp_hdr.msg_id = device_ops_api::DEV_OPS_API_MID_DEVICE_OPS_API_COMPATIBILITY_RSP;
       break;
+    case rt::device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_STREAM_SYNC_CMD:
+      rsp.rsp_hdr.msg_id = rt::device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_STREAM_SYNC_RSP;
+      break;
+    case rt::device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_MEMSET_CMD:
+      rsp.rsp_hdr.msg_id = rt::device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_MEMSET_RSP;
+      break;
+    case rt::device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_DEVICE_MEMCPY_CMD:
+      rsp.rsp_hdr.msg_id = rt::device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_DEVICE_MEMCPY_RSP;
+      break;
+    case rt::device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_KERNEL_HEAP_CONFIG_CMD:
+      rsp.rsp_hdr.msg_id = rt::device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_KERNEL_HEAP_CONFIG_RSP;
+      break;
+    case rt::device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_KERNEL_FLUSH_RANGES_CMD:
+      rsp.rsp_hdr.msg_id = rt::device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_KERNEL_FLUSH_RANGES_RSP;
+      break;
+    case rt::device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_KERNEL_SHIRE_ARGS_CMD:
+      rsp.rsp_hdr.msg_id = rt::device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_KERNEL_SHIRE_ARGS_RSP;
+      break;
+    case rt::device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_KERNEL_WATCHDOG_CMD:
+      rsp.rsp_hdr.msg_id = rt::device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_KERNEL_WATCHDOG_RSP;
+      break;
+    case rt::device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_KERNEL_LAUNCH_CONFIG_CMD:
+      rsp.rsp_hdr.msg_id = rt::device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_KERNEL_LAUNCH_CONFIG_RSP;
+      break;
+    case rt::device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_KERNEL_POWER_REPORT_CMD:
+      rsp.rsp_hdr.msg_id = rt::device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_KERNEL_POWER_REPORT_RSP;
+      break;
+    case rt::device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_KERNEL_MULTI_LAUNCH_CMD:
+      rsp.rsp_hdr.msg_id = rt::device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_KERNEL_MULTI_LAUNCH_RSP;
+      break;
+    case rt::device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_CMD_LIST_EXECUTE_CMD:
+      rsp.rsp_hdr.msg_id = rt::device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_CMD_LIST_EXECUTE_RSP;
+      break;
+    case rt::device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_DMA_CHAIN_CMD:
+      rsp.rsp_hdr.msg_id = rt::device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_DMA_CHAIN_RSP;
+      break;
     default:
       throw Exception("Please, add command with msg_id: " + std::to_string(cmd->msg_id));
     }
-    responsesMasterMinion_[device].push(rsp);
+    if (modelled_) {
+      auto& model = models_[static_cast<size_t>(device)];
+      if (params_.latency_.sqDepth_ > 0 && model.inFlight_.size() >= params_.latency_.sqDepth_) {
+        model.sqFull_ = true;
+        return false;
+      }
+      model.inFlight_.emplace(getCompletionTime(model, cmd), rsp);
+    } else {
+      responsesMasterMinion_[device].push(rsp);
+    }
+    lock.unlock();
+    cvMm_.notify_all();
     return true;
   }
 
@@ -131,9 +206,30 @@ public:
     while (!lock.try_lock()) {
       // spin-lock
     }
-    cvMm_.wait_for(lock, timeout, [this, device] { return !responsesMasterMinion_[device].empty(); });
-    cq_available = true;
-    sq_bitmap = 0xFFFFFFFFFFFFFFFF;
+    if (!modelled_) {
+      cvMm_.wait_for(lock, timeout, [this, device] { return !responsesMasterMinion_[device].empty(); });
+      cq_available = true;
+      sq_bitmap = 0xFFFFFFFFFFFFFFFF;
+      return;
+    }
+    auto& model = models_[static_cast<size_t>(device)];
+    auto deadline = Clock::now() + timeout;
+    for (;;) {
+      auto now = Clock::now();
+      deliverResponses(device, now);
+      // the submission queue is reported once it has room again after a failed send, like an edge triggered epoll
+      bool sqAvailable = model.sqFull_ && model.inFlight_.size() < params_.latency_.sqDepth_;
+      if (sqAvailable || !responsesMasterMinion_[device].empty() || now >= deadline) {
+        sq_bitmap = sqAvailable ? 0xFFFFFFFFFFFFFFFF : 0;
+        cq_available = !responsesMasterMinion_[device].empty();
+        if (sqAvailable) {
+          model.sqFull_ = false;
+        }
+        return;
+      }
+      auto wakeUp = model.inFlight_.empty() ? deadline : std::min(deadline, model.inFlight_.begin()->first);
+      cvMm_.wait_until(lock, wakeUp);
+    }
   }
 
   bool receiveResponseMasterMinion(int device, std::vector<std::byte>& response) override {
@@ -142,7 +238,9 @@ public:
     while (!lock.try_lock()) {
       // spin-lock
     }
-
+    if (modelled_) {
+      deliverResponses(device, Clock::now());
+    }
     if (!responsesMasterMinion_[device].empty()) {
       response.resize(sizeof(device_ops_api::rsp_header_t));
       std::memcpy(response.data(), &responsesMasterMinion_[device].front(), sizeof(device_ops_api::rsp_header_t));
@@ -298,7 +396,83 @@ public:
     return false;
   }
 
+  size_t registerHostMemory(int, const void*, size_t, bool) override {
+    return 1;
+  }
+
+  bool canStreamHostMemory(int) const override {
+    return true;
+  }
+
 private:
+  struct DeviceModel {
+    Clock::time_point computeFree_;
+    Clock::time_point dmaFree_;
+    // responses of the commands in flight, by completion time
+    std::multimap<Clock::time_point, device_ops_api::rsp_header_t> inFlight_;
+    bool sqFull_ = false;
+  };
+
+  Clock::time_point getCompletionTime(DeviceModel& model, const device_ops_api::cmn_header_t* cmd) const {
+    const auto& latency = params_.latency_;
+    auto now = Clock::now();
+    bool barrier = (cmd->flags & device_ops_api::CMD_FLAGS_BARRIER_ENABLE) != 0;
+    auto getStart = [&](Clock::time_point engineFree) {
+      auto start = std::max(now, engineFree);
+      return barrier ? std::max({start, model.computeFree_, model.dmaFree_}) : start;
+    };
+    switch (cmd->msg_id) {
+    case device_ops_api::DEV_OPS_API_MID_DEVICE_OPS_KERNEL_LAUNCH_CMD:
+    case rt::device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_KERNEL_MULTI_LAUNCH_CMD:
+      model.computeFree_ = getStart(model.computeFree_) + latency.kernelLaunch_;
+      return model.computeFree_;
+    case device_ops_api::DEV_OPS_API_MID_DEVICE_OPS_DMA_WRITELIST_CMD:
+    case device_ops_api::DEV_OPS_API_MID_DEVICE_OPS_DMA_READLIST_CMD:
+      model.dmaFree_ = getStart(model.dmaFree_) + latency.dmaCommand_ + getTransferTime(cmd);
+      return model.dmaFree_;
+    case rt::device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_STREAM_SYNC_CMD:
+      return std::max({now, model.computeFree_, model.dmaFree_}) + latency.otherCommand_;
+    default:
+      return getStart(now) + latency.otherCommand_;
+    }
+  }
+
+  // read and write lists share the layout, see MemcpyOps.cpp
+  std::chrono::nanoseconds getTransferTime(const device_ops_api::cmn_header_t* cmd) const {
+    if (params_.latency_.dmaBytesPerSecond_ == 0) {
+      return std::chrono::nanoseconds{0};
+    }
+    auto begin = reinterpret_cast<const std::byte*>(cmd);
+    auto node = begin + offsetof(device_ops_api::device_ops_dma_writelist_cmd_t, list);
+    auto end = begin + cmd->size;
+    uint64_t bytes = 0;
+    for (; node + sizeof(device_ops_api::dma_write_node) <= end; node += sizeof(device_ops_api::dma_write_node)) {
+      device_ops_api::dma_write_node entry;
+      std::memcpy(&entry, node, sizeof(entry));
+      bytes += entry.size;
+    }
+    return std::chrono::nanoseconds{bytes * 1'000'000'000ULL / params_.latency_.dmaBytesPerSecond_};
+  }
+
+  // moves the completed responses to the completion queue, once there are latency_.cqBatch_ of them or there is
+  // nothing else in flight. Must be called with mmMutex_ held
+  void deliverResponses(int device, Clock::time_point now) {
+    auto& inFlight = models_[static_cast<size_t>(device)].inFlight_;
+    auto last = inFlight.begin();
+    uint32_t count = 0;
+    while (last != inFlight.end() && last->first <= now && count < params_.latency_.cqBatch_) {
+      ++last;
+      ++count;
+    }
+    if (count == 0 || (count < params_.latency_.cqBatch_ && last != inFlight.end())) {
+      return;
+    }
+    for (auto it = inFlight.begin(); it != last; ++it) {
+      responsesMasterMinion_[device].push(it->second);
+    }
+    inFlight.erase(inFlight.begin(), last);
+  }
+
   std::unordered_map<int, std::queue<device_ops_api::rsp_header_t>> responsesMasterMinion_;
   std::unordered_map<int, std::queue<device_ops_api::dev_mgmt_rsp_header_t>> responsesServiceProcessor_;
   std::condition_variable cvMm_;
@@ -307,6 +481,8 @@ private:
   std::mutex spMutex_;
   const int numDevices_;
   Parameters params_;
+  const bool modelled_;
+  std::vector<DeviceModel> models_;
 
   void checkDevice(int device) const {
     if (device >= numDevices_ || device < 0) {
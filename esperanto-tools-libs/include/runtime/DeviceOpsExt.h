@@ -0,0 +1,424 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) 2025 Ainekko, Co.
+ * SPDX-License-Identifier: Apache-2.0
+ *-------------------------------------------------------------------------*/
+#pragma once
+#include <esperanto/device-apis/operations-api/device_ops_api_cxx.h>
+
+#include <cstdint>
+
+/// \brief Device ops commands supported by MasterMinion which are not yet part of the device-api spec. Message ids
+/// are taken from the end of the device ops reserved range. Must be kept in sync with MasterMinion host_cmd_hdlr.h
+namespace rt::device_ops_ext {
+
+constexpr uint16_t DEV_OPS_API_MID_DEVICE_OPS_STREAM_SYNC_CMD = 1020;
+constexpr uint16_t DEV_OPS_API_MID_DEVICE_OPS_STREAM_SYNC_RSP = 1021;
+
+/// number of slots MasterMinion has to synchronize submission queues
+constexpr auto kNumStreamSyncSlots = 64U;
+
+enum StreamSyncOp : uint8_t {
+  STREAM_SYNC_OP_SIGNAL = 0, ///< sent with barrier, stores the token in the slot once previous SQ commands completed
+  STREAM_SYNC_OP_WAIT = 1    ///< holds the SQ till the slot contains the token, then clears the slot
+};
+
+enum StreamSyncResponse : uint32_t {
+  STREAM_SYNC_RESPONSE_SUCCESS = 0,
+  STREAM_SYNC_RESPONSE_HOST_ABORTED = 1,
+  STREAM_SYNC_RESPONSE_INVALID_SLOT = 2
+};
+
+struct device_ops_stream_sync_cmd_t {
+  device_ops_api::cmd_header_t command_info;
+  uint16_t slot;
+  uint16_t token; ///< must not be 0
+  uint8_t op;     ///< see StreamSyncOp
+  uint8_t pad[3];
+} __attribute__((packed, aligned(8)));
+
+struct device_ops_stream_sync_rsp_t {
+  device_ops_api::rsp_header_t response_info;
+  uint32_t status; ///< see StreamSyncResponse
+  uint32_t pad;
+} __attribute__((packed, aligned(8)));
+
+constexpr uint16_t DEV_OPS_API_MID_DEVICE_OPS_CMD_CHAIN_CMD = 1018;
+constexpr uint16_t DEV_OPS_API_MID_DEVICE_OPS_CMD_CHAIN_RSP = 1019;
+
+/// max number of stages (writelist, kernel launch, readlist commands) of a command chain
+constexpr auto kMaxCmdChainStages = 4U;
+
+enum CmdChainResponse : uint32_t {
+  CMD_CHAIN_RESPONSE_SUCCESS = 0,
+  CMD_CHAIN_RESPONSE_STAGE_FAILED = 1, ///< failed_stage and stage_status tell which stage failed and how
+  CMD_CHAIN_RESPONSE_HOST_ABORTED = 2,
+  CMD_CHAIN_RESPONSE_INVALID_STAGES = 3
+};
+
+/// stages are full commands, each one 8 bytes aligned, following the chain command. They run in order, each stage
+/// once the previous one completed, and their responses are consumed by MasterMinion
+struct device_ops_cmd_chain_cmd_t {
+  device_ops_api::cmd_header_t command_info;
+  uint8_t stage_count;
+  uint8_t pad[7];
+} __attribute__((packed, aligned(8)));
+
+struct device_ops_cmd_chain_rsp_t {
+  device_ops_api::rsp_header_t response_info;
+  uint64_t device_cmd_start_ts;
+  uint64_t device_cmd_wait_dur;
+  uint64_t device_cmd_execute_dur;
+  uint32_t status;       ///< see CmdChainResponse
+  uint32_t stage_status; ///< status of the failed stage response
+  uint8_t failed_stage;  ///< stage_count if no stage failed
+  uint8_t pad[7];
+} __attribute__((packed, aligned(8)));
+
+constexpr uint16_t DEV_OPS_API_MID_DEVICE_OPS_CMD_LIST_EXECUTE_CMD = 1004;
+constexpr uint16_t DEV_OPS_API_MID_DEVICE_OPS_CMD_LIST_EXECUTE_RSP = 1005;
+
+/// max number of patches of a command list execution
+constexpr auto kCmdListPatchesMax = 8U;
+/// max size of each command of a command list
+constexpr auto kCmdListStageSizeMax = 512U;
+
+enum CmdListResponse : uint32_t {
+  CMD_LIST_RESPONSE_SUCCESS = 0,
+  CMD_LIST_RESPONSE_STAGE_FAILED = 1, ///< failed_stage, stage_msg_id and stage_status tell which stage failed and how
+  CMD_LIST_RESPONSE_HOST_ABORTED = 2,
+  CMD_LIST_RESPONSE_INVALID_LIST = 3
+};
+
+/// replaces the 64 bit word at offset of the list, only for one execution
+struct device_ops_cmd_list_patch_t {
+  uint64_t value;
+  uint32_t offset; ///< 8 bytes aligned
+  uint32_t pad;
+} __attribute__((packed, aligned(8)));
+
+/// the list lives in device memory and holds command chain stages, memsets, device memcpys and kernel flush ranges,
+/// each one 8 bytes aligned. MasterMinion runs them in order like the stages of a command chain, with the tag id of
+/// the execute command, and only sends the execute response
+struct device_ops_cmd_list_execute_cmd_t {
+  device_ops_api::cmd_header_t command_info;
+  uint64_t list_address;     ///< 8 bytes aligned
+  uint64_t exception_buffer; ///< replaces the one of the kernel launches if not 0
+  uint64_t args_buffer;      ///< replaces the args address of the kernel launches with embedded args if not 0
+  uint32_t list_size;
+  uint32_t stage_count;
+  uint32_t patch_count;
+  uint32_t pad;
+  device_ops_cmd_list_patch_t patches[kCmdListPatchesMax];
+} __attribute__((packed, aligned(8)));
+
+struct device_ops_cmd_list_execute_rsp_t {
+  device_ops_api::rsp_header_t response_info;
+  uint64_t device_cmd_start_ts;
+  uint64_t device_cmd_wait_dur;
+  uint64_t device_cmd_execute_dur;
+  uint32_t status;       ///< see CmdListResponse
+  uint32_t stage_status; ///< status of the failed stage response
+  uint32_t failed_stage; ///< stage_count if no stage failed
+  uint16_t stage_msg_id; ///< response message id of the failed stage
+  uint16_t pad;
+} __attribute__((packed, aligned(8)));
+
+constexpr uint16_t DEV_OPS_API_MID_DEVICE_OPS_MEMSET_CMD = 1016;
+constexpr uint16_t DEV_OPS_API_MID_DEVICE_OPS_MEMSET_RSP = 1017;
+
+enum MemsetResponse : uint32_t {
+  MEMSET_RESPONSE_SUCCESS = 0,
+  MEMSET_RESPONSE_HOST_ABORTED = 1,
+  MEMSET_RESPONSE_INVALID_ADDRESS = 2, ///< out of the host managed DRAM
+  MEMSET_RESPONSE_INVALID_PATTERN = 3  ///< bad pattern size, or address / size not multiple of it
+};
+
+/// MasterMinion fills the device memory with the pattern, repeated, and evicts it to L3; there is no PCIe traffic
+struct device_ops_memset_cmd_t {
+  device_ops_api::cmd_header_t command_info;
+  uint64_t dst_device_phy_addr; ///< aligned to pattern_size
+  uint64_t size;                ///< multiple of pattern_size
+  uint64_t pattern;             ///< little endian, only the first pattern_size bytes are used
+  uint8_t pattern_size;         ///< 1, 2, 4 or 8
+  uint8_t pad[7];
+} __attribute__((packed, aligned(8)));
+
+struct device_ops_memset_rsp_t {
+  device_ops_api::rsp_header_t response_info;
+  uint32_t status; ///< see MemsetResponse
+  uint32_t pad;
+} __attribute__((packed, aligned(8)));
+
+constexpr uint16_t DEV_OPS_API_MID_DEVICE_OPS_DEVICE_MEMCPY_CMD = 1014;
+constexpr uint16_t DEV_OPS_API_MID_DEVICE_OPS_DEVICE_MEMCPY_RSP = 1015;
+
+enum DeviceMemcpyResponse : uint32_t {
+  DEVICE_MEMCPY_RESPONSE_SUCCESS = 0,
+  DEVICE_MEMCPY_RESPONSE_HOST_ABORTED = 1,
+  DEVICE_MEMCPY_RESPONSE_INVALID_ADDRESS = 2 ///< out of the host managed DRAM
+};
+
+/// MasterMinion copies between two ranges of the same device memory, which can overlap; there is no PCIe traffic
+struct device_ops_device_memcpy_cmd_t {
+  device_ops_api::cmd_header_t command_info;
+  uint64_t src_device_phy_addr;
+  uint64_t dst_device_phy_addr;
+  uint64_t size;
+} __attribute__((packed, aligned(8)));
+
+struct device_ops_device_memcpy_rsp_t {
+  device_ops_api::rsp_header_t response_info;
+  uint32_t status; ///< see DeviceMemcpyResponse
+  uint32_t pad;
+} __attribute__((packed, aligned(8)));
+
+constexpr uint16_t DEV_OPS_API_MID_DEVICE_OPS_DMA_CHAIN_CMD = 1012;
+constexpr uint16_t DEV_OPS_API_MID_DEVICE_OPS_DMA_CHAIN_RSP = 1013;
+
+/// max number of data elements of a DMA chain
+constexpr auto kMaxDmaChainElems = 64U * 1024U;
+
+enum DmaChainDirection : uint8_t { DMA_CHAIN_DIRECTION_HOST_TO_DEVICE = 0, DMA_CHAIN_DIRECTION_DEVICE_TO_HOST = 1 };
+
+/// PCIe DMA linked list data element. The host side address is an offset in the host buffer of the command; ctrl is
+/// written by MasterMinion
+struct dma_chain_elem_t {
+  uint32_t ctrl;
+  uint32_t size; ///< must not be 0
+  uint64_t sar;  ///< source address
+  uint64_t dar;  ///< destination address
+} __attribute__((packed));
+static_assert(sizeof(dma_chain_elem_t) == 24, "DMA chain element must match the PCIe DMA linked list element");
+
+/// the chain is an array of elem_count + 1 elements in host managed DRAM, 8 bytes aligned, the last one being
+/// overwritten with the link ending the chain. It's run in place by a single DMA channel. MasterMinion checks the host
+/// offsets against host_size and rewrites them with the bus address, so a chain is consumed by the command. The host
+/// buffer must be DMA contiguous (CMA, or in a single DMA segment of a registered buffer); the driver fills in its bus
+/// address, the command is pushed with dev::CmdFlagMM::isDmaChain_
+struct device_ops_dma_chain_cmd_t {
+  device_ops_api::cmd_header_t command_info;
+  uint64_t chain_device_phy_addr;
+  uint64_t host_virt_addr;
+  uint64_t host_phy_addr; ///< filled in by the driver
+  uint64_t host_size;
+  uint32_t elem_count; ///< 1 to kMaxDmaChainElems
+  uint8_t direction;   ///< see DmaChainDirection
+  uint8_t pad[3];
+} __attribute__((packed, aligned(8)));
+
+/// same layout as the DMA list responses, status is a device_ops_api::dma_response_e
+struct device_ops_dma_chain_rsp_t {
+  device_ops_api::rsp_header_t response_info;
+  uint64_t device_cmd_start_ts;
+  uint64_t device_cmd_wait_dur;
+  uint64_t device_cmd_execute_dur;
+  uint32_t status;
+  uint32_t pad;
+} __attribute__((packed, aligned(8)));
+
+constexpr uint16_t DEV_OPS_API_MID_DEVICE_OPS_KERNEL_HEAP_CONFIG_CMD = 1010;
+constexpr uint16_t DEV_OPS_API_MID_DEVICE_OPS_KERNEL_HEAP_CONFIG_RSP = 1011;
+
+/// must match KERNEL_HEAP_ARENA_COUNT and KERNEL_HEAP_ARENA_HEADER_SIZE (system/abi.h)
+constexpr auto kKernelHeapArenaCount = 32U;
+constexpr auto kKernelHeapArenaHeaderSize = 256U;
+/// each arena holds at least its header and a cache line
+constexpr auto kKernelHeapMinSize = kKernelHeapArenaCount * (kKernelHeapArenaHeaderSize + 64U);
+
+enum KernelHeapConfigResponse : uint32_t {
+  KERNEL_HEAP_CONFIG_RESPONSE_SUCCESS = 0,
+  KERNEL_HEAP_CONFIG_RESPONSE_HOST_ABORTED = 1,
+  KERNEL_HEAP_CONFIG_RESPONSE_INVALID_ADDRESS = 2, ///< out of the host managed DRAM, misaligned or too small
+  KERNEL_HEAP_CONFIG_RESPONSE_KERNELS_RUNNING = 3
+};
+
+/// MasterMinion splits the region in an arena per compute shire (see system/abi.h), which kernels allocate from with
+/// etsoc/common/heap.h. A size of 0 disables the heap. It's refused while kernels are running
+struct device_ops_kernel_heap_config_cmd_t {
+  device_ops_api::cmd_header_t command_info;
+  uint64_t heap_device_phy_addr; ///< aligned to a cache line
+  uint64_t size;
+} __attribute__((packed, aligned(8)));
+
+struct device_ops_kernel_heap_config_rsp_t {
+  device_ops_api::rsp_header_t response_info;
+  uint32_t status; ///< see KernelHeapConfigResponse
+  uint32_t pad;
+} __attribute__((packed, aligned(8)));
+
+constexpr uint16_t DEV_OPS_API_MID_DEVICE_OPS_KERNEL_FLUSH_RANGES_CMD = 1008;
+constexpr uint16_t DEV_OPS_API_MID_DEVICE_OPS_KERNEL_FLUSH_RANGES_RSP = 1009;
+
+/// must match MM_KERNEL_FLUSH_RANGES_MAX (host_cmd_hdlr.h)
+constexpr auto kKernelFlushRangesMax = 15U;
+
+enum KernelFlushRangesResponse : uint32_t {
+  KERNEL_FLUSH_RANGES_RESPONSE_SUCCESS = 0,
+  KERNEL_FLUSH_RANGES_RESPONSE_HOST_ABORTED = 1,
+  KERNEL_FLUSH_RANGES_RESPONSE_INVALID_ADDRESS = 2 ///< too many ranges, or one empty or out of the host managed DRAM
+};
+
+struct device_ops_flush_range_t {
+  uint64_t device_phy_addr;
+  uint64_t size;
+} __attribute__((packed, aligned(8)));
+
+/// Sets the output buffers of the next kernel launched from the same SQ, which the last hart of the kernel flushes to
+/// memory before reporting its completion. A count of 0 clears them
+struct device_ops_kernel_flush_ranges_cmd_t {
+  device_ops_api::cmd_header_t command_info;
+  uint32_t count;
+  uint32_t pad;
+  device_ops_flush_range_t ranges[kKernelFlushRangesMax];
+} __attribute__((packed, aligned(8)));
+
+struct device_ops_kernel_flush_ranges_rsp_t {
+  device_ops_api::rsp_header_t response_info;
+  uint32_t status; ///< see KernelFlushRangesResponse
+  uint32_t pad;
+} __attribute__((packed, aligned(8)));
+
+constexpr uint16_t DEV_OPS_API_MID_DEVICE_OPS_KERNEL_SHIRE_ARGS_CMD = 1002;
+constexpr uint16_t DEV_OPS_API_MID_DEVICE_OPS_KERNEL_SHIRE_ARGS_RSP = 1003;
+
+enum KernelShireArgsResponse : uint32_t {
+  KERNEL_SHIRE_ARGS_RESPONSE_SUCCESS = 0,
+  KERNEL_SHIRE_ARGS_RESPONSE_HOST_ABORTED = 1,
+  KERNEL_SHIRE_ARGS_RESPONSE_INVALID_STRIDE = 2 ///< not a multiple of 8 bytes
+};
+
+/// Makes the arguments of the next kernel launched from the same SQ an array with a slice of stride bytes for each
+/// shire of its mask, in increasing shire order; each shire gets a pointer to its own slice. A stride of 0 clears it
+struct device_ops_kernel_shire_args_cmd_t {
+  device_ops_api::cmd_header_t command_info;
+  uint32_t stride;
+  uint32_t pad;
+} __attribute__((packed, aligned(8)));
+
+struct device_ops_kernel_shire_args_rsp_t {
+  device_ops_api::rsp_header_t response_info;
+  uint32_t status; ///< see KernelShireArgsResponse
+  uint32_t pad;
+} __attribute__((packed, aligned(8)));
+
+constexpr uint16_t DEV_OPS_API_MID_DEVICE_OPS_KERNEL_WATCHDOG_CMD = 1000;
+constexpr uint16_t DEV_OPS_API_MID_DEVICE_OPS_KERNEL_WATCHDOG_RSP = 1001;
+
+enum KernelWatchdogResponse : uint32_t {
+  KERNEL_WATCHDOG_RESPONSE_SUCCESS = 0,
+  KERNEL_WATCHDOG_RESPONSE_HOST_ABORTED = 1
+};
+
+/// Arms a watchdog for the next kernel launched from the same SQ: if it doesn't complete within the timeout,
+/// MasterMinion aborts only its shires and the launch completes with DEV_OPS_API_KERNEL_LAUNCH_RESPONSE_TIMEOUT_HANG.
+/// A timeout of 0 clears it
+struct device_ops_kernel_watchdog_cmd_t {
+  device_ops_api::cmd_header_t command_info;
+  uint32_t timeout; ///< in seconds
+  uint32_t pad;
+} __attribute__((packed, aligned(8)));
+
+struct device_ops_kernel_watchdog_rsp_t {
+  device_ops_api::rsp_header_t response_info;
+  uint32_t status; ///< see KernelWatchdogResponse
+  uint32_t pad;
+} __attribute__((packed, aligned(8)));
+
+constexpr uint16_t DEV_OPS_API_MID_DEVICE_OPS_KERNEL_POWER_REPORT_CMD = 998;
+constexpr uint16_t DEV_OPS_API_MID_DEVICE_OPS_KERNEL_POWER_REPORT_RSP = 999;
+
+enum KernelPowerReportResponse : uint32_t {
+  KERNEL_POWER_REPORT_RESPONSE_SUCCESS = 0,
+  KERNEL_POWER_REPORT_RESPONSE_HOST_ABORTED = 1,
+  KERNEL_POWER_REPORT_RESPONSE_NO_KERNEL = 2 ///< the SQ has no report of the kernel launch
+};
+
+/// Reports the Minion frequency and the power/thermal throttle events seen by a kernel launched from the same SQ (not
+/// in a multi-launch). Sent with barrier after the launch, so the kernel has completed
+struct device_ops_kernel_power_report_cmd_t {
+  device_ops_api::cmd_header_t command_info;
+  uint16_t kernel_launch_tag_id; ///< tag id of the kernel launch to report
+  uint16_t pad16;
+  uint32_t pad;
+} __attribute__((packed, aligned(8)));
+
+struct device_ops_kernel_power_report_rsp_t {
+  device_ops_api::rsp_header_t response_info;
+  uint32_t status;          ///< see KernelPowerReportResponse
+  uint16_t start_freq_mhz;  ///< Minion frequency when the kernel started
+  uint16_t end_freq_mhz;    ///< Minion frequency when the kernel completed
+  uint32_t throttle_events; ///< frequency throttles reported by the service processor while it ran
+  uint32_t pad;
+} __attribute__((packed, aligned(8)));
+
+constexpr uint16_t DEV_OPS_API_MID_DEVICE_OPS_KERNEL_LAUNCH_CONFIG_CMD = 996;
+constexpr uint16_t DEV_OPS_API_MID_DEVICE_OPS_KERNEL_LAUNCH_CONFIG_RSP = 997;
+
+enum KernelLaunchConfigFlags : uint32_t {
+  KERNEL_LAUNCH_CONFIG_FLAGS_NO_TENSOR_OPS = 1U << 0,      ///< the kernel doesn't use tensor instructions
+  KERNEL_LAUNCH_CONFIG_FLAGS_SHIRE_CACHE_CONFIG = 1U << 1, ///< repartition the SCP and L2 of the kernel shires
+  KERNEL_LAUNCH_CONFIG_FLAGS_PREFETCH = 1U << 2,           ///< prefetch the kernel entry code and arguments
+  KERNEL_LAUNCH_CONFIG_FLAGS_REPORT_AND_CONTINUE = 1U << 3 ///< report tensor errors without failing the launch
+};
+
+enum KernelLaunchConfigResponse : uint32_t {
+  KERNEL_LAUNCH_CONFIG_RESPONSE_SUCCESS = 0,
+  KERNEL_LAUNCH_CONFIG_RESPONSE_HOST_ABORTED = 1,
+  KERNEL_LAUNCH_CONFIG_RESPONSE_INVALID_CACHE_CONFIG = 2 ///< odd sets or less than 0x40 L2 sets
+};
+
+/// Sets the launch flags of the next kernel launched from the same SQ
+struct device_ops_kernel_launch_config_cmd_t {
+  device_ops_api::cmd_header_t command_info;
+  uint32_t flags;    ///< see KernelLaunchConfigFlags
+  uint16_t scp_sets; ///< SCP sets per shire cache bank, with KERNEL_LAUNCH_CONFIG_FLAGS_SHIRE_CACHE_CONFIG
+  uint16_t l2_sets;  ///< L2 sets per shire cache bank, scp_sets + l2_sets must fill the sets below L3
+} __attribute__((packed, aligned(8)));
+
+struct device_ops_kernel_launch_config_rsp_t {
+  device_ops_api::rsp_header_t response_info;
+  uint32_t status; ///< see KernelLaunchConfigResponse
+  uint32_t pad;
+} __attribute__((packed, aligned(8)));
+
+constexpr uint16_t DEV_OPS_API_MID_DEVICE_OPS_KERNEL_MULTI_LAUNCH_CMD = 1006;
+constexpr uint16_t DEV_OPS_API_MID_DEVICE_OPS_KERNEL_MULTI_LAUNCH_RSP = 1007;
+
+/// must match MM_KERNEL_MULTI_LAUNCH_MAX (host_cmd_hdlr.h)
+constexpr auto kKernelMultiLaunchMax = 8U;
+
+enum KernelMultiLaunchResponse : uint32_t {
+  KERNEL_MULTI_LAUNCH_RESPONSE_COMPLETED = 0,
+  KERNEL_MULTI_LAUNCH_RESPONSE_HOST_ABORTED = 1,
+  KERNEL_MULTI_LAUNCH_RESPONSE_INVALID_ARGS = 2, ///< bad count, or empty or overlapping shire masks
+  KERNEL_MULTI_LAUNCH_RESPONSE_ENTRY_FAILED = 3  ///< see the status of each entry
+};
+
+struct device_ops_kernel_multi_launch_entry_t {
+  uint64_t code_start_address;
+  uint64_t pointer_to_args; ///< already in device memory, there is no optional payload
+  uint64_t shire_mask;
+} __attribute__((packed, aligned(8)));
+
+/// Launches kernels on disjoint shire masks together, each dispatched by MasterMinion like a kernel launch, with a
+/// single response once all of them complete. The exception buffer is indexed by hart, so it's shared
+struct device_ops_kernel_multi_launch_cmd_t {
+  device_ops_api::cmd_header_t command_info;
+  uint64_t exception_buffer;
+  uint32_t count;
+  uint32_t pad;
+  device_ops_kernel_multi_launch_entry_t entries[kKernelMultiLaunchMax];
+} __attribute__((packed, aligned(8)));
+
+struct device_ops_kernel_multi_launch_rsp_t {
+  device_ops_api::rsp_header_t response_info;
+  uint64_t device_cmd_start_ts;
+  uint64_t device_cmd_wait_dur;
+  uint64_t device_cmd_execute_dur; ///< from the first launch to the last completion
+  uint64_t cm_error_shire_mask;    ///< shires of the entries which failed
+  uint32_t status;                 ///< see KernelMultiLaunchResponse
+  uint32_t count;
+  uint32_t entry_status[kKernelMultiLaunchMax]; ///< device_ops_api::DEV_OPS_API_KERNEL_LAUNCH_RESPONSE of each entry
+} __attribute__((packed, aligned(8)));
+
+} // namespace rt::device_ops_ext
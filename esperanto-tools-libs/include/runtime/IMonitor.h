@@ -7,12 +7,96 @@
 #include "Types.h"
 #include <runtime/IRuntimeExport.h>
 
+#include <array>
+#include <unordered_map>
+#include <vector>
+
 /// \defgroup runtime_monitor_api Runtime Monitoring API
 ///
 /// The Monitor API provides an interface to query about the multiprocess server status.
 ///
 /// @{
 namespace rt {
+/// \brief Statistics of a client connected to the multiprocess server, see \ref IMonitor::getClientStats
+struct ClientStats {
+  int pid_;                   ///< PID of the client process
+  uint32_t uid_;              ///< user owning the client process
+  uint32_t weight_;           ///< share of the submissions given to this client by the server scheduler
+  uint64_t bytesCopied_;      ///< total bytes of the memcpys submitted
+  uint64_t kernelLaunches_;   ///< total kernel launches submitted
+  uint32_t inflightCommands_; ///< memcpys and kernel launches submitted but not yet completed
+  uint64_t throttledUs_;      ///< total time the client submissions have been held back by its QoS limits
+  uint64_t shireMask_;        ///< shires the client kernels are restricted to, 0 means all of them
+  uint64_t deviceMemory_;     ///< device memory allocated by the client, in bytes
+  uint64_t maxDeviceMemory_;  ///< device memory quota of the client in bytes per device, 0 means unlimited
+  uint64_t kernelShireUs_;    ///< execution time of the completed kernels of the client, times their shires
+};
+
+/// \brief Commands whose latencies are tracked in the \ref DeviceMetrics
+enum class CommandKind { KernelLaunch, MemcpyHostToDevice, MemcpyDeviceToHost, COUNT };
+
+/// \brief Stages of the commands execution whose latencies are tracked in the \ref DeviceMetrics
+enum class LatencyStage {
+  SubmitToStart,    ///< from the command being queued in the host till it starts executing in the device
+  Execution,        ///< execution in the device
+  CompletionToWake, ///< from the host reading the command response till the waiters of its event are woken up
+  COUNT
+};
+
+/// \brief Latency histogram in nanoseconds (HDR style). Values below 2 * kSubBuckets have a bucket of their own,
+/// above that each power of two range is split in kSubBuckets buckets, so the bucket bounds are within 1/kSubBuckets
+/// of the values they hold.
+struct ETRT_API LatencyHistogram {
+  static constexpr uint32_t kSubBucketBits = 4;
+  static constexpr uint64_t kSubBuckets = 1U << kSubBucketBits;
+  static constexpr size_t kNumBuckets = (64 - kSubBucketBits + 1) * kSubBuckets;
+
+  /// \brief Returns the bucket the given value goes to.
+  static size_t getBucket(uint64_t value);
+  /// \brief Returns the biggest value which goes to the given bucket.
+  static uint64_t getBucketUpperBound(size_t bucket);
+
+  /// \brief Returns an upper bound of the given percentile (in range [0, 1]) of the values, 0 if there are none.
+  uint64_t getPercentile(double percentile) const;
+
+  std::vector<uint64_t> counts_ = std::vector<uint64_t>(kNumBuckets); ///< number of values of each bucket
+  uint64_t count_ = 0;                                                ///< number of values
+  uint64_t sum_ = 0;                                                  ///< sum of all values
+  uint64_t min_ = 0;                                                  ///< smallest value, 0 if there are none
+  uint64_t max_ = 0;                                                  ///< biggest value
+};
+
+/// \brief Metrics of the commands executed by a device since the server started, see \ref IMonitor::getDeviceMetrics
+struct DeviceMetrics {
+  /// latencies of each command kind and stage, indexed by \ref CommandKind and \ref LatencyStage
+  std::array<std::array<LatencyHistogram, static_cast<size_t>(LatencyStage::COUNT)>,
+             static_cast<size_t>(CommandKind::COUNT)>
+    latencies_;
+  uint64_t bytesHostToDevice_ = 0; ///< bytes copied by the completed host to device DMA commands
+  uint64_t bytesDeviceToHost_ = 0; ///< bytes copied by the completed device to host DMA commands
+  /// bytes per second of the host to device DMA commands over the time they were executing in the device
+  double bytesPerSecondHostToDevice_ = 0.0;
+  /// bytes per second of the device to host DMA commands over the time they were executing in the device
+  double bytesPerSecondDeviceToHost_ = 0.0;
+
+  const LatencyHistogram& getLatencies(CommandKind kind, LatencyStage stage) const {
+    return latencies_[static_cast<size_t>(kind)][static_cast<size_t>(stage)];
+  }
+};
+
+/// \brief Utilization of a device over a short interval, sampled by the MasterMinion firmware into its stats trace
+/// buffer, see \ref IMonitor::getDeviceUtilization
+struct UtilizationSample {
+  uint64_t timestampCycles_ = 0; ///< device cycle the sample interval ends at
+  uint64_t intervalCycles_ = 0;  ///< device cycles covered by the sample
+  std::vector<uint32_t> sqPendingBytes_;     ///< bytes waiting to be processed in each submission queue
+  std::vector<uint32_t> sqInflightCommands_; ///< commands of each submission queue being executed
+  std::vector<double> dmaHostToDeviceBusy_;  ///< busy fraction [0, 1] of each host to device DMA channel
+  std::vector<double> dmaDeviceToHostBusy_;  ///< busy fraction [0, 1] of each device to host DMA channel
+  double kernelBusy_ = 0.0;                  ///< fraction of the interval kernels were executing
+  uint64_t busyShireMask_ = 0;               ///< shires running a kernel at the end of the interval
+};
+
 /// \brief Facade Monitor interface declaration, all monitoring interactions should be made using this interface. There
 /// is a static method \ref create to make monitoring instances.
 ///
@@ -32,6 +116,16 @@ public:
   /// sent to the device and waiting to get the response from.
   virtual std::unordered_map<DeviceId, uint32_t> getAliveEvents() = 0;
 
+  /// \brief Returns the statistics of each client currently connected to the server.
+  virtual std::vector<ClientStats> getClientStats() = 0;
+
+  /// \brief Returns the latency histograms and transfer counters of the commands executed by each device.
+  virtual std::unordered_map<DeviceId, DeviceMetrics> getDeviceMetrics() = 0;
+
+  /// \brief Returns the utilization time series of each device, oldest sample first. The samples are read in bulk from
+  /// the MasterMinion stats trace buffer, which is a ring, so only the most recent ones are kept by the device.
+  virtual std::unordered_map<DeviceId, std::vector<UtilizationSample>> getDeviceUtilization() = 0;
+
   /// \brief create a new instance of the monitor.
   /// \param socketPath the socket to connect to the multiprocess server.
   static std::unique_ptr<IMonitor> create(const std::string& socketPath);
@@ -71,6 +71,7 @@ enum class Class {
   SyncTime,
   IdentifyThread,
   MemoryStats,
+  CommandStats,
   COUNT
 };
 
@@ -112,7 +113,7 @@ public:
   Class getClass() const;
   TimePoint getTimeStamp() const;
   std::string getThreadId() const;
-  ExtraMetadata getExtras() const;
+  const ExtraMetadata& getExtras() const;
 
   std::thread::id getNumericThreadId() const;
 
@@ -207,7 +208,6 @@ private:
   template <typename T> std::optional<T> getExtra(std::string_view name) const;
 
   ExtraMetadata extra_;
-  std::string threadId_;
   TimePoint timeStamp_;
   Type type_;
   Class class_;
@@ -318,6 +318,18 @@ template <typename Archive> void serialize(Archive& ar, rt::DeviceProperties& pr
   } catch (cereal::Exception const&) {
     // Old traces may not contain these members
   }
+  try {
+    ar(cereal::make_nvp("max_concurrent_kernels", props.maxConcurrentKernels_));
+  } catch (cereal::Exception const&) {
+    // Old traces may not contain this member
+  }
+  try {
+    ar(cereal::make_nvp("dram_memshire_least_significant_bit", props.dramMemshireLSb_));
+    ar(cereal::make_nvp("dram_memshire_bits", props.dramMemshireBits_));
+    ar(cereal::make_nvp("dram_memshire_controller_bit", props.dramMemshireControllerBit_));
+  } catch (cereal::Exception const&) {
+    // Old traces may not contain these members
+  }
 }
 
 } // end namespace cereal
@@ -5,11 +5,14 @@
 #pragma once
 
 #include "IProfiler.h"
+#include "KernelSignature.h"
 #include "Types.h"
 #include <runtime/IRuntimeExport.h>
 
+#include <array>
 #include <chrono>
 #include <cstddef>
+#include <future>
 #include <memory>
 #include <ostream>
 #include <vector>
@@ -31,6 +34,9 @@ class IDeviceLayer;
 ///
 /// @{
 namespace rt {
+/// \brief MemoryPoolPtr is an alias for a pointer to a MemoryPool, see \ref IRuntime::createMemoryPool
+using MemoryPoolPtr = std::unique_ptr<class MemoryPool>;
+
 /// \brief Facade Runtime interface declaration, all runtime interactions should be made using this interface. There is
 /// a static method \ref create to make runtime instances (factory method)
 ///
@@ -69,15 +75,95 @@ public:
   ///
   void freeDevice(DeviceId device, std::byte* buffer);
 
+  /// \brief Deallocates previously allocated memory once all the work submitted to the stream so far has finished.
+  /// The call doesn't block; there is no need to \ref waitForStream before releasing buffers used by the stream.
+  /// Operations submitted to other streams must not be using the buffer.
+  ///
+  /// @param[in] stream the stream whose submitted work the free is ordered after; the buffer must be allocated in the
+  /// stream device
+  /// @param[in] buffer device memory pointer previously allocated with mallocDevice to be deallocated
+  ///
+  void freeDeviceAsync(StreamId stream, std::byte* buffer);
+
+  /// \brief Allocates device memory the runtime can move to compact the device memory (see \ref compactDeviceMemory),
+  /// so long running processes with varied allocation sizes don't end up failing big allocations while there is plenty
+  /// of free memory. The allocation is referred to by a handle, its current address is given by
+  /// \ref resolveDeviceHandle. The allocation is only moved by compactDeviceMemory and mallocDeviceHandle calls on the
+  /// same device, so handles must be resolved again after them, ie. when building the next memcpys or kernel launch
+  /// arguments. If the allocation doesn't fit, or the fragmentation is above Options::memoryCompactionThreshold_, the
+  /// device memory is compacted first.
+  ///
+  /// @param[in] device handler indicating in which device to allocate the memory
+  /// @param[in] size indicates the memory allocation size in bytes
+  /// @param[in] alignment indicates the required alignment for memory allocation, defaults to device cache line size
+  ///
+  /// @returns the handle of the allocation
+  ///
+  DeviceHandle mallocDeviceHandle(DeviceId device, size_t size, uint32_t alignment = kCacheLineSize);
+
+  /// \brief Deallocates memory previously allocated with \ref mallocDeviceHandle.
+  ///
+  /// @param[in] handle the allocation handle
+  ///
+  void freeDeviceHandle(DeviceHandle handle);
+
+  /// \brief Returns the current device address of an allocation done with \ref mallocDeviceHandle. It's valid till the
+  /// next \ref compactDeviceMemory or \ref mallocDeviceHandle call on the same device.
+  ///
+  /// @param[in] handle the allocation handle
+  ///
+  std::byte* resolveDeviceHandle(DeviceHandle handle) const;
+
+  /// \brief Compacts the device memory moving the allocations done with \ref mallocDeviceHandle down, with device to
+  /// device DMAs, so the free memory left between them is merged. Other allocations stay where they are. It's only
+  /// done if the device is idle, with no commands in flight on any stream; commands must not be submitted to the device
+  /// meanwhile. Blocks till the moves are done.
+  ///
+  /// @param[in] device handler indicating which device memory to compact
+  ///
+  /// @returns the number of allocations moved, 0 if the device was not idle
+  ///
+  size_t compactDeviceMemory(DeviceId device);
+
+  /// \brief Allocates managed device memory, which lets the device memory be oversubscribed. When a device allocation
+  /// doesn't fit, the content of the least recently used managed allocations is evicted to host memory (with device
+  /// to host DMAs) and their device memory released, till it fits. Evicted allocations are brought back to the device
+  /// by \ref prefetchManaged, which must be called with the allocations used by each kernel launch or memcpy before
+  /// issuing it. Like the ones of \ref mallocDeviceHandle, managed allocations are handles and they are released with
+  /// \ref freeDeviceHandle; their address (see \ref resolveDeviceHandle) changes after being evicted.
+  ///
+  /// @param[in] device handler indicating in which device to allocate the memory
+  /// @param[in] size indicates the memory allocation size in bytes
+  /// @param[in] alignment indicates the required alignment for memory allocation, defaults to device cache line size
+  ///
+  /// @returns the handle of the allocation
+  ///
+  DeviceHandle mallocManaged(DeviceId device, size_t size, uint32_t alignment = kCacheLineSize);
+
+  /// \brief Declares the managed allocations (see \ref mallocManaged) the next operations submitted to the stream use.
+  /// They become the most recently used ones, and the evicted ones are restored into the device with host to device
+  /// memcpys queued to the stream without barrier, so they overlap the previous kernel of the stream. The operations
+  /// using them must be issued with barrier, and their addresses resolved after this call. An allocation is only
+  /// evicted again once the work submitted to the stream of its last prefetch is done.
+  ///
+  /// @param[in] stream the stream of the operations using the allocations
+  /// @param[in] handles the managed allocations, all of them in the stream device
+  ///
+  void prefetchManaged(StreamId stream, const std::vector<DeviceHandle>& handles);
+
   /// \brief Creates a new stream and associates it to the given device. A stream is an abstraction of a "pipeline"
   /// where you can push operations (mem copies or kernel launches) and enforce the dependencies between these
   /// operations
   ///
   /// @param[in] device handler indicating in which device to associate the stream
+  /// @param[in] priority High priority streams are placed on a submission queue reserved for them, which the device
+  /// also services first when assigning DMA channels, kernel slots and shires: their kernels are launched ahead of the
+  /// ones of Normal priority streams waiting for the same resources. This way latency-critical work doesn't sit behind
+  /// big batch operations submitted through Normal priority streams. See \ref StreamPriority
   ///
   /// @returns a stream handler
   ///
-  StreamId createStream(DeviceId device);
+  StreamId createStream(DeviceId device, StreamPriority priority = StreamPriority::Normal);
 
   /// \brief Destroys a previously created stream
   ///
@@ -86,6 +172,83 @@ public:
   ///
   void destroyStream(StreamId stream);
 
+  /// \brief Creates a group of devices for data-parallel work. The runtime creates one stream per member device, and
+  /// \ref launchOnGroup, \ref scatter and \ref gather submit to all of them from one call, returning a single group
+  /// event which is dispatched once the work of every device is done. Group events don't belong to any stream: streams
+  /// waiting for them (see \ref streamWaitEvent) resolve the dependency in the host, and \ref getEventTiming doesn't
+  /// know them.
+  ///
+  /// @param[in] devices the member devices, without repetitions; shards are assigned to them in this order
+  /// @param[in] priority the priority of the group streams, see \ref StreamPriority
+  ///
+  /// @returns a device group handler
+  ///
+  DeviceGroupId createDeviceGroup(const std::vector<DeviceId>& devices,
+                                  StreamPriority priority = StreamPriority::Normal);
+
+  /// \brief Destroys a device group and its streams, once the work submitted to them is done
+  ///
+  /// @param[in] group handler to the group to be destroyed
+  ///
+  void destroyDeviceGroup(DeviceGroupId group);
+
+  /// \brief Returns the stream of a device group in one of its devices, ie. to submit more work after the group
+  /// operations or to retrieve their errors (see \ref retrieveStreamErrors)
+  ///
+  /// @param[in] group the device group
+  /// @param[in] device one of the devices of the group
+  ///
+  StreamId getDeviceGroupStream(DeviceGroupId group, DeviceId device) const;
+
+  /// \brief Returns the devices of a device group, in the order they were given to \ref createDeviceGroup
+  ///
+  /// @param[in] group the device group
+  ///
+  std::vector<DeviceId> getDeviceGroupDevices(DeviceGroupId group) const;
+
+  /// \brief Launches a kernel on every device of the group, see \ref kernelLaunch
+  ///
+  /// @param[in] group the device group
+  /// @param[in] kernels the kernel launched on each device, in the order of the group devices (kernels are loaded per
+  /// device, see \ref loadCode)
+  /// @param[in] kernelArgs the arguments of each launch, in the order of the group devices, or a single one used by all
+  /// of them
+  /// @param[in] kernelLaunchOptions the launch options, the same for all the devices
+  ///
+  /// @returns the group event, dispatched once all the launches are completed
+  ///
+  EventId launchOnGroup(DeviceGroupId group, const std::vector<KernelId>& kernels,
+                        const std::vector<std::vector<std::byte>>& kernelArgs,
+                        const KernelLaunchOptions& kernelLaunchOptions = KernelLaunchOptions());
+
+  /// \brief Copies consecutive shards of a host buffer to the devices of the group: the device i of the group receives
+  /// the shardSize bytes at h_src + i * shardSize. See \ref memcpyHostToDevice
+  ///
+  /// @param[in] group the device group
+  /// @param[in] h_src host buffer holding a shard per device
+  /// @param[in] d_dsts destination device buffer of each device, in the order of the group devices
+  /// @param[in] shardSize bytes copied to each device
+  /// @param[in] barrier if true, the copies wait for the work previously submitted to the group streams
+  ///
+  /// @returns the group event, dispatched once all the copies are completed
+  ///
+  EventId scatter(DeviceGroupId group, const std::byte* h_src, const std::vector<std::byte*>& d_dsts, size_t shardSize,
+                  bool barrier = false);
+
+  /// \brief Copies a shard from each device of the group to consecutive locations of a host buffer: the shardSize bytes
+  /// of the device i of the group go to h_dst + i * shardSize. See \ref memcpyDeviceToHost
+  ///
+  /// @param[in] group the device group
+  /// @param[in] d_srcs source device buffer of each device, in the order of the group devices
+  /// @param[in] h_dst host buffer receiving a shard per device
+  /// @param[in] shardSize bytes copied from each device
+  /// @param[in] barrier if true, the copies wait for the work previously submitted to the group streams
+  ///
+  /// @returns the group event, dispatched once all the copies are completed
+  ///
+  EventId gather(DeviceGroupId group, const std::vector<const std::byte*>& d_srcs, std::byte* h_dst, size_t shardSize,
+                 bool barrier = true);
+
   /// \brief Loads an elf into the device. The caller will provide a byte code containing the elf representation and its
   /// size. Host memory.
   /// @param[in] stream handler indicating the stream used for the kernel loading.
@@ -120,6 +283,26 @@ public:
   EventId kernelLaunch(StreamId stream, KernelId kernel, const std::byte* kernel_args, size_t kernel_args_size,
                        const KernelLaunchOptions& kernelLaunchOptions = KernelLaunchOptions());
 
+  /// \brief Typed kernel launch: the arguments are packed like the members of a C struct declared in the same order
+  /// (see \ref runtime_kernel_signature) and checked against the signature the kernel elf declares with
+  /// \ref ET_KERNEL_SIGNATURE; throws an \ref Exception if they don't match. Kernels without signature are launched
+  /// unchecked. Arguments must be trivially copyable; device buffers are passed as pointers.
+  ///
+  /// @param[in] stream handler indicating in which stream the kernel will be executed
+  /// @param[in] kernel handler which indicate what code to execute in the device
+  /// @param[in] shireMask indicates in what shires the kernel will be executed
+  /// @param[in] args the kernel arguments
+  ///
+  template <typename... Args>
+  EventId kernelLaunch(StreamId stream, KernelId kernel, uint64_t shireMask, const Args&... args) {
+    constexpr auto size = kernelArgsSize<Args...>();
+    std::array<std::byte, (size > 0 ? size : 1)> buffer{};
+    packKernelArgs(buffer.data(), args...);
+    KernelLaunchOptions options;
+    options.setShireMask(shireMask);
+    return kernelLaunchSigned(stream, kernel, kernelSignature<Args...>(), buffer.data(), size, options);
+  }
+
   /// \deprecated See kernelLaunch using KernelLaunchOptions
   ///
   /// @param[in] stream handler indicating in which stream the kernel will be executed. The kernel code have to be
@@ -149,6 +332,23 @@ public:
                        std::optional<UserTrace> userTraceConfig = std::nullopt,
                        const std::string& coreDumpFilePath = "");
 
+  /// \brief Queues the execution of several kernels together, each one on its own shires; e.g. models running side by
+  /// side, each on its own shire partition. The firmware dispatches all of them from a single command and sends a
+  /// single response once they all complete, so the whole launch is a single event. The kernel arguments must already
+  /// be in device memory. Only \ref DeviceProperties::maxConcurrentKernels_ kernels run at the same time, the others
+  /// are launched as the previous ones complete.
+  ///
+  /// @param[in] stream handler indicating in which stream the kernels will be executed. The kernels have to be
+  /// registered into the device associated to the stream previously.
+  /// @param[in] launches kernels to execute, from 1 to device_ops_ext::kKernelMultiLaunchMax, with disjoint shire masks
+  /// @param[in] barrier this parameter indicates if the kernels execution should be postponed till all previous works
+  /// issued into this stream finish (a barrier).
+  ///
+  /// @returns EventId is a handler of an event which can be waited for (waitForEventId) to synchronize when all the
+  /// kernels end the execution. If any of them fails, the stream error carries its error code.
+  ///
+  EventId kernelLaunchMulti(StreamId stream, const std::vector<LaunchDesc>& launches, bool barrier = true);
+
   /// \brief Queues a memcpy operation from host memory to device memory. The device memory must be previously
   /// allocated by a mallocDevice.
   ///
@@ -192,6 +392,88 @@ public:
   EventId memcpyDeviceToHost(StreamId stream, const std::byte* d_src, std::byte* h_dst, size_t size,
                              bool barrier = true, const CmaCopyFunction& cmaCopyFunction = defaultCmaCopyFunction);
 
+  /// \brief Queues a memcpy of fp32 host values to device memory, converted to a narrower device element type while
+  /// they are copied into the CMA buffers; so there is a single host pass and the PCIe traffic is the device size. The
+  /// memcpy always goes through the CMA buffers, even if the host memory is registered. It can't be captured.
+  ///
+  /// @param[in] stream handler indicating in which stream to queue the memcpy operation
+  /// @param[in] h_src host memory buffer holding count fp32 values
+  /// @param[in] d_dst device memory buffer to copy to, it receives count elements of the conversion type
+  /// @param[in] count number of elements to copy
+  /// @param[in] conversion see \ref MemcpyConversion
+  /// @param[in] barrier see memcpyHostToDevice
+  ///
+  /// @returns EventId is a handler of an event which can be waited for (waitForEventId) to synchronize when the memcpy
+  /// ends.
+  ///
+  /// NOTE: the host memory pointer must be kept alive until the operation has completely ended in device.
+  ///
+  EventId memcpyHostToDeviceConverted(StreamId stream, const float* h_src, std::byte* d_dst, size_t count,
+                                      const MemcpyConversion& conversion, bool barrier = false);
+
+  /// \brief Queues a memcpy of device elements to fp32 host values, converted while they are copied out of the CMA
+  /// buffers. The reverse of memcpyHostToDeviceConverted.
+  ///
+  /// @param[in] stream handler indicating in which stream to queue the memcpy operation
+  /// @param[in] d_src device memory buffer holding count elements of the conversion type
+  /// @param[in] h_dst host memory buffer to copy to, it receives count fp32 values
+  /// @param[in] count number of elements to copy
+  /// @param[in] conversion see \ref MemcpyConversion
+  /// @param[in] barrier see memcpyDeviceToHost
+  ///
+  /// @returns EventId is a handler of an event which can be waited for (waitForEventId) to synchronize when the memcpy
+  /// ends.
+  ///
+  /// NOTE: the host memory pointer must be kept alive until the operation has completely ended in device.
+  ///
+  EventId memcpyDeviceToHostConverted(StreamId stream, const std::byte* d_src, float* h_dst, size_t count,
+                                      const MemcpyConversion& conversion, bool barrier = true);
+
+  /// \brief Queues a memcpy of LZ4 compressed host data to device memory, decompressed by the device; so the PCIe
+  /// traffic is the compressed size. The chunks are DMA'd into a device staging area in batches, and each batch is
+  /// expanded by the decompression kernel while the next one is transferred. The decompressed chunks are written one
+  /// after the other from d_dst. Chunks of about 1MB or more keep the transfers efficient, and there should be more
+  /// of them than harts in the shire mask to use all of them. The decompression kernels are launched with a barrier,
+  /// so the memcpy is ordered after all the work queued in the stream before. The runtime loads the lz4_decompress
+  /// kernel itself the first time it's used on a device (see ET_RUNTIME_KERNELS_DIR), that first call blocks till it's
+  /// loaded. It can't be captured.
+  ///
+  /// @param[in] stream handler indicating in which stream to queue the memcpy operation
+  /// @param[in] chunks the compressed blocks, see \ref CompressedChunk
+  /// @param[in] d_dst device memory buffer to decompress to, it must hold the sum of the decompressed sizes
+  /// @param[in] shireMask the shires running the decompression kernel
+  ///
+  /// @returns EventId is a handler of an event which can be waited for (waitForEventId) to synchronize when the memcpy
+  /// ends. A corrupted chunk, or one whose decompressed size is not the expected one, fails the kernel.
+  ///
+  /// NOTE: the compressed host memory must be kept alive until the operation has completely ended in device.
+  ///
+  EventId memcpyHostToDeviceCompressed(StreamId stream, const std::vector<CompressedChunk>& chunks, std::byte* d_dst,
+                                       uint64_t shireMask);
+
+  /// \brief Queues a memcpy from host memory to device memory whose integrity is checked in the device, without reading
+  /// the data back. The host computes the CRC32 of each 1MiB chunk of the source while staging it for the DMA, and the
+  /// crc32_check kernel, launched with a barrier after the copy, computes them again from the device memory in parallel
+  /// over the harts of the shire mask. Once it's done, the device CRCs (4 bytes per chunk) are read back and compared
+  /// in stream order; a difference is reported as a DeviceErrorCode::MemcpyChecksumMismatch stream error on the
+  /// returned event. The runtime loads the kernel itself the first time it's used on a device (see
+  /// ET_RUNTIME_KERNELS_DIR), that first call blocks till it's loaded. It can't be captured.
+  ///
+  /// @param[in] stream handler indicating in which stream to queue the memcpy operation
+  /// @param[in] h_src host memory buffer to copy from
+  /// @param[in] d_dst device memory buffer to copy to, it must be 8 bytes aligned
+  /// @param[in] size indicates the size of the memcpy
+  /// @param[in] shireMask the shires running the check kernel
+  /// @param[in] barrier see memcpyHostToDevice
+  ///
+  /// @returns EventId is a handler of an event which can be waited for (waitForEventId) to synchronize when the memcpy
+  /// and its check end.
+  ///
+  /// NOTE: the host memory pointer must be kept alive until the operation has completely ended in device.
+  ///
+  EventId memcpyHostToDeviceChecked(StreamId stream, const std::byte* h_src, std::byte* d_dst, size_t size,
+                                    uint64_t shireMask, bool barrier = false);
+
   /// \brief Queues many memcpy operations from host memory to device memory. These operations are defined in struct
   /// \ref MemcpyList. The device memory must be a valid region previously allocated by a mallocDevice; the host memory
   /// must be a previously allocated memory in the host by the conventional means (for example the heap).
@@ -230,6 +512,36 @@ public:
   EventId memcpyDeviceToHost(StreamId stream, MemcpyList memcpyList, bool barrier = true,
                              const CmaCopyFunction& cmaCopyFunction = defaultCmaCopyFunction);
 
+  /// \brief Queues many memcpy operations from host memory to device memory as a single DMA chain. The list is staged
+  /// in a CMA buffer, and its DMA elements are uploaded to the device and run by a single DMA channel, whatever their
+  /// number; so a list of many small operations costs a couple of DMA commands instead of one every few hundred
+  /// operations. The operations are split at the max DMA element size, and the list can take up to
+  /// device_ops_ext::kMaxDmaChainElems DMA elements. The chain waits for its upload with a barrier, so the memcpy is
+  /// ordered after all the work queued in the stream before. It can't be captured.
+  ///
+  /// @param[in] stream handler indicating in which stream to queue the memcpy operation
+  /// @param[in] memcpyList contains all the operations required. See \ref MemcpyList
+  ///
+  /// @returns EventId is a handler of an event which can be waited for (waitForEventId) to synchronize when the memcpy
+  /// ends.
+  ///
+  /// NOTE: the host memory pointers must be kept alive until the operation has completely ended in device.
+  ///
+  EventId memcpyHostToDeviceChained(StreamId stream, MemcpyList memcpyList);
+
+  /// \brief Queues many memcpy operations from device memory to host memory as a single DMA chain. The reverse of
+  /// memcpyHostToDeviceChained.
+  ///
+  /// @param[in] stream handler indicating in which stream to queue the memcpy operation
+  /// @param[in] memcpyList contains all the operations required. See \ref MemcpyList
+  ///
+  /// @returns EventId is a handler of an event which can be waited for (waitForEventId) to synchronize when the memcpy
+  /// ends.
+  ///
+  /// NOTE: the host memory pointers must be kept alive until the operation has completely ended in device.
+  ///
+  EventId memcpyDeviceToHostChained(StreamId stream, MemcpyList memcpyList);
+
   /// \brief Queues a device to device memcpy operation. The source device will be the corresponding to streamSrc, the
   /// destination device is provided in deviceDst. The device memory must be a valid region previously allocated by a
   /// mallocDevice, in both devices. The operation will be queued into the source device, hence it can be synced using
@@ -270,6 +582,60 @@ public:
   EventId memcpyDeviceToDevice(DeviceId deviceSrc, StreamId streamDst, const std::byte* d_src, std::byte* d_dst,
                                size_t size, bool barrier = true);
 
+  /// \brief Queues a memcpy operation between two buffers of the device of the stream. The copy is executed by the
+  /// device, the data doesn't go through the host nor through PCIe, and it is ordered within the stream like any other
+  /// operation. The buffers can overlap. The P2P memcpyDeviceToDevice operations also end here when both devices are
+  /// the same.
+  ///
+  /// @param[in] stream handler indicating in which stream to queue the memcpy operation.
+  /// @param[in] d_src device memory buffer to copy from.
+  /// @param[in] d_dst device memory buffer to copy to.
+  /// @param[in] size indicates the size of the memcpy.
+  /// @param[in] barrier this parameter indicates if the memcpy operation should be postponed till all previous works
+  /// issued into this stream finish (a barrier).
+  /// @returns EventId is a handler of an event which can be waited for (waitForEventId) to synchronize when the memcpy
+  /// ends.
+  ///
+  EventId memcpyDeviceToDevice(StreamId stream, const std::byte* d_src, std::byte* d_dst, size_t size,
+                               bool barrier = true);
+
+  /// \brief Queues an operation setting size bytes of device memory to value. The memory is filled by the device
+  /// itself, there is no host staging nor PCIe traffic. It is ordered within the stream like any other operation.
+  ///
+  /// @param[in] stream handler indicating in which stream to queue the operation.
+  /// @param[in] d_dst device memory buffer to fill, it must be a valid region previously allocated by a mallocDevice.
+  /// @param[in] value byte value stored in each of the bytes.
+  /// @param[in] size number of bytes to set.
+  /// @param[in] barrier this parameter indicates if the operation should be postponed till all previous works issued
+  /// into this stream finish (a barrier).
+  /// @returns EventId is a handler of an event which can be waited for (waitForEventId) to synchronize when the memory
+  /// has been set.
+  ///
+  EventId memsetDevice(StreamId stream, std::byte* d_dst, uint8_t value, size_t size, bool barrier = false);
+
+  /// \brief Like \ref memsetDevice, but repeating a pattern of patternSize bytes (1, 2, 4 or 8, taken from the least
+  /// significant bytes of pattern) instead of a single byte. d_dst must be aligned to patternSize and size must be a
+  /// multiple of it.
+  ///
+  EventId fillDevice(StreamId stream, std::byte* d_dst, uint64_t pattern, size_t patternSize, size_t size,
+                     bool barrier = false);
+
+  /// \brief Queues an operation setting the kernel heap of the device: a region kernels allocate scratch memory from,
+  /// with et_heap_alloc (etsoc/common/heap.h), when its size is only known on the device. The region is split in an
+  /// arena per compute shire, which is emptied after each kernel. The heap is kept until set again; it must not be
+  /// changed nor freed while kernels are running.
+  ///
+  /// @param[in] stream handler indicating in which stream to queue the operation.
+  /// @param[in] d_heap device memory buffer of the heap, it must be a valid region previously allocated by a
+  /// mallocDevice. nullptr disables the heap.
+  /// @param[in] size size of the heap, at least 10KB (device_ops_ext::kKernelHeapMinSize). 0 disables the heap.
+  /// @param[in] barrier this parameter indicates if the operation should be postponed till all previous works issued
+  /// into this stream finish (a barrier).
+  /// @returns EventId is a handler of an event which can be waited for (waitForEventId) to synchronize when the heap
+  /// has been set.
+  ///
+  EventId setKernelHeap(StreamId stream, std::byte* d_heap, size_t size, bool barrier = true);
+
   /// \brief This will block the caller thread until the given event is dispatched or the timeout is reached. This
   /// primitive allows to synchronize with the device execution.
   ///
@@ -293,6 +659,109 @@ public:
   ///
   bool waitForStream(StreamId stream, std::chrono::seconds timeout = std::chrono::hours(24));
 
+  /// \brief Makes all the work submitted to the stream after this call wait till the given event has completed. The
+  /// dependency is resolved in the device: the event stream signals once its previous commands are done and the
+  /// waiting stream submission queue is held till then, so there is no host round-trip between both. Because of this
+  /// the wait holds the whole submission queue, which could be shared with other streams.
+  /// If the event has already completed nothing is submitted.
+  ///
+  /// @param[in] stream the stream which will wait.
+  /// @param[in] event the event to wait for; it has to belong to a stream of the same device.
+  ///
+  /// @returns EventId which completes once the dependency is satisfied.
+  ///
+  EventId streamWaitEvent(StreamId stream, EventId event);
+
+  /// \brief Runs a host function in stream order: once the work previously submitted to the stream has completed, and
+  /// before any work submitted after this call is sent to the device. The caller doesn't block; the function is run by
+  /// the callback executor (see setCallbackExecutor) and the following commands are queued in the host meanwhile.
+  /// Like streamWaitEvent, this holds the whole submission queue, which could be shared with other streams. The
+  /// function runs even if previous commands failed, see retrieveStreamErrors. Exceptions thrown by the function are
+  /// logged and discarded. It must not wait for work submitted to the same stream after it, that would never complete.
+  ///
+  /// @param[in] stream the stream which orders the function.
+  /// @param[in] func the host function to run. Can't be empty.
+  ///
+  /// @returns EventId which completes once the function has returned.
+  ///
+  EventId launchHostFunc(StreamId stream, HostFunc func);
+
+  /// \brief Registers a callback which will be called once the given event has completed, without blocking the
+  /// caller. If the event has already completed, the callback is called right away (but asynchronously too). Errors are
+  /// not reported through this callback, see setOnStreamErrorsCallback and retrieveStreamErrors.
+  ///
+  /// @param[in] event the event to be notified about.
+  /// @param[in] callback see \ref rt::EventCompletionCallback. It is run by the callback executor, see
+  /// setCallbackExecutor.
+  ///
+  void onEventComplete(EventId event, EventCompletionCallback callback);
+
+  /// \brief Returns a future which becomes ready once the given event has completed. It's implemented on top of
+  /// onEventComplete, so it doesn't keep any thread blocked.
+  ///
+  /// @param[in] event the event to be notified about.
+  ///
+  /// @returns std::future<void> ready once the event has completed.
+  ///
+  std::future<void> getEventFuture(EventId event);
+
+  /// \brief Returns the device side timing of a completed kernel launch or DMA command: when the device started it, how
+  /// long it waited and how long it was executing, in device cycles. Unlike the profiler, it doesn't need tracing to be
+  /// enabled. Event ids wrap around, so the timing is only kept till the event id is reused by a later command.
+  ///
+  /// @param[in] event the event returned by the kernel launch or memcpy.
+  ///
+  /// @returns the timing of the command, or std::nullopt if the event has not completed yet, didn't come from a kernel
+  /// launch or memcpy, or is too old.
+  ///
+  std::optional<EventTiming> getEventTiming(EventId event);
+
+  /// \brief Returns the power and thermal state of the device while a kernel ran: its Minion frequency and the
+  /// power/thermal throttle events of the device service processor, which explain kernels running slower than usual.
+  /// Only kernels launched with \ref KernelLaunchOptions::setPowerReport have it. The report is received right after
+  /// the kernel completes, so it's always available once a later command of the stream completed (ie. after \ref
+  /// waitForStream). Like the timing, it's only kept till the event id is reused by a later kernel launch.
+  ///
+  /// @param[in] event the event returned by the kernel launch.
+  ///
+  /// @returns the power state, or std::nullopt if its report was not received yet, the launch had no report or it
+  /// failed.
+  ///
+  std::optional<KernelPowerState> getEventPowerState(EventId event);
+
+  /// \brief Caps the shires used at once by the kernels launched with \ref KernelLaunchOptions::setShireCount in a
+  /// device: launches which would go over the budget wait for the previous kernels to complete, as when there are not
+  /// enough free shires. Running fewer shires lowers the power drawn by the device, so a caller seeing throttled
+  /// kernels can degrade gracefully instead of hitting the frequency drops of the device thermal management. A kernel
+  /// needing more shires than the budget runs alone. The kernels launched with an explicit shire mask are not limited.
+  ///
+  /// @param[in] device the device to limit.
+  /// @param[in] maxActiveShires the budget in shires, 0 removes it.
+  ///
+  void setShireBudget(DeviceId device, int maxActiveShires);
+
+  /// \brief Returns the shire budget of a device, 0 if it has none. See \ref setShireBudget
+  int getShireBudget(DeviceId device) const;
+
+  /// \brief Sets a policy adjusting the shire budgets from the power reports (see \ref
+  /// KernelLaunchOptions::setPowerReport): it's called with every report received and its result becomes the budget of
+  /// the device, ie. lowering it while the kernels are being throttled and raising it back once they are not. The
+  /// policy runs in the runtime response thread, so it must be fast and not call the runtime but for \ref
+  /// getShireBudget.
+  ///
+  /// @param[in] policy see \ref rt::ShireBudgetPolicy; an empty one leaves the budgets as they are.
+  ///
+  void setShireBudgetPolicy(ShireBudgetPolicy policy);
+
+  /// \brief Sets the executor which will run the onEventComplete callbacks, ie. a function posting them to an
+  /// asio::io_context, so they are delivered into the caller event loop. It only applies to the callbacks registered
+  /// afterwards. If not set (or set to nullptr) callbacks are run by an internal runtime thread, so they should not
+  /// block for long.
+  ///
+  /// @param[in] executor see \ref rt::CallbackExecutor.
+  ///
+  void setCallbackExecutor(CallbackExecutor executor);
+
   /// \brief This will return a list of errors and their execution context (if any)
   ///
   /// @param[in] stream this is the stream to synchronize with.
@@ -380,6 +849,152 @@ public:
   ///
   bool isP2PEnabled(DeviceId one, DeviceId other) const;
 
+  /// \brief Registers a host memory range to be used in memcpy operations with given device. Memcpys whose host memory
+  /// is fully contained in a registered range are done by the DMA engine directly from/to that memory, skipping the
+  /// intermediate copies through the CMA buffers. This is intended for big host buffers used in many memcpys (for
+  /// example, model weights). If the device can't access the host memory directly, the memcpys will keep using the
+  /// regular path.
+  ///
+  /// @param[in] device the device which will do memcpys from/to the host memory.
+  /// @param[in] h_ptr start of the host memory range.
+  /// @param[in] size size in bytes of the host memory range.
+  /// @param[in] toDeviceOnly true if the host memory is only used as source of host to device memcpys. It's then
+  /// registered without write access, so read-only memory (for example, a read-only mapped file) can be registered;
+  /// device to host memcpys into it keep using the regular path.
+  ///
+  /// NOTE: the host memory must be kept alive until it's unregistered through \ref unregisterHostBuffer.
+  ///
+  void registerHostBuffer(DeviceId device, const std::byte* h_ptr, size_t size, bool toDeviceOnly = false);
+
+  /// \brief Unregisters a host memory range previously registered through \ref registerHostBuffer. There must not be
+  /// pending memcpys using this memory.
+  ///
+  /// @param[in] device the device where the host memory was registered.
+  /// @param[in] h_ptr start of the host memory range, as given to \ref registerHostBuffer.
+  ///
+  void unregisterHostBuffer(DeviceId device, const std::byte* h_ptr);
+
+  /// \brief Allocates host memory already registered to be used in memcpy operations with given device (see
+  /// \ref registerHostBuffer). When running through the server the memory is shared with it, so memcpys from/to this
+  /// memory are not copied across processes either; this is the preferred way to stage host data in multiprocess mode.
+  ///
+  /// @param[in] device the device which will do memcpys from/to the host memory.
+  /// @param[in] size size in bytes of the host memory; it will be rounded up to the page size.
+  ///
+  /// @returns a pointer to the allocated host memory, page aligned.
+  ///
+  /// NOTE: the host memory must be released through \ref freeHostBuffer before destroying the runtime.
+  ///
+  std::byte* allocHostBuffer(DeviceId device, size_t size);
+
+  /// \brief Releases host memory allocated through \ref allocHostBuffer. There must not be pending memcpys using this
+  /// memory.
+  ///
+  /// @param[in] device the device given to \ref allocHostBuffer.
+  /// @param[in] h_ptr the pointer returned by \ref allocHostBuffer.
+  ///
+  void freeHostBuffer(DeviceId device, std::byte* h_ptr);
+
+  /// \brief Enables or disables memcpy coalescing on \p stream. While enabled, small host to device or device to host
+  /// memcpys issued without barrier are not submitted right away; consecutive memcpys in the same direction are merged
+  /// into a single DMA list command, which saves the per-command overhead of many tiny transfers. The merged command is
+  /// submitted once it's full, when any other operation is issued to the stream, or when the stream or any of its
+  /// events is waited for. Each memcpy keeps its own event, completed along with the merged command; device errors of
+  /// the merged command are reported with its own event instead. Disabling the coalescing submits the pending memcpys.
+  ///
+  /// @param[in] stream the stream to configure.
+  /// @param[in] enabled true to merge small memcpys, false to submit each memcpy on its own (default).
+  ///
+  void setMemcpyCoalescing(StreamId stream, bool enabled);
+
+  /// \brief Enables or disables request batching. Only meaningful for runtimes connected to a server (see
+  /// \ref create(const std::string&)), which otherwise wait for the server to answer each call. While enabled, memcpys
+  /// and kernel launches return right away with an event assigned by the client, and their requests are queued to be
+  /// sent along with the following ones in a single message. The queue is sent when it's big enough, when any other
+  /// call needs an answer from the server, when an event or stream is waited for, or through \ref flushRequests.
+  /// Errors raised by the server for a batched request complete its event and are thrown by the next
+  /// \ref waitForEvent, \ref waitForStream or \ref flushRequests call.
+  ///
+  /// @param[in] enabled true to batch requests, false to send each request and wait for its answer (default).
+  ///
+  void setRequestBatching(bool enabled);
+
+  /// \brief Sends the requests queued by request batching (see \ref setRequestBatching) right away, without waiting for
+  /// them to be processed. Throws the error of any batched request which failed meanwhile.
+  ///
+  void flushRequests();
+
+  /// \brief Sets the output the MasterMinion firmware trace of \p device is drained to. The MasterMinion logs into one
+  /// half of its trace buffer while the other one is drained by DMA in the background, so long traced runs don't drop
+  /// events. Each drained half is appended to \p output as a standalone trace buffer (see et-trace layout.h), in the
+  /// order they were filled. The firmware keeps wrapping the half it logs into while nothing drains the other one.
+  ///
+  /// @param[in] device handler indicating which device trace to drain
+  /// @param[in] output stream the drained buffers are appended to, it must outlive the runtime. nullptr stops draining
+  ///
+  void setMasterMinionTraceOutput(DeviceId device, std::ostream* output);
+
+  /// \brief Reserves \p size bytes of device memory (a single \ref mallocDevice) and returns a \ref MemoryPool to
+  /// sub-allocate from it. Pool allocations and resets are served in the host, without calling the runtime, so a loop
+  /// which resets the pool once per iteration doesn't do any allocator call in steady state. The reservation is
+  /// released when the pool is destroyed; the pool must not outlive the runtime.
+  ///
+  /// @param[in] device handler indicating in which device to reserve the memory
+  /// @param[in] size size in bytes of the reservation
+  /// @param[in] alignment alignment of the reservation, defaults to device cache line size
+  ///
+  /// @returns a MemoryPool backed by the reservation
+  ///
+  MemoryPoolPtr createMemoryPool(DeviceId device, size_t size, uint32_t alignment = kCacheLineSize);
+
+  /// \brief Starts capturing the commands issued to \p stream into a command graph. While capturing, kernel launches
+  /// and memcpys on the stream are not executed; they are built once and recorded in the graph, which can be replayed
+  /// many times through \ref launchGraph resubmitting the same device commands. The events returned by captured
+  /// operations are already completed. Only memcpys from/to registered host buffers (see \ref registerHostBuffer) and
+  /// device to device memcpys can be captured; other memcpys throw an \ref Exception.
+  ///
+  /// @param[in] stream the stream to capture, it must not be already capturing
+  ///
+  void beginCapture(StreamId stream);
+
+  /// \brief Finishes the capture started by \ref beginCapture. Kernel arguments too big to be embedded in the launch
+  /// command are uploaded to the device once, here.
+  ///
+  /// @param[in] stream the stream being captured
+  ///
+  /// @returns GraphId a handler to the captured graph
+  ///
+  GraphId endCapture(StreamId stream);
+
+  /// \brief Uploads the commands of a captured graph to device memory, once. From then on \ref launchGraph submits a
+  /// single command and MasterMinion replays the graph commands from device memory, one after the other, so the
+  /// submission cost doesn't depend on the graph size. Only kernel launches, memcpys, memsets and kernel flush ranges
+  /// can be uploaded; graphs with other commands throw an \ref Exception.
+  ///
+  /// @param[in] stream the stream used to upload the commands; must belong to the device where the graph was captured
+  /// @param[in] graph the graph to upload, it must not be already uploaded
+  ///
+  void uploadGraph(StreamId stream, GraphId graph);
+
+  /// \brief Submits all the commands of a captured graph to \p stream, in capture order. The kernels used by the
+  /// graph must remain loaded and the memory used by its commands must remain allocated (and the host buffers
+  /// registered) as long as the graph is launched.
+  ///
+  /// @param[in] stream the stream to submit the commands to; must belong to the device where the graph was captured
+  /// @param[in] graph the graph to launch
+  /// @param[in] patches words of the embedded kernel arguments replaced only for this launch. Only for graphs uploaded
+  /// with \ref uploadGraph, up to device_ops_ext::kCmdListPatchesMax
+  ///
+  /// @returns EventId is the event which will be dispatched once all the graph commands are completed
+  ///
+  EventId launchGraph(StreamId stream, GraphId graph, const std::vector<GraphArgPatch>& patches = {});
+
+  /// \brief Releases a graph captured through \ref endCapture. There must not be pending launches of the graph.
+  ///
+  /// @param[in] graph the graph to destroy
+  ///
+  void destroyGraph(GraphId graph);
+
   /// \brief Virtual Destructor to enable polymorphic release of the runtime instances
   virtual ~IRuntime();
   ///
@@ -411,6 +1026,10 @@ public:
 private:
   std::unique_ptr<profiling::IProfilerRecorder> profiler_;
 
+  // launch of the typed kernelLaunch, once the arguments are packed
+  EventId kernelLaunchSigned(StreamId stream, KernelId kernel, uint64_t signature, const std::byte* kernel_args,
+                             size_t kernel_args_size, const KernelLaunchOptions& kernelLaunchOptions);
+
   // NVI applied, all public interface is non-virtual; customization is in the private part
   virtual std::vector<DeviceId> doGetDevices() = 0;
 
@@ -421,8 +1040,9 @@ private:
 
   virtual std::byte* doMallocDevice(DeviceId device, size_t size, uint32_t alignment = kCacheLineSize) = 0;
   virtual void doFreeDevice(DeviceId device, std::byte* buffer) = 0;
+  virtual void doFreeDeviceAsync(StreamId stream, std::byte* buffer) = 0;
 
-  virtual StreamId doCreateStream(DeviceId device) = 0;
+  virtual StreamId doCreateStream(DeviceId device, StreamPriority priority) = 0;
   virtual void doDestroyStream(StreamId stream) = 0;
 
   virtual EventId doKernelLaunch(StreamId stream, KernelId kernel, const std::byte* kernel_args,
@@ -454,6 +1074,12 @@ private:
 
   virtual void doSetOnKernelAbortedErrorCallback(const KernelAbortedCallback& callback) = 0;
 
+  virtual void doOnEventComplete(EventId event, EventCompletionCallback callback) = 0;
+
+  virtual std::optional<EventTiming> doGetEventTiming(EventId event) = 0;
+
+  virtual void doSetCallbackExecutor(CallbackExecutor executor) = 0;
+
   virtual std::vector<StreamError> doRetrieveStreamErrors(StreamId stream) = 0;
 
   virtual DmaInfo doGetDmaInfo(DeviceId deviceId) const = 0;
@@ -463,6 +1089,224 @@ private:
   virtual bool doIsP2PEnabled(DeviceId, DeviceId) const {
     return false;
   }
+
+  virtual void doRegisterHostBuffer(DeviceId, const std::byte*, size_t, bool) { /* defaults do nothing */
+  }
+
+  virtual void doUnregisterHostBuffer(DeviceId, const std::byte*) { /* defaults do nothing */
+  }
+
+  virtual std::byte* doAllocHostBuffer(DeviceId, size_t) {
+    throw Exception("Host buffers are not supported by this runtime");
+  }
+
+  virtual void doFreeHostBuffer(DeviceId, std::byte*) {
+    throw Exception("Host buffers are not supported by this runtime");
+  }
+
+  virtual void doBeginCapture(StreamId) {
+    throw Exception("Command graphs are not supported by this runtime");
+  }
+
+  virtual GraphId doEndCapture(StreamId) {
+    throw Exception("Command graphs are not supported by this runtime");
+  }
+
+  virtual void doUploadGraph(StreamId, GraphId) {
+    throw Exception("Command graphs are not supported by this runtime");
+  }
+
+  virtual EventId doLaunchGraph(StreamId, GraphId, const std::vector<GraphArgPatch>&) {
+    throw Exception("Command graphs are not supported by this runtime");
+  }
+
+  virtual void doDestroyGraph(GraphId) {
+    throw Exception("Command graphs are not supported by this runtime");
+  }
+
+  virtual void doSetMemcpyCoalescing(StreamId, bool) { /* defaults do nothing */
+  }
+
+  virtual void doSetRequestBatching(bool) { /* defaults do nothing */
+  }
+
+  virtual void doFlushRequests() { /* defaults do nothing */
+  }
+
+  virtual EventId doStreamWaitEvent(StreamId, EventId) {
+    throw Exception("Device side stream waits are not supported by this runtime");
+  }
+
+  virtual EventId doFillDevice(StreamId, std::byte*, uint64_t, size_t, size_t, bool) {
+    throw Exception("Device memory fills are not supported by this runtime");
+  }
+
+  virtual EventId doMemcpyWithinDevice(StreamId, const std::byte*, std::byte*, size_t, bool) {
+    throw Exception("Memcpys within the device are not supported by this runtime");
+  }
+
+  virtual EventId doSetKernelHeap(StreamId, std::byte*, size_t, bool) {
+    throw Exception("Kernel heaps are not supported by this runtime");
+  }
+
+  virtual EventId doKernelLaunchMulti(StreamId, const std::vector<LaunchDesc>&, bool) {
+    throw Exception("Kernel multi-launches are not supported by this runtime");
+  }
+
+  virtual void doSetMasterMinionTraceOutput(DeviceId, std::ostream*) {
+    throw Exception("Draining the MasterMinion trace is not supported by this runtime");
+  }
+
+  virtual EventId doLaunchHostFunc(StreamId, HostFunc) {
+    throw Exception("Host functions are not supported by this runtime");
+  }
+
+  virtual EventId doMemcpyHostToDeviceConverted(StreamId, const float*, std::byte*, size_t, const MemcpyConversion&,
+                                                bool) {
+    throw Exception("Converting memcpys are not supported by this runtime");
+  }
+
+  virtual EventId doMemcpyDeviceToHostConverted(StreamId, const std::byte*, float*, size_t, const MemcpyConversion&,
+                                                bool) {
+    throw Exception("Converting memcpys are not supported by this runtime");
+  }
+
+  virtual EventId doMemcpyHostToDeviceCompressed(StreamId, const std::vector<CompressedChunk>&, std::byte*, uint64_t) {
+    throw Exception("Compressed memcpys are not supported by this runtime");
+  }
+
+  virtual EventId doMemcpyHostToDeviceChecked(StreamId, const std::byte*, std::byte*, size_t, uint64_t, bool) {
+    throw Exception("Checked memcpys are not supported by this runtime");
+  }
+
+  virtual EventId doMemcpyHostToDeviceChained(StreamId, MemcpyList) {
+    throw Exception("Chained memcpys are not supported by this runtime");
+  }
+
+  virtual EventId doMemcpyDeviceToHostChained(StreamId, MemcpyList) {
+    throw Exception("Chained memcpys are not supported by this runtime");
+  }
+
+  virtual DeviceHandle doMallocDeviceHandle(DeviceId, size_t, uint32_t) {
+    throw Exception("Relocatable device allocations are not supported by this runtime");
+  }
+
+  virtual void doFreeDeviceHandle(DeviceHandle) {
+    throw Exception("Relocatable device allocations are not supported by this runtime");
+  }
+
+  virtual std::byte* doResolveDeviceHandle(DeviceHandle) const {
+    throw Exception("Relocatable device allocations are not supported by this runtime");
+  }
+
+  virtual size_t doCompactDeviceMemory(DeviceId) {
+    throw Exception("Device memory compaction is not supported by this runtime");
+  }
+
+  virtual DeviceHandle doMallocManaged(DeviceId, size_t, uint32_t) {
+    throw Exception("Managed device allocations are not supported by this runtime");
+  }
+
+  virtual void doPrefetchManaged(StreamId, const std::vector<DeviceHandle>&) {
+    throw Exception("Managed device allocations are not supported by this runtime");
+  }
+
+  virtual EventId doKernelLaunchSigned(StreamId, KernelId, uint64_t, const std::byte*, size_t,
+                                       const KernelLaunchOptionsImp&) {
+    throw Exception("Typed kernel launches are not supported by this runtime");
+  }
+
+  virtual DeviceGroupId doCreateDeviceGroup(const std::vector<DeviceId>&, StreamPriority) {
+    throw Exception("Device groups are not supported by this runtime");
+  }
+
+  virtual void doDestroyDeviceGroup(DeviceGroupId) {
+    throw Exception("Device groups are not supported by this runtime");
+  }
+
+  virtual StreamId doGetDeviceGroupStream(DeviceGroupId, DeviceId) const {
+    throw Exception("Device groups are not supported by this runtime");
+  }
+
+  virtual std::vector<DeviceId> doGetDeviceGroupDevices(DeviceGroupId) const {
+    throw Exception("Device groups are not supported by this runtime");
+  }
+
+  virtual EventId doLaunchOnGroup(DeviceGroupId, const std::vector<KernelId>&, const std::vector<std::vector<std::byte>>&,
+                                  const KernelLaunchOptionsImp&) {
+    throw Exception("Device groups are not supported by this runtime");
+  }
+
+  virtual EventId doScatter(DeviceGroupId, const std::byte*, const std::vector<std::byte*>&, size_t, bool) {
+    throw Exception("Device groups are not supported by this runtime");
+  }
+
+  virtual EventId doGather(DeviceGroupId, const std::vector<const std::byte*>&, std::byte*, size_t, bool) {
+    throw Exception("Device groups are not supported by this runtime");
+  }
+
+  virtual std::optional<KernelPowerState> doGetEventPowerState(EventId) {
+    throw Exception("Power reports are not supported by this runtime");
+  }
+
+  virtual void doSetShireBudget(DeviceId, int) {
+    throw Exception("Shire budgets are not supported by this runtime");
+  }
+
+  virtual int doGetShireBudget(DeviceId) const {
+    throw Exception("Shire budgets are not supported by this runtime");
+  }
+
+  virtual void doSetShireBudgetPolicy(ShireBudgetPolicy) {
+    throw Exception("Shire budgets are not supported by this runtime");
+  }
+};
+
+/// \brief Arena style sub-allocator over a device memory reservation, see \ref IRuntime::createMemoryPool. Memory is
+/// handed out linearly and released all at once through \ref reset. A MemoryPool is not thread safe; the intended
+/// usage is one pool per stream (or per request loop) holding its transient buffers.
+class ETRT_API MemoryPool {
+public:
+  /// \brief Allocates memory from the pool; throws an \ref Exception if there is not enough space left.
+  ///
+  /// @param[in] size indicates the allocation size in bytes
+  /// @param[in] alignment indicates the required alignment, defaults to device cache line size
+  ///
+  /// @returns a device memory pointer inside the pool reservation
+  ///
+  std::byte* allocate(size_t size, uint32_t alignment = kCacheLineSize);
+
+  /// \brief Releases all the allocations done so far. There must not be pending operations using pool memory.
+  void reset();
+
+  /// \brief Returns the device where the pool memory is reserved
+  DeviceId getDevice() const;
+
+  /// \brief Returns the total size of the pool, in bytes
+  size_t getSize() const;
+
+  /// \brief Returns the bytes currently allocated (including alignment padding)
+  size_t getUsedBytes() const;
+
+  /// \brief Returns the maximum used bytes since pool creation, useful to size the pool
+  size_t getPeakUsedBytes() const;
+
+  MemoryPool(const MemoryPool&) = delete;
+  MemoryPool& operator=(const MemoryPool&) = delete;
+
+  /// \brief Frees the device memory reservation
+  ~MemoryPool();
+
+private:
+  friend class IRuntime;
+  MemoryPool(IRuntime& runtime, DeviceId device, std::byte* base, size_t size);
+
+  IRuntime& runtime_;
+  DeviceId device_;
+  std::byte* base_;
+  size_t size_;
+  size_t used_ = 0;
+  size_t peakUsed_ = 0;
 };
 
 } // namespace rt
@@ -0,0 +1,99 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) 2025 Ainekko, Co.
+ * SPDX-License-Identifier: Apache-2.0
+ *-------------------------------------------------------------------------*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+/// \defgroup runtime_kernel_signature Kernel signature API
+///
+/// Compile-time description of the arguments of a kernel, shared by the host and the device code (this header has no
+/// host dependencies). The arguments are laid out like the members of a C struct declared in the same order, so a
+/// kernel reading them through such a struct sees the values given to the typed \ref rt::IRuntime::kernelLaunch.
+///
+/// Kernels declare their arguments with \ref ET_KERNEL_SIGNATURE; the runtime reads the signature from the elf when
+/// the code is loaded and rejects typed launches whose arguments don't match it, instead of letting the kernel read
+/// garbage. The signature covers the size, alignment and kind (integer, floating point, pointer...) of each argument,
+/// not its name or exact type.
+///
+/// @{
+namespace rt {
+
+namespace kernel_signature_detail {
+constexpr uint64_t kFnvOffset = 0xcbf29ce484222325ULL;
+constexpr uint64_t kFnvPrime = 0x100000001b3ULL;
+
+constexpr uint64_t mix(uint64_t hash, uint64_t value) {
+  for (int i = 0; i < 8; ++i) {
+    hash = (hash ^ ((value >> (i * 8)) & 0xFF)) * kFnvPrime;
+  }
+  return hash;
+}
+
+template <typename T> constexpr uint64_t kindOf() {
+  using U = std::remove_cv_t<T>;
+  if constexpr (std::is_same_v<U, bool>) {
+    return 1;
+  } else if constexpr (std::is_pointer_v<U>) {
+    return 2;
+  } else if constexpr (std::is_floating_point_v<U>) {
+    return 3;
+  } else if constexpr (std::is_enum_v<U>) {
+    return kindOf<std::underlying_type_t<U>>();
+  } else if constexpr (std::is_integral_v<U>) {
+    return std::is_signed_v<U> ? 4 : 5;
+  } else {
+    return 6;
+  }
+}
+
+constexpr size_t alignUp(size_t value, size_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+} // namespace kernel_signature_detail
+
+/// \brief Name of the elf section holding the signature defined by \ref ET_KERNEL_SIGNATURE
+constexpr const char* kKernelSignatureSection = ".et_kernel_signature";
+
+/// \brief Returns the signature of a kernel taking the given arguments
+template <typename... Args> constexpr uint64_t kernelSignature() {
+  using namespace kernel_signature_detail;
+  auto hash = mix(kFnvOffset, sizeof...(Args));
+  ((hash = mix(mix(mix(hash, sizeof(Args)), alignof(Args)), kindOf<Args>())), ...);
+  return hash;
+}
+
+/// \brief Returns the size of the arguments laid out like a C struct, including the trailing padding
+template <typename... Args> constexpr size_t kernelArgsSize() {
+  using namespace kernel_signature_detail;
+  size_t size = 0;
+  size_t alignment = 1;
+  ((size = alignUp(size, alignof(Args)) + sizeof(Args),
+    alignment = alignof(Args) > alignment ? alignof(Args) : alignment),
+   ...);
+  return alignUp(size, alignment);
+}
+
+/// \brief Copies the arguments into dst, which must hold \ref kernelArgsSize bytes, laid out like a C struct
+template <typename... Args> void packKernelArgs(std::byte* dst, const Args&... args) {
+  using namespace kernel_signature_detail;
+  static_assert((std::is_trivially_copyable_v<Args> && ...), "Kernel arguments must be trivially copyable");
+  size_t offset = 0;
+  ((offset = alignUp(offset, alignof(Args)), std::memcpy(dst + offset, &args, sizeof(Args)), offset += sizeof(Args)),
+   ...);
+}
+
+} // namespace rt
+
+/// \brief Defines the signature of the kernel in its elf, ie. ET_KERNEL_SIGNATURE(float*, const float*, uint64_t);
+/// there must be one per elf
+#define ET_KERNEL_SIGNATURE(...)                                                                                       \
+  extern "C" __attribute__((used, section(".et_kernel_signature"))) const uint64_t __et_kernel_signature =           \
+    rt::kernelSignature<__VA_ARGS__>()
+
+/// @}
+// End of runtime_kernel_signature
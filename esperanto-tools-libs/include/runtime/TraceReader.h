@@ -0,0 +1,119 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) 2025 Ainekko, Co.
+ * SPDX-License-Identifier: Apache-2.0
+ *-------------------------------------------------------------------------*/
+#pragma once
+
+#include <runtime/IRuntimeExport.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string>
+#include <vector>
+
+struct trace_entry_header_t;
+
+/// \defgroup runtime_trace_reader_api Runtime Trace Reader API
+///
+/// Random access to the entries of big device firmware trace buffers (see et-trace/layout.h), without decoding the
+/// whole buffer for every query.
+/// @{
+namespace rt::profiling {
+
+/// \brief Entries of a trace buffer to look for, see \ref TraceReader::find. An entry is returned if it matches all
+/// the fields.
+struct TraceQuery {
+  uint64_t beginCycle_ = 0;                                  ///< lowest cycle of the entries
+  uint64_t endCycle_ = std::numeric_limits<uint64_t>::max(); ///< highest cycle of the entries, included
+  std::vector<uint16_t> types_;                              ///< trace_type of the entries, any type if empty
+  uint64_t shireMask_ = std::numeric_limits<uint64_t>::max(); ///< shire of the logging hart, its hart_id / 64
+  std::optional<uint16_t> hartId_;                           ///< hart which logged the entries
+};
+
+/// \brief Summary of a sub-buffer of a trace buffer, as indexed by \ref TraceReader
+struct TraceSubBuffer {
+  size_t offset_ = 0;       ///< offset of the sub-buffer in the trace buffer
+  size_t dataSize_ = 0;     ///< valid bytes in the sub-buffer, its header included
+  size_t entries_ = 0;      ///< number of entries
+  uint64_t firstCycle_ = 0; ///< lowest cycle of its entries
+  uint64_t lastCycle_ = 0;  ///< highest cycle of its entries
+  uint64_t shireMask_ = 0;  ///< shires of the harts which logged its entries
+};
+
+/// \brief Reader of a device trace buffer in the standard layout, either memory-mapped from a file or held in memory.
+///
+/// On construction every sub-buffer is decoded once, in parallel, to build an index: the time range, the shires and
+/// the entry types of each sub-buffer, and a checkpoint every few hundred entries. Queries only decode the sub-buffers
+/// and the parts of them which can hold matching entries, again in parallel. The returned entries point into the
+/// trace buffer, so they are valid as long as the reader is; their types are in et-trace/layout.h.
+///
+class ETRT_API TraceReader {
+public:
+  /// \brief Memory maps a trace file, as dumped from the device. Throws \ref rt::Exception if it can't be read.
+  ///
+  /// @param[in] path of the trace file
+  /// @param[in] threads used to decode the sub-buffers, all the hardware threads if 0
+  ///
+  static TraceReader open(const std::string& path, size_t threads = 0);
+
+  /// \brief Reads a trace buffer held in memory. Throws \ref rt::Exception if it is not a trace buffer.
+  ///
+  /// @param[in] buffer contents of the trace buffer, starting with its standard header
+  /// @param[in] threads used to decode the sub-buffers, all the hardware threads if 0
+  ///
+  explicit TraceReader(const std::vector<std::byte>& buffer, size_t threads = 0);
+
+  ~TraceReader();
+  TraceReader(TraceReader&& other) noexcept;
+  TraceReader& operator=(TraceReader&& other) noexcept;
+  TraceReader(const TraceReader&) = delete;
+  TraceReader& operator=(const TraceReader&) = delete;
+
+  /// \brief Returns the sub-buffers holding entries, in buffer order.
+  ///
+  const std::vector<TraceSubBuffer>& getSubBuffers() const {
+    return subBuffers_;
+  }
+
+  /// \brief Returns the entries matching a query, sorted by cycle. Entries with the same cycle keep the buffer order.
+  ///
+  std::vector<const trace_entry_header_t*> find(const TraceQuery& query) const;
+
+private:
+  struct Checkpoint;
+
+  TraceReader(const std::byte* data, size_t size, size_t threads);
+  void buildIndex();
+  template <typename Func> void parallelFor(size_t count, Func&& func) const;
+
+  const std::byte* data_ = nullptr;
+  size_t size_ = 0;
+  void* mapping_ = nullptr; ///< file mapping, if the buffer is memory-mapped
+  std::vector<uint64_t> storage_; ///< aligned copy of the buffer, if it is held in memory
+  size_t threads_ = 1;
+  std::vector<TraceSubBuffer> subBuffers_;
+  std::vector<uint64_t> typeMasks_;                  ///< per sub-buffer, bit per trace_type
+  std::vector<std::vector<Checkpoint>> checkpoints_; ///< per sub-buffer
+};
+
+/// \brief Samples taken at a program counter, see \ref getPcHotspots
+struct PcHotspot {
+  uint64_t pc_ = 0;        ///< program counter
+  size_t samples_ = 0;     ///< number of samples taken at the program counter
+  uint64_t shireMask_ = 0; ///< shires of the sampled harts
+};
+
+/// \brief Builds a hot-spot report from the PC samples of a trace buffer (see Trace_PC_Sample in et-trace/encoder.h).
+///
+/// @param[in] reader of the trace buffer
+/// @param[in] query samples to count, its types are ignored
+/// @returns the sampled program counters, most sampled first
+///
+ETRT_API std::vector<PcHotspot> getPcHotspots(const TraceReader& reader, TraceQuery query = {});
+
+} // namespace rt::profiling
+
+/// @}
+// End of runtime_trace_reader_api
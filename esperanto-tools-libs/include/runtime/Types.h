@@ -8,11 +8,13 @@
 
 #include <hostUtils/debug/StackException.h>
 
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <memory>
 #include <optional>
+#include <utility>
 #include <vector>
 
 /// \defgroup runtime_types Runtime Types
@@ -42,16 +44,80 @@ enum class DeviceId : int {};
 /// \brief KernelId Handler
 enum class KernelId : int {};
 
+/// \brief Command graph Handler, see \ref IRuntime::beginCapture
+enum class GraphId : int {};
+
+/// \brief Device group Handler, see \ref IRuntime::createDeviceGroup
+enum class DeviceGroupId : int {};
+
+/// \brief Relocatable device memory allocation Handler, see \ref IRuntime::mallocDeviceHandle
+enum class DeviceHandle : uint32_t {};
+
+/// \brief Selects how the runtime waits for device responses (completion queue entries).
+enum class ResponseReceiverMode {
+  Polling,  ///< poll the completion queue periodically, sleeping between checks (legacy behavior)
+  Blocking, ///< block on the device completion queue notification until there is a response available
+  Hybrid    ///< busy-poll for \ref Options::responseReceiverSpinTime_ after last response, then block
+};
+
+/// \brief Selects the strategy used to allocate device memory (see \ref IRuntime::mallocDevice).
+enum class MemoryAllocatorPolicy {
+  FirstFit,   ///< address ordered free list, takes the first chunk big enough (legacy behavior)
+  SizeClasses ///< segregated free lists for small allocations plus a best-fit tree for big ones; O(log n) lookups
+};
+
+/// \brief Scheduling priority of a stream, see \ref IRuntime::createStream
+enum class StreamPriority {
+  Normal, ///< streams are distributed round-robin among the device submission queues
+  High    ///< latency-critical streams, they get a submission queue which is not shared with Normal streams
+};
+
 /// \brief This struct will hold parametrization options for Runtime instantiation
 struct ETRT_API Options {
   bool checkMemcpyDeviceOperations_; /// < if set, the runtime will inspect all memcpy operations and throw an
                                      /// exception if invalid device address/size
   bool checkDeviceApiVersion_;
+  ResponseReceiverMode responseReceiverMode_ = ResponseReceiverMode::Polling; /// < see \ref ResponseReceiverMode
+  std::chrono::microseconds responseReceiverSpinTime_ = std::chrono::microseconds{20}; /// < only used in Hybrid mode
+  MemoryAllocatorPolicy memoryAllocatorPolicy_ = MemoryAllocatorPolicy::FirstFit; /// < see \ref MemoryAllocatorPolicy
+  bool pinThreadsToDeviceNode_ = true; /// < if set, each device runtime threads run on the cpus of the device NUMA node
+  size_t codeImageRetentionBytes_ = 0; /// < device bytes of read-only code images kept loaded once all their kernels
+                                       /// are unloaded, so loading the same elf again doesn't copy it to the device
+  size_t streamHostMemoryMinBytes_ = 0; /// < memcpys of at least this size from/to host memory not registered with
+                                        /// IRuntime::registerHostBuffer are done by the DMA engine directly from/to
+                                        /// that memory, pinned only while in flight, instead of through the CMA
+                                        /// buffers. Zero disables it; ignored if the device can't access host memory
+                                        /// directly
+  bool prefaultCmaBuffers_ = false; /// < if set, every page of the CMA staging buffers is faulted in at start-up, so
+                                    /// the first memcpys don't take page faults in the copy path
+  bool lockCmaBuffers_ = false;     /// < if set, the CMA staging buffers are also locked in memory (mlock); failing to
+                                    /// lock them (ie. because of RLIMIT_MEMLOCK) is only a warning
+  bool hugePageCmaBuffers_ = true; /// < if set, the CMA staging buffers are backed by hugepages when the device-layer
+                                   /// can allocate them (see dev::IDeviceLayer::allocHugePageDmaBuffer), so the DMAs
+                                   /// take fewer IOMMU and TLB entries; otherwise, or if there are not enough free
+                                   /// hugepages, they are CMA memory
+  size_t executionContextBuffers_ = 0; /// < execution context buffers created per device at start-up, so the first
+                                       /// kernel launches don't have to allocate them. Zero means the default (5)
+  size_t mappedDramH2DMaxBytes_ = 0; /// < host to device memcpys up to this size issued to an idle stream are done with
+                                     /// CPU stores through the device DRAM mapped by the device-layer (see
+                                     /// dev::IDeviceLayer::getMappedDram), and completed before returning, instead of
+                                     /// through CMA and a DMA command. Zero disables it; ignored if the DRAM is not
+                                     /// mapped
+  size_t mappedDramD2HMaxBytes_ = 0; /// < same as mappedDramH2DMaxBytes_ for device to host memcpys, done with
+                                     /// uncached CPU loads, so keep it small
+  double memoryCompactionThreshold_ = 0.0; /// < IRuntime::mallocDeviceHandle compacts the device memory first if its
+                                           /// fragmentation (1 - largest free chunk / free bytes) is above this. Zero
+                                           /// only compacts when the allocation doesn't fit
+  bool inlineCommandSubmission_ = true; /// < if set, a command sent to a submission queue with no other pending
+                                        /// commands is written to the queue by the calling thread, skipping the
+                                        /// handoff to the command sender thread; which only takes the commands
+                                        /// queued behind others or not fitting in the queue
 };
 
 /// \brief Returns the default options. See \ref Options
 constexpr auto getDefaultOptions() {
-  return Options{true, true};
+  return Options{true, true, ResponseReceiverMode::Polling, std::chrono::microseconds{20},
+                 MemoryAllocatorPolicy::FirstFit, true, 0, 0};
 }
 
 /// \brief RuntimePtr is an alias for a pointer to a Runtime instantation
@@ -62,6 +128,18 @@ using RuntimePtr = std::unique_ptr<class IRuntime>;
 class ETRT_API Exception : public dbg::StackException {
   using dbg::StackException::StackException;
 };
+/// \brief Shape of a pitched memcpy of up to three dimensions: planes_ planes of rows_ rows of rowSize_ bytes. A pitch
+/// is the distance between the beginnings of two consecutive rows (or planes) of one side, 0 meaning packed
+struct ETRT_API MemcpyShape {
+  size_t rowSize_;
+  size_t rows_ = 1;
+  size_t planes_ = 1;
+  size_t srcRowPitch_ = 0;
+  size_t srcPlanePitch_ = 0;
+  size_t dstRowPitch_ = 0;
+  size_t dstPlanePitch_ = 0;
+};
+
 /// \brief This struct will hold a number of memcpy operations.
 struct ETRT_API MemcpyList {
 
@@ -69,6 +147,11 @@ struct ETRT_API MemcpyList {
     operations_.emplace_back(Op{src, dst, size});
   }
 
+  /// \brief Adds the rows of a pitched memcpy, see \ref MemcpyShape; ie. a slice of a batch or a tile of an image. Rows
+  /// contiguous on both sides are merged in a single op, with the previous op too, so a shape packed on both sides
+  /// takes a single op. Lists are split in as many DMA commands as needed by the runtime.
+  void addStridedOp(std::byte* src, std::byte* dst, const MemcpyShape& shape);
+
   struct Op {
     std::byte* src_;
     std::byte* dst_;
@@ -167,6 +250,41 @@ enum class DeviceErrorCode {
   ErrorTypeCmSmodeRtException,
   ErrorTypeCmSmodeRtHang,
 
+  StreamSyncHostAborted,
+  StreamSyncInvalidSlot,
+
+  MemsetHostAborted,
+  MemsetInvalidAddress,
+  MemsetInvalidPattern,
+
+  DeviceMemcpyHostAborted,
+  DeviceMemcpyInvalidAddress,
+
+  KernelHeapHostAborted,
+  KernelHeapInvalidAddress,
+  KernelHeapKernelsRunning,
+
+  KernelFlushRangesHostAborted,
+  KernelFlushRangesInvalidAddress,
+
+  KernelShireArgsHostAborted,
+  KernelShireArgsInvalidStride,
+
+  KernelWatchdogHostAborted,
+
+  KernelPowerReportHostAborted,
+
+  KernelLaunchConfigHostAborted,
+  KernelLaunchConfigInvalidCacheConfig,
+
+  KernelMultiLaunchHostAborted,
+  KernelMultiLaunchInvalidArgs,
+
+  CommandListHostAborted,
+  CommandListInvalid,
+
+  MemcpyChecksumMismatch,
+
   Unknown
 };
 
@@ -185,8 +303,51 @@ struct ETRT_API StreamError {
   std::optional<uint64_t> cmShireMask_; /// < only available in some kernel errors. Contains offending shiremask
   std::optional<std::vector<ErrorContext>> errorContext_;
 };
+/// \brief Device side timing of a completed kernel launch or DMA command, see IRuntime::getEventTiming. Cycles are
+/// counted by the device Master Minion, at frequencyMhz_.
+struct ETRT_API EventTiming {
+  DeviceId device_;              ///< device which executed the command
+  uint64_t startCycles_ = 0;     ///< cycle the device popped the command from its submission queue
+  uint64_t waitCycles_ = 0;      ///< cycles the command waited in the device till it started executing
+  uint64_t executionCycles_ = 0; ///< cycles the command was executing
+  uint32_t frequencyMhz_ = 0;    ///< frequency of the device cycle counter
+
+  uint64_t getExecutionStartCycles() const {
+    return startCycles_ + waitCycles_;
+  }
+  uint64_t getEndCycles() const {
+    return getExecutionStartCycles() + executionCycles_;
+  }
+  /// \brief Returns the given device cycles in nanoseconds, 0 if the frequency is unknown
+  std::chrono::nanoseconds toDuration(uint64_t cycles) const {
+    return std::chrono::nanoseconds{
+      static_cast<std::chrono::nanoseconds::rep>(frequencyMhz_ == 0 ? 0 : cycles * 1000 / frequencyMhz_)};
+  }
+};
+/// \brief Power and thermal state of the device while a kernel ran, see KernelLaunchOptions::setPowerReport. The device
+/// service processor lowers the Minion frequency on its own when the device gets too hot or draws too much power; the
+/// throttle events tell the launches which were slowed down by it.
+struct ETRT_API KernelPowerState {
+  DeviceId device_;                ///< device which executed the kernel
+  uint32_t startFrequencyMhz_ = 0; ///< Minion frequency when the kernel started
+  uint32_t endFrequencyMhz_ = 0;   ///< Minion frequency when the kernel completed
+  uint32_t throttleEvents_ = 0;    ///< times the frequency was lowered by a power or thermal throttle while it ran
+
+  bool wasThrottled() const {
+    return throttleEvents_ > 0;
+  }
+};
+/// \brief Decides the shire budget of a device from the power state of its kernels, see IRuntime::setShireBudgetPolicy.
+/// Gets the power state of a kernel and the current budget of its device (0 if none) and returns the new budget
+using ShireBudgetPolicy = std::function<int(const KernelPowerState& state, int currentBudget)>;
 /// \brief This callback can be optionally set to automatically retrieve stream errors when produced
 using StreamErrorCallback = std::function<void(EventId, const StreamError&)>;
+/// \brief This callback is called once an event has completed, see IRuntime::onEventComplete
+using EventCompletionCallback = std::function<void(EventId)>;
+/// \brief Runs the given task, ie. posting it to an asio io_context. See IRuntime::setCallbackExecutor
+using CallbackExecutor = std::function<void(std::function<void()>)>;
+/// \brief Host work run in stream order, see IRuntime::launchHostFunc
+using HostFunc = std::function<void()>;
 /// \brief Constants
 constexpr auto kCacheLineSize = 64U; // TODO This should not be here, it should be
                                      // in a header with project-wide constants
@@ -275,6 +436,15 @@ struct ETRT_API DeviceProperties {
                                            ///< interleaved DRAM address region
   uint8_t
     onPkgDRAMInterleavedChipletBits_; ///< Number of chiplet bits in the on-package interleaved DRAM address region
+
+  uint8_t maxConcurrentKernels_ = 1; ///< Number of kernels which can run at the same time on disjoint shire masks
+
+  /// The DRAM is interleaved across the memshires in cache line granularity: a buffer spans all of them every
+  /// 1 << (dramMemshireLSb_ + dramMemshireBits_) bytes. Kernels can use these to make each shire touch mostly the
+  /// lines of a given memshire, i.e. memshire = (address >> dramMemshireLSb_) & ((1 << dramMemshireBits_) - 1)
+  uint8_t dramMemshireLSb_ = 6;           ///< Least significant bit position of the memshire in a DRAM address
+  uint8_t dramMemshireBits_ = 3;          ///< Number of memshire bits in a DRAM address
+  uint8_t dramMemshireControllerBit_ = 9; ///< Bit position of the controller within the memshire in a DRAM address
 };
 
 // NOTE: this is copied directly from device firmware "encoder.h"; we need to find a proper solution. So this will be in
@@ -289,6 +459,22 @@ struct ETRT_API UserTrace {
   uint32_t filterMask_;  /*!< This is a bit mask representing a list of filters for a given event to trace. */
 };
 
+/// \brief A kernel of a \ref IRuntime::kernelLaunchMulti
+struct ETRT_API LaunchDesc {
+  KernelId kernel_;       ///< kernel to execute, loaded into the device of the stream
+  const std::byte* args_; ///< device buffer holding the kernel arguments, previously allocated with mallocDevice; it
+                          ///< can be nullptr
+  uint64_t shireMask_;    ///< shires executing the kernel, disjoint from the shires of the other kernels
+};
+
+/// \brief A 64 bit word of the embedded arguments of a kernel launch of an uploaded graph, replaced for a single
+/// \ref IRuntime::launchGraph
+struct ETRT_API GraphArgPatch {
+  size_t launch_;     ///< kernel launch of the graph, its index counting only the kernel launches in capture order
+  size_t argsOffset_; ///< offset in the kernel arguments, 8 bytes aligned
+  uint64_t value_;
+};
+
 // These two structs (DmaInfo and DeviceConfig) are directly copied from IDeviceLayer.h; these needs to be republished
 // by runtime since runtime consumers dont necessary need to know about DeviceLayer component once runtime multiprocess
 // is released
@@ -301,8 +487,27 @@ struct ETRT_API DmaInfo {
 
 enum class CmaCopyType { TO_CMA, FROM_CMA }; // type of CMA
 using CmaCopyFunction = std::function<void(const std::byte* src, std::byte* dst, size_t size, CmaCopyType type)>;
-static constexpr auto defaultCmaCopyFunction = [](const std::byte* src, std::byte* dst, size_t size, CmaCopyType) {
-  std::copy(src, src + size, dst);
+/// \brief Copies into (or from) the DMA staging memory. Big copies into it use non-temporal stores, the widest ones
+/// the CPU supports (checked once, at runtime), so the staged data doesn't evict the host caches
+ETRT_API void copyCma(const std::byte* src, std::byte* dst, size_t size, CmaCopyType type);
+static constexpr auto defaultCmaCopyFunction = [](const std::byte* src, std::byte* dst, size_t size,
+                                                  CmaCopyType type) { copyCma(src, dst, size, type); };
+
+/// \brief Element type of the device side of a converting memcpy, whose host side holds fp32 values. See
+/// IRuntime::memcpyHostToDeviceConverted
+enum class DeviceElementType { Fp16, Bf16, Int8 };
+
+/// \brief Conversion applied while a memcpy is staged through the CMA buffers. Values are rounded to nearest even
+struct ETRT_API MemcpyConversion {
+  DeviceElementType type_;
+  float scale_ = 1.0f; ///< Int8 only: device = round(host / scale_) saturated to [-128, 127], host = device * scale_
+};
+
+/// \brief A raw LZ4 block (no frame) of host memory, see IRuntime::memcpyHostToDeviceCompressed
+struct ETRT_API CompressedChunk {
+  const std::byte* data_;   ///< Compressed block
+  size_t size_;             ///< Size of the compressed block
+  size_t decompressedSize_; ///< Size of the block once decompressed, it must be exact
 };
 
 // Forward declaration
@@ -319,10 +524,19 @@ class ETRT_API KernelLaunchOptions {
 public:
   KernelLaunchOptions();
   virtual ~KernelLaunchOptions();
+  KernelLaunchOptions(const KernelLaunchOptions& other);
+  KernelLaunchOptions& operator=(const KernelLaunchOptions& other);
 
   /// \brief Set in what shires the kernel will be executed, by default it gets the max shires availables
   /// depending on device type.
   void setShireMask(uint64_t shireMask);
+  /// \brief Set how many shires the kernel needs, letting the runtime choose them among the ones not used by other
+  /// kernels launched this way on the same device, as close as possible to each other. If there are not enough free
+  /// shires, the launch blocks till previous kernels complete. It overrides \ref setShireMask, 0 (the default) disables
+  /// it.
+  /// \note The kernels launched with an explicit shire mask are not taken into account. Can't be used while capturing
+  /// a graph
+  void setShireCount(int shireCount);
   /// \brief Set if the kernel execution should be postponed till all previous works issued into this stream finish (a
   /// barrier). Usually the kernel launch must be postponed till some previous memory operations end, hence the default
   /// value is true.
@@ -351,6 +565,61 @@ public:
   /// \brief Set the path of the file that will contain a core dump if the execution throws an exception
   void setCoreDumpFilePath(const std::string& coreDumpFilePath);
 
+  /// \brief Max number of ranges given to \ref setFlushRanges
+  static constexpr size_t kMaxFlushRanges = 15;
+
+  /// \brief Set the output buffers of the kernel, which the device flushes to memory once the kernel completes, so they
+  /// are visible to memory readers bypassing the caches without flushing the whole L3. By default there are none.
+  /// \param ranges Device address and size of each buffer (previously allocated with \ref mallocDevice)
+  /// \note Throws an exception if there are more than \ref kMaxFlushRanges ranges or a range is empty
+  void setFlushRanges(const std::vector<std::pair<const std::byte*, size_t>>& ranges);
+
+  /// \brief Make the kernel arguments an array with a slice of stride bytes for each shire the kernel runs on, in
+  /// increasing shire order, instead of the same arguments for all of them. Each shire gets a pointer to its own slice,
+  /// so the kernel reads it as if it were the whole arguments. The arguments size given to the launch must be the number
+  /// of shires times the stride. By default (stride 0) all the shires share the arguments.
+  /// \note Throws an exception if the stride is not a multiple of 8 bytes
+  void setShireArgsStride(uint32_t stride);
+
+  /// \brief Arm a device watchdog for the kernel: if it doesn't complete within the timeout, the device aborts only the
+  /// shires it runs on, without resetting them nor disturbing the kernels running on other shires, and the launch fails
+  /// with \ref DeviceErrorCode::KernelLaunchTimeoutHang. As for any failed launch, the \ref StreamError has the shires
+  /// that were aborted and the context (PC, trap registers...) of their harts. By default (0) there is no watchdog.
+  /// \note Throws an exception if the timeout is negative or doesn't fit in 32 bits
+  void setWatchdogTimeout(std::chrono::seconds timeout);
+
+  /// \brief Report the power and thermal state of the device while the kernel ran: the Minion frequency at its start
+  /// and completion and the throttle events in between, see \ref IRuntime::getEventPowerState. The report is an extra
+  /// command which waits for the kernel in the device, so it keeps the following commands of the stream from starting
+  /// before the kernel completes. By default there is no report.
+  /// \note Launches with a power report can't be captured into a graph
+  void setPowerReport(bool enabled);
+
+  /// \brief Tell the device the kernel doesn't use tensor instructions, so the shires it runs on can skip the tensor
+  /// state reset before the next kernel. If the kernel does use them, the next kernel may find their state dirty. By
+  /// default the tensor state is reset before every kernel.
+  void setNoTensorOps(bool noTensorOps);
+
+  /// \brief Repartition the scratchpad (SCP) and L2 of each shire cache bank of the shires the kernel runs on before
+  /// it starts. The partition stays until a later kernel requests another one, and shires already partitioned this way
+  /// skip the repartition. The L3 is shared by all the shires, so it keeps its boot size: scpSets + l2Sets must be the
+  /// number of sets below it, otherwise the shires keep their partition. The master shire is never repartitioned. By
+  /// default (0, 0) the kernel runs with the current partition.
+  /// \param scpSets SCP sets per bank
+  /// \param l2Sets L2 sets per bank
+  /// \note Throws an exception if a number of sets is odd, or if there are less than 64 L2 sets
+  void setShireCacheConfig(uint16_t scpSets, uint16_t l2Sets);
+
+  /// \brief Have the device prefetch the first lines of the kernel code and of its arguments into L3 before starting
+  /// it, and the code into the instruction caches of its shires. It cuts the cache misses at the start of short
+  /// kernels. The number of prefetched lines is in the MasterMinion trace. By default there is no prefetch.
+  void setLaunchPrefetch(bool enabled);
+
+  /// \brief Have the device report the recoverable errors of the kernel (tensor errors) and let it complete, instead of
+  /// failing the launch. Each error is recorded in the error ring of its shire and the other shires are not disturbed.
+  /// Faults which can't be recovered, such as exceptions, still fail the launch. By default any error fails it.
+  void setReportAndContinue(bool enabled);
+
   std::unique_ptr<KernelLaunchOptionsImp> imp_;
 };
 
@@ -0,0 +1,99 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) 2025 Ainekko, Co.
+ * SPDX-License-Identifier: Apache-2.0
+ *-------------------------------------------------------------------------*/
+#pragma once
+
+#include "IRuntime.h"
+#include "Types.h"
+#include <runtime/IRuntimeExport.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+/// \defgroup runtime_work_queue Work queue API
+///
+/// The work queue API is the host producer of the device DRAM work queues consumed by persistent kernels (see
+/// transports/work_queue/work_queue.h in et-common-libs). A persistent kernel is launched once, given the queue
+/// address, and stays resident on its shires running the items the host pushes, so there is no launch per item.
+///
+/// @{
+namespace rt {
+
+/// \brief Host side of a work queue in device memory. It owns the queue memory and a stream of its own, where the
+/// items are written with memcpys, so they are published while the persistent kernel runs on another stream. The host
+/// is the only producer; a WorkQueue is not thread safe.
+class ETRT_API WorkQueue {
+public:
+  /// \brief Allocates and initializes an empty work queue in the device.
+  ///
+  /// @param[in] runtime the runtime used to access the queue, it must outlive the work queue
+  /// @param[in] device the device where the queue and its persistent kernel are
+  /// @param[in] slotCount number of slots, the items which can be pending at once
+  /// @param[in] payloadSize size in bytes of the item payload, a multiple of 8
+  ///
+  WorkQueue(IRuntime& runtime, DeviceId device, uint32_t slotCount, uint32_t payloadSize);
+
+  /// \brief Destroys the stream and frees the queue memory. The persistent kernel must have returned.
+  ~WorkQueue();
+
+  WorkQueue(const WorkQueue&) = delete;
+  WorkQueue& operator=(const WorkQueue&) = delete;
+
+  /// \brief Returns the device address of the queue, the work_queue_cb_t to give to the persistent kernel
+  std::byte* getDeviceAddress() const;
+
+  /// \brief Publishes an item, returning once the consumers can see it. If its slot still holds an item which has not
+  /// been completed, it waits for it. Throws an \ref Exception if the queue is stopped, the payload is bigger than the
+  /// payload size or the slot is not released within the timeout.
+  ///
+  /// @param[in] payload the item payload, the bytes up to the payload size are zeroed
+  /// @param[in] size size in bytes of the payload
+  /// @param[in] timeout maximum time to wait for the slot of the item to be released
+  ///
+  /// @returns the position of the item, to check its completion with \ref getStatus
+  ///
+  uint64_t push(const std::byte* payload, size_t size, std::chrono::seconds timeout = std::chrono::seconds(60));
+
+  /// \brief Tells the consumers there won't be more items; the persistent kernel returns once they are all claimed.
+  void stop();
+
+  /// \brief Returns the number of items completed by the consumers so far
+  uint64_t getCompleted();
+
+  /// \brief Waits till the consumers completed count items. Returns false if the timeout expires before.
+  bool waitForCompleted(uint64_t count, std::chrono::seconds timeout = std::chrono::hours(24));
+
+  /// \brief Returns the status the consumer completed an item with, or nullopt if it has not been completed yet.
+  /// Throws an \ref Exception if the slot of the item has already been reused by a later one.
+  ///
+  /// @param[in] position the position returned by \ref push
+  ///
+  std::optional<int64_t> getStatus(uint64_t position);
+
+private:
+  struct SlotHeader {
+    uint64_t done_;
+    int64_t status_;
+  };
+
+  std::byte* getSlot(uint64_t position) const;
+  SlotHeader readSlotHeader(uint64_t position);
+  uint64_t readWord(const std::byte* d_src);
+  void writeWord(std::byte* d_dst, uint64_t value);
+
+  IRuntime& runtime_;
+  DeviceId device_;
+  StreamId stream_;
+  std::byte* queue_;
+  uint32_t slotCount_;
+  uint32_t slotSize_;
+  uint64_t head_ = 0;
+  bool stopped_ = false;
+};
+
+} // namespace rt
+  /// @}
+  // End of runtime_work_queue
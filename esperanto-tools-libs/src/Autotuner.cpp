@@ -0,0 +1,209 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) 2025 Ainekko, Co.
+ * SPDX-License-Identifier: Apache-2.0
+ *-------------------------------------------------------------------------*/
+
+#include "runtime/Autotuner.h"
+#include "Utils.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <string>
+
+using namespace rt;
+
+namespace {
+bool hasWhitespaces(const std::string& s) {
+  return std::any_of(begin(s), end(s), [](unsigned char c) { return std::isspace(c); });
+}
+} // namespace
+
+Autotuner::Autotuner(IRuntime& runtime, std::string databasePath, int iterations)
+  : runtime_(runtime)
+  , databasePath_(std::move(databasePath))
+  , iterations_(iterations) {
+  if (iterations_ < 1) {
+    throw Exception("Autotuner needs at least one iteration per candidate");
+  }
+  load();
+}
+
+Autotuner::~Autotuner() {
+  for (auto [device, stream] : benchmarkStreams_) {
+    try {
+      runtime_.waitForStream(stream);
+      runtime_.destroyStream(stream);
+    } catch (const Exception& e) {
+      RT_LOG(WARNING) << "Couldn't release autotuner stream of device " << static_cast<int>(device)
+                      << ". Error: " << e.what();
+    }
+  }
+}
+
+EventId Autotuner::launch(DeviceId device, StreamId stream, const std::string& operation,
+                          const std::vector<size_t>& shape, const std::vector<TuningCandidate>& candidates) {
+  auto best = tune(device, stream, operation, shape, candidates);
+  return launchCandidate(stream, candidates[best]);
+}
+
+size_t Autotuner::tune(DeviceId device, StreamId stream, const std::string& operation, const std::vector<size_t>& shape,
+                       const std::vector<TuningCandidate>& candidates) {
+  if (candidates.empty()) {
+    throw Exception("Operation " + operation + " has no candidates to tune");
+  }
+  if (operation.empty() || hasWhitespaces(operation)) {
+    throw Exception("Invalid operation name to tune: '" + operation + "'");
+  }
+  for (const auto& c : candidates) {
+    if (c.name_.empty() || hasWhitespaces(c.name_)) {
+      throw Exception("Invalid candidate name '" + c.name_ + "' of operation " + operation);
+    }
+  }
+  auto key = getKey(operation, shape);
+  auto findCandidate = [&candidates](const std::string& name) {
+    return static_cast<size_t>(std::find_if(begin(candidates), end(candidates),
+                                            [&name](const auto& c) { return c.name_ == name; }) -
+                               begin(candidates));
+  };
+  if (auto it = tunings_.find(key); it != end(tunings_)) {
+    if (auto idx = findCandidate(it->second.candidate_); idx < candidates.size()) {
+      return idx;
+    }
+    RT_LOG(INFO) << "Tuned candidate " << it->second.candidate_ << " of " << key << " is gone, tuning it again";
+  }
+
+  // the benchmarks go after the work already submitted by the caller
+  runtime_.waitForStream(stream);
+  auto benchmarkStream = getBenchmarkStream(device);
+  auto best = candidates.size();
+  auto bestCycles = std::numeric_limits<uint64_t>::max();
+  for (size_t i = 0; i < candidates.size(); ++i) {
+    auto cycles = benchmark(benchmarkStream, candidates[i]);
+    if (cycles) {
+      RT_LOG(INFO) << "Autotuner " << key << " candidate " << candidates[i].name_ << ": " << *cycles << " cycles";
+    } else {
+      RT_LOG(WARNING) << "Autotuner " << key << " candidate " << candidates[i].name_ << " failed, discarding it";
+    }
+    if (cycles && *cycles < bestCycles) {
+      best = i;
+      bestCycles = *cycles;
+    }
+  }
+  if (best == candidates.size()) {
+    throw Exception("All the candidates of " + key + " failed");
+  }
+  tunings_[key] = Tuning{candidates[best].name_, bestCycles};
+  save();
+  return best;
+}
+
+std::optional<std::string> Autotuner::getTuned(const std::string& operation, const std::vector<size_t>& shape) const {
+  if (auto it = tunings_.find(getKey(operation, shape)); it != end(tunings_)) {
+    return it->second.candidate_;
+  }
+  return std::nullopt;
+}
+
+void Autotuner::clear() {
+  tunings_.clear();
+  save();
+}
+
+std::string Autotuner::getKey(const std::string& operation, const std::vector<size_t>& shape) {
+  std::stringstream ss;
+  ss << operation << ":";
+  for (size_t i = 0; i < shape.size(); ++i) {
+    ss << (i > 0 ? "x" : "") << shape[i];
+  }
+  return ss.str();
+}
+
+EventId Autotuner::launchCandidate(StreamId stream, const TuningCandidate& candidate) {
+  KernelLaunchOptions options;
+  if (candidate.setOptions_) {
+    candidate.setOptions_(options);
+  }
+  return runtime_.kernelLaunch(stream, candidate.kernel_, candidate.args_.data(), candidate.args_.size(), options);
+}
+
+std::optional<uint64_t> Autotuner::benchmark(StreamId stream, const TuningCandidate& candidate) {
+  auto fastest = std::numeric_limits<uint64_t>::max();
+  // the first launch warms up the caches and isn't timed
+  for (int i = 0; i <= iterations_; ++i) {
+    EventId event{};
+    try {
+      event = launchCandidate(stream, candidate);
+    } catch (const Exception& e) {
+      RT_LOG(WARNING) << "Couldn't launch candidate " << candidate.name_ << ". Error: " << e.what();
+      runtime_.waitForStream(stream);
+      runtime_.retrieveStreamErrors(stream);
+      return std::nullopt;
+    }
+    runtime_.waitForEvent(event);
+    if (!runtime_.retrieveStreamErrors(stream).empty()) {
+      return std::nullopt;
+    }
+    auto timing = runtime_.getEventTiming(event);
+    if (!timing) {
+      throw Exception("Missing device timing of candidate " + candidate.name_);
+    }
+    if (i > 0) {
+      fastest = std::min(fastest, timing->executionCycles_);
+    }
+  }
+  return fastest;
+}
+
+StreamId Autotuner::getBenchmarkStream(DeviceId device) {
+  auto it = benchmarkStreams_.find(device);
+  if (it == end(benchmarkStreams_)) {
+    it = benchmarkStreams_.emplace(device, runtime_.createStream(device)).first;
+  }
+  return it->second;
+}
+
+// one tuning per line: key, candidate name and cycles
+void Autotuner::load() {
+  if (databasePath_.empty()) {
+    return;
+  }
+  std::ifstream file(databasePath_);
+  if (!file) {
+    RT_LOG(INFO) << "Autotuner database " << databasePath_ << " not found, it will be created";
+    return;
+  }
+  std::string line;
+  while (std::getline(file, line)) {
+    std::istringstream ss(line);
+    std::string key;
+    Tuning tuning;
+    if (!(ss >> key >> tuning.candidate_ >> tuning.cycles_)) {
+      RT_LOG(WARNING) << "Ignoring malformed line of autotuner database " << databasePath_ << ": " << line;
+      continue;
+    }
+    tunings_[key] = tuning;
+  }
+}
+
+void Autotuner::save() const {
+  if (databasePath_.empty()) {
+    return;
+  }
+  // written aside and renamed, so a crash doesn't leave a truncated database
+  auto tmpPath = databasePath_ + ".tmp";
+  {
+    std::ofstream file(tmpPath, std::ios::trunc);
+    for (const auto& [key, tuning] : tunings_) {
+      file << key << " " << tuning.candidate_ << " " << tuning.cycles_ << "\n";
+    }
+    if (!file) {
+      throw Exception("Couldn't write autotuner database " + tmpPath);
+    }
+  }
+  if (std::rename(tmpPath.c_str(), databasePath_.c_str()) != 0) {
+    throw Exception("Couldn't write autotuner database " + databasePath_);
+  }
+}
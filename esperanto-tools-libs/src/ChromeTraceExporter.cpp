@@ -0,0 +1,583 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) 2025 Ainekko, Co.
+ * SPDX-License-Identifier: Apache-2.0
+ *-------------------------------------------------------------------------*/
+
+#include "runtime/ChromeTraceExporter.h"
+
+#include "Utils.h"
+
+#include <cereal/archives/json.hpp>
+#include <cereal/archives/portable_binary.hpp>
+#include <elfio/elfio.hpp>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#pragma GCC diagnostic ignored "-Wcast-align"
+#pragma GCC diagnostic ignored "-Wcast-qual"
+#pragma GCC diagnostic ignored "-Wsign-conversion"
+#pragma GCC diagnostic ignored "-Wuseless-cast"
+#pragma GCC diagnostic ignored "-Wignored-qualifiers"
+#define ET_TRACE_DECODER_IMPL
+#include <et-trace/decoder.h>
+#include <et-trace/layout.h>
+#pragma GCC diagnostic pop
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <limits>
+#include <map>
+#include <sstream>
+
+using namespace rt;
+using namespace rt::profiling;
+
+namespace {
+constexpr int kHostPid = 0;
+constexpr int kCommandsTid = 0;
+constexpr int kMasterMinionTid = 1;
+constexpr int kShireTidBase = 100;
+constexpr uint16_t kHartsPerShire = 64;
+
+int getDevicePid(DeviceId device) {
+  return static_cast<int>(device) + 1;
+}
+
+std::string escape(std::string_view str) {
+  std::ostringstream ss;
+  for (auto c : str) {
+    switch (c) {
+    case '"':
+      ss << "\\\"";
+      break;
+    case '\\':
+      ss << "\\\\";
+      break;
+    case '\n':
+      ss << "\\n";
+      break;
+    case '\r':
+      ss << "\\r";
+      break;
+    case '\t':
+      ss << "\\t";
+      break;
+    default:
+      if (static_cast<unsigned char>(c) < 0x20) {
+        ss << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c);
+      } else {
+        ss << c;
+      }
+    }
+  }
+  return ss.str();
+}
+
+// a single Chrome trace event; args_ holds the members of the args object, already formatted
+struct TraceEvent {
+  std::string name_;
+  char phase_;
+  double ts_; // microseconds
+  int pid_;
+  int tid_;
+  std::optional<double> dur_ = std::nullopt;
+  std::string args_ = {};
+};
+
+class TraceWriter {
+public:
+  explicit TraceWriter(std::ostream& output, ProfileEvent::TimePoint base)
+    : output_(output)
+    , base_(base) {
+    output_ << std::fixed << std::setprecision(3) << R"({"displayTimeUnit":"ns","traceEvents":[)";
+  }
+  ~TraceWriter() {
+    output_ << "\n]}\n";
+  }
+
+  double toUs(ProfileEvent::TimePoint tp) const {
+    return std::chrono::duration<double, std::micro>(tp - base_).count();
+  }
+
+  void write(const TraceEvent& evt) {
+    output_ << (first_ ? "\n" : ",\n");
+    first_ = false;
+    output_ << R"({"name":")" << escape(evt.name_) << R"(","ph":")" << evt.phase_ << R"(","ts":)" << evt.ts_
+            << R"(,"pid":)" << evt.pid_ << R"(,"tid":)" << evt.tid_;
+    if (evt.dur_) {
+      output_ << R"(,"dur":)" << *evt.dur_;
+    }
+    if (evt.phase_ == 'i') {
+      output_ << R"(,"s":"t")";
+    }
+    if (!evt.args_.empty()) {
+      output_ << R"(,"args":{)" << evt.args_ << "}";
+    }
+    output_ << "}";
+  }
+
+  void writeName(const char* kind, int pid, std::optional<int> tid, const std::string& name) {
+    write(TraceEvent{kind, 'M', 0.0, pid, tid.value_or(0), std::nullopt, R"("name":")" + escape(name) + "\""});
+  }
+
+private:
+  std::ostream& output_;
+  ProfileEvent::TimePoint base_;
+  bool first_ = true;
+};
+
+void addArg(std::string& args, std::string_view name, const std::string& value) {
+  if (!args.empty()) {
+    args += ",";
+  }
+  args += "\"" + escape(name) + "\":" + value;
+}
+
+std::optional<std::string> formatExtra(const ProfileEvent::ExtraValues& value) {
+  return std::visit(
+    [](const auto& v) -> std::optional<std::string> {
+      using T = std::decay_t<decltype(v)>;
+      if constexpr (std::is_same_v<T, bool>) {
+        return v ? "true" : "false";
+      } else if constexpr (std::is_same_v<T, ResponseType>) {
+        return "\"" + getString(v) + "\"";
+      } else if constexpr (std::is_enum_v<T>) {
+        return std::to_string(static_cast<std::underlying_type_t<T>>(v));
+      } else if constexpr (std::is_integral_v<T>) {
+        return std::to_string(v);
+      } else if constexpr (std::is_same_v<T, ProfileEvent::Duration>) {
+        return std::to_string(std::chrono::duration_cast<std::chrono::nanoseconds>(v).count());
+      } else if constexpr (std::is_same_v<T, ProfileEvent::SystemTimePoint>) {
+        return std::to_string(std::chrono::duration_cast<std::chrono::nanoseconds>(v.time_since_epoch()).count());
+      } else if constexpr (std::is_same_v<T, std::string>) {
+        return "\"" + escape(v) + "\"";
+      } else {
+        return std::nullopt;
+      }
+    },
+    value);
+}
+
+std::string formatExtras(const ProfileEvent& event) {
+  auto args = std::string{};
+  // sorted so the output is stable
+  auto extras = std::map<std::string, ProfileEvent::ExtraValues>(begin(event.getExtras()), end(event.getExtras()));
+  for (const auto& [name, value] : extras) {
+    if (auto formatted = formatExtra(value)) {
+      addArg(args, name, *formatted);
+    }
+  }
+  return args;
+}
+
+ProfileEvent::TimePoint toHostTime(const ClockCalibration& calibration, uint64_t cycle) {
+  auto cycles = static_cast<double>(static_cast<int64_t>(cycle - calibration.deviceCycle_));
+  auto ns = cycles * 1000.0 / calibration.frequency_;
+  return calibration.hostTime_ +
+         std::chrono::duration_cast<ProfileEvent::Duration>(std::chrono::duration<double, std::nano>(ns));
+}
+
+std::string getCommandStatusName(uint8_t status) {
+  switch (status) {
+  case CMD_STATUS_WAIT_BARRIER:
+    return "waiting barrier";
+  case CMD_STATUS_RECEIVED:
+    return "received";
+  case CMD_STATUS_EXECUTING:
+    return "executing";
+  case CMD_STATUS_FAILED:
+    return "failed";
+  case CMD_STATUS_ABORTED:
+    return "aborted";
+  case CMD_STATUS_SUCCEEDED:
+    return "succeeded";
+  default:
+    return "status " + std::to_string(status);
+  }
+}
+
+template <typename Func> void forEachTraceEntry(const std::vector<std::byte>& buffer, Func&& func) {
+  if (buffer.size() < sizeof(trace_buffer_std_header_t)) {
+    RT_LOG(WARNING) << "Device trace buffer too small to hold a trace header, ignoring it";
+    return;
+  }
+  // copied so the header is properly aligned
+  auto aligned = std::vector<trace_buffer_std_header_t>((buffer.size() + sizeof(trace_buffer_std_header_t) - 1) /
+                                                        sizeof(trace_buffer_std_header_t));
+  std::memcpy(aligned.data(), buffer.data(), buffer.size());
+  // the decoder doesn't do bounds checking on its own, entries past the buffer are ignored
+  auto tb = aligned.data();
+  auto bufferEnd = reinterpret_cast<const std::byte*>(tb) + buffer.size();
+  for (auto entry = Trace_Decode(tb, nullptr); entry != nullptr; entry = Trace_Decode(tb, entry)) {
+    auto entryBytes = reinterpret_cast<const std::byte*>(entry);
+    if (entryBytes + sizeof(trace_entry_header_t) > bufferEnd ||
+        entryBytes + sizeof(trace_entry_header_t) + entry->payload_size > bufferEnd) {
+      RT_LOG(WARNING) << "Device trace buffer entry out of bounds, the trace may be truncated";
+      break;
+    }
+    func(*entry);
+  }
+}
+
+// resolves the device strings of deferred trace strings from the segments of the images of the device
+const char* resolveImageString(uint64_t address, void* user) {
+  auto segments = static_cast<const std::vector<std::pair<uint64_t, const std::vector<char>*>>*>(user);
+  for (const auto& [base, data] : *segments) {
+    if (address >= base && address - base < data->size()) {
+      auto str = data->data() + (address - base);
+      // only strings ending within the segment
+      if (std::memchr(str, '\0', data->size() - (address - base)) != nullptr) {
+        return str;
+      }
+    }
+  }
+  return nullptr;
+}
+
+std::string getTraceString(const trace_entry_header_t& entry,
+                           const std::vector<std::pair<uint64_t, const std::vector<char>*>>& segments) {
+  auto res = std::string{};
+  if (entry.type == TRACE_TYPE_STRING_DEFERRED) {
+    auto deferred = reinterpret_cast<const trace_string_deferred_t*>(&entry);
+    auto fixedSize = sizeof(trace_string_deferred_t) - sizeof(trace_entry_header_t);
+    // the args must be within the entry, which is within the buffer
+    if (entry.payload_size < fixedSize ||
+        deferred->arg_count > (entry.payload_size - fixedSize) / sizeof(uint64_t)) {
+      return "<invalid deferred string>";
+    }
+    auto user = const_cast<void*>(static_cast<const void*>(&segments));
+    res.resize(Trace_Format_Deferred_String(deferred, resolveImageString, user, nullptr, 0));
+    Trace_Format_Deferred_String(deferred, resolveImageString, user, res.data(), res.size() + 1);
+  } else {
+    auto str = reinterpret_cast<const trace_string_t*>(&entry);
+    auto size = std::min<size_t>(entry.payload_size, TRACE_STRING_MAX_SIZE);
+    res = std::string(str->string, strnlen(str->string, size));
+  }
+  // firmware strings usually end with a line break
+  while (!res.empty() && (res.back() == '\n' || res.back() == '\r')) {
+    res.pop_back();
+  }
+  return res;
+}
+
+struct KernelExecution {
+  EventId event_;
+  uint64_t startCycle_;
+  uint64_t endCycle_;
+};
+
+// kernels executed by a device, sorted by start cycle
+struct DeviceKernels {
+  // calls func with the index of each kernel executing at the given cycle
+  template <typename Func> void forEachExecuting(uint64_t cycle, Func&& func) const {
+    auto it = std::upper_bound(begin(kernels_), end(kernels_), cycle,
+                               [](uint64_t c, const KernelExecution& k) { return c < k.startCycle_; });
+    // kernels can run concurrently, look back as far as the longest one could have started
+    while (it != begin(kernels_)) {
+      --it;
+      if (cycle - it->startCycle_ > maxDuration_) {
+        break;
+      }
+      if (cycle <= it->endCycle_) {
+        func(static_cast<size_t>(it - begin(kernels_)));
+      }
+    }
+  }
+  std::vector<KernelExecution> kernels_;
+  uint64_t maxDuration_ = 0;
+};
+} // namespace
+
+namespace rt::profiling {
+
+void ChromeTraceExporter::addHostEvents(std::istream& input, IProfiler::OutputType type) {
+  switch (type) {
+  case IProfiler::OutputType::Json: {
+    cereal::JSONInputArchive archive(input);
+    while (archive.getNodeName() != nullptr) {
+      ProfileEvent evt;
+      archive(evt);
+      addHostEvent(evt);
+    }
+    break;
+  }
+  case IProfiler::OutputType::Binary: {
+    cereal::PortableBinaryInputArchive archive(input);
+    while (input.peek() != std::istream::traits_type::eof()) {
+      ProfileEvent evt;
+      archive(evt);
+      addHostEvent(evt);
+    }
+    break;
+  }
+  default:
+    throw Exception("Unknown profiler output type");
+  }
+}
+
+void ChromeTraceExporter::addHostEvent(const ProfileEvent& event) {
+  hostEvents_.emplace_back(event);
+}
+
+void ChromeTraceExporter::addDeviceTrace(DeviceId device, DeviceTraceType type, std::vector<std::byte> buffer) {
+  auto& traces = type == DeviceTraceType::MasterMinion ? mmTraces_ : cmTraces_;
+  traces[device].emplace_back(std::move(buffer));
+}
+
+void ChromeTraceExporter::addDeviceImage(DeviceId device, std::istream& elf, uint64_t loadBias) {
+  ELFIO::elfio image;
+  if (!image.load(elf)) {
+    throw Exception("Error parsing elf");
+  }
+  auto& segments = images_[device];
+  for (auto&& segment : image.segments) {
+    if (segment->get_type() == PT_LOAD && segment->get_file_size() > 0) {
+      auto data = segment->get_data();
+      segments.emplace_back(
+        ImageSegment{segment->get_virtual_address() + loadBias, std::vector<char>(data, data + segment->get_file_size())});
+    }
+  }
+}
+
+void ChromeTraceExporter::setClockCalibration(DeviceId device, const ClockCalibration& calibration) {
+  if (calibration.frequency_ == 0) {
+    throw Exception("Clock calibration frequency can't be 0");
+  }
+  calibrations_[device] = calibration;
+}
+
+std::optional<ClockCalibration> ChromeTraceExporter::getClockCalibration(DeviceId device) const {
+  if (auto it = calibrations_.find(device); it != end(calibrations_)) {
+    return it->second;
+  }
+  auto frequency = uint32_t{0};
+  for (const auto& evt : hostEvents_) {
+    if (evt.getClass() == Class::GetDeviceProperties && evt.getDeviceId() == device) {
+      if (auto props = evt.getDeviceProperties(); props && props->frequency_ != 0) {
+        frequency = props->frequency_;
+        break;
+      }
+    }
+  }
+  if (frequency == 0) {
+    return std::nullopt;
+  }
+  // the command completed on the device before its response got to the host; the response received soonest after
+  // its completion gives the tightest offset between both clocks
+  auto res = std::optional<ClockCalibration>{};
+  auto minOffset = std::numeric_limits<double>::max();
+  for (const auto& evt : hostEvents_) {
+    auto startTs = evt.getDeviceCmdStartTs();
+    if (evt.getClass() != Class::ResponseReceived || evt.getDeviceId() != device || !startTs) {
+      continue;
+    }
+    auto endCycle = *startTs + evt.getDeviceCmdWaitDur().value_or(0) + evt.getDeviceCmdExecDur().value_or(0);
+    auto hostNs = std::chrono::duration<double, std::nano>(evt.getTimeStamp().time_since_epoch()).count();
+    auto offset = hostNs - static_cast<double>(endCycle) * 1000.0 / frequency;
+    if (offset < minOffset) {
+      minOffset = offset;
+      res = ClockCalibration{evt.getTimeStamp(), endCycle, frequency};
+    }
+  }
+  return res;
+}
+
+void ChromeTraceExporter::write(std::ostream& output) const {
+  auto base = ProfileEvent::TimePoint::max();
+  for (const auto& evt : hostEvents_) {
+    base = std::min(base, evt.getTimeStamp());
+  }
+  if (hostEvents_.empty()) {
+    base = ProfileEvent::TimePoint{};
+  }
+  TraceWriter writer(output, base);
+
+  // host events, a track per thread
+  writer.writeName("process_name", kHostPid, std::nullopt, "Host");
+  std::unordered_map<std::thread::id, int> tids;
+  auto getTid = [&tids](std::thread::id id) {
+    return tids.try_emplace(id, static_cast<int>(tids.size()) + 1).first->second;
+  };
+  std::unordered_map<DeviceId, DeviceKernels> kernels;
+  std::unordered_map<DeviceId, std::optional<ClockCalibration>> calibrations;
+  auto getCalibration = [this, &calibrations](DeviceId device) -> const std::optional<ClockCalibration>& {
+    auto it = calibrations.find(device);
+    if (it == end(calibrations)) {
+      it = calibrations.emplace(device, getClockCalibration(device)).first;
+      if (!it->second) {
+        RT_LOG(WARNING) << "No clock calibration for device " << static_cast<int>(device)
+                        << ", its device timestamps won't be exported";
+      }
+    }
+    return it->second;
+  };
+
+  for (const auto& evt : hostEvents_) {
+    auto tid = getTid(evt.getNumericThreadId());
+    auto ts = writer.toUs(evt.getTimeStamp());
+    auto name = getString(evt.getClass());
+    switch (evt.getType()) {
+    case Type::Complete: {
+      auto dur = std::chrono::duration<double, std::micro>(evt.getDuration().value_or(ProfileEvent::Duration{}));
+      writer.write(TraceEvent{name, 'X', ts, kHostPid, tid, dur.count(), formatExtras(evt)});
+      break;
+    }
+    case Type::Start:
+      writer.write(TraceEvent{name, 'B', ts, kHostPid, tid, std::nullopt, formatExtras(evt)});
+      break;
+    case Type::End:
+      writer.write(TraceEvent{name, 'E', ts, kHostPid, tid, std::nullopt, formatExtras(evt)});
+      break;
+    case Type::Counter:
+      writer.write(TraceEvent{name, 'C', ts, kHostPid, tid, std::nullopt, formatExtras(evt)});
+      break;
+    case Type::Instant:
+      if (evt.getClass() == Class::IdentifyThread) {
+        writer.writeName("thread_name", kHostPid, tid, evt.getThreadName().value_or(""));
+      } else {
+        writer.write(TraceEvent{name, 'i', ts, kHostPid, tid, std::nullopt, formatExtras(evt)});
+      }
+      break;
+    default:
+      break;
+    }
+
+    // device side execution of the commands, as given by their responses
+    auto startTs = evt.getDeviceCmdStartTs();
+    auto device = evt.getDeviceId();
+    if (evt.getClass() != Class::ResponseReceived || !startTs || !device) {
+      continue;
+    }
+    const auto& calibration = getCalibration(*device);
+    if (!calibration) {
+      continue;
+    }
+    auto eventId = evt.getEvent().value_or(EventId{0});
+    auto rspType = evt.getResponseType().value_or(ResponseType::COUNT);
+    auto cmdName = (rspType == ResponseType::COUNT ? std::string{"Command"} : getString(rspType)) + " " +
+                   std::to_string(static_cast<int>(eventId));
+    auto args = std::string{};
+    addArg(args, ProfileEvent::kEventId, std::to_string(static_cast<int>(eventId)));
+    auto execCycle = *startTs + evt.getDeviceCmdWaitDur().value_or(0);
+    auto endCycle = execCycle + evt.getDeviceCmdExecDur().value_or(0);
+    auto pid = getDevicePid(*device);
+    auto startUs = writer.toUs(toHostTime(*calibration, *startTs));
+    auto execUs = writer.toUs(toHostTime(*calibration, execCycle));
+    auto endUs = writer.toUs(toHostTime(*calibration, endCycle));
+    if (execCycle != *startTs) {
+      writer.write(TraceEvent{cmdName + " wait", 'X', startUs, pid, kCommandsTid, execUs - startUs, args});
+    }
+    writer.write(TraceEvent{cmdName, 'X', execUs, pid, kCommandsTid, endUs - execUs, args});
+    if (rspType == ResponseType::Kernel) {
+      auto& deviceKernels = kernels[*device];
+      deviceKernels.kernels_.emplace_back(KernelExecution{eventId, execCycle, endCycle});
+      deviceKernels.maxDuration_ = std::max(deviceKernels.maxDuration_, endCycle - execCycle);
+    }
+  }
+
+  for (auto& [device, deviceKernels] : kernels) {
+    std::sort(begin(deviceKernels.kernels_), end(deviceKernels.kernels_),
+              [](const auto& a, const auto& b) { return a.startCycle_ < b.startCycle_; });
+  }
+
+  // device firmware traces
+  std::unordered_map<DeviceId, bool> namedDevices;
+  auto nameDevice = [&writer, &namedDevices](DeviceId device) {
+    if (auto [it, inserted] = namedDevices.try_emplace(device, true); inserted) {
+      auto pid = getDevicePid(device);
+      writer.writeName("process_name", pid, std::nullopt, "Device " + std::to_string(static_cast<int>(device)));
+      writer.writeName("thread_name", pid, kCommandsTid, "Commands");
+    }
+  };
+  for (const auto& [device, _] : calibrations) {
+    nameDevice(device);
+  }
+  auto getImageSegments = [this](DeviceId device) {
+    auto segments = std::vector<std::pair<uint64_t, const std::vector<char>*>>{};
+    if (auto it = images_.find(device); it != end(images_)) {
+      for (const auto& segment : it->second) {
+        segments.emplace_back(segment.address_, &segment.data_);
+      }
+    }
+    return segments;
+  };
+
+  for (const auto& [device, traces] : mmTraces_) {
+    const auto& calibration = getCalibration(device);
+    if (!calibration) {
+      continue;
+    }
+    nameDevice(device);
+    auto pid = getDevicePid(device);
+    auto segments = getImageSegments(device);
+    writer.writeName("thread_name", pid, kMasterMinionTid, "Master Minion");
+    for (const auto& trace : traces) {
+      forEachTraceEntry(trace, [&](const trace_entry_header_t& entry) {
+        auto ts = writer.toUs(toHostTime(*calibration, entry.cycle));
+        auto args = std::string{};
+        addArg(args, "hart_id", std::to_string(entry.hart_id));
+        if (entry.type == TRACE_TYPE_CMD_STATUS) {
+          const auto& cmd = reinterpret_cast<const trace_cmd_status_t*>(&entry)->cmd;
+          addArg(args, "mesg_id", std::to_string(cmd.mesg_id));
+          addArg(args, "queue_slot_id", std::to_string(cmd.queue_slot_id));
+          addArg(args, ProfileEvent::kEventId, std::to_string(cmd.trans_id));
+          auto name = "Command " + std::to_string(cmd.trans_id) + " " + getCommandStatusName(cmd.cmd_status);
+          writer.write(TraceEvent{name, 'i', ts, pid, kMasterMinionTid, std::nullopt, args});
+        } else if (entry.type == TRACE_TYPE_STRING || entry.type == TRACE_TYPE_STRING_DEFERRED) {
+          writer.write(
+            TraceEvent{getTraceString(entry, segments), 'i', ts, pid, kMasterMinionTid, std::nullopt, args});
+        }
+      });
+    }
+  }
+
+  for (const auto& [device, traces] : cmTraces_) {
+    const auto& calibration = getCalibration(device);
+    if (!calibration) {
+      continue;
+    }
+    nameDevice(device);
+    auto pid = getDevicePid(device);
+    auto segments = getImageSegments(device);
+    // first and last cycle traced by each shire while executing each kernel
+    std::map<std::pair<size_t, uint16_t>, std::pair<uint64_t, uint64_t>> kernelShireSpans;
+    std::map<uint16_t, bool> tracedShires;
+    const auto& deviceKernels = kernels[device];
+    for (const auto& trace : traces) {
+      forEachTraceEntry(trace, [&](const trace_entry_header_t& entry) {
+        auto shire = static_cast<uint16_t>(entry.hart_id / kHartsPerShire);
+        auto tid = kShireTidBase + shire;
+        tracedShires.try_emplace(shire, true);
+        deviceKernels.forEachExecuting(entry.cycle, [&kernelShireSpans, shire, cycle = entry.cycle](size_t i) {
+          auto [it, inserted] = kernelShireSpans.try_emplace({i, shire}, cycle, cycle);
+          if (!inserted) {
+            it->second.first = std::min(it->second.first, cycle);
+            it->second.second = std::max(it->second.second, cycle);
+          }
+        });
+        if (entry.type == TRACE_TYPE_STRING || entry.type == TRACE_TYPE_STRING_DEFERRED) {
+          auto args = std::string{};
+          addArg(args, "hart_id", std::to_string(entry.hart_id));
+          auto ts = writer.toUs(toHostTime(*calibration, entry.cycle));
+          writer.write(TraceEvent{getTraceString(entry, segments), 'i', ts, pid, tid, std::nullopt, args});
+        }
+      });
+    }
+    for (const auto& [shire, _] : tracedShires) {
+      writer.writeName("thread_name", pid, kShireTidBase + shire, "Shire " + std::to_string(shire));
+    }
+    for (const auto& [key, span] : kernelShireSpans) {
+      const auto& kernel = deviceKernels.kernels_[key.first];
+      auto args = std::string{};
+      addArg(args, ProfileEvent::kEventId, std::to_string(static_cast<int>(kernel.event_)));
+      auto startUs = writer.toUs(toHostTime(*calibration, span.first));
+      auto endUs = writer.toUs(toHostTime(*calibration, span.second));
+      writer.write(TraceEvent{"Kernel " + std::to_string(static_cast<int>(kernel.event_)), 'X', startUs, pid,
+                              kShireTidBase + key.second, endUs - startUs, args});
+    }
+  }
+}
+
+} // namespace rt::profiling
@@ -0,0 +1,398 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) 2025 Ainekko, Co.
+ * SPDX-License-Identifier: Apache-2.0
+ *-------------------------------------------------------------------------*/
+
+#include "runtime/Collectives.h"
+#include "Utils.h"
+#include <algorithm>
+#include <limits>
+#include <sstream>
+#include <string>
+
+using namespace rt;
+
+namespace {
+constexpr auto kNone = std::numeric_limits<size_t>::max();
+
+// looks for a cycle through all the devices following the links, starting from device 0
+bool findRing(const std::vector<std::vector<bool>>& links, std::vector<size_t>& ring, std::vector<bool>& visited) {
+  auto n = links.size();
+  if (ring.size() == n) {
+    return n <= 2 || links[ring.back()][ring.front()];
+  }
+  for (size_t next = 0; next < n; ++next) {
+    if (!visited[next] && links[ring.back()][next]) {
+      visited[next] = true;
+      ring.emplace_back(next);
+      if (findRing(links, ring, visited)) {
+        return true;
+      }
+      ring.pop_back();
+      visited[next] = false;
+    }
+  }
+  return false;
+}
+} // namespace
+
+Communicator::Communicator(IRuntime& runtime, std::vector<DeviceId> devices, size_t chunkSize)
+  : Communicator(runtime, std::move(devices), chunkSize, std::nullopt) {
+}
+
+Communicator::Communicator(IRuntime& runtime, DeviceGroupId group, size_t chunkSize)
+  : Communicator(runtime, runtime.getDeviceGroupDevices(group), chunkSize, group) {
+}
+
+Communicator::Communicator(IRuntime& runtime, std::vector<DeviceId> devices, size_t chunkSize,
+                           std::optional<DeviceGroupId> group)
+  : runtime_(runtime)
+  , devices_(std::move(devices))
+  , ownsStreams_(!group) {
+  auto n = devices_.size();
+  if (n == 0) {
+    throw Exception("A communicator needs at least one device");
+  }
+  for (size_t i = 0; i < n; ++i) {
+    if (std::find(begin(devices_) + static_cast<long>(i) + 1, end(devices_), devices_[i]) != end(devices_)) {
+      throw Exception("Device " + std::to_string(static_cast<int>(devices_[i])) + " is repeated in the communicator");
+    }
+  }
+  chunkSize_ = chunkSize;
+  for (auto d : devices_) {
+    chunkSize_ = std::min<size_t>(chunkSize_, runtime_.getDmaInfo(d).maxElementSize_);
+  }
+  chunkSize_ -= chunkSize_ % kCacheLineSize;
+  if (chunkSize_ == 0) {
+    throw Exception("Communicator chunk size must be at least " + std::to_string(kCacheLineSize) + " bytes");
+  }
+
+  // memcpys are queued into the destination stream, both sides have to be able to reach the other
+  links_.assign(n, std::vector<bool>(n, false));
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t j = i + 1; j < n; ++j) {
+      links_[i][j] = links_[j][i] =
+        runtime_.isP2PEnabled(devices_[i], devices_[j]) && runtime_.isP2PEnabled(devices_[j], devices_[i]);
+    }
+  }
+  std::vector<bool> visited(n, false);
+  visited[0] = true;
+  ring_.emplace_back(0);
+  if (!findRing(links_, ring_, visited)) {
+    ring_.clear();
+    auto [parents, order] = buildTree(0);
+    if (order.size() != n) {
+      auto missing = std::find(begin(parents) + 1, end(parents), kNone) - begin(parents);
+      std::stringstream ss;
+      ss << "Device " << static_cast<int>(devices_[static_cast<size_t>(missing)]) << " can't be reached from device "
+         << static_cast<int>(devices_[0]) << " through P2P memcpys";
+      throw Exception(ss.str());
+    }
+  }
+  RT_VLOG(LOW) << "Communicator of " << n << " devices, topology: " << (ring_.empty() ? "tree" : "ring")
+               << " chunk size: " << chunkSize_;
+
+  for (auto d : devices_) {
+    streams_.emplace_back(group ? runtime_.getDeviceGroupStream(*group, d) : runtime_.createStream(d));
+  }
+  scratch_.resize(n, nullptr);
+  scratchSizes_.resize(n, 0);
+}
+
+Communicator::~Communicator() {
+  for (size_t i = 0; i < devices_.size(); ++i) {
+    try {
+      runtime_.waitForStream(streams_[i]);
+      if (ownsStreams_) {
+        runtime_.destroyStream(streams_[i]);
+      }
+      if (scratch_[i] != nullptr) {
+        runtime_.freeDevice(devices_[i], scratch_[i]);
+      }
+    } catch (const Exception& e) {
+      RT_LOG(WARNING) << "Couldn't release communicator resources of device " << static_cast<int>(devices_[i])
+                      << ". Error: " << e.what();
+    }
+  }
+}
+
+CollectiveTopology Communicator::getTopology() const {
+  return ring_.empty() ? CollectiveTopology::Tree : CollectiveTopology::Ring;
+}
+
+std::vector<DeviceId> Communicator::getRing() const {
+  std::vector<DeviceId> res;
+  for (auto idx : ring_) {
+    res.emplace_back(devices_[idx]);
+  }
+  return res;
+}
+
+StreamId Communicator::getStream(DeviceId device) const {
+  return streams_[getIndex(device)];
+}
+
+size_t Communicator::getIndex(DeviceId device) const {
+  auto it = std::find(begin(devices_), end(devices_), device);
+  if (it == end(devices_)) {
+    throw Exception("Device " + std::to_string(static_cast<int>(device)) + " doesn't belong to the communicator");
+  }
+  return static_cast<size_t>(it - begin(devices_));
+}
+
+void Communicator::checkBuffers(const std::vector<std::byte*>& buffers) const {
+  if (buffers.size() != devices_.size()) {
+    throw Exception("Expected " + std::to_string(devices_.size()) + " buffers, one per device, got " +
+                    std::to_string(buffers.size()));
+  }
+}
+
+std::vector<Communicator::Chunk> Communicator::split(size_t offset, size_t size) const {
+  std::vector<Chunk> res;
+  for (size_t done = 0; done < size; done += chunkSize_) {
+    res.emplace_back(Chunk{offset + done, std::min(chunkSize_, size - done)});
+  }
+  return res;
+}
+
+Communicator::Tree Communicator::buildTree(size_t root) const {
+  auto n = devices_.size();
+  std::vector<size_t> parents(n, kNone);
+  std::vector<size_t> order{root};
+  parents[root] = root;
+  if (!ring_.empty()) {
+    // chain following the ring
+    auto pos = static_cast<size_t>(std::find(begin(ring_), end(ring_), root) - begin(ring_));
+    for (size_t hop = 1; hop < n; ++hop) {
+      auto idx = ring_[(pos + hop) % n];
+      parents[idx] = order.back();
+      order.emplace_back(idx);
+    }
+    return {parents, order};
+  }
+  // breadth first, so the tree is as shallow as possible
+  for (size_t i = 0; i < order.size(); ++i) {
+    for (size_t next = 0; next < n; ++next) {
+      if (parents[next] == kNone && links_[order[i]][next]) {
+        parents[next] = order[i];
+        order.emplace_back(next);
+      }
+    }
+  }
+  return {parents, order};
+}
+
+std::byte* Communicator::getScratch(size_t idx, size_t size) {
+  if (scratchSizes_[idx] < size) {
+    // only called once the previous collectives are done, see waitForPreviousWork
+    if (scratch_[idx] != nullptr) {
+      runtime_.freeDevice(devices_[idx], scratch_[idx]);
+      scratch_[idx] = nullptr;
+      scratchSizes_[idx] = 0;
+    }
+    scratch_[idx] = runtime_.mallocDevice(devices_[idx], size);
+    scratchSizes_[idx] = size;
+  }
+  return scratch_[idx];
+}
+
+void Communicator::waitForPreviousWork() {
+  for (auto st : streams_) {
+    if (!runtime_.waitForStream(st)) {
+      throw Exception("Timeout waiting for the communicator streams");
+    }
+  }
+  lastEvents_.assign(devices_.size(), std::nullopt);
+}
+
+void Communicator::wait(const std::optional<EventId>& event) {
+  if (event && !runtime_.waitForEvent(*event)) {
+    throw Exception("Timeout waiting for event " + std::to_string(static_cast<int>(*event)));
+  }
+}
+
+EventId Communicator::copy(size_t src, size_t dst, const std::byte* d_src, std::byte* d_dst, size_t size,
+                           bool barrier) {
+  auto evt = runtime_.memcpyDeviceToDevice(devices_[src], streams_[dst], d_src, d_dst, size, barrier);
+  lastEvents_[dst] = evt;
+  return evt;
+}
+
+EventId Communicator::reduce(size_t idx, std::byte* d_dst, const std::byte* d_src, size_t size, const ReduceOp& op) {
+  auto it = op.kernels_.find(devices_[idx]);
+  if (it == end(op.kernels_)) {
+    throw Exception("No reduction kernel for device " + std::to_string(static_cast<int>(devices_[idx])));
+  }
+  auto args = op.makeArgs_(d_dst, d_src, size);
+  auto options = op.options_;
+  options.setBarrier(true);
+  auto evt = runtime_.kernelLaunch(streams_[idx], it->second, args.data(), args.size(), options);
+  lastEvents_[idx] = evt;
+  return evt;
+}
+
+std::vector<EventId> Communicator::getLastEvents() {
+  std::vector<EventId> res;
+  for (const auto& evt : lastEvents_) {
+    if (evt) {
+      res.emplace_back(*evt);
+    }
+  }
+  lastEvents_.clear();
+  return res;
+}
+
+std::vector<EventId> Communicator::broadcast(DeviceId root, const std::vector<std::byte*>& buffers, size_t size) {
+  checkBuffers(buffers);
+  auto rootIdx = getIndex(root);
+  waitForPreviousWork();
+  propagate({buildTree(rootIdx)}, buffers, {0}, size);
+  return getLastEvents();
+}
+
+std::vector<EventId> Communicator::allGather(const std::vector<std::byte*>& buffers, size_t size) {
+  checkBuffers(buffers);
+  waitForPreviousWork();
+  // each block is broadcasted from its owner; on a ring this is the usual ring all-gather, each link carries n - 1
+  // blocks
+  std::vector<Tree> trees;
+  std::vector<size_t> offsets;
+  for (size_t i = 0; i < devices_.size(); ++i) {
+    trees.emplace_back(buildTree(i));
+    offsets.emplace_back(i * size);
+  }
+  propagate(trees, buffers, offsets, size);
+  return getLastEvents();
+}
+
+std::vector<EventId> Communicator::allReduce(const std::vector<std::byte*>& buffers, size_t size,
+                                             const ReduceOp& op) {
+  checkBuffers(buffers);
+  if (!op.makeArgs_) {
+    throw Exception("The reduction has no kernel arguments builder");
+  }
+  waitForPreviousWork();
+  if (devices_.size() > 1 && size > 0) {
+    if (ring_.empty()) {
+      treeAllReduce(buffers, size, op);
+    } else {
+      ringAllReduce(buffers, size, op);
+    }
+  }
+  return getLastEvents();
+}
+
+void Communicator::propagate(const std::vector<Tree>& trees, const std::vector<std::byte*>& buffers,
+                             const std::vector<size_t>& offsets, size_t size) {
+  auto n = devices_.size();
+  auto chunks = split(0, size);
+  // ready[tree][device][chunk]
+  std::vector<ChunkEvents> ready(trees.size(), ChunkEvents(n, std::vector<std::optional<EventId>>(chunks.size())));
+  // going level by level, so all the trees progress at once and each chunk only waits for its arrival to the parent
+  for (size_t pos = 1; pos < n; ++pos) {
+    for (size_t c = 0; c < chunks.size(); ++c) {
+      for (size_t t = 0; t < trees.size(); ++t) {
+        const auto& [parents, order] = trees[t];
+        auto dst = order[pos];
+        auto src = parents[dst];
+        auto offset = offsets[t] + chunks[c].offset_;
+        wait(ready[t][src][c]);
+        ready[t][dst][c] = copy(src, dst, buffers[src] + offset, buffers[dst] + offset, chunks[c].size_, false);
+      }
+    }
+  }
+}
+
+void Communicator::ringAllReduce(const std::vector<std::byte*>& buffers, size_t size, const ReduceOp& op) {
+  auto n = ring_.size();
+  // the data is split in one segment per device, each one goes around the ring being reduced (reduce-scatter) till
+  // it's complete in a device, then it goes around once more to be copied to the others (all-gather)
+  auto segmentSize = align((size + n - 1) / n, kCacheLineSize);
+  std::vector<std::vector<Chunk>> segments;
+  for (size_t s = 0; s < n; ++s) {
+    auto offset = std::min(s * segmentSize, size);
+    segments.emplace_back(split(offset, std::min(segmentSize, size - offset)));
+  }
+  auto maxChunks = segments.front().size();
+  std::vector<std::byte*> scratch(n);
+  for (size_t k = 0; k < n; ++k) {
+    scratch[k] = getScratch(k, size);
+  }
+  // ready[k][s][c]: the chunk held by ring position k is up to date, read[k][s][c]: it's been copied to the next one
+  std::vector<ChunkEvents> ready(n, ChunkEvents(n, std::vector<std::optional<EventId>>(maxChunks)));
+  auto read = ready;
+
+  for (size_t step = 0; step + 1 < n; ++step) {
+    for (size_t c = 0; c < maxChunks; ++c) {
+      for (size_t k = 0; k < n; ++k) {
+        auto s = (k + n - step) % n;
+        if (c >= segments[s].size()) {
+          continue;
+        }
+        auto next = (k + 1) % n;
+        auto src = ring_[k];
+        auto dst = ring_[next];
+        const auto& chunk = segments[s][c];
+        wait(ready[k][s][c]);
+        // segments arrive to different scratch areas, so the copy doesn't need to wait for the previous reductions
+        read[k][s][c] =
+          copy(src, dst, buffers[src] + chunk.offset_, scratch[dst] + chunk.offset_, chunk.size_, false);
+        ready[next][s][c] = reduce(dst, buffers[dst] + chunk.offset_, scratch[dst] + chunk.offset_, chunk.size_, op);
+      }
+    }
+  }
+  // now ring position k holds the complete segment k + 1
+  for (size_t step = 0; step + 1 < n; ++step) {
+    for (size_t c = 0; c < maxChunks; ++c) {
+      for (size_t k = 0; k < n; ++k) {
+        auto s = (k + 1 + n - step) % n;
+        if (c >= segments[s].size()) {
+          continue;
+        }
+        auto next = (k + 1) % n;
+        auto src = ring_[k];
+        auto dst = ring_[next];
+        const auto& chunk = segments[s][c];
+        wait(ready[k][s][c]);
+        // the partial result of the next one has to be sent before it's overwritten
+        wait(read[next][s][c]);
+        ready[next][s][c] =
+          copy(src, dst, buffers[src] + chunk.offset_, buffers[dst] + chunk.offset_, chunk.size_, false);
+      }
+    }
+  }
+}
+
+void Communicator::treeAllReduce(const std::vector<std::byte*>& buffers, size_t size, const ReduceOp& op) {
+  auto n = devices_.size();
+  auto [parents, order] = buildTree(0);
+  auto chunks = split(0, size);
+  // ready[i][c]: the chunk of device i is up to date, read[i][c]: it's been copied to its parent
+  ChunkEvents ready(n, std::vector<std::optional<EventId>>(chunks.size()));
+  auto read = ready;
+
+  // reduction towards the root, children go before their parents
+  for (auto pos = n - 1; pos > 0; --pos) {
+    auto src = order[pos];
+    auto dst = parents[src];
+    auto scratch = getScratch(dst, size);
+    for (size_t c = 0; c < chunks.size(); ++c) {
+      const auto& chunk = chunks[c];
+      wait(ready[src][c]);
+      // the scratch chunk is shared by all the children, barrier so it's not overwritten before being reduced
+      read[src][c] = copy(src, dst, buffers[src] + chunk.offset_, scratch + chunk.offset_, chunk.size_, true);
+      ready[dst][c] = reduce(dst, buffers[dst] + chunk.offset_, scratch + chunk.offset_, chunk.size_, op);
+    }
+  }
+  // and back from the root
+  for (size_t pos = 1; pos < n; ++pos) {
+    auto dst = order[pos];
+    auto src = parents[dst];
+    for (size_t c = 0; c < chunks.size(); ++c) {
+      const auto& chunk = chunks[c];
+      wait(ready[src][c]);
+      wait(read[dst][c]);
+      ready[dst][c] = copy(src, dst, buffers[src] + chunk.offset_, buffers[dst] + chunk.offset_, chunk.size_, false);
+    }
+  }
+}
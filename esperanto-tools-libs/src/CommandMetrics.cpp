@@ -0,0 +1,327 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) 2025 Ainekko, Co.
+ * SPDX-License-Identifier: Apache-2.0
+ *-------------------------------------------------------------------------*/
+
+#include "CommandMetrics.h"
+
+#include "CommandSender.h"
+#include "Utils.h"
+
+#include <esperanto/device-apis/operations-api/device_ops_api_cxx.h>
+#include <esperanto/device-apis/operations-api/device_ops_api_rpc_types.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <optional>
+
+using namespace rt;
+
+size_t LatencyHistogram::getBucket(uint64_t value) {
+  auto bitWidth = value == 0 ? 0U : static_cast<uint32_t>(64 - __builtin_clzll(value));
+  auto shift = bitWidth > kSubBucketBits + 1 ? bitWidth - kSubBucketBits - 1 : 0U;
+  return static_cast<size_t>(shift * kSubBuckets + (value >> shift));
+}
+
+uint64_t LatencyHistogram::getBucketUpperBound(size_t bucket) {
+  if (bucket < 2 * kSubBuckets) {
+    return bucket;
+  }
+  auto shift = bucket / kSubBuckets - 1;
+  auto top = bucket - shift * kSubBuckets;
+  if (top + 1 == 2 * kSubBuckets && shift + kSubBucketBits + 1 == 64) {
+    return std::numeric_limits<uint64_t>::max();
+  }
+  return ((top + 1) << shift) - 1;
+}
+
+uint64_t LatencyHistogram::getPercentile(double percentile) const {
+  if (count_ == 0) {
+    return 0;
+  }
+  auto target = std::max<uint64_t>(static_cast<uint64_t>(std::ceil(percentile * static_cast<double>(count_))), 1);
+  uint64_t accumulated = 0;
+  for (size_t i = 0; i < counts_.size(); ++i) {
+    accumulated += counts_[i];
+    if (accumulated >= target) {
+      return std::min(getBucketUpperBound(i), max_);
+    }
+  }
+  return max_;
+}
+
+namespace {
+int64_t toEpochNs(CommandMetrics::Clock::time_point t) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+}
+
+std::optional<CommandKind> getKind(profiling::ResponseType type) {
+  switch (type) {
+  case profiling::ResponseType::Kernel:
+    return CommandKind::KernelLaunch;
+  case profiling::ResponseType::DMAWrite:
+    return CommandKind::MemcpyHostToDevice;
+  case profiling::ResponseType::DMARead:
+    return CommandKind::MemcpyDeviceToHost;
+  default:
+    return std::nullopt;
+  }
+}
+
+// bytes moved by a host DMA list command, 0 for any other command
+uint64_t getDmaBytes(const Command& command) {
+  using namespace device_ops_api;
+  const auto& data = command.commandData_;
+  if (!command.isDma_ || command.isP2P_ || data.size() < offsetof(device_ops_dma_readlist_cmd_t, list)) {
+    return 0;
+  }
+  uint64_t bytes = 0;
+  for (auto offset = offsetof(device_ops_dma_readlist_cmd_t, list); offset + sizeof(dma_write_node) <= data.size();
+       offset += sizeof(dma_write_node)) {
+    dma_write_node node;
+    memcpy(&node, data.data() + offset, sizeof(node));
+    bytes += node.size;
+  }
+  return bytes;
+}
+
+// shards of the current thread, one per CommandMetrics instance it has recorded to
+struct ThreadShard {
+  ThreadShard(uint64_t metricsId, std::shared_ptr<CommandMetrics::Shard> shard)
+    : metricsId_(metricsId)
+    , shard_(std::move(shard)) {
+  }
+  ThreadShard(ThreadShard&&) = default;
+  ThreadShard& operator=(ThreadShard&&) = default;
+  ~ThreadShard() {
+    if (shard_) {
+      shard_->abandoned_ = true;
+    }
+  }
+  uint64_t metricsId_;
+  std::shared_ptr<CommandMetrics::Shard> shard_;
+};
+thread_local std::vector<ThreadShard> threadShards;
+
+std::atomic<uint64_t> nextMetricsId = 0;
+} // namespace
+
+void CommandMetrics::Histogram::add(uint64_t value) {
+  // only the owning thread writes, so there is no need for read-modify-write operations
+  auto& bucket = counts_[LatencyHistogram::getBucket(value)];
+  bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  count_.store(count_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  sum_.store(sum_.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+  if (value < min_.load(std::memory_order_relaxed)) {
+    min_.store(value, std::memory_order_relaxed);
+  }
+  if (value > max_.load(std::memory_order_relaxed)) {
+    max_.store(value, std::memory_order_relaxed);
+  }
+}
+
+void CommandMetrics::Histogram::mergeInto(LatencyHistogram& histogram) const {
+  auto count = count_.load(std::memory_order_relaxed);
+  if (count == 0) {
+    return;
+  }
+  for (size_t i = 0; i < counts_.size(); ++i) {
+    histogram.counts_[i] += counts_[i].load(std::memory_order_relaxed);
+  }
+  auto min = min_.load(std::memory_order_relaxed);
+  histogram.min_ = histogram.count_ == 0 ? min : std::min(histogram.min_, min);
+  histogram.max_ = std::max(histogram.max_, max_.load(std::memory_order_relaxed));
+  histogram.count_ += count;
+  histogram.sum_ += sum_.load(std::memory_order_relaxed);
+}
+
+CommandMetrics::CommandMetrics(std::vector<uint32_t> frequencies)
+  : id_(nextMetricsId++)
+  , frequencies_(std::move(frequencies))
+  , commands_(std::make_unique<CommandTimes[]>(size_t{std::numeric_limits<std::underlying_type_t<EventId>>::max()} +
+                                               1)) {
+}
+
+CommandMetrics::~CommandMetrics() {
+  SpinLock lock(shardsMutex_);
+  for (auto& shard : shards_) {
+    shard->closed_ = true;
+  }
+}
+
+CommandMetrics::Shard& CommandMetrics::getThreadShard() {
+  for (auto& threadShard : threadShards) {
+    if (threadShard.metricsId_ == id_) {
+      return *threadShard.shard_;
+    }
+  }
+  // first record of this thread, get rid of the shards of the metrics already destroyed
+  threadShards.erase(std::remove_if(begin(threadShards), end(threadShards),
+                                    [](const auto& threadShard) { return threadShard.shard_->closed_.load(); }),
+                     end(threadShards));
+  SpinLock lock(shardsMutex_);
+  // threads come and go (i.e. callback threads), so keep the accumulated values of the finished ones reusing their
+  // shards instead of creating a new one each time
+  auto it = std::find_if(begin(shards_), end(shards_), [](const auto& shard) { return shard->abandoned_.load(); });
+  std::shared_ptr<Shard> shard;
+  if (it != end(shards_)) {
+    shard = *it;
+    shard->abandoned_ = false;
+  } else {
+    shard = shards_.emplace_back(std::make_shared<Shard>(frequencies_.size()));
+  }
+  lock.unlock();
+  return *threadShards.emplace_back(id_, std::move(shard)).shard_;
+}
+
+uint64_t CommandMetrics::toNs(DeviceId device, uint64_t cycles) const {
+  auto idx = static_cast<size_t>(device);
+  auto frequency = idx < frequencies_.size() ? frequencies_[idx] : 0U;
+  return frequency == 0 ? 0 : cycles * 1000 / frequency;
+}
+
+void CommandMetrics::setTiming(CommandTimes& times, const std::optional<EventTiming>& timing) {
+  // writers of an event id are serialized by its command lifecycle, so only the readers need the sequence check
+  auto seq = times.timingSeq_.load(std::memory_order_relaxed);
+  times.timingSeq_.store(seq + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  times.hasTiming_.store(timing.has_value(), std::memory_order_relaxed);
+  if (timing) {
+    times.timingDevice_.store(static_cast<int32_t>(timing->device_), std::memory_order_relaxed);
+    times.startCycles_.store(timing->startCycles_, std::memory_order_relaxed);
+    times.waitCycles_.store(timing->waitCycles_, std::memory_order_relaxed);
+    times.execCycles_.store(timing->executionCycles_, std::memory_order_relaxed);
+  }
+  times.timingSeq_.store(seq + 2, std::memory_order_release);
+}
+
+std::optional<EventTiming> CommandMetrics::getEventTiming(EventId event) const {
+  const auto& times = commands_[static_cast<size_t>(event)];
+  while (true) {
+    auto seq = times.timingSeq_.load(std::memory_order_acquire);
+    if (seq % 2 != 0) {
+      continue;
+    }
+    std::optional<EventTiming> result;
+    if (times.hasTiming_.load(std::memory_order_relaxed)) {
+      result.emplace();
+      result->device_ = DeviceId{times.timingDevice_.load(std::memory_order_relaxed)};
+      result->startCycles_ = times.startCycles_.load(std::memory_order_relaxed);
+      result->waitCycles_ = times.waitCycles_.load(std::memory_order_relaxed);
+      result->executionCycles_ = times.execCycles_.load(std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (times.timingSeq_.load(std::memory_order_relaxed) == seq) {
+      if (result) {
+        result->frequencyMhz_ = frequencies_[static_cast<size_t>(result->device_)];
+      }
+      return result;
+    }
+  }
+}
+
+void CommandMetrics::onCommandQueued(const Command& command, Clock::time_point now) {
+  auto& times = commands_[static_cast<size_t>(command.eventId_)];
+  setTiming(times, std::nullopt);
+  times.sending_.store(0, std::memory_order_relaxed);
+  times.received_.store(0, std::memory_order_relaxed);
+  times.kind_.store(-1, std::memory_order_relaxed);
+  times.queued_.store(toEpochNs(now), std::memory_order_release);
+}
+
+void CommandMetrics::onCommandSending(const Command& command, Clock::time_point now) {
+  auto& times = commands_[static_cast<size_t>(command.eventId_)];
+  times.bytes_.store(getDmaBytes(command), std::memory_order_relaxed);
+  // released before the command reaches the device, so its response can't be processed before this is visible
+  times.sending_.store(toEpochNs(now), std::memory_order_release);
+}
+
+void CommandMetrics::onResponse(DeviceId device, EventId event, profiling::ResponseType type, uint64_t startCycles,
+                                uint64_t waitCycles, uint64_t execCycles, Clock::time_point now) {
+  auto kind = getKind(type);
+  auto deviceIdx = static_cast<size_t>(device);
+  if (!kind || deviceIdx >= frequencies_.size()) {
+    return;
+  }
+  auto& times = commands_[static_cast<size_t>(event)];
+  setTiming(times, EventTiming{device, startCycles, waitCycles, execCycles, 0});
+  times.timingFresh_.store(true, std::memory_order_relaxed);
+  auto queued = times.queued_.load(std::memory_order_acquire);
+  auto sending = times.sending_.load(std::memory_order_acquire);
+  auto received = toEpochNs(now);
+  if (queued == 0 || sending < queued || received < sending) {
+    // not sent through a command sender
+    return;
+  }
+  times.queued_.store(0, std::memory_order_relaxed);
+  times.device_.store(static_cast<int32_t>(deviceIdx), std::memory_order_relaxed);
+  times.kind_.store(static_cast<int32_t>(*kind), std::memory_order_relaxed);
+  times.received_.store(received, std::memory_order_release);
+
+  auto& shard = getThreadShard().devices_[deviceIdx];
+  auto& latencies = shard.latencies_[static_cast<size_t>(*kind)];
+  auto execNs = toNs(device, execCycles);
+  latencies[static_cast<size_t>(LatencyStage::SubmitToStart)].add(static_cast<uint64_t>(sending - queued) +
+                                                                  toNs(device, waitCycles));
+  latencies[static_cast<size_t>(LatencyStage::Execution)].add(execNs);
+  if (*kind != CommandKind::KernelLaunch) {
+    auto idx = static_cast<size_t>(*kind) - static_cast<size_t>(CommandKind::MemcpyHostToDevice);
+    auto bytes = times.bytes_.load(std::memory_order_relaxed);
+    shard.bytes_[idx].store(shard.bytes_[idx].load(std::memory_order_relaxed) + bytes, std::memory_order_relaxed);
+    shard.execNs_[idx].store(shard.execNs_[idx].load(std::memory_order_relaxed) + execNs, std::memory_order_relaxed);
+  }
+}
+
+void CommandMetrics::onDispatching(EventId event) {
+  // the events which are not commands (i.e. memcpys split in several commands) must not show the timing left by an
+  // older command with the same id
+  auto& times = commands_[static_cast<size_t>(event)];
+  if (!times.timingFresh_.exchange(false, std::memory_order_relaxed) &&
+      times.hasTiming_.load(std::memory_order_relaxed)) {
+    setTiming(times, std::nullopt);
+  }
+}
+
+void CommandMetrics::onDispatched(EventId event, Clock::time_point now) {
+  auto& times = commands_[static_cast<size_t>(event)];
+  auto received = times.received_.load(std::memory_order_acquire);
+  auto kind = times.kind_.load(std::memory_order_relaxed);
+  auto woken = toEpochNs(now);
+  if (received == 0 || kind < 0 || woken < received) {
+    return;
+  }
+  times.received_.store(0, std::memory_order_relaxed);
+  auto deviceIdx = static_cast<size_t>(times.device_.load(std::memory_order_relaxed));
+  auto& shard = getThreadShard().devices_[deviceIdx];
+  shard.latencies_[static_cast<size_t>(kind)][static_cast<size_t>(LatencyStage::CompletionToWake)].add(
+    static_cast<uint64_t>(woken - received));
+}
+
+std::unordered_map<DeviceId, DeviceMetrics> CommandMetrics::getMetrics() const {
+  std::unordered_map<DeviceId, DeviceMetrics> result;
+  std::vector<std::array<uint64_t, 2>> execNs(frequencies_.size());
+  SpinLock lock(shardsMutex_);
+  for (size_t d = 0; d < frequencies_.size(); ++d) {
+    auto& metrics = result[DeviceId{static_cast<int>(d)}];
+    for (const auto& shard : shards_) {
+      const auto& deviceShard = shard->devices_[d];
+      for (size_t k = 0; k < deviceShard.latencies_.size(); ++k) {
+        for (size_t s = 0; s < deviceShard.latencies_[k].size(); ++s) {
+          deviceShard.latencies_[k][s].mergeInto(metrics.latencies_[k][s]);
+        }
+      }
+      metrics.bytesHostToDevice_ += deviceShard.bytes_[0].load(std::memory_order_relaxed);
+      metrics.bytesDeviceToHost_ += deviceShard.bytes_[1].load(std::memory_order_relaxed);
+      execNs[d][0] += deviceShard.execNs_[0].load(std::memory_order_relaxed);
+      execNs[d][1] += deviceShard.execNs_[1].load(std::memory_order_relaxed);
+    }
+    auto toBytesPerSecond = [](uint64_t bytes, uint64_t ns) {
+      return ns == 0 ? 0.0 : static_cast<double>(bytes) * 1e9 / static_cast<double>(ns);
+    };
+    metrics.bytesPerSecondHostToDevice_ = toBytesPerSecond(metrics.bytesHostToDevice_, execNs[d][0]);
+    metrics.bytesPerSecondDeviceToHost_ = toBytesPerSecond(metrics.bytesDeviceToHost_, execNs[d][1]);
+  }
+  return result;
+}
@@ -0,0 +1,109 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) 2025 Ainekko, Co.
+ * SPDX-License-Identifier: Apache-2.0
+ *-------------------------------------------------------------------------*/
+
+#pragma once
+
+#include "runtime/IMonitor.h"
+#include "runtime/IProfileEvent.h"
+#include "runtime/Types.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace rt {
+struct Command;
+
+// Latency histograms and DMA counters of the commands sent to the devices, see IMonitor::getDeviceMetrics. Recording
+// is lock free: each thread accumulates into a shard of its own (the mutex is only taken the first time a thread
+// records) and the shards are merged when the metrics are queried.
+class CommandMetrics {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  // frequencies of the device cycle counters in Mhz, indexed by device
+  explicit CommandMetrics(std::vector<uint32_t> frequencies);
+  ~CommandMetrics();
+
+  // called by the command sender when the command is queued and right before sending it to the device
+  void onCommandQueued(const Command& command, Clock::time_point now = Clock::now());
+  void onCommandSending(const Command& command, Clock::time_point now = Clock::now());
+  // called when the response of a command is received, with the device cycle it started at and the cycles it waited
+  // and executed
+  void onResponse(DeviceId device, EventId event, profiling::ResponseType type, uint64_t startCycles,
+                  uint64_t waitCycles, uint64_t execCycles, Clock::time_point now = Clock::now());
+  // called right before and after the waiters of the event are woken up
+  void onDispatching(EventId event);
+  void onDispatched(EventId event, Clock::time_point now = Clock::now());
+
+  std::unordered_map<DeviceId, DeviceMetrics> getMetrics() const;
+
+  // device timing of the last kernel launch or DMA command completed with the given event id, see
+  // IRuntime::getEventTiming
+  std::optional<EventTiming> getEventTiming(EventId event) const;
+
+  // the accumulators of a thread, only written by it
+  struct Histogram {
+    void add(uint64_t value);
+    void mergeInto(LatencyHistogram& histogram) const;
+
+    std::array<std::atomic<uint64_t>, LatencyHistogram::kNumBuckets> counts_{};
+    std::atomic<uint64_t> count_ = 0;
+    std::atomic<uint64_t> sum_ = 0;
+    std::atomic<uint64_t> min_ = std::numeric_limits<uint64_t>::max();
+    std::atomic<uint64_t> max_ = 0;
+  };
+  struct DeviceShard {
+    std::array<std::array<Histogram, static_cast<size_t>(LatencyStage::COUNT)>, static_cast<size_t>(CommandKind::COUNT)>
+      latencies_;
+    std::array<std::atomic<uint64_t>, 2> bytes_{};  // indexed by kind - MemcpyHostToDevice
+    std::array<std::atomic<uint64_t>, 2> execNs_{}; // same
+  };
+  struct Shard {
+    explicit Shard(size_t numDevices)
+      : devices_(std::make_unique<DeviceShard[]>(numDevices)) {
+    }
+    std::unique_ptr<DeviceShard[]> devices_;
+    std::atomic<bool> abandoned_ = false; // the thread owning it has finished, another one can take it
+    std::atomic<bool> closed_ = false;    // the metrics have been destroyed
+  };
+
+private:
+  Shard& getThreadShard();
+  uint64_t toNs(DeviceId device, uint64_t cycles) const;
+
+  // timestamps of the in flight commands, indexed by event id. Written by the command sender and response threads
+  struct CommandTimes {
+    std::atomic<int64_t> queued_ = 0; // ns since the clock epoch, 0 if not queued
+    std::atomic<int64_t> sending_ = 0;
+    std::atomic<uint64_t> bytes_ = 0;
+    std::atomic<int64_t> received_ = 0;
+    std::atomic<int32_t> kind_ = -1; // CommandKind of the received response, -1 if none
+    std::atomic<int32_t> device_ = 0;
+    // device timing of the response, seqlock protected: odd while being written
+    std::atomic<uint32_t> timingSeq_ = 0;
+    std::atomic<bool> hasTiming_ = false;
+    std::atomic<bool> timingFresh_ = false; // set by the response of the current use of the event id
+    std::atomic<int32_t> timingDevice_ = 0;
+    std::atomic<uint64_t> startCycles_ = 0;
+    std::atomic<uint64_t> waitCycles_ = 0;
+    std::atomic<uint64_t> execCycles_ = 0;
+  };
+  static void setTiming(CommandTimes& times, const std::optional<EventTiming>& timing);
+
+  const uint64_t id_;
+  std::vector<uint32_t> frequencies_;
+  std::unique_ptr<CommandTimes[]> commands_;
+  mutable std::mutex shardsMutex_;
+  std::vector<std::shared_ptr<Shard>> shards_;
+};
+
+} // namespace rt
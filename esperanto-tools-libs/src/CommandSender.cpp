@@ -4,6 +4,7 @@
  *-------------------------------------------------------------------------*/
 #include "CommandSender.h"
 
+#include "CommandMetrics.h"
 #include "Utils.h"
 
 #include <device-layer/IDeviceLayer.h>
@@ -16,9 +17,9 @@
 
 using namespace rt;
 
-std::string commandString(const std::vector<std::byte>& commandData);
+std::string commandString(const CommandData& commandData);
 
-std::string commandString(const std::vector<std::byte>& commandData) {
+std::string commandString(const CommandData& commandData) {
   std::stringstream ss;
   ss << "Sent command: 0x";
   for (auto byte : commandData) {
@@ -27,21 +28,17 @@ std::string commandString(const std::vector<std::byte>& commandData) {
   return ss.str();
 }
 
-template <typename List> std::string getCommandPtrs(List& commands) {
-  std::stringstream ss;
-  ss << "|";
-  for (auto it = begin(commands); it != end(commands); ++it) {
-    ss << std::hex << &*it << " enabled? " << (it->isEnabled_ ? "True" : "False") << "|";
-  }
-  return ss.str();
-}
-
 CommandSender::CommandSender(dev::IDeviceLayer& deviceLayer, profiling::IProfilerRecorder* profiler, int deviceId,
                              int sqIdx)
   : deviceLayer_(deviceLayer)
   , profiler_(profiler)
   , deviceId_(deviceId)
   , sqIdx_(sqIdx) {
+  slots_.resize(kInitialSlots);
+  for (auto i = static_cast<uint32_t>(kInitialSlots); i > 0; --i) {
+    freeSlots_.emplace_back(i - 1);
+  }
+  slotByEvent_.resize(size_t{std::numeric_limits<std::underlying_type_t<EventId>>::max()} + 1, kNoSlot);
   runner_ = std::thread{std::bind(&CommandSender::runnerFunc, this)};
 }
 void CommandSender::setOnCommandSentCallback(CommandSentCallback callback) {
@@ -49,11 +46,85 @@ void CommandSender::setOnCommandSentCallback(CommandSentCallback callback) {
   callback_ = std::move(callback);
 }
 
+void CommandSender::insertBefore(uint32_t before, Command command) {
+  auto& eventSlot = slotByEvent_[static_cast<size_t>(command.eventId_)];
+  if (eventSlot != kNoSlot) {
+    throw Exception("There is already a command with event " + std::to_string(static_cast<int>(command.eventId_)) +
+                    " in the send list");
+  }
+  if (freeSlots_.empty()) {
+    freeSlots_.emplace_back(static_cast<uint32_t>(slots_.size()));
+    slots_.emplace_back();
+  }
+  auto idx = freeSlots_.back();
+  freeSlots_.pop_back();
+  auto& slot = slots_[idx];
+  slot.command_.emplace(std::move(command));
+  eventSlot = idx;
+  if (metrics_ != nullptr) {
+    metrics_->onCommandQueued(*slot.command_);
+  }
+
+  auto prev = before == kNoSlot ? tail_ : slots_[before].prev_;
+  slot.prev_ = prev;
+  slot.next_ = before;
+  if (prev == kNoSlot) {
+    head_ = idx;
+  } else {
+    slots_[prev].next_ = idx;
+  }
+  if (before == kNoSlot) {
+    tail_ = idx;
+  } else {
+    slots_[before].prev_ = idx;
+  }
+  ++numCommands_;
+}
+
+void CommandSender::remove(uint32_t idx) {
+  auto& slot = slots_[idx];
+  if (slot.prev_ == kNoSlot) {
+    head_ = slot.next_;
+  } else {
+    slots_[slot.prev_].next_ = slot.next_;
+  }
+  if (slot.next_ == kNoSlot) {
+    tail_ = slot.prev_;
+  } else {
+    slots_[slot.next_].prev_ = slot.prev_;
+  }
+  slotByEvent_[static_cast<size_t>(slot.command_->eventId_)] = kNoSlot;
+  slot.command_.reset();
+  freeSlots_.emplace_back(idx);
+  --numCommands_;
+}
+
+uint32_t CommandSender::findSlot(EventId event, const char* error) const {
+  auto idx = slotByEvent_[static_cast<size_t>(event)];
+  if (idx == kNoSlot) {
+    throw Exception(error);
+  }
+  return idx;
+}
+
 void CommandSender::send(Command command) {
   SpinLock lock(mutex_);
+  // with nothing queued ahead there is nothing to keep the order with, the command can go straight to the SQ
+  if (inlineSubmission_ && command.isEnabled_ && head_ == kNoSlot && running_) {
+    profiling::ProfileEvent event(profiling::Type::Instant, profiling::Class::CommandSent);
+    if (metrics_ != nullptr) {
+      metrics_->onCommandQueued(command);
+    }
+    if (sendCommand(command)) {
+      onCommandSent(command, event);
+      return;
+    }
+    RT_VLOG(MID) << "Submission queue " << sqIdx_ << " is full, queueing command " << static_cast<int>(command.eventId_)
+                 << " for the runner thread";
+  }
   RT_VLOG(MID) << "Adding command (send) " << static_cast<int>(command.eventId_) << " to the send list. Enabled? "
                << (command.isEnabled_ ? "True" : "False");
-  commands_.emplace_back(std::move(command));
+  insertBefore(kNoSlot, std::move(command));
   lock.unlock();
   condVar_.notify_one();
 }
@@ -62,12 +133,8 @@ void CommandSender::sendBefore(EventId existingCommand, Command command) {
   SpinLock lock(mutex_);
   RT_VLOG(MID) << "Adding command (sendBefore) " << static_cast<int>(command.eventId_) << " to the send list. Enabled? "
                << (command.isEnabled_ ? "True" : "False");
-  auto it = std::find_if(begin(commands_), end(commands_),
-                         [existingCommand](const Command& elem) { return elem.eventId_ == existingCommand; });
-  if (it == end(commands_)) {
-    throw Exception("Trying to send a command before a non-existing command");
-  }
-  commands_.emplace(it, std::move(command));
+  insertBefore(findSlot(existingCommand, "Trying to send a command before a non-existing command"),
+               std::move(command));
   lock.unlock();
   condVar_.notify_one();
 }
@@ -76,25 +143,17 @@ void Command::enable() {
   parent_.enable(eventId_);
 }
 
-void CommandSender::setCommandData(EventId command, std::vector<std::byte> data) {
+void CommandSender::setCommandData(EventId command, CommandData data) {
   SpinLock lock(mutex_);
-  auto it =
-    std::find_if(begin(commands_), end(commands_), [command](const Command& elem) { return elem.eventId_ == command; });
-  if (it == end(commands_)) {
-    throw Exception("Trying to set data into  a non-existing command");
-  }
-  it->commandData_ = std::move(data);
+  auto idx = findSlot(command, "Trying to set data into  a non-existing command");
+  slots_[idx].command_->commandData_ = std::move(data);
 }
 
 void CommandSender::enable(EventId event) {
   RT_VLOG(MID) << "Enabling command " << static_cast<int>(event);
   SpinLock lock(mutex_);
-  auto it =
-    std::find_if(begin(commands_), end(commands_), [event](const Command& elem) { return elem.eventId_ == event; });
-  if (it == end(commands_)) {
-    throw Exception("Trying to enable a non-existing command");
-  }
-  it->isEnabled_ = true;
+  auto idx = findSlot(event, "Trying to enable a non-existing command");
+  slots_[idx].command_->isEnabled_ = true;
   lock.unlock();
   condVar_.notify_one();
 }
@@ -108,21 +167,19 @@ CommandSender::~CommandSender() {
 
 std::optional<EventId> CommandSender::getFirstDmaCommand() const {
   SpinLock lock(mutex_);
-  auto it = std::find_if(begin(commands_), end(commands_), [](const auto& c) { return c.isDma_; });
-  std::optional<EventId> result;
-  if (it != end(commands_)) {
-    result = it->eventId_;
+  for (auto idx = head_; idx != kNoSlot; idx = slots_[idx].next_) {
+    if (slots_[idx].command_->isDma_) {
+      return slots_[idx].command_->eventId_;
+    }
   }
-  return result;
+  return {};
 }
 
 void CommandSender::cancel(EventId event) {
   SpinLock lock(mutex_);
   RT_VLOG(MID) << "Cancel command " << static_cast<int>(event);
-  auto it =
-    std::find_if(begin(commands_), end(commands_), [event](const Command& elem) { return elem.eventId_ == event; });
-  if (it != end(commands_)) {
-    commands_.erase(it);
+  if (auto idx = slotByEvent_[static_cast<size_t>(event)]; idx != kNoSlot) {
+    remove(idx);
     lock.unlock();
     condVar_.notify_one();
   } else {
@@ -130,42 +187,87 @@ void CommandSender::cancel(EventId event) {
   }
 }
 
+void CommandSender::onCommandSent(const Command& cmd, const profiling::ProfileEvent& sentEvent) {
+  RT_VLOG(LOW) << ">>> Command sent: " << commandString(cmd.commandData_) << ". DeviceID: " << deviceId_
+               << " SQ: " << sqIdx_ << " EventId: " << static_cast<int>(cmd.eventId_);
+
+  auto event = sentEvent;
+  event.setEvent(cmd.eventId_);
+  event.setStream(cmd.streamId_);
+  event.setDeviceId(DeviceId(deviceId_));
+  event.setParentId(cmd.parentEventId_);
+  profiler_->record(event);
+
+  if (callback_) {
+    auto th = std::thread([callback = callback_, cmd, deviceId = deviceId_, threadId = nextCallbackThreadId_] {
+      profiling::IProfilerRecorder::setCurrentThreadName(
+        "Device " + std::to_string(deviceId) + " command sender callback thread " + std::to_string(threadId));
+      callback(&cmd);
+    });
+    th.detach();
+    nextCallbackThreadId_++;
+  }
+}
+
+size_t CommandSender::sendBatch() {
+  // coalesce the enabled non DMA commands at the head into a single submission; DMA commands are processed one by one
+  // by the driver so they are always sent alone
+  batchSizes_.clear();
+  batchData_.clear();
+  for (auto idx = head_; idx != kNoSlot && batchSizes_.size() < kMaxBatchCommands; idx = slots_[idx].next_) {
+    const auto& cmd = *slots_[idx].command_;
+    if (!cmd.isEnabled_ || cmd.isDma_ || cmd.isDmaChain_ ||
+        batchData_.size() + cmd.commandData_.size() > kMaxBatchBytes) {
+      break;
+    }
+    batchSizes_.emplace_back(cmd.commandData_.size());
+    batchData_.insert(end(batchData_), cmd.commandData_.begin(), cmd.commandData_.end());
+    if (metrics_ != nullptr) {
+      metrics_->onCommandSending(cmd);
+    }
+  }
+  if (batchSizes_.size() <= 1) {
+    return 0;
+  }
+  RT_VLOG(MID) << ">>> Sending " << batchSizes_.size() << " commands in a batch. DeviceID: " << deviceId_
+               << " SQ: " << sqIdx_ << " First EventId: " << static_cast<int>(front().eventId_);
+  dev::CmdFlagMM flags;
+  return deviceLayer_.sendCommandsMasterMinion(deviceId_, sqIdx_, batchData_.data(), batchSizes_, flags);
+}
+
+bool CommandSender::sendCommand(const Command& cmd) {
+  dev::CmdFlagMM flags;
+  flags.isDma_ = cmd.isDma_;
+  flags.isHpSq_ = false;
+  flags.isP2pDma_ = cmd.isP2P_;
+  flags.isDmaChain_ = cmd.isDmaChain_;
+  RT_VLOG(MID) << ">>> Sending command: " << commandString(cmd.commandData_) << ". DeviceID: " << deviceId_
+               << " SQ: " << sqIdx_ << " EventId: " << static_cast<int>(cmd.eventId_);
+  if (metrics_ != nullptr) {
+    metrics_->onCommandSending(cmd);
+  }
+  // the device-layer takes a non const pointer but doesn't write the command
+  return deviceLayer_.sendCommandMasterMinion(deviceId_, sqIdx_, const_cast<std::byte*>(cmd.commandData_.data()),
+                                              cmd.commandData_.size(), flags);
+}
+
 void CommandSender::runnerFunc() {
   profiling::IProfilerRecorder::setCurrentThreadName("Device " + std::to_string(deviceId_) + " command sender");
 
   while (running_) {
     try {
       SpinLock lock(mutex_);
-      if (!commands_.empty() && commands_.front().isEnabled_) {
-        auto& cmd = commands_.front();
-        dev::CmdFlagMM flags;
-        flags.isDma_ = cmd.isDma_;
-        flags.isHpSq_ = false;
-        flags.isP2pDma_ = cmd.isP2P_;
-        RT_VLOG(MID) << ">>> Sending command: " << commandString(cmd.commandData_) << ". DeviceID: " << deviceId_
-                     << " SQ: " << sqIdx_ << " EventId: " << static_cast<int>(cmd.eventId_);
+      if (isFrontEnabled()) {
         profiling::ProfileEvent event(profiling::Type::Instant, profiling::Class::CommandSent);
-        if (deviceLayer_.sendCommandMasterMinion(deviceId_, sqIdx_, cmd.commandData_.data(), cmd.commandData_.size(),
-                                                 flags)) {
-          RT_VLOG(LOW) << ">>> Command sent: " << commandString(cmd.commandData_) << ". DeviceID: " << deviceId_
-                       << " SQ: " << sqIdx_ << " EventId: " << static_cast<int>(cmd.eventId_);
-
-          event.setEvent(cmd.eventId_);
-          event.setStream(cmd.streamId_);
-          event.setDeviceId(DeviceId(deviceId_));
-          event.setParentId(cmd.parentEventId_);
-          profiler_->record(event);
-
-          if (callback_) {
-            auto th = std::thread([callback = callback_, cmd, deviceId = deviceId_, threadId = nextCallbackThreadId_] {
-              profiling::IProfilerRecorder::setCurrentThreadName(
-                "Device " + std::to_string(deviceId) + " command sender callback thread " + std::to_string(threadId));
-              callback(&cmd);
-            });
-            th.detach();
-            nextCallbackThreadId_++;
+        auto sent = sendBatch();
+        if (sent == 0 && batchSizes_.size() <= 1) {
+          sent = sendCommand(front()) ? 1 : 0;
+        }
+        if (sent > 0) {
+          for (auto i = 0UL; i < sent; ++i) {
+            onCommandSent(front(), event);
+            remove(head_);
           }
-          commands_.pop_front();
         } else {
           lock.unlock();
           RT_LOG(INFO) << "Submission queue " << sqIdx_
@@ -184,7 +286,7 @@ void CommandSender::runnerFunc() {
           }
         }
       } else {
-        condVar_.wait(lock, [this] { return !running_ || (!commands_.empty() && commands_.front().isEnabled_); });
+        condVar_.wait(lock, [this] { return !running_ || isFrontEnabled(); });
       }
     } catch (const std::exception& e) {
       RT_LOG(FATAL)
@@ -10,19 +10,118 @@
 
 #include <device-layer/IDeviceLayer.h>
 
+#include <algorithm>
+#include <array>
 #include <condition_variable>
 #include <cstddef>
+#include <deque>
 #include <functional>
-#include <list>
+#include <limits>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <thread>
 #include <vector>
 
 namespace rt {
+class CommandMetrics;
+
+// command payload with inline storage for the usual device-api command sizes, so building and queueing a command
+// doesn't allocate. Bigger payloads (long DMA lists) fall back to the heap
+class CommandData {
+public:
+  static constexpr size_t kInlineSize = 1024;
+
+  CommandData() = default;
+  // zero filled
+  explicit CommandData(size_t size) {
+    resize(size);
+  }
+  // implicit on purpose, commands built as vectors can be queued as before
+  CommandData(const std::vector<std::byte>& data) {
+    assign(data.data(), data.size());
+  }
+  CommandData(const CommandData& other) {
+    assign(other.data(), other.size());
+  }
+  CommandData(CommandData&& other) noexcept {
+    *this = std::move(other);
+  }
+  CommandData& operator=(const CommandData& other) {
+    if (this != &other) {
+      assign(other.data(), other.size());
+    }
+    return *this;
+  }
+  CommandData& operator=(CommandData&& other) noexcept {
+    if (this != &other) {
+      if (other.isHeap()) {
+        heap_ = std::move(other.heap_);
+      } else {
+        std::copy_n(other.inline_.data(), other.size_, inline_.data());
+      }
+      size_ = other.size_;
+      other.size_ = 0;
+    }
+    return *this;
+  }
+
+  void assign(const std::byte* data, size_t size) {
+    if (size > kInlineSize) {
+      heap_.assign(data, data + size);
+    } else {
+      std::copy_n(data, size, inline_.data());
+    }
+    size_ = size;
+  }
+
+  // keeps the current content, new bytes are zero filled
+  void resize(size_t size) {
+    if (size > kInlineSize) {
+      if (!isHeap()) {
+        heap_.assign(inline_.data(), inline_.data() + size_);
+      }
+      heap_.resize(size);
+    } else if (isHeap()) {
+      std::copy_n(heap_.data(), size, inline_.data());
+      heap_.clear();
+    } else if (size > size_) {
+      std::fill(inline_.data() + size_, inline_.data() + size, std::byte{0});
+    }
+    size_ = size;
+  }
+
+  std::byte* data() {
+    return isHeap() ? heap_.data() : inline_.data();
+  }
+  const std::byte* data() const {
+    return isHeap() ? heap_.data() : inline_.data();
+  }
+  size_t size() const {
+    return size_;
+  }
+  bool empty() const {
+    return size_ == 0;
+  }
+  const std::byte* begin() const {
+    return data();
+  }
+  const std::byte* end() const {
+    return data() + size_;
+  }
+
+private:
+  bool isHeap() const {
+    return size_ > kInlineSize;
+  }
+  std::array<std::byte, kInlineSize> inline_;
+  std::vector<std::byte> heap_;
+  size_t size_ = 0;
+};
+
 struct Command {
   void enable();
-  std::vector<std::byte> commandData_;
+  CommandData commandData_;
   class CommandSender& parent_;
   EventId eventId_;
   EventId parentEventId_;
@@ -30,6 +129,7 @@ struct Command {
   bool isDma_ = false;
   bool isEnabled_ = false;
   bool isP2P_ = false;
+  bool isDmaChain_ = false;
 };
 
 class CommandSender {
@@ -48,7 +148,7 @@ public:
   // if the Command is not yet running, it will be removed from the queue
   void cancel(EventId command);
 
-  void setCommandData(EventId command, std::vector<std::byte> data);
+  void setCommandData(EventId command, CommandData data);
   void enable(EventId command);
   void setOnCommandSentCallback(CommandSentCallback callback);
 
@@ -56,8 +156,19 @@ public:
     profiler_ = profiler;
   }
 
+  // to be set before sending any command
+  void setMetrics(CommandMetrics* metrics) {
+    metrics_ = metrics;
+  }
+
+  // if set, send() writes the command to the SQ from the calling thread when there are no other commands queued and the
+  // SQ has room; otherwise it's queued for the runner thread as usual. To be set before sending any command
+  void setInlineSubmission(bool enabled) {
+    inlineSubmission_ = enabled;
+  }
+
   size_t getCurrentSize() const {
-    return commands_.size();
+    return numCommands_;
   }
 
 private:
@@ -67,16 +178,57 @@ private:
   CommandSender& operator=(CommandSender&&) = delete;
 
   void runnerFunc();
+  // tries to send the enabled commands at the head of the queue in a single submission; returns how many were sent.
+  // Returns 0 without sending anything if there are less than two commands to batch. Must be called with mutex_ held
+  size_t sendBatch();
+  // writes the command to the SQ, returns false if the SQ is full. Must be called with mutex_ held
+  bool sendCommand(const Command& cmd);
+  void onCommandSent(const Command& cmd, const profiling::ProfileEvent& sentEvent);
+
+  static constexpr size_t kMaxBatchCommands = 32;
+  static constexpr size_t kMaxBatchBytes = 16 * 1024;
+
   mutable std::mutex mutex_;
-  std::list<Command> commands_;
+  // commands are kept in a slab of slots (which is only grown, never shrunk) linked in submission order, and indexed
+  // by event id; so queueing, enabling or cancelling a command neither allocates nor searches. Guarded by mutex_
+  struct Slot {
+    std::optional<Command> command_;
+    uint32_t prev_;
+    uint32_t next_;
+  };
+  static constexpr uint32_t kNoSlot = std::numeric_limits<uint32_t>::max();
+  static constexpr size_t kInitialSlots = 256;
+  // stores the command in a free slot and links it before the given slot (kNoSlot links it at the tail)
+  void insertBefore(uint32_t before, Command command);
+  // unlinks the command slot and releases it
+  void remove(uint32_t slot);
+  // returns the slot of the command with the given event, throws if there is no such command
+  uint32_t findSlot(EventId event, const char* error) const;
+  Command& front() {
+    return *slots_[head_].command_;
+  }
+  bool isFrontEnabled() const {
+    return head_ != kNoSlot && slots_[head_].command_->isEnabled_;
+  }
+
+  std::deque<Slot> slots_;
+  std::vector<uint32_t> freeSlots_;
+  std::vector<uint32_t> slotByEvent_;
+  uint32_t head_ = kNoSlot;
+  uint32_t tail_ = kNoSlot;
+  size_t numCommands_ = 0;
   std::thread runner_;
   std::condition_variable condVar_;
   dev::IDeviceLayer& deviceLayer_;
   profiling::IProfilerRecorder* profiler_;
+  CommandMetrics* metrics_ = nullptr;
   CommandSentCallback callback_;
+  std::vector<std::byte> batchData_;
+  std::vector<size_t> batchSizes_;
   int nextCallbackThreadId_ = 0;
   int deviceId_;
   int sqIdx_;
   bool running_ = true;
+  bool inlineSubmission_ = false;
 };
 } // namespace rt
@@ -6,6 +6,12 @@
 #pragma once
 #include "runtime/Types.h"
 
+// where the runtime finds the device kernels it uses internally, set by the build to the kernels install dir. The
+// ET_RUNTIME_KERNELS_DIR environment variable overrides it
+#ifndef RUNTIME_KERNELS_DIR
+#define RUNTIME_KERNELS_DIR "/usr/local/lib/esperanto-fw/kernels"
+#endif
+
 namespace rt {
 // these constants are based on documentation:
 // https://esperantotech.atlassian.net/wiki/spaces/SW/pages/1289355429/Device+Ops+Interface+-+Command+Response+Events+Bindings#Trace-setup-and-execution-flow
@@ -13,6 +19,16 @@ constexpr auto kNumErrorContexts = 2080;
 constexpr auto kExceptionBufferSize = sizeof(ErrorContext) * kNumErrorContexts;
 constexpr auto kNumExecutionCacheBuffers = 5;  // initial number of execution cache buffers
 constexpr auto kAllocFactorTotalMaxMemory = 2; // this will affect the size of memory we allocate for CMA
+// kernels MasterMinion can run at the same time on disjoint shire masks, must match MM_MAX_PARALLEL_KERNELS
+constexpr auto kMaxConcurrentKernels = 2;
+// ET-SOC1 DRAM address map: bits [8:6] select the memshire and bit 9 the controller within it, see system/layout.h
+constexpr auto kDramMemshireLSb = 6;
+constexpr auto kDramMemshireBits = 3;
+constexpr auto kDramMemshireControllerBit = 9;
+
+// kernels of test-compute-kernels the runtime loads itself, see RuntimeImp::getRuntimeKernel
+constexpr auto kCrc32CheckKernel = "crc32_check";
+constexpr auto kLz4DecompressKernel = "lz4_decompress";
 
 constexpr auto kCmPrevExecutionPath = "./fw_trace_cm_last_execution";
 constexpr auto kMmPrevExecutionPath = "./fw_trace_mm_last_execution";
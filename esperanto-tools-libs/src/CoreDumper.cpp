@@ -8,7 +8,10 @@
 #include "RuntimeImp.h"
 #include "Utils.h"
 #include "runtime/Types.h"
+#include <algorithm>
+#include <filesystem>
 #include <fstream>
+#include <sstream>
 #include <unistd.h>
 
 using namespace rt;
@@ -16,6 +19,10 @@ using namespace rt;
 namespace {
 constexpr auto kAlignment = 256;
 constexpr auto kMaxValidContextType = 4;
+// Segments are written in chunks; the chunks which are all zeros are skipped, leaving holes in the (sparse) file
+constexpr auto kWriteChunkSize = 1UL << 20;
+// Host memory the snapshots waiting to be written can take before a new dump waits for them
+constexpr auto kMaxPendingBytes = 4UL << 30;
 
 // Standard RISC-V exception mcause values
 // Instruction address misaligned
@@ -218,16 +225,19 @@ NoteData createNoteData(const rt::StreamError& error, const std::vector<size_t>&
 } // namespace
 
 void CoreDumper::addCodeAddress(DeviceId id, std::byte* address) {
+  std::lock_guard lock(mutex_);
   auto res = codeAddresses_[id].emplace(address);
   LOG_IF(FATAL, !res.second) << "Address already registered. This is likely a bug.";
 }
 
 void CoreDumper::removeCodeAddress(DeviceId id, std::byte* address) {
+  std::lock_guard lock(mutex_);
   auto res = codeAddresses_[id].erase(address);
   LOG_IF(FATAL, res == 0) << "Address not registered. This is likely a bug.";
 }
 
 void CoreDumper::addKernelExecution(const std::string& coreDumpPath, KernelId kernelId, EventId eventId) {
+  std::lock_guard lock(mutex_);
   if (kernelExecutions_.find(eventId) != kernelExecutions_.end()) {
     throw Exception("EventId already registered. This is likely a bug.");
   }
@@ -235,16 +245,27 @@ void CoreDumper::addKernelExecution(const std::string& coreDumpPath, KernelId ke
 }
 
 void CoreDumper::removeKernelExecution(EventId eventId) {
+  std::lock_guard lock(mutex_);
   kernelExecutions_.erase(eventId);
 }
 
+bool CoreDumper::isCodeAddress(DeviceId device, std::byte* address) const {
+  std::lock_guard lock(mutex_);
+  auto it = codeAddresses_.find(device);
+  return it != end(codeAddresses_) && it->second.find(address) != end(it->second);
+}
+
 void CoreDumper::dump(EventId eventId, const std::vector<AllocationInfo>& allocations, const rt::StreamError& error,
                       RuntimeImp& runtime) {
 
+  std::unique_lock lock(mutex_);
   auto it = kernelExecutions_.find(eventId);
   if (it == end(kernelExecutions_)) {
     return; // nothing to dump
   }
+  auto [kernelId, coreDumpFilePath] = it->second;
+  unused(kernelId);
+  lock.unlock();
   if (not error.errorContext_.has_value()) {
     RT_LOG(WARNING) << "Device error (no core dump possible). Not dumping a core without any kernel loaded.";
     return;
@@ -258,33 +279,17 @@ void CoreDumper::dump(EventId eventId, const std::vector<AllocationInfo>& alloca
 
   RT_LOG(WARNING) << "Dumping the stack is not possible yet.";
 
-  auto [kernelId, coreDumpFilePath] = it->second;
-  unused(kernelId);
-
-  // try to open a writing stream
-  auto os = std::ofstream{coreDumpFilePath, std::ios::binary | std::ios::trunc};
-
-  if (!os.is_open()) {
-    RT_LOG(WARNING) << "Could not open file " << coreDumpFilePath << " for writing";
-    return;
-  }
-
   auto numSegments = /* notes */ 1 + allocations.size();
   RT_LOG_IF(FATAL, numSegments > std::numeric_limits<uint16_t>::max()) << "Too many segments to dump";
 
   auto device = error.device_;
 
-  auto fileOffset = 0UL;
-
   // write the ELF header
   ETSOCElf::Header header;
   header.e_type = ET_CORE;
   header.e_machine = EM_RISCV;
   header.e_phnum = static_cast<uint16_t>(numSegments);
 
-  os.write(reinterpret_cast<const char*>(&header), sizeof(header));
-  fileOffset += sizeof(header);
-
   std::vector<ETSOCElf::SegmentHeader> segmentHeaders(numSegments);
 
   // Data starts after the segment headers
@@ -305,13 +310,14 @@ void CoreDumper::dump(EventId eventId, const std::vector<AllocationInfo>& alloca
 
   // Initialize the code and data segment headers
   size_t segmentIndex = 1;
+  auto totalBytes = 0UL;
   for (auto [address, size] : allocations) {
     auto& segmentHeader = segmentHeaders[segmentIndex];
 
     segmentHeader.p_type = PT_LOAD;
 
     // check if this is code or data section
-    if (codeAddresses_[device].find(address) != codeAddresses_[device].end()) {
+    if (isCodeAddress(device, address)) {
       segmentHeader.p_flags = (PF_X | PF_R);
     } else {
       segmentHeader.p_flags = (PF_R | PF_W);
@@ -325,56 +331,127 @@ void CoreDumper::dump(EventId eventId, const std::vector<AllocationInfo>& alloca
     segmentHeader.p_align = kAlignment;
 
     dataOffset = dataOffset + size;
-    dataOffset = align(dataOffset, kAlignment);
+    totalBytes += size;
+    if (segmentIndex + 1 < numSegments) {
+      dataOffset = align(dataOffset, kAlignment);
+    }
     segmentIndex++;
   }
-  // Write the segment headers
-  os.write(reinterpret_cast<const char*>(segmentHeaders.data()),
-           static_cast<long>(sizeof(*segmentHeaders.data()) * segmentHeaders.size()));
-  fileOffset += sizeof(*segmentHeaders.data()) * segmentHeaders.size();
-
+  auto fileSize = dataOffset;
+
+  // The ELF header, the segment headers and the notes are serialized here; the writer only appends the segments
+  std::ostringstream prologueStream;
+  prologueStream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  prologueStream.write(reinterpret_cast<const char*>(segmentHeaders.data()),
+                       static_cast<long>(sizeof(*segmentHeaders.data()) * segmentHeaders.size()));
+  auto fileOffset = sizeof(header) + sizeof(*segmentHeaders.data()) * segmentHeaders.size();
   // Enforce alignment in the output file
-  std::fill_n(std::ostreambuf_iterator<char>(os), segmentHeaders[0].p_offset - fileOffset, 0);
-  fileOffset = segmentHeaders[0].p_offset;
-
-  // Dump the note segment
+  std::fill_n(std::ostreambuf_iterator<char>(prologueStream), segmentHeaders[0].p_offset - fileOffset, 0);
   {
-    Dumper dumper(os);
+    Dumper dumper(prologueStream);
     note.apply(dumper);
-    fileOffset += note.size();
   }
-
-  auto stream = runtime.doCreateStream(device);
-
-  // Dump allocated device memory regions
+  auto prologueString = prologueStream.str();
+  std::vector<char> prologue(begin(prologueString), end(prologueString));
+
+  // Bound the host memory held by the snapshots if the writer is behind
+  lock.lock();
+  pendingCv_.wait(lock,
+                  [this, totalBytes] { return pendingBytes_ == 0 || pendingBytes_ + totalBytes <= kMaxPendingBytes; });
+  pendingBytes_ += totalBytes;
+  pendingDumps_++;
+  lock.unlock();
+
+  // Snapshot the allocated device memory regions. All the copies are issued before waiting for any of them, so they
+  // are spread over the DMA channels instead of being done one after the other
+  auto stream = runtime.doCreateStream(device, StreamPriority::Normal);
+  std::vector<Segment> segments;
+  std::vector<EventId> copyEvents;
+  segments.reserve(allocations.size());
+  copyEvents.reserve(allocations.size());
   segmentIndex = 1;
   for (auto [address, size] : allocations) {
-    // Space for a copy in the host
-    std::vector<std::byte> hostAddress(size);
-
-    // Copy from device to host
-    auto copyEventId =
-      runtime.doMemcpyDeviceToHost(stream, address, hostAddress.data(), size, false, defaultCmaCopyFunction);
-
-    // Enforce alignment in the output file
-    std::fill_n(std::ostreambuf_iterator<char>(os), segmentHeaders[segmentIndex].p_offset - fileOffset, 0);
-    fileOffset = segmentHeaders[segmentIndex].p_offset;
-
-    // Wait for the copy to finish
-    auto success = runtime.doWaitForEvent(copyEventId);
-    if (not success) {
-      RT_LOG(WARNING) << "Timed out copying core dump data from device.";
-      runtime.destroyStream(stream);
-      return;
-    }
+    auto& segment = segments.emplace_back(Segment{segmentHeaders[segmentIndex].p_offset, std::vector<std::byte>(size)});
+    copyEvents.emplace_back(
+      runtime.doMemcpyDeviceToHost(stream, address, segment.data_.data(), size, false, defaultCmaCopyFunction));
+    segmentIndex++;
+  }
+  auto success = true;
+  for (auto copyEvent : copyEvents) {
+    success = runtime.doWaitForEvent(copyEvent) && success;
+  }
+  runtime.doDestroyStream(stream);
+  if (not success) {
+    RT_LOG(WARNING) << "Timed out copying core dump data from device.";
+    lock.lock();
+    pendingBytes_ -= totalBytes;
+    pendingDumps_--;
+    lock.unlock();
+    pendingCv_.notify_all();
+    return;
+  }
 
-    // Write the segment
-    os.write(reinterpret_cast<const char*>(hostAddress.data()), static_cast<long>(size));
-    fileOffset += size;
+  writer_.pushTask([this, path = coreDumpFilePath, prologue = std::move(prologue), segments = std::move(segments),
+                    fileSize, totalBytes]() mutable {
+    write(path, std::move(prologue), std::move(segments), fileSize);
+    std::unique_lock pendingLock(mutex_);
+    pendingBytes_ -= totalBytes;
+    pendingDumps_--;
+    pendingLock.unlock();
+    pendingCv_.notify_all();
+  });
+  RT_LOG(INFO) << "Core dump snapshot taken, writing it in the background to " << coreDumpFilePath;
+}
 
-    segmentIndex++;
+void CoreDumper::write(const std::string& path, std::vector<char> prologue, std::vector<Segment> segments,
+                       size_t fileSize) {
+  namespace fs = std::filesystem;
+  auto partialPath = path + ".partial";
+
+  // try to open a writing stream
+  auto os = std::ofstream{partialPath, std::ios::binary | std::ios::trunc};
+  if (!os.is_open()) {
+    RT_LOG(WARNING) << "Could not open file " << partialPath << " for writing";
+    return;
+  }
+  os.write(prologue.data(), static_cast<long>(prologue.size()));
+  prologue = {};
+
+  for (auto& segment : segments) {
+    auto data = segment.data_.data();
+    auto size = segment.data_.size();
+    for (auto offset = 0UL; offset < size; offset += kWriteChunkSize) {
+      auto chunkSize = std::min(kWriteChunkSize, size - offset);
+      auto chunk = data + offset;
+      if (std::all_of(chunk, chunk + chunkSize, [](std::byte b) { return b == std::byte{0}; })) {
+        continue;
+      }
+      os.seekp(static_cast<long>(segment.fileOffset_ + offset));
+      os.write(reinterpret_cast<const char*>(chunk), static_cast<long>(chunkSize));
+    }
+    // release the snapshot as soon as it is written
+    segment.data_ = {};
+  }
+  os.close();
+  if (os.fail()) {
+    RT_LOG(WARNING) << "Could not write the core dump to " << partialPath;
+    return;
   }
 
-  runtime.doDestroyStream(stream);
+  std::error_code ec;
+  // the skipped zero chunks at the end of the file are not covered by any write
+  fs::resize_file(partialPath, fileSize, ec);
+  if (!ec) {
+    fs::rename(partialPath, path, ec);
+  }
+  if (ec) {
+    RT_LOG(WARNING) << "Could not write the core dump to " << path << ": " << ec.message();
+    return;
+  }
   RT_LOG(INFO) << "Core dump completed.";
 }
+
+void CoreDumper::waitPendingDumps() {
+  std::unique_lock lock(mutex_);
+  pendingCv_.wait(lock, [this] { return pendingDumps_ == 0; });
+}
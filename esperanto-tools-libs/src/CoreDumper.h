@@ -6,6 +6,9 @@
 #pragma once
 #include "MemoryManager.h"
 #include "runtime/Types.h"
+#include <condition_variable>
+#include <hostUtils/threadPool/ThreadPool.h>
+#include <mutex>
 #include <set>
 #include <unordered_map>
 
@@ -18,10 +21,22 @@ public:
   void removeKernelExecution(EventId eventId);
   void addCodeAddress(DeviceId device, std::byte* address);
   void removeCodeAddress(DeviceId device, std::byte* address);
+  // Snapshots the device memory (all the D2H copies are issued at once) and returns; the dump file is written by a
+  // background thread, under a temporary name which is renamed to the requested path once complete
   void dump(EventId eventId, const std::vector<AllocationInfo>& allocations, const rt::StreamError& error,
             RuntimeImp& runtime);
+  // blocks the caller until all the pending dump files have been written
+  void waitPendingDumps();
 
 private:
+  struct Segment {
+    uint64_t fileOffset_;
+    std::vector<std::byte> data_;
+  };
+  // ELF header, segment headers and notes, followed by the segments
+  void write(const std::string& path, std::vector<char> prologue, std::vector<Segment> segments, size_t fileSize);
+  bool isCodeAddress(DeviceId device, std::byte* address) const;
+
   struct KernelExecution {
     KernelId kernelId_;
     std::string coreDumpPath_;
@@ -29,5 +44,14 @@ private:
 
   std::unordered_map<DeviceId, std::set<std::byte*>> codeAddresses_; // store all code addresses
   std::unordered_map<EventId, KernelExecution> kernelExecutions_;
+  // kernel launches and code loads on different devices can run concurrently
+  mutable std::mutex mutex_;
+
+  // host memory held by the snapshots not yet written; dump waits while it is above kMaxPendingBytes
+  size_t pendingBytes_ = 0;
+  size_t pendingDumps_ = 0;
+  std::condition_variable pendingCv_;
+  // declared last so it is destroyed (waiting for the pending dumps) before the members the writes use
+  threadPool::ThreadPool writer_{1, false, true};
 };
 } // namespace rt
\ No newline at end of file
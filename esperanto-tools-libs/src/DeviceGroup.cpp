@@ -0,0 +1,148 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) 2025 Ainekko, Co.
+ * SPDX-License-Identifier: Apache-2.0
+ *-------------------------------------------------------------------------*/
+
+#include "RuntimeImp.h"
+#include "Utils.h"
+#include "runtime/Types.h"
+#include <algorithm>
+#include <mutex>
+#include <string>
+
+using namespace rt;
+using namespace rt::profiling;
+
+// The group operations are submitted device by device from the calling thread; each submission only takes the mutex
+// of its device and returns once its commands are queued (the CMA staging of the memcpys runs in the per-device thread
+// pools), so the devices work in parallel. If the submission to a device throws, the operations already submitted to
+// the previous devices are left in their streams.
+
+DeviceGroupId RuntimeImp::doCreateDeviceGroup(const std::vector<DeviceId>& devices, StreamPriority priority) {
+  if (devices.empty()) {
+    throw Exception("A device group needs at least one device");
+  }
+  for (auto it = begin(devices); it != end(devices); ++it) {
+    if (std::find(begin(devices_), end(devices_), *it) == end(devices_)) {
+      throw Exception("Invalid device " + std::to_string(static_cast<int>(*it)) + " for a device group");
+    }
+    if (std::find(std::next(it), end(devices), *it) != end(devices)) {
+      throw Exception("Device " + std::to_string(static_cast<int>(*it)) + " is repeated in the device group");
+    }
+  }
+  DeviceGroup group;
+  group.devices_ = devices;
+  try {
+    for (auto device : devices) {
+      group.streams_.emplace_back(doCreateStream(device, priority));
+    }
+  } catch (...) {
+    for (auto stream : group.streams_) {
+      doDestroyStream(stream);
+    }
+    throw;
+  }
+  std::lock_guard lock(deviceGroupsMutex_);
+  auto id = DeviceGroupId{nextDeviceGroupId_++};
+  deviceGroups_.emplace(id, std::move(group));
+  RT_VLOG(LOW) << "Created device group " << static_cast<int>(id) << " of " << devices.size() << " devices";
+  return id;
+}
+
+void RuntimeImp::doDestroyDeviceGroup(DeviceGroupId group) {
+  DeviceGroup deviceGroup;
+  {
+    std::lock_guard lock(deviceGroupsMutex_);
+    auto it = find(deviceGroups_, group, "Invalid device group");
+    deviceGroup = std::move(it->second);
+    deviceGroups_.erase(it);
+  }
+  for (auto stream : deviceGroup.streams_) {
+    doWaitForStream(stream);
+    doDestroyStream(stream);
+  }
+  RT_VLOG(LOW) << "Destroyed device group " << static_cast<int>(group);
+}
+
+StreamId RuntimeImp::doGetDeviceGroupStream(DeviceGroupId group, DeviceId device) const {
+  std::lock_guard lock(deviceGroupsMutex_);
+  const auto& deviceGroup = find(deviceGroups_, group, "Invalid device group")->second;
+  auto it = std::find(begin(deviceGroup.devices_), end(deviceGroup.devices_), device);
+  if (it == end(deviceGroup.devices_)) {
+    throw Exception("Device " + std::to_string(static_cast<int>(device)) + " doesn't belong to device group " +
+                    std::to_string(static_cast<int>(group)));
+  }
+  return deviceGroup.streams_[static_cast<size_t>(it - begin(deviceGroup.devices_))];
+}
+
+std::vector<DeviceId> RuntimeImp::doGetDeviceGroupDevices(DeviceGroupId group) const {
+  std::lock_guard lock(deviceGroupsMutex_);
+  return find(deviceGroups_, group, "Invalid device group")->second.devices_;
+}
+
+EventId RuntimeImp::doLaunchOnGroup(DeviceGroupId group, const std::vector<KernelId>& kernels,
+                                    const std::vector<std::vector<std::byte>>& kernelArgs,
+                                    const KernelLaunchOptionsImp& options) {
+  auto deviceGroup = getDeviceGroup(group, kernels.size(), "kernels");
+  if (kernelArgs.size() != 1) {
+    getDeviceGroup(group, kernelArgs.size(), "kernel arguments");
+  }
+  std::vector<EventId> events;
+  for (size_t i = 0; i < deviceGroup.streams_.size(); ++i) {
+    const auto& args = kernelArgs.size() == 1 ? kernelArgs.front() : kernelArgs[i];
+    events.emplace_back(doKernelLaunch(deviceGroup.streams_[i], kernels[i], args.data(), args.size(), options));
+  }
+  return makeGroupEvent(std::move(events));
+}
+
+EventId RuntimeImp::doScatter(DeviceGroupId group, const std::byte* h_src, const std::vector<std::byte*>& d_dsts,
+                              size_t shardSize, bool barrier) {
+  auto deviceGroup = getDeviceGroup(group, d_dsts.size(), "destination buffers");
+  std::vector<EventId> events;
+  for (size_t i = 0; i < deviceGroup.streams_.size(); ++i) {
+    events.emplace_back(doMemcpyHostToDevice(deviceGroup.streams_[i], h_src + i * shardSize, d_dsts[i], shardSize,
+                                             barrier, defaultCmaCopyFunction));
+  }
+  return makeGroupEvent(std::move(events));
+}
+
+EventId RuntimeImp::doGather(DeviceGroupId group, const std::vector<const std::byte*>& d_srcs, std::byte* h_dst,
+                             size_t shardSize, bool barrier) {
+  auto deviceGroup = getDeviceGroup(group, d_srcs.size(), "source buffers");
+  std::vector<EventId> events;
+  for (size_t i = 0; i < deviceGroup.streams_.size(); ++i) {
+    events.emplace_back(doMemcpyDeviceToHost(deviceGroup.streams_[i], d_srcs[i], h_dst + i * shardSize, shardSize,
+                                             barrier, defaultCmaCopyFunction));
+  }
+  return makeGroupEvent(std::move(events));
+}
+
+RuntimeImp::DeviceGroup RuntimeImp::getDeviceGroup(DeviceGroupId group, size_t elements, const char* what) const {
+  std::lock_guard lock(deviceGroupsMutex_);
+  const auto& deviceGroup = find(deviceGroups_, group, "Invalid device group")->second;
+  if (elements != deviceGroup.devices_.size()) {
+    throw Exception("Device group " + std::to_string(static_cast<int>(group)) + " has " +
+                    std::to_string(deviceGroup.devices_.size()) + " devices but got " + std::to_string(elements) + " " +
+                    what);
+  }
+  return deviceGroup;
+}
+
+EventId RuntimeImp::makeGroupEvent(std::vector<EventId> events) {
+  auto evt = eventManager_.getNextId();
+  RT_VLOG(LOW) << "Group event " << static_cast<int>(evt) << " of " << events.size() << " events";
+  // the group event is in no stream, so it's not dispatched through dispatch(), which removes it from its stream
+  eventManager_.addOnDispatchCallback({std::move(events), [this, evt] {
+                                         if (!running_) {
+                                           return;
+                                         }
+                                         ProfileEvent profileEvent(Type::Instant, Class::DispatchEvent);
+                                         profileEvent.setEvent(evt);
+                                         getProfiler()->record(profileEvent);
+                                         commandMetrics_->onDispatching(evt);
+                                         eventManager_.dispatch(evt);
+                                         commandMetrics_->onDispatched(evt);
+                                         notify(evt);
+                                       }});
+  return evt;
+}
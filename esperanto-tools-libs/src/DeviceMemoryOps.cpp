@@ -0,0 +1,372 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) 2025 Ainekko, Co.
+ * SPDX-License-Identifier: Apache-2.0
+ *-------------------------------------------------------------------------*/
+
+#include "RuntimeImp.h"
+#include "Utils.h"
+#include "runtime/DeviceOpsExt.h"
+#include "runtime/Types.h"
+#include <esperanto/device-apis/operations-api/device_ops_api_cxx.h>
+#include <esperanto/device-apis/operations-api/device_ops_api_spec.h>
+#include <cstring>
+#include <map>
+#include <unordered_map>
+
+using namespace rt;
+
+namespace {
+CommandData makeMemsetCommand(const std::byte* d_dst, uint64_t pattern, size_t patternSize, size_t size,
+                              bool barrier) {
+  CommandData data(sizeof(device_ops_ext::device_ops_memset_cmd_t));
+  auto cmd = reinterpret_cast<device_ops_ext::device_ops_memset_cmd_t*>(data.data());
+  memset(cmd, 0, sizeof(*cmd));
+  cmd->command_info.cmd_hdr.msg_id = device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_MEMSET_CMD;
+  cmd->command_info.cmd_hdr.size = static_cast<device_ops_api::msg_size_t>(sizeof(*cmd));
+  if (barrier) {
+    cmd->command_info.cmd_hdr.flags |= device_ops_api::CMD_FLAGS_BARRIER_ENABLE;
+  }
+  cmd->dst_device_phy_addr = reinterpret_cast<uint64_t>(d_dst);
+  cmd->size = size;
+  cmd->pattern = pattern;
+  cmd->pattern_size = static_cast<uint8_t>(patternSize);
+  return data;
+}
+
+CommandData makeDeviceMemcpyCommand(const std::byte* d_src, const std::byte* d_dst, size_t size, bool barrier) {
+  CommandData data(sizeof(device_ops_ext::device_ops_device_memcpy_cmd_t));
+  auto cmd = reinterpret_cast<device_ops_ext::device_ops_device_memcpy_cmd_t*>(data.data());
+  memset(cmd, 0, sizeof(*cmd));
+  cmd->command_info.cmd_hdr.msg_id = device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_DEVICE_MEMCPY_CMD;
+  cmd->command_info.cmd_hdr.size = static_cast<device_ops_api::msg_size_t>(sizeof(*cmd));
+  if (barrier) {
+    cmd->command_info.cmd_hdr.flags |= device_ops_api::CMD_FLAGS_BARRIER_ENABLE;
+  }
+  cmd->src_device_phy_addr = reinterpret_cast<uint64_t>(d_src);
+  cmd->dst_device_phy_addr = reinterpret_cast<uint64_t>(d_dst);
+  cmd->size = size;
+  return data;
+}
+
+CommandData makeKernelHeapConfigCommand(const std::byte* d_heap, size_t size, bool barrier) {
+  CommandData data(sizeof(device_ops_ext::device_ops_kernel_heap_config_cmd_t));
+  auto cmd = reinterpret_cast<device_ops_ext::device_ops_kernel_heap_config_cmd_t*>(data.data());
+  memset(cmd, 0, sizeof(*cmd));
+  cmd->command_info.cmd_hdr.msg_id = device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_KERNEL_HEAP_CONFIG_CMD;
+  cmd->command_info.cmd_hdr.size = static_cast<device_ops_api::msg_size_t>(sizeof(*cmd));
+  if (barrier) {
+    cmd->command_info.cmd_hdr.flags |= device_ops_api::CMD_FLAGS_BARRIER_ENABLE;
+  }
+  cmd->heap_device_phy_addr = reinterpret_cast<uint64_t>(d_heap);
+  cmd->size = size;
+  return data;
+}
+
+void setTag(CommandData& data, EventId evt) {
+  reinterpret_cast<device_ops_api::cmn_header_t*>(data.data())->tag_id = static_cast<device_ops_api::tag_id_t>(evt);
+}
+} // namespace
+
+EventId RuntimeImp::sendDeviceMemoryCommand(StreamId stream, CommandData data, size_t size) {
+  auto streamInfo = streamManager_.getStreamInfo(stream);
+  if (isCapturing(stream)) {
+    GraphNode node;
+    node.command_ = std::move(data);
+    return captureCommands(stream, {std::move(node)});
+  }
+
+  flushCoalescedMemcpys(stream);
+  auto evt = eventManager_.getNextId();
+  streamManager_.addEvent(stream, evt);
+  if (size == 0) {
+    // nothing to do in the device
+    dispatch(evt);
+    return evt;
+  }
+  setTag(data, evt);
+  auto& commandSender = find(commandSenders_, getCommandSenderIdx(streamInfo.device_, streamInfo.vq_))->second;
+  commandSender.send(Command{std::move(data), commandSender, evt, evt, stream, false, true});
+  Sync(evt);
+  return evt;
+}
+
+EventId RuntimeImp::doFillDevice(StreamId stream, std::byte* d_dst, uint64_t pattern, size_t patternSize, size_t size,
+                                 bool barrier) {
+  if (patternSize != 1 && patternSize != 2 && patternSize != 4 && patternSize != 8) {
+    throw Exception("Fill pattern size must be 1, 2, 4 or 8 bytes");
+  }
+  if (reinterpret_cast<uint64_t>(d_dst) % patternSize != 0 || size % patternSize != 0) {
+    throw Exception("Fill address and size must be multiples of the pattern size");
+  }
+  auto streamInfo = streamManager_.getStreamInfo(stream);
+  auto device = DeviceId{streamInfo.device_};
+  SpinLock lock(getDeviceMutex(device));
+  if (checkMemcpyDeviceAddress_) {
+    memoryManagers_.at(device).checkOperation(d_dst, size);
+  }
+  auto evt = sendDeviceMemoryCommand(stream, makeMemsetCommand(d_dst, pattern, patternSize, size, barrier), size);
+  RT_VLOG(LOW) << "FillDevice stream: " << static_cast<int>(stream) << " EventId: " << static_cast<int>(evt)
+               << std::hex << " Device address: " << d_dst << " Size: " << size << " Pattern: " << pattern
+               << " Pattern size: " << patternSize;
+  return evt;
+}
+
+EventId RuntimeImp::doMemcpyWithinDevice(StreamId stream, const std::byte* d_src, std::byte* d_dst, size_t size,
+                                         bool barrier) {
+  auto streamInfo = streamManager_.getStreamInfo(stream);
+  auto device = DeviceId{streamInfo.device_};
+  SpinLock lock(getDeviceMutex(device));
+  if (checkMemcpyDeviceAddress_) {
+    const auto& mm = memoryManagers_.at(device);
+    mm.checkOperation(d_src, size);
+    mm.checkOperation(d_dst, size);
+  }
+  auto evt = sendDeviceMemoryCommand(stream, makeDeviceMemcpyCommand(d_src, d_dst, size, barrier), size);
+  RT_VLOG(LOW) << "MemcpyWithinDevice stream: " << static_cast<int>(stream) << " EventId: " << static_cast<int>(evt)
+               << std::hex << " Source address: " << d_src << " Destination address: " << d_dst << " Size: " << size;
+  return evt;
+}
+
+EventId RuntimeImp::doSetKernelHeap(StreamId stream, std::byte* d_heap, size_t size, bool barrier) {
+  if (d_heap == nullptr) {
+    size = 0;
+  }
+  if (size != 0 && size < device_ops_ext::kKernelHeapMinSize) {
+    throw Exception("Kernel heap size must be at least " + std::to_string(device_ops_ext::kKernelHeapMinSize) +
+                    " bytes");
+  }
+  auto streamInfo = streamManager_.getStreamInfo(stream);
+  auto device = DeviceId{streamInfo.device_};
+  SpinLock lock(getDeviceMutex(device));
+  if (checkMemcpyDeviceAddress_ && size != 0) {
+    memoryManagers_.at(device).checkOperation(d_heap, size);
+  }
+  // disabling the heap is a command too, the size given only tells there is work for the device
+  auto evt = sendDeviceMemoryCommand(stream, makeKernelHeapConfigCommand(d_heap, size, barrier), 1);
+  RT_VLOG(LOW) << "SetKernelHeap stream: " << static_cast<int>(stream) << " EventId: " << static_cast<int>(evt)
+               << std::hex << " Device address: " << d_heap << " Size: " << size;
+  return evt;
+}
+
+DeviceHandle RuntimeImp::doMallocDeviceHandle(DeviceId device, size_t size, uint32_t alignment) {
+  SpinLock lock(getDeviceMutex(device));
+  auto fragmentation = find(memoryManagers_, device)->second.getFragmentationStats().fragmentation_;
+  if (memoryCompactionThreshold_ > 0.0 && fragmentation > memoryCompactionThreshold_) {
+    RT_VLOG(LOW) << "Device memory fragmentation " << fragmentation << " is above the compaction threshold";
+    doCompactDeviceMemory(device);
+  }
+  std::byte* ptr;
+  try {
+    ptr = doMallocDevice(device, size, alignment);
+  } catch (const Exception&) {
+    if (doCompactDeviceMemory(device) == 0) {
+      throw;
+    }
+    ptr = doMallocDevice(device, size, alignment);
+  }
+  std::lock_guard handlesLock(handlesMutex_);
+  auto handle = DeviceHandle{nextHandle_++};
+  auto& allocation = handles_[handle];
+  allocation.device_ = device;
+  allocation.address_ = ptr;
+  allocation.alignment_ = alignment;
+  return handle;
+}
+
+void RuntimeImp::doFreeDeviceHandle(DeviceHandle handle) {
+  std::unique_lock handlesLock(handlesMutex_);
+  auto it = handles_.find(handle);
+  if (it == end(handles_)) {
+    throw Exception("Invalid device handle or double free");
+  }
+  auto device = it->second.device_;
+  handlesLock.unlock();
+
+  // the device mutex goes first, so the allocation can't be moved, nor freed, meanwhile
+  SpinLock lock(getDeviceMutex(device));
+  handlesLock.lock();
+  it = handles_.find(handle);
+  if (it == end(handles_)) {
+    throw Exception("Invalid device handle or double free");
+  }
+  auto allocation = it->second;
+  handles_.erase(it);
+  handlesLock.unlock();
+  if (allocation.address_ != nullptr) {
+    doFreeDevice(device, allocation.address_);
+  }
+  if (allocation.hostCopy_ != nullptr) {
+    doFreeHostBuffer(device, allocation.hostCopy_);
+  }
+}
+
+std::byte* RuntimeImp::doResolveDeviceHandle(DeviceHandle handle) const {
+  std::lock_guard handlesLock(handlesMutex_);
+  auto it = handles_.find(handle);
+  if (it == end(handles_)) {
+    throw Exception("Invalid device handle");
+  }
+  if (it->second.address_ == nullptr) {
+    throw Exception("Managed allocation is evicted, it has to be prefetched first");
+  }
+  return it->second.address_;
+}
+
+size_t RuntimeImp::doCompactDeviceMemory(DeviceId device) {
+  // held till the moves are done, so nothing else can be allocated in the ranges being moved
+  SpinLock lock(getDeviceMutex(device));
+  if (areEventsOnFly(device)) {
+    RT_VLOG(LOW) << "Device " << static_cast<int>(device) << " is not idle, its memory is not compacted";
+    return 0;
+  }
+  std::map<const std::byte*, uint32_t> movable;
+  std::unordered_map<const std::byte*, DeviceHandle> handleByAddress;
+  {
+    std::lock_guard handlesLock(handlesMutex_);
+    for (const auto& [handle, allocation] : handles_) {
+      if (allocation.device_ == device && allocation.address_ != nullptr) {
+        movable.emplace(allocation.address_, allocation.alignment_);
+        handleByAddress.emplace(allocation.address_, handle);
+      }
+    }
+  }
+  auto& mm = memoryManagers_.at(device);
+  auto relocations = mm.getCompaction(movable);
+  if (relocations.empty()) {
+    return 0;
+  }
+  RT_VLOG(LOW) << "Compacting device " << static_cast<int>(device) << " memory, moving " << relocations.size()
+               << " allocations";
+
+  // each move is a barrier, the next one can overlap the range it leaves
+  auto stream = doCreateStream(device, StreamPriority::Normal);
+  for (const auto& r : relocations) {
+    mm.relocate(r.from_, r.to_);
+    sendDeviceMemoryCommand(stream, makeDeviceMemcpyCommand(r.from_, r.to_, r.size_, true), r.size_);
+  }
+  {
+    std::lock_guard handlesLock(handlesMutex_);
+    for (const auto& r : relocations) {
+      handles_.at(handleByAddress.at(r.from_)).address_ = r.to_;
+    }
+  }
+  auto done = doWaitForStream(stream);
+  auto errors = doRetrieveStreamErrors(stream);
+  doDestroyStream(stream);
+  if (!done || !errors.empty()) {
+    throw Exception("Device memory compaction failed, the content of the moved allocations is lost");
+  }
+  return relocations.size();
+}
+
+DeviceHandle RuntimeImp::doMallocManaged(DeviceId device, size_t size, uint32_t alignment) {
+  SpinLock lock(getDeviceMutex(device));
+  auto ptr = doMallocDevice(device, size, alignment);
+  std::lock_guard handlesLock(handlesMutex_);
+  auto handle = DeviceHandle{nextHandle_++};
+  auto& allocation = handles_[handle];
+  allocation.device_ = device;
+  allocation.address_ = ptr;
+  allocation.alignment_ = alignment;
+  allocation.managed_ = true;
+  allocation.size_ = size;
+  allocation.lastUse_ = nextUse_++;
+  return handle;
+}
+
+void RuntimeImp::doPrefetchManaged(StreamId stream, const std::vector<DeviceHandle>& handles) {
+  auto device = DeviceId{streamManager_.getStreamInfo(stream).device_};
+  SpinLock lock(getDeviceMutex(device));
+  std::vector<DeviceHandle> evicted;
+  {
+    std::lock_guard handlesLock(handlesMutex_);
+    for (auto handle : handles) {
+      auto it = handles_.find(handle);
+      if (it == end(handles_) || !it->second.managed_ || it->second.device_ != device) {
+        throw Exception("Invalid managed allocation handle for the stream device");
+      }
+    }
+    // all of them are the most recently used ones, and pinned so restoring one doesn't evict another of the list
+    auto use = nextUse_++;
+    for (auto handle : handles) {
+      auto& allocation = handles_.at(handle);
+      allocation.lastUse_ = use;
+      allocation.stream_ = stream;
+      allocation.pinned_ = true;
+      if (allocation.address_ == nullptr) {
+        evicted.emplace_back(handle);
+      }
+    }
+  }
+  auto unpin = [this, &handles] {
+    std::lock_guard handlesLock(handlesMutex_);
+    for (auto handle : handles) {
+      handles_.at(handle).pinned_ = false;
+    }
+  };
+  try {
+    for (auto handle : evicted) {
+      std::unique_lock handlesLock(handlesMutex_);
+      auto allocation = handles_.at(handle);
+      handlesLock.unlock();
+      auto ptr = doMallocDevice(device, allocation.size_, allocation.alignment_);
+      handlesLock.lock();
+      handles_.at(handle).address_ = ptr;
+      handlesLock.unlock();
+      RT_VLOG(LOW) << "Restoring managed allocation " << static_cast<uint32_t>(handle) << " to address: " << std::hex
+                   << ptr;
+      doMemcpyHostToDevice(stream, allocation.hostCopy_, ptr, allocation.size_, false, defaultCmaCopyFunction);
+    }
+  } catch (...) {
+    unpin();
+    throw;
+  }
+  unpin();
+}
+
+bool RuntimeImp::evictManagedAllocation(DeviceId device) {
+  std::unique_lock handlesLock(handlesMutex_);
+  auto victim = end(handles_);
+  for (auto it = begin(handles_); it != end(handles_); ++it) {
+    const auto& a = it->second;
+    if (a.managed_ && a.device_ == device && a.address_ != nullptr && !a.pinned_ &&
+        (victim == end(handles_) || a.lastUse_ < victim->second.lastUse_)) {
+      victim = it;
+    }
+  }
+  if (victim == end(handles_)) {
+    return false;
+  }
+  auto handle = victim->first;
+  auto allocation = victim->second;
+  handlesLock.unlock();
+  RT_VLOG(LOW) << "Evicting managed allocation " << static_cast<uint32_t>(handle) << " at address: " << std::hex
+               << allocation.address_ << " size: " << std::dec << allocation.size_;
+
+  if (allocation.hostCopy_ == nullptr) {
+    allocation.hostCopy_ = doAllocHostBuffer(device, allocation.size_);
+    handlesLock.lock();
+    handles_.at(handle).hostCopy_ = allocation.hostCopy_;
+    handlesLock.unlock();
+  }
+  if (allocation.stream_) {
+    try {
+      doWaitForStream(*allocation.stream_);
+    } catch (const Exception&) {
+      // the stream was destroyed, so the work using the allocation is done
+    }
+  }
+  auto stream = doCreateStream(device, StreamPriority::Normal);
+  doMemcpyDeviceToHost(stream, allocation.address_, allocation.hostCopy_, allocation.size_, true,
+                       defaultCmaCopyFunction);
+  auto done = doWaitForStream(stream);
+  auto errors = doRetrieveStreamErrors(stream);
+  doDestroyStream(stream);
+  if (!done || !errors.empty()) {
+    throw Exception("Evicting managed allocation failed");
+  }
+  memoryManagers_.at(device).free(allocation.address_);
+  handlesLock.lock();
+  handles_.at(handle).address_ = nullptr;
+  return true;
+}
@@ -0,0 +1,85 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) 2025 Ainekko, Co.
+ * SPDX-License-Identifier: Apache-2.0
+ *-------------------------------------------------------------------------*/
+
+#include "DeviceUtilization.h"
+
+#include "Utils.h"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#pragma GCC diagnostic ignored "-Wcast-align"
+#pragma GCC diagnostic ignored "-Wcast-qual"
+#pragma GCC diagnostic ignored "-Wsign-conversion"
+#pragma GCC diagnostic ignored "-Wuseless-cast"
+#pragma GCC diagnostic ignored "-Wignored-qualifiers"
+#include <et-trace/decoder.h>
+#include <et-trace/layout.h>
+#pragma GCC diagnostic pop
+
+#include <algorithm>
+#include <cstring>
+
+using namespace rt;
+
+namespace {
+double toFraction(uint64_t busyCycles, uint64_t intervalCycles) {
+  if (intervalCycles == 0) {
+    return 0.0;
+  }
+  return std::min(1.0, static_cast<double>(busyCycles) / static_cast<double>(intervalCycles));
+}
+} // namespace
+
+std::vector<UtilizationSample> rt::decodeUtilizationSamples(const std::vector<std::byte>& buffer) {
+  auto res = std::vector<UtilizationSample>{};
+  if (buffer.size() < sizeof(trace_buffer_std_header_t)) {
+    RT_LOG(WARNING) << "MM stats trace buffer too small to hold a trace header, ignoring it";
+    return res;
+  }
+  // copied so the header is properly aligned
+  auto aligned = std::vector<trace_buffer_std_header_t>((buffer.size() + sizeof(trace_buffer_std_header_t) - 1) /
+                                                        sizeof(trace_buffer_std_header_t));
+  std::memcpy(aligned.data(), buffer.data(), buffer.size());
+  // the decoder doesn't do bounds checking on its own, entries past the buffer are ignored
+  auto tb = aligned.data();
+  auto bufferEnd = reinterpret_cast<const std::byte*>(tb) + buffer.size();
+  for (auto entry = Trace_Decode(tb, nullptr); entry != nullptr; entry = Trace_Decode(tb, entry)) {
+    auto entryBytes = reinterpret_cast<const std::byte*>(entry);
+    if (entryBytes + sizeof(trace_custom_event_t) > bufferEnd ||
+        entryBytes + sizeof(trace_entry_header_t) + entry->payload_size > bufferEnd) {
+      RT_LOG(WARNING) << "MM stats trace buffer entry out of bounds, the samples may be truncated";
+      break;
+    }
+    if (entry->type != TRACE_TYPE_CUSTOM_EVENT) {
+      continue;
+    }
+    auto event = reinterpret_cast<const trace_custom_event_t*>(entry);
+    if (event->custom_type != TRACE_CUSTOM_TYPE_MM_UTILIZATION ||
+        event->payload_size < sizeof(mm_utilization_sample) ||
+        entryBytes + sizeof(trace_custom_event_t) + sizeof(mm_utilization_sample) > bufferEnd) {
+      continue;
+    }
+    mm_utilization_sample sample;
+    std::memcpy(&sample, event->payload, sizeof(sample));
+
+    auto& us = res.emplace_back();
+    us.timestampCycles_ = entry->cycle;
+    us.intervalCycles_ = sample.interval_cycles;
+    auto sqCount = std::min<uint32_t>(sample.sq_count, TRACE_MM_UTILIZATION_SQ_COUNT);
+    us.sqPendingBytes_.assign(sample.sq_pending_bytes, sample.sq_pending_bytes + sqCount);
+    us.sqInflightCommands_.assign(sample.sq_inflight_cmds, sample.sq_inflight_cmds + sqCount);
+    for (auto i = 0U; i < TRACE_MM_UTILIZATION_DMA_CHANNEL_COUNT; ++i) {
+      us.dmaHostToDeviceBusy_.emplace_back(toFraction(sample.dma_h2d_busy_cycles[i], sample.interval_cycles));
+      us.dmaDeviceToHostBusy_.emplace_back(toFraction(sample.dma_d2h_busy_cycles[i], sample.interval_cycles));
+    }
+    us.kernelBusy_ = toFraction(sample.kernel_busy_cycles, sample.interval_cycles);
+    us.busyShireMask_ = sample.busy_shire_mask;
+  }
+  // the buffer is a ring, once it has wrapped its start holds the newest samples
+  std::stable_sort(begin(res), end(res),
+                   [](const auto& a, const auto& b) { return a.timestampCycles_ < b.timestampCycles_; });
+  return res;
+}
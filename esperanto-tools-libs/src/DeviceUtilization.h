@@ -0,0 +1,19 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) 2025 Ainekko, Co.
+ * SPDX-License-Identifier: Apache-2.0
+ *-------------------------------------------------------------------------*/
+
+#pragma once
+
+#include "runtime/IMonitor.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace rt {
+
+// Decodes the utilization samples logged by the MasterMinion into its stats trace buffer (TRACE_MM_STATS_BUFFER), see
+// IMonitor::getDeviceUtilization. Entries of other types are skipped, samples are returned oldest first.
+std::vector<UtilizationSample> decodeUtilizationSamples(const std::vector<std::byte>& buffer);
+
+} // namespace rt
@@ -10,7 +10,9 @@
 #include <cassert>
 #include <condition_variable>
 #include <easy/profiler.h>
+#include <exception>
 #include <mutex>
+#include <sstream>
 #include <thread>
 
 using namespace rt;
@@ -18,19 +20,30 @@ using namespace rt;
 void EventManager::addOnDispatchCallback(OnDispatchCallback callback) {
   std::unique_lock lock(mutex_);
   auto& events = callback.eventsWatched_;
+  std::sort(begin(events), end(events));
+  events.erase(std::unique(begin(events), end(events)), end(events));
   events.erase(std::remove_if(begin(events), end(events), [this](EventId event) { return isDispatched(event); }),
                end(events));
   if (events.empty()) {
     callbackExecutor_.pushTask(std::move(callback.callback_));
   } else {
-    callbacks_.emplace_back(std::move(callback));
+    auto id = nextCallbackId_++;
+    for (auto event : events) {
+      callbacksByEvent_[event].emplace_back(id);
+    }
+    callbacks_.emplace(id, PendingCallback{events.size(), std::move(callback.callback_)});
   }
 }
 
 EventId EventManager::getNextId() {
-  std::lock_guard lock(mutex_);
-  auto res = EventId{nextEventId_++};
-  onflyEvents_.emplace(res);
+  auto res = EventId{nextEventId_.fetch_add(1, std::memory_order_relaxed)};
+  auto idx = static_cast<size_t>(res);
+  auto bit = uint64_t{1} << (idx % kBitsPerWord);
+  if (auto prev = onflyEvents_[idx / kBitsPerWord].fetch_or(bit, std::memory_order_acq_rel); prev & bit) {
+    RT_LOG(WARNING) << "Event id " << static_cast<int>(res) << " reused while still on-fly";
+  } else {
+    numOnflyEvents_.fetch_add(1, std::memory_order_relaxed);
+  }
   RT_VLOG(LOW) << "Last event id: " << static_cast<int>(res);
   return res;
 }
@@ -38,44 +51,83 @@ EventId EventManager::getNextId() {
 void EventManager::dispatch(EventId event) {
   EASY_FUNCTION()
   std::unique_lock lock(mutex_);
-  RT_VLOG(LOW) << "Dispatching event " << static_cast<int>(event);
-  if (onflyEvents_.erase(event) != 1) {
+  dispatchLocked(event);
+}
 
-    std::stringstream ss;
-    ss << "Couldn't dispatch event: " << static_cast<int>(event)
-       << ". Perhaps it was already dispatched?. Events on-fly: ";
-    for (auto& e : onflyEvents_) {
-      ss << static_cast<int>(e) << " ";
+void EventManager::dispatch(const std::vector<EventId>& events) {
+  EASY_FUNCTION()
+  std::unique_lock lock(mutex_);
+  // dispatch all events even if some of them fail, the first error is reported once all are processed
+  std::exception_ptr firstError;
+  for (auto event : events) {
+    try {
+      dispatchLocked(event);
+    } catch (...) {
+      if (!firstError) {
+        firstError = std::current_exception();
+      }
     }
+  }
+  if (firstError) {
+    std::rethrow_exception(firstError);
+  }
+}
+
+void EventManager::dispatchLocked(EventId event) {
+  RT_VLOG(LOW) << "Dispatching event " << static_cast<int>(event);
+  if (!clearOnfly(event)) {
     if (throwOnMissingEvent_) {
       throw Exception("Couldn't dispatch event: " + std::to_string(static_cast<int>(event)) +
                       ". Perhaps it was already dispatched?");
-    } else {
-      RT_LOG(WARNING) << ss.str();
     }
+    std::stringstream ss;
+    ss << "Couldn't dispatch event: " << static_cast<int>(event)
+       << ". Perhaps it was already dispatched?. Events on-fly: ";
+    for (auto i = 0UL; i < kNumEventIds; ++i) {
+      if (!isDispatched(EventId{static_cast<std::underlying_type_t<EventId>>(i)})) {
+        ss << i << " ";
+      }
+    }
+    RT_LOG(WARNING) << ss.str();
   }
-  for (auto it = begin(callbacks_); it != end(callbacks_);) {
-    auto& events = it->eventsWatched_;
-    events.erase(std::remove_if(begin(events), end(events), [event](EventId e) { return e == event; }), end(events));
-    if (events.empty()) {
-      callbackExecutor_.pushTask(std::move(it->callback_));
-      it = callbacks_.erase(it);
-    } else {
-      ++it;
+  if (auto it = callbacksByEvent_.find(event); it != end(callbacksByEvent_)) {
+    for (auto id : it->second) {
+      if (auto cb = callbacks_.find(id); cb != end(callbacks_) && --cb->second.pendingEvents_ == 0) {
+        callbackExecutor_.pushTask(std::move(cb->second.callback_));
+        callbacks_.erase(cb);
+      }
     }
+    callbacksByEvent_.erase(it);
   }
 
   if (auto it = blockedThreads_.find(event); it != end(blockedThreads_)) {
-    it->second->notify_all();
+    it->second.condVar_.notify_all();
   }
 }
 
 bool EventManager::isDispatched(EventId event) const {
-  return onflyEvents_.find(event) == end(onflyEvents_);
+  auto idx = static_cast<size_t>(event);
+  auto bit = uint64_t{1} << (idx % kBitsPerWord);
+  return (onflyEvents_[idx / kBitsPerWord].load(std::memory_order_acquire) & bit) == 0;
+}
+
+bool EventManager::clearOnfly(EventId event) {
+  auto idx = static_cast<size_t>(event);
+  auto bit = uint64_t{1} << (idx % kBitsPerWord);
+  if (onflyEvents_[idx / kBitsPerWord].fetch_and(~bit, std::memory_order_acq_rel) & bit) {
+    numOnflyEvents_.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+  }
+  return false;
 }
 
 bool EventManager::blockUntilDispatched(EventId event, std::chrono::milliseconds timeout) {
   RT_VLOG(HIGH) << "Blocking until dispatched for event " << static_cast<int>(event);
+  // fast path, no need to take the lock if the event was already dispatched
+  if (isDispatched(event)) {
+    RT_VLOG(HIGH) << "Event " << static_cast<int>(event) << " already dispatched.";
+    return true;
+  }
   std::unique_lock lock(mutex_);
   if (isDispatched(event)) {
     RT_VLOG(HIGH) << "Event " << static_cast<int>(event) << " already dispatched.";
@@ -84,24 +136,16 @@ bool EventManager::blockUntilDispatched(EventId event, std::chrono::milliseconds
     return false;
   }
 
-  auto it = blockedThreads_.find(event);
-
-  std::condition_variable* cv;
-  if (it == end(blockedThreads_)) {
-    auto tmp = std::make_unique<std::condition_variable>();
-    cv = tmp.get();
-    blockedThreads_[event] = std::move(tmp);
-  } else {
-    cv = it->second.get();
+  auto& waiters = blockedThreads_[event];
+  ++waiters.count_;
+  auto res = waiters.condVar_.wait_for(lock, timeout, [this, event] { return isDispatched(event) || destroying_; });
+  if (--waiters.count_ == 0) {
+    blockedThreads_.erase(event);
   }
-  auto res = cv->wait_for(lock, timeout);
-  if (res == std::cv_status::timeout) {
+  if (!res) {
     RT_VLOG(HIGH) << "Event " << static_cast<int>(event) << " TIMED OUT.";
     return false;
   }
-  if (blockedThreads_.find(event) != end(blockedThreads_)) {
-    blockedThreads_.erase(event);
-  }
   RT_VLOG(HIGH) << "Event " << static_cast<int>(event) << " dispatched.";
   return true;
 }
@@ -109,10 +153,11 @@ bool EventManager::blockUntilDispatched(EventId event, std::chrono::milliseconds
 EventManager::~EventManager() {
   using namespace std::chrono_literals;
   std::unique_lock lock(mutex_);
-  for (auto& [event, cv] : blockedThreads_) {
+  destroying_ = true;
+  for (auto& [event, waiters] : blockedThreads_) {
     RT_LOG(WARNING)
       << "Destroying eventmanager with non-dispatched events. Notifying all threads that where waiting for event "
       << static_cast<int>(event);
-    cv->notify_all();
+    waiters.condVar_.notify_all();
   }
-}
\ No newline at end of file
+}
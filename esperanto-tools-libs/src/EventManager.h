@@ -10,9 +10,9 @@
 #include <hostUtils/threadPool/ThreadPool.h>
 #include <hostUtils/threadPool/function2.hpp>
 
+#include <array>
 #include <atomic>
 #include <condition_variable>
-#include <set>
 #include <unordered_map>
 namespace rt {
 
@@ -26,24 +26,51 @@ public:
 
   EventId getNextId();
   void dispatch(EventId event);
+  void dispatch(const std::vector<EventId>& events);
   // returns false if the timeout is reached; true otherwise
   bool blockUntilDispatched(EventId event, std::chrono::milliseconds timeout);
   void setThrowOnMissingEvent(bool value) {
     throwOnMissingEvent_ = value;
   }
+  // lock-free; an event is on-fly from getNextId until it's dispatched
+  bool isDispatched(EventId event) const;
+  size_t getNumOnflyEvents() const {
+    return numOnflyEvents_.load(std::memory_order_relaxed);
+  }
   ~EventManager();
 
   void addOnDispatchCallback(OnDispatchCallback callback);
 
 private:
-  bool isDispatched(EventId event) const;
+  static constexpr size_t kNumEventIds = size_t{1} << (8 * sizeof(std::underlying_type_t<EventId>));
+  static constexpr size_t kBitsPerWord = 64;
+
+  struct PendingCallback {
+    size_t pendingEvents_;
+    fu2::unique_function<void()> callback_;
+  };
+  struct Waiters {
+    std::condition_variable condVar_;
+    size_t count_ = 0;
+  };
+
+  // returns true if the event was on-fly
+  bool clearOnfly(EventId event);
+  // mutex_ must be held by the caller
+  void dispatchLocked(EventId event);
 
   mutable std::mutex mutex_;
   bool throwOnMissingEvent_ = false;
-  std::set<EventId> onflyEvents_;
-  std::vector<OnDispatchCallback> callbacks_;
-  std::unordered_map<EventId, std::unique_ptr<std::condition_variable>> blockedThreads_;
-  std::underlying_type_t<EventId> nextEventId_ = 0;
+  bool destroying_ = false;
+  // one bit per event id; ids are monotonic and wrap around the full EventId range
+  std::array<std::atomic<uint64_t>, kNumEventIds / kBitsPerWord> onflyEvents_{};
+  std::atomic<size_t> numOnflyEvents_ = 0;
+  std::atomic<std::underlying_type_t<EventId>> nextEventId_ = 0;
+  // callbacks are indexed by each watched event, so a dispatch only touches the callbacks waiting for it
+  std::unordered_map<size_t, PendingCallback> callbacks_;
+  std::unordered_map<EventId, std::vector<size_t>> callbacksByEvent_;
+  size_t nextCallbackId_ = 0;
+  std::unordered_map<EventId, Waiters> blockedThreads_;
   threadPool::ThreadPool callbackExecutor_{2};
 };
 } // namespace rt
@@ -11,15 +11,19 @@
 
 #include <algorithm>
 #include <cassert>
+#include <future>
+#include <string>
 #include <type_traits>
 
 using namespace rt;
 using Buffer = ExecutionContextCache::Buffer;
 
-Buffer::Buffer(DeviceId device, RuntimeImp* runtime, size_t size)
+Buffer::Buffer(DeviceId device, RuntimeImp* runtime, size_t size, uint32_t index)
   : hostBuffer_(size)
   , device_(device)
-  , runtime_(runtime) {
+  , runtime_(runtime)
+  , index_(index)
+  , next_(kNoBuffer) {
   deviceBuffer_ = runtime->doMallocDevice(device, size);
 }
 
@@ -28,84 +32,128 @@ Buffer::~Buffer() {
 }
 
 ExecutionContextCache::~ExecutionContextCache() {
-  RT_LOG_IF(WARNING, !reservedBuffers_.empty() || !allocBuffers_.empty())
-    << "Reserved or allocated buffers are not empty in destruction.";
-  for (const auto& [event, value] : reservedBuffers_) {
-    unused(value);
-    RT_LOG(WARNING) << "Reserved buffer for event " << static_cast<int>(event) << " wasn't released.";
-  }
-  for (auto const buffer : allocBuffers_) {
-    RT_LOG(WARNING) << "Allocated buffer 0x" << buffer << " wasn't released.";
+  auto inUse = false;
+  for (const auto& [device, deviceBuffers] : devices_) {
+    for (auto i = 0U; i < deviceBuffers.numBuffers_; ++i) {
+      const auto& buffer = deviceBuffers.buffers_[i];
+      if (buffer->state_ != Buffer::State::Free) {
+        RT_LOG(WARNING) << (buffer->state_ == Buffer::State::Reserved ? "Reserved" : "Allocated") << " buffer 0x"
+                        << buffer.get() << " wasn't released.";
+        inUse = true;
+      }
+    }
   }
-  assert(reservedBuffers_.empty());
-  assert(allocBuffers_.empty());
+  unused(inUse);
+  assert(!inUse);
 }
 
 ExecutionContextCache::ExecutionContextCache(RuntimeImp* runtime, int initialFreeListSize, int bufferSize)
-  : runtime_(runtime)
+  : reservedBuffers_(std::make_unique<std::atomic<Buffer*>[]>(kNumEventIds))
+  , runtime_(runtime)
   , bufferSize_(bufferSize) {
   auto devices = runtime_->doGetDevices();
   // TODO: see SW-9219, we fill these buffers with trash until this is properly handled
   std::vector<std::byte> trash;
   std::fill_n(std::back_inserter(trash), bufferSize, std::byte{0xCD});
   for (auto dev : devices) {
-    auto st = runtime_->doCreateStream(dev);
-    auto [it, res] = freeBuffers_.try_emplace(dev, std::vector<Buffer*>{});
+    auto [it, res] = devices_.try_emplace(dev);
     (void)res;
     assert(res);
-    auto& list = it->second;
-    for (int i = 0; i < initialFreeListSize; ++i) {
-      buffers_.emplace_back(std::make_unique<Buffer>(dev, runtime_, bufferSize_));
-      auto bufferPtr = buffers_.back().get();
-      // TODO: see SW-9219, we fill these buffers with trash until this is properly handled
-      runtime_->doMemcpyHostToDevice(st, trash.data(), bufferPtr->deviceBuffer_, static_cast<size_t>(bufferSize), true,
-                                     defaultCmaCopyFunction);
-      list.emplace_back(bufferPtr);
+  }
+  // the devices are filled at the same time, each one waits for its own memcpys
+  std::vector<std::future<void>> fills;
+  for (auto dev : devices) {
+    fills.emplace_back(std::async(std::launch::async, [this, dev, initialFreeListSize, bufferSize, &trash] {
+      auto st = runtime_->doCreateStream(dev, StreamPriority::Normal);
+      auto& deviceBuffers = devices_.at(dev);
+      for (int i = 0; i < initialFreeListSize; ++i) {
+        auto bufferPtr = createBuffer(deviceBuffers, dev);
+        // TODO: see SW-9219, we fill these buffers with trash until this is properly handled
+        runtime_->doMemcpyHostToDevice(st, trash.data(), bufferPtr->deviceBuffer_, static_cast<size_t>(bufferSize),
+                                       true, defaultCmaCopyFunction);
+        pushFree(deviceBuffers, bufferPtr);
+      }
+      runtime_->doWaitForStream(st);
+      runtime_->doDestroyStream(st);
+    }));
+  }
+  for (auto& fill : fills) {
+    fill.wait();
+  }
+  for (auto& fill : fills) {
+    fill.get();
+  }
+}
+
+Buffer* ExecutionContextCache::createBuffer(DeviceBuffers& deviceBuffers, DeviceId device) {
+  // the slot is only published once its buffer is built, so a failed allocation leaves no empty slot behind
+  std::lock_guard lock(deviceBuffers.createMutex_);
+  auto index = deviceBuffers.numBuffers_.load(std::memory_order_relaxed);
+  if (index == kMaxBuffers) {
+    throw Exception("Too many execution context buffers for device " + std::to_string(static_cast<int>(device)));
+  }
+  auto& slot = deviceBuffers.buffers_[index];
+  slot = std::make_unique<Buffer>(device, runtime_, bufferSize_, index);
+  deviceBuffers.numBuffers_.store(index + 1, std::memory_order_release);
+  return slot.get();
+}
+
+Buffer* ExecutionContextCache::popFree(DeviceBuffers& deviceBuffers) {
+  auto head = deviceBuffers.freeHead_.load(std::memory_order_acquire);
+  while (static_cast<uint32_t>(head) != kNoBuffer) {
+    auto top = deviceBuffers.buffers_[static_cast<uint32_t>(head)].get();
+    auto next = top->next_.load(std::memory_order_relaxed);
+    auto newHead = ((head >> 32) + 1) << 32 | next;
+    if (deviceBuffers.freeHead_.compare_exchange_weak(head, newHead, std::memory_order_acquire,
+                                                      std::memory_order_acquire)) {
+      return top;
     }
-    runtime_->doWaitForStream(st);
-    runtime_->doDestroyStream(st);
   }
+  return nullptr;
+}
+
+void ExecutionContextCache::pushFree(DeviceBuffers& deviceBuffers, Buffer* buffer) {
+  buffer->state_ = Buffer::State::Free;
+  auto head = deviceBuffers.freeHead_.load(std::memory_order_relaxed);
+  uint64_t newHead;
+  do {
+    buffer->next_.store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+    newHead = ((head >> 32) + 1) << 32 | buffer->index_;
+  } while (!deviceBuffers.freeHead_.compare_exchange_weak(head, newHead, std::memory_order_release,
+                                                          std::memory_order_relaxed));
 }
 
 Buffer* ExecutionContextCache::allocBuffer(DeviceId deviceId) {
   RT_VLOG(MID) << "Allocating buffer for device " << static_cast<int>(deviceId);
-  SpinLock lock(mutex_);
-  auto&& list = freeBuffers_[deviceId];
-  if (list.empty()) {
-    buffers_.emplace_back(std::make_unique<Buffer>(deviceId, runtime_, bufferSize_));
-    list.emplace_back(buffers_.back().get());
+  auto& deviceBuffers = find(devices_, deviceId, "Device without execution context buffers")->second;
+  auto result = popFree(deviceBuffers);
+  if (result == nullptr) {
+    result = createBuffer(deviceBuffers, deviceId);
   }
-  auto result = list.back();
-  auto [insertion, res] = allocBuffers_.insert(result);
-  unused(insertion, res);
-  assert(res);
-  list.pop_back();
+  result->state_ = Buffer::State::Allocated;
   return result;
 }
 
 void ExecutionContextCache::reserveBuffer(EventId event, Buffer* buffer) {
   RT_VLOG(MID) << "Reserving buffer " << buffer << " for event " << static_cast<int>(event);
-  SpinLock lock(mutex_);
-  auto it = find(allocBuffers_, buffer, "Trying to reserve a buffer which wasn't allocated previously");
-  auto [insertion, res] = reservedBuffers_.emplace(event, *it);
-  unused(insertion, res);
-  assert(res);
-  allocBuffers_.erase(it);
+  if (auto expected = Buffer::State::Allocated;
+      !buffer->state_.compare_exchange_strong(expected, Buffer::State::Reserved)) {
+    throw Exception("Trying to reserve a buffer which wasn't allocated previously");
+  }
+  auto previous = reservedBuffers_[static_cast<size_t>(event)].exchange(buffer, std::memory_order_acq_rel);
+  unused(previous);
+  assert(previous == nullptr);
 }
 
 Buffer* ExecutionContextCache::getReservedBuffer(EventId eventId) const {
-  SpinLock lock(mutex_);
-  if (auto it = reservedBuffers_.find(eventId); it != end(reservedBuffers_)) {
-    return it->second;
-  }
-  return nullptr;
+  return reservedBuffers_[static_cast<size_t>(eventId)].load(std::memory_order_acquire);
 }
 
 void ExecutionContextCache::releaseBuffer(EventId id) {
   RT_VLOG(MID) << "Releasing buffer for event " << static_cast<int>(id);
-  SpinLock lock(mutex_);
-  auto it = find(reservedBuffers_, id);
-  freeBuffers_[it->second->device_].emplace_back(it->second);
-  reservedBuffers_.erase(it);
-  RT_VLOG(MID) << "Buffer erased. In use buffers count: " << reservedBuffers_.size();
+  auto buffer = reservedBuffers_[static_cast<size_t>(id)].exchange(nullptr, std::memory_order_acq_rel);
+  if (buffer == nullptr) {
+    throw Exception("There is no buffer reserved for event " + std::to_string(static_cast<int>(id)));
+  }
+  pushFree(find(devices_, buffer->device_)->second, buffer);
 }
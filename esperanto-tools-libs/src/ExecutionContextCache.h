@@ -7,9 +7,11 @@
 #include "MemoryManager.h"
 #include "runtime/IRuntime.h"
 
+#include <atomic>
 #include <cstddef>
+#include <memory>
 #include <mutex>
-#include <set>
+#include <type_traits>
 #include <unordered_map>
 #include <vector>
 
@@ -19,7 +21,8 @@ class RuntimeImp;
 class ExecutionContextCache {
 public:
   struct Buffer {
-    explicit Buffer(DeviceId device, RuntimeImp* runtime, size_t size);
+    enum class State { Free, Allocated, Reserved };
+    explicit Buffer(DeviceId device, RuntimeImp* runtime, size_t size, uint32_t index);
     ~Buffer();
     std::byte* getExceptionContextPtr() const {
       return deviceBuffer_ + kBlockSize;
@@ -35,11 +38,15 @@ public:
     std::byte* deviceBuffer_;
     DeviceId device_;
     RuntimeImp* runtime_;
+    uint32_t index_;             // position in the device buffers
+    std::atomic<uint32_t> next_; // next free buffer index, only meaningful while in the free list
+    std::atomic<State> state_ = State::Free;
   };
 
   explicit ExecutionContextCache(RuntimeImp* runtime, int initialFreeListSize = 10, int bufferSize = kBlockSize);
 
-  // returns a buffer from the free list, if there are no free list then it will allocate a buffer and use that
+  // returns a buffer from the device free list, if it's empty then it will allocate a buffer and use that. Lock-free
+  // unless a new buffer has to be allocated
   Buffer* allocBuffer(DeviceId deviceId);
 
   // associates a previously allocated buffer through allocBuffer with the given kernelId.
@@ -47,7 +54,7 @@ public:
   // the buffer
   void reserveBuffer(EventId eventId, Buffer* buffer);
 
-  // release the buffer associated to given eventId and returns it to the freeBuffers list, should be done whenever
+  // release the buffer associated to given eventId and returns it to the device free list, should be done whenever
   // the kernel completes execution
   void releaseBuffer(EventId eventId);
 
@@ -62,14 +69,32 @@ public:
   ~ExecutionContextCache();
 
 private:
-  mutable std::mutex mutex_;
-  std::unordered_map<DeviceId, std::vector<Buffer*>> freeBuffers_;
-  std::unordered_map<EventId, Buffer*> reservedBuffers_;
-  // these are the buffers which are currently allocated but yet not reserved.
-  std::set<Buffer*> allocBuffers_;
+  static constexpr size_t kNumEventIds = size_t{1} << (8 * sizeof(std::underlying_type_t<EventId>));
+  // every buffer in use is associated to an on-fly event, so there can't be more buffers than event ids
+  static constexpr uint32_t kMaxBuffers = kNumEventIds;
+  static constexpr uint32_t kNoBuffer = ~0U;
 
-  // these are all the allocated buffers; (freeBuffers_ + reservedBuffers_ + allocBuffers_)
-  std::vector<std::unique_ptr<Buffer>> buffers_;
+  struct DeviceBuffers {
+    DeviceBuffers()
+      : buffers_(kMaxBuffers) {
+    }
+    // fixed size so it's never reallocated; entries are filled up to numBuffers_ and never removed
+    std::vector<std::unique_ptr<Buffer>> buffers_;
+    std::atomic<uint32_t> numBuffers_ = 0;
+    // serializes the creation of new buffers, the slow path of allocBuffer
+    std::mutex createMutex_;
+    // lock-free stack of free buffers. Lower 32 bits are the top index, upper 32 bits a tag which avoids ABA
+    std::atomic<uint64_t> freeHead_ = kNoBuffer;
+  };
+
+  Buffer* popFree(DeviceBuffers& deviceBuffers);
+  void pushFree(DeviceBuffers& deviceBuffers, Buffer* buffer);
+  Buffer* createBuffer(DeviceBuffers& deviceBuffers, DeviceId device);
+
+  // filled at construction, read-only afterwards
+  std::unordered_map<DeviceId, DeviceBuffers> devices_;
+  // indexed by EventId
+  std::unique_ptr<std::atomic<Buffer*>[]> reservedBuffers_;
   RuntimeImp* runtime_;
   int bufferSize_;
 };
@@ -0,0 +1,300 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) 2025 Ainekko, Co.
+ * SPDX-License-Identifier: Apache-2.0
+ *-------------------------------------------------------------------------*/
+
+#include "ExecutionContextCache.h"
+#include "RuntimeImp.h"
+#include "Utils.h"
+#include "runtime/DeviceOpsExt.h"
+#include "runtime/Types.h"
+#include <algorithm>
+#include <cstring>
+#include <esperanto/device-apis/operations-api/device_ops_api_cxx.h>
+#include <esperanto/device-apis/operations-api/device_ops_api_spec.h>
+#include <limits>
+#include <mutex>
+
+using namespace rt;
+
+namespace {
+// commands MasterMinion can execute from a command list, see uploadGraph
+bool isListStage(uint16_t msgId) {
+  switch (msgId) {
+  case device_ops_api::DEV_OPS_API_MID_DEVICE_OPS_DMA_WRITELIST_CMD:
+  case device_ops_api::DEV_OPS_API_MID_DEVICE_OPS_DMA_READLIST_CMD:
+  case device_ops_api::DEV_OPS_API_MID_DEVICE_OPS_P2PDMA_WRITELIST_CMD:
+  case device_ops_api::DEV_OPS_API_MID_DEVICE_OPS_P2PDMA_READLIST_CMD:
+  case device_ops_api::DEV_OPS_API_MID_DEVICE_OPS_KERNEL_LAUNCH_CMD:
+  case device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_MEMSET_CMD:
+  case device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_DEVICE_MEMCPY_CMD:
+  case device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_KERNEL_FLUSH_RANGES_CMD:
+  case device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_KERNEL_SHIRE_ARGS_CMD:
+  case device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_KERNEL_WATCHDOG_CMD:
+  case device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_KERNEL_LAUNCH_CONFIG_CMD:
+    return true;
+  default:
+    return false;
+  }
+}
+} // namespace
+
+bool RuntimeImp::isCapturing(StreamId stream) const {
+  std::lock_guard lock(graphsMutex_);
+  return captures_.find(stream) != end(captures_);
+}
+
+EventId RuntimeImp::captureCommands(StreamId stream, std::vector<GraphNode> nodes) {
+  {
+    std::lock_guard lock(graphsMutex_);
+    auto& graph = find(captures_, stream, "Stream is not being captured")->second;
+    for (auto& node : nodes) {
+      if (!node.args_.empty()) {
+        auto offset = (graph.args_.size() + kCacheLineSize - 1) / kCacheLineSize * kCacheLineSize;
+        graph.args_.resize(offset);
+        graph.args_.insert(end(graph.args_), begin(node.args_), end(node.args_));
+        node.argsOffset_ = offset;
+        node.args_.clear();
+      }
+      graph.nodes_.emplace_back(std::move(node));
+    }
+    RT_VLOG(MID) << "Captured commands on stream " << static_cast<int>(stream)
+                 << ". Graph nodes: " << graph.nodes_.size();
+  }
+  // captured operations don't execute anything, give back an already completed event
+  auto evt = eventManager_.getNextId();
+  streamManager_.addEvent(stream, evt);
+  dispatch(evt);
+  return evt;
+}
+
+void RuntimeImp::doBeginCapture(StreamId stream) {
+  auto streamInfo = streamManager_.getStreamInfo(stream);
+  flushCoalescedMemcpys(stream);
+  std::lock_guard lock(graphsMutex_);
+  if (auto [it, inserted] = captures_.try_emplace(stream, Graph{DeviceId{streamInfo.device_}, {}, {}, nullptr});
+      !inserted) {
+    throw Exception("Stream " + std::to_string(static_cast<int>(stream)) + " is already being captured");
+  }
+  RT_VLOG(LOW) << "Begin capture on stream " << static_cast<int>(stream);
+}
+
+GraphId RuntimeImp::doEndCapture(StreamId stream) {
+  std::unique_lock lock(graphsMutex_);
+  auto it = find(captures_, stream, "Stream is not being captured");
+  auto graph = std::move(it->second);
+  captures_.erase(it);
+  lock.unlock();
+
+  if (!graph.args_.empty()) {
+    // upload all the staged kernel args at once; launches will point to them without any extra copy
+    graph.argsBuffer_ = doMallocDevice(graph.device_, graph.args_.size());
+    try {
+      auto evt = doMemcpyHostToDevice(stream, graph.args_.data(), graph.argsBuffer_, graph.args_.size(), false,
+                                      defaultCmaCopyFunction);
+      if (!doWaitForEvent(evt)) {
+        throw Exception("Timeout uploading graph kernel args");
+      }
+    } catch (...) {
+      doFreeDevice(graph.device_, graph.argsBuffer_);
+      throw;
+    }
+    graph.args_.clear();
+  }
+
+  lock.lock();
+  auto id = GraphId{nextGraphId_++};
+  RT_VLOG(LOW) << "End capture on stream " << static_cast<int>(stream) << ". Graph " << static_cast<int>(id)
+               << " has " << graph.nodes_.size() << " commands";
+  graphs_.emplace(id, std::move(graph));
+  return id;
+}
+
+void RuntimeImp::doUploadGraph(StreamId stream, GraphId graphId) {
+  auto streamInfo = streamManager_.getStreamInfo(stream);
+  auto device = DeviceId{streamInfo.device_};
+  if (isCapturing(stream)) {
+    throw Exception("Can't upload a graph through a stream which is being captured");
+  }
+  std::unique_lock lock(graphsMutex_);
+  const auto& graph = find(graphs_, graphId, "Graph not found")->second;
+  if (graph.device_ != device) {
+    throw Exception("Can't upload a graph through a stream associated to a different device");
+  }
+  if (graph.listBuffer_ != nullptr) {
+    throw Exception("Graph " + std::to_string(static_cast<int>(graphId)) + " is already uploaded");
+  }
+  // the exception buffer and the embedded args address of the kernel launches are given on each launch
+  std::vector<std::byte> list;
+  std::vector<std::pair<size_t, size_t>> launchArgs;
+  bool barrier = false;
+  for (const auto& node : graph.nodes_) {
+    auto header = reinterpret_cast<const device_ops_api::cmn_header_t*>(node.command_.data());
+    if (!isListStage(header->msg_id) || node.command_.size() > device_ops_ext::kCmdListStageSizeMax) {
+      throw Exception("Graph command with msg_id " + std::to_string(header->msg_id) + " can't be uploaded");
+    }
+    barrier |= (header->flags & device_ops_api::CMD_FLAGS_BARRIER_ENABLE) != 0;
+    auto offset = list.size();
+    list.insert(end(list), node.command_.data(), node.command_.data() + node.command_.size());
+    if (node.isKernelLaunch_) {
+      auto cmdPtr = reinterpret_cast<device_ops_api::device_ops_kernel_launch_cmd_t*>(list.data() + offset);
+      cmdPtr->exception_buffer = 0;
+      cmdPtr->pointer_to_args = node.argsOffset_ ? reinterpret_cast<uint64_t>(graph.argsBuffer_ + *node.argsOffset_) : 0;
+      launchArgs.emplace_back(node.embeddedArgsOffset_ ? offset + *node.embeddedArgsOffset_ : 0,
+                              node.embeddedArgsSize_);
+    }
+    list.resize((list.size() + 7) / 8 * 8);
+  }
+  if (list.empty() || list.size() > std::numeric_limits<uint32_t>::max()) {
+    throw Exception("Graph " + std::to_string(static_cast<int>(graphId)) + " can't be uploaded, its size is " +
+                    std::to_string(list.size()));
+  }
+  // the upload takes the device mutex, which goes before graphsMutex_
+  lock.unlock();
+
+  auto listBuffer = doMallocDevice(device, list.size());
+  try {
+    auto evt = doMemcpyHostToDevice(stream, list.data(), listBuffer, list.size(), false, defaultCmaCopyFunction);
+    if (!doWaitForEvent(evt)) {
+      throw Exception("Timeout uploading graph commands");
+    }
+    lock.lock();
+    auto& uploaded = find(graphs_, graphId, "Graph not found")->second;
+    if (uploaded.listBuffer_ != nullptr) {
+      throw Exception("Graph " + std::to_string(static_cast<int>(graphId)) + " is already uploaded");
+    }
+    uploaded.listBuffer_ = listBuffer;
+    uploaded.listSize_ = static_cast<uint32_t>(list.size());
+    uploaded.listBarrier_ = barrier;
+    uploaded.listLaunchArgs_ = std::move(launchArgs);
+  } catch (...) {
+    if (lock.owns_lock()) {
+      lock.unlock();
+    }
+    doFreeDevice(device, listBuffer);
+    throw;
+  }
+  RT_VLOG(LOW) << "Uploaded graph " << static_cast<int>(graphId) << ": " << list.size() << " bytes";
+}
+
+EventId RuntimeImp::doLaunchGraph(StreamId stream, GraphId graphId, const std::vector<GraphArgPatch>& patches) {
+  auto streamInfo = streamManager_.getStreamInfo(stream);
+  auto device = DeviceId{streamInfo.device_};
+  SpinLock lock(getDeviceMutex(device));
+  flushCoalescedMemcpys(stream);
+  std::unique_lock graphsLock(graphsMutex_);
+  if (captures_.find(stream) != end(captures_)) {
+    throw Exception("Can't launch a graph on a stream which is being captured");
+  }
+  const auto& graph = find(graphs_, graphId, "Graph not found")->second;
+  if (graph.device_ != device) {
+    throw Exception("Can't launch a graph on a stream associated to a different device");
+  }
+  if (graph.listBuffer_ == nullptr && !patches.empty()) {
+    throw Exception("Only uploaded graphs can be patched");
+  }
+  auto& commandSender = find(commandSenders_, getCommandSenderIdx(streamInfo.device_, streamInfo.vq_))->second;
+
+  if (graph.listBuffer_ != nullptr) {
+    if (patches.size() > device_ops_ext::kCmdListPatchesMax) {
+      throw Exception("Too many graph patches, the maximum is " + std::to_string(device_ops_ext::kCmdListPatchesMax));
+    }
+    CommandData data(sizeof(device_ops_ext::device_ops_cmd_list_execute_cmd_t));
+    auto cmd = reinterpret_cast<device_ops_ext::device_ops_cmd_list_execute_cmd_t*>(data.data());
+    memset(cmd, 0, sizeof(*cmd));
+    for (size_t i = 0; i < patches.size(); ++i) {
+      const auto& patch = patches[i];
+      if (patch.launch_ >= graph.listLaunchArgs_.size()) {
+        throw Exception("Graph patch of kernel launch " + std::to_string(patch.launch_) + ", the graph has " +
+                        std::to_string(graph.listLaunchArgs_.size()));
+      }
+      auto [argsOffset, argsSize] = graph.listLaunchArgs_[patch.launch_];
+      if (patch.argsOffset_ % sizeof(uint64_t) != 0 || patch.argsOffset_ + sizeof(uint64_t) > argsSize) {
+        throw Exception("Graph patch out of the embedded args of kernel launch " + std::to_string(patch.launch_));
+      }
+      cmd->patches[i].offset = static_cast<uint32_t>(argsOffset + patch.argsOffset_);
+      cmd->patches[i].value = patch.value_;
+    }
+    cmd->command_info.cmd_hdr.msg_id = device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_CMD_LIST_EXECUTE_CMD;
+    cmd->command_info.cmd_hdr.size = static_cast<device_ops_api::msg_size_t>(sizeof(*cmd));
+    cmd->command_info.cmd_hdr.flags = graph.listBarrier_ ? device_ops_api::CMD_FLAGS_BARRIER_ENABLE : 0;
+    cmd->list_address = reinterpret_cast<uint64_t>(graph.listBuffer_);
+    cmd->list_size = graph.listSize_;
+    cmd->stage_count = static_cast<uint32_t>(graph.nodes_.size());
+    cmd->patch_count = static_cast<uint32_t>(patches.size());
+
+    auto evt = eventManager_.getNextId();
+    streamManager_.addEvent(stream, evt);
+    cmd->command_info.cmd_hdr.tag_id = static_cast<device_ops_api::tag_id_t>(evt);
+    if (!graph.listLaunchArgs_.empty()) {
+      // the kernels run one after the other, they share a single execution context
+      auto pBuffer = executionContextCache_->allocBuffer(device);
+      executionContextCache_->reserveBuffer(evt, pBuffer);
+      cmd->exception_buffer = reinterpret_cast<uint64_t>(pBuffer->getExceptionContextPtr());
+      cmd->args_buffer = reinterpret_cast<uint64_t>(pBuffer->getParametersPtr());
+      for (const auto& node : graph.nodes_) {
+        if (!node.coreDumpFilePath_.empty()) {
+          coreDumper_.addKernelExecution(node.coreDumpFilePath_, node.kernel_, evt);
+          break;
+        }
+      }
+    }
+    RT_VLOG(LOW) << "Launching uploaded graph " << static_cast<int>(graphId) << " on stream "
+                 << static_cast<int>(stream) << " EventId: " << static_cast<int>(evt)
+                 << " commands: " << graph.nodes_.size() << " patches: " << patches.size();
+    auto isDma = std::any_of(begin(graph.nodes_), end(graph.nodes_), [](const auto& node) { return node.isDma_; });
+    auto isP2P = std::any_of(begin(graph.nodes_), end(graph.nodes_), [](const auto& node) { return node.isP2P_; });
+    commandSender.send(Command{std::move(data), commandSender, evt, evt, stream, isDma, true, isP2P});
+    Sync(evt);
+    return evt;
+  }
+
+  auto evt = eventManager_.getNextId();
+  streamManager_.addEvent(stream, evt);
+  RT_VLOG(LOW) << "Launching graph " << static_cast<int>(graphId) << " on stream " << static_cast<int>(stream)
+               << " EventId: " << static_cast<int>(evt) << " commands: " << graph.nodes_.size();
+
+  std::vector<EventId> cmdEvents;
+  cmdEvents.reserve(graph.nodes_.size());
+  for (const auto& node : graph.nodes_) {
+    auto cmdEvt = eventManager_.getNextId();
+    streamManager_.addEvent(stream, cmdEvt);
+    auto data = node.command_;
+    auto header = reinterpret_cast<device_ops_api::cmn_header_t*>(data.data());
+    header->tag_id = static_cast<device_ops_api::tag_id_t>(cmdEvt);
+    if (node.isKernelLaunch_) {
+      // each launch needs its own execution context so errors are reported per kernel execution
+      auto pBuffer = executionContextCache_->allocBuffer(device);
+      executionContextCache_->reserveBuffer(cmdEvt, pBuffer);
+      auto cmdPtr = reinterpret_cast<device_ops_api::device_ops_kernel_launch_cmd_t*>(data.data());
+      cmdPtr->exception_buffer = reinterpret_cast<uint64_t>(pBuffer->getExceptionContextPtr());
+      cmdPtr->pointer_to_args = reinterpret_cast<uint64_t>(
+        node.argsOffset_ ? graph.argsBuffer_ + *node.argsOffset_ : pBuffer->getParametersPtr());
+      if (!node.coreDumpFilePath_.empty()) {
+        coreDumper_.addKernelExecution(node.coreDumpFilePath_, node.kernel_, cmdEvt);
+      }
+    }
+    commandSender.send(
+      Command{std::move(data), commandSender, cmdEvt, cmdEvt, stream, node.isDma_, true, node.isP2P_});
+    cmdEvents.emplace_back(cmdEvt);
+  }
+  eventManager_.addOnDispatchCallback({std::move(cmdEvents), [this, evt] { dispatch(evt); }});
+
+  Sync(evt);
+  return evt;
+}
+
+void RuntimeImp::doDestroyGraph(GraphId graphId) {
+  std::unique_lock lock(graphsMutex_);
+  auto it = find(graphs_, graphId, "Graph not found");
+  auto graph = std::move(it->second);
+  graphs_.erase(it);
+  lock.unlock();
+  RT_VLOG(LOW) << "Destroying graph " << static_cast<int>(graphId);
+  if (graph.argsBuffer_ != nullptr) {
+    doFreeDevice(graph.device_, graph.argsBuffer_);
+  }
+  if (graph.listBuffer_ != nullptr) {
+    doFreeDevice(graph.device_, graph.listBuffer_);
+  }
+}
@@ -9,10 +9,12 @@
 #include "RuntimeImp.h"
 #include "ScopedProfileEvent.h"
 #include "Utils.h"
+#include "runtime/DeviceOpsExt.h"
 #include "runtime/Types.h"
 #include <chrono>
 #include <cmath>
 #include <cstdio>
+#include <cstring>
 #include <device-layer/IDeviceLayer.h>
 #include <elfio/elfio.hpp>
 #include <esperanto/device-apis/operations-api/device_ops_api_cxx.h>
@@ -24,17 +26,118 @@
 using namespace rt;
 using namespace rt::profiling;
 
+namespace {
+static_assert(KernelLaunchOptions::kMaxFlushRanges == device_ops_ext::kKernelFlushRangesMax);
+
+CommandData makeKernelFlushRangesCommand(const std::vector<std::pair<uint64_t, uint64_t>>& ranges) {
+  CommandData data(sizeof(device_ops_ext::device_ops_kernel_flush_ranges_cmd_t));
+  auto cmd = reinterpret_cast<device_ops_ext::device_ops_kernel_flush_ranges_cmd_t*>(data.data());
+  memset(cmd, 0, sizeof(*cmd));
+  cmd->command_info.cmd_hdr.msg_id = device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_KERNEL_FLUSH_RANGES_CMD;
+  cmd->command_info.cmd_hdr.size = static_cast<device_ops_api::msg_size_t>(sizeof(*cmd));
+  cmd->count = static_cast<uint32_t>(ranges.size());
+  for (size_t i = 0; i < ranges.size(); ++i) {
+    cmd->ranges[i].device_phy_addr = ranges[i].first;
+    cmd->ranges[i].size = ranges[i].second;
+  }
+  return data;
+}
+
+CommandData makeKernelShireArgsCommand(uint32_t stride) {
+  CommandData data(sizeof(device_ops_ext::device_ops_kernel_shire_args_cmd_t));
+  auto cmd = reinterpret_cast<device_ops_ext::device_ops_kernel_shire_args_cmd_t*>(data.data());
+  memset(cmd, 0, sizeof(*cmd));
+  cmd->command_info.cmd_hdr.msg_id = device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_KERNEL_SHIRE_ARGS_CMD;
+  cmd->command_info.cmd_hdr.size = static_cast<device_ops_api::msg_size_t>(sizeof(*cmd));
+  cmd->stride = stride;
+  return data;
+}
+
+CommandData makeKernelWatchdogCommand(uint32_t timeout) {
+  CommandData data(sizeof(device_ops_ext::device_ops_kernel_watchdog_cmd_t));
+  auto cmd = reinterpret_cast<device_ops_ext::device_ops_kernel_watchdog_cmd_t*>(data.data());
+  memset(cmd, 0, sizeof(*cmd));
+  cmd->command_info.cmd_hdr.msg_id = device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_KERNEL_WATCHDOG_CMD;
+  cmd->command_info.cmd_hdr.size = static_cast<device_ops_api::msg_size_t>(sizeof(*cmd));
+  cmd->timeout = timeout;
+  return data;
+}
+
+CommandData makeKernelLaunchConfigCommand(uint32_t flags, uint16_t scpSets, uint16_t l2Sets) {
+  CommandData data(sizeof(device_ops_ext::device_ops_kernel_launch_config_cmd_t));
+  auto cmd = reinterpret_cast<device_ops_ext::device_ops_kernel_launch_config_cmd_t*>(data.data());
+  memset(cmd, 0, sizeof(*cmd));
+  cmd->command_info.cmd_hdr.msg_id = device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_KERNEL_LAUNCH_CONFIG_CMD;
+  cmd->command_info.cmd_hdr.size = static_cast<device_ops_api::msg_size_t>(sizeof(*cmd));
+  cmd->flags = flags;
+  cmd->scp_sets = scpSets;
+  cmd->l2_sets = l2Sets;
+  return data;
+}
+
+// gives the shires chosen by the scheduler back, unless the launch gets to the point where its event holds them
+struct ScheduledShires {
+  ShireScheduler* scheduler_ = nullptr;
+  uint64_t mask_ = 0;
+  ~ScheduledShires() {
+    if (scheduler_ != nullptr) {
+      scheduler_->release(mask_);
+    }
+  }
+};
+} // namespace
+
 EventId RuntimeImp::doKernelLaunch(StreamId streamId, KernelId kernelId, const std::byte* kernel_args,
                                    size_t kernel_args_size, const KernelLaunchOptionsImp& options) {
-  SpinLock lock(mutex_);
+  flushCoalescedMemcpys(streamId);
+  // copied while holding the lock, a concurrent unloadCode can destroy the kernel afterwards
+  SpinLock kernelsLock(mutex_);
   const auto& kernel = find(kernels_, kernelId)->second;
-  auto cfg = deviceLayer_->getDeviceConfig(static_cast<int>(kernel->deviceId_));
+  auto kernelDevice = kernel->deviceId_;
+  auto kernelEntryAddress = kernel->getEntryAddress();
+  kernelsLock.unlock();
+  auto cfg = deviceLayer_->getDeviceConfig(static_cast<int>(kernelDevice));
   auto validMask = cfg.computeMinionShireMask_;
-  if (~validMask & options.shireMask_ || !(validMask & options.shireMask_)) {
+  if (options.shirePartition_ != 0) {
+    validMask &= options.shirePartition_;
+  }
+  auto shireMask = options.shireMask_;
+  // chosen before taking the device mutex, the scheduler can wait for other kernels to complete
+  ScheduledShires scheduled;
+  // the report would belong to the graph launch, not to this kernel
+  if (options.powerReport_ && isCapturing(streamId)) {
+    throw Exception("Kernel launches with a power report can't be captured");
+  }
+  if (options.shireCount_ > 0) {
+    if (options.shireCount_ > __builtin_popcountll(validMask)) {
+      throw Exception("Shire count is invalid, the device has " + std::to_string(__builtin_popcountll(validMask)) +
+                      " shires");
+    }
+    // the shires would only be held by the graph launch, which doesn't know about them
+    if (isCapturing(streamId)) {
+      throw Exception("Kernel launches with a shire count can't be captured");
+    }
+    scheduled.scheduler_ = find(shireSchedulers_, kernelDevice)->second.get();
+    scheduled.mask_ = scheduled.scheduler_->acquire(validMask, options.shireCount_);
+    shireMask = scheduled.mask_;
+  }
+  SpinLock lock(getDeviceMutex(kernelDevice));
+  if (~validMask & shireMask || !(validMask & shireMask)) {
     std::stringstream ss;
     ss << "Shiremask is invalid. Valid selectable values for shire mask are: 0x" << std::hex << validMask;
     throw Exception(ss.str());
   }
+  if (checkMemcpyDeviceAddress_) {
+    for (const auto& [address, size] : options.flushRanges_) {
+      memoryManagers_.at(kernelDevice).checkOperation(reinterpret_cast<const std::byte*>(address), size);
+    }
+  }
+
+  if (options.shireArgsStride_ != 0 &&
+      kernel_args_size != static_cast<size_t>(__builtin_popcountll(shireMask)) * options.shireArgsStride_) {
+    throw Exception("Kernel args size has to be the shire args stride (" + std::to_string(options.shireArgsStride_) +
+                    ") times the number of shires (" + std::to_string(__builtin_popcountll(shireMask)) + ")");
+  }
 
   if (kernel_args_size > executionContextCache_->getBufferSize()) {
     throw Exception("Maximum kernel arg size is " + std::to_string(executionContextCache_->getBufferSize()));
@@ -44,7 +147,7 @@ EventId RuntimeImp::doKernelLaunch(StreamId streamId, KernelId kernelId, const s
   }
 
   constexpr auto ETSOC_THREADS_PER_SHIRE = 64;
-  auto activeThreads = (size_t)__builtin_popcountll(options.shireMask_) * ETSOC_THREADS_PER_SHIRE;
+  auto activeThreads = (size_t)__builtin_popcountll(shireMask) * ETSOC_THREADS_PER_SHIRE;
   if (options.stackConfig_ && (options.stackConfig_->totalSize_ / activeThreads) < SIZE_4K) {
     std::stringstream ss;
     ss << "Stack size is too small, at least 4096 bytes per active thread (" << activeThreads << ") are needed";
@@ -64,11 +167,13 @@ EventId RuntimeImp::doKernelLaunch(StreamId streamId, KernelId kernelId, const s
 
   auto streamInfo = streamManager_.getStreamInfo(streamId);
 
-  if (DeviceId{streamInfo.device_} != kernel->deviceId_) {
+  if (DeviceId{streamInfo.device_} != kernelDevice) {
     throw Exception("Can't execute stream and kernel associated to a different device");
   }
 
   bool kernelArgsFit = kernel_args_size <= maxSizeKernelEmbeddingParameters;
+  // when capturing, the args which don't fit are uploaded to the graph args buffer once the capture ends
+  auto capturing = isCapturing(streamId);
   auto optionalArgSize = kernelArgsFit ? kernel_args_size : 0;
   if (options.userTraceConfig_) {
     optionalArgSize += sizeof(UserTrace);
@@ -77,13 +182,11 @@ EventId RuntimeImp::doKernelLaunch(StreamId streamId, KernelId kernelId, const s
     optionalArgSize += sizeof(StackConfiguration);
   }
 
-  std::vector<std::byte> cmdBase(sizeof(device_ops_api::device_ops_kernel_launch_cmd_t) + optionalArgSize);
-
-  memset(cmdBase.data(), 0, sizeof(cmdBase));
+  CommandData cmdBase(sizeof(device_ops_api::device_ops_kernel_launch_cmd_t) + optionalArgSize);
 
   auto cmdPtr = reinterpret_cast<device_ops_api::device_ops_kernel_launch_cmd_t*>(cmdBase.data());
 
-  auto pBuffer = executionContextCache_->allocBuffer(kernel->deviceId_);
+  auto pBuffer = capturing ? nullptr : executionContextCache_->allocBuffer(kernelDevice);
   auto pPayload = reinterpret_cast<std::byte*>(cmdPtr->argument_payload);
   if (options.userTraceConfig_) {
     memcpy(pPayload, &*options.userTraceConfig_, sizeof(UserTrace));
@@ -92,7 +195,7 @@ EventId RuntimeImp::doKernelLaunch(StreamId streamId, KernelId kernelId, const s
   if (options.stackConfig_) {
     device_ops_api::kernel_user_stack_cfg_t stackCfg;
 
-    auto memManager = memoryManagers_.at(kernel->deviceId_);
+    const auto& memManager = memoryManagers_.at(kernelDevice);
     auto rawStackBase = reinterpret_cast<std::byte*>(options.stackConfig_->baseAddress_);
     stackCfg.stack_base_offset = memManager.compressPointer(rawStackBase, std::log2(SIZE_4K));
     stackCfg.stack_size = static_cast<uint32_t>(options.stackConfig_->totalSize_ / SIZE_4K);
@@ -102,21 +205,14 @@ EventId RuntimeImp::doKernelLaunch(StreamId streamId, KernelId kernelId, const s
   }
   if (kernelArgsFit) {
     std::copy(kernel_args, kernel_args + kernel_args_size, pPayload);
-  } else {
+  } else if (!capturing) {
     // we must wait for parameters, but we will use kenelArgsFit instead of modified barrier user option.
     // stage parameters in host buffer
     std::copy(kernel_args, kernel_args + kernel_args_size, begin(pBuffer->hostBuffer_));
     doMemcpyHostToDevice(streamId, pBuffer->hostBuffer_.data(), pBuffer->getParametersPtr(), kernel_args_size, false,
                          defaultCmaCopyFunction);
   }
-  auto event = eventManager_.getNextId();
-  streamManager_.addEvent(streamId, event);
-  executionContextCache_->reserveBuffer(event, pBuffer);
-  if (!options.coreDumpFilePath_.empty()) {
-    coreDumper_.addKernelExecution(options.coreDumpFilePath_, kernelId, event);
-  }
 
-  cmdPtr->command_info.cmd_hdr.tag_id = static_cast<uint16_t>(event);
   cmdPtr->command_info.cmd_hdr.msg_id = device_ops_api::DEV_OPS_API_MID_DEVICE_OPS_KERNEL_LAUNCH_CMD;
   cmdPtr->command_info.cmd_hdr.size = sizeof(device_ops_api::device_ops_kernel_launch_cmd_t);
   if (optionalArgSize > 0) {
@@ -124,7 +220,7 @@ EventId RuntimeImp::doKernelLaunch(StreamId streamId, KernelId kernelId, const s
     cmdPtr->command_info.cmd_hdr.size = static_cast<device_ops_api::msg_size_t>(size);
   }
   cmdPtr->command_info.cmd_hdr.flags = 0;
-  if (!kernelArgsFit || options.barrier_) {
+  if ((!kernelArgsFit && !capturing) || options.barrier_) {
     cmdPtr->command_info.cmd_hdr.flags |= device_ops_api::CMD_FLAGS_BARRIER_ENABLE;
   }
   if (options.flushL3_) {
@@ -141,17 +237,249 @@ EventId RuntimeImp::doKernelLaunch(StreamId streamId, KernelId kernelId, const s
     cmdPtr->command_info.cmd_hdr.flags |= device_ops_api::CMD_FLAGS_KERNEL_LAUNCH_USER_STACK_CFG;
   }
 
+  cmdPtr->code_start_address = kernelEntryAddress;
+  cmdPtr->shire_mask = shireMask;
+
+  // the MM keeps the flush ranges for the next kernel launched from the same SQ, so they go right before the launch
+  if (!options.flushRanges_.empty()) {
+    sendDeviceMemoryCommand(streamId, makeKernelFlushRangesCommand(options.flushRanges_), 1);
+  }
+  if (options.shireArgsStride_ != 0) {
+    sendDeviceMemoryCommand(streamId, makeKernelShireArgsCommand(options.shireArgsStride_), 1);
+  }
+  if (options.watchdogTimeout_ != 0) {
+    sendDeviceMemoryCommand(streamId, makeKernelWatchdogCommand(options.watchdogTimeout_), 1);
+  }
+  uint32_t launchConfigFlags = 0;
+  if (options.noTensorOps_) {
+    launchConfigFlags |= device_ops_ext::KERNEL_LAUNCH_CONFIG_FLAGS_NO_TENSOR_OPS;
+  }
+  if (options.l2Sets_ != 0) {
+    launchConfigFlags |= device_ops_ext::KERNEL_LAUNCH_CONFIG_FLAGS_SHIRE_CACHE_CONFIG;
+  }
+  if (options.launchPrefetch_) {
+    launchConfigFlags |= device_ops_ext::KERNEL_LAUNCH_CONFIG_FLAGS_PREFETCH;
+  }
+  if (options.reportAndContinue_) {
+    launchConfigFlags |= device_ops_ext::KERNEL_LAUNCH_CONFIG_FLAGS_REPORT_AND_CONTINUE;
+  }
+  if (launchConfigFlags != 0) {
+    sendDeviceMemoryCommand(
+      streamId, makeKernelLaunchConfigCommand(launchConfigFlags, options.scpSets_, options.l2Sets_), 1);
+  }
+
+  if (capturing) {
+    RT_VLOG(LOW) << "Capturing kernel launch on stream: " << static_cast<int>(streamId) << std::hex << ", PC: 0x"
+                 << cmdPtr->code_start_address << ", shireMask: 0x" << shireMask;
+    GraphNode node;
+    node.isKernelLaunch_ = true;
+    node.kernel_ = kernelId;
+    node.coreDumpFilePath_ = options.coreDumpFilePath_;
+    if (!kernelArgsFit) {
+      node.args_.assign(kernel_args, kernel_args + kernel_args_size);
+    } else {
+      node.embeddedArgsOffset_ = static_cast<size_t>(pPayload - cmdBase.data());
+      node.embeddedArgsSize_ = kernel_args_size;
+    }
+    node.command_ = std::move(cmdBase);
+    return captureCommands(streamId, {std::move(node)});
+  }
+
+  auto event = eventManager_.getNextId();
+  streamManager_.addEvent(streamId, event);
+  executionContextCache_->reserveBuffer(event, pBuffer);
+  if (scheduled.scheduler_ != nullptr) {
+    scheduled.scheduler_->assign(event, scheduled.mask_);
+    scheduled.scheduler_ = nullptr;
+  }
+  if (!options.coreDumpFilePath_.empty()) {
+    coreDumper_.addKernelExecution(options.coreDumpFilePath_, kernelId, event);
+  }
+
+  cmdPtr->command_info.cmd_hdr.tag_id = static_cast<uint16_t>(event);
   cmdPtr->exception_buffer = reinterpret_cast<uint64_t>(pBuffer->getExceptionContextPtr());
-  cmdPtr->code_start_address = kernel->getEntryAddress();
   cmdPtr->pointer_to_args = reinterpret_cast<uint64_t>(pBuffer->getParametersPtr());
-  cmdPtr->shire_mask = options.shireMask_;
 
   RT_VLOG(LOW) << "Pushing kernel Launch Command on SQ: " << streamInfo.vq_
                << " EventId: " << cmdPtr->command_info.cmd_hdr.tag_id << std::hex << ", parameters: 0x"
                << cmdPtr->pointer_to_args << ", PC: 0x" << cmdPtr->code_start_address << ", shireMask: 0x"
-               << options.shireMask_;
+               << shireMask;
+  auto& commandSender = find(commandSenders_, getCommandSenderIdx(streamInfo.device_, streamInfo.vq_))->second;
+  {
+    // a previous launch with the same event id may have left its power state
+    std::lock_guard powerLock(powerStatesMutex_);
+    powerStates_.erase(event);
+  }
+  commandSender.send(Command{std::move(cmdBase), commandSender, event, event, streamId, false, true});
+  if (options.powerReport_) {
+    sendKernelPowerReport(streamId, event);
+  }
+
+  Sync(event);
+  return event;
+}
+
+void RuntimeImp::sendKernelPowerReport(StreamId stream, EventId kernelEvent) {
+  auto streamInfo = streamManager_.getStreamInfo(stream);
+  CommandData data(sizeof(device_ops_ext::device_ops_kernel_power_report_cmd_t));
+  auto cmd = reinterpret_cast<device_ops_ext::device_ops_kernel_power_report_cmd_t*>(data.data());
+  memset(cmd, 0, sizeof(*cmd));
+  cmd->command_info.cmd_hdr.msg_id = device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_KERNEL_POWER_REPORT_CMD;
+  cmd->command_info.cmd_hdr.size = static_cast<device_ops_api::msg_size_t>(sizeof(*cmd));
+  // the barrier makes the device wait for the kernel to complete
+  cmd->command_info.cmd_hdr.flags = device_ops_api::CMD_FLAGS_BARRIER_ENABLE;
+  cmd->kernel_launch_tag_id = static_cast<uint16_t>(kernelEvent);
+
+  auto evt = eventManager_.getNextId();
+  streamManager_.addEvent(stream, evt);
+  {
+    std::lock_guard lock(powerStatesMutex_);
+    pendingPowerReports_[evt] = kernelEvent;
+  }
+  cmd->command_info.cmd_hdr.tag_id = static_cast<uint16_t>(evt);
+  RT_VLOG(LOW) << "Pushing kernel power report on SQ: " << streamInfo.vq_ << " EventId: " << static_cast<int>(evt)
+               << " Kernel EventId: " << static_cast<int>(kernelEvent);
+  auto& commandSender = find(commandSenders_, getCommandSenderIdx(streamInfo.device_, streamInfo.vq_))->second;
+  commandSender.send(Command{std::move(data), commandSender, evt, evt, stream, false, true});
+}
+
+void RuntimeImp::onKernelPowerReport(DeviceId device, EventId reportEvent,
+                                     const device_ops_ext::device_ops_kernel_power_report_rsp_t& report) {
+  std::unique_lock lock(powerStatesMutex_);
+  auto it = pendingPowerReports_.find(reportEvent);
+  if (it == end(pendingPowerReports_)) {
+    RT_LOG(WARNING) << "Unexpected kernel power report. Tag id: " << static_cast<int>(reportEvent);
+    return;
+  }
+  auto kernelEvent = it->second;
+  pendingPowerReports_.erase(it);
+  if (report.status != device_ops_ext::KERNEL_POWER_REPORT_RESPONSE_SUCCESS) {
+    RT_LOG(WARNING) << "No power report of kernel EventId: " << static_cast<int>(kernelEvent)
+                    << ". Status: " << report.status;
+    return;
+  }
+  KernelPowerState state{device, report.start_freq_mhz, report.end_freq_mhz, report.throttle_events};
+  powerStates_[kernelEvent] = state;
+  auto policy = shireBudgetPolicy_;
+  lock.unlock();
+
+  if (state.wasThrottled()) {
+    RT_VLOG(LOW) << "Kernel EventId: " << static_cast<int>(kernelEvent) << " throttled " << state.throttleEvents_
+                 << " times, frequency " << state.startFrequencyMhz_ << " -> " << state.endFrequencyMhz_ << " MHz";
+  }
+  if (policy) {
+    auto& scheduler = *find(shireSchedulers_, device)->second;
+    auto current = scheduler.getBudget();
+    auto budget = policy(state, current);
+    if (budget != current) {
+      RT_LOG(INFO) << "Shire budget of device " << static_cast<int>(device) << " set to " << budget
+                   << " by the policy";
+      scheduler.setBudget(budget);
+    }
+  }
+}
+
+std::optional<KernelPowerState> RuntimeImp::doGetEventPowerState(EventId event) {
+  std::lock_guard lock(powerStatesMutex_);
+  if (auto it = powerStates_.find(event); it != end(powerStates_)) {
+    return it->second;
+  }
+  return std::nullopt;
+}
+
+void RuntimeImp::doSetShireBudget(DeviceId device, int maxActiveShires) {
+  find(shireSchedulers_, device, "Invalid device")->second->setBudget(maxActiveShires);
+  RT_VLOG(LOW) << "Shire budget of device " << static_cast<int>(device) << " set to " << maxActiveShires;
+}
+
+int RuntimeImp::doGetShireBudget(DeviceId device) const {
+  return find(shireSchedulers_, device, "Invalid device")->second->getBudget();
+}
+
+void RuntimeImp::doSetShireBudgetPolicy(ShireBudgetPolicy policy) {
+  std::lock_guard lock(powerStatesMutex_);
+  shireBudgetPolicy_ = std::move(policy);
+}
+
+EventId RuntimeImp::doKernelLaunchSigned(StreamId streamId, KernelId kernelId, uint64_t signature,
+                                         const std::byte* kernel_args, size_t kernel_args_size,
+                                         const KernelLaunchOptionsImp& options) {
+  SpinLock kernelsLock(mutex_);
+  auto expected = find(kernels_, kernelId)->second->signature_;
+  kernelsLock.unlock();
+  if (!expected) {
+    RT_VLOG(LOW) << "Kernel " << static_cast<int>(kernelId) << " has no signature, its arguments are not checked";
+  } else if (*expected != signature) {
+    std::stringstream ss;
+    ss << "Arguments of kernel " << static_cast<int>(kernelId) << " don't match its signature. Expected signature: 0x"
+       << std::hex << *expected << " got: 0x" << signature;
+    throw Exception(ss.str());
+  }
+  return doKernelLaunch(streamId, kernelId, kernel_args, kernel_args_size, options);
+}
+
+EventId RuntimeImp::doKernelLaunchMulti(StreamId streamId, const std::vector<LaunchDesc>& launches, bool barrier) {
+  if (launches.empty() || launches.size() > device_ops_ext::kKernelMultiLaunchMax) {
+    throw Exception("A kernel multi-launch needs from 1 to " + std::to_string(device_ops_ext::kKernelMultiLaunchMax) +
+                    " kernels");
+  }
+  // the exception buffer is reserved for the event, which only exists once the capture is launched
+  if (isCapturing(streamId)) {
+    throw Exception("Kernel multi-launches can't be captured");
+  }
+  flushCoalescedMemcpys(streamId);
+  auto streamInfo = streamManager_.getStreamInfo(streamId);
+  auto device = DeviceId{streamInfo.device_};
+
+  CommandData cmdBase(sizeof(device_ops_ext::device_ops_kernel_multi_launch_cmd_t));
+  auto cmd = reinterpret_cast<device_ops_ext::device_ops_kernel_multi_launch_cmd_t*>(cmdBase.data());
+  memset(cmd, 0, sizeof(*cmd));
+  SpinLock kernelsLock(mutex_);
+  for (size_t i = 0; i < launches.size(); ++i) {
+    const auto& kernel = find(kernels_, launches[i].kernel_)->second;
+    if (kernel->deviceId_ != device) {
+      throw Exception("Can't execute stream and kernel associated to a different device");
+    }
+    cmd->entries[i].code_start_address = kernel->getEntryAddress();
+    cmd->entries[i].pointer_to_args = reinterpret_cast<uint64_t>(launches[i].args_);
+    cmd->entries[i].shire_mask = launches[i].shireMask_;
+  }
+  kernelsLock.unlock();
+
+  SpinLock lock(getDeviceMutex(device));
+  auto validMask = deviceLayer_->getDeviceConfig(static_cast<int>(device)).computeMinionShireMask_;
+  uint64_t usedMask = 0;
+  for (const auto& launch : launches) {
+    if (~validMask & launch.shireMask_ || !(validMask & launch.shireMask_)) {
+      std::stringstream ss;
+      ss << "Shiremask is invalid. Valid selectable values for shire mask are: 0x" << std::hex << validMask;
+      throw Exception(ss.str());
+    }
+    if (usedMask & launch.shireMask_) {
+      throw Exception("The kernels of a multi-launch must have disjoint shire masks");
+    }
+    usedMask |= launch.shireMask_;
+  }
+
+  cmd->command_info.cmd_hdr.msg_id = device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_KERNEL_MULTI_LAUNCH_CMD;
+  cmd->command_info.cmd_hdr.size = static_cast<device_ops_api::msg_size_t>(sizeof(*cmd));
+  cmd->command_info.cmd_hdr.flags = barrier ? device_ops_api::CMD_FLAGS_BARRIER_ENABLE : 0;
+  cmd->count = static_cast<uint32_t>(launches.size());
+
+  // the kernels run on disjoint shires, so they can share the exception buffer, which is indexed by hart
+  auto pBuffer = executionContextCache_->allocBuffer(device);
+  auto event = eventManager_.getNextId();
+  streamManager_.addEvent(streamId, event);
+  executionContextCache_->reserveBuffer(event, pBuffer);
+
+  cmd->command_info.cmd_hdr.tag_id = static_cast<uint16_t>(event);
+  cmd->exception_buffer = reinterpret_cast<uint64_t>(pBuffer->getExceptionContextPtr());
+
+  RT_VLOG(LOW) << "Pushing kernel multi-launch Command on SQ: " << streamInfo.vq_
+               << " EventId: " << static_cast<int>(event) << " Kernels: " << launches.size() << std::hex
+               << ", shireMask: 0x" << usedMask;
   auto& commandSender = find(commandSenders_, getCommandSenderIdx(streamInfo.device_, streamInfo.vq_))->second;
-  commandSender.send(Command{cmdBase, commandSender, event, event, streamId, false, true});
+  commandSender.send(Command{std::move(cmdBase), commandSender, event, event, streamId, false, true});
 
   Sync(event);
   return event;
@@ -3,8 +3,10 @@
  * SPDX-License-Identifier: Apache-2.0
  *-------------------------------------------------------------------------*/
 
+#include <limits>
 #include <memory>
 #include <optional>
+#include <string>
 
 #include "KernelLaunchOptionsImp.h"
 #include "runtime/Types.h"
@@ -21,11 +23,30 @@ KernelLaunchOptions::KernelLaunchOptions(const rt::KernelLaunchOptionsImp& kOptI
   imp_ = std::make_unique<KernelLaunchOptionsImp>(kOptImp);
 }
 
+KernelLaunchOptions::KernelLaunchOptions(const KernelLaunchOptions& other) {
+  *this = other;
+}
+
+KernelLaunchOptions& KernelLaunchOptions::operator=(const KernelLaunchOptions& other) {
+  if (this != &other) {
+    imp_ = other.imp_ ? std::make_unique<KernelLaunchOptionsImp>(*other.imp_) : nullptr;
+  }
+  return *this;
+}
+
 void KernelLaunchOptions::setShireMask(uint64_t shireMask) {
   setIfImpIsNull();
   imp_->shireMask_ = shireMask;
 }
 
+void KernelLaunchOptions::setShireCount(int shireCount) {
+  if (shireCount < 0) {
+    throw Exception("Shire count can't be negative");
+  }
+  setIfImpIsNull();
+  imp_->shireCount_ = shireCount;
+}
+
 void KernelLaunchOptions::setBarrier(bool barrier) {
   setIfImpIsNull();
   imp_->barrier_ = barrier;
@@ -56,6 +77,70 @@ void KernelLaunchOptions::setStackConfig(std::byte* baseAddress, uint64_t totalS
   imp_->stackConfig_ = StackConfiguration{rawAddr, totalSize};
 }
 
+void KernelLaunchOptions::setFlushRanges(const std::vector<std::pair<const std::byte*, size_t>>& ranges) {
+  if (ranges.size() > kMaxFlushRanges) {
+    throw Exception("Too many flush ranges, the maximum is " + std::to_string(kMaxFlushRanges));
+  }
+  std::vector<std::pair<uint64_t, uint64_t>> flushRanges;
+  for (const auto& [address, size] : ranges) {
+    if (size == 0) {
+      throw Exception("Flush ranges can't be empty");
+    }
+    flushRanges.emplace_back(reinterpret_cast<uint64_t>(address), size);
+  }
+
+  setIfImpIsNull();
+  imp_->flushRanges_ = std::move(flushRanges);
+}
+
+void KernelLaunchOptions::setShireArgsStride(uint32_t stride) {
+  if (stride % 8 != 0) {
+    throw Exception("Shire args stride has to be a multiple of 8 bytes");
+  }
+  setIfImpIsNull();
+  imp_->shireArgsStride_ = stride;
+}
+
+void KernelLaunchOptions::setWatchdogTimeout(std::chrono::seconds timeout) {
+  if (timeout.count() < 0 || timeout.count() > std::numeric_limits<uint32_t>::max()) {
+    throw Exception("Invalid watchdog timeout of " + std::to_string(timeout.count()) + " seconds");
+  }
+  setIfImpIsNull();
+  imp_->watchdogTimeout_ = static_cast<uint32_t>(timeout.count());
+}
+
+void KernelLaunchOptions::setPowerReport(bool enabled) {
+  setIfImpIsNull();
+  imp_->powerReport_ = enabled;
+}
+
+void KernelLaunchOptions::setNoTensorOps(bool noTensorOps) {
+  setIfImpIsNull();
+  imp_->noTensorOps_ = noTensorOps;
+}
+
+void KernelLaunchOptions::setLaunchPrefetch(bool enabled) {
+  setIfImpIsNull();
+  imp_->launchPrefetch_ = enabled;
+}
+
+void KernelLaunchOptions::setReportAndContinue(bool enabled) {
+  setIfImpIsNull();
+  imp_->reportAndContinue_ = enabled;
+}
+
+void KernelLaunchOptions::setShireCacheConfig(uint16_t scpSets, uint16_t l2Sets) {
+  // (0, 0) clears it
+  auto isDefault = scpSets == 0 && l2Sets == 0;
+  if (!isDefault && (scpSets % 2 != 0 || l2Sets % 2 != 0 || l2Sets < 64)) {
+    throw Exception("Invalid shire cache config of " + std::to_string(scpSets) + " SCP sets and " +
+                    std::to_string(l2Sets) + " L2 sets");
+  }
+  setIfImpIsNull();
+  imp_->scpSets_ = scpSets;
+  imp_->l2Sets_ = l2Sets;
+}
+
 void KernelLaunchOptions::setCoreDumpFilePath(const std::string& coreDumpFilePath) {
   setIfImpIsNull();
   imp_->coreDumpFilePath_ = coreDumpFilePath;
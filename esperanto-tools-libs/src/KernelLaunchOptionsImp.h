@@ -9,12 +9,16 @@
 #include <cstdint>
 #include <optional>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "runtime/Types.h"
 
 #include <cereal/cereal.hpp>
 #include <cereal/types/optional.hpp>
 #include <cereal/types/string.hpp>
+#include <cereal/types/utility.hpp>
+#include <cereal/types/vector.hpp>
 
 namespace rt {
 
@@ -31,14 +35,38 @@ struct StackConfiguration {
 
 struct KernelLaunchOptionsImp {
   uint64_t shireMask_ = 0xFFFFFFFFUL;
+  // when not 0, the runtime chooses the shire mask with this number of shires instead of using shireMask_
+  int shireCount_ = 0;
   bool barrier_ = true;
   bool flushL3_ = false;
   std::optional<UserTrace> userTraceConfig_;
   std::string coreDumpFilePath_;
   std::optional<StackConfiguration> stackConfig_;
+  // (device address, size) of the buffers flushed to memory at the kernel completion
+  std::vector<std::pair<uint64_t, uint64_t>> flushRanges_;
+  // when not 0, the arguments have a slice of this size per shire of the mask
+  uint32_t shireArgsStride_ = 0;
+  // when not 0, seconds the kernel may run before the device aborts its shires
+  uint32_t watchdogTimeout_ = 0;
+  // the kernel is followed by a report of the device power state while it ran
+  bool powerReport_ = false;
+  // the kernel doesn't use tensor instructions, so the tensor state reset before the next kernel can be skipped
+  bool noTensorOps_ = false;
+  // when l2Sets_ is not 0, SCP and L2 sets per shire cache bank the kernel shires are repartitioned with
+  uint16_t scpSets_ = 0;
+  uint16_t l2Sets_ = 0;
+  // the device prefetches the kernel code and arguments before the launch
+  bool launchPrefetch_ = false;
+  // the device reports the recoverable errors of the kernel instead of failing the launch
+  bool reportAndContinue_ = false;
+  // when not 0, the only shires the kernel can run on (shireMask_ must be among them and shireCount_ shires are chosen
+  // from them). Set by the server from the client partition, so it's not serialized
+  uint64_t shirePartition_ = 0;
 
   template <class Archive> void serialize(Archive& archive) {
-    archive(shireMask_, barrier_, flushL3_, userTraceConfig_, coreDumpFilePath_, stackConfig_);
+    archive(shireMask_, shireCount_, barrier_, flushL3_, userTraceConfig_, coreDumpFilePath_, stackConfig_, flushRanges_,
+            shireArgsStride_, watchdogTimeout_, powerReport_, noTensorOps_, scpSets_,
+            l2Sets_, launchPrefetch_, reportAndContinue_);
   }
 };
 
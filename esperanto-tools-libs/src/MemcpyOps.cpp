@@ -5,10 +5,14 @@
 
 #include "MemcpyOps.h"
 #include "CommandSender.h"
+#include "Constants.h"
+#include "KernelLaunchOptionsImp.h"
 #include "RuntimeImp.h"
 #include "ScopedProfileEvent.h"
 #include "Utils.h"
+#include "dma/CmaConversion.h"
 #include "dma/CmaManager.h"
+#include "dma/MemcpyChainAction.h"
 #include "dma/MemcpyContext.h"
 #include "dma/MemcpyD2HAction.h"
 #include "dma/MemcpyH2DAction.h"
@@ -16,17 +20,25 @@
 #include "dma/MemcpyListH2DAction.h"
 #include "runtime/Types.h"
 #include <algorithm>
+#include <atomic>
+#include <cerrno>
 #include <chrono>
+#include <cmath>
+#include <cstring>
 #include <esperanto/device-apis/device_apis_message_types.h>
 #include <esperanto/device-apis/operations-api/device_ops_api_cxx.h>
 #include <esperanto/device-apis/operations-api/device_ops_api_rpc_types.h>
 #include <g3log/loglevels.hpp>
 #include <iterator>
+#include <limits>
+#include <memory>
 #include <mutex>
 #include <numeric>
 #include <optional>
+#include <sys/mman.h>
 #include <thread>
 #include <type_traits>
+#include <unistd.h>
 using namespace rt::profiling;
 using namespace device_ops_api;
 static_assert(sizeof(device_ops_dma_readlist_cmd_t) == sizeof(device_ops_dma_writelist_cmd_t));
@@ -38,6 +50,76 @@ static_assert(offsetof(dma_write_node, size) == offsetof(dma_read_node, size));
 
 namespace rt {
 
+namespace {
+// memcpys bigger than this are not worth coalescing, their own DMA command overhead is negligible
+constexpr size_t kMaxCoalescedMemcpySize = 64 * 1024;
+// smaller ops of a staged list share their cma copy task
+constexpr size_t kMinStagedCopySize = 64 * 1024;
+
+// one chunk of the args of the lz4_decompress kernel, they follow the chunk count
+struct DecompressChunk {
+  uint64_t src_;
+  uint64_t srcSize_;
+  uint64_t dst_;
+  uint64_t dstSize_;
+};
+// compressed bytes transferred per batch, and chunks per batch so the kernel args fit in a block
+constexpr size_t kMaxCompressedBatchSize = 32UL * 1024 * 1024;
+constexpr size_t kMaxCompressedBatchChunks = (kBlockSize - sizeof(uint64_t)) / sizeof(DecompressChunk);
+
+// args of the crc32_check kernel, it writes the CRC32 of each chunk to crcs_
+struct ChecksumArgs {
+  uint64_t data_;
+  uint64_t size_;
+  uint64_t chunkSize_;
+  uint64_t chunkCount_;
+  uint64_t crcs_;
+};
+// bytes checked by a hart of the kernel, and bytes the staging copy of a checked memcpy copies before computing their
+// CRC, so they are still in the host caches
+constexpr size_t kChecksumChunkSize = 1024UL * 1024;
+constexpr size_t kChecksumCopyStep = 256UL * 1024;
+
+// host side of a checked memcpy, see doMemcpyHostToDeviceChecked
+struct ChecksumState {
+  // CRC32 of a range of the source computed by the staging copy, ranges don't cross a chunk boundary
+  struct Piece {
+    size_t offset_;
+    size_t size_;
+    uint32_t crc_;
+  };
+  const std::byte* src_;
+  size_t size_;
+  std::mutex mutex_;
+  std::vector<Piece> pieces_;
+  // copied back from the device once the kernel is done
+  std::vector<uint32_t> deviceCrcs_;
+
+  // the CRCs of the chunks, combined from the pieces tiling each one. Chunks which were not staged (ie. the source is a
+  // registered host buffer, DMAed in place) are computed from the source
+  std::vector<uint32_t> getHostCrcs() {
+    std::lock_guard lock(mutex_);
+    std::sort(begin(pieces_), end(pieces_), [](const auto& a, const auto& b) { return a.offset_ < b.offset_; });
+    std::vector<uint32_t> crcs(deviceCrcs_.size());
+    auto piece = begin(pieces_);
+    for (auto i = 0UL; i < crcs.size(); ++i) {
+      auto offset = i * kChecksumChunkSize;
+      auto chunkEnd = std::min(offset + kChecksumChunkSize, size_);
+      for (; piece != end(pieces_) && piece->offset_ < offset; ++piece) {
+      }
+      auto pos = offset;
+      auto crc = 0U;
+      for (; piece != end(pieces_) && piece->offset_ == pos && pos < chunkEnd; ++piece) {
+        crc = crc32Combine(crc, piece->crc_, piece->size_);
+        pos += piece->size_;
+      }
+      crcs[i] = pos == chunkEnd ? crc : crc32(src_ + offset, chunkEnd - offset);
+    }
+    return crcs;
+  }
+};
+} // namespace
+
 void MemcpyCommandBuilder::addOp(const std::byte* hostAddr, const std::byte* deviceAddr, size_t size) {
   if (numEntries_ >= maxEntries_) {
     throw Exception("Can't add new op. Maximum number of operations is: " + std::to_string(maxEntries_));
@@ -53,6 +135,26 @@ void MemcpyCommandBuilder::addOp(const std::byte* hostAddr, const std::byte* dev
   std::copy(ptr, ptr + sizeof(newNode), std::back_insert_iterator(data_));
 }
 
+size_t MemcpyCommandBuilder::extendLastOp(const std::byte* hostAddr, const std::byte* deviceAddr, size_t size,
+                                          size_t maxSize) {
+  if (numEntries_ == 0) {
+    return 0;
+  }
+  // read and write nodes share the layout
+  auto nodePtr = data_.data() + data_.size() - sizeof(dma_write_node);
+  dma_write_node node;
+  std::memcpy(&node, nodePtr, sizeof(node));
+  if (node.src_host_virt_addr + node.size != reinterpret_cast<uint64_t>(hostAddr) ||
+      node.dst_device_phy_addr + node.size != reinterpret_cast<uint64_t>(deviceAddr)) {
+    return 0;
+  }
+  auto limit = std::min<size_t>(maxSize, std::numeric_limits<uint32_t>::max());
+  auto extended = node.size < limit ? std::min(size, limit - node.size) : 0UL;
+  node.size = static_cast<uint32_t>(node.size + extended);
+  std::memcpy(nodePtr, &node, sizeof(node));
+  return extended;
+}
+
 void MemcpyCommandBuilder::setTagId(rt::EventId eventId) {
   static_assert(sizeof(std::underlying_type_t<EventId>) == sizeof(tag_id_t));
   auto cmdPtr = reinterpret_cast<device_ops_dma_readlist_cmd_t*>(data_.data());
@@ -82,21 +184,156 @@ void MemcpyCommandBuilder::clear() {
   data_.resize(offsetof(device_ops_dma_readlist_cmd_t, list));
 }
 
+std::vector<MemcpyCommandBuilder> buildStagedListCommands(MemcpyType type, const MemcpyList& list,
+                                                          const std::byte* cmaPtr, bool barrier,
+                                                          const dev::DmaInfo& dmaInfo) {
+  auto maxEntries = static_cast<uint32_t>(dmaInfo.maxElementCount_);
+  std::vector<MemcpyCommandBuilder> builders;
+  auto processed = 0UL;
+  for (const auto& op : list.operations_) {
+    auto deviceAddr = type == MemcpyType::H2D ? op.dst_ : op.src_;
+    for (auto offset = 0UL; offset < op.size_;) {
+      auto remaining = op.size_ - offset;
+      auto hostAddr = cmaPtr + processed + offset;
+      auto extended = builders.empty() ? 0UL
+                                       : builders.back().extendLastOp(hostAddr, deviceAddr + offset, remaining,
+                                                                      dmaInfo.maxElementSize_);
+      if (extended > 0) {
+        offset += extended;
+        continue;
+      }
+      if (builders.empty() || builders.back().numEntries_ == maxEntries) {
+        builders.emplace_back(type, barrier, maxEntries);
+      }
+      auto size = std::min(remaining, dmaInfo.maxElementSize_);
+      builders.back().addOp(hostAddr, deviceAddr + offset, size);
+      offset += size;
+    }
+    processed += op.size_;
+  }
+  if (builders.empty()) {
+    builders.emplace_back(type, barrier, maxEntries);
+  }
+  return builders;
+}
+
+std::vector<StagedCopyRange> groupStagedCopies(const MemcpyList& list) {
+  std::vector<StagedCopyRange> ranges;
+  auto rangeSize = 0UL;
+  auto processed = 0UL;
+  for (auto i = 0UL; i < list.operations_.size(); ++i) {
+    if (ranges.empty() || rangeSize >= kMinStagedCopySize) {
+      ranges.push_back({i, 0, processed});
+      rangeSize = 0;
+    }
+    ranges.back().count_++;
+    rangeSize += list.operations_[i].size_;
+    processed += list.operations_[i].size_;
+  }
+  return ranges;
+}
+
+std::vector<device_ops_ext::dma_chain_elem_t> buildStagedChainElems(MemcpyType type, const MemcpyList& list,
+                                                                    const dev::DmaInfo& dmaInfo) {
+  std::vector<device_ops_ext::dma_chain_elem_t> elems;
+  auto maxSize = std::min<size_t>(dmaInfo.maxElementSize_, std::numeric_limits<uint32_t>::max());
+  auto processed = 0UL;
+  for (const auto& op : list.operations_) {
+    auto deviceAddr = reinterpret_cast<uint64_t>(type == MemcpyType::H2D ? op.dst_ : op.src_);
+    for (auto offset = 0UL; offset < op.size_;) {
+      auto remaining = op.size_ - offset;
+      auto hostOffset = processed + offset;
+      if (!elems.empty()) {
+        auto& last = elems.back();
+        auto lastHost = type == MemcpyType::H2D ? last.sar : last.dar;
+        auto lastDevice = type == MemcpyType::H2D ? last.dar : last.sar;
+        if (lastHost + last.size == hostOffset && lastDevice + last.size == deviceAddr + offset &&
+            last.size < maxSize) {
+          auto extended = std::min(remaining, maxSize - last.size);
+          last.size = static_cast<uint32_t>(last.size + extended);
+          offset += extended;
+          continue;
+        }
+      }
+      auto size = std::min(remaining, maxSize);
+      device_ops_ext::dma_chain_elem_t elem{};
+      elem.size = static_cast<uint32_t>(size);
+      elem.sar = type == MemcpyType::H2D ? hostOffset : deviceAddr + offset;
+      elem.dar = type == MemcpyType::H2D ? deviceAddr + offset : hostOffset;
+      elems.emplace_back(elem);
+      offset += size;
+    }
+    processed += op.size_;
+  }
+  return elems;
+}
+
+void MemcpyList::addStridedOp(std::byte* src, std::byte* dst, const MemcpyShape& shape) {
+  auto srcRowPitch = shape.srcRowPitch_ == 0 ? shape.rowSize_ : shape.srcRowPitch_;
+  auto dstRowPitch = shape.dstRowPitch_ == 0 ? shape.rowSize_ : shape.dstRowPitch_;
+  auto srcPlanePitch = shape.srcPlanePitch_ == 0 ? srcRowPitch * shape.rows_ : shape.srcPlanePitch_;
+  auto dstPlanePitch = shape.dstPlanePitch_ == 0 ? dstRowPitch * shape.rows_ : shape.dstPlanePitch_;
+  if (shape.rowSize_ == 0 || shape.rows_ == 0 || shape.planes_ == 0) {
+    throw Exception("Strided memcpys can't be empty");
+  }
+  if (srcRowPitch < shape.rowSize_ || dstRowPitch < shape.rowSize_ || srcPlanePitch < srcRowPitch * shape.rows_ ||
+      dstPlanePitch < dstRowPitch * shape.rows_) {
+    throw Exception("Strided memcpy pitches can't make rows overlap");
+  }
+  for (auto plane = 0UL; plane < shape.planes_; ++plane) {
+    for (auto row = 0UL; row < shape.rows_; ++row) {
+      auto rowSrc = src + plane * srcPlanePitch + row * srcRowPitch;
+      auto rowDst = dst + plane * dstPlanePitch + row * dstRowPitch;
+      if (!operations_.empty()) {
+        auto& last = operations_.back();
+        if (last.src_ + last.size_ == rowSrc && last.dst_ + last.size_ == rowDst) {
+          last.size_ += shape.rowSize_;
+          continue;
+        }
+      }
+      addOp(rowSrc, rowDst, shape.rowSize_);
+    }
+  }
+}
+
 EventId RuntimeImp::doMemcpyHostToDevice(StreamId stream, const std::byte* h_src, std::byte* d_dst, size_t size,
                                          bool barrier, const CmaCopyFunction& cmaCopyFunction) {
   auto streamInfo = streamManager_.getStreamInfo(stream);
-  SpinLock lock(mutex_);
+  SpinLock lock(getDeviceMutex(DeviceId{streamInfo.device_}));
   if (checkMemcpyDeviceAddress_) {
     auto& mm = memoryManagers_.at(DeviceId{streamInfo.device_});
     mm.checkOperation(d_dst, size);
   }
   auto& commandSender = find(commandSenders_, getCommandSenderIdx(streamInfo.device_, streamInfo.vq_))->second;
 
+  if (isCapturing(stream)) {
+    auto hostBuffer = findHostBuffer(DeviceId{streamInfo.device_}, MemcpyType::H2D, h_src, size);
+    auto ops = hostBuffer ? std::vector<ZeroCopyOp>{{h_src, d_dst, size}} : std::vector<ZeroCopyOp>{};
+    return captureCommands(stream, captureZeroCopyMemcpy(MemcpyType::H2D, DeviceId{streamInfo.device_}, ops,
+                                                         hostBuffer && hostBuffer->dmaContiguous_, barrier));
+  }
+  if (auto mappedEvt = tryMappedDramMemcpy(MemcpyType::H2D, stream, h_src, d_dst, size)) {
+    Sync(*mappedEvt);
+    return *mappedEvt;
+  }
+  if (auto coalescedEvt = tryCoalesceMemcpy(MemcpyType::H2D, stream, h_src, d_dst, size, barrier, cmaCopyFunction)) {
+    Sync(*coalescedEvt);
+    return *coalescedEvt;
+  }
+
   auto evt = eventManager_.getNextId();
   RT_VLOG(LOW) << "MemcpyHostToDevice stream: " << static_cast<int>(stream) << " EventId: " << static_cast<int>(evt)
                << std::hex << " Host address: " << h_src << " Device address: " << d_dst << " Size: " << size;
   streamManager_.addEvent(stream, evt);
 
+  if (auto hostBuffer = findHostBuffer(DeviceId{streamInfo.device_}, MemcpyType::H2D, h_src, size); hostBuffer) {
+    RT_VLOG(MID) << "H2D: host memory can be used directly, skipping CMA";
+    sendZeroCopyMemcpy(MemcpyType::H2D, commandSender, DeviceId{streamInfo.device_}, stream, evt,
+                       {{h_src, d_dst, size}}, hostBuffer->dmaContiguous_, barrier);
+    Sync(evt);
+    return evt;
+  }
+
   // start sending a "ghost" command which will be create the needed barrier in command sender until we have sent all
   // commands. This is needed because we don't know if we will have enough CMA memory to hold all commands with their
   // addresses and sizes in the queue or we will have to chunk them
@@ -123,16 +360,38 @@ EventId RuntimeImp::doMemcpyDeviceToHost(StreamId stream, const std::byte* d_src
                                          bool barrier, const CmaCopyFunction& cmaCopyFunction) {
   auto streamInfo = streamManager_.getStreamInfo(stream);
   auto& commandSender = find(commandSenders_, getCommandSenderIdx(streamInfo.device_, streamInfo.vq_))->second;
-  SpinLock lock(mutex_);
+  SpinLock lock(getDeviceMutex(DeviceId{streamInfo.device_}));
   if (checkMemcpyDeviceAddress_) {
     auto& mm = memoryManagers_.at(DeviceId{streamInfo.device_});
     mm.checkOperation(d_src, size);
   }
+  if (isCapturing(stream)) {
+    auto hostBuffer = findHostBuffer(DeviceId{streamInfo.device_}, MemcpyType::D2H, h_dst, size);
+    auto ops = hostBuffer ? std::vector<ZeroCopyOp>{{h_dst, d_src, size}} : std::vector<ZeroCopyOp>{};
+    return captureCommands(stream, captureZeroCopyMemcpy(MemcpyType::D2H, DeviceId{streamInfo.device_}, ops,
+                                                         hostBuffer && hostBuffer->dmaContiguous_, barrier));
+  }
+  if (auto mappedEvt = tryMappedDramMemcpy(MemcpyType::D2H, stream, d_src, h_dst, size)) {
+    Sync(*mappedEvt);
+    return *mappedEvt;
+  }
+  if (auto coalescedEvt = tryCoalesceMemcpy(MemcpyType::D2H, stream, d_src, h_dst, size, barrier, cmaCopyFunction)) {
+    Sync(*coalescedEvt);
+    return *coalescedEvt;
+  }
   auto evt = eventManager_.getNextId();
   RT_VLOG(LOW) << "MemcpyDeviceToHost stream: " << static_cast<int>(stream) << " EventId: " << static_cast<int>(evt)
                << std::hex << " Host address: " << h_dst << " Device address: " << d_src << " Size: " << size;
   streamManager_.addEvent(stream, evt);
 
+  if (auto hostBuffer = findHostBuffer(DeviceId{streamInfo.device_}, MemcpyType::D2H, h_dst, size); hostBuffer) {
+    RT_VLOG(MID) << "D2H: host memory can be used directly, skipping CMA";
+    sendZeroCopyMemcpy(MemcpyType::D2H, commandSender, DeviceId{streamInfo.device_}, stream, evt,
+                       {{h_dst, d_src, size}}, hostBuffer->dmaContiguous_, barrier);
+    Sync(evt);
+    return evt;
+  }
+
   // start sending a "ghost" command which will be create the needed barrier in command sender until we have sent all
   // commands. This is needed because we don't know if we will have enough CMA memory to hold all commands with their
   // addresses and sizes in the queue or we will have to chunk them.
@@ -155,12 +414,253 @@ EventId RuntimeImp::doMemcpyDeviceToHost(StreamId stream, const std::byte* d_src
   return evt;
 }
 
+EventId RuntimeImp::doMemcpyHostToDeviceConverted(StreamId stream, const float* h_src, std::byte* d_dst, size_t count,
+                                                  const MemcpyConversion& conversion, bool barrier) {
+  auto streamInfo = streamManager_.getStreamInfo(stream);
+  auto device = DeviceId{streamInfo.device_};
+  auto size = count * getDeviceElementSize(conversion.type_);
+  if (conversion.type_ == DeviceElementType::Int8 && !std::isnormal(conversion.scale_)) {
+    throw Exception("Int8 memcpy conversions need a normal scale");
+  }
+  SpinLock lock(getDeviceMutex(device));
+  if (checkMemcpyDeviceAddress_) {
+    memoryManagers_.at(device).checkOperation(d_dst, size);
+  }
+  if (isCapturing(stream)) {
+    throw Exception("Converting memcpys can't be captured");
+  }
+  auto& commandSender = find(commandSenders_, getCommandSenderIdx(streamInfo.device_, streamInfo.vq_))->second;
+  // the conversion happens in the cma copies, the other paths don't have them
+  flushCoalescedMemcpys(stream);
+  auto evt = eventManager_.getNextId();
+  RT_VLOG(LOW) << "MemcpyHostToDevice (converted) stream: " << static_cast<int>(stream)
+               << " EventId: " << static_cast<int>(evt) << std::hex << " Host address: " << h_src
+               << " Device address: " << d_dst << std::dec << " Elements: " << count;
+  streamManager_.addEvent(stream, evt);
+  commandSender.send(Command{{}, commandSender, evt, evt, stream, true});
+
+  // the action sees the host buffer with the device layout, the copy function maps its offsets back to the fp32 values
+  auto hostBase = reinterpret_cast<const std::byte*>(h_src);
+  auto& cmaManager = cmaManagers_.at(device);
+  MemcpyContext mc{makeConvertingCopyFunction(conversion, hostBase),
+                   deviceLayer_->getDmaInfo(streamInfo.device_),
+                   *this,
+                   *cmaManager,
+                   streamManager_,
+                   eventManager_,
+                   commandSender,
+                   *threadPools_.at(device),
+                   stream,
+                   evt};
+  cmaManager->addMemcpyAction(std::make_unique<MemcpyH2DAction>(hostBase, d_dst, size, barrier, std::move(mc)));
+  Sync(evt);
+  return evt;
+}
+
+EventId RuntimeImp::doMemcpyDeviceToHostConverted(StreamId stream, const std::byte* d_src, float* h_dst, size_t count,
+                                                  const MemcpyConversion& conversion, bool barrier) {
+  auto streamInfo = streamManager_.getStreamInfo(stream);
+  auto device = DeviceId{streamInfo.device_};
+  auto size = count * getDeviceElementSize(conversion.type_);
+  SpinLock lock(getDeviceMutex(device));
+  if (checkMemcpyDeviceAddress_) {
+    memoryManagers_.at(device).checkOperation(d_src, size);
+  }
+  if (isCapturing(stream)) {
+    throw Exception("Converting memcpys can't be captured");
+  }
+  auto& commandSender = find(commandSenders_, getCommandSenderIdx(streamInfo.device_, streamInfo.vq_))->second;
+  flushCoalescedMemcpys(stream);
+  auto evt = eventManager_.getNextId();
+  RT_VLOG(LOW) << "MemcpyDeviceToHost (converted) stream: " << static_cast<int>(stream)
+               << " EventId: " << static_cast<int>(evt) << std::hex << " Host address: " << h_dst
+               << " Device address: " << d_src << std::dec << " Elements: " << count;
+  streamManager_.addEvent(stream, evt);
+  commandSender.send(Command{{}, commandSender, evt, evt, stream, true});
+
+  auto hostBase = reinterpret_cast<std::byte*>(h_dst);
+  auto& cmaManager = cmaManagers_.at(device);
+  MemcpyContext mc{makeConvertingCopyFunction(conversion, hostBase),
+                   deviceLayer_->getDmaInfo(streamInfo.device_),
+                   *this,
+                   *cmaManager,
+                   streamManager_,
+                   eventManager_,
+                   commandSender,
+                   *threadPools_.at(device),
+                   stream,
+                   evt};
+  cmaManager->addMemcpyAction(std::make_unique<MemcpyD2HAction>(d_src, hostBase, size, barrier, std::move(mc)));
+  Sync(evt);
+  return evt;
+}
+
+EventId RuntimeImp::doMemcpyHostToDeviceCompressed(StreamId stream, const std::vector<CompressedChunk>& chunks,
+                                                   std::byte* d_dst, uint64_t shireMask) {
+  auto streamInfo = streamManager_.getStreamInfo(stream);
+  auto device = DeviceId{streamInfo.device_};
+  if (chunks.empty()) {
+    throw Exception("Compressed memcpys need at least one chunk");
+  }
+  if (isCapturing(stream)) {
+    throw Exception("Compressed memcpys can't be captured");
+  }
+
+  // the chunks of a batch are staged one after the other, cache line aligned; a batch is a single memcpy list
+  struct Batch {
+    size_t first_;
+    size_t count_;
+    size_t stagingSize_;
+  };
+  auto dmaInfo = deviceLayer_->getDmaInfo(streamInfo.device_);
+  auto maxBatchSize = std::min(kMaxCompressedBatchSize, cmaManagers_.at(device)->getTotalSize());
+  auto maxBatchChunks = std::min(kMaxCompressedBatchChunks, static_cast<size_t>(dmaInfo.maxElementCount_));
+  std::vector<Batch> batches;
+  size_t slotSize = 0;
+  size_t totalSize = 0;
+  for (auto i = 0UL; i < chunks.size(); ++i) {
+    const auto& chunk = chunks[i];
+    if (chunk.data_ == nullptr || chunk.size_ == 0 || chunk.decompressedSize_ == 0) {
+      throw Exception("Compressed memcpy chunk " + std::to_string(i) + " is empty");
+    }
+    auto stagedSize = align(chunk.size_, kCacheLineSize);
+    if (batches.empty() || batches.back().count_ == maxBatchChunks ||
+        batches.back().stagingSize_ + stagedSize > maxBatchSize) {
+      batches.push_back({i, 0, 0});
+    }
+    batches.back().count_++;
+    batches.back().stagingSize_ += stagedSize;
+    slotSize = std::max(slotSize, batches.back().stagingSize_);
+    totalSize += chunk.decompressedSize_;
+  }
+  if (checkMemcpyDeviceAddress_) {
+    SpinLock lock(getDeviceMutex(device));
+    memoryManagers_.at(device).checkOperation(d_dst, totalSize);
+  }
+  RT_VLOG(LOW) << "MemcpyHostToDevice (compressed) stream: " << static_cast<int>(stream) << std::hex
+               << " Device address: " << d_dst << std::dec << " Chunks: " << chunks.size() << " Size: " << totalSize
+               << " Batches: " << batches.size();
+  auto decompressKernel = getRuntimeKernel(device, kLz4DecompressKernel);
+
+  // two staging slots: a batch is transferred into one of them while the previous one is decompressed from the other
+  auto staging = doMallocDevice(device, slotSize * std::min(batches.size(), 2UL));
+  KernelLaunchOptionsImp options;
+  options.shireMask_ = shireMask;
+  // the kernel waits for the transfer of its batch, and for the previous kernel. The transfers have no barrier, the
+  // next one overlaps the kernel; it can't overwrite the slot of a running kernel, as the kernel two batches back has
+  // completed before the previous one started
+  options.barrier_ = true;
+  EventId evt{};
+  try {
+    auto dst = d_dst;
+    for (auto b = 0UL; b < batches.size(); ++b) {
+      const auto& batch = batches[b];
+      auto slot = staging + (b % 2) * slotSize;
+      MemcpyList list;
+      std::vector<std::byte> args(sizeof(uint64_t) + batch.count_ * sizeof(DecompressChunk));
+      uint64_t count = batch.count_;
+      std::memcpy(args.data(), &count, sizeof(count));
+      size_t offset = 0;
+      for (auto i = 0UL; i < batch.count_; ++i) {
+        const auto& chunk = chunks[batch.first_ + i];
+        list.addOp(const_cast<std::byte*>(chunk.data_), slot + offset, chunk.size_);
+        DecompressChunk arg{reinterpret_cast<uint64_t>(slot + offset), chunk.size_, reinterpret_cast<uint64_t>(dst),
+                            chunk.decompressedSize_};
+        std::memcpy(args.data() + sizeof(uint64_t) + i * sizeof(DecompressChunk), &arg, sizeof(arg));
+        offset += align(chunk.size_, kCacheLineSize);
+        dst += chunk.decompressedSize_;
+      }
+      doMemcpyHostToDevice(stream, std::move(list), false, defaultCmaCopyFunction);
+      evt = doKernelLaunch(stream, decompressKernel, args.data(), args.size(), options);
+    }
+  } catch (...) {
+    doFreeDeviceAsync(stream, staging);
+    throw;
+  }
+  doFreeDeviceAsync(stream, staging);
+  return evt;
+}
+
+EventId RuntimeImp::doMemcpyHostToDeviceChecked(StreamId stream, const std::byte* h_src, std::byte* d_dst, size_t size,
+                                                uint64_t shireMask, bool barrier) {
+  if (size == 0) {
+    throw Exception("Checked memcpys can't be empty");
+  }
+  if (reinterpret_cast<uint64_t>(d_dst) % 8 != 0) {
+    throw Exception("Checked memcpys need a device address aligned to 8 bytes");
+  }
+  if (isCapturing(stream)) {
+    throw Exception("Checked memcpys can't be captured");
+  }
+
+  auto device = DeviceId{streamManager_.getStreamInfo(stream).device_};
+  auto checkKernel = getRuntimeKernel(device, kCrc32CheckKernel);
+
+  auto chunkCount = (size + kChecksumChunkSize - 1) / kChecksumChunkSize;
+  auto state = std::make_shared<ChecksumState>();
+  state->src_ = h_src;
+  state->size_ = size;
+  state->deviceCrcs_.resize(chunkCount);
+  auto d_crcs = doMallocDevice(device, chunkCount * sizeof(uint32_t));
+  RT_VLOG(LOW) << "MemcpyHostToDevice (checked) stream: " << static_cast<int>(stream) << std::hex
+               << " Device address: " << d_dst << std::dec << " Size: " << size << " Chunks: " << chunkCount;
+
+  // the host CRCs are computed by the staging copy, in steps small enough to still find the source in the caches
+  auto copyFunction = [state](const std::byte* src, std::byte* dst, size_t copySize, CmaCopyType type) {
+    std::vector<ChecksumState::Piece> pieces;
+    auto copyStart = static_cast<size_t>(src - state->src_);
+    auto copyEnd = copyStart + copySize;
+    for (auto offset = copyStart; offset < copyEnd;) {
+      auto pieceEnd = std::min(copyEnd, (offset / kChecksumChunkSize + 1) * kChecksumChunkSize);
+      ChecksumState::Piece piece{offset, pieceEnd - offset, 0};
+      while (offset < pieceEnd) {
+        auto step = std::min(kChecksumCopyStep, pieceEnd - offset);
+        copyCma(state->src_ + offset, dst + (offset - copyStart), step, type);
+        piece.crc_ = crc32(state->src_ + offset, step, piece.crc_);
+        offset += step;
+      }
+      pieces.emplace_back(piece);
+    }
+    std::lock_guard lock(state->mutex_);
+    state->pieces_.insert(end(state->pieces_), begin(pieces), end(pieces));
+  };
+  doMemcpyHostToDevice(stream, h_src, d_dst, size, barrier, copyFunction);
+
+  // the kernel waits for the memcpy and recomputes the CRCs from the device memory, which are then compared in stream
+  // order with the host ones
+  ChecksumArgs args{reinterpret_cast<uint64_t>(d_dst), size, kChecksumChunkSize, chunkCount,
+                    reinterpret_cast<uint64_t>(d_crcs)};
+  KernelLaunchOptionsImp options;
+  options.shireMask_ = shireMask;
+  options.barrier_ = true;
+  doKernelLaunch(stream, checkKernel, reinterpret_cast<const std::byte*>(&args), sizeof(args), options);
+  doMemcpyDeviceToHost(stream, d_crcs, reinterpret_cast<std::byte*>(state->deviceCrcs_.data()),
+                       chunkCount * sizeof(uint32_t), true, defaultCmaCopyFunction);
+  return launchHostTask(stream, [this, state, stream, device, d_crcs](EventId evt) {
+    doFreeDevice(device, d_crcs);
+    auto hostCrcs = state->getHostCrcs();
+    auto [host, dev] = std::mismatch(begin(hostCrcs), end(hostCrcs), begin(state->deviceCrcs_));
+    if (host == end(hostCrcs)) {
+      return;
+    }
+    auto chunk = static_cast<size_t>(std::distance(begin(hostCrcs), host));
+    RT_LOG(WARNING) << "Checked memcpy of event " << static_cast<int>(evt) << " differs at chunk " << chunk
+                    << " (offset " << chunk * kChecksumChunkSize << "): host CRC32 " << std::hex << *host
+                    << " device CRC32 " << *dev;
+    StreamError error(DeviceErrorCode::MemcpyChecksumMismatch, device);
+    error.stream_ = stream;
+    if (!streamManager_.executeCallback(evt, error, [] {})) {
+      streamManager_.addError(evt, std::move(error));
+    }
+  });
+}
+
 EventId RuntimeImp::doMemcpyHostToDevice(StreamId stream, MemcpyList memcpyList, bool barrier,
                                          const CmaCopyFunction& cmaCopyFunction) {
   auto streamInfo = streamManager_.getStreamInfo(stream);
   checkList(streamInfo.device_, memcpyList);
 
-  SpinLock lock(mutex_);
+  SpinLock lock(getDeviceMutex(DeviceId{streamInfo.device_}));
   if (checkMemcpyDeviceAddress_) {
     auto& mm = memoryManagers_.at(DeviceId{streamInfo.device_});
     for (auto& elem : memcpyList.operations_) {
@@ -170,11 +670,29 @@ EventId RuntimeImp::doMemcpyHostToDevice(StreamId stream, MemcpyList memcpyList,
 
   auto& commandSender = find(commandSenders_, getCommandSenderIdx(streamInfo.device_, streamInfo.vq_))->second;
 
+  if (isCapturing(stream)) {
+    auto dmaContiguous = true;
+    auto ops = getZeroCopyOps(DeviceId{streamInfo.device_}, memcpyList, MemcpyType::H2D, dmaContiguous);
+    return captureCommands(
+      stream, captureZeroCopyMemcpy(MemcpyType::H2D, DeviceId{streamInfo.device_}, ops, dmaContiguous, barrier));
+  }
+
+  flushCoalescedMemcpys(stream);
   auto evt = eventManager_.getNextId();
   RT_VLOG(LOW) << "MemcpyHostToDevice (list) stream: " << static_cast<int>(stream)
                << " EventId: " << static_cast<int>(evt);
   streamManager_.addEvent(stream, evt);
 
+  auto dmaContiguous = true;
+  if (auto ops = getZeroCopyOps(DeviceId{streamInfo.device_}, memcpyList, MemcpyType::H2D, dmaContiguous);
+      !ops.empty()) {
+    RT_VLOG(MID) << "H2D: all host memory can be used directly, skipping CMA";
+    sendZeroCopyMemcpy(MemcpyType::H2D, commandSender, DeviceId{streamInfo.device_}, stream, evt, ops, dmaContiguous,
+                       barrier);
+    Sync(evt);
+    return evt;
+  }
+
   commandSender.send(Command{{}, commandSender, evt, evt, stream, true});
   RT_VLOG(MID) << "H2D: Added command id: " << static_cast<int>(evt) << " to CS " << &commandSender;
 
@@ -197,7 +715,7 @@ EventId RuntimeImp::doMemcpyDeviceToHost(StreamId stream, MemcpyList memcpyList,
                                          const CmaCopyFunction& cmaCopyFunction) {
   auto streamInfo = streamManager_.getStreamInfo(stream);
   checkList(streamInfo.device_, memcpyList);
-  SpinLock lock(mutex_);
+  SpinLock lock(getDeviceMutex(DeviceId{streamInfo.device_}));
   if (checkMemcpyDeviceAddress_) {
     auto& mm = memoryManagers_.at(DeviceId{streamInfo.device_});
     for (auto& elem : memcpyList.operations_) {
@@ -206,11 +724,29 @@ EventId RuntimeImp::doMemcpyDeviceToHost(StreamId stream, MemcpyList memcpyList,
   }
   auto& commandSender = find(commandSenders_, getCommandSenderIdx(streamInfo.device_, streamInfo.vq_))->second;
 
+  if (isCapturing(stream)) {
+    auto dmaContiguous = true;
+    auto ops = getZeroCopyOps(DeviceId{streamInfo.device_}, memcpyList, MemcpyType::D2H, dmaContiguous);
+    return captureCommands(
+      stream, captureZeroCopyMemcpy(MemcpyType::D2H, DeviceId{streamInfo.device_}, ops, dmaContiguous, barrier));
+  }
+
+  flushCoalescedMemcpys(stream);
   auto evt = eventManager_.getNextId();
   RT_VLOG(LOW) << "MemcpyDeviceToHost (list) stream: " << static_cast<int>(stream)
                << " EventId: " << static_cast<int>(evt);
   streamManager_.addEvent(stream, evt);
 
+  auto dmaContiguous = true;
+  if (auto ops = getZeroCopyOps(DeviceId{streamInfo.device_}, memcpyList, MemcpyType::D2H, dmaContiguous);
+      !ops.empty()) {
+    RT_VLOG(MID) << "D2H: all host memory can be used directly, skipping CMA";
+    sendZeroCopyMemcpy(MemcpyType::D2H, commandSender, DeviceId{streamInfo.device_}, stream, evt, ops, dmaContiguous,
+                       barrier);
+    Sync(evt);
+    return evt;
+  }
+
   commandSender.send(Command{{}, commandSender, evt, evt, stream, true});
   RT_VLOG(MID) << "D2H: Added GHOST command id: " << static_cast<int>(evt) << " to CS " << &commandSender;
 
@@ -229,9 +765,82 @@ EventId RuntimeImp::doMemcpyDeviceToHost(StreamId stream, MemcpyList memcpyList,
   return evt;
 }
 
+EventId RuntimeImp::doMemcpyHostToDeviceChained(StreamId stream, MemcpyList memcpyList) {
+  return memcpyChained(MemcpyType::H2D, stream, std::move(memcpyList));
+}
+
+EventId RuntimeImp::doMemcpyDeviceToHostChained(StreamId stream, MemcpyList memcpyList) {
+  return memcpyChained(MemcpyType::D2H, stream, std::move(memcpyList));
+}
+
+EventId RuntimeImp::memcpyChained(MemcpyType type, StreamId stream, MemcpyList memcpyList) {
+  auto streamInfo = streamManager_.getStreamInfo(stream);
+  auto device = DeviceId{streamInfo.device_};
+  if (memcpyList.operations_.empty()) {
+    throw Exception("Chained memcpys can't be empty");
+  }
+  if (isCapturing(stream)) {
+    throw Exception("Chained memcpys can't be captured");
+  }
+  auto dmaInfo = deviceLayer_->getDmaInfo(streamInfo.device_);
+  auto elems = buildStagedChainElems(type, memcpyList, dmaInfo);
+  if (elems.size() > device_ops_ext::kMaxDmaChainElems) {
+    throw Exception("Chained memcpy takes " + std::to_string(elems.size()) + " DMA elements, the maximum is " +
+                    std::to_string(device_ops_ext::kMaxDmaChainElems));
+  }
+  size_t totalSize = 0;
+  for (auto& op : memcpyList.operations_) {
+    totalSize += op.size_;
+  }
+  if (auto stagingSize = MemcpyChainAction::getStagingSize(totalSize, elems.size());
+      stagingSize > cmaManagers_.at(device)->getTotalSize()) {
+    throw Exception("Required staging size for the chained memcpy is: " + std::to_string(stagingSize) +
+                    " which is larger of maximum allowed of " +
+                    std::to_string(cmaManagers_.at(device)->getTotalSize()) + " bytes.");
+  }
+  if (checkMemcpyDeviceAddress_) {
+    SpinLock lock(getDeviceMutex(device));
+    auto& mm = memoryManagers_.at(device);
+    for (auto& op : memcpyList.operations_) {
+      mm.checkOperation(type == MemcpyType::H2D ? op.dst_ : op.src_, op.size_);
+    }
+  }
+
+  // the chain is uploaded for each memcpy since the device rewrites it to run it; freed once the memcpy is done
+  auto chain = doMallocDevice(device, (elems.size() + 1) * sizeof(device_ops_ext::dma_chain_elem_t));
+  EventId evt{};
+  try {
+    SpinLock lock(getDeviceMutex(device));
+    auto& commandSender = find(commandSenders_, getCommandSenderIdx(streamInfo.device_, streamInfo.vq_))->second;
+    flushCoalescedMemcpys(stream);
+    evt = eventManager_.getNextId();
+    RT_VLOG(LOW) << "Memcpy" << (type == MemcpyType::H2D ? "HostToDevice" : "DeviceToHost")
+                 << " (chained) stream: " << static_cast<int>(stream) << " EventId: " << static_cast<int>(evt)
+                 << " Elements: " << elems.size();
+    streamManager_.addEvent(stream, evt);
+    commandSender.send(Command{{}, commandSender, evt, evt, stream, true});
+
+    auto& cmaManager = cmaManagers_.at(device);
+    MemcpyContext mc{defaultCmaCopyFunction, dmaInfo,        *this,         *cmaManager,
+                     streamManager_,        eventManager_,  commandSender, *threadPools_.at(device),
+                     stream,                evt};
+    cmaManager->addMemcpyAction(
+      std::make_unique<MemcpyChainAction>(type, std::move(memcpyList), std::move(elems), chain, std::move(mc)));
+  } catch (...) {
+    doFreeDeviceAsync(stream, chain);
+    throw;
+  }
+  doFreeDeviceAsync(stream, chain);
+  Sync(evt);
+  return evt;
+}
+
 EventId RuntimeImp::doMemcpyDeviceToDevice(StreamId streamSrc, DeviceId deviceDst, const std::byte* d_src,
                                            std::byte* d_dst, size_t size, bool barrier) {
   auto streamInfo = streamManager_.getStreamInfo(streamSrc);
+  if (DeviceId{streamInfo.device_} == deviceDst) {
+    return doMemcpyWithinDevice(streamSrc, d_src, d_dst, size, barrier);
+  }
   auto& commandSender = find(commandSenders_, getCommandSenderIdx(streamInfo.device_, streamInfo.vq_))->second;
   if (!doIsP2PEnabled(DeviceId{streamInfo.device_}, deviceDst)) {
     RT_LOG(WARNING) << "Devices " << streamInfo.device_ << " and " << static_cast<int>(deviceDst)
@@ -244,25 +853,22 @@ EventId RuntimeImp::doMemcpyDeviceToDevice(StreamId streamSrc, DeviceId deviceDs
     throw Exception(ss.str());
   }
   auto dc = deviceLayer_->getDeviceConfig(static_cast<int>(deviceDst));
-  SpinLock lock(mutex_);
   if (checkMemcpyDeviceAddress_) {
-    const auto& mmSrc = memoryManagers_.at(DeviceId{streamInfo.device_});
-    mmSrc.checkOperation(d_src, size);
-
+    // check the peer first and release its lock; holding both device locks at once could deadlock against a p2p
+    // memcpy issued in the opposite direction
+    SpinLock peerLock(getDeviceMutex(deviceDst));
     const auto& mmDst = memoryManagers_.at(deviceDst);
     mmDst.checkOperation(d_dst, size);
   }
-  auto evt = eventManager_.getNextId();
-  RT_VLOG(LOW) << "MemcpyDeviceToDevice streamSrc: " << static_cast<int>(streamSrc)
-               << " Device destination: " << static_cast<int>(deviceDst) << " EventId: " << static_cast<int>(evt)
-               << std::hex << " DeviceSrc address: " << d_src << " DeviceDst address: " << d_dst << " Size: " << size;
-  streamManager_.addEvent(streamSrc, evt);
-
+  SpinLock lock(getDeviceMutex(DeviceId{streamInfo.device_}));
+  if (checkMemcpyDeviceAddress_) {
+    const auto& mmSrc = memoryManagers_.at(DeviceId{streamInfo.device_});
+    mmSrc.checkOperation(d_src, size);
+  }
   auto data = std::vector<std::byte>(sizeof(device_ops_p2pdma_readlist_cmd_t) + sizeof(p2pdma_read_node));
   auto dataPtr = reinterpret_cast<device_ops_p2pdma_readlist_cmd_t*>(data.data());
 
   dataPtr->command_info.cmd_hdr.size = static_cast<msg_size_t>(data.size());
-  dataPtr->command_info.cmd_hdr.tag_id = static_cast<tag_id_t>(evt);
   dataPtr->command_info.cmd_hdr.msg_id = DEV_OPS_API_MID_DEVICE_OPS_P2PDMA_READLIST_CMD;
   if (barrier) {
     dataPtr->command_info.cmd_hdr.flags |= device_ops_api::CMD_FLAGS_BARRIER_ENABLE;
@@ -272,6 +878,21 @@ EventId RuntimeImp::doMemcpyDeviceToDevice(StreamId streamSrc, DeviceId deviceDs
   dataPtr->list[0].peer_devnum = dc.physDeviceId_;
   dataPtr->list[0].size = static_cast<uint32_t>(size);
 
+  if (isCapturing(streamSrc)) {
+    GraphNode node;
+    node.command_ = std::move(data);
+    node.isDma_ = node.isP2P_ = true;
+    return captureCommands(streamSrc, {std::move(node)});
+  }
+
+  flushCoalescedMemcpys(streamSrc);
+  auto evt = eventManager_.getNextId();
+  RT_VLOG(LOW) << "MemcpyDeviceToDevice streamSrc: " << static_cast<int>(streamSrc)
+               << " Device destination: " << static_cast<int>(deviceDst) << " EventId: " << static_cast<int>(evt)
+               << std::hex << " DeviceSrc address: " << d_src << " DeviceDst address: " << d_dst << " Size: " << size;
+  streamManager_.addEvent(streamSrc, evt);
+  dataPtr->command_info.cmd_hdr.tag_id = static_cast<tag_id_t>(evt);
+
   commandSender.send(Command{std::move(data), commandSender, evt, evt, streamSrc, true, true, true});
 
   Sync(evt);
@@ -281,6 +902,9 @@ EventId RuntimeImp::doMemcpyDeviceToDevice(StreamId streamSrc, DeviceId deviceDs
 EventId RuntimeImp::doMemcpyDeviceToDevice(DeviceId deviceSrc, StreamId streamDst, const std::byte* d_src,
                                            std::byte* d_dst, size_t size, bool barrier) {
   auto streamInfo = streamManager_.getStreamInfo(streamDst);
+  if (DeviceId{streamInfo.device_} == deviceSrc) {
+    return doMemcpyWithinDevice(streamDst, d_src, d_dst, size, barrier);
+  }
   auto& commandSender = find(commandSenders_, getCommandSenderIdx(streamInfo.device_, streamInfo.vq_))->second;
   if (!doIsP2PEnabled(DeviceId{streamInfo.device_}, deviceSrc)) {
     RT_LOG(WARNING) << "Devices " << streamInfo.device_ << " and " << static_cast<int>(deviceSrc)
@@ -294,25 +918,21 @@ EventId RuntimeImp::doMemcpyDeviceToDevice(DeviceId deviceSrc, StreamId streamDs
     throw Exception(ss.str());
   }
   auto dc = deviceLayer_->getDeviceConfig(static_cast<int>(deviceSrc));
-  SpinLock lock(mutex_);
   if (checkMemcpyDeviceAddress_) {
+    // see doMemcpyDeviceToDevice(StreamId, DeviceId, ...) regarding lock ordering
+    SpinLock peerLock(getDeviceMutex(deviceSrc));
     const auto& mmSrc = memoryManagers_.at(deviceSrc);
     mmSrc.checkOperation(d_src, size);
-
+  }
+  SpinLock lock(getDeviceMutex(DeviceId{streamInfo.device_}));
+  if (checkMemcpyDeviceAddress_) {
     const auto& mmDst = memoryManagers_.at(DeviceId{streamInfo.device_});
     mmDst.checkOperation(d_dst, size);
   }
-  auto evt = eventManager_.getNextId();
-  RT_VLOG(LOW) << "MemcpyDeviceToDevice streamDst: " << static_cast<int>(streamDst)
-               << " Device source: " << static_cast<int>(deviceSrc) << " EventId: " << static_cast<int>(evt) << std::hex
-               << " DeviceSrc address: " << d_src << " DeviceDst address: " << d_dst << " Size: " << size;
-  streamManager_.addEvent(streamDst, evt);
-
   auto data = std::vector<std::byte>(sizeof(device_ops_p2pdma_writelist_cmd_t) + sizeof(p2pdma_write_node));
   auto dataPtr = reinterpret_cast<device_ops_p2pdma_writelist_cmd_t*>(data.data());
 
   dataPtr->command_info.cmd_hdr.size = static_cast<msg_size_t>(data.size());
-  dataPtr->command_info.cmd_hdr.tag_id = static_cast<tag_id_t>(evt);
   dataPtr->command_info.cmd_hdr.msg_id = DEV_OPS_API_MID_DEVICE_OPS_P2PDMA_WRITELIST_CMD;
   if (barrier) {
     dataPtr->command_info.cmd_hdr.flags |= device_ops_api::CMD_FLAGS_BARRIER_ENABLE;
@@ -322,9 +942,372 @@ EventId RuntimeImp::doMemcpyDeviceToDevice(DeviceId deviceSrc, StreamId streamDs
   dataPtr->list[0].peer_devnum = dc.physDeviceId_;
   dataPtr->list[0].size = static_cast<uint32_t>(size);
 
+  if (isCapturing(streamDst)) {
+    GraphNode node;
+    node.command_ = std::move(data);
+    node.isDma_ = node.isP2P_ = true;
+    return captureCommands(streamDst, {std::move(node)});
+  }
+
+  flushCoalescedMemcpys(streamDst);
+  auto evt = eventManager_.getNextId();
+  RT_VLOG(LOW) << "MemcpyDeviceToDevice streamDst: " << static_cast<int>(streamDst)
+               << " Device source: " << static_cast<int>(deviceSrc) << " EventId: " << static_cast<int>(evt) << std::hex
+               << " DeviceSrc address: " << d_src << " DeviceDst address: " << d_dst << " Size: " << size;
+  streamManager_.addEvent(streamDst, evt);
+  dataPtr->command_info.cmd_hdr.tag_id = static_cast<tag_id_t>(evt);
+
   commandSender.send(Command{std::move(data), commandSender, evt, evt, streamDst, true, true, true});
 
   Sync(evt);
   return evt;
 }
+
+void RuntimeImp::doRegisterHostBuffer(DeviceId device, const std::byte* h_ptr, size_t size, bool toDeviceOnly) {
+  if (h_ptr == nullptr || size == 0) {
+    throw Exception("Invalid host buffer");
+  }
+  SpinLock lock(getDeviceMutex(device));
+  auto& buffers = hostBuffers_[device];
+  if (auto it = buffers.lower_bound(h_ptr);
+      (it != end(buffers) && it->first < h_ptr + size) ||
+      (it != begin(buffers) && std::prev(it)->first + std::prev(it)->second.size_ > h_ptr)) {
+    throw Exception("Host buffer overlaps with an already registered host buffer");
+  }
+  auto segments = deviceLayer_->registerHostMemory(static_cast<int>(device), h_ptr, size, toDeviceOnly);
+  RT_LOG_IF(INFO, segments == 0) << "Device can't access host memory directly, memcpys from/to host buffer " << h_ptr
+                                 << " will be done through CMA";
+  RT_VLOG(LOW) << "Registered host buffer " << h_ptr << " size: " << size << " DMA segments: " << segments;
+  buffers.emplace(h_ptr, HostBuffer{size, segments > 0, segments == 1, false, toDeviceOnly});
+}
+
+void RuntimeImp::doUnregisterHostBuffer(DeviceId device, const std::byte* h_ptr) {
+  SpinLock lock(getDeviceMutex(device));
+  auto& buffers = hostBuffers_[device];
+  auto it = buffers.find(h_ptr);
+  if (it == end(buffers)) {
+    throw Exception("Host buffer was not registered");
+  }
+  if (it->second.allocated_) {
+    throw Exception("Host buffer was allocated through allocHostBuffer, it must be released with freeHostBuffer");
+  }
+  if (it->second.registered_) {
+    deviceLayer_->unregisterHostMemory(static_cast<int>(device), h_ptr);
+  }
+  buffers.erase(it);
+}
+
+std::byte* RuntimeImp::doAllocHostBuffer(DeviceId device, size_t size) {
+  if (size == 0) {
+    throw Exception("Invalid host buffer size");
+  }
+  auto pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  size = (size + pageSize - 1) / pageSize * pageSize;
+  auto memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (memory == MAP_FAILED) {
+    throw Exception(std::string{"Can't allocate host buffer: "} + strerror(errno));
+  }
+  auto h_ptr = static_cast<std::byte*>(memory);
+  try {
+    doRegisterHostBuffer(device, h_ptr, size, false);
+  } catch (...) {
+    munmap(memory, size);
+    throw;
+  }
+  SpinLock lock(getDeviceMutex(device));
+  find(hostBuffers_[device], h_ptr)->second.allocated_ = true;
+  return h_ptr;
+}
+
+void RuntimeImp::doFreeHostBuffer(DeviceId device, std::byte* h_ptr) {
+  SpinLock lock(getDeviceMutex(device));
+  auto& buffers = hostBuffers_[device];
+  auto it = buffers.find(h_ptr);
+  if (it == end(buffers) || !it->second.allocated_) {
+    throw Exception("Host buffer was not allocated through allocHostBuffer");
+  }
+  if (it->second.registered_) {
+    deviceLayer_->unregisterHostMemory(static_cast<int>(device), h_ptr);
+  }
+  auto size = it->second.size_;
+  buffers.erase(it);
+  munmap(h_ptr, size);
+}
+
+std::optional<RuntimeImp::HostBuffer> RuntimeImp::findHostBuffer(DeviceId device, MemcpyType type,
+                                                                 const std::byte* h_ptr, size_t size) const {
+  if (auto devIt = hostBuffers_.find(device); devIt != end(hostBuffers_)) {
+    const auto& buffers = devIt->second;
+    if (auto it = buffers.upper_bound(h_ptr); it != begin(buffers)) {
+      --it;
+      if (it->second.registered_ && h_ptr + size <= it->first + it->second.size_) {
+        if (type == MemcpyType::D2H && it->second.toDeviceOnly_) {
+          return {};
+        }
+        return it->second;
+      }
+    }
+  }
+  // the device-layer pins and maps the memory of each command, which only pays off over the CMA copies for big memcpys
+  if (streamHostMemoryMinBytes_ != 0 && size >= streamHostMemoryMinBytes_ &&
+      deviceLayer_->canStreamHostMemory(static_cast<int>(device))) {
+    return HostBuffer{size, true, false};
+  }
+  return {};
+}
+
+std::vector<RuntimeImp::ZeroCopyOp> RuntimeImp::getZeroCopyOps(DeviceId device, const MemcpyList& list,
+                                                               MemcpyType type, bool& dmaContiguous) const {
+  std::vector<ZeroCopyOp> ops;
+  for (const auto& op : list.operations_) {
+    auto hostAddr = type == MemcpyType::H2D ? op.src_ : op.dst_;
+    auto deviceAddr = type == MemcpyType::H2D ? op.dst_ : op.src_;
+    auto hostBuffer = findHostBuffer(device, type, hostAddr, op.size_);
+    if (!hostBuffer) {
+      return {};
+    }
+    dmaContiguous = dmaContiguous && hostBuffer->dmaContiguous_;
+    ops.emplace_back(ZeroCopyOp{hostAddr, deviceAddr, op.size_});
+  }
+  return ops;
+}
+
+std::vector<std::vector<std::byte>> RuntimeImp::buildZeroCopyCommands(MemcpyType type, DeviceId device,
+                                                                      const std::vector<ZeroCopyOp>& ops,
+                                                                      bool dmaContiguous, bool barrier) const {
+  auto dmaInfo = deviceLayer_->getDmaInfo(static_cast<int>(device));
+  auto pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  // the driver splits each entry at the DMA segment boundaries of the registered memory; when the memory is not
+  // contiguous each command holds a single entry spanning at most maxElementCount_ pages, so it never exceeds
+  // maxElementCount_ entries once split
+  auto maxEntries = static_cast<uint32_t>(dmaContiguous ? dmaInfo.maxElementCount_ : 1);
+  std::vector<MemcpyCommandBuilder> builders;
+  for (const auto& op : ops) {
+    auto processed = 0UL;
+    while (processed < op.size_) {
+      auto chunkSize = std::min(op.size_ - processed, dmaInfo.maxElementSize_);
+      if (!dmaContiguous) {
+        auto pageOffset = reinterpret_cast<uintptr_t>(op.hostAddr_ + processed) % pageSize;
+        chunkSize = std::min(chunkSize, dmaInfo.maxElementCount_ * pageSize - pageOffset);
+      }
+      if (builders.empty() || builders.back().numEntries_ == maxEntries) {
+        builders.emplace_back(type, barrier, maxEntries);
+      }
+      builders.back().addOp(op.hostAddr_ + processed, op.deviceAddr_ + processed, chunkSize);
+      processed += chunkSize;
+    }
+  }
+  std::vector<std::vector<std::byte>> commands;
+  for (auto& builder : builders) {
+    commands.emplace_back(builder.build());
+  }
+  return commands;
+}
+
+void RuntimeImp::sendZeroCopyMemcpy(MemcpyType type, CommandSender& commandSender, DeviceId device, StreamId stream,
+                                    EventId evt, const std::vector<ZeroCopyOp>& ops, bool dmaContiguous,
+                                    bool barrier) {
+  auto commands = buildZeroCopyCommands(type, device, ops, dmaContiguous, barrier);
+  if (commands.size() == 1) {
+    reinterpret_cast<cmn_header_t*>(commands.front().data())->tag_id = static_cast<tag_id_t>(evt);
+    commandSender.send(Command{std::move(commands.front()), commandSender, evt, evt, stream, true, true});
+    return;
+  }
+
+  // several commands needed, dispatch the memcpy event once all of them have been completed
+  std::vector<EventId> cmdEvents;
+  for (auto& command : commands) {
+    auto cmdEvt = eventManager_.getNextId();
+    streamManager_.addEvent(stream, cmdEvt);
+    reinterpret_cast<cmn_header_t*>(command.data())->tag_id = static_cast<tag_id_t>(cmdEvt);
+    commandSender.send(Command{std::move(command), commandSender, cmdEvt, evt, stream, true, true});
+    cmdEvents.emplace_back(cmdEvt);
+  }
+  RT_VLOG(MID) << "Sent " << cmdEvents.size() << " commands for zero-copy memcpy event " << static_cast<int>(evt);
+  eventManager_.addOnDispatchCallback({std::move(cmdEvents), [this, evt] { dispatch(evt); }});
+}
+
+std::vector<RuntimeImp::GraphNode> RuntimeImp::captureZeroCopyMemcpy(MemcpyType type, DeviceId device,
+                                                                     const std::vector<ZeroCopyOp>& ops,
+                                                                     bool dmaContiguous, bool barrier) const {
+  if (ops.empty()) {
+    throw Exception("Only memcpys from/to registered host buffers can be captured in a graph");
+  }
+  std::vector<GraphNode> nodes;
+  for (auto& command : buildZeroCopyCommands(type, device, ops, dmaContiguous, barrier)) {
+    GraphNode node;
+    node.command_ = std::move(command);
+    node.isDma_ = true;
+    nodes.emplace_back(std::move(node));
+  }
+  return nodes;
+}
+
+std::optional<EventId> RuntimeImp::tryMappedDramMemcpy(MemcpyType type, StreamId stream, const std::byte* src,
+                                                       std::byte* dst, size_t size) {
+  auto maxBytes = type == MemcpyType::H2D ? mappedDramH2DMaxBytes_ : mappedDramD2HMaxBytes_;
+  if (size == 0 || size > maxBytes) {
+    return {};
+  }
+  auto device = DeviceId{streamManager_.getStreamInfo(stream).device_};
+  auto it = mappedDrams_.find(device);
+  if (it == end(mappedDrams_)) {
+    return {};
+  }
+  auto& dram = it->second;
+  auto deviceAddress = reinterpret_cast<uint64_t>(type == MemcpyType::H2D ? dst : src);
+  if (deviceAddress < dram.deviceAddress_ || deviceAddress - dram.deviceAddress_ > dram.size_ - size) {
+    return {};
+  }
+  // the CPU copy doesn't wait for anything, so it must not overtake previous commands of the stream. The device mutex
+  // is held, nothing can be added to the stream in the meantime
+  if (!streamManager_.getLiveEvents(stream).empty()) {
+    return {};
+  }
+  auto mapped = dram.hostAddress_ + (deviceAddress - dram.deviceAddress_);
+  if (type == MemcpyType::H2D) {
+    std::memcpy(mapped, src, size);
+    // drains the write-combining buffers; posted writes are not reordered, so later commands see the data
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+  } else {
+    std::memcpy(dst, mapped, size);
+  }
+  auto evt = eventManager_.getNextId();
+  RT_VLOG(LOW) << "Mapped DRAM memcpy stream: " << static_cast<int>(stream) << " EventId: " << static_cast<int>(evt)
+               << std::hex << " Source: " << src << " Destination: " << dst << std::dec << " Size: " << size;
+  streamManager_.addEvent(stream, evt);
+  dispatch(evt);
+  return evt;
+}
+
+std::optional<EventId> RuntimeImp::tryCoalesceMemcpy(MemcpyType type, StreamId stream, const std::byte* src,
+                                                     std::byte* dst, size_t size, bool barrier,
+                                                     const CmaCopyFunction& cmaCopyFunction) {
+  if (numCoalescingStreams_ == 0) {
+    return {};
+  }
+  auto device = DeviceId{streamManager_.getStreamInfo(stream).device_};
+  auto dmaInfo = deviceLayer_->getDmaInfo(static_cast<int>(device));
+  // zero-copy memcpys don't go through CMA, they are better sent on their own
+  auto coalescible = !barrier && size <= std::min(kMaxCoalescedMemcpySize, dmaInfo.maxElementSize_) &&
+                     !findHostBuffer(device, type, type == MemcpyType::H2D ? src : dst, size);
+
+  std::unique_lock lock(coalescingMutex_);
+  auto it = coalescedMemcpys_.find(stream);
+  if (it == end(coalescedMemcpys_)) {
+    return {};
+  }
+  auto& pending = it->second;
+  std::optional<CoalescedMemcpys> full;
+  if (pending && (!coalescible || pending->type_ != type ||
+                  pending->list_.operations_.size() == dmaInfo.maxElementCount_ ||
+                  pending->totalSize_ + size > cmaManagers_.at(device)->getSlabSize())) {
+    full = std::move(pending);
+    pending.reset();
+  }
+  std::optional<EventId> evt;
+  if (coalescible) {
+    if (!pending) {
+      pending = CoalescedMemcpys{type, {}, {}, {}};
+    }
+    evt = eventManager_.getNextId();
+    streamManager_.addEvent(stream, *evt);
+    pending->list_.addOp(const_cast<std::byte*>(src), dst, size);
+    pending->copyFunctions_.emplace_back(cmaCopyFunction);
+    pending->events_.emplace_back(*evt);
+    pending->totalSize_ += size;
+    RT_VLOG(LOW) << "Coalesced memcpy stream: " << static_cast<int>(stream) << " EventId: " << static_cast<int>(*evt)
+                 << std::hex << " Source: " << src << " Destination: " << dst << std::dec << " Size: " << size
+                 << " Pending memcpys: " << pending->events_.size();
+  }
+  lock.unlock();
+  // the device mutex is held by the caller, nothing else can be submitted to the device in the meantime
+  if (full) {
+    sendCoalescedMemcpys(stream, std::move(*full));
+  }
+  return evt;
+}
+
+void RuntimeImp::flushCoalescedMemcpys(StreamId stream) {
+  if (numCoalescingStreams_ == 0) {
+    return;
+  }
+  auto hasPending = [this, stream] {
+    auto it = coalescedMemcpys_.find(stream);
+    return it != end(coalescedMemcpys_) && it->second;
+  };
+  std::unique_lock coalescingLock(coalescingMutex_);
+  if (!hasPending()) {
+    return;
+  }
+  coalescingLock.unlock();
+
+  SpinLock lock(getDeviceMutex(DeviceId{streamManager_.getStreamInfo(stream).device_}));
+  coalescingLock.lock();
+  if (!hasPending()) {
+    return;
+  }
+  auto& pending = coalescedMemcpys_.find(stream)->second;
+  auto memcpys = std::move(*pending);
+  pending.reset();
+  coalescingLock.unlock();
+  sendCoalescedMemcpys(stream, std::move(memcpys));
+}
+
+void RuntimeImp::flushCoalescedMemcpys(EventId event) {
+  if (numCoalescingStreams_ == 0) {
+    return;
+  }
+  if (auto streamInfo = streamManager_.getStreamInfo(event); streamInfo) {
+    flushCoalescedMemcpys(streamInfo->id_);
+  }
+}
+
+void RuntimeImp::sendCoalescedMemcpys(StreamId stream, CoalescedMemcpys memcpys) {
+  auto streamInfo = streamManager_.getStreamInfo(stream);
+  auto device = DeviceId{streamInfo.device_};
+  auto& commandSender = find(commandSenders_, getCommandSenderIdx(streamInfo.device_, streamInfo.vq_))->second;
+  auto evt = eventManager_.getNextId();
+  streamManager_.addEvent(stream, evt);
+  RT_VLOG(LOW) << "Sending " << memcpys.events_.size() << " coalesced memcpys " << stringizeEvents(memcpys.events_)
+               << " stream: " << static_cast<int>(stream) << " EventId: " << static_cast<int>(evt)
+               << " Total size: " << memcpys.totalSize_;
+  // the memcpys are done once the merged list is done
+  eventManager_.addOnDispatchCallback({{evt}, [this, events = std::move(memcpys.events_)] { dispatch(events); }});
+
+  commandSender.send(Command{{}, commandSender, evt, evt, stream, true});
+  auto& cmaManager = cmaManagers_.at(device);
+  MemcpyContext mc{memcpys.copyFunctions_.front(), deviceLayer_->getDmaInfo(streamInfo.device_),
+                   *this,                          *cmaManager,
+                   streamManager_,                 eventManager_,
+                   commandSender,                  *threadPools_.at(device),
+                   stream,                         evt};
+  std::unique_ptr<actionList::IAction> action;
+  if (memcpys.type_ == MemcpyType::H2D) {
+    action = std::make_unique<MemcpyListH2DAction>(std::move(memcpys.list_), false, std::move(mc),
+                                                   std::move(memcpys.copyFunctions_));
+  } else {
+    action = std::make_unique<MemcpyListD2HAction>(std::move(memcpys.list_), false, std::move(mc),
+                                                   std::move(memcpys.copyFunctions_));
+  }
+  cmaManager->addMemcpyAction(std::move(action));
+  Sync(evt);
+}
+
+void RuntimeImp::doSetMemcpyCoalescing(StreamId stream, bool enabled) {
+  auto device = DeviceId{streamManager_.getStreamInfo(stream).device_};
+  RT_VLOG(LOW) << "Memcpy coalescing on stream " << static_cast<int>(stream) << (enabled ? " enabled" : " disabled");
+  SpinLock lock(getDeviceMutex(device));
+  if (!enabled) {
+    flushCoalescedMemcpys(stream);
+  }
+  std::lock_guard coalescingLock(coalescingMutex_);
+  if (enabled) {
+    if (coalescedMemcpys_.try_emplace(stream).second) {
+      ++numCoalescingStreams_;
+    }
+  } else if (coalescedMemcpys_.erase(stream) > 0) {
+    --numCoalescingStreams_;
+  }
+}
 } // namespace rt
@@ -4,7 +4,9 @@
  *-------------------------------------------------------------------------*/
 #pragma once
 #include "CommandSender.h"
+#include "runtime/DeviceOpsExt.h"
 #include "runtime/Types.h"
+#include <device-layer/IDeviceLayer.h>
 #include <cstddef>
 #include <stdint.h>
 #include <vector>
@@ -15,6 +17,9 @@ enum class MemcpyType { H2D, D2H };
 struct MemcpyCommandBuilder {
 
   void addOp(const std::byte* hostAddr, const std::byte* deviceAddr, size_t size);
+  // extends the last entry with the head of the op if the op continues it on both sides, up to maxSize bytes per
+  // entry; returns the bytes added to the entry, 0 if none
+  size_t extendLastOp(const std::byte* hostAddr, const std::byte* deviceAddr, size_t size, size_t maxSize);
   void setTagId(rt::EventId eventId);
 
   explicit MemcpyCommandBuilder(MemcpyType type, bool barrierEnabled, uint32_t maxEntries);
@@ -28,4 +33,25 @@ struct MemcpyCommandBuilder {
   std::vector<std::byte> data_;
 };
 
+// the DMA commands of a list staged in cma from cmaPtr, in the list order. Ops are split in entries of at most
+// maxElementSize_ bytes and entries continuing the previous one on both sides are merged, each command holds up to
+// maxElementCount_ entries. The tag ids are not set
+std::vector<MemcpyCommandBuilder> buildStagedListCommands(MemcpyType type, const MemcpyList& list,
+                                                          const std::byte* cmaPtr, bool barrier,
+                                                          const dev::DmaInfo& dmaInfo);
+
+// consecutive ops of a staged list which are copied to (or from) cma by a single task, so lists of many small ops
+// don't take a task and an event each
+struct StagedCopyRange {
+  size_t first_;
+  size_t count_;
+  size_t cmaOffset_;
+};
+std::vector<StagedCopyRange> groupStagedCopies(const MemcpyList& list);
+
+// the data elements of a DMA chain running a list staged in cma, in the list order. Ops are split and merged as in
+// buildStagedListCommands; the host side address of an element is its offset in the staging buffer
+std::vector<device_ops_ext::dma_chain_elem_t> buildStagedChainElems(MemcpyType type, const MemcpyList& list,
+                                                                    const dev::DmaInfo& dmaInfo);
+
 } // namespace rt
@@ -19,8 +19,10 @@
 
 using namespace rt;
 
-MemoryManager::MemoryManager(uint64_t dramBaseAddr, size_t totalMemoryBytes, uint32_t blockSize)
-  : dramBaseAddr_(dramBaseAddr == 0 ? dramBaseAddr + blockSize : dramBaseAddr)
+MemoryManager::MemoryManager(uint64_t dramBaseAddr, size_t totalMemoryBytes, uint32_t blockSize,
+                             MemoryAllocatorPolicy policy)
+  : policy_(policy)
+  , dramBaseAddr_(dramBaseAddr == 0 ? dramBaseAddr + blockSize : dramBaseAddr)
   , totalMemoryBytes_(totalMemoryBytes)
   , blockSizeLog2_(static_cast<uint32_t>(std::log2(blockSize))) {
 
@@ -45,7 +47,12 @@ MemoryManager::MemoryManager(uint64_t dramBaseAddr, size_t totalMemoryBytes, uin
     RT_LOG(WARNING) << "TotalMemoryBytes is bigger than supported, clamping it to max supported: " << std::hex
                     << totalMemoryBytes_ << " bytes.";
   }
-  free_.emplace_back(FreeChunk{0, static_cast<uint32_t>(totalMemoryBytes_ >> blockSizeLog2_)});
+  auto initialChunk = FreeChunk{0, static_cast<uint32_t>(totalMemoryBytes_ >> blockSizeLog2_)};
+  if (policy_ == MemoryAllocatorPolicy::FirstFit) {
+    free_.emplace_back(initialChunk);
+  } else {
+    insertFreeChunk(initialChunk);
+  }
 }
 
 size_t MemoryManager::getNumAllocations() const {
@@ -53,7 +60,35 @@ size_t MemoryManager::getNumAllocations() const {
 }
 
 size_t MemoryManager::getNumFreeChunks() const {
-  return free_.size();
+  return policy_ == MemoryAllocatorPolicy::FirstFit ? free_.size() : freeByAddress_.size();
+}
+
+MemoryAllocatorPolicy MemoryManager::getPolicy() const {
+  return policy_;
+}
+
+MemoryManager::FragmentationStats MemoryManager::getFragmentationStats() const {
+  FragmentationStats stats;
+  stats.freeBytes_ = getFreeBytes();
+  stats.largestFreeChunkBytes_ = getFreeContiguousBytes();
+  stats.numFreeChunks_ = getNumFreeChunks();
+  stats.fragmentation_ =
+    stats.freeBytes_ == 0
+      ? 0.0
+      : 1.0 - static_cast<double>(stats.largestFreeChunkBytes_) / static_cast<double>(stats.freeBytes_);
+  return stats;
+}
+
+std::vector<MemoryManager::FreeChunk> MemoryManager::getFreeChunks() const {
+  if (policy_ == MemoryAllocatorPolicy::FirstFit) {
+    return free_;
+  }
+  std::vector<FreeChunk> result;
+  result.reserve(freeByAddress_.size());
+  for (auto& [start, size] : freeByAddress_) {
+    result.emplace_back(FreeChunk{start, size});
+  }
+  return result;
 }
 
 void MemoryManager::sanityCheck() const {
@@ -68,17 +103,32 @@ void MemoryManager::sanityCheck() const {
 
   dbg::Check(getFreeContiguousBytes() <= getFreeBytes(),
              std::string{"There are more contiguos free bytes than total free bytes!"});
-  dbg::Check(std::is_sorted(begin(free_), end(free_)), std::string{"Free list is not sorted!"});
+  auto freeChunks = getFreeChunks();
+  dbg::Check(std::is_sorted(begin(freeChunks), end(freeChunks)), std::string{"Free list is not sorted!"});
 
   // check all chunks have valid values
-  for (auto& elem : free_) {
+  for (auto& elem : freeChunks) {
     dbg::Check(elem.size_ > 0, "Invalid free chunk: " + elem.str());
   }
   // check there are no overlapping chunks
-  for (auto current = begin(free_), next = current + 1; next != end(free_); ++current, ++next) {
+  for (auto current = begin(freeChunks), next = current + 1; !freeChunks.empty() && next != end(freeChunks);
+       ++current, ++next) {
     dbg::Check(current->startAddress_ + current->size_ <= next->startAddress_,
                "Free list overlapping chunks: \n\tChunk1: " + current->str() + " \n\tChunk2: " + next->str());
   }
+  // check the size indexes are consistent with the free chunks
+  if (policy_ == MemoryAllocatorPolicy::SizeClasses) {
+    auto indexedChunks = freeBySize_.size();
+    for (auto& sizeClass : sizeClasses_) {
+      indexedChunks += sizeClass.size();
+    }
+    dbg::Check(indexedChunks == freeChunks.size(), std::string{"Size indexes don't match the free chunks!"});
+    for (auto& elem : freeChunks) {
+      auto indexed = elem.size_ <= kNumSizeClasses ? sizeClasses_[elem.size_ - 1].count(elem.startAddress_) > 0
+                                                   : freeBySize_.count({elem.size_, elem.startAddress_}) > 0;
+      dbg::Check(indexed, "Free chunk not indexed by size: " + elem.str());
+    }
+  }
   // check all allocations have valid values
   for (auto& alloc : allocated_) {
     dbg::Check(alloc.second > 0, "Invalid allocation: " + getAllocationStr(alloc));
@@ -94,9 +144,9 @@ void MemoryManager::sanityCheck() const {
   }
 
   // check there are not collisions between allocations and free list
-  auto freePtr = begin(free_);
+  auto freePtr = begin(freeChunks);
   auto allocPtr = begin(allocated_);
-  while (freePtr != end(free_) && allocPtr != end(allocated_)) {
+  while (freePtr != end(freeChunks) && allocPtr != end(allocated_)) {
     if (freePtr->startAddress_ > allocPtr->first) {
       dbg::Check(allocPtr->first + allocPtr->second <= freePtr->startAddress_,
                  "Memory collision between allocation and free chunk. \n\tFree Chunk: " + freePtr->str() +
@@ -121,12 +171,19 @@ void MemoryManager::sanityCheck() const {
 }
 
 size_t MemoryManager::getFreeContiguousBytes() const {
+  auto blockSize = static_cast<size_t>(getBlockSize());
+  if (policy_ == MemoryAllocatorPolicy::SizeClasses) {
+    if (!freeBySize_.empty()) {
+      return blockSize * freeBySize_.rbegin()->first;
+    }
+    auto it = std::find_if(sizeClasses_.rbegin(), sizeClasses_.rend(), [](const auto& c) { return !c.empty(); });
+    return it == sizeClasses_.rend() ? 0UL : blockSize * static_cast<size_t>(sizeClasses_.rend() - it);
+  }
   if (free_.empty()) {
     return 0UL;
   }
   auto it = std::max_element(begin(free_), end(free_),
                              [](const auto& one, const auto& other) { return one.size_ < other.size_; });
-  auto blockSize = static_cast<size_t>(getBlockSize());
   auto freeChunkBlocks = static_cast<size_t>(it->size_);
   return blockSize * freeChunkBlocks;
 }
@@ -136,6 +193,11 @@ size_t MemoryManager::getTotalMemoryBytes() const {
 }
 
 size_t MemoryManager::getFreeBytes() const {
+  if (policy_ == MemoryAllocatorPolicy::SizeClasses) {
+    return std::accumulate(begin(freeByAddress_), end(freeByAddress_), 0UL,
+                           [](const auto& accumulate, const auto& e) { return accumulate + e.second; }) *
+           getBlockSize();
+  }
   return std::accumulate(begin(free_), end(free_), 0UL,
                          [](const auto& accumulate, const auto& e) { return accumulate + e.size_; }) *
          getBlockSize();
@@ -147,7 +209,70 @@ size_t MemoryManager::getAllocatedBytes() const {
          getBlockSize();
 }
 
+void MemoryManager::insertFreeChunk(FreeChunk chunk) {
+  freeByAddress_.emplace(chunk.startAddress_, chunk.size_);
+  if (chunk.size_ <= kNumSizeClasses) {
+    sizeClasses_[chunk.size_ - 1].insert(chunk.startAddress_);
+  } else {
+    freeBySize_.emplace(chunk.size_, chunk.startAddress_);
+  }
+}
+
+void MemoryManager::eraseFreeChunk(FreeChunk chunk) {
+  freeByAddress_.erase(chunk.startAddress_);
+  if (chunk.size_ <= kNumSizeClasses) {
+    sizeClasses_[chunk.size_ - 1].erase(chunk.startAddress_);
+  } else {
+    freeBySize_.erase({chunk.size_, chunk.startAddress_});
+  }
+}
+
+void MemoryManager::addChunkSizeClasses(FreeChunk chunk) {
+  // merge with next chunk
+  if (auto next = freeByAddress_.lower_bound(chunk.startAddress_);
+      next != end(freeByAddress_) && chunk.startAddress_ + chunk.size_ == next->first) {
+    auto nextChunk = FreeChunk{next->first, next->second};
+    eraseFreeChunk(nextChunk);
+    chunk.size_ += nextChunk.size_;
+  }
+  // merge with previous chunk
+  if (auto next = freeByAddress_.lower_bound(chunk.startAddress_); next != begin(freeByAddress_)) {
+    auto prev = std::prev(next);
+    if (prev->first + prev->second == chunk.startAddress_) {
+      auto prevChunk = FreeChunk{prev->first, prev->second};
+      eraseFreeChunk(prevChunk);
+      chunk.startAddress_ = prevChunk.startAddress_;
+      chunk.size_ += prevChunk.size_;
+    }
+  }
+  insertFreeChunk(chunk);
+}
+
+MemoryManager::FreeChunk MemoryManager::takeBestFit(uint32_t numBlocks) {
+  numBlocks = std::max(numBlocks, 1U);
+  // small sizes: take the lowest address from the smallest size class which fits
+  for (auto i = numBlocks - 1; i < kNumSizeClasses; ++i) {
+    if (!sizeClasses_[i].empty()) {
+      auto chunk = FreeChunk{*sizeClasses_[i].begin(), i + 1};
+      eraseFreeChunk(chunk);
+      return chunk;
+    }
+  }
+  // big sizes: smallest chunk which fits, lowest address on ties
+  auto it = freeBySize_.lower_bound({numBlocks, 0U});
+  if (it == end(freeBySize_)) {
+    throw Exception("Out of memory");
+  }
+  auto chunk = FreeChunk{it->second, it->first};
+  eraseFreeChunk(chunk);
+  return chunk;
+}
+
 void MemoryManager::addChunk(FreeChunk chunk) {
+  if (policy_ == MemoryAllocatorPolicy::SizeClasses) {
+    addChunkSizeClasses(chunk);
+    return;
+  }
   if (free_.empty()) {
     free_.emplace_back(chunk);
     return;
@@ -226,6 +351,10 @@ void MemoryManager::checkOperation(const std::byte* address, size_t size) const
   RT_VLOG(MID) << "Check passed Mem operation @:" << std::hex << address << " size: " << std::dec << size;
 }
 
+bool MemoryManager::isAllocation(const std::byte* ptr) const {
+  return allocated_.find(compressPointer(ptr)) != end(allocated_);
+}
+
 void MemoryManager::setDebugMode(bool enabled) {
   debugMode_ = enabled;
 }
@@ -258,31 +387,51 @@ std::byte* MemoryManager::malloc(size_t size, uint32_t alignment) {
 
   auto totalBlocks = countBlocks + extraBlocks;
 
-  // find a suitable chunk, if not return nullptr
-  auto it =
-    std::find_if(begin(free_), end(free_), [totalBlocks](const auto& elem) { return elem.size_ >= totalBlocks; });
-  if (it == end(free_)) {
-    throw Exception("Out of memory");
-  }
+  auto getMissAlignment = [this, alignment, blockSize](uint32_t address) {
+    auto tmp = reinterpret_cast<uint64_t>(uncompressPointer(address));
+    auto extraBytes = (tmp % alignment == 0) ? 0 : static_cast<uint32_t>(alignment - tmp % alignment);
+    return extraBytes / blockSize;
+  };
 
-  // calculate the alignment in blocks
-  auto addr = it->startAddress_;
-  auto tmp = reinterpret_cast<uint64_t>(uncompressPointer(addr));
-  auto extraBytes = (tmp % alignment == 0) ? 0 : static_cast<uint32_t>(alignment - tmp % alignment);
+  uint32_t addr;
+  uint32_t missAlignment;
+  if (policy_ == MemoryAllocatorPolicy::SizeClasses) {
+    auto chunk = takeBestFit(totalBlocks);
+    addr = chunk.startAddress_;
+    missAlignment = getMissAlignment(addr);
+    // the chunk was already merged with its neighbours, so the leftovers can be indexed directly
+    auto usedBlocks = countBlocks + missAlignment;
+    if (chunk.size_ > usedBlocks) {
+      insertFreeChunk(FreeChunk{addr + usedBlocks, chunk.size_ - usedBlocks});
+    }
+    if (missAlignment > 0) {
+      insertFreeChunk(FreeChunk{addr, missAlignment});
+    }
+  } else {
+    // find a suitable chunk, if not return nullptr
+    auto it =
+      std::find_if(begin(free_), end(free_), [totalBlocks](const auto& elem) { return elem.size_ >= totalBlocks; });
+    if (it == end(free_)) {
+      throw Exception("Out of memory");
+    }
 
-  // fullfill the requested alignment
-  auto missAlignment = extraBytes / blockSize;
+    // calculate the alignment in blocks
+    addr = it->startAddress_;
 
-  // take countBlocks from freeChunk
-  it->startAddress_ += countBlocks + missAlignment;
-  it->size_ -= countBlocks + missAlignment;
-  if (it->empty()) { // we exhausted all free space, so remove the chunk
-    free_.erase(it);
-  }
+    // fullfill the requested alignment
+    missAlignment = getMissAlignment(addr);
 
-  // if we needed extra blocks for alignment, add a freeChunk with those extra blocks (which are actually not used)
-  if (missAlignment > 0) {
-    addChunk(FreeChunk{addr, missAlignment});
+    // take countBlocks from freeChunk
+    it->startAddress_ += countBlocks + missAlignment;
+    it->size_ -= countBlocks + missAlignment;
+    if (it->empty()) { // we exhausted all free space, so remove the chunk
+      free_.erase(it);
+    }
+
+    // if we needed extra blocks for alignment, add a freeChunk with those extra blocks (which are actually not used)
+    if (missAlignment > 0) {
+      addChunk(FreeChunk{addr, missAlignment});
+    }
   }
   // bookkeep the allocation and return pointer
   addr += missAlignment;
@@ -297,6 +446,82 @@ std::byte* MemoryManager::malloc(size_t size, uint32_t alignment) {
   return uncompressPointer(addr);
 }
 
+std::vector<MemoryManager::Relocation>
+MemoryManager::getCompaction(const std::map<const std::byte*, uint32_t>& movable) const {
+  std::vector<Relocation> result;
+  auto blockSize = getBlockSize();
+  auto cursor = 0U;
+  for (auto& [start, numBlocks] : allocated_) {
+    if (auto it = movable.find(uncompressPointer(start)); it != end(movable) && cursor < start) {
+      auto alignment = std::max(it->second, blockSize);
+      auto address = reinterpret_cast<uint64_t>(uncompressPointer(cursor));
+      auto target = cursor + static_cast<uint32_t>((alignment - address % alignment) % alignment / blockSize);
+      if (target < start) {
+        result.emplace_back(Relocation{uncompressPointer(start), uncompressPointer(target),
+                                       static_cast<size_t>(numBlocks) << blockSizeLog2_});
+        cursor = target + numBlocks;
+        continue;
+      }
+    }
+    cursor = start + numBlocks;
+  }
+  return result;
+}
+
+void MemoryManager::relocate(const std::byte* ptr, const std::byte* newPtr) {
+  RT_VLOG(LOW) << "Relocating allocation at address: " << ptr << " to: " << newPtr;
+  auto it = allocated_.find(compressPointer(ptr));
+  if (it == allocated_.end()) {
+    throw Exception("Ptr not allocated previously");
+  }
+  auto numBlocks = it->second;
+  addChunk(FreeChunk{it->first, numBlocks});
+  allocated_.erase(it);
+  auto newAddress = compressPointer(newPtr);
+  takeRange(FreeChunk{newAddress, numBlocks});
+  allocated_.insert({newAddress, numBlocks});
+  if (debugMode_) {
+    sanityCheck();
+  }
+}
+
+void MemoryManager::takeRange(FreeChunk range) {
+  auto rangeEnd = range.startAddress_ + range.size_;
+  if (policy_ == MemoryAllocatorPolicy::SizeClasses) {
+    auto next = freeByAddress_.upper_bound(range.startAddress_);
+    if (next == begin(freeByAddress_) || std::prev(next)->first + std::prev(next)->second < rangeEnd) {
+      throw Exception("Range is not free: " + range.str());
+    }
+    auto chunk = FreeChunk{std::prev(next)->first, std::prev(next)->second};
+    auto chunkEnd = chunk.startAddress_ + chunk.size_;
+    eraseFreeChunk(chunk);
+    if (range.startAddress_ > chunk.startAddress_) {
+      insertFreeChunk(FreeChunk{chunk.startAddress_, range.startAddress_ - chunk.startAddress_});
+    }
+    if (chunkEnd > rangeEnd) {
+      insertFreeChunk(FreeChunk{rangeEnd, chunkEnd - rangeEnd});
+    }
+    return;
+  }
+  auto it = std::upper_bound(begin(free_), end(free_), range);
+  if (it == begin(free_) || (it - 1)->startAddress_ + (it - 1)->size_ < rangeEnd) {
+    throw Exception("Range is not free: " + range.str());
+  }
+  --it;
+  auto chunkEnd = it->startAddress_ + it->size_;
+  if (range.startAddress_ > it->startAddress_) {
+    it->size_ = range.startAddress_ - it->startAddress_;
+    if (chunkEnd > rangeEnd) {
+      free_.emplace(it + 1, FreeChunk{rangeEnd, chunkEnd - rangeEnd});
+    }
+  } else if (chunkEnd > rangeEnd) {
+    it->startAddress_ = rangeEnd;
+    it->size_ = chunkEnd - rangeEnd;
+  } else {
+    free_.erase(it);
+  }
+}
+
 uint32_t MemoryManager::getBlockSize() const {
   return 1U << blockSizeLog2_;
 }
@@ -7,17 +7,22 @@
 
 #include "Utils.h"
 #include "runtime/Types.h"
+#include <array>
 #include <cassert>
 #include <cstddef>
 #include <limits>
 #include <map>
+#include <set>
 #include <vector>
 namespace rt {
 constexpr auto kBlockSize = 4096U;
+// number of segregated free lists used by MemoryAllocatorPolicy::SizeClasses; list i holds chunks of i+1 blocks
+constexpr auto kNumSizeClasses = 16U;
 
 class MemoryManager {
 public:
-  explicit MemoryManager(uint64_t dramBaseAddr, size_t totalMemoryBytes, uint32_t blockSize = kBlockSize);
+  explicit MemoryManager(uint64_t dramBaseAddr, size_t totalMemoryBytes, uint32_t blockSize = kBlockSize,
+                         MemoryAllocatorPolicy policy = MemoryAllocatorPolicy::FirstFit);
 
   std::byte* malloc(size_t size, uint32_t alignment);
   void free(std::byte* ptr);
@@ -39,8 +44,23 @@ public:
 
   size_t getNumFreeChunks() const;
 
+  MemoryAllocatorPolicy getPolicy() const;
+
+  struct FragmentationStats {
+    size_t freeBytes_;
+    size_t largestFreeChunkBytes_;
+    size_t numFreeChunks_;
+    // 0 when all free memory is contiguous, tends to 1 when free memory is split in many small chunks
+    double fragmentation_;
+  };
+
+  FragmentationStats getFragmentationStats() const;
+
   void setDebugMode(bool enabled);
 
+  // returns true if ptr is the start address of a current allocation
+  bool isAllocation(const std::byte* ptr) const;
+
   // checks if the operation is valid knowing current allocations
   void checkOperation(const std::byte* address, size_t size) const;
 
@@ -51,6 +71,20 @@ public:
 
   std::vector<AllocationInfo> getAllocations() const;
 
+  struct Relocation {
+    std::byte* from_;
+    std::byte* to_;
+    size_t size_;
+  };
+
+  // returns the moves compacting the movable allocations (their address and alignment): each one slides down to the
+  // lowest aligned address after the previous allocation, once moved. The others stay where they are. The moves must
+  // be applied in order, the ranges of a move can overlap
+  std::vector<Relocation> getCompaction(const std::map<const std::byte*, uint32_t>& movable) const;
+
+  // moves an allocation to newPtr, which must be free once the allocation is released
+  void relocate(const std::byte* ptr, const std::byte* newPtr);
+
   uint32_t compressPointer(const std::byte* ptr, size_t alignedTo) const {
     auto tmp = reinterpret_cast<uint64_t>(ptr);
     tmp -= dramBaseAddr_;
@@ -90,9 +124,26 @@ private:
   }
 
   void addChunk(FreeChunk chunk);
+  // removes a range from the free chunks, it must be fully contained in one of them
+  void takeRange(FreeChunk range);
+
+  // SizeClasses policy helpers. insert/erase only update the indexes, addChunkSizeClasses also merges neighbours
+  void insertFreeChunk(FreeChunk chunk);
+  void eraseFreeChunk(FreeChunk chunk);
+  void addChunkSizeClasses(FreeChunk chunk);
+  FreeChunk takeBestFit(uint32_t numBlocks);
+
+  // returns the free chunks sorted by address, regardless of the policy
+  std::vector<FreeChunk> getFreeChunks() const;
 
   std::map<uint32_t, uint32_t> allocated_;
+  // FirstFit policy free list, sorted by address
   std::vector<FreeChunk> free_;
+  // SizeClasses policy free chunks: by address (start -> size) to merge on free, and indexed by size to do the lookup
+  std::map<uint32_t, uint32_t> freeByAddress_;
+  std::array<std::set<uint32_t>, kNumSizeClasses> sizeClasses_;
+  std::set<std::pair<uint32_t, uint32_t>> freeBySize_; // (size, start) of chunks bigger than kNumSizeClasses blocks
+  MemoryAllocatorPolicy policy_;
   uint64_t dramBaseAddr_;
   size_t totalMemoryBytes_;
   uint32_t blockSizeLog2_; // size of the minimum block in log2
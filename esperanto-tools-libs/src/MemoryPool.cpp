@@ -0,0 +1,60 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) 2025 Ainekko, Co.
+ * SPDX-License-Identifier: Apache-2.0
+ *-------------------------------------------------------------------------*/
+
+#include "Utils.h"
+#include "runtime/IRuntime.h"
+#include <algorithm>
+#include <string>
+
+using namespace rt;
+
+MemoryPool::MemoryPool(IRuntime& runtime, DeviceId device, std::byte* base, size_t size)
+  : runtime_(runtime)
+  , device_(device)
+  , base_(base)
+  , size_(size) {
+  RT_VLOG(LOW) << "Created memory pool at: " << std::hex << base_ << " size: " << std::dec << size_;
+}
+
+MemoryPool::~MemoryPool() {
+  try {
+    runtime_.freeDevice(device_, base_);
+  } catch (const Exception& e) {
+    RT_LOG(WARNING) << "Couldn't release memory pool at: " << std::hex << base_ << ". Error: " << e.what();
+  }
+}
+
+std::byte* MemoryPool::allocate(size_t size, uint32_t alignment) {
+  auto address = reinterpret_cast<uint64_t>(base_) + used_;
+  auto padding = (address % alignment == 0) ? 0UL : alignment - address % alignment;
+  if (used_ + padding + size > size_) {
+    throw Exception("Memory pool out of memory. Requested: " + std::to_string(size) +
+                    " bytes, available: " + std::to_string(size_ - std::min(size_, used_ + padding)) + " bytes");
+  }
+  auto result = base_ + used_ + padding;
+  used_ += padding + size;
+  peakUsed_ = std::max(peakUsed_, used_);
+  return result;
+}
+
+void MemoryPool::reset() {
+  used_ = 0;
+}
+
+DeviceId MemoryPool::getDevice() const {
+  return device_;
+}
+
+size_t MemoryPool::getSize() const {
+  return size_;
+}
+
+size_t MemoryPool::getUsedBytes() const {
+  return used_;
+}
+
+size_t MemoryPool::getPeakUsedBytes() const {
+  return peakUsed_;
+}
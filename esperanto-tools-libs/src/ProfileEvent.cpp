@@ -55,6 +55,7 @@ std::string getString(Class cls) {
     STR_PROFILING_CLASS(SyncTime)
     STR_PROFILING_CLASS(IdentifyThread)
     STR_PROFILING_CLASS(MemoryStats)
+    STR_PROFILING_CLASS(CommandStats)
 
   default:
     RT_LOG(WARNING) << "No stringized unknown profiling::Class. Consider adding it to " __FILE__;
@@ -126,6 +127,7 @@ Class class_from_string(const std::string& str) {
     s_map[getString(Class::SyncTime)] = Class::SyncTime;
     s_map[getString(Class::IdentifyThread)] = Class::IdentifyThread;
     s_map[getString(Class::MemoryStats)] = Class::MemoryStats;
+    s_map[getString(Class::CommandStats)] = Class::CommandStats;
 
     assert(s_map.size() == static_cast<int>(Class::COUNT));
   });
@@ -184,9 +186,15 @@ ProfileEvent::TimePoint ProfileEvent::getTimeStamp() const {
   return timeStamp_;
 }
 std::string ProfileEvent::getThreadId() const {
-  return threadId_;
+  // formatted on demand, events are created in hot paths but only stringized when serialized
+  if (numericThreadId_ == std::thread::id{}) {
+    return {};
+  }
+  std::stringstream ss;
+  ss << numericThreadId_;
+  return ss.str();
 }
-ProfileEvent::ExtraMetadata ProfileEvent::getExtras() const {
+const ProfileEvent::ExtraMetadata& ProfileEvent::getExtras() const {
   return extra_;
 }
 std::thread::id ProfileEvent::getNumericThreadId() const {
@@ -281,10 +289,6 @@ void ProfileEvent::setTimeStamp(TimePoint t) {
 }
 void ProfileEvent::setThreadId(std::thread::id id) {
   numericThreadId_ = id;
-
-  std::stringstream ss;
-  ss << id;
-  threadId_ = ss.str();
 }
 void ProfileEvent::setExtras(ExtraMetadata extras) {
   extra_ = std::move(extras);
@@ -0,0 +1,155 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) 2025 Ainekko, Co.
+ * SPDX-License-Identifier: Apache-2.0
+ *-------------------------------------------------------------------------*/
+
+#include "ProfileSampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string>
+
+namespace rt::profiling {
+
+namespace {
+size_t getBucket(uint64_t value) {
+  return value == 0 ? 0 : static_cast<size_t>(64 - __builtin_clzll(value));
+}
+uint64_t getBucketBound(size_t bucket) {
+  if (bucket == 0) {
+    return 0;
+  }
+  return bucket >= 64 ? std::numeric_limits<uint64_t>::max() : (uint64_t{1} << bucket) - 1;
+}
+} // namespace
+
+void ProfileSampler::Histogram::add(uint64_t value) {
+  ++buckets_[getBucket(value)];
+  min_ = count_ == 0 ? value : std::min(min_, value);
+  max_ = std::max(max_, value);
+  sum_ += value;
+  ++count_;
+}
+
+uint64_t ProfileSampler::Histogram::getPercentile(double percentile) const {
+  auto target = static_cast<uint64_t>(std::ceil(percentile * static_cast<double>(count_)));
+  uint64_t accumulated = 0;
+  for (size_t i = 0; i < buckets_.size(); ++i) {
+    accumulated += buckets_[i];
+    if (accumulated >= target && accumulated > 0) {
+      return std::min(getBucketBound(i), max_);
+    }
+  }
+  return max_;
+}
+
+void ProfileSampler::Histogram::addTo(ProfileEvent::ExtraMetadata& extras, std::string_view name) const {
+  auto prefix = std::string{name} + ".";
+  extras[prefix + "count"] = count_;
+  extras[prefix + "sum"] = sum_;
+  extras[prefix + "min"] = min_;
+  extras[prefix + "max"] = max_;
+  extras[prefix + "p50"] = getPercentile(0.5);
+  extras[prefix + "p99"] = getPercentile(0.99);
+  for (size_t i = 0; i < buckets_.size(); ++i) {
+    if (buckets_[i] != 0) {
+      extras[prefix + "le_" + std::to_string(getBucketBound(i))] = buckets_[i];
+    }
+  }
+}
+
+ProfileSampler::ProfileSampler(const SamplingOptions& options, TimePoint now)
+  : options_(options)
+  , lastFlush_(now) {
+}
+
+bool ProfileSampler::sample(Class cls, TimePoint timeStamp) {
+  auto idx = static_cast<size_t>(cls);
+  auto everyN = options_.everyN_[idx];
+  if (everyN == 0) {
+    return false;
+  }
+  auto& state = classes_[idx];
+  if (state.seen_++ % everyN != 0) {
+    return false;
+  }
+  if (options_.minInterval_.count() > 0 && state.lastForwarded_ &&
+      timeStamp - *state.lastForwarded_ < options_.minInterval_) {
+    return false;
+  }
+  state.lastForwarded_ = timeStamp;
+  return true;
+}
+
+void ProfileSampler::aggregate(const ProfileEvent& event) {
+  auto eventId = event.getEvent();
+  if (options_.statsPeriod_.count() == 0 || !eventId) {
+    return;
+  }
+  auto cls = event.getClass();
+  auto isApiCall = cls == Class::KernelLaunch || cls == Class::MemcpyHostToDevice || cls == Class::MemcpyDeviceToHost;
+  if (!isApiCall && cls != Class::ResponseReceived) {
+    return;
+  }
+
+  // the api call event is recorded when the call returns, so the response can come before or after it. Responses
+  // without api call (i.e. code loads) stay pending till their event id is reused, so pending_ is bounded by the
+  // number of event ids
+  auto& command = pending_[*eventId];
+  if (isApiCall) {
+    command.start_ = event.getTimeStamp();
+    command.isLaunch_ = cls == Class::KernelLaunch;
+    command.size_ = cls == Class::KernelLaunch ? std::nullopt : event.getSize();
+    if (command.end_ && *command.end_ < *command.start_) {
+      // response of an older command with the same event id
+      command.end_.reset();
+    }
+  } else {
+    command.end_ = event.getTimeStamp();
+  }
+  if (command.start_ && command.end_) {
+    complete(command);
+    pending_.erase(*eventId);
+  }
+}
+
+void ProfileSampler::complete(const PendingCommand& command) {
+  auto latency = std::chrono::duration_cast<std::chrono::microseconds>(*command.end_ - *command.start_).count();
+  auto latencyUs = static_cast<uint64_t>(std::max<int64_t>(latency, 0));
+  if (command.isLaunch_) {
+    launchLatency_.add(latencyUs);
+  } else if (command.size_) {
+    memcpySize_.add(*command.size_);
+    // bytes per microsecond are MB/s
+    memcpyBandwidth_.add(*command.size_ / std::max<uint64_t>(latencyUs, 1));
+  }
+}
+
+std::optional<ProfileEvent> ProfileSampler::flush(TimePoint now, bool force) {
+  if (options_.statsPeriod_.count() == 0 || (!force && now - lastFlush_ < options_.statsPeriod_)) {
+    return std::nullopt;
+  }
+  auto period = now - lastFlush_;
+  lastFlush_ = now;
+  if (launchLatency_.count_ == 0 && memcpySize_.count_ == 0) {
+    return std::nullopt;
+  }
+
+  ProfileEvent::ExtraMetadata extras;
+  launchLatency_.addTo(extras, kLaunchLatency);
+  memcpySize_.addTo(extras, kMemcpySize);
+  memcpyBandwidth_.addTo(extras, kMemcpyBandwidth);
+  launchLatency_ = Histogram{};
+  memcpySize_ = Histogram{};
+  memcpyBandwidth_ = Histogram{};
+
+  ProfileEvent evt(Type::Counter, Class::CommandStats);
+  evt.setTimeStamp(now);
+  evt.setThreadId();
+  evt.setExtras(std::move(extras));
+  evt.setDuration(period);
+  return evt;
+}
+
+} // namespace rt::profiling
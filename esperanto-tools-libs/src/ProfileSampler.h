@@ -0,0 +1,92 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) 2025 Ainekko, Co.
+ * SPDX-License-Identifier: Apache-2.0
+ *-------------------------------------------------------------------------*/
+
+#pragma once
+
+#include "runtime/IProfileEvent.h"
+
+#include <array>
+#include <chrono>
+#include <optional>
+#include <unordered_map>
+
+namespace rt::profiling {
+
+struct SamplingOptions {
+  SamplingOptions() {
+    everyN_.fill(1);
+  }
+  // forwards one event out of each everyN_ of the class; 1 forwards all of them and 0 none
+  std::array<uint32_t, static_cast<size_t>(Class::COUNT)> everyN_;
+  // forwards at most one event of each class per interval; zero disables the time based sampling
+  std::chrono::microseconds minInterval_{0};
+  // period of the CommandStats counter events; zero disables them
+  std::chrono::milliseconds statsPeriod_{0};
+};
+
+// Decides which profiling events of a client are forwarded and aggregates its commands latencies and memcpy sizes and
+// bandwidths, so they can be emitted periodically as a single CommandStats counter event. Not thread safe.
+class ProfileSampler {
+public:
+  using Clock = ProfileEvent::Clock;
+  using TimePoint = ProfileEvent::TimePoint;
+
+  explicit ProfileSampler(const SamplingOptions& options, TimePoint now = Clock::now());
+
+  // returns true if an event of the given class recorded at the given time has to be forwarded
+  bool sample(Class cls, TimePoint timeStamp);
+
+  // takes the KernelLaunch, Memcpy* and ResponseReceived events into the stats, ignores the rest
+  void aggregate(const ProfileEvent& event);
+
+  // returns the stats gathered since the last one, once per stats period or whenever force is set. Empty if the stats
+  // are disabled, the period hasn't elapsed or no command completed meanwhile
+  std::optional<ProfileEvent> flush(TimePoint now = Clock::now(), bool force = false);
+
+  static constexpr std::string_view kLaunchLatency = "launch_latency_us";
+  static constexpr std::string_view kMemcpySize = "memcpy_size_bytes";
+  static constexpr std::string_view kMemcpyBandwidth = "memcpy_bandwidth_mbps";
+
+  // log2 buckets: each value goes to the bucket of its bit width, so bucket 0 only holds zeroes
+  struct Histogram {
+    void add(uint64_t value);
+    // upper bound of the bucket holding the given percentile
+    uint64_t getPercentile(double percentile) const;
+    // adds <name>.count, .sum, .min, .max, .p50, .p99 and a <name>.le_<bound> entry per non empty bucket
+    void addTo(ProfileEvent::ExtraMetadata& extras, std::string_view name) const;
+
+    std::array<uint64_t, 65> buckets_{};
+    uint64_t count_ = 0;
+    uint64_t sum_ = 0;
+    uint64_t min_ = 0;
+    uint64_t max_ = 0;
+  };
+
+private:
+  // a launch or memcpy waiting for the other half of its events, the api call or its response
+  struct PendingCommand {
+    std::optional<TimePoint> start_;
+    std::optional<TimePoint> end_;
+    std::optional<uint64_t> size_;
+    bool isLaunch_ = false;
+  };
+
+  void complete(const PendingCommand& command);
+
+  struct ClassState {
+    uint64_t seen_ = 0;
+    std::optional<TimePoint> lastForwarded_;
+  };
+
+  SamplingOptions options_;
+  std::array<ClassState, static_cast<size_t>(Class::COUNT)> classes_;
+  std::unordered_map<EventId, PendingCommand> pending_;
+  Histogram launchLatency_;
+  Histogram memcpySize_;
+  Histogram memcpyBandwidth_;
+  TimePoint lastFlush_;
+};
+
+} // namespace rt::profiling
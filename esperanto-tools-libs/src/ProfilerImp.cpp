@@ -7,61 +7,319 @@
 
 #include "Utils.h"
 
+#include <algorithm>
+#include <array>
 #include <stdexcept>
+#include <string_view>
+#include <unordered_map>
 
 namespace rt::profiling {
 
+// Compact representation of a ProfileEvent. The extras are stored as (name, variant index, value) triplets; events
+// with extras which don't fit in a uint64_t (or unknown names, or too many of them) are kept as a heap copy instead.
+struct ProfilerImp::EventRecord {
+  static constexpr size_t kMaxExtras = 8;
+
+  ProfileEvent::TimePoint timeStamp_;
+  std::thread::id threadId_;
+  Type type_;
+  Class class_;
+  uint8_t numExtras_ = 0;
+  std::array<uint8_t, kMaxExtras> names_;
+  std::array<uint8_t, kMaxExtras> kinds_;
+  std::array<uint64_t, kMaxExtras> values_;
+  std::unique_ptr<ProfileEvent> event_;
+};
+
+// Single producer (the recording thread) single consumer (the io thread) ring of event records
+class ProfilerImp::EventRing {
+public:
+  // returns false if the ring is full, in such case the record is not moved
+  bool push(EventRecord& record) {
+    auto head = head_.load(std::memory_order_relaxed);
+    if (head - tail_.load(std::memory_order_acquire) == kSize) {
+      return false;
+    }
+    slots_[head & kMask] = std::move(record);
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  template <typename Func> size_t drain(Func&& func) {
+    auto tail = tail_.load(std::memory_order_relaxed);
+    auto head = head_.load(std::memory_order_acquire);
+    for (auto i = tail; i != head; ++i) {
+      auto& record = slots_[i & kMask];
+      func(record);
+      record.event_.reset();
+      tail_.store(i + 1, std::memory_order_release);
+    }
+    return head - tail;
+  }
+
+  bool empty() const {
+    return !overflowing_.load(std::memory_order_acquire) &&
+           head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+  }
+
+  // events which didn't fit in the ring. While there are some, the following events go here too
+  std::mutex overflowMutex_;
+  std::queue<ProfileEvent> overflow_;     // guarded by overflowMutex_
+  std::atomic<bool> overflowing_ = false; // only set by the recording thread, only cleared by the io thread
+
+  std::atomic<bool> abandoned_ = false; // the recording thread has exited
+  std::atomic<bool> closed_ = false;    // the profiler has been destroyed
+  bool identified_ = false;             // only accessed by the recording thread
+
+private:
+  static constexpr size_t kSize = 1024;
+  static constexpr size_t kMask = kSize - 1;
+  static_assert((kSize & kMask) == 0, "Ring size must be a power of two");
+
+  std::array<EventRecord, kSize> slots_;
+  alignas(64) std::atomic<size_t> head_ = 0;
+  alignas(64) std::atomic<size_t> tail_ = 0;
+};
+
+namespace {
+constexpr auto kIdleWaitTime = std::chrono::milliseconds(1);
+
+constexpr std::array<std::string_view, 23> kExtraNames = {ProfileEvent::kVersion,
+                                                          ProfileEvent::kDuration,
+                                                          ProfileEvent::kEventId,
+                                                          ProfileEvent::kParentId,
+                                                          ProfileEvent::kStreamId,
+                                                          ProfileEvent::kDeviceId,
+                                                          ProfileEvent::kKernelId,
+                                                          ProfileEvent::kResponseType,
+                                                          ProfileEvent::kLoadAddr,
+                                                          ProfileEvent::kDeviceCmdStartTs,
+                                                          ProfileEvent::kDeviceCmdWaitDur,
+                                                          ProfileEvent::kDeviceCmdExecDur,
+                                                          ProfileEvent::kTimePointSystem,
+                                                          ProfileEvent::kServerPid,
+                                                          ProfileEvent::kBarrier,
+                                                          ProfileEvent::kAddress,
+                                                          ProfileEvent::kAddressSrc,
+                                                          ProfileEvent::kAddressDst,
+                                                          ProfileEvent::kSize,
+                                                          ProfileEvent::kAlignment,
+                                                          ProfileEvent::kMemoryStatsAllocatedMem,
+                                                          ProfileEvent::kMemoryStatsFreeMem,
+                                                          ProfileEvent::kMemoryStatsMaxContiguousFreeMem};
+
+std::optional<uint8_t> getExtraNameIndex(std::string_view name) {
+  static const auto indexes = [] {
+    auto res = std::unordered_map<std::string_view, uint8_t>{};
+    for (auto i = 0U; i < kExtraNames.size(); ++i) {
+      res.emplace(kExtraNames[i], static_cast<uint8_t>(i));
+    }
+    return res;
+  }();
+  if (auto it = indexes.find(name); it != end(indexes)) {
+    return it->second;
+  }
+  return std::nullopt;
+}
+
+template <typename T> constexpr bool isEncodable() {
+  return std::is_enum_v<T> || std::is_integral_v<T> || std::is_same_v<T, ProfileEvent::Duration> ||
+         std::is_same_v<T, ProfileEvent::SystemTimePoint>;
+}
+
+std::optional<uint64_t> encodeValue(const ProfileEvent::ExtraValues& value) {
+  return std::visit(
+    [](const auto& v) -> std::optional<uint64_t> {
+      using T = std::decay_t<decltype(v)>;
+      if constexpr (std::is_enum_v<T>) {
+        return static_cast<uint64_t>(static_cast<std::underlying_type_t<T>>(v));
+      } else if constexpr (std::is_integral_v<T>) {
+        return static_cast<uint64_t>(v);
+      } else if constexpr (std::is_same_v<T, ProfileEvent::Duration>) {
+        return static_cast<uint64_t>(v.count());
+      } else if constexpr (std::is_same_v<T, ProfileEvent::SystemTimePoint>) {
+        return static_cast<uint64_t>(v.time_since_epoch().count());
+      } else {
+        return std::nullopt;
+      }
+    },
+    value);
+}
+
+template <typename T> T decodeValue(uint64_t value) {
+  if constexpr (std::is_enum_v<T>) {
+    return static_cast<T>(static_cast<std::underlying_type_t<T>>(value));
+  } else if constexpr (std::is_integral_v<T>) {
+    return static_cast<T>(value);
+  } else if constexpr (std::is_same_v<T, ProfileEvent::Duration>) {
+    return ProfileEvent::Duration(static_cast<ProfileEvent::Duration::rep>(value));
+  } else {
+    static_assert(std::is_same_v<T, ProfileEvent::SystemTimePoint>);
+    return ProfileEvent::SystemTimePoint(ProfileEvent::SystemClock::duration(
+      static_cast<ProfileEvent::SystemClock::duration::rep>(value)));
+  }
+}
+
+template <size_t I = 0> ProfileEvent::ExtraValues decodeValue(size_t kind, uint64_t value) {
+  if constexpr (I < std::variant_size_v<ProfileEvent::ExtraValues>) {
+    using T = std::variant_alternative_t<I, ProfileEvent::ExtraValues>;
+    if constexpr (isEncodable<T>()) {
+      if (kind == I) {
+        return ProfileEvent::ExtraValues{std::in_place_index<I>, decodeValue<T>(value)};
+      }
+    }
+    return decodeValue<I + 1>(kind, value);
+  } else {
+    throw Exception("Invalid profile event record extra kind: " + std::to_string(kind));
+  }
+}
+
+bool encodeExtras(const ProfileEvent::ExtraMetadata& extras, ProfilerImp::EventRecord& record) {
+  if (extras.size() > ProfilerImp::EventRecord::kMaxExtras) {
+    return false;
+  }
+  for (const auto& [name, value] : extras) {
+    auto index = getExtraNameIndex(name);
+    auto encoded = index ? encodeValue(value) : std::nullopt;
+    if (!encoded) {
+      return false;
+    }
+    auto i = record.numExtras_++;
+    record.names_[i] = *index;
+    record.kinds_[i] = static_cast<uint8_t>(value.index());
+    record.values_[i] = *encoded;
+  }
+  return true;
+}
+
+ProfilerImp::EventRecord encode(const ProfileEvent& event) {
+  auto record = ProfilerImp::EventRecord{};
+  record.timeStamp_ = event.getTimeStamp();
+  record.threadId_ = event.getNumericThreadId();
+  record.type_ = event.getType();
+  record.class_ = event.getClass();
+  if (!encodeExtras(event.getExtras(), record)) {
+    record.event_ = std::make_unique<ProfileEvent>(event);
+  }
+  return record;
+}
+
+ProfileEvent decode(ProfilerImp::EventRecord& record) {
+  if (record.event_) {
+    return std::move(*record.event_);
+  }
+  ProfileEvent event;
+  event.setType(record.type_);
+  event.setClass(record.class_);
+  event.setTimeStamp(record.timeStamp_);
+  event.setThreadId(record.threadId_);
+  auto extras = ProfileEvent::ExtraMetadata{};
+  for (auto i = 0U; i < record.numExtras_; ++i) {
+    extras.emplace(kExtraNames[record.names_[i]], decodeValue(record.kinds_[i], record.values_[i]));
+  }
+  event.setExtras(std::move(extras));
+  return event;
+}
+
+// rings of the current thread, one per profiler instance it has recorded to
+struct ThreadRing {
+  ThreadRing(uint64_t profilerId, std::shared_ptr<ProfilerImp::EventRing> ring)
+    : profilerId_(profilerId)
+    , ring_(std::move(ring)) {
+  }
+  ThreadRing(ThreadRing&&) = default;
+  ThreadRing& operator=(ThreadRing&&) = default;
+  ~ThreadRing() {
+    if (ring_) {
+      ring_->abandoned_ = true;
+    }
+  }
+  uint64_t profilerId_;
+  std::shared_ptr<ProfilerImp::EventRing> ring_;
+};
+thread_local std::vector<ThreadRing> threadRings;
+
+std::atomic<uint64_t> nextProfilerId = 0;
+} // namespace
+
+ProfilerImp::ProfilerImp()
+  : id_(nextProfilerId++) {
+}
+
 // IProfiler interface
 void ProfilerImp::start(std::ostream& outputStream, OutputType outputType) {
   if (recording_) {
     throw Exception("Profiler was already started");
   }
+  {
+    SpinLock lock{mutex_};
+    events_ = {};
+    ProfileEvent evt(Type::Instant, Class::StartProfiling);
+    evt.setExtras({{"version", kCurrentVersion}});
+    events_.emplace(std::move(evt));
+    while (!delayedEvents_.empty()) {
+      events_.emplace(std::move(delayedEvents_.front()));
+      delayedEvents_.pop();
+    }
+  }
   recording_ = true;
   ioThread_ = std::thread(std::bind(&ProfilerImp::ioThread, this, outputType, &outputStream));
-  ProfileEvent evt(Type::Instant, Class::StartProfiling);
-  evt.setExtras({{"version", kCurrentVersion}});
-  record(std::move(evt));
-
-  SpinLock lock{mutex_};
-  while (!delayedEvents_.empty()) {
-    auto& event = delayedEvents_.front();
-    events_.emplace(std::move(event));
-    delayedEvents_.pop();
-  }
 }
 
 void ProfilerImp::stop() {
   if (recording_) {
-    ProfileEvent evt(Type::Instant, Class::EndProfiling);
-    record(std::move(evt));
+    {
+      SpinLock lock{mutex_};
+      endEvent_.emplace(Type::Instant, Class::EndProfiling);
+    }
     recording_ = false;
     cv_.notify_one();
     ioThread_.join();
   }
 }
 
-void ProfilerImp::record(const ProfileEvent& event) {
-  if (!recording_) {
-    return;
+ProfilerImp::EventRing& ProfilerImp::getThreadRing() {
+  for (auto& threadRing : threadRings) {
+    if (threadRing.profilerId_ == id_) {
+      return *threadRing.ring_;
+    }
   }
-
-  auto identifyThreadEvent = identifyThread();
-
-  bool wasEmpty;
+  // first event of this thread on this profiler, get rid of the rings of the profilers already destroyed
+  threadRings.erase(std::remove_if(begin(threadRings), end(threadRings),
+                                   [](const auto& threadRing) { return threadRing.ring_->closed_.load(); }),
+                    end(threadRings));
+  auto ring = std::make_shared<EventRing>();
   {
-    SpinLock lock{mutex_};
-    wasEmpty = events_.empty();
-
-    events_.push(event);
+    SpinLock lock{ringsMutex_};
+    rings_.emplace_back(ring);
+  }
+  return *threadRings.emplace_back(id_, std::move(ring)).ring_;
+}
 
-    if (identifyThreadEvent.has_value()) {
-      events_.emplace(std::move(identifyThreadEvent.value()));
-    }
+void ProfilerImp::push(EventRing& ring, EventRecord& record) {
+  if (ring.overflowing_.load(std::memory_order_acquire) || !ring.push(record)) {
+    // the io thread is falling behind, don't drop the event. It can't go to the ring till the io thread takes the
+    // overflowed ones, or it would be written before them
+    SpinLock lock{ring.overflowMutex_};
+    ring.overflow_.emplace(decode(record));
+    ring.overflowing_.store(true, std::memory_order_release);
   }
+}
 
-  if (wasEmpty) {
-    cv_.notify_one();
+void ProfilerImp::record(const ProfileEvent& event) {
+  if (!recording_) {
+    return;
+  }
+  auto& ring = getThreadRing();
+  if (!ring.identified_ && !threadName_.empty()) {
+    ring.identified_ = true;
+    ProfileEvent identifyThreadEvent{Type::Instant, Class::IdentifyThread};
+    identifyThreadEvent.setThreadName(threadName_);
+    auto identifyRecord = encode(identifyThreadEvent);
+    push(ring, identifyRecord);
   }
+  auto record = encode(event);
+  push(ring, record);
 }
 
 void ProfilerImp::recordNowOrAtStart(const ProfileEvent& event) {
@@ -81,24 +339,9 @@ ProfilerImp::~ProfilerImp() {
       RT_LOG(WARNING) << "Exception thrown while destroying the runtime profiler: " << exc.what();
     }
   }
-}
-
-std::optional<ProfileEvent> ProfilerImp::identifyThread() {
-  if (threadName_.empty()) {
-    return std::nullopt;
-  }
-
-  SpinLock lock(identifiedThreadsMutex_);
-  auto [it, inserted] = identifiedThreads_.emplace(std::this_thread::get_id());
-  (void)it;
-  lock.unlock();
-
-  if (inserted) {
-    ProfileEvent identifyThreadEvent{Type::Instant, Class::IdentifyThread};
-    identifyThreadEvent.setThreadName(threadName_);
-    return identifyThreadEvent;
-  } else {
-    return std::nullopt;
+  SpinLock lock{ringsMutex_};
+  for (auto& ring : rings_) {
+    ring->closed_ = true;
   }
 }
 
@@ -117,25 +360,68 @@ void ProfilerImp::ioThread(OutputType outputType, std::ostream* stream) {
     throw Exception("Unknown profiler output type");
   }
 
-  SpinLock lock{mutex_};
-  while (recording_ || !events_.empty()) {
-    if (events_.empty()) {
-      cv_.wait(lock, [this] { return !events_.empty() || !recording_; });
+  auto write = [&archive](const ProfileEvent& evt) {
+    std::visit(
+      [&evt](auto&& arch) {
+        using T = std::decay_t<decltype(arch)>;
+        if constexpr (!std::is_same_v<T, std::monostate>) {
+          arch(evt);
+        }
+      },
+      archive);
+  };
+
+  // writes all the pending events, returns how many
+  auto drain = [this, &write] {
+    auto count = size_t{0};
+    std::queue<ProfileEvent> events;
+    {
+      SpinLock lock{mutex_};
+      std::swap(events, events_);
+    }
+    for (; !events.empty(); events.pop()) {
+      write(events.front());
+      ++count;
     }
-    if (!events_.empty()) {
-      auto evt = events_.front();
-      events_.pop();
-      lock.unlock();
-      std::visit(
-        [&evt](auto&& arch) {
-          using T = std::decay_t<decltype(arch)>;
-          if constexpr (!std::is_same_v<T, std::monostate>) {
-            arch(evt);
-          }
-        },
-        archive);
-      lock.lock();
+    std::vector<std::shared_ptr<EventRing>> rings;
+    {
+      SpinLock lock{ringsMutex_};
+      rings_.erase(std::remove_if(begin(rings_), end(rings_),
+                                  [](const auto& ring) { return ring->abandoned_ && ring->empty(); }),
+                   end(rings_));
+      rings = rings_;
     }
+    for (auto& ring : rings) {
+      count += ring->drain([&write](EventRecord& record) { write(decode(record)); });
+      if (ring->overflowing_.load(std::memory_order_acquire)) {
+        std::queue<ProfileEvent> overflow;
+        {
+          // the records pushed before the overflowing ones may have come after the drain above
+          SpinLock lock{ring->overflowMutex_};
+          count += ring->drain([&write](EventRecord& record) { write(decode(record)); });
+          std::swap(overflow, ring->overflow_);
+          ring->overflowing_.store(false, std::memory_order_release);
+        }
+        for (; !overflow.empty(); overflow.pop()) {
+          write(overflow.front());
+          ++count;
+        }
+      }
+    }
+    return count;
+  };
+
+  while (recording_) {
+    if (drain() == 0) {
+      SpinLock lock{mutex_};
+      cv_.wait_for(lock, kIdleWaitTime, [this] { return !recording_ || !events_.empty(); });
+    }
+  }
+  drain();
+  SpinLock lock{mutex_};
+  if (endEvent_) {
+    write(*endEvent_);
+    endEvent_.reset();
   }
 }
 
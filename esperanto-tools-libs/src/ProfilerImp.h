@@ -13,9 +13,12 @@
 #include <cereal/archives/json.hpp>
 #include <cereal/archives/portable_binary.hpp>
 
+#include <atomic>
+#include <memory>
 #include <mutex>
 #include <queue>
 #include <variant>
+#include <vector>
 
 namespace rt::profiling {
 
@@ -38,9 +41,14 @@ public:
   }
 };
 
-// Regular implementation
+// Regular implementation. Each recording thread encodes its events into fixed size records pushed to its own lock-free
+// single producer single consumer ring; the io thread drains all the rings and serializes the events. Events which
+// can't be encoded in a record (i.e. with strings or device properties) are carried in the record as a heap copy, so
+// each thread events keep their order. Only when a ring is full the events go through its mutex protected overflow
+// queue, and so do the following ones till the io thread drains the ring, so they are written after the older records.
 class ETRT_API ProfilerImp : public IProfilerRecorder {
 public:
+  ProfilerImp();
   // IProfiler interface
   void start(std::ostream& outputStream, OutputType outputType) override;
   void stop() override;
@@ -48,19 +56,27 @@ public:
   void recordNowOrAtStart(const ProfileEvent& event) override;
   ~ProfilerImp() override;
 
+  struct EventRecord;
+  class EventRing;
+
 private:
   void ioThread(OutputType outputType, std::ostream* stream);
-  std::optional<ProfileEvent> identifyThread();
+  // returns the ring of the calling thread, creating it the first time
+  EventRing& getThreadRing();
+  void push(EventRing& ring, EventRecord& record);
 
   std::mutex mutex_;
   std::queue<ProfileEvent> events_;
   std::queue<ProfileEvent> delayedEvents_;
+  std::optional<ProfileEvent> endEvent_;
   std::condition_variable cv_;
   std::thread ioThread_;
-  bool recording_ = false;
+  std::atomic<bool> recording_ = false;
 
-  std::mutex identifiedThreadsMutex_;
-  std::unordered_set<std::thread::id> identifiedThreads_;
+  // tells apart the rings of different profiler instances in the threads cache
+  const uint64_t id_;
+  std::mutex ringsMutex_;
+  std::vector<std::shared_ptr<EventRing>> rings_;
 };
 
 } // namespace rt::profiling
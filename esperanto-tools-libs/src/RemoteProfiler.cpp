@@ -27,6 +27,15 @@ void RemoteProfiler::releaseThisThreadsWorker() {
   threadsWorker_ = nullptr;
 }
 
+void RemoteProfiler::removeWorker(Worker* worker) {
+  SpinLock lock(workerAccessedThreadsMutex_);
+  workerAccessedThreads_.erase(worker);
+  lock.unlock();
+
+  SpinLock samplersLock(samplersMutex_);
+  samplers_.erase(worker);
+}
+
 void RemoteProfiler::start(std::ostream& outputStream, OutputType outputType) {
   if (localProfiler_) {
     localProfiler_->start(outputStream, outputType);
@@ -45,6 +54,14 @@ void RemoteProfiler::enableRemote() {
 
 void RemoteProfiler::disableRemote() {
   enabled_ = false;
+  // the stats restart from scratch once enabled again
+  SpinLock lock(samplersMutex_);
+  samplers_.clear();
+}
+
+void RemoteProfiler::setSamplingOptions(const SamplingOptions& options) {
+  SpinLock lock(samplersMutex_);
+  samplingOptions_ = options;
 }
 
 void RemoteProfiler::record(const ProfileEvent& event) {
@@ -59,6 +76,13 @@ void RemoteProfiler::record(const ProfileEvent& event) {
   registerThread();
 
   auto cl = event.getClass();
+  if ((cl == Class::KernelLaunch) || (cl == Class::MemcpyHostToDevice) || (cl == Class::MemcpyDeviceToHost)) {
+    // Also measured at the client, so these are only taken into the stats
+    if (auto worker = event.getStream() ? getWorker(event.getStream().value()) : nullptr; worker != nullptr) {
+      processProfilingEvent(worker, event, false);
+    }
+    return;
+  }
   if ((cl != Class::ResponseReceived) && (cl != Class::CommandSent) && (cl != Class::DispatchEvent)) {
     // All other classes are also measured at the client, so here we avoid having both events in the client
     return;
@@ -122,20 +146,19 @@ void RemoteProfiler::recordRequestProfilingEvent(EventId eventId, StreamId strea
     return;
   }
 
-  // Emit the request profiling event
-  sendProfilingEvent(worker, event);
+  // Emit the request profiling event if sampled; the response profiling events follow the same decision
+  auto sampled = processProfilingEvent(worker, event, true);
 
   // Response profiling events do not have the stream id recorded
   SpinLock lock(eventToStreamAndEraliesMutex_);
+  eventToStream_[eventId] = Request{streamId, sampled};
   auto it = earlyProfilingEvents_.find(eventId);
   if (it != earlyProfilingEvents_.end()) {
     // Try to process any response profiling event that might have arrived too early
-    auto const& earlyEvent = it->second;
-    sendProfilingEvent(worker, earlyEvent);
+    auto earlyEvent = std::move(it->second);
     earlyProfilingEvents_.erase(it);
-  } else {
-    // Save the event to stream association for the response profiling event
-    eventToStream_[eventId] = streamId;
+    lock.unlock();
+    processProfilingEvent(worker, earlyEvent, sampled);
   }
 }
 
@@ -145,16 +168,16 @@ void RemoteProfiler::recordResponseProfilingEvent(EventId eventId, const Profile
   auto it = eventToStream_.find(eventId);
   if (it != eventToStream_.end()) {
     // A response profiling event correclty ordered after its request
-    auto streamId = it->second;
+    auto request = it->second;
 
-    auto worker = getWorker(streamId);
+    auto worker = getWorker(request.stream_);
     if (worker == nullptr) {
-      RT_LOG(WARNING) << "Stream " << int(streamId) << " has no worker assigned";
+      RT_LOG(WARNING) << "Stream " << int(request.stream_) << " has no worker assigned";
       return;
     }
 
     lock.unlock();
-    sendProfilingEvent(worker, event);
+    processProfilingEvent(worker, event, request.sampled_);
   } else {
     // Delay this reponse profiling event since it arrived before its matching request profiling event
     auto [it2, inserted] = earlyProfilingEvents_.try_emplace(eventId, event);
@@ -167,6 +190,27 @@ void RemoteProfiler::recordResponseProfilingEvent(EventId eventId, const Profile
   }
 }
 
+bool RemoteProfiler::processProfilingEvent(Worker* worker, const ProfileEvent& event, bool forward) {
+  SpinLock lock(samplersMutex_);
+  auto& sampler = getSampler(worker);
+  sampler.aggregate(event);
+  forward = forward && sampler.sample(event.getClass(), event.getTimeStamp());
+  auto stats = sampler.flush();
+  lock.unlock();
+
+  if (forward) {
+    sendProfilingEvent(worker, event);
+  }
+  if (stats) {
+    sendProfilingEvent(worker, *stats);
+  }
+  return forward;
+}
+
+ProfileSampler& RemoteProfiler::getSampler(Worker* worker) {
+  return samplers_.try_emplace(worker, samplingOptions_).first->second;
+}
+
 inline void RemoteProfiler::registerThread() {
   auto threadId = std::this_thread::get_id();
 
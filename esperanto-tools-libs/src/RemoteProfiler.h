@@ -5,6 +5,7 @@
 
 #pragma once
 
+#include "ProfileSampler.h"
 #include "ProfilerImp.h"
 
 #include "runtime/Types.h"
@@ -35,6 +36,8 @@ public:
   void setLocalProfiler(std::unique_ptr<IProfilerRecorder>&& localProfiler);
   void setThisThreadsWorker(Worker* worker);
   void releaseThisThreadsWorker();
+  // forgets all the worker state, to be called when the worker is destroyed
+  void removeWorker(Worker* worker);
 
   void assignRemoteWorkerToStream(StreamId stream);
   void unassignRemoteWorkerFromStream(StreamId stream);
@@ -42,6 +45,9 @@ public:
   void enableRemote();
   void disableRemote();
 
+  // sampling and stats of the events sent to the workers; applies to the workers which didn't send events yet
+  void setSamplingOptions(const SamplingOptions& options);
+
 private:
   inline void registerThread();
   std::string getThreadName(std::thread::id threadId);
@@ -50,6 +56,10 @@ private:
 
   void recordRequestProfilingEvent(EventId eventId, StreamId streamId, const ProfileEvent& event);
   void recordResponseProfilingEvent(EventId eventId, const ProfileEvent& event);
+  // aggregates the event and sends it (if forward is set and it gets sampled) and the stats (if due) to the worker.
+  // Returns true if the event was sent
+  bool processProfilingEvent(Worker* worker, const ProfileEvent& event, bool forward);
+  ProfileSampler& getSampler(Worker* worker);
 
   void sendProfilingEvent(Worker* worker, const ProfileEvent& event);
 
@@ -59,8 +69,12 @@ private:
   mutable std::mutex streamToWorkerMutex_;
   std::unordered_map<StreamId, Worker*> streamToWorker_;
 
+  struct Request {
+    StreamId stream_;
+    bool sampled_; // the response events of a request which has not been sampled are not forwarded
+  };
   mutable std::mutex eventToStreamAndEraliesMutex_;
-  std::unordered_map<EventId, StreamId> eventToStream_;
+  std::unordered_map<EventId, Request> eventToStream_;
   std::unordered_map<EventId, ProfileEvent> earlyProfilingEvents_;
 
   std::mutex threadIdNamesMutex_;
@@ -70,6 +84,10 @@ private:
   // For each worker, the ID of each thread that has emited an event and wether it has already been identified
   std::unordered_map<Worker*, std::unordered_map<std::thread::id, bool>> workerAccessedThreads_;
 
+  std::mutex samplersMutex_;
+  SamplingOptions samplingOptions_;
+  std::unordered_map<Worker*, ProfileSampler> samplers_;
+
   static thread_local Worker* threadsWorker_;
 };
 
@@ -5,13 +5,13 @@
 
 #include "ResponseReceiver.h"
 #include "RuntimeImp.h"
+#include "ThreadAffinity.h"
 #include "Utils.h"
 
 #include <algorithm>
 #include <array>
 #include <chrono>
 #include <easy/profiler.h>
-#include <random>
 #include <thread>
 #include <utility>
 
@@ -21,31 +21,41 @@ namespace {
 constexpr auto kResponsePollingIntervalWithEventsOnFly = 50us;
 constexpr auto kResponsePollingIntervalNoEventsOnFly = 500us;
 constexpr auto kResponseNumTriesBeforePolling = 1;
+constexpr auto kMaxResponsesPerBatch = 32;
+// in blocking modes we still wake up periodically; when the device layer has no per CQ notifications the epoll fd is
+// edge-triggered and shared with the CommandSender threads and the other CQs receivers, so a CQ notification could be
+// consumed by them. The timeout bounds the latency in that (rare) case.
+constexpr auto kResponseBlockingTimeoutWithEventsOnFly = 1ms;
+constexpr auto kResponseBlockingTimeoutNoEventsOnFly = 10ms;
 constexpr auto kCheckDevicesInterval = 5s;
 constexpr auto kCheckDevicesPolling = 1ms;
 } // namespace
 
-void ResponseReceiver::checkResponses(int deviceId) {
+void ResponseReceiver::checkResponses(int deviceId, int cqIdx) {
   EASY_THREAD_SCOPE("ResponseReceiver")
   // Max ioctl size is 14b
   constexpr uint32_t kMaxMsgSize = (1UL << 14) - 1;
 
-  profiling::IProfilerRecorder::setCurrentThreadName("Device " + std::to_string(deviceId) + " response receiver");
-
-  std::vector<std::byte> buffer(kMaxMsgSize);
+  profiling::IProfilerRecorder::setCurrentThreadName("Device " + std::to_string(deviceId) + " CQ " +
+                                                      std::to_string(cqIdx) + " response receiver");
+  if (pinToDeviceCpus_) {
+    if (auto cpus = getDeviceLocalCpus(deviceLayer_, deviceId)) {
+      pinCurrentThread(*cpus);
+    }
+  }
 
-  std::random_device rd;
-  std::mt19937 gen(rd());
+  std::vector<std::vector<std::byte>> buffers(kMaxResponsesPerBatch, std::vector<std::byte>(kMaxMsgSize));
 
+  auto lastResponse = std::chrono::steady_clock::now();
   while (runReceiver_) {
     int responsesCount = 0;
     for (int i = 0; i < kResponseNumTriesBeforePolling; ++i) {
       try {
-        while (deviceLayer_.receiveResponseMasterMinion(deviceId, buffer)) {
-          RT_VLOG(LOW) << "Got response from deviceId: " << deviceId;
-          responsesCount++;
-          receiverServices_->onResponseReceived(DeviceId{deviceId}, buffer);
-          RT_VLOG(LOW) << "Response processed";
+        while (auto count = deviceLayer_.receiveResponsesFromCqMasterMinion(deviceId, cqIdx, buffers)) {
+          RT_VLOG(LOW) << "Got " << count << " responses from deviceId: " << deviceId << " CQ: " << cqIdx;
+          responsesCount += static_cast<int>(count);
+          receiverServices_->onResponsesReceived(DeviceId{deviceId}, buffers, count);
+          RT_VLOG(LOW) << "Responses processed";
         }
       } catch (const std::exception& e) {
         RT_LOG(WARNING)
@@ -59,12 +69,40 @@ void ResponseReceiver::checkResponses(int deviceId) {
       if (!eventsOnfly) {
         deviceLayer_.hintInactivity(deviceId);
       }
-      std::this_thread::sleep_for(eventsOnfly ? kResponsePollingIntervalWithEventsOnFly
-                                              : kResponsePollingIntervalNoEventsOnFly);
+      waitForResponses(deviceId, cqIdx, eventsOnfly, lastResponse);
+    } else {
+      lastResponse = std::chrono::steady_clock::now();
     }
   }
 }
 
+void ResponseReceiver::waitForResponses(int deviceId, int cqIdx, bool eventsOnFly,
+                                        std::chrono::steady_clock::time_point lastResponse) {
+  auto mode = mode_;
+  if (mode == ResponseReceiverMode::Hybrid) {
+    // keep spinning while we are inside the spin window and there is work pending on the device
+    if (eventsOnFly && std::chrono::steady_clock::now() < lastResponse + spinTime_) {
+      std::this_thread::yield();
+      return;
+    }
+    mode = ResponseReceiverMode::Blocking;
+  }
+  if (mode == ResponseReceiverMode::Blocking) {
+    try {
+      // no need to check the result, the caller will try to pop responses anyway after returning
+      deviceLayer_.waitForCqEventMasterMinion(deviceId, cqIdx,
+                                              eventsOnFly ? kResponseBlockingTimeoutWithEventsOnFly
+                                                          : kResponseBlockingTimeoutNoEventsOnFly);
+      return;
+    } catch (const std::exception& e) {
+      RT_LOG(WARNING) << "Exception while waiting for responses on device " << deviceId
+                      << ". Falling back to polling. Exception message: " << e.what();
+    }
+  }
+  std::this_thread::sleep_for(eventsOnFly ? kResponsePollingIntervalWithEventsOnFly
+                                          : kResponsePollingIntervalNoEventsOnFly);
+}
+
 void ResponseReceiver::checkDevices() {
   profiling::IProfilerRecorder::setCurrentThreadName("Device checker");
 
@@ -88,13 +126,23 @@ void ResponseReceiver::checkDevices() {
   }
 }
 
-ResponseReceiver::ResponseReceiver(dev::IDeviceLayer& deviceLayer, IReceiverServices* receiverServices)
+ResponseReceiver::ResponseReceiver(dev::IDeviceLayer& deviceLayer, IReceiverServices* receiverServices,
+                                   ResponseReceiverMode mode, std::chrono::microseconds spinTime,
+                                   bool pinToDeviceCpus)
   : deviceLayer_(deviceLayer)
-  , receiverServices_(receiverServices) {
+  , receiverServices_(receiverServices)
+  , mode_(mode)
+  , spinTime_(spinTime)
+  , pinToDeviceCpus_(pinToDeviceCpus) {
+
+  RT_LOG(INFO) << "Response receiver mode: " << static_cast<int>(mode_) << " spin time: " << spinTime_.count() << "us";
 
   auto devCount = deviceLayer_.getDevicesCount();
   for (int i = 0; i < devCount; ++i) {
-    receivers_.emplace_back(std::thread(std::bind(&ResponseReceiver::checkResponses, this, i)));
+    auto cqCount = std::max(deviceLayer_.getCompletionQueuesCount(i), 1);
+    for (int cq = 0; cq < cqCount; ++cq) {
+      receivers_.emplace_back(std::thread(std::bind(&ResponseReceiver::checkResponses, this, i, cq)));
+    }
   }
 }
 
@@ -9,6 +9,7 @@
 #include "device-layer/IDeviceLayer.h"
 
 #include <atomic>
+#include <chrono>
 #include <functional>
 #include <memory>
 #include <thread>
@@ -21,22 +22,38 @@ public:
     virtual bool areEventsOnFly(DeviceId device) const = 0;
     virtual void checkDevice(DeviceId device) = 0;
     virtual void onResponseReceived(DeviceId device, const std::vector<std::byte>& response) = 0;
+    // processes the first count responses; implementations can override this to amortize per-response costs
+    virtual void onResponsesReceived(DeviceId device, const std::vector<std::vector<std::byte>>& responses,
+                                     size_t count) {
+      for (size_t i = 0; i < count; ++i) {
+        onResponseReceived(device, responses[i]);
+      }
+    }
   };
-  explicit ResponseReceiver(dev::IDeviceLayer& deviceLayer, IReceiverServices* receiverServices);
+  explicit ResponseReceiver(dev::IDeviceLayer& deviceLayer, IReceiverServices* receiverServices,
+                            ResponseReceiverMode mode = ResponseReceiverMode::Polling,
+                            std::chrono::microseconds spinTime = std::chrono::microseconds{0},
+                            bool pinToDeviceCpus = false);
 
   void startDeviceChecker();
 
   ~ResponseReceiver();
 
 private:
-  void checkResponses(int deviceId);
+  // drains one of the completion queues of the device, each of them has a receiver thread of its own
+  void checkResponses(int deviceId, int cqIdx);
   void checkDevices();
+  // waits till there could be new responses in the device completion queue, following the configured mode
+  void waitForResponses(int deviceId, int cqIdx, bool eventsOnFly, std::chrono::steady_clock::time_point lastResponse);
 
   std::vector<std::thread> receivers_;
   std::thread deviceChecker_;
   bool runDeviceChecker_ = false;
-  bool runReceiver_ = true;
+  std::atomic<bool> runReceiver_ = true;
   dev::IDeviceLayer& deviceLayer_;
   IReceiverServices* receiverServices_;
+  ResponseReceiverMode mode_;
+  std::chrono::microseconds spinTime_;
+  bool pinToDeviceCpus_;
 };
 } // namespace rt
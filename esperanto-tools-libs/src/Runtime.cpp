@@ -59,10 +59,54 @@ void IRuntime::freeDevice(DeviceId device, std::byte* buffer) {
   doFreeDevice(device, buffer);
 }
 
-StreamId IRuntime::createStream(DeviceId device) {
+void IRuntime::freeDeviceAsync(StreamId stream, std::byte* buffer) {
+  EASY_FUNCTION()
+  ScopedProfileEvent profileEvent(Class::FreeDevice, *profiler_, stream);
+  profileEvent.setAddress(buffer);
+  doFreeDeviceAsync(stream, buffer);
+}
+
+DeviceHandle IRuntime::mallocDeviceHandle(DeviceId device, size_t size, uint32_t alignment) {
+  EASY_FUNCTION()
+  ScopedProfileEvent profileEvent(Class::MallocDevice, *profiler_, device, size);
+  profileEvent.setAlignment(alignment);
+  auto handle = doMallocDeviceHandle(device, size, alignment);
+  profileEvent.setAddress(doResolveDeviceHandle(handle));
+  return handle;
+}
+
+void IRuntime::freeDeviceHandle(DeviceHandle handle) {
+  EASY_FUNCTION()
+  doFreeDeviceHandle(handle);
+}
+
+std::byte* IRuntime::resolveDeviceHandle(DeviceHandle handle) const {
+  return doResolveDeviceHandle(handle);
+}
+
+size_t IRuntime::compactDeviceMemory(DeviceId device) {
+  EASY_FUNCTION()
+  return doCompactDeviceMemory(device);
+}
+
+DeviceHandle IRuntime::mallocManaged(DeviceId device, size_t size, uint32_t alignment) {
+  EASY_FUNCTION()
+  ScopedProfileEvent profileEvent(Class::MallocDevice, *profiler_, device, size);
+  profileEvent.setAlignment(alignment);
+  auto handle = doMallocManaged(device, size, alignment);
+  profileEvent.setAddress(doResolveDeviceHandle(handle));
+  return handle;
+}
+
+void IRuntime::prefetchManaged(StreamId stream, const std::vector<DeviceHandle>& handles) {
+  EASY_FUNCTION()
+  doPrefetchManaged(stream, handles);
+}
+
+StreamId IRuntime::createStream(DeviceId device, StreamPriority priority) {
   EASY_FUNCTION()
   ScopedProfileEvent profileEvent(Class::CreateStream, *profiler_, device);
-  auto st = doCreateStream(device);
+  auto st = doCreateStream(device, priority);
   profileEvent.setStream(st);
   return st;
 }
@@ -73,6 +117,45 @@ void IRuntime::destroyStream(StreamId stream) {
   doDestroyStream(stream);
 }
 
+DeviceGroupId IRuntime::createDeviceGroup(const std::vector<DeviceId>& devices, StreamPriority priority) {
+  EASY_FUNCTION()
+  return doCreateDeviceGroup(devices, priority);
+}
+
+void IRuntime::destroyDeviceGroup(DeviceGroupId group) {
+  EASY_FUNCTION()
+  doDestroyDeviceGroup(group);
+}
+
+StreamId IRuntime::getDeviceGroupStream(DeviceGroupId group, DeviceId device) const {
+  return doGetDeviceGroupStream(group, device);
+}
+
+std::vector<DeviceId> IRuntime::getDeviceGroupDevices(DeviceGroupId group) const {
+  return doGetDeviceGroupDevices(group);
+}
+
+EventId IRuntime::launchOnGroup(DeviceGroupId group, const std::vector<KernelId>& kernels,
+                                const std::vector<std::vector<std::byte>>& kernelArgs,
+                                const KernelLaunchOptions& kernelLaunchOptions) {
+  EASY_FUNCTION()
+  KernelLaunchOptionsImp const& kOptionsImp =
+    (kernelLaunchOptions.imp_ == nullptr) ? DefaultKernelOptions::defaultKernelOptions : *kernelLaunchOptions.imp_;
+  return doLaunchOnGroup(group, kernels, kernelArgs, kOptionsImp);
+}
+
+EventId IRuntime::scatter(DeviceGroupId group, const std::byte* h_src, const std::vector<std::byte*>& d_dsts,
+                          size_t shardSize, bool barrier) {
+  EASY_FUNCTION()
+  return doScatter(group, h_src, d_dsts, shardSize, barrier);
+}
+
+EventId IRuntime::gather(DeviceGroupId group, const std::vector<const std::byte*>& d_srcs, std::byte* h_dst,
+                         size_t shardSize, bool barrier) {
+  EASY_FUNCTION()
+  return doGather(group, d_srcs, h_dst, shardSize, barrier);
+}
+
 EventId IRuntime::memcpyHostToDevice(StreamId stream, const std::byte* h_src, std::byte* d_dst, size_t size,
                                      bool barrier, const CmaCopyFunction& cmaCopyFunction) {
   EASY_FUNCTION()
@@ -102,6 +185,42 @@ EventId IRuntime::memcpyDeviceToHost(StreamId stream, const std::byte* d_src, st
   return eventId;
 }
 
+EventId IRuntime::memcpyHostToDeviceConverted(StreamId stream, const float* h_src, std::byte* d_dst, size_t count,
+                                              const MemcpyConversion& conversion, bool barrier) {
+  EASY_FUNCTION()
+  ScopedProfileEvent profileEvent(Class::MemcpyHostToDevice, *profiler_, stream, barrier);
+  auto eventId = doMemcpyHostToDeviceConverted(stream, h_src, d_dst, count, conversion, barrier);
+  profileEvent.setEventId(eventId);
+  return eventId;
+}
+
+EventId IRuntime::memcpyDeviceToHostConverted(StreamId stream, const std::byte* d_src, float* h_dst, size_t count,
+                                              const MemcpyConversion& conversion, bool barrier) {
+  EASY_FUNCTION()
+  ScopedProfileEvent profileEvent(Class::MemcpyDeviceToHost, *profiler_, stream, barrier);
+  auto eventId = doMemcpyDeviceToHostConverted(stream, d_src, h_dst, count, conversion, barrier);
+  profileEvent.setEventId(eventId);
+  return eventId;
+}
+
+EventId IRuntime::memcpyHostToDeviceCompressed(StreamId stream, const std::vector<CompressedChunk>& chunks,
+                                               std::byte* d_dst, uint64_t shireMask) {
+  EASY_FUNCTION()
+  ScopedProfileEvent profileEvent(Class::MemcpyHostToDevice, *profiler_, stream, true);
+  auto eventId = doMemcpyHostToDeviceCompressed(stream, chunks, d_dst, shireMask);
+  profileEvent.setEventId(eventId);
+  return eventId;
+}
+
+EventId IRuntime::memcpyHostToDeviceChecked(StreamId stream, const std::byte* h_src, std::byte* d_dst, size_t size,
+                                            uint64_t shireMask, bool barrier) {
+  EASY_FUNCTION()
+  ScopedProfileEvent profileEvent(Class::MemcpyHostToDevice, *profiler_, stream, barrier);
+  auto eventId = doMemcpyHostToDeviceChecked(stream, h_src, d_dst, size, shireMask, barrier);
+  profileEvent.setEventId(eventId);
+  return eventId;
+}
+
 EventId IRuntime::memcpyHostToDevice(StreamId stream, MemcpyList memcpyList, bool barrier,
                                      const CmaCopyFunction& cmaCopyFunction) {
   EASY_FUNCTION()
@@ -120,6 +239,22 @@ EventId IRuntime::memcpyDeviceToHost(StreamId stream, MemcpyList memcpyList, boo
   return eventId;
 }
 
+EventId IRuntime::memcpyHostToDeviceChained(StreamId stream, MemcpyList memcpyList) {
+  EASY_FUNCTION()
+  ScopedProfileEvent profileEvent(Class::MemcpyHostToDevice, *profiler_, stream, true);
+  auto eventId = doMemcpyHostToDeviceChained(stream, std::move(memcpyList));
+  profileEvent.setEventId(eventId);
+  return eventId;
+}
+
+EventId IRuntime::memcpyDeviceToHostChained(StreamId stream, MemcpyList memcpyList) {
+  EASY_FUNCTION()
+  ScopedProfileEvent profileEvent(Class::MemcpyDeviceToHost, *profiler_, stream, true);
+  auto eventId = doMemcpyDeviceToHostChained(stream, std::move(memcpyList));
+  profileEvent.setEventId(eventId);
+  return eventId;
+}
+
 EventId IRuntime::kernelLaunch(StreamId stream, KernelId kernel, const std::byte* kernel_args, size_t kernel_args_size,
                                uint64_t shire_mask, bool barrier, bool flushL3,
                                std::optional<UserTrace> userTraceConfig, const std::string& coreDumpPath) {
@@ -154,6 +289,15 @@ EventId IRuntime::kernelLaunch(StreamId stream, KernelId kernel, const std::byte
   return evt;
 }
 
+EventId IRuntime::kernelLaunchSigned(StreamId stream, KernelId kernel, uint64_t signature, const std::byte* kernel_args,
+                                     size_t kernel_args_size, const KernelLaunchOptions& kernelLaunchOptions) {
+  EASY_FUNCTION()
+  ScopedProfileEvent profileEvent(Class::KernelLaunch, *profiler_, stream, kernel, -1ULL);
+  auto evt = doKernelLaunchSigned(stream, kernel, signature, kernel_args, kernel_args_size, *kernelLaunchOptions.imp_);
+  profileEvent.setEventId(evt);
+  return evt;
+}
+
 bool IRuntime::waitForEvent(EventId event, std::chrono::seconds timeout) {
   EASY_FUNCTION(profiler::colors::Red300)
   EASY_VALUE("Event", static_cast<int>(event));
@@ -231,6 +375,138 @@ bool IRuntime::isP2PEnabled(DeviceId one, DeviceId other) const {
   return doIsP2PEnabled(one, other);
 }
 
+void IRuntime::registerHostBuffer(DeviceId device, const std::byte* h_ptr, size_t size, bool toDeviceOnly) {
+  EASY_FUNCTION()
+  doRegisterHostBuffer(device, h_ptr, size, toDeviceOnly);
+}
+
+void IRuntime::unregisterHostBuffer(DeviceId device, const std::byte* h_ptr) {
+  EASY_FUNCTION()
+  doUnregisterHostBuffer(device, h_ptr);
+}
+
+std::byte* IRuntime::allocHostBuffer(DeviceId device, size_t size) {
+  EASY_FUNCTION()
+  return doAllocHostBuffer(device, size);
+}
+
+void IRuntime::freeHostBuffer(DeviceId device, std::byte* h_ptr) {
+  EASY_FUNCTION()
+  doFreeHostBuffer(device, h_ptr);
+}
+
+void IRuntime::beginCapture(StreamId stream) {
+  EASY_FUNCTION()
+  doBeginCapture(stream);
+}
+
+GraphId IRuntime::endCapture(StreamId stream) {
+  EASY_FUNCTION()
+  return doEndCapture(stream);
+}
+
+void IRuntime::uploadGraph(StreamId stream, GraphId graph) {
+  EASY_FUNCTION()
+  doUploadGraph(stream, graph);
+}
+
+EventId IRuntime::launchGraph(StreamId stream, GraphId graph, const std::vector<GraphArgPatch>& patches) {
+  EASY_FUNCTION()
+  return doLaunchGraph(stream, graph, patches);
+}
+
+void IRuntime::destroyGraph(GraphId graph) {
+  EASY_FUNCTION()
+  doDestroyGraph(graph);
+}
+
+EventId IRuntime::streamWaitEvent(StreamId stream, EventId event) {
+  EASY_FUNCTION()
+  return doStreamWaitEvent(stream, event);
+}
+
+EventId IRuntime::launchHostFunc(StreamId stream, HostFunc func) {
+  EASY_FUNCTION()
+  if (!func) {
+    throw Exception("Host function can't be empty");
+  }
+  return doLaunchHostFunc(stream, std::move(func));
+}
+
+void IRuntime::setMemcpyCoalescing(StreamId stream, bool enabled) {
+  EASY_FUNCTION()
+  doSetMemcpyCoalescing(stream, enabled);
+}
+
+void IRuntime::setRequestBatching(bool enabled) {
+  EASY_FUNCTION()
+  doSetRequestBatching(enabled);
+}
+
+void IRuntime::flushRequests() {
+  EASY_FUNCTION()
+  doFlushRequests();
+}
+
+void IRuntime::setMasterMinionTraceOutput(DeviceId device, std::ostream* output) {
+  EASY_FUNCTION()
+  doSetMasterMinionTraceOutput(device, output);
+}
+
+void IRuntime::onEventComplete(EventId event, EventCompletionCallback callback) {
+  EASY_FUNCTION()
+  if (!callback) {
+    throw Exception("Event completion callback can't be empty");
+  }
+  doOnEventComplete(event, std::move(callback));
+}
+
+std::future<void> IRuntime::getEventFuture(EventId event) {
+  EASY_FUNCTION()
+  auto promise = std::make_shared<std::promise<void>>();
+  auto future = promise->get_future();
+  doOnEventComplete(event, [promise](EventId) { promise->set_value(); });
+  return future;
+}
+
+std::optional<EventTiming> IRuntime::getEventTiming(EventId event) {
+  EASY_FUNCTION()
+  return doGetEventTiming(event);
+}
+
+std::optional<KernelPowerState> IRuntime::getEventPowerState(EventId event) {
+  EASY_FUNCTION()
+  return doGetEventPowerState(event);
+}
+
+void IRuntime::setShireBudget(DeviceId device, int maxActiveShires) {
+  EASY_FUNCTION()
+  if (maxActiveShires < 0) {
+    throw Exception("Invalid shire budget of " + std::to_string(maxActiveShires) + " shires");
+  }
+  doSetShireBudget(device, maxActiveShires);
+}
+
+int IRuntime::getShireBudget(DeviceId device) const {
+  return doGetShireBudget(device);
+}
+
+void IRuntime::setShireBudgetPolicy(ShireBudgetPolicy policy) {
+  EASY_FUNCTION()
+  doSetShireBudgetPolicy(std::move(policy));
+}
+
+void IRuntime::setCallbackExecutor(CallbackExecutor executor) {
+  EASY_FUNCTION()
+  doSetCallbackExecutor(std::move(executor));
+}
+
+MemoryPoolPtr IRuntime::createMemoryPool(DeviceId device, size_t size, uint32_t alignment) {
+  EASY_FUNCTION()
+  auto base = mallocDevice(device, size, alignment);
+  return MemoryPoolPtr(new MemoryPool(*this, device, base, size));
+}
+
 EventId IRuntime::memcpyDeviceToDevice(StreamId streamSrc, DeviceId deviceDst, const std::byte* d_src, std::byte* d_dst,
                                        size_t size, bool barrier) {
   EASY_FUNCTION()
@@ -249,4 +525,31 @@ EventId IRuntime::memcpyDeviceToDevice(DeviceId deviceSrc, StreamId streamDst, c
   return doMemcpyDeviceToDevice(deviceSrc, streamDst, d_src, d_dst, size, barrier);
 }
 
+EventId IRuntime::memcpyDeviceToDevice(StreamId stream, const std::byte* d_src, std::byte* d_dst, size_t size,
+                                       bool barrier) {
+  EASY_FUNCTION()
+  return doMemcpyWithinDevice(stream, d_src, d_dst, size, barrier);
+}
+
+EventId IRuntime::memsetDevice(StreamId stream, std::byte* d_dst, uint8_t value, size_t size, bool barrier) {
+  EASY_FUNCTION()
+  return doFillDevice(stream, d_dst, value, 1, size, barrier);
+}
+
+EventId IRuntime::fillDevice(StreamId stream, std::byte* d_dst, uint64_t pattern, size_t patternSize, size_t size,
+                             bool barrier) {
+  EASY_FUNCTION()
+  return doFillDevice(stream, d_dst, pattern, patternSize, size, barrier);
+}
+
+EventId IRuntime::setKernelHeap(StreamId stream, std::byte* d_heap, size_t size, bool barrier) {
+  EASY_FUNCTION()
+  return doSetKernelHeap(stream, d_heap, size, barrier);
+}
+
+EventId IRuntime::kernelLaunchMulti(StreamId stream, const std::vector<LaunchDesc>& launches, bool barrier) {
+  EASY_FUNCTION()
+  return doKernelLaunchMulti(stream, launches, barrier);
+}
+
 } // namespace rt
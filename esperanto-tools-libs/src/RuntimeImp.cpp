@@ -5,10 +5,12 @@
 
 #include "RuntimeImp.h"
 #include "Constants.h"
+#include "DeviceUtilization.h"
 #include "ExecutionContextCache.h"
 #include "MemoryManager.h"
 #include "ScopedProfileEvent.h"
 #include "StreamManager.h"
+#include "ThreadAffinity.h"
 #include "Utils.h"
 #include "dma/CmaManager.h"
 #include "dma/DmaBufferImp.h"
@@ -19,6 +21,7 @@
 #include <algorithm>
 #include <chrono>
 #include <cstdint>
+#include <cstring>
 #include <device-layer/IDeviceLayer.h>
 #include <easy/arbitrary_value.h>
 #include <easy/details/profiler_colors.h>
@@ -27,10 +30,15 @@
 #include <esperanto/device-apis/device_apis_message_types.h>
 #include <esperanto/device-apis/operations-api/device_ops_api_cxx.h>
 #include <esperanto/device-apis/operations-api/device_ops_api_rpc_types.h>
+#include <fstream>
+#include <future>
 #include <hostUtils/threadPool/ThreadPool.h>
+#include <iterator>
 #include <memory>
 #include <mutex>
 #include <sstream>
+#include <streambuf>
+#include <string_view>
 #include <thread>
 #include <tuple>
 #include <type_traits>
@@ -43,10 +51,38 @@ void relocateELF(std::byte* runtimeBaseAddress, ELFIO::elfio& elf, std::byte* el
 void relocateSection(std::byte* runtimeBaseAddress, std::byte* elfContents,
                      ELFIO::relocation_section_accessor& reloc_sec, ELFIO::Elf64_Addr elfBaseAddr);
 std::tuple<ELFIO::Elf64_Addr, size_t> getELFBaseAddr(const ELFIO::elfio& elf);
+std::optional<uint64_t> getKernelSignature(const ELFIO::elfio& elf);
 
 void recordMemoryStats(IProfilerRecorder& profiler, DeviceId device, size_t free_bytes,
                        size_t max_free_contiguous_bytes, size_t allocated_memory);
 
+namespace {
+// buffer_type of the trace buffer full event for the MasterMinion trace (TRACE_MM_BUFFER in et-trace layout.h)
+constexpr uint8_t kMasterMinionTraceBuffer = 0;
+
+// read-only stream buffer over memory owned by someone else, so it can be parsed without copying it
+class MemoryStreamBuffer : public std::streambuf {
+public:
+  MemoryStreamBuffer(const std::byte* data, size_t size) {
+    auto begin = const_cast<char*>(reinterpret_cast<const char*>(data));
+    setg(begin, begin, begin + size);
+  }
+
+protected:
+  pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode) override {
+    auto base = dir == std::ios_base::beg ? eback() : (dir == std::ios_base::cur ? gptr() : egptr());
+    if (off < eback() - base || off > egptr() - base) {
+      return pos_type(off_type(-1));
+    }
+    setg(eback(), base + off, egptr());
+    return pos_type(gptr() - eback());
+  }
+  pos_type seekpos(pos_type pos, std::ios_base::openmode which) override {
+    return seekoff(off_type(pos), std::ios_base::beg, which);
+  }
+};
+} // namespace
+
 RuntimeImp::~RuntimeImp() {
   RT_LOG(INFO) << "Destroying runtime";
   for (auto d : devices_) {
@@ -73,16 +109,30 @@ RuntimeImp::RuntimeImp(std::shared_ptr<dev::IDeviceLayer> const& deviceLayer, Op
 
   RT_LOG(INFO) << "Profiler enabled? " << (profiler::isEnabled() ? "True" : "False");
   checkMemcpyDeviceAddress_ = options.checkMemcpyDeviceOperations_;
+  codeImageRetentionBytes_ = options.codeImageRetentionBytes_;
+  streamHostMemoryMinBytes_ = options.streamHostMemoryMinBytes_;
+  mappedDramH2DMaxBytes_ = options.mappedDramH2DMaxBytes_;
+  mappedDramD2HMaxBytes_ = options.mappedDramD2HMaxBytes_;
+  memoryCompactionThreshold_ = options.memoryCompactionThreshold_;
   auto devicesCount = deviceLayer_->getDevicesCount();
   CHECK(devicesCount > 0);
 
+  std::vector<uint32_t> frequencies;
+  for (int device = 0; device < devicesCount; ++device) {
+    frequencies.emplace_back(deviceLayer_->getDeviceConfig(device).minionBootFrequency_);
+  }
+  commandMetrics_ = std::make_unique<CommandMetrics>(std::move(frequencies));
+
   for (int device = 0; device < devicesCount; ++device) {
     auto deviceId = DeviceId{device};
     devices_.emplace_back(deviceId);
+    deviceMutexes_.try_emplace(deviceId, std::make_unique<std::recursive_mutex>());
     auto sqCount = deviceLayer->getSubmissionQueuesCount(device);
     streamManager_.addDevice(deviceId, sqCount);
     for (int sq = 0; sq < sqCount; ++sq) {
-      commandSenders_.try_emplace(getCommandSenderIdx(device, sq), *deviceLayer_, getProfiler(), device, sq);
+      auto it = commandSenders_.try_emplace(getCommandSenderIdx(device, sq), *deviceLayer_, getProfiler(), device, sq);
+      it.first->second.setMetrics(commandMetrics_.get());
+      it.first->second.setInlineSubmission(options.inlineCommandSubmission_);
     }
   }
 
@@ -91,24 +141,37 @@ RuntimeImp::RuntimeImp(std::shared_ptr<dev::IDeviceLayer> const& deviceLayer, Op
 
   for (auto& d : devices_) {
     auto devInt = static_cast<int>(d);
-    auto tracingBufferSize = deviceLayer_->getTraceBufferSizeMasterMinion(devInt, dev::TraceBufferType::TraceBufferCM) +
-                             deviceLayer_->getTraceBufferSizeMasterMinion(devInt, dev::TraceBufferType::TraceBufferMM);
     auto dramBaseAddress = deviceLayer_->getDramBaseAddress(devInt);
     auto dramSize = deviceLayer_->getDramSize(devInt);
     RT_LOG(INFO) << std::hex << "Runtime initialization device " << devInt << ": Dram base addr: " << dramBaseAddress
                  << " Dram size: " << dramSize
                  << " Check memcpy operations: " << (checkMemcpyDeviceAddress_ ? "True" : "False");
 
-    memoryManagers_.try_emplace(d, dramBaseAddress, dramSize, kBlockSize);
-    deviceTracing_.try_emplace(
-      d, DeviceFwTracing{std::make_unique<DmaBufferImp>(devInt, tracingBufferSize, true, *deviceLayer_), nullptr,
-                         nullptr});
+    memoryManagers_.try_emplace(d, dramBaseAddress, dramSize, kBlockSize, options.memoryAllocatorPolicy_);
+    if (mappedDramH2DMaxBytes_ != 0 || mappedDramD2HMaxBytes_ != 0) {
+      auto mapped = deviceLayer_->getMappedDram(devInt);
+      if (mapped != nullptr) {
+        mappedDrams_.try_emplace(d, MappedDram{mapped, dramBaseAddress, dramSize});
+      }
+      RT_LOG(INFO) << "Device " << devInt << " DRAM mapped for small memcpys? " << (mapped ? "True" : "False");
+    }
+    // its dma buffers are allocated by the drains once a MasterMinion trace output is set, see drainMasterMinionTrace
+    deviceTracing_.try_emplace(d);
     auto dmaInfo = deviceLayer_->getDmaInfo(devInt);
     maxElementCount = std::max(maxElementCount, dmaInfo.maxElementCount_);
     totalElementSize += dmaInfo.maxElementSize_;
-    threadPools_.try_emplace(DeviceId{d}, std::make_unique<threadPool::ThreadPool>(4));
-    errorHandlingThreadPools_.try_emplace(DeviceId{d}, std::make_unique<threadPool::ThreadPool>(1));
+    // copies into the CMA buffers run on these threads, keep them close to the device memory
+    std::function<void()> onThreadStart;
+    if (auto cpus = options.pinThreadsToDeviceNode_ ? getDeviceLocalCpus(*deviceLayer_, devInt) : std::nullopt) {
+      onThreadStart = [cpus = *cpus] { pinCurrentThread(cpus); };
+    }
+    threadPools_.try_emplace(DeviceId{d},
+                             std::make_unique<threadPool::WorkStealingThreadPool>(4, false, onThreadStart));
+    errorHandlingThreadPools_.try_emplace(DeviceId{d},
+                                          std::make_unique<threadPool::ThreadPool>(1, false, false, onThreadStart));
     abortSync_.try_emplace(DeviceId{d});
+    streamSyncSlots_.try_emplace(DeviceId{d});
+    shireSchedulers_.try_emplace(DeviceId{d}, std::make_unique<ShireScheduler>());
   }
   auto desiredCma = maxElementCount * totalElementSize * kAllocFactorTotalMaxMemory;
   auto envCma = getenv("ET_CMA_SIZE");
@@ -118,43 +181,77 @@ RuntimeImp::RuntimeImp(std::shared_ptr<dev::IDeviceLayer> const& deviceLayer, Op
     desiredCma = mem;
   }
   auto cmaPerDevice = desiredCma / static_cast<uint32_t>(devicesCount);
+  auto prefaultCma = options.prefaultCmaBuffers_ || options.lockCmaBuffers_;
   while (cmaPerDevice >= kBlockSize) {
-    try {
-      for (const auto& d : devices_) {
+    // the buffers of all the devices are mapped (and prefaulted) at the same time
+    std::vector<std::future<std::unique_ptr<CmaManager>>> allocations;
+    for (const auto& d : devices_) {
+      allocations.emplace_back(std::async(std::launch::async, [this, d, cmaPerDevice, prefaultCma, &options] {
         auto devInt = static_cast<int>(d);
         auto dmaInfo = deviceLayer_->getDmaInfo(devInt);
-        cmaManagers_.try_emplace(
-          d, std::make_unique<CmaManager>(std::make_unique<DmaBufferImp>(devInt, cmaPerDevice, true, *deviceLayer_),
-                                          dmaInfo.maxElementCount_ * dmaInfo.maxElementSize_));
+        auto cmaManager =
+          std::make_unique<CmaManager>(std::make_unique<DmaBufferImp>(devInt, cmaPerDevice, true, *deviceLayer_,
+                                                                      options.hugePageCmaBuffers_),
+                                       dmaInfo.maxElementCount_ * dmaInfo.maxElementSize_, dmaInfo.maxElementSize_);
+        if (prefaultCma) {
+          cmaManager->prefault(options.lockCmaBuffers_);
+        }
+        return cmaManager;
+      }));
+    }
+    auto allocated = true;
+    for (auto i = 0UL; i < allocations.size(); ++i) {
+      try {
+        cmaManagers_.try_emplace(devices_[i], allocations[i].get());
+      } catch (const dev::Exception&) {
+        allocated = false;
       }
+    }
+    if (allocated) {
       break; // if we were able to do the required allocations, end the loop; if not try asking for less memory.
-    } catch (const dev::Exception&) {
-      cmaManagers_.clear();
-      auto newCmaPerDevice = 3 * cmaPerDevice / 4;
-      RT_LOG(WARNING) << "There is not enough CMA memory to allocate desired " << cmaPerDevice
-                      << " bytes per device. Trying with " << newCmaPerDevice << " bytes per device.";
-      cmaPerDevice = newCmaPerDevice;
     }
+    cmaManagers_.clear();
+    auto newCmaPerDevice = 3 * cmaPerDevice / 4;
+    RT_LOG(WARNING) << "There is not enough CMA memory to allocate desired " << cmaPerDevice
+                    << " bytes per device. Trying with " << newCmaPerDevice << " bytes per device.";
+    cmaPerDevice = newCmaPerDevice;
   }
   RT_LOG_IF(FATAL, cmaPerDevice < kBlockSize) << "Error: need at least " << kBlockSize << "B of CMA per device to work";
-  responseReceiver_ = std::make_unique<ResponseReceiver>(*deviceLayer_, this);
+  RT_LOG_IF(INFO, prefaultCma) << "CMA buffers prefaulted" << (options.lockCmaBuffers_ ? " and locked." : ".");
+  responseReceiver_ = std::make_unique<ResponseReceiver>(*deviceLayer_, this, options.responseReceiverMode_,
+                                                         options.responseReceiverSpinTime_,
+                                                         options.pinThreadsToDeviceNode_);
 
-  // initialization sequence, need to send abort command to ensure the device is in a proper state
+  // initialization sequence, need to send abort command to ensure the device is in a proper state. Each device waits
+  // for its own responses, so all of them are initialized at the same time
+  running_ = true;
+  std::vector<std::future<void>> initializations;
   for (int d = 0; d < devicesCount; ++d) {
-    RT_LOG(INFO) << "Initializing device: " << d;
-    abortDevice(DeviceId{d});
-    if (options.checkDeviceApiVersion_) {
-      running_ = true;
-      RT_LOG(INFO) << "Checking device api version for device: " << d;
-      checkDeviceApi(DeviceId{d});
-    }
-    deviceLayer_->hintInactivity(d);
-    RT_LOG(INFO) << "Device: " << d << " initialized.";
+    initializations.emplace_back(std::async(std::launch::async, [this, d, &options] {
+      RT_LOG(INFO) << "Initializing device: " << d;
+      abortDeviceQueues(DeviceId{d});
+      if (options.checkDeviceApiVersion_) {
+        RT_LOG(INFO) << "Checking device api version for device: " << d;
+        checkDeviceApi(DeviceId{d});
+      }
+      deviceLayer_->hintInactivity(d);
+      RT_LOG(INFO) << "Device: " << d << " initialized.";
+    }));
+  }
+  // wait for all of them before rethrowing the first error, they use this object
+  for (auto& init : initializations) {
+    init.wait();
+  }
+  for (auto& init : initializations) {
+    init.get();
   }
   eventManager_.setThrowOnMissingEvent(true);
-  running_ = true;
+  auto executionContextBuffers = kNumExecutionCacheBuffers;
+  if (options.executionContextBuffers_ > 0) {
+    executionContextBuffers = static_cast<int>(options.executionContextBuffers_);
+  }
   executionContextCache_ = std::make_unique<ExecutionContextCache>(
-    this, kNumExecutionCacheBuffers, align(kExceptionBufferSize + kBlockSize, kBlockSize));
+    this, executionContextBuffers, align(kExceptionBufferSize + kBlockSize, kBlockSize));
   responseReceiver_->startDeviceChecker();
   RT_LOG(INFO) << "Runtime initialized.";
 }
@@ -226,34 +323,99 @@ DeviceProperties RuntimeImp::doGetDeviceProperties(DeviceId device) const {
   prop.onPkgDRAMInterleavedChipletLSb_ = dc.onPkgDRAMInterleavedChipletLSb_;
   prop.onPkgDRAMInterleavedChipletBits_ = dc.onPkgDRAMInterleavedChipletBits_;
 
+  prop.maxConcurrentKernels_ = kMaxConcurrentKernels;
+
+  prop.dramMemshireLSb_ = kDramMemshireLSb;
+  prop.dramMemshireBits_ = kDramMemshireBits;
+  prop.dramMemshireControllerBit_ = kDramMemshireControllerBit;
+
   return prop;
 }
 
-LoadCodeResult RuntimeImp::doLoadCode(StreamId stream, const std::byte* data, size_t size) {
-  SpinLock lock(mutex_);
+std::optional<LoadCodeResult> RuntimeImp::loadCachedCode(StreamId stream, DeviceId device, size_t imageHash,
+                                                         const std::byte* elf, size_t elfSize) {
+  SpinLock kernelsLock(mutex_);
+  auto [first, last] = codeImages_.equal_range(imageHash);
+  auto it = std::find_if(first, last, [device, elf, elfSize](const auto& entry) {
+    const auto& image = entry.second;
+    return image.deviceId_ == device && image.elf_.size() == elfSize &&
+           std::equal(elf, elf + elfSize, image.elf_.data());
+  });
+  if (it == last) {
+    return {};
+  }
+  auto& image = it->second;
+  if (image.refCount_++ == 0) {
+    retainedCodeImageBytes_ -= image.size_;
+    RT_VLOG(LOW) << "Reusing retained code image at " << image.deviceBuffer_;
+  }
+  auto kernelId = static_cast<KernelId>(nextKernelId_++);
+  kernels_.emplace(kernelId, std::make_unique<Kernel>(device, image.deviceBuffer_, image.entryPoint_, imageHash,
+                                                      image.signature_));
+  auto loadEvent = image.loadEvent_;
+  RT_VLOG(LOW) << "Reusing code image at " << image.deviceBuffer_ << " for kernel " << static_cast<int>(kernelId)
+               << ". Kernels sharing it: " << image.refCount_;
 
-  auto stInfo = streamManager_.getStreamInfo(stream);
+  LoadCodeResult loadCodeResult;
+  loadCodeResult.loadAddress_ = image.deviceBuffer_;
+  loadCodeResult.kernel_ = kernelId;
+  kernelsLock.unlock();
+
+  loadCodeResult.event_ = eventManager_.getNextId();
+  streamManager_.addEvent(stream, loadCodeResult.event_);
+  if (loadEvent) {
+    // the image is still being copied, probably from another stream
+    eventManager_.addOnDispatchCallback({{*loadEvent}, [this, evt = loadCodeResult.event_] { dispatch(evt); }});
+  } else {
+    dispatch(loadCodeResult.event_);
+  }
+  return loadCodeResult;
+}
 
-  std::vector<std::byte> dataCopy(size);
-  std::byte* elfContents = dataCopy.data();
-  std::copy(data, data + size, elfContents);
+LoadCodeResult RuntimeImp::doLoadCode(StreamId stream, const std::byte* data, size_t size) {
+  flushCoalescedMemcpys(stream);
+  auto stInfo = streamManager_.getStreamInfo(stream);
+  auto device = DeviceId{stInfo.device_};
+  SpinLock lock(getDeviceMutex(device));
 
-  auto memStream = std::istringstream(std::string(reinterpret_cast<const char*>(elfContents), size), std::ios::binary);
+  auto imageHash = std::hash<std::string_view>{}(std::string_view(reinterpret_cast<const char*>(data), size));
+  if (auto cached = loadCachedCode(stream, device, imageHash, data, size)) {
+    return *cached;
+  }
 
+  // parse the elf straight from the caller buffer
+  MemoryStreamBuffer elfBuffer(data, size);
+  std::istream elfStream(&elfBuffer);
   ELFIO::elfio elf;
-  if (!elf.load(memStream)) {
+  if (!elf.load(elfStream)) {
     throw Exception("Error parsing elf");
   }
 
   auto [elfBaseAddr, extraSize] = getELFBaseAddr(elf);
+  auto shareable = std::none_of(begin(elf.segments), end(elf.segments), [](const auto& segment) {
+    return (segment->get_type() & PT_LOAD) && (segment->get_flags() & PF_W) && segment->get_memory_size() > 0;
+  });
 
   // we need to add all the diff between fileSize and memSize to the final size
   // allocate a buffer in the device to load the code
 
-  auto deviceBuffer = doMallocDevice(DeviceId{stInfo.device_}, size + extraSize, kCacheLineSize);
+  auto deviceBuffer = doMallocDevice(device, size + extraSize, kCacheLineSize);
+
+  // host copy of the device buffer contents (zero filled, so bss needs nothing); first fill it with the LOAD segments
+  // and then relocate it
+  std::vector<std::byte> image(size + extraSize);
+  for (auto&& segment : elf.segments) {
+    if ((segment->get_type() & PT_LOAD) && segment->get_memory_size() > 0) {
+      auto offset = segment->get_offset();
+      auto fileSize = segment->get_file_size();
+      auto memSize = segment->get_memory_size();
+      CHECK(memSize >= fileSize);
+      std::copy(data + offset, data + offset + fileSize, image.data() + offset);
+    }
+  }
 
   // Handle the elf relocations
-  relocateELF(deviceBuffer, elf, elfContents, elfBaseAddr);
+  relocateELF(deviceBuffer, elf, image.data(), elfBaseAddr);
 
   // copy the execution code into the device
   // iterate over all the LOAD segments, writing them to device memory
@@ -273,54 +435,63 @@ LoadCodeResult RuntimeImp::doLoadCode(StreamId stream, const std::byte* data, si
         continue;
       }
       auto addr = reinterpret_cast<uint64_t>(deviceBuffer) + offset;
-      CHECK(memSize >= fileSize);
       if (!basePhysicalAddressCalculated) {
         basePhysicalAddress = loadAddress - offset;
         basePhysicalAddressCalculated = true;
       }
-      // allocate a dmabuffer to do the copy
-      std::vector<std::byte> currentBuffer{memSize};
-      // first fill with fileSize
-      std::copy(elfContents + offset, elfContents + offset + fileSize, currentBuffer.data());
-      if (memSize > fileSize) {
-        RT_VLOG(LOW) << "Memsize of segment " << segment->get_index() << " is larger than fileSize. Filling with 0s";
-        std::fill_n(reinterpret_cast<uint8_t*>(currentBuffer.data()) + fileSize, memSize - fileSize, 0);
-      }
       RT_VLOG(LOW) << "S: " << segment->get_index() << std::hex << " O: 0x" << offset << " PA: 0x" << loadAddress
                    << " MS: 0x" << memSize << " FS: 0x" << fileSize << " @: 0x" << addr << " E: 0x" << entry << "\n";
-      events.emplace_back(doMemcpyHostToDevice(stream, currentBuffer.data(), reinterpret_cast<std::byte*>(addr),
+      events.emplace_back(doMemcpyHostToDevice(stream, image.data() + offset, reinterpret_cast<std::byte*>(addr),
                                                memSize, false, defaultCmaCopyFunction));
-      eventManager_.addOnDispatchCallback({{events.back()}, [buffer = std::move(currentBuffer)] {
-                                             // do nothing, it will release the buffer
-                                           }});
     }
   }
   if (!basePhysicalAddressCalculated) {
     throw Exception("Error calculating kernel entrypoint");
   }
 
-  auto kernel = std::make_unique<Kernel>(DeviceId{stInfo.device_}, deviceBuffer, entry - basePhysicalAddress);
+  auto entryPoint = entry - basePhysicalAddress;
+  auto signature = getKernelSignature(elf);
+  auto kernel = std::make_unique<Kernel>(device, deviceBuffer, entryPoint,
+                                         shareable ? std::optional<size_t>{imageHash} : std::nullopt, signature);
+
+  // fill the struct results
+  LoadCodeResult loadCodeResult;
+  loadCodeResult.loadAddress_ = deviceBuffer;
+  loadCodeResult.event_ = eventManager_.getNextId();
+  streamManager_.addEvent(stream, loadCodeResult.event_);
 
   // store the ref
+  SpinLock kernelsLock(mutex_);
   auto kernelId = static_cast<KernelId>(nextKernelId_++);
   auto it = kernels_.find(kernelId);
   if (it != end(kernels_)) {
     throw Exception("Can't create kernel");
   }
   kernels_.emplace(kernelId, std::move(kernel));
-
-  // fill the struct results
-  LoadCodeResult loadCodeResult;
-  loadCodeResult.loadAddress_ = deviceBuffer;
+  if (shareable) {
+    codeImages_.emplace(imageHash, CodeImage{device, deviceBuffer, size + extraSize, entryPoint, signature,
+                                             std::vector<std::byte>(data, data + size), 1, loadCodeResult.event_});
+  }
+  kernelsLock.unlock();
   loadCodeResult.kernel_ = kernelId;
 
-  loadCodeResult.event_ = eventManager_.getNextId();
-  streamManager_.addEvent(stream, loadCodeResult.event_);
-  eventManager_.addOnDispatchCallback({std::move(events), [this, evt = loadCodeResult.event_] {
-                                         RT_VLOG(LOW) << "Load code ended.";
-                                         dispatch(evt);
-                                       }});
-  coreDumper_.addCodeAddress(DeviceId{stInfo.device_}, deviceBuffer);
+  // the host image has to be alive till all the copies are done
+  eventManager_.addOnDispatchCallback(
+    {std::move(events), [this, evt = loadCodeResult.event_, image = std::move(image), shareable, imageHash,
+                         deviceBuffer] {
+       RT_VLOG(LOW) << "Load code ended.";
+       if (shareable) {
+         SpinLock kernelsLock(mutex_);
+         auto [first, last] = codeImages_.equal_range(imageHash);
+         auto it =
+           std::find_if(first, last, [deviceBuffer](const auto& e) { return e.second.deviceBuffer_ == deviceBuffer; });
+         if (it != last) {
+           it->second.loadEvent_.reset();
+         }
+       }
+       dispatch(evt);
+     }});
+  coreDumper_.addCodeAddress(device, deviceBuffer);
   return loadCodeResult;
 }
 
@@ -329,17 +500,69 @@ void RuntimeImp::doUnloadCode(KernelId kernel) {
   auto it = find(kernels_, kernel);
   auto deviceId = it->second->deviceId_;
   auto deviceBuffer = it->second->deviceBuffer_;
+  auto imageHash = it->second->imageHash_;
   RT_VLOG(LOW) << "Unloading kernel from deviceId " << static_cast<std::underlying_type_t<DeviceId>>(deviceId)
                << " buffer: " << deviceBuffer;
 
-  // free the buffer
-  doFreeDevice(deviceId, it->second->deviceBuffer_);
-
-  // and remove the kernel
+  // remove the kernel
   kernels_.erase(it);
+  if (imageHash) {
+    auto [first, last] = codeImages_.equal_range(*imageHash);
+    auto image = std::find_if(first, last, [deviceId, deviceBuffer](const auto& entry) {
+      return entry.second.deviceId_ == deviceId && entry.second.deviceBuffer_ == deviceBuffer;
+    });
+    if (image != last && --image->second.refCount_ > 0) {
+      RT_VLOG(LOW) << "Code image still used by " << image->second.refCount_ << " kernels";
+      return;
+    }
+    if (image != last && image->second.size_ <= codeImageRetentionBytes_) {
+      // keep it loaded in case the same elf is loaded again, i.e. by the next run of the same client
+      image->second.retainedSeq_ = nextRetainedSeq_++;
+      retainedCodeImageBytes_ += image->second.size_;
+      RT_VLOG(LOW) << "Retaining code image at " << deviceBuffer << ". Retained bytes: " << retainedCodeImageBytes_;
+      auto evicted = evictRetainedCodeImages(codeImageRetentionBytes_);
+      lock.unlock();
+      freeCodeImages(evicted);
+      return;
+    }
+    if (image != last) {
+      codeImages_.erase(image);
+    }
+  }
+  lock.unlock();
+
+  // and free the buffer
+  doFreeDevice(deviceId, deviceBuffer);
   coreDumper_.removeCodeAddress(deviceId, deviceBuffer);
 }
 
+KernelId RuntimeImp::getRuntimeKernel(DeviceId device, const std::string& name) {
+  std::lock_guard lock(runtimeKernelsMutex_);
+  if (auto it = runtimeKernels_.find({device, name}); it != end(runtimeKernels_)) {
+    return it->second;
+  }
+  auto dir = getenv("ET_RUNTIME_KERNELS_DIR");
+  auto path = std::string{dir ? dir : RUNTIME_KERNELS_DIR} + "/" + name + ".elf";
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    throw Exception("Can't open the " + name + " kernel used by the runtime: " + path);
+  }
+  std::vector<char> elf{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+
+  // loaded on its own stream, the next commands of the caller stream must be able to use it right away
+  auto stream = doCreateStream(device, StreamPriority::Normal);
+  auto loadCodeResult = doLoadCode(stream, reinterpret_cast<const std::byte*>(elf.data()), elf.size());
+  auto loaded = doWaitForEvent(loadCodeResult.event_) && streamManager_.retrieveErrors(stream).empty();
+  doDestroyStream(stream);
+  if (!loaded) {
+    doUnloadCode(loadCodeResult.kernel_);
+    throw Exception("Loading the " + name + " kernel used by the runtime failed: " + path);
+  }
+  RT_VLOG(LOW) << "Loaded runtime kernel " << path << " as kernel " << static_cast<int>(loadCodeResult.kernel_);
+  runtimeKernels_.emplace(std::make_pair(device, name), loadCodeResult.kernel_);
+  return loadCodeResult.kernel_;
+}
+
 void recordMemoryStats(IProfilerRecorder& profiler, DeviceId device, const size_t free_bytes,
                        const size_t max_free_contiguous_bytes, const size_t allocated_memory) {
   ProfileEvent evt(Type::Counter, Class::MemoryStats);
@@ -352,6 +575,44 @@ void recordMemoryStats(IProfilerRecorder& profiler, DeviceId device, const size_
   profiler.record(evt);
 }
 
+std::vector<RuntimeImp::CodeImage> RuntimeImp::evictRetainedCodeImages(size_t maxBytes,
+                                                                        std::optional<DeviceId> device) {
+  std::vector<CodeImage> evicted;
+  while (retainedCodeImageBytes_ > maxBytes) {
+    auto oldest = end(codeImages_);
+    for (auto it = begin(codeImages_); it != end(codeImages_); ++it) {
+      const auto& image = it->second;
+      if (image.refCount_ == 0 && (!device || image.deviceId_ == *device) &&
+          (oldest == end(codeImages_) || image.retainedSeq_ < oldest->second.retainedSeq_)) {
+        oldest = it;
+      }
+    }
+    if (oldest == end(codeImages_)) {
+      break;
+    }
+    RT_VLOG(LOW) << "Evicting retained code image at " << oldest->second.deviceBuffer_;
+    retainedCodeImageBytes_ -= oldest->second.size_;
+    evicted.emplace_back(std::move(oldest->second));
+    codeImages_.erase(oldest);
+  }
+  return evicted;
+}
+
+void RuntimeImp::setCodeImageRetentionBytes(size_t bytes) {
+  SpinLock lock(mutex_);
+  codeImageRetentionBytes_ = bytes;
+  auto evicted = evictRetainedCodeImages(bytes);
+  lock.unlock();
+  freeCodeImages(evicted);
+}
+
+void RuntimeImp::freeCodeImages(const std::vector<CodeImage>& images) {
+  for (const auto& image : images) {
+    doFreeDevice(image.deviceId_, image.deviceBuffer_);
+    coreDumper_.removeCodeAddress(image.deviceId_, image.deviceBuffer_);
+  }
+}
+
 std::byte* RuntimeImp::doMallocDevice(DeviceId device, size_t size, uint32_t alignment) {
   RT_VLOG(LOW) << "Malloc requested device " << std::hex << static_cast<std::underlying_type_t<DeviceId>>(device)
                << " size: " << size << " alignment: " << alignment;
@@ -360,9 +621,24 @@ std::byte* RuntimeImp::doMallocDevice(DeviceId device, size_t size, uint32_t ali
     throw Exception("Alignment must be power of two");
   }
 
-  std::unique_lock lock(mutex_);
+  std::unique_lock lock(getDeviceMutex(device));
   auto it = find(memoryManagers_, device);
-  auto ptr = it->second.malloc(size, alignment);
+  std::byte* ptr = nullptr;
+  while (ptr == nullptr) {
+    try {
+      ptr = it->second.malloc(size, alignment);
+    } catch (const Exception&) {
+      // retained code images, and then managed allocations, are dropped before giving up
+      SpinLock kernelsLock(mutex_);
+      auto evicted = evictRetainedCodeImages(0, device);
+      kernelsLock.unlock();
+      if (!evicted.empty()) {
+        freeCodeImages(evicted);
+      } else if (!evictManagedAllocation(device)) {
+        throw;
+      }
+    }
+  }
   const size_t free_bytes = it->second.getFreeBytes();
   const size_t max_free_contiguous_bytes = it->second.getFreeContiguousBytes();
   const size_t allocated_memory = it->second.getTotalMemoryBytes() - free_bytes;
@@ -374,7 +650,11 @@ std::byte* RuntimeImp::doMallocDevice(DeviceId device, size_t size, uint32_t ali
 void RuntimeImp::doFreeDevice(DeviceId device, std::byte* buffer) {
   RT_VLOG(LOW) << "Free at device: " << static_cast<std::underlying_type_t<DeviceId>>(device)
                << " buffer address: " << std::hex << buffer;
-  std::unique_lock lock(mutex_);
+  std::unique_lock lock(getDeviceMutex(device));
+  if (auto pending = pendingAsyncFrees_.find(device);
+      pending != end(pendingAsyncFrees_) && pending->second.count(buffer) != 0) {
+    throw Exception("Ptr has a pending async free");
+  }
   auto it = find(memoryManagers_, device);
   it->second.free(buffer);
   const size_t free_bytes = it->second.getFreeBytes();
@@ -384,14 +664,64 @@ void RuntimeImp::doFreeDevice(DeviceId device, std::byte* buffer) {
   recordMemoryStats(*getProfiler(), device, free_bytes, max_free_contiguous_bytes, allocated_memory);
 }
 
-StreamId RuntimeImp::doCreateStream(DeviceId device) {
-  RT_VLOG(LOW) << "Creating stream at device: " << static_cast<std::underlying_type_t<DeviceId>>(device);
-  return streamManager_.createStream(device);
+void RuntimeImp::doFreeDeviceAsync(StreamId stream, std::byte* buffer) {
+  auto device = DeviceId{streamManager_.getStreamInfo(stream).device_};
+  SpinLock lock(getDeviceMutex(device));
+  if (!find(memoryManagers_, device)->second.isAllocation(buffer)) {
+    throw Exception("Ptr not allocated previously or double free");
+  }
+  // mark it at check time so a second free can't pass the check while the first one is still pending
+  if (!pendingAsyncFrees_[device].emplace(buffer).second) {
+    throw Exception("Ptr already has a pending async free");
+  }
+  lock.unlock();
+
+  // the free will be done once all the work submitted to the stream so far has been completed
+  std::vector<EventId> events;
+  try {
+    flushCoalescedMemcpys(stream);
+    events = streamManager_.getLiveEvents(stream);
+  } catch (...) {
+    SpinLock relock(getDeviceMutex(device));
+    pendingAsyncFrees_[device].erase(buffer);
+    throw;
+  }
+  RT_VLOG(LOW) << "Free async at device: " << static_cast<std::underlying_type_t<DeviceId>>(device)
+               << " buffer address: " << std::hex << buffer << " pending " << stringizeEvents(events);
+  if (events.empty()) {
+    completeFreeDeviceAsync(device, buffer);
+    return;
+  }
+  eventManager_.addOnDispatchCallback({std::move(events), [this, device, buffer] {
+                                         try {
+                                           completeFreeDeviceAsync(device, buffer);
+                                         } catch (const Exception& e) {
+                                           RT_LOG(WARNING) << "Async free of buffer " << std::hex << buffer
+                                                           << " failed: " << e.what();
+                                         }
+                                       }});
+}
+
+void RuntimeImp::completeFreeDeviceAsync(DeviceId device, std::byte* buffer) {
+  {
+    SpinLock lock(getDeviceMutex(device));
+    pendingAsyncFrees_[device].erase(buffer);
+  }
+  doFreeDevice(device, buffer);
+}
+
+StreamId RuntimeImp::doCreateStream(DeviceId device, StreamPriority priority) {
+  RT_VLOG(LOW) << "Creating stream at device: " << static_cast<std::underlying_type_t<DeviceId>>(device)
+               << " priority: " << (priority == StreamPriority::High ? "high" : "normal");
+  return streamManager_.createStream(device, priority);
 }
 
 void RuntimeImp::doDestroyStream(StreamId stream) {
   RT_VLOG(LOW) << "Destroying stream: " << static_cast<std::underlying_type_t<StreamId>>(stream);
+  doSetMemcpyCoalescing(stream, false);
   streamManager_.destroyStream(stream);
+  std::lock_guard lock(graphsMutex_);
+  captures_.erase(stream);
 }
 
 bool RuntimeImp::doWaitForEvent(EventId event, std::chrono::seconds timeout) {
@@ -401,6 +731,7 @@ bool RuntimeImp::doWaitForEvent(EventId event, std::chrono::seconds timeout) {
     return true;
   }
 
+  flushCoalescedMemcpys(event);
   RT_VLOG(LOW) << "Waiting for event " << static_cast<int>(event) << " to be dispatched.";
   auto res = eventManager_.blockUntilDispatched(event, timeout);
   RT_VLOG(LOW) << "Finished wait for event " << static_cast<int>(event) << " timed out? " << (res ? "false" : "true");
@@ -410,6 +741,7 @@ bool RuntimeImp::doWaitForEvent(EventId event, std::chrono::seconds timeout) {
 bool RuntimeImp::doWaitForStream(StreamId stream, std::chrono::seconds timeout) {
   auto start = std::chrono::steady_clock::now();
 
+  flushCoalescedMemcpys(stream);
   auto events = streamManager_.getLiveEvents(stream);
 
 #ifdef NDEBUG
@@ -470,6 +802,25 @@ void RuntimeImp::doSetOnKernelAbortedErrorCallback(const KernelAbortedCallback&
   kernelAbortedCallback_ = callback;
 }
 
+void RuntimeImp::doOnEventComplete(EventId event, EventCompletionCallback callback) {
+  // a pending coalesced memcpy wouldn't complete till something else is issued to its stream
+  flushCoalescedMemcpys(event);
+  SpinLock lock(mutex_);
+  auto executor = callbackExecutor_;
+  lock.unlock();
+  RT_VLOG(MID) << "Registering completion callback for event " << static_cast<int>(event);
+  // the event manager executor only hands the callback to the user executor, it doesn't run user code in that case
+  eventManager_.addOnDispatchCallback(
+    {{event}, [executor = std::move(executor), event, callback = std::move(callback)]() mutable {
+       runEventCompletionCallback(executor, event, std::move(callback));
+     }});
+}
+
+void RuntimeImp::doSetCallbackExecutor(CallbackExecutor executor) {
+  SpinLock lock(mutex_);
+  callbackExecutor_ = std::move(executor);
+}
+
 void RuntimeImp::handleKernelAbortedCallback(EventId event) {
   auto buffer = executionContextCache_->getReservedBuffer(event);
   auto exceptionContext = (buffer != nullptr ? buffer->getExceptionContextPtr() : nullptr);
@@ -538,12 +889,12 @@ void RuntimeImp::processResponseError(DeviceId device, const ResponseError& resp
         if (auto st = streamError.stream_; st.has_value()) {
           // if we reach here, there are no more events in associated stream so we can do the copy
           auto errorContexts = std::vector<ErrorContext>(kNumErrorContexts);
-          auto copyStream = doCreateStream(buffer->device_);
+          auto copyStream = doCreateStream(buffer->device_, StreamPriority::Normal);
           auto e = memcpyDeviceToHost(copyStream, buffer->getExceptionContextPtr(),
                                       reinterpret_cast<std::byte*>(errorContexts.data()), kExceptionBufferSize, false);
           doWaitForEvent(e);
           streamError.errorContext_.emplace(std::move(errorContexts));
-          SpinLock mmlock(mutex_);
+          SpinLock mmlock(getDeviceMutex(device));
           auto allocs = memoryManagers_.at(device).getAllocations();
           mmlock.unlock();
           coreDumper_.dump(event, allocs, streamError, *this);
@@ -599,20 +950,48 @@ void RuntimeImp::waitUntilAllowedToProcessResponseErrors(DeviceId device) {
 
 void RuntimeImp::onResponseReceived(DeviceId device, const std::vector<std::byte>& response) {
   EASY_FUNCTION()
+  if (processResponse(device, response)) {
+    dispatch(EventId{reinterpret_cast<const rsp_header_t*>(response.data())->rsp_hdr.tag_id});
+  }
+}
+
+void RuntimeImp::onResponsesReceived(DeviceId device, const std::vector<std::vector<std::byte>>& responses,
+                                     size_t count) {
+  EASY_FUNCTION()
+  std::vector<EventId> events;
+  events.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    // responses are already popped from the device, so an error in one of them must not discard the rest
+    try {
+      if (processResponse(device, responses[i])) {
+        events.emplace_back(EventId{reinterpret_cast<const rsp_header_t*>(responses[i].data())->rsp_hdr.tag_id});
+      }
+    } catch (const std::exception& e) {
+      RT_LOG(WARNING) << "Exception processing response " << i << " of a batch of " << count
+                      << " responses. Exception message: " << e.what();
+    }
+  }
+  dispatch(events);
+}
+
+bool RuntimeImp::processResponse(DeviceId device, const std::vector<std::byte>& response) {
   // check the response header
   auto header = reinterpret_cast<const rsp_header_t*>(response.data());
   auto eventId = EventId{header->rsp_hdr.tag_id};
 
-  auto recordEvent = [](auto& profiler, const auto& rsp, const auto& evt, ResponseType rspT) {
+  auto recordEvent = [this, device](auto& profiler, const auto& rsp, const auto& evt, ResponseType rspT) {
     RT_VLOG(HIGH) << std::hex << " Start time: " << rsp.device_cmd_start_ts << " Wait time: " << rsp.device_cmd_wait_dur
                   << " Execution time: " << rsp.device_cmd_execute_dur;
     ProfileEvent event(Type::Instant, Class::ResponseReceived);
     event.setEvent(evt);
+    event.setDeviceId(device);
     event.setResponseType(rspT);
     event.setDeviceCmdStartTs(rsp.device_cmd_start_ts);
     event.setDeviceCmdWaitDur(rsp.device_cmd_wait_dur);
     event.setDeviceCmdExecDur(rsp.device_cmd_execute_dur);
     profiler.record(event);
+    commandMetrics_->onResponse(device, evt, rspT, rsp.device_cmd_start_ts, rsp.device_cmd_wait_dur,
+                                rsp.device_cmd_execute_dur);
   };
 
   RT_VLOG(MID) << "Response received eventId: " << static_cast<int>(eventId)
@@ -629,9 +1008,10 @@ void RuntimeImp::onResponseReceived(DeviceId device, const std::vector<std::byte
       processResponseError(device, {convert(header->rsp_hdr.msg_id, r->status), eventId});
     } else {
       SpinLock lock(mutex_);
-      deviceApiVersion_.major = r->major;
-      deviceApiVersion_.minor = r->minor;
-      deviceApiVersion_.patch = r->patch;
+      auto& version = deviceApiVersions_[device];
+      version.major = r->major;
+      version.minor = r->minor;
+      version.patch = r->patch;
     }
     break;
   case device_ops_api::DEV_OPS_API_MID_DEVICE_OPS_KERNEL_ABORT_RSP:
@@ -656,6 +1036,142 @@ void RuntimeImp::onResponseReceived(DeviceId device, const std::vector<std::byte
     }
     break;
   }
+  case device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_DMA_CHAIN_RSP: {
+    auto r = reinterpret_cast<const device_ops_ext::device_ops_dma_chain_rsp_t*>(response.data());
+    recordEvent(*getProfiler(), *r, eventId, ResponseType::DMARead);
+    if (r->status != device_ops_api::DEV_OPS_API_DMA_RESPONSE_COMPLETE) {
+      responseWasOk = false;
+      RT_LOG(WARNING) << "Error on DMA chain: " << r->status << ". Tag id: " << static_cast<int>(eventId);
+      processResponseError(device, {convert(header->rsp_hdr.msg_id, r->status), eventId});
+    }
+    break;
+  }
+  case device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_STREAM_SYNC_RSP:
+    if (auto r = reinterpret_cast<const device_ops_ext::device_ops_stream_sync_rsp_t*>(response.data());
+        r->status != device_ops_ext::STREAM_SYNC_RESPONSE_SUCCESS) {
+      responseWasOk = false;
+      RT_LOG(WARNING) << "Error on stream sync: " << r->status << ". Tag id: " << static_cast<int>(eventId);
+      processResponseError(device, {convert(header->rsp_hdr.msg_id, r->status), eventId});
+    }
+    break;
+  case device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_MEMSET_RSP:
+    if (auto r = reinterpret_cast<const device_ops_ext::device_ops_memset_rsp_t*>(response.data());
+        r->status != device_ops_ext::MEMSET_RESPONSE_SUCCESS) {
+      responseWasOk = false;
+      RT_LOG(WARNING) << "Error on memset: " << r->status << ". Tag id: " << static_cast<int>(eventId);
+      processResponseError(device, {convert(header->rsp_hdr.msg_id, r->status), eventId});
+    }
+    break;
+  case device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_DEVICE_MEMCPY_RSP:
+    if (auto r = reinterpret_cast<const device_ops_ext::device_ops_device_memcpy_rsp_t*>(response.data());
+        r->status != device_ops_ext::DEVICE_MEMCPY_RESPONSE_SUCCESS) {
+      responseWasOk = false;
+      RT_LOG(WARNING) << "Error on device memcpy: " << r->status << ". Tag id: " << static_cast<int>(eventId);
+      processResponseError(device, {convert(header->rsp_hdr.msg_id, r->status), eventId});
+    }
+    break;
+  case device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_KERNEL_HEAP_CONFIG_RSP:
+    if (auto r = reinterpret_cast<const device_ops_ext::device_ops_kernel_heap_config_rsp_t*>(response.data());
+        r->status != device_ops_ext::KERNEL_HEAP_CONFIG_RESPONSE_SUCCESS) {
+      responseWasOk = false;
+      RT_LOG(WARNING) << "Error on kernel heap config: " << r->status << ". Tag id: " << static_cast<int>(eventId);
+      processResponseError(device, {convert(header->rsp_hdr.msg_id, r->status), eventId});
+    }
+    break;
+  case device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_KERNEL_FLUSH_RANGES_RSP:
+    if (auto r = reinterpret_cast<const device_ops_ext::device_ops_kernel_flush_ranges_rsp_t*>(response.data());
+        r->status != device_ops_ext::KERNEL_FLUSH_RANGES_RESPONSE_SUCCESS) {
+      responseWasOk = false;
+      RT_LOG(WARNING) << "Error on kernel flush ranges: " << r->status << ". Tag id: " << static_cast<int>(eventId);
+      processResponseError(device, {convert(header->rsp_hdr.msg_id, r->status), eventId});
+    }
+    break;
+  case device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_KERNEL_SHIRE_ARGS_RSP:
+    if (auto r = reinterpret_cast<const device_ops_ext::device_ops_kernel_shire_args_rsp_t*>(response.data());
+        r->status != device_ops_ext::KERNEL_SHIRE_ARGS_RESPONSE_SUCCESS) {
+      responseWasOk = false;
+      RT_LOG(WARNING) << "Error on kernel shire args: " << r->status << ". Tag id: " << static_cast<int>(eventId);
+      processResponseError(device, {convert(header->rsp_hdr.msg_id, r->status), eventId});
+    }
+    break;
+  case device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_KERNEL_WATCHDOG_RSP:
+    if (auto r = reinterpret_cast<const device_ops_ext::device_ops_kernel_watchdog_rsp_t*>(response.data());
+        r->status != device_ops_ext::KERNEL_WATCHDOG_RESPONSE_SUCCESS) {
+      responseWasOk = false;
+      RT_LOG(WARNING) << "Error on kernel watchdog: " << r->status << ". Tag id: " << static_cast<int>(eventId);
+      processResponseError(device, {convert(header->rsp_hdr.msg_id, r->status), eventId});
+    }
+    break;
+  case device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_KERNEL_LAUNCH_CONFIG_RSP:
+    if (auto r = reinterpret_cast<const device_ops_ext::device_ops_kernel_launch_config_rsp_t*>(response.data());
+        r->status != device_ops_ext::KERNEL_LAUNCH_CONFIG_RESPONSE_SUCCESS) {
+      responseWasOk = false;
+      RT_LOG(WARNING) << "Error on kernel launch config: " << r->status << ". Tag id: " << static_cast<int>(eventId);
+      processResponseError(device, {convert(header->rsp_hdr.msg_id, r->status), eventId});
+    }
+    break;
+  case device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_KERNEL_POWER_REPORT_RSP: {
+    // copied since the report is optional for the fake device layers
+    device_ops_ext::device_ops_kernel_power_report_rsp_t r{};
+    std::memcpy(&r, response.data(), std::min(response.size(), sizeof(r)));
+    if (r.status == device_ops_ext::KERNEL_POWER_REPORT_RESPONSE_HOST_ABORTED) {
+      responseWasOk = false;
+      RT_LOG(WARNING) << "Error on kernel power report: " << r.status << ". Tag id: " << static_cast<int>(eventId);
+      processResponseError(device, {convert(header->rsp_hdr.msg_id, r.status), eventId});
+    }
+    onKernelPowerReport(device, eventId, r);
+    break;
+  }
+  case device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_KERNEL_MULTI_LAUNCH_RSP: {
+    // copied since the entries are optional for the fake device layers
+    device_ops_ext::device_ops_kernel_multi_launch_rsp_t r{};
+    std::memcpy(&r, response.data(), std::min(response.size(), sizeof(r)));
+    recordEvent(*getProfiler(), r, eventId, ResponseType::Kernel);
+    if (r.status != device_ops_ext::KERNEL_MULTI_LAUNCH_RESPONSE_COMPLETED) {
+      responseWasOk = false;
+      RT_LOG(WARNING) << "Error on kernel multi-launch: " << r.status << ". Tag id: " << static_cast<int>(eventId);
+      ResponseError re{convert(header->rsp_hdr.msg_id, r.status), eventId};
+      if (r.status == device_ops_ext::KERNEL_MULTI_LAUNCH_RESPONSE_ENTRY_FAILED) {
+        // the event takes the error of the first kernel which failed
+        bool first = true;
+        uint32_t count = r.count;
+        for (uint32_t i = 0; i < std::min(count, device_ops_ext::kKernelMultiLaunchMax); ++i) {
+          if (r.entry_status[i] == device_ops_api::DEV_OPS_API_KERNEL_LAUNCH_RESPONSE_KERNEL_COMPLETED) {
+            continue;
+          }
+          RT_LOG(WARNING) << "Kernel " << i << " of the multi-launch failed: " << r.entry_status[i];
+          if (first) {
+            re.errorCode_ = convert(device_ops_api::DEV_OPS_API_MID_DEVICE_OPS_KERNEL_LAUNCH_RSP, r.entry_status[i]);
+            first = false;
+          }
+        }
+        re.kernelLaunchErrorExtra_ = {nullptr, nullptr, r.cm_error_shire_mask};
+      }
+      processResponseError(device, re);
+    } else if (executionContextCache_) {
+      executionContextCache_->releaseBuffer(eventId);
+    }
+    break;
+  }
+  case device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_CMD_LIST_EXECUTE_RSP: {
+    device_ops_ext::device_ops_cmd_list_execute_rsp_t r{};
+    std::memcpy(&r, response.data(), std::min(response.size(), sizeof(r)));
+    recordEvent(*getProfiler(), r, eventId, ResponseType::Kernel);
+    if (r.status != device_ops_ext::CMD_LIST_RESPONSE_SUCCESS) {
+      responseWasOk = false;
+      RT_LOG(WARNING) << "Error on command list: " << r.status << ". Failed command: " << r.failed_stage
+                      << " status: " << r.stage_status << ". Tag id: " << static_cast<int>(eventId);
+      // the event takes the error of the command which failed
+      auto errorCode = r.status == device_ops_ext::CMD_LIST_RESPONSE_STAGE_FAILED
+                         ? convert(r.stage_msg_id, r.stage_status)
+                         : convert(header->rsp_hdr.msg_id, r.status);
+      processResponseError(device, {errorCode, eventId});
+    } else if (executionContextCache_ && executionContextCache_->getReservedBuffer(eventId) != nullptr) {
+      // only the lists with kernel launches have an execution context
+      executionContextCache_->releaseBuffer(eventId);
+    }
+    break;
+  }
   case device_ops_api::DEV_OPS_API_MID_DEVICE_OPS_ABORT_RSP:
     unlockProcessingResponseErrors(device, eventId);
     if (auto r = reinterpret_cast<const device_ops_api::device_ops_abort_rsp_t*>(response.data());
@@ -679,6 +1195,8 @@ void RuntimeImp::onResponseReceived(DeviceId device, const std::vector<std::byte
     auto r = reinterpret_cast<const device_ops_api::device_ops_kernel_launch_rsp_t*>(response.data());
     recordEvent(*getProfiler(), *r, eventId, ResponseType::Kernel);
     RT_LOG(INFO) << "KernelLaunch Reponse Event: " << int(eventId);
+    // the kernel doesn't run anymore, whatever its status
+    find(shireSchedulers_, device)->second->releaseEvent(eventId);
     if (r->status !=
         device_ops_api::DEV_OPS_API_KERNEL_LAUNCH_RESPONSE::DEV_OPS_API_KERNEL_LAUNCH_RESPONSE_KERNEL_COMPLETED) {
       responseWasOk = false;
@@ -729,9 +1247,13 @@ void RuntimeImp::onResponseReceived(DeviceId device, const std::vector<std::byte
   }
   case device_ops_api::DEV_OPS_API_MID_DEVICE_OPS_TRACE_BUFFER_FULL_EVENT: {
     auto r = reinterpret_cast<const device_ops_api::device_ops_trace_buffer_full_event_t*>(response.data());
-    RT_LOG(WARNING) << "Reported asynchronous event from firmware: Trace buffer full. This is ignored by host runtime. "
-                       "Trace buffer type: "
-                    << r->buffer_type;
+    if (r->buffer_type == kMasterMinionTraceBuffer) {
+      drainMasterMinionTrace(device, r->data_size);
+    } else {
+      RT_LOG(WARNING) << "Reported asynchronous event from firmware: Trace buffer full. This is ignored by host "
+                         "runtime. Trace buffer type: "
+                      << r->buffer_type;
+    }
     break;
   }
   case device_ops_api::DEV_OPS_API_MID_DEVICE_OPS_P2PDMA_READLIST_RSP:
@@ -752,9 +1274,7 @@ void RuntimeImp::onResponseReceived(DeviceId device, const std::vector<std::byte
   }
   // If response wasn't ok, then processResponseError will clean events.
   // In addition, abort callbacks delay dispatching to the end of the callback.
-  if (responseWasOk and !skipDispatch) {
-    dispatch(eventId);
-  }
+  return responseWasOk and !skipDispatch;
 }
 
 void RuntimeImp::setMemoryManagerDebugMode(DeviceId device, bool enable) {
@@ -779,7 +1299,7 @@ std::vector<StreamError> RuntimeImp::doRetrieveStreamErrors(StreamId stream) {
   return streamManager_.retrieveErrors(stream);
 }
 void RuntimeImp::checkDeviceApi(DeviceId device) {
-  auto st = doCreateStream(device);
+  auto st = doCreateStream(device, StreamPriority::Normal);
   auto streamInfo = streamManager_.getStreamInfo(st);
   auto evt = eventManager_.getNextId();
   streamManager_.addEvent(st, evt);
@@ -793,18 +1313,24 @@ void RuntimeImp::checkDeviceApi(DeviceId device) {
   doWaitForStream(st);
   doDestroyStream(st);
   // now the responsereceiver will put the data into deviceapi field, check that
-  if (!deviceApiVersion_.isValid()) {
+  DeviceApiVersion version;
+  {
+    SpinLock lock(mutex_);
+    version = deviceApiVersions_[device];
+  }
+  if (!version.isValid()) {
     throw Exception("Runtime couldn't retrieve a valid device-api version.");
   }
-  RT_LOG(INFO) << "Device API version: " << deviceApiVersion_.major << "." << deviceApiVersion_.minor << "."
-               << deviceApiVersion_.patch;
-  if (deviceApiVersion_.major != 2) {
+  RT_LOG(INFO) << "Device " << static_cast<int>(device) << " API version: " << version.major << "." << version.minor
+               << "." << version.patch;
+  if (version.major != 2) {
     throw Exception("Incompatible device-api version. This runtime version supports device-api 2.X.Y.");
   }
 }
 
 EventId RuntimeImp::doAbortCommand(EventId commandId, std::chrono::milliseconds timeout) {
   using namespace std::chrono_literals;
+  flushCoalescedMemcpys(commandId);
   auto stInfo = streamManager_.getStreamInfo(commandId);
   auto evt = eventManager_.getNextId();
   if (!stInfo) {
@@ -840,6 +1366,7 @@ EventId RuntimeImp::doAbortCommand(EventId commandId, std::chrono::milliseconds
 }
 
 EventId RuntimeImp::doAbortStream(StreamId streamId) {
+  flushCoalescedMemcpys(streamId);
   auto events = streamManager_.getLiveEvents(streamId);
   if (events.empty()) {
     RT_LOG(WARNING) << "Trying to abort stream " << static_cast<int>(streamId) << " but it had no outstanding events.";
@@ -869,10 +1396,39 @@ void RuntimeImp::dispatch(EventId event) {
   evt.setEvent(event);
   getProfiler()->record(evt);
   streamManager_.removeEvent(event);
+  commandMetrics_->onDispatching(event);
   eventManager_.dispatch(event);
+  commandMetrics_->onDispatched(event);
   notify(event);
 }
 
+void RuntimeImp::dispatch(const std::vector<EventId>& events) {
+  EASY_FUNCTION(profiler::colors::Green)
+  if (events.empty()) {
+    return;
+  }
+  if (!running_) {
+    RT_LOG(WARNING) << "Trying to dispatch " << events.size()
+                    << " events but runtime is not running. Ignoring the dispatch.";
+    return;
+  }
+  for (auto event : events) {
+    ProfileEvent evt(Type::Instant, Class::DispatchEvent);
+    evt.setEvent(event);
+    getProfiler()->record(evt);
+  }
+  streamManager_.removeEvents(events);
+  for (auto event : events) {
+    commandMetrics_->onDispatching(event);
+  }
+  eventManager_.dispatch(events);
+  auto now = CommandMetrics::Clock::now();
+  for (auto event : events) {
+    commandMetrics_->onDispatched(event, now);
+    notify(event);
+  }
+}
+
 void RuntimeImp::checkDevice(DeviceId device) {
   auto state = deviceLayer_->getDeviceStateMasterMinion(static_cast<int>(device));
   RT_VLOG(LOW) << "Device state: " << static_cast<int>(state) << " Runtime running: " << (running_ ? "True" : "False");
@@ -889,13 +1445,18 @@ void RuntimeImp::checkDevice(DeviceId device) {
 
 void RuntimeImp::abortDevice(DeviceId device) {
   EASY_FUNCTION()
-  using namespace std::chrono_literals;
-
   // we need to ensure runtime is in running state to allow dispatch and waitForStream to work properly
   auto oldRunningState = running_;
   running_ = true;
+  abortDeviceQueues(device);
+  running_ = oldRunningState;
+}
+
+void RuntimeImp::abortDeviceQueues(DeviceId device) {
+  using namespace std::chrono_literals;
   for (auto sq = 0, sqCount = deviceLayer_->getSubmissionQueuesCount(static_cast<int>(device)); sq < sqCount; ++sq) {
-    auto st = doCreateStream(device);
+    // one stream per submission queue, so all of them get the abort
+    auto st = streamManager_.createStream(device, sq);
     auto fakeEvt = eventManager_.getNextId();
     streamManager_.addEvent(st, fakeEvt);
     abortCommand(fakeEvt, 5s);
@@ -903,22 +1464,15 @@ void RuntimeImp::abortDevice(DeviceId device) {
     doWaitForStream(st);
     doDestroyStream(st);
   }
-  running_ = oldRunningState;
 }
 
 void RuntimeImp::checkList(int device, const MemcpyList& list) const {
   EASY_FUNCTION()
-  auto dmaInfo = deviceLayer_->getDmaInfo(device);
-  if (list.operations_.size() > dmaInfo.maxElementCount_) {
-    throw Exception("Invalid element count in memcpy list. Max elements allowed is:" +
-                    std::to_string(dmaInfo.maxElementCount_));
-  }
+  // ops are split in as many DMA entries and commands as needed, only the whole list has to fit in CMA since it's staged
+  // at once
   size_t totalSize = 0;
   for (auto& op : list.operations_) {
     totalSize += op.size_;
-    if (op.size_ > dmaInfo.maxElementSize_) {
-      throw Exception("Invalid size in memcpy list. Max size available is: " + std::to_string(dmaInfo.maxElementSize_));
-    }
   }
   if (totalSize > cmaManagers_.at(DeviceId{device})->getTotalSize()) {
     throw Exception("Required total size for the list is: " + std::to_string(totalSize) +
@@ -929,8 +1483,8 @@ void RuntimeImp::checkList(int device, const MemcpyList& list) const {
 
 std::unordered_map<DeviceId, uint64_t> RuntimeImp::getFreeMemory() const {
   std::unordered_map<DeviceId, uint64_t> res;
-  SpinLock lock(mutex_);
   for (auto d : devices_) {
+    SpinLock lock(getDeviceMutex(d));
     res.emplace(d, memoryManagers_.at(d).getFreeBytes());
   }
   return res;
@@ -955,6 +1509,95 @@ std::unordered_map<DeviceId, uint32_t> RuntimeImp::getAliveEvents() const {
   return streamManager_.getEventCount();
 }
 
+std::optional<EventTiming> RuntimeImp::doGetEventTiming(EventId event) {
+  if (!eventManager_.isDispatched(event)) {
+    return {};
+  }
+  return commandMetrics_->getEventTiming(event);
+}
+
+std::unordered_map<DeviceId, DeviceMetrics> RuntimeImp::getDeviceMetrics() const {
+  return commandMetrics_->getMetrics();
+}
+
+std::unordered_map<DeviceId, std::vector<UtilizationSample>> RuntimeImp::getDeviceUtilization() const {
+  std::unordered_map<DeviceId, std::vector<UtilizationSample>> res;
+  for (auto d : devices_) {
+    auto buffer = std::vector<std::byte>{};
+    auto& samples = res[d];
+    if (deviceLayer_->getTraceBufferServiceProcessor(static_cast<int>(d), dev::TraceBufferType::TraceBufferMMStats,
+                                                     buffer)) {
+      samples = decodeUtilizationSamples(buffer);
+    }
+  }
+  return res;
+}
+
+void RuntimeImp::doSetMasterMinionTraceOutput(DeviceId device, std::ostream* output) {
+  SpinLock lock(getDeviceMutex(device));
+  auto& tracing = find(deviceTracing_, device)->second;
+  if (output != nullptr && tracing.dmaBufferSize_ == 0) {
+    auto devInt = static_cast<int>(device);
+    tracing.dmaBufferSize_ =
+      deviceLayer_->getTraceBufferSizeMasterMinion(devInt, dev::TraceBufferType::TraceBufferCM) +
+      deviceLayer_->getTraceBufferSizeMasterMinion(devInt, dev::TraceBufferType::TraceBufferMM);
+  }
+  tracing.mmOutput_ = output;
+}
+
+void RuntimeImp::drainMasterMinionTrace(DeviceId device, uint32_t size) {
+  // the response thread must not wait for the device mutex, the drain is issued from the device thread pool
+  find(threadPools_, device)->second->pushTask([this, device, size] {
+    SpinLock lock(getDeviceMutex(device));
+    auto& tracing = find(deviceTracing_, device)->second;
+    if (tracing.mmOutput_ == nullptr) {
+      RT_VLOG(LOW) << "MasterMinion trace buffer full, there is no output set to drain it to. Device: "
+                   << static_cast<int>(device);
+      return;
+    }
+    if (!tracing.drainStream_) {
+      tracing.drainStream_ = doCreateStream(device, StreamPriority::Normal);
+    }
+    auto streamInfo = streamManager_.getStreamInfo(*tracing.drainStream_);
+    auto& commandSender = find(commandSenders_, getCommandSenderIdx(streamInfo.device_, streamInfo.vq_))->second;
+    auto evt = eventManager_.getNextId();
+    streamManager_.addEvent(*tracing.drainStream_, evt);
+
+    std::shared_ptr<IDmaBuffer> dmaBuffer;
+    {
+      std::lock_guard buffersLock(tracing.dmaBuffersMutex_);
+      if (!tracing.freeDmaBuffers_.empty()) {
+        dmaBuffer = std::move(tracing.freeDmaBuffers_.back());
+        tracing.freeDmaBuffers_.pop_back();
+      }
+    }
+    if (!dmaBuffer) {
+      dmaBuffer =
+        std::make_shared<DmaBufferImp>(static_cast<int>(device), tracing.dmaBufferSize_, true, *deviceLayer_);
+    }
+
+    // the firmware reads from the full half itself, the device address is ignored
+    auto buffer = dmaBuffer->getPtr();
+    auto bytes = std::min<size_t>(size, dmaBuffer->getSize());
+    MemcpyCommandBuilder builder(MemcpyType::D2H, false, 1);
+    builder.setTagId(evt);
+    builder.addOp(buffer, nullptr, bytes);
+    auto cmd = builder.build();
+    reinterpret_cast<device_ops_api::device_ops_dma_readlist_cmd_t*>(cmd.data())->command_info.cmd_hdr.flags |=
+      device_ops_api::CMD_FLAGS_MMFW_TRACEBUF;
+    RT_VLOG(LOW) << "Draining " << bytes << " bytes of MasterMinion trace. Device: " << static_cast<int>(device)
+                 << " EventId: " << static_cast<int>(evt);
+
+    eventManager_.addOnDispatchCallback(
+      {{evt}, [output = tracing.mmOutput_, &tracing, dmaBuffer = std::move(dmaBuffer), buffer, bytes] {
+         output->write(reinterpret_cast<const char*>(buffer), static_cast<std::streamsize>(bytes));
+         std::lock_guard buffersLock(tracing.dmaBuffersMutex_);
+         tracing.freeDmaBuffers_.emplace_back(dmaBuffer);
+       }});
+    commandSender.send(Command{std::move(cmd), commandSender, evt, evt, *tracing.drainStream_, true, true});
+  });
+}
+
 bool RuntimeImp::doIsP2PEnabled(DeviceId one, DeviceId other) const {
   return deviceLayer_->checkP2pDmaCompatibility(static_cast<int>(one), static_cast<int>(other));
 }
@@ -1008,3 +1651,17 @@ std::tuple<ELFIO::Elf64_Addr, size_t> getELFBaseAddr(const ELFIO::elfio& elf) {
   }
   return std::make_tuple(elfBaseAddr, extraSize);
 }
+
+std::optional<uint64_t> getKernelSignature(const ELFIO::elfio& elf) {
+  for (const auto& section : elf.sections) {
+    if (section->get_name() == kKernelSignatureSection) {
+      uint64_t signature;
+      if (section->get_size() != sizeof(signature) || section->get_data() == nullptr) {
+        throw Exception("Invalid kernel signature section in elf");
+      }
+      std::memcpy(&signature, section->get_data(), sizeof(signature));
+      return signature;
+    }
+  }
+  return std::nullopt;
+}
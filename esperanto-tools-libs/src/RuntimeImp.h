@@ -5,29 +5,40 @@
 
 #pragma once
 
+#include "CommandMetrics.h"
 #include "CommandSender.h"
 #include "CoreDumper.h"
 #include "EventManager.h"
+#include "MemcpyOps.h"
 #include "MemoryManager.h"
 #include "Observer.h"
 #include "ProfilerImp.h"
 #include "ResponseReceiver.h"
+#include "ShireScheduler.h"
 #include "StreamManager.h"
 #include "Utils.h"
 
 #include "dma/CmaManager.h"
 #include "dma/IDmaBuffer.h"
+#include "runtime/DeviceOpsExt.h"
 #include "runtime/IProfileEvent.h"
 #include "runtime/IRuntime.h"
 #include "runtime/Types.h"
 
 #include <hostUtils/threadPool/ThreadPool.h>
+#include <hostUtils/threadPool/WorkStealingThreadPool.h>
 
 #include <algorithm>
+#include <atomic>
+#include <bitset>
 #include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <type_traits>
 #include <unordered_map>
+#include <unordered_set>
 
 namespace rt {
 class ExecutionContextCache;
@@ -57,8 +68,9 @@ public:
 
   std::byte* doMallocDevice(DeviceId device, size_t size, uint32_t alignment = kCacheLineSize) final;
   void doFreeDevice(DeviceId device, std::byte* buffer) final;
+  void doFreeDeviceAsync(StreamId stream, std::byte* buffer) final;
 
-  StreamId doCreateStream(DeviceId device) final;
+  StreamId doCreateStream(DeviceId device, StreamPriority priority) final;
   void doDestroyStream(StreamId stream) final;
 
   EventId doKernelLaunch(StreamId stream, KernelId kernel, const std::byte* kernel_args, size_t kernel_args_size,
@@ -67,10 +79,20 @@ public:
                                const CmaCopyFunction& cmaCopyFunction) final;
   EventId doMemcpyDeviceToHost(StreamId stream, const std::byte* src, std::byte* dst, size_t size, bool barrier,
                                const CmaCopyFunction& cmaCopyFunction) final;
+  EventId doMemcpyHostToDeviceConverted(StreamId stream, const float* h_src, std::byte* d_dst, size_t count,
+                                        const MemcpyConversion& conversion, bool barrier) final;
+  EventId doMemcpyDeviceToHostConverted(StreamId stream, const std::byte* d_src, float* h_dst, size_t count,
+                                        const MemcpyConversion& conversion, bool barrier) final;
+  EventId doMemcpyHostToDeviceCompressed(StreamId stream, const std::vector<CompressedChunk>& chunks, std::byte* d_dst,
+                                         uint64_t shireMask) final;
+  EventId doMemcpyHostToDeviceChecked(StreamId stream, const std::byte* h_src, std::byte* d_dst, size_t size,
+                                      uint64_t shireMask, bool barrier) final;
   EventId doMemcpyHostToDevice(StreamId stream, MemcpyList memcpyList, bool barrier,
                                const CmaCopyFunction& cmaCopyFunction) final;
   EventId doMemcpyDeviceToHost(StreamId stream, MemcpyList memcpyList, bool barrier,
                                const CmaCopyFunction& cmaCopyFunction) final;
+  EventId doMemcpyHostToDeviceChained(StreamId stream, MemcpyList memcpyList) final;
+  EventId doMemcpyDeviceToHostChained(StreamId stream, MemcpyList memcpyList) final;
   EventId doMemcpyDeviceToDevice(StreamId streamSrc, DeviceId deviceDst, const std::byte* d_src, std::byte* d_dst,
                                  size_t size, bool barrier) final;
   EventId doMemcpyDeviceToDevice(DeviceId deviceSrc, StreamId streamDst, const std::byte* d_src, std::byte* d_dst,
@@ -85,6 +107,11 @@ public:
 
   void doSetOnStreamErrorsCallback(StreamErrorCallback callback) final;
 
+  void doOnEventComplete(EventId event, EventCompletionCallback callback) final;
+  std::optional<EventTiming> doGetEventTiming(EventId event) final;
+
+  void doSetCallbackExecutor(CallbackExecutor executor) final;
+
   void doSetOnKernelAbortedErrorCallback(const KernelAbortedCallback& callback) final;
 
   std::vector<StreamError> doRetrieveStreamErrors(StreamId stream) final;
@@ -93,6 +120,68 @@ public:
 
   bool doIsP2PEnabled(DeviceId one, DeviceId other) const final;
 
+  void doRegisterHostBuffer(DeviceId device, const std::byte* h_ptr, size_t size, bool toDeviceOnly) final;
+
+  void doUnregisterHostBuffer(DeviceId device, const std::byte* h_ptr) final;
+
+  std::byte* doAllocHostBuffer(DeviceId device, size_t size) final;
+
+  void doFreeHostBuffer(DeviceId device, std::byte* h_ptr) final;
+
+  void doBeginCapture(StreamId stream) final;
+
+  GraphId doEndCapture(StreamId stream) final;
+
+  void doUploadGraph(StreamId stream, GraphId graph) final;
+  EventId doLaunchGraph(StreamId stream, GraphId graph, const std::vector<GraphArgPatch>& patches) final;
+
+  void doDestroyGraph(GraphId graph) final;
+
+  EventId doStreamWaitEvent(StreamId stream, EventId event) final;
+
+  EventId doLaunchHostFunc(StreamId stream, HostFunc func) final;
+
+  EventId doFillDevice(StreamId stream, std::byte* d_dst, uint64_t pattern, size_t patternSize, size_t size,
+                       bool barrier) final;
+
+  EventId doMemcpyWithinDevice(StreamId stream, const std::byte* d_src, std::byte* d_dst, size_t size,
+                               bool barrier) final;
+
+  EventId doSetKernelHeap(StreamId stream, std::byte* d_heap, size_t size, bool barrier) final;
+
+  DeviceHandle doMallocDeviceHandle(DeviceId device, size_t size, uint32_t alignment) final;
+  void doFreeDeviceHandle(DeviceHandle handle) final;
+  std::byte* doResolveDeviceHandle(DeviceHandle handle) const final;
+  size_t doCompactDeviceMemory(DeviceId device) final;
+  DeviceHandle doMallocManaged(DeviceId device, size_t size, uint32_t alignment) final;
+  void doPrefetchManaged(StreamId stream, const std::vector<DeviceHandle>& handles) final;
+
+  EventId doKernelLaunchMulti(StreamId stream, const std::vector<LaunchDesc>& launches, bool barrier) final;
+
+  EventId doKernelLaunchSigned(StreamId stream, KernelId kernel, uint64_t signature, const std::byte* kernel_args,
+                               size_t kernel_args_size, const KernelLaunchOptionsImp& options) final;
+
+  DeviceGroupId doCreateDeviceGroup(const std::vector<DeviceId>& devices, StreamPriority priority) final;
+  void doDestroyDeviceGroup(DeviceGroupId group) final;
+  StreamId doGetDeviceGroupStream(DeviceGroupId group, DeviceId device) const final;
+  std::vector<DeviceId> doGetDeviceGroupDevices(DeviceGroupId group) const final;
+  EventId doLaunchOnGroup(DeviceGroupId group, const std::vector<KernelId>& kernels,
+                          const std::vector<std::vector<std::byte>>& kernelArgs,
+                          const KernelLaunchOptionsImp& options) final;
+  EventId doScatter(DeviceGroupId group, const std::byte* h_src, const std::vector<std::byte*>& d_dsts,
+                    size_t shardSize, bool barrier) final;
+  EventId doGather(DeviceGroupId group, const std::vector<const std::byte*>& d_srcs, std::byte* h_dst,
+                   size_t shardSize, bool barrier) final;
+
+  std::optional<KernelPowerState> doGetEventPowerState(EventId event) final;
+  void doSetShireBudget(DeviceId device, int maxActiveShires) final;
+  int doGetShireBudget(DeviceId device) const final;
+  void doSetShireBudgetPolicy(ShireBudgetPolicy policy) final;
+
+  void doSetMemcpyCoalescing(StreamId stream, bool enabled) final;
+
+  void doSetMasterMinionTraceOutput(DeviceId device, std::ostream* output) final;
+
   ~RuntimeImp() final;
 
   KernelLaunchOptions createKernelLaunchOptions(const rt::KernelLaunchOptionsImp& kOptImp) {
@@ -102,9 +191,13 @@ public:
   // IResponseServices
   bool areEventsOnFly(DeviceId device) const final;
   void onResponseReceived(DeviceId device, const std::vector<std::byte>& response) final;
+  void onResponsesReceived(DeviceId device, const std::vector<std::vector<std::byte>>& responses,
+                           size_t count) final;
 
   // this method is a helper to call eventManager dispatch and streamManager removeEvent
   void dispatch(EventId event);
+  // same as above but for several events, taking eventManager and streamManager locks just once
+  void dispatch(const std::vector<EventId>& events);
 
   // these methods are intended for debugging, internal use only
   void setMemoryManagerDebugMode(DeviceId device, bool enable);
@@ -112,6 +205,8 @@ public:
     checkMemcpyDeviceAddress_ = value;
   }
   void setSentCommandCallback(DeviceId device, CommandSender::CommandSentCallback callback);
+  // see Options::codeImageRetentionBytes_; retained images beyond the new limit are freed
+  void setCodeImageRetentionBytes(size_t bytes);
 
   // methods not part of the public API, used mainly for client/server implementation
   std::unordered_map<DeviceId, uint64_t> getFreeMemory() const;
@@ -120,6 +215,10 @@ public:
 
   std::unordered_map<DeviceId, uint32_t> getAliveEvents() const;
 
+  std::unordered_map<DeviceId, DeviceMetrics> getDeviceMetrics() const;
+
+  std::unordered_map<DeviceId, std::vector<UtilizationSample>> getDeviceUtilization() const;
+
 private:
   friend ExecutionContextCache;
 
@@ -127,11 +226,17 @@ private:
 
   void onProfilerChanged() override;
 
+  // drops the pending mark of an async free and releases the buffer
+  void completeFreeDeviceAsync(DeviceId device, std::byte* buffer);
+
   struct Kernel {
-    Kernel(DeviceId deviceId, std::byte* deviceBuffer, uint64_t entryPoint)
+    Kernel(DeviceId deviceId, std::byte* deviceBuffer, uint64_t entryPoint, std::optional<size_t> imageHash = {},
+           std::optional<uint64_t> signature = {})
       : deviceId_(deviceId)
       , deviceBuffer_(deviceBuffer)
-      , entryPoint_(entryPoint) {
+      , entryPoint_(entryPoint)
+      , imageHash_(imageHash)
+      , signature_(signature) {
       RT_VLOG(LOW) << std::hex << "Kernel loaded at device: " << static_cast<std::underlying_type_t<DeviceId>>(deviceId)
                    << " at address: " << deviceBuffer_ << " with entry point: " << entryPoint;
     }
@@ -146,12 +251,35 @@ private:
     DeviceId deviceId_;
     std::byte* deviceBuffer_;
     uint64_t entryPoint_;
+    // set when the device buffer is a code image shared with other kernels
+    std::optional<size_t> imageHash_;
+    // arguments signature declared by the elf, see ET_KERNEL_SIGNATURE
+    std::optional<uint64_t> signature_;
+  };
+
+  // device code loaded from an elf, shared by all the kernels loaded from the same elf into the same device. Only
+  // read-only images are shared, each kernel must get its own copy of writable data and bss
+  struct CodeImage {
+    DeviceId deviceId_;
+    std::byte* deviceBuffer_;
+    size_t size_; // bytes of the device buffer
+    uint64_t entryPoint_;
+    std::optional<uint64_t> signature_;
+    std::vector<std::byte> elf_; // kept to tell apart different elfs with the same hash
+    size_t refCount_ = 1;
+    std::optional<EventId> loadEvent_; // set till the image has been copied into the device
+    uint64_t retainedSeq_ = 0;         // order in which images with no kernels were retained, to evict the oldest
   };
 
   struct DeviceFwTracing {
-    std::unique_ptr<IDmaBuffer> dmaBuffer_;
-    std::ostream* mmOutput_;
-    std::ostream* cmOutput_;
+    size_t dmaBufferSize_ = 0; // set once there is a MasterMinion trace output
+    // each outstanding drain has a dma buffer of its own till its data is written out, so the firmware can notify the
+    // next full half meanwhile; the buffers of the completed drains are kept here for the following ones
+    std::mutex dmaBuffersMutex_;
+    std::vector<std::shared_ptr<IDmaBuffer>> freeDmaBuffers_;
+    std::ostream* mmOutput_ = nullptr;
+    std::ostream* cmOutput_ = nullptr;
+    std::optional<StreamId> drainStream_ = std::nullopt; // created on the first MasterMinion trace drain
   };
   struct ResponseError {
     struct KernelLaunchErrorExtra {
@@ -164,13 +292,148 @@ private:
     std::optional<KernelLaunchErrorExtra> kernelLaunchErrorExtra_ = std::nullopt;
   };
   void processResponseError(DeviceId device, const ResponseError& error);
+  // handles a response; returns true if the associated event must be dispatched by the caller
+  bool processResponse(DeviceId device, const std::vector<std::byte>& response);
 
   void abortDevice(DeviceId d);
+  // aborts the commands of all the submission queues of the device; the runtime must be running
+  void abortDeviceQueues(DeviceId d);
 
   void checkDeviceApi(DeviceId d);
 
+  // reads into mmOutput_ the MasterMinion trace half the firmware notified as full, in the background
+  void drainMasterMinionTrace(DeviceId device, uint32_t size);
+
   void checkList(int device, const MemcpyList& list) const;
 
+  // returns the kernel <name>.elf the runtime uses internally (ie. crc32_check), loading it the first time it's used on
+  // the device; see RUNTIME_KERNELS_DIR in Constants.h. Blocks till the code is loaded, so the device mutex must not
+  // be held
+  KernelId getRuntimeKernel(DeviceId device, const std::string& name);
+  // same as launchHostFunc, but the task gets the event of the launch, so it can report stream errors on it
+  EventId launchHostTask(StreamId stream, std::function<void(EventId)> task);
+
+  // queues a memcpy list as a single DMA chain, see memcpyHostToDeviceChained
+  EventId memcpyChained(MemcpyType type, StreamId stream, MemcpyList memcpyList);
+
+  struct HostBuffer {
+    size_t size_;
+    bool registered_;           // false if the device-layer can't access this memory directly
+    bool dmaContiguous_;        // true if the whole buffer is contiguous for the DMA engine
+    bool allocated_ = false;    // true if it was allocated through allocHostBuffer
+    bool toDeviceOnly_ = false; // true if the device can only read it, D2H memcpys into it go through CMA
+  };
+  struct ZeroCopyOp {
+    const std::byte* hostAddr_;
+    const std::byte* deviceAddr_;
+    size_t size_;
+  };
+  // returns the registered host buffer containing the whole range, if any, or a non contiguous one spanning the range
+  // if it's big enough to be streamed (see Options::streamHostMemoryMinBytes_). Buffers registered toDeviceOnly are
+  // skipped for D2H memcpys. Device mutex must be held by the caller
+  std::optional<HostBuffer> findHostBuffer(DeviceId device, MemcpyType type, const std::byte* h_ptr,
+                                           size_t size) const;
+  // returns the ops of the list if all host ranges are in registered host buffers, empty otherwise
+  std::vector<ZeroCopyOp> getZeroCopyOps(DeviceId device, const MemcpyList& list, MemcpyType type,
+                                         bool& dmaContiguous) const;
+  // builds the DMA commands (without tag id) of a memcpy done directly from/to registered host memory
+  std::vector<std::vector<std::byte>> buildZeroCopyCommands(MemcpyType type, DeviceId device,
+                                                            const std::vector<ZeroCopyOp>& ops, bool dmaContiguous,
+                                                            bool barrier) const;
+  // loads a new kernel reusing an already loaded code image of the same elf, if any. Must be called with the device
+  // mutex held
+  std::optional<LoadCodeResult> loadCachedCode(StreamId stream, DeviceId device, size_t imageHash, const std::byte* elf,
+                                               size_t elfSize);
+  // removes the oldest retained code images (refCount_ 0) till the retained ones take no more than maxBytes; if device
+  // is set only its images are removed. Must be called with mutex_ held, the returned images must be freed afterwards
+  std::vector<CodeImage> evictRetainedCodeImages(size_t maxBytes, std::optional<DeviceId> device = {});
+  void freeCodeImages(const std::vector<CodeImage>& images);
+  // evicts the least recently used managed allocation of the device to host memory; returns false if there was none to
+  // evict. Must be called with the device mutex held
+  bool evictManagedAllocation(DeviceId device);
+  // sends DMA commands directly from/to registered host memory; evt is dispatched once all commands complete
+  void sendZeroCopyMemcpy(MemcpyType type, CommandSender& commandSender, DeviceId device, StreamId stream, EventId evt,
+                          const std::vector<ZeroCopyOp>& ops, bool dmaContiguous, bool barrier);
+
+  // memcpys of a coalescing stream waiting to be submitted as a single DMA list
+  struct CoalescedMemcpys {
+    MemcpyType type_;
+    MemcpyList list_;
+    std::vector<CmaCopyFunction> copyFunctions_;
+    std::vector<EventId> events_;
+    size_t totalSize_ = 0;
+  };
+  // appends the memcpy to the pending ones of the stream if it has coalescing enabled and the memcpy is eligible;
+  // returns its event in that case. Must be called with the device mutex held
+  std::optional<EventId> tryCoalesceMemcpy(MemcpyType type, StreamId stream, const std::byte* src, std::byte* dst,
+                                           size_t size, bool barrier, const CmaCopyFunction& cmaCopyFunction);
+  // does the memcpy with CPU stores or loads through the mapped DRAM of the device if it's small enough (see
+  // Options::mappedDramH2DMaxBytes_) and the stream is idle; returns its event, already dispatched, in that case. Must
+  // be called with the device mutex held
+  std::optional<EventId> tryMappedDramMemcpy(MemcpyType type, StreamId stream, const std::byte* src, std::byte* dst,
+                                             size_t size);
+  // submits the pending coalesced memcpys of the stream, if any
+  void flushCoalescedMemcpys(StreamId stream);
+  // same as above for the stream the event belongs to
+  void flushCoalescedMemcpys(EventId event);
+  // must be called with the device mutex held
+  void sendCoalescedMemcpys(StreamId stream, CoalescedMemcpys memcpys);
+
+  struct GraphNode {
+    CommandData command_; // device-api command, its tag id is patched on each launch
+    bool isDma_ = false;
+    bool isP2P_ = false;
+    // kernel launches get a fresh execution context buffer on each launch
+    bool isKernelLaunch_ = false;
+    // kernel args which can't be embedded in the command; moved to the graph args when the node is captured
+    std::vector<std::byte> args_;
+    // offset of the kernel args in the graph args buffer when they can't be embedded in the command
+    std::optional<size_t> argsOffset_;
+    // offset and size of the kernel args embedded in the command
+    std::optional<size_t> embeddedArgsOffset_;
+    size_t embeddedArgsSize_ = 0;
+    KernelId kernel_{};
+    std::string coreDumpFilePath_;
+  };
+  struct Graph {
+    DeviceId device_;
+    std::vector<GraphNode> nodes_;
+    // kernel args not embedded in the commands, uploaded to argsBuffer_ when the capture ends
+    std::vector<std::byte> args_;
+    std::byte* argsBuffer_ = nullptr;
+    // the commands uploaded to device memory by uploadGraph, MasterMinion executes them from there
+    std::byte* listBuffer_ = nullptr;
+    uint32_t listSize_ = 0;
+    bool listBarrier_ = false;
+    // offset in the list and size of the embedded args of each kernel launch, size 0 if they are not embedded
+    std::vector<std::pair<size_t, size_t>> listLaunchArgs_;
+  };
+  struct DeviceGroup {
+    std::vector<DeviceId> devices_;
+    std::vector<StreamId> streams_; ///< one per device, in the same order
+  };
+  // copy of the group, checking it has one element per device
+  DeviceGroup getDeviceGroup(DeviceGroupId group, size_t elements, const char* what) const;
+  // event dispatched once all the given events are; it belongs to no stream. See DeviceGroup.cpp
+  EventId makeGroupEvent(std::vector<EventId> events);
+
+  bool isCapturing(StreamId stream) const;
+  // records the commands in the graph being captured on the stream; returns an already dispatched event
+  EventId captureCommands(StreamId stream, std::vector<GraphNode> nodes);
+  // sends (or captures) a MasterMinion command working on device memory only, see DeviceMemoryOps.cpp; zero size
+  // operations complete without any command. The device mutex must be held
+  EventId sendDeviceMemoryCommand(StreamId stream, CommandData data, size_t size);
+  // sends the power report of the kernel launched right before in the stream, see KernelLaunchOptions::setPowerReport.
+  // The device mutex must be held
+  void sendKernelPowerReport(StreamId stream, EventId kernelEvent);
+  // keeps the power state of the kernel of a report and applies the shire budget policy to it
+  void onKernelPowerReport(DeviceId device, EventId reportEvent,
+                           const device_ops_ext::device_ops_kernel_power_report_rsp_t& report);
+  // graph nodes of a zero-copy memcpy; throws if ops is empty (the memcpy would need CMA staging, which can't be
+  // captured)
+  std::vector<GraphNode> captureZeroCopyMemcpy(MemcpyType type, DeviceId device, const std::vector<ZeroCopyOp>& ops,
+                                               bool dmaContiguous, bool barrier) const;
+
   uint64_t getCommandSenderIdx(int deviceId, int sqIdx) const {
     return (static_cast<uint64_t>(deviceId) << 32ULL) + static_cast<uint64_t>(sqIdx);
   }
@@ -194,28 +457,110 @@ private:
     int numBlockers_ = 0;
   };
 
-  mutable std::recursive_mutex mutex_;
+  // device state (memory managers, command senders and cma managers) belongs to the per-device mutex; submissions to
+  // the same device must be serialized to keep ghost commands and memcpy actions in the same order
+  std::recursive_mutex& getDeviceMutex(DeviceId device) const {
+    return *find(deviceMutexes_, device)->second;
+  }
+
+  // protects kernels_, codeImages_, nextKernelId_, kernelAbortedCallback_ and deviceApiVersions_
+  mutable std::mutex mutex_;
+  // recursive because some operations (loadCode, kernelLaunch) are built on top of others (mallocDevice, memcpy)
+  std::unordered_map<DeviceId, std::unique_ptr<std::recursive_mutex>> deviceMutexes_;
   std::shared_ptr<dev::IDeviceLayer> deviceLayer_;
+  // used by the command senders and the response processing, so it's destroyed after them
+  std::unique_ptr<CommandMetrics> commandMetrics_;
   std::unordered_map<DeviceId, std::unique_ptr<CmaManager>> cmaManagers_;
   std::vector<DeviceId> devices_;
   StreamManager streamManager_;
   std::unordered_map<DeviceId, MemoryManager> memoryManagers_;
   std::unordered_map<KernelId, std::unique_ptr<Kernel>> kernels_;
+  // indexed by the elf content hash
+  std::unordered_multimap<size_t, CodeImage> codeImages_;
+  // see Options::codeImageRetentionBytes_
+  size_t codeImageRetentionBytes_ = 0;
+  // see Options::streamHostMemoryMinBytes_
+  size_t streamHostMemoryMinBytes_ = 0;
+  // see Options::mappedDramH2DMaxBytes_ and Options::mappedDramD2HMaxBytes_
+  size_t mappedDramH2DMaxBytes_ = 0;
+  size_t mappedDramD2HMaxBytes_ = 0;
+  // see Options::memoryCompactionThreshold_
+  double memoryCompactionThreshold_ = 0.0;
+  // allocations done with mallocDeviceHandle and mallocManaged, the ones the device memory compaction moves
+  struct HandleAllocation {
+    DeviceId device_;
+    std::byte* address_; // nullptr while evicted
+    uint32_t alignment_;
+    // managed allocations only, see mallocManaged
+    bool managed_ = false;
+    size_t size_ = 0;
+    std::byte* hostCopy_ = nullptr; // host buffer the content is evicted to, kept till the allocation is freed
+    uint64_t lastUse_ = 0;          // LRU order, bumped by each prefetch
+    std::optional<StreamId> stream_; // of the last prefetch
+    bool pinned_ = false;           // not evicted while its prefetch is restoring the others
+  };
+  // protects handles_, nextHandle_ and nextUse_. Taken after the device mutex when both are needed
+  mutable std::mutex handlesMutex_;
+  std::unordered_map<DeviceHandle, HandleAllocation> handles_;
+  uint32_t nextHandle_ = 0;
+  uint64_t nextUse_ = 1;
+  // device DRAM mapped in the process by the device-layer, only for the devices which have it
+  struct MappedDram {
+    std::byte* hostAddress_;
+    uint64_t deviceAddress_;
+    uint64_t size_;
+  };
+  std::unordered_map<DeviceId, MappedDram> mappedDrams_;
+  size_t retainedCodeImageBytes_ = 0;
+  uint64_t nextRetainedSeq_ = 1;
   std::unordered_map<DeviceId, DeviceFwTracing> deviceTracing_;
+  // host buffers registered per device, sorted by address; guarded by the device mutex
+  std::unordered_map<DeviceId, std::map<const std::byte*, HostBuffer>> hostBuffers_;
+  // buffers with an async free still waiting on their stream; guarded by the device mutex
+  std::unordered_map<DeviceId, std::unordered_set<const std::byte*>> pendingAsyncFrees_;
+  // pending memcpys of the streams with coalescing enabled; taken after the device mutex
+  std::mutex coalescingMutex_;
+  std::unordered_map<StreamId, std::optional<CoalescedMemcpys>> coalescedMemcpys_;
+  // avoids taking coalescingMutex_ at all when no stream has coalescing enabled
+  std::atomic<int> numCoalescingStreams_ = 0;
   std::unique_ptr<ExecutionContextCache> executionContextCache_;
   std::unordered_map<uint64_t, CommandSender> commandSenders_;
 
   int nextKernelId_ = 0;
 
   std::unique_ptr<ResponseReceiver> responseReceiver_;
-  std::unordered_map<DeviceId, std::unique_ptr<threadPool::ThreadPool>> threadPools_;
+  std::unordered_map<DeviceId, std::unique_ptr<threadPool::WorkStealingThreadPool>> threadPools_;
   std::unordered_map<DeviceId, std::unique_ptr<threadPool::ThreadPool>> errorHandlingThreadPools_;
   std::unordered_map<DeviceId, AbortSync> abortSync_;
   EventManager eventManager_;
   bool running_ = false;
   bool checkMemcpyDeviceAddress_ = false;
-  DeviceApiVersion deviceApiVersion_;
+  std::unordered_map<DeviceId, DeviceApiVersion> deviceApiVersions_;
   KernelAbortedCallback kernelAbortedCallback_;
+  CallbackExecutor callbackExecutor_;
+  // protects captures_, graphs_ and nextGraphId_. Taken after the device mutex when both are needed
+  mutable std::mutex graphsMutex_;
+  std::unordered_map<StreamId, Graph> captures_;
+  std::unordered_map<GraphId, Graph> graphs_;
+  int nextGraphId_ = 0;
+  // protects deviceGroups_ and nextDeviceGroupId_
+  mutable std::mutex deviceGroupsMutex_;
+  std::unordered_map<DeviceGroupId, DeviceGroup> deviceGroups_;
+  int nextDeviceGroupId_ = 0;
+  // MasterMinion stream sync slots in use, guarded by the device mutex
+  std::unordered_map<DeviceId, std::bitset<device_ops_ext::kNumStreamSyncSlots>> streamSyncSlots_;
+  // shires of the kernels launched with a shire count, see KernelLaunchOptions::setShireCount
+  std::unordered_map<DeviceId, std::unique_ptr<ShireScheduler>> shireSchedulers_;
+  // protects pendingPowerReports_, powerStates_ and shireBudgetPolicy_
+  mutable std::mutex powerStatesMutex_;
+  // kernel launch event of each power report being executed
+  std::unordered_map<EventId, EventId> pendingPowerReports_;
+  // indexed by kernel launch event, erased when the event id is reused by a later launch
+  std::unordered_map<EventId, KernelPowerState> powerStates_;
+  ShireBudgetPolicy shireBudgetPolicy_;
+  // kernels loaded by getRuntimeKernel, per device and name
+  std::mutex runtimeKernelsMutex_;
+  std::map<std::pair<DeviceId, std::string>, KernelId> runtimeKernels_;
   CoreDumper coreDumper_;
 };
 } // namespace rt
@@ -0,0 +1,121 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) 2025 Ainekko, Co.
+ * SPDX-License-Identifier: Apache-2.0
+ *-------------------------------------------------------------------------*/
+
+#include "ShireScheduler.h"
+
+#include <algorithm>
+#include <array>
+#include <numeric>
+
+using namespace rt;
+
+namespace {
+constexpr auto kNumQuadrants = 64 / kShiresPerQuadrant;
+constexpr uint64_t kQuadrantMask = (uint64_t{1} << kShiresPerQuadrant) - 1;
+
+uint64_t getQuadrant(uint64_t mask, int quadrant) {
+  return mask & (kQuadrantMask << (quadrant * kShiresPerQuadrant));
+}
+
+// count shires of mask (all of them in the same quadrant), the first run of adjacent ones if there is one
+uint64_t pickShires(uint64_t mask, int count) {
+  auto window = (uint64_t{1} << count) - 1;
+  for (auto i = 0; i + count <= 64; ++i) {
+    if ((mask & (window << i)) == (window << i)) {
+      return window << i;
+    }
+  }
+  uint64_t picked = 0;
+  for (; count > 0; --count) {
+    picked |= mask & -mask;
+    mask &= mask - 1;
+  }
+  return picked;
+}
+} // namespace
+
+std::optional<uint64_t> rt::chooseShireMask(uint64_t freeMask, int count) {
+  if (count <= 0 || __builtin_popcountll(freeMask) < count) {
+    return std::nullopt;
+  }
+  std::array<int, kNumQuadrants> numFree;
+  for (auto q = 0; q < kNumQuadrants; ++q) {
+    numFree[q] = __builtin_popcountll(getQuadrant(freeMask, q));
+  }
+
+  std::optional<int> best;
+  for (auto q = 0; q < kNumQuadrants; ++q) {
+    if (numFree[q] >= count && (!best || numFree[q] < numFree[*best])) {
+      best = q;
+    }
+  }
+  if (best) {
+    return pickShires(getQuadrant(freeMask, *best), count);
+  }
+
+  std::array<int, kNumQuadrants> order;
+  std::iota(begin(order), end(order), 0);
+  std::stable_sort(begin(order), end(order), [&numFree](int a, int b) { return numFree[a] > numFree[b]; });
+  uint64_t mask = 0;
+  for (auto q : order) {
+    auto n = std::min(numFree[q], count);
+    mask |= pickShires(getQuadrant(freeMask, q), n);
+    count -= n;
+    if (count == 0) {
+      break;
+    }
+  }
+  return mask;
+}
+
+uint64_t ShireScheduler::acquire(uint64_t validMask, int count) {
+  std::unique_lock lock(mutex_);
+  std::optional<uint64_t> mask;
+  condVar_.wait(lock, [&] {
+    if (budget_ > 0 && busyMask_ != 0 && __builtin_popcountll(busyMask_) + count > budget_) {
+      return false;
+    }
+    mask = chooseShireMask(validMask & ~busyMask_, count);
+    return mask.has_value();
+  });
+  busyMask_ |= *mask;
+  return *mask;
+}
+
+void ShireScheduler::setBudget(int maxShires) {
+  std::unique_lock lock(mutex_);
+  budget_ = std::max(maxShires, 0);
+  lock.unlock();
+  condVar_.notify_all();
+}
+
+int ShireScheduler::getBudget() const {
+  std::lock_guard lock(mutex_);
+  return budget_;
+}
+
+void ShireScheduler::assign(EventId event, uint64_t shireMask) {
+  std::lock_guard lock(mutex_);
+  eventMasks_[event] = shireMask;
+}
+
+void ShireScheduler::release(uint64_t shireMask) {
+  std::unique_lock lock(mutex_);
+  busyMask_ &= ~shireMask;
+  lock.unlock();
+  condVar_.notify_all();
+}
+
+void ShireScheduler::releaseEvent(EventId event) {
+  std::unique_lock lock(mutex_);
+  auto it = eventMasks_.find(event);
+  if (it == end(eventMasks_)) {
+    return;
+  }
+  busyMask_ &= ~it->second;
+  eventMasks_.erase(it);
+  lock.unlock();
+  condVar_.notify_all();
+}
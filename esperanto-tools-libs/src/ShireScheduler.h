@@ -0,0 +1,48 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) 2025 Ainekko, Co.
+ * SPDX-License-Identifier: Apache-2.0
+ *-------------------------------------------------------------------------*/
+#pragma once
+
+#include "runtime/IRuntime.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+
+namespace rt {
+// compute shires sharing the same memshire quadrant of the NoC, consecutive shire indexes are neighbours
+constexpr auto kShiresPerQuadrant = 8;
+
+// chooses count shires among the free ones, as close as possible: inside a single quadrant if one has enough of them
+// (the one with fewer free shires, to keep the emptier quadrants for bigger kernels), adjacent ones first. Bigger
+// kernels take the emptier quadrants first. Returns nullopt if there are not enough free shires
+std::optional<uint64_t> chooseShireMask(uint64_t freeMask, int count);
+
+// shires placement of the kernels launched with KernelLaunchOptions::setShireCount on a device. The kernels launched
+// with an explicit shire mask are not tracked. Thread safe
+class ShireScheduler {
+public:
+  // returns the mask of count shires among validMask, blocking till enough of them are free and within the budget
+  uint64_t acquire(uint64_t validMask, int count);
+  // caps the shires held at once, 0 for no cap. A kernel needing more shires than the budget runs once no other
+  // kernel holds any. See IRuntime::setShireBudget
+  void setBudget(int maxShires);
+  int getBudget() const;
+  // the shires are held by the event till its kernel completes
+  void assign(EventId event, uint64_t shireMask);
+  // frees the shires of a mask which has no event, ie. when the launch fails before it's sent
+  void release(uint64_t shireMask);
+  // frees the shires held by the event, if any
+  void releaseEvent(EventId event);
+
+private:
+  mutable std::mutex mutex_;
+  std::condition_variable condVar_;
+  uint64_t busyMask_ = 0;
+  int budget_ = 0;
+  std::unordered_map<EventId, uint64_t> eventMasks_;
+};
+} // namespace rt
@@ -20,18 +20,41 @@ Stream::Info StreamManager::getStreamInfo(StreamId stream) const {
 
 std::optional<Stream::Info> StreamManager::getStreamInfo(EventId event) const {
   SpinLock lock(mutex_);
-  for (auto& [id, stream] : streams_) {
-    unused(id);
-    if (stream.submittedEvents_.find(event) != end(stream.submittedEvents_)) {
-      return stream.info_;
-    }
+  if (auto it = eventStreams_.find(event); it != end(eventStreams_)) {
+    return find(streams_, it->second)->second.info_;
   }
   return {};
 }
 
-StreamId StreamManager::createStream(DeviceId device) {
+Stream* StreamManager::findStreamLocked(EventId event) {
+  if (auto it = eventStreams_.find(event); it != end(eventStreams_)) {
+    return &find(streams_, it->second)->second;
+  }
+  return nullptr;
+}
+
+bool StreamManager::removeEventLocked(EventId event) {
+  auto stream = findStreamLocked(event);
+  if (stream == nullptr) {
+    return false;
+  }
+  stream->submittedEvents_.erase(event);
+  eventStreams_.erase(event);
+  --eventsOnFly_[DeviceId{stream->info_.device_}];
+  return true;
+}
+
+StreamId StreamManager::createStream(DeviceId device, StreamPriority priority) {
+  SpinLock lock(mutex_);
+  return createStreamLocked(device, queueHelper_.nextQueue(device, priority));
+}
+
+StreamId StreamManager::createStream(DeviceId device, int vq) {
   SpinLock lock(mutex_);
-  auto vq = queueHelper_.nextQueue(device);
+  return createStreamLocked(device, vq);
+}
+
+StreamId StreamManager::createStreamLocked(DeviceId device, int vq) {
   auto id = StreamId{nextStreamId_++};
   auto [it, res] = streams_.try_emplace(id, Stream{device, vq, id});
   if (!res) {
@@ -43,21 +66,21 @@ StreamId StreamManager::createStream(DeviceId device) {
 
 void StreamManager::destroyStream(StreamId stream) {
   SpinLock lock(mutex_);
-  auto res = streams_.erase(stream);
-  if (!res) {
+  auto it = streams_.find(stream);
+  if (it == end(streams_)) {
     throw Exception("Trying to destroy a non-existing stream.");
   }
+  for (auto event : it->second.submittedEvents_) {
+    eventStreams_.erase(event);
+  }
+  eventsOnFly_[DeviceId{it->second.info_.device_}] -= static_cast<uint32_t>(it->second.submittedEvents_.size());
+  streams_.erase(it);
 }
 
 bool StreamManager::hasEventsOnFly(DeviceId device) const {
   SpinLock lock(mutex_);
-  for (auto& [id, stream] : streams_) {
-    unused(id);
-    if (stream.info_.device_ == static_cast<int>(device) && !stream.submittedEvents_.empty()) {
-      return true;
-    }
-  }
-  return false;
+  auto it = eventsOnFly_.find(device);
+  return it != end(eventsOnFly_) && it->second > 0;
 }
 
 std::unordered_map<DeviceId, uint32_t> StreamManager::getEventCount() const {
@@ -77,22 +100,32 @@ void StreamManager::addDevice(DeviceId device, int queueCount) {
 
 void StreamManager::addEvent(StreamId stream, EventId event) {
   SpinLock lock(mutex_);
-  auto [it, result] = find(streams_, stream)->second.submittedEvents_.emplace(event);
+  auto& st = find(streams_, stream)->second;
+  auto [it, result] = st.submittedEvents_.emplace(event);
   unused(it);
   if (!result) {
     throw Exception("Trying to add an event that already exists in the stream");
   }
+  eventStreams_[event] = stream;
+  ++eventsOnFly_[DeviceId{st.info_.device_}];
 }
 
 void StreamManager::removeEvent(EventId event) {
   SpinLock lock(mutex_);
-  for (auto& [id, stream] : streams_) {
-    unused(id);
-    if (stream.submittedEvents_.erase(event) > 0)
-      return;
+  if (!removeEventLocked(event)) {
+    RT_LOG(WARNING) << "Trying to remove a non-existing event: " << static_cast<uint32_t>(event)
+                    << ". Perhaps the associated Stream was already destroyed";
+  }
+}
+
+void StreamManager::removeEvents(const std::vector<EventId>& events) {
+  SpinLock lock(mutex_);
+  for (auto event : events) {
+    if (!removeEventLocked(event)) {
+      RT_LOG(WARNING) << "Trying to remove a non-existing event: " << static_cast<uint32_t>(event)
+                      << ". Perhaps the associated Stream was already destroyed";
+    }
   }
-  RT_LOG(WARNING) << "Trying to remove a non-existing event: " << static_cast<uint32_t>(event)
-                  << ". Perhaps the associated Stream was already destroyed";
 }
 
 std::vector<EventId> StreamManager::getLiveEvents(StreamId stream) const {
@@ -132,12 +165,9 @@ void StreamManager::setErrorCallback(StreamErrorCallback callback) {
 
 void StreamManager::addError(EventId event, StreamError error) {
   SpinLock lock(mutex_);
-  for (auto& [id, stream] : streams_) {
-    unused(id);
-    if (stream.submittedEvents_.find(event) != end(stream.submittedEvents_)) {
-      stream.errors_.emplace_back(std::move(error));
-      return;
-    }
+  if (auto stream = findStreamLocked(event); stream != nullptr) {
+    stream->errors_.emplace_back(std::move(error));
+    return;
   }
   RT_LOG(WARNING) << "Trying to process an error without a host callback set and the stream was already destroyed. "
                      "So this error will be unnoticed by host.";
@@ -31,13 +31,15 @@ struct Stream {
   std::vector<StreamError> errors_;
 };
 
+// When the device has more than one submission queue the last one is reserved for high priority streams, the
+// MasterMinion services it first and launches its kernels ahead of the other queues ones (see MM_SQ_PRIORITY_IDX). Normal streams are distributed among the remaining ones.
 class QueueHelper {
 public:
   void addDevice(DeviceId device, int queueCount) {
     queues_.try_emplace(device, QueueInfo{queueCount});
   }
-  int nextQueue(DeviceId device) {
-    return find(queues_, device)->second.getNextQueue();
+  int nextQueue(DeviceId device, StreamPriority priority) {
+    return find(queues_, device)->second.getNextQueue(priority);
   }
 
 private:
@@ -46,9 +48,15 @@ private:
       : nextQueue_{0}
       , queueCount_{count} {
     }
-    int getNextQueue() {
+    int getNextQueue(StreamPriority priority) {
+      if (queueCount_ == 1) {
+        return 0;
+      }
+      if (priority == StreamPriority::High) {
+        return queueCount_ - 1;
+      }
       auto res = nextQueue_;
-      nextQueue_ = (nextQueue_ + 1) % queueCount_;
+      nextQueue_ = (nextQueue_ + 1) % (queueCount_ - 1);
       return res;
     }
     int nextQueue_;
@@ -61,7 +69,9 @@ class StreamManager {
 public:
   Stream::Info getStreamInfo(StreamId stream) const;
   std::optional<Stream::Info> getStreamInfo(EventId event) const;
-  StreamId createStream(DeviceId device);
+  StreamId createStream(DeviceId device, StreamPriority priority);
+  // creates a stream bound to the given submission queue, regardless of its priority
+  StreamId createStream(DeviceId device, int vq);
   void destroyStream(StreamId stream);
   bool hasEventsOnFly(DeviceId device) const;
   std::unordered_map<DeviceId, uint32_t> getEventCount() const;
@@ -71,6 +81,7 @@ public:
 
   void addEvent(StreamId stream, EventId event);
   void removeEvent(EventId event);
+  void removeEvents(const std::vector<EventId>& events);
   std::vector<StreamError> retrieveErrors(StreamId stream);
   void setErrorCallback(StreamErrorCallback callback);
   // returns false if there is no callback. If true, it will execute the callback and after that it will execute the
@@ -80,9 +91,20 @@ public:
   void addError(const StreamError& error);
 
 private:
+  // mutex_ must be held by the caller. Returns false if the event was not found
+  bool removeEventLocked(EventId event);
+  // mutex_ must be held by the caller. Returns nullptr if the event is not associated to any stream
+  Stream* findStreamLocked(EventId event);
+  // mutex_ must be held by the caller
+  StreamId createStreamLocked(DeviceId device, int vq);
+
   threadPool::ThreadPool threadPool_{2};
   QueueHelper queueHelper_;
   std::unordered_map<StreamId, Stream> streams_;
+  // index to avoid traversing all streams when looking for the owner of an event
+  std::unordered_map<EventId, StreamId> eventStreams_;
+  // number of submitted events per device, queried very frequently by the response receivers
+  std::unordered_map<DeviceId, uint32_t> eventsOnFly_;
   std::underlying_type<StreamId>::type nextStreamId_ = 0;
   StreamErrorCallback streamErrorCallback_;
   mutable std::mutex mutex_;
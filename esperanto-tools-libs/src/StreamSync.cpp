@@ -0,0 +1,146 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) 2025 Ainekko, Co.
+ * SPDX-License-Identifier: Apache-2.0
+ *-------------------------------------------------------------------------*/
+
+#include "RuntimeImp.h"
+#include "Utils.h"
+#include "runtime/DeviceOpsExt.h"
+#include "runtime/Types.h"
+#include <esperanto/device-apis/operations-api/device_ops_api_cxx.h>
+#include <esperanto/device-apis/operations-api/device_ops_api_spec.h>
+#include <cstring>
+
+using namespace rt;
+
+namespace {
+CommandData makeStreamSyncCommand(EventId tag, uint16_t slot, uint16_t token, device_ops_ext::StreamSyncOp op) {
+  CommandData data(sizeof(device_ops_ext::device_ops_stream_sync_cmd_t));
+  auto cmd = reinterpret_cast<device_ops_ext::device_ops_stream_sync_cmd_t*>(data.data());
+  memset(cmd, 0, sizeof(*cmd));
+  cmd->command_info.cmd_hdr.tag_id = static_cast<device_ops_api::tag_id_t>(tag);
+  cmd->command_info.cmd_hdr.msg_id = device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_STREAM_SYNC_CMD;
+  cmd->command_info.cmd_hdr.size = static_cast<device_ops_api::msg_size_t>(sizeof(*cmd));
+  // the signal must wait for all the work previously submitted to its SQ
+  cmd->command_info.cmd_hdr.flags =
+    op == device_ops_ext::STREAM_SYNC_OP_SIGNAL ? device_ops_api::CMD_FLAGS_BARRIER_ENABLE : 0;
+  cmd->slot = slot;
+  cmd->token = token;
+  cmd->op = op;
+  return data;
+}
+} // namespace
+
+EventId RuntimeImp::doStreamWaitEvent(StreamId stream, EventId event) {
+  auto streamInfo = streamManager_.getStreamInfo(stream);
+  auto device = DeviceId{streamInfo.device_};
+  if (isCapturing(stream)) {
+    throw Exception("Can't wait for an event on a stream which is being captured");
+  }
+  // the producer could belong to another device, flush before taking the device mutex
+  flushCoalescedMemcpys(stream);
+  flushCoalescedMemcpys(event);
+  SpinLock lock(getDeviceMutex(device));
+  auto producer = streamManager_.getStreamInfo(event);
+  if (producer && producer->device_ != streamInfo.device_) {
+    throw Exception("Can't wait for an event from a different device");
+  }
+
+  auto evt = eventManager_.getNextId();
+  streamManager_.addEvent(stream, evt);
+  RT_VLOG(LOW) << "Stream " << static_cast<int>(stream) << " waits for event " << static_cast<int>(event)
+               << " EventId: " << static_cast<int>(evt);
+  if (!producer) {
+    if (!eventManager_.isDispatched(event)) {
+      // an event of no stream, ie. a device group event. Resolve it in the host
+      lock.unlock();
+      doWaitForEvent(event);
+    }
+    // else already completed, nothing to wait for
+    dispatch(evt);
+    return evt;
+  }
+
+  auto& slots = find(streamSyncSlots_, device)->second;
+  auto slot = 0U;
+  while (slot < slots.size() && slots.test(slot)) {
+    ++slot;
+  }
+  if (slot == slots.size()) {
+    // no free slots, resolve the dependency in the host. Following commands won't be submitted till it's done
+    RT_VLOG(LOW) << "No free stream sync slots, waiting for event " << static_cast<int>(event) << " in the host";
+    lock.unlock();
+    doWaitForEvent(event);
+    dispatch(evt);
+    return evt;
+  }
+  slots.set(slot);
+
+  // wait event ids are unique among the onfly events, which makes them good tokens. 0 means not signaled
+  auto token = std::max<uint16_t>(static_cast<uint16_t>(evt), 1);
+  auto signalEvt = eventManager_.getNextId();
+  streamManager_.addEvent(producer->id_, signalEvt);
+  auto& producerSender = find(commandSenders_, getCommandSenderIdx(producer->device_, producer->vq_))->second;
+  producerSender.send(Command{makeStreamSyncCommand(signalEvt, static_cast<uint16_t>(slot), token,
+                                                    device_ops_ext::STREAM_SYNC_OP_SIGNAL),
+                              producerSender, signalEvt, signalEvt, producer->id_, false, true});
+
+  auto& commandSender = find(commandSenders_, getCommandSenderIdx(streamInfo.device_, streamInfo.vq_))->second;
+  commandSender.send(Command{
+    makeStreamSyncCommand(evt, static_cast<uint16_t>(slot), token, device_ops_ext::STREAM_SYNC_OP_WAIT),
+    commandSender, evt, evt, stream, false, true});
+
+  // the slot can be reused once both sides are done with it
+  eventManager_.addOnDispatchCallback({{signalEvt, evt}, [this, device, slot] {
+                                         SpinLock slotsLock(getDeviceMutex(device));
+                                         find(streamSyncSlots_, device)->second.reset(slot);
+                                       }});
+  Sync(evt);
+  return evt;
+}
+
+EventId RuntimeImp::doLaunchHostFunc(StreamId stream, HostFunc func) {
+  return launchHostTask(stream, [func = std::move(func)](EventId) { func(); });
+}
+
+EventId RuntimeImp::launchHostTask(StreamId stream, std::function<void(EventId)> task) {
+  auto streamInfo = streamManager_.getStreamInfo(stream);
+  auto device = DeviceId{streamInfo.device_};
+  if (isCapturing(stream)) {
+    throw Exception("Can't launch a host function on a stream which is being captured");
+  }
+  flushCoalescedMemcpys(stream);
+  SpinLock executorLock(mutex_);
+  auto executor = callbackExecutor_;
+  executorLock.unlock();
+  SpinLock lock(getDeviceMutex(device));
+  auto previousEvents = streamManager_.getLiveEvents(stream);
+  auto evt = eventManager_.getNextId();
+  streamManager_.addEvent(stream, evt);
+  RT_VLOG(LOW) << "Launching host function on stream " << static_cast<int>(stream)
+               << " EventId: " << static_cast<int>(evt) << " after " << previousEvents.size() << " events";
+
+  // a disabled command holds the following commands of the submission queue; it's never sent, just removed once the
+  // function has returned
+  auto& commandSender = find(commandSenders_, getCommandSenderIdx(streamInfo.device_, streamInfo.vq_))->second;
+  commandSender.send(Command{CommandData{}, commandSender, evt, evt, stream, false, false});
+  eventManager_.addOnDispatchCallback(
+    {std::move(previousEvents), [this, &commandSender, executor = std::move(executor), evt, task = std::move(task)] {
+       auto run = [this, &commandSender, evt, task] {
+         try {
+           task(evt);
+         } catch (const std::exception& e) {
+           RT_LOG(WARNING) << "Host function of event " << static_cast<int>(evt) << " threw: " << e.what();
+         }
+         commandSender.cancel(evt);
+         dispatch(evt);
+       };
+       if (executor) {
+         executor(std::move(run));
+       } else {
+         run();
+       }
+     }});
+  Sync(evt);
+  return evt;
+}
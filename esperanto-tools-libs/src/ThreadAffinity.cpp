@@ -0,0 +1,62 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) 2025 Ainekko, Co.
+ * SPDX-License-Identifier: Apache-2.0
+ *-------------------------------------------------------------------------*/
+
+#include "ThreadAffinity.h"
+#include "Utils.h"
+
+#include <cstring>
+#include <pthread.h>
+#include <sstream>
+
+using namespace rt;
+
+std::optional<cpu_set_t> rt::parseCpuList(const std::string& cpuList) {
+  cpu_set_t cpus;
+  CPU_ZERO(&cpus);
+  std::stringstream ss(cpuList);
+  std::string range;
+  while (std::getline(ss, range, ',')) {
+    if (auto end = range.find_last_not_of(" \n"); end != std::string::npos) {
+      range.erase(end + 1);
+    } else {
+      continue;
+    }
+    try {
+      auto dash = range.find('-');
+      auto first = std::stoul(range.substr(0, dash));
+      auto last = dash == std::string::npos ? first : std::stoul(range.substr(dash + 1));
+      for (auto cpu = first; cpu <= last && cpu < CPU_SETSIZE; ++cpu) {
+        CPU_SET(cpu, &cpus);
+      }
+    } catch (const std::exception&) {
+      return std::nullopt;
+    }
+  }
+  if (CPU_COUNT(&cpus) == 0) {
+    return std::nullopt;
+  }
+  return cpus;
+}
+
+std::optional<cpu_set_t> rt::getDeviceLocalCpus(const dev::IDeviceLayer& deviceLayer, int device) {
+  try {
+    auto numaNode = deviceLayer.getDeviceAttribute(device, "numa_node");
+    auto cpus = parseCpuList(deviceLayer.getDeviceAttribute(device, "local_cpulist"));
+    if (cpus) {
+      RT_LOG(INFO) << "Device " << device << " NUMA node: " << numaNode.substr(0, numaNode.find('\n'))
+                   << " local cpus: " << CPU_COUNT(&*cpus);
+    }
+    return cpus;
+  } catch (const std::exception& e) {
+    RT_VLOG(LOW) << "Couldn't get device " << device << " local cpus: " << e.what();
+    return std::nullopt;
+  }
+}
+
+void rt::pinCurrentThread(const cpu_set_t& cpus) {
+  if (auto res = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus); res != 0) {
+    RT_LOG(WARNING) << "Couldn't set thread affinity: " << strerror(res);
+  }
+}
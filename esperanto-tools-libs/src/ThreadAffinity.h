@@ -0,0 +1,23 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) 2025 Ainekko, Co.
+ * SPDX-License-Identifier: Apache-2.0
+ *-------------------------------------------------------------------------*/
+#pragma once
+
+#include "device-layer/IDeviceLayer.h"
+
+#include <optional>
+#include <sched.h>
+#include <string>
+
+namespace rt {
+// parses a sysfs cpu list (ie. "0-7,16-23"). Returns nullopt if it's empty or malformed
+std::optional<cpu_set_t> parseCpuList(const std::string& cpuList);
+
+// returns the cpus of the NUMA node the device is attached to, read from its PCIe sysfs entry. Returns nullopt if it
+// can't be known (ie. sysemu devices or single node hosts without the entry)
+std::optional<cpu_set_t> getDeviceLocalCpus(const dev::IDeviceLayer& deviceLayer, int device);
+
+// pins the calling thread to the given cpus. Failures are only logged, the thread keeps running wherever it was
+void pinCurrentThread(const cpu_set_t& cpus);
+} // namespace rt
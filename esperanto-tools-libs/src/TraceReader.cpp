@@ -0,0 +1,337 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) 2025 Ainekko, Co.
+ * SPDX-License-Identifier: Apache-2.0
+ *-------------------------------------------------------------------------*/
+
+#include "runtime/TraceReader.h"
+
+#include "Utils.h"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#pragma GCC diagnostic ignored "-Wcast-align"
+#pragma GCC diagnostic ignored "-Wcast-qual"
+#pragma GCC diagnostic ignored "-Wsign-conversion"
+#pragma GCC diagnostic ignored "-Wuseless-cast"
+#pragma GCC diagnostic ignored "-Wignored-qualifiers"
+#include <et-trace/decoder.h>
+#include <et-trace/layout.h>
+#pragma GCC diagnostic pop
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unordered_map>
+#include <unistd.h>
+#include <utility>
+
+using namespace rt;
+using namespace rt::profiling;
+
+// Entry of a sub-buffer the decode can start from
+struct TraceReader::Checkpoint {
+  const trace_entry_header_t* entry_;
+  uint64_t maxCycleBefore_; // highest cycle of the entries before it, 0 if none
+  uint64_t minCycleFrom_;   // lowest cycle of the entries from it to the end of the sub-buffer
+};
+
+namespace {
+constexpr uint16_t kHartsPerShire = 64;
+constexpr size_t kCheckpointInterval = 256; // entries between two checkpoints
+
+uint64_t getShireBit(uint16_t hartId) {
+  auto shire = hartId / kHartsPerShire;
+  return shire < 64 ? (1ULL << shire) : 0;
+}
+
+// Calls func with each entry of the sub-buffer at index till it returns false, starting from entry "from" or from the
+// first entry if null. The decoder doesn't do bounds checking on its own, entries past "end" end the sub-buffer.
+template <typename Func>
+void forEachEntry(const trace_buffer_std_header_t* tb, const TraceSubBuffer& sub, size_t index,
+                  const trace_entry_header_t* from, Func&& func) {
+  auto base = reinterpret_cast<const std::byte*>(tb) + sub.offset_;
+  auto end = base + sub.dataSize_;
+  auto sizeHeader = reinterpret_cast<const trace_buffer_size_header_t*>(base);
+  auto next = [tb, sizeHeader, index](const trace_entry_header_t* prev) {
+    return index == 0 ? Trace_Decode(tb, prev) : Trace_Decode_Sub(sizeHeader, prev);
+  };
+  for (auto entry = from != nullptr ? from : next(nullptr); entry != nullptr; entry = next(entry)) {
+    auto entryBytes = reinterpret_cast<const std::byte*>(entry);
+    // Trace_Decode goes on with the next sub-buffers
+    if (entryBytes < base || entryBytes >= end) {
+      break;
+    }
+    if (entryBytes + sizeof(trace_entry_header_t) > end ||
+        entryBytes + sizeof(trace_entry_header_t) + entry->payload_size > end) {
+      RT_LOG(WARNING) << "Device trace sub-buffer " << index << " entry out of bounds, the trace may be truncated";
+      break;
+    }
+    if (!func(*entry)) {
+      break;
+    }
+  }
+}
+} // namespace
+
+TraceReader TraceReader::open(const std::string& path, size_t threads) {
+  auto fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    throw Exception("Can't open trace file " + path + ": " + strerror(errno));
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+    ::close(fd);
+    throw Exception("Can't read trace file " + path);
+  }
+  auto size = static_cast<size_t>(st.st_size);
+  auto memory = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (memory == MAP_FAILED) {
+    throw Exception("Can't map trace file " + path + ": " + strerror(errno));
+  }
+  try {
+    auto reader = TraceReader(static_cast<const std::byte*>(memory), size, threads);
+    reader.mapping_ = memory;
+    reader.buildIndex();
+    return reader;
+  } catch (...) {
+    munmap(memory, size);
+    throw;
+  }
+}
+
+TraceReader::TraceReader(const std::vector<std::byte>& buffer, size_t threads)
+  : TraceReader(nullptr, buffer.size(), threads) {
+  // copied so the header is properly aligned
+  storage_.resize((buffer.size() + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+  std::memcpy(storage_.data(), buffer.data(), buffer.size());
+  data_ = reinterpret_cast<const std::byte*>(storage_.data());
+  buildIndex();
+}
+
+TraceReader::TraceReader(const std::byte* data, size_t size, size_t threads)
+  : data_(data)
+  , size_(size)
+  , threads_(threads != 0 ? threads : std::max(1U, std::thread::hardware_concurrency())) {
+}
+
+TraceReader::~TraceReader() {
+  if (mapping_ != nullptr) {
+    munmap(mapping_, size_);
+  }
+}
+
+TraceReader::TraceReader(TraceReader&& other) noexcept
+  : data_(other.data_)
+  , size_(other.size_)
+  , mapping_(std::exchange(other.mapping_, nullptr))
+  , storage_(std::move(other.storage_))
+  , threads_(other.threads_)
+  , subBuffers_(std::move(other.subBuffers_))
+  , typeMasks_(std::move(other.typeMasks_))
+  , checkpoints_(std::move(other.checkpoints_)) {
+}
+
+TraceReader& TraceReader::operator=(TraceReader&& other) noexcept {
+  if (this != &other) {
+    if (mapping_ != nullptr) {
+      munmap(mapping_, size_);
+    }
+    data_ = other.data_;
+    size_ = other.size_;
+    mapping_ = std::exchange(other.mapping_, nullptr);
+    storage_ = std::move(other.storage_);
+    threads_ = other.threads_;
+    subBuffers_ = std::move(other.subBuffers_);
+    typeMasks_ = std::move(other.typeMasks_);
+    checkpoints_ = std::move(other.checkpoints_);
+  }
+  return *this;
+}
+
+template <typename Func> void TraceReader::parallelFor(size_t count, Func&& func) const {
+  auto threads = std::min(threads_, count);
+  if (threads <= 1) {
+    for (auto i = 0UL; i < count; ++i) {
+      func(i);
+    }
+    return;
+  }
+  std::atomic<size_t> next = 0;
+  auto workers = std::vector<std::thread>{};
+  for (auto t = 0UL; t < threads; ++t) {
+    workers.emplace_back([&next, &func, count] {
+      for (auto i = next++; i < count; i = next++) {
+        func(i);
+      }
+    });
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+}
+
+void TraceReader::buildIndex() {
+  if (size_ < sizeof(trace_buffer_std_header_t)) {
+    throw Exception("Device trace buffer too small to hold a trace header");
+  }
+  auto tb = reinterpret_cast<const trace_buffer_std_header_t*>(data_);
+  if (tb->magic_header != TRACE_MAGIC_HEADER) {
+    throw Exception("Not a device trace buffer, wrong magic header");
+  }
+  if (tb->version.major != TRACE_VERSION_MAJOR || tb->version.minor > TRACE_VERSION_MINOR) {
+    throw Exception("Unsupported device trace layout version " + std::to_string(tb->version.major) + "." +
+                    std::to_string(tb->version.minor));
+  }
+
+  // sub-buffers holding entries, the first one starts with the standard header and the others with a size header
+  auto count = std::max<size_t>(tb->sub_buffer_count, 1);
+  auto candidates = std::vector<TraceSubBuffer>{};
+  auto indexes = std::vector<size_t>{};
+  for (auto i = 0UL; i < count; ++i) {
+    TraceSubBuffer sub;
+    sub.offset_ = i * tb->sub_buffer_size;
+    if (sub.offset_ + sizeof(trace_buffer_size_header_t) > size_) {
+      RT_LOG(WARNING) << "Device trace buffer truncated at sub-buffer " << i;
+      break;
+    }
+    auto headerSize = i == 0 ? sizeof(trace_buffer_std_header_t) : sizeof(trace_buffer_size_header_t);
+    sub.dataSize_ = i == 0 ? tb->data_size : reinterpret_cast<const trace_buffer_size_header_t*>(data_ + sub.offset_)->data_size;
+    if ((count > 1 && sub.dataSize_ > tb->sub_buffer_size) || sub.offset_ + sub.dataSize_ > size_) {
+      RT_LOG(WARNING) << "Device trace sub-buffer " << i << " data size out of bounds, ignoring it";
+      continue;
+    }
+    if (sub.dataSize_ > headerSize) {
+      candidates.emplace_back(sub);
+      indexes.emplace_back(i);
+    }
+  }
+
+  auto typeMasks = std::vector<uint64_t>(candidates.size());
+  auto checkpoints = std::vector<std::vector<Checkpoint>>(candidates.size());
+  parallelFor(candidates.size(), [&](size_t i) {
+    auto& sub = candidates[i];
+    auto& cps = checkpoints[i];
+    sub.firstCycle_ = std::numeric_limits<uint64_t>::max();
+    forEachEntry(tb, sub, indexes[i], nullptr, [&](const trace_entry_header_t& entry) {
+      if (sub.entries_ % kCheckpointInterval == 0) {
+        cps.emplace_back(Checkpoint{&entry, sub.entries_ == 0 ? 0 : sub.lastCycle_, 0});
+      }
+      uint64_t cycle = entry.cycle;
+      sub.firstCycle_ = std::min(sub.firstCycle_, cycle);
+      sub.lastCycle_ = std::max(sub.lastCycle_, cycle);
+      sub.shireMask_ |= getShireBit(entry.hart_id);
+      if (entry.type < 64) {
+        typeMasks[i] |= 1ULL << entry.type;
+      }
+      ++sub.entries_;
+      return true;
+    });
+    // lowest cycle from each checkpoint to the end, walking the checkpoints backwards
+    auto minCycle = std::numeric_limits<uint64_t>::max();
+    for (auto cp = cps.rbegin(); cp != cps.rend(); ++cp) {
+      auto chunkEnd = cp == cps.rbegin() ? nullptr : (cp - 1)->entry_;
+      forEachEntry(tb, sub, indexes[i], cp->entry_, [&](const trace_entry_header_t& entry) {
+        if (&entry == chunkEnd) {
+          return false;
+        }
+        uint64_t cycle = entry.cycle;
+        minCycle = std::min(minCycle, cycle);
+        return true;
+      });
+      cp->minCycleFrom_ = minCycle;
+    }
+  });
+
+  for (auto i = 0UL; i < candidates.size(); ++i) {
+    if (candidates[i].entries_ > 0) {
+      subBuffers_.emplace_back(candidates[i]);
+      typeMasks_.emplace_back(typeMasks[i]);
+      checkpoints_.emplace_back(std::move(checkpoints[i]));
+    }
+  }
+}
+
+std::vector<const trace_entry_header_t*> TraceReader::find(const TraceQuery& query) const {
+  auto tb = reinterpret_cast<const trace_buffer_std_header_t*>(data_);
+  auto typeMask = query.types_.empty() ? std::numeric_limits<uint64_t>::max() : 0ULL;
+  for (auto type : query.types_) {
+    typeMask |= type < 64 ? (1ULL << type) : 0;
+  }
+  auto shireMask = query.shireMask_;
+  if (query.hartId_) {
+    shireMask &= getShireBit(*query.hartId_);
+  }
+  auto matches = [&query, typeMask](const trace_entry_header_t& entry) {
+    return entry.cycle >= query.beginCycle_ && entry.cycle <= query.endCycle_ && entry.type < 64 &&
+           (typeMask & (1ULL << entry.type)) != 0 && (query.shireMask_ & getShireBit(entry.hart_id)) != 0 &&
+           (!query.hartId_ || entry.hart_id == *query.hartId_);
+  };
+
+  auto results = std::vector<std::vector<const trace_entry_header_t*>>(subBuffers_.size());
+  parallelFor(subBuffers_.size(), [&](size_t i) {
+    const auto& sub = subBuffers_[i];
+    const auto& cps = checkpoints_[i];
+    if (sub.lastCycle_ < query.beginCycle_ || sub.firstCycle_ > query.endCycle_ || (typeMasks_[i] & typeMask) == 0 ||
+        (sub.shireMask_ & shireMask) == 0) {
+      return;
+    }
+    // last checkpoint all the entries before which are older than the range
+    auto cp = std::partition_point(cps.begin(), cps.end(),
+                                   [&query](const Checkpoint& c) { return c.maxCycleBefore_ < query.beginCycle_; });
+    if (cp != cps.begin()) {
+      --cp;
+    }
+    auto subIndex = sub.offset_ / std::max<size_t>(tb->sub_buffer_size, 1);
+    auto& res = results[i];
+    auto entries = 0UL;
+    forEachEntry(tb, sub, subIndex, cp->entry_, [&](const trace_entry_header_t& entry) {
+      // at each checkpoint, stop if all the entries left are newer than the range
+      if (entries++ % kCheckpointInterval == 0 && cp != cps.end()) {
+        if (cp->minCycleFrom_ > query.endCycle_) {
+          return false;
+        }
+        ++cp;
+      }
+      if (matches(entry)) {
+        res.emplace_back(&entry);
+      }
+      return true;
+    });
+  });
+
+  auto res = std::vector<const trace_entry_header_t*>{};
+  for (auto& r : results) {
+    res.insert(res.end(), r.begin(), r.end());
+  }
+  std::stable_sort(res.begin(), res.end(),
+                   [](const trace_entry_header_t* a, const trace_entry_header_t* b) { return a->cycle < b->cycle; });
+  return res;
+}
+
+std::vector<PcHotspot> rt::profiling::getPcHotspots(const TraceReader& reader, TraceQuery query) {
+  query.types_ = {TRACE_TYPE_PC_SAMPLE};
+  auto hotspots = std::unordered_map<uint64_t, PcHotspot>{};
+  for (auto entry : reader.find(query)) {
+    auto sample = reinterpret_cast<const trace_pc_sample_t*>(entry);
+    auto& hotspot = hotspots[sample->pc];
+    hotspot.pc_ = sample->pc;
+    ++hotspot.samples_;
+    hotspot.shireMask_ |= getShireBit(sample->header.hart_id);
+  }
+  auto res = std::vector<PcHotspot>{};
+  res.reserve(hotspots.size());
+  for (const auto& [pc, hotspot] : hotspots) {
+    res.emplace_back(hotspot);
+  }
+  std::sort(res.begin(), res.end(), [](const PcHotspot& a, const PcHotspot& b) {
+    return a.samples_ != b.samples_ ? a.samples_ > b.samples_ : a.pc_ < b.pc_;
+  });
+  return res;
+}
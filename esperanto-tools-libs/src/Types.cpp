@@ -148,6 +148,41 @@ std::string std::to_string(rt::DeviceErrorCode e) {
     STR_DEVICE_ERROR_CODE(ErrorTypeCmSmodeRtException)
     STR_DEVICE_ERROR_CODE(ErrorTypeCmSmodeRtHang)
 
+    STR_DEVICE_ERROR_CODE(StreamSyncHostAborted)
+    STR_DEVICE_ERROR_CODE(StreamSyncInvalidSlot)
+
+    STR_DEVICE_ERROR_CODE(MemsetHostAborted)
+    STR_DEVICE_ERROR_CODE(MemsetInvalidAddress)
+    STR_DEVICE_ERROR_CODE(MemsetInvalidPattern)
+
+    STR_DEVICE_ERROR_CODE(DeviceMemcpyHostAborted)
+    STR_DEVICE_ERROR_CODE(DeviceMemcpyInvalidAddress)
+
+    STR_DEVICE_ERROR_CODE(KernelHeapHostAborted)
+    STR_DEVICE_ERROR_CODE(KernelHeapInvalidAddress)
+    STR_DEVICE_ERROR_CODE(KernelHeapKernelsRunning)
+
+    STR_DEVICE_ERROR_CODE(KernelFlushRangesHostAborted)
+    STR_DEVICE_ERROR_CODE(KernelFlushRangesInvalidAddress)
+
+    STR_DEVICE_ERROR_CODE(KernelShireArgsHostAborted)
+    STR_DEVICE_ERROR_CODE(KernelShireArgsInvalidStride)
+
+    STR_DEVICE_ERROR_CODE(KernelWatchdogHostAborted)
+
+    STR_DEVICE_ERROR_CODE(KernelPowerReportHostAborted)
+
+    STR_DEVICE_ERROR_CODE(KernelLaunchConfigHostAborted)
+    STR_DEVICE_ERROR_CODE(KernelLaunchConfigInvalidCacheConfig)
+
+    STR_DEVICE_ERROR_CODE(KernelMultiLaunchHostAborted)
+    STR_DEVICE_ERROR_CODE(KernelMultiLaunchInvalidArgs)
+
+    STR_DEVICE_ERROR_CODE(CommandListHostAborted)
+    STR_DEVICE_ERROR_CODE(CommandListInvalid)
+
+    STR_DEVICE_ERROR_CODE(MemcpyChecksumMismatch)
+
     STR_DEVICE_ERROR_CODE(Unknown)
 
   default:
@@ -4,6 +4,9 @@
  *-------------------------------------------------------------------------*/
 #include "Utils.h"
 #include "runtime/Types.h"
+#include "runtime/DeviceOpsExt.h"
+#include <array>
+#include <cstring>
 #include <esperanto/device-apis/operations-api/device_ops_api_spec.h>
 rt::DeviceErrorCode convert(int responseType, uint32_t responseCode) {
   switch (responseType) {
@@ -77,6 +80,7 @@ rt::DeviceErrorCode convert(int responseType, uint32_t responseCode) {
     }
   case DEV_OPS_API_MID_DEVICE_OPS_DMA_READLIST_RSP:
   case DEV_OPS_API_MID_DEVICE_OPS_DMA_WRITELIST_RSP:
+  case rt::device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_DMA_CHAIN_RSP:
     switch (responseCode) {
     case DEV_OPS_API_DMA_RESPONSE_UNEXPECTED_ERROR:
       return rt::DeviceErrorCode::DmaUnexpectedError;
@@ -193,8 +197,208 @@ rt::DeviceErrorCode convert(int responseType, uint32_t responseCode) {
       RT_LOG(WARNING) << "Unknown DEV_OPS_API_MID_DEVICE_OPS_DEVICE_FW_ERROR response code: " << responseCode;
       return rt::DeviceErrorCode::Unknown;
     }
+  case rt::device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_STREAM_SYNC_RSP:
+    switch (responseCode) {
+    case rt::device_ops_ext::STREAM_SYNC_RESPONSE_HOST_ABORTED:
+      return rt::DeviceErrorCode::StreamSyncHostAborted;
+    case rt::device_ops_ext::STREAM_SYNC_RESPONSE_INVALID_SLOT:
+      return rt::DeviceErrorCode::StreamSyncInvalidSlot;
+    default:
+      RT_LOG(WARNING) << "Unknown DEV_OPS_API_MID_DEVICE_OPS_STREAM_SYNC_RSP response code: " << responseCode;
+      return rt::DeviceErrorCode::Unknown;
+    }
+  case rt::device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_MEMSET_RSP:
+    switch (responseCode) {
+    case rt::device_ops_ext::MEMSET_RESPONSE_HOST_ABORTED:
+      return rt::DeviceErrorCode::MemsetHostAborted;
+    case rt::device_ops_ext::MEMSET_RESPONSE_INVALID_ADDRESS:
+      return rt::DeviceErrorCode::MemsetInvalidAddress;
+    case rt::device_ops_ext::MEMSET_RESPONSE_INVALID_PATTERN:
+      return rt::DeviceErrorCode::MemsetInvalidPattern;
+    default:
+      RT_LOG(WARNING) << "Unknown DEV_OPS_API_MID_DEVICE_OPS_MEMSET_RSP response code: " << responseCode;
+      return rt::DeviceErrorCode::Unknown;
+    }
+  case rt::device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_DEVICE_MEMCPY_RSP:
+    switch (responseCode) {
+    case rt::device_ops_ext::DEVICE_MEMCPY_RESPONSE_HOST_ABORTED:
+      return rt::DeviceErrorCode::DeviceMemcpyHostAborted;
+    case rt::device_ops_ext::DEVICE_MEMCPY_RESPONSE_INVALID_ADDRESS:
+      return rt::DeviceErrorCode::DeviceMemcpyInvalidAddress;
+    default:
+      RT_LOG(WARNING) << "Unknown DEV_OPS_API_MID_DEVICE_OPS_DEVICE_MEMCPY_RSP response code: " << responseCode;
+      return rt::DeviceErrorCode::Unknown;
+    }
+  case rt::device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_KERNEL_HEAP_CONFIG_RSP:
+    switch (responseCode) {
+    case rt::device_ops_ext::KERNEL_HEAP_CONFIG_RESPONSE_HOST_ABORTED:
+      return rt::DeviceErrorCode::KernelHeapHostAborted;
+    case rt::device_ops_ext::KERNEL_HEAP_CONFIG_RESPONSE_INVALID_ADDRESS:
+      return rt::DeviceErrorCode::KernelHeapInvalidAddress;
+    case rt::device_ops_ext::KERNEL_HEAP_CONFIG_RESPONSE_KERNELS_RUNNING:
+      return rt::DeviceErrorCode::KernelHeapKernelsRunning;
+    default:
+      RT_LOG(WARNING) << "Unknown DEV_OPS_API_MID_DEVICE_OPS_KERNEL_HEAP_CONFIG_RSP response code: " << responseCode;
+      return rt::DeviceErrorCode::Unknown;
+    }
+  case rt::device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_KERNEL_FLUSH_RANGES_RSP:
+    switch (responseCode) {
+    case rt::device_ops_ext::KERNEL_FLUSH_RANGES_RESPONSE_HOST_ABORTED:
+      return rt::DeviceErrorCode::KernelFlushRangesHostAborted;
+    case rt::device_ops_ext::KERNEL_FLUSH_RANGES_RESPONSE_INVALID_ADDRESS:
+      return rt::DeviceErrorCode::KernelFlushRangesInvalidAddress;
+    default:
+      RT_LOG(WARNING) << "Unknown DEV_OPS_API_MID_DEVICE_OPS_KERNEL_FLUSH_RANGES_RSP response code: " << responseCode;
+      return rt::DeviceErrorCode::Unknown;
+    }
+  case rt::device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_KERNEL_SHIRE_ARGS_RSP:
+    switch (responseCode) {
+    case rt::device_ops_ext::KERNEL_SHIRE_ARGS_RESPONSE_HOST_ABORTED:
+      return rt::DeviceErrorCode::KernelShireArgsHostAborted;
+    case rt::device_ops_ext::KERNEL_SHIRE_ARGS_RESPONSE_INVALID_STRIDE:
+      return rt::DeviceErrorCode::KernelShireArgsInvalidStride;
+    default:
+      RT_LOG(WARNING) << "Unknown DEV_OPS_API_MID_DEVICE_OPS_KERNEL_SHIRE_ARGS_RSP response code: " << responseCode;
+      return rt::DeviceErrorCode::Unknown;
+    }
+  case rt::device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_KERNEL_WATCHDOG_RSP:
+    switch (responseCode) {
+    case rt::device_ops_ext::KERNEL_WATCHDOG_RESPONSE_HOST_ABORTED:
+      return rt::DeviceErrorCode::KernelWatchdogHostAborted;
+    default:
+      RT_LOG(WARNING) << "Unknown DEV_OPS_API_MID_DEVICE_OPS_KERNEL_WATCHDOG_RSP response code: " << responseCode;
+      return rt::DeviceErrorCode::Unknown;
+    }
+  case rt::device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_KERNEL_LAUNCH_CONFIG_RSP:
+    switch (responseCode) {
+    case rt::device_ops_ext::KERNEL_LAUNCH_CONFIG_RESPONSE_HOST_ABORTED:
+      return rt::DeviceErrorCode::KernelLaunchConfigHostAborted;
+    case rt::device_ops_ext::KERNEL_LAUNCH_CONFIG_RESPONSE_INVALID_CACHE_CONFIG:
+      return rt::DeviceErrorCode::KernelLaunchConfigInvalidCacheConfig;
+    default:
+      RT_LOG(WARNING) << "Unknown DEV_OPS_API_MID_DEVICE_OPS_KERNEL_LAUNCH_CONFIG_RSP response code: " << responseCode;
+      return rt::DeviceErrorCode::Unknown;
+    }
+  case rt::device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_KERNEL_POWER_REPORT_RSP:
+    switch (responseCode) {
+    case rt::device_ops_ext::KERNEL_POWER_REPORT_RESPONSE_HOST_ABORTED:
+      return rt::DeviceErrorCode::KernelPowerReportHostAborted;
+    default:
+      RT_LOG(WARNING) << "Unknown DEV_OPS_API_MID_DEVICE_OPS_KERNEL_POWER_REPORT_RSP response code: " << responseCode;
+      return rt::DeviceErrorCode::Unknown;
+    }
+  case rt::device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_KERNEL_MULTI_LAUNCH_RSP:
+    switch (responseCode) {
+    case rt::device_ops_ext::KERNEL_MULTI_LAUNCH_RESPONSE_HOST_ABORTED:
+      return rt::DeviceErrorCode::KernelMultiLaunchHostAborted;
+    case rt::device_ops_ext::KERNEL_MULTI_LAUNCH_RESPONSE_INVALID_ARGS:
+      return rt::DeviceErrorCode::KernelMultiLaunchInvalidArgs;
+    default:
+      RT_LOG(WARNING) << "Unknown DEV_OPS_API_MID_DEVICE_OPS_KERNEL_MULTI_LAUNCH_RSP response code: " << responseCode;
+      return rt::DeviceErrorCode::Unknown;
+    }
+  case rt::device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_CMD_LIST_EXECUTE_RSP:
+    switch (responseCode) {
+    case rt::device_ops_ext::CMD_LIST_RESPONSE_HOST_ABORTED:
+      return rt::DeviceErrorCode::CommandListHostAborted;
+    case rt::device_ops_ext::CMD_LIST_RESPONSE_INVALID_LIST:
+      return rt::DeviceErrorCode::CommandListInvalid;
+    default:
+      RT_LOG(WARNING) << "Unknown DEV_OPS_API_MID_DEVICE_OPS_CMD_LIST_EXECUTE_RSP response code: " << responseCode;
+      return rt::DeviceErrorCode::Unknown;
+    }
   default:
     RT_LOG(WARNING) << "Unknown errorcodes for this response: " << responseCode;
     return rt::DeviceErrorCode::Unknown;
   }
 }
+
+namespace {
+// slicing-by-8 tables, the same ones the crc32 kernels of test-compute-kernels use
+constexpr std::array<std::array<uint32_t, 256>, 8> kCrc32Tables = [] {
+  std::array<std::array<uint32_t, 256>, 8> tables{};
+  for (uint32_t i = 0; i < 256; ++i) {
+    auto crc = i;
+    for (int j = 0; j < 8; ++j) {
+      crc = (crc >> 1) ^ ((crc & 1) ? 0xEDB88320U : 0U);
+    }
+    tables[0][i] = crc;
+  }
+  for (uint32_t i = 0; i < 256; ++i) {
+    for (size_t t = 1; t < 8; ++t) {
+      tables[t][i] = (tables[t - 1][i] >> 8) ^ tables[0][tables[t - 1][i] & 0xFF];
+    }
+  }
+  return tables;
+}();
+
+// crc32Combine works with the 32x32 GF(2) matrices shifting a CRC by a number of zero bits, one column per element
+using Gf2Matrix = std::array<uint32_t, 32>;
+
+uint32_t gf2MatrixTimes(const Gf2Matrix& matrix, uint32_t vector) {
+  auto sum = 0U;
+  for (auto i = 0U; vector != 0; ++i, vector >>= 1) {
+    if (vector & 1) {
+      sum ^= matrix[i];
+    }
+  }
+  return sum;
+}
+
+Gf2Matrix gf2MatrixSquare(const Gf2Matrix& matrix) {
+  Gf2Matrix square;
+  for (auto i = 0U; i < square.size(); ++i) {
+    square[i] = gf2MatrixTimes(matrix, matrix[i]);
+  }
+  return square;
+}
+} // namespace
+
+uint32_t crc32(const std::byte* data, size_t size, uint32_t previousCrc) {
+  const auto& t = kCrc32Tables;
+  auto crc = ~previousCrc;
+  for (; size >= 8; size -= 8, data += 8) {
+    uint32_t one;
+    uint32_t two;
+    std::memcpy(&one, data, sizeof(one));
+    std::memcpy(&two, data + 4, sizeof(two));
+    one ^= crc;
+    crc = t[7][one & 0xFF] ^ t[6][(one >> 8) & 0xFF] ^ t[5][(one >> 16) & 0xFF] ^ t[4][one >> 24] ^
+          t[3][two & 0xFF] ^ t[2][(two >> 8) & 0xFF] ^ t[1][(two >> 16) & 0xFF] ^ t[0][two >> 24];
+  }
+  for (; size > 0; --size, ++data) {
+    crc = (crc >> 8) ^ t[0][(crc ^ std::to_integer<uint32_t>(*data)) & 0xFF];
+  }
+  return ~crc;
+}
+
+uint32_t crc32Combine(uint32_t crc1, uint32_t crc2, size_t size2) {
+  if (size2 == 0) {
+    return crc1;
+  }
+  // operator shifting one zero bit, then squared to shift two and four
+  Gf2Matrix odd;
+  odd[0] = 0xEDB88320U;
+  for (auto i = 1U; i < odd.size(); ++i) {
+    odd[i] = 1U << (i - 1);
+  }
+  auto even = gf2MatrixSquare(odd);
+  odd = gf2MatrixSquare(even);
+  // apply size2 zero bytes to crc1, squaring the operator for each bit of size2 (the first square shifts one byte)
+  while (size2 != 0) {
+    even = gf2MatrixSquare(odd);
+    if (size2 & 1) {
+      crc1 = gf2MatrixTimes(even, crc1);
+    }
+    size2 >>= 1;
+    if (size2 == 0) {
+      break;
+    }
+    odd = gf2MatrixSquare(even);
+    if (size2 & 1) {
+      crc1 = gf2MatrixTimes(odd, crc1);
+    }
+    size2 >>= 1;
+  }
+  return crc1 ^ crc2;
+}
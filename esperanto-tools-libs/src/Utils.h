@@ -10,6 +10,12 @@
 #include <hostUtils/logging/Logging.h>
 #include <runtime/Types.h>
 #include <string>
+
+#define RT_LOG(severity) ET_LOG(RUNTIME, severity)                             /*NOSONAR*/
+#define RT_DLOG(severity) ET_DLOG(RUNTIME, severity)                           /*NOSONAR*/
+#define RT_VLOG(severity) ET_VLOG(RUNTIME, severity)                           /*NOSONAR*/
+#define RT_LOG_IF(severity, condition) ET_LOG_IF(RUNTIME, severity, condition) /*NOSONAR*/
+
 namespace rt {
 inline std::string stringizeEvents(const std::vector<EventId>& events) {
   std::stringstream ss;
@@ -27,6 +33,23 @@ template <typename Container, typename Key> auto find(Container& c, Key&& k, con
   }
   return it;
 }
+
+// runs a user completion callback, through the user executor if there is one. Exceptions are logged, never propagated
+inline void runEventCompletionCallback(const CallbackExecutor& executor, EventId event,
+                                       EventCompletionCallback callback) {
+  auto task = [event, callback = std::move(callback)] {
+    try {
+      callback(event);
+    } catch (const std::exception& e) {
+      RT_LOG(WARNING) << "Event " << static_cast<int>(event) << " completion callback threw: " << e.what();
+    }
+  };
+  if (executor) {
+    executor(std::move(task));
+  } else {
+    task();
+  }
+}
 } // namespace rt
 
 template <typename T, typename U> T align(T address, U alignment) {
@@ -44,13 +67,14 @@ template <typename T, typename... Args> void unused(T t, Args... args) {
   unused(t);
   unused(args...);
 }
-#define RT_LOG(severity) ET_LOG(RUNTIME, severity)                             /*NOSONAR*/
-#define RT_DLOG(severity) ET_DLOG(RUNTIME, severity)                           /*NOSONAR*/
-#define RT_VLOG(severity) ET_VLOG(RUNTIME, severity)                           /*NOSONAR*/
-#define RT_LOG_IF(severity, condition) ET_LOG_IF(RUNTIME, severity, condition) /*NOSONAR*/
 
 rt::DeviceErrorCode convert(int responseType, uint32_t responseCode);
 
+// CRC32 (reflected 0xEDB88320 polynomial, like zlib) of size bytes, continuing from previousCrc
+uint32_t crc32(const std::byte* data, size_t size, uint32_t previousCrc = 0);
+// CRC32 of the concatenation of two blocks, given the CRC32 of each one and the size of the second
+uint32_t crc32Combine(uint32_t crc1, uint32_t crc2, size_t size2);
+
 template <typename Mutex> struct SpinLock : public std::unique_lock<Mutex> {
   explicit SpinLock(Mutex& mutex, std::chrono::milliseconds spinTime = std::chrono::milliseconds(10))
     : std::unique_lock<Mutex>{mutex, std::defer_lock} {
@@ -0,0 +1,160 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) 2025 Ainekko, Co.
+ * SPDX-License-Identifier: Apache-2.0
+ *-------------------------------------------------------------------------*/
+
+#include "runtime/WorkQueue.h"
+#include "Utils.h"
+#include <cstring>
+#include <limits>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace rt;
+
+namespace {
+// work_queue_cb_t layout, see transports/work_queue/work_queue.h
+constexpr size_t kHeadOffset = 0;
+constexpr size_t kCompletedOffset = 128;
+constexpr size_t kStopOffset = 192;
+constexpr size_t kSlotCountOffset = 200; // followed by slot_size
+constexpr size_t kSlotsOffset = 256;
+constexpr size_t kSlotHeaderSize = 16; // work_queue_slot_t done and status
+
+constexpr auto kPollPeriod = std::chrono::microseconds(100);
+} // namespace
+
+WorkQueue::WorkQueue(IRuntime& runtime, DeviceId device, uint32_t slotCount, uint32_t payloadSize)
+  : runtime_(runtime)
+  , device_(device) {
+  if (slotCount == 0 || payloadSize == 0 || payloadSize % 8 != 0 ||
+      payloadSize > std::numeric_limits<uint32_t>::max() - kSlotHeaderSize) {
+    throw Exception("Invalid work queue of " + std::to_string(slotCount) + " slots with a payload of " +
+                    std::to_string(payloadSize) + " bytes");
+  }
+  slotCount_ = slotCount;
+  slotSize_ = payloadSize + static_cast<uint32_t>(kSlotHeaderSize);
+  auto size = kSlotsOffset + static_cast<size_t>(slotCount_) * slotSize_;
+  stream_ = runtime_.createStream(device_);
+  queue_ = runtime_.mallocDevice(device_, size);
+  try {
+    runtime_.memsetDevice(stream_, queue_, 0, size);
+    writeWord(queue_ + kSlotCountOffset, slotCount_ | (static_cast<uint64_t>(slotSize_) << 32));
+  } catch (...) {
+    runtime_.freeDevice(device_, queue_);
+    runtime_.destroyStream(stream_);
+    throw;
+  }
+  RT_VLOG(LOW) << "Work queue of " << slotCount_ << " slots of " << slotSize_ << " bytes at " << queue_;
+}
+
+WorkQueue::~WorkQueue() {
+  try {
+    runtime_.waitForStream(stream_);
+    runtime_.freeDevice(device_, queue_);
+    runtime_.destroyStream(stream_);
+  } catch (const Exception& e) {
+    RT_LOG(WARNING) << "Couldn't release work queue resources of device " << static_cast<int>(device_)
+                    << ". Error: " << e.what();
+  }
+}
+
+std::byte* WorkQueue::getDeviceAddress() const {
+  return queue_;
+}
+
+uint64_t WorkQueue::push(const std::byte* payload, size_t size, std::chrono::seconds timeout) {
+  if (stopped_) {
+    throw Exception("Can't push items to a stopped work queue");
+  }
+  auto payloadSize = slotSize_ - kSlotHeaderSize;
+  if (size > payloadSize) {
+    throw Exception("Work item of " + std::to_string(size) + " bytes, the payload size is " +
+                    std::to_string(payloadSize));
+  }
+  auto position = head_;
+  if (position >= slotCount_) {
+    // the slot is released once the item which used it last is completed
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (readSlotHeader(position).done_ != position - slotCount_ + 1) {
+      if (std::chrono::steady_clock::now() > deadline) {
+        throw Exception("Timeout waiting for the slot of work item " + std::to_string(position));
+      }
+      std::this_thread::sleep_for(kPollPeriod);
+    }
+  }
+  std::vector<std::byte> item(payloadSize);
+  std::memcpy(item.data(), payload, size);
+  runtime_.memcpyHostToDevice(stream_, item.data(), getSlot(position) + kSlotHeaderSize, item.size(), false);
+  // head goes after the payload, so the consumers never claim a partially written item
+  writeWord(queue_ + kHeadOffset, position + 1);
+  ++head_;
+  return position;
+}
+
+void WorkQueue::stop() {
+  writeWord(queue_ + kStopOffset, 1);
+  stopped_ = true;
+}
+
+uint64_t WorkQueue::getCompleted() {
+  return readWord(queue_ + kCompletedOffset);
+}
+
+bool WorkQueue::waitForCompleted(uint64_t count, std::chrono::seconds timeout) {
+  auto deadline = std::chrono::steady_clock::now() + timeout;
+  while (getCompleted() < count) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+    std::this_thread::sleep_for(kPollPeriod);
+  }
+  return true;
+}
+
+std::optional<int64_t> WorkQueue::getStatus(uint64_t position) {
+  if (position >= head_) {
+    throw Exception("Work item " + std::to_string(position) + " has not been pushed");
+  }
+  auto header = readSlotHeader(position);
+  if (header.done_ > position + 1) {
+    throw Exception("The slot of work item " + std::to_string(position) + " has been reused");
+  }
+  if (header.done_ != position + 1) {
+    return std::nullopt;
+  }
+  return header.status_;
+}
+
+std::byte* WorkQueue::getSlot(uint64_t position) const {
+  return queue_ + kSlotsOffset + (position % slotCount_) * slotSize_;
+}
+
+WorkQueue::SlotHeader WorkQueue::readSlotHeader(uint64_t position) {
+  SlotHeader header;
+  auto evt =
+    runtime_.memcpyDeviceToHost(stream_, getSlot(position), reinterpret_cast<std::byte*>(&header), sizeof(header));
+  if (!runtime_.waitForEvent(evt)) {
+    throw Exception("Timeout reading the slot of work item " + std::to_string(position));
+  }
+  return header;
+}
+
+uint64_t WorkQueue::readWord(const std::byte* d_src) {
+  uint64_t value;
+  auto evt = runtime_.memcpyDeviceToHost(stream_, d_src, reinterpret_cast<std::byte*>(&value), sizeof(value));
+  if (!runtime_.waitForEvent(evt)) {
+    throw Exception("Timeout reading the work queue");
+  }
+  return value;
+}
+
+void WorkQueue::writeWord(std::byte* d_dst, uint64_t value) {
+  // with a barrier, so it lands after all the previous writes
+  auto evt =
+    runtime_.memcpyHostToDevice(stream_, reinterpret_cast<const std::byte*>(&value), d_dst, sizeof(value), true);
+  if (!runtime_.waitForEvent(evt)) {
+    throw Exception("Timeout writing the work queue");
+  }
+}
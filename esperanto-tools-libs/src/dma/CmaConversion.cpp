@@ -0,0 +1,253 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) 2025 Ainekko, Co.
+ * SPDX-License-Identifier: Apache-2.0
+ *-------------------------------------------------------------------------*/
+#include "dma/CmaConversion.h"
+#include "Utils.h"
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+using namespace rt;
+
+namespace {
+uint32_t toBits(float value) {
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+float fromBits(uint32_t bits) {
+  float value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+uint16_t floatToHalf(float value) {
+  constexpr uint32_t kHalfOverflow = (127U + 16U) << 23;
+  constexpr uint32_t kHalfMinNormal = 113U << 23;
+  // adding it to a value below kHalfMinNormal leaves the half subnormal in the low bits, rounded by the FPU
+  constexpr uint32_t kSubnormalMagic = ((127U - 15U) + (23U - 10U) + 1U) << 23;
+  auto bits = toBits(value);
+  auto sign = static_cast<uint16_t>((bits >> 16) & 0x8000U);
+  bits &= 0x7FFFFFFFU;
+  if (bits >= kHalfOverflow) {
+    return sign | (bits > 0x7F800000U ? 0x7E00U : 0x7C00U);
+  }
+  if (bits < kHalfMinNormal) {
+    return sign | static_cast<uint16_t>(toBits(fromBits(bits) + fromBits(kSubnormalMagic)) - kSubnormalMagic);
+  }
+  auto odd = (bits >> 13) & 1U;
+  bits -= (127U - 15U) << 23;
+  bits += 0xFFFU + odd;
+  return sign | static_cast<uint16_t>(bits >> 13);
+}
+
+float halfToFloat(uint16_t half) {
+  auto sign = static_cast<uint32_t>(half & 0x8000U) << 16;
+  auto exponent = (half >> 10) & 0x1FU;
+  auto mantissa = static_cast<uint32_t>(half & 0x3FFU);
+  if (exponent == 0x1FU) {
+    return fromBits(sign | 0x7F800000U | (mantissa << 13));
+  }
+  if (exponent == 0) {
+    auto magnitude = std::ldexp(static_cast<float>(mantissa), -24);
+    return fromBits(sign | toBits(magnitude));
+  }
+  return fromBits(sign | ((exponent + 112U) << 23) | (mantissa << 13));
+}
+
+// the scalar loops below are simple enough for the compiler to vectorize them
+void toBf16(const float* src, uint16_t* dst, size_t count) {
+  for (auto i = 0UL; i < count; ++i) {
+    auto bits = toBits(src[i]);
+    auto isNan = (bits & 0x7FFFFFFFU) > 0x7F800000U;
+    // quiet the NaNs, so they don't become infinities when truncated
+    dst[i] = static_cast<uint16_t>(isNan ? (bits >> 16) | 0x40U : (bits + 0x7FFFU + ((bits >> 16) & 1U)) >> 16);
+  }
+}
+
+void fromBf16(const uint16_t* src, float* dst, size_t count) {
+  for (auto i = 0UL; i < count; ++i) {
+    dst[i] = fromBits(static_cast<uint32_t>(src[i]) << 16);
+  }
+}
+
+// NaNs become -128, the same as the vector version
+int8_t toInt8(float value, float inverseScale) {
+  auto scaled = value * inverseScale;
+  scaled = scaled > -128.0f ? scaled : -128.0f;
+  scaled = scaled < 127.0f ? scaled : 127.0f;
+  return static_cast<int8_t>(std::nearbyint(scaled));
+}
+
+void fromInt8(const int8_t* src, float* dst, size_t count, float scale) {
+  for (auto i = 0UL; i < count; ++i) {
+    dst[i] = static_cast<float>(src[i]) * scale;
+  }
+}
+
+void toHalfScalar(const float* src, uint16_t* dst, size_t count) {
+  for (auto i = 0UL; i < count; ++i) {
+    dst[i] = floatToHalf(src[i]);
+  }
+}
+
+void fromHalfScalar(const uint16_t* src, float* dst, size_t count) {
+  for (auto i = 0UL; i < count; ++i) {
+    dst[i] = halfToFloat(src[i]);
+  }
+}
+
+void toInt8Scalar(const float* src, int8_t* dst, size_t count, float inverseScale) {
+  for (auto i = 0UL; i < count; ++i) {
+    dst[i] = toInt8(src[i], inverseScale);
+  }
+}
+
+using ToHalfFunction = void (*)(const float*, uint16_t*, size_t);
+using FromHalfFunction = void (*)(const uint16_t*, float*, size_t);
+using ToInt8Function = void (*)(const float*, int8_t*, size_t, float);
+
+#if defined(__x86_64__)
+__attribute__((target("avx,f16c"))) void toHalfF16c(const float* src, uint16_t* dst, size_t count) {
+  auto i = 0UL;
+  for (; i + 8 <= count; i += 8) {
+    auto half = _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), half);
+  }
+  toHalfScalar(src + i, dst + i, count - i);
+}
+
+__attribute__((target("avx,f16c"))) void fromHalfF16c(const uint16_t* src, float* dst, size_t count) {
+  auto i = 0UL;
+  for (; i + 8 <= count; i += 8) {
+    _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i))));
+  }
+  fromHalfScalar(src + i, dst + i, count - i);
+}
+
+__attribute__((target("avx2"))) void toInt8Avx2(const float* src, int8_t* dst, size_t count, float inverseScale) {
+  auto scale = _mm256_set1_ps(inverseScale);
+  auto low = _mm256_set1_ps(-128.0f);
+  auto high = _mm256_set1_ps(127.0f);
+  // packing works within 128 bit lanes, this puts the 32 bytes back in order
+  auto order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+  auto i = 0UL;
+  for (; i + 32 <= count; i += 32) {
+    __m256i words[4];
+    for (auto j = 0; j < 4; ++j) {
+      auto scaled = _mm256_mul_ps(_mm256_loadu_ps(src + i + 8 * j), scale);
+      // max returns its second operand for NaNs
+      scaled = _mm256_min_ps(_mm256_max_ps(scaled, low), high);
+      words[j] = _mm256_cvtps_epi32(scaled);
+    }
+    auto shorts0 = _mm256_packs_epi32(words[0], words[1]);
+    auto shorts1 = _mm256_packs_epi32(words[2], words[3]);
+    auto bytes = _mm256_permutevar8x32_epi32(_mm256_packs_epi16(shorts0, shorts1), order);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), bytes);
+  }
+  toInt8Scalar(src + i, dst + i, count - i, inverseScale);
+}
+
+struct Converters {
+  ToHalfFunction toHalf_ = toHalfScalar;
+  FromHalfFunction fromHalf_ = fromHalfScalar;
+  ToInt8Function toInt8_ = toInt8Scalar;
+};
+
+Converters selectConverters() {
+  Converters converters;
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx") && __builtin_cpu_supports("f16c")) {
+    converters.toHalf_ = toHalfF16c;
+    converters.fromHalf_ = fromHalfF16c;
+  }
+  if (__builtin_cpu_supports("avx2")) {
+    converters.toInt8_ = toInt8Avx2;
+  }
+  return converters;
+}
+#else
+struct Converters {
+  ToHalfFunction toHalf_ = toHalfScalar;
+  FromHalfFunction fromHalf_ = fromHalfScalar;
+  ToInt8Function toInt8_ = toInt8Scalar;
+};
+
+Converters selectConverters() {
+  return Converters{};
+}
+#endif
+
+const Converters& getConverters() {
+  // resolved once, from the CPU features
+  static const auto converters = selectConverters();
+  return converters;
+}
+} // namespace
+
+size_t rt::getDeviceElementSize(DeviceElementType type) {
+  switch (type) {
+  case DeviceElementType::Fp16:
+  case DeviceElementType::Bf16:
+    return 2;
+  case DeviceElementType::Int8:
+    return 1;
+  default:
+    throw Exception("Unknown device element type: " + std::to_string(static_cast<int>(type)));
+  }
+}
+
+void rt::convertToDevice(const float* src, std::byte* dst, size_t count, const MemcpyConversion& conversion) {
+  switch (conversion.type_) {
+  case DeviceElementType::Fp16:
+    getConverters().toHalf_(src, reinterpret_cast<uint16_t*>(dst), count);
+    break;
+  case DeviceElementType::Bf16:
+    toBf16(src, reinterpret_cast<uint16_t*>(dst), count);
+    break;
+  case DeviceElementType::Int8:
+    getConverters().toInt8_(src, reinterpret_cast<int8_t*>(dst), count, 1.0f / conversion.scale_);
+    break;
+  default:
+    throw Exception("Unknown device element type: " + std::to_string(static_cast<int>(conversion.type_)));
+  }
+}
+
+void rt::convertFromDevice(const std::byte* src, float* dst, size_t count, const MemcpyConversion& conversion) {
+  switch (conversion.type_) {
+  case DeviceElementType::Fp16:
+    getConverters().fromHalf_(reinterpret_cast<const uint16_t*>(src), dst, count);
+    break;
+  case DeviceElementType::Bf16:
+    fromBf16(reinterpret_cast<const uint16_t*>(src), dst, count);
+    break;
+  case DeviceElementType::Int8:
+    fromInt8(reinterpret_cast<const int8_t*>(src), dst, count, conversion.scale_);
+    break;
+  default:
+    throw Exception("Unknown device element type: " + std::to_string(static_cast<int>(conversion.type_)));
+  }
+}
+
+CmaCopyFunction rt::makeConvertingCopyFunction(const MemcpyConversion& conversion, const std::byte* hostBase) {
+  auto elementSize = getDeviceElementSize(conversion.type_);
+  return [conversion, hostBase, elementSize](const std::byte* src, std::byte* dst, size_t size, CmaCopyType type) {
+    // the staging slabs and the dma elements are multiples of the element size, so no element is split across copies
+    assert(size % elementSize == 0);
+    if (type == CmaCopyType::TO_CMA) {
+      auto host = reinterpret_cast<const float*>(hostBase) + static_cast<size_t>(src - hostBase) / elementSize;
+      convertToDevice(host, dst, size / elementSize, conversion);
+    } else {
+      auto host = reinterpret_cast<float*>(const_cast<std::byte*>(hostBase)) +
+                  static_cast<size_t>(dst - hostBase) / elementSize;
+      convertFromDevice(src, host, size / elementSize, conversion);
+    }
+  };
+}
@@ -0,0 +1,23 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) 2025 Ainekko, Co.
+ * SPDX-License-Identifier: Apache-2.0
+ *-------------------------------------------------------------------------*/
+
+#pragma once
+#include "runtime/Types.h"
+#include <cstddef>
+
+namespace rt {
+// bytes of each element of the device side of a converting memcpy
+size_t getDeviceElementSize(DeviceElementType type);
+
+// converts count fp32 values into device elements, rounding to nearest even
+void convertToDevice(const float* src, std::byte* dst, size_t count, const MemcpyConversion& conversion);
+
+// converts count device elements into fp32 values
+void convertFromDevice(const std::byte* src, float* dst, size_t count, const MemcpyConversion& conversion);
+
+// cma copy function of a memcpy converting the fp32 host buffer at hostBase. The memcpy actions see the host buffer
+// as if it had the device layout, so the offsets they give from hostBase are in device bytes
+CmaCopyFunction makeConvertingCopyFunction(const MemcpyConversion& conversion, const std::byte* hostBase);
+} // namespace rt
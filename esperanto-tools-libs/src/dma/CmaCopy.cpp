@@ -0,0 +1,147 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) 2025 Ainekko, Co.
+ * SPDX-License-Identifier: Apache-2.0
+ *-------------------------------------------------------------------------*/
+#include "Utils.h"
+#include "runtime/Types.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+using namespace rt;
+
+namespace {
+// smaller copies are left to memcpy, the lines could still be in the host caches when they are read back
+constexpr auto kStreamingThreshold = 64UL * 1024UL;
+// bytes loaded ahead of the copy when reading from the staging memory
+constexpr auto kPrefetchDistance = 1024UL;
+
+using CopyFunction = void (*)(const std::byte* src, std::byte* dst, size_t size);
+
+void copyPlain(const std::byte* src, std::byte* dst, size_t size) {
+  std::memcpy(dst, src, size);
+}
+
+#if defined(__x86_64__)
+// the staging memory is only written once and then read by the DMA engine, non-temporal stores skip the host caches
+// and don't need to read the destination lines first. The unaligned head and the tail are copied with memcpy; returns
+// the bytes copied to align dst
+size_t copyHead(const std::byte* src, std::byte* dst, size_t size, size_t alignment) {
+  auto head = std::min(size, (alignment - (reinterpret_cast<uintptr_t>(dst) % alignment)) % alignment);
+  std::memcpy(dst, src, head);
+  return head;
+}
+
+void copyToCmaSse2(const std::byte* src, std::byte* dst, size_t size) {
+  auto head = copyHead(src, dst, size, 16);
+  src += head;
+  dst += head;
+  size -= head;
+  for (; size >= 64; size -= 64, src += 64, dst += 64) {
+    auto a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+    auto b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 16));
+    auto c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 32));
+    auto d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 48));
+    _mm_stream_si128(reinterpret_cast<__m128i*>(dst), a);
+    _mm_stream_si128(reinterpret_cast<__m128i*>(dst + 16), b);
+    _mm_stream_si128(reinterpret_cast<__m128i*>(dst + 32), c);
+    _mm_stream_si128(reinterpret_cast<__m128i*>(dst + 48), d);
+  }
+  _mm_sfence();
+  std::memcpy(dst, src, size);
+}
+
+__attribute__((target("avx2"))) void copyToCmaAvx2(const std::byte* src, std::byte* dst, size_t size) {
+  auto head = copyHead(src, dst, size, 32);
+  src += head;
+  dst += head;
+  size -= head;
+  for (; size >= 128; size -= 128, src += 128, dst += 128) {
+    auto a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+    auto b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 32));
+    auto c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 64));
+    auto d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 96));
+    _mm256_stream_si256(reinterpret_cast<__m256i*>(dst), a);
+    _mm256_stream_si256(reinterpret_cast<__m256i*>(dst + 32), b);
+    _mm256_stream_si256(reinterpret_cast<__m256i*>(dst + 64), c);
+    _mm256_stream_si256(reinterpret_cast<__m256i*>(dst + 96), d);
+  }
+  _mm_sfence();
+  std::memcpy(dst, src, size);
+}
+
+__attribute__((target("avx512f"))) void copyToCmaAvx512(const std::byte* src, std::byte* dst, size_t size) {
+  auto head = copyHead(src, dst, size, 64);
+  src += head;
+  dst += head;
+  size -= head;
+  for (; size >= 256; size -= 256, src += 256, dst += 256) {
+    auto a = _mm512_loadu_si512(src);
+    auto b = _mm512_loadu_si512(src + 64);
+    auto c = _mm512_loadu_si512(src + 128);
+    auto d = _mm512_loadu_si512(src + 192);
+    _mm512_stream_si512(reinterpret_cast<__m512i*>(dst), a);
+    _mm512_stream_si512(reinterpret_cast<__m512i*>(dst + 64), b);
+    _mm512_stream_si512(reinterpret_cast<__m512i*>(dst + 128), c);
+    _mm512_stream_si512(reinterpret_cast<__m512i*>(dst + 192), d);
+  }
+  _mm_sfence();
+  std::memcpy(dst, src, size);
+}
+
+// the data read from the staging memory was written by the DMA engine, so it's not in the host caches. The user
+// buffer is likely used soon, it's written through the caches
+void copyFromCmaPrefetched(const std::byte* src, std::byte* dst, size_t size) {
+  constexpr auto kBlockSize = 256UL;
+  for (; size >= kBlockSize; size -= kBlockSize, src += kBlockSize, dst += kBlockSize) {
+    if (size >= kBlockSize + kPrefetchDistance) {
+      for (auto line = 0UL; line < kBlockSize; line += kCacheLineSize) {
+        _mm_prefetch(reinterpret_cast<const char*>(src + kPrefetchDistance + line), _MM_HINT_NTA);
+      }
+    }
+    std::memcpy(dst, src, kBlockSize);
+  }
+  std::memcpy(dst, src, size);
+}
+
+CopyFunction selectToCma() {
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f")) {
+    RT_LOG(INFO) << "CMA copies use AVX-512 non-temporal stores";
+    return copyToCmaAvx512;
+  }
+  if (__builtin_cpu_supports("avx2")) {
+    RT_LOG(INFO) << "CMA copies use AVX2 non-temporal stores";
+    return copyToCmaAvx2;
+  }
+  return copyToCmaSse2;
+}
+
+CopyFunction selectFromCma() {
+  return copyFromCmaPrefetched;
+}
+#else
+CopyFunction selectToCma() {
+  return copyPlain;
+}
+
+CopyFunction selectFromCma() {
+  return copyPlain;
+}
+#endif
+} // namespace
+
+void rt::copyCma(const std::byte* src, std::byte* dst, size_t size, CmaCopyType type) {
+  if (size < kStreamingThreshold) {
+    copyPlain(src, dst, size);
+    return;
+  }
+  // resolved once, from the CPU features
+  static const auto toCma = selectToCma();
+  static const auto fromCma = selectFromCma();
+  (type == CmaCopyType::TO_CMA ? toCma : fromCma)(src, dst, size);
+}
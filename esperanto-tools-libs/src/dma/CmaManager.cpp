@@ -7,17 +7,32 @@
 #include "Utils.h"
 #include "dma/IDmaBuffer.h"
 #include "runtime/IRuntime.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
 #include <mutex>
+#include <sys/mman.h>
+#include <unistd.h>
 using namespace rt;
 namespace {
-constexpr auto kCmaBlockSize = 1024U;
-}
+constexpr auto kCmaBlockSize = 1024UL;
+constexpr auto kNumStagingSlabs = 4UL;
+} // namespace
 
-CmaManager::CmaManager(std::unique_ptr<IDmaBuffer> dmaBuffer, size_t maxBytesPerCommand)
+CmaManager::CmaManager(std::unique_ptr<IDmaBuffer> dmaBuffer, size_t maxBytesPerCommand, size_t maxBytesPerElement)
   : dmaBuffer_(std::move(dmaBuffer))
   , memoryManager_(reinterpret_cast<uint64_t>(dmaBuffer_->getPtr()), dmaBuffer_->getSize(), kCmaBlockSize)
   , maxBytesPerCommand_(maxBytesPerCommand) {
-  RT_VLOG(LOW) << "Runtime CMA allocation size: 0x" << std::hex << dmaBuffer_->getSize();
+  // keep at least kNumStagingSlabs in flight so cma copies and dmas can overlap
+  auto slabSize = std::min(maxBytesPerCommand_, dmaBuffer_->getSize() / kNumStagingSlabs);
+  if (maxBytesPerElement > 0 && slabSize >= maxBytesPerElement) {
+    slabSize -= slabSize % maxBytesPerElement;
+  } else {
+    slabSize -= slabSize % kCmaBlockSize;
+  }
+  slabSize_ = std::max(slabSize, kCmaBlockSize);
+  RT_VLOG(LOW) << "Runtime CMA allocation size: 0x" << std::hex << dmaBuffer_->getSize() << " staging slab size: 0x"
+               << slabSize_;
 }
 
 void CmaManager::addMemcpyAction(std::unique_ptr<actionList::IAction> action) {
@@ -28,6 +43,10 @@ size_t CmaManager::getTotalSize() const {
   return dmaBuffer_->getSize();
 }
 
+size_t CmaManager::getSlabSize() const {
+  return slabSize_;
+}
+
 size_t CmaManager::getFreeBytes() const {
   SpinLock lock(mutex_);
   auto freeBytes = memoryManager_.getFreeContiguousBytes();
@@ -38,8 +57,22 @@ size_t CmaManager::getFreeBytes() const {
 void CmaManager::free(std::byte* buffer) {
   SpinLock lock(mutex_);
   memoryManager_.free(buffer);
-  // we have more memory available so greedily wakeup the runner
-  memcpyActionManager_.update();
+  // we have more memory available, wake up the memcpys waiting for it which fit
+  memcpyActionManager_.notify(kCmaResource, memoryManager_.getFreeContiguousBytes());
+}
+
+void CmaManager::prefault(bool lock) {
+  auto ptr = dmaBuffer_->getPtr();
+  auto size = dmaBuffer_->getSize();
+  auto pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  // the staging buffers are always written first (H2D) or by the device (D2H), so a write fault is the one to take
+  auto page = reinterpret_cast<volatile std::byte*>(ptr);
+  for (auto offset = 0UL; offset < size; offset += pageSize) {
+    page[offset] = std::byte{0};
+  }
+  if (lock && mlock(ptr, size) != 0) {
+    RT_LOG(WARNING) << "Couldn't lock the CMA buffer (" << size << " bytes) in memory: " << std::strerror(errno);
+  }
 }
 
 std::byte* CmaManager::alloc(size_t size) {
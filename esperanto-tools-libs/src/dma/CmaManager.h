@@ -14,11 +14,15 @@ namespace rt {
 class IRuntime;
 class CmaManager {
 public:
-  explicit CmaManager(std::unique_ptr<IDmaBuffer> dmaBuffer, size_t maxBytesPerCommand);
+  explicit CmaManager(std::unique_ptr<IDmaBuffer> dmaBuffer, size_t maxBytesPerCommand, size_t maxBytesPerElement);
 
   // returns total size
   size_t getTotalSize() const;
 
+  // returns the size of each staging slab. Big memcpys are split in slabs of this size (a multiple of the dma element
+  // size when possible) so the host copy into slab N+1 overlaps the DMA of slab N
+  size_t getSlabSize() const;
+
   // returns max contiguous bytes (max allocation)
   size_t getFreeBytes() const;
 
@@ -27,9 +31,16 @@ public:
 
   void free(std::byte* buffer);
 
+  // touches every page of the buffer so later copies don't page fault, and optionally mlocks it. Must be called before
+  // the buffer is used, it overwrites its contents
+  void prefault(bool lock);
+
   // add an asynchronous memcpy operation to be executed
   void addMemcpyAction(std::unique_ptr<actionList::IAction> action);
 
+  // resource the memcpy actions wait for when there are not enough free bytes, see actionList::IAction::getWaitFor
+  static constexpr actionList::ResourceId kCmaResource = 1;
+
 private:
   actionList::Runner memcpyActionManager_;
   std::unique_ptr<IDmaBuffer> dmaBuffer_;
@@ -37,5 +48,6 @@ private:
   std::condition_variable cv_;
   mutable std::mutex mutex_;
   const size_t maxBytesPerCommand_;
+  size_t slabSize_;
 };
 } // namespace rt
\ No newline at end of file
@@ -14,12 +14,19 @@
 namespace rt {
 class DmaBufferImp : public IDmaBuffer {
 public:
-  DmaBufferImp(int device, size_t size, bool writeable, dev::IDeviceLayer& deviceLayer)
+  // if preferHugePages is set, the buffer is backed by hugepages when the device-layer can allocate them
+  DmaBufferImp(int device, size_t size, bool writeable, dev::IDeviceLayer& deviceLayer, bool preferHugePages = false)
     : deviceLayer_(deviceLayer)
-    , size_(size)
-    , address_(reinterpret_cast<std::byte*>(deviceLayer_.allocDmaBuffer(device, size, writeable))) {
+    , size_(size) {
+    if (preferHugePages) {
+      address_ = reinterpret_cast<std::byte*>(deviceLayer_.allocHugePageDmaBuffer(device, size, writeable));
+    }
+    auto hugePages = address_ != nullptr;
+    if (!hugePages) {
+      address_ = reinterpret_cast<std::byte*>(deviceLayer_.allocDmaBuffer(device, size, writeable));
+    }
     RT_VLOG(MID) << "Allocated dma buffer: " << std::hex << address_ << " size: " << size_ << " writeble? "
-                 << (writeable ? "True" : "False");
+                 << (writeable ? "True" : "False") << " hugepages? " << (hugePages ? "True" : "False");
   }
   ~DmaBufferImp() {
     if (address_) {
@@ -39,6 +46,6 @@ public:
 private:
   dev::IDeviceLayer& deviceLayer_;
   size_t size_;
-  std::byte* address_;
+  std::byte* address_ = nullptr;
 };
 } // namespace rt
@@ -0,0 +1,138 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) 2025 Ainekko, Co.
+ * SPDX-License-Identifier: Apache-2.0
+ *-------------------------------------------------------------------------*/
+
+#include "MemcpyChainAction.h"
+#include "RuntimeImp.h"
+#include "ScopedProfileEvent.h"
+#include "Utils.h"
+#include "dma/CmaManager.h"
+#include <cstring>
+using namespace actionList;
+using namespace rt;
+using namespace rt::profiling;
+
+namespace {
+// the chain ends with an extra element, overwritten by the device with the link ending it
+size_t getChainSize(size_t elemCount) {
+  return (elemCount + 1) * sizeof(device_ops_ext::dma_chain_elem_t);
+}
+} // namespace
+
+MemcpyChainAction::MemcpyChainAction(MemcpyType type, MemcpyList list,
+                                     std::vector<device_ops_ext::dma_chain_elem_t> elems, std::byte* chainAddr,
+                                     MemcpyContext ctx)
+  : ctx_(ctx)
+  , type_(type)
+  , list_(std::move(list))
+  , elems_(std::move(elems))
+  , chainAddr_(chainAddr) {
+  totalSize_ = 0U;
+  for (auto& o : list_.operations_) {
+    totalSize_ += o.size_;
+  }
+}
+
+size_t MemcpyChainAction::getStagingSize(size_t totalSize, size_t elemCount) {
+  return align(totalSize, kCacheLineSize) + getChainSize(elemCount);
+}
+
+// the whole list and its chain are staged at once
+actionList::WaitFor MemcpyChainAction::getWaitFor() const {
+  return {CmaManager::kCmaResource, getStagingSize(totalSize_, elems_.size())};
+}
+
+bool MemcpyChainAction::update() {
+  auto cmaPtr = ctx_.cmaManager_.alloc(getStagingSize(totalSize_, elems_.size()));
+  if (cmaPtr == nullptr) {
+    RT_VLOG(LOW) << "Can't allocate CMA buffer for MemcpyChainAction. Required size: "
+                 << getStagingSize(totalSize_, elems_.size());
+    return false;
+  }
+
+  // the data is at the start of the buffer, so the host side of the elements are offsets from cmaPtr
+  auto chainPtr = cmaPtr + align(totalSize_, kCacheLineSize);
+  auto chainSize = getChainSize(elems_.size());
+  std::memcpy(chainPtr, elems_.data(), elems_.size() * sizeof(device_ops_ext::dma_chain_elem_t));
+  std::memset(chainPtr + chainSize - sizeof(device_ops_ext::dma_chain_elem_t), 0,
+              sizeof(device_ops_ext::dma_chain_elem_t));
+
+  // the chain upload is a regular DMA list, the chain command waits for it with a barrier
+  std::vector<EventId> cmdEvents;
+  MemcpyList chainList;
+  chainList.addOp(chainPtr, chainAddr_, chainSize);
+  for (auto& builder : buildStagedListCommands(MemcpyType::H2D, chainList, chainPtr, false, ctx_.dmaInfo_)) {
+    auto cmdEvt = getNextId(ctx_);
+    builder.setTagId(cmdEvt);
+    ctx_.commandSender_.sendBefore(
+      ctx_.eventId_, {builder.build(), ctx_.commandSender_, cmdEvt, ctx_.eventId_, ctx_.stream_, true, true});
+    cmdEvents.emplace_back(cmdEvt);
+  }
+
+  // the host buffer bus address is filled in by the driver; the device-layers without one use host addresses
+  auto chainEvt = getNextId(ctx_);
+  std::vector<std::byte> cmdData(sizeof(device_ops_ext::device_ops_dma_chain_cmd_t));
+  auto cmd = reinterpret_cast<device_ops_ext::device_ops_dma_chain_cmd_t*>(cmdData.data());
+  cmd->command_info.cmd_hdr.tag_id = static_cast<uint16_t>(chainEvt);
+  cmd->command_info.cmd_hdr.msg_id = device_ops_ext::DEV_OPS_API_MID_DEVICE_OPS_DMA_CHAIN_CMD;
+  cmd->command_info.cmd_hdr.size = static_cast<uint16_t>(cmdData.size());
+  cmd->command_info.cmd_hdr.flags = device_ops_api::CMD_FLAGS_BARRIER_ENABLE;
+  cmd->chain_device_phy_addr = reinterpret_cast<uint64_t>(chainAddr_);
+  cmd->host_virt_addr = cmd->host_phy_addr = reinterpret_cast<uint64_t>(cmaPtr);
+  cmd->host_size = totalSize_;
+  cmd->elem_count = static_cast<uint32_t>(elems_.size());
+  cmd->direction = type_ == MemcpyType::H2D ? device_ops_ext::DMA_CHAIN_DIRECTION_HOST_TO_DEVICE
+                                            : device_ops_ext::DMA_CHAIN_DIRECTION_DEVICE_TO_HOST;
+  // host to device chains are enabled once the data is staged
+  ctx_.commandSender_.sendBefore(ctx_.eventId_, {std::move(cmdData), ctx_.commandSender_, chainEvt, ctx_.eventId_,
+                                                 ctx_.stream_, false, type_ == MemcpyType::D2H, false, true});
+  cmdEvents.emplace_back(chainEvt);
+  RT_VLOG(MID) << "Chained memcpy " << static_cast<int>(ctx_.eventId_) << " of " << elems_.size()
+               << " elements sent in commands: " << stringizeEvents(cmdEvents);
+
+  std::vector<EventId> syncEvents;
+  std::vector<threadPool::WorkStealingThreadPool::Task> copies;
+  for (const auto& range : groupStagedCopies(list_)) {
+    auto first = begin(list_.operations_) + static_cast<long>(range.first_);
+    std::vector<MemcpyList::Op> ops(first, first + static_cast<long>(range.count_));
+    auto syncId = getNextId(ctx_);
+    syncEvents.emplace_back(syncId);
+    copies.emplace_back([&rt = ctx_.runtime_, ops = std::move(ops), copyFunction = ctx_.cmaCopyFunction_,
+                         cmaPtr = cmaPtr + range.cmaOffset_, syncId, evt = ctx_.eventId_, type = type_] {
+      ScopedProfileEvent pevent(profiling::Class::CmaCopy, *rt.getProfiler(), syncId);
+      pevent.setParentId(evt);
+      auto processed = 0UL;
+      for (const auto& op : ops) {
+        if (type == MemcpyType::H2D) {
+          copyFunction(op.src_, cmaPtr + processed, op.size_, CmaCopyType::TO_CMA);
+        } else {
+          copyFunction(cmaPtr + processed, op.dst_, op.size_, CmaCopyType::FROM_CMA);
+        }
+        processed += op.size_;
+      }
+      rt.dispatch(syncId);
+    });
+  }
+  RT_VLOG(MID) << ">>> Alloc cmaPtr: " << std::hex << cmaPtr << " associated events: " << stringizeEvents(syncEvents);
+  ctx_.commandSender_.cancel(ctx_.eventId_);
+
+  auto release = [&cm = ctx_.cmaManager_, &rt = ctx_.runtime_, cmaPtr, evt = ctx_.eventId_] {
+    RT_VLOG(MID) << ">>> Free cmaPtr: " << std::hex << cmaPtr;
+    cm.free(cmaPtr);
+    rt.dispatch(evt);
+  };
+  if (type_ == MemcpyType::H2D) {
+    ctx_.eventManager_.addOnDispatchCallback(
+      {syncEvents, [&cs = ctx_.commandSender_, chainEvt] { cs.enable(chainEvt); }});
+    ctx_.threadPool_.pushBatch(std::move(copies));
+    ctx_.eventManager_.addOnDispatchCallback({std::move(cmdEvents), std::move(release)});
+  } else {
+    ctx_.eventManager_.addOnDispatchCallback(
+      {std::move(cmdEvents), [&tp = ctx_.threadPool_, copies = std::move(copies)]() mutable {
+         tp.pushBatch(std::move(copies));
+       }});
+    ctx_.eventManager_.addOnDispatchCallback({std::move(syncEvents), std::move(release)});
+  }
+  return true;
+}
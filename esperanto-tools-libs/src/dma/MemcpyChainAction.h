@@ -0,0 +1,35 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) 2025 Ainekko, Co.
+ * SPDX-License-Identifier: Apache-2.0
+ *-------------------------------------------------------------------------*/
+
+#pragma once
+#include "MemcpyContext.h"
+#include "MemcpyOps.h"
+#include "runtime/DeviceOpsExt.h"
+#include "runtime/Types.h"
+#include <hostUtils/actionList/ActionList.h>
+
+namespace rt {
+
+// stages a memcpy list in cma, followed by the DMA chain running it; the chain is uploaded to chainAddr with a regular
+// DMA command and run by the DMA chain command, which replace the ghost command
+class MemcpyChainAction : public actionList::IAction {
+public:
+  MemcpyChainAction(MemcpyType type, MemcpyList list, std::vector<device_ops_ext::dma_chain_elem_t> elems,
+                    std::byte* chainAddr, MemcpyContext ctx);
+  bool update() override;
+  actionList::WaitFor getWaitFor() const override;
+
+  // cma bytes taken by the list and its chain
+  static size_t getStagingSize(size_t totalSize, size_t elemCount);
+
+private:
+  MemcpyContext ctx_;
+  MemcpyType type_;
+  MemcpyList list_;
+  std::vector<device_ops_ext::dma_chain_elem_t> elems_;
+  std::byte* chainAddr_;
+  size_t totalSize_;
+};
+} // namespace rt
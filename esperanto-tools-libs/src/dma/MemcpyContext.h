@@ -9,7 +9,8 @@
 #include "runtime/IProfileEvent.h"
 #include "runtime/Types.h"
 #include <device-layer/IDeviceLayer.h>
-#include <hostUtils/threadPool/ThreadPool.h>
+#include <atomic>
+#include <hostUtils/threadPool/WorkStealingThreadPool.h>
 
 namespace rt {
 struct MemcpyContext {
@@ -20,10 +21,20 @@ struct MemcpyContext {
   class StreamManager& streamManager_;
   class EventManager& eventManager_;
   class CommandSender& commandSender_;
-  threadPool::ThreadPool& threadPool_;
+  threadPool::WorkStealingThreadPool& threadPool_;
   StreamId stream_;
   EventId eventId_;
 };
+// tracks how many bytes of a staged memcpy went through the cma copy and the dma stages. It is shared with the
+// callbacks so it outlives the action which created it
+struct MemcpyProgress {
+  explicit MemcpyProgress(size_t totalBytes)
+    : totalBytes_(totalBytes) {
+  }
+  const size_t totalBytes_;
+  std::atomic<size_t> copiedBytes_ = 0;
+  std::atomic<size_t> transferredBytes_ = 0;
+};
 inline EventId getNextId(MemcpyContext& ctx) {
   auto evt = ctx.eventManager_.getNextId();
   ctx.streamManager_.addEvent(ctx.stream_, evt);
@@ -19,22 +19,37 @@ MemcpyD2HAction::MemcpyD2HAction(const std::byte* d_src, std::byte* h_dst, size_
   , d_src_(d_src)
   , h_dst_(h_dst)
   , size_(size)
-  , barrier_(barrier) {
+  , barrier_(barrier)
+  , progress_(std::make_shared<MemcpyProgress>(size)) {
+}
+
+// wait for a whole slab, or what is left, instead of sending small commands with every freed block
+actionList::WaitFor MemcpyD2HAction::getWaitFor() const {
+  return {CmaManager::kCmaResource, std::min(ctx_.cmaManager_.getSlabSize(), size_ - pos_)};
 }
 
 bool MemcpyD2HAction::update() {
   assert(pos_ < size_);
 
-  // alloc buffer for next copy
-  auto availableBytes = ctx_.cmaManager_.getFreeBytes();
-  if (availableBytes == 0) {
-    return false;
+  // issue one command per cma slab while there is cma available, so the copy out of a finished slab overlaps the dma
+  // of the following ones
+  auto slabSize = ctx_.cmaManager_.getSlabSize();
+  while (pos_ < size_) {
+    auto availableBytes = ctx_.cmaManager_.getFreeBytes();
+    if (availableBytes == 0) {
+      return false;
+    }
+    auto currentSize = std::min(std::min(availableBytes, size_ - pos_), slabSize);
+    auto cmaPtr = ctx_.cmaManager_.alloc(currentSize);
+    if (cmaPtr == nullptr) {
+      return false;
+    }
+    sendSlab(cmaPtr, currentSize);
   }
+  return true;
+}
 
-  auto currentSize =
-    std::min(std::min(availableBytes, size_ - pos_), ctx_.dmaInfo_.maxElementSize_ * ctx_.dmaInfo_.maxElementCount_);
-  auto cmaPtr = ctx_.cmaManager_.alloc(currentSize);
-
+void MemcpyD2HAction::sendSlab(std::byte* cmaPtr, size_t currentSize) {
   auto cmdEvt = getNextId(ctx_);
   MemcpyCommandBuilder builder(MemcpyType::D2H, barrier_, static_cast<uint32_t>(ctx_.dmaInfo_.maxElementCount_));
   builder.setTagId(cmdEvt);
@@ -52,11 +67,12 @@ bool MemcpyD2HAction::update() {
     ctx_.eventManager_.addOnDispatchCallback(
       {{cmdEvt},
        [& tp = ctx_.threadPool_, copyFunc = ctx_.cmaCopyFunction_, processed, cmaPtr, chunkSize, syncId, dst = h_dst_,
-        pos = pos_, &rt = ctx_.runtime_, evt = ctx_.eventId_] {
-         tp.pushTask([copyFunc, &rt, processed, cmaPtr, chunkSize, syncId, pos, dst, evt] {
+        pos = pos_, &rt = ctx_.runtime_, evt = ctx_.eventId_, progress = progress_] {
+         tp.pushTask([copyFunc, &rt, processed, cmaPtr, chunkSize, syncId, pos, dst, evt, progress] {
            ScopedProfileEvent pevent(profiling::Class::CmaCopy, *rt.getProfiler(), syncId);
            pevent.setParentId(evt);
            copyFunc(cmaPtr + processed, dst + pos + processed, chunkSize, CmaCopyType::FROM_CMA);
+           progress->copiedBytes_ += chunkSize;
            rt.dispatch(syncId);
          });
        }});
@@ -67,11 +83,16 @@ bool MemcpyD2HAction::update() {
 
   RT_VLOG(MID) << ">>> Alloc cmaPtr: " << std::hex << cmaPtr << " associated events: " << stringizeEvents(syncEvents);
 
-  /***/
   // set the proper data once the builder has been filled
   ctx_.commandSender_.sendBefore(
     ctx_.eventId_, {builder.build(), ctx_.commandSender_, cmdEvt, ctx_.eventId_, ctx_.stream_, true, true});
 
+  ctx_.eventManager_.addOnDispatchCallback({{cmdEvt}, [currentSize, progress = progress_, evt = ctx_.eventId_] {
+                                              auto transferred = progress->transferredBytes_ += currentSize;
+                                              RT_VLOG(MID) << "Memcpy " << int(evt) << " progress: " << transferred
+                                                           << "/" << progress->totalBytes_ << " bytes";
+                                            }});
+
   // release the buffer once the command has been completed
   ctx_.eventManager_.addOnDispatchCallback({syncEvents, [& cm = ctx_.cmaManager_, cmaPtr] {
                                               RT_VLOG(MID) << ">>> Free cmaPtr: " << std::hex << cmaPtr;
@@ -80,7 +101,6 @@ bool MemcpyD2HAction::update() {
   for (auto e : syncEvents) {
     cmdEvents_.emplace_back(e);
   }
-  return pos_ == size_;
 }
 
 void MemcpyD2HAction::onFinish() {
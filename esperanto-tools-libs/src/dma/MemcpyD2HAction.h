@@ -7,6 +7,7 @@
 #include "MemcpyContext.h"
 #include "runtime/Types.h"
 #include <hostUtils/actionList/ActionList.h>
+#include <memory>
 
 namespace rt {
 
@@ -14,9 +15,12 @@ class MemcpyD2HAction : public actionList::IAction {
 public:
   MemcpyD2HAction(const std::byte* d_src, std::byte* h_dst, size_t size, bool barrier, MemcpyContext ctx);
   bool update() override;
+  actionList::WaitFor getWaitFor() const override;
   void onFinish() override;
 
 private:
+  void sendSlab(std::byte* cmaPtr, size_t currentSize);
+
   MemcpyContext ctx_;
   std::vector<EventId> cmdEvents_;
   const std::byte* d_src_;
@@ -24,5 +28,6 @@ private:
   size_t size_;
   size_t pos_ = 0;
   bool barrier_;
+  std::shared_ptr<MemcpyProgress> progress_;
 };
 } // namespace rt
\ No newline at end of file
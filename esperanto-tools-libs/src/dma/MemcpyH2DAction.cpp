@@ -20,23 +20,38 @@ MemcpyH2DAction::MemcpyH2DAction(const std::byte* h_src, std::byte* d_dst, size_
   , h_src_(h_src)
   , d_dst_(d_dst)
   , size_(size)
-  , barrier_(barrier) {
+  , barrier_(barrier)
+  , progress_(std::make_shared<MemcpyProgress>(size)) {
+}
+
+// wait for a whole slab, or what is left, instead of sending small commands with every freed block
+actionList::WaitFor MemcpyH2DAction::getWaitFor() const {
+  return {CmaManager::kCmaResource, std::min(ctx_.cmaManager_.getSlabSize(), size_ - pos_)};
 }
 
 bool MemcpyH2DAction::update() {
   RT_VLOG(MID) << "MemcpyH2DAction::update for command with eventId: " << static_cast<int>(ctx_.eventId_);
   assert(pos_ < size_);
 
-  // alloc buffer for next copy
-  auto availableBytes = ctx_.cmaManager_.getFreeBytes();
-  if (availableBytes == 0) {
-    return false;
+  // issue one command per cma slab while there is cma available. Each command is enabled as soon as its own cma copies
+  // are done, so the copy of the next slab overlaps the dma of the previous one
+  auto slabSize = ctx_.cmaManager_.getSlabSize();
+  while (pos_ < size_) {
+    auto availableBytes = ctx_.cmaManager_.getFreeBytes();
+    if (availableBytes == 0) {
+      return false;
+    }
+    auto currentSize = std::min(std::min(availableBytes, size_ - pos_), slabSize);
+    auto cmaPtr = ctx_.cmaManager_.alloc(currentSize);
+    if (cmaPtr == nullptr) {
+      return false;
+    }
+    sendSlab(cmaPtr, currentSize);
   }
+  return true;
+}
 
-  auto currentSize =
-    std::min(std::min(availableBytes, size_ - pos_), ctx_.dmaInfo_.maxElementSize_ * ctx_.dmaInfo_.maxElementCount_);
-  auto cmaPtr = ctx_.cmaManager_.alloc(currentSize);
-
+void MemcpyH2DAction::sendSlab(std::byte* cmaPtr, size_t currentSize) {
   // add a copy task to the threadpool
   auto cmdEvt = getNextId(ctx_);
   MemcpyCommandBuilder builder(MemcpyType::H2D, barrier_, static_cast<uint32_t>(ctx_.dmaInfo_.maxElementCount_));
@@ -44,6 +59,7 @@ bool MemcpyH2DAction::update() {
   auto processed = 0UL;
 
   std::vector<EventId> syncEvents;
+  std::vector<threadPool::WorkStealingThreadPool::Task> copies;
   while (processed < currentSize) {
     auto chunkSize = std::min(ctx_.dmaInfo_.maxElementSize_, currentSize - processed);
     builder.addOp(cmaPtr + processed, d_dst_ + pos_ + processed, chunkSize);
@@ -51,17 +67,19 @@ bool MemcpyH2DAction::update() {
     auto syncId = getNextId(ctx_);
     syncEvents.emplace_back(syncId);
 
-    ctx_.threadPool_.pushTask([& rt = ctx_.runtime_, copyFunction = ctx_.cmaCopyFunction_, processed, cmaPtr, chunkSize,
-                               syncId, src = h_src_, pos = pos_, evt = ctx_.eventId_] {
+    copies.emplace_back([& rt = ctx_.runtime_, copyFunction = ctx_.cmaCopyFunction_, processed, cmaPtr, chunkSize,
+                         syncId, src = h_src_, pos = pos_, evt = ctx_.eventId_, progress = progress_] {
       ScopedProfileEvent pevent(profiling::Class::CmaCopy, *rt.getProfiler(), syncId);
       pevent.setParentId(evt);
       copyFunction(src + pos + processed, cmaPtr + processed, chunkSize, CmaCopyType::TO_CMA);
+      progress->copiedBytes_ += chunkSize;
       rt.dispatch(syncId);
     });
 
     processed += chunkSize;
   }
   pos_ += currentSize;
+  ctx_.threadPool_.pushBatch(std::move(copies));
 
   RT_VLOG(MID) << ">>> Alloc cmaPtr: " << std::hex << cmaPtr << " associated event: " << int(cmdEvt);
 
@@ -75,12 +93,13 @@ bool MemcpyH2DAction::update() {
   cmdEvents_.emplace_back(cmdEvt);
 
   // release the buffer once the command has been completed
-  ctx_.eventManager_.addOnDispatchCallback({{cmdEvt}, [& cm = ctx_.cmaManager_, cmaPtr] {
-                                              RT_VLOG(MID) << ">>> Free cmaPtr: " << std::hex << cmaPtr;
-                                              cm.free(cmaPtr);
-                                            }});
-
-  return pos_ == size_;
+  ctx_.eventManager_.addOnDispatchCallback(
+    {{cmdEvt}, [& cm = ctx_.cmaManager_, cmaPtr, currentSize, progress = progress_, evt = ctx_.eventId_] {
+       auto transferred = progress->transferredBytes_ += currentSize;
+       RT_VLOG(MID) << ">>> Free cmaPtr: " << std::hex << cmaPtr << std::dec << " memcpy " << int(evt)
+                    << " progress: " << transferred << "/" << progress->totalBytes_ << " bytes";
+       cm.free(cmaPtr);
+     }});
 }
 
 void MemcpyH2DAction::onFinish() {
@@ -6,6 +6,7 @@
 #pragma once
 #include "MemcpyContext.h"
 #include <hostUtils/actionList/ActionList.h>
+#include <memory>
 
 namespace rt {
 
@@ -13,9 +14,12 @@ class MemcpyH2DAction : public actionList::IAction {
 public:
   MemcpyH2DAction(const std::byte* h_src, std::byte* d_dst, size_t size, bool barrier, MemcpyContext ctx);
   bool update() override;
+  actionList::WaitFor getWaitFor() const override;
   void onFinish() override;
 
 private:
+  void sendSlab(std::byte* cmaPtr, size_t currentSize);
+
   MemcpyContext ctx_;
   std::vector<EventId> cmdEvents_;
   const std::byte* h_src_;
@@ -23,5 +27,6 @@ private:
   size_t size_;
   size_t pos_ = 0;
   bool barrier_;
+  std::shared_ptr<MemcpyProgress> progress_;
 };
 } // namespace rt
\ No newline at end of file
@@ -14,16 +14,23 @@ using namespace actionList;
 using namespace rt;
 using namespace rt::profiling;
 
-MemcpyListD2HAction::MemcpyListD2HAction(MemcpyList list, bool barrier, MemcpyContext ctx)
+MemcpyListD2HAction::MemcpyListD2HAction(MemcpyList list, bool barrier, MemcpyContext ctx,
+                                         std::vector<CmaCopyFunction> copyFunctions)
   : ctx_(ctx)
   , list_(list)
-  , barrier_(barrier) {
+  , barrier_(barrier)
+  , copyFunctions_(std::move(copyFunctions)) {
   totalSize_ = 0U;
   for (auto& o : list_.operations_) {
     totalSize_ += o.size_;
   }
 }
 
+// the whole list is staged at once
+actionList::WaitFor MemcpyListD2HAction::getWaitFor() const {
+  return {CmaManager::kCmaResource, totalSize_};
+}
+
 bool MemcpyListD2HAction::update() {
 
   // alloc buffer for next copy
@@ -33,43 +40,55 @@ bool MemcpyListD2HAction::update() {
     return false;
   }
 
-  auto cmdEvt = getNextId(ctx_);
-  MemcpyCommandBuilder builder(MemcpyType::D2H, barrier_, static_cast<uint32_t>(ctx_.dmaInfo_.maxElementCount_));
-  builder.setTagId(cmdEvt);
-  auto processed = 0UL;
+  // the commands are sent before the ghost command, which is removed
+  std::vector<EventId> cmdEvents;
+  for (auto& builder : buildStagedListCommands(MemcpyType::D2H, list_, cmaPtr, barrier_, ctx_.dmaInfo_)) {
+    auto cmdEvt = getNextId(ctx_);
+    builder.setTagId(cmdEvt);
+    ctx_.commandSender_.sendBefore(
+      ctx_.eventId_, {builder.build(), ctx_.commandSender_, cmdEvt, ctx_.eventId_, ctx_.stream_, true, true});
+    cmdEvents.emplace_back(cmdEvt);
+  }
 
   std::vector<EventId> syncEvents;
-  for (auto& op : list_.operations_) {
-    auto chunkSize = op.size_;
-    builder.addOp(cmaPtr + processed, op.src_, chunkSize);
+  std::vector<threadPool::WorkStealingThreadPool::Task> copies;
+  for (const auto& range : groupStagedCopies(list_)) {
+    auto first = begin(list_.operations_) + static_cast<long>(range.first_);
+    std::vector<MemcpyList::Op> ops(first, first + static_cast<long>(range.count_));
+    std::vector<CmaCopyFunction> copyFunctions{ctx_.cmaCopyFunction_};
+    if (!copyFunctions_.empty()) {
+      auto firstFunction = begin(copyFunctions_) + static_cast<long>(range.first_);
+      copyFunctions.assign(firstFunction, firstFunction + static_cast<long>(range.count_));
+    }
 
     auto syncId = getNextId(ctx_);
     syncEvents.emplace_back(syncId);
 
-    // add a callback which will queue a task to the threadpool to do the final copy from cma to host virtual memory
-    ctx_.eventManager_.addOnDispatchCallback(
-      {{cmdEvt},
-       [& rt = ctx_.runtime_, &tp = ctx_.threadPool_, copyFunction = ctx_.cmaCopyFunction_, dst = op.dst_, processed,
-        cmaPtr, chunkSize, syncId, evt = ctx_.eventId_] {
-         tp.pushTask([dst, copyFunction, &rt, processed, cmaPtr, chunkSize, syncId, evt] {
-           // add the tracking information (cmacopy)
-           ScopedProfileEvent pevent(profiling::Class::CmaCopy, *rt.getProfiler(), syncId);
-           pevent.setParentId(evt);
-           copyFunction(cmaPtr + processed, dst, chunkSize, CmaCopyType::FROM_CMA);
-           rt.dispatch(syncId);
-         });
-       }});
-
-    processed += chunkSize;
+    // the final copy from cma to host virtual memory
+    copies.emplace_back([&rt = ctx_.runtime_, ops = std::move(ops), copyFunctions = std::move(copyFunctions),
+                         cmaPtr = cmaPtr + range.cmaOffset_, syncId, evt = ctx_.eventId_] {
+      // add the tracking information (cmacopy)
+      ScopedProfileEvent pevent(profiling::Class::CmaCopy, *rt.getProfiler(), syncId);
+      pevent.setParentId(evt);
+      auto processed = 0UL;
+      for (auto i = 0UL; i < ops.size(); ++i) {
+        copyFunctions[copyFunctions.size() == 1 ? 0 : i](cmaPtr + processed, ops[i].dst_, ops[i].size_,
+                                                         CmaCopyType::FROM_CMA);
+        processed += ops[i].size_;
+      }
+      rt.dispatch(syncId);
+    });
   }
 
   RT_VLOG(MID) << ">>> Alloc cmaPtr: " << std::hex << cmaPtr << " associated events: " << stringizeEvents(syncEvents);
 
-  // set the proper data once the builder has been filled
-  ctx_.commandSender_.sendBefore(
-    ctx_.eventId_, {builder.build(), ctx_.commandSender_, cmdEvt, ctx_.eventId_, ctx_.stream_, true, true});
+  // queue the copies once all the commands have been completed
+  ctx_.eventManager_.addOnDispatchCallback(
+    {std::move(cmdEvents), [&tp = ctx_.threadPool_, copies = std::move(copies)]() mutable {
+       tp.pushBatch(std::move(copies));
+     }});
 
-  // release the buffer once the command has been completed
+  // release the buffer once the copies have been done
   ctx_.eventManager_.addOnDispatchCallback(
     {syncEvents, [& cm = ctx_.cmaManager_, &rt = ctx_.runtime_, cmaPtr, evt = ctx_.eventId_] {
        RT_VLOG(MID) << ">>> Free cmaPtr: " << std::hex << cmaPtr;
@@ -11,13 +11,17 @@ namespace rt {
 
 class MemcpyListD2HAction : public actionList::IAction {
 public:
-  MemcpyListD2HAction(MemcpyList list, bool barrier, MemcpyContext ctx);
+  // copyFunctions, if not empty, holds the cma copy function of each op; otherwise ctx cmaCopyFunction_ is used
+  MemcpyListD2HAction(MemcpyList list, bool barrier, MemcpyContext ctx,
+                      std::vector<CmaCopyFunction> copyFunctions = {});
   bool update() override;
+  actionList::WaitFor getWaitFor() const override;
 
 private:
   MemcpyContext ctx_;
   MemcpyList list_;
   size_t totalSize_;
   bool barrier_;
+  std::vector<CmaCopyFunction> copyFunctions_;
 };
 } // namespace rt
\ No newline at end of file
@@ -13,16 +13,23 @@ using namespace actionList;
 using namespace rt;
 using namespace rt::profiling;
 
-MemcpyListH2DAction::MemcpyListH2DAction(MemcpyList list, bool barrier, MemcpyContext ctx)
+MemcpyListH2DAction::MemcpyListH2DAction(MemcpyList list, bool barrier, MemcpyContext ctx,
+                                         std::vector<CmaCopyFunction> copyFunctions)
   : ctx_(ctx)
   , list_(list)
-  , barrier_(barrier) {
+  , barrier_(barrier)
+  , copyFunctions_(std::move(copyFunctions)) {
   totalSize_ = 0U;
   for (auto& o : list_.operations_) {
     totalSize_ += o.size_;
   }
 }
 
+// the whole list is staged at once
+actionList::WaitFor MemcpyListH2DAction::getWaitFor() const {
+  return {CmaManager::kCmaResource, totalSize_};
+}
+
 bool MemcpyListH2DAction::update() {
 
   // alloc buffer for next copy
@@ -32,41 +39,80 @@ bool MemcpyListH2DAction::update() {
     return false;
   }
 
-  MemcpyCommandBuilder builder(MemcpyType::H2D, barrier_, static_cast<uint32_t>(ctx_.dmaInfo_.maxElementCount_));
-  builder.setTagId(ctx_.eventId_);
+  auto builders = buildStagedListCommands(MemcpyType::H2D, list_, cmaPtr, barrier_, ctx_.dmaInfo_);
 
   std::vector<EventId> syncEvents;
-  auto processed = 0UL;
-  for (auto& op : list_.operations_) {
-    auto chunkSize = op.size_;
-    builder.addOp(cmaPtr + processed, op.dst_, chunkSize);
+  std::vector<threadPool::WorkStealingThreadPool::Task> copies;
+  for (const auto& range : groupStagedCopies(list_)) {
+    auto first = begin(list_.operations_) + static_cast<long>(range.first_);
+    std::vector<MemcpyList::Op> ops(first, first + static_cast<long>(range.count_));
+    std::vector<CmaCopyFunction> copyFunctions{ctx_.cmaCopyFunction_};
+    if (!copyFunctions_.empty()) {
+      auto firstFunction = begin(copyFunctions_) + static_cast<long>(range.first_);
+      copyFunctions.assign(firstFunction, firstFunction + static_cast<long>(range.count_));
+    }
 
     auto syncId = getNextId(ctx_);
     syncEvents.emplace_back(syncId);
 
-    ctx_.threadPool_.pushTask([copyFunction = ctx_.cmaCopyFunction_, &rt = ctx_.runtime_, processed, cmaPtr, chunkSize,
-                               syncId, src = op.src_, evt = ctx_.eventId_] {
+    copies.emplace_back([&rt = ctx_.runtime_, ops = std::move(ops), copyFunctions = std::move(copyFunctions),
+                         cmaPtr = cmaPtr + range.cmaOffset_, syncId, evt = ctx_.eventId_] {
       // add the tracking information (cmacopy)
       ScopedProfileEvent pevent(profiling::Class::CmaCopy, *rt.getProfiler(), syncId);
       pevent.setParentId(evt);
-      copyFunction(src, cmaPtr + processed, chunkSize, CmaCopyType::TO_CMA);
+      auto processed = 0UL;
+      for (auto i = 0UL; i < ops.size(); ++i) {
+        copyFunctions[copyFunctions.size() == 1 ? 0 : i](ops[i].src_, cmaPtr + processed, ops[i].size_,
+                                                         CmaCopyType::TO_CMA);
+        processed += ops[i].size_;
+      }
       rt.dispatch(syncId);
     });
-    processed += chunkSize;
   }
+  ctx_.threadPool_.pushBatch(std::move(copies));
   RT_VLOG(MID) << ">>> Alloc cmaPtr: " << std::hex << cmaPtr << " associated events: " << stringizeEvents(syncEvents);
 
-  // set the correct command data, once built
-  ctx_.commandSender_.setCommandData(ctx_.eventId_, builder.build());
+  if (builders.size() == 1) {
+    // set the correct command data, once built
+    builders.front().setTagId(ctx_.eventId_);
+    ctx_.commandSender_.setCommandData(ctx_.eventId_, builders.front().build());
 
-  // once all cmacopies has been done, enable the command
-  ctx_.eventManager_.addOnDispatchCallback(
-    {std::move(syncEvents), [& cs = ctx_.commandSender_, evt = ctx_.eventId_] { cs.enable(evt); }});
+    // once all cmacopies has been done, enable the command
+    ctx_.eventManager_.addOnDispatchCallback(
+      {std::move(syncEvents), [& cs = ctx_.commandSender_, evt = ctx_.eventId_] { cs.enable(evt); }});
+
+    ctx_.eventManager_.addOnDispatchCallback({{ctx_.eventId_}, [& cm = ctx_.cmaManager_, cmaPtr] {
+                                                RT_VLOG(MID) << ">>> Free cmaPtr: " << std::hex << cmaPtr;
+                                                cm.free(cmaPtr);
+                                              }});
+    return true;
+  }
 
-  ctx_.eventManager_.addOnDispatchCallback({{ctx_.eventId_}, [& cm = ctx_.cmaManager_, cmaPtr] {
-                                              RT_VLOG(MID) << ">>> Free cmaPtr: " << std::hex << cmaPtr;
-                                              cm.free(cmaPtr);
+  // the list takes several commands, they replace the ghost command
+  std::vector<EventId> cmdEvents;
+  for (auto& builder : builders) {
+    auto cmdEvt = getNextId(ctx_);
+    builder.setTagId(cmdEvt);
+    ctx_.commandSender_.sendBefore(
+      ctx_.eventId_, {builder.build(), ctx_.commandSender_, cmdEvt, ctx_.eventId_, ctx_.stream_, true, false});
+    cmdEvents.emplace_back(cmdEvt);
+  }
+  RT_VLOG(MID) << "List memcpy " << static_cast<int>(ctx_.eventId_) << " sent in " << cmdEvents.size()
+               << " commands: " << stringizeEvents(cmdEvents);
+  ctx_.commandSender_.cancel(ctx_.eventId_);
+
+  // once all cmacopies has been done, enable the commands
+  ctx_.eventManager_.addOnDispatchCallback({std::move(syncEvents), [& cs = ctx_.commandSender_, cmdEvents] {
+                                              for (auto cmdEvt : cmdEvents) {
+                                                cs.enable(cmdEvt);
+                                              }
                                             }});
 
+  ctx_.eventManager_.addOnDispatchCallback(
+    {std::move(cmdEvents), [& cm = ctx_.cmaManager_, &rt = ctx_.runtime_, cmaPtr, evt = ctx_.eventId_] {
+       RT_VLOG(MID) << ">>> Free cmaPtr: " << std::hex << cmaPtr;
+       cm.free(cmaPtr);
+       rt.dispatch(evt);
+     }});
   return true;
-}
\ No newline at end of file
+}
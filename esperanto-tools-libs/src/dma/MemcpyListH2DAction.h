@@ -12,13 +12,17 @@ namespace rt {
 
 class MemcpyListH2DAction : public actionList::IAction {
 public:
-  MemcpyListH2DAction(MemcpyList list, bool barrier, MemcpyContext ctx);
+  // copyFunctions, if not empty, holds the cma copy function of each op; otherwise ctx cmaCopyFunction_ is used
+  MemcpyListH2DAction(MemcpyList list, bool barrier, MemcpyContext ctx,
+                      std::vector<CmaCopyFunction> copyFunctions = {});
   bool update() override;
+  actionList::WaitFor getWaitFor() const override;
 
 private:
   MemcpyContext ctx_;
   MemcpyList list_;
   size_t totalSize_;
   bool barrier_;
+  std::vector<CmaCopyFunction> copyFunctions_;
 };
 } // namespace rt
\ No newline at end of file
@@ -14,6 +14,8 @@
 #include "runtime/Types.h"
 
 #include <chrono>
+#include <cstring>
+#include <limits>
 #include <sstream>
 #include <thread>
 
@@ -22,8 +24,11 @@
 #include <easy/details/profiler_colors.h>
 #include <easy/profiler.h>
 
+#include <fcntl.h>
 #include <poll.h>
+#include <sys/mman.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <sys/un.h>
 #include <unistd.h>
 
@@ -40,6 +45,10 @@ constexpr auto kConnectTimeout = 1000ms;
 
 constexpr auto kConnectRetries = 10;
 
+// how long a push to a full request ring waits before checking the client is still running
+constexpr auto kShmPushTimeout = 1000ms;
+constexpr auto kShmPopTimeout = 5ms;
+
 struct MemStream : public std::streambuf {
   MemStream(char* s, std::size_t n) {
     setg(s, s, s + n);
@@ -53,6 +62,23 @@ void Client::doSetOnStreamErrorsCallback(std::function<void(EventId, StreamError
   streamErrorCallback_ = std::move(callback);
 }
 
+void Client::doOnEventComplete(EventId event, EventCompletionCallback callback) {
+  SpinLock lock(mutex_);
+  auto task = [executor = callbackExecutor_, event, callback = std::move(callback)]() mutable {
+    runEventCompletionCallback(executor, event, std::move(callback));
+  };
+  if (eventToStream_.find(event) == end(eventToStream_)) {
+    tp_.pushTask(std::move(task));
+  } else {
+    eventCallbacks_[event].emplace_back(std::move(task));
+  }
+}
+
+void Client::doSetCallbackExecutor(CallbackExecutor executor) {
+  SpinLock lock(mutex_);
+  callbackExecutor_ = std::move(executor);
+}
+
 Client::~Client() {
   RT_LOG(INFO) << "Destroying client.";
   running_ = false;
@@ -152,6 +178,7 @@ void Client::responseProcessor() {
   profiling::IProfilerRecorder::setCurrentThreadName("Client response processor");
 
   auto requestBuffer = std::vector<char>(kMaxMessageSize);
+  auto ringBuffer = std::vector<std::byte>{};
   try {
     while (running_) {
       EASY_BLOCK("Client::responseProcessor::loop")
@@ -159,10 +186,18 @@ void Client::responseProcessor() {
       pollfd pfd;
       pfd.events = POLLIN;
       pfd.fd = socket_;
-      if (poll(&pfd, 1, 5) == 0) {
-        // Some responses can arrive before their event has been registered. Here we make sure of forward progress event
-        // if no more responses arrive
-        processDelayedResponses();
+      // with the shared memory transport the socket is only polled to know if the server went away
+      auto shmActive = shmActive_.load();
+      if (poll(&pfd, 1, shmActive ? 0 : 5) == 0) {
+        if (uint32_t kind; shmActive && responseRing_->pop(kind, ringBuffer, kShmPopTimeout)) {
+          do {
+            handleResponse(decodeResponse(static_cast<shm::Kind>(kind), ringBuffer));
+          } while (running_ && responseRing_->pop(kind, ringBuffer, 0ms));
+        } else {
+          // Some responses can arrive before their event has been registered. Here we make sure of forward progress
+          // event if no more responses arrive
+          processDelayedResponses();
+        }
         continue;
       }
 
@@ -181,26 +216,7 @@ void Client::responseProcessor() {
           archive >> response;
           RT_VLOG(HIGH) << "Got response, size: " << res << ". Type: " << static_cast<uint32_t>(response.type_)
                         << " id: " << response.id_;
-          bool done = false;
-          try {
-            processResponse(response);
-            done = true;
-          } catch (const Exception& e) {
-            EASY_EVENT("Response arrived before request ack, delaying its processing.")
-            RT_LOG(WARNING) << "Response for event " << response.id_
-                            << " arrived before request ack, delaying its processing: " << e.what();
-            std::ostringstream oss;
-            {
-              cereal::JSONOutputArchive jsonArchive(oss);
-              jsonArchive << response;
-            }
-            RT_LOG(WARNING) << "Response contents: " << oss.str();
-            delayedResponses_.emplace_back(std::move(response));
-          }
-
-          if (done) {
-            processDelayedResponses();
-          }
+          handleResponse(std::move(response));
         } else {
           RT_LOG(INFO) << "Socket closed, ending client listener thread.";
           running_ = false;
@@ -214,6 +230,49 @@ void Client::responseProcessor() {
   RT_LOG(INFO) << "End listener thread.";
 }
 
+void Client::handleResponse(resp::Response response) {
+  try {
+    processResponse(response);
+  } catch (const Exception& e) {
+    EASY_EVENT("Response arrived before request ack, delaying its processing.")
+    RT_LOG(WARNING) << "Response for event " << response.id_
+                    << " arrived before request ack, delaying its processing: " << e.what();
+    std::ostringstream oss;
+    {
+      cereal::JSONOutputArchive jsonArchive(oss);
+      jsonArchive << response;
+    }
+    RT_LOG(WARNING) << "Response contents: " << oss.str();
+    delayedResponses_.emplace_back(std::move(response));
+    return;
+  }
+  processDelayedResponses();
+}
+
+resp::Response Client::decodeResponse(shm::Kind kind, const std::vector<std::byte>& data) const {
+  EASY_FUNCTION()
+  switch (kind) {
+  case shm::Kind::EVENT: {
+    shm::EventRecord record;
+    if (data.size() != sizeof(record)) {
+      throw Exception("Invalid shared memory event response size: " + std::to_string(data.size()));
+    }
+    memcpy(&record, data.data(), sizeof(record));
+    return {record.type_, record.id_, resp::Event{record.event_}};
+  }
+  case shm::Kind::SERIALIZED: {
+    auto ms = MemStream{const_cast<char*>(reinterpret_cast<const char*>(data.data())), data.size()};
+    std::istream is(&ms);
+    cereal::PortableBinaryInputArchive archive{is};
+    resp::Response response;
+    archive >> response;
+    return response;
+  }
+  default:
+    throw Exception("Unexpected shared memory response kind: " + std::to_string(static_cast<uint32_t>(kind)));
+  }
+}
+
 void Client::processDelayedResponses() {
   bool effective = true;
   while (effective) {
@@ -237,16 +296,37 @@ void Client::processDelayedResponses() {
 
 bool Client::doWaitForEvent(EventId event, std::chrono::seconds timeout) {
   EASY_FUNCTION(profiler::colors::Red300)
+  // the event request could be still queued
+  sendQueuedRequests();
   SpinLock lock(mutex_);
-  if (eventToStream_.find(event) == end(eventToStream_)) {
-    return true;
+  auto completed = eventSync_.wait_for(lock, timeout,
+                                       [this, event] { return eventToStream_.find(event) == end(eventToStream_); });
+  rethrowBatchError();
+  return completed;
+}
+
+std::optional<EventTiming> Client::doGetEventTiming(EventId event) {
+  std::unique_lock lock(mutex_);
+  auto it = dispatchedToServerEvent_.find(event);
+  if (it == end(dispatchedToServerEvent_)) {
+    return {};
   }
-  return eventSync_.wait_for(lock, timeout,
-                             [this, event] { return eventToStream_.find(event) == end(eventToStream_); });
+  auto serverEvt = it->second;
+  lock.unlock();
+  auto payload = sendRequestAndWait(req::Type::GET_EVENT_TIMING, serverEvt);
+  // the responses are processed in order, so if the server reused its event before answering, the dispatch of the
+  // newer command has already remapped it
+  lock.lock();
+  if (auto current = serverToDispatchedEvent_.find(serverEvt);
+      current == end(serverToDispatchedEvent_) || current->second != event) {
+    return {};
+  }
+  return std::get<resp::EventTiming>(payload).timing_;
 }
 
 bool Client::doWaitForStream(StreamId stream, std::chrono::seconds timeout) {
   auto start = std::chrono::steady_clock::now();
+  flush();
   SpinLock lock(mutex_);
   auto events = find(streamToEvents_, stream, "Stream does not exist")->second;
   lock.unlock();
@@ -267,23 +347,193 @@ req::Id Client::getNextId() {
   return req::IsRegularId(res) ? res : getNextId();
 }
 
-void Client::sendRequest(const req::Request& request) {
+void Client::sendRequest(const req::Request& request, const std::vector<int>& fds) {
   EASY_FUNCTION()
-  EASY_BLOCK("Serialize request")
   RT_VLOG(MID) << "Sending request " << static_cast<uint32_t>(request.type_) << " with id: " << request.id_;
+  SpinLock lock(mutex_);
+  if (responseWaiters_.find(request.id_) != end(responseWaiters_)) {
+    RT_LOG(WARNING) << "There was a previous response structure (Waiter) for request ID: " << request.id_
+                    << ". New request ID will erase the previous one. This is likely a BUG.";
+  }
+  responseWaiters_[request.id_] = std::make_unique<Waiter>();
+  lock.unlock();
+
+  if (fds.empty()) {
+    queueRequest(request);
+    sendQueuedRequests();
+    return;
+  }
+  sendQueuedRequests();
+  EASY_BLOCK("Serialize request")
   std::stringstream sreq;
   cereal::PortableBinaryOutputArchive archive(sreq);
   archive(request);
   EASY_END_BLOCK
+  std::lock_guard sendLock(sendMutex_);
+  writeSocket(sreq.str(), fds);
+}
+
+size_t Client::queueRequest(const req::Request& request) {
+  EASY_FUNCTION()
+  std::lock_guard lock(queueMutex_);
+  auto headerOffset = submissionQueue_.size();
+  submissionQueue_.resize(headerOffset + sizeof(shm::BatchEntryHeader));
+  auto kind = encodeRequest(request, submissionQueue_);
+  auto entrySize = submissionQueue_.size() - headerOffset - sizeof(shm::BatchEntryHeader);
+  auto header = shm::BatchEntryHeader{static_cast<uint32_t>(kind), static_cast<uint32_t>(entrySize)};
+  memcpy(submissionQueue_.data() + headerOffset, &header, sizeof(header));
+  return submissionQueue_.size();
+}
+
+void Client::sendQueuedRequests() {
+  EASY_FUNCTION()
+  std::lock_guard sendLock(sendMutex_);
+  {
+    std::lock_guard lock(queueMutex_);
+    if (submissionQueue_.empty()) {
+      // another sender took them already
+      return;
+    }
+    std::swap(submissionQueue_, sendBuffer_);
+    submissionQueue_.clear();
+  }
+  auto maxMessageSize = shmActive_ ? requestRing_->getMaxMessageSize() : kMaxBatchSize;
+  auto entrySize = [this](size_t offset) {
+    shm::BatchEntryHeader header;
+    memcpy(&header, sendBuffer_.data() + offset, sizeof(header));
+    return sizeof(header) + header.size_;
+  };
+  for (auto begin = 0UL; begin < sendBuffer_.size();) {
+    auto end = begin + entrySize(begin);
+    auto numEntries = 1U;
+    while (end < sendBuffer_.size() && end + entrySize(end) - begin <= maxMessageSize) {
+      end += entrySize(end);
+      ++numEntries;
+    }
+    if (numEntries == 1) {
+      // a lone request is sent as it is
+      shm::BatchEntryHeader header;
+      memcpy(&header, sendBuffer_.data() + begin, sizeof(header));
+      sendMessage(static_cast<shm::Kind>(header.kind_), sendBuffer_.data() + begin + sizeof(header), header.size_);
+    } else {
+      RT_VLOG(MID) << "Sending " << numEntries << " requests in a single message";
+      sendMessage(shm::Kind::BATCH, sendBuffer_.data() + begin, end - begin);
+    }
+    begin = end;
+  }
+}
+
+void Client::sendMessage(shm::Kind kind, const std::byte* data, size_t size) {
+  EASY_FUNCTION()
+  if (shmActive_) {
+    while (!requestRing_->push(static_cast<uint32_t>(kind), data, size, kShmPushTimeout)) {
+      if (!running_) {
+        throw NetworkException("Server connection lost while the request ring was full");
+      }
+      RT_LOG(WARNING) << "Shared memory request ring is full, server is not consuming requests. Retrying...";
+    }
+    return;
+  }
+  if (kind == shm::Kind::SERIALIZED) {
+    writeSocket(std::string{reinterpret_cast<const char*>(data), size}, {});
+    return;
+  }
+  // the socket only carries serialized requests; anything else is wrapped in a batch
+  auto batch = std::string{};
+  if (kind != shm::Kind::BATCH) {
+    auto header = shm::BatchEntryHeader{static_cast<uint32_t>(kind), static_cast<uint32_t>(size)};
+    batch.append(reinterpret_cast<const char*>(&header), sizeof(header));
+  }
+  batch.append(reinterpret_cast<const char*>(data), size);
+  EASY_BLOCK("Serialize request")
+  std::stringstream sreq;
+  cereal::PortableBinaryOutputArchive archive(sreq);
+  archive(req::Request{req::Type::BATCH, req::INVALID_REQUEST_ID, req::Batch{std::move(batch)}});
+  EASY_END_BLOCK
+  writeSocket(sreq.str(), {});
+}
+
+shm::Kind Client::encodeRequest(const req::Request& request, std::vector<std::byte>& buffer) const {
+  auto append = [&buffer](const void* data, size_t size) {
+    auto ptr = static_cast<const std::byte*>(data);
+    buffer.insert(end(buffer), ptr, ptr + size);
+  };
+  switch (request.type_) {
+  case req::Type::MEMCPY_H2D:
+  case req::Type::MEMCPY_D2H: {
+    auto& copy = std::get<req::Memcpy>(request.payload_);
+    auto record =
+      shm::MemcpyRecord{request.type_, request.id_, copy.src_, copy.dst_, copy.size_, copy.stream_, copy.barrier_};
+    append(&record, sizeof(record));
+    return shm::Kind::MEMCPY;
+  }
+  case req::Type::KERNEL_LAUNCH: {
+    auto& launch = std::get<req::KernelLaunch>(request.payload_);
+    auto& options = launch.kernelOptionsImp_;
+    if (options.userTraceConfig_ || !options.coreDumpFilePath_.empty() || !options.flushRanges_.empty() ||
+        options.shireArgsStride_ != 0 || options.watchdogTimeout_ != 0 || options.noTensorOps_ ||
+        options.l2Sets_ != 0 || options.launchPrefetch_ || options.reportAndContinue_) {
+      break;
+    }
+    auto record = shm::KernelLaunchRecord{request.id_,
+                                          launch.stream_,
+                                          launch.kernel_,
+                                          options.barrier_,
+                                          options.flushL3_,
+                                          options.stackConfig_.has_value(),
+                                          options.shireMask_,
+                                          options.stackConfig_ ? options.stackConfig_->baseAddress_ : 0,
+                                          options.stackConfig_ ? options.stackConfig_->totalSize_ : 0,
+                                          launch.kernelArgs_.size()};
+    append(&record, sizeof(record));
+    append(launch.kernelArgs_.data(), launch.kernelArgs_.size());
+    return shm::Kind::KERNEL_LAUNCH;
+  }
+  default:
+    break;
+  }
+  EASY_BLOCK("Serialize request")
+  std::stringstream sreq;
+  cereal::PortableBinaryOutputArchive archive(sreq);
+  archive(request);
   auto str = sreq.str();
+  append(str.data(), str.size());
+  return shm::Kind::SERIALIZED;
+}
+
+void Client::flush() {
+  EASY_FUNCTION()
+  sendQueuedRequests();
   SpinLock lock(mutex_);
-  if (responseWaiters_.find(request.id_) != end(responseWaiters_)) {
-    RT_LOG(WARNING) << "There was a previous response structure (Waiter) for request ID: " << request.id_
-                    << ". New request ID will erase the previous one. This is likely a BUG.";
+  rethrowBatchError();
+}
+
+void Client::rethrowBatchError() {
+  if (batchError_) {
+    auto error = std::move(*batchError_);
+    batchError_.reset();
+    throw error;
   }
-  responseWaiters_[request.id_] = std::make_unique<Waiter>();
-  EASY_BLOCK("Write socket")
-  if (auto res = write(socket_, str.data(), str.size()); res < static_cast<long>(str.size())) {
+}
+
+void Client::writeSocket(const std::string& data, const std::vector<int>& fds) {
+  EASY_FUNCTION()
+  iovec iov{const_cast<char*>(data.data()), data.size()};
+  msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  auto control = std::vector<char>(fds.empty() ? 0 : CMSG_SPACE(sizeof(int) * fds.size()));
+  if (!fds.empty()) {
+    msg.msg_control = control.data();
+    msg.msg_controllen = control.size();
+    auto cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int) * fds.size());
+    memcpy(CMSG_DATA(cmsg), fds.data(), sizeof(int) * fds.size());
+  }
+  if (auto res = sendmsg(socket_, &msg, 0); res < static_cast<long>(data.size())) {
     auto errorMsg = std::string{strerror(errno)};
     RT_VLOG(LOW) << "Write socket error: " << errorMsg;
     throw NetworkException("Write socket error: " + errorMsg);
@@ -315,6 +565,12 @@ void Client::dispatch(EventId event) {
   auto& events = find(streamToEvents_, st, "Stream not found")->second;
   auto it = std::remove(begin(events), end(events), event);
   events.erase(it, end(events));
+  if (auto cbs = eventCallbacks_.find(event); cbs != end(eventCallbacks_)) {
+    for (auto& cb : cbs->second) {
+      tp_.pushTask(std::move(cb));
+    }
+    eventCallbacks_.erase(cbs);
+  }
   eventSync_.notify_all();
 }
 
@@ -328,13 +584,14 @@ void Client::processResponse(const resp::Response& response) {
     CHECK(response.id_ == req::ASYNC_RUNTIME_EVENT)
       << "Kernel aborted message should have request type ASYNC_RUNTIME_EVENT";
     auto& payload = std::get<resp::KernelAborted>(response.payload_);
-    auto evt = payload.event_;
+    auto serverEvt = payload.event_;
+    auto evt = getClientEvent(serverEvt);
     auto buffer = reinterpret_cast<std::byte*>(payload.buffer_);
     if (kernelAbortCallback_) {
       delayedEvents_.insert(evt);
-      tp_.pushTask([this, cb = kernelAbortCallback_, evt, buffer, size = payload.size_] {
-        cb(evt, buffer, size, [this, evt] {
-          sendRequestAndWait(req::Type::KERNEL_ABORT_RELEASE_RESOURCES, evt);
+      tp_.pushTask([this, cb = kernelAbortCallback_, evt, serverEvt, buffer, size = payload.size_] {
+        cb(evt, buffer, size, [this, evt, serverEvt] {
+          sendRequestAndWait(req::Type::KERNEL_ABORT_RELEASE_RESOURCES, serverEvt);
           SpinLock inner_lock(mutex_);
           dispatch(evt);
           delayedEvents_.erase(evt);
@@ -342,16 +599,26 @@ void Client::processResponse(const resp::Response& response) {
       });
     } else {
       lock.unlock();
-      sendRequestAndWait(req::Type::KERNEL_ABORT_RELEASE_RESOURCES, evt);
+      sendRequestAndWait(req::Type::KERNEL_ABORT_RELEASE_RESOURCES, serverEvt);
     }
     break;
   }
 
   case resp::Type::EVENT_DISPATCHED: {
     CHECK(response.id_ == req::ASYNC_RUNTIME_EVENT) << "Event dispatched should have request type ASYNC_RUNTIME_EVENT";
+    auto serverEvt = std::get<resp::Event>(response.payload_).event_;
+    auto evt = getClientEvent(serverEvt);
+    // the server can reuse its event id from now on
+    serverToClientEvent_.erase(serverEvt);
+    clientToServerEvent_.erase(evt);
+    if (auto it = serverToDispatchedEvent_.find(serverEvt); it != end(serverToDispatchedEvent_)) {
+      dispatchedToServerEvent_.erase(it->second);
+    }
+    serverToDispatchedEvent_[serverEvt] = evt;
+    dispatchedToServerEvent_[evt] = serverEvt;
     // only dispatch the event if its a delayed event (a callback is being executed), otherwise it will be dispatched
-    // later after the callback is done
-    if (auto evt = std::get<resp::Event>(response.payload_).event_; delayedEvents_.find(evt) == end(delayedEvents_)) {
+    // later after the callback is done. It could be already dispatched too, if its batched request failed
+    if (delayedEvents_.find(evt) == end(delayedEvents_) && eventToStream_.find(evt) != end(eventToStream_)) {
       dispatch(evt);
     }
     break;
@@ -360,7 +627,7 @@ void Client::processResponse(const resp::Response& response) {
   case resp::Type::STREAM_ERROR: {
     CHECK(response.id_ == req::ASYNC_RUNTIME_EVENT) << "Stream error should have request type ASYNC_RUNTIME_EVENT";
     auto& payload = std::get<resp::StreamError>(response.payload_);
-    auto evt = payload.event_;
+    auto evt = getClientEvent(payload.event_);
     if (streamErrorCallback_) {
       delayedEvents_.insert(evt);
       tp_.pushTask([this, cb = streamErrorCallback_, evt, error = std::move(payload.error_)] {
@@ -388,6 +655,21 @@ void Client::processResponse(const resp::Response& response) {
   }
 
   default:
+    if (auto it = batchedRequests_.find(response.id_); it != end(batchedRequests_)) {
+      auto evt = it->second;
+      batchedRequests_.erase(it);
+      if (auto error = std::get_if<resp::RuntimeException>(&response.payload_); error != nullptr) {
+        RT_LOG(WARNING) << "Batched request " << response.id_ << " failed: " << error->exception_.what();
+        batchError_ = error->exception_;
+        dispatch(evt);
+      } else {
+        auto serverEvt = std::get<resp::Event>(response.payload_).event_;
+        serverToClientEvent_[serverEvt] = evt;
+        clientToServerEvent_[evt] = serverEvt;
+        eventSync_.notify_all();
+      }
+      break;
+    }
     RT_VLOG(MID) << "Got response type: " << static_cast<uint32_t>(response.type_) << " wake up waiter.";
     auto it = find(responseWaiters_, response.id_, "Could not find the request id " + std::to_string(response.id_));
     RT_VLOG(MID) << "Waiter found; notifying";
@@ -397,21 +679,62 @@ void Client::processResponse(const resp::Response& response) {
 }
 
 EventId Client::registerEvent(const resp::Response::Payload_t& payload, StreamId st) {
+  return registerEvent(std::get<resp::Event>(payload).event_, st);
+}
+
+EventId Client::registerEvent(EventId serverEvt, StreamId st) {
   EASY_FUNCTION(profiler::colors::Purple)
-  auto evt = std::get<resp::Event>(payload).event_;
-  EASY_VALUE("Event", static_cast<int>(evt))
-  registerEvent(evt, st);
+  auto evt = allocateEvent(st);
+  SpinLock lock(mutex_);
+  serverToClientEvent_[serverEvt] = evt;
+  clientToServerEvent_[evt] = serverEvt;
+  EASY_VALUE("Server event", static_cast<int>(serverEvt))
   return evt;
 }
 
-void Client::registerEvent(EventId evt, StreamId st) {
+EventId Client::allocateEvent(StreamId st, std::optional<req::Id> request) {
   EASY_FUNCTION(profiler::colors::Purple)
   SpinLock lock(mutex_);
-  find(streamToEvents_, st, "Stream does not exist");
+  auto& events = find(streamToEvents_, st, "Stream does not exist")->second;
+  // skip the ids of the events still alive
+  auto evt = static_cast<EventId>(++nextEvent_);
+  for (auto tries = 0U; eventToStream_.find(evt) != end(eventToStream_) || delayedEvents_.count(evt) > 0; ++tries) {
+    if (tries == std::numeric_limits<uint16_t>::max()) {
+      throw Exception("Too many events alive, can't allocate a new one");
+    }
+    evt = static_cast<EventId>(++nextEvent_);
+  }
+  if (auto it = dispatchedToServerEvent_.find(evt); it != end(dispatchedToServerEvent_)) {
+    serverToDispatchedEvent_.erase(it->second);
+    dispatchedToServerEvent_.erase(it);
+  }
   eventToStream_[evt] = st;
-  streamToEvents_[st].emplace_back(evt);
+  events.emplace_back(evt);
+  if (request) {
+    batchedRequests_[*request] = evt;
+  }
   EASY_VALUE("Event", static_cast<int>(evt))
   EASY_VALUE("Stream", static_cast<int>(st))
+  return evt;
+}
+
+EventId Client::getClientEvent(EventId serverEvt) const {
+  // the event could be unknown yet if its request response is still to be processed; then this response is delayed
+  return find(serverToClientEvent_, serverEvt, "Event does not exist")->second;
+}
+
+std::optional<EventId> Client::getServerEvent(EventId evt) {
+  // the event request could be still queued
+  sendQueuedRequests();
+  SpinLock lock(mutex_);
+  eventSync_.wait(lock, [this, evt] {
+    return !running_ || clientToServerEvent_.find(evt) != end(clientToServerEvent_) ||
+           eventToStream_.find(evt) == end(eventToStream_);
+  });
+  if (auto it = clientToServerEvent_.find(evt); it != end(clientToServerEvent_)) {
+    return it->second;
+  }
+  return {};
 }
 
 EventId Client::doAbortStream(StreamId st) {
@@ -436,6 +759,8 @@ void Client::handShake() {
       ".0. Please update the runtime client library or runtime daemon server.");
   }
 
+  setupShmTransport();
+
   // get deviceLayerProperties now
   auto devices = getDevices();
   RT_LOG(INFO) << "Num devices: " << devices.size();
@@ -455,15 +780,38 @@ void Client::handShake() {
   }
 }
 
+void Client::setupShmTransport() {
+  EASY_FUNCTION()
+  try {
+    requestRing_ = ShmRing::create(shm::kRequestRingSize);
+    responseRing_ = ShmRing::create(shm::kResponseRingSize);
+    auto reqId = getNextId();
+    sendRequest({req::Type::SHM_TRANSPORT, reqId, std::monostate{}}, {requestRing_->getFd(), responseRing_->getFd()});
+    waitForResponse(reqId);
+  } catch (const Exception& e) {
+    RT_LOG(WARNING) << "Can't set up the shared memory transport, all requests will go through the socket: "
+                    << e.what();
+    requestRing_.reset();
+    responseRing_.reset();
+    return;
+  }
+  shmActive_ = true;
+  RT_LOG(INFO) << "Using shared memory transport. Request ring: " << requestRing_->getCapacity()
+               << " bytes, response ring: " << responseRing_->getCapacity() << " bytes";
+}
+
 EventId Client::doMemcpyDeviceToHost(StreamId st, std::byte const* src, std::byte* dst, unsigned long size,
                                      bool barrier, const CmaCopyFunction&) {
-  auto payload = sendRequestAndWait(req::Type::MEMCPY_D2H, req::Memcpy{st, reinterpret_cast<AddressT>(src),
-                                                                       reinterpret_cast<AddressT>(dst), size, barrier});
-  return registerEvent(payload, st);
+  auto request = req::Memcpy{st, reinterpret_cast<AddressT>(src), reinterpret_cast<AddressT>(dst), size, barrier};
+  return sendEventRequest(req::Type::MEMCPY_D2H, request, st);
 }
 
-StreamId Client::doCreateStream(DeviceId deviceId) {
-  auto payload = sendRequestAndWait(req::Type::CREATE_STREAM, req::CreateStream{deviceId});
+StreamId Client::doCreateStream(DeviceId deviceId, StreamPriority priority) {
+  // normal priority streams keep using the plain request, so older servers can still serve them
+  auto payload = priority == StreamPriority::Normal
+                   ? sendRequestAndWait(req::Type::CREATE_STREAM, req::CreateStream{deviceId})
+                   : sendRequestAndWait(req::Type::CREATE_PRIORITY_STREAM,
+                                        req::CreatePriorityStream{deviceId, priority});
   auto st = std::get<resp::CreateStream>(payload).stream_;
   SpinLock lock(mutex_);
   streamToEvents_[st] = {};
@@ -476,33 +824,89 @@ std::byte* Client::doMallocDevice(DeviceId device, unsigned long size, unsigned
 }
 
 EventId Client::doMemcpyDeviceToHost(StreamId st, MemcpyList memcpyList, bool barrier, const CmaCopyFunction&) {
-  auto payload = sendRequestAndWait(req::Type::MEMCPY_LIST_D2H, req::MemcpyList{memcpyList, st, barrier});
-  return registerEvent(payload, st);
+  return sendEventRequest(req::Type::MEMCPY_LIST_D2H, req::MemcpyList{memcpyList, st, barrier}, st);
 }
 
 EventId Client::doMemcpyHostToDevice(StreamId st, std::byte const* src, std::byte* dst, unsigned long size,
                                      bool barrier, const CmaCopyFunction&) {
-  auto payload = sendRequestAndWait(req::Type::MEMCPY_H2D, req::Memcpy{st, reinterpret_cast<AddressT>(src),
-                                                                       reinterpret_cast<AddressT>(dst), size, barrier});
-  return registerEvent(payload, st);
+  auto request = req::Memcpy{st, reinterpret_cast<AddressT>(src), reinterpret_cast<AddressT>(dst), size, barrier};
+  return sendEventRequest(req::Type::MEMCPY_H2D, request, st);
 }
 
 void Client::doFreeDevice(DeviceId device, std::byte* ptr) {
   sendRequestAndWait(req::Type::FREE, req::Free{device, reinterpret_cast<AddressT>(ptr)});
 }
 
+std::byte* Client::doAllocHostBuffer(DeviceId device, size_t size) {
+  if (size == 0) {
+    throw Exception("Invalid host buffer size");
+  }
+  auto pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  size = (size + pageSize - 1) / pageSize * pageSize;
+  auto fd = memfd_create("etrt-host-buffer", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+  if (fd < 0) {
+    throw Exception(std::string{"Can't create host buffer: "} + strerror(errno));
+  }
+  // once sealed the server can rely on its mapping of the buffer staying valid
+  if (ftruncate(fd, static_cast<off_t>(size)) != 0 ||
+      fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) != 0) {
+    auto error = std::string{strerror(errno)};
+    close(fd);
+    throw Exception("Can't set up host buffer: " + error);
+  }
+  auto memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (memory == MAP_FAILED) {
+    auto error = std::string{strerror(errno)};
+    close(fd);
+    throw Exception("Can't map host buffer: " + error);
+  }
+  try {
+    sendRequestAndWait(req::Type::ALLOC_HOST_BUFFER,
+                       req::AllocHostBuffer{device, reinterpret_cast<AddressT>(memory), size}, {fd});
+  } catch (...) {
+    munmap(memory, size);
+    close(fd);
+    throw;
+  }
+  // the server has its own reference to the memory now
+  close(fd);
+  auto h_ptr = static_cast<std::byte*>(memory);
+  SpinLock lock(mutex_);
+  hostBuffers_[h_ptr] = size;
+  return h_ptr;
+}
+
+void Client::doFreeHostBuffer(DeviceId device, std::byte* h_ptr) {
+  SpinLock lock(mutex_);
+  auto size = find(hostBuffers_, h_ptr, "Host buffer was not allocated through allocHostBuffer")->second;
+  lock.unlock();
+  sendRequestAndWait(req::Type::FREE_HOST_BUFFER, req::FreeHostBuffer{device, reinterpret_cast<AddressT>(h_ptr)});
+  lock.lock();
+  hostBuffers_.erase(h_ptr);
+  lock.unlock();
+  munmap(h_ptr, size);
+}
+
+void Client::doFreeDeviceAsync(StreamId stream, std::byte* ptr) {
+  sendRequestAndWait(req::Type::FREE_ASYNC, req::FreeAsync{stream, reinterpret_cast<AddressT>(ptr)});
+}
+
 EventId Client::doKernelLaunch(StreamId stream, KernelId kernel, const std::byte* kernel_args, size_t kernel_args_size,
                                const KernelLaunchOptionsImp& options) {
   std::vector<std::byte> kernelArgs;
   std::copy(kernel_args, kernel_args + kernel_args_size, std::back_inserter(kernelArgs));
-  auto payload = sendRequestAndWait(req::Type::KERNEL_LAUNCH, req::KernelLaunch{stream, kernel, kernelArgs, options});
-  return registerEvent(payload, stream);
+  return sendEventRequest(req::Type::KERNEL_LAUNCH, req::KernelLaunch{stream, kernel, kernelArgs, options}, stream);
 }
 
 EventId Client::doAbortCommand(EventId evt, std::chrono::milliseconds timeout) {
   SpinLock lock(mutex_);
   auto st = find(eventToStream_, evt, "Trying to abort a non existing command.")->second;
-  auto payload = sendRequestAndWait(req::Type::ABORT_COMMAND, req::AbortCommand{evt, timeout});
+  lock.unlock();
+  auto serverEvt = getServerEvent(evt);
+  if (!serverEvt) {
+    throw Exception("Trying to abort a non existing command.");
+  }
+  auto payload = sendRequestAndWait(req::Type::ABORT_COMMAND, req::AbortCommand{*serverEvt, timeout});
   return registerEvent(payload, st);
 }
 
@@ -517,9 +921,8 @@ LoadCodeResult Client::doLoadCode(StreamId st, std::byte const* data, unsigned l
   LoadCodeResult r;
   auto resp = std::get<resp::LoadCode>(payload);
   r.loadAddress_ = reinterpret_cast<std::byte*>(resp.loadAddress_);
-  r.event_ = resp.event_;
+  r.event_ = registerEvent(resp.event_, st);
   r.kernel_ = resp.kernel_;
-  registerEvent(r.event_, st);
   return r;
 }
 
@@ -533,8 +936,7 @@ void Client::doUnloadCode(KernelId kid) {
 }
 
 EventId Client::doMemcpyHostToDevice(StreamId st, MemcpyList memcpyList, bool barrier, const CmaCopyFunction&) {
-  auto payload = sendRequestAndWait(req::Type::MEMCPY_LIST_H2D, req::MemcpyList{memcpyList, st, barrier});
-  return registerEvent(payload, st);
+  return sendEventRequest(req::Type::MEMCPY_LIST_H2D, req::MemcpyList{memcpyList, st, barrier}, st);
 }
 
 void Client::doDestroyStream(StreamId stream) {
@@ -590,6 +992,21 @@ std::unordered_map<DeviceId, uint32_t> Client::getAliveEvents() {
   return std::get<resp::AliveEvents>(payload).aliveEvents_;
 }
 
+std::vector<ClientStats> Client::getClientStats() {
+  auto payload = sendRequestAndWait(req::Type::GET_CLIENT_STATS, std::monostate{});
+  return std::get<resp::ClientsStats>(payload).clientsStats_;
+}
+
+std::unordered_map<DeviceId, DeviceMetrics> Client::getDeviceMetrics() {
+  auto payload = sendRequestAndWait(req::Type::GET_DEVICE_METRICS, std::monostate{});
+  return std::get<resp::DevicesMetrics>(payload).devicesMetrics_;
+}
+
+std::unordered_map<DeviceId, std::vector<UtilizationSample>> Client::getDeviceUtilization() {
+  auto payload = sendRequestAndWait(req::Type::GET_DEVICE_UTILIZATION, std::monostate{});
+  return std::get<resp::DevicesUtilization>(payload).devicesUtilization_;
+}
+
 EventId Client::doMemcpyDeviceToDevice(StreamId streamSrc, DeviceId deviceDst, const std::byte* d_src, std::byte* d_dst,
                                        size_t size, bool barrier) {
   auto payload = sendRequestAndWait(req::Type::MEMCPY_P2P_WRITE,
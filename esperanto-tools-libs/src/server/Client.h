@@ -6,6 +6,7 @@
 #include "KernelLaunchOptionsImp.h"
 #include "ProfilerImp.h"
 #include "Protocol.h"
+#include "ShmRing.h"
 #include "StreamManager.h"
 #include "runtime/IMonitor.h"
 #include "runtime/Types.h"
@@ -23,7 +24,8 @@ public:
   std::vector<DeviceId> doGetDevices() final;
   std::byte* doMallocDevice(DeviceId device, size_t size, uint32_t alignment = kCacheLineSize) final;
   void doFreeDevice(DeviceId device, std::byte* buffer) final;
-  StreamId doCreateStream(DeviceId device) final;
+  void doFreeDeviceAsync(StreamId stream, std::byte* buffer) final;
+  StreamId doCreateStream(DeviceId device, StreamPriority priority) final;
   void doDestroyStream(StreamId stream) final;
   LoadCodeResult doLoadCode(StreamId stream, const std::byte* elf, size_t elf_size) final;
   void doUnloadCode(KernelId kernel) final;
@@ -52,6 +54,9 @@ public:
   std::vector<StreamError> doRetrieveStreamErrors(StreamId stream) final;
 
   void doSetOnStreamErrorsCallback(StreamErrorCallback callback) final;
+  void doOnEventComplete(EventId event, EventCompletionCallback callback) final;
+  std::optional<EventTiming> doGetEventTiming(EventId event) final;
+  void doSetCallbackExecutor(CallbackExecutor executor) final;
 
   DeviceProperties doGetDeviceProperties(DeviceId device) const final;
 
@@ -68,6 +73,22 @@ public:
 
   bool doIsP2PEnabled(DeviceId one, DeviceId other) const final;
 
+  std::byte* doAllocHostBuffer(DeviceId device, size_t size) final;
+
+  void doFreeHostBuffer(DeviceId device, std::byte* h_ptr) final;
+
+  void doSetRequestBatching(bool enabled) final {
+    batching_ = enabled;
+  }
+
+  void doFlushRequests() final {
+    flush();
+  }
+
+  // sends the queued requests right away, see IRuntime::setRequestBatching. Throws the error of any failed batched
+  // request
+  void flush();
+
   // IMonitor implementation
   size_t getCurrentClients() final;
 
@@ -77,20 +98,55 @@ public:
 
   std::unordered_map<DeviceId, uint32_t> getAliveEvents() final;
 
+  std::vector<ClientStats> getClientStats() final;
+
+  std::unordered_map<DeviceId, DeviceMetrics> getDeviceMetrics() final;
+  std::unordered_map<DeviceId, std::vector<UtilizationSample>> getDeviceUtilization() final;
+
 private:
   void connect(sockaddr_un& addr) const;
 
   void onProfilerChanged() final;
 
-  template <typename Payload> resp::Response::Payload_t sendRequestAndWait(req::Type type, Payload payload) {
+  template <typename Payload>
+  resp::Response::Payload_t sendRequestAndWait(req::Type type, Payload payload, const std::vector<int>& fds = {}) {
     auto reqId = getNextId();
-    sendRequest({type, reqId, std::move(payload)});
+    sendRequest({type, reqId, std::move(payload)}, fds);
     return waitForResponse(reqId);
   }
+  // sends a request whose response is an event of the given stream. With request batching enabled the request is only
+  // queued and its event is returned without waiting for the server
+  template <typename Payload> EventId sendEventRequest(req::Type type, Payload payload, StreamId stream) {
+    if (!batching_) {
+      return registerEvent(sendRequestAndWait(type, std::move(payload)), stream);
+    }
+    auto reqId = getNextId();
+    auto evt = allocateEvent(stream, reqId);
+    auto queuedSize = queueRequest({type, reqId, std::move(payload)});
+    if (queuedSize >= kMaxBatchSize) {
+      sendQueuedRequests();
+    }
+    return evt;
+  }
   void dispatch(EventId event);
   void handShake();
-
-  void sendRequest(const req::Request& request);
+  void setupShmTransport();
+
+  // fds are passed to the server along with the request (SCM_RIGHTS). Requests with fds always go through the socket,
+  // so they must not depend on the ordering with requests sent before them
+  void sendRequest(const req::Request& request, const std::vector<int>& fds = {});
+  // appends the request to the submission queue; returns the queue size in bytes
+  size_t queueRequest(const req::Request& request);
+  // sends all the queued requests, coalescing them in as few messages as possible
+  void sendQueuedRequests();
+  // encodes the request as it's pushed to the request ring, appending it to buffer
+  shm::Kind encodeRequest(const req::Request& request, std::vector<std::byte>& buffer) const;
+  // must be called with sendMutex_ held
+  void sendMessage(shm::Kind kind, const std::byte* data, size_t size);
+  void writeSocket(const std::string& data, const std::vector<int>& fds);
+  resp::Response decodeResponse(shm::Kind kind, const std::vector<std::byte>& data) const;
+  // processes the response or delays it if its request hasn't been acked yet
+  void handleResponse(resp::Response response);
   void processResponse(const resp::Response& response);
 
   void responseProcessor();
@@ -99,8 +155,18 @@ private:
 
   void processDelayedResponses();
 
+  // registers a server event, returning the client event it's mapped to
   EventId registerEvent(const resp::Response::Payload_t& payload, StreamId stream);
-  void registerEvent(EventId evt, StreamId stream);
+  EventId registerEvent(EventId serverEvt, StreamId stream);
+  // returns a new client event for stream; if given, the server event will be known once the request is answered
+  EventId allocateEvent(StreamId stream, std::optional<req::Id> request = {});
+  // returns the client event mapped to a server event. mutex_ must be held
+  EventId getClientEvent(EventId serverEvt) const;
+  // returns the server event mapped to a client event, waiting for its request to be answered if needed. Returns
+  // nothing if the event is already completed
+  std::optional<EventId> getServerEvent(EventId evt);
+  // throws the error of a failed batched request, if any. mutex_ must be held
+  void rethrowBatchError();
 
   // store dmaInfo and deviceConfig for each device
 
@@ -132,9 +198,22 @@ private:
   std::vector<DeviceId> devices_;
   std::vector<DeviceLayerProperties> deviceLayerProperties_;
   std::unordered_map<resp::Id, std::unique_ptr<Waiter>> responseWaiters_;
+  // events handed to the user are assigned by the client, so batched requests can return them before the server
+  // answers; they are mapped to the server events once known. eventToStream_ holds all the alive client events
   std::unordered_map<EventId, StreamId> eventToStream_;
+  std::unordered_map<EventId, EventId> serverToClientEvent_;
+  std::unordered_map<EventId, EventId> clientToServerEvent_;
+  // server events of the dispatched client events, till the server reuses them, to ask for their timing
+  std::unordered_map<EventId, EventId> dispatchedToServerEvent_;
+  std::unordered_map<EventId, EventId> serverToDispatchedEvent_;
+  // batched requests waiting for their response and their client events
+  std::unordered_map<req::Id, EventId> batchedRequests_;
+  std::optional<Exception> batchError_;
+  uint16_t nextEvent_ = 0;
   std::unordered_map<StreamId, std::vector<EventId>> streamToEvents_;
   std::unordered_map<StreamId, std::vector<StreamError>> streamErrors_;
+  // host buffers shared with the server and their sizes
+  std::unordered_map<std::byte*, size_t> hostBuffers_;
   resp::P2PCompatibility p2pCompatibility_;
 
   std::condition_variable eventSync_;
@@ -143,6 +222,9 @@ private:
 
   StreamErrorCallback streamErrorCallback_;
   KernelAbortedCallback kernelAbortCallback_;
+  CallbackExecutor callbackExecutor_;
+  // completion callbacks waiting for their events, they are handed to tp_ when the event is dispatched
+  std::unordered_map<EventId, std::vector<std::function<void()>>> eventCallbacks_;
   threadPool::ThreadPool tp_{2};
 
   // these events won't be dispatched instantly because there are callbacks being executed
@@ -151,6 +233,22 @@ private:
   // Some responses can arrive before their event id is known. They are delayed here until their event id can be matched
   std::list<resp::Response> delayedResponses_;
 
+  // shared memory transport; once active the socket is only used to detect the server going away
+  std::unique_ptr<ShmRing> requestRing_;
+  std::unique_ptr<ShmRing> responseRing_;
+  std::atomic<bool> shmActive_ = false;
+  // serializes the writes to the socket or the request ring, which only allows one producer
+  std::mutex sendMutex_;
+  std::vector<std::byte> sendBuffer_;
+
+  // queued requests are sent once they reach this size
+  static constexpr size_t kMaxBatchSize = 64UL << 10;
+  // requests waiting to be sent, as a shm::Kind::BATCH message. Requests issued while another thread is sending are
+  // coalesced here and sent together by the next sender
+  std::mutex queueMutex_;
+  std::vector<std::byte> submissionQueue_;
+  std::atomic<bool> batching_ = false;
+
   int socket_;
   std::atomic<req::Id> nextId_ = 0;
   bool running_ = true;
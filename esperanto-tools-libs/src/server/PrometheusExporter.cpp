@@ -0,0 +1,150 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) 2025 Ainekko, Co.
+ * SPDX-License-Identifier: Apache-2.0
+ *-------------------------------------------------------------------------*/
+#include "PrometheusExporter.h"
+#include "runtime/Types.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+using namespace rt;
+
+namespace {
+// bucket bounds in nanoseconds
+constexpr std::array<uint64_t, 22> kBounds = {
+  1'000,       2'000,       5'000,         10'000,        20'000,        50'000,        100'000,     200'000,
+  500'000,     1'000'000,   2'000'000,     5'000'000,     10'000'000,    20'000'000,    50'000'000,  100'000'000,
+  200'000'000, 500'000'000, 1'000'000'000, 2'000'000'000, 5'000'000'000, 10'000'000'000};
+
+const char* getKindLabel(size_t kind) {
+  switch (static_cast<CommandKind>(kind)) {
+  case CommandKind::KernelLaunch:
+    return "kernel_launch";
+  case CommandKind::MemcpyHostToDevice:
+    return "memcpy_h2d";
+  case CommandKind::MemcpyDeviceToHost:
+    return "memcpy_d2h";
+  default:
+    return "unknown";
+  }
+}
+
+const char* getStageLabel(size_t stage) {
+  switch (static_cast<LatencyStage>(stage)) {
+  case LatencyStage::SubmitToStart:
+    return "submit_to_start";
+  case LatencyStage::Execution:
+    return "execution";
+  case LatencyStage::CompletionToWake:
+    return "completion_to_wake";
+  default:
+    return "unknown";
+  }
+}
+
+double toSeconds(uint64_t ns) {
+  return static_cast<double>(ns) / 1e9;
+}
+
+void writeHistogram(std::ostream& os, const std::string& labels, const LatencyHistogram& histogram) {
+  // the values of a bucket straddling a bound are counted in the next one, so each count is a lower bound
+  uint64_t accumulated = 0;
+  size_t bucket = 0;
+  for (auto bound : kBounds) {
+    for (; bucket < histogram.counts_.size() && LatencyHistogram::getBucketUpperBound(bucket) <= bound; ++bucket) {
+      accumulated += histogram.counts_[bucket];
+    }
+    os << "et_command_latency_seconds_bucket{" << labels << ",le=\"" << toSeconds(bound) << "\"} " << accumulated
+       << "\n";
+  }
+  os << "et_command_latency_seconds_bucket{" << labels << ",le=\"+Inf\"} " << histogram.count_ << "\n";
+  os << "et_command_latency_seconds_sum{" << labels << "} " << toSeconds(histogram.sum_) << "\n";
+  os << "et_command_latency_seconds_count{" << labels << "} " << histogram.count_ << "\n";
+}
+} // namespace
+
+std::string rt::formatPrometheusMetrics(const std::unordered_map<DeviceId, DeviceMetrics>& devicesMetrics,
+                                        const std::vector<ClientStats>& clientsStats) {
+  // sorted by device so consecutive scrapes are easy to diff
+  std::map<int, const DeviceMetrics*> devices;
+  for (const auto& [device, metrics] : devicesMetrics) {
+    devices.emplace(static_cast<int>(device), &metrics);
+  }
+
+  std::ostringstream os;
+  os << "# HELP et_command_latency_seconds Latency of each stage of the commands executed by the device.\n";
+  os << "# TYPE et_command_latency_seconds histogram\n";
+  for (const auto& [device, metrics] : devices) {
+    for (size_t kind = 0; kind < metrics->latencies_.size(); ++kind) {
+      for (size_t stage = 0; stage < metrics->latencies_[kind].size(); ++stage) {
+        auto labels = "device=\"" + std::to_string(device) + "\",command=\"" + getKindLabel(kind) + "\",stage=\"" +
+                      getStageLabel(stage) + "\"";
+        writeHistogram(os, labels, metrics->latencies_[kind][stage]);
+      }
+    }
+  }
+
+  os << "# HELP et_dma_bytes_total Bytes copied by the completed DMA commands.\n";
+  os << "# TYPE et_dma_bytes_total counter\n";
+  for (const auto& [device, metrics] : devices) {
+    os << "et_dma_bytes_total{device=\"" << device << "\",direction=\"h2d\"} " << metrics->bytesHostToDevice_ << "\n";
+    os << "et_dma_bytes_total{device=\"" << device << "\",direction=\"d2h\"} " << metrics->bytesDeviceToHost_ << "\n";
+  }
+  os << "# HELP et_dma_bytes_per_second Bandwidth of the DMA commands over their execution time in the device.\n";
+  os << "# TYPE et_dma_bytes_per_second gauge\n";
+  for (const auto& [device, metrics] : devices) {
+    os << "et_dma_bytes_per_second{device=\"" << device << "\",direction=\"h2d\"} "
+       << metrics->bytesPerSecondHostToDevice_ << "\n";
+    os << "et_dma_bytes_per_second{device=\"" << device << "\",direction=\"d2h\"} "
+       << metrics->bytesPerSecondDeviceToHost_ << "\n";
+  }
+
+  os << "# HELP et_clients Number of clients connected to the server.\n";
+  os << "# TYPE et_clients gauge\n";
+  os << "et_clients " << clientsStats.size() << "\n";
+  auto writeClients = [&os, &clientsStats](const char* name, const char* type, const char* help, auto getter) {
+    os << "# HELP " << name << " " << help << "\n";
+    os << "# TYPE " << name << " " << type << "\n";
+    for (const auto& cs : clientsStats) {
+      os << name << "{pid=\"" << cs.pid_ << "\",uid=\"" << cs.uid_ << "\"} " << getter(cs) << "\n";
+    }
+  };
+  writeClients("et_client_bytes_copied_total", "counter", "Bytes of the memcpys submitted by the client.",
+               [](const ClientStats& cs) { return cs.bytesCopied_; });
+  writeClients("et_client_kernel_launches_total", "counter", "Kernel launches submitted by the client.",
+               [](const ClientStats& cs) { return cs.kernelLaunches_; });
+  writeClients("et_client_inflight_commands", "gauge", "Commands of the client submitted but not yet completed.",
+               [](const ClientStats& cs) { return cs.inflightCommands_; });
+  writeClients("et_client_throttled_seconds_total", "counter", "Time the client has been held back by its QoS.",
+               [](const ClientStats& cs) { return static_cast<double>(cs.throttledUs_) / 1e6; });
+  writeClients("et_client_device_memory_bytes", "gauge", "Device memory allocated by the client.",
+               [](const ClientStats& cs) { return cs.deviceMemory_; });
+  writeClients("et_client_kernel_shire_seconds_total", "counter",
+               "Execution time of the completed kernels of the client times their shires.",
+               [](const ClientStats& cs) { return static_cast<double>(cs.kernelShireUs_) / 1e6; });
+  return os.str();
+}
+
+void rt::writePrometheusMetrics(const std::string& path,
+                                const std::unordered_map<DeviceId, DeviceMetrics>& devicesMetrics,
+                                const std::vector<ClientStats>& clientsStats) {
+  auto tmpPath = path + ".tmp";
+  {
+    std::ofstream file(tmpPath, std::ios::trunc);
+    if (!file) {
+      throw Exception("Can't open metrics file: " + tmpPath);
+    }
+    file << formatPrometheusMetrics(devicesMetrics, clientsStats);
+    if (!file.flush()) {
+      throw Exception("Can't write metrics file: " + tmpPath);
+    }
+  }
+  if (std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+    throw Exception("Can't rename " + tmpPath + " to " + path);
+  }
+}
@@ -0,0 +1,23 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) 2025 Ainekko, Co.
+ * SPDX-License-Identifier: Apache-2.0
+ *-------------------------------------------------------------------------*/
+#pragma once
+#include "runtime/IMonitor.h"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace rt {
+
+/// \brief Formats the device metrics and the clients stats in the Prometheus text exposition format. The latencies
+/// are exported in seconds, with the histogram buckets coarsened to a fixed 1-2-5 series from 1us to 10s.
+std::string formatPrometheusMetrics(const std::unordered_map<DeviceId, DeviceMetrics>& devicesMetrics,
+                                    const std::vector<ClientStats>& clientsStats);
+
+/// \brief Writes the formatted metrics to the given path, through a temporary file renamed over it so the readers
+/// (i.e. the node exporter textfile collector) never see a partial file.
+void writePrometheusMetrics(const std::string& path, const std::unordered_map<DeviceId, DeviceMetrics>& devicesMetrics,
+                            const std::vector<ClientStats>& clientsStats);
+} // namespace rt
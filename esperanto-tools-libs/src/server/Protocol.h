@@ -5,8 +5,10 @@
 
 #pragma once
 #include "KernelLaunchOptionsImp.h"
+#include "runtime/IMonitor.h"
 #include "runtime/IProfileEvent.h"
 #include "runtime/Types.h"
+#include <algorithm>
 #include <cereal/cereal.hpp>
 #include <cereal/types/array.hpp>
 #include <cereal/types/optional.hpp>
@@ -41,9 +43,53 @@ template <class Archive> void serialize(Archive& archive, StreamError& se) {
   archive(se.errorCode_, se.cmShireMask_, se.errorContext_);
 }
 
+template <class Archive> void serialize(Archive& archive, ClientStats& cs) {
+  archive(cs.pid_, cs.uid_, cs.weight_, cs.bytesCopied_, cs.kernelLaunches_, cs.inflightCommands_, cs.throttledUs_,
+          cs.shireMask_, cs.deviceMemory_, cs.maxDeviceMemory_, cs.kernelShireUs_);
+}
+
+// the histograms are sent sparse, most of their buckets are empty
+template <class Archive> void save(Archive& archive, const LatencyHistogram& lh) {
+  std::vector<uint32_t> buckets;
+  std::vector<uint64_t> counts;
+  for (size_t i = 0; i < lh.counts_.size(); ++i) {
+    if (lh.counts_[i] != 0) {
+      buckets.emplace_back(static_cast<uint32_t>(i));
+      counts.emplace_back(lh.counts_[i]);
+    }
+  }
+  archive(lh.count_, lh.sum_, lh.min_, lh.max_, buckets, counts);
+}
+
+template <class Archive> void load(Archive& archive, LatencyHistogram& lh) {
+  std::vector<uint32_t> buckets;
+  std::vector<uint64_t> counts;
+  archive(lh.count_, lh.sum_, lh.min_, lh.max_, buckets, counts);
+  lh.counts_.assign(LatencyHistogram::kNumBuckets, 0);
+  for (size_t i = 0; i < std::min(buckets.size(), counts.size()); ++i) {
+    if (buckets[i] < LatencyHistogram::kNumBuckets) {
+      lh.counts_[buckets[i]] = counts[i];
+    }
+  }
+}
+
+template <class Archive> void serialize(Archive& archive, EventTiming& et) {
+  archive(et.device_, et.startCycles_, et.waitCycles_, et.executionCycles_, et.frequencyMhz_);
+}
+
+template <class Archive> void serialize(Archive& archive, DeviceMetrics& dm) {
+  archive(dm.latencies_, dm.bytesHostToDevice_, dm.bytesDeviceToHost_, dm.bytesPerSecondHostToDevice_,
+          dm.bytesPerSecondDeviceToHost_);
+}
+
+template <class Archive> void serialize(Archive& archive, UtilizationSample& us) {
+  archive(us.timestampCycles_, us.intervalCycles_, us.sqPendingBytes_, us.sqInflightCommands_, us.dmaHostToDeviceBusy_,
+          us.dmaDeviceToHostBusy_, us.kernelBusy_, us.busyShireMask_);
+}
+
 namespace Protocol {
 static constexpr int MAJOR = 3;
-static constexpr int MINOR = 3;
+static constexpr int MINOR = 13;
 } // namespace Protocol
 
 namespace req {
@@ -77,6 +123,16 @@ enum class Type : uint32_t {
   MEMCPY_P2P_WRITE,
   ENABLE_TRACING,
   DISABLE_TRACING,
+  FREE_ASYNC,
+  CREATE_PRIORITY_STREAM,
+  SHM_TRANSPORT,
+  ALLOC_HOST_BUFFER,
+  FREE_HOST_BUFFER,
+  BATCH,
+  GET_CLIENT_STATS,
+  GET_DEVICE_METRICS,
+  GET_EVENT_TIMING,
+  GET_DEVICE_UTILIZATION,
 };
 
 using Id = uint32_t;
@@ -170,6 +226,14 @@ struct CreateStream {
   }
 };
 
+struct CreatePriorityStream {
+  DeviceId device_;
+  StreamPriority priority_;
+  template <class Archive> void serialize(Archive& archive) {
+    archive(device_, priority_);
+  }
+};
+
 struct DestroyStream {
   StreamId stream_;
   template <class Archive> void serialize(Archive& archive) {
@@ -209,6 +273,14 @@ struct Free {
   }
 };
 
+struct FreeAsync {
+  StreamId stream_;
+  AddressT address_;
+  template <class Archive> void serialize(Archive& archive) {
+    archive(stream_, address_);
+  }
+};
+
 struct AbortStream {
   StreamId streamId_;
   template <class Archive> void serialize(Archive& archive) {
@@ -216,6 +288,33 @@ struct AbortStream {
   }
 };
 
+// the host buffer memory is a sealed memfd created by the client, passed along through SCM_RIGHTS
+struct AllocHostBuffer {
+  DeviceId device_;
+  AddressT address_; // where the client mapped it
+  size_t size_;
+  template <class Archive> void serialize(Archive& archive) {
+    archive(device_, address_, size_);
+  }
+};
+
+struct FreeHostBuffer {
+  DeviceId device_;
+  AddressT address_;
+  template <class Archive> void serialize(Archive& archive) {
+    archive(device_, address_);
+  }
+};
+
+// several requests sent in a single message, encoded as a shm::Kind::BATCH message. It has no response of its own,
+// each batched request gets its response as if it was sent alone
+struct Batch {
+  std::string data_;
+  template <class Archive> void serialize(Archive& archive) {
+    archive(data_);
+  }
+};
+
 struct AbortCommand {
   EventId eventId_;
   std::chrono::milliseconds timeout_;
@@ -235,7 +334,8 @@ struct Request {
   Type type_;
   Id id_ = INVALID_REQUEST_ID;
   std::variant<std::monostate, UnloadCode, KernelLaunch, Memcpy, MemcpyList, CreateStream, DestroyStream, LoadCode,
-               Malloc, Free, AbortStream, AbortCommand, DeviceId, EventId, MemcpyP2P>
+               Malloc, Free, AbortStream, AbortCommand, DeviceId, EventId, MemcpyP2P, FreeAsync,
+               CreatePriorityStream, AllocHostBuffer, FreeHostBuffer, Batch>
     payload_;
   template <class Archive> void serialize(Archive& archive) {
     archive(type_, id_, payload_);
@@ -277,6 +377,14 @@ enum class Type : uint32_t {
   ENABLE_TRACING,
   DISABLE_TRACING,
   TRACING_EVENT,
+  FREE_ASYNC,
+  SHM_TRANSPORT,
+  ALLOC_HOST_BUFFER,
+  FREE_HOST_BUFFER,
+  GET_CLIENT_STATS,
+  GET_DEVICE_METRICS,
+  GET_EVENT_TIMING,
+  GET_DEVICE_UTILIZATION,
 };
 
 constexpr auto getStr(Type t) {
@@ -316,6 +424,14 @@ constexpr auto getStr(Type t) {
     STR_TYPE(ENABLE_TRACING)
     STR_TYPE(DISABLE_TRACING)
     STR_TYPE(TRACING_EVENT)
+    STR_TYPE(FREE_ASYNC)
+    STR_TYPE(SHM_TRANSPORT)
+    STR_TYPE(ALLOC_HOST_BUFFER)
+    STR_TYPE(FREE_HOST_BUFFER)
+    STR_TYPE(GET_CLIENT_STATS)
+    STR_TYPE(GET_DEVICE_METRICS)
+    STR_TYPE(GET_EVENT_TIMING)
+    STR_TYPE(GET_DEVICE_UTILIZATION)
 
   default:
     return "Unknown type";
@@ -348,6 +464,30 @@ struct AliveEvents {
     archive(aliveEvents_);
   }
 };
+struct ClientsStats {
+  std::vector<ClientStats> clientsStats_;
+  template <class Archive> void serialize(Archive& archive) {
+    archive(clientsStats_);
+  }
+};
+struct EventTiming {
+  std::optional<rt::EventTiming> timing_;
+  template <class Archive> void serialize(Archive& archive) {
+    archive(timing_);
+  }
+};
+struct DevicesMetrics {
+  std::unordered_map<DeviceId, DeviceMetrics> devicesMetrics_;
+  template <class Archive> void serialize(Archive& archive) {
+    archive(devicesMetrics_);
+  }
+};
+struct DevicesUtilization {
+  std::unordered_map<DeviceId, std::vector<UtilizationSample>> devicesUtilization_;
+  template <class Archive> void serialize(Archive& archive) {
+    archive(devicesUtilization_);
+  }
+};
 struct GetDevices {
   std::vector<DeviceId> devices_;
   template <class Archive> void serialize(Archive& archive) {
@@ -456,7 +596,8 @@ struct Response {
 
   using Payload_t = std::variant<std::monostate, Version, Malloc, GetDevices, Event, CreateStream, LoadCode,
                                  StreamError, RuntimeException, DmaInfo, DeviceProperties, KernelAborted, NumClients,
-                                 FreeMemory, WaitingCommands, AliveEvents, P2PCompatibility, profiling::ProfileEvent>;
+                                 FreeMemory, WaitingCommands, AliveEvents, P2PCompatibility, profiling::ProfileEvent,
+                                 ClientsStats, DevicesMetrics, EventTiming, DevicesUtilization>;
   Type type_;
   Id id_ = req::INVALID_REQUEST_ID;
   Payload_t payload_;
@@ -465,4 +606,61 @@ struct Response {
   }
 };
 } // namespace resp
+
+// Once the SHM_TRANSPORT request has been acked (its ring fds are passed along through SCM_RIGHTS), all requests and
+// responses go through a pair of shared memory rings (see ShmRing) instead of the socket, which is only kept to detect
+// the peer going away. The most frequent messages have a fixed layout record; anything else is carried serialized as
+// it would be sent through the socket.
+namespace shm {
+constexpr size_t kRequestRingSize = 1UL << 20;
+// big enough for a stream error carrying all the error contexts
+constexpr size_t kResponseRingSize = 2UL << 20;
+
+enum class Kind : uint32_t {
+  SERIALIZED,    ///< cereal serialized req::Request or resp::Response
+  MEMCPY,        ///< MemcpyRecord request
+  KERNEL_LAUNCH, ///< KernelLaunchRecord request followed by the kernel args
+  EVENT,         ///< EventRecord response
+  BATCH,         ///< sequence of requests, each one a BatchEntryHeader followed by the request encoded as its kind
+};
+
+struct BatchEntryHeader {
+  uint32_t kind_; ///< Kind of the entry, can't be BATCH
+  uint32_t size_; ///< size of the entry following this header
+};
+
+struct MemcpyRecord {
+  req::Type type_; ///< MEMCPY_H2D or MEMCPY_D2H
+  req::Id id_;
+  AddressT src_;
+  AddressT dst_;
+  uint64_t size_;
+  StreamId stream_;
+  uint32_t barrier_;
+};
+
+// only used for launches without user trace nor core dump options
+struct KernelLaunchRecord {
+  req::Id id_;
+  StreamId stream_;
+  KernelId kernel_;
+  uint32_t barrier_;
+  uint32_t flushL3_;
+  uint32_t hasStackConfig_;
+  uint64_t shireMask_;
+  uint64_t stackBaseAddress_;
+  uint64_t stackTotalSize_;
+  uint64_t argsSize_;
+};
+
+// responses whose payload is a resp::Event
+struct EventRecord {
+  resp::Type type_;
+  resp::Id id_;
+  EventId event_;
+};
+
+static_assert(std::is_trivially_copyable_v<MemcpyRecord> && std::is_trivially_copyable_v<KernelLaunchRecord> &&
+              std::is_trivially_copyable_v<EventRecord> && std::is_trivially_copyable_v<BatchEntryHeader>);
+} // namespace shm
 } // namespace rt
@@ -0,0 +1,177 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) 2025 Ainekko, Co.
+ * SPDX-License-Identifier: Apache-2.0
+ *-------------------------------------------------------------------------*/
+
+#include "Scheduler.h"
+#include "Utils.h"
+
+#include "runtime/Types.h"
+
+#include <algorithm>
+
+using namespace rt;
+
+namespace {
+// a kernel launch accounts as this many bytes when sharing the submissions among clients
+constexpr uint64_t kLaunchCost = 1UL << 20;
+// upper bound of each wait, just in case a wake up is missed
+constexpr auto kMaxWaitTime = std::chrono::milliseconds(10);
+} // namespace
+
+Scheduler::TokenBucket::TokenBucket(uint64_t rate, Clock::time_point now)
+  : rate_(static_cast<double>(rate))
+  , tokens_(static_cast<double>(rate))
+  , last_(now) {
+}
+
+double Scheduler::TokenBucket::getTokens(Clock::time_point now) const {
+  auto elapsed = std::chrono::duration<double>(now - last_).count();
+  return std::min(rate_, tokens_ + rate_ * elapsed);
+}
+
+Scheduler::Clock::duration Scheduler::TokenBucket::getWaitTime(uint64_t amount, Clock::time_point now) const {
+  if (rate_ == 0.0) {
+    return Clock::duration::zero();
+  }
+  auto needed = std::min(static_cast<double>(amount), rate_);
+  auto tokens = getTokens(now);
+  if (tokens >= needed) {
+    return Clock::duration::zero();
+  }
+  auto wait = std::chrono::duration<double>((needed - tokens) / rate_);
+  return std::chrono::duration_cast<Clock::duration>(wait) + Clock::duration{1};
+}
+
+void Scheduler::TokenBucket::consume(uint64_t amount, Clock::time_point now) {
+  if (rate_ == 0.0) {
+    return;
+  }
+  tokens_ = getTokens(now) - static_cast<double>(amount);
+  last_ = now;
+}
+
+void Scheduler::registerClient(const Worker* client, const ucred& credentials, const ClientQos& qos) {
+  std::lock_guard lock(mutex_);
+  auto now = Clock::now();
+  auto stats = ClientStats{
+    credentials.pid, credentials.uid, std::max(qos.weight_, 1U), 0, 0, 0, 0, qos.shireMask_, 0, qos.maxDeviceMemory_,
+    0};
+  auto state = ClientState{stats, qos, now};
+  state.finishTag_ = virtualTime_;
+  clients_.insert_or_assign(client, state);
+  RT_VLOG(LOW) << "Scheduler registered client PID: " << credentials.pid << " weight: " << stats.weight_
+               << " max bytes/s: " << qos.maxBytesPerSecond_ << " max launches/s: " << qos.maxLaunchesPerSecond_
+               << " max in-flight: " << qos.maxInflightCommands_ << " shires: 0x" << std::hex << qos.shireMask_
+               << std::dec << " max device memory: " << qos.maxDeviceMemory_;
+}
+
+void Scheduler::unregisterClient(const Worker* client) {
+  std::lock_guard lock(mutex_);
+  if (auto it = clients_.find(client); it != end(clients_)) {
+    inflightCommands_ -= it->second.stats_.inflightCommands_;
+    clients_.erase(it);
+  }
+  cv_.notify_all();
+}
+
+Scheduler::Clock::duration Scheduler::getWaitTime(const ClientState& client, Clock::time_point now) const {
+  if ((maxInflightCommands_ != 0 && inflightCommands_ >= maxInflightCommands_) ||
+      (client.qos_.maxInflightCommands_ != 0 && client.stats_.inflightCommands_ >= client.qos_.maxInflightCommands_)) {
+    return Clock::duration::max();
+  }
+  return std::max(client.bytes_.getWaitTime(client.pendingCost_.bytes_, now),
+                  client.launches_.getWaitTime(client.pendingCost_.launches_, now));
+}
+
+bool Scheduler::isPreceded(const ClientState& client, Clock::time_point now) const {
+  return std::any_of(begin(clients_), end(clients_), [&client, now, this](const auto& it) {
+    const auto& other = it.second;
+    return &other != &client && other.waiting_ && other.startTag_ < client.startTag_ &&
+           getWaitTime(other, now) == Clock::duration::zero();
+  });
+}
+
+void Scheduler::admit(const Worker* client, Cost cost) {
+  std::unique_lock lock(mutex_);
+  auto it = clients_.find(client);
+  if (it == end(clients_)) {
+    throw Exception("Client is not registered in the scheduler");
+  }
+  auto& state = it->second;
+  state.pendingCost_ = cost;
+  state.startTag_ = std::max(virtualTime_, state.finishTag_);
+  state.waiting_ = true;
+
+  auto start = Clock::now();
+  auto now = start;
+  while (getWaitTime(state, now) != Clock::duration::zero() || isPreceded(state, now)) {
+    cv_.wait_for(lock, std::min<Clock::duration>(getWaitTime(state, now), kMaxWaitTime));
+    // state is no longer valid if the client has been unregistered meanwhile
+    if (clients_.find(client) == end(clients_)) {
+      throw Exception("Client disconnected while waiting to be scheduled");
+    }
+    now = Clock::now();
+  }
+
+  state.waiting_ = false;
+  auto units = static_cast<double>(cost.bytes_ + cost.launches_ * kLaunchCost);
+  state.finishTag_ = state.startTag_ + units / state.stats_.weight_;
+  virtualTime_ = state.startTag_;
+  state.bytes_.consume(cost.bytes_, now);
+  state.launches_.consume(cost.launches_, now);
+  state.stats_.bytesCopied_ += cost.bytes_;
+  state.stats_.kernelLaunches_ += cost.launches_;
+  auto throttled = std::chrono::duration_cast<std::chrono::microseconds>(now - start);
+  state.stats_.throttledUs_ += static_cast<uint64_t>(throttled.count());
+  ++state.stats_.inflightCommands_;
+  ++inflightCommands_;
+  // the next waiting client in order may be admitted now
+  cv_.notify_all();
+}
+
+void Scheduler::release(const Worker* client) {
+  std::lock_guard lock(mutex_);
+  if (auto it = clients_.find(client); it != end(clients_) && it->second.stats_.inflightCommands_ > 0) {
+    --it->second.stats_.inflightCommands_;
+    --inflightCommands_;
+  }
+  cv_.notify_all();
+}
+
+void Scheduler::setMaxInflightCommands(uint32_t maxInflightCommands) {
+  std::lock_guard lock(mutex_);
+  maxInflightCommands_ = maxInflightCommands;
+  cv_.notify_all();
+}
+
+ClientQos Scheduler::getQos(const Worker* client) const {
+  std::lock_guard lock(mutex_);
+  if (auto it = clients_.find(client); it != end(clients_)) {
+    return it->second.qos_;
+  }
+  return ClientQos{};
+}
+
+std::vector<ClientStats> Scheduler::getStats() const {
+  std::lock_guard lock(mutex_);
+  auto stats = std::vector<ClientStats>{};
+  for (const auto& it : clients_) {
+    stats.emplace_back(it.second.stats_);
+  }
+  return stats;
+}
+
+void Scheduler::addDeviceMemory(const Worker* client, int64_t bytes) {
+  std::lock_guard lock(mutex_);
+  if (auto it = clients_.find(client); it != end(clients_)) {
+    it->second.stats_.deviceMemory_ += static_cast<uint64_t>(bytes);
+  }
+}
+
+void Scheduler::addKernelShireTime(const Worker* client, uint64_t shireUs) {
+  std::lock_guard lock(mutex_);
+  if (auto it = clients_.find(client); it != end(clients_)) {
+    it->second.stats_.kernelShireUs_ += shireUs;
+  }
+}
@@ -0,0 +1,95 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) 2025 Ainekko, Co.
+ * SPDX-License-Identifier: Apache-2.0
+ *-------------------------------------------------------------------------*/
+#pragma once
+
+#include "Server.h"
+#include "runtime/IMonitor.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <sys/socket.h>
+#include <unordered_map>
+#include <vector>
+
+namespace rt {
+
+/// \brief Admission control of the memcpys and kernel launches of all the server clients. Each Worker asks to be
+/// admitted before submitting a command to the runtime and releases it once the command event is dispatched.
+/// Clients are held back while they exceed their ClientQos rates or in-flight limits; when the server max in-flight
+/// commands is reached the admissions are given in start-time fair queuing order, so each competing client gets a
+/// share proportional to its weight.
+class Scheduler {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  struct Cost {
+    uint64_t bytes_ = 0;
+    uint32_t launches_ = 0;
+  };
+
+  void registerClient(const Worker* client, const ucred& credentials, const ClientQos& qos);
+  // wakes up the client if it was waiting to be admitted, admit will throw
+  void unregisterClient(const Worker* client);
+
+  // blocks till the client can submit a command of the given cost. Throws if the client gets unregistered meanwhile
+  void admit(const Worker* client, Cost cost);
+  // to be called once per admitted command, when it has completed or failed to be submitted
+  void release(const Worker* client);
+
+  void setMaxInflightCommands(uint32_t maxInflightCommands);
+  ClientQos getQos(const Worker* client) const;
+  std::vector<ClientStats> getStats() const;
+
+  // per client utilization reported by the workers, see ClientStats
+  void addDeviceMemory(const Worker* client, int64_t bytes);
+  void addKernelShireTime(const Worker* client, uint64_t shireUs);
+
+private:
+  // rate limiter allowing a burst of one second worth of tokens; a rate of 0 means unlimited
+  struct TokenBucket {
+    TokenBucket(uint64_t rate, Clock::time_point now);
+    double getTokens(Clock::time_point now) const;
+    // time to wait till amount can be consumed; commands bigger than the burst just need the bucket to be full
+    Clock::duration getWaitTime(uint64_t amount, Clock::time_point now) const;
+    // the tokens can go negative when consuming more than the burst
+    void consume(uint64_t amount, Clock::time_point now);
+
+    double rate_;
+    double tokens_;
+    Clock::time_point last_;
+  };
+
+  struct ClientState {
+    ClientState(const ClientStats& stats, const ClientQos& qos, Clock::time_point now)
+      : stats_(stats)
+      , qos_(qos)
+      , bytes_(qos.maxBytesPerSecond_, now)
+      , launches_(qos.maxLaunchesPerSecond_, now) {
+    }
+    ClientStats stats_;
+    ClientQos qos_;
+    TokenBucket bytes_;
+    TokenBucket launches_;
+    double finishTag_ = 0.0; // virtual time at which the last admitted command of the client finishes
+    double startTag_ = 0.0;  // virtual start time of the command waiting to be admitted
+    Cost pendingCost_;
+    bool waiting_ = false;
+  };
+
+  // time the client has to wait before its pending command can be admitted, zero if it can be admitted right now and
+  // Clock::duration::max() if it has to wait for a release
+  Clock::duration getWaitTime(const ClientState& client, Clock::time_point now) const;
+  // true if another waiting client could be admitted right now and goes before the given one
+  bool isPreceded(const ClientState& client, Clock::time_point now) const;
+
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  std::unordered_map<const Worker*, ClientState> clients_;
+  double virtualTime_ = 0.0;
+  uint32_t inflightCommands_ = 0;
+  uint32_t maxInflightCommands_ = 0;
+};
+} // namespace rt
@@ -6,6 +6,7 @@
 
 #include "Constants.h"
 #include "RemoteProfiler.h"
+#include "Scheduler.h"
 #include "Utils.h"
 #include "Worker.h"
 
@@ -17,37 +18,50 @@
 #include <linux/capability.h>
 #include <signal.h>
 #include <sys/capability.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <sys/param.h>
-#include <sys/poll.h>
 #include <sys/socket.h>
 #include <sys/types.h>
 #include <sys/un.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <array>
 #include <mutex>
 
 using namespace rt;
 namespace {
 constexpr auto kSocketNeededSize = static_cast<int>(2 * sizeof(ErrorContext) * kNumErrorContexts);
-}
+constexpr auto kRequestsThreads = 4;
+constexpr auto kMaxEpollEvents = 64;
+} // namespace
 
 Server::~Server() {
   RT_LOG(INFO) << "Destroying server.";
   running_ = false;
-  SpinLock lock(mutex_);
   RT_LOG(INFO) << "Waiting for listener.";
-  close(socket_);
+  if (uint64_t val = 1; write(wakeupFd_, &val, sizeof(val)) < 0) {
+    RT_LOG(WARNING) << "Unable to wake up the listener: " << strerror(errno);
+  }
   listener_.join();
+  SpinLock lock(mutex_);
   RT_LOG(INFO) << "Destroying all existing workers.";
   workers_.clear();
   close(socket_);
+  close(epollFd_);
+  close(wakeupFd_);
   if (auto p = getProfiler(); p != nullptr) {
     p->stop();
   }
 }
 
 Server::Server(const std::string& socketPath, std::shared_ptr<dev::IDeviceLayer> const& deviceLayer, Options options)
-  : deviceLayer_{deviceLayer} {
+  : deviceLayer_{deviceLayer}
+  , requestsPool_{kRequestsThreads, true, false, [] {
+                    EASY_THREAD("Server::requestsPool")
+                    profiling::IProfilerRecorder::setCurrentThreadName("Requests thread");
+                  }} {
 
   cap_t caps;
   std::array<cap_value_t, 1> capList = {CAP_SYS_PTRACE};
@@ -74,6 +88,7 @@ Server::Server(const std::string& socketPath, std::shared_ptr<dev::IDeviceLayer>
   runtime_ = IRuntime::create(deviceLayer_, options);
   auto profiler = std::make_unique<rt::profiling::RemoteProfiler>();
   runtime_->setProfiler(std::move(profiler));
+  scheduler_ = std::make_unique<Scheduler>();
 
   socket_ = socket(AF_UNIX, SOCK_SEQPACKET, 0);
 
@@ -88,6 +103,19 @@ Server::Server(const std::string& socketPath, std::shared_ptr<dev::IDeviceLayer>
   if (::listen(socket_, 10) < 0) {
     RT_LOG(FATAL) << "Listen error: " << strerror(errno);
   }
+  epollFd_ = epoll_create1(EPOLL_CLOEXEC);
+  wakeupFd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  if (epollFd_ < 0 || wakeupFd_ < 0) {
+    RT_LOG(FATAL) << "Unable to create the listener epoll: " << strerror(errno);
+  }
+  for (auto fd : {socket_, wakeupFd_}) {
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    if (epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &event) < 0) {
+      RT_LOG(FATAL) << "Unable to add fd to the listener epoll: " << strerror(errno);
+    }
+  }
   RT_LOG(INFO) << "Listening on socket " << socketPath;
   listener_ = std::thread(&Server::listen, this);
   runtime_->setOnStreamErrorsCallback([this](EventId evt, const StreamError& error) {
@@ -110,48 +138,115 @@ void Server::listen() {
 
   profiling::IProfilerRecorder::setCurrentThreadName("Listener thread");
 
+  std::array<epoll_event, kMaxEpollEvents> events;
   while (running_) {
-    pollfd pfd;
-    pfd.events = POLLIN;
-    pfd.fd = socket_;
-    EASY_BLOCK("Server::listener::poll", profiler::colors::Blue)
-    if (poll(&pfd, 1, 5) == 0) {
-      continue;
-    }
+    EASY_BLOCK("Server::listener::epoll_wait", profiler::colors::Blue)
+    auto numEvents = epoll_wait(epollFd_, events.data(), static_cast<int>(events.size()), -1);
     EASY_END_BLOCK
-    EASY_BLOCK("Server::listener::accept", profiler::colors::Blue)
-    auto cl = accept(socket_, nullptr, nullptr);
-    if (cl < 0) {
-      RT_LOG(WARNING) << "Accept error: " << strerror(errno) << ". Ignoring this client connection.";
+    if (numEvents < 0) {
+      if (errno != EINTR) {
+        RT_LOG(WARNING) << "Epoll wait error: " << strerror(errno);
+      }
       continue;
     }
-    if (auto val = kSocketNeededSize; setsockopt(cl, SOL_SOCKET, SO_SNDBUFFORCE, &val, sizeof(val)) < 0) {
-      RT_LOG(FATAL) << "Unable to set send buffer size to required: " << strerror(errno)
-                    << ". Be sure runtime daemon has CAP_NET_ADMIN capability.";
+    for (auto i = 0; i < numEvents && running_; ++i) {
+      if (auto fd = events[i].data.fd; fd == socket_) {
+        acceptClient();
+      } else if (fd != wakeupFd_) {
+        dispatchClient(fd);
+      }
     }
+  }
+}
 
-    if (auto val = kSocketNeededSize; setsockopt(cl, SOL_SOCKET, SO_RCVBUFFORCE, &val, sizeof(val)) < 0) {
-      RT_LOG(FATAL) << "Unable to set receive buffer size to required: " << strerror(errno)
-                    << ". Be sure runtime daemon has CAP_NET_ADMIN capability.";
-    }
+void Server::acceptClient() {
+  EASY_FUNCTION(profiler::colors::Blue)
+  auto cl = accept4(socket_, nullptr, nullptr, SOCK_CLOEXEC);
+  if (cl < 0) {
+    RT_LOG(WARNING) << "Accept error: " << strerror(errno) << ". Ignoring this client connection.";
+    return;
+  }
+  if (auto val = kSocketNeededSize; setsockopt(cl, SOL_SOCKET, SO_SNDBUFFORCE, &val, sizeof(val)) < 0) {
+    RT_LOG(FATAL) << "Unable to set send buffer size to required: " << strerror(errno)
+                  << ". Be sure runtime daemon has CAP_NET_ADMIN capability.";
+  }
 
-    if (int val = 1; setsockopt(cl, SOL_SOCKET, SO_PASSCRED, &val, sizeof(val)) < 0) {
-      RT_LOG(FATAL) << "Unable to set local passcred: " << strerror(errno)
-                    << ". Be sure runtime daemon has CAP_SYS_PTRACE capability.";
-    }
-    socklen_t len = sizeof(ucred);
-    ucred credentials;
-    if (getsockopt(cl, SOL_SOCKET, SO_PEERCRED, &credentials, &len) == -1) {
-      RT_LOG(FATAL) << "Unable to get peer credentials: " << strerror(errno)
-                    << ". Be sure runtime daemon has CAP_SYS_PTRACE capability.";
-    }
-    RT_LOG(INFO) << " New client connection established from PID: " << credentials.pid << "(UID: " << credentials.uid
-                 << " GID: " << credentials.gid << ").";
+  if (auto val = kSocketNeededSize; setsockopt(cl, SOL_SOCKET, SO_RCVBUFFORCE, &val, sizeof(val)) < 0) {
+    RT_LOG(FATAL) << "Unable to set receive buffer size to required: " << strerror(errno)
+                  << ". Be sure runtime daemon has CAP_NET_ADMIN capability.";
+  }
 
-    // delegate the request processing for this client to a worker
-    SpinLock lock(mutex_);
-    workers_.emplace_back(std::make_unique<Worker>(cl, dynamic_cast<RuntimeImp&>(*runtime_), *this, credentials));
+  if (int val = 1; setsockopt(cl, SOL_SOCKET, SO_PASSCRED, &val, sizeof(val)) < 0) {
+    RT_LOG(FATAL) << "Unable to set local passcred: " << strerror(errno)
+                  << ". Be sure runtime daemon has CAP_SYS_PTRACE capability.";
+  }
+  socklen_t len = sizeof(ucred);
+  ucred credentials;
+  if (getsockopt(cl, SOL_SOCKET, SO_PEERCRED, &credentials, &len) == -1) {
+    RT_LOG(FATAL) << "Unable to get peer credentials: " << strerror(errno)
+                  << ". Be sure runtime daemon has CAP_SYS_PTRACE capability.";
+  }
+  RT_LOG(INFO) << " New client connection established from PID: " << credentials.pid << "(UID: " << credentials.uid
+               << " GID: " << credentials.gid << ").";
+
+  // the requests of this client are processed by its worker, on requestsPool_ each time its socket gets ready
+  SpinLock lock(mutex_);
+  workers_.emplace_back(std::make_unique<Worker>(cl, dynamic_cast<RuntimeImp&>(*runtime_), *this, credentials));
+  epoll_event event{};
+  event.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+  event.data.fd = cl;
+  if (epoll_ctl(epollFd_, EPOLL_CTL_ADD, cl, &event) < 0) {
+    RT_LOG(FATAL) << "Unable to add client socket to the listener epoll: " << strerror(errno);
+  }
+}
+
+void Server::dispatchClient(int socket) {
+  // workers are only destroyed holding mutex_, so the worker can't go away before it's marked as busy
+  SpinLock lock(mutex_);
+  auto it = std::find_if(begin(workers_), end(workers_), [socket](const auto& w) { return w->getSocket() == socket; });
+  if (it != end(workers_)) {
+    (*it)->dispatchRequests(requestsPool_);
+  }
+}
+
+void Server::rearmClient(int socket) {
+  // the socket is one shot, so only one thread at a time processes the requests of a given client
+  epoll_event event{};
+  event.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+  event.data.fd = socket;
+  if (epoll_ctl(epollFd_, EPOLL_CTL_MOD, socket, &event) < 0) {
+    RT_LOG(WARNING) << "Unable to rearm client socket: " << strerror(errno);
+  }
+}
+
+void Server::setDefaultClientQos(const ClientQos& qos) {
+  std::lock_guard lock(qosMutex_);
+  defaultQos_ = qos;
+}
+
+void Server::setClientQos(uid_t uid, const ClientQos& qos) {
+  std::lock_guard lock(qosMutex_);
+  clientsQos_[uid] = qos;
+}
+
+void Server::setMaxInflightCommands(uint32_t maxInflightCommands) {
+  scheduler_->setMaxInflightCommands(maxInflightCommands);
+}
+
+std::unordered_map<DeviceId, DeviceMetrics> Server::getDeviceMetrics() const {
+  return dynamic_cast<const RuntimeImp&>(*runtime_).getDeviceMetrics();
+}
+
+std::vector<ClientStats> Server::getClientStats() const {
+  return scheduler_->getStats();
+}
+
+ClientQos Server::getClientQos(uid_t uid) const {
+  std::lock_guard lock(qosMutex_);
+  if (auto it = clientsQos_.find(uid); it != end(clientsQos_)) {
+    return it->second;
   }
+  return defaultQos_;
 }
 
 void Server::removeWorker(Worker* worker) {
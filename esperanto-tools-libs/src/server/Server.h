@@ -3,6 +3,7 @@
  * SPDX-License-Identifier: Apache-2.0
  *-------------------------------------------------------------------------*/
 #pragma once
+#include "runtime/IMonitor.h"
 #include "runtime/IProfiler.h"
 #include "runtime/IRuntime.h"
 
@@ -10,12 +11,28 @@
 #include <hostUtils/threadPool/ThreadPool.h>
 
 #include <memory>
+#include <mutex>
 #include <string_view>
+#include <sys/types.h>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 
 namespace rt {
 class Worker;
+class Scheduler;
+
+/// \brief Quality of service of the clients of a given user, see Server::setClientQos. Zero limits mean unlimited.
+struct ClientQos {
+  uint32_t weight_ = 1;               ///< share of the submissions when the server max in-flight commands is reached
+  uint64_t maxBytesPerSecond_ = 0;    ///< memcpy bandwidth cap
+  uint32_t maxLaunchesPerSecond_ = 0; ///< kernel launch rate cap
+  uint32_t maxInflightCommands_ = 0;  ///< max memcpys and kernel launches submitted but not yet completed
+  bool allowHighPriority_ = true;     ///< if false, high priority streams requested by the client are normal ones
+  uint64_t shireMask_ = 0;            ///< shires the client kernels run on, its partition of the device
+  uint64_t maxDeviceMemory_ = 0;      ///< device memory the client can have allocated, in bytes per device
+};
+
 class ETRT_API Server {
 public:
   explicit Server(const std::string& socketPath, std::shared_ptr<dev::IDeviceLayer> const& deviceLayer,
@@ -33,16 +50,54 @@ public:
     return workers_.size();
   }
 
+  /// \brief Sets the QoS of the clients which don't have a specific one. Only applies to clients connecting later.
+  void setDefaultClientQos(const ClientQos& qos);
+
+  /// \brief Sets the QoS of the clients owned by the given user. Only applies to clients connecting later.
+  void setClientQos(uid_t uid, const ClientQos& qos);
+
+  /// \brief Limits the memcpys and kernel launches in flight among all clients (0 means unlimited). Once reached,
+  /// each client gets a share of the submissions proportional to its weight.
+  void setMaxInflightCommands(uint32_t maxInflightCommands);
+
+  ClientQos getClientQos(uid_t uid) const;
+
+  Scheduler& getScheduler() {
+    return *scheduler_;
+  }
+
+  /// \brief Returns the latency histograms and transfer counters of each device, see \ref IMonitor::getDeviceMetrics
+  std::unordered_map<DeviceId, DeviceMetrics> getDeviceMetrics() const;
+
+  /// \brief Returns the statistics of each connected client, see \ref IMonitor::getClientStats
+  std::vector<ClientStats> getClientStats() const;
+
+  /// \brief Re-enables the readiness notifications of a client socket once its worker has read all pending requests.
+  void rearmClient(int socket);
+
 private:
+  // single epoll loop accepting the clients and dispatching the ready client sockets to requestsPool_
   void listen();
+  void acceptClient();
+  void dispatchClient(int socket);
 
   int socket_;
+  int epollFd_;
+  int wakeupFd_; // eventfd waking up the listener on destruction
   bool running_ = true;
   std::mutex mutex_;
   std::thread listener_;
   std::shared_ptr<dev::IDeviceLayer> deviceLayer_;
   std::unique_ptr<IRuntime> runtime_;
+  // declared before workers_, they unregister from it when destroyed
+  std::unique_ptr<Scheduler> scheduler_;
   std::vector<std::unique_ptr<Worker>> workers_;
+  mutable std::mutex qosMutex_;
+  ClientQos defaultQos_;
+  std::unordered_map<uid_t, ClientQos> clientsQos_;
   threadPool::ThreadPool tp_{1}; // used to remove workers
+  // decodes and processes the requests of the ready clients; a client waiting to be admitted by the scheduler holds
+  // its thread, so it grows when all of them are busy
+  threadPool::ThreadPool requestsPool_;
 };
 } // namespace rt
@@ -0,0 +1,199 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) 2025 Ainekko, Co.
+ * SPDX-License-Identifier: Apache-2.0
+ *-------------------------------------------------------------------------*/
+
+#include "ShmRing.h"
+#include "runtime/Types.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <string>
+
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+using namespace rt;
+
+namespace {
+// the header gets its own page so the data area is page aligned
+constexpr size_t kHeaderSize = 4096;
+static_assert(sizeof(ShmRing::Header) <= kHeaderSize);
+static_assert(std::atomic<uint32_t>::is_always_lock_free && sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+              "futex words must be plain 32 bit integers");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "ring positions must be lock free to be shared");
+
+struct MessageHeader {
+  uint32_t size_;
+  uint32_t kind_;
+};
+constexpr size_t kAlignment = sizeof(MessageHeader);
+
+constexpr size_t getStride(size_t size) {
+  return sizeof(MessageHeader) + (size + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+// the ring is shared between processes, so futexes can't be process private
+void futexWait(std::atomic<uint32_t>& word, uint32_t expected, std::chrono::nanoseconds timeout) {
+  auto secs = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+  timespec ts{static_cast<time_t>(secs.count()), static_cast<long>((timeout - secs).count())};
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT, expected, &ts, nullptr, 0);
+}
+
+void futexWake(std::atomic<uint32_t>& word) {
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, 1, nullptr, nullptr, 0);
+}
+
+// waits till ready() holds, using the given futex word and waiting flag. Returns false on timeout
+template <typename Ready>
+bool waitFor(std::atomic<uint32_t>& seq, std::atomic<uint32_t>& waiting, std::chrono::milliseconds timeout,
+             Ready&& ready) {
+  auto deadline = std::chrono::steady_clock::now() + timeout;
+  while (!ready()) {
+    auto expected = seq.load();
+    waiting.store(1);
+    // check again once the peer can see we are waiting, otherwise its wake up could be missed
+    if (ready()) {
+      waiting.store(0);
+      return true;
+    }
+    auto remaining = deadline - std::chrono::steady_clock::now();
+    if (remaining <= std::chrono::nanoseconds::zero()) {
+      waiting.store(0);
+      return false;
+    }
+    futexWait(seq, expected, remaining);
+    waiting.store(0);
+  }
+  return true;
+}
+} // namespace
+
+std::unique_ptr<ShmRing> ShmRing::create(size_t capacity) {
+  if (capacity == 0 || (capacity & (capacity - 1)) != 0) {
+    throw Exception("Shared memory ring capacity must be a power of two");
+  }
+  auto fd = memfd_create("etrt-shm-ring", MFD_CLOEXEC);
+  if (fd < 0) {
+    throw Exception(std::string{"Can't create shared memory ring: "} + strerror(errno));
+  }
+  auto mappedSize = kHeaderSize + capacity;
+  if (ftruncate(fd, static_cast<off_t>(mappedSize)) != 0) {
+    auto error = std::string{strerror(errno)};
+    close(fd);
+    throw Exception("Can't resize shared memory ring: " + error);
+  }
+  auto memory = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (memory == MAP_FAILED) {
+    auto error = std::string{strerror(errno)};
+    close(fd);
+    throw Exception("Can't map shared memory ring: " + error);
+  }
+  auto header = new (memory) Header{};
+  header->capacity_ = capacity;
+  return std::unique_ptr<ShmRing>(new ShmRing(fd, memory, mappedSize));
+}
+
+std::unique_ptr<ShmRing> ShmRing::attach(int fd) {
+  struct stat st;
+  if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) <= kHeaderSize) {
+    close(fd);
+    throw Exception("Invalid shared memory ring fd");
+  }
+  auto mappedSize = static_cast<size_t>(st.st_size);
+  auto memory = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (memory == MAP_FAILED) {
+    auto error = std::string{strerror(errno)};
+    close(fd);
+    throw Exception("Can't map shared memory ring: " + error);
+  }
+  // the capacity is read from the header but never trusted beyond the mapped size
+  if (auto capacity = static_cast<Header*>(memory)->capacity_;
+      capacity != mappedSize - kHeaderSize || (capacity & (capacity - 1)) != 0) {
+    munmap(memory, mappedSize);
+    close(fd);
+    throw Exception("Shared memory ring size mismatch");
+  }
+  return std::unique_ptr<ShmRing>(new ShmRing(fd, memory, mappedSize));
+}
+
+ShmRing::ShmRing(int fd, void* memory, size_t mappedSize)
+  : fd_(fd)
+  , memory_(memory)
+  , mappedSize_(mappedSize)
+  , header_(static_cast<Header*>(memory))
+  , data_(static_cast<std::byte*>(memory) + kHeaderSize)
+  , capacity_(mappedSize - kHeaderSize) {
+}
+
+ShmRing::~ShmRing() {
+  munmap(memory_, mappedSize_);
+  close(fd_);
+}
+
+size_t ShmRing::getMaxMessageSize() const {
+  return capacity_ / 2;
+}
+
+void ShmRing::copyIn(uint64_t pos, const void* src, size_t size) {
+  auto offset = pos & (capacity_ - 1);
+  auto first = std::min(size, capacity_ - offset);
+  memcpy(data_ + offset, src, first);
+  memcpy(data_, static_cast<const std::byte*>(src) + first, size - first);
+}
+
+void ShmRing::copyOut(uint64_t pos, void* dst, size_t size) const {
+  auto offset = pos & (capacity_ - 1);
+  auto first = std::min(size, capacity_ - offset);
+  memcpy(dst, data_ + offset, first);
+  memcpy(static_cast<std::byte*>(dst) + first, data_, size - first);
+}
+
+bool ShmRing::push(uint32_t kind, const void* data, size_t size, std::chrono::milliseconds timeout) {
+  if (size > getMaxMessageSize()) {
+    throw Exception("Message of " + std::to_string(size) + " bytes doesn't fit in the shared memory ring. Max size: " +
+                    std::to_string(getMaxMessageSize()));
+  }
+  auto stride = getStride(size);
+  auto tail = header_->tail_.load(std::memory_order_relaxed);
+  if (!waitFor(header_->spaceSeq_, header_->producerWaiting_, timeout,
+               [this, tail, stride] { return capacity_ - (tail - header_->head_.load()) >= stride; })) {
+    return false;
+  }
+  auto messageHeader = MessageHeader{static_cast<uint32_t>(size), kind};
+  copyIn(tail, &messageHeader, sizeof(messageHeader));
+  copyIn(tail + sizeof(messageHeader), data, size);
+  header_->tail_.store(tail + stride);
+  header_->dataSeq_.fetch_add(1);
+  if (header_->consumerWaiting_.load()) {
+    futexWake(header_->dataSeq_);
+  }
+  return true;
+}
+
+bool ShmRing::pop(uint32_t& kind, std::vector<std::byte>& buffer, std::chrono::milliseconds timeout) {
+  auto head = header_->head_.load(std::memory_order_relaxed);
+  if (!waitFor(header_->dataSeq_, header_->consumerWaiting_, timeout,
+               [this, head] { return header_->tail_.load() != head; })) {
+    return false;
+  }
+  MessageHeader messageHeader;
+  copyOut(head, &messageHeader, sizeof(messageHeader));
+  if (messageHeader.size_ > getMaxMessageSize()) {
+    throw Exception("Corrupted shared memory ring message size: " + std::to_string(messageHeader.size_));
+  }
+  buffer.resize(messageHeader.size_);
+  copyOut(head + sizeof(messageHeader), buffer.data(), messageHeader.size_);
+  kind = messageHeader.kind_;
+  header_->head_.store(head + getStride(messageHeader.size_));
+  header_->spaceSeq_.fetch_add(1);
+  if (header_->producerWaiting_.load()) {
+    futexWake(header_->spaceSeq_);
+  }
+  return true;
+}
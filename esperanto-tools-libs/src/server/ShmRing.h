@@ -0,0 +1,73 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) 2025 Ainekko, Co.
+ * SPDX-License-Identifier: Apache-2.0
+ *-------------------------------------------------------------------------*/
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace rt {
+
+/// \brief Single producer, single consumer ring of variable sized messages living in a memfd shared memory region.
+/// The client creates the rings and passes their fds to the server (SCM_RIGHTS), so both processes map the same
+/// memory. Waits are done through futexes on the ring header, there are no syscalls when the peer isn't waiting.
+/// There must be only one thread pushing and one thread popping at any time; callers must serialize them otherwise.
+class ShmRing {
+public:
+  // creates a new ring; capacity must be a power of two
+  static std::unique_ptr<ShmRing> create(size_t capacity);
+  // maps a ring created by the peer process given its fd, which is owned by the ring from now on
+  static std::unique_ptr<ShmRing> attach(int fd);
+
+  ~ShmRing();
+  ShmRing(const ShmRing&) = delete;
+  ShmRing& operator=(const ShmRing&) = delete;
+
+  // fd of the shared memory, to be sent to the peer. It's owned by the ring, valid till the ring is destroyed
+  int getFd() const {
+    return fd_;
+  }
+  size_t getCapacity() const {
+    return capacity_;
+  }
+  // max size of a single message payload
+  size_t getMaxMessageSize() const;
+
+  // pushes a message; waits up to timeout for enough free space. Returns false if it timed out
+  bool push(uint32_t kind, const void* data, size_t size, std::chrono::milliseconds timeout);
+
+  // pops the next message into buffer (resized if needed) and sets its kind; waits up to timeout for a message to be
+  // available. Returns false if it timed out
+  bool pop(uint32_t& kind, std::vector<std::byte>& buffer, std::chrono::milliseconds timeout);
+
+  struct Header {
+    // positions are free running byte counters, each one written by one side only. Kept in their own cache lines
+    alignas(64) std::atomic<uint64_t> head_; // read position, written by the consumer
+    alignas(64) std::atomic<uint64_t> tail_; // write position, written by the producer
+    // futex words, bumped each time a message is pushed/popped
+    alignas(64) std::atomic<uint32_t> dataSeq_;
+    std::atomic<uint32_t> spaceSeq_;
+    std::atomic<uint32_t> consumerWaiting_;
+    std::atomic<uint32_t> producerWaiting_;
+    uint64_t capacity_;
+  };
+
+private:
+  ShmRing(int fd, void* memory, size_t mappedSize);
+
+  void copyIn(uint64_t pos, const void* src, size_t size);
+  void copyOut(uint64_t pos, void* dst, size_t size) const;
+
+  int fd_;
+  void* memory_;
+  size_t mappedSize_;
+  Header* header_;
+  std::byte* data_;
+  size_t capacity_;
+};
+} // namespace rt
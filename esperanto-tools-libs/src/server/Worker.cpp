@@ -11,6 +11,7 @@
 #include "ProfilerImp.h"
 #include "Protocol.h"
 #include "RemoteProfiler.h"
+#include "Scheduler.h"
 #include "ScopedProfileEvent.h"
 #include "Server.h"
 #include "Utils.h"
@@ -19,8 +20,12 @@
 #include <easy/profiler.h>
 #include <g3log/loglevels.hpp>
 
+#include <algorithm>
 #include <cstring>
-#include <sys/poll.h>
+#include <fcntl.h>
+#include <optional>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/uio.h>
 #include <unistd.h>
@@ -34,11 +39,61 @@ struct MemStream : public std::streambuf {
   }
 };
 
+namespace {
+// how long a push to a full response ring waits before checking the worker is still running
+constexpr auto kShmPushTimeout = std::chrono::milliseconds(1000);
+// how long a pop from the request ring waits before checking the worker is still running
+constexpr auto kShmPopTimeout = std::chrono::milliseconds(100);
+constexpr auto kMaxPassedFds = 2;
+constexpr size_t kMaxRequestSize = req::kMaxKernelSize + 4096; // 4096 is for all metadata
+
+// memcpys and kernel launches go through the server scheduler, the rest of the requests are not held back
+std::optional<Scheduler::Cost> getSchedulingCost(const req::Request& request) {
+  switch (request.type_) {
+  case req::Type::MEMCPY_H2D:
+  case req::Type::MEMCPY_D2H:
+    return Scheduler::Cost{std::get<req::Memcpy>(request.payload_).size_, 0};
+  case req::Type::MEMCPY_LIST_H2D:
+  case req::Type::MEMCPY_LIST_D2H: {
+    auto cost = Scheduler::Cost{};
+    for (const auto& op : std::get<req::MemcpyList>(request.payload_).ops_) {
+      cost.bytes_ += op.size_;
+    }
+    return cost;
+  }
+  case req::Type::MEMCPY_P2P_READ:
+  case req::Type::MEMCPY_P2P_WRITE:
+    return Scheduler::Cost{std::get<req::MemcpyP2P>(request.payload_).size_, 0};
+  case req::Type::KERNEL_LAUNCH:
+    return Scheduler::Cost{0, 1};
+  default:
+    return std::nullopt;
+  }
+}
+} // namespace
+
 void Worker::update(EventId event) {
   SpinLock lock(mutex_);
 
   if (events_.erase(event) > 0) {
     RT_DLOG(INFO) << "Dispatched at worker event " << static_cast<int>(event);
+    if (scheduledEvents_.erase(event) > 0) {
+      server_.getScheduler().release(this);
+    }
+    // the runtime timing is overwritten as soon as any client reuses the event id, so keep a copy
+    auto timing = runtime_.getEventTiming(event);
+    if (timing) {
+      dispatchedTimings_[event] = *timing;
+    } else {
+      dispatchedTimings_.erase(event);
+    }
+    if (auto it = kernelShires_.find(event); it != end(kernelShires_)) {
+      if (timing) {
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(timing->toDuration(timing->executionCycles_));
+        server_.getScheduler().addKernelShireTime(this, static_cast<uint64_t>(us.count()) * it->second);
+      }
+      kernelShires_.erase(it);
+    }
     sendResponse({resp::Type::EVENT_DISPATCHED, req::ASYNC_RUNTIME_EVENT, resp::Event{event}});
   }
 }
@@ -47,6 +102,11 @@ void Worker::sendResponse(const resp::Response& resp) {
   EASY_FUNCTION(profiler::colors::Green)
   RT_VLOG(MID) << "Sending response. Type: " << static_cast<uint32_t>(resp.type_) << "(" << resp::getStr(resp.type_)
                << ") Id: " << resp.id_;
+  std::lock_guard lock(sendMutex_);
+  if (responseRing_) {
+    pushResponse(resp);
+    return;
+  }
   EASY_BLOCK("Serialize response")
   std::stringstream response;
   cereal::PortableBinaryOutputArchive archive(response);
@@ -61,10 +121,67 @@ void Worker::sendResponse(const resp::Response& resp) {
   }
 }
 
+void Worker::pushResponse(const resp::Response& resp) {
+  EASY_FUNCTION(profiler::colors::Green)
+  auto append = [this](const void* data, size_t size) {
+    auto ptr = static_cast<const std::byte*>(data);
+    sendBuffer_.insert(end(sendBuffer_), ptr, ptr + size);
+  };
+  sendBuffer_.clear();
+  auto kind = shm::Kind::SERIALIZED;
+  if (auto event = std::get_if<resp::Event>(&resp.payload_); event != nullptr) {
+    auto record = shm::EventRecord{resp.type_, resp.id_, event->event_};
+    append(&record, sizeof(record));
+    kind = shm::Kind::EVENT;
+  } else {
+    EASY_BLOCK("Serialize response")
+    std::stringstream response;
+    cereal::PortableBinaryOutputArchive archive(response);
+    archive(resp);
+    auto str = response.str();
+    append(str.data(), str.size());
+  }
+  while (!responseRing_->push(static_cast<uint32_t>(kind), sendBuffer_.data(), sendBuffer_.size(), kShmPushTimeout)) {
+    if (!running_) {
+      throw NetworkException("Client connection lost while the response ring was full");
+    }
+    RT_LOG(WARNING) << "Shared memory response ring is full, client is not consuming responses. Retrying...";
+  }
+}
+
+ssize_t Worker::readSocket(std::vector<std::byte>& buffer) {
+  iovec iov{buffer.data(), buffer.size()};
+  alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * kMaxPassedFds)];
+  msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+  auto res = recvmsg(socket_, &msg, MSG_CMSG_CLOEXEC | MSG_DONTWAIT);
+  if (res <= 0) {
+    return res;
+  }
+  for (auto cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+    if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+      auto numFds = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+      for (auto i = 0UL; i < numFds; ++i) {
+        int fd;
+        memcpy(&fd, CMSG_DATA(cmsg) + i * sizeof(int), sizeof(int));
+        receivedFds_.emplace_back(fd);
+      }
+    }
+  }
+  RT_LOG_IF(WARNING, msg.msg_flags & MSG_CTRUNC) << "Some fds sent by the client were discarded";
+  return res;
+}
+
 Worker::Worker(int socket, RuntimeImp& runtime, Server& server, ucred credentials)
   : runtime_(runtime)
   , server_(server)
-  , socket_(socket) {
+  , requestBuffer_(kMaxRequestSize)
+  , socket_(socket)
+  , clientPid_(credentials.pid) {
   pid_ = getpid();
 
   runtime_.attach(this);
@@ -89,15 +206,22 @@ Worker::Worker(int socket, RuntimeImp& runtime, Server& server, ucred credential
                       << std::hex << src << " Dst: " << dst << std::string{" error: "} + strerror(errno);
     }
   };
-  runner_ = std::thread(&Worker::requestProcessor, this, credentials.pid);
+  server_.getScheduler().registerClient(this, credentials, server_.getClientQos(credentials.uid));
 }
 
 Worker::~Worker() {
   RT_VLOG(LOW) << "Destroying worker " << this;
   running_ = false;
+  // wakes up the runner if it's waiting to be scheduled
+  server_.getScheduler().unregisterClient(this);
+  std::unique_lock busyLock(busyMutex_);
+  busyCondVar_.wait(busyLock, [this] { return !busy_; });
+  busyLock.unlock();
+  if (ringRunner_.joinable()) {
+    ringRunner_.join();
+  }
   SpinLock lock(mutex_);
   close(socket_);
-  runner_.join();
 
   // Unregister all streams from the Remote Profiler
   auto profiler = getProfiler();
@@ -105,6 +229,7 @@ Worker::~Worker() {
     for (auto stream : streams_) {
       profiler->unassignRemoteWorkerFromStream(stream);
     }
+    profiler->removeWorker(this);
   }
 
   freeResources();
@@ -116,66 +241,59 @@ rt::profiling::RemoteProfiler* Worker::getProfiler() {
   return dynamic_cast<rt::profiling::RemoteProfiler*>(runtime_.getProfiler());
 }
 
-void Worker::requestProcessor(pid_t clientPID) {
-  using namespace std::string_literals;
-  auto threadName = "Server::Worker" + std::to_string(workerId_++);
-  EASY_THREAD_SCOPE(threadName.c_str())
-
-  profiling::IProfilerRecorder::setCurrentThreadName("Worker for client PID " + std::to_string(clientPID));
-
-  constexpr size_t kMaxRequestSize = req::kMaxKernelSize + 4096; // 4096 is for all metadata
-  auto requestBuffer = std::vector<char>(kMaxRequestSize);
+void Worker::dispatchRequests(threadPool::ThreadPool& pool) {
+  std::lock_guard lock(busyMutex_);
+  if (!running_ || busy_) {
+    return;
+  }
+  busy_ = true;
+  pool.pushTask([this] {
+    auto rearm = processSocketRequests();
+    std::lock_guard busyLock(busyMutex_);
+    // rearmed holding the lock, so the listener can't drop a dispatch of the socket while it's still busy
+    if (rearm) {
+      server_.rearmClient(socket_);
+    }
+    busy_ = false;
+    busyCondVar_.notify_all();
+  });
+}
 
+bool Worker::processSocketRequests() {
+  EASY_FUNCTION(profiler::colors::Blue)
   auto profiler = getProfiler();
   if (profiler == nullptr) {
     RT_LOG(FATAL) << "Remote profiler not set";
-    return;
+    return false;
   }
 
   // Associate the current thread to the this Worker object within the RemoteProfiler
   profiler->setThisThreadsWorker(this);
 
+  auto rearm = false;
   try {
     while (running_) {
-      EASY_BLOCK("requestProcessor::loop", profiler::colors::Blue)
       RT_VLOG(MID) << "Reading next request";
-      pollfd pfd;
-      pfd.events = POLLIN;
-      pfd.fd = socket_;
-      EASY_BLOCK("poll")
-      if (poll(&pfd, 1, 5) == 0) {
-        continue;
-      }
-      EASY_END_BLOCK
-
       EASY_BLOCK("read")
-      auto res = read(socket_, requestBuffer.data(), requestBuffer.size());
-      if (res < 0) {
+      auto res = readSocket(requestBuffer_);
+      EASY_END_BLOCK
+      if (res < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        // all pending requests were read, wait for the next ones
+        rearm = true;
+        break;
+      } else if (res < 0) {
         auto msg = std::string{"Read socket error: "} + strerror(errno);
         RT_VLOG(LOW) << msg;
         throw NetworkException(msg);
       } else if (res > 0) {
-        EASY_END_BLOCK
-
-        EASY_BLOCK("decodeRequest")
-        auto ms = MemStream{requestBuffer.data(), static_cast<size_t>(res)};
-        std::istream is(&ms);
-        req::Id id{req::INVALID_REQUEST_ID};
-        try {
-          cereal::PortableBinaryInputArchive archive{is};
-          req::Request request;
-          archive >> request;
-          id = request.id_; // save in case runtime triggers an exception to answer with correct id
-          EASY_END_BLOCK
-
-          processRequest(request);
-        } catch (const Exception& e) {
-          if (running_) {
-            RT_VLOG(LOW) << "Got a runtime exception. Passing that exception to the client.";
-            sendResponse({resp::Type::RUNTIME_EXCEPTION, id, resp::RuntimeException{e}});
-          }
+        std::lock_guard lock(requestsMutex_);
+        processEncodedRequest(shm::Kind::SERIALIZED, requestBuffer_.data(), static_cast<size_t>(res));
+        // fds are only expected along with SHM_TRANSPORT and ALLOC_HOST_BUFFER requests
+        for (auto fd : receivedFds_) {
+          close(fd);
         }
-      } else if (running_) {
+        receivedFds_.clear();
+      } else {
         running_ = false;
         server_.removeWorker(this);
       }
@@ -185,6 +303,250 @@ void Worker::requestProcessor(pid_t clientPID) {
   }
 
   profiler->releaseThisThreadsWorker();
+  return rearm;
+}
+
+void Worker::processRingRequests() {
+  auto threadName = "Server::ShmWorker for client PID " + std::to_string(clientPid_);
+  EASY_THREAD_SCOPE(threadName.c_str())
+
+  profiling::IProfilerRecorder::setCurrentThreadName("Shared memory worker for client PID " +
+                                                     std::to_string(clientPid_));
+  auto profiler = getProfiler();
+  if (profiler == nullptr) {
+    RT_LOG(FATAL) << "Remote profiler not set";
+    return;
+  }
+  profiler->setThisThreadsWorker(this);
+
+  auto ringBuffer = std::vector<std::byte>{};
+  try {
+    while (running_) {
+      if (uint32_t kind; requestRing_->pop(kind, ringBuffer, kShmPopTimeout)) {
+        std::lock_guard lock(requestsMutex_);
+        processEncodedRequest(static_cast<shm::Kind>(kind), ringBuffer.data(), ringBuffer.size());
+      }
+    }
+  } catch (const NetworkException& e) {
+    RT_VLOG(LOW) << "Got a network exception. " << e.what();
+  }
+
+  profiler->releaseThisThreadsWorker();
+}
+
+void Worker::processEncodedRequest(shm::Kind kind, const std::byte* data, size_t size) {
+  EASY_BLOCK("decodeRequest")
+  req::Id id{req::INVALID_REQUEST_ID};
+  try {
+    if (kind == shm::Kind::BATCH) {
+      EASY_END_BLOCK
+      processBatch(data, size);
+      return;
+    }
+    auto request = decodeRequest(kind, data, size);
+    id = request.id_; // save in case runtime triggers an exception to answer with correct id
+    EASY_END_BLOCK
+
+    std::optional<AdmissionGuard> admission;
+    if (auto cost = getSchedulingCost(request); cost) {
+      EASY_BLOCK("Scheduler::admit")
+      server_.getScheduler().admit(this, *cost);
+      admission.emplace(*this);
+    }
+    processRequest(request);
+  } catch (const Exception& e) {
+    if (running_) {
+      RT_VLOG(LOW) << "Got a runtime exception. Passing that exception to the client.";
+      sendResponse({resp::Type::RUNTIME_EXCEPTION, id, resp::RuntimeException{e}});
+    }
+  }
+}
+
+Worker::AdmissionGuard::AdmissionGuard(Worker& worker)
+  : worker_(worker)
+  , previous_(worker.admission_) {
+  worker_.admission_ = this;
+}
+
+Worker::AdmissionGuard::~AdmissionGuard() {
+  worker_.admission_ = previous_;
+  if (!dismissed_) {
+    worker_.server_.getScheduler().release(&worker_);
+  }
+}
+
+void Worker::addScheduledEvent(EventId event) {
+  if (admission_ != nullptr) {
+    scheduledEvents_.emplace(event);
+    admission_->dismiss();
+  }
+}
+
+req::Request Worker::decodeRequest(shm::Kind kind, const std::byte* data, size_t size) const {
+  switch (kind) {
+  case shm::Kind::MEMCPY: {
+    shm::MemcpyRecord record;
+    if (size != sizeof(record)) {
+      throw Exception("Invalid shared memory memcpy request size: " + std::to_string(size));
+    }
+    memcpy(&record, data, sizeof(record));
+    return {record.type_, record.id_,
+            req::Memcpy{record.stream_, record.src_, record.dst_, record.size_, record.barrier_ != 0}};
+  }
+  case shm::Kind::KERNEL_LAUNCH: {
+    shm::KernelLaunchRecord record;
+    if (size < sizeof(record)) {
+      throw Exception("Invalid shared memory kernel launch request size: " + std::to_string(size));
+    }
+    memcpy(&record, data, sizeof(record));
+    if (record.argsSize_ != size - sizeof(record)) {
+      throw Exception("Invalid shared memory kernel launch args size: " + std::to_string(record.argsSize_));
+    }
+    KernelLaunchOptionsImp options;
+    options.shireMask_ = record.shireMask_;
+    options.barrier_ = record.barrier_ != 0;
+    options.flushL3_ = record.flushL3_ != 0;
+    if (record.hasStackConfig_ != 0) {
+      options.stackConfig_ = StackConfiguration{record.stackBaseAddress_, record.stackTotalSize_};
+    }
+    auto args = std::vector<std::byte>(data + sizeof(record), data + size);
+    return {req::Type::KERNEL_LAUNCH, record.id_,
+            req::KernelLaunch{record.stream_, record.kernel_, std::move(args), std::move(options)}};
+  }
+  case shm::Kind::SERIALIZED: {
+    auto ms = MemStream{const_cast<char*>(reinterpret_cast<const char*>(data)), size};
+    std::istream is(&ms);
+    cereal::PortableBinaryInputArchive archive{is};
+    req::Request request;
+    archive >> request;
+    return request;
+  }
+  default:
+    throw Exception("Unexpected shared memory request kind: " + std::to_string(static_cast<uint32_t>(kind)));
+  }
+}
+
+void Worker::processBatch(const std::byte* data, size_t size) {
+  EASY_FUNCTION(profiler::colors::LightGreen)
+  while (size > 0) {
+    shm::BatchEntryHeader header;
+    if (size < sizeof(header)) {
+      throw Exception("Truncated request batch");
+    }
+    memcpy(&header, data, sizeof(header));
+    data += sizeof(header);
+    size -= sizeof(header);
+    if (header.size_ > size || static_cast<shm::Kind>(header.kind_) == shm::Kind::BATCH) {
+      throw Exception("Invalid request batch entry");
+    }
+    // each request answers its own errors, the following ones are still processed
+    processEncodedRequest(static_cast<shm::Kind>(header.kind_), data, header.size_);
+    data += header.size_;
+    size -= header.size_;
+  }
+}
+
+void Worker::setupShmTransport(const req::Request& request) {
+  if (requestRing_) {
+    throw Exception("Shared memory transport already set up");
+  }
+  if (receivedFds_.size() != 2) {
+    throw Exception("Shared memory transport request needs the request and response ring fds");
+  }
+  auto fds = std::move(receivedFds_);
+  receivedFds_.clear();
+  auto requestFd = fds[0];
+  auto responseFd = fds[1];
+  std::unique_ptr<ShmRing> responseRing;
+  try {
+    requestRing_ = ShmRing::attach(requestFd);
+  } catch (...) {
+    close(responseFd);
+    throw;
+  }
+  try {
+    responseRing = ShmRing::attach(responseFd);
+  } catch (...) {
+    requestRing_.reset();
+    throw;
+  }
+  // the ack still goes through the socket; the client won't push any request to the ring before getting it
+  sendResponse({resp::Type::SHM_TRANSPORT, request.id_, std::monostate{}});
+  std::lock_guard lock(sendMutex_);
+  responseRing_ = std::move(responseRing);
+  ringRunner_ = std::thread(&Worker::processRingRequests, this);
+  RT_VLOG(LOW) << "Worker " << this << " switched to shared memory transport";
+}
+
+void Worker::allocHostBuffer(const req::Request& request) {
+  auto& req = std::get<req::AllocHostBuffer>(request.payload_);
+  if (receivedFds_.size() != 1) {
+    throw Exception("Host buffer request needs the host buffer fd");
+  }
+  auto fd = receivedFds_.front();
+  receivedFds_.clear();
+  // the memory must be sealed, otherwise the client could shrink it under the worker mapping
+  struct stat st;
+  auto seals = fcntl(fd, F_GET_SEALS);
+  if (seals < 0 || (seals & (F_SEAL_SHRINK | F_SEAL_SEAL)) != (F_SEAL_SHRINK | F_SEAL_SEAL) || fstat(fd, &st) != 0 ||
+      static_cast<size_t>(st.st_size) != req.size_ || req.size_ == 0) {
+    close(fd);
+    throw Exception("Invalid host buffer fd");
+  }
+  if (auto it = sharedHostBuffers_.lower_bound(req.address_);
+      (it != end(sharedHostBuffers_) && it->first - req.address_ < req.size_) ||
+      (it != begin(sharedHostBuffers_) && req.address_ - std::prev(it)->first < std::prev(it)->second.size_)) {
+    close(fd);
+    throw Exception("Host buffer overlaps with an already shared host buffer");
+  }
+  auto memory = mmap(nullptr, req.size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (memory == MAP_FAILED) {
+    throw Exception(std::string{"Can't map host buffer: "} + strerror(errno));
+  }
+  auto ptr = static_cast<std::byte*>(memory);
+  try {
+    runtime_.registerHostBuffer(req.device_, ptr, req.size_);
+  } catch (...) {
+    munmap(memory, req.size_);
+    throw;
+  }
+  sharedHostBuffers_.emplace(req.address_, SharedHostBuffer{req.device_, ptr, req.size_});
+  RT_VLOG(LOW) << "Worker " << this << " mapped client host buffer " << std::hex << req.address_ << " at " << ptr
+               << std::dec << " size: " << req.size_;
+  sendResponse({resp::Type::ALLOC_HOST_BUFFER, request.id_, std::monostate{}});
+}
+
+std::byte* Worker::findSharedHostBuffer(AddressT address, size_t size) const {
+  auto it = sharedHostBuffers_.upper_bound(address);
+  if (it == begin(sharedHostBuffers_)) {
+    return nullptr;
+  }
+  --it;
+  auto offset = address - it->first;
+  if (offset > it->second.size_ || size > it->second.size_ - offset) {
+    return nullptr;
+  }
+  return it->second.ptr_ + offset;
+}
+
+bool Worker::translateSharedHostBuffers(MemcpyList& list, MemcpyType type) const {
+  if (sharedHostBuffers_.empty()) {
+    return false;
+  }
+  auto translated = std::vector<std::byte*>{};
+  for (const auto& op : list.operations_) {
+    auto hostAddr = reinterpret_cast<AddressT>(type == MemcpyType::H2D ? op.src_ : op.dst_);
+    auto ptr = findSharedHostBuffer(hostAddr, op.size_);
+    if (ptr == nullptr) {
+      return false;
+    }
+    translated.emplace_back(ptr);
+  }
+  for (auto i = 0UL; i < translated.size(); ++i) {
+    (type == MemcpyType::H2D ? list.operations_[i].src_ : list.operations_[i].dst_) = translated[i];
+  }
+  return true;
 }
 
 void Worker::processRequest(const req::Request& request) {
@@ -200,8 +562,9 @@ void Worker::processRequest(const req::Request& request) {
 
   case req::Type::MALLOC: {
     auto& req = std::get<req::Malloc>(request.payload_);
+    checkDeviceMemoryQuota(req.device_, req.size_);
     auto ptr = runtime_.mallocDevice(req.device_, req.size_, req.alignment_);
-    allocations_.insert(Allocation{req.device_, ptr});
+    addAllocation(req.device_, ptr, req.size_);
     sendResponse({resp::Type::MALLOC, request.id_, resp::Malloc{reinterpret_cast<AddressT>(ptr)}});
     break;
   }
@@ -209,21 +572,44 @@ void Worker::processRequest(const req::Request& request) {
   case req::Type::FREE: {
     auto& req = std::get<req::Free>(request.payload_);
     auto addr = reinterpret_cast<std::byte*>(req.address_);
-    if (allocations_.erase(Allocation{req.device_, addr}) != 1) {
+    auto it = allocations_.find(Allocation{req.device_, addr});
+    if (it == end(allocations_)) {
       RT_LOG(WARNING) << "Trying to deallocate a non previous allocated buffer.";
       throw Exception("Trying to deallocate a non previous allocated buffer.");
     }
+    removeAllocation(it);
     runtime_.freeDevice(DeviceId{req.device_}, addr);
     sendResponse({resp::Type::FREE, request.id_, std::monostate{}});
     break;
   }
 
+  case req::Type::FREE_ASYNC: {
+    auto& req = std::get<req::FreeAsync>(request.payload_);
+    auto addr = reinterpret_cast<std::byte*>(req.address_);
+    auto it = std::find_if(begin(allocations_), end(allocations_), [addr](const auto& a) { return a.ptr_ == addr; });
+    if (it == end(allocations_)) {
+      RT_LOG(WARNING) << "Trying to deallocate a non previous allocated buffer.";
+      throw Exception("Trying to deallocate a non previous allocated buffer.");
+    }
+    runtime_.freeDeviceAsync(req.stream_, addr);
+    removeAllocation(it);
+    sendResponse({resp::Type::FREE_ASYNC, request.id_, std::monostate{}});
+    break;
+  }
+
   case req::Type::MEMCPY_H2D: {
     auto& req = std::get<req::Memcpy>(request.payload_);
-    auto src = reinterpret_cast<std::byte*>(req.src_);
     auto dst = reinterpret_cast<std::byte*>(req.dst_);
-    auto evt = runtime_.memcpyHostToDevice(req.stream_, src, dst, req.size_, req.barrier_, cmaCopyFunction_);
+    EventId evt;
+    // memory shared by the client is accessed directly, without copying it across processes
+    if (auto src = findSharedHostBuffer(req.src_, req.size_); src != nullptr) {
+      evt = runtime_.memcpyHostToDevice(req.stream_, src, dst, req.size_, req.barrier_);
+    } else {
+      auto remoteSrc = reinterpret_cast<std::byte*>(req.src_);
+      evt = runtime_.memcpyHostToDevice(req.stream_, remoteSrc, dst, req.size_, req.barrier_, cmaCopyFunction_);
+    }
     events_.emplace(evt);
+    addScheduledEvent(evt);
     sendResponse({resp::Type::MEMCPY_H2D, request.id_, resp::Event{evt}});
     break;
   }
@@ -231,25 +617,39 @@ void Worker::processRequest(const req::Request& request) {
   case req::Type::MEMCPY_D2H: {
     auto& req = std::get<req::Memcpy>(request.payload_);
     auto src = reinterpret_cast<std::byte*>(req.src_);
-    auto dst = reinterpret_cast<std::byte*>(req.dst_);
-    auto evt = runtime_.memcpyDeviceToHost(req.stream_, src, dst, req.size_, req.barrier_, cmaCopyFunction_);
+    EventId evt;
+    if (auto dst = findSharedHostBuffer(req.dst_, req.size_); dst != nullptr) {
+      evt = runtime_.memcpyDeviceToHost(req.stream_, src, dst, req.size_, req.barrier_);
+    } else {
+      auto remoteDst = reinterpret_cast<std::byte*>(req.dst_);
+      evt = runtime_.memcpyDeviceToHost(req.stream_, src, remoteDst, req.size_, req.barrier_, cmaCopyFunction_);
+    }
     events_.emplace(evt);
+    addScheduledEvent(evt);
     sendResponse({resp::Type::MEMCPY_D2H, request.id_, resp::Event{evt}});
     break;
   }
 
   case req::Type::MEMCPY_LIST_H2D: {
     auto& req = std::get<req::MemcpyList>(request.payload_);
-    auto evt = runtime_.memcpyHostToDevice(req.stream_, MemcpyList(req), req.barrier_, cmaCopyFunction_);
+    auto list = MemcpyList(req);
+    auto evt = translateSharedHostBuffers(list, MemcpyType::H2D)
+                 ? runtime_.memcpyHostToDevice(req.stream_, std::move(list), req.barrier_)
+                 : runtime_.memcpyHostToDevice(req.stream_, std::move(list), req.barrier_, cmaCopyFunction_);
     events_.emplace(evt);
+    addScheduledEvent(evt);
     sendResponse({resp::Type::MEMCPY_LIST_H2D, request.id_, resp::Event{evt}});
     break;
   }
 
   case req::Type::MEMCPY_LIST_D2H: {
     auto& req = std::get<req::MemcpyList>(request.payload_);
-    auto evt = runtime_.memcpyDeviceToHost(req.stream_, MemcpyList(req), req.barrier_, cmaCopyFunction_);
+    auto list = MemcpyList(req);
+    auto evt = translateSharedHostBuffers(list, MemcpyType::D2H)
+                 ? runtime_.memcpyDeviceToHost(req.stream_, std::move(list), req.barrier_)
+                 : runtime_.memcpyDeviceToHost(req.stream_, std::move(list), req.barrier_, cmaCopyFunction_);
     events_.emplace(evt);
+    addScheduledEvent(evt);
     sendResponse({resp::Type::MEMCPY_LIST_D2H, request.id_, resp::Event{evt}});
     break;
   }
@@ -264,6 +664,22 @@ void Worker::processRequest(const req::Request& request) {
     break;
   }
 
+  case req::Type::CREATE_PRIORITY_STREAM: {
+    auto& req = std::get<req::CreatePriorityStream>(request.payload_);
+    auto priority = req.priority_;
+    // the high priority submission queue is reserved to the clients allowed by their QoS
+    if (priority == StreamPriority::High && !server_.getScheduler().getQos(this).allowHighPriority_) {
+      RT_LOG(WARNING) << "Client not allowed to use high priority streams, creating a normal priority stream instead.";
+      priority = StreamPriority::Normal;
+    }
+    auto st = runtime_.createStream(req.device_, priority);
+    auto profiler = getProfiler();
+    profiler->assignRemoteWorkerToStream(st);
+    streams_.insert(st);
+    sendResponse({resp::Type::CREATE_STREAM, request.id_, resp::CreateStream{st}});
+    break;
+  }
+
   case req::Type::DESTROY_STREAM: {
     auto& req = std::get<req::DestroyStream>(request.payload_);
     auto st = req.stream_;
@@ -312,11 +728,24 @@ void Worker::processRequest(const req::Request& request) {
   case req::Type::KERNEL_LAUNCH: {
     auto& req = std::get<req::KernelLaunch>(request.payload_);
 
-    KernelLaunchOptions kernelLaunchOptions = runtime_.createKernelLaunchOptions(req.kernelOptionsImp_);
+    // kernels of a client with a partition only run on its shires. Masks covering the whole partition (i.e. the
+    // default all shires one) are narrowed to it, the others must be within it
+    auto options = req.kernelOptionsImp_;
+    auto partition = server_.getScheduler().getQos(this).shireMask_;
+    if (partition != 0) {
+      options.shirePartition_ = partition;
+      if ((options.shireMask_ & partition) == partition) {
+        options.shireMask_ = partition;
+      }
+    }
+    KernelLaunchOptions kernelLaunchOptions = runtime_.createKernelLaunchOptions(options);
 
     auto evt = runtime_.kernelLaunch(req.stream_, req.kernel_, req.kernelArgs_.data(), req.kernelArgs_.size(),
                                      kernelLaunchOptions);
     events_.emplace(evt);
+    addScheduledEvent(evt);
+    kernelShires_[evt] = options.shireCount_ > 0 ? static_cast<uint32_t>(options.shireCount_)
+                                                  : static_cast<uint32_t>(__builtin_popcountll(options.shireMask_));
 
     RT_DLOG(INFO) << "Registered at worker event " << static_cast<int>(evt);
     sendResponse({resp::Type::KERNEL_LAUNCH, request.id_, resp::Event{evt}});
@@ -337,6 +766,16 @@ void Worker::processRequest(const req::Request& request) {
     break;
   }
 
+  case req::Type::GET_EVENT_TIMING: {
+    auto event = std::get<EventId>(request.payload_);
+    std::optional<EventTiming> timing;
+    if (auto it = dispatchedTimings_.find(event); it != end(dispatchedTimings_)) {
+      timing = it->second;
+    }
+    sendResponse({resp::Type::GET_EVENT_TIMING, request.id_, resp::EventTiming{timing}});
+    break;
+  }
+
   case req::Type::ABORT_STREAM: {
     auto& req = std::get<req::AbortStream>(request.payload_);
     auto evt = runtime_.abortStream(req.streamId_);
@@ -392,6 +831,22 @@ void Worker::processRequest(const req::Request& request) {
     break;
   }
 
+  case req::Type::GET_CLIENT_STATS: {
+    sendResponse({resp::Type::GET_CLIENT_STATS, request.id_, resp::ClientsStats{server_.getScheduler().getStats()}});
+    break;
+  }
+
+  case req::Type::GET_DEVICE_METRICS: {
+    sendResponse({resp::Type::GET_DEVICE_METRICS, request.id_, resp::DevicesMetrics{runtime_.getDeviceMetrics()}});
+    break;
+  }
+
+  case req::Type::GET_DEVICE_UTILIZATION: {
+    sendResponse({resp::Type::GET_DEVICE_UTILIZATION, request.id_,
+                  resp::DevicesUtilization{runtime_.getDeviceUtilization()}});
+    break;
+  }
+
   case req::Type::GET_P2P_COMPATIBILITY: {
     resp::P2PCompatibility result;
 
@@ -415,6 +870,7 @@ void Worker::processRequest(const req::Request& request) {
     auto dst = reinterpret_cast<std::byte*>(req.dst_);
     auto evt = runtime_.memcpyDeviceToDevice(req.stream_, req.device_, src, dst, req.size_, req.barrier_);
     events_.emplace(evt);
+    addScheduledEvent(evt);
     sendResponse({resp::Type::MEMCPY_P2P_WRITE, request.id_, resp::Event{evt}});
     break;
   }
@@ -425,6 +881,7 @@ void Worker::processRequest(const req::Request& request) {
     auto dst = reinterpret_cast<std::byte*>(req.dst_);
     auto evt = runtime_.memcpyDeviceToDevice(req.device_, req.stream_, src, dst, req.size_, req.barrier_);
     events_.emplace(evt);
+    addScheduledEvent(evt);
     sendResponse({resp::Type::MEMCPY_P2P_READ, request.id_, resp::Event{evt}});
     break;
   }
@@ -444,6 +901,35 @@ void Worker::processRequest(const req::Request& request) {
     break;
   }
 
+  case req::Type::SHM_TRANSPORT: {
+    setupShmTransport(request);
+    break;
+  }
+
+  case req::Type::BATCH: {
+    auto& batch = std::get<req::Batch>(request.payload_);
+    processBatch(reinterpret_cast<const std::byte*>(batch.data_.data()), batch.data_.size());
+    break;
+  }
+
+  case req::Type::ALLOC_HOST_BUFFER: {
+    allocHostBuffer(request);
+    break;
+  }
+
+  case req::Type::FREE_HOST_BUFFER: {
+    auto& req = std::get<req::FreeHostBuffer>(request.payload_);
+    auto it = sharedHostBuffers_.find(req.address_);
+    if (it == end(sharedHostBuffers_) || it->second.device_ != req.device_) {
+      throw Exception("Host buffer was not shared with the server");
+    }
+    runtime_.unregisterHostBuffer(it->second.device_, it->second.ptr_);
+    munmap(it->second.ptr_, it->second.size_);
+    sharedHostBuffers_.erase(it);
+    sendResponse({resp::Type::FREE_HOST_BUFFER, request.id_, std::monostate{}});
+    break;
+  }
+
   case req::Type::DISABLE_TRACING: {
     auto profiler = getProfiler();
     if (profiler != nullptr) {
@@ -465,6 +951,7 @@ void Worker::freeResources() {
     runtime_.freeDevice(alloc.device_, alloc.ptr_);
   }
   allocations_.clear();
+  allocatedBytes_.clear();
 
   for (auto st : streams_) {
     runtime_.destroyStream(st);
@@ -483,6 +970,33 @@ void Worker::freeResources() {
     }
   }
   kernelAbortedFreeResources_.clear();
+
+  for (const auto& it : sharedHostBuffers_) {
+    runtime_.unregisterHostBuffer(it.second.device_, it.second.ptr_);
+    munmap(it.second.ptr_, it.second.size_);
+  }
+  sharedHostBuffers_.clear();
+}
+
+void Worker::checkDeviceMemoryQuota(DeviceId device, size_t size) {
+  auto quota = server_.getScheduler().getQos(this).maxDeviceMemory_;
+  auto allocated = allocatedBytes_[device];
+  if (quota != 0 && allocated + size > quota) {
+    throw Exception("Device memory quota exceeded: " + std::to_string(allocated) + " bytes allocated, " +
+                    std::to_string(size) + " requested, the quota is " + std::to_string(quota));
+  }
+}
+
+void Worker::addAllocation(DeviceId device, std::byte* ptr, size_t size) {
+  allocations_.insert(Allocation{device, ptr, size});
+  allocatedBytes_[device] += size;
+  server_.getScheduler().addDeviceMemory(this, static_cast<int64_t>(size));
+}
+
+void Worker::removeAllocation(std::set<Allocation>::iterator it) {
+  allocatedBytes_[it->device_] -= it->size_;
+  server_.getScheduler().addDeviceMemory(this, -static_cast<int64_t>(it->size_));
+  allocations_.erase(it);
 }
 
 void Worker::onStreamError(EventId event, const StreamError& error) {
@@ -5,12 +5,19 @@
 #pragma once
 #include "Protocol.h"
 #include "RuntimeImp.h"
+#include "ShmRing.h"
 #include "runtime/Types.h"
 #include "server/Protocol.h"
 
+#include <hostUtils/threadPool/ThreadPool.h>
+
+#include <condition_variable>
+#include <map>
+#include <optional>
 #include <set>
 #include <sys/socket.h>
 #include <thread>
+#include <unordered_map>
 
 namespace rt {
 
@@ -37,38 +44,128 @@ public:
     sendResponse(response);
   }
 
+  int getSocket() const {
+    return socket_;
+  }
+
+  // processes the requests pending in the socket on the given pool; called by the server listener once the socket is
+  // ready, which keeps it disarmed till the worker has read all of them
+  void dispatchRequests(threadPool::ThreadPool& pool);
+
 private:
-  void requestProcessor(pid_t clientPID);
+  // reads and processes the requests pending in the socket; returns true if the socket has to be rearmed
+  bool processSocketRequests();
+  // consumer of the shared memory request ring, waiting on its futex
+  void processRingRequests();
   void freeResources();
+  // decodes and processes a request, sending back any runtime exception to the client
+  void processEncodedRequest(shm::Kind kind, const std::byte* data, size_t size);
+  req::Request decodeRequest(shm::Kind kind, const std::byte* data, size_t size) const;
+  // processes each request of a shm::Kind::BATCH message
+  void processBatch(const std::byte* data, size_t size);
   void processRequest(const req::Request& request);
+  // records the event of the request being processed if it was admitted by the server scheduler, the admission is
+  // then released once the event is dispatched
+  void addScheduledEvent(EventId event);
+  void setupShmTransport(const req::Request& request);
+  void allocHostBuffer(const req::Request& request);
+
+  // returns the worker address of a range fully contained in a host buffer shared by the client, nullptr otherwise
+  std::byte* findSharedHostBuffer(AddressT address, size_t size) const;
+  // replaces the list host addresses by their worker addresses if all of them are in host buffers shared by the client.
+  // Returns false and leaves the list untouched otherwise
+  bool translateSharedHostBuffers(MemcpyList& list, MemcpyType type) const;
+
+  // reads a message from the socket; any fd passed along is appended to receivedFds_
+  ssize_t readSocket(std::vector<std::byte>& buffer);
 
   void sendResponse(const resp::Response& response);
+  // must be called with sendMutex_ held
+  void pushResponse(const resp::Response& response);
 
   rt::profiling::RemoteProfiler* getProfiler();
 
   struct Allocation {
     DeviceId device_;
     std::byte* ptr_;
+    size_t size_ = 0; // not part of the ordering
     bool operator<(const Allocation& other) const {
       return device_ < other.device_ || (device_ == other.device_ && ptr_ < other.ptr_);
     }
   };
 
-  inline static std::atomic<size_t> workerId_{0};
+  struct SharedHostBuffer {
+    DeviceId device_;
+    std::byte* ptr_; // where the worker mapped it
+    size_t size_;
+  };
+
+  // scheduler admission of the request being processed. Released on destruction unless its event was recorded through
+  // addScheduledEvent, so requests failing for any reason before that don't keep it
+  class AdmissionGuard {
+  public:
+    explicit AdmissionGuard(Worker& worker);
+    ~AdmissionGuard();
+    AdmissionGuard(const AdmissionGuard&) = delete;
+    AdmissionGuard& operator=(const AdmissionGuard&) = delete;
+
+    void dismiss() {
+      dismissed_ = true;
+    }
+
+  private:
+    Worker& worker_;
+    AdmissionGuard* previous_; // batches nest the processing of their requests
+    bool dismissed_ = false;
+  };
+
+  // throws if allocating size more bytes would go over the device memory quota of the client
+  void checkDeviceMemoryQuota(DeviceId device, size_t size);
+  void addAllocation(DeviceId device, std::byte* ptr, size_t size);
+  void removeAllocation(std::set<Allocation>::iterator it);
 
   RuntimeImp& runtime_;
   CmaCopyFunction cmaCopyFunction_;
   std::unordered_map<EventId, std::function<void()>> kernelAbortedFreeResources_;
   std::set<Allocation> allocations_;
+  // bytes of allocations_ in each device, limited by ClientQos::maxDeviceMemory_
+  std::unordered_map<DeviceId, uint64_t> allocatedBytes_;
+  // shires of the kernel launches not yet dispatched, to account their execution time to the client
+  std::unordered_map<EventId, uint32_t> kernelShires_;
   std::set<StreamId> streams_;
   std::set<KernelId> kernels_;
   std::set<EventId> events_;
-  std::thread runner_;
+  // events of the commands admitted by the server scheduler, released once dispatched
+  std::set<EventId> scheduledEvents_;
+  // admission of the request being processed, if any
+  AdmissionGuard* admission_ = nullptr;
+  // device timing of the dispatched events, see IRuntime::getEventTiming. Kept till the event is dispatched again
+  std::unordered_map<EventId, EventTiming> dispatchedTimings_;
+  // host buffers shared by the client (see allocHostBuffer), indexed by their address in the client. Memcpys from/to
+  // them access the memory directly instead of going through cmaCopyFunction_
+  std::map<AddressT, SharedHostBuffer> sharedHostBuffers_;
   Server& server_;
   std::recursive_mutex mutex_;
+  // serializes the processing of the socket and the request ring requests
+  std::mutex requestsMutex_;
+  std::vector<std::byte> requestBuffer_;
+  // set while processSocketRequests is pending or running in the server pool
+  bool busy_ = false;
+  std::mutex busyMutex_;
+  std::condition_variable busyCondVar_;
+  // shared memory transport, set up by the client through SHM_TRANSPORT. The request ring is only used by
+  // ringRunner_
+  std::thread ringRunner_;
+  std::unique_ptr<ShmRing> requestRing_;
+  std::unique_ptr<ShmRing> responseRing_;
+  // responses are sent from several threads; serializes the writes to the socket or the response ring
+  std::mutex sendMutex_;
+  std::vector<std::byte> sendBuffer_;
+  std::vector<int> receivedFds_;
   int socket_;
   bool running_ = true;
 
   pid_t pid_;
+  pid_t clientPid_;
 };
 } // namespace rt
@@ -6,6 +6,7 @@
 #include "ProfilerImp.h"
 #include "RemoteProfiler.h"
 
+#include "PrometheusExporter.h"
 #include "Server.h"
 
 #include "runtime/DeviceLayerFake.h"
@@ -15,10 +16,14 @@
 #include <hostUtils/logging/Logger.h>
 #include <sw-sysemu/SysEmuOptions.h>
 
+#include <algorithm>
+#include <cctype>
+#include <chrono>
 #include <condition_variable>
 #include <csignal>
 #include <fstream>
 #include <ios>
+#include <sstream>
 #include <sys/stat.h>
 #include <unistd.h>
 
@@ -63,6 +68,94 @@ bool validateNumDevices(const char* flagName, uint32_t value) {
   }
   return true;
 }
+bool validateReceiverMode(const char* flagName, const std::string& value) {
+  if (value != "polling" && value != "blocking" && value != "hybrid") {
+    printf("Invalid value for --%s: %s\n", flagName, value.c_str());
+    return false;
+  }
+  return true;
+}
+bool validateMemoryAllocator(const char* flagName, const std::string& value) {
+  if (value != "firstfit" && value != "sizeclasses") {
+    printf("Invalid value for --%s: %s\n", flagName, value.c_str());
+    return false;
+  }
+  return true;
+}
+// parses a comma separated list of uid:weight:max_mbps:max_launches_per_sec:max_inflight:allow_hp entries, optionally
+// followed by :shire_mask:max_device_mb, where uid can be '*' for all users without an entry
+bool parseClientQos(const std::string& value, std::vector<std::pair<std::string, rt::ClientQos>>& result) {
+  std::istringstream entries(value);
+  for (std::string entry; std::getline(entries, entry, ',');) {
+    std::istringstream fields(entry);
+    std::vector<std::string> values;
+    for (std::string field; std::getline(fields, field, ':');) {
+      values.emplace_back(field);
+    }
+    if ((values.size() != 6 && values.size() != 8) || values[0].empty()) {
+      return false;
+    }
+    if (values[0] != "*" && !std::all_of(begin(values[0]), end(values[0]), ::isdigit)) {
+      return false;
+    }
+    try {
+      rt::ClientQos qos;
+      qos.weight_ = static_cast<uint32_t>(std::stoul(values[1]));
+      qos.maxBytesPerSecond_ = std::stoull(values[2]) << 20;
+      qos.maxLaunchesPerSecond_ = static_cast<uint32_t>(std::stoul(values[3]));
+      qos.maxInflightCommands_ = static_cast<uint32_t>(std::stoul(values[4]));
+      qos.allowHighPriority_ = std::stoul(values[5]) != 0;
+      if (values.size() == 8) {
+        qos.shireMask_ = std::stoull(values[6], nullptr, 0);
+        qos.maxDeviceMemory_ = std::stoull(values[7]) << 20;
+      }
+      if (qos.weight_ == 0) {
+        return false;
+      }
+      result.emplace_back(values[0], qos);
+    } catch (const std::exception&) {
+      return false;
+    }
+  }
+  return true;
+}
+bool validateClientQos(const char* flagName, const std::string& value) {
+  std::vector<std::pair<std::string, rt::ClientQos>> qos;
+  if (!parseClientQos(value, qos)) {
+    printf("Invalid value for --%s: %s\n", flagName, value.c_str());
+    return false;
+  }
+  return true;
+}
+// parses a comma separated list of class:N entries, where class is a profiling::Class name
+bool parseProfilerSampling(const std::string& value, rt::profiling::SamplingOptions& result) {
+  std::istringstream entries(value);
+  for (std::string entry; std::getline(entries, entry, ',');) {
+    auto pos = entry.find(':');
+    if (pos == std::string::npos) {
+      return false;
+    }
+    auto name = entry.substr(0, pos);
+    auto cls = rt::profiling::class_from_string(name);
+    if (rt::profiling::getString(cls) != name) {
+      return false;
+    }
+    try {
+      result.everyN_[static_cast<size_t>(cls)] = static_cast<uint32_t>(std::stoul(entry.substr(pos + 1)));
+    } catch (const std::exception&) {
+      return false;
+    }
+  }
+  return true;
+}
+bool validateProfilerSampling(const char* flagName, const std::string& value) {
+  rt::profiling::SamplingOptions options;
+  if (!parseProfilerSampling(value, options)) {
+    printf("Invalid value for --%s: %s\n", flagName, value.c_str());
+    return false;
+  }
+  return true;
+}
 constexpr auto kBootRomTrampolineToBl2Elf = "/BootromTrampolineToBL2.elf";
 constexpr auto kBl2Elf = "/ServiceProcessorBL2_fast-boot.elf";
 constexpr auto kMasterMinionElf = "/MasterMinion.elf";
@@ -80,12 +173,18 @@ DEFINE_string(log_folder, "/var/log/et_runtime", "Folder where runtime will stor
 DEFINE_int32(log_verbosity, -1,
              "Defines level of log verbosity. -1 disables verbose logs, 0 enables low verbosity, 1 enables mid "
              "verbosity and 2 enables high verbosity");
+DEFINE_bool(log_async, false,
+            "Hands the verbose logs to the logger from a background thread, so they don't slow down the threads which "
+            "log them.");
 DEFINE_string(device_type, "pcie",
               "Indicates which kind of devices the server will use. This value must be one of these: \n\t'pcie' -> "
               "physical devices\n\t'sysemu' -> emulated devices\n\t'fake' -> dummy devices (most features won't work "
               "properly, this is intended for internal development only')");
 DEFINE_validator(device_type, &validateDeviceType);
 DEFINE_validator(log_verbosity, &validateVerbosity);
+DEFINE_bool(pcie_io_uring, false,
+            "Submits the bursts of commands and the completion queue pops to the driver through io_uring, with a single "
+            "syscall. Only valid for pcie based servers; IOCTLs are used if the driver doesn't support it.");
 DEFINE_string(tracing_folder, "/var/log/et_runtime", "Folder where will be put the tracing files.");
 DEFINE_string(tracing_mode, "json", "Tracing mode can be json or bin");
 DEFINE_validator(tracing_mode, &validateTraceMode);
@@ -104,6 +203,53 @@ DEFINE_uint32(frequencyMhz, dev::DeviceLayerFake::Parameters::getDefault().dc_.m
               "Frequency in Mhz\n. Only valid for fake based server.");
 DEFINE_uint64(dramSize, dev::DeviceLayerFake::Parameters::getDefault().bytesDram_,
               "Dram size in bytes\n. Only valid for fake based server.");
+DEFINE_string(receiver_mode, "polling",
+              "How the runtime waits for device responses. This value must be one of these: \n\t'polling' -> "
+              "periodic polling\n\t'blocking' -> block till the device notifies responses\n\t'hybrid' -> spin "
+              "for receiver_spin_us after each response then block");
+DEFINE_validator(receiver_mode, &validateReceiverMode);
+DEFINE_uint32(receiver_spin_us, 20, "Spin time in microseconds when receiver_mode is hybrid.");
+DEFINE_string(memory_allocator, "firstfit",
+              "Device memory allocator. This value must be one of these: \n\t'firstfit' -> address ordered first "
+              "fit\n\t'sizeclasses' -> size classes for small allocations plus best fit for big ones");
+DEFINE_validator(memory_allocator, &validateMemoryAllocator);
+DEFINE_uint64(code_cache_size, 256UL << 20,
+              "Device bytes of read-only kernel code kept loaded once no client uses it, so clients loading the same "
+              "elf again (i.e. after a restart) don't copy it to the device. It's freed on demand when device memory "
+              "runs out.");
+DEFINE_bool(prefault_cma, false,
+            "Fault in the CMA staging buffers at start-up, so the first memcpys of the clients don't take page "
+            "faults.");
+DEFINE_bool(lock_cma, false, "Lock the CMA staging buffers in memory (mlock); it needs a big enough RLIMIT_MEMLOCK.");
+DEFINE_bool(hugepage_cma, true, "Back the CMA staging buffers with hugepages when there are enough free ones.");
+DEFINE_uint32(execution_context_buffers, 0,
+              "Kernel execution context buffers created per device at start-up (0 means the runtime default).");
+DEFINE_string(client_qos, "",
+              "Clients quality of service. Comma separated list of "
+              "uid:weight:max_mbps:max_launches_per_sec:max_inflight:allow_hp entries; uid '*' applies to the users "
+              "without an entry. Zero limits mean unlimited and allow_hp (0 or 1) tells if the user clients can "
+              "create high priority streams. Two more fields, shire_mask:max_device_mb, give the user clients a "
+              "partition of the device: the shires their kernels run on and a device memory quota (zero means all "
+              "the shires and unlimited). I.e. '*:1:1000:0:64:0,0:4:0:0:0:1' or '1000:1:0:0:0:1:0xFFFF:8192'");
+DEFINE_validator(client_qos, &validateClientQos);
+DEFINE_uint32(max_inflight_commands, 0,
+              "Max memcpys and kernel launches in flight among all clients (0 means unlimited). Once reached, the "
+              "submissions are shared among the clients according to their client_qos weight.");
+
+DEFINE_string(profiler_sampling, "",
+              "Sampling of the profiling events sent to the clients which enabled tracing. Comma separated list of "
+              "class:N entries, forwarding one out of each N events of the class (0 forwards none). The responses of "
+              "a command are only forwarded if its CommandSent event was. I.e. 'CommandSent:100'");
+DEFINE_validator(profiler_sampling, &validateProfilerSampling);
+DEFINE_uint32(profiler_sampling_interval_us, 0,
+              "Forward at most one profiling event of each class per interval to each client (0 disables it).");
+DEFINE_uint32(profiler_stats_period_ms, 0,
+              "Period of the CommandStats counter events sent to the clients which enabled tracing, with the "
+              "histograms of their launch latencies and memcpy sizes and bandwidths (0 disables them).");
+DEFINE_string(metrics_file, "",
+              "File where the device metrics and clients stats are periodically written in the Prometheus text "
+              "format, i.e. for the node exporter textfile collector. Empty disables it.");
+DEFINE_uint32(metrics_period_ms, 10000, "Period of the metrics_file updates.");
 
 namespace gflags {}
 namespace google {}
@@ -130,6 +276,11 @@ int main(int argc, char* argv[]) {
   g3::log_levels::disable(DEBUG);
 #endif
   initializeLogging(worker.get());
+  // declared after the log worker, so it writes its pending logs before the worker is destroyed
+  std::unique_ptr<logging::AsyncLogging> asyncLogging;
+  if (FLAGS_log_async) {
+    asyncLogging = std::make_unique<logging::AsyncLogging>();
+  }
 
   // sysemu setup
   auto sysemurundir = FLAGS_sysemu_data_folder + kSysemuRunDir;
@@ -147,7 +298,8 @@ int main(int argc, char* argv[]) {
   std::shared_ptr<dev::IDeviceLayer> deviceLayer;
   auto pid = getpid();
   if (FLAGS_device_type == "pcie") {
-    deviceLayer = dev::IDeviceLayer::createPcieDeviceLayer();
+    deviceLayer = FLAGS_pcie_io_uring ? dev::IDeviceLayer::createPcieUringDeviceLayer()
+                                      : dev::IDeviceLayer::createPcieDeviceLayer();
   } else if (FLAGS_device_type == "sysemu") {
     emu::SysEmuOptions opts;
     opts.bootromTrampolineToBL2ElfPath = FLAGS_sysemu_data_folder + kBootRomTrampolineToBl2Elf;
@@ -206,8 +358,32 @@ int main(int argc, char* argv[]) {
     if (FLAGS_device_type == "fake") {
       opts.checkDeviceApiVersion_ = false;
     }
+    if (FLAGS_receiver_mode == "blocking") {
+      opts.responseReceiverMode_ = rt::ResponseReceiverMode::Blocking;
+    } else if (FLAGS_receiver_mode == "hybrid") {
+      opts.responseReceiverMode_ = rt::ResponseReceiverMode::Hybrid;
+    }
+    opts.responseReceiverSpinTime_ = std::chrono::microseconds{FLAGS_receiver_spin_us};
+    if (FLAGS_memory_allocator == "sizeclasses") {
+      opts.memoryAllocatorPolicy_ = rt::MemoryAllocatorPolicy::SizeClasses;
+    }
+    opts.codeImageRetentionBytes_ = FLAGS_code_cache_size;
+    opts.prefaultCmaBuffers_ = FLAGS_prefault_cma;
+    opts.lockCmaBuffers_ = FLAGS_lock_cma;
+    opts.hugePageCmaBuffers_ = FLAGS_hugepage_cma;
+    opts.executionContextBuffers_ = FLAGS_execution_context_buffers;
 
     rt::Server s(FLAGS_socket_path, deviceLayer, opts);
+    std::vector<std::pair<std::string, rt::ClientQos>> clientsQos;
+    parseClientQos(FLAGS_client_qos, clientsQos);
+    for (const auto& [uid, qos] : clientsQos) {
+      if (uid == "*") {
+        s.setDefaultClientQos(qos);
+      } else {
+        s.setClientQos(static_cast<uid_t>(std::stoul(uid)), qos);
+      }
+    }
+    s.setMaxInflightCommands(FLAGS_max_inflight_commands);
 
     // Set up profiling
     {
@@ -224,6 +400,12 @@ int main(int argc, char* argv[]) {
       }
       profiler->setLocalProfiler(std::move(localProfiler));
 
+      rt::profiling::SamplingOptions sampling;
+      parseProfilerSampling(FLAGS_profiler_sampling, sampling);
+      sampling.minInterval_ = std::chrono::microseconds{FLAGS_profiler_sampling_interval_us};
+      sampling.statsPeriod_ = std::chrono::milliseconds{FLAGS_profiler_stats_period_ms};
+      profiler->setSamplingOptions(sampling);
+
       auto type = rt::IProfiler::OutputType::Json;
       if (FLAGS_tracing_mode != "json") {
         type = rt::IProfiler::OutputType::Binary;
@@ -232,7 +414,18 @@ int main(int argc, char* argv[]) {
     }
 
     std::unique_lock lock(s_m);
-    s_cv.wait(lock, [] { return !s_running; });
+    if (FLAGS_metrics_file.empty()) {
+      s_cv.wait(lock, [] { return !s_running; });
+    } else {
+      auto period = std::chrono::milliseconds{std::max(FLAGS_metrics_period_ms, 1U)};
+      while (!s_cv.wait_for(lock, period, [] { return !s_running; })) {
+        try {
+          rt::writePrometheusMetrics(FLAGS_metrics_file, s.getDeviceMetrics(), s.getClientStats());
+        } catch (const rt::Exception& e) {
+          std::cerr << "Failed to write the metrics: " << e.what() << "\n";
+        }
+      }
+    }
 
     std::cout << "End server execution\n.";
 
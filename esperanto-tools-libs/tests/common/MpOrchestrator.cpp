@@ -23,7 +23,8 @@ enum class Status : uint64_t { INVALID, SERVER_READY, END_SERVER, SERVER_ERROR }
 
 } // namespace
 
-void MpOrchestrator::createServer(const DeviceLayerCreatorFunc& deviceLayerCreator, rt::Options options) {
+void MpOrchestrator::createServer(const DeviceLayerCreatorFunc& deviceLayerCreator, rt::Options options,
+                                  const std::function<void(rt::Server&)>& setupServer) {
   RT_LOG_IF(FATAL, server_ != -1) << "Server already created!";
 
   efdToServer_ = eventfd(0, 0);
@@ -44,6 +45,9 @@ void MpOrchestrator::createServer(const DeviceLayerCreatorFunc& deviceLayerCreat
         auto logger = std::make_unique<logging::LoggerDefault>();
         RT_LOG(INFO) << "Creating server process (pid " << getpid() << ")";
         auto server = rt::Server{socketPath_, deviceLayerCreator(), options};
+        if (setupServer) {
+          setupServer(server);
+        }
         Status s(Status::SERVER_READY);
         write(efdFromServer_, &s, sizeof(s));
         while (s != Status::END_SERVER) {
@@ -15,7 +15,9 @@ public:
   ~MpOrchestrator();
   using DeviceLayerCreatorFunc = std::function<std::unique_ptr<dev::IDeviceLayer>()>;
 
-  void createServer(const DeviceLayerCreatorFunc& deviceLayerCreator, rt::Options options);
+  // setupServer, if any, is called in the server process before the clients can connect
+  void createServer(const DeviceLayerCreatorFunc& deviceLayerCreator, rt::Options options,
+                    const std::function<void(rt::Server&)>& setupServer = {});
   void createClient(const std::function<void(rt::IRuntime* runtime)>&);
   const std::string& getSocketPath() const { // to be able to create local clients.
     return socketPath_;
@@ -32,6 +32,8 @@ public:
       case DeviceLayerImp::SYSEMU: {
         RT_LOG(INFO) << "Running tests with SYSEMU deviceLayer. Num devices: " << static_cast<uint32_t>(numDevices_);
         auto opts = getSysemuDefaultOptions();
+        opts.additionalOptions.insert(end(opts.additionalOptions), begin(sysEmuAdditionalOptions_),
+                                      end(sysEmuAdditionalOptions_));
         std::vector<decltype(opts)> vopts;
         for (auto i = 0; i < numDevices_; ++i) {
           vopts.emplace_back(opts);
@@ -91,6 +93,10 @@ public:
   }
 
   rt::KernelId loadKernel(const std::string& kernel_name, uint32_t deviceIdx = 0) {
+    return loadKernelCode(kernel_name, deviceIdx).kernel_;
+  }
+
+  static std::string getKernelsDir() {
     std::string kernels_dir = std::string{KERNELS_DIR};
     if (not fs::exists(kernels_dir)) {
       auto kernels_dir_env = getenv("ET_RUNTIME_TEST_KERNELS_DIR");
@@ -98,13 +104,17 @@ public:
         kernels_dir = std::string{kernels_dir_env};
       }
     }
-    auto kernelContent = readFile(kernels_dir + "/" + kernel_name);
+    return kernels_dir;
+  }
+
+  rt::LoadCodeResult loadKernelCode(const std::string& kernel_name, uint32_t deviceIdx = 0) {
+    auto kernelContent = readFile(getKernelsDir() + "/" + kernel_name);
     EXPECT_FALSE(kernelContent.empty());
     EXPECT_TRUE(devices_.size() > deviceIdx);
     auto st = defaultStreams_[deviceIdx];
     auto res = runtime_->loadCode(st, kernelContent.data(), kernelContent.size());
     runtime_->waitForEvent(res.event_);
-    return res.kernel_;
+    return res;
   }
 
   static bool IsTraceEnabled(int argc, char* argv[]) {
@@ -176,6 +186,8 @@ private:
 
 protected:
   uint8_t numDevices_ = 1;
+  /// sys_emu command line options of the SYSEMU deviceLayer, on top of the defaults
+  std::vector<std::string> sysEmuAdditionalOptions_;
   std::ofstream traceOut_;
   std::unique_ptr<logging::LoggerDefault> loggerDefault_;
   std::shared_ptr<dev::IDeviceLayer> deviceLayer_; // only set for SP mode
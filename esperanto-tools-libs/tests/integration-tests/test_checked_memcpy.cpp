@@ -0,0 +1,70 @@
+//******************************************************************************
+// Copyright (c) 2025 Ainekko, Co.
+// SPDX-License-Identifier: Apache-2.0
+//------------------------------------------------------------------------------
+
+#include "RuntimeFixture.h"
+#include "Utils.h"
+#include "common/Constants.h"
+#include "runtime/IRuntime.h"
+#include "runtime/Types.h"
+#include <hostUtils/logging/Logger.h>
+
+#include <cstdlib>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+struct CheckedMemcpy : public RuntimeFixture {
+  void SetUp() override {
+    // the runtime loads crc32_check.elf itself, from the test kernels
+    setenv("ET_RUNTIME_KERNELS_DIR", getKernelsDir().c_str(), 1);
+    RuntimeFixture::SetUp();
+    hSrc_.resize(kSize);
+    randomize(hSrc_, 0, 255);
+    dDst_ = runtime_->mallocDevice(devices_[0], kSize);
+  }
+
+  void TearDown() override {
+    runtime_->freeDevice(devices_[0], dDst_);
+    RuntimeFixture::TearDown();
+  }
+
+  // 3 whole 1MiB chunks and a partial one, so staging steps are split at the chunk boundaries
+  static constexpr size_t kSize = 3 * 1024 * 1024 + 100 * 1024 + 8;
+  std::vector<std::byte> hSrc_;
+  std::byte* dDst_;
+};
+
+TEST_F(CheckedMemcpy, Matches) {
+  runtime_->memcpyHostToDeviceChecked(defaultStreams_[0], hSrc_.data(), dDst_, kSize, 0x3);
+  std::vector<std::byte> hDst(kSize);
+  runtime_->memcpyDeviceToHost(defaultStreams_[0], dDst_, hDst.data(), kSize);
+  runtime_->waitForStream(defaultStreams_[0]);
+  ASSERT_TRUE(runtime_->retrieveStreamErrors(defaultStreams_[0]).empty());
+  ASSERT_EQ(hDst, hSrc_);
+}
+
+TEST_F(CheckedMemcpy, MismatchReported) {
+  // the mismatch is expected, part of the test
+  runtime_->setOnStreamErrorsCallback(nullptr);
+  // a crc32_check kernel which doesn't write any CRC, so none of them matches the host ones
+  auto kernelsDir = fs::temp_directory_path() / ("checked_memcpy_kernels_" + std::to_string(getpid()));
+  fs::create_directories(kernelsDir);
+  fs::copy_file(fs::path(getKernelsDir()) / "empty.elf", kernelsDir / "crc32_check.elf",
+                fs::copy_options::overwrite_existing);
+  setenv("ET_RUNTIME_KERNELS_DIR", kernelsDir.c_str(), 1);
+
+  runtime_->memcpyHostToDeviceChecked(defaultStreams_[0], hSrc_.data(), dDst_, kSize, 0x1);
+  runtime_->waitForStream(defaultStreams_[0]);
+  fs::remove_all(kernelsDir);
+  auto errors = runtime_->retrieveStreamErrors(defaultStreams_[0]);
+  ASSERT_EQ(errors.size(), 1UL);
+  EXPECT_EQ(errors[0].errorCode_, rt::DeviceErrorCode::MemcpyChecksumMismatch);
+}
+
+int main(int argc, char** argv) {
+  RuntimeFixture::ParseArguments(argc, argv);
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -100,6 +100,83 @@ TEST_F(TestCodeLoading, MultipleLoads) {
   }
 }
 
+// Loading the same elf several times gives independent kernels, regardless of their code being shared or not
+TEST_F(TestCodeLoading, SameElfLoadedTwice) {
+  // add_vector has no writable segments, so both kernels share the code image
+  auto first = loadKernelCode("add_vector.elf");
+  auto second = loadKernelCode("add_vector.elf");
+  EXPECT_NE(first.kernel_, second.kernel_);
+  EXPECT_EQ(first.loadAddress_, second.loadAddress_);
+  runtime_->unloadCode(first.kernel_);
+  EXPECT_THROW(runtime_->unloadCode(first.kernel_), rt::Exception);
+
+  auto numElems = 150U;
+  auto hSrc1 = std::vector<int>(numElems);
+  auto hSrc2 = std::vector<int>(numElems);
+  auto hDst = std::vector<int>(numElems);
+  auto dSrc1 = runtime_->mallocDevice(devices_[0], numElems * sizeof(int));
+  auto dSrc2 = runtime_->mallocDevice(devices_[0], numElems * sizeof(int));
+  auto dDst = runtime_->mallocDevice(devices_[0], numElems * sizeof(int));
+  randomize(hSrc1, std::numeric_limits<int>::lowest(), std::numeric_limits<int>::max());
+  randomize(hSrc2, std::numeric_limits<int>::lowest(), std::numeric_limits<int>::max());
+
+  struct {
+    void* src1;
+    void* src2;
+    void* dst;
+    int elements;
+  } params{dSrc1, dSrc2, dDst, static_cast<int>(numElems)};
+  runtime_->memcpyHostToDevice(defaultStreams_[0], reinterpret_cast<std::byte*>(hSrc1.data()), dSrc1,
+                               numElems * sizeof(int));
+  runtime_->memcpyHostToDevice(defaultStreams_[0], reinterpret_cast<std::byte*>(hSrc2.data()), dSrc2,
+                               numElems * sizeof(int));
+  // the second kernel must keep working once the first one has been unloaded
+  runtime_->kernelLaunch(defaultStreams_[0], second.kernel_, reinterpret_cast<std::byte*>(&params), sizeof(params),
+                         0x1);
+  runtime_->memcpyDeviceToHost(defaultStreams_[0], dDst, reinterpret_cast<std::byte*>(hDst.data()),
+                               numElems * sizeof(int));
+  runtime_->waitForStream(defaultStreams_[0]);
+  runtime_->unloadCode(second.kernel_);
+  runtime_->freeDevice(devices_[0], dSrc1);
+  runtime_->freeDevice(devices_[0], dSrc2);
+  runtime_->freeDevice(devices_[0], dDst);
+  for (auto i = 0U; i < numElems; ++i) {
+    ASSERT_EQ(hDst[i], hSrc1[i] + hSrc2[i]);
+  }
+}
+
+// Kernels with writable segments keep their own copy of the code image
+TEST_F(TestCodeLoading, SameElfWithBssLoadedTwice) {
+  auto first = loadKernelCode("bss.elf");
+  auto second = loadKernelCode("bss.elf");
+  EXPECT_NE(first.kernel_, second.kernel_);
+  EXPECT_NE(first.loadAddress_, second.loadAddress_);
+  runtime_->unloadCode(first.kernel_);
+  runtime_->unloadCode(second.kernel_);
+}
+
+// Once unloaded, read-only code images are kept loaded up to the retention limit and reused by the next loads
+TEST_F(TestCodeLoading, RetainedCodeImage) {
+  auto imp = dynamic_cast<rt::RuntimeImp*>(runtime_.get());
+  if (imp == nullptr) {
+    return; // in multiprocess mode the retention is configured by the server
+  }
+  auto dev = devices_[0];
+  imp->setCodeImageRetentionBytes(64 << 20);
+  auto initialFree = imp->getFreeMemory()[dev];
+  runtime_->unloadCode(loadKernel("add_vector.elf"));
+  auto retainedFree = imp->getFreeMemory()[dev];
+  EXPECT_LT(retainedFree, initialFree);
+
+  auto kernel = loadKernel("add_vector.elf");
+  EXPECT_EQ(imp->getFreeMemory()[dev], retainedFree);
+  runtime_->unloadCode(kernel);
+  EXPECT_EQ(imp->getFreeMemory()[dev], retainedFree);
+
+  imp->setCodeImageRetentionBytes(0);
+  EXPECT_EQ(imp->getFreeMemory()[dev], initialFree);
+}
+
 } // namespace
 
 int main(int argc, char** argv) {
@@ -0,0 +1,139 @@
+//******************************************************************************
+// Copyright (c) 2025 Ainekko, Co.
+// SPDX-License-Identifier: Apache-2.0
+//------------------------------------------------------------------------------
+
+#include "RuntimeFixture.h"
+#include "common/Constants.h"
+#include "runtime/Collectives.h"
+#include "runtime/IRuntime.h"
+#include "runtime/Types.h"
+#include <hostUtils/logging/Logger.h>
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <numeric>
+#include <vector>
+
+using namespace rt;
+
+struct Collectives : public RuntimeFixture {
+  void SetUp() override {
+    // force multidevice if its not PCIE
+    if (sDlType != RuntimeFixture::DeviceLayerImp::PCIE) {
+      numDevices_ = 2;
+    }
+    RuntimeFixture::SetUp();
+  }
+};
+
+TEST_F(Collectives, moveData) {
+  if (devices_.size() < 2) {
+    GTEST_SKIP() << "Collectives between devices need at least 2 devices, there is " << devices_.size();
+  }
+  for (auto it = begin(devices_); it != end(devices_); ++it) {
+    for (auto other = std::next(it); other != end(devices_); ++other) {
+      if (!runtime_->isP2PEnabled(*it, *other)) {
+        GTEST_SKIP() << "Devices " << static_cast<int>(*it) << " and " << static_cast<int>(*other)
+                     << " can't do P2P memcpys";
+      }
+    }
+  }
+  // small chunks, so the data is pipelined through several of them
+  constexpr auto kChunkSize = 1UL << 12;
+  constexpr auto kElements = 5000UL;
+  constexpr auto kSize = kElements * sizeof(int);
+  auto numDevices = devices_.size();
+  Communicator comm(*runtime_, devices_, kChunkSize);
+
+  std::vector<std::byte*> buffers;
+  for (auto dev : devices_) {
+    buffers.emplace_back(runtime_->mallocDevice(dev, kSize * numDevices));
+  }
+  auto upload = [this, &buffers](size_t idx, const std::vector<int>& data) {
+    runtime_->memcpyHostToDevice(defaultStreams_[idx], reinterpret_cast<const std::byte*>(data.data()), buffers[idx],
+                                 data.size() * sizeof(int));
+    runtime_->waitForStream(defaultStreams_[idx]);
+  };
+  auto download = [this, &buffers](size_t idx, size_t elements) {
+    std::vector<int> data(elements);
+    runtime_->memcpyDeviceToHost(defaultStreams_[idx], buffers[idx], reinterpret_cast<std::byte*>(data.data()),
+                                 elements * sizeof(int));
+    runtime_->waitForStream(defaultStreams_[idx]);
+    return data;
+  };
+  auto waitFor = [this](const std::vector<EventId>& events) {
+    for (auto evt : events) {
+      EXPECT_TRUE(runtime_->waitForEvent(evt));
+    }
+  };
+  auto blockOf = [](size_t idx) {
+    std::vector<int> block(kElements);
+    std::iota(begin(block), end(block), static_cast<int>(idx * kElements));
+    return block;
+  };
+
+  // broadcast from the last device
+  for (size_t i = 0; i < numDevices; ++i) {
+    upload(i, i + 1 == numDevices ? blockOf(i) : std::vector<int>(kElements));
+  }
+  waitFor(comm.broadcast(devices_.back(), buffers, kSize));
+  for (size_t i = 0; i < numDevices; ++i) {
+    EXPECT_EQ(download(i, kElements), blockOf(numDevices - 1)) << "device " << i;
+  }
+
+  // all-gather, each device starts with only its own block
+  std::vector<int> gathered;
+  for (size_t i = 0; i < numDevices; ++i) {
+    std::vector<int> data(kElements * numDevices);
+    auto block = blockOf(i);
+    std::copy(begin(block), end(block), begin(data) + static_cast<long>(i * kElements));
+    upload(i, data);
+    gathered.insert(end(gathered), begin(block), end(block));
+  }
+  waitFor(comm.allGather(buffers, kSize));
+  for (size_t i = 0; i < numDevices; ++i) {
+    EXPECT_EQ(download(i, kElements * numDevices), gathered) << "device " << i;
+  }
+
+  // all-reduce adding the blocks of all the devices, with add_vector doing dst = dst + src
+  ReduceOp op;
+  for (size_t i = 0; i < numDevices; ++i) {
+    op.kernels_[devices_[i]] = loadKernel("add_vector.elf", static_cast<uint32_t>(i));
+  }
+  op.makeArgs_ = [](std::byte* dst, const std::byte* src, size_t size) {
+    struct {
+      const std::byte* a;
+      const std::byte* b;
+      std::byte* result;
+      int numElements;
+    } params{dst, src, dst, static_cast<int>(size / sizeof(int))};
+    std::vector<std::byte> args(sizeof(params));
+    std::memcpy(args.data(), &params, sizeof(params));
+    return args;
+  };
+  op.options_.setShireMask(0x1);
+  std::vector<int> sum(kElements);
+  for (size_t i = 0; i < numDevices; ++i) {
+    auto block = blockOf(i);
+    upload(i, block);
+    std::transform(begin(sum), end(sum), begin(block), begin(sum), std::plus<>());
+  }
+  waitFor(comm.allReduce(buffers, kSize, op));
+  for (size_t i = 0; i < numDevices; ++i) {
+    EXPECT_EQ(download(i, kElements), sum) << "device " << i;
+    EXPECT_TRUE(runtime_->retrieveStreamErrors(comm.getStream(devices_[i])).empty());
+  }
+
+  for (size_t i = 0; i < numDevices; ++i) {
+    runtime_->freeDevice(devices_[i], buffers[i]);
+  }
+}
+
+int main(int argc, char** argv) {
+  RuntimeFixture::ParseArguments(argc, argv);
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,123 @@
+//******************************************************************************
+// Copyright (c) 2025 Ainekko, Co.
+// SPDX-License-Identifier: Apache-2.0
+//------------------------------------------------------------------------------
+
+#include "RuntimeFixture.h"
+#include "Utils.h"
+#include "common/Constants.h"
+#include "runtime/IRuntime.h"
+#include "runtime/Types.h"
+#include <hostUtils/logging/Logger.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+// LZ4 lengths of 15 or more continue in bytes after the token
+void appendExtraLength(std::vector<std::byte>& out, size_t length) {
+  if (length < 15) {
+    return;
+  }
+  length -= 15;
+  for (; length >= 255; length -= 255) {
+    out.emplace_back(std::byte{255});
+  }
+  out.emplace_back(static_cast<std::byte>(length));
+}
+
+void appendLiterals(std::vector<std::byte>& out, const std::byte* literals, size_t count, uint8_t matchNibble) {
+  out.emplace_back(static_cast<std::byte>((std::min<size_t>(count, 15) << 4) | matchNibble));
+  appendExtraLength(out, count);
+  out.insert(end(out), literals, literals + count);
+}
+
+// LZ4 block of a block whose bytes from period to size - tail repeat its first period bytes, encoded as a single
+// match; it has no match if tail is the whole block
+std::vector<std::byte> compressBlock(const std::vector<std::byte>& block, size_t period, size_t tail) {
+  std::vector<std::byte> out;
+  if (tail < block.size()) {
+    auto matchLength = block.size() - tail - period;
+    appendLiterals(out, block.data(), period, static_cast<uint8_t>(std::min<size_t>(matchLength - 4, 15)));
+    out.emplace_back(static_cast<std::byte>(period & 0xFF));
+    out.emplace_back(static_cast<std::byte>(period >> 8));
+    appendExtraLength(out, matchLength - 4);
+  }
+  // the last sequence is only literals, LZ4 requires the last 5 bytes to be literals
+  appendLiterals(out, block.data() + block.size() - tail, tail, 0);
+  return out;
+}
+} // namespace
+
+struct CompressedMemcpy : public RuntimeFixture {
+  void SetUp() override {
+    // the runtime loads lz4_decompress.elf itself, from the test kernels
+    setenv("ET_RUNTIME_KERNELS_DIR", getKernelsDir().c_str(), 1);
+    RuntimeFixture::SetUp();
+  }
+
+  // adds a chunk of size bytes repeating its first period bytes up to the last tail ones
+  void addChunk(size_t size, size_t period, size_t tail) {
+    std::vector<std::byte> block(size);
+    randomize(block, 0, 255);
+    for (auto i = period; i < size - tail; ++i) {
+      block[i] = block[i - period];
+    }
+    auto& compressed = compressed_.emplace_back(compressBlock(block, period, tail));
+    expected_.insert(end(expected_), begin(block), end(block));
+    sizes_.emplace_back(compressed.size(), size);
+  }
+
+  std::vector<rt::CompressedChunk> getChunks() const {
+    std::vector<rt::CompressedChunk> chunks;
+    for (auto i = 0U; i < compressed_.size(); ++i) {
+      chunks.push_back({compressed_[i].data(), sizes_[i].first, sizes_[i].second});
+    }
+    return chunks;
+  }
+
+  std::vector<std::vector<std::byte>> compressed_;
+  std::vector<std::pair<size_t, size_t>> sizes_;
+  std::vector<std::byte> expected_;
+};
+
+TEST_F(CompressedMemcpy, Decompress) {
+  // more chunks than harts of a shire, some of them with long matches and some of them only literals
+  for (auto i = 0U; i < 80; ++i) {
+    if (i % 4 == 3) {
+      addChunk(1000 + i, 0, 1000 + i);
+    } else {
+      addChunk(64 * 1024 + i * 8, 64 + i, 16);
+    }
+  }
+  auto dDst = runtime_->mallocDevice(devices_[0], expected_.size());
+  runtime_->memcpyHostToDeviceCompressed(defaultStreams_[0], getChunks(), dDst, 0x3);
+  std::vector<std::byte> hDst(expected_.size());
+  runtime_->memcpyDeviceToHost(defaultStreams_[0], dDst, hDst.data(), hDst.size());
+  runtime_->waitForStream(defaultStreams_[0]);
+  ASSERT_TRUE(runtime_->retrieveStreamErrors(defaultStreams_[0]).empty());
+  for (auto i = 0U; i < hDst.size(); ++i) {
+    ASSERT_EQ(hDst[i], expected_[i]) << "byte " << i;
+  }
+  runtime_->freeDevice(devices_[0], dDst);
+}
+
+TEST_F(CompressedMemcpy, WrongDecompressedSize) {
+  // the failure is expected, part of the test
+  runtime_->setOnStreamErrorsCallback(nullptr);
+  addChunk(64 * 1024, 64, 16);
+  auto chunks = getChunks();
+  chunks[0].decompressedSize_ += 64;
+  auto dDst = runtime_->mallocDevice(devices_[0], chunks[0].decompressedSize_);
+  runtime_->memcpyHostToDeviceCompressed(defaultStreams_[0], chunks, dDst, 0x1);
+  runtime_->waitForStream(defaultStreams_[0]);
+  EXPECT_EQ(runtime_->retrieveStreamErrors(defaultStreams_[0]).size(), 1UL);
+  runtime_->freeDevice(devices_[0], dDst);
+}
+
+int main(int argc, char** argv) {
+  RuntimeFixture::ParseArguments(argc, argv);
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
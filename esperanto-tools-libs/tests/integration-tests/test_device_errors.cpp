@@ -25,8 +25,10 @@ namespace fs = std::experimental::filesystem;
 #error "cannot include the filesystem library"
 #endif
 
+#include <chrono>
 #include <fstream>
 #include <ios>
+#include <limits>
 #include <optional>
 #include <random>
 
@@ -95,6 +97,60 @@ TEST_F(DeviceErrors, coreDump) {
   RT_LOG(INFO) << "CoreDump at path: " << coreDumpPath;
 }
 
+// The options of a launch the device rejects must not be applied to the next kernel of the stream
+TEST_F(DeviceErrors, FailedLaunchOptionsDontLeak) {
+  auto numElems = 150U;
+  auto hSrc1 = std::vector<int>(numElems);
+  auto hSrc2 = std::vector<int>(numElems);
+  auto hDst = std::vector<int>(numElems);
+  auto dSrc1 = runtime_->mallocDevice(devices_[0], numElems * sizeof(int));
+  auto dSrc2 = runtime_->mallocDevice(devices_[0], numElems * sizeof(int));
+  auto dDst = runtime_->mallocDevice(devices_[0], numElems * sizeof(int));
+  randomize(hSrc1, std::numeric_limits<int>::lowest() / 2, std::numeric_limits<int>::max() / 2);
+  randomize(hSrc2, std::numeric_limits<int>::lowest() / 2, std::numeric_limits<int>::max() / 2);
+  runtime_->memcpyHostToDevice(defaultStreams_[0], reinterpret_cast<std::byte*>(hSrc1.data()), dSrc1,
+                               numElems * sizeof(int));
+  runtime_->memcpyHostToDevice(defaultStreams_[0], reinterpret_cast<std::byte*>(hSrc2.data()), dSrc2,
+                               numElems * sizeof(int));
+  struct {
+    void* src1;
+    void* src2;
+    void* dst;
+    int elements;
+  } params{dSrc1, dSrc2, dDst, static_cast<int>(numElems)};
+
+  // the per hart stack of 193 4KB pages split among the 192 harts of 3 shires is not cache line aligned, which only
+  // the device checks, so this launch fails after the commands carrying its options were processed
+  constexpr uint64_t kBadShireMask = 0x7;
+  constexpr size_t kBadStackSize = 193 * 4096;
+  auto dStack = runtime_->mallocDevice(devices_[0], kBadStackSize, 4096);
+  std::vector<std::byte> badArgs(3 * sizeof(params));
+  rt::KernelLaunchOptions badOptions;
+  badOptions.setShireMask(kBadShireMask);
+  badOptions.setStackConfig(dStack, kBadStackSize);
+  badOptions.setShireArgsStride(sizeof(params));
+  badOptions.setFlushRanges({{dStack, kBadStackSize}});
+  badOptions.setWatchdogTimeout(std::chrono::seconds(1));
+  runtime_->kernelLaunch(defaultStreams_[0], add_vector_kernel, badArgs.data(), badArgs.size(), badOptions);
+  runtime_->waitForStream(defaultStreams_[0]);
+  ASSERT_EQ(runtime_->retrieveStreamErrors(defaultStreams_[0]).size(), 1UL);
+
+  // both shires compute the whole vector, a second shire reading its arguments at a leaked stride would fail
+  runtime_->kernelLaunch(defaultStreams_[0], add_vector_kernel, reinterpret_cast<std::byte*>(&params), sizeof(params),
+                         0x3);
+  runtime_->memcpyDeviceToHost(defaultStreams_[0], dDst, reinterpret_cast<std::byte*>(hDst.data()),
+                               numElems * sizeof(int));
+  runtime_->waitForStream(defaultStreams_[0]);
+  ASSERT_TRUE(runtime_->retrieveStreamErrors(defaultStreams_[0]).empty());
+  for (auto i = 0U; i < numElems; ++i) {
+    ASSERT_EQ(hDst[i], hSrc1[i] + hSrc2[i]);
+  }
+  runtime_->freeDevice(devices_[0], dStack);
+  runtime_->freeDevice(devices_[0], dSrc1);
+  runtime_->freeDevice(devices_[0], dSrc2);
+  runtime_->freeDevice(devices_[0], dDst);
+}
+
 int main(int argc, char** argv) {
   RuntimeFixture::ParseArguments(argc, argv);
   testing::InitGoogleTest(&argc, argv);
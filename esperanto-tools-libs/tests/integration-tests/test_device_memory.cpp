@@ -0,0 +1,179 @@
+//******************************************************************************
+// Copyright (c) 2025 Ainekko, Co.
+// SPDX-License-Identifier: Apache-2.0
+//------------------------------------------------------------------------------
+
+#include "RuntimeFixture.h"
+#include "Utils.h"
+#include "common/Constants.h"
+#include "runtime/DeviceOpsExt.h"
+#include "runtime/IRuntime.h"
+#include "runtime/Types.h"
+#include <hostUtils/logging/Logger.h>
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+struct DeviceMemory : public RuntimeFixture {
+  void SetUp() override {
+    RuntimeFixture::SetUp();
+    hInit_.resize(kSize);
+    randomize(hInit_, 0, 255);
+    dBuffer_ = runtime_->mallocDevice(devices_[0], kSize);
+    runtime_->memcpyHostToDevice(defaultStreams_[0], hInit_.data(), dBuffer_, kSize);
+  }
+
+  void TearDown() override {
+    runtime_->freeDevice(devices_[0], dBuffer_);
+    RuntimeFixture::TearDown();
+  }
+
+  std::vector<std::byte> readBack() {
+    std::vector<std::byte> hDst(kSize);
+    runtime_->memcpyDeviceToHost(defaultStreams_[0], dBuffer_, hDst.data(), kSize);
+    runtime_->waitForStream(defaultStreams_[0]);
+    EXPECT_TRUE(runtime_->retrieveStreamErrors(defaultStreams_[0]).empty());
+    return hDst;
+  }
+
+  // not a multiple of a cache line, so the device handles the unaligned head and tail
+  static constexpr size_t kSize = 2 * 1024 * 1024 + 1000;
+  std::vector<std::byte> hInit_;
+  std::byte* dBuffer_;
+};
+
+TEST_F(DeviceMemory, Memset) {
+  // an unaligned range in the middle, the bytes around it must be kept
+  constexpr size_t kOffset = 13;
+  constexpr size_t kLength = kSize - kOffset - 7;
+  runtime_->memsetDevice(defaultStreams_[0], dBuffer_ + kOffset, 0xA5, kLength);
+  auto expected = hInit_;
+  std::memset(expected.data() + kOffset, 0xA5, kLength);
+  ASSERT_EQ(readBack(), expected);
+}
+
+TEST_F(DeviceMemory, Fill) {
+  constexpr uint64_t kPattern = 0x0123456789ABCDEFULL;
+  auto expected = hInit_;
+  // an 8 bytes pattern over the first half and a 2 bytes one over the second, both ending before the buffer end
+  constexpr size_t kHalf = kSize / 2 / 8 * 8;
+  runtime_->fillDevice(defaultStreams_[0], dBuffer_ + 8, kPattern, 8, kHalf - 8);
+  runtime_->fillDevice(defaultStreams_[0], dBuffer_ + kHalf, kPattern, 2, kHalf - 64);
+  for (auto i = 8U; i < kHalf; i += 8) {
+    std::memcpy(expected.data() + i, &kPattern, 8);
+  }
+  for (auto i = kHalf; i < 2 * kHalf - 64; i += 2) {
+    std::memcpy(expected.data() + i, &kPattern, 2);
+  }
+  ASSERT_EQ(readBack(), expected);
+}
+
+TEST_F(DeviceMemory, DeviceToDevice) {
+  // a copy to another buffer, then an overlapping one within it
+  auto dOther = runtime_->mallocDevice(devices_[0], kSize);
+  runtime_->memcpyDeviceToDevice(defaultStreams_[0], dBuffer_, dOther, kSize);
+  std::vector<std::byte> hDst(kSize);
+  runtime_->memcpyDeviceToHost(defaultStreams_[0], dOther, hDst.data(), kSize);
+  runtime_->waitForStream(defaultStreams_[0]);
+  ASSERT_TRUE(runtime_->retrieveStreamErrors(defaultStreams_[0]).empty());
+  ASSERT_EQ(hDst, hInit_);
+  runtime_->freeDevice(devices_[0], dOther);
+
+  constexpr size_t kShift = 4096 + 3;
+  runtime_->memcpyDeviceToDevice(defaultStreams_[0], dBuffer_, dBuffer_ + kShift, kSize - kShift);
+  auto expected = hInit_;
+  std::memmove(expected.data() + kShift, expected.data(), kSize - kShift);
+  ASSERT_EQ(readBack(), expected);
+}
+
+TEST_F(DeviceMemory, KernelHeap) {
+  constexpr size_t kHarts = 2 * 64;
+  constexpr size_t kArenaSize = 64 * 1024;
+  constexpr size_t kHeapSize = 32 * kArenaSize;
+  // two launches of 64 blocks per arena only fit if the arenas are emptied after each kernel
+  constexpr size_t kBlockSize = 512;
+  struct {
+    uint64_t heapBase;
+    uint64_t heapSize;
+    uint64_t blockSize;
+    uint64_t* blocks;
+  } params{0, 0, kBlockSize, nullptr};
+  auto heapKernel = loadKernel("heap.elf");
+  auto dHeap = runtime_->mallocDevice(devices_[0], kHeapSize);
+  auto dBlocks = runtime_->mallocDevice(devices_[0], kHarts * sizeof(uint64_t));
+  params.blocks = reinterpret_cast<uint64_t*>(dBlocks);
+
+  // without a heap the kernel can't allocate
+  runtime_->kernelLaunch(defaultStreams_[0], heapKernel, reinterpret_cast<std::byte*>(&params), sizeof(params), 0x3);
+  runtime_->waitForStream(defaultStreams_[0]);
+  ASSERT_TRUE(runtime_->retrieveStreamErrors(defaultStreams_[0]).empty());
+
+  runtime_->setKernelHeap(defaultStreams_[0], dHeap, kHeapSize);
+  params.heapBase = reinterpret_cast<uint64_t>(dHeap);
+  params.heapSize = kHeapSize;
+  for (auto launch = 0; launch < 2; ++launch) {
+    runtime_->kernelLaunch(defaultStreams_[0], heapKernel, reinterpret_cast<std::byte*>(&params), sizeof(params),
+                           0x3);
+    std::vector<uint64_t> blocks(kHarts);
+    std::vector<std::byte> heap(kHeapSize);
+    runtime_->memcpyDeviceToHost(defaultStreams_[0], dBlocks, reinterpret_cast<std::byte*>(blocks.data()),
+                                 kHarts * sizeof(uint64_t));
+    runtime_->memcpyDeviceToHost(defaultStreams_[0], dHeap, heap.data(), kHeapSize);
+    runtime_->waitForStream(defaultStreams_[0]);
+    ASSERT_TRUE(runtime_->retrieveStreamErrors(defaultStreams_[0]).empty());
+
+    // each hart got its own block from the arena of its shire, holding what it wrote
+    std::vector<uint64_t> sorted;
+    for (auto hart = 0U; hart < kHarts; ++hart) {
+      auto arena = params.heapBase + hart / 64 * kArenaSize;
+      ASSERT_GE(blocks[hart], arena + rt::device_ops_ext::kKernelHeapArenaHeaderSize) << "hart " << hart;
+      ASSERT_LE(blocks[hart] + kBlockSize, arena + kArenaSize) << "hart " << hart;
+      auto offset = blocks[hart] - params.heapBase;
+      for (auto i = 0U; i < kBlockSize; ++i) {
+        ASSERT_EQ(heap[offset + i], static_cast<std::byte>(hart)) << "hart " << hart;
+      }
+      sorted.emplace_back(blocks[hart]);
+    }
+    std::sort(begin(sorted), end(sorted));
+    for (auto i = 1U; i < sorted.size(); ++i) {
+      ASSERT_GE(sorted[i], sorted[i - 1] + kBlockSize);
+    }
+  }
+
+  runtime_->setKernelHeap(defaultStreams_[0], nullptr, 0);
+  runtime_->waitForStream(defaultStreams_[0]);
+  runtime_->freeDevice(devices_[0], dBlocks);
+  runtime_->freeDevice(devices_[0], dHeap);
+}
+
+TEST_F(DeviceMemory, MemoryPool) {
+  // pool memory is used as any other device memory, and reused after a reset
+  auto pool = runtime_->createMemoryPool(devices_[0], kSize);
+  auto dA = pool->allocate(kSize / 2);
+  auto dB = pool->allocate(kSize / 4);
+  runtime_->memcpyHostToDevice(defaultStreams_[0], hInit_.data(), dA, kSize / 2);
+  runtime_->memcpyHostToDevice(defaultStreams_[0], hInit_.data() + kSize / 2, dB, kSize / 4);
+  std::vector<std::byte> hDst(kSize / 2 + kSize / 4);
+  runtime_->memcpyDeviceToHost(defaultStreams_[0], dA, hDst.data(), kSize / 2);
+  runtime_->memcpyDeviceToHost(defaultStreams_[0], dB, hDst.data() + kSize / 2, kSize / 4);
+  runtime_->waitForStream(defaultStreams_[0]);
+  ASSERT_TRUE(runtime_->retrieveStreamErrors(defaultStreams_[0]).empty());
+  ASSERT_TRUE(std::equal(begin(hDst), end(hDst), begin(hInit_)));
+
+  pool->reset();
+  auto dC = pool->allocate(kSize);
+  runtime_->memcpyDeviceToDevice(defaultStreams_[0], dBuffer_, dC, kSize);
+  hDst.resize(kSize);
+  runtime_->memcpyDeviceToHost(defaultStreams_[0], dC, hDst.data(), kSize);
+  runtime_->waitForStream(defaultStreams_[0]);
+  ASSERT_TRUE(runtime_->retrieveStreamErrors(defaultStreams_[0]).empty());
+  ASSERT_EQ(hDst, hInit_);
+  pool.reset();
+}
+
+int main(int argc, char** argv) {
+  RuntimeFixture::ParseArguments(argc, argv);
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,131 @@
+//******************************************************************************
+// Copyright (c) 2025 Ainekko, Co.
+// SPDX-License-Identifier: Apache-2.0
+//------------------------------------------------------------------------------
+
+#include "RuntimeFixture.h"
+#include "Utils.h"
+#include "common/Constants.h"
+#include "runtime/IRuntime.h"
+#include "runtime/Types.h"
+#include <hostUtils/logging/Logger.h>
+
+#include <chrono>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace {
+struct AddVectorParams {
+  void* src1;
+  void* src2;
+  void* dst;
+  int elements;
+};
+} // namespace
+
+struct UploadedGraph : public RuntimeFixture {
+  void SetUp() override {
+    RuntimeFixture::SetUp();
+    addVectorKernel_ = loadKernel("add_vector.elf");
+    hSrc1_.resize(kNumElems);
+    hSrc2_.resize(kNumElems);
+    randomize(hSrc1_, std::numeric_limits<int>::lowest() / 2, std::numeric_limits<int>::max() / 2);
+    randomize(hSrc2_, std::numeric_limits<int>::lowest() / 2, std::numeric_limits<int>::max() / 2);
+    dSrc1_ = runtime_->mallocDevice(devices_[0], kSize);
+    dSrc2_ = runtime_->mallocDevice(devices_[0], kSize);
+    dDst_ = runtime_->mallocDevice(devices_[0], kSize);
+    runtime_->memcpyHostToDevice(defaultStreams_[0], reinterpret_cast<std::byte*>(hSrc2_.data()), dSrc2_, kSize);
+  }
+
+  void TearDown() override {
+    runtime_->freeDevice(devices_[0], dSrc1_);
+    runtime_->freeDevice(devices_[0], dSrc2_);
+    runtime_->freeDevice(devices_[0], dDst_);
+    RuntimeFixture::TearDown();
+  }
+
+  void checkResult(const std::byte* dDst) {
+    std::vector<int> hDst(kNumElems);
+    runtime_->memcpyDeviceToHost(defaultStreams_[0], dDst, reinterpret_cast<std::byte*>(hDst.data()), kSize);
+    runtime_->waitForStream(defaultStreams_[0]);
+    ASSERT_TRUE(runtime_->retrieveStreamErrors(defaultStreams_[0]).empty());
+    for (auto i = 0U; i < kNumElems; ++i) {
+      ASSERT_EQ(hDst[i], hSrc1_[i] + hSrc2_[i]) << "element " << i;
+    }
+  }
+
+  static constexpr size_t kNumElems = 4096;
+  static constexpr size_t kSize = kNumElems * sizeof(int);
+  rt::KernelId addVectorKernel_;
+  std::vector<int> hSrc1_;
+  std::vector<int> hSrc2_;
+  std::byte* dSrc1_;
+  std::byte* dSrc2_;
+  std::byte* dDst_;
+};
+
+TEST_F(UploadedGraph, LaunchWithPatches) {
+  auto hSrc1 = reinterpret_cast<const std::byte*>(hSrc1_.data());
+  runtime_->registerHostBuffer(devices_[0], hSrc1, kSize);
+  AddVectorParams params{dSrc1_, dSrc2_, dDst_, static_cast<int>(kNumElems)};
+  runtime_->beginCapture(defaultStreams_[0]);
+  runtime_->memcpyHostToDevice(defaultStreams_[0], hSrc1, dSrc1_, kSize);
+  runtime_->kernelLaunch(defaultStreams_[0], addVectorKernel_, reinterpret_cast<std::byte*>(&params), sizeof(params),
+                         0x1);
+  auto graph = runtime_->endCapture(defaultStreams_[0]);
+  runtime_->uploadGraph(defaultStreams_[0], graph);
+
+  // the graph as captured, then replayed with the result redirected to another buffer
+  runtime_->launchGraph(defaultStreams_[0], graph);
+  checkResult(dDst_);
+  auto dOtherDst = runtime_->mallocDevice(devices_[0], kSize);
+  runtime_->launchGraph(defaultStreams_[0], graph,
+                        {{0, offsetof(AddVectorParams, dst), reinterpret_cast<uint64_t>(dOtherDst)}});
+  checkResult(dOtherDst);
+
+  runtime_->destroyGraph(graph);
+  runtime_->freeDevice(devices_[0], dOtherDst);
+  runtime_->unregisterHostBuffer(devices_[0], hSrc1);
+}
+
+TEST_F(UploadedGraph, FailedGraphDoesntLeakLaunchOptions) {
+  // the failure is expected, part of the test
+  runtime_->setOnStreamErrorsCallback(nullptr);
+  runtime_->memcpyHostToDevice(defaultStreams_[0], reinterpret_cast<std::byte*>(hSrc1_.data()), dSrc1_, kSize);
+  AddVectorParams params{dSrc1_, dSrc2_, dDst_, static_cast<int>(kNumElems)};
+
+  // the per hart stack of 193 4KB pages split among the 192 harts of 3 shires is not cache line aligned, so the launch
+  // stage fails after the stages carrying its other options, failing the whole command list
+  constexpr uint64_t kBadShireMask = 0x7;
+  constexpr size_t kBadStackSize = 193 * 4096;
+  auto dStack = runtime_->mallocDevice(devices_[0], kBadStackSize, 4096);
+  std::vector<std::byte> badArgs(3 * sizeof(params));
+  rt::KernelLaunchOptions badOptions;
+  badOptions.setShireMask(kBadShireMask);
+  badOptions.setStackConfig(dStack, kBadStackSize);
+  badOptions.setShireArgsStride(sizeof(params));
+  badOptions.setFlushRanges({{dStack, kBadStackSize}});
+  badOptions.setWatchdogTimeout(std::chrono::seconds(1));
+  runtime_->beginCapture(defaultStreams_[0]);
+  runtime_->kernelLaunch(defaultStreams_[0], addVectorKernel_, badArgs.data(), badArgs.size(), badOptions);
+  auto graph = runtime_->endCapture(defaultStreams_[0]);
+  runtime_->uploadGraph(defaultStreams_[0], graph);
+  runtime_->launchGraph(defaultStreams_[0], graph);
+  runtime_->waitForStream(defaultStreams_[0]);
+  ASSERT_EQ(runtime_->retrieveStreamErrors(defaultStreams_[0]).size(), 1UL);
+
+  // both shires compute the whole vector, a second shire reading its arguments at a leaked stride would fail
+  runtime_->kernelLaunch(defaultStreams_[0], addVectorKernel_, reinterpret_cast<std::byte*>(&params), sizeof(params),
+                         0x3);
+  checkResult(dDst_);
+
+  runtime_->destroyGraph(graph);
+  runtime_->freeDevice(devices_[0], dStack);
+}
+
+int main(int argc, char** argv) {
+  RuntimeFixture::ParseArguments(argc, argv);
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,169 @@
+//******************************************************************************
+// Copyright (c) 2025 Ainekko, Co.
+// SPDX-License-Identifier: Apache-2.0
+//------------------------------------------------------------------------------
+
+#include "RuntimeFixture.h"
+#include "Utils.h"
+#include "common/Constants.h"
+#include "runtime/IRuntime.h"
+#include "runtime/Types.h"
+#include <hostUtils/logging/Logger.h>
+
+#include <array>
+#include <chrono>
+#include <limits>
+#include <vector>
+
+namespace {
+struct AddVectorParams {
+  void* src1;
+  void* src2;
+  void* dst;
+  int elements;
+};
+} // namespace
+
+struct KernelLaunch : public RuntimeFixture {
+  void SetUp() override {
+    RuntimeFixture::SetUp();
+    addVectorKernel_ = loadKernel("add_vector.elf");
+    hSrc1_.resize(kNumElems);
+    hSrc2_.resize(kNumElems);
+    randomize(hSrc1_, std::numeric_limits<int>::lowest() / 2, std::numeric_limits<int>::max() / 2);
+    randomize(hSrc2_, std::numeric_limits<int>::lowest() / 2, std::numeric_limits<int>::max() / 2);
+    dSrc1_ = runtime_->mallocDevice(devices_[0], kNumElems * sizeof(int));
+    dSrc2_ = runtime_->mallocDevice(devices_[0], kNumElems * sizeof(int));
+    dDst_ = runtime_->mallocDevice(devices_[0], kNumElems * sizeof(int));
+    runtime_->memcpyHostToDevice(defaultStreams_[0], reinterpret_cast<std::byte*>(hSrc1_.data()), dSrc1_,
+                                 kNumElems * sizeof(int));
+    runtime_->memcpyHostToDevice(defaultStreams_[0], reinterpret_cast<std::byte*>(hSrc2_.data()), dSrc2_,
+                                 kNumElems * sizeof(int));
+  }
+
+  void TearDown() override {
+    runtime_->freeDevice(devices_[0], dSrc1_);
+    runtime_->freeDevice(devices_[0], dSrc2_);
+    runtime_->freeDevice(devices_[0], dDst_);
+    RuntimeFixture::TearDown();
+  }
+
+  // reads back dDst_ and checks elements [begin, end) hold the sum of the sources
+  void checkResult(size_t begin = 0, size_t end = kNumElems) {
+    std::vector<int> hDst(kNumElems);
+    runtime_->memcpyDeviceToHost(defaultStreams_[0], dDst_, reinterpret_cast<std::byte*>(hDst.data()),
+                                 kNumElems * sizeof(int));
+    runtime_->waitForStream(defaultStreams_[0]);
+    ASSERT_TRUE(runtime_->retrieveStreamErrors(defaultStreams_[0]).empty());
+    for (auto i = begin; i < end; ++i) {
+      ASSERT_EQ(hDst[i], hSrc1_[i] + hSrc2_[i]) << "element " << i;
+    }
+  }
+
+  static constexpr size_t kNumElems = 4096;
+  rt::KernelId addVectorKernel_;
+  std::vector<int> hSrc1_;
+  std::vector<int> hSrc2_;
+  std::byte* dSrc1_;
+  std::byte* dSrc2_;
+  std::byte* dDst_;
+};
+
+using KernelLaunchMulti = KernelLaunch;
+
+TEST_F(KernelLaunch, FlushRanges) {
+  AddVectorParams params{dSrc1_, dSrc2_, dDst_, static_cast<int>(kNumElems)};
+  // flush the result in two halves, both must reach memory before the launch completes
+  auto halfSize = kNumElems * sizeof(int) / 2;
+  rt::KernelLaunchOptions options;
+  options.setShireMask(0x1);
+  options.setFlushRanges({{dDst_, halfSize}, {dDst_ + halfSize, halfSize}});
+  runtime_->kernelLaunch(defaultStreams_[0], addVectorKernel_, reinterpret_cast<std::byte*>(&params), sizeof(params),
+                         options);
+  checkResult();
+}
+
+TEST_F(KernelLaunch, TooManyFlushRanges) {
+  std::vector<std::pair<const std::byte*, size_t>> ranges(rt::KernelLaunchOptions::kMaxFlushRanges + 1,
+                                                          {dDst_, sizeof(int)});
+  rt::KernelLaunchOptions options;
+  EXPECT_THROW(options.setFlushRanges(ranges), rt::Exception);
+  EXPECT_THROW(options.setFlushRanges({{dDst_, 0}}), rt::Exception);
+}
+
+TEST_F(KernelLaunch, ShireArgs) {
+  // each shire adds its own half of the vectors, a shire reading the arguments of the other would leave half unwritten
+  constexpr auto kHalf = kNumElems / 2;
+  constexpr auto kHalfSize = kHalf * sizeof(int);
+  std::vector<AddVectorParams> params{
+    {dSrc1_, dSrc2_, dDst_, static_cast<int>(kHalf)},
+    {dSrc1_ + kHalfSize, dSrc2_ + kHalfSize, dDst_ + kHalfSize, static_cast<int>(kHalf)}};
+  runtime_->memsetDevice(defaultStreams_[0], dDst_, 0, kNumElems * sizeof(int));
+  rt::KernelLaunchOptions options;
+  options.setShireMask(0x3);
+  options.setShireArgsStride(sizeof(AddVectorParams));
+  runtime_->kernelLaunch(defaultStreams_[0], addVectorKernel_, reinterpret_cast<std::byte*>(params.data()),
+                         params.size() * sizeof(AddVectorParams), options);
+  checkResult();
+}
+
+TEST_F(KernelLaunch, WatchdogAbortsHungShire) {
+  // the hang is expected, part of the test
+  runtime_->setOnStreamErrorsCallback(nullptr);
+  auto hangKernel = loadKernel("hang.elf");
+  std::array<std::byte, 64> dummyArgs{};
+  rt::KernelLaunchOptions options;
+  options.setShireMask(0x1);
+  options.setWatchdogTimeout(std::chrono::seconds(1));
+  runtime_->kernelLaunch(defaultStreams_[0], hangKernel, dummyArgs.data(), dummyArgs.size(), options);
+
+  // a kernel on another shire is not disturbed by the abort
+  auto otherStream = runtime_->createStream(devices_[0]);
+  AddVectorParams params{dSrc1_, dSrc2_, dDst_, static_cast<int>(kNumElems)};
+  runtime_->kernelLaunch(otherStream, addVectorKernel_, reinterpret_cast<std::byte*>(&params), sizeof(params), 0x2);
+  runtime_->waitForStream(otherStream);
+  EXPECT_TRUE(runtime_->retrieveStreamErrors(otherStream).empty());
+  runtime_->destroyStream(otherStream);
+
+  runtime_->waitForStream(defaultStreams_[0]);
+  auto errors = runtime_->retrieveStreamErrors(defaultStreams_[0]);
+  ASSERT_EQ(errors.size(), 1UL);
+  EXPECT_EQ(errors[0].errorCode_, rt::DeviceErrorCode::KernelLaunchTimeoutHang);
+  ASSERT_TRUE(errors[0].cmShireMask_.has_value());
+  EXPECT_EQ(*errors[0].cmShireMask_, 0x1UL);
+  checkResult();
+
+  // the aborted shire is usable again
+  runtime_->memsetDevice(defaultStreams_[0], dDst_, 0, kNumElems * sizeof(int));
+  runtime_->kernelLaunch(defaultStreams_[0], addVectorKernel_, reinterpret_cast<std::byte*>(&params), sizeof(params),
+                         0x1);
+  checkResult();
+}
+
+TEST_F(KernelLaunchMulti, DisjointShires) {
+  // two kernels side by side, each one adding its own half of the vectors with its arguments in device memory
+  constexpr auto kHalf = kNumElems / 2;
+  constexpr auto kHalfSize = kHalf * sizeof(int);
+  std::array<AddVectorParams, 2> params{
+    {{dSrc1_, dSrc2_, dDst_, static_cast<int>(kHalf)},
+     {dSrc1_ + kHalfSize, dSrc2_ + kHalfSize, dDst_ + kHalfSize, static_cast<int>(kHalf)}}};
+  std::array<std::byte*, 2> dArgs;
+  for (auto i = 0U; i < params.size(); ++i) {
+    dArgs[i] = runtime_->mallocDevice(devices_[0], sizeof(AddVectorParams));
+    runtime_->memcpyHostToDevice(defaultStreams_[0], reinterpret_cast<std::byte*>(&params[i]), dArgs[i],
+                                 sizeof(AddVectorParams));
+  }
+  runtime_->memsetDevice(defaultStreams_[0], dDst_, 0, kNumElems * sizeof(int));
+  runtime_->kernelLaunchMulti(defaultStreams_[0],
+                              {{addVectorKernel_, dArgs[0], 0x1}, {addVectorKernel_, dArgs[1], 0x2}});
+  checkResult();
+  for (auto d : dArgs) {
+    runtime_->freeDevice(devices_[0], d);
+  }
+}
+
+int main(int argc, char** argv) {
+  RuntimeFixture::ParseArguments(argc, argv);
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -6,11 +6,15 @@
 #include "RuntimeFixture.h"
 #include "RuntimeImp.h"
 #include "common/Constants.h"
+#include "runtime/DeviceOpsExt.h"
 #include "runtime/Types.h"
 #include <device-layer/IDeviceLayer.h>
 #include <gtest/gtest.h>
 #include <hostUtils/logging/Logger.h>
+#include <cstring>
 #include <random>
+#include <sys/mman.h>
+#include <unistd.h>
 
 namespace {
 class TestMemcpy : public RuntimeFixture {};
@@ -93,15 +97,11 @@ TEST_F(TestMemcpy, 2GbMemcpy) {
 TEST_F(TestMemcpy, dmaListCheckExceptions) {
   auto dev = devices_[0];
   auto stream = runtime_->createStream(dev);
-  auto dmaInfo = runtime_->getDmaInfo(dev);
+  // lists longer than maxElementCount_ or with ops bigger than maxElementSize_ are split, but they must fit in CMA
   rt::MemcpyList list;
-  list.addOp(nullptr, nullptr, dmaInfo.maxElementSize_ + 1);
-  EXPECT_THROW(runtime_->memcpyHostToDevice(stream, list);, rt::Exception);
-  list.operations_.clear();
-  for (auto i = 0U; i <= dmaInfo.maxElementCount_; ++i) {
-    list.addOp(nullptr, nullptr, 1);
-  }
+  list.addOp(nullptr, nullptr, 1UL << 40);
   EXPECT_THROW(runtime_->memcpyHostToDevice(stream, list);, rt::Exception);
+  EXPECT_THROW(runtime_->memcpyDeviceToHost(stream, list);, rt::Exception);
 }
 
 TEST_F(TestMemcpy, dmaListSimple) {
@@ -147,6 +147,80 @@ TEST_F(TestMemcpy, dmaListSimple) {
   }
 }
 
+TEST_F(TestMemcpy, dmaChainCheckExceptions) {
+  if (sRtType == RtType::MP) {
+    RT_LOG(INFO) << "Skipping this test, chained memcpys are not supported by the multi-process runtime";
+    return;
+  }
+  auto dev = devices_[0];
+  auto stream = runtime_->createStream(dev);
+  rt::MemcpyList empty;
+  EXPECT_THROW(runtime_->memcpyHostToDeviceChained(stream, empty), rt::Exception);
+  EXPECT_THROW(runtime_->memcpyDeviceToHostChained(stream, empty), rt::Exception);
+  // one element per op, since they don't continue each other
+  rt::MemcpyList tooLong;
+  std::vector<std::byte> host(2 * (rt::device_ops_ext::kMaxDmaChainElems + 1));
+  auto dst = reinterpret_cast<std::byte*>(0x8000000000UL);
+  for (auto i = 0UL; i <= rt::device_ops_ext::kMaxDmaChainElems; ++i) {
+    tooLong.addOp(host.data() + 2 * i, dst + 4 * i, 1);
+  }
+  EXPECT_THROW(runtime_->memcpyHostToDeviceChained(stream, tooLong), rt::Exception);
+}
+
+TEST_F(TestMemcpy, dmaChainSimple) {
+  if (sRtType == RtType::MP) {
+    RT_LOG(INFO) << "Skipping this test, chained memcpys are not supported by the multi-process runtime";
+    return;
+  }
+  auto dev = devices_[0];
+  auto stream = runtime_->createStream(dev);
+  auto dmaInfo = deviceLayer_->getDmaInfo(static_cast<int>(dev));
+  // more ops than a DMA list command takes, scattered in a single allocation so none of them are merged
+  auto opCount = 4UL * dmaInfo.maxElementCount_;
+  auto stride = 256UL;
+  auto deviceMem = runtime_->mallocDevice(dev, opCount * stride);
+  std::mt19937 gen(std::random_device{}());
+  std::uniform_int_distribution dis(1UL, stride / 2);
+  std::vector<std::vector<std::byte>> hostMemSrc;
+  std::vector<std::vector<std::byte>> hostMemDst;
+  rt::MemcpyList listH2D;
+  rt::MemcpyList listD2H;
+  for (auto i = 0UL; i < opCount; ++i) {
+    auto opSize = dis(gen);
+    std::vector<std::byte> src(opSize);
+    for (auto& b : src) {
+      b = std::byte(dis(gen) % 256);
+    }
+    hostMemSrc.emplace_back(std::move(src));
+    hostMemDst.emplace_back(opSize);
+  }
+  for (auto i = 0UL; i < opCount; ++i) {
+    listH2D.addOp(hostMemSrc[i].data(), deviceMem + i * stride, hostMemSrc[i].size());
+    listD2H.addOp(deviceMem + i * stride, hostMemDst[i].data(), hostMemDst[i].size());
+  }
+  runtime_->memcpyHostToDeviceChained(stream, listH2D);
+  runtime_->memcpyDeviceToHostChained(stream, listD2H);
+  ASSERT_TRUE(runtime_->waitForStream(stream));
+  ASSERT_TRUE(runtime_->retrieveStreamErrors(stream).empty());
+
+  // the regular list memcpy reads the same data back
+  std::vector<std::vector<std::byte>> hostMemCheck;
+  rt::MemcpyList listCheck;
+  for (auto i = 0UL; i < opCount; ++i) {
+    hostMemCheck.emplace_back(hostMemSrc[i].size());
+  }
+  for (auto i = 0UL; i < opCount; ++i) {
+    listCheck.addOp(deviceMem + i * stride, hostMemCheck[i].data(), hostMemCheck[i].size());
+  }
+  runtime_->memcpyDeviceToHost(stream, listCheck);
+  ASSERT_TRUE(runtime_->waitForStream(stream));
+  for (auto i = 0UL; i < opCount; ++i) {
+    ASSERT_EQ(hostMemSrc[i], hostMemDst[i]) << "op " << i;
+    ASSERT_EQ(hostMemSrc[i], hostMemCheck[i]) << "op " << i;
+  }
+  runtime_->freeDevice(dev, deviceMem);
+}
+
 TEST_F(TestMemcpy, memcpyD2DCheckExceptions) {
   if (sDlType != RuntimeFixture::DeviceLayerImp::PCIE) { // force multidevice if its not PCIE
     numDevices_ = 2;
@@ -237,6 +311,70 @@ TEST_F(TestMemcpy, simpleMemcpyD2D) {
   ASSERT_EQ(random_trash, result);
 }
 
+TEST_F(TestMemcpy, coalescedMemcpys) {
+  std::mt19937 gen(std::random_device{}());
+  std::uniform_int_distribution<int> dis(0, 255);
+
+  constexpr auto kNumCopies = 1000UL;
+  constexpr auto kCopySize = 4096UL + 64;
+  auto dev = devices_[0];
+  auto stream = runtime_->createStream(dev);
+  auto src = std::vector<std::byte>(kNumCopies * kCopySize);
+  for (auto& b : src) {
+    b = static_cast<std::byte>(dis(gen));
+  }
+  auto d_buffer = runtime_->mallocDevice(dev, src.size());
+  runtime_->setMemcpyCoalescing(stream, true);
+
+  // small copies merged in lists; the copies back go in reverse order, each one to its own place
+  for (auto i = 0UL; i < kNumCopies; ++i) {
+    runtime_->memcpyHostToDevice(stream, src.data() + i * kCopySize, d_buffer + i * kCopySize, kCopySize, false);
+  }
+  auto result = std::vector<std::byte>(src.size());
+  for (auto i = kNumCopies; i-- > 0;) {
+    runtime_->memcpyDeviceToHost(stream, d_buffer + i * kCopySize, result.data() + i * kCopySize, kCopySize, false);
+  }
+  runtime_->waitForStream(stream);
+  ASSERT_TRUE(runtime_->retrieveStreamErrors(stream).empty());
+  ASSERT_EQ(src, result);
+
+  runtime_->setMemcpyCoalescing(stream, false);
+  runtime_->freeDevice(dev, d_buffer);
+  runtime_->destroyStream(stream);
+}
+
+TEST_F(TestMemcpy, toDeviceOnlyHostBuffer) {
+  std::mt19937 gen(std::random_device{}());
+  std::uniform_int_distribution<int> dis(0, 255);
+
+  auto dev = devices_[0];
+  auto stream = defaultStreams_[0];
+  auto size = 16 * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  auto memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  ASSERT_NE(memory, MAP_FAILED);
+  auto h_src = static_cast<std::byte*>(memory);
+  for (auto i = 0UL; i < size; ++i) {
+    h_src[i] = static_cast<std::byte>(dis(gen));
+  }
+  // read-only memory can only be registered without write access
+  ASSERT_EQ(mprotect(memory, size, PROT_READ), 0);
+  runtime_->registerHostBuffer(dev, h_src, size, true);
+  auto d_buffer = runtime_->mallocDevice(dev, size);
+  EXPECT_TRUE(runtime_->waitForEvent(runtime_->memcpyHostToDevice(stream, h_src, d_buffer, size)));
+
+  // D2H memcpys into a writeable buffer registered to device only go through CMA
+  auto result = std::vector<std::byte>(size);
+  runtime_->registerHostBuffer(dev, result.data(), result.size(), true);
+  EXPECT_TRUE(runtime_->waitForEvent(runtime_->memcpyDeviceToHost(stream, d_buffer, result.data(), size)));
+  EXPECT_TRUE(runtime_->retrieveStreamErrors(stream).empty());
+  EXPECT_EQ(std::memcmp(result.data(), h_src, size), 0);
+
+  runtime_->unregisterHostBuffer(dev, result.data());
+  runtime_->unregisterHostBuffer(dev, h_src);
+  runtime_->freeDevice(dev, d_buffer);
+  munmap(memory, size);
+}
+
 int main(int argc, char** argv) {
   RuntimeFixture::ParseArguments(argc, argv);
   testing::InitGoogleTest(&argc, argv);
@@ -15,6 +15,7 @@
 
 #include <cereal/archives/binary.hpp>
 #include <cereal/archives/json.hpp>
+#include <cereal/archives/portable_binary.hpp>
 #include <gtest/gtest.h>
 
 #include <fstream>
@@ -111,6 +112,56 @@ TEST(Profiler, add_2_vectors_profiling) {
   LOG(INFO) << "Trace: " << str;
 }
 
+TEST(Profiler, record_from_multiple_threads) {
+  constexpr auto kNumThreads = 4;
+  constexpr auto kNumEvents = 5000; // more than fit in the thread rings, so some go through the overflow queues
+  std::stringstream ss;
+  {
+    profiling::ProfilerImp profiler;
+    profiler.start(ss, rt::IProfiler::OutputType::Binary);
+    std::vector<std::thread> threads;
+    for (auto t = 0; t < kNumThreads; ++t) {
+      threads.emplace_back([&profiler, t] {
+        profiling::IProfilerRecorder::setCurrentThreadName("test thread " + std::to_string(t));
+        for (auto i = 0; i < kNumEvents; ++i) {
+          profiling::ProfileEvent evt(profiling::Type::Instant, profiling::Class::KernelLaunch);
+          evt.setEvent(EventId{static_cast<uint16_t>(i)});
+          evt.setDeviceId(DeviceId{t});
+          evt.setDuration(std::chrono::microseconds(i));
+          profiler.record(evt);
+        }
+      });
+    }
+    for (auto& th : threads) {
+      th.join();
+    }
+    profiler.stop();
+  }
+
+  cereal::PortableBinaryInputArchive archive(ss);
+  profiling::ProfileEvent evt;
+  archive(evt);
+  EXPECT_EQ(evt.getClass(), profiling::Class::StartProfiling);
+  std::vector<int> launches(kNumThreads);
+  auto identifiedThreads = 0;
+  while (evt.getClass() != profiling::Class::EndProfiling) {
+    ASSERT_NO_THROW(archive(evt));
+    if (evt.getClass() == profiling::Class::KernelLaunch) {
+      auto device = static_cast<int>(evt.getDeviceId().value());
+      ASSERT_LT(device, kNumThreads);
+      auto i = static_cast<int>(evt.getEvent().value());
+      EXPECT_EQ(evt.getDuration(), std::chrono::microseconds(i));
+      // the events of each thread keep their order, even those which overflowed its ring
+      ASSERT_EQ(i, launches[static_cast<size_t>(device)]);
+      ++launches[static_cast<size_t>(device)];
+    } else if (evt.getClass() == profiling::Class::IdentifyThread) {
+      ++identifiedThreads;
+    }
+  }
+  EXPECT_EQ(launches, std::vector<int>(kNumThreads, kNumEvents));
+  EXPECT_EQ(identifiedThreads, kNumThreads);
+}
+
 class ProfileEventDeserializationTest : public ::testing::Test {
 protected:
   void SetUp() override {
@@ -0,0 +1,88 @@
+//******************************************************************************
+// Copyright (c) 2025 Ainekko, Co.
+// SPDX-License-Identifier: Apache-2.0
+//------------------------------------------------------------------------------
+
+#include "RuntimeFixture.h"
+#include "runtime/IRuntime.h"
+#include <device-layer/IDeviceLayer.h>
+#include <gtest/gtest.h>
+#include <random>
+
+namespace {
+
+// The firmware boots and serves the runtime, and the kernels run, with the scalar code going through translated
+// blocks (sys_emu -translate). Both with the default quantum, where every block resumes after one instruction, and
+// with a larger one, where the harts run whole blocks.
+class TestTranslate : public RuntimeFixture, public testing::WithParamInterface<const char*> {
+public:
+  TestTranslate() {
+    sysEmuAdditionalOptions_ = {"-translate", "-quantum", GetParam()};
+  }
+};
+
+} // namespace
+
+TEST_P(TestTranslate, memcpyRoundTrip) {
+  auto dev = devices_[0];
+  auto stream = defaultStreams_[0];
+  constexpr auto kSize = 1UL << 20;
+  std::vector<std::byte> src(kSize);
+  std::vector<std::byte> dst(kSize);
+  std::mt19937 gen(std::random_device{}());
+  std::uniform_int_distribution dis(0, 255);
+  for (auto& b : src) {
+    b = std::byte(dis(gen));
+  }
+  auto devBuf = runtime_->mallocDevice(dev, kSize);
+  runtime_->memcpyHostToDevice(stream, src.data(), devBuf, kSize);
+  runtime_->memcpyDeviceToHost(stream, devBuf, dst.data(), kSize);
+  ASSERT_TRUE(runtime_->waitForStream(stream));
+  ASSERT_EQ(src, dst);
+  runtime_->freeDevice(dev, devBuf);
+}
+
+TEST_P(TestTranslate, addVector) {
+  auto dev = devices_[0];
+  auto stream = defaultStreams_[0];
+  auto kernel = loadKernel("add_vector.elf");
+  constexpr auto kNumElems = 10496;
+  std::vector<int> vA(kNumElems);
+  std::vector<int> vB(kNumElems);
+  std::vector<int> vExpected(kNumElems);
+  std::vector<int> vResult(kNumElems);
+  randomize(vA, std::numeric_limits<int>::lowest() / 2, std::numeric_limits<int>::max() / 2);
+  randomize(vB, std::numeric_limits<int>::lowest() / 2, std::numeric_limits<int>::max() / 2);
+  for (auto i = 0; i < kNumElems; ++i) {
+    vExpected[i] = vA[i] + vB[i];
+  }
+  auto bufferSize = kNumElems * sizeof(int);
+  auto bufA = runtime_->mallocDevice(dev, bufferSize);
+  auto bufB = runtime_->mallocDevice(dev, bufferSize);
+  auto bufResult = runtime_->mallocDevice(dev, bufferSize);
+  struct {
+    void* vA;
+    void* vB;
+    void* vResult;
+    int numElements;
+  } params{bufA, bufB, bufResult, kNumElems};
+  runtime_->memcpyHostToDevice(stream, reinterpret_cast<std::byte*>(vA.data()), bufA, bufferSize);
+  runtime_->memcpyHostToDevice(stream, reinterpret_cast<std::byte*>(vB.data()), bufB, bufferSize);
+  runtime_->kernelLaunch(stream, kernel, reinterpret_cast<std::byte*>(&params), sizeof(params), 0x3);
+  runtime_->memcpyDeviceToHost(stream, bufResult, reinterpret_cast<std::byte*>(vResult.data()), bufferSize);
+  ASSERT_TRUE(runtime_->waitForStream(stream));
+  ASSERT_TRUE(runtime_->retrieveStreamErrors(stream).empty());
+  EXPECT_EQ(vResult, vExpected);
+  runtime_->unloadCode(kernel);
+  runtime_->freeDevice(dev, bufA);
+  runtime_->freeDevice(dev, bufB);
+  runtime_->freeDevice(dev, bufResult);
+}
+
+INSTANTIATE_TEST_SUITE_P(Quantum, TestTranslate, testing::Values("1", "64"));
+
+int main(int argc, char** argv) {
+  RuntimeFixture::ParseArguments(argc, argv);
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
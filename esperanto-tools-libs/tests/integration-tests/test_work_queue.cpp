@@ -0,0 +1,92 @@
+//******************************************************************************
+// Copyright (c) 2025 Ainekko, Co.
+// SPDX-License-Identifier: Apache-2.0
+//------------------------------------------------------------------------------
+
+#include "RuntimeFixture.h"
+#include "Utils.h"
+#include "common/Constants.h"
+#include "runtime/IRuntime.h"
+#include "runtime/Types.h"
+#include "runtime/WorkQueue.h"
+#include <hostUtils/logging/Logger.h>
+
+#include <chrono>
+#include <limits>
+#include <vector>
+
+namespace {
+// WorkItem of the work_queue kernel
+struct WorkItem {
+  const int* a;
+  const int* b;
+  int* result;
+  uint64_t numElements;
+};
+} // namespace
+
+struct PersistentKernel : public RuntimeFixture {};
+
+TEST_F(PersistentKernel, RunsPushedItems) {
+  // more items than slots, so the host reuses slots as the kernel completes items
+  constexpr size_t kItems = 64;
+  constexpr uint32_t kSlots = 16;
+  constexpr size_t kElems = 256;
+  constexpr size_t kSize = kItems * kElems * sizeof(int);
+  std::vector<int> hSrc1(kItems * kElems);
+  std::vector<int> hSrc2(kItems * kElems);
+  randomize(hSrc1, std::numeric_limits<int>::lowest() / 2, std::numeric_limits<int>::max() / 2);
+  randomize(hSrc2, std::numeric_limits<int>::lowest() / 2, std::numeric_limits<int>::max() / 2);
+  auto dSrc1 = runtime_->mallocDevice(devices_[0], kSize);
+  auto dSrc2 = runtime_->mallocDevice(devices_[0], kSize);
+  auto dDst = runtime_->mallocDevice(devices_[0], kSize);
+  runtime_->memcpyHostToDevice(defaultStreams_[0], reinterpret_cast<std::byte*>(hSrc1.data()), dSrc1, kSize);
+  runtime_->memcpyHostToDevice(defaultStreams_[0], reinterpret_cast<std::byte*>(hSrc2.data()), dSrc2, kSize);
+  runtime_->waitForStream(defaultStreams_[0]);
+
+  rt::WorkQueue queue(*runtime_, devices_[0], kSlots, sizeof(WorkItem));
+  auto kernel = loadKernel("work_queue.elf");
+  auto wq = queue.getDeviceAddress();
+  runtime_->kernelLaunch(defaultStreams_[0], kernel, reinterpret_cast<std::byte*>(&wq), sizeof(wq), 0x1);
+
+  uint64_t last = 0;
+  for (auto i = 0U; i < kItems; ++i) {
+    auto offset = i * kElems * sizeof(int);
+    WorkItem item{reinterpret_cast<int*>(dSrc1 + offset), reinterpret_cast<int*>(dSrc2 + offset),
+                  reinterpret_cast<int*>(dDst + offset), kElems};
+    last = queue.push(reinterpret_cast<std::byte*>(&item), sizeof(item));
+    ASSERT_EQ(last, i);
+  }
+  ASSERT_TRUE(queue.waitForCompleted(kItems, std::chrono::seconds(60)));
+  ASSERT_EQ(queue.getStatus(last), 0);
+  EXPECT_THROW(queue.getStatus(0), rt::Exception);
+  queue.stop();
+  EXPECT_THROW(queue.push(nullptr, 0), rt::Exception);
+  ASSERT_TRUE(runtime_->waitForStream(defaultStreams_[0]));
+
+  std::vector<int> hDst(kItems * kElems);
+  runtime_->memcpyDeviceToHost(defaultStreams_[0], dDst, reinterpret_cast<std::byte*>(hDst.data()), kSize);
+  runtime_->waitForStream(defaultStreams_[0]);
+  ASSERT_TRUE(runtime_->retrieveStreamErrors(defaultStreams_[0]).empty());
+  for (auto i = 0U; i < hDst.size(); ++i) {
+    ASSERT_EQ(hDst[i], hSrc1[i] + hSrc2[i]) << "element " << i;
+  }
+  runtime_->freeDevice(devices_[0], dSrc1);
+  runtime_->freeDevice(devices_[0], dSrc2);
+  runtime_->freeDevice(devices_[0], dDst);
+}
+
+TEST_F(PersistentKernel, InvalidQueues) {
+  EXPECT_THROW(rt::WorkQueue(*runtime_, devices_[0], 0, 32), rt::Exception);
+  EXPECT_THROW(rt::WorkQueue(*runtime_, devices_[0], 16, 0), rt::Exception);
+  EXPECT_THROW(rt::WorkQueue(*runtime_, devices_[0], 16, 12), rt::Exception);
+  rt::WorkQueue queue(*runtime_, devices_[0], 16, 32);
+  std::vector<std::byte> item(40);
+  EXPECT_THROW(queue.push(item.data(), item.size()), rt::Exception);
+}
+
+int main(int argc, char** argv) {
+  RuntimeFixture::ParseArguments(argc, argv);
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,78 @@
+//******************************************************************************
+// Copyright (c) 2025 Ainekko, Co.
+// SPDX-License-Identifier: Apache-2.0
+//------------------------------------------------------------------------------
+#include "RuntimeFixture.h"
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace testing;
+
+namespace {
+constexpr auto kNumDevices = 4;
+constexpr auto kSubmissionsPerThread = 2000U;
+constexpr auto kMemcpySize = 1U << 10;
+// adding submitters must not lower the aggregated rate; a single runtime lock would keep it flat at best, with the
+// contention making it drop. Kept below 1 so a loaded machine doesn't fail the test
+constexpr auto kMinScaling = 0.9;
+} // namespace
+
+// Each thread submits to its own device; since runtime locks are per device, the aggregated submission rate should
+// scale with the number of threads instead of being serialized by a single runtime lock
+struct StressSubmit : RuntimeFixture {
+  void SetUp() override {
+    numDevices_ = kNumDevices;
+    RuntimeFixture::SetUp();
+  }
+
+  double runSubmitters(size_t numThreads) {
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (auto i = 0U; i < numThreads; ++i) {
+      threads.emplace_back([this, i] {
+        auto device = devices_[i];
+        auto stream = defaultStreams_[i];
+        auto dst = runtime_->mallocDevice(device, kMemcpySize);
+        std::vector<std::byte> src(kMemcpySize);
+        std::vector<rt::EventId> events;
+        events.reserve(kSubmissionsPerThread);
+        for (auto j = 0U; j < kSubmissionsPerThread; ++j) {
+          events.emplace_back(runtime_->memcpyHostToDevice(stream, src.data(), dst, kMemcpySize));
+        }
+        EXPECT_TRUE(runtime_->waitForStream(stream));
+        // every submitted command has to be completed, not only the last one
+        for (auto event : events) {
+          EXPECT_TRUE(runtime_->waitForEvent(event, std::chrono::seconds(0)));
+        }
+        EXPECT_TRUE(runtime_->retrieveStreamErrors(stream).empty());
+        runtime_->freeDevice(device, dst);
+      });
+    }
+    for (auto& t : threads) {
+      t.join();
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return static_cast<double>(numThreads * kSubmissionsPerThread) / elapsed;
+  }
+};
+
+TEST_F(StressSubmit, memcpy_submission_rate_1_to_N_threads) {
+  auto singleRate = 0.0;
+  for (auto numThreads = 1U; numThreads <= devices_.size(); ++numThreads) {
+    auto rate = runSubmitters(numThreads);
+    RT_LOG(INFO) << "Threads: " << numThreads << " submissions/s: " << rate
+                 << " (per thread: " << rate / numThreads << ")";
+    if (numThreads == 1) {
+      singleRate = rate;
+    } else if (numThreads <= std::thread::hardware_concurrency()) {
+      EXPECT_GE(rate, singleRate * kMinScaling) << "Threads: " << numThreads;
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  RuntimeFixture::ParseArguments(argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -9,6 +9,7 @@
 
 #include <gtest/gtest.h>
 #include <hostUtils/logging/Logging.h>
+#include <tools/Histogram.h>
 #include <tools/IBenchmarker.h>
 
 TEST(BenchmarkerTool, fake) {
@@ -23,6 +24,69 @@ TEST(BenchmarkerTool, fake) {
   runBenchmarker(rt.get(), options);
 }
 
+TEST(BenchmarkerTool, fakeWithLatencyModel) {
+  auto params = dev::DeviceLayerFake::Parameters::getDefault();
+  params.latency_.kernelLaunch_ = std::chrono::microseconds(20);
+  params.latency_.dmaCommand_ = std::chrono::microseconds(2);
+  params.latency_.otherCommand_ = std::chrono::microseconds(1);
+  params.latency_.dmaBytesPerSecond_ = 16ULL << 30;
+  params.latency_.sqDepth_ = 64;
+  params.latency_.cqBatch_ = 8;
+  auto deviceLayer = std::shared_ptr<dev::IDeviceLayer>(new dev::DeviceLayerFake(1, params));
+  rt::IBenchmarker::Options options;
+  options.bytesD2H = 1 << 20;
+  options.bytesH2D = 1 << 20;
+  options.numWorkloadsPerThread = 100;
+  options.numThreads = 8;
+  options.useDmaBuffers = false;
+  auto rt = rt::IRuntime::create(deviceLayer, rt::Options{true, false});
+  runBenchmarker(rt.get(), options);
+}
+
+TEST(BenchmarkerTool, fakePipelinedWithHistograms) {
+  auto params = dev::DeviceLayerFake::Parameters::getDefault();
+  params.latency_.dmaCommand_ = std::chrono::microseconds(5);
+  params.latency_.dmaBytesPerSecond_ = 8ULL << 30;
+  auto deviceLayer = std::shared_ptr<dev::IDeviceLayer>(new dev::DeviceLayerFake(1, params));
+  rt::IBenchmarker::Options options;
+  options.bytesD2H = 1 << 20;
+  options.bytesH2D = 1 << 20;
+  options.numWorkloadsPerThread = 50;
+  options.numThreads = 2;
+  options.pipelineDepth = 4;
+  options.cpuAffinity = {0};
+  options.computeHistograms = true;
+  auto rt = rt::IRuntime::create(deviceLayer, rt::Options{true, false});
+  auto res = rt::IBenchmarker::create(rt.get())->run(options);
+  ASSERT_EQ(res.workerResults.size(), 2);
+  EXPECT_EQ(res.latencies["h2d"].count(), 100);
+  EXPECT_EQ(res.latencies["d2h"].count(), 100);
+  EXPECT_EQ(res.latencies["workload"].count(), 100);
+  EXPECT_EQ(res.latencies.count("kernel"), 0);
+  EXPECT_LE(res.latencies["h2d"].valueAtPercentile(50), res.latencies["h2d"].max());
+}
+
+TEST(Histogram, percentiles) {
+  rt::Histogram h;
+  EXPECT_EQ(h.valueAtPercentile(50), 0);
+  for (auto v = 1UL; v <= 1000000; ++v) {
+    h.record(v * 1000);
+  }
+  EXPECT_EQ(h.count(), 1000000);
+  EXPECT_EQ(h.min(), 1000);
+  EXPECT_EQ(h.max(), 1000000000);
+  EXPECT_NEAR(h.valueAtPercentile(50), 500000000, 500000000 / 1000);
+  EXPECT_NEAR(h.valueAtPercentile(99.9), 999000000, 999000000 / 1000);
+  EXPECT_EQ(h.valueAtPercentile(100), 1000000000);
+
+  rt::Histogram other;
+  other.record(5, 10);
+  h.merge(other);
+  EXPECT_EQ(h.count(), 1000010);
+  EXPECT_EQ(h.min(), 5);
+  EXPECT_EQ(h.valueAtPercentile(0.0001), 5);
+}
+
 int main(int argc, char** argv) {
   logging::LoggerDefault logger_;
   g3::log_levels::disable(DEBUG);
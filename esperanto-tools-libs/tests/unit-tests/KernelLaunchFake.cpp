@@ -7,6 +7,7 @@
 #include "runtime/DeviceLayerFake.h"
 #include "runtime/IRuntime.h"
 #include "runtime/Types.h"
+#include <atomic>
 #include <chrono>
 #include <functional>
 #include <gtest/gtest.h>
@@ -110,6 +111,25 @@ TEST_F(KernelLaunchF, onlyKernels10K_waitIters) {
   send_K(1e4, 32, true);
 }
 
+TEST_F(KernelLaunchF, concurrentLaunches) {
+  // execution context buffers are taken and released from several threads at once
+  std::vector<std::thread> threads;
+  for (auto t = 0; t < 4; ++t) {
+    threads.emplace_back([this] {
+      auto st = runtime_->createStream(device_);
+      std::vector<std::byte> args(32);
+      for (auto i = 0; i < 2000; ++i) {
+        runtime_->kernelLaunch(st, kernel_, args.data(), args.size(), 0x3);
+      }
+      EXPECT_TRUE(runtime_->waitForStream(st));
+      runtime_->destroyStream(st);
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+}
+
 TEST_F(KernelLaunchF, simpleOptions) {
   constexpr size_t kTraceBytesPerHart = 4096;
   constexpr size_t kNumHarts = 2048;
@@ -137,6 +157,290 @@ TEST_F(KernelLaunchF, simpleOptions) {
   sendH2D_K_D2H_WithOptions(1, 64, 1024, opts);
 }
 
+TEST_F(KernelLaunchF, flushRanges) {
+  constexpr auto kSize = 4096UL;
+  auto output = runtime_->mallocDevice(device_, 2 * kSize);
+
+  KernelLaunchOptions opts;
+  opts.setShireMask(0x3);
+  opts.setFlushRanges({{output, kSize}, {output + kSize, 64}});
+  sendH2D_K_D2H_WithOptions(10, 64, 1024, opts);
+  EXPECT_TRUE(runtime_->retrieveStreamErrors(stream_).empty());
+
+  // ranges out of the allocations are refused when checking the device operations
+  static_cast<RuntimeImp*>(runtime_.get())->setCheckMemcpyDeviceAddress(true);
+  KernelLaunchOptions badOpts;
+  badOpts.setShireMask(0x3);
+  badOpts.setFlushRanges({{output + kSize, 2 * kSize}});
+  EXPECT_THROW(runtime_->kernelLaunch(stream_, kernel_, dummy_.data(), 64, badOpts), rt::Exception);
+  runtime_->freeDevice(device_, output);
+}
+
+TEST_F(KernelLaunchF, shireArgs) {
+  // one 32 bytes slice for each of the two shires
+  KernelLaunchOptions opts;
+  opts.setShireMask(0x3);
+  opts.setShireArgsStride(32);
+  sendH2D_K_D2H_WithOptions(10, 64, 1024, opts);
+  EXPECT_TRUE(runtime_->retrieveStreamErrors(stream_).empty());
+
+  // the arguments must have a slice per shire
+  EXPECT_THROW(runtime_->kernelLaunch(stream_, kernel_, dummy_.data(), 32, opts), rt::Exception);
+}
+
+TEST_F(KernelLaunchF, watchdog) {
+  // the fake device completes the kernel before the watchdog expires
+  KernelLaunchOptions opts;
+  opts.setWatchdogTimeout(std::chrono::seconds{10});
+  sendH2D_K_D2H_WithOptions(10, 64, 1024, opts);
+  EXPECT_TRUE(runtime_->retrieveStreamErrors(stream_).empty());
+}
+
+TEST_F(KernelLaunchF, launchConfig) {
+  KernelLaunchOptions opts;
+  opts.setShireMask(0x3);
+  opts.setNoTensorOps(true);
+  opts.setShireCacheConfig(0x80, 0x100);
+  opts.setLaunchPrefetch(true);
+  opts.setReportAndContinue(true);
+  sendH2D_K_D2H_WithOptions(10, 64, 1024, opts);
+  EXPECT_TRUE(runtime_->retrieveStreamErrors(stream_).empty());
+}
+
+TEST_F(KernelLaunchF, powerReport) {
+  dummy_.resize(64);
+  KernelLaunchOptions opts;
+  opts.setShireMask(0x3);
+  opts.setPowerReport(true);
+  auto reported = runtime_->kernelLaunch(stream_, kernel_, dummy_.data(), 64, opts);
+  auto notReported = runtime_->kernelLaunch(stream_, kernel_, dummy_.data(), 64, 0x3);
+  EXPECT_TRUE(runtime_->waitForStream(stream_));
+  EXPECT_TRUE(runtime_->retrieveStreamErrors(stream_).empty());
+  // the fake device reports no throttling
+  auto state = runtime_->getEventPowerState(reported);
+  ASSERT_TRUE(state);
+  EXPECT_EQ(state->device_, device_);
+  EXPECT_FALSE(state->wasThrottled());
+  EXPECT_FALSE(runtime_->getEventPowerState(notReported));
+}
+
+TEST_F(KernelLaunchF, shireBudgetPolicy) {
+  EXPECT_EQ(runtime_->getShireBudget(device_), 0);
+  EXPECT_THROW(runtime_->setShireBudget(device_, -1), rt::Exception);
+  std::atomic<int> calls = 0;
+  runtime_->setShireBudgetPolicy([&calls](const KernelPowerState& state, int budget) {
+    ++calls;
+    return state.wasThrottled() ? budget / 2 : 8;
+  });
+  dummy_.resize(64);
+  KernelLaunchOptions opts;
+  opts.setShireCount(4);
+  opts.setPowerReport(true);
+  for (auto i = 0; i < 10; ++i) {
+    runtime_->kernelLaunch(stream_, kernel_, dummy_.data(), 64, opts);
+  }
+  EXPECT_TRUE(runtime_->waitForStream(stream_));
+  EXPECT_TRUE(runtime_->retrieveStreamErrors(stream_).empty());
+  EXPECT_EQ(calls, 10);
+  EXPECT_EQ(runtime_->getShireBudget(device_), 8);
+  runtime_->setShireBudgetPolicy({});
+  runtime_->setShireBudget(device_, 0);
+  EXPECT_EQ(runtime_->getShireBudget(device_), 0);
+}
+
+TEST_F(KernelLaunchF, shireCount) {
+  // launches from several streams share the shires, the ones not fitting wait for the previous kernels
+  KernelLaunchOptions opts;
+  opts.setShireCount(4);
+  std::vector<std::thread> threads;
+  for (auto t = 0; t < 4; ++t) {
+    threads.emplace_back([this, &opts] {
+      auto st = runtime_->createStream(device_);
+      for (auto i = 0; i < 500; ++i) {
+        runtime_->kernelLaunch(st, kernel_, dummy_.data(), 64, opts);
+      }
+      EXPECT_TRUE(runtime_->waitForStream(st));
+      EXPECT_TRUE(runtime_->retrieveStreamErrors(st).empty());
+      runtime_->destroyStream(st);
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  KernelLaunchOptions badOpts;
+  badOpts.setShireCount(65);
+  EXPECT_THROW(runtime_->kernelLaunch(stream_, kernel_, dummy_.data(), 64, badOpts), rt::Exception);
+}
+
+TEST_F(KernelLaunchF, shirePartition) {
+  auto rt = static_cast<RuntimeImp*>(runtime_.get());
+  KernelLaunchOptionsImp imp;
+  imp.shirePartition_ = 0xF0;
+  imp.shireMask_ = 0x30;
+  EXPECT_NO_THROW(runtime_->kernelLaunch(stream_, kernel_, dummy_.data(), 64, rt->createKernelLaunchOptions(imp)));
+  imp.shireMask_ = 0x18;
+  EXPECT_THROW(runtime_->kernelLaunch(stream_, kernel_, dummy_.data(), 64, rt->createKernelLaunchOptions(imp)),
+               rt::Exception);
+
+  // the shires are chosen within the partition
+  imp.shireCount_ = 4;
+  EXPECT_NO_THROW(runtime_->kernelLaunch(stream_, kernel_, dummy_.data(), 64, rt->createKernelLaunchOptions(imp)));
+  imp.shireCount_ = 5;
+  EXPECT_THROW(runtime_->kernelLaunch(stream_, kernel_, dummy_.data(), 64, rt->createKernelLaunchOptions(imp)),
+               rt::Exception);
+  EXPECT_TRUE(runtime_->waitForStream(stream_));
+}
+
+TEST_F(KernelLaunchF, kernelLaunchMulti) {
+  constexpr auto kArgsSize = 64UL;
+  auto args = runtime_->mallocDevice(device_, 2 * kArgsSize);
+  std::vector<LaunchDesc> launches{{kernel_, args, 0x1}, {kernel_, args + kArgsSize, 0x2}};
+  for (auto i = 0; i < 100; ++i) {
+    runtime_->kernelLaunchMulti(stream_, launches);
+  }
+  EXPECT_TRUE(runtime_->waitForEvent(runtime_->kernelLaunchMulti(stream_, launches, false)));
+  EXPECT_TRUE(runtime_->waitForStream(stream_));
+  EXPECT_TRUE(runtime_->retrieveStreamErrors(stream_).empty());
+
+  EXPECT_THROW(runtime_->kernelLaunchMulti(stream_, {}), rt::Exception);
+  EXPECT_THROW(runtime_->kernelLaunchMulti(stream_, {{kernel_, args, 0x3}, {kernel_, args, 0x2}}), rt::Exception);
+  std::vector<LaunchDesc> tooMany(device_ops_ext::kKernelMultiLaunchMax + 1, {kernel_, args, 0x1});
+  EXPECT_THROW(runtime_->kernelLaunchMulti(stream_, tooMany), rt::Exception);
+  runtime_->freeDevice(device_, args);
+}
+
+TEST_F(KernelLaunchF, captureAndLaunchGraph) {
+  constexpr auto kTransferSize = 1024UL;
+  dummy_.resize(kTransferSize);
+  runtime_->registerHostBuffer(device_, dummy_.data(), dummy_.size());
+
+  runtime_->beginCapture(stream_);
+  EXPECT_THROW(runtime_->beginCapture(stream_), rt::Exception);
+  runtime_->memcpyHostToDevice(stream_, dummy_.data(), nullptr, kTransferSize);
+  runtime_->kernelLaunch(stream_, kernel_, dummy_.data(), 16, 0x3);
+  // too big to be embedded, uploaded once at endCapture
+  runtime_->kernelLaunch(stream_, kernel_, dummy_.data(), 128, 0x3);
+  runtime_->memcpyDeviceToHost(stream_, nullptr, dummy_.data(), kTransferSize);
+  // memcpys staged through CMA can't be captured
+  std::vector<std::byte> unregistered(kTransferSize);
+  EXPECT_THROW(runtime_->memcpyHostToDevice(stream_, unregistered.data(), nullptr, kTransferSize), rt::Exception);
+  auto graph = runtime_->endCapture(stream_);
+  EXPECT_THROW(runtime_->endCapture(stream_), rt::Exception);
+
+  for (auto i = 0; i < 1000; ++i) {
+    runtime_->launchGraph(stream_, graph);
+  }
+  EXPECT_TRUE(runtime_->waitForEvent(runtime_->launchGraph(stream_, graph)));
+  EXPECT_TRUE(runtime_->waitForStream(stream_));
+
+  runtime_->destroyGraph(graph);
+  EXPECT_THROW(runtime_->launchGraph(stream_, graph), rt::Exception);
+  runtime_->unregisterHostBuffer(device_, dummy_.data());
+}
+
+TEST_F(KernelLaunchF, uploadGraph) {
+  constexpr auto kTransferSize = 1024UL;
+  dummy_.resize(kTransferSize);
+  runtime_->registerHostBuffer(device_, dummy_.data(), dummy_.size());
+
+  runtime_->beginCapture(stream_);
+  runtime_->memcpyHostToDevice(stream_, dummy_.data(), nullptr, kTransferSize);
+  runtime_->kernelLaunch(stream_, kernel_, dummy_.data(), 16, 0x3);
+  runtime_->kernelLaunch(stream_, kernel_, dummy_.data(), 128, 0x3);
+  runtime_->memcpyDeviceToHost(stream_, nullptr, dummy_.data(), kTransferSize);
+  auto graph = runtime_->endCapture(stream_);
+
+  // only the args of uploaded graphs can be patched
+  EXPECT_THROW(runtime_->launchGraph(stream_, graph, {{0, 0, 42}}), rt::Exception);
+  runtime_->uploadGraph(stream_, graph);
+  EXPECT_THROW(runtime_->uploadGraph(stream_, graph), rt::Exception);
+
+  for (auto i = 0U; i < 1000; ++i) {
+    runtime_->launchGraph(stream_, graph, {{0, 8 * (i % 2), i}});
+  }
+  EXPECT_TRUE(runtime_->waitForEvent(runtime_->launchGraph(stream_, graph)));
+  // out of the embedded args, the second launch has none
+  EXPECT_THROW(runtime_->launchGraph(stream_, graph, {{0, 16, 0}}), rt::Exception);
+  EXPECT_THROW(runtime_->launchGraph(stream_, graph, {{0, 4, 0}}), rt::Exception);
+  EXPECT_THROW(runtime_->launchGraph(stream_, graph, {{1, 0, 0}}), rt::Exception);
+  EXPECT_THROW(runtime_->launchGraph(stream_, graph, {{2, 0, 0}}), rt::Exception);
+  std::vector<GraphArgPatch> tooMany(device_ops_ext::kCmdListPatchesMax + 1, {0, 0, 0});
+  EXPECT_THROW(runtime_->launchGraph(stream_, graph, tooMany), rt::Exception);
+  EXPECT_TRUE(runtime_->waitForStream(stream_));
+
+  runtime_->destroyGraph(graph);
+  runtime_->unregisterHostBuffer(device_, dummy_.data());
+}
+
+TEST_F(KernelLaunchF, compressedMemcpy) {
+  constexpr auto kChunkSize = 4096UL;
+  constexpr auto kNumChunks = 10UL;
+  dummy_.resize(kChunkSize * kNumChunks);
+  std::vector<CompressedChunk> chunks;
+  for (auto i = 0UL; i < kNumChunks; ++i) {
+    chunks.push_back({dummy_.data() + i * kChunkSize, kChunkSize / 2 + i, kChunkSize});
+  }
+  // the fake device has no lz4_decompress elf to load
+  auto runtimeImp = static_cast<RuntimeImp*>(runtime_.get());
+  runtimeImp->runtimeKernels_.emplace(std::make_pair(device_, std::string{"lz4_decompress"}), kernel_);
+  auto d_dst = runtime_->mallocDevice(device_, kChunkSize * kNumChunks);
+  // more chunks than the fake device DMA list entries, in several batches
+  auto evt = runtime_->memcpyHostToDeviceCompressed(stream_, chunks, d_dst, 0x3);
+  EXPECT_TRUE(runtime_->waitForEvent(evt));
+  EXPECT_TRUE(runtime_->waitForStream(stream_));
+  EXPECT_TRUE(runtime_->retrieveStreamErrors(stream_).empty());
+
+  EXPECT_THROW(runtime_->memcpyHostToDeviceCompressed(stream_, {}, d_dst, 0x3), rt::Exception);
+  std::vector<CompressedChunk> emptyChunk{{nullptr, 16, 16}};
+  EXPECT_THROW(runtime_->memcpyHostToDeviceCompressed(stream_, emptyChunk, d_dst, 0x3), rt::Exception);
+  runtime_->beginCapture(stream_);
+  EXPECT_THROW(runtime_->memcpyHostToDeviceCompressed(stream_, chunks, d_dst, 0x3), rt::Exception);
+  runtime_->destroyGraph(runtime_->endCapture(stream_));
+  runtime_->freeDevice(device_, d_dst);
+}
+
+TEST_F(KernelLaunchF, checkedMemcpy) {
+  constexpr auto kSize = 3UL * 1024 * 1024 + 100;
+  dummy_.resize(kSize);
+  // the fake device has no crc32_check elf to load, and it doesn't move any data, so whether the CRCs match is left to
+  // the sysemu integration tests; here only that the memcpy, the kernel and the compare are all completed
+  auto runtimeImp = static_cast<RuntimeImp*>(runtime_.get());
+  runtimeImp->runtimeKernels_.emplace(std::make_pair(device_, std::string{"crc32_check"}), kernel_);
+  runtime_->setOnStreamErrorsCallback([](auto, const auto&) {});
+  auto d_dst = runtime_->mallocDevice(device_, kSize);
+  auto evt = runtime_->memcpyHostToDeviceChecked(stream_, dummy_.data(), d_dst, kSize, 0x3);
+  EXPECT_TRUE(runtime_->waitForEvent(evt));
+  EXPECT_TRUE(runtime_->waitForStream(stream_));
+
+  EXPECT_THROW(runtime_->memcpyHostToDeviceChecked(stream_, dummy_.data(), d_dst, 0, 0x3), rt::Exception);
+  EXPECT_THROW(runtime_->memcpyHostToDeviceChecked(stream_, dummy_.data(), d_dst + 4, 64, 0x3), rt::Exception);
+  runtime_->beginCapture(stream_);
+  EXPECT_THROW(runtime_->memcpyHostToDeviceChecked(stream_, dummy_.data(), d_dst, kSize, 0x3), rt::Exception);
+  runtime_->destroyGraph(runtime_->endCapture(stream_));
+  runtime_->freeDevice(device_, d_dst);
+}
+
+TEST_F(KernelLaunchF, eventTiming) {
+  dummy_.resize(32);
+  auto evt = runtime_->kernelLaunch(stream_, kernel_, dummy_.data(), dummy_.size(), 0x3);
+  ASSERT_TRUE(runtime_->waitForEvent(evt));
+  auto timing = runtime_->getEventTiming(evt);
+  ASSERT_TRUE(timing.has_value());
+  EXPECT_EQ(timing->device_, device_);
+  EXPECT_EQ(timing->frequencyMhz_, runtime_->getDeviceProperties(device_).frequency_);
+  EXPECT_EQ(timing->getEndCycles(), timing->startCycles_ + timing->waitCycles_ + timing->executionCycles_);
+
+  // a graph launch event is not a device command, it must not show the timing of an older command
+  runtime_->beginCapture(stream_);
+  runtime_->kernelLaunch(stream_, kernel_, dummy_.data(), dummy_.size(), 0x3);
+  auto graph = runtime_->endCapture(stream_);
+  auto graphEvt = runtime_->launchGraph(stream_, graph);
+  ASSERT_TRUE(runtime_->waitForEvent(graphEvt));
+  EXPECT_FALSE(runtime_->getEventTiming(graphEvt).has_value());
+  runtime_->destroyGraph(graph);
+}
+
 int main(int argc, char** argv) {
   logging::LoggerDefault logger_;
   g3::log_levels::disable(DEBUG);
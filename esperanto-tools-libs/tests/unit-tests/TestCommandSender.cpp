@@ -112,6 +112,93 @@ TEST(CommandSender, checkSendBefore) {
   }
 }
 
+TEST(CommandSender, checkCancelAndBigCommands) {
+  // commands bigger than the inline storage are kept on the heap
+  std::vector<std::byte> commandData(CommandData::kInlineSize * 2);
+
+  auto header = reinterpret_cast<device_ops_api::cmn_header_t*>(commandData.data());
+  // dummy msg_id to make it work on deviceLayerFake
+  header->msg_id = device_ops_api::DEV_OPS_API_MID_DEVICE_OPS_DMA_WRITELIST_CMD;
+  // more commands than initial slots, so the slab has to grow
+  auto numCommands = static_cast<int>(CommandSender::kInitialSlots) * 2;
+  auto deviceLayer = std::shared_ptr<dev::IDeviceLayer>(new dev::DeviceLayerFake);
+  profiling::DummyProfiler profiler;
+  CommandSender cs(*deviceLayer, &profiler, 0, 0);
+  for (auto i = 1; i <= numCommands; ++i) {
+    header->tag_id = device_ops_api::tag_id_t(i);
+    auto evt = EventId(i);
+    cs.send(Command{commandData, cs, evt, evt});
+  }
+  EXPECT_THROW(cs.send(Command{commandData, cs, EventId{1}, EventId{1}}), Exception);
+  EXPECT_EQ(cs.getCurrentSize(), static_cast<size_t>(numCommands));
+
+  // cancel the even ones and reuse their slots for new commands queued before the odd ones
+  for (auto i = 2; i <= numCommands; i += 2) {
+    cs.cancel(EventId(i));
+  }
+  EXPECT_EQ(cs.getCurrentSize(), static_cast<size_t>(numCommands / 2));
+  for (auto i = 2; i <= numCommands; i += 2) {
+    header->tag_id = device_ops_api::tag_id_t(i);
+    auto evt = EventId(i);
+    cs.sendBefore(EventId(i + 1 > numCommands ? 1 : i + 1), Command{commandData, cs, evt, evt});
+  }
+  EXPECT_THROW(cs.enable(EventId(numCommands + 1)), Exception);
+  for (auto i = 1; i <= numCommands; ++i) {
+    cs.enable(EventId(i));
+  }
+  std::vector<std::byte> response;
+  std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+  // last one was queued before the first
+  std::vector<int> expected{numCommands, 1};
+  for (auto i = 2; i < numCommands; ++i) {
+    expected.emplace_back(i);
+  }
+  for (auto tag : expected) {
+    ASSERT_TRUE(deviceLayer->receiveResponseMasterMinion(0, response));
+    auto rsp = reinterpret_cast<device_ops_api::rsp_header_t*>(response.data());
+    ASSERT_EQ(rsp->rsp_hdr.tag_id, tag);
+  }
+  EXPECT_EQ(cs.getCurrentSize(), 0UL);
+}
+
+TEST(CommandSender, checkInlineSubmission) {
+  std::vector<std::byte> commandData(64);
+
+  auto header = reinterpret_cast<device_ops_api::cmn_header_t*>(commandData.data());
+  // dummy msg_id to make it work on deviceLayerFake
+  header->msg_id = device_ops_api::DEV_OPS_API_MID_DEVICE_OPS_DMA_WRITELIST_CMD;
+  auto deviceLayer = std::shared_ptr<dev::IDeviceLayer>(new dev::DeviceLayerFake);
+  profiling::DummyProfiler profiler;
+  CommandSender cs(*deviceLayer, &profiler, 0, 0);
+  cs.setInlineSubmission(true);
+  auto makeCommand = [&](int tag, bool enabled) {
+    header->tag_id = device_ops_api::tag_id_t(tag);
+    auto evt = EventId(tag);
+    auto cmd = Command{commandData, cs, evt, evt};
+    cmd.isEnabled_ = enabled;
+    return cmd;
+  };
+
+  // nothing queued, the command is sent by the calling thread before send returns
+  std::vector<std::byte> response;
+  cs.send(makeCommand(1, true));
+  EXPECT_EQ(cs.getCurrentSize(), 0UL);
+  ASSERT_TRUE(deviceLayer->receiveResponseMasterMinion(0, response));
+  EXPECT_EQ(reinterpret_cast<device_ops_api::rsp_header_t*>(response.data())->rsp_hdr.tag_id, 1);
+
+  // an enabled command behind a pending one must wait for it
+  cs.send(makeCommand(2, false));
+  cs.send(makeCommand(3, true));
+  EXPECT_EQ(cs.getCurrentSize(), 2UL);
+  EXPECT_FALSE(deviceLayer->receiveResponseMasterMinion(0, response));
+  cs.enable(EventId(2));
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  for (auto tag : {2, 3}) {
+    ASSERT_TRUE(deviceLayer->receiveResponseMasterMinion(0, response));
+    EXPECT_EQ(reinterpret_cast<device_ops_api::rsp_header_t*>(response.data())->rsp_hdr.tag_id, tag);
+  }
+}
+
 int main(int argc, char** argv) {
   logging::LoggerDefault logger_;
   testing::InitGoogleTest(&argc, argv);
@@ -92,6 +92,30 @@ TEST_F(RuntimeBenchmark, H2D_K_D2H_NoSync_On_Iters) {
   runtime_->waitForStream(stream_);
 }
 
+struct RuntimeBenchmarkReceiverMode : TestWithParam<ResponseReceiverMode> {};
+
+TEST_P(RuntimeBenchmarkReceiverMode, H2D_K_D2H_Sync_On_Iters) {
+  auto deviceLayer = std::shared_ptr<dev::IDeviceLayer>(new dev::DeviceLayerFake);
+  auto options = Options{false, false};
+  options.responseReceiverMode_ = GetParam();
+  auto runtime = rt::IRuntime::create(deviceLayer, options);
+  runtime->setOnStreamErrorsCallback([](auto, const auto&) { FAIL(); });
+  auto device = runtime->getDevices()[0];
+  auto stream = runtime->createStream(device);
+  auto rt = static_cast<RuntimeImp*>(runtime.get());
+  rt->setMemoryManagerDebugMode(device, true);
+  rt->kernels_.insert({KernelId{0}, std::make_unique<RuntimeImp::Kernel>(device, nullptr, 0x4000)});
+  auto start = steady_clock::now();
+  sendH2D_K_D2H(1e3, stream, KernelId{0}, runtime, true);
+  RT_LOG(INFO) << "Receiver mode " << static_cast<int>(GetParam()) << " elapsed time: "
+               << duration_cast<milliseconds>(steady_clock::now() - start).count() << "ms";
+  runtime->destroyStream(stream);
+}
+
+INSTANTIATE_TEST_SUITE_P(ReceiverModes, RuntimeBenchmarkReceiverMode,
+                         Values(ResponseReceiverMode::Polling, ResponseReceiverMode::Blocking,
+                                ResponseReceiverMode::Hybrid));
+
 int main(int argc, char** argv) {
   logging::LoggerDefault logger_;
   g3::log_levels::disable(DEBUG);
@@ -4,7 +4,9 @@
 //------------------------------------------------------------------------------
 #include "common/MpOrchestrator.h"
 #include "runtime/DeviceLayerFake.h"
+#include "runtime/IMonitor.h"
 #include "runtime/Types.h"
+#include <algorithm>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
@@ -29,6 +31,55 @@ TEST(mp_malloc, malloc_free_100clients_1000mallocs) {
   orch.createClient([dram](rt::IRuntime* rt) { ASSERT_NO_THROW(rt->mallocDevice(rt::DeviceId{0}, dram - 3358720)); });
 }
 
+TEST(mp_malloc, free_async_10clients) {
+  MpOrchestrator orch;
+  orch.createServer([] { return std::make_unique<dev::DeviceLayerFake>(); }, rt::Options{true, false});
+  for (int i = 0; i < 10; ++i) {
+    orch.createClient([](rt::IRuntime* rt) {
+      auto dev = rt::DeviceId{0};
+      auto st = rt->createStream(dev);
+      std::vector<std::byte> host(1024);
+      for (auto j = 0; j < 100; ++j) {
+        auto a = rt->mallocDevice(dev, host.size());
+        rt->memcpyHostToDevice(st, host.data(), a, host.size());
+        rt->freeDeviceAsync(st, a);
+      }
+      ASSERT_TRUE(rt->waitForStream(st));
+      rt->destroyStream(st);
+    });
+  }
+}
+
+TEST(mp_malloc, device_memory_quota) {
+  static constexpr uint64_t kQuota = 1UL << 20;
+  MpOrchestrator orch;
+  orch.createServer([] { return std::make_unique<dev::DeviceLayerFake>(); }, rt::Options{true, false},
+                    [](rt::Server& server) {
+                      rt::ClientQos qos;
+                      qos.maxDeviceMemory_ = kQuota;
+                      server.setDefaultClientQos(qos);
+                    });
+  orch.createClient([](rt::IRuntime* rt) {
+    auto dev = rt::DeviceId{0};
+    auto a = rt->mallocDevice(dev, kQuota / 2);
+    auto b = rt->mallocDevice(dev, kQuota / 2);
+    EXPECT_THROW(rt->mallocDevice(dev, 4096), rt::Exception);
+
+    auto monitor = static_cast<rt::IMonitor*>(static_cast<rt::Client*>(rt));
+    auto stats = monitor->getClientStats();
+    auto it = std::find_if(begin(stats), end(stats), [](const auto& cs) { return cs.pid_ == getpid(); });
+    ASSERT_NE(it, end(stats));
+    EXPECT_EQ(it->deviceMemory_, kQuota);
+    EXPECT_EQ(it->maxDeviceMemory_, kQuota);
+
+    // freed memory is available again
+    rt->freeDevice(dev, a);
+    auto c = rt->mallocDevice(dev, 4096);
+    rt->freeDevice(dev, b);
+    rt->freeDevice(dev, c);
+  });
+}
+
 int main(int argc, char** argv) {
   testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
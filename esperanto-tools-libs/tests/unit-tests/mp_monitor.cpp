@@ -6,10 +6,12 @@
 #include "runtime/DeviceLayerFake.h"
 #include "runtime/IMonitor.h"
 #include "runtime/Types.h"
+#include <algorithm>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include <hostUtils/logging/Logger.h>
 #include <thread>
+#include <unistd.h>
 
 TEST(mp_monitor, getCurrentClients) {
   using namespace std::literals;
@@ -72,6 +74,71 @@ TEST(mp_monitor, getAliveEvents) {
   ASSERT_EQ(0, monitor->getWaitingCommands()[rt::DeviceId{0}]);
 }
 
+TEST(mp_monitor, getClientStats) {
+  using namespace std::literals;
+  MpOrchestrator orch;
+  orch.createServer([] { return std::make_unique<dev::DeviceLayerFake>(); }, rt::Options{true, false});
+  auto monitor = rt::IMonitor::create(orch.getSocketPath());
+  constexpr auto copySize = 1 << 12;
+  for (int i = 0; i < 5; ++i) {
+    orch.createClient([](rt::IRuntime* rt) {
+      constexpr auto dev = rt::DeviceId{0};
+      std::vector<std::byte> h_mem(copySize);
+      auto mem = rt->mallocDevice(dev, copySize);
+      auto st = rt->createStream(dev);
+      rt->memcpyHostToDevice(st, h_mem.data(), mem, copySize);
+      rt->memcpyDeviceToHost(st, mem, h_mem.data(), copySize);
+      rt->waitForStream(st);
+      auto monitorClient = static_cast<rt::IMonitor*>(static_cast<rt::Client*>(rt));
+      auto stats = monitorClient->getClientStats();
+      auto it = std::find_if(begin(stats), end(stats), [](const auto& cs) { return cs.pid_ == getpid(); });
+      ASSERT_NE(it, end(stats));
+      EXPECT_EQ(it->bytesCopied_, 2 * copySize);
+      EXPECT_EQ(it->kernelLaunches_, 0);
+      EXPECT_EQ(it->inflightCommands_, 0);
+      EXPECT_EQ(it->weight_, 1);
+      std::this_thread::sleep_for(500ms);
+    });
+  }
+  std::this_thread::sleep_for(250ms);
+  // 5 created clients + monitor
+  ASSERT_EQ(monitor->getClientStats().size(), 6);
+}
+
+TEST(mp_monitor, getDeviceMetrics) {
+  MpOrchestrator orch;
+  orch.createServer([] { return std::make_unique<dev::DeviceLayerFake>(); }, rt::Options{true, false});
+  auto monitor = rt::IMonitor::create(orch.getSocketPath());
+  constexpr auto copySize = 1 << 12;
+  constexpr auto numClients = 3;
+  for (int i = 0; i < numClients; ++i) {
+    orch.createClient([](rt::IRuntime* rt) {
+      constexpr auto dev = rt::DeviceId{0};
+      std::vector<std::byte> h_mem(copySize);
+      auto mem = rt->mallocDevice(dev, copySize);
+      auto st = rt->createStream(dev);
+      rt->memcpyHostToDevice(st, h_mem.data(), mem, copySize);
+      rt->memcpyDeviceToHost(st, mem, h_mem.data(), copySize);
+      rt->waitForStream(st);
+    });
+  }
+  orch.clearClients();
+  auto metrics = monitor->getDeviceMetrics();
+  ASSERT_EQ(metrics.count(rt::DeviceId{0}), 1);
+  const auto& dm = metrics[rt::DeviceId{0}];
+  EXPECT_EQ(dm.bytesHostToDevice_, numClients * copySize);
+  EXPECT_EQ(dm.bytesDeviceToHost_, numClients * copySize);
+  for (auto kind : {rt::CommandKind::MemcpyHostToDevice, rt::CommandKind::MemcpyDeviceToHost}) {
+    for (auto stage : {rt::LatencyStage::SubmitToStart, rt::LatencyStage::Execution}) {
+      const auto& histogram = dm.getLatencies(kind, stage);
+      EXPECT_EQ(histogram.count_, numClients);
+      EXPECT_LE(histogram.min_, histogram.max_);
+      EXPECT_GE(histogram.getPercentile(1.0), histogram.max_);
+    }
+  }
+  EXPECT_EQ(dm.getLatencies(rt::CommandKind::KernelLaunch, rt::LatencyStage::Execution).count_, 0);
+}
+
 int main(int argc, char** argv) {
   testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
@@ -37,6 +37,38 @@ TEST(mp_sync_events, wait_memcpy) {
   }
 }
 
+TEST(mp_sync_events, wait_batched_memcpys) {
+  MpOrchestrator orch;
+  orch.createServer([] { return std::make_unique<dev::DeviceLayerFake>(); }, rt::Options{true, false});
+  for (int i = 0; i < 10; ++i) {
+    orch.createClient([](rt::IRuntime* rt) {
+      auto devices = rt->getDevices();
+      ASSERT_FALSE(devices.empty());
+      auto dev = devices[0];
+      auto st = rt->createStream(dev);
+      std::vector<std::byte> h_mem(1024);
+      auto mem = rt->mallocDevice(dev, 1024);
+
+      rt->setRequestBatching(true);
+      std::vector<rt::EventId> events;
+      for (int j = 0; j < 100; ++j) {
+        events.emplace_back(rt->memcpyHostToDevice(st, h_mem.data(), mem, 1024));
+        events.emplace_back(rt->memcpyDeviceToHost(st, mem, h_mem.data(), 1024));
+      }
+      rt->flushRequests();
+      for (auto evt : events) {
+        EXPECT_TRUE(rt->waitForEvent(evt));
+      }
+      // errors of batched requests are thrown once waited for
+      rt->memcpyHostToDevice(st, h_mem.data(), nullptr, 1024);
+      EXPECT_THROW(rt->waitForStream(st), rt::Exception);
+      rt->setRequestBatching(false);
+      EXPECT_TRUE(rt->waitForEvent(rt->memcpyHostToDevice(st, h_mem.data(), mem, 1024)));
+      rt->freeDevice(dev, mem);
+    });
+  }
+}
+
 int main(int argc, char** argv) {
   testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
@@ -5,7 +5,19 @@
 
 #include "RuntimeFixture.h"
 #include "Utils.h"
+#include "runtime/Collectives.h"
+#include "runtime/DeviceOpsExt.h"
 #include "runtime/IRuntime.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <future>
+#include <mutex>
+#include <numeric>
+#include <sys/mman.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_set>
 using namespace rt;
 
 TEST_F(RuntimeFixture, checkStackTraceException) {
@@ -35,6 +47,483 @@ TEST_F(RuntimeFixture, checkStackConfigBadBaseAddressException) {
   EXPECT_THROW(opts.setStackConfig(baseAddrptr, kTraceBytesPerHart), rt::Exception);
 }
 
+TEST_F(RuntimeFixture, registeredHostBufferMemcpys) {
+  auto dev = devices_[0];
+  auto st = defaultStreams_[0];
+  auto dmaInfo = runtime_->getDmaInfo(dev);
+  // big enough to need several DMA commands
+  auto size = dmaInfo.maxElementSize_ * dmaInfo.maxElementCount_ + dmaInfo.maxElementSize_ / 2;
+  std::vector<std::byte> host(size);
+  auto d_ptr = runtime_->mallocDevice(dev, size);
+  runtime_->registerHostBuffer(dev, host.data(), host.size());
+  EXPECT_THROW(runtime_->registerHostBuffer(dev, host.data() + 1, 1), rt::Exception);
+
+  EXPECT_TRUE(runtime_->waitForEvent(runtime_->memcpyHostToDevice(st, host.data(), d_ptr, size)));
+  EXPECT_TRUE(runtime_->waitForEvent(runtime_->memcpyDeviceToHost(st, d_ptr, host.data() + 1, size - 1)));
+  MemcpyList list;
+  list.addOp(host.data(), d_ptr, 64);
+  list.addOp(host.data() + 128, d_ptr + 128, 64);
+  EXPECT_TRUE(runtime_->waitForEvent(runtime_->memcpyHostToDevice(st, list)));
+
+  runtime_->unregisterHostBuffer(dev, host.data());
+  EXPECT_THROW(runtime_->unregisterHostBuffer(dev, host.data()), rt::Exception);
+  // once unregistered memcpys keep working through CMA
+  EXPECT_TRUE(runtime_->waitForEvent(runtime_->memcpyHostToDevice(st, host.data(), d_ptr, size)));
+  runtime_->freeDevice(dev, d_ptr);
+}
+
+TEST_F(RuntimeFixture, allocatedHostBufferMemcpys) {
+  auto dev = devices_[0];
+  auto st = defaultStreams_[0];
+  constexpr auto kSize = 3000UL;
+  auto h_ptr = runtime_->allocHostBuffer(dev, kSize);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(h_ptr) % static_cast<uintptr_t>(sysconf(_SC_PAGESIZE)), 0U);
+  // already registered, and only releasable through freeHostBuffer
+  EXPECT_THROW(runtime_->registerHostBuffer(dev, h_ptr, kSize), rt::Exception);
+  EXPECT_THROW(runtime_->unregisterHostBuffer(dev, h_ptr), rt::Exception);
+
+  auto d_ptr = runtime_->mallocDevice(dev, kSize);
+  std::fill(h_ptr, h_ptr + kSize, std::byte{0x5A});
+  EXPECT_TRUE(runtime_->waitForEvent(runtime_->memcpyHostToDevice(st, h_ptr, d_ptr, kSize)));
+  EXPECT_TRUE(runtime_->waitForEvent(runtime_->memcpyDeviceToHost(st, d_ptr, h_ptr, kSize)));
+  runtime_->freeDevice(dev, d_ptr);
+
+  std::vector<std::byte> host(kSize);
+  EXPECT_THROW(runtime_->freeHostBuffer(dev, host.data()), rt::Exception);
+  runtime_->freeHostBuffer(dev, h_ptr);
+  EXPECT_THROW(runtime_->freeHostBuffer(dev, h_ptr), rt::Exception);
+}
+
+TEST_F(RuntimeFixture, memoryPoolAllocateAndReset) {
+  auto dev = devices_[0];
+  constexpr auto kPoolSize = 1UL << 20;
+  auto pool = runtime_->createMemoryPool(dev, kPoolSize);
+  EXPECT_EQ(pool->getDevice(), dev);
+  EXPECT_EQ(pool->getSize(), kPoolSize);
+
+  auto a = pool->allocate(100);
+  auto b = pool->allocate(1000, 4096);
+  EXPECT_EQ(reinterpret_cast<uint64_t>(a) % kCacheLineSize, 0UL);
+  EXPECT_EQ(reinterpret_cast<uint64_t>(b) % 4096, 0UL);
+  EXPECT_GE(b, a + 100);
+  EXPECT_THROW(pool->allocate(kPoolSize), rt::Exception);
+
+  auto peak = pool->getUsedBytes();
+  pool->reset();
+  EXPECT_EQ(pool->getUsedBytes(), 0UL);
+  EXPECT_EQ(pool->getPeakUsedBytes(), peak);
+  EXPECT_EQ(pool->allocate(100), a);
+  EXPECT_NO_THROW(pool.reset());
+}
+
+TEST_F(RuntimeFixture, freeDeviceAsync) {
+  auto dev = devices_[0];
+  auto st = defaultStreams_[0];
+  constexpr auto kSize = 1UL << 20;
+  std::vector<std::byte> host(kSize);
+  for (auto i = 0; i < 10; ++i) {
+    auto d_ptr = runtime_->mallocDevice(dev, kSize);
+    runtime_->memcpyHostToDevice(st, host.data(), d_ptr, kSize);
+    runtime_->memcpyDeviceToHost(st, d_ptr, host.data(), kSize);
+    // no need to wait for the stream before releasing the buffer
+    runtime_->freeDeviceAsync(st, d_ptr);
+  }
+  runtime_->waitForStream(st);
+
+  // with no pending work the free is done right away
+  auto d_ptr = runtime_->mallocDevice(dev, kSize);
+  runtime_->freeDeviceAsync(st, d_ptr);
+  EXPECT_THROW(runtime_->freeDevice(dev, d_ptr), rt::Exception);
+  EXPECT_THROW(runtime_->freeDeviceAsync(st, d_ptr), rt::Exception);
+
+  // while the free is pending on the stream any other free of the same buffer is rejected
+  d_ptr = runtime_->mallocDevice(dev, kSize);
+  std::promise<void> release;
+  runtime_->launchHostFunc(st, [held = release.get_future().share()] { held.wait(); });
+  runtime_->freeDeviceAsync(st, d_ptr);
+  EXPECT_THROW(runtime_->freeDeviceAsync(st, d_ptr), rt::Exception);
+  EXPECT_THROW(runtime_->freeDevice(dev, d_ptr), rt::Exception);
+  release.set_value();
+  EXPECT_TRUE(runtime_->waitForStream(st));
+  EXPECT_THROW(runtime_->freeDeviceAsync(st, d_ptr), rt::Exception);
+}
+
+TEST_F(RuntimeFixture, streamWaitEvent) {
+  auto dev = devices_[0];
+  auto producer = defaultStreams_[0];
+  auto consumer = runtime_->createStream(dev);
+  constexpr auto kSize = 1UL << 20;
+  std::vector<std::byte> host(kSize);
+  auto d_ptr = runtime_->mallocDevice(dev, kSize);
+  // more waits than sync slots, they have to be recycled
+  for (auto i = 0U; i < 2 * device_ops_ext::kNumStreamSyncSlots; ++i) {
+    auto evt = runtime_->memcpyHostToDevice(producer, host.data(), d_ptr, kSize);
+    runtime_->streamWaitEvent(consumer, evt);
+    runtime_->memcpyDeviceToHost(consumer, d_ptr, host.data(), kSize);
+  }
+  EXPECT_TRUE(runtime_->waitForStream(consumer));
+  EXPECT_TRUE(runtime_->waitForStream(producer));
+
+  // waiting for an already completed event
+  auto evt = runtime_->memcpyHostToDevice(producer, host.data(), d_ptr, kSize);
+  EXPECT_TRUE(runtime_->waitForEvent(evt));
+  EXPECT_TRUE(runtime_->waitForEvent(runtime_->streamWaitEvent(consumer, evt)));
+  runtime_->freeDevice(dev, d_ptr);
+  runtime_->destroyStream(consumer);
+}
+
+TEST_F(RuntimeFixture, memsetAndFillDevice) {
+  auto dev = devices_[0];
+  auto st = defaultStreams_[0];
+  constexpr auto kSize = 1UL << 20;
+  auto d_ptr = runtime_->mallocDevice(dev, kSize);
+  auto evt = runtime_->memsetDevice(st, d_ptr, 0, kSize);
+  EXPECT_TRUE(runtime_->waitForEvent(evt));
+  EXPECT_TRUE(runtime_->waitForEvent(runtime_->fillDevice(st, d_ptr + 4, 0xDEADBEEF, 4, kSize - 4, true)));
+  // nothing to fill
+  EXPECT_TRUE(runtime_->waitForEvent(runtime_->memsetDevice(st, d_ptr, 0xFF, 0)));
+  EXPECT_TRUE(runtime_->waitForStream(st));
+  EXPECT_TRUE(runtime_->retrieveStreamErrors(st).empty());
+
+  EXPECT_THROW(runtime_->fillDevice(st, d_ptr, 0, 3, kSize), rt::Exception);
+  EXPECT_THROW(runtime_->fillDevice(st, d_ptr + 2, 0, 4, 16), rt::Exception);
+  EXPECT_THROW(runtime_->fillDevice(st, d_ptr, 0, 8, 12), rt::Exception);
+  runtime_->freeDevice(dev, d_ptr);
+}
+
+TEST_F(RuntimeFixture, setKernelHeap) {
+  auto dev = devices_[0];
+  auto st = defaultStreams_[0];
+  constexpr auto kSize = 1UL << 20;
+  auto d_ptr = runtime_->mallocDevice(dev, kSize);
+  EXPECT_TRUE(runtime_->waitForEvent(runtime_->setKernelHeap(st, d_ptr, kSize)));
+  EXPECT_THROW(runtime_->setKernelHeap(st, d_ptr, rt::device_ops_ext::kKernelHeapMinSize - 1), rt::Exception);
+  // disabling the heap still goes to the device
+  EXPECT_TRUE(runtime_->waitForEvent(runtime_->setKernelHeap(st, nullptr, 0)));
+  EXPECT_TRUE(runtime_->waitForStream(st));
+  EXPECT_TRUE(runtime_->retrieveStreamErrors(st).empty());
+  runtime_->freeDevice(dev, d_ptr);
+}
+
+TEST_F(RuntimeFixture, memcpyWithinDevice) {
+  auto dev = devices_[0];
+  auto st = defaultStreams_[0];
+  constexpr auto kSize = 1UL << 20;
+  auto d_src = runtime_->mallocDevice(dev, kSize);
+  auto d_dst = runtime_->mallocDevice(dev, kSize);
+  EXPECT_TRUE(runtime_->waitForEvent(runtime_->memcpyDeviceToDevice(st, d_src, d_dst, kSize)));
+  // overlapping buffers
+  EXPECT_TRUE(runtime_->waitForEvent(runtime_->memcpyDeviceToDevice(st, d_src, d_src + 64, kSize - 64, false)));
+  // the P2P entry point with the same device for both sides
+  EXPECT_TRUE(runtime_->waitForEvent(runtime_->memcpyDeviceToDevice(st, dev, d_src, d_dst, kSize)));
+  EXPECT_TRUE(runtime_->waitForStream(st));
+  EXPECT_TRUE(runtime_->retrieveStreamErrors(st).empty());
+  runtime_->freeDevice(dev, d_dst);
+  runtime_->freeDevice(dev, d_src);
+}
+
+TEST_F(RuntimeFixture, communicatorTopology) {
+  EXPECT_THROW(Communicator(*runtime_, {}), rt::Exception);
+  EXPECT_THROW(Communicator(*runtime_, {devices_[0], devices_[0]}), rt::Exception);
+
+  constexpr auto kSize = 1UL << 16;
+  Communicator single(*runtime_, {devices_[0]});
+  EXPECT_EQ(single.getTopology(), CollectiveTopology::Ring);
+  EXPECT_EQ(single.getRing(), std::vector<DeviceId>{devices_[0]});
+  EXPECT_THROW(single.getStream(DeviceId{-1}), rt::Exception);
+  auto d_ptr = runtime_->mallocDevice(devices_[0], kSize);
+  // nothing to send with a single device
+  EXPECT_TRUE(single.broadcast(devices_[0], {d_ptr}, kSize).empty());
+  EXPECT_TRUE(single.allGather({d_ptr}, kSize).empty());
+  EXPECT_THROW(single.allGather({d_ptr, d_ptr}, kSize), rt::Exception);
+  runtime_->freeDevice(devices_[0], d_ptr);
+
+  if (devices_.size() > 1 && !runtime_->isP2PEnabled(devices_[0], devices_[1])) {
+    // both devices can't be connected
+    EXPECT_THROW(Communicator(*runtime_, {devices_[0], devices_[1]}), rt::Exception);
+  }
+}
+
+TEST_F(RuntimeFixture, eventCompletionCallbacks) {
+  using namespace std::chrono_literals;
+  auto dev = devices_[0];
+  auto st = defaultStreams_[0];
+  constexpr auto kSize = 1UL << 20;
+  std::vector<std::byte> host(kSize);
+  auto d_ptr = runtime_->mallocDevice(dev, kSize);
+
+  auto evt = runtime_->memcpyHostToDevice(st, host.data(), d_ptr, kSize);
+  std::promise<EventId> completed;
+  runtime_->onEventComplete(evt, [&completed](EventId e) { completed.set_value(e); });
+  auto completedFuture = completed.get_future();
+  ASSERT_EQ(completedFuture.wait_for(10s), std::future_status::ready);
+  EXPECT_EQ(completedFuture.get(), evt);
+  // already completed events are notified too
+  EXPECT_EQ(runtime_->getEventFuture(evt).wait_for(10s), std::future_status::ready);
+
+  std::atomic<int> executed = 0;
+  runtime_->setCallbackExecutor([&executed](std::function<void()> task) {
+    ++executed;
+    task();
+  });
+  auto future = runtime_->getEventFuture(runtime_->memcpyDeviceToHost(st, d_ptr, host.data(), kSize));
+  EXPECT_EQ(future.wait_for(10s), std::future_status::ready);
+  EXPECT_EQ(executed, 1);
+  runtime_->setCallbackExecutor(nullptr);
+  EXPECT_THROW(runtime_->onEventComplete(evt, nullptr), rt::Exception);
+  runtime_->freeDevice(dev, d_ptr);
+}
+
+TEST_F(RuntimeFixture, launchHostFunc) {
+  using namespace std::chrono_literals;
+  auto dev = devices_[0];
+  auto st = defaultStreams_[0];
+  constexpr auto kSize = 1UL << 20;
+  std::vector<std::byte> host(kSize);
+  auto d_ptr = runtime_->mallocDevice(dev, kSize);
+
+  std::vector<int> order;
+  std::mutex orderMutex;
+  auto record = [&order, &orderMutex](int step) {
+    std::lock_guard lock(orderMutex);
+    order.emplace_back(step);
+  };
+  auto h2d = runtime_->memcpyHostToDevice(st, host.data(), d_ptr, kSize);
+  runtime_->launchHostFunc(st, [this, h2d, &record] {
+    // the previous work has completed, the following one is held till this returns
+    EXPECT_TRUE(runtime_->waitForEvent(h2d, 0s));
+    std::this_thread::sleep_for(10ms);
+    record(0);
+  });
+  auto d2h = runtime_->memcpyDeviceToHost(st, d_ptr, host.data(), kSize);
+  runtime_->onEventComplete(d2h, [&record](EventId) { record(1); });
+  // exceptions don't stop the stream
+  auto evt = runtime_->launchHostFunc(st, [] { throw rt::Exception("host function failure"); });
+  EXPECT_TRUE(runtime_->waitForEvent(evt));
+  EXPECT_TRUE(runtime_->waitForStream(st));
+  {
+    std::lock_guard lock(orderMutex);
+    EXPECT_EQ(order, (std::vector<int>{0, 1}));
+  }
+  EXPECT_THROW(runtime_->launchHostFunc(st, nullptr), rt::Exception);
+  runtime_->freeDevice(dev, d_ptr);
+}
+
+TEST_F(RuntimeFixture, memcpyCoalescing) {
+  auto dev = devices_[0];
+  auto st = runtime_->createStream(dev);
+  constexpr auto kNumCopies = 1000UL;
+  constexpr auto kCopySize = 64UL;
+  std::vector<std::byte> src(kNumCopies * kCopySize);
+  std::vector<std::byte> dst(src.size());
+  for (auto i = 0UL; i < src.size(); ++i) {
+    src[i] = static_cast<std::byte>(i);
+  }
+  auto d_ptr = runtime_->mallocDevice(dev, src.size());
+  runtime_->setMemcpyCoalescing(st, true);
+
+  std::vector<EventId> events;
+  for (auto i = 0UL; i < kNumCopies; ++i) {
+    events.emplace_back(
+      runtime_->memcpyHostToDevice(st, src.data() + i * kCopySize, d_ptr + i * kCopySize, kCopySize, false));
+  }
+  // waiting for any of the events submits the pending ones
+  EXPECT_TRUE(runtime_->waitForEvent(events[kNumCopies / 2]));
+  for (auto i = 0UL; i < kNumCopies; ++i) {
+    runtime_->memcpyDeviceToHost(st, d_ptr + i * kCopySize, dst.data() + i * kCopySize, kCopySize, false);
+  }
+  EXPECT_TRUE(runtime_->waitForStream(st));
+  for (auto e : events) {
+    EXPECT_TRUE(runtime_->waitForEvent(e));
+  }
+
+  // a barrier memcpy is never coalesced, it goes after the pending ones
+  runtime_->memcpyDeviceToHost(st, d_ptr, dst.data(), kCopySize, false);
+  runtime_->memcpyDeviceToHost(st, d_ptr + kCopySize, dst.data() + kCopySize, dst.size() - kCopySize, true);
+  runtime_->setMemcpyCoalescing(st, false);
+  EXPECT_TRUE(runtime_->waitForStream(st));
+  runtime_->freeDevice(dev, d_ptr);
+  runtime_->destroyStream(st);
+}
+
+TEST(StreamedHostMemory, bigMemcpysFromUnregisteredMemory) {
+  auto deviceLayer = std::shared_ptr<dev::IDeviceLayer>{std::make_unique<dev::DeviceLayerFake>()};
+  auto options = rt::getDefaultOptions();
+  options.checkDeviceApiVersion_ = false;
+  options.streamHostMemoryMinBytes_ = 4096;
+  auto runtime = IRuntime::create(deviceLayer, options);
+  auto dev = runtime->getDevices().front();
+  auto st = runtime->createStream(dev);
+  auto dmaInfo = runtime->getDmaInfo(dev);
+  // not DMA contiguous, so it takes several DMA commands
+  auto size = dmaInfo.maxElementSize_ + 4096 + 3;
+  std::vector<std::byte> host(size);
+  auto d_ptr = runtime->mallocDevice(dev, size);
+
+  EXPECT_TRUE(runtime->waitForEvent(runtime->memcpyHostToDevice(st, host.data() + 1, d_ptr, size - 1)));
+  EXPECT_TRUE(runtime->waitForEvent(runtime->memcpyDeviceToHost(st, d_ptr, host.data(), size)));
+  // below the threshold, through CMA
+  EXPECT_TRUE(runtime->waitForEvent(runtime->memcpyHostToDevice(st, host.data(), d_ptr, 64)));
+  MemcpyList list;
+  list.addOp(host.data(), d_ptr, 4096);
+  list.addOp(host.data() + 8192, d_ptr + 8192, 8192);
+  EXPECT_TRUE(runtime->waitForEvent(runtime->memcpyHostToDevice(st, list)));
+  runtime->freeDevice(dev, d_ptr);
+  runtime->destroyStream(st);
+}
+
+namespace {
+// fake device-layer with its DRAM mapped as plain host memory
+class MappedDramDeviceLayer : public dev::DeviceLayerFake {
+public:
+  MappedDramDeviceLayer()
+    : dram_(static_cast<std::byte*>(mmap(nullptr, getDramSize(0), PROT_READ | PROT_WRITE,
+                                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0))) {
+  }
+  ~MappedDramDeviceLayer() override {
+    munmap(dram_, getDramSize(0));
+  }
+  std::byte* getMappedDram(int) const override {
+    return dram_;
+  }
+  std::byte* at(const std::byte* d_ptr) const {
+    return dram_ + (reinterpret_cast<uint64_t>(d_ptr) - getDramBaseAddress(0));
+  }
+
+private:
+  std::byte* dram_;
+};
+} // namespace
+
+TEST(MappedDram, smallMemcpys) {
+  auto mappedDram = std::make_shared<MappedDramDeviceLayer>();
+  ASSERT_NE(mappedDram->getMappedDram(0), MAP_FAILED);
+  auto options = rt::getDefaultOptions();
+  options.checkDeviceApiVersion_ = false;
+  options.mappedDramH2DMaxBytes_ = 4096;
+  options.mappedDramD2HMaxBytes_ = 256;
+  auto runtime = IRuntime::create(mappedDram, options);
+  auto dev = runtime->getDevices().front();
+  auto st = runtime->createStream(dev);
+  auto d_ptr = runtime->mallocDevice(dev, 1 << 20);
+
+  std::vector<std::byte> src(128);
+  std::iota(reinterpret_cast<uint8_t*>(src.data()), reinterpret_cast<uint8_t*>(src.data() + src.size()), 1);
+  EXPECT_TRUE(runtime->waitForEvent(runtime->memcpyHostToDevice(st, src.data(), d_ptr + 64, src.size())));
+  EXPECT_EQ(std::memcmp(mappedDram->at(d_ptr + 64), src.data(), src.size()), 0);
+
+  std::memset(mappedDram->at(d_ptr + 4096), 0x5A, 256);
+  std::vector<std::byte> dst(256);
+  EXPECT_TRUE(runtime->waitForEvent(runtime->memcpyDeviceToHost(st, d_ptr + 4096, dst.data(), dst.size())));
+  EXPECT_EQ(dst, std::vector<std::byte>(256, std::byte{0x5A}));
+
+  // above the limit it goes through CMA and the DMA commands, which the fake doesn't write to the mapping
+  std::vector<std::byte> big(8192, std::byte{0x11});
+  EXPECT_TRUE(runtime->waitForEvent(runtime->memcpyHostToDevice(st, big.data(), d_ptr + 65536, big.size())));
+  EXPECT_NE(*mappedDram->at(d_ptr + 65536), std::byte{0x11});
+  runtime->freeDevice(dev, d_ptr);
+  runtime->destroyStream(st);
+}
+
+namespace {
+class HugePageDeviceLayer : public dev::DeviceLayerFake {
+public:
+  void* allocHugePageDmaBuffer(int, size_t sizeInBytes, bool) override {
+    auto buffer = malloc(sizeInBytes);
+    hugePageBuffers_.insert(buffer);
+    return buffer;
+  }
+  void freeDmaBuffer(void* dmaBuffer) override {
+    freedHugePages_ += hugePageBuffers_.erase(dmaBuffer);
+    DeviceLayerFake::freeDmaBuffer(dmaBuffer);
+  }
+  std::unordered_set<void*> hugePageBuffers_;
+  size_t freedHugePages_ = 0;
+};
+} // namespace
+
+TEST(HugePages, cmaBuffers) {
+  auto hugePages = std::make_shared<HugePageDeviceLayer>();
+  auto options = rt::getDefaultOptions();
+  options.checkDeviceApiVersion_ = false;
+  auto runtime = IRuntime::create(hugePages, options);
+  ASSERT_EQ(hugePages->hugePageBuffers_.size(), 1);
+  auto dev = runtime->getDevices().front();
+  auto st = runtime->createStream(dev);
+  std::vector<std::byte> src(1 << 20, std::byte{0x3C});
+  std::vector<std::byte> dst(src.size());
+  auto d_ptr = runtime->mallocDevice(dev, src.size());
+  runtime->memcpyHostToDevice(st, src.data(), d_ptr, src.size());
+  runtime->memcpyDeviceToHost(st, d_ptr, dst.data(), dst.size());
+  EXPECT_TRUE(runtime->waitForStream(st));
+  EXPECT_EQ(src, dst);
+  runtime->freeDevice(dev, d_ptr);
+  runtime->destroyStream(st);
+  runtime.reset();
+  EXPECT_EQ(hugePages->freedHugePages_, 1);
+
+  // without the option, the CMA buffers are never hugepages
+  options.hugePageCmaBuffers_ = false;
+  hugePages = std::make_shared<HugePageDeviceLayer>();
+  runtime = IRuntime::create(hugePages, options);
+  EXPECT_TRUE(hugePages->hugePageBuffers_.empty());
+}
+
+TEST(WarmStart, prefaultedCmaBuffers) {
+  auto deviceLayer = std::shared_ptr<dev::IDeviceLayer>{std::make_unique<dev::DeviceLayerFake>()};
+  auto options = rt::getDefaultOptions();
+  options.checkDeviceApiVersion_ = false;
+  options.prefaultCmaBuffers_ = true;
+  options.lockCmaBuffers_ = true; // it's fine if it can't be locked, it only warns
+  options.executionContextBuffers_ = 16;
+  auto runtime = IRuntime::create(deviceLayer, options);
+  auto dev = runtime->getDevices().front();
+  auto st = runtime->createStream(dev);
+  std::vector<std::byte> src(1 << 20, std::byte{0x5A});
+  std::vector<std::byte> dst(src.size());
+  auto d_ptr = runtime->mallocDevice(dev, src.size());
+  runtime->memcpyHostToDevice(st, src.data(), d_ptr, src.size());
+  runtime->memcpyDeviceToHost(st, d_ptr, dst.data(), dst.size());
+  EXPECT_TRUE(runtime->waitForStream(st));
+  EXPECT_EQ(src, dst);
+  runtime->freeDevice(dev, d_ptr);
+  runtime->destroyStream(st);
+}
+
+TEST_F(RuntimeFixture, convertedMemcpys) {
+  auto dev = devices_[0];
+  auto st = defaultStreams_[0];
+  constexpr auto kCount = 1UL << 20;
+  std::vector<float> host(kCount, 1.0f);
+  auto d_ptr = runtime_->mallocDevice(dev, kCount * 2);
+  runtime_->memcpyHostToDeviceConverted(st, host.data(), d_ptr, kCount, {DeviceElementType::Bf16});
+  EXPECT_TRUE(runtime_->waitForEvent(
+    runtime_->memcpyDeviceToHostConverted(st, d_ptr, host.data(), kCount, {DeviceElementType::Fp16})));
+  EXPECT_TRUE(runtime_->waitForStream(st));
+  EXPECT_TRUE(runtime_->retrieveStreamErrors(st).empty());
+  EXPECT_THROW(runtime_->memcpyHostToDeviceConverted(st, host.data(), d_ptr, kCount, {DeviceElementType::Int8, 0.0f}),
+               rt::Exception);
+  runtime_->freeDevice(dev, d_ptr);
+}
+
+TEST_F(RuntimeFixture, stridedListMemcpys) {
+  auto dev = devices_[0];
+  auto st = defaultStreams_[0];
+  auto dmaInfo = runtime_->getDmaInfo(dev);
+  // more rows than entries in a DMA command
+  auto rows = dmaInfo.maxElementCount_ * 3 + 1;
+  std::vector<std::byte> host(rows * 256);
+  auto d_ptr = runtime_->mallocDevice(dev, rows * 256);
+  MemcpyList h2d;
+  h2d.addStridedOp(host.data(), d_ptr, {64, rows, 1, 256, 0, 128});
+  EXPECT_TRUE(runtime_->waitForEvent(runtime_->memcpyHostToDevice(st, h2d)));
+  MemcpyList d2h;
+  d2h.addStridedOp(d_ptr, host.data(), {64, rows, 1, 128, 0, 256});
+  EXPECT_TRUE(runtime_->waitForEvent(runtime_->memcpyDeviceToHost(st, d2h)));
+  EXPECT_TRUE(runtime_->retrieveStreamErrors(st).empty());
+  runtime_->freeDevice(dev, d_ptr);
+}
+
 int main(int argc, char** argv) {
   RuntimeFixture::sDlType = RuntimeFixture::DeviceLayerImp::FAKE;
   testing::InitGoogleTest(&argc, argv);
@@ -5,6 +5,8 @@
 
 #include "KernelLaunchOptionsImp.h"
 #include "RuntimeFixture.h"
+#include <array>
+#include <cstring>
 #include <optional>
 
 using namespace rt;
@@ -16,6 +18,14 @@ TEST_F(RuntimeFixture, checkSetShireMask) {
   EXPECT_EQ(opts.imp_->shireMask_, shireMask);
 }
 
+TEST_F(RuntimeFixture, checkSetShireCount) {
+  KernelLaunchOptions opts;
+  opts.setShireCount(4);
+  EXPECT_EQ(opts.imp_->shireCount_, 4);
+  EXPECT_THROW(opts.setShireCount(-1), rt::Exception);
+  EXPECT_EQ(opts.imp_->shireCount_, 4);
+}
+
 TEST_F(RuntimeFixture, checkSetBarrier) {
   bool barrier = true;
   KernelLaunchOptions opts;
@@ -74,6 +84,93 @@ TEST_F(RuntimeFixture, checkSetCoreDumpFilePath) {
   EXPECT_TRUE(opts.imp_->coreDumpFilePath_ == coreDumpFilePath);
 }
 
+TEST_F(RuntimeFixture, checkSetFlushRanges) {
+  auto first = reinterpret_cast<const std::byte*>(0x8005801000UL);
+  auto second = reinterpret_cast<const std::byte*>(0x8005900040UL);
+
+  KernelLaunchOptions opts;
+  opts.setFlushRanges({{first, 4096}, {second, 100}});
+
+  ASSERT_EQ(opts.imp_->flushRanges_.size(), 2UL);
+  EXPECT_EQ(opts.imp_->flushRanges_[0].first, reinterpret_cast<uint64_t>(first));
+  EXPECT_EQ(opts.imp_->flushRanges_[0].second, 4096UL);
+  EXPECT_EQ(opts.imp_->flushRanges_[1].first, reinterpret_cast<uint64_t>(second));
+  EXPECT_EQ(opts.imp_->flushRanges_[1].second, 100UL);
+
+  // rejected ranges don't change the current ones
+  EXPECT_THROW(opts.setFlushRanges({{first, 0}}), rt::Exception);
+  std::vector<std::pair<const std::byte*, size_t>> tooMany(KernelLaunchOptions::kMaxFlushRanges + 1, {first, 64});
+  EXPECT_THROW(opts.setFlushRanges(tooMany), rt::Exception);
+  EXPECT_EQ(opts.imp_->flushRanges_.size(), 2UL);
+
+  opts.setFlushRanges({});
+  EXPECT_TRUE(opts.imp_->flushRanges_.empty());
+}
+
+TEST_F(RuntimeFixture, checkSetShireArgsStride) {
+  KernelLaunchOptions opts;
+  opts.setShireArgsStride(64);
+  EXPECT_EQ(opts.imp_->shireArgsStride_, 64U);
+  EXPECT_THROW(opts.setShireArgsStride(12), rt::Exception);
+  EXPECT_EQ(opts.imp_->shireArgsStride_, 64U);
+  opts.setShireArgsStride(0);
+  EXPECT_EQ(opts.imp_->shireArgsStride_, 0U);
+}
+
+TEST_F(RuntimeFixture, checkSetWatchdogTimeout) {
+  KernelLaunchOptions opts;
+  opts.setWatchdogTimeout(std::chrono::seconds{30});
+  EXPECT_EQ(opts.imp_->watchdogTimeout_, 30U);
+  EXPECT_THROW(opts.setWatchdogTimeout(std::chrono::seconds{-1}), rt::Exception);
+  EXPECT_EQ(opts.imp_->watchdogTimeout_, 30U);
+  opts.setWatchdogTimeout(std::chrono::seconds{0});
+  EXPECT_EQ(opts.imp_->watchdogTimeout_, 0U);
+}
+
+TEST_F(RuntimeFixture, checkSetPowerReport) {
+  KernelLaunchOptions opts;
+  opts.setPowerReport(true);
+  EXPECT_TRUE(opts.imp_->powerReport_);
+  opts.setPowerReport(false);
+  EXPECT_FALSE(opts.imp_->powerReport_);
+}
+
+TEST_F(RuntimeFixture, checkSetNoTensorOps) {
+  KernelLaunchOptions opts;
+  opts.setNoTensorOps(true);
+  EXPECT_TRUE(opts.imp_->noTensorOps_);
+  opts.setNoTensorOps(false);
+  EXPECT_FALSE(opts.imp_->noTensorOps_);
+}
+
+TEST_F(RuntimeFixture, checkSetLaunchPrefetch) {
+  KernelLaunchOptions opts;
+  opts.setLaunchPrefetch(true);
+  EXPECT_TRUE(opts.imp_->launchPrefetch_);
+  opts.setLaunchPrefetch(false);
+  EXPECT_FALSE(opts.imp_->launchPrefetch_);
+}
+
+TEST_F(RuntimeFixture, checkSetReportAndContinue) {
+  KernelLaunchOptions opts;
+  opts.setReportAndContinue(true);
+  EXPECT_TRUE(opts.imp_->reportAndContinue_);
+  opts.setReportAndContinue(false);
+  EXPECT_FALSE(opts.imp_->reportAndContinue_);
+}
+
+TEST_F(RuntimeFixture, checkSetShireCacheConfig) {
+  KernelLaunchOptions opts;
+  opts.setShireCacheConfig(0x80, 0x100);
+  EXPECT_EQ(opts.imp_->scpSets_, 0x80);
+  EXPECT_EQ(opts.imp_->l2Sets_, 0x100);
+  EXPECT_THROW(opts.setShireCacheConfig(0x81, 0x100), rt::Exception);
+  EXPECT_THROW(opts.setShireCacheConfig(0x80, 0x20), rt::Exception);
+  EXPECT_EQ(opts.imp_->l2Sets_, 0x100);
+  opts.setShireCacheConfig(0, 0);
+  EXPECT_EQ(opts.imp_->l2Sets_, 0);
+}
+
 TEST_F(RuntimeFixture, checkAllAPIAtOnce) {
   bool barrier = true;
   bool flushL3 = true;
@@ -114,8 +211,36 @@ TEST_F(RuntimeFixture, checkAllAPIAtOnce) {
   EXPECT_TRUE(opts.imp_->coreDumpFilePath_ == coreDumpFilePath);
 }
 
+TEST(KernelSignature, layoutMatchesAStruct) {
+  struct Args {
+    uint8_t a;
+    float* b;
+    uint32_t c;
+  };
+  EXPECT_EQ((kernelArgsSize<uint8_t, float*, uint32_t>()), sizeof(Args));
+  EXPECT_EQ(kernelArgsSize<>(), 0UL);
+
+  std::array<std::byte, sizeof(Args)> buffer{};
+  auto ptr = reinterpret_cast<float*>(0x1234);
+  packKernelArgs(buffer.data(), uint8_t{7}, ptr, uint32_t{42});
+  Args args;
+  std::memcpy(&args, buffer.data(), sizeof(args));
+  EXPECT_EQ(args.a, 7);
+  EXPECT_EQ(args.b, ptr);
+  EXPECT_EQ(args.c, 42U);
+}
+
+TEST(KernelSignature, tellsApartArguments) {
+  EXPECT_EQ((kernelSignature<float*, const float*, uint64_t>()), (kernelSignature<int*, float*, size_t>()));
+  EXPECT_NE((kernelSignature<float*, uint64_t>()), (kernelSignature<uint64_t, float*>()));
+  EXPECT_NE((kernelSignature<int32_t>()), (kernelSignature<uint32_t>()));
+  EXPECT_NE((kernelSignature<float>()), (kernelSignature<int32_t>()));
+  EXPECT_NE((kernelSignature<uint32_t>()), (kernelSignature<uint32_t, uint32_t>()));
+  static_assert(kernelSignature<double>() != kernelSignature<>());
+}
+
 int main(int argc, char** argv) {
   RuntimeFixture::sDlType = RuntimeFixture::DeviceLayerImp::FAKE;
   testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
-}
\ No newline at end of file
+}
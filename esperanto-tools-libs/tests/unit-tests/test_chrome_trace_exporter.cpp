@@ -0,0 +1,164 @@
+//******************************************************************************
+// Copyright (c) 2025 Ainekko, Co.
+// SPDX-License-Identifier: Apache-2.0
+//------------------------------------------------------------------------------
+
+#include "Utils.h"
+#include "runtime/ChromeTraceExporter.h"
+#include <cstring>
+#include <elfio/elfio.hpp>
+#include <et-trace/encoder.h>
+#include <et-trace/layout.h>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <unistd.h>
+#include <vector>
+
+using namespace rt;
+
+TEST(ChromeTraceExporter, mergesHostAndDeviceEvents) {
+  using namespace rt::profiling;
+  auto start = ProfileEvent::Clock::now();
+  ChromeTraceExporter exporter;
+
+  ProfileEvent props(Type::Complete, Class::GetDeviceProperties);
+  props.setTimeStamp(start);
+  props.setDeviceId(DeviceId{0});
+  auto deviceProperties = DeviceProperties{};
+  deviceProperties.frequency_ = 1000; // a cycle per ns
+  props.setDeviceProperties(deviceProperties);
+  exporter.addHostEvent(props);
+
+  // kernel waits from cycle 1000 to 1100 and executes till 2000
+  auto addResponse = [&exporter, start](EventId event, uint64_t startTs, std::chrono::microseconds received) {
+    ProfileEvent rsp(Type::Instant, Class::ResponseReceived);
+    rsp.setTimeStamp(start + received);
+    rsp.setEvent(event);
+    rsp.setDeviceId(DeviceId{0});
+    rsp.setResponseType(ResponseType::Kernel);
+    rsp.setDeviceCmdStartTs(startTs);
+    rsp.setDeviceCmdWaitDur(100);
+    rsp.setDeviceCmdExecDur(900);
+    exporter.addHostEvent(rsp);
+  };
+  addResponse(EventId{5}, 1000, std::chrono::microseconds(10));
+  // received later after its completion, must not be taken for the calibration
+  addResponse(EventId{6}, 3000, std::chrono::microseconds(50));
+
+  auto calibration = exporter.getClockCalibration(DeviceId{0});
+  ASSERT_TRUE(calibration);
+  EXPECT_EQ(calibration->deviceCycle_, 2000);
+  EXPECT_EQ(calibration->hostTime_, start + std::chrono::microseconds(10));
+  EXPECT_FALSE(exporter.getClockCalibration(DeviceId{1}));
+
+  // compute minion trace with 2 entries of shire 1 while the kernel 5 was executing
+  std::vector<std::byte> buffer(sizeof(trace_buffer_std_header_t));
+  auto addString = [&buffer](uint64_t cycle, uint16_t hartId, const std::string& str) {
+    trace_entry_header_t entry{cycle, static_cast<uint32_t>(TRACE_STRING_SIZE_ALIGN(str.size() + 1)), hartId,
+                               TRACE_TYPE_STRING};
+    auto offset = buffer.size();
+    buffer.resize(offset + sizeof(entry) + entry.payload_size);
+    std::memcpy(buffer.data() + offset, &entry, sizeof(entry));
+    std::memcpy(buffer.data() + offset + sizeof(entry), str.c_str(), str.size() + 1);
+  };
+  addString(1200, 64, "kernel start");
+  addString(1800, 65, "kernel end");
+  trace_buffer_std_header_t header{};
+  header.magic_header = TRACE_MAGIC_HEADER;
+  header.version = {TRACE_VERSION_MAJOR, TRACE_VERSION_MINOR, TRACE_VERSION_PATCH};
+  header.type = TRACE_CM_BUFFER;
+  header.data_size = static_cast<uint32_t>(buffer.size());
+  header.sub_buffer_size = static_cast<uint32_t>(buffer.size());
+  header.sub_buffer_count = 1;
+  std::memcpy(buffer.data(), &header, sizeof(header));
+  exporter.addDeviceTrace(DeviceId{0}, DeviceTraceType::ComputeMinion, std::move(buffer));
+
+  std::stringstream ss;
+  exporter.write(ss);
+  auto trace = ss.str();
+  EXPECT_NE(trace.find(R"("name":"GetDeviceProperties","ph":"X")"), std::string::npos) << trace;
+  EXPECT_NE(trace.find(R"("name":"Kernel 5","ph":"X","ts":9.100,"pid":1,"tid":0,"dur":0.900)"), std::string::npos)
+    << trace;
+  EXPECT_NE(trace.find(R"("name":"Kernel 5","ph":"X","ts":9.200,"pid":1,"tid":101,"dur":0.600)"), std::string::npos)
+    << trace;
+  EXPECT_NE(trace.find(R"("name":"kernel start","ph":"i","ts":9.200,"pid":1,"tid":101)"), std::string::npos) << trace;
+  EXPECT_NE(trace.find(R"("name":"Shire 1")"), std::string::npos) << trace;
+}
+
+TEST(ChromeTraceExporter, formatsDeferredStrings) {
+  using namespace rt::profiling;
+  ChromeTraceExporter exporter;
+  exporter.setClockCalibration(DeviceId{0}, ClockCalibration{ProfileEvent::Clock::now(), 0, 1000});
+
+  // firmware image with its read only strings at 0x8000, loaded 0x1000 after its link address
+  constexpr uint64_t kRodata = 0x8000;
+  constexpr uint64_t kLoadBias = 0x1000;
+  const char strings[] = "shire %u took %llu cycles\0" // 0x8000
+                         "%s done\0"                    // 0x801A
+                         "kernel";                      // 0x8022
+  ELFIO::elfio elf;
+  elf.create(ELFCLASS64, ELFDATA2LSB);
+  elf.set_type(ET_EXEC);
+  elf.set_machine(EM_RISCV);
+  auto section = elf.sections.add(".rodata");
+  section->set_type(SHT_PROGBITS);
+  section->set_flags(SHF_ALLOC);
+  section->set_addr_align(8);
+  section->set_data(strings, sizeof(strings));
+  auto segment = elf.segments.add();
+  segment->set_type(PT_LOAD);
+  segment->set_flags(PF_R);
+  segment->set_virtual_address(kRodata);
+  segment->set_physical_address(kRodata);
+  segment->set_align(0x1000);
+  segment->add_section_index(section->get_index(), section->get_addr_align());
+  char path[] = "/tmp/deviceImageXXXXXX";
+  auto fd = mkstemp(path);
+  ASSERT_GE(fd, 0);
+  close(fd);
+  ASSERT_TRUE(elf.save(path));
+  std::ifstream image(path, std::ios::binary);
+  unlink(path);
+  exporter.addDeviceImage(DeviceId{0}, image, kLoadBias);
+
+  std::vector<std::byte> buffer(sizeof(trace_buffer_std_header_t));
+  auto addDeferred = [&buffer](uint64_t cycle, uint64_t format, std::vector<uint64_t> args) {
+    trace_string_deferred_t entry{};
+    entry.header = {cycle, static_cast<uint32_t>(sizeof(entry) - sizeof(trace_entry_header_t) + args.size() * 8), 64,
+                    TRACE_TYPE_STRING_DEFERRED};
+    entry.format = format;
+    entry.log_level = TRACE_EVENT_STRING_INFO;
+    entry.arg_count = static_cast<uint8_t>(args.size());
+    auto offset = buffer.size();
+    buffer.resize(offset + sizeof(entry) + args.size() * 8);
+    std::memcpy(buffer.data() + offset, &entry, sizeof(entry));
+    std::memcpy(buffer.data() + offset + sizeof(entry), args.data(), args.size() * 8);
+  };
+  addDeferred(1000, kRodata + kLoadBias, {1, 1234});
+  addDeferred(2000, kRodata + kLoadBias + 0x1A, {kRodata + kLoadBias + 0x22});
+  // not in the image
+  addDeferred(3000, 0x100, {});
+  trace_buffer_std_header_t header{};
+  header.magic_header = TRACE_MAGIC_HEADER;
+  header.version = {TRACE_VERSION_MAJOR, TRACE_VERSION_MINOR, TRACE_VERSION_PATCH};
+  header.type = TRACE_CM_BUFFER;
+  header.data_size = static_cast<uint32_t>(buffer.size());
+  header.sub_buffer_size = static_cast<uint32_t>(buffer.size());
+  header.sub_buffer_count = 1;
+  std::memcpy(buffer.data(), &header, sizeof(header));
+  exporter.addDeviceTrace(DeviceId{0}, DeviceTraceType::ComputeMinion, std::move(buffer));
+
+  std::stringstream ss;
+  exporter.write(ss);
+  auto trace = ss.str();
+  EXPECT_NE(trace.find(R"("name":"shire 1 took 1234 cycles","ph":"i")"), std::string::npos) << trace;
+  EXPECT_NE(trace.find(R"("name":"kernel done","ph":"i")"), std::string::npos) << trace;
+  EXPECT_NE(trace.find(R"("name":"<format 0x100>","ph":"i")"), std::string::npos) << trace;
+}
+
+int main(int argc, char** argv) {
+  logging::LoggerDefault logger_;
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
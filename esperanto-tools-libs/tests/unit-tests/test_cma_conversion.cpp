@@ -0,0 +1,57 @@
+//******************************************************************************
+// Copyright (c) 2025 Ainekko, Co.
+// SPDX-License-Identifier: Apache-2.0
+//------------------------------------------------------------------------------
+
+#include "Utils.h"
+#include "dma/CmaConversion.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace rt;
+
+TEST(CmaConversion, roundTrips) {
+  std::vector<float> src{0.0f, -0.0f, 1.0f, -2.5f, 65504.0f, 70000.0f, 1e-7f, 3.14159f, 1.00390625f};
+  src.resize(1000, 0.75f);
+  std::vector<uint16_t> half(src.size());
+  std::vector<float> back(src.size());
+  convertToDevice(src.data(), reinterpret_cast<std::byte*>(half.data()), src.size(), {DeviceElementType::Fp16});
+  EXPECT_EQ(half[2], 0x3C00);
+  EXPECT_EQ(half[4], 0x7BFF);
+  // overflows become infinity, tiny values subnormals
+  EXPECT_EQ(half[5], 0x7C00);
+  EXPECT_EQ(half[6], 0x0002);
+  convertFromDevice(reinterpret_cast<std::byte*>(half.data()), back.data(), back.size(), {DeviceElementType::Fp16});
+  EXPECT_EQ(back[3], -2.5f);
+  EXPECT_EQ(back[999], 0.75f);
+
+  convertToDevice(src.data(), reinterpret_cast<std::byte*>(half.data()), src.size(), {DeviceElementType::Bf16});
+  EXPECT_EQ(half[2], 0x3F80);
+  // ties round to even
+  EXPECT_EQ(half[8], 0x3F80);
+  convertFromDevice(reinterpret_cast<std::byte*>(half.data()), back.data(), back.size(), {DeviceElementType::Bf16});
+  EXPECT_EQ(back[3], -2.5f);
+
+  std::vector<int8_t> quantized(src.size());
+  MemcpyConversion int8{DeviceElementType::Int8, 0.5f};
+  convertToDevice(src.data(), reinterpret_cast<std::byte*>(quantized.data()), src.size(), int8);
+  EXPECT_EQ(quantized[3], -5);
+  // saturated
+  EXPECT_EQ(quantized[4], 127);
+  EXPECT_EQ(quantized[999], 2);
+  convertFromDevice(reinterpret_cast<std::byte*>(quantized.data()), back.data(), back.size(), int8);
+  EXPECT_EQ(back[3], -2.5f);
+  EXPECT_EQ(back[999], 1.0f);
+
+  // the copy function maps the offsets in device bytes back to the fp32 values
+  auto copy = makeConvertingCopyFunction({DeviceElementType::Fp16}, reinterpret_cast<const std::byte*>(src.data()));
+  copy(reinterpret_cast<const std::byte*>(src.data()) + 200, reinterpret_cast<std::byte*>(half.data()), 20,
+       CmaCopyType::TO_CMA);
+  EXPECT_EQ(half[0], 0x3A00);
+}
+
+int main(int argc, char** argv) {
+  logging::LoggerDefault logger_;
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
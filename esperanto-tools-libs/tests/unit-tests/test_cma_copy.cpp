@@ -0,0 +1,41 @@
+//******************************************************************************
+// Copyright (c) 2025 Ainekko, Co.
+// SPDX-License-Identifier: Apache-2.0
+//------------------------------------------------------------------------------
+
+#include "Utils.h"
+#include "runtime/Types.h"
+#include <algorithm>
+#include <cstring>
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace rt;
+
+TEST(CmaCopy, unalignedSizesAndOffsets) {
+  constexpr auto kSize = 1UL << 20;
+  std::vector<std::byte> src(kSize);
+  std::vector<std::byte> dst(kSize);
+  for (auto i = 0UL; i < kSize; ++i) {
+    src[i] = static_cast<std::byte>(i * 7 + 3);
+  }
+  // below and above the size copied with non-temporal stores, with unaligned heads and tails
+  for (auto type : {CmaCopyType::TO_CMA, CmaCopyType::FROM_CMA}) {
+    for (auto size : {0UL, 100UL, 65537UL, kSize - 128}) {
+      for (auto offset : {0UL, 13UL, 64UL}) {
+        std::fill(begin(dst), end(dst), std::byte{0});
+        copyCma(src.data() + offset, dst.data() + 64 - offset, size, type);
+        EXPECT_EQ(std::memcmp(src.data() + offset, dst.data() + 64 - offset, size), 0);
+        EXPECT_TRUE(std::all_of(begin(dst), begin(dst) + static_cast<long>(64 - offset),
+                                [](std::byte b) { return b == std::byte{0}; }));
+        EXPECT_EQ(dst[64 - offset + size], std::byte{0});
+      }
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  logging::LoggerDefault logger_;
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
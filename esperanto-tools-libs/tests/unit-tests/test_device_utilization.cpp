@@ -0,0 +1,90 @@
+//******************************************************************************
+// Copyright (c) 2025 Ainekko, Co.
+// SPDX-License-Identifier: Apache-2.0
+//------------------------------------------------------------------------------
+
+#include "DeviceUtilization.h"
+#include "Utils.h"
+#include <cstring>
+#include <et-trace/layout.h>
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace rt;
+
+TEST(DeviceUtilization, decodesMasterMinionSamples) {
+  std::vector<std::byte> buffer(sizeof(trace_buffer_std_header_t));
+  auto addCustomEvent = [&buffer](uint64_t cycle, uint32_t customType, const void* payload, uint32_t size) {
+    trace_custom_event_t event{};
+    event.header = {cycle, static_cast<uint32_t>(sizeof(event) - sizeof(trace_entry_header_t) + size), 2048,
+                    TRACE_TYPE_CUSTOM_EVENT};
+    event.custom_type = customType;
+    event.payload_size = size;
+    auto offset = buffer.size();
+    buffer.resize(offset + sizeof(event) + size);
+    std::memcpy(buffer.data() + offset, &event, sizeof(event));
+    std::memcpy(buffer.data() + offset + sizeof(event), payload, size);
+  };
+  mm_utilization_sample sample{};
+  sample.interval_cycles = 1000;
+  sample.busy_shire_mask = 0x3;
+  sample.kernel_busy_cycles = 250;
+  sample.sq_count = 2;
+  sample.sq_pending_bytes[0] = 128;
+  sample.sq_inflight_cmds[1] = 3;
+  sample.dma_h2d_busy_cycles[0] = 500;
+  sample.dma_d2h_busy_cycles[3] = 2000; // accounted at transfer completion, it can exceed the interval
+  addCustomEvent(5000, TRACE_CUSTOM_TYPE_MM_UTILIZATION, &sample, sizeof(sample));
+  // other stats events logged into the same buffer must be skipped
+  compute_resources_sample resources{};
+  addCustomEvent(6000, TRACE_CUSTOM_TYPE_MM_COMPUTE_RESOURCES, &resources, sizeof(resources));
+  auto writeHeader = [&buffer] {
+    trace_buffer_std_header_t header{};
+    header.magic_header = TRACE_MAGIC_HEADER;
+    header.version = {TRACE_VERSION_MAJOR, TRACE_VERSION_MINOR, TRACE_VERSION_PATCH};
+    header.type = TRACE_MM_STATS_BUFFER;
+    header.data_size = static_cast<uint32_t>(buffer.size());
+    header.sub_buffer_size = static_cast<uint32_t>(buffer.size());
+    header.sub_buffer_count = 1;
+    std::memcpy(buffer.data(), &header, sizeof(header));
+  };
+  writeHeader();
+
+  auto samples = decodeUtilizationSamples(buffer);
+  ASSERT_EQ(samples.size(), 1);
+  const auto& us = samples.front();
+  EXPECT_EQ(us.timestampCycles_, 5000);
+  EXPECT_EQ(us.intervalCycles_, 1000);
+  EXPECT_EQ(us.busyShireMask_, 0x3);
+  EXPECT_DOUBLE_EQ(us.kernelBusy_, 0.25);
+  ASSERT_EQ(us.sqPendingBytes_.size(), 2);
+  EXPECT_EQ(us.sqPendingBytes_[0], 128);
+  ASSERT_EQ(us.sqInflightCommands_.size(), 2);
+  EXPECT_EQ(us.sqInflightCommands_[1], 3);
+  ASSERT_EQ(us.dmaHostToDeviceBusy_.size(), TRACE_MM_UTILIZATION_DMA_CHANNEL_COUNT);
+  EXPECT_DOUBLE_EQ(us.dmaHostToDeviceBusy_[0], 0.5);
+  EXPECT_DOUBLE_EQ(us.dmaDeviceToHostBusy_[3], 1.0);
+
+  // truncated buffers are not read past their end
+  buffer.resize(buffer.size() - sizeof(resources) - 8);
+  EXPECT_EQ(decodeUtilizationSamples(buffer).size(), 1);
+  EXPECT_TRUE(decodeUtilizationSamples(std::vector<std::byte>(4)).empty());
+
+  // once the ring has wrapped the newest samples are at the start of the buffer, they are returned oldest first
+  buffer.resize(sizeof(trace_buffer_std_header_t));
+  addCustomEvent(9000, TRACE_CUSTOM_TYPE_MM_UTILIZATION, &sample, sizeof(sample));
+  addCustomEvent(7000, TRACE_CUSTOM_TYPE_MM_UTILIZATION, &sample, sizeof(sample));
+  addCustomEvent(8000, TRACE_CUSTOM_TYPE_MM_UTILIZATION, &sample, sizeof(sample));
+  writeHeader();
+  samples = decodeUtilizationSamples(buffer);
+  ASSERT_EQ(samples.size(), 3);
+  EXPECT_EQ(samples[0].timestampCycles_, 7000);
+  EXPECT_EQ(samples[1].timestampCycles_, 8000);
+  EXPECT_EQ(samples[2].timestampCycles_, 9000);
+}
+
+int main(int argc, char** argv) {
+  logging::LoggerDefault logger_;
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -87,6 +87,10 @@ TEST(devices, get_properties) {
   EXPECT_EQ(properties.onPkgDRAMChipletBits_, dc.onPkgDRAMChipletBits_);
   EXPECT_EQ(properties.onPkgDRAMInterleavedChipletLSb_, dc.onPkgDRAMInterleavedChipletLSb_);
   EXPECT_EQ(properties.onPkgDRAMInterleavedChipletBits_, dc.onPkgDRAMInterleavedChipletBits_);
+  EXPECT_GE(properties.maxConcurrentKernels_, 1);
+  EXPECT_EQ(properties.dramMemshireLSb_, 6);
+  EXPECT_EQ(properties.dramMemshireBits_, 3);
+  EXPECT_EQ(properties.dramMemshireControllerBit_, 9);
 }
 
 int main(int argc, char** argv) {
@@ -25,7 +25,7 @@ class EventManagerF : public ::testing::Test {
 public:
   void TearDown() override {
     // ensure there are not missing events
-    ASSERT_TRUE(em_.onflyEvents_.empty());
+    ASSERT_EQ(em_.getNumOnflyEvents(), 0UL);
     ASSERT_TRUE(em_.blockedThreads_.empty());
   }
   template <typename Functor> std::thread createAndBlockThread(EventId evt, bool detach, Functor&& functor) {
@@ -93,7 +93,7 @@ TEST_F(EventManagerF, severalEvents) {
     EXPECT_FALSE(em_.isDispatched(events[i + 1]));
   }
 
-  EXPECT_EQ(em_.onflyEvents_.size(), 50);
+  EXPECT_EQ(em_.getNumOnflyEvents(), 50);
 
   // also dispatch odd events
   for (auto i = 1U; i < 100; i += 2) {
@@ -126,6 +126,48 @@ TEST_F(EventManagerF, blockingThreads) {
   EXPECT_EQ(unblockedThreads.load(), nThreads);
 }
 
+TEST_F(EventManagerF, callbacksAreRunOnceAllWatchedEventsAreDispatched) {
+  std::vector<EventId> events;
+  for (int i = 0; i < 10; ++i) {
+    events.emplace_back(em_.getNextId());
+  }
+  std::atomic<int> executed = 0;
+  // watch the same event twice to ensure duplicates don't stall the callback
+  em_.addOnDispatchCallback({{events[0], events[0], events[9]}, [&executed] { executed.fetch_add(1); }});
+  em_.addOnDispatchCallback({events, [&executed] { executed.fetch_add(1); }});
+  em_.dispatch(events[0]);
+  for (auto i = 1U; i < 9; ++i) {
+    em_.dispatch(events[i]);
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_EQ(executed.load(), 0);
+  em_.dispatch(events[9]);
+  while (executed.load() != 2) {
+    std::this_thread::yield();
+  }
+  EXPECT_TRUE(em_.callbacks_.empty());
+  EXPECT_TRUE(em_.callbacksByEvent_.empty());
+}
+
+TEST_F(EventManagerF, dispatchThroughput) {
+  // keep many events on-fly with callbacks attached to check dispatch cost doesn't depend on them
+  constexpr auto kOnfly = 10000U;
+  constexpr auto kIterations = 50000U; // stay below the EventId range so ids are not reused
+  std::vector<EventId> onfly;
+  for (auto i = 0U; i < kOnfly; ++i) {
+    onfly.emplace_back(em_.getNextId());
+    em_.addOnDispatchCallback({{onfly.back()}, [] {}});
+  }
+  auto start = std::chrono::steady_clock::now();
+  for (auto i = 0U; i < kIterations; ++i) {
+    em_.dispatch(em_.getNextId());
+  }
+  auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  LOG(INFO) << "Dispatched " << kIterations << " events with " << kOnfly << " on-fly in " << elapsed
+            << "s. Events/s: " << kIterations / elapsed;
+  em_.dispatch(onfly);
+}
+
 int main(int argc, char** argv) {
   logging::LoggerDefault logger_;
   testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,64 @@
+//******************************************************************************
+// Copyright (c) 2025 Ainekko, Co.
+// SPDX-License-Identifier: Apache-2.0
+//------------------------------------------------------------------------------
+
+#include "Utils.h"
+#include "server/PrometheusExporter.h"
+#include <gtest/gtest.h>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+using namespace rt;
+
+TEST(LatencyHistogram, bucketBounds) {
+  using rt::LatencyHistogram;
+  std::vector<uint64_t> values = {0, 1, 31, 32, 33, 1000, 123456789, std::numeric_limits<uint64_t>::max()};
+  for (uint32_t bit = 0; bit < 64; ++bit) {
+    values.emplace_back(uint64_t{1} << bit);
+    values.emplace_back((uint64_t{1} << bit) - 1);
+  }
+  for (auto value : values) {
+    auto bucket = LatencyHistogram::getBucket(value);
+    ASSERT_LT(bucket, LatencyHistogram::kNumBuckets);
+    auto upper = LatencyHistogram::getBucketUpperBound(bucket);
+    EXPECT_GE(upper, value);
+    // within 1/16 of the value, 1/kSubBuckets
+    EXPECT_LE(upper - value, value / LatencyHistogram::kSubBuckets);
+    if (bucket > 0) {
+      EXPECT_LT(LatencyHistogram::getBucketUpperBound(bucket - 1), value);
+    }
+  }
+
+  LatencyHistogram histogram;
+  for (uint64_t i = 1; i <= 100; ++i) {
+    histogram.counts_[LatencyHistogram::getBucket(i * 1000)]++;
+    histogram.count_++;
+    histogram.sum_ += i * 1000;
+  }
+  histogram.min_ = 1000;
+  histogram.max_ = 100000;
+  EXPECT_EQ(histogram.getPercentile(1.0), 100000);
+  auto p50 = histogram.getPercentile(0.5);
+  EXPECT_GE(p50, 50000);
+  EXPECT_LE(p50, 50000 + 50000 / LatencyHistogram::kSubBuckets);
+
+  std::unordered_map<rt::DeviceId, rt::DeviceMetrics> metrics;
+  metrics[rt::DeviceId{0}].latencies_[0][0] = histogram;
+  metrics[rt::DeviceId{0}].bytesHostToDevice_ = 4096;
+  auto text = rt::formatPrometheusMetrics(metrics, {});
+  EXPECT_NE(text.find("et_command_latency_seconds_count{device=\"0\",command=\"kernel_launch\","
+                      "stage=\"submit_to_start\"} 100\n"),
+            std::string::npos);
+  EXPECT_NE(text.find("et_command_latency_seconds_bucket{device=\"0\",command=\"kernel_launch\","
+                      "stage=\"submit_to_start\",le=\"+Inf\"} 100\n"),
+            std::string::npos);
+  EXPECT_NE(text.find("et_dma_bytes_total{device=\"0\",direction=\"h2d\"} 4096\n"), std::string::npos);
+}
+
+int main(int argc, char** argv) {
+  logging::LoggerDefault logger_;
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,83 @@
+//******************************************************************************
+// Copyright (c) 2025 Ainekko, Co.
+// SPDX-License-Identifier: Apache-2.0
+//------------------------------------------------------------------------------
+
+#include "MemcpyOps.h"
+#include "Utils.h"
+#include <cstring>
+#include <esperanto/device-apis/operations-api/device_ops_api_cxx.h>
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace rt;
+
+TEST(MemcpyList, stridedOps) {
+  std::vector<std::byte> src(4096);
+  std::vector<std::byte> dst(4096);
+  // a 2x3x16 tile out of 2 planes of 4x32 bytes, into a packed buffer
+  MemcpyList list;
+  list.addStridedOp(src.data() + 8, dst.data(), {16, 3, 2, 32, 128});
+  ASSERT_EQ(list.operations_.size(), 6UL);
+  EXPECT_EQ(list.operations_[1].src_, src.data() + 8 + 32);
+  EXPECT_EQ(list.operations_[1].dst_, dst.data() + 16);
+  EXPECT_EQ(list.operations_[3].src_, src.data() + 8 + 128);
+  EXPECT_EQ(list.operations_[3].dst_, dst.data() + 48);
+
+  // packed rows are merged, with the previous op too
+  list.addStridedOp(src.data() + 1024, dst.data() + 1024, {64, 4, 2});
+  list.addStridedOp(src.data() + 1536, dst.data() + 1536, {64, 2});
+  ASSERT_EQ(list.operations_.size(), 7UL);
+  EXPECT_EQ(list.operations_.back().size_, 640UL);
+  // rows packed on a single side are not
+  list.addStridedOp(src.data() + 2048, dst.data() + 2048, {64, 4, 1, 0, 0, 128});
+  EXPECT_EQ(list.operations_.size(), 11UL);
+
+  EXPECT_THROW(list.addStridedOp(src.data(), dst.data(), {0, 4}), rt::Exception);
+  EXPECT_THROW(list.addStridedOp(src.data(), dst.data(), {64, 4, 1, 32}), rt::Exception);
+  EXPECT_THROW(list.addStridedOp(src.data(), dst.data(), {64, 4, 2, 64, 128}), rt::Exception);
+}
+
+TEST(MemcpyList, stagedListCommands) {
+  std::vector<std::byte> host(4096);
+  std::vector<std::byte> cma(4096);
+  dev::DmaInfo dmaInfo{};
+  dmaInfo.maxElementSize_ = 256;
+  dmaInfo.maxElementCount_ = 4;
+  auto entrySizes = [](MemcpyCommandBuilder& builder) {
+    std::vector<uint32_t> sizes;
+    auto data = builder.build();
+    for (auto node = offsetof(device_ops_api::device_ops_dma_writelist_cmd_t, list); node < data.size();
+         node += sizeof(device_ops_api::dma_write_node)) {
+      device_ops_api::dma_write_node entry;
+      std::memcpy(&entry, data.data() + node, sizeof(entry));
+      sizes.emplace_back(entry.size);
+    }
+    return sizes;
+  };
+  auto device = reinterpret_cast<std::byte*>(0x8000000000UL);
+
+  // strided on the host side only: staged in cma, the rows become contiguous entries, split at maxElementSize_
+  MemcpyList gather;
+  gather.addStridedOp(host.data(), device, {100, 10, 1, 200});
+  auto builders = buildStagedListCommands(MemcpyType::H2D, gather, cma.data(), false, dmaInfo);
+  ASSERT_EQ(builders.size(), 1UL);
+  EXPECT_EQ(entrySizes(builders[0]), (std::vector<uint32_t>{256, 256, 256, 232}));
+
+  // strided on the device side: an entry per row, in as many commands as needed
+  MemcpyList scatter;
+  scatter.addStridedOp(device, host.data(), {100, 10, 1, 200});
+  builders = buildStagedListCommands(MemcpyType::D2H, scatter, cma.data(), true, dmaInfo);
+  ASSERT_EQ(builders.size(), 3UL);
+  EXPECT_EQ(entrySizes(builders[2]).size(), 2UL);
+
+  auto ranges = groupStagedCopies(scatter);
+  ASSERT_EQ(ranges.size(), 1UL);
+  EXPECT_EQ(ranges[0].count_, 10UL);
+}
+
+int main(int argc, char** argv) {
+  logging::LoggerDefault logger_;
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
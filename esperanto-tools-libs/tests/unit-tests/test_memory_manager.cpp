@@ -411,6 +411,172 @@ TEST(MemoryManager, get_allocations) {
   ASSERT_EQ(mm.getAllocations().size(), 0);
 }
 
+TEST(MemoryManager, size_classes_malloc_free_holes) {
+  auto totalRam = 1UL << 34;
+  auto mm = MemoryManager(1 << 12, totalRam, kBlockSize, MemoryAllocatorPolicy::SizeClasses);
+  mm.setDebugMode(true);
+
+  EXPECT_THROW({ mm.malloc(totalRam + 1024, 1024); }, Exception);
+
+  std::vector<std::byte*> ptrs;
+  for (int i = 0; i < 100; ++i) {
+    ptrs.emplace_back(mm.malloc(1024, 1024));
+    ASSERT_NE(ptrs.back(), nullptr);
+  }
+  ASSERT_EQ(mm.getNumFreeChunks(), 1);
+
+  // free odd pos of buffers
+  for (auto i = 1U; i < 100; i += 2) {
+    mm.free(ptrs[i]);
+  }
+  ASSERT_EQ(mm.getNumFreeChunks(), 50);
+  ASSERT_EQ(mm.sizeClasses_[0].size(), 49);
+
+  // a small allocation should reuse one of the holes instead of the big chunk
+  auto hole = mm.malloc(1024, 1024);
+  ASSERT_EQ(hole, ptrs[1]);
+  mm.free(hole);
+
+  // free even buffers
+  for (auto i = 0U; i < 100; i += 2) {
+    mm.free(ptrs[i]);
+  }
+  ASSERT_EQ(mm.getNumFreeChunks(), 1);
+  ASSERT_EQ(mm.getFreeBytes(), totalRam);
+  ASSERT_EQ(mm.getFreeContiguousBytes(), totalRam);
+}
+
+TEST(MemoryManager, size_classes_best_fit) {
+  auto mm = MemoryManager(1 << 12, 1UL << 34, kBlockSize, MemoryAllocatorPolicy::SizeClasses);
+  mm.setDebugMode(true);
+  auto big = 64U * kBlockSize;
+  auto a = mm.malloc(2 * big, kBlockSize);
+  auto separator1 = mm.malloc(kBlockSize, kBlockSize);
+  auto b = mm.malloc(big, kBlockSize);
+  auto separator2 = mm.malloc(kBlockSize, kBlockSize);
+  mm.free(a);
+  mm.free(b);
+  // first fit would take 'a'; best fit takes the hole which matches exactly
+  ASSERT_EQ(mm.malloc(big, kBlockSize), b);
+  ASSERT_EQ(mm.malloc(2 * big, kBlockSize), a);
+  unused(separator1, separator2);
+}
+
+TEST(MemoryManager, size_classes_random_alignments) {
+  std::default_random_engine e1(1234);
+  auto totalRam = 1UL << 30;
+  for (auto startAddress : {1UL << 12, 0x800000UL}) {
+    auto mm = MemoryManager(startAddress, totalRam, 1024, MemoryAllocatorPolicy::SizeClasses);
+    std::uniform_int_distribution<size_t> sizeDist(1, 1UL << 17);
+    std::uniform_int_distribution<uint32_t> alignDist(6, 16);
+    std::vector<std::byte*> ptrs;
+    for (auto i = 0U; i < 5000; ++i) {
+      if (!ptrs.empty() && (i % 3 == 0)) {
+        std::uniform_int_distribution<size_t> pick(0, ptrs.size() - 1);
+        auto pos = pick(e1);
+        mm.free(ptrs[pos]);
+        ptrs.erase(begin(ptrs) + static_cast<long>(pos));
+        continue;
+      }
+      auto alignment = 1U << alignDist(e1);
+      auto ptr = mm.malloc(sizeDist(e1), alignment);
+      ASSERT_EQ(reinterpret_cast<uint64_t>(ptr) % alignment, 0UL);
+      ptrs.emplace_back(ptr);
+    }
+    mm.sanityCheck();
+    auto stats = mm.getFragmentationStats();
+    ASSERT_EQ(stats.freeBytes_, mm.getFreeBytes());
+    ASSERT_LE(stats.largestFreeChunkBytes_, stats.freeBytes_);
+    ASSERT_GE(stats.fragmentation_, 0.0);
+    ASSERT_LT(stats.fragmentation_, 1.0);
+    for (auto p : ptrs) {
+      mm.free(p);
+    }
+    ASSERT_EQ(mm.getNumFreeChunks(), 1);
+    ASSERT_EQ(mm.getFragmentationStats().fragmentation_, 0.0);
+  }
+}
+
+TEST(MemoryManager, compaction) {
+  for (auto policy : {MemoryAllocatorPolicy::FirstFit, MemoryAllocatorPolicy::SizeClasses}) {
+    auto mm = MemoryManager(1 << 12, 1UL << 30, kBlockSize, policy);
+    mm.setDebugMode(true);
+    std::vector<std::byte*> ptrs;
+    for (auto i = 0; i < 64; ++i) {
+      ptrs.emplace_back(mm.malloc((i % 5 + 1) * kBlockSize, i % 3 == 0 ? 4 * kBlockSize : kBlockSize));
+    }
+    // leave holes, with one pinned allocation in the middle
+    std::map<const std::byte*, uint32_t> movable;
+    for (auto i = 0U; i < ptrs.size(); ++i) {
+      if (i % 2 == 1) {
+        mm.free(ptrs[i]);
+      } else if (i != 32) {
+        movable.emplace(ptrs[i], i % 3 == 0 ? 4 * kBlockSize : kBlockSize);
+      }
+    }
+    auto fragmentation = mm.getFragmentationStats().fragmentation_;
+    auto relocations = mm.getCompaction(movable);
+    ASSERT_FALSE(relocations.empty());
+    for (const auto& r : relocations) {
+      EXPECT_LT(r.to_, r.from_);
+      EXPECT_EQ(reinterpret_cast<uint64_t>(r.to_) % movable.at(r.from_), 0);
+      mm.relocate(r.from_, r.to_);
+    }
+    // the allocations after the pinned one are packed, only leaving the blocks needed by their alignment
+    EXPECT_TRUE(mm.isAllocation(ptrs[32]));
+    EXPECT_LT(mm.getFragmentationStats().fragmentation_, fragmentation);
+    auto allocs = mm.getAllocations();
+    auto pinned = std::find_if(begin(allocs), end(allocs), [&ptrs](const auto& a) { return a.address_ == ptrs[32]; });
+    ASSERT_NE(pinned, end(allocs));
+    for (auto it = std::next(pinned); it != end(allocs); ++it) {
+      auto prev = std::prev(it);
+      EXPECT_LE(it->address_ - (prev->address_ + prev->size_), 3 * kBlockSize);
+    }
+    EXPECT_THROW(mm.relocate(ptrs[1], ptrs[3]), Exception);
+    for (const auto& a : allocs) {
+      mm.free(a.address_);
+    }
+    ASSERT_EQ(mm.getNumFreeChunks(), 1);
+  }
+}
+
+TEST(MemoryManager, benchmark_policies) {
+  constexpr auto kNumLiveAllocations = 10000U;
+  constexpr auto kNumIterations = 20000U;
+  for (auto policy : {MemoryAllocatorPolicy::FirstFit, MemoryAllocatorPolicy::SizeClasses}) {
+    std::default_random_engine e1(12389);
+    // mostly small tensors with a few big ones
+    std::uniform_int_distribution<size_t> smallDist(1, 16 * kBlockSize);
+    std::uniform_int_distribution<size_t> bigDist(1, 1U << 22);
+    std::uniform_int_distribution<uint32_t> kindDist(0, 9);
+    auto mm = MemoryManager(1UL << 13, 1UL << 34, kBlockSize, policy);
+    auto nextSize = [&] { return kindDist(e1) == 0 ? bigDist(e1) : smallDist(e1); };
+
+    std::vector<std::byte*> ptrs;
+    ptrs.reserve(kNumLiveAllocations);
+    for (auto i = 0U; i < kNumLiveAllocations; ++i) {
+      ptrs.emplace_back(mm.malloc(nextSize(), kCacheLineSize));
+    }
+    auto start = std::chrono::steady_clock::now();
+    for (auto i = 0U; i < kNumIterations; ++i) {
+      std::uniform_int_distribution<size_t> pick(0, ptrs.size() - 1);
+      auto& p = ptrs[pick(e1)];
+      mm.free(p);
+      p = mm.malloc(nextSize(), kCacheLineSize);
+    }
+    auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    auto stats = mm.getFragmentationStats();
+    RT_LOG(INFO) << "Policy: " << (policy == MemoryAllocatorPolicy::FirstFit ? "FirstFit" : "SizeClasses")
+                 << " malloc+free: " << elapsed / kNumIterations << "us free chunks: " << stats.numFreeChunks_
+                 << " largest free chunk: " << stats.largestFreeChunkBytes_ << " free bytes: " << stats.freeBytes_
+                 << " fragmentation: " << stats.fragmentation_;
+    for (auto p : ptrs) {
+      mm.free(p);
+    }
+    ASSERT_EQ(mm.getNumFreeChunks(), 1);
+  }
+}
+
 int main(int argc, char** argv) {
   logging::LoggerDefault logger_;
   testing::InitGoogleTest(&argc, argv);
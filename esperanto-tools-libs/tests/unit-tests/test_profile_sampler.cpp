@@ -0,0 +1,74 @@
+//******************************************************************************
+// Copyright (c) 2025 Ainekko, Co.
+// SPDX-License-Identifier: Apache-2.0
+//------------------------------------------------------------------------------
+
+#include "ProfileSampler.h"
+#include "Utils.h"
+#include <chrono>
+#include <gtest/gtest.h>
+#include <string>
+
+using namespace rt;
+
+TEST(ProfileSampler, samplesAndAggregatesCommands) {
+  using namespace rt::profiling;
+  using namespace std::chrono_literals;
+  SamplingOptions options;
+  options.everyN_[static_cast<size_t>(Class::CommandSent)] = 4;
+  options.everyN_[static_cast<size_t>(Class::DispatchEvent)] = 0;
+  options.minInterval_ = 1ms;
+  options.statsPeriod_ = 10ms;
+  auto start = ProfileEvent::Clock::now();
+  ProfileSampler sampler(options, start);
+
+  auto forwarded = 0;
+  for (auto i = 0; i < 16; ++i) {
+    forwarded += sampler.sample(Class::CommandSent, start + i * 1ms) ? 1 : 0;
+  }
+  EXPECT_EQ(forwarded, 4);
+  EXPECT_FALSE(sampler.sample(Class::DispatchEvent, start));
+  EXPECT_TRUE(sampler.sample(Class::ResponseReceived, start));
+  EXPECT_FALSE(sampler.sample(Class::ResponseReceived, start + 500us));
+  EXPECT_TRUE(sampler.sample(Class::ResponseReceived, start + 1ms));
+
+  // a launch whose response is recorded before its api call event, and a memcpy with its events in order
+  auto makeResponse = [](EventId event, ProfileEvent::TimePoint timeStamp) {
+    ProfileEvent response(Type::Instant, Class::ResponseReceived);
+    response.setEvent(event);
+    response.setTimeStamp(timeStamp);
+    return response;
+  };
+  sampler.aggregate(makeResponse(EventId{1}, start + 100us));
+  ProfileEvent launch(Type::Complete, Class::KernelLaunch, StreamId{0}, EventId{1});
+  launch.setTimeStamp(start);
+  sampler.aggregate(launch);
+  ProfileEvent memcpy(Type::Complete, Class::MemcpyHostToDevice, StreamId{0}, EventId{2});
+  memcpy.setTimeStamp(start);
+  memcpy.setSize(1 << 20);
+  sampler.aggregate(memcpy);
+  sampler.aggregate(makeResponse(EventId{2}, start + 1ms));
+
+  EXPECT_FALSE(sampler.flush(start + 5ms));
+  auto stats = sampler.flush(start + 10ms);
+  ASSERT_TRUE(stats);
+  EXPECT_EQ(stats->getType(), Type::Counter);
+  EXPECT_EQ(stats->getClass(), Class::CommandStats);
+  const auto& extras = stats->getExtras();
+  auto get = [&extras](const std::string& name) { return std::get<uint64_t>(extras.at(name)); };
+  EXPECT_EQ(get("launch_latency_us.count"), 1U);
+  EXPECT_EQ(get("launch_latency_us.max"), 100U);
+  EXPECT_EQ(get("launch_latency_us.le_127"), 1U);
+  EXPECT_EQ(get("launch_latency_us.p99"), 100U);
+  EXPECT_EQ(get("memcpy_size_bytes.sum"), 1U << 20);
+  EXPECT_EQ(get("memcpy_bandwidth_mbps.max"), (1U << 20) / 1000);
+
+  // the stats restart after each flush
+  EXPECT_FALSE(sampler.flush(start + 20ms));
+}
+
+int main(int argc, char** argv) {
+  logging::LoggerDefault logger_;
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
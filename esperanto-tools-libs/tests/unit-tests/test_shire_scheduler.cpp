@@ -0,0 +1,50 @@
+//******************************************************************************
+// Copyright (c) 2025 Ainekko, Co.
+// SPDX-License-Identifier: Apache-2.0
+//------------------------------------------------------------------------------
+
+#include "ShireScheduler.h"
+#include "Utils.h"
+#include <chrono>
+#include <future>
+#include <gtest/gtest.h>
+
+using namespace rt;
+
+TEST(ShireScheduler, chooseShireMask) {
+  // adjacent shires of a single quadrant, the fullest one which fits
+  EXPECT_EQ(chooseShireMask(0xFFFFFFFF, 4), 0xFUL);
+  EXPECT_EQ(chooseShireMask(0xFFFFFF0F, 4), 0xFUL);
+  EXPECT_EQ(chooseShireMask(0xFFFFFFF0, 4), 0xF0UL);
+  // bigger kernels take whole quadrants first
+  EXPECT_EQ(chooseShireMask(0xFFFFFF0F, 12), 0xFFF00UL);
+  EXPECT_EQ(chooseShireMask(0xFFFFFFFF, 32), 0xFFFFFFFFUL);
+  EXPECT_FALSE(chooseShireMask(0x5, 3));
+  EXPECT_FALSE(chooseShireMask(0xFFFFFFFF, 0));
+}
+
+TEST(ShireScheduler, budget) {
+  ShireScheduler scheduler;
+  scheduler.setBudget(8);
+  auto first = scheduler.acquire(0xFFFFFFFF, 4);
+  auto second = scheduler.acquire(0xFFFFFFFF, 4);
+  // there are free shires, but the budget is spent
+  auto third = std::async(std::launch::async, [&scheduler] { return scheduler.acquire(0xFFFFFFFF, 4); });
+  EXPECT_EQ(third.wait_for(std::chrono::milliseconds(50)), std::future_status::timeout);
+  scheduler.release(first);
+  auto thirdMask = third.get();
+  EXPECT_EQ(__builtin_popcountll(thirdMask), 4);
+  scheduler.release(second);
+  scheduler.release(thirdMask);
+  // a kernel bigger than the budget runs alone
+  auto big = scheduler.acquire(0xFFFFFFFF, 12);
+  EXPECT_EQ(__builtin_popcountll(big), 12);
+  scheduler.release(big);
+  EXPECT_EQ(scheduler.getBudget(), 8);
+}
+
+int main(int argc, char** argv) {
+  logging::LoggerDefault logger_;
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
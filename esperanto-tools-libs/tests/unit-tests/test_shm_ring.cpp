@@ -0,0 +1,53 @@
+//******************************************************************************
+// Copyright (c) 2025 Ainekko, Co.
+// SPDX-License-Identifier: Apache-2.0
+//------------------------------------------------------------------------------
+
+#include "Utils.h"
+#include "server/ShmRing.h"
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace rt;
+
+TEST(ShmRing, pushPopAcrossMappings) {
+  using namespace std::chrono_literals;
+  constexpr auto kCapacity = 4096UL;
+  constexpr auto kNumMessages = 10000U;
+  auto producer = ShmRing::create(kCapacity);
+  // attach through a different fd, as the server does with the one received from the client
+  auto consumer = ShmRing::attach(dup(producer->getFd()));
+  EXPECT_EQ(consumer->getCapacity(), kCapacity);
+  EXPECT_THROW(ShmRing::create(kCapacity + 1), rt::Exception);
+  std::vector<std::byte> tooBig(producer->getMaxMessageSize() + 1);
+  EXPECT_THROW(producer->push(0, tooBig.data(), tooBig.size(), 0ms), rt::Exception);
+
+  // the ring is much smaller than all the messages, so it wraps around and the producer has to wait for space
+  std::thread reader([&consumer] {
+    std::vector<std::byte> buffer;
+    for (auto i = 0U; i < kNumMessages; ++i) {
+      uint32_t kind;
+      ASSERT_TRUE(consumer->pop(kind, buffer, 10s));
+      ASSERT_EQ(kind, i);
+      ASSERT_EQ(buffer.size(), i % 301);
+      ASSERT_TRUE(std::all_of(begin(buffer), end(buffer), [i](auto b) { return b == static_cast<std::byte>(i); }));
+    }
+  });
+  for (auto i = 0U; i < kNumMessages; ++i) {
+    std::vector<std::byte> message(i % 301, static_cast<std::byte>(i));
+    ASSERT_TRUE(producer->push(i, message.data(), message.size(), 10s));
+  }
+  reader.join();
+  uint32_t kind;
+  std::vector<std::byte> buffer;
+  EXPECT_FALSE(consumer->pop(kind, buffer, 1ms));
+}
+
+int main(int argc, char** argv) {
+  logging::LoggerDefault logger_;
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -72,6 +72,33 @@ TEST(StreamsLifeCycle, create_and_destroy_10k_streams) {
   EXPECT_TRUE(rt->streamManager_.streams_.empty());
 }
 
+TEST(StreamsLifeCycle, priority_streams) {
+  QueueHelper helper;
+  helper.addDevice(DeviceId{0}, 4);
+  helper.addDevice(DeviceId{1}, 1);
+  for (auto i = 0; i < 6; ++i) {
+    // last queue is reserved for high priority streams
+    EXPECT_EQ(helper.nextQueue(DeviceId{0}, StreamPriority::Normal), i % 3);
+    EXPECT_EQ(helper.nextQueue(DeviceId{0}, StreamPriority::High), 3);
+    // with a single queue everything goes together
+    EXPECT_EQ(helper.nextQueue(DeviceId{1}, StreamPriority::High), 0);
+    EXPECT_EQ(helper.nextQueue(DeviceId{1}, StreamPriority::Normal), 0);
+  }
+
+  auto deviceLayer = std::make_shared<dev::DeviceLayerFake>();
+  auto runtime = rt::IRuntime::create(deviceLayer, Options{true, false});
+  auto devices = runtime->getDevices();
+  ASSERT_FALSE(devices.empty());
+  auto st = runtime->createStream(devices[0], StreamPriority::High);
+  std::vector<std::byte> host(1024);
+  auto d_ptr = runtime->mallocDevice(devices[0], host.size());
+  runtime->memcpyHostToDevice(st, host.data(), d_ptr, host.size());
+  runtime->memcpyDeviceToHost(st, d_ptr, host.data(), host.size());
+  EXPECT_TRUE(runtime->waitForStream(st));
+  runtime->freeDevice(devices[0], d_ptr);
+  runtime->destroyStream(st);
+}
+
 int main(int argc, char** argv) {
   logging::LoggerDefault logger_;
   testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,28 @@
+//******************************************************************************
+// Copyright (c) 2025 Ainekko, Co.
+// SPDX-License-Identifier: Apache-2.0
+//------------------------------------------------------------------------------
+
+#include "ThreadAffinity.h"
+#include "Utils.h"
+#include <gtest/gtest.h>
+
+using namespace rt;
+
+TEST(ThreadAffinity, parseCpuList) {
+  auto cpus = parseCpuList("0-3,8,10-11\n");
+  ASSERT_TRUE(cpus);
+  EXPECT_EQ(CPU_COUNT(&*cpus), 7);
+  EXPECT_TRUE(CPU_ISSET(3, &*cpus));
+  EXPECT_FALSE(CPU_ISSET(4, &*cpus));
+  EXPECT_TRUE(CPU_ISSET(11, &*cpus));
+  EXPECT_FALSE(parseCpuList(""));
+  EXPECT_FALSE(parseCpuList("\n"));
+  EXPECT_FALSE(parseCpuList("a-b"));
+}
+
+int main(int argc, char** argv) {
+  logging::LoggerDefault logger_;
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,140 @@
+//******************************************************************************
+// Copyright (c) 2025 Ainekko, Co.
+// SPDX-License-Identifier: Apache-2.0
+//------------------------------------------------------------------------------
+
+#include "Utils.h"
+#include "runtime/TraceReader.h"
+#include <algorithm>
+#include <cstring>
+#include <et-trace/layout.h>
+#include <gtest/gtest.h>
+#include <limits>
+#include <unistd.h>
+#include <vector>
+
+using namespace rt;
+
+TEST(TraceReader, findsEntriesBySubBuffer) {
+  using namespace rt::profiling;
+  constexpr uint32_t kSubBufferSize = 32768;
+  std::vector<std::byte> buffer(2 * kSubBufferSize);
+  // fills a sub-buffer with u32 values logged by two harts, one cycle apart
+  auto fill = [&buffer](size_t offset, size_t headerSize, uint64_t cycle, uint16_t hart0, uint16_t hart1) {
+    auto size = headerSize;
+    for (uint32_t i = 0; i < 1000; ++i) {
+      trace_value_u32_t value{};
+      value.header = {cycle + i, static_cast<uint32_t>(sizeof(value) - sizeof(trace_entry_header_t)),
+                      i % 2 == 0 ? hart0 : hart1, i % 10 == 0 ? TRACE_TYPE_VALUE_U64 : TRACE_TYPE_VALUE_U32};
+      value.value = i;
+      std::memcpy(buffer.data() + offset + size, &value, sizeof(value));
+      size += sizeof(value);
+    }
+    return static_cast<uint32_t>(size);
+  };
+  trace_buffer_std_header_t header{};
+  header.magic_header = TRACE_MAGIC_HEADER;
+  header.version = {TRACE_VERSION_MAJOR, TRACE_VERSION_MINOR, TRACE_VERSION_PATCH};
+  header.type = TRACE_CM_BUFFER;
+  header.data_size = fill(0, sizeof(header), 1000, 0, 70);
+  header.sub_buffer_size = kSubBufferSize;
+  header.sub_buffer_count = 2;
+  std::memcpy(buffer.data(), &header, sizeof(header));
+  trace_buffer_size_header_t sizeHeader{};
+  sizeHeader.data_size = fill(kSubBufferSize, sizeof(sizeHeader), 5000, 130, 131);
+  std::memcpy(buffer.data() + kSubBufferSize, &sizeHeader, sizeof(sizeHeader));
+
+  auto reader = TraceReader(buffer, 2);
+  const auto& subBuffers = reader.getSubBuffers();
+  ASSERT_EQ(subBuffers.size(), 2);
+  EXPECT_EQ(subBuffers[0].entries_, 1000);
+  EXPECT_EQ(subBuffers[0].firstCycle_, 1000);
+  EXPECT_EQ(subBuffers[0].lastCycle_, 1999);
+  EXPECT_EQ(subBuffers[0].shireMask_, 0x3);
+  EXPECT_EQ(subBuffers[1].offset_, kSubBufferSize);
+  EXPECT_EQ(subBuffers[1].shireMask_, 0x4);
+
+  EXPECT_EQ(reader.find({}).size(), 2000);
+  TraceQuery query;
+  query.beginCycle_ = 1900;
+  query.endCycle_ = 5099;
+  auto entries = reader.find(query);
+  ASSERT_EQ(entries.size(), 200);
+  EXPECT_EQ(entries.front()->cycle, 1900);
+  EXPECT_EQ(entries.back()->cycle, 5099);
+  EXPECT_TRUE(std::is_sorted(entries.begin(), entries.end(),
+                             [](const auto* a, const auto* b) { return a->cycle < b->cycle; }));
+  query.shireMask_ = 0x4;
+  EXPECT_EQ(reader.find(query).size(), 100);
+  query.shireMask_ = std::numeric_limits<uint64_t>::max();
+  query.hartId_ = 70;
+  EXPECT_EQ(reader.find(query).size(), 50);
+  query.hartId_.reset();
+  query.types_ = {TRACE_TYPE_VALUE_U64};
+  entries = reader.find(query);
+  ASSERT_EQ(entries.size(), 20);
+  EXPECT_EQ(reinterpret_cast<const trace_value_u32_t*>(entries.front())->value, 900);
+
+  // the same trace dumped to a file is memory mapped
+  char path[] = "/tmp/traceReaderXXXXXX";
+  auto fd = mkstemp(path);
+  ASSERT_GE(fd, 0);
+  ASSERT_EQ(write(fd, buffer.data(), buffer.size()), static_cast<ssize_t>(buffer.size()));
+  close(fd);
+  auto mapped = TraceReader::open(path);
+  unlink(path);
+  EXPECT_EQ(mapped.find(query).size(), 20);
+  EXPECT_THROW(TraceReader::open(path), rt::Exception);
+  EXPECT_THROW(TraceReader(std::vector<std::byte>(4)), rt::Exception);
+}
+
+TEST(TraceReader, buildsPcHotspots) {
+  using namespace rt::profiling;
+  std::vector<std::byte> buffer(sizeof(trace_buffer_std_header_t));
+  auto addSample = [&buffer](uint64_t cycle, uint16_t hartId, uint64_t pc) {
+    trace_pc_sample_t sample{};
+    sample.header = {cycle, static_cast<uint32_t>(sizeof(sample) - sizeof(trace_entry_header_t)), hartId,
+                     TRACE_TYPE_PC_SAMPLE};
+    sample.pc = pc;
+    auto offset = buffer.size();
+    buffer.resize(offset + sizeof(sample));
+    std::memcpy(buffer.data() + offset, &sample, sizeof(sample));
+  };
+  for (uint64_t i = 0; i < 10; ++i) {
+    addSample(100 * i, i % 2 == 0 ? 0 : 64, i < 7 ? 0x8005001000 : 0x8005002000);
+  }
+  addSample(2000, 0, 0x8005000000);
+  trace_buffer_std_header_t header{};
+  header.magic_header = TRACE_MAGIC_HEADER;
+  header.version = {TRACE_VERSION_MAJOR, TRACE_VERSION_MINOR, TRACE_VERSION_PATCH};
+  header.type = TRACE_CM_BUFFER;
+  header.data_size = static_cast<uint32_t>(buffer.size());
+  header.sub_buffer_size = static_cast<uint32_t>(buffer.size());
+  header.sub_buffer_count = 1;
+  std::memcpy(buffer.data(), &header, sizeof(header));
+
+  auto reader = TraceReader(buffer);
+  auto hotspots = getPcHotspots(reader);
+  ASSERT_EQ(hotspots.size(), 3);
+  EXPECT_EQ(hotspots[0].pc_, 0x8005001000);
+  EXPECT_EQ(hotspots[0].samples_, 7);
+  EXPECT_EQ(hotspots[0].shireMask_, 0x3);
+  EXPECT_EQ(hotspots[1].pc_, 0x8005002000);
+  EXPECT_EQ(hotspots[1].samples_, 3);
+  EXPECT_EQ(hotspots[2].samples_, 1);
+
+  TraceQuery query;
+  query.endCycle_ = 999;
+  query.hartId_ = 64;
+  hotspots = getPcHotspots(reader, query);
+  ASSERT_EQ(hotspots.size(), 2);
+  EXPECT_EQ(hotspots[0].samples_, 3);
+  EXPECT_EQ(hotspots[0].shireMask_, 0x2);
+  EXPECT_EQ(hotspots[1].samples_, 2);
+}
+
+int main(int argc, char** argv) {
+  logging::LoggerDefault logger_;
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
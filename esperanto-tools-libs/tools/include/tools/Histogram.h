@@ -0,0 +1,46 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) 2025 Ainekko, Co.
+ * SPDX-License-Identifier: Apache-2.0
+ *-------------------------------------------------------------------------*/
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+namespace rt {
+
+// HDR (high dynamic range) histogram: values are kept with a fixed number of significant binary digits whatever their
+// magnitude, so percentiles have the same relative precision for nanoseconds and for seconds. Buckets are added as
+// bigger values are recorded, there is no highest trackable value.
+class Histogram {
+public:
+  // subBucketBits is the precision: values are recorded with an error below 1 / 2^(subBucketBits - 1), 2^-10 (~0.1%)
+  // by default
+  explicit Histogram(uint32_t subBucketBits = 11);
+
+  void record(uint64_t value, uint64_t count = 1);
+  // adds the values of other, which must have the same precision
+  void merge(const Histogram& other);
+
+  uint64_t count() const {
+    return count_;
+  }
+  // min and max are exact; all of them return 0 if there are no values
+  uint64_t min() const;
+  uint64_t max() const;
+  double mean() const;
+  // returns the value below or equal to which percentile (from 0 to 100) of the recorded values are
+  uint64_t valueAtPercentile(double percentile) const;
+
+private:
+  size_t indexOf(uint64_t value) const;
+  uint64_t highestEquivalentValue(size_t index) const;
+
+  uint32_t subBucketBits_;
+  std::vector<uint64_t> counts_;
+  uint64_t count_ = 0;
+  uint64_t min_ = UINT64_MAX;
+  uint64_t max_ = 0;
+  double sum_ = 0;
+};
+} // namespace rt
@@ -0,0 +1,102 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) 2025 Ainekko, Co.
+ * SPDX-License-Identifier: Apache-2.0
+ *-------------------------------------------------------------------------*/
+
+#pragma once
+#include "runtime/Types.h"
+#include "tools/IBenchmarker.h"
+#include <map>
+#include <runtime/IRuntime.h>
+#include <string>
+#include <vector>
+namespace rt {
+
+// Standard runtime benchmarks. Each scenario produces measurements, identified by the scenario name and its parameters
+// (ie. the stream count or the transfer size), which can be compared against the measurements of a baseline run.
+class IBenchmarkSuite {
+public:
+  enum class Scenario {
+    LaunchRate,    // empty kernel launches per second, per number of streams
+    Latency,       // submit to complete latency percentiles of an empty kernel launch and of a small H2D memcpy
+    BandwidthH2D,  // host to device bandwidth per transfer size
+    BandwidthD2H,  // device to host bandwidth per transfer size
+    BandwidthP2P,  // device to device bandwidth per transfer size, between the first two devices if they allow P2P
+    DeviceScaling, // launch rate and H2D bandwidth running on 1..N devices at the same time
+    Roofline,      // load bandwidth and latency per working set, atomic throughput and FMA peak, per shire count
+  };
+
+  // working set of the Roofline load tests, meant to fit in a level of the memory hierarchy
+  struct RooflineLevel {
+    std::string name;
+    size_t workingSet;
+    // each minion loads its slice of the working set instead of all of it. Needed for the levels bigger than L3, else
+    // the minions would share the lines other minions brought to L3
+    bool partitioned = false;
+  };
+
+  struct Options {
+    // scenarios to run, all of them if empty
+    std::vector<Scenario> scenarios;
+    // kernel launched by LaunchRate, Latency and DeviceScaling, it should do nothing. Those scenarios are skipped if empty
+    std::string emptyKernelPath;
+    // stream counts of LaunchRate
+    std::vector<size_t> streamCounts = {1, 2, 4, 8};
+    // kernel launches per LaunchRate and DeviceScaling measurement
+    size_t launches = 10000;
+    // samples per Latency measurement
+    size_t latencySamples = 10000;
+    // transfer sizes of the bandwidth scenarios
+    std::vector<size_t> transferSizes = {4 << 10, 64 << 10, 1 << 20, 16 << 20, 64 << 20};
+    // total bytes transferred per bandwidth measurement, each size is repeated until reaching it (at least once)
+    size_t bandwidthBytes = 256 << 20;
+    // roofline kernel of test-compute-kernels, Roofline is skipped if empty
+    std::string rooflineKernelPath;
+    // shire counts of the Roofline bandwidth, atomic and FMA tests, the first compute shires of the device are used
+    std::vector<size_t> rooflineShireCounts = {1, 2, 4, 8, 16, 32};
+    // working sets of the Roofline load tests, adjust them to the cache configuration of the device
+    std::vector<RooflineLevel> rooflineLevels = {
+      {"l1", 8 << 10}, {"l2", 1 << 20}, {"l3", 16 << 20}, {"dram", 256 << 20, true}};
+    // distance in bytes between the loads of the Roofline load tests, powers of two of at least 8
+    std::vector<size_t> rooflineStrides = {8, 64, 256};
+    // loads, atomics or FMA instructions per hart and Roofline measurement, at least (working sets are swept whole)
+    size_t rooflineAccesses = 1 << 20;
+  };
+
+  struct Measurement {
+    std::string scenario;
+    std::map<std::string, std::string> params; // ie. {"streams", "4"}
+    // metrics ending in "_us", "_ns" or "_cycles" are latencies (lower is better), the rest are rates (higher is
+    // better)
+    std::map<std::string, double> values;
+  };
+
+  struct Results {
+    std::vector<Measurement> measurements;
+  };
+
+  // a metric which got worse than the tolerance compared with the baseline
+  struct Regression {
+    std::string scenario;
+    std::map<std::string, std::string> params;
+    std::string metric;
+    double baseline;
+    double current;
+  };
+
+  // factory method.
+  static std::unique_ptr<IBenchmarkSuite> create(IRuntime* runtime);
+
+  // runs the scenarios on the enabled devices (DeviceScaling and BandwidthP2P take them in order)
+  virtual Results run(const Options& options,
+                      IBenchmarker::DeviceMask mask = IBenchmarker::DeviceMask::enableAll()) = 0;
+
+  // returns the metrics of current which are worse than in baseline by more than tolerance (ie. 0.1 is 10%). Metrics
+  // which are not in both results are ignored
+  static std::vector<Regression> compare(const Results& current, const Results& baseline, double tolerance);
+
+  static std::string toString(Scenario scenario);
+
+  virtual ~IBenchmarkSuite() = default;
+};
+} // namespace rt
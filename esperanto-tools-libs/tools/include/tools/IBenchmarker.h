@@ -5,8 +5,12 @@
 
 #pragma once
 #include "runtime/Types.h"
+#include "tools/Histogram.h"
 #include <bitset>
+#include <map>
 #include <runtime/IRuntime.h>
+#include <string>
+#include <vector>
 namespace rt {
 constexpr auto kMaxDevices = 32;
 class IBenchmarker {
@@ -33,6 +37,15 @@ public:
     std::string runtimeTracePath;
     // if true, then results will have timestamps for each start and end operation
     bool computeOpStats = false;
+    // workloads each thread keeps in flight, each one with its own buffers, so the H2D of a workload overlaps with the
+    // kernel and D2H of the previous ones. If 0 all the workloads are submitted at once, sharing the buffers
+    size_t pipelineDepth = 0;
+    // shires the kernel is launched on; if 0 all the compute shires of the device
+    uint64_t kernelShireMask = 0;
+    // cpus the threads are pinned to, thread i to cpuAffinity[i % size]. If empty threads are not pinned
+    std::vector<int> cpuAffinity;
+    // if true, then results will have latency histograms (see WorkerResult::latencies)
+    bool computeHistograms = false;
   };
 
   // DeviceMask by default has all devices disabled
@@ -65,12 +78,16 @@ public:
     float bytesSentPerSecond;
     float bytesReceivedPerSecond;
     float workloadsPerSecond;
+    // submit to complete latencies in nanoseconds, per operation: "h2d", "kernel", "d2h" and "workload" (from the first
+    // submission of a workload to the completion of its last operation). Only filled if computeHistograms is set
+    std::map<std::string, Histogram> latencies;
   };
   struct SummaryResults {
     float bytesSentPerSecond;
     float bytesReceivedPerSecond;
     float workloadsPerSecond;
     std::vector<WorkerResult> workerResults;
+    std::map<std::string, Histogram> latencies; // the latencies of all the workers merged
   };
 
   // factory method.
@@ -0,0 +1,551 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) 2025 Ainekko, Co.
+ * SPDX-License-Identifier: Apache-2.0
+ *-------------------------------------------------------------------------*/
+#include "BenchmarkSuiteImp.h"
+#include "Logging.h"
+#include "runtime/Types.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <fstream>
+#include <hostUtils/logging/Logging.h>
+#include <numeric>
+#include <thread>
+
+using namespace rt;
+
+namespace {
+using Clock = std::chrono::high_resolution_clock;
+
+inline std::vector<std::byte> readFile(const std::string& path) {
+  auto file = std::ifstream(path, std::ios_base::binary);
+  CHECK(file.is_open()) << "Can't open file path: " << path;
+  auto iniF = file.tellg();
+  file.seekg(0, std::ios::end);
+  auto endF = file.tellg();
+  auto size = static_cast<uint32_t>(endF - iniF);
+  file.seekg(0, std::ios::beg);
+
+  std::vector<std::byte> fileContent(size);
+  file.read(reinterpret_cast<char*>(fileContent.data()), size);
+  return fileContent;
+}
+
+double seconds(Clock::time_point start, Clock::time_point end) {
+  return std::chrono::duration<double>(end - start).count();
+}
+
+double toMBps(size_t bytes, double secs) {
+  return static_cast<double>(bytes) / secs / static_cast<double>(1 << 20);
+}
+
+// p is in [0, 1], samples must be sorted
+double percentile(const std::vector<double>& samples, double p) {
+  auto pos = static_cast<size_t>(p * static_cast<double>(samples.size() - 1) + 0.5);
+  return samples[std::min(pos, samples.size() - 1)];
+}
+
+void addLatencies(const std::string& op, std::vector<double> samples, IBenchmarkSuite::Results& results) {
+  std::sort(begin(samples), end(samples));
+  IBenchmarkSuite::Measurement m;
+  m.scenario = IBenchmarkSuite::toString(IBenchmarkSuite::Scenario::Latency);
+  m.params["op"] = op;
+  m.values["p50_us"] = percentile(samples, 0.5);
+  m.values["p99_us"] = percentile(samples, 0.99);
+  m.values["p999_us"] = percentile(samples, 0.999);
+  m.values["mean_us"] = std::accumulate(begin(samples), end(samples), 0.0) / static_cast<double>(samples.size());
+  m.values["max_us"] = samples.back();
+  results.measurements.emplace_back(std::move(m));
+}
+
+// size of the H2D memcpies timed by the Latency scenario
+constexpr size_t kLatencyMemcpySize = 4 << 10;
+
+// Parameters and Result of the roofline kernel of test-compute-kernels
+enum RooflineTest : uint64_t { kRooflineLoadBw, kRooflineLoadLat, kRooflineAtomic, kRooflineFma };
+struct RooflineParams {
+  uint64_t test;
+  uint64_t shireMask;
+  uint64_t partitioned;
+  std::byte* buffer;
+  uint64_t workingSet;
+  uint64_t stride;
+  uint64_t iterations;
+  std::byte* collMem;
+  std::byte* outData;
+};
+struct RooflineResult {
+  uint64_t hartId;
+  uint64_t cycles;
+  uint64_t ops;
+  uint64_t checksum;
+  uint64_t reserved[4];
+};
+constexpr size_t kRooflineMinionsPerShire = 32;
+constexpr size_t kRooflineMaxShires = 32;
+constexpr size_t kRooflineMaxMinions = kRooflineMinionsPerShire * kRooflineMaxShires;
+// bigger than the et_coll_mem_t of the kernel barriers
+constexpr size_t kRooflineCollMemSize = 64 << 10;
+// independent fmadd.ps per iteration of the FMA test, each one 8 lanes of 2 flops
+constexpr uint64_t kRooflineFmaBlock = 24;
+constexpr double kRooflineFlopsPerFma = 16.0;
+constexpr size_t kRooflineLineSize = 64;
+} // namespace
+
+std::unique_ptr<IBenchmarkSuite> IBenchmarkSuite::create(IRuntime* runtime) {
+  return std::make_unique<BenchmarkSuiteImp>(runtime);
+}
+
+std::string IBenchmarkSuite::toString(Scenario scenario) {
+  switch (scenario) {
+  case Scenario::LaunchRate:
+    return "launch_rate";
+  case Scenario::Latency:
+    return "latency";
+  case Scenario::BandwidthH2D:
+    return "bandwidth_h2d";
+  case Scenario::BandwidthD2H:
+    return "bandwidth_d2h";
+  case Scenario::BandwidthP2P:
+    return "bandwidth_p2p";
+  case Scenario::DeviceScaling:
+    return "device_scaling";
+  case Scenario::Roofline:
+    return "roofline";
+  }
+  return "unknown";
+}
+
+std::vector<IBenchmarkSuite::Regression> IBenchmarkSuite::compare(const Results& current, const Results& baseline,
+                                                                  double tolerance) {
+  std::vector<Regression> regressions;
+  for (const auto& m : current.measurements) {
+    auto it = std::find_if(begin(baseline.measurements), end(baseline.measurements),
+                           [&m](const Measurement& b) { return b.scenario == m.scenario && b.params == m.params; });
+    if (it == end(baseline.measurements)) {
+      continue;
+    }
+    for (const auto& [metric, value] : m.values) {
+      auto b = it->values.find(metric);
+      if (b == end(it->values)) {
+        continue;
+      }
+      auto endsWith = [&metric](const std::string& suffix) {
+        return metric.size() > suffix.size() &&
+               metric.compare(metric.size() - suffix.size(), suffix.size(), suffix) == 0;
+      };
+      auto lowerIsBetter = endsWith("_us") || endsWith("_ns") || endsWith("_cycles");
+      auto worse = lowerIsBetter ? value > b->second * (1.0 + tolerance) : value < b->second * (1.0 - tolerance);
+      if (worse) {
+        regressions.push_back({m.scenario, m.params, metric, b->second, value});
+      }
+    }
+  }
+  return regressions;
+}
+
+BenchmarkSuiteImp::~BenchmarkSuiteImp() = default;
+
+BenchmarkSuiteImp::BenchmarkSuiteImp(IRuntime* runtime)
+  : runtime_(runtime) {
+  runtime_->setOnStreamErrorsCallback([](auto eventId, const auto& streamError) {
+    BM_LOG(FATAL) << "Got device response error: " << static_cast<int>(eventId)
+                  << " error msg: " << streamError.getString();
+  });
+  BM_LOG_IF(FATAL, runtime_->getDevices().empty()) << "No devices";
+}
+
+IBenchmarkSuite::Results BenchmarkSuiteImp::run(const Options& options, IBenchmarker::DeviceMask mask) {
+  std::vector<DeviceId> devices;
+  for (auto d : runtime_->getDevices()) {
+    if (mask.isEnabled(d)) {
+      devices.emplace_back(d);
+    }
+  }
+  BM_LOG_IF(FATAL, devices.empty()) << "There are no enabled devices. Check the device mask";
+
+  auto scenarios = options.scenarios;
+  if (scenarios.empty()) {
+    scenarios = {Scenario::LaunchRate,   Scenario::Latency,       Scenario::BandwidthH2D, Scenario::BandwidthD2H,
+                 Scenario::BandwidthP2P, Scenario::DeviceScaling, Scenario::Roofline};
+  }
+  if (!options.emptyKernelPath.empty()) {
+    auto elf = readFile(options.emptyKernelPath);
+    for (auto d : devices) {
+      auto stream = runtime_->createStream(d);
+      auto loaded = runtime_->loadCode(stream, elf.data(), elf.size());
+      runtime_->waitForEvent(loaded.event_);
+      runtime_->destroyStream(stream);
+      kernels_[d] = loaded.kernel_;
+    }
+  }
+
+  Results results;
+  for (auto scenario : scenarios) {
+    auto needsKernel = scenario == Scenario::LaunchRate || scenario == Scenario::Latency;
+    if (needsKernel && kernels_.empty()) {
+      BM_LOG(WARNING) << "Skipping " << toString(scenario) << ": there is no empty kernel.";
+      continue;
+    }
+    BM_LOG(INFO) << "Running " << toString(scenario);
+    switch (scenario) {
+    case Scenario::LaunchRate:
+      runLaunchRate(options, devices.front(), results);
+      break;
+    case Scenario::Latency:
+      runLatency(devices.front(), options.latencySamples, results);
+      break;
+    case Scenario::BandwidthH2D:
+    case Scenario::BandwidthD2H:
+    case Scenario::BandwidthP2P:
+      runBandwidth(scenario, options, devices, results);
+      break;
+    case Scenario::DeviceScaling:
+      runDeviceScaling(options, devices, results);
+      break;
+    case Scenario::Roofline:
+      runRoofline(options, devices.front(), results);
+      break;
+    }
+  }
+  for (auto [device, kernel] : kernels_) {
+    runtime_->unloadCode(kernel);
+  }
+  kernels_.clear();
+  return results;
+}
+
+EventId BenchmarkSuiteImp::launch(StreamId stream, DeviceId device) {
+  std::array<std::byte, 32> args{};
+  KernelLaunchOptions launchOptions;
+  launchOptions.setShireMask(0x1);
+  launchOptions.setBarrier(false);
+  while (true) {
+    try {
+      return runtime_->kernelLaunch(stream, kernels_.at(device), args.data(), args.size(), launchOptions);
+    } catch (const Exception&) {
+      // the submission queue is full, let the device catch up
+      runtime_->waitForStream(stream);
+    }
+  }
+}
+
+void BenchmarkSuiteImp::runLaunchRate(const Options& options, DeviceId device, Results& results) {
+  for (auto numStreams : options.streamCounts) {
+    std::vector<StreamId> streams;
+    for (auto i = 0UL; i < numStreams; ++i) {
+      streams.emplace_back(runtime_->createStream(device));
+    }
+    auto start = Clock::now();
+    for (auto i = 0UL; i < options.launches; ++i) {
+      launch(streams[i % numStreams], device);
+    }
+    for (auto s : streams) {
+      runtime_->waitForStream(s);
+    }
+    auto elapsed = seconds(start, Clock::now());
+    for (auto s : streams) {
+      runtime_->destroyStream(s);
+    }
+    Measurement m;
+    m.scenario = toString(Scenario::LaunchRate);
+    m.params["streams"] = std::to_string(numStreams);
+    m.values["launches_per_second"] = static_cast<double>(options.launches) / elapsed;
+    results.measurements.emplace_back(std::move(m));
+  }
+}
+
+void BenchmarkSuiteImp::runLatency(DeviceId device, size_t samples, Results& results) {
+  if (samples == 0) {
+    return;
+  }
+  auto stream = runtime_->createStream(device);
+  auto toUs = [](Clock::time_point start) { return seconds(start, Clock::now()) * 1e6; };
+
+  std::vector<double> kernelSamples;
+  kernelSamples.reserve(samples);
+  for (auto i = 0UL; i < samples; ++i) {
+    auto start = Clock::now();
+    runtime_->waitForEvent(launch(stream, device));
+    kernelSamples.emplace_back(toUs(start));
+  }
+  addLatencies("kernel", std::move(kernelSamples), results);
+
+  std::vector<std::byte> host(kLatencyMemcpySize);
+  auto dev = runtime_->mallocDevice(device, kLatencyMemcpySize);
+  std::vector<double> memcpySamples;
+  memcpySamples.reserve(samples);
+  for (auto i = 0UL; i < samples; ++i) {
+    auto start = Clock::now();
+    runtime_->waitForEvent(runtime_->memcpyHostToDevice(stream, host.data(), dev, host.size()));
+    memcpySamples.emplace_back(toUs(start));
+  }
+  addLatencies("h2d", std::move(memcpySamples), results);
+  runtime_->freeDevice(device, dev);
+  runtime_->destroyStream(stream);
+}
+
+double BenchmarkSuiteImp::timeMemcpys(Scenario scenario, StreamId stream, DeviceId dstDevice, std::byte* src,
+                                      std::byte* dst, size_t size, size_t reps) {
+  auto enqueue = [=] {
+    switch (scenario) {
+    case Scenario::BandwidthH2D:
+      runtime_->memcpyHostToDevice(stream, src, dst, size);
+      break;
+    case Scenario::BandwidthD2H:
+      runtime_->memcpyDeviceToHost(stream, src, dst, size, false);
+      break;
+    default:
+      runtime_->memcpyDeviceToDevice(stream, dstDevice, src, dst, size, false);
+    }
+  };
+  // warm up, so the first transfer does not pay for the setup of the buffers
+  enqueue();
+  runtime_->waitForStream(stream);
+  auto start = Clock::now();
+  for (auto i = 0UL; i < reps; ++i) {
+    enqueue();
+  }
+  runtime_->waitForStream(stream);
+  return seconds(start, Clock::now());
+}
+
+void BenchmarkSuiteImp::runBandwidth(Scenario scenario, const Options& options, std::vector<DeviceId> devices,
+                                     Results& results) {
+  if (options.transferSizes.empty()) {
+    return;
+  }
+  auto maxSize = *std::max_element(begin(options.transferSizes), end(options.transferSizes));
+  auto srcDevice = devices.front();
+  auto dstDevice = srcDevice;
+  std::byte* src;
+  std::byte* dst;
+  std::vector<std::byte> host;
+  if (scenario == Scenario::BandwidthP2P) {
+    if (devices.size() < 2 || !runtime_->isP2PEnabled(devices[0], devices[1])) {
+      BM_LOG(WARNING) << "Skipping " << toString(scenario) << ": it needs two devices with P2P enabled.";
+      return;
+    }
+    dstDevice = devices[1];
+    src = runtime_->mallocDevice(srcDevice, maxSize);
+    dst = runtime_->mallocDevice(dstDevice, maxSize);
+  } else {
+    host.resize(maxSize);
+    auto dev = runtime_->mallocDevice(srcDevice, maxSize);
+    src = scenario == Scenario::BandwidthH2D ? host.data() : dev;
+    dst = scenario == Scenario::BandwidthH2D ? dev : host.data();
+  }
+  auto stream = runtime_->createStream(srcDevice);
+  for (auto size : options.transferSizes) {
+    auto reps = std::max(options.bandwidthBytes / size, size_t{1});
+    auto elapsed = timeMemcpys(scenario, stream, dstDevice, src, dst, size, reps);
+    Measurement m;
+    m.scenario = toString(scenario);
+    m.params["size"] = std::to_string(size);
+    m.values["MBps"] = toMBps(size * reps, elapsed);
+    results.measurements.emplace_back(std::move(m));
+  }
+  runtime_->destroyStream(stream);
+  if (scenario == Scenario::BandwidthP2P) {
+    runtime_->freeDevice(srcDevice, src);
+    runtime_->freeDevice(dstDevice, dst);
+  } else {
+    runtime_->freeDevice(srcDevice, scenario == Scenario::BandwidthH2D ? dst : src);
+  }
+}
+
+void BenchmarkSuiteImp::runDeviceScaling(const Options& options, std::vector<DeviceId> devices, Results& results) {
+  constexpr size_t kTransferSize = 16 << 20;
+  auto transferSize = std::min(kTransferSize, options.bandwidthBytes);
+  auto reps = options.bandwidthBytes / std::max(transferSize, size_t{1});
+  for (auto count = 1UL; count <= devices.size(); ++count) {
+    std::vector<StreamId> streams;
+    std::vector<std::byte*> buffers;
+    for (auto i = 0UL; i < count; ++i) {
+      streams.emplace_back(runtime_->createStream(devices[i]));
+      buffers.emplace_back(transferSize > 0 ? runtime_->mallocDevice(devices[i], transferSize) : nullptr);
+    }
+    std::vector<std::byte> host(transferSize);
+    auto runAll = [&](auto&& work) {
+      std::vector<std::thread> threads;
+      auto start = Clock::now();
+      for (auto i = 0UL; i < count; ++i) {
+        threads.emplace_back([&work, &streams, i] { work(i, streams[i]); });
+      }
+      for (auto& t : threads) {
+        t.join();
+      }
+      return seconds(start, Clock::now());
+    };
+
+    Measurement m;
+    m.scenario = toString(Scenario::DeviceScaling);
+    m.params["devices"] = std::to_string(count);
+    if (!kernels_.empty()) {
+      auto elapsed = runAll([&](size_t i, StreamId stream) {
+        for (auto l = 0UL; l < options.launches; ++l) {
+          launch(stream, devices[i]);
+        }
+        runtime_->waitForStream(stream);
+      });
+      m.values["launches_per_second"] = static_cast<double>(options.launches * count) / elapsed;
+    }
+    if (reps > 0) {
+      auto elapsed = runAll([&](size_t i, StreamId stream) {
+        for (auto r = 0UL; r < reps; ++r) {
+          runtime_->memcpyHostToDevice(stream, host.data(), buffers[i], transferSize);
+        }
+        runtime_->waitForStream(stream);
+      });
+      m.values["MBps"] = toMBps(transferSize * reps * count, elapsed);
+    }
+    results.measurements.emplace_back(std::move(m));
+    for (auto i = 0UL; i < count; ++i) {
+      runtime_->destroyStream(streams[i]);
+      if (buffers[i] != nullptr) {
+        runtime_->freeDevice(devices[i], buffers[i]);
+      }
+    }
+  }
+}
+
+void BenchmarkSuiteImp::runRoofline(const Options& options, DeviceId device, Results& results) {
+  if (options.rooflineKernelPath.empty()) {
+    BM_LOG(WARNING) << "Skipping " << toString(Scenario::Roofline) << ": there is no roofline kernel.";
+    return;
+  }
+  auto props = runtime_->getDeviceProperties(device);
+  if (props.frequency_ == 0) {
+    BM_LOG(WARNING) << "Skipping " << toString(Scenario::Roofline) << ": unknown minion frequency.";
+    return;
+  }
+  auto secondsPerCycle = 1.0 / (static_cast<double>(props.frequency_) * 1e6);
+  std::vector<uint32_t> shires;
+  for (auto s = 0U; s < kRooflineMaxShires; ++s) {
+    if ((props.computeMinionShireMask_ >> s) & 1U) {
+      shires.emplace_back(s);
+    }
+  }
+  // the first count compute shires
+  auto shireMask = [&shires](size_t count) {
+    auto mask = uint64_t{0};
+    for (auto i = 0UL; i < count; ++i) {
+      mask |= 1ULL << shires[i];
+    }
+    return mask;
+  };
+
+  auto bufferSize = kRooflineMaxMinions * kRooflineLineSize;
+  for (const auto& level : options.rooflineLevels) {
+    bufferSize = std::max(bufferSize, level.workingSet);
+  }
+  auto elf = readFile(options.rooflineKernelPath);
+  auto stream = runtime_->createStream(device);
+  auto loaded = runtime_->loadCode(stream, elf.data(), elf.size());
+  runtime_->waitForEvent(loaded.event_);
+  auto buffer = runtime_->mallocDevice(device, bufferSize);
+  auto collMem = runtime_->mallocDevice(device, kRooflineCollMemSize);
+  auto outData = runtime_->mallocDevice(device, kRooflineMaxMinions * sizeof(RooflineResult));
+  std::vector<std::byte> zeroCollMem(kRooflineCollMemSize);
+  std::vector<RooflineResult> zeroResults(kRooflineMaxMinions);
+  std::vector<RooflineResult> out(kRooflineMaxMinions);
+
+  // launches the test, returns the operations of all the minions and the seconds taken by the slowest one
+  auto run = [&](RooflineParams params) {
+    params.buffer = buffer;
+    params.collMem = collMem;
+    params.outData = outData;
+    runtime_->memcpyHostToDevice(stream, zeroCollMem.data(), collMem, zeroCollMem.size());
+    runtime_->memcpyHostToDevice(stream, reinterpret_cast<std::byte*>(zeroResults.data()), outData,
+                                 zeroResults.size() * sizeof(RooflineResult));
+    KernelLaunchOptions launchOptions;
+    launchOptions.setShireMask(params.shireMask);
+    runtime_->kernelLaunch(stream, loaded.kernel_, reinterpret_cast<std::byte*>(&params), sizeof(params),
+                           launchOptions);
+    runtime_->memcpyDeviceToHost(stream, outData, reinterpret_cast<std::byte*>(out.data()),
+                                 out.size() * sizeof(RooflineResult));
+    runtime_->waitForStream(stream);
+    auto ops = uint64_t{0};
+    auto cycles = uint64_t{0};
+    for (const auto& r : out) {
+      ops += r.ops;
+      cycles = std::max(cycles, r.cycles);
+    }
+    return std::make_pair(static_cast<double>(ops), static_cast<double>(cycles) * secondsPerCycle);
+  };
+  auto sweeps = [&options](size_t elements) {
+    return std::max(options.rooflineAccesses / std::max(elements, size_t{1}), size_t{1});
+  };
+  auto measurement = [](const std::string& test) {
+    Measurement m;
+    m.scenario = toString(Scenario::Roofline);
+    m.params["test"] = test;
+    return m;
+  };
+
+  for (const auto& level : options.rooflineLevels) {
+    for (auto stride : options.rooflineStrides) {
+      auto elements = level.workingSet / stride;
+      if (stride < 8 || (stride & (stride - 1)) != 0 || level.workingSet % stride != 0 ||
+          elements < kRooflineMinionsPerShire) {
+        BM_LOG(WARNING) << "Skipping roofline level " << level.name << " stride " << stride
+                        << ": the stride must be a power of two, of at least 8 bytes, dividing the working set";
+        continue;
+      }
+      auto bytesPerLoad = static_cast<double>(std::min(stride, kRooflineLineSize));
+      for (auto count : options.rooflineShireCounts) {
+        auto minions = count * kRooflineMinionsPerShire;
+        if (count == 0 || count > shires.size() || elements < minions) {
+          continue;
+        }
+        auto perMinion = level.partitioned ? elements / minions : elements;
+        auto [loads, secs] = run({kRooflineLoadBw, shireMask(count), level.partitioned, nullptr, level.workingSet,
+                                  stride, sweeps(perMinion), nullptr, nullptr});
+        auto m = measurement("load_bw");
+        m.params["level"] = level.name;
+        m.params["size"] = std::to_string(level.workingSet);
+        m.params["stride"] = std::to_string(stride);
+        m.params["shires"] = std::to_string(count);
+        m.values["GBps"] = loads * bytesPerLoad / secs / 1e9;
+        results.measurements.emplace_back(std::move(m));
+      }
+      auto [loads, secs] = run({kRooflineLoadLat, shireMask(1), 0, nullptr, level.workingSet, stride,
+                                sweeps(elements), nullptr, nullptr});
+      auto m = measurement("load_lat");
+      m.params["level"] = level.name;
+      m.params["size"] = std::to_string(level.workingSet);
+      m.params["stride"] = std::to_string(stride);
+      m.values["latency_ns"] = secs / loads * 1e9;
+      m.values["latency_cycles"] = secs / loads / secondsPerCycle;
+      results.measurements.emplace_back(std::move(m));
+    }
+  }
+
+  for (auto count : options.rooflineShireCounts) {
+    if (count == 0 || count > shires.size()) {
+      continue;
+    }
+    for (auto partitioned : {true, false}) {
+      auto [atomics, secs] = run({kRooflineAtomic, shireMask(count), partitioned, nullptr, 0, 0,
+                                  options.rooflineAccesses, nullptr, nullptr});
+      auto m = measurement("atomic");
+      m.params["mode"] = partitioned ? "private" : "shared";
+      m.params["shires"] = std::to_string(count);
+      m.values["atomics_per_second"] = atomics / secs;
+      results.measurements.emplace_back(std::move(m));
+    }
+    auto [fmas, secs] = run(
+      {kRooflineFma, shireMask(count), 0, nullptr, 0, 0, sweeps(kRooflineFmaBlock), nullptr, nullptr});
+    auto m = measurement("fma");
+    m.params["shires"] = std::to_string(count);
+    m.values["GFLOPS"] = fmas * kRooflineFlopsPerFma / secs / 1e9;
+    results.measurements.emplace_back(std::move(m));
+  }
+
+  runtime_->destroyStream(stream);
+  runtime_->freeDevice(device, outData);
+  runtime_->freeDevice(device, collMem);
+  runtime_->freeDevice(device, buffer);
+  runtime_->unloadCode(loaded.kernel_);
+}
@@ -0,0 +1,31 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) 2025 Ainekko, Co.
+ * SPDX-License-Identifier: Apache-2.0
+ *-------------------------------------------------------------------------*/
+
+#pragma once
+#include <runtime/IRuntime.h>
+#include <tools/IBenchmarkSuite.h>
+namespace rt {
+class BenchmarkSuiteImp : public IBenchmarkSuite {
+public:
+  explicit BenchmarkSuiteImp(IRuntime* runtime);
+  ~BenchmarkSuiteImp();
+  Results run(const Options& options, IBenchmarker::DeviceMask mask) override;
+
+private:
+  void runLaunchRate(const Options& options, DeviceId device, Results& results);
+  void runLatency(DeviceId device, size_t samples, Results& results);
+  void runBandwidth(Scenario scenario, const Options& options, std::vector<DeviceId> devices, Results& results);
+  void runDeviceScaling(const Options& options, std::vector<DeviceId> devices, Results& results);
+  void runRoofline(const Options& options, DeviceId device, Results& results);
+  // launches the empty kernel, waiting for the stream if its queue is full
+  EventId launch(StreamId stream, DeviceId device);
+  // time in seconds of a memcpy of each kind, repeated reps times; src and dst are on the given devices
+  double timeMemcpys(Scenario scenario, StreamId stream, DeviceId dstDevice, std::byte* src, std::byte* dst,
+                     size_t size, size_t reps);
+
+  IRuntime* runtime_;
+  std::map<DeviceId, KernelId> kernels_;
+};
+} // namespace rt
@@ -47,7 +47,6 @@ BenchmarkerImp::BenchmarkerImp(IRuntime* runtime)
 
 IBenchmarker::SummaryResults BenchmarkerImp::run(Options options, DeviceMask mask) {
   BM_LOG_IF(FATAL, options.useDmaBuffers) << "Use dma buffers is not yet supported.";
-  BM_LOG_IF(FATAL, !options.kernelPath.empty()) << "Kernel based workloads is not yet supported.";
   auto& tracePath = options.runtimeTracePath;
   std::ofstream traceOutput;
   if (!tracePath.empty()) {
@@ -66,9 +65,12 @@ IBenchmarker::SummaryResults BenchmarkerImp::run(Options options, DeviceMask mas
   for (auto d : runtime_->getDevices()) {
     if (mask.isEnabled(d)) {
       BM_LOG(INFO) << "\t Device " << static_cast<int>(d) << " is enabled. Creating workers.";
-      for (int i = 0; i < options.numThreads; ++i) {
-        workers.emplace_back(std::make_unique<Worker>(options.bytesH2D, options.bytesD2H, options.numH2D,
-                                                      options.numD2H, d, *runtime_, options.kernelPath));
+      for (auto i = 0UL; i < options.numThreads; ++i) {
+        std::optional<int> cpu;
+        if (!options.cpuAffinity.empty()) {
+          cpu = options.cpuAffinity[workers.size() % options.cpuAffinity.size()];
+        }
+        workers.emplace_back(std::make_unique<Worker>(options, d, *runtime_, cpu));
       }
     }
   }
@@ -83,6 +85,9 @@ IBenchmarker::SummaryResults BenchmarkerImp::run(Options options, DeviceMask mas
   SummaryResults summary;
   for (auto& w : workers) {
     summary.workerResults.emplace_back(w->wait());
+    for (const auto& [op, histogram] : summary.workerResults.back().latencies) {
+      summary.latencies[op].merge(histogram);
+    }
   }
   if (!tracePath.empty()) {
     auto profiler = runtime_->getProfiler();
@@ -0,0 +1,102 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) 2025 Ainekko, Co.
+ * SPDX-License-Identifier: Apache-2.0
+ *-------------------------------------------------------------------------*/
+#include "tools/Histogram.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+using namespace rt;
+
+// The first 2^subBucketBits buckets hold one value each; after them, each power of two [2^k, 2^(k+1)) is split in
+// 2^(subBucketBits - 1) buckets of the same width.
+Histogram::Histogram(uint32_t subBucketBits)
+  : subBucketBits_(subBucketBits) {
+  if (subBucketBits_ < 1 || subBucketBits_ > 32) {
+    throw std::invalid_argument("Histogram subBucketBits must be in [1, 32]");
+  }
+}
+
+size_t Histogram::indexOf(uint64_t value) const {
+  auto subBucketCount = uint64_t{1} << subBucketBits_;
+  if (value < subBucketCount) {
+    return value;
+  }
+  auto halfCount = subBucketCount / 2;
+  auto msb = 63U - static_cast<uint32_t>(__builtin_clzll(value));
+  auto shift = msb - (subBucketBits_ - 1);
+  auto subBucket = value >> shift; // in [halfCount, subBucketCount)
+  return subBucketCount + (shift - 1) * halfCount + (subBucket - halfCount);
+}
+
+uint64_t Histogram::highestEquivalentValue(size_t index) const {
+  auto subBucketCount = uint64_t{1} << subBucketBits_;
+  if (index < subBucketCount) {
+    return index;
+  }
+  auto halfCount = subBucketCount / 2;
+  auto shift = (index - subBucketCount) / halfCount + 1;
+  auto subBucket = (index - subBucketCount) % halfCount + halfCount;
+  auto lowest = subBucket << shift;
+  return lowest + ((uint64_t{1} << shift) - 1);
+}
+
+void Histogram::record(uint64_t value, uint64_t count) {
+  if (count == 0) {
+    return;
+  }
+  auto index = indexOf(value);
+  if (index >= counts_.size()) {
+    counts_.resize(index + 1);
+  }
+  counts_[index] += count;
+  count_ += count;
+  min_ = std::min(min_, value);
+  max_ = std::max(max_, value);
+  sum_ += static_cast<double>(value) * static_cast<double>(count);
+}
+
+void Histogram::merge(const Histogram& other) {
+  if (other.subBucketBits_ != subBucketBits_) {
+    throw std::invalid_argument("Can't merge histograms with different precision");
+  }
+  if (other.counts_.size() > counts_.size()) {
+    counts_.resize(other.counts_.size());
+  }
+  for (auto i = 0UL; i < other.counts_.size(); ++i) {
+    counts_[i] += other.counts_[i];
+  }
+  count_ += other.count_;
+  min_ = std::min(min_, other.min_);
+  max_ = std::max(max_, other.max_);
+  sum_ += other.sum_;
+}
+
+uint64_t Histogram::min() const {
+  return count_ == 0 ? 0 : min_;
+}
+
+uint64_t Histogram::max() const {
+  return max_;
+}
+
+double Histogram::mean() const {
+  return count_ == 0 ? 0.0 : sum_ / static_cast<double>(count_);
+}
+
+uint64_t Histogram::valueAtPercentile(double percentile) const {
+  if (count_ == 0) {
+    return 0;
+  }
+  percentile = std::clamp(percentile, 0.0, 100.0);
+  auto target = std::max(static_cast<uint64_t>(std::ceil(percentile / 100.0 * static_cast<double>(count_))), 1UL);
+  auto seen = 0UL;
+  for (auto i = 0UL; i < counts_.size(); ++i) {
+    seen += counts_[i];
+    if (seen >= target) {
+      return std::clamp(highestEquivalentValue(i), min_, max_);
+    }
+  }
+  return max_;
+}
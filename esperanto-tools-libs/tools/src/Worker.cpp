@@ -9,135 +9,190 @@
 #include <chrono>
 #include <fstream>
 #include <hostUtils/logging/Logging.h>
+#include <pthread.h>
+#include <sched.h>
 using namespace rt;
 
-Worker::Worker(size_t bytesH2D, size_t bytesD2H, size_t numH2D, size_t numD2H, DeviceId device, IRuntime& runtime,
-               const std::string& kernelPath)
+namespace {
+std::vector<std::byte> readKernel(const std::string& path) {
+  std::ifstream file(path, std::ios_base::binary);
+  if (!file.is_open()) {
+    throw Exception("Couldn't open kernel file: " + path);
+  }
+  auto iniF = file.tellg();
+  file.seekg(0, std::ios::end);
+  auto endF = file.tellg();
+  auto size = endF - iniF;
+  file.seekg(0, std::ios::beg);
+
+  std::vector<std::byte> fileContent(static_cast<uint32_t>(size));
+  file.read(reinterpret_cast<char*>(fileContent.data()), size);
+  return fileContent;
+}
+} // namespace
+
+Worker::Worker(const IBenchmarker::Options& options, DeviceId device, IRuntime& runtime, std::optional<int> cpu)
   : runtime_(runtime)
   , device_(device)
-  , numH2D_(numH2D)
-  , numD2H_(numD2H) {
+  , numH2D_(options.numH2D)
+  , numD2H_(options.numD2H)
+  , kernelShireMask_(options.kernelShireMask)
+  , pipelined_(options.pipelineDepth > 0)
+  , computeHistograms_(options.computeHistograms)
+  , cpu_(cpu) {
   auto devices = runtime.getDevices();
   BM_LOG_IF(FATAL, std::find(begin(devices), end(devices), device_) == end(devices)) << "Invalid DeviceId";
-  BM_LOG_IF(FATAL, bytesH2D == 0 && bytesD2H == 0) << "H2D and D2H can't be both zero";
+  BM_LOG_IF(FATAL, options.bytesH2D == 0 && options.bytesD2H == 0) << "H2D and D2H can't be both zero";
+  bytesH2D_ = options.bytesH2D;
+  bytesD2H_ = options.bytesD2H;
   if (numH2D_ > 1) {
-    bytesH2D = bytesH2D + numH2D_ - 1;
+    bytesH2D_ = bytesH2D_ + numH2D_ - 1;
   }
   if (numD2H_ > 1) {
-    bytesD2H = bytesD2H + numD2H_ - 1;
+    bytesD2H_ = bytesD2H_ + numD2H_ - 1;
   }
-  if (bytesH2D > 0) {
-    hH2D_.resize(bytesH2D);
-    dH2D_ = runtime_.mallocDevice(device_, bytesH2D);
-  }
-  if (bytesD2H > 0) {
-    hD2H_.resize(bytesD2H);
-    dD2H_ = runtime_.mallocDevice(device_, bytesD2H);
+  slots_.resize(std::max(options.pipelineDepth, size_t{1}));
+  for (auto& slot : slots_) {
+    if (bytesH2D_ > 0) {
+      slot.hH2D_.resize(bytesH2D_);
+      slot.dH2D_ = runtime_.mallocDevice(device_, bytesH2D_);
+    }
+    if (bytesD2H_ > 0) {
+      slot.hD2H_.resize(bytesD2H_);
+      slot.dD2H_ = runtime_.mallocDevice(device_, bytesD2H_);
+    }
+    for (auto i = 0U; i < numH2D_; ++i) {
+      auto size = slot.hH2D_.size() / numH2D_;
+      if (i % 4 == 0) {
+        slot.listH2D_.emplace_back(rt::MemcpyList{});
+      }
+      slot.listH2D_.back().addOp(slot.hH2D_.data() + i * size, slot.dH2D_ + i * size, size);
+    }
+    for (auto i = 0U; i < numD2H_; ++i) {
+      auto size = slot.hD2H_.size() / numD2H_;
+      if (i % 4 == 0) {
+        slot.listD2H_.emplace_back(rt::MemcpyList{});
+      }
+      slot.listD2H_.back().addOp(slot.dD2H_ + i * size, slot.hD2H_.data() + i * size, size);
+    }
+    slot.parameters_.src = slot.dH2D_;
+    slot.parameters_.srcSize = slot.hH2D_.size();
+    slot.parameters_.dst = slot.dD2H_;
+    slot.parameters_.dstSize = slot.hD2H_.size();
   }
   stream_ = runtime_.createStream(device_);
   result_.device = device_;
 
   // load code if any
-  if (!kernelPath.empty()) {
-    std::ifstream file(kernelPath);
-    if (file.is_open()) {
-      throw Exception("Couldn't open kernel file.");
-    }
-    auto iniF = file.tellg();
-    file.seekg(0, std::ios::end);
-    auto endF = file.tellg();
-    auto size = endF - iniF;
-    file.seekg(0, std::ios::beg);
-
-    std::vector<std::byte> fileContent(static_cast<uint32_t>(size));
-    file.read(reinterpret_cast<char*>(fileContent.data()), size);
+  if (!options.kernelPath.empty()) {
+    auto fileContent = readKernel(options.kernelPath);
     auto res = runtime_.loadCode(stream_, fileContent.data(), fileContent.size());
     kernel_ = res.kernel_;
     runtime_.waitForEvent(res.event_);
     if (!runtime_.retrieveStreamErrors(stream_).empty()) {
       throw Exception("There were some errors in runtime");
     }
-    parameters_.src = dH2D_;
-    parameters_.srcSize = hH2D_.size();
-    parameters_.dst = dD2H_;
-    parameters_.dstSize = hD2H_.size();
   }
 }
 
-void Worker::doIteration(bool computeOpStats, uint64_t shireMask, std::vector<rt::MemcpyList>& listH2D,
-                         std::vector<rt::MemcpyList>& listD2H, std::vector<OpStats>& opstats) {
-  if (dH2D_) {
+void Worker::trackLatency(EventId event, const std::string& op, Clock::time_point submitted) {
+  {
+    std::lock_guard lock(mutex_);
+    ++pendingLatencies_;
+  }
+  runtime_.onEventComplete(event, [this, op, submitted](EventId) {
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - submitted).count();
+    std::lock_guard lock(mutex_);
+    result_.latencies[op].record(static_cast<uint64_t>(ns));
+    if (--pendingLatencies_ == 0) {
+      cv_.notify_all();
+    }
+  });
+}
+
+void Worker::waitTrackedLatencies() {
+  std::unique_lock lock(mutex_);
+  cv_.wait(lock, [this] { return pendingLatencies_ == 0; });
+}
+
+void Worker::doIteration(bool computeOpStats, bool computeHistograms, uint64_t shireMask, Slot& slot,
+                         std::vector<OpStats>& opstats) {
+  if (pipelined_ && slot.lastEvent_) {
+    // the workload which used these buffers has to finish first
+    runtime_.waitForEvent(*slot.lastEvent_);
+  }
+  auto workloadStart = Clock::now();
+  std::optional<EventId> last;
+  auto submit = [&](const char* op, auto&& enqueue) {
+    auto submitted = Clock::now();
+    auto evt = enqueue();
+    if (computeOpStats) {
+      opstats.emplace_back(OpStats{evt});
+    }
+    if (computeHistograms) {
+      trackLatency(evt, op, submitted);
+    }
+    last = evt;
+  };
+  if (slot.dH2D_) {
     if (numH2D_ > 1) {
-      for (auto& op : listH2D) {
-        auto evt = runtime_.memcpyHostToDevice(stream_, op);
-        if (computeOpStats) {
-          opstats.emplace_back(OpStats{evt});
-        }
+      for (auto& op : slot.listH2D_) {
+        submit("h2d", [&] { return runtime_.memcpyHostToDevice(stream_, op); });
       }
     } else {
-      auto evt = runtime_.memcpyHostToDevice(stream_, hH2D_.data(), dH2D_, hH2D_.size());
-      if (computeOpStats) {
-        opstats.emplace_back(OpStats{evt});
-      }
+      submit("h2d",
+             [&] { return runtime_.memcpyHostToDevice(stream_, slot.hH2D_.data(), slot.dH2D_, slot.hH2D_.size()); });
     }
   }
   if (kernel_) {
-    auto evt = runtime_.kernelLaunch(stream_, kernel_.value(), reinterpret_cast<std::byte*>(&parameters_),
-                                     sizeof(parameters_), shireMask);
-    if (computeOpStats) {
-      opstats.emplace_back(OpStats{evt});
-    }
+    submit("kernel", [&] {
+      return runtime_.kernelLaunch(stream_, kernel_.value(), reinterpret_cast<std::byte*>(&slot.parameters_),
+                                   sizeof(slot.parameters_), shireMask);
+    });
   }
-  if (dD2H_) {
+  if (slot.dD2H_) {
     if (numD2H_ > 1) {
-      for (auto& op : listD2H) {
-        auto evt = runtime_.memcpyDeviceToHost(stream_, op);
-        if (computeOpStats) {
-          opstats.emplace_back(OpStats{evt});
-        }
+      for (auto& op : slot.listD2H_) {
+        submit("d2h", [&] { return runtime_.memcpyDeviceToHost(stream_, op); });
       }
     } else {
-      auto evt = runtime_.memcpyDeviceToHost(stream_, dD2H_, hD2H_.data(), hD2H_.size());
-      if (computeOpStats) {
-        opstats.emplace_back(OpStats{evt});
-      }
+      submit("d2h",
+             [&] { return runtime_.memcpyDeviceToHost(stream_, slot.dD2H_, slot.hD2H_.data(), slot.hD2H_.size()); });
     }
   }
+  if (last && computeHistograms) {
+    trackLatency(*last, "workload", workloadStart);
+  }
+  slot.lastEvent_ = last;
 }
 
 void Worker::start(int numIterations, bool computeOpStats, bool discardFirst) {
   runner_ = std::thread([this, numIterations, computeOpStats, discardFirst] {
+    if (cpu_) {
+      cpu_set_t cpuset;
+      CPU_ZERO(&cpuset);
+      CPU_SET(*cpu_, &cpuset);
+      BM_LOG_IF(WARNING, pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset) != 0)
+        << "Couldn't pin worker thread to cpu " << *cpu_;
+    }
     using OpStats = rt::IBenchmarker::OpStats;
-    auto shireMask = runtime_.getDeviceProperties(device_).computeMinionShireMask_;
+    auto shireMask = kernelShireMask_;
+    if (shireMask == 0) {
+      shireMask = runtime_.getDeviceProperties(device_).computeMinionShireMask_;
+    }
     std::vector<OpStats> opstats;
 
-    std::vector<rt::MemcpyList> listH2D;
-    std::vector<rt::MemcpyList> listD2H;
-
     if (discardFirst) {
-      doIteration(computeOpStats, shireMask, listH2D, listD2H, opstats);
+      doIteration(computeOpStats, false, shireMask, slots_.front(), opstats);
     }
     opstats.clear();
 
     auto start = std::chrono::high_resolution_clock::now();
 
-    for (auto i = 0U; i < numH2D_; ++i) {
-      auto size = hH2D_.size() / numH2D_;
-      if (i % 4 == 0) {
-        listH2D.emplace_back(rt::MemcpyList{});
-      }
-      listH2D.back().addOp(hH2D_.data() + i * size, dH2D_ + i * size, size);
-    }
-    for (auto i = 0U; i < numD2H_; ++i) {
-      auto size = hD2H_.size() / numD2H_;
-      if (i % 4 == 0) {
-        listD2H.emplace_back(rt::MemcpyList{});
-      }
-      listD2H.back().addOp(dD2H_ + i * size, hD2H_.data() + i * size, size);
-    }
     for (int i = 0; i < numIterations; ++i) {
       BM_VLOG(MID) << "Doing interation: " << i;
-      doIteration(computeOpStats, shireMask, listH2D, listD2H, opstats);
+      auto& slot = slots_[static_cast<size_t>(i) % slots_.size()];
+      doIteration(computeOpStats, computeHistograms_, shireMask, slot, opstats);
     }
     if (computeOpStats) {
       for (auto& e : opstats) {
@@ -149,10 +204,11 @@ void Worker::start(int numIterations, bool computeOpStats, bool discardFirst) {
       runtime_.waitForStream(stream_);
     }
     auto et = std::chrono::high_resolution_clock::now() - start;
+    waitTrackedLatencies();
     auto us = std::chrono::duration_cast<std::chrono::microseconds>(et);
     auto secs = us.count() / 1e6f;
-    result_.bytesReceivedPerSecond = hD2H_.size() * numIterations / secs;
-    result_.bytesSentPerSecond = hH2D_.size() * numIterations / secs;
+    result_.bytesReceivedPerSecond = bytesD2H_ * numIterations / secs;
+    result_.bytesSentPerSecond = bytesH2D_ * numIterations / secs;
     result_.workloadsPerSecond = numIterations / secs;
     result_.opStats_ = std::move(opstats);
   });
@@ -164,11 +220,13 @@ rt::IBenchmarker::WorkerResult Worker::wait() {
 }
 
 Worker::~Worker() {
-  if (dD2H_) {
-    runtime_.freeDevice(device_, dD2H_);
-  }
-  if (dH2D_) {
-    runtime_.freeDevice(device_, dH2D_);
+  for (auto& slot : slots_) {
+    if (slot.dD2H_) {
+      runtime_.freeDevice(device_, slot.dD2H_);
+    }
+    if (slot.dH2D_) {
+      runtime_.freeDevice(device_, slot.dH2D_);
+    }
   }
   runtime_.destroyStream(stream_);
-}
\ No newline at end of file
+}
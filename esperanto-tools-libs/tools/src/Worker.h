@@ -6,21 +6,48 @@
 #include "runtime/Types.h"
 #include "tools/IBenchmarker.h"
 #include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <optional>
 #include <runtime/IRuntime.h>
 #include <thread>
 
 class Worker {
 public:
-  explicit Worker(size_t bytesH2D, size_t bytesD2H, size_t numH2D, size_t numD2H, rt::DeviceId device,
-                  rt::IRuntime& runtime, const std::string& kernelPath);
+  // cpu is the cpu its thread is pinned to, if any
+  explicit Worker(const rt::IBenchmarker::Options& options, rt::DeviceId device, rt::IRuntime& runtime,
+                  std::optional<int> cpu = std::nullopt);
   void start(int numIterations, bool computeOpStats, bool discardFirst = true);
   rt::IBenchmarker::WorkerResult wait();
   ~Worker();
 
 private:
   using OpStats = rt::IBenchmarker::OpStats;
-  void doIteration(bool computeOpStats, uint64_t shireMask, std::vector<rt::MemcpyList>& listH2D,
-                   std::vector<rt::MemcpyList>& listD2H, std::vector<OpStats>& opstats);
+  using Clock = std::chrono::high_resolution_clock;
+
+  // buffers of a workload in flight
+  struct Slot {
+    std::vector<std::byte> hH2D_;
+    std::byte* dH2D_ = nullptr;
+    std::vector<std::byte> hD2H_;
+    std::byte* dD2H_ = nullptr;
+    std::vector<rt::MemcpyList> listH2D_;
+    std::vector<rt::MemcpyList> listD2H_;
+    std::optional<rt::EventId> lastEvent_;
+    struct Parameters {
+      std::byte* src;
+      size_t srcSize;
+      std::byte* dst;
+      size_t dstSize;
+    } parameters_;
+  };
+
+  void doIteration(bool computeOpStats, bool computeHistograms, uint64_t shireMask, Slot& slot,
+                   std::vector<OpStats>& opstats);
+  // records the latency of the event into the histogram once it completes
+  void trackLatency(rt::EventId event, const std::string& op, Clock::time_point submitted);
+  void waitTrackedLatencies();
+
   rt::IRuntime& runtime_;
   rt::DeviceId device_;
   rt::StreamId stream_;
@@ -28,18 +55,16 @@ private:
   rt::IBenchmarker::WorkerResult result_;
   size_t numH2D_;
   size_t numD2H_;
+  size_t bytesH2D_ = 0;
+  size_t bytesD2H_ = 0;
+  uint64_t kernelShireMask_;
+  bool pipelined_;
+  bool computeHistograms_;
+  std::optional<int> cpu_;
   std::optional<rt::KernelId> kernel_;
+  std::vector<Slot> slots_;
 
-  std::vector<std::byte> hH2D_;
-  std::byte* dH2D_ = nullptr;
-
-  std::vector<std::byte> hD2H_;
-  std::byte* dD2H_ = nullptr;
-
-  struct Parameters {
-    std::byte* src;
-    size_t srcSize;
-    std::byte* dst;
-    size_t dstSize;
-  } parameters_;
-};
\ No newline at end of file
+  std::mutex mutex_; // guards result_.latencies and pendingLatencies_, updated by runtime callbacks
+  std::condition_variable cv_;
+  size_t pendingLatencies_ = 0;
+};
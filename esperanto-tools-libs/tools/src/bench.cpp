@@ -7,12 +7,17 @@
 #include "runtime/DeviceLayerFake.h"
 #include "runtime/IRuntime.h"
 #include "runtime/Types.h"
+#include "tools/IBenchmarkSuite.h"
 #include "tools/IBenchmarker.h"
+#include <fstream>
 #include <gflags/gflags.h>
 #include <hostUtils/logging/Instance.h>
 #include <hostUtils/logging/Logger.h>
 #include <iomanip>
 #include <iostream>
+#include <sstream>
+#include <sys/wait.h>
+#include <unistd.h>
 
 #if __has_include(<filesystem>)
 #include <filesystem>
@@ -45,9 +50,44 @@ DECLARE_bool(helpshort);
 DEFINE_string(kernelPath, "",
               "path of the kernel to load and execute (per workload). If empty then it won't execute any kernel. "
               "Parameters for the kernel will be the H2D buffer + size and D2H buffer + size");
+DEFINE_uint64(depth, 0,
+              "workloads in flight per thread, each one with its own buffers (H2D || kernel || D2H pipeline). If 0 all "
+              "workloads are submitted at once");
+DEFINE_uint64(shireMask, 0, "shires to launch the kernel on. If 0 all the compute shires");
+DEFINE_string(cpus, "", "comma separated cpus to pin the threads to, round robin. If empty threads are not pinned");
+DEFINE_bool(histograms, false, "compute the latency histograms of each operation");
+DEFINE_string(thSweep, "", "comma separated thread counts to run the benchmark with, instead of --th");
 DEFINE_uint32(deviceLayer, 0, "DeviceLayer type: 0 -> fake; 1 -> sysemu based; 2 -> pcie; 3-> socket");
 DEFINE_string(socketPath, "/var/run/et_runtime/pcie.sock", "socket path when connecting to a daemon");
 
+// benchmark suite, see IBenchmarkSuite
+DEFINE_bool(suite, false, "run the benchmark suite instead of the H2D/D2H workloads; the results are always json");
+DEFINE_string(scenarios, "",
+              "comma separated suite scenarios (launch_rate, latency, bandwidth_h2d, bandwidth_d2h, bandwidth_p2p, "
+              "device_scaling, roofline). All of them if empty");
+DEFINE_string(emptyKernel, "", "kernel doing nothing used by the suite launches. Defaults to KERNELS_DIR/empty.elf");
+DEFINE_string(streams, "1,2,4,8", "comma separated stream counts of the launch_rate scenario");
+DEFINE_string(sizes, "4096,65536,1048576,16777216,67108864",
+              "comma separated transfer sizes of the bandwidth scenarios");
+DEFINE_uint64(launches, 10000, "kernel launches per launch_rate and device_scaling measurement");
+DEFINE_uint64(samples, 10000, "samples per latency measurement");
+DEFINE_uint64(bandwidthBytes, 256 << 20, "bytes transferred per bandwidth measurement");
+DEFINE_string(rooflineKernel, "", "kernel of the roofline scenario. Defaults to KERNELS_DIR/roofline.elf");
+DEFINE_string(rooflineShires, "1,2,4,8,16,32", "comma separated shire counts of the roofline scenario");
+DEFINE_string(rooflineLevels, "l1:8192,l2:1048576,l3:16777216,dram:268435456:p",
+              "comma separated name:workingSet[:p] of the roofline load tests, p sweeps a slice per minion");
+DEFINE_string(rooflineStrides, "8,64,256", "comma separated strides of the roofline load tests");
+DEFINE_uint64(rooflineAccesses, 1 << 20, "loads, atomics or FMA instructions per hart and roofline measurement");
+DEFINE_uint32(processes, 1, "number of processes running the suite at the same time, through the server (socket)");
+DEFINE_string(output, "", "file to write the suite results to. If empty they go to stdout");
+DEFINE_string(baseline, "", "suite results to compare with; the exit code is not zero if there are regressions");
+DEFINE_double(tolerance, 0.1, "allowed relative loss against the baseline before it is a regression");
+DEFINE_uint32(fakeDevices, 1, "number of devices of the fake DeviceLayer");
+DEFINE_uint64(fakeKernelLaunchNs, 0, "fake DeviceLayer kernel launch time");
+DEFINE_uint64(fakeDmaCommandNs, 0, "fake DeviceLayer fixed time per DMA command");
+DEFINE_uint64(fakeDmaBytesPerSecond, 0, "fake DeviceLayer DMA bandwidth, zero means transfers take no time");
+DEFINE_uint32(fakeSqDepth, 0, "fake DeviceLayer maximum commands in flight, zero means unlimited");
+
 static bool ValidatePort(const char* flagname, GFLAGS_NAMESPACE::uint32 value) {
   if (value >= 0 && value <= 3) // value is ok
     return true;
@@ -81,9 +121,15 @@ inline auto getDefaultSysemuOptions() {
 auto createDeviceLayer() {
   std::unique_ptr<dev::IDeviceLayer> result;
   switch (FLAGS_deviceLayer) {
-  case 0:
-    result.reset(new dev::DeviceLayerFake);
+  case 0: {
+    auto params = dev::DeviceLayerFake::Parameters::getDefault();
+    params.latency_.kernelLaunch_ = std::chrono::nanoseconds(FLAGS_fakeKernelLaunchNs);
+    params.latency_.dmaCommand_ = std::chrono::nanoseconds(FLAGS_fakeDmaCommandNs);
+    params.latency_.dmaBytesPerSecond_ = FLAGS_fakeDmaBytesPerSecond;
+    params.latency_.sqDepth_ = FLAGS_fakeSqDepth;
+    result.reset(new dev::DeviceLayerFake(static_cast<int>(FLAGS_fakeDevices), params));
     break;
+  }
   case 1:
     result = dev::IDeviceLayer::createSysEmuDeviceLayer(getDefaultSysemuOptions());
     break;
@@ -97,7 +143,179 @@ auto createDeviceLayer() {
   }
   return result;
 }
+auto createRuntime() {
+  std::shared_ptr<dev::IDeviceLayer> deviceLayer = createDeviceLayer();
+  decltype(rt::IRuntime::create(deviceLayer)) runtime;
+  if (deviceLayer) {
+    runtime = rt::IRuntime::create(deviceLayer, rt::Options{false, false});
+  } else {
+    runtime = rt::IRuntime::create(FLAGS_socketPath);
+  }
+  return runtime;
+}
+
+template <typename T> std::vector<T> parseList(const std::string& list) {
+  std::vector<T> result;
+  std::istringstream is(list);
+  std::string item;
+  while (std::getline(is, item, ',')) {
+    if (!item.empty()) {
+      result.emplace_back(static_cast<T>(std::stoull(item)));
+    }
+  }
+  return result;
+}
+
+std::vector<IBenchmarkSuite::Scenario> parseScenarios(const std::string& list) {
+  using Scenario = IBenchmarkSuite::Scenario;
+  std::vector<Scenario> result;
+  std::istringstream is(list);
+  std::string item;
+  while (std::getline(is, item, ',')) {
+    auto found = false;
+    for (auto s : {Scenario::LaunchRate, Scenario::Latency, Scenario::BandwidthH2D, Scenario::BandwidthD2H,
+                   Scenario::BandwidthP2P, Scenario::DeviceScaling, Scenario::Roofline}) {
+      if (item == IBenchmarkSuite::toString(s)) {
+        result.emplace_back(s);
+        found = true;
+      }
+    }
+    if (!found && !item.empty()) {
+      throw std::invalid_argument("Unknown scenario: " + item);
+    }
+  }
+  return result;
+}
+
+std::vector<IBenchmarkSuite::RooflineLevel> parseRooflineLevels(const std::string& list) {
+  std::vector<IBenchmarkSuite::RooflineLevel> result;
+  std::istringstream is(list);
+  std::string item;
+  while (std::getline(is, item, ',')) {
+    if (item.empty()) {
+      continue;
+    }
+    auto colon = item.find(':');
+    if (colon == std::string::npos || colon == 0) {
+      throw std::invalid_argument("Wrong roofline level, it should be name:workingSet[:p]: " + item);
+    }
+    IBenchmarkSuite::RooflineLevel level;
+    level.name = item.substr(0, colon);
+    auto rest = item.substr(colon + 1);
+    auto flag = rest.find(':');
+    level.workingSet = std::stoull(rest.substr(0, flag));
+    level.partitioned = flag != std::string::npos && rest.substr(flag + 1) == "p";
+    result.emplace_back(std::move(level));
+  }
+  return result;
+}
+
+IBenchmarkSuite::Results readResults(const std::string& path) {
+  std::ifstream file(path);
+  if (!file.is_open()) {
+    throw std::runtime_error("Can't open suite results: " + path);
+  }
+  auto j = nlohmann::json::parse(file);
+  return j.contains("results") ? j.at("results").get<IBenchmarkSuite::Results>() : j.get<IBenchmarkSuite::Results>();
+}
+
+IBenchmarkSuite::Results runSuite() {
+  auto runtime = createRuntime();
+  auto suite = IBenchmarkSuite::create(runtime.get());
+  IBenchmarkSuite::Options opts;
+  opts.scenarios = parseScenarios(FLAGS_scenarios);
+  opts.emptyKernelPath = FLAGS_emptyKernel;
+  if (opts.emptyKernelPath.empty() && std::string(KERNELS_DIR).size() > 0) {
+    opts.emptyKernelPath = std::string(KERNELS_DIR) + "/empty.elf";
+  }
+  opts.streamCounts = parseList<size_t>(FLAGS_streams);
+  opts.transferSizes = parseList<size_t>(FLAGS_sizes);
+  opts.launches = FLAGS_launches;
+  opts.latencySamples = FLAGS_samples;
+  opts.bandwidthBytes = FLAGS_bandwidthBytes;
+  opts.rooflineKernelPath = FLAGS_rooflineKernel;
+  if (opts.rooflineKernelPath.empty() && std::string(KERNELS_DIR).size() > 0) {
+    opts.rooflineKernelPath = std::string(KERNELS_DIR) + "/roofline.elf";
+  }
+  opts.rooflineShireCounts = parseList<size_t>(FLAGS_rooflineShires);
+  opts.rooflineLevels = parseRooflineLevels(FLAGS_rooflineLevels);
+  opts.rooflineStrides = parseList<size_t>(FLAGS_rooflineStrides);
+  opts.rooflineAccesses = FLAGS_rooflineAccesses;
+  IBenchmarker::DeviceMask mask;
+  mask.mask_ = FLAGS_dmask;
+  return suite->run(opts, mask);
+}
+
+// runs the suite in FLAGS_processes copies of this executable, each one with its own runtime connected to the server
+IBenchmarkSuite::Results runSuiteProcesses(const std::vector<std::string>& args) {
+  if (FLAGS_deviceLayer != 3) {
+    throw std::invalid_argument("Multiple processes need the socket DeviceLayer (--deviceLayer=3)");
+  }
+  std::vector<std::pair<pid_t, std::string>> children;
+  for (auto p = 0U; p < FLAGS_processes; ++p) {
+    auto output = (fs::temp_directory_path() /
+                   ("bench_suite_" + std::to_string(getpid()) + "_" + std::to_string(p) + ".json"))
+                    .string();
+    auto childArgs = args;
+    childArgs.emplace_back("--processes=1");
+    childArgs.emplace_back("--baseline=");
+    childArgs.emplace_back("--output=" + output);
+    std::vector<char*> argv;
+    for (auto& a : childArgs) {
+      argv.emplace_back(a.data());
+    }
+    argv.emplace_back(nullptr);
+    auto pid = fork();
+    if (pid < 0) {
+      throw std::runtime_error("Can't fork the suite processes");
+    }
+    if (pid == 0) {
+      execv("/proc/self/exe", argv.data());
+      _exit(127);
+    }
+    children.emplace_back(pid, output);
+  }
+  IBenchmarkSuite::Results results;
+  for (auto p = 0U; p < children.size(); ++p) {
+    auto& [pid, output] = children[p];
+    int status = 0;
+    waitpid(pid, &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+      throw std::runtime_error("Suite process " + std::to_string(p) + " failed");
+    }
+    for (auto& m : readResults(output).measurements) {
+      m.params["processes"] = std::to_string(FLAGS_processes);
+      m.params["process"] = std::to_string(p);
+      results.measurements.emplace_back(std::move(m));
+    }
+    fs::remove(output);
+  }
+  return results;
+}
+
+int suiteMain(const std::vector<std::string>& args) {
+  auto results = FLAGS_processes > 1 ? runSuiteProcesses(args) : runSuite();
+  nlohmann::json j;
+  j["results"] = results;
+  auto regressions = std::vector<IBenchmarkSuite::Regression>{};
+  if (!FLAGS_baseline.empty()) {
+    regressions = IBenchmarkSuite::compare(results, readResults(FLAGS_baseline), FLAGS_tolerance);
+    j["regressions"] = regressions;
+  }
+  if (FLAGS_output.empty()) {
+    std::cout << j.dump(2) << std::endl;
+  } else {
+    std::ofstream(FLAGS_output) << j.dump(2) << std::endl;
+  }
+  for (const auto& r : regressions) {
+    std::cerr << "Regression in " << r.scenario << " " << nlohmann::json(r.params).dump() << " " << r.metric << ": "
+              << r.baseline << " -> " << r.current << std::endl;
+  }
+  return regressions.empty() ? 0 : 1;
+}
+
 int main(int argc, char* argv[]) {
+  std::vector<std::string> args(argv, argv + argc);
   logging::Instance logger;
   if (!FLAGS_enableLogging) {
     g3::log_levels::disable(INFO);
@@ -111,13 +329,10 @@ int main(int argc, char* argv[]) {
   }
   GFLAGS_NAMESPACE::HandleCommandLineHelpFlags();
 
-  std::shared_ptr<dev::IDeviceLayer> deviceLayer = createDeviceLayer();
-  decltype(rt::IRuntime::create(deviceLayer)) runtime;
-  if (deviceLayer) {
-    runtime = rt::IRuntime::create(deviceLayer, rt::Options{false, false});
-  } else {
-    runtime = rt::IRuntime::create(FLAGS_socketPath);
+  if (FLAGS_suite) {
+    return suiteMain(args);
   }
+  auto runtime = createRuntime();
   auto benchmarker = IBenchmarker::create(runtime.get());
   IBenchmarker::Options opts;
   opts.runtimeTracePath = FLAGS_tracePath;
@@ -130,20 +345,41 @@ int main(int argc, char* argv[]) {
   opts.numH2D = FLAGS_numh2d;
   opts.numWorkloadsPerThread = FLAGS_wl;
   opts.computeOpStats = FLAGS_computeOpStats;
+  opts.pipelineDepth = FLAGS_depth;
+  opts.kernelShireMask = FLAGS_shireMask;
+  opts.cpuAffinity = parseList<int>(FLAGS_cpus);
+  opts.computeHistograms = FLAGS_histograms;
 
   IBenchmarker::DeviceMask mask;
   mask.mask_ = FLAGS_dmask;
-  auto results = benchmarker->run(opts, mask);
+  auto threadCounts = parseList<uint64_t>(FLAGS_thSweep);
+  if (threadCounts.empty()) {
+    threadCounts.emplace_back(FLAGS_th);
+  }
+  nlohmann::json runs = nlohmann::json::array();
+  for (auto numThreads : threadCounts) {
+    opts.numThreads = numThreads;
+    auto results = benchmarker->run(opts, mask);
+    if (FLAGS_json) {
+      nlohmann::json j;
+      j["options"] = opts;
+      j["execution"] = results;
+      runs.emplace_back(std::move(j));
+    } else {
+      std::cout << "Summary (" << numThreads << " threads per device): " << std::setprecision(2) << std::fixed
+                << "\n * H2D: " << results.bytesSentPerSecond / 1e6 << "MB/s"
+                << "\n * D2H: " << results.bytesReceivedPerSecond / 1e6 << "MB/s"
+                << "\n * Workloads/s: " << results.workloadsPerSecond << std::endl;
+      for (const auto& [op, histogram] : results.latencies) {
+        std::cout << " * " << op << " latency (us): p50 " << histogram.valueAtPercentile(50) / 1e3 << " p99 "
+                  << histogram.valueAtPercentile(99) / 1e3 << " p99.9 " << histogram.valueAtPercentile(99.9) / 1e3
+                  << " max " << histogram.max() / 1e3 << std::endl;
+      }
+    }
+  }
   if (FLAGS_json) {
-    using namespace nlohmann;
-    json j;
-    j["options"] = opts;
-    j["execution"] = results;
-    std::cout << std::setprecision(2) << std::fixed << j.dump(2) << std::endl;
-  } else {
-    std::cout << "Summary: " << std::setprecision(2) << std::fixed << "\n * H2D: " << results.bytesSentPerSecond / 1e6
-              << "MB/s"
-              << "\n * D2H: " << results.bytesReceivedPerSecond / 1e6 << "MB/s"
-              << "\n * Workloads/s: " << results.workloadsPerSecond << std::endl;
+    // a single run keeps the original layout
+    auto& out = runs.size() == 1 ? runs[0] : runs;
+    std::cout << std::setprecision(2) << std::fixed << out.dump(2) << std::endl;
   }
 }
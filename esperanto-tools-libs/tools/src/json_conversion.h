@@ -3,6 +3,7 @@
  * SPDX-License-Identifier: Apache-2.0
  *-------------------------------------------------------------------------*/
 
+#include "tools/IBenchmarkSuite.h"
 #include "tools/IBenchmarker.h"
 #include <nlohmann/json.hpp>
 namespace rt {
@@ -17,7 +18,22 @@ void to_json(nlohmann::json& j, const IBenchmarker::Options& options) {
                      {"computeOpStats", options.computeOpStats},
                      {"kernelPath", options.kernelPath},
                      {"numH2D", options.numH2D},
-                     {"numD2H", options.numD2H}};
+                     {"numD2H", options.numD2H},
+                     {"pipelineDepth", options.pipelineDepth},
+                     {"kernelShireMask", options.kernelShireMask},
+                     {"cpuAffinity", options.cpuAffinity},
+                     {"computeHistograms", options.computeHistograms}};
+}
+void to_json(nlohmann::json& j, const Histogram& h) {
+  j = nlohmann::json{{"count", h.count()},
+                     {"min_ns", h.min()},
+                     {"mean_ns", h.mean()},
+                     {"p50_ns", h.valueAtPercentile(50)},
+                     {"p90_ns", h.valueAtPercentile(90)},
+                     {"p99_ns", h.valueAtPercentile(99)},
+                     {"p999_ns", h.valueAtPercentile(99.9)},
+                     {"p9999_ns", h.valueAtPercentile(99.99)},
+                     {"max_ns", h.max()}};
 }
 void to_json(nlohmann::json& j, const IBenchmarker::OpStats& result) {
   using namespace std::chrono;
@@ -31,12 +47,35 @@ void to_json(nlohmann::json& j, const IBenchmarker::WorkerResult& result) {
                      {"MBpsSent", result.bytesSentPerSecond / static_cast<float>(1 << 20)},
                      {"WLps", result.workloadsPerSecond},
                      {"DeviceId", result.device},
-                     {"OpStats", result.opStats_}};
+                     {"OpStats", result.opStats_},
+                     {"Latencies", result.latencies}};
 }
 void to_json(nlohmann::json& j, const IBenchmarker::SummaryResults& result) {
   j = nlohmann::json{{"TotalMBpsReceived", result.bytesReceivedPerSecond / static_cast<float>(1 << 20)},
                      {"TotalMBpsSent", result.bytesSentPerSecond / static_cast<float>(1 << 20)},
                      {"TotalWLps", result.workloadsPerSecond},
-                     {"WorkersResults", result.workerResults}};
+                     {"WorkersResults", result.workerResults},
+                     {"Latencies", result.latencies}};
+}
+void to_json(nlohmann::json& j, const IBenchmarkSuite::Measurement& m) {
+  j = nlohmann::json{{"scenario", m.scenario}, {"params", m.params}, {"values", m.values}};
+}
+void from_json(const nlohmann::json& j, IBenchmarkSuite::Measurement& m) {
+  j.at("scenario").get_to(m.scenario);
+  j.at("params").get_to(m.params);
+  j.at("values").get_to(m.values);
+}
+void to_json(nlohmann::json& j, const IBenchmarkSuite::Results& results) {
+  j = nlohmann::json{{"measurements", results.measurements}};
+}
+void from_json(const nlohmann::json& j, IBenchmarkSuite::Results& results) {
+  j.at("measurements").get_to(results.measurements);
+}
+void to_json(nlohmann::json& j, const IBenchmarkSuite::Regression& r) {
+  j = nlohmann::json{{"scenario", r.scenario},
+                     {"params", r.params},
+                     {"metric", r.metric},
+                     {"baseline", r.baseline},
+                     {"current", r.current}};
 }
 } // namespace rt
\ No newline at end of file
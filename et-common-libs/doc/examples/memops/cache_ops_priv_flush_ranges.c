@@ -0,0 +1,30 @@
+/*
+  Example of using cache_ops_priv_flush_ranges api.
+  Below is an example which demonstrates the flush of two output buffers to memory. A memory
+  read/write operation will be performed and then only the written ranges will be flushed, which
+  stay in the caches.
+*/
+
+/* Include api specific header */
+#include <etsoc/isa/cacheops-umode.h>
+#include "utils.h"
+
+/* Define base addresses for memory operations to generate shire cache and memory shire events. */
+
+#define MS_BASE_DEST_0   0x8100006000ULL
+#define MS_BASE_DEST_1   0x8100008000ULL
+#define MS_BASE_SRC      0x8100009000ULL
+#define TEST_DATA_SIZE   256
+
+int main(void)
+{
+    cache_ops_range_t ranges[] = { { MS_BASE_DEST_0, TEST_DATA_SIZE },
+        { MS_BASE_DEST_1, TEST_DATA_SIZE } };
+
+    /* Do a memory read/write. */
+    et_memcpy(MS_BASE_DEST_0, MS_BASE_SRC, TEST_DATA_SIZE);
+    et_memcpy(MS_BASE_DEST_1, MS_BASE_SRC, TEST_DATA_SIZE);
+
+    /* Flush only the written ranges to memory */
+    return (int)cache_ops_priv_flush_ranges(to_Mem, ranges, 2);
+}
@@ -0,0 +1,536 @@
+/*-------------------------------------------------------------------------
+* Copyright (c) 2025 Ainekko, Co.
+* SPDX-License-Identifier: Apache-2.0
+*-------------------------------------------------------------------------
+*/
+/***********************************************************************/
+/*! \file collectives.h
+    \brief A C header only library of collectives (barrier, allreduce and
+    broadcast) for kernels spanning many shires.
+
+    The collectives are hierarchical, no level has more than a few harts
+    meeting at the same place:
+
+    - Harts of a neighborhood join a neighborhood FLB, the last one of each
+      neighborhood joins the shire FLB. Reduced values are combined by the
+      last hart of each level from per hart slots accessed with local
+      atomics, so they never leave the shire L2.
+    - When all the first harts of a shire reduce (and no second hart takes
+      part) the shire level is a TensorReduce tree instead, leaving the
+      shire value in minion 0.
+    - The last hart of each shire climbs a fanout ET_COLL_FANOUT tree of
+      counters accessed with global atomics. Only the last hart arriving
+      at a node keeps climbing, the others sleep on their FCC. The root
+      releases the harts it met on its way up, each of them releases the
+      ones it met and finally every shire leader releases its shire.
+
+    Nobody polls: waiting harts block on FCC until their credit arrives.
+
+    The collective memory (et_coll_mem_t) lives in device memory, must be
+    zeroed before the first collective and must not be shared with other
+    collectives in flight. Every hart taking part uses its own et_coll_t,
+    initialized with the same arguments, and all of them have to call the
+    same collectives in the same order. The FLBs flb to flb + 4 and the
+    selected FCC can't be used by the kernel while collectives are in use.
+*/
+/***********************************************************************/
+
+#ifndef __COLLECTIVES_H
+#define __COLLECTIVES_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "etsoc/isa/atomic.h"
+#include "etsoc/isa/fcc.h"
+#include "etsoc/isa/flb.h"
+#include "etsoc/isa/hart.h"
+#include "etsoc/isa/tensors.h"
+#include "etsoc/isa/utils.h"
+
+/*! \def ET_COLL_MAX_SHIRES
+    \brief Maximum number of compute shires taking part in collectives
+*/
+#define ET_COLL_MAX_SHIRES 32U
+
+/*! \def ET_COLL_FANOUT
+    \brief Number of shires (or subtrees) meeting at each node of the chip tree
+*/
+#define ET_COLL_FANOUT 4U
+
+/*! \def ET_COLL_MAX_NODES
+    \brief Nodes of the chip tree for ET_COLL_MAX_SHIRES shires (8 + 2 + 1)
+*/
+#define ET_COLL_MAX_NODES 11U
+
+/*! \def ET_COLL_MAX_LEVELS
+    \brief Levels of the chip tree for ET_COLL_MAX_SHIRES shires
+*/
+#define ET_COLL_MAX_LEVELS 3U
+
+/*! \def ET_COLL_NEIGH_FLBS
+    \brief FLBs used by each context, one per neighborhood plus the shire one
+*/
+#define ET_COLL_NEIGH_FLBS 5U
+
+/*! \def ET_COLL_BCAST_SIZE
+    \brief Maximum payload in bytes of a broadcast
+*/
+#define ET_COLL_BCAST_SIZE 1024U
+
+/**
+ * @brief Defines for collectives status codes.
+ */
+#define ET_COLL_OPERATION_SUCCESS     0
+#define ET_COLL_ERROR_INVALID_ARGS    -1
+#define ET_COLL_ERROR_NOT_PARTICIPANT -2
+
+/*! \struct et_coll_node_t
+    \brief A node of the chip tree, only accessed with global atomics.
+*/
+typedef struct et_coll_node {
+    uint32_t count;                  /**< Harts arrived at the node */
+    uint32_t hart[ET_COLL_FANOUT];   /**< Hart arrived from each child, to release it */
+    uint8_t pad[12];
+    uint64_t value[ET_COLL_FANOUT];  /**< Value arrived from each child */
+} __attribute__((aligned(64))) et_coll_node_t;
+
+/*! \struct et_coll_shire_t
+    \brief Per shire reduction slots, only accessed with local atomics.
+*/
+typedef struct et_coll_shire {
+    uint64_t hart[64];   /**< Value of each hart of the shire */
+    uint64_t neigh[8];   /**< Value of each neighborhood, 4 used */
+} __attribute__((aligned(64))) et_coll_shire_t;
+
+/*! \struct et_coll_mem_t
+    \brief Device memory shared by all the harts of a collectives context.
+*/
+typedef struct et_coll_mem {
+    et_coll_node_t node[ET_COLL_MAX_NODES];
+    uint64_t result;     /**< Result of the last allreduce */
+    uint8_t pad[56];
+    et_coll_shire_t shire[ET_COLL_MAX_SHIRES];
+    uint64_t bcast[2][ET_COLL_BCAST_SIZE / 8U]; /**< Broadcast buffers, used alternately */
+} __attribute__((aligned(64))) et_coll_mem_t;
+
+/*! \struct et_coll_t
+    \brief Per hart handle of a collectives context.
+*/
+typedef struct et_coll {
+    et_coll_mem_t *mem;
+    uint64_t shire_mask; /**< Shires taking part */
+    uint32_t mask_t0;    /**< Minions whose first hart takes part, in every shire */
+    uint32_t mask_t1;    /**< Minions whose second hart takes part, in every shire */
+    uint32_t flb;        /**< First of the ET_COLL_NEIGH_FLBS FLBs used */
+    fcc_t fcc;           /**< FCC used to sleep */
+    uint32_t rank;       /**< Index of the shire among the ones taking part */
+    uint32_t shires;     /**< Number of shires taking part */
+    uint32_t seq;        /**< Broadcasts done, to pick the buffer */
+} et_coll_t;
+
+/*! \fn static inline int32_t et_coll_init(et_coll_t *ctx, et_coll_mem_t *mem, uint64_t shire_mask,
+    uint32_t mask_t0, uint32_t mask_t1, uint32_t flb, fcc_t fcc)
+    \brief Initializes the handle of the calling hart for a collectives context.
+    \param ctx Handle to initialize
+    \param mem Zeroed device memory of the context
+    \param shire_mask Shires taking part, below ET_COLL_MAX_SHIRES
+    \param mask_t0 Minions whose first hart takes part in each shire
+    \param mask_t1 Minions whose second hart takes part in each shire
+    \param flb First FLB used, ET_COLL_NEIGH_FLBS FLBs are used
+    \param fcc FCC used to sleep
+    \return ET_COLL_OPERATION_SUCCESS, ET_COLL_ERROR_INVALID_ARGS or
+            ET_COLL_ERROR_NOT_PARTICIPANT if the calling hart doesn't take part
+*/
+static inline int32_t et_coll_init(et_coll_t *ctx, et_coll_mem_t *mem, uint64_t shire_mask,
+    uint32_t mask_t0, uint32_t mask_t1, uint32_t flb, fcc_t fcc)
+{
+    uint64_t hart_id = get_hart_id();
+    uint64_t shire = hart_id >> 6;
+    uint32_t minion_mask = (hart_id & 1U) ? mask_t1 : mask_t0;
+
+    if ((mem == NULL) || (shire_mask == 0) || ((shire_mask >> ET_COLL_MAX_SHIRES) != 0) ||
+        ((mask_t0 | mask_t1) == 0) || ((flb + ET_COLL_NEIGH_FLBS) > FLB_COUNT))
+    {
+        return ET_COLL_ERROR_INVALID_ARGS;
+    }
+    if ((shire >= ET_COLL_MAX_SHIRES) || !((shire_mask >> shire) & 1U) ||
+        !((minion_mask >> ((hart_id >> 1) & 31U)) & 1U))
+    {
+        return ET_COLL_ERROR_NOT_PARTICIPANT;
+    }
+
+    ctx->mem = mem;
+    ctx->shire_mask = shire_mask;
+    ctx->mask_t0 = mask_t0;
+    ctx->mask_t1 = mask_t1;
+    ctx->flb = flb;
+    ctx->fcc = fcc;
+    ctx->rank = (uint32_t)__builtin_popcountll(shire_mask & ((1ULL << shire) - 1U));
+    ctx->shires = (uint32_t)__builtin_popcountll(shire_mask);
+    ctx->seq = 0;
+
+    return ET_COLL_OPERATION_SUCCESS;
+}
+
+/*! \fn static inline bool et_coll_valid_op(uint64_t op)
+    \brief Checks the reduction is one of the TENSOR_REDUCE_OP supported.
+    \param op TENSOR_REDUCE_OP
+    \return true if supported
+*/
+static inline bool et_coll_valid_op(uint64_t op)
+{
+    return (op == TENSOR_REDUCE_OP_FADD) || (op == TENSOR_REDUCE_OP_FMAX) ||
+           (op == TENSOR_REDUCE_OP_FMIN) || (op == TENSOR_REDUCE_OP_IADD) ||
+           (op == TENSOR_REDUCE_OP_IMAX) || (op == TENSOR_REDUCE_OP_IMIN);
+}
+
+/*! \fn static inline uint32_t et_coll_combine(uint64_t op, uint32_t a, uint32_t b)
+    \brief Combines two values the way TensorReduce does.
+    \param op TENSOR_REDUCE_OP
+    \param a Raw bits of the first value
+    \param b Raw bits of the second value
+    \return Raw bits of the result
+*/
+static inline __attribute__((always_inline)) uint32_t et_coll_combine(
+    uint64_t op, uint32_t a, uint32_t b)
+{
+    union {
+        uint32_t u;
+        int32_t i;
+        float f;
+    } x = { .u = a }, y = { .u = b };
+
+    switch (op)
+    {
+        case TENSOR_REDUCE_OP_FADD:
+            x.f = x.f + y.f;
+            break;
+        case TENSOR_REDUCE_OP_FMAX:
+            x.f = __builtin_fmaxf(x.f, y.f);
+            break;
+        case TENSOR_REDUCE_OP_FMIN:
+            x.f = __builtin_fminf(x.f, y.f);
+            break;
+        case TENSOR_REDUCE_OP_IADD:
+            x.u = x.u + y.u;
+            break;
+        case TENSOR_REDUCE_OP_IMAX:
+            x.i = (x.i > y.i) ? x.i : y.i;
+            break;
+        default:
+            x.i = (x.i < y.i) ? x.i : y.i;
+            break;
+    }
+
+    return x.u;
+}
+
+/*! \fn static inline uint32_t et_coll_tensor_reduce(uint32_t value, uint64_t op, uint64_t height)
+    \brief One TensorReduce step of the tree: minions with bit height set (and
+    the lower ones clear) send, minions with the height + 1 lower bits clear
+    receive and combine.
+    \param value Raw bits of the value of the calling minion
+    \param op TENSOR_REDUCE_OP
+    \param height Step of the tree
+    \return Raw bits of the combined value on receivers
+*/
+static inline __attribute__((always_inline)) uint32_t et_coll_tensor_reduce(
+    uint32_t value, uint64_t op, uint64_t height)
+{
+    uint32_t out;
+    uint64_t csr_enc = ((op & 0xF) << 24) | (1ULL << 16) | ((height & 0xF) << 3) | 3ULL;
+
+    __asm__ __volatile__("fmv.s.x     f0, %[value]\n"
+                         "csrw 0x800, %[csr_enc]\n"
+                         "csrwi tensor_wait, %[wait]\n"
+                         "fmv.x.s     %[out], f0\n"
+                         : [out] "=r"(out)
+                         : [csr_enc] "r"(csr_enc), [value] "r"(value), [wait] "I"(TENSOR_REDUCE_WAIT)
+                         : "f0");
+
+    return out;
+}
+
+/*! \fn static inline uint32_t et_coll_sync(et_coll_t *ctx, uint64_t op, uint32_t value, bool reduce)
+    \brief Arrival and release of every collective, optionally reducing a value.
+    \param ctx Handle of the calling hart
+    \param op TENSOR_REDUCE_OP, when reducing
+    \param value Raw bits of the value of the calling hart, when reducing
+    \param reduce Reduce value over all the harts taking part
+    \return Raw bits of the reduced value, when reducing
+*/
+static inline __attribute__((always_inline)) uint32_t et_coll_sync(
+    et_coll_t *ctx, uint64_t op, uint32_t value, bool reduce)
+{
+    et_coll_mem_t *mem = ctx->mem;
+    uint64_t hart_id = get_hart_id();
+    uint64_t minion = (hart_id >> 1) & 31U;
+    uint64_t neigh = minion >> 3;
+    et_coll_shire_t *shire = &mem->shire[hart_id >> 6];
+    bool leader;
+
+    if (reduce && (ctx->mask_t0 == 0xFFFFFFFFU) && (ctx->mask_t1 == 0))
+    {
+        /* Senders are done once their bit is reached, minion 0 gets the shire value */
+        for (uint64_t height = 0; height < 5U; height++)
+        {
+            value = et_coll_tensor_reduce(value, op, height);
+            if ((minion >> height) & 1U)
+            {
+                break;
+            }
+        }
+        leader = (minion == 0);
+    }
+    else
+    {
+        uint32_t neigh_t0 = (ctx->mask_t0 >> (neigh * 8U)) & 0xFFU;
+        uint32_t neigh_t1 = (ctx->mask_t1 >> (neigh * 8U)) & 0xFFU;
+        uint32_t threads = (uint32_t)(__builtin_popcount(neigh_t0) + __builtin_popcount(neigh_t1));
+
+        if (reduce)
+        {
+            atomic_store_local_64(&shire->hart[hart_id & 63U], value);
+        }
+        FENCE
+        leader = (flbarrier(ctx->flb + neigh, threads - 1U) != 0);
+
+        if (leader)
+        {
+            uint32_t neighs = 0;
+
+            for (uint32_t n = 0; n < 4U; n++)
+            {
+                neighs += (((ctx->mask_t0 | ctx->mask_t1) >> (n * 8U)) & 0xFFU) ? 1U : 0U;
+            }
+            if (reduce)
+            {
+                for (uint64_t i = 0; i < 16U; i++)
+                {
+                    uint64_t mask = (i & 1U) ? neigh_t1 : neigh_t0;
+                    uint64_t slot = (neigh * 16U) + i;
+
+                    if (((mask >> (i >> 1)) & 1U) && (slot != (hart_id & 63U)))
+                    {
+                        value = et_coll_combine(
+                            op, value, (uint32_t)atomic_load_local_64(&shire->hart[slot]));
+                    }
+                }
+                atomic_store_local_64(&shire->neigh[neigh], value);
+            }
+            FENCE
+            leader = (flbarrier(ctx->flb + 4U, neighs - 1U) != 0);
+
+            if (leader && reduce)
+            {
+                for (uint32_t n = 0; n < 4U; n++)
+                {
+                    if ((n != neigh) && (((ctx->mask_t0 | ctx->mask_t1) >> (n * 8U)) & 0xFFU))
+                    {
+                        value = et_coll_combine(
+                            op, value, (uint32_t)atomic_load_local_64(&shire->neigh[n]));
+                    }
+                }
+            }
+        }
+    }
+
+    if (leader)
+    {
+        uint32_t won_node[ET_COLL_MAX_LEVELS];
+        uint32_t won_child[ET_COLL_MAX_LEVELS];
+        uint32_t won_children[ET_COLL_MAX_LEVELS];
+        uint32_t levels = 0;
+        uint32_t idx = ctx->rank;
+        uint32_t count = ctx->shires;
+        uint32_t base = 0;
+        bool root = true;
+
+        /* Climb while being the last one arriving at each node */
+        while (count > 1U)
+        {
+            uint32_t node_idx = base + (idx / ET_COLL_FANOUT);
+            uint32_t child = idx % ET_COLL_FANOUT;
+            uint32_t first = idx - child;
+            uint32_t children =
+                ((count - first) < ET_COLL_FANOUT) ? (count - first) : ET_COLL_FANOUT;
+            et_coll_node_t *node = &mem->node[node_idx];
+
+            if (reduce)
+            {
+                atomic_store_global_64(&node->value[child], value);
+            }
+            atomic_store_global_32(&node->hart[child], (uint32_t)hart_id);
+            FENCE
+            if (atomic_add_global_32(&node->count, 1U) != (children - 1U))
+            {
+                root = false;
+                break;
+            }
+            atomic_store_global_32(&node->count, 0);
+            if (reduce)
+            {
+                for (uint32_t c = 0; c < children; c++)
+                {
+                    if (c != child)
+                    {
+                        value = et_coll_combine(
+                            op, value, (uint32_t)atomic_load_global_64(&node->value[c]));
+                    }
+                }
+            }
+            won_node[levels] = node_idx;
+            won_child[levels] = child;
+            won_children[levels] = children;
+            levels++;
+
+            base += (count + ET_COLL_FANOUT - 1U) / ET_COLL_FANOUT;
+            idx /= ET_COLL_FANOUT;
+            count = (count + ET_COLL_FANOUT - 1U) / ET_COLL_FANOUT;
+        }
+
+        if (root)
+        {
+            if (reduce)
+            {
+                atomic_store_global_64(&mem->result, value);
+            }
+            FENCE
+        }
+        else
+        {
+            wait_fcc(ctx->fcc);
+        }
+
+        /* Release the harts met on the way up, top down, then the own shire */
+        while (levels > 0)
+        {
+            levels--;
+            for (uint32_t c = 0; c < won_children[levels]; c++)
+            {
+                if (c != won_child[levels])
+                {
+                    uint32_t hart = atomic_load_global_32(&mem->node[won_node[levels]].hart[c]);
+                    SEND_FCC(hart >> 6, hart & 1U, ctx->fcc, 1ULL << ((hart >> 1) & 31U));
+                }
+            }
+        }
+        if (ctx->mask_t0 != 0)
+        {
+            SEND_FCC(THIS_SHIRE, THREAD_0, ctx->fcc, ctx->mask_t0);
+        }
+        if (ctx->mask_t1 != 0)
+        {
+            SEND_FCC(THIS_SHIRE, THREAD_1, ctx->fcc, ctx->mask_t1);
+        }
+    }
+    wait_fcc(ctx->fcc);
+
+    return reduce ? (uint32_t)atomic_load_global_64(&mem->result) : 0;
+}
+
+/*! \fn static inline void et_coll_barrier(et_coll_t *ctx)
+    \brief Blocks until all the harts of the context call it.
+    \param ctx Handle of the calling hart
+*/
+static inline void et_coll_barrier(et_coll_t *ctx)
+{
+    et_coll_sync(ctx, 0, 0, false);
+}
+
+/*! \fn static inline int32_t et_coll_allreduce_uint32(et_coll_t *ctx, uint64_t op, uint32_t *value)
+    \brief Reduces an integer over all the harts of the context, all of them get the result.
+    \param ctx Handle of the calling hart
+    \param op TENSOR_REDUCE_OP_IADD, TENSOR_REDUCE_OP_IMAX or TENSOR_REDUCE_OP_IMIN
+    \param value Value of the calling hart, replaced by the result
+    \return ET_COLL_OPERATION_SUCCESS or ET_COLL_ERROR_INVALID_ARGS
+*/
+static inline int32_t et_coll_allreduce_uint32(et_coll_t *ctx, uint64_t op, uint32_t *value)
+{
+    if ((op != TENSOR_REDUCE_OP_IADD) && (op != TENSOR_REDUCE_OP_IMAX) &&
+        (op != TENSOR_REDUCE_OP_IMIN))
+    {
+        return ET_COLL_ERROR_INVALID_ARGS;
+    }
+    *value = et_coll_sync(ctx, op, *value, true);
+
+    return ET_COLL_OPERATION_SUCCESS;
+}
+
+/*! \fn static inline int32_t et_coll_allreduce_float(et_coll_t *ctx, uint64_t op, float *value)
+    \brief Reduces a float over all the harts of the context, all of them get the result.
+    The order of the additions depends on the arrival order.
+    \param ctx Handle of the calling hart
+    \param op TENSOR_REDUCE_OP_FADD, TENSOR_REDUCE_OP_FMAX or TENSOR_REDUCE_OP_FMIN
+    \param value Value of the calling hart, replaced by the result
+    \return ET_COLL_OPERATION_SUCCESS or ET_COLL_ERROR_INVALID_ARGS
+*/
+static inline int32_t et_coll_allreduce_float(et_coll_t *ctx, uint64_t op, float *value)
+{
+    union {
+        uint32_t u;
+        float f;
+    } v = { .f = *value };
+
+    if (!et_coll_valid_op(op) || (op >= TENSOR_REDUCE_OP_IADD))
+    {
+        return ET_COLL_ERROR_INVALID_ARGS;
+    }
+    v.u = et_coll_sync(ctx, op, v.u, true);
+    *value = v.f;
+
+    return ET_COLL_OPERATION_SUCCESS;
+}
+
+/*! \fn static inline int32_t et_coll_broadcast(et_coll_t *ctx, uint64_t root, void *data, uint64_t size)
+    \brief Copies the data of the root hart to all the harts of the context, through
+    a buffer in device memory accessed with global atomics, so it's served by the
+    L2/L3 and no hart reads stale cache lines.
+    \param ctx Handle of the calling hart
+    \param root Hart id of the hart sending, taking part in the context
+    \param data Data to send on the root, buffer to receive on the others, 8 bytes aligned
+    \param size Bytes to send, multiple of 8 up to ET_COLL_BCAST_SIZE
+    \return ET_COLL_OPERATION_SUCCESS or ET_COLL_ERROR_INVALID_ARGS
+*/
+static inline int32_t et_coll_broadcast(et_coll_t *ctx, uint64_t root, void *data, uint64_t size)
+{
+    /* Buffers alternate, so buffer N is only rewritten after everyone passed broadcast N + 1 */
+    uint64_t *buffer = ctx->mem->bcast[ctx->seq & 1U];
+    uint64_t *words = (uint64_t *)data;
+
+    if ((size > ET_COLL_BCAST_SIZE) || ((size & 7U) != 0) || (((uint64_t)data & 7U) != 0))
+    {
+        return ET_COLL_ERROR_INVALID_ARGS;
+    }
+    ctx->seq++;
+
+    if (get_hart_id() == root)
+    {
+        for (uint64_t i = 0; i < (size / 8U); i++)
+        {
+            atomic_store_global_64(&buffer[i], words[i]);
+        }
+    }
+    et_coll_sync(ctx, 0, 0, false);
+    if (get_hart_id() != root)
+    {
+        for (uint64_t i = 0; i < (size / 8U); i++)
+        {
+            words[i] = atomic_load_global_64(&buffer[i]);
+        }
+    }
+
+    return ET_COLL_OPERATION_SUCCESS;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __COLLECTIVES_H */
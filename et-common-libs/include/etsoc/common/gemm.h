@@ -0,0 +1,460 @@
+/*-------------------------------------------------------------------------
+* Copyright (c) 2025 Ainekko, Co.
+* SPDX-License-Identifier: Apache-2.0
+*-------------------------------------------------------------------------
+*/
+/***********************************************************************/
+/*! \file gemm.h
+    \brief A C header only library of tiled GEMM and convolution kernels
+    built on the tensor instructions of tensors.h.
+
+    Each minion computes 16x16 output tiles with TensorFMA, keeping the
+    accumulators in the vector register file (or TenC for int8). Every
+    K step loads a 16 line A tile and a 16 line B tile into the L1
+    scratchpad, B with the interleave TensorLoad the element type needs:
+
+    - fp32: 16 K values per step, B rows loaded as is.
+    - fp16: 32 K values per step, B loaded with interleave16.
+    - int8: 64 K values per step, B loaded with interleave8.
+
+    The scratchpad layout (A double buffered, B single buffered) is derived
+    from ET_GEMM_L1_SCP_LINES at compile time. The functions are always
+    inlined, so the element type and epilogue are folded into each call
+    site, in place of a template.
+
+    The output tiles are split between the minions taking part: rows of
+    tiles between neighborhoods, columns of tiles between the 8 minions of
+    each neighborhood. When all the minions of a neighborhood run the same
+    tile rows, their A tensor loads are cooperative, so each A line is read
+    once per neighborhood instead of once per minion.
+
+    Requirements: M and N multiple of 16, K multiple of the K step, row
+    strides multiple of 64 bytes, buffers 64 bytes aligned, L1 scratchpad
+    enabled and only the first hart of each minion calling in. Cooperative
+    loads need the shire in cooperative mode, which the CM runtime enables
+    for every launch.
+*/
+/***********************************************************************/
+
+#ifndef __GEMM_H
+#define __GEMM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "etsoc/isa/hart.h"
+#include "etsoc/isa/tensors.h"
+
+/*! \def ET_GEMM_L1_SCP_LINES
+    \brief Number of 64 byte lines of the L1 scratchpad of each minion. It can
+    be lowered by kernels keeping their own data in the scratchpad.
+*/
+#ifndef ET_GEMM_L1_SCP_LINES
+#define ET_GEMM_L1_SCP_LINES 48U
+#endif
+
+/*! \def ET_GEMM_TILE_M
+    \brief Rows of each output tile (TensorFMA A rows)
+*/
+#define ET_GEMM_TILE_M 16U
+
+/*! \def ET_GEMM_TILE_N
+    \brief Columns of each output tile (TensorFMA B columns)
+*/
+#define ET_GEMM_TILE_N 16U
+
+/*! \def ET_GEMM_TILE_LINES
+    \brief Scratchpad lines of an A or B tile of one K step
+*/
+#define ET_GEMM_TILE_LINES 16U
+
+/*! \def ET_GEMM_A_BUFFERS
+    \brief A tiles kept in the scratchpad, two to load the next one while
+    TensorFMA reads the current one if they fit
+*/
+#define ET_GEMM_A_BUFFERS                                                                \
+    (((ET_GEMM_L1_SCP_LINES - ET_GEMM_TILE_LINES) / ET_GEMM_TILE_LINES) >= 2U ? 2U : 1U)
+
+_Static_assert(ET_GEMM_L1_SCP_LINES >= (2U * ET_GEMM_TILE_LINES),
+    "GEMM needs at least an A and a B tile in the L1 scratchpad");
+
+/*! \def ET_GEMM_SCP_B
+    \brief First scratchpad line of the B tile, after the A tiles
+*/
+#define ET_GEMM_SCP_B (ET_GEMM_A_BUFFERS * ET_GEMM_TILE_LINES)
+
+/*! \def ET_GEMM_MINIONS_PER_NEIGH
+    \brief Minions sharing the A tiles of a neighborhood
+*/
+#define ET_GEMM_MINIONS_PER_NEIGH 8U
+
+/*! \def ET_GEMM_NEIGHS_PER_SHIRE
+    \brief Neighborhoods of each shire
+*/
+#define ET_GEMM_NEIGHS_PER_SHIRE 4U
+
+/**
+ * @brief Defines for GEMM status codes.
+ */
+#define ET_GEMM_OPERATION_SUCCESS     0
+#define ET_GEMM_ERROR_INVALID_SHAPE   -1
+#define ET_GEMM_ERROR_INVALID_ADDRESS -2
+#define ET_GEMM_ERROR_TENSOR          -3
+
+/*! \enum et_gemm_type_e
+    \brief Element type of A and B, the TensorFMA type encoding
+*/
+typedef enum {
+    ET_GEMM_FP32 = 0,
+    ET_GEMM_FP16 = 1,
+    ET_GEMM_INT8 = 3
+} et_gemm_type_e;
+
+/*! \enum et_gemm_epilogue_e
+    \brief What is done with the accumulators before storing them to C
+*/
+typedef enum {
+    /* Store the fp32 (int32 for int8) accumulators */
+    ET_GEMM_EPILOGUE_NONE = 0,
+    /* int8 only: convert to fp32 and multiply each column by its scale, store fp32 */
+    ET_GEMM_EPILOGUE_DEQUANT,
+    /* Multiply each column by its scale, round and saturate to int8, store int8 */
+    ET_GEMM_EPILOGUE_QUANT_INT8
+} et_gemm_epilogue_e;
+
+/*! \struct et_gemm_conv_t
+    \brief Convolution viewed as a GEMM (implicit GEMM). Input is NHWC and
+    already padded, the filter is [KH][KW][C][OC] and the output NHWC, so
+    A rows are output pixels, K runs over (kh, kw, c) and N over OC.
+    C must be a multiple of the K step and OW of ET_GEMM_TILE_M.
+*/
+typedef struct {
+    uint32_t batch;
+    uint32_t in_h;
+    uint32_t in_w;
+    uint32_t channels;
+    uint32_t kernel_h;
+    uint32_t kernel_w;
+    uint32_t stride;
+    uint32_t out_channels;
+} et_gemm_conv_t;
+
+/*! \struct et_gemm_t
+    \brief Description of C[MxN] = A[MxK] * B[KxN], with row strides in bytes.
+    For convolutions set conv, M, N and K are then derived from it.
+*/
+typedef struct {
+    et_gemm_type_e type;
+    et_gemm_epilogue_e epilogue;
+    bool a_unsigned;
+    bool b_unsigned;
+    uint64_t m;
+    uint64_t n;
+    uint64_t k;
+    const void *a;
+    uint64_t lda;
+    const void *b;
+    uint64_t ldb;
+    void *c;
+    uint64_t ldc;
+    /* N fp32 column scales, 64 bytes aligned, for the quant epilogues */
+    const float *scales;
+    /* Implicit GEMM convolution, NULL for a plain GEMM */
+    const et_gemm_conv_t *conv;
+} et_gemm_t;
+
+/*! \struct et_gemm_workers_t
+    \brief Minions computing a GEMM together. All of them must call et_gemm
+    with the same description.
+*/
+typedef struct {
+    /* First shire taking part */
+    uint32_t first_shire;
+    /* Number of consecutive shires taking part */
+    uint32_t num_shires;
+    /* Use cooperative A loads when the tiles allow it */
+    bool coop_loads;
+} et_gemm_workers_t;
+
+/*! \fn static inline uint64_t et_gemm_elem_size(et_gemm_type_e type)
+    \brief Size in bytes of the A and B elements
+*/
+static inline __attribute__((always_inline)) uint64_t et_gemm_elem_size(et_gemm_type_e type)
+{
+    return (type == ET_GEMM_FP32) ? 4U : ((type == ET_GEMM_FP16) ? 2U : 1U);
+}
+
+/*! \fn static inline uint64_t et_gemm_k_step(et_gemm_type_e type)
+    \brief K values consumed by each TensorFMA, a full A scratchpad line
+*/
+static inline __attribute__((always_inline)) uint64_t et_gemm_k_step(et_gemm_type_e type)
+{
+    return 64U / et_gemm_elem_size(type);
+}
+
+/*! \fn static inline uint64_t et_gemm_ops(const et_gemm_t *gemm)
+    \brief Multiply and add operations (2 per MAC) of a GEMM, for benchmarks
+*/
+static inline uint64_t et_gemm_ops(const et_gemm_t *gemm)
+{
+    return 2U * gemm->m * gemm->n * gemm->k;
+}
+
+/*! \fn static inline void et_gemm_from_conv(et_gemm_t *gemm)
+    \brief Derives the GEMM shape and strides of an implicit GEMM convolution
+*/
+static inline void et_gemm_from_conv(et_gemm_t *gemm)
+{
+    const et_gemm_conv_t *conv = gemm->conv;
+    uint64_t elem_size = et_gemm_elem_size(gemm->type);
+    uint64_t out_h = ((conv->in_h - conv->kernel_h) / conv->stride) + 1U;
+    uint64_t out_w = ((conv->in_w - conv->kernel_w) / conv->stride) + 1U;
+
+    gemm->m = conv->batch * out_h * out_w;
+    gemm->n = conv->out_channels;
+    gemm->k = (uint64_t)conv->kernel_h * conv->kernel_w * conv->channels;
+    gemm->lda = (uint64_t)conv->stride * conv->channels * elem_size;
+    gemm->ldb = conv->out_channels * elem_size;
+}
+
+/*! \fn static inline uint64_t et_gemm_a_address(const et_gemm_t *gemm, uint64_t m0, uint64_t k0)
+    \brief Address of the A tile line of row m0 and column k0. A tile rows
+    are lda bytes apart, for convolutions too since tiles don't cross rows
+    of output pixels.
+*/
+static inline __attribute__((always_inline)) uint64_t et_gemm_a_address(
+    const et_gemm_t *gemm, uint64_t m0, uint64_t k0)
+{
+    uint64_t elem_size = et_gemm_elem_size(gemm->type);
+
+    if (gemm->conv == NULL)
+    {
+        return (uint64_t)gemm->a + (m0 * gemm->lda) + (k0 * elem_size);
+    }
+
+    const et_gemm_conv_t *conv = gemm->conv;
+    uint64_t out_h = ((conv->in_h - conv->kernel_h) / conv->stride) + 1U;
+    uint64_t out_w = ((conv->in_w - conv->kernel_w) / conv->stride) + 1U;
+    uint64_t ow = m0 % out_w;
+    uint64_t oh = (m0 / out_w) % out_h;
+    uint64_t batch = m0 / (out_w * out_h);
+    uint64_t tap = k0 / conv->channels;
+    uint64_t channel = k0 % conv->channels;
+    uint64_t ih = (oh * conv->stride) + (tap / conv->kernel_w);
+    uint64_t iw = (ow * conv->stride) + (tap % conv->kernel_w);
+
+    return (uint64_t)gemm->a +
+           ((((batch * conv->in_h + ih) * conv->in_w + iw) * conv->channels) + channel) * elem_size;
+}
+
+/*! \fn static inline void et_gemm_load_b(const et_gemm_t *gemm, uint64_t k0, uint64_t n0)
+    \brief Loads the B tile of rows k0 and columns n0 in the scratchpad, in the
+    layout TensorFMA expects for the element type
+*/
+static inline __attribute__((always_inline)) void et_gemm_load_b(
+    const et_gemm_t *gemm, uint64_t k0, uint64_t n0)
+{
+    uint64_t col_bytes = n0 * et_gemm_elem_size(gemm->type);
+    uint64_t addr = (uint64_t)gemm->b + (k0 * gemm->ldb) + (col_bytes & ~63ULL);
+
+    if (gemm->type == ET_GEMM_FP32)
+    {
+        tensor_load(false, false, ET_GEMM_SCP_B, 0, 0, addr, 0, ET_GEMM_TILE_LINES - 1U,
+            gemm->ldb, 1);
+    }
+    else if (gemm->type == ET_GEMM_FP16)
+    {
+        /* Each line packs 2 K rows of 16 columns, the offset picks the 32 byte half */
+        tensor_load(false, false, ET_GEMM_SCP_B, 2, 0, addr, (col_bytes & 32U) >> 4,
+            ET_GEMM_TILE_LINES - 1U, gemm->ldb, 1);
+    }
+    else
+    {
+        /* Each line packs 4 K rows of 16 columns, the offset picks the 16 byte quarter */
+        tensor_load(false, false, ET_GEMM_SCP_B, 1, 0, addr, (col_bytes & 63U) >> 4,
+            ET_GEMM_TILE_LINES - 1U, gemm->ldb, 1);
+    }
+}
+
+/*! \fn static inline void et_gemm_store_c(const et_gemm_t *gemm, uint64_t m0, uint64_t n0)
+    \brief Runs the epilogue on the accumulators of a tile and stores it to C
+*/
+static inline __attribute__((always_inline)) void et_gemm_store_c(
+    const et_gemm_t *gemm, uint64_t m0, uint64_t n0)
+{
+    uint64_t out_size = (gemm->epilogue == ET_GEMM_EPILOGUE_QUANT_INT8) ? 1U : 4U;
+    uint64_t addr = (uint64_t)gemm->c + (m0 * gemm->ldc) + (n0 * out_size);
+
+    if (gemm->epilogue != ET_GEMM_EPILOGUE_NONE)
+    {
+        /* The column scales go in the first A buffer, no tensor op reads it anymore */
+        tensor_load(false, false, 0, 0, 0, (uint64_t)gemm->scales + (n0 * 4U), 0, 0, 64, 0);
+        tensor_wait(TENSOR_LOAD_WAIT_0);
+
+        if (gemm->epilogue == ET_GEMM_EPILOGUE_DEQUANT)
+        {
+            tensor_quant(0, 3, ET_GEMM_TILE_M - 1U, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+                QUANT_FP32_MUL_ROW, QUANT_INT32_TO_FP32);
+        }
+        else if (gemm->type == ET_GEMM_INT8)
+        {
+            tensor_quant(0, 3, ET_GEMM_TILE_M - 1U, 0, 0, 0, 0, 0, 0, QUANT_PACK_128B,
+                QUANT_SATINT8, QUANT_FP32_TO_INT32, QUANT_FP32_MUL_ROW, QUANT_INT32_TO_FP32);
+        }
+        else
+        {
+            tensor_quant(0, 3, ET_GEMM_TILE_M - 1U, 0, 0, 0, 0, 0, 0, 0, QUANT_PACK_128B,
+                QUANT_SATINT8, QUANT_FP32_TO_INT32, QUANT_FP32_MUL_ROW);
+        }
+        tensor_wait(TENSOR_QUANT_WAIT);
+    }
+
+    if (gemm->epilogue == ET_GEMM_EPILOGUE_QUANT_INT8)
+    {
+        /* Each row was packed in 16 bytes of its first register */
+        tensor_store(1, 0, 0, ET_GEMM_TILE_M - 1U, addr, 0, gemm->ldc);
+    }
+    else
+    {
+        tensor_store(0, 0, 3, ET_GEMM_TILE_M - 1U, addr, 0, gemm->ldc);
+    }
+    tensor_wait(TENSOR_STORE_WAIT);
+}
+
+/*! \fn static inline void et_gemm_tile(const et_gemm_t *gemm, uint64_t m0, uint64_t n0, uint64_t coop)
+    \brief Computes and stores the output tile of row m0 and column n0
+    \param coop tensor_coop value of the cooperative A loads, 0 if not cooperative
+*/
+static inline __attribute__((always_inline)) void et_gemm_tile(
+    const et_gemm_t *gemm, uint64_t m0, uint64_t n0, uint64_t coop)
+{
+    uint64_t k_step = et_gemm_k_step(gemm->type);
+    uint64_t steps = gemm->k / k_step;
+    bool int8 = (gemm->type == ET_GEMM_INT8);
+
+    if (coop != 0)
+    {
+        tensor_coop(coop);
+    }
+    tensor_load(false, coop != 0, 0, 0, 0, et_gemm_a_address(gemm, m0, 0), 0,
+        ET_GEMM_TILE_LINES - 1U, gemm->lda, 0);
+    et_gemm_load_b(gemm, 0, n0);
+
+    for (uint64_t step = 0; step < steps; step++)
+    {
+        uint64_t a_line = (step % ET_GEMM_A_BUFFERS) * ET_GEMM_TILE_LINES;
+        bool last = ((step + 1U) == steps);
+
+        tensor_wait(TENSOR_LOAD_WAIT_0);
+        tensor_wait(TENSOR_LOAD_WAIT_1);
+
+        /* int8 accumulates in TenC, moved to the registers by the last step */
+        tensor_fma(false, 3, ET_GEMM_TILE_M - 1U, 15, 0, int8 && last, gemm->b_unsigned,
+            gemm->a_unsigned, false, ET_GEMM_SCP_B, a_line, (uint64_t)gemm->type, step == 0);
+
+        /* Load the next A tile while TensorFMA reads this one, if there is room for both */
+        if (!last && (ET_GEMM_A_BUFFERS > 1U))
+        {
+            tensor_load(false, coop != 0, ((step + 1U) % ET_GEMM_A_BUFFERS) * ET_GEMM_TILE_LINES,
+                0, 0, et_gemm_a_address(gemm, m0, (step + 1U) * k_step), 0,
+                ET_GEMM_TILE_LINES - 1U, gemm->lda, 0);
+        }
+        tensor_wait(TENSOR_FMA_WAIT);
+        if (!last)
+        {
+            if (ET_GEMM_A_BUFFERS == 1U)
+            {
+                tensor_load(false, coop != 0, 0, 0, 0,
+                    et_gemm_a_address(gemm, m0, (step + 1U) * k_step), 0, ET_GEMM_TILE_LINES - 1U,
+                    gemm->lda, 0);
+            }
+            et_gemm_load_b(gemm, (step + 1U) * k_step, n0);
+        }
+    }
+
+    et_gemm_store_c(gemm, m0, n0);
+}
+
+/*! \fn static inline int64_t et_gemm(const et_gemm_t *gemm, const et_gemm_workers_t *workers)
+    \brief Computes the part of a GEMM (or implicit GEMM convolution) of the
+    calling minion. Must be called by the first hart of every minion of the
+    shires taking part.
+    \param gemm GEMM description, the same for all the minions
+    \param workers Minions taking part
+    \return ET_GEMM_OPERATION_SUCCESS or a negative ET_GEMM_ERROR code
+*/
+static inline __attribute__((always_inline)) int64_t et_gemm(
+    const et_gemm_t *gemm, const et_gemm_workers_t *workers)
+{
+    et_gemm_t desc = *gemm;
+    uint64_t hart_id = get_hart_id();
+    uint64_t minion = (hart_id >> 1) % (ET_GEMM_MINIONS_PER_NEIGH * ET_GEMM_NEIGHS_PER_SHIRE);
+    uint64_t shire = hart_id >> 6;
+
+    if (desc.conv != NULL)
+    {
+        et_gemm_from_conv(&desc);
+        uint64_t out_w = ((desc.conv->in_w - desc.conv->kernel_w) / desc.conv->stride) + 1U;
+        if (((out_w % ET_GEMM_TILE_M) != 0) ||
+            ((desc.conv->channels % et_gemm_k_step(desc.type)) != 0))
+        {
+            return ET_GEMM_ERROR_INVALID_SHAPE;
+        }
+    }
+    if ((desc.m == 0) || ((desc.m % ET_GEMM_TILE_M) != 0) || ((desc.n % ET_GEMM_TILE_N) != 0) ||
+        (desc.k == 0) || ((desc.k % et_gemm_k_step(desc.type)) != 0) ||
+        ((desc.epilogue == ET_GEMM_EPILOGUE_DEQUANT) && (desc.type != ET_GEMM_INT8)))
+    {
+        return ET_GEMM_ERROR_INVALID_SHAPE;
+    }
+    if ((((uint64_t)desc.a | (uint64_t)desc.b | desc.lda | desc.ldb) & 63U) ||
+        (((uint64_t)desc.c | desc.ldc) & 15U) ||
+        ((desc.epilogue != ET_GEMM_EPILOGUE_NONE) && (((uint64_t)desc.scales & 63U) != 0)))
+    {
+        return ET_GEMM_ERROR_INVALID_ADDRESS;
+    }
+    if ((shire < workers->first_shire) || (shire >= (workers->first_shire + workers->num_shires)) ||
+        (hart_id & 1U))
+    {
+        return ET_GEMM_OPERATION_SUCCESS;
+    }
+
+    /* Rows of tiles go to neighborhoods, columns of tiles to the minions of each one */
+    uint64_t neigh = ((shire - workers->first_shire) * ET_GEMM_NEIGHS_PER_SHIRE) +
+                     (minion / ET_GEMM_MINIONS_PER_NEIGH);
+    uint64_t neighs = workers->num_shires * ET_GEMM_NEIGHS_PER_SHIRE;
+    uint64_t neigh_minion = minion % ET_GEMM_MINIONS_PER_NEIGH;
+    uint64_t tile_rows = desc.m / ET_GEMM_TILE_M;
+    uint64_t tile_cols = desc.n / ET_GEMM_TILE_N;
+    uint64_t coop = 0;
+
+    /* Cooperative loads need every minion of the neighborhood issuing the same A loads */
+    if (workers->coop_loads && ((tile_cols % ET_GEMM_MINIONS_PER_NEIGH) == 0))
+    {
+        uint64_t neigh_in_shire = minion / ET_GEMM_MINIONS_PER_NEIGH;
+        coop = (1ULL << (16U + neigh_in_shire)) | (0xFFULL << 8) | neigh_in_shire;
+    }
+
+    /* tensor_error is never cleared by the hardware */
+    __asm__ __volatile__("csrw 0x808, zero\n");
+
+    for (uint64_t row = neigh; row < tile_rows; row += neighs)
+    {
+        for (uint64_t col = neigh_minion; col < tile_cols; col += ET_GEMM_MINIONS_PER_NEIGH)
+        {
+            et_gemm_tile(&desc, row * ET_GEMM_TILE_M, col * ET_GEMM_TILE_N, coop);
+        }
+    }
+
+    return (get_tensor_error() != 0) ? ET_GEMM_ERROR_TENSOR : ET_GEMM_OPERATION_SUCCESS;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __GEMM_H */
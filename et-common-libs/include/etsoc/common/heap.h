@@ -0,0 +1,243 @@
+/*-------------------------------------------------------------------------
+* Copyright (c) 2025 Ainekko, Co.
+* SPDX-License-Identifier: Apache-2.0
+*-------------------------------------------------------------------------
+*/
+/***********************************************************************/
+/*! \file heap.h
+    \brief A C header only device heap for kernels needing scratch memory
+    whose size is only known on the device, so the host doesn't have to
+    allocate arguments for the worst case.
+
+    The host reserves the kernel heap region and hands it to the MM, which
+    describes it in the kernel environment (kernel_environment_t):
+
+    - The region is split in KERNEL_HEAP_ARENA_COUNT arenas, one per
+      compute shire, so concurrent kernels on disjoint shire masks never
+      share an arena. Harts only allocate from the arena of their shire.
+    - Each arena begins with its allocator state (et_heap_arena_t), only
+      accessed with local atomics, which are performed in the shire L2.
+    - Blocks are powers of two, from ET_HEAP_MIN_BLOCK_SIZE bytes, and are
+      cache line aligned. Freed blocks are kept in a lock-free list per
+      size, and are taken again before bumping the top of the arena.
+      List heads hold a tag changed on every update, to avoid ABA.
+    - The arenas are reset at kernel completion, by the runtime, so the
+      blocks not freed by a kernel are not leaked to the next one.
+
+    Blocks are freed with their allocation size, as there is no per block
+    header. et_heap_free evicts the block to L2 before listing it, so the
+    next hart taking it doesn't get its lines overwritten from the L1 of
+    the previous owner. Blocks can't be passed between shires.
+*/
+/***********************************************************************/
+
+#ifndef __HEAP_H
+#define __HEAP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "etsoc/isa/atomic.h"
+#include "etsoc/isa/cacheops-umode.h"
+#include "etsoc/isa/hart.h"
+#include "etsoc/isa/utils.h"
+#include "system/abi.h"
+
+/*! \def ET_HEAP_MIN_BLOCK_SIZE
+    \brief Size of the smallest block, a cache line
+*/
+#define ET_HEAP_MIN_BLOCK_SIZE 64U
+
+/*! \def ET_HEAP_CLASS_COUNT
+    \brief Number of block sizes, from ET_HEAP_MIN_BLOCK_SIZE to 2GB
+*/
+#define ET_HEAP_CLASS_COUNT 26U
+
+/*! \def ET_HEAP_OFFSET_MASK
+    \brief Offset in the arena of the first block of a list, bits 0-39 of its head
+*/
+#define ET_HEAP_OFFSET_MASK 0xFFFFFFFFFFULL
+
+/*! \def ET_HEAP_TAG_INC
+    \brief Increment of the tag of a list head, in bits 40-63
+*/
+#define ET_HEAP_TAG_INC (1ULL << 40)
+
+/*! \def ET_HEAP_EVICT_CHUNK
+    \brief Bytes evicted by each cache op, which takes a 4 bit line count
+*/
+#define ET_HEAP_EVICT_CHUNK (8U * 64U)
+
+/*! \struct et_heap_arena_t
+    \brief Allocator state at the beginning of each arena, zeroed when empty.
+*/
+typedef struct et_heap_arena {
+    uint64_t top;                       /**< Bytes bumped after the header */
+    uint64_t free[ET_HEAP_CLASS_COUNT]; /**< Free list head of each block size */
+    uint64_t reserved[5];
+} __attribute__((aligned(64))) et_heap_arena_t;
+
+static_assert(sizeof(et_heap_arena_t) == KERNEL_HEAP_ARENA_HEADER_SIZE,
+    "et_heap_arena_t must match the arena header of the kernel heap ABI");
+
+/*! \fn static inline et_heap_arena_t *et_heap_get_arena(const kernel_environment_t *env)
+    \brief Returns the arena of the shire of the calling hart.
+    \param env Kernel environment
+    \return The arena, or NULL if there is no heap or the hart is not in a compute shire
+*/
+static inline et_heap_arena_t *et_heap_get_arena(const kernel_environment_t *env)
+{
+    uint64_t shire = get_hart_id() >> 6;
+
+    if ((env->heap_base == 0) || (shire >= KERNEL_HEAP_ARENA_COUNT))
+    {
+        return NULL;
+    }
+
+    return (et_heap_arena_t *)(uintptr_t)(env->heap_base + (shire * env->heap_arena_size));
+}
+
+/*! \fn static inline uint32_t et_heap_get_class(size_t size)
+    \brief Returns the block size class of an allocation size.
+    \param size Allocation size in bytes
+    \return Index of the class, ET_HEAP_CLASS_COUNT if it's too big
+*/
+static inline uint32_t et_heap_get_class(size_t size)
+{
+    if (size <= ET_HEAP_MIN_BLOCK_SIZE)
+    {
+        return 0;
+    }
+    if (size > ((uint64_t)ET_HEAP_MIN_BLOCK_SIZE << (ET_HEAP_CLASS_COUNT - 1U)))
+    {
+        return ET_HEAP_CLASS_COUNT;
+    }
+
+    /* Round up to the next power of two, from the smallest block */
+    return (uint32_t)(64 - __builtin_clzll((uint64_t)size - 1U)) - 6U;
+}
+
+/*! \fn static inline void *et_heap_alloc(const kernel_environment_t *env, size_t size)
+    \brief Allocates a cache line aligned block from the arena of the calling hart shire.
+    Lock-free, it can be called by all the harts of the shire at once.
+    \param env Kernel environment
+    \param size Allocation size in bytes
+    \return The block, or NULL if there is no heap or the arena is exhausted
+*/
+static inline void *et_heap_alloc(const kernel_environment_t *env, size_t size)
+{
+    et_heap_arena_t *arena = et_heap_get_arena(env);
+    uint32_t size_class = et_heap_get_class(size);
+    uint64_t block_size = (uint64_t)ET_HEAP_MIN_BLOCK_SIZE << size_class;
+    uint64_t base = (uint64_t)(uintptr_t)arena;
+    uint64_t head;
+    uint64_t top;
+
+    if ((arena == NULL) || (size == 0) || (size_class >= ET_HEAP_CLASS_COUNT))
+    {
+        return NULL;
+    }
+
+    /* Take a freed block of the same size first */
+    head = atomic_load_local_64(&arena->free[size_class]);
+    while ((head & ET_HEAP_OFFSET_MASK) != 0)
+    {
+        uint64_t offset = head & ET_HEAP_OFFSET_MASK;
+        uint64_t next = atomic_load_local_64((volatile uint64_t *)(uintptr_t)(base + offset));
+        uint64_t tag = (head & ~ET_HEAP_OFFSET_MASK) + ET_HEAP_TAG_INC;
+        uint64_t prev =
+            atomic_compare_and_exchange_local_64(&arena->free[size_class], head, tag | next);
+
+        if (prev == head)
+        {
+            return (void *)(uintptr_t)(base + offset);
+        }
+        head = prev;
+    }
+
+    /* Bump the top of the arena, it never goes beyond the end */
+    top = atomic_load_local_64(&arena->top);
+    while ((KERNEL_HEAP_ARENA_HEADER_SIZE + top + block_size) <= env->heap_arena_size)
+    {
+        uint64_t prev =
+            atomic_compare_and_exchange_local_64(&arena->top, top, top + block_size);
+
+        if (prev == top)
+        {
+            return (void *)(uintptr_t)(base + KERNEL_HEAP_ARENA_HEADER_SIZE + top);
+        }
+        top = prev;
+    }
+
+    return NULL;
+}
+
+/*! \fn static inline void et_heap_free(const kernel_environment_t *env, void *ptr, size_t size)
+    \brief Returns a block to the arena of the calling hart shire. It must have been allocated
+    by a hart of the same shire, during the same kernel.
+    \param env Kernel environment
+    \param ptr Block returned by et_heap_alloc, NULL is ignored
+    \param size Size given to et_heap_alloc for the block
+*/
+static inline void et_heap_free(const kernel_environment_t *env, void *ptr, size_t size)
+{
+    et_heap_arena_t *arena = et_heap_get_arena(env);
+    uint32_t size_class = et_heap_get_class(size);
+    uint64_t block_size = (uint64_t)ET_HEAP_MIN_BLOCK_SIZE << size_class;
+    uint64_t offset = (uint64_t)(uintptr_t)ptr - (uint64_t)(uintptr_t)arena;
+    volatile uint64_t *next = ptr;
+    uint64_t head;
+
+    if ((arena == NULL) || (ptr == NULL) || (size == 0) || (size_class >= ET_HEAP_CLASS_COUNT))
+    {
+        return;
+    }
+
+    /* The block stores must reach L2 before another hart can take it */
+    FENCE;
+    for (uint64_t done = 0; done < block_size; done += ET_HEAP_EVICT_CHUNK)
+    {
+        cache_ops_evict(to_L2, (const uint8_t *)ptr + done,
+            ((block_size - done) < ET_HEAP_EVICT_CHUNK) ? (block_size - done) :
+                                                          ET_HEAP_EVICT_CHUNK);
+    }
+    WAIT_CACHEOPS;
+
+    head = atomic_load_local_64(&arena->free[size_class]);
+    for (;;)
+    {
+        uint64_t prev;
+
+        atomic_store_local_64(next, head & ET_HEAP_OFFSET_MASK);
+        prev = atomic_compare_and_exchange_local_64(&arena->free[size_class], head,
+            ((head & ~ET_HEAP_OFFSET_MASK) + ET_HEAP_TAG_INC) | offset);
+        if (prev == head)
+        {
+            break;
+        }
+        head = prev;
+    }
+}
+
+/*! \fn static inline uint64_t et_heap_get_used(const kernel_environment_t *env)
+    \brief Returns the bytes of the arena of the calling hart shire bumped so far, freed
+    blocks included. Useful to size the heap region.
+    \param env Kernel environment
+    \return Bytes used, 0 if there is no heap
+*/
+static inline uint64_t et_heap_get_used(const kernel_environment_t *env)
+{
+    et_heap_arena_t *arena = et_heap_get_arena(env);
+
+    return (arena == NULL) ? 0 : atomic_load_local_64(&arena->top);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __HEAP_H */
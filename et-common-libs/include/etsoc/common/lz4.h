@@ -0,0 +1,145 @@
+/*-------------------------------------------------------------------------
+* Copyright (c) 2025 Ainekko, Co.
+* SPDX-License-Identifier: Apache-2.0
+*-------------------------------------------------------------------------
+*/
+/***********************************************************************/
+/*! \file lz4.h
+    \brief A C header only LZ4 block decompressor, for kernels expanding
+    data the host compressed to save PCIe bandwidth.
+
+    Only the raw block format is decoded (no frame header, no checksums),
+    as produced by LZ4_compress_default() or LZ4F blocks with
+    LZ4F_blockIndependent. Every read and write is bounds checked, a
+    corrupted block fails instead of writing outside of the destination.
+*/
+/***********************************************************************/
+
+#ifndef __LZ4_H
+#define __LZ4_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*! \def ET_LZ4_MIN_MATCH
+    \brief Length of the shortest match, added to the match length of each token
+*/
+#define ET_LZ4_MIN_MATCH 4U
+
+/*! \fn static inline size_t et_lz4_read_length(const uint8_t **src, const uint8_t *src_end, size_t length)
+    \brief Adds the extra bytes of a length whose token nibble is 15.
+    \param src Position in the block, moved past the extra bytes
+    \param src_end End of the block
+    \param length Length from the token nibble
+    \return The length, SIZE_MAX if the block ends before it
+*/
+static inline size_t et_lz4_read_length(const uint8_t **src, const uint8_t *src_end, size_t length)
+{
+    uint8_t byte;
+
+    if (length != 15U)
+    {
+        return length;
+    }
+    do
+    {
+        if (*src >= src_end)
+        {
+            return SIZE_MAX;
+        }
+        byte = *(*src)++;
+        length += byte;
+    } while (byte == 255U);
+
+    return length;
+}
+
+/*! \fn static inline int64_t et_lz4_decompress_block(const void *src, size_t src_size, void *dst, size_t dst_capacity)
+    \brief Decompresses an LZ4 block.
+    \param src Compressed block
+    \param src_size Size of the compressed block
+    \param dst Destination buffer, must not overlap src
+    \param dst_capacity Size of the destination buffer
+    \return Number of bytes written to dst, -1 if the block is corrupted or doesn't fit in dst
+*/
+static inline int64_t et_lz4_decompress_block(const void *src, size_t src_size, void *dst, size_t dst_capacity)
+{
+    const uint8_t *in = (const uint8_t *)src;
+    const uint8_t *in_end = in + src_size;
+    uint8_t *out = (uint8_t *)dst;
+    uint8_t *out_end = out + dst_capacity;
+
+    while (in < in_end)
+    {
+        uint8_t token = *in++;
+        size_t literals = et_lz4_read_length(&in, in_end, token >> 4);
+
+        if ((literals > (size_t)(in_end - in)) || (literals > (size_t)(out_end - out)))
+        {
+            return -1;
+        }
+        for (size_t i = 0; i < literals; ++i)
+        {
+            out[i] = in[i];
+        }
+        in += literals;
+        out += literals;
+
+        /* The last sequence only has literals */
+        if (in == in_end)
+        {
+            break;
+        }
+        if ((in_end - in) < 2)
+        {
+            return -1;
+        }
+
+        size_t offset = (size_t)in[0] | ((size_t)in[1] << 8);
+        in += 2;
+        if ((offset == 0U) || (offset > (size_t)(out - (uint8_t *)dst)))
+        {
+            return -1;
+        }
+        size_t match = et_lz4_read_length(&in, in_end, token & 15U);
+        if (match == SIZE_MAX)
+        {
+            return -1;
+        }
+        match += ET_LZ4_MIN_MATCH;
+        if (match > (size_t)(out_end - out))
+        {
+            return -1;
+        }
+
+        /* The match can overlap the bytes it writes, they are copied in order */
+        const uint8_t *ref = out - offset;
+        if (offset >= 8U)
+        {
+            for (; match >= 8U; match -= 8U, ref += 8, out += 8)
+            {
+                for (size_t i = 0; i < 8U; ++i)
+                {
+                    out[i] = ref[i];
+                }
+            }
+        }
+        for (size_t i = 0; i < match; ++i)
+        {
+            out[i] = ref[i];
+        }
+        out += match;
+    }
+
+    return (int64_t)(out - (uint8_t *)dst);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __LZ4_H */
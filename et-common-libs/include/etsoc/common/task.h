@@ -0,0 +1,449 @@
+/*-------------------------------------------------------------------------
+* Copyright (c) 2025 Ainekko, Co.
+* SPDX-License-Identifier: Apache-2.0
+*-------------------------------------------------------------------------
+*/
+/***********************************************************************/
+/*! \file task.h
+    \brief A C header only work stealing runtime for kernels with irregular
+    work, such as sparse ops or variable length sequences, where the static
+    split of the work by hart id leaves harts idle.
+
+    et_task_parallel_for runs a body over the grains of an iteration range:
+
+    - The grains are first split statically. Each shire gets a share, keeps
+      a reserve of it in its pool and spreads the rest over the deques of
+      its harts, so balanced loops mostly run without stealing.
+    - Each hart takes its grains one by one from the front of its deque.
+      Once it's empty it steals half of the back of another deque of the
+      shire, trying the other hart of its minion first, then the rest of
+      its neighborhood and then the other neighborhoods. Then it refills
+      from the pool of its shire and last steals half of the pool of
+      another shire.
+    - Deques and pools are a single range word, so taking from the front
+      and stealing from the back are one compare and exchange each. Deques
+      are only accessed with local atomics, which are performed in the shire
+      L2, so they stay in the L2 of their shire. Pools are only accessed
+      with global atomics.
+    - Harts that find nothing to steal sleep on their FCC. A hart leaving
+      at least two grains in its deque wakes one of them to steal. The last
+      hart of a shire going to sleep ends the loop for the whole shire.
+
+    The task memory (et_task_mem_t) lives in device memory and must be
+    zeroed before the first loop. Every hart taking part uses its own
+    et_task_t, initialized with the same arguments, and all of them have to
+    run the same loops in the same order. The selected FCC can't be used by
+    the kernel while a loop runs. Loops only join at shire level, kernels
+    needing all the shires done have to add a barrier (see collectives.h).
+*/
+/***********************************************************************/
+
+#ifndef __TASK_H
+#define __TASK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "etsoc/isa/atomic.h"
+#include "etsoc/isa/fcc.h"
+#include "etsoc/isa/hart.h"
+#include "etsoc/isa/utils.h"
+
+/*! \def ET_TASK_MAX_SHIRES
+    \brief Maximum number of compute shires running loops
+*/
+#define ET_TASK_MAX_SHIRES 32U
+
+/*! \def ET_TASK_MAX_GRAINS
+    \brief Maximum number of grains of a loop
+*/
+#define ET_TASK_MAX_GRAINS 0xFFFFFFULL
+
+/*! \def ET_TASK_RESERVE_SHIFT
+    \brief Each shire keeps 1 / (1 << ET_TASK_RESERVE_SHIFT) of its share in its pool
+*/
+#define ET_TASK_RESERVE_SHIFT 2U
+
+/*! \def ET_TASK_RANGE(seq, begin, end)
+    \brief Range word of deques and pools: loop sequence in bits 48-63, first
+    grain in bits 24-47 and end grain in bits 0-23
+*/
+#define ET_TASK_RANGE(seq, begin, end) \
+    ((((uint64_t)(seq) & 0xFFFFU) << 48) | ((uint64_t)(begin) << 24) | (uint64_t)(end))
+
+/*! \def ET_TASK_RANGE_SEQ(range)
+    \brief Loop sequence of a range word
+*/
+#define ET_TASK_RANGE_SEQ(range) ((range) >> 48)
+
+/*! \def ET_TASK_RANGE_BEGIN(range)
+    \brief First grain of a range word
+*/
+#define ET_TASK_RANGE_BEGIN(range) (((range) >> 24) & ET_TASK_MAX_GRAINS)
+
+/*! \def ET_TASK_RANGE_END(range)
+    \brief End grain of a range word
+*/
+#define ET_TASK_RANGE_END(range) ((range) & ET_TASK_MAX_GRAINS)
+
+/**
+ * @brief Defines for task runtime status codes.
+ */
+#define ET_TASK_OPERATION_SUCCESS     0
+#define ET_TASK_ERROR_INVALID_ARGS    -1
+#define ET_TASK_ERROR_NOT_PARTICIPANT -2
+
+/*! \typedef et_task_body_t
+    \brief Body of a loop, runs the iterations [begin, end) of a grain.
+*/
+typedef void (*et_task_body_t)(uint64_t begin, uint64_t end, void *arg);
+
+/*! \struct et_task_shire_t
+    \brief Per shire state, only accessed with local atomics.
+*/
+typedef struct et_task_shire {
+    uint64_t deque[64];  /**< Range word of each hart of the shire */
+    uint64_t sleepers;   /**< Harts of the shire sleeping on their FCC */
+    uint64_t done;       /**< Sequence of the last loop the shire finished */
+} __attribute__((aligned(64))) et_task_shire_t;
+
+/*! \struct et_task_pool_t
+    \brief Per shire reserve of grains, only accessed with global atomics.
+*/
+typedef struct et_task_pool {
+    uint64_t range;      /**< Range word of the reserve */
+} __attribute__((aligned(64))) et_task_pool_t;
+
+/*! \struct et_task_mem_t
+    \brief Device memory shared by all the harts of a task context.
+*/
+typedef struct et_task_mem {
+    et_task_shire_t shire[ET_TASK_MAX_SHIRES];
+    et_task_pool_t pool[ET_TASK_MAX_SHIRES];
+} __attribute__((aligned(64))) et_task_mem_t;
+
+/*! \struct et_task_t
+    \brief Per hart handle of a task context.
+*/
+typedef struct et_task {
+    et_task_mem_t *mem;
+    uint64_t shire_mask;    /**< Shires taking part */
+    uint64_t hart_mask;     /**< Harts taking part, in every shire */
+    uint32_t mask_t0;       /**< Minions whose first hart takes part, in every shire */
+    uint32_t mask_t1;       /**< Minions whose second hart takes part, in every shire */
+    fcc_t fcc;              /**< FCC used to sleep */
+    uint32_t rank;          /**< Index of the shire among the ones taking part */
+    uint32_t shires;        /**< Number of shires taking part */
+    uint32_t harts;         /**< Number of harts taking part in each shire */
+    uint64_t seq;           /**< Loops run */
+    uint64_t local_steals;  /**< Ranges stolen from harts of the shire, in all the loops */
+    uint64_t remote_steals; /**< Ranges stolen from pools of other shires, in all the loops */
+} et_task_t;
+
+/*! \fn static inline int32_t et_task_init(et_task_t *ctx, et_task_mem_t *mem, uint64_t shire_mask,
+    uint32_t mask_t0, uint32_t mask_t1, fcc_t fcc)
+    \brief Initializes the handle of the calling hart for a task context.
+    \param ctx Handle to initialize
+    \param mem Zeroed device memory of the context
+    \param shire_mask Shires taking part, below ET_TASK_MAX_SHIRES
+    \param mask_t0 Minions whose first hart takes part in each shire
+    \param mask_t1 Minions whose second hart takes part in each shire
+    \param fcc FCC used to sleep
+    \return ET_TASK_OPERATION_SUCCESS, ET_TASK_ERROR_INVALID_ARGS or
+            ET_TASK_ERROR_NOT_PARTICIPANT if the calling hart doesn't take part
+*/
+static inline int32_t et_task_init(et_task_t *ctx, et_task_mem_t *mem, uint64_t shire_mask,
+    uint32_t mask_t0, uint32_t mask_t1, fcc_t fcc)
+{
+    uint64_t hart_id = get_hart_id();
+    uint64_t shire = hart_id >> 6;
+    uint32_t minion_mask = (hart_id & 1U) ? mask_t1 : mask_t0;
+    uint64_t hart_mask = 0;
+
+    if ((mem == NULL) || (shire_mask == 0) || ((shire_mask >> ET_TASK_MAX_SHIRES) != 0) ||
+        ((mask_t0 | mask_t1) == 0))
+    {
+        return ET_TASK_ERROR_INVALID_ARGS;
+    }
+    if ((shire >= ET_TASK_MAX_SHIRES) || !((shire_mask >> shire) & 1U) ||
+        !((minion_mask >> ((hart_id >> 1) & 31U)) & 1U))
+    {
+        return ET_TASK_ERROR_NOT_PARTICIPANT;
+    }
+
+    for (uint32_t minion = 0; minion < 32U; minion++)
+    {
+        hart_mask |= (uint64_t)((mask_t0 >> minion) & 1U) << (minion * 2U);
+        hart_mask |= (uint64_t)((mask_t1 >> minion) & 1U) << ((minion * 2U) + 1U);
+    }
+
+    ctx->mem = mem;
+    ctx->shire_mask = shire_mask;
+    ctx->hart_mask = hart_mask;
+    ctx->mask_t0 = mask_t0;
+    ctx->mask_t1 = mask_t1;
+    ctx->fcc = fcc;
+    ctx->rank = (uint32_t)__builtin_popcountll(shire_mask & ((1ULL << shire) - 1U));
+    ctx->shires = (uint32_t)__builtin_popcountll(shire_mask);
+    ctx->harts = (uint32_t)__builtin_popcountll(hart_mask);
+    ctx->seq = 0;
+    ctx->local_steals = 0;
+    ctx->remote_steals = 0;
+
+    return ET_TASK_OPERATION_SUCCESS;
+}
+
+/*! \fn static inline bool et_task_take(volatile uint64_t *range, bool global, uint64_t seq,
+    uint64_t min_grains, uint64_t divisor, bool back, uint64_t *begin, uint64_t *end)
+    \brief Takes grains from a range word of the current loop with a compare and exchange,
+    retrying while other harts change it.
+    \param range Range word
+    \param global Access it with global atomics instead of local ones
+    \param seq Sequence of the current loop
+    \param min_grains Grains the range needs to have to take any
+    \param divisor Take 1 / divisor of the grains (at least one), or a single one if 0
+    \param back Take them from the back instead of the front
+    \param begin Returns the first grain taken
+    \param end Returns the end grain taken
+    \return true if grains were taken
+*/
+static inline __attribute__((always_inline)) bool et_task_take(volatile uint64_t *range,
+    bool global, uint64_t seq, uint64_t min_grains, uint64_t divisor, bool back, uint64_t *begin,
+    uint64_t *end)
+{
+    uint64_t value = global ? atomic_load_global_64(range) : atomic_load_local_64(range);
+
+    for (;;)
+    {
+        uint64_t first = ET_TASK_RANGE_BEGIN(value);
+        uint64_t last = ET_TASK_RANGE_END(value);
+        uint64_t take;
+        uint64_t desired;
+        uint64_t prev;
+
+        /* Words of other loops are empty */
+        if ((ET_TASK_RANGE_SEQ(value) != (seq & 0xFFFFU)) || (first >= last) ||
+            ((last - first) < min_grains))
+        {
+            return false;
+        }
+        take = (divisor == 0) ? 1U : ((last - first) / divisor);
+        take = (take == 0) ? 1U : take;
+        desired = back ? ET_TASK_RANGE(seq, first, last - take) :
+                         ET_TASK_RANGE(seq, first + take, last);
+
+        prev = global ? atomic_compare_and_exchange_global_64(range, value, desired) :
+                        atomic_compare_and_exchange_local_64(range, value, desired);
+        if (prev == value)
+        {
+            *begin = back ? (last - take) : first;
+            *end = back ? last : (first + take);
+
+            return true;
+        }
+        value = prev;
+    }
+}
+
+/*! \fn static inline bool et_task_steal(et_task_t *ctx, uint64_t seq, uint64_t *begin,
+    uint64_t *end)
+    \brief Looks for grains once the deque of the calling hart is empty: steals from the
+    harts of the shire, nearest first, refills from the shire pool or steals from the pools
+    of the other shires.
+    \param ctx Handle of the calling hart
+    \param seq Sequence of the current loop
+    \param begin Returns the first grain found
+    \param end Returns the end grain found
+    \return true if grains were found
+*/
+static inline bool et_task_steal(et_task_t *ctx, uint64_t seq, uint64_t *begin, uint64_t *end)
+{
+    et_task_mem_t *mem = ctx->mem;
+    uint64_t hart_id = get_hart_id();
+    uint64_t index = hart_id & 63U;
+    uint64_t shire = hart_id >> 6;
+
+    /* index ^ 1 is the other hart of the minion, index ^ 2..15 the rest of the neighborhood */
+    for (uint64_t k = 1; k < 64U; k++)
+    {
+        uint64_t victim = index ^ k;
+
+        if (((ctx->hart_mask >> victim) & 1U) &&
+            et_task_take(&mem->shire[shire].deque[victim], false, seq, 2U, 2U, true, begin, end))
+        {
+            ctx->local_steals++;
+            return true;
+        }
+    }
+
+    if (et_task_take(&mem->pool[shire].range, true, seq, 1U, 2U * ctx->harts, false, begin, end))
+    {
+        return true;
+    }
+
+    for (uint64_t k = 1; k < ET_TASK_MAX_SHIRES; k++)
+    {
+        uint64_t victim = (shire + k) % ET_TASK_MAX_SHIRES;
+
+        if (((ctx->shire_mask >> victim) & 1U) &&
+            et_task_take(&mem->pool[victim].range, true, seq, 1U, 2U, true, begin, end))
+        {
+            ctx->remote_steals++;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*! \fn static inline void et_task_wake_one(et_task_t *ctx, et_task_shire_t *shire)
+    \brief Wakes one of the sleeping harts of the shire, if any, to steal.
+    \param ctx Handle of the calling hart
+    \param shire Per shire state of the calling hart
+*/
+static inline void et_task_wake_one(et_task_t *ctx, et_task_shire_t *shire)
+{
+    uint64_t sleepers = atomic_load_local_64(&shire->sleepers);
+
+    while (sleepers != 0)
+    {
+        uint64_t bit = sleepers & (~sleepers + 1U);
+        uint64_t prev =
+            atomic_compare_and_exchange_local_64(&shire->sleepers, sleepers, sleepers & ~bit);
+
+        if (prev == sleepers)
+        {
+            uint64_t hart = (uint64_t)__builtin_ctzll(bit);
+
+            SEND_FCC(THIS_SHIRE, hart & 1U, ctx->fcc, 1ULL << (hart >> 1));
+            return;
+        }
+        sleepers = prev;
+    }
+}
+
+/*! \fn static inline bool et_task_sleep(et_task_t *ctx, et_task_shire_t *shire, uint64_t seq)
+    \brief Sleeps the calling hart until it's woken to steal or the loop is done in the shire.
+    The last hart of the shire going to sleep ends the loop and wakes all the others.
+    \param ctx Handle of the calling hart
+    \param shire Per shire state of the calling hart
+    \param seq Sequence of the current loop
+    \return true if the loop is done in the shire
+*/
+static inline bool et_task_sleep(et_task_t *ctx, et_task_shire_t *shire, uint64_t seq)
+{
+    uint64_t hart_id = get_hart_id();
+    uint64_t bit = 1ULL << (hart_id & 63U);
+
+    if ((atomic_or_local_64(&shire->sleepers, bit) | bit) == ctx->hart_mask)
+    {
+        /* Nobody is left to wake, so nobody else can find grains either */
+        uint32_t minion = 1U << ((hart_id >> 1) & 31U);
+        uint32_t mask_t0 = ctx->mask_t0 & ((hart_id & 1U) ? 0xFFFFFFFFU : ~minion);
+        uint32_t mask_t1 = ctx->mask_t1 & ((hart_id & 1U) ? ~minion : 0xFFFFFFFFU);
+
+        atomic_store_local_64(&shire->done, seq);
+        atomic_store_local_64(&shire->sleepers, 0);
+        FENCE
+        if (mask_t0 != 0)
+        {
+            SEND_FCC(THIS_SHIRE, THREAD_0, ctx->fcc, mask_t0);
+        }
+        if (mask_t1 != 0)
+        {
+            SEND_FCC(THIS_SHIRE, THREAD_1, ctx->fcc, mask_t1);
+        }
+
+        return true;
+    }
+    wait_fcc(ctx->fcc);
+
+    return (atomic_load_local_64(&shire->done) == seq);
+}
+
+/*! \fn static inline int32_t et_task_parallel_for(et_task_t *ctx, uint64_t count, uint64_t grain,
+    et_task_body_t body, void *arg)
+    \brief Runs body over the iterations [0, count), in grains of grain iterations, balancing
+    them over all the harts of the context. Returns once all the grains of the shire are done.
+    \param ctx Handle of the calling hart
+    \param count Number of iterations
+    \param grain Iterations of each grain, up to ET_TASK_MAX_GRAINS grains
+    \param body Body of the loop, inlined when constant at the call site
+    \param arg Argument passed to body
+    \return ET_TASK_OPERATION_SUCCESS or ET_TASK_ERROR_INVALID_ARGS
+*/
+static inline __attribute__((always_inline)) int32_t et_task_parallel_for(
+    et_task_t *ctx, uint64_t count, uint64_t grain, et_task_body_t body, void *arg)
+{
+    et_task_mem_t *mem = ctx->mem;
+    uint64_t hart_id = get_hart_id();
+    uint64_t index = hart_id & 63U;
+    et_task_shire_t *shire = &mem->shire[hart_id >> 6];
+    volatile uint64_t *deque = &shire->deque[index];
+    uint64_t grains;
+    uint64_t seq;
+    uint64_t begin;
+    uint64_t end;
+
+    if ((grain == 0) || (body == NULL) || (((count + grain - 1U) / grain) > ET_TASK_MAX_GRAINS))
+    {
+        return ET_TASK_ERROR_INVALID_ARGS;
+    }
+    grains = (count + grain - 1U) / grain;
+    seq = ++ctx->seq;
+
+    /* Static split of the shire share between its pool and the deques of its harts */
+    {
+        uint64_t share_begin = (grains * ctx->rank) / ctx->shires;
+        uint64_t share_end = (grains * (ctx->rank + 1U)) / ctx->shires;
+        uint64_t split = share_end - ((share_end - share_begin) >> ET_TASK_RESERVE_SHIFT);
+        uint64_t k = (uint64_t)__builtin_popcountll(ctx->hart_mask & ((1ULL << index) - 1U));
+
+        atomic_store_local_64(deque,
+            ET_TASK_RANGE(seq, share_begin + (((split - share_begin) * k) / ctx->harts),
+                share_begin + (((split - share_begin) * (k + 1U)) / ctx->harts)));
+        if (k == 0)
+        {
+            atomic_store_global_64(
+                &mem->pool[hart_id >> 6].range, ET_TASK_RANGE(seq, split, share_end));
+        }
+    }
+
+    for (;;)
+    {
+        if (et_task_take(deque, false, seq, 1U, 0U, false, &begin, &end))
+        {
+            uint64_t left = atomic_load_local_64(deque);
+
+            /* Hand the grains left to a sleeping hart while this one runs its grain */
+            if ((atomic_load_local_64(&shire->sleepers) != 0) &&
+                (ET_TASK_RANGE_END(left) >= (ET_TASK_RANGE_BEGIN(left) + 2U)))
+            {
+                et_task_wake_one(ctx, shire);
+            }
+            body(begin * grain, ((end * grain) < count) ? (end * grain) : count, arg);
+        }
+        else if (et_task_steal(ctx, seq, &begin, &end))
+        {
+            /* Nobody else writes an empty deque, thieves need two grains to steal */
+            atomic_store_local_64(deque, ET_TASK_RANGE(seq, begin, end));
+        }
+        else if (et_task_sleep(ctx, shire, seq))
+        {
+            break;
+        }
+    }
+
+    return ET_TASK_OPERATION_SUCCESS;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TASK_H */
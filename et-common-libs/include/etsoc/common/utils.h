@@ -18,6 +18,7 @@ extern "C" {
 
 #include <stddef.h>
 #include "etsoc/drivers/pmu/pmu.h"
+#include "etsoc/isa/cacheops_common.h"
 #include "trace/trace_umode.h"
 
 /*! \def et_printf(fmt, ...)
@@ -70,6 +71,29 @@ void *et_memcpy(void *dest, const void *src, size_t n);
 */
 int et_memcmp(const void *s1, const void *s2, size_t n);
 
+/*! \fn void *et_memcpy_evict(void *dest, const void *src, size_t n, enum cop_dest dest_level)
+    \brief Copies n characters from memory area src to memory area dest, and evicts dest
+    up to dest_level once copied. Useful for results read by other shires or the host, so the
+    copy doesn't keep lines nobody on the shire is going to read again.
+    \param dest This is pointer to the destination buffer
+    \param src This is pointer to the source buffer
+    \param n Number of bytes
+    \param dest_level Cache level the destination is evicted to
+    \return Pointer to destination buffer
+*/
+void *et_memcpy_evict(void *dest, const void *src, size_t n, enum cop_dest dest_level);
+
+/*! \fn void *et_memset_evict(void *s, int c, size_t n, enum cop_dest dest_level)
+    \brief Copies the character c to the first n characters of s, and evicts s up to
+    dest_level once set.
+    \param s Pointer to memory control block
+    \param c The value to be set
+    \param n Number of bytes
+    \param dest_level Cache level the memory is evicted to
+    \return Pointer to memory area s
+*/
+void *et_memset_evict(void *s, int c, size_t n, enum cop_dest dest_level);
+
 /*! \fn size_t et_strlen(const char *str)
     \brief Computes the length of the string str up to, but not including the
     terminating null character.
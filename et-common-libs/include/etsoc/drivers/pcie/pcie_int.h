@@ -48,11 +48,13 @@
 
 /* Interrupt the host via whatever mechanism it has enabled (MSI, MSI-X, or legacy)
  * For MSI and MSI-X, we request multiple interrupt vectors (i.e. one per CQ).
- * The host can give us up to the number of vectors requested. Use pcie_get_int_vecs
- * to determine the number of vectors.
+ * The host can give us up to the number of vectors requested. Use
+ * pcie_get_interrupt_vectors to determine the number of vectors.
  * Returns 0 on success, negative on failure
  */
 int pcie_interrupt_host(uint32_t vec);
+/* Number of interrupt vectors the host enabled, 0 if interrupts are disabled */
+uint32_t pcie_get_interrupt_vectors(void);
 void PCIe_release_pshire_from_reset(void);
 void PCIe_init(bool expect_link_up);
 void pcie_enable_link(void);
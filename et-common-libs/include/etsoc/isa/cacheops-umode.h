@@ -154,6 +154,44 @@ inline int64_t __attribute__((always_inline)) cache_ops_priv_evict_whole_l1_l2(v
     return syscall(SYSCALL_CACHE_OPS_EVICT_WHOLE_L1_L2, 0, 0, 0);
 }
 
+/*! \fn  inline int64_t cache_ops_priv_evict_ranges(enum cop_dest dest,
+         const cache_ops_range_t *ranges, uint64_t count)
+    \brief  This function evicts the cache lines of a list of address ranges up to the provided
+    cache level, and waits for the evictions to complete. Cheaper than evicting a whole cache
+    level when a kernel only needs its outputs to be visible.
+    \param dest  destination cache level
+    \param ranges  address ranges, in host managed DRAM
+    \param count  number of ranges, up to CACHE_OPS_RANGES_MAX
+    \return status of function call, success/error
+    \memops Implementation of cache_ops_priv_evict_ranges api
+    \example cache_ops_priv_evict_ranges.c
+    Example(s) of using cache_ops_priv_evict_ranges api
+*/
+inline int64_t __attribute__((always_inline))
+cache_ops_priv_evict_ranges(enum cop_dest dest, const cache_ops_range_t *ranges, uint64_t count)
+{
+    return syscall(SYSCALL_CACHE_OPS_EVICT_RANGES, (uint64_t)ranges, count, dest);
+}
+
+/*! \fn  inline int64_t cache_ops_priv_flush_ranges(enum cop_dest dest,
+         const cache_ops_range_t *ranges, uint64_t count)
+    \brief  This function flushes the dirty cache lines of a list of address ranges up to the
+    provided cache level, and waits for the flushes to complete. Unlike an eviction, the lines
+    are kept in the caches.
+    \param dest  destination cache level
+    \param ranges  address ranges, in host managed DRAM
+    \param count  number of ranges, up to CACHE_OPS_RANGES_MAX
+    \return status of function call, success/error
+    \memops Implementation of cache_ops_priv_flush_ranges api
+    \example cache_ops_priv_flush_ranges.c
+    Example(s) of using cache_ops_priv_flush_ranges api
+*/
+inline int64_t __attribute__((always_inline))
+cache_ops_priv_flush_ranges(enum cop_dest dest, const cache_ops_range_t *ranges, uint64_t count)
+{
+    return syscall(SYSCALL_CACHE_OPS_FLUSH_RANGES, (uint64_t)ranges, count, dest);
+}
+
 //-------------------------------------------------------------------------------------------------
 //   Instructions available to U-Mode, S-Mode, and M-Mode
 //-------------------------------------------------------------------------------------------------
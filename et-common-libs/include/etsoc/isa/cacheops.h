@@ -156,6 +156,38 @@ inline void __attribute__((always_inline)) flush_va(uint64_t use_tmask, uint64_t
     );
 }
 
+//-------------------------------------------------------------------------------------------------
+//
+// FUNCTION: flush_va_all
+//
+//   This function is a wrapper of flush_va for any number for cache lines. It calls flush_va as
+//   many times as needed to flush all lines
+//
+inline void __attribute__((always_inline)) flush_va_all(uint64_t use_tmask, uint64_t dst,
+    uint64_t addr, uint64_t num_lines, uint64_t stride, uint64_t id)
+{
+    while (num_lines > 15)
+    {
+        flush_va(use_tmask, dst, addr, 15, stride, id);
+        addr += (stride * 16);
+        num_lines -= 15;
+    }
+    flush_va(use_tmask, dst, addr, num_lines, stride, id);
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// FUNCTION: flush
+//
+//   This function flushes all dirty cache lines from address to address+size up to the provided
+//   cache level.
+//
+inline void __attribute__((always_inline))
+flush(enum cop_dest dest, volatile const void *const address, uint64_t size)
+{
+    flush_va_all(0, dest, (uint64_t)address, (((uint64_t)address & 0x3F) + size) >> 6, 64, 0);
+}
+
 //-------------------------------------------------------------------------------------------------
 //
 // FUNCTION: prefetch_va
@@ -7,6 +7,8 @@
 #ifndef __CACHEOPS_COMMON_H
 #define __CACHEOPS_COMMON_H
 
+#include <stdint.h>
+
 /*! \enum cop_dest
     \brief enum representing cache levels.
 */
@@ -17,4 +19,17 @@ enum cop_dest { to_L1 = 0x0ULL, to_L2 = 0x1ULL, to_L3 = 0x2ULL, to_Mem = 0x3ULL
 */
 enum l1d_mode { l1d_shared, l1d_split, l1d_scp };
 
+/*! \def CACHE_OPS_RANGES_MAX
+    \brief Max number of ranges of a range based cache operation syscall.
+*/
+#define CACHE_OPS_RANGES_MAX 64U
+
+/*! \struct cache_ops_range_t
+    \brief Address range of a range based cache operation.
+*/
+typedef struct {
+    uint64_t address; /**< Start of the range, it doesn't need to be line aligned */
+    uint64_t size;    /**< Size of the range in bytes */
+} cache_ops_range_t;
+
 #endif // ! __CACHEOPS_COMMON_H
\ No newline at end of file
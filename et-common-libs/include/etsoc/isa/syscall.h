@@ -25,6 +25,8 @@ extern "C" {
 #define SYSCALL_PMC_SC_SAMPLE               (SYSCALL_UMODE_THRESHOLD + 9)
 #define SYSCALL_PMC_MS_SAMPLE               (SYSCALL_UMODE_THRESHOLD + 10)
 #define SYSCALL_CACHE_OPS_EVICT_WHOLE_L1_L2 (SYSCALL_UMODE_THRESHOLD + 11)
+#define SYSCALL_CACHE_OPS_EVICT_RANGES      (SYSCALL_UMODE_THRESHOLD + 12)
+#define SYSCALL_CACHE_OPS_FLUSH_RANGES      (SYSCALL_UMODE_THRESHOLD + 13)
 #define SYSCALL_UMODE_THRESHOLD_LIMIT       127
 
 /* SYSCALL IDs for syscalls from U-Mode */
@@ -33,8 +35,9 @@ extern "C" {
 #define SYSCALL_SMODE_THRESHOLD_LIMIT 512
 
 /* SYSCALL error codes */
-#define SYSCALL_SUCCESS    0
-#define SYSCALL_INVALID_ID -1
+#define SYSCALL_SUCCESS      0
+#define SYSCALL_INVALID_ID   -1
+#define SYSCALL_INVALID_ARGS -2
 
 /* Kernel return types. Must be kept synced with FW.
 TODO: Need a separate header for it? */
@@ -26,7 +26,7 @@
 /*! \def ABI_VERSION_MINOR
     \brief This is ABI layout version (minor).
 */
-#define ABI_VERSION_MINOR 1
+#define ABI_VERSION_MINOR 2
 
 /*! \def ABI_VERSION_PATCH
     \brief This is ABI layout version (patch).
@@ -52,8 +52,22 @@ typedef struct {
     abi_version_t version; /* Version of the ABI */
     uint64_t shire_mask;   /* Representing all the Compute Shires assigned to the current Kernel */
     uint32_t frequency;    /* Frequency of Minion cores in MHz */
+    uint32_t reserved;
+    uint64_t heap_base;       /* Kernel heap region, 0 if none (see etsoc/common/heap.h) */
+    uint64_t heap_arena_size; /* Size of the arena of each Compute Shire in the heap region */
 } __attribute__((packed, aligned(64))) kernel_environment_t;
 
+/*! \def KERNEL_HEAP_ARENA_COUNT
+    \brief Number of arenas the kernel heap region is split in, one per Compute Shire.
+*/
+#define KERNEL_HEAP_ARENA_COUNT 32U
+
+/*! \def KERNEL_HEAP_ARENA_HEADER_SIZE
+    \brief Size of the allocator state at the beginning of each arena. An arena whose header
+    is all zeros is empty.
+*/
+#define KERNEL_HEAP_ARENA_HEADER_SIZE 256U
+
 /************************/
 /* Compile-time checks  */
 /************************/
@@ -165,8 +165,11 @@
 /*     Worker FW sdata           0x8001400000    0x400000  (4M)      NA     */
 /*     CM-MM Message counter     0x8001800000    0x21000   (132K)    NA     */
 /*     CM SMode Trace CB         0x8001821000    0x20800   (130K)    NA     */
-/*     CM UMode Trace Config     0x8001841800    0x40      (64B)     NA     */
-/*     UNUSED                    0x8001841840    0x1F5C7C0 (~31.36M) NA     */
+/*     CM UMode Trace Config     0x8001841800    0x100     (256B)    NA     */
+/*     CM error rings            0x8001841900    0x21000   (132K)    NA     */
+/*     CM kernel flush ranges    0x8001862900    0x400     (1K)      NA     */
+/*     Master FW snapshot        0x8001863000    0x800000  (8M)      NA     */
+/*     UNUSED                    0x8002063000    0x173B000 (~23.23M) NA     */
 /*     SMODE Stacks end          0x800379E000    0x861000  (8580K)   NA     */
 /*     SMODE Stacks base         0x8003FFF000                        NA     */
 /****************************************************************************/
@@ -189,9 +192,30 @@
 #define CM_SMODE_TRACE_CB_BASEADDR                          (CM_MM_HART_MESSAGE_COUNTER + CM_MM_HART_MESSAGE_COUNTER_SIZE)
 #define CM_SMODE_TRACE_CB_SIZE                              (TRACE_CB_MAX_SIZE * CM_HART_COUNT)
 
-/* CM U-mode Trace config region. */
+/* CM U-mode Trace config region. One config per kernel slot, so kernels running at the same time
+   on different shires don't overwrite each other's config. */
 #define CM_UMODE_TRACE_CFG_BASEADDR                         (CM_SMODE_TRACE_CB_BASEADDR + CM_SMODE_TRACE_CB_SIZE)
-#define CM_UMODE_TRACE_CFG_SIZE                             SIZE_64B
+#define CM_UMODE_TRACE_CFG_SIZE                             (MAX_SIMULTANEOUS_KERNELS * SIZE_64B)
+#define CM_UMODE_TRACE_CFG_SLOT_ADDR(slot)                  (CM_UMODE_TRACE_CFG_BASEADDR + ((uint64_t)(slot) * SIZE_64B))
+
+/* CM error rings. One ring (cm_error_ring_t) per shire with the errors reported by kernels
+   launched in report and continue mode. */
+#define CM_ERROR_RINGS_BASEADDR                             (CM_UMODE_TRACE_CFG_BASEADDR + CM_UMODE_TRACE_CFG_SIZE)
+#define CM_ERROR_RING_SIZE                                  SIZE_4KB
+#define CM_ERROR_RINGS_SIZE                                 (NUM_SHIRES * CM_ERROR_RING_SIZE)
+#define CM_ERROR_RING_ADDR(shire)                           (CM_ERROR_RINGS_BASEADDR + ((uint64_t)(shire) * CM_ERROR_RING_SIZE))
+
+/* CM kernel flush ranges. One list (cm_kernel_flush_ranges_t) per kernel slot, with the output
+   buffers the last hart of the kernel flushes to memory before reporting its completion. */
+#define CM_KERNEL_FLUSH_RANGES_BASEADDR                     (CM_ERROR_RINGS_BASEADDR + CM_ERROR_RINGS_SIZE)
+#define CM_KERNEL_FLUSH_RANGES_SLOT_SIZE                    (4 * SIZE_64B)
+#define CM_KERNEL_FLUSH_RANGES_SIZE                         (MAX_SIMULTANEOUS_KERNELS * CM_KERNEL_FLUSH_RANGES_SLOT_SIZE)
+#define CM_KERNEL_FLUSH_RANGES_SLOT_ADDR(slot)              (CM_KERNEL_FLUSH_RANGES_BASEADDR + ((uint64_t)(slot) * CM_KERNEL_FLUSH_RANGES_SLOT_SIZE))
+
+/* Copy of the verified Master Minion image, kept by the SP to restore it on MM resets
+   without reading and authenticating it from flash again. */
+#define FW_MASTER_SNAPSHOT_BASEADDR                         ALIGN_4K(CM_KERNEL_FLUSH_RANGES_BASEADDR + CM_KERNEL_FLUSH_RANGES_SIZE)
+#define FW_MASTER_SNAPSHOT_SIZE                             SIZE_8MB
 
 /* Stack grows downward, so start from end of the region. */
 #define FW_SMODE_STACK_BASE                                 (LOW_SDATA_SUBREGION_BASE + LOW_SDATA_SUBREGION_SIZE - SIZE_4KB)
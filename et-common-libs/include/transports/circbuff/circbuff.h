@@ -39,7 +39,9 @@ typedef struct __attribute__((__packed__)) circ_buff_cb {
     uint64_t head_offset; /**< Offset of the circular buffer to write data to */
     uint64_t tail_offset; /**< Offset of the circular buffer to read data from */
     uint64_t length;      /**< Total length (in bytes) of the circular buffer */
-    uint64_t pad;         /**< Padding to make the struct 32-bytes aligned */
+    uint64_t notify_threshold; /**< Number of pushed entries to coalesce per consumer
+                                 notification, written by the consumer. 0 or 1
+                                 notifies on each entry */
     uint8_t buffer_ptr[]; /**< Flexible array to access circular buffer memory
                             located just after circ_buff_cb_t */
 } circ_buff_cb_t;
@@ -212,6 +214,23 @@ static inline void Circbuffer_Set_Tail(
     ETSOC_Memory_Write_64(&tail_val, &dest_circ_buff_cb_ptr->tail_offset, flags);
 }
 
+/*! \fn static inline uint64_t Circbuffer_Get_Notify_Threshold(const circ_buff_cb_t *circ_buff_cb_ptr,
+    uint32_t flags)
+    \brief Gets the notification threshold set by the consumer in circular buffer CB.
+    \param [in] circ_buff_cb_ptr: Pointer to circular buffer control block.
+    \param [in] flags: Indicates memory access type
+*/
+static inline uint64_t Circbuffer_Get_Notify_Threshold(
+    const circ_buff_cb_t *circ_buff_cb_ptr, uint32_t flags)
+{
+    uint64_t threshold = 0;
+
+    /* Read the circular buffer CB from memory */
+    ETSOC_Memory_Read_64(&circ_buff_cb_ptr->notify_threshold, &threshold, flags);
+
+    return threshold;
+}
+
 /*! \fn static inline uint64_t Circbuffer_Get_Head(const circ_buff_cb_t *circ_buff_cb_ptr,
     uint32_t flags)
     \brief Gets the head offset value in circular buffer CB.
@@ -89,6 +89,21 @@ typedef enum {
 #define KERNEL_LAUNCH_FLAGS_EVICT_L3_BEFORE_LAUNCH      (1u << 0)
 #define KERNEL_LAUNCH_FLAGS_COMPUTE_KERNEL_TRACE_ENABLE (1u << 1)
 #define KERNEL_LAUNCH_FLAGS_COMPUTE_KERNEL_STACK_CONFIG (1u << 2)
+/* The kernel doesn't use tensor instructions, so it leaves the tensor state as it finds it */
+#define KERNEL_LAUNCH_FLAGS_NO_TENSOR_OPS               (1u << 3)
+/* Repartition the SCP and L2 of the compute shires as given by scp_sets and l2_sets. The
+   partition stays until a later kernel requests a different one */
+#define KERNEL_LAUNCH_FLAGS_SHIRE_CACHE_CONFIG          (1u << 4)
+/* Prefetch KERNEL_LAUNCH_PREFETCH_CODE_LINES lines from the kernel entry into the I-caches */
+#define KERNEL_LAUNCH_FLAGS_PREFETCH_CODE               (1u << 5)
+/* At most 63, the width of the ICACHE_UPREFETCH lines count */
+#define KERNEL_LAUNCH_PREFETCH_CODE_LINES               32U
+/* Report recoverable errors (tensor errors) to the error ring of the shire and let the kernel
+   complete, instead of failing the launch */
+#define KERNEL_LAUNCH_FLAGS_REPORT_AND_CONTINUE         (1u << 6)
+/* Flush the ranges of the kernel slot (CM_KERNEL_FLUSH_RANGES_SLOT_ADDR) to memory once all the
+   harts are done, before reporting the completion */
+#define KERNEL_LAUNCH_FLAGS_FLUSH_RANGES                (1u << 7)
 
 typedef struct {
     uint64_t code_start_address;
@@ -100,7 +115,12 @@ typedef struct {
     uint8_t kw_base_id;
     uint8_t slot_index;
     uint8_t flags;
-    uint8_t pad; /* Padding to make struct 64-bit aligned */
+    uint8_t pad;       /* Padding to make struct 64-bit aligned */
+    uint16_t scp_sets; /* SCP sets per shire cache bank */
+    uint16_t l2_sets;  /* L2 sets per shire cache bank, scp_sets + l2_sets fill the sets below L3 */
+    uint32_t args_shire_stride; /* If not 0, pointer_to_args is an array with a slice of this size
+                                   for each shire of shire_mask, in increasing shire order, and each
+                                   shire gets a pointer to its own slice */
 } __attribute__((packed)) mm_to_cm_message_kernel_params_t;
 
 typedef struct {
@@ -234,7 +254,8 @@ typedef struct {
     uint32_t shire_id;
     uint32_t status;
     uint8_t slot_index;
-    uint8_t pad[7]; /* Padding to make struct 64-bit aligned */
+    uint8_t pad[3];
+    uint32_t reported_errors; /* Errors reported to the shire error rings, the launch continued */
 } __attribute__((packed, aligned(64))) cm_to_mm_message_kernel_launch_completed_t;
 
 ASSERT_CACHE_LINE_CONSTRAINTS(cm_to_mm_message_kernel_launch_completed_t);
@@ -156,7 +156,8 @@ enum sp_mm_msg_e {
     SP2MM_CMD_GET_MM_STATS,
     SP2MM_RSP_GET_MM_STATS,
     SP2MM_CMD_MM_STATS_RUN_CONTROL,
-    SP2MM_RSP_MM_STATS_RUN_CONTROL
+    SP2MM_RSP_MM_STATS_RUN_CONTROL,
+    SP2MM_EVENT_OPERATING_POINT
 };
 
 typedef uint8_t mm2sp_fw_type_e;
@@ -450,6 +451,17 @@ struct sp2mm_mm_stats_run_control_rsp_t {
     int32_t status;
 } __attribute__((aligned(8), packed));
 
+/*! \struct sp2mm_operating_point_event_t
+    \brief SP to MM event sent once the SP changed the Minion operating
+    point, so MM knows the frequency the kernels run at. It has no response.
+*/
+struct sp2mm_operating_point_event_t {
+    struct dev_cmd_hdr_t msg_hdr;
+    uint16_t freq;     /* New Minion frequency in MHz */
+    uint8_t throttled; /* 1 if lowered by a power or thermal throttle */
+    uint8_t pad;
+} __attribute__((aligned(8), packed));
+
 /*! \struct sp2mm_mm_abort_all_cmd_t
     \brief SP to MM command structure for abort command.
 */
@@ -0,0 +1,179 @@
+/***********************************************************************
+*
+* Copyright (c) 2025 Ainekko, Co.
+* SPDX-License-Identifier: Apache-2.0
+*
+************************************************************************/
+/*! \file work_queue.h
+    \brief A C header that defines the device DRAM work queue used by
+    persistent (resident) kernels.
+
+    A persistent kernel is launched once and stays on its shires, pulling
+    work items from a work queue instead of being launched for each item.
+    The queue lives in device DRAM and is filled by a producer which only
+    needs memory writes (e.g. host memcpys to the device, as rt::WorkQueue
+    of the runtime does):
+
+    - The producer writes item p in slot (p % slot_count), payload after
+      the slot header, and only then advances head past p. Slot s can be
+      reused for item p once its done field is (p - slot_count + 1).
+    - Consumer harts claim items in order by advancing tail, run them and
+      complete them writing the slot status and done fields and
+      incrementing completed, so the producer can poll a single counter.
+    - Setting stop makes the consumers return once all the published items
+      have been claimed.
+
+    All the work queue fields are accessed with global atomics, so the
+    consumers never read stale cache lines of slots reused by the producer.
+    Results written by the kernel with regular stores must be evicted
+    (see cache_ops_evict) before completing the item.
+*/
+/***********************************************************************/
+#ifndef WORK_QUEUE_H
+#define WORK_QUEUE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#include "etsoc/isa/atomic.h"
+
+/**
+ * @brief Defines for Work Queue status codes.
+ */
+#define WORK_QUEUE_OPERATION_SUCCESS 0
+#define WORK_QUEUE_ERROR_EMPTY       -1
+#define WORK_QUEUE_ERROR_STOPPED     -2
+
+/*! \struct work_queue_cb_t
+    \brief The work queue control block, at the start of the work queue
+    memory. Producer and consumer fields are kept in separate cache lines.
+*/
+typedef struct work_queue_cb {
+    uint64_t head;        /**< Items published by the producer */
+    uint8_t pad0[56];
+    uint64_t tail;        /**< Items claimed by the consumer harts */
+    uint8_t pad1[56];
+    uint64_t completed;   /**< Items completed by the consumer harts */
+    uint8_t pad2[56];
+    uint64_t stop;        /**< Non zero once the producer won't publish more items */
+    uint32_t slot_count;  /**< Number of slots of the queue */
+    uint32_t slot_size;   /**< Size in bytes of each slot, header included. Multiple of 8 */
+    uint8_t pad3[48];
+    uint8_t slots[];      /**< Flexible array to access the slots located just after the
+                               control block */
+} work_queue_cb_t;
+
+/*! \struct work_queue_slot_t
+    \brief Header of each work queue slot, followed by the item payload.
+*/
+typedef struct work_queue_slot {
+    uint64_t done;        /**< Position + 1 of the last item completed in the slot */
+    int64_t status;       /**< Completion status of that item, written before done */
+    uint64_t payload[];   /**< Item payload, (slot_size - sizeof(work_queue_slot_t)) bytes */
+} work_queue_slot_t;
+
+/*! \def WORK_QUEUE_MEM_SIZE(slot_count, slot_size)
+    \brief Size in bytes of the memory needed by a work queue.
+*/
+#define WORK_QUEUE_MEM_SIZE(slot_count, slot_size) \
+    (sizeof(work_queue_cb_t) + ((uint64_t)(slot_count) * (slot_size)))
+
+/*! \fn static inline work_queue_slot_t *work_queue_get_slot(work_queue_cb_t *wq, uint64_t position)
+    \brief Returns the slot holding the item at the given position.
+    \param wq Pointer to the work queue control block
+    \param position Position of the item
+    \return Pointer to the slot
+*/
+static inline work_queue_slot_t *work_queue_get_slot(work_queue_cb_t *wq, uint64_t position)
+{
+    uint32_t slot_count = atomic_load_global_32(&wq->slot_count);
+    uint32_t slot_size = atomic_load_global_32(&wq->slot_size);
+
+    return (work_queue_slot_t *)(void *)&wq->slots[(position % slot_count) * slot_size];
+}
+
+/*! \fn static inline int32_t work_queue_try_pop(work_queue_cb_t *wq, void *item, uint64_t *position)
+    \brief Claims the next published item, if any, and copies its payload.
+    \param wq Pointer to the work queue control block
+    \param item Buffer of (slot_size - sizeof(work_queue_slot_t)) bytes, 8 bytes aligned
+    \param position Returns the position of the claimed item, to complete it
+    \return WORK_QUEUE_OPERATION_SUCCESS if an item was claimed, WORK_QUEUE_ERROR_EMPTY if there
+            are no items to claim or WORK_QUEUE_ERROR_STOPPED if there won't be more
+*/
+static inline int32_t work_queue_try_pop(work_queue_cb_t *wq, void *item, uint64_t *position)
+{
+    /* Stop must be read before head, the producer sets it after publishing its last item */
+    uint64_t stop = atomic_load_global_64(&wq->stop);
+    asm volatile("fence\n" ::: "memory");
+    uint64_t tail = atomic_load_global_64(&wq->tail);
+
+    while (tail < atomic_load_global_64(&wq->head))
+    {
+        uint64_t prev = atomic_compare_and_exchange_global_64(&wq->tail, tail, tail + 1);
+
+        if (prev == tail)
+        {
+            const work_queue_slot_t *slot = work_queue_get_slot(wq, tail);
+            uint64_t *dst = (uint64_t *)item;
+            uint32_t words =
+                (atomic_load_global_32(&wq->slot_size) - (uint32_t)sizeof(work_queue_slot_t)) / 8U;
+
+            for (uint32_t i = 0; i < words; i++)
+            {
+                dst[i] = atomic_load_global_64(&slot->payload[i]);
+            }
+            *position = tail;
+
+            return WORK_QUEUE_OPERATION_SUCCESS;
+        }
+        /* Another hart claimed it, retry with the next one */
+        tail = prev;
+    }
+
+    return stop ? WORK_QUEUE_ERROR_STOPPED : WORK_QUEUE_ERROR_EMPTY;
+}
+
+/*! \fn static inline int32_t work_queue_pop(work_queue_cb_t *wq, void *item, uint64_t *position)
+    \brief Waits for the next published item, claims it and copies its payload.
+    \param wq Pointer to the work queue control block
+    \param item Buffer of (slot_size - sizeof(work_queue_slot_t)) bytes, 8 bytes aligned
+    \param position Returns the position of the claimed item, to complete it
+    \return WORK_QUEUE_OPERATION_SUCCESS if an item was claimed or WORK_QUEUE_ERROR_STOPPED if
+            the queue was stopped and all its items were claimed
+*/
+static inline int32_t work_queue_pop(work_queue_cb_t *wq, void *item, uint64_t *position)
+{
+    int32_t status;
+
+    do
+    {
+        status = work_queue_try_pop(wq, item, position);
+    } while (status == WORK_QUEUE_ERROR_EMPTY);
+
+    return status;
+}
+
+/*! \fn static inline void work_queue_complete(work_queue_cb_t *wq, uint64_t position, int64_t status)
+    \brief Writes the completion record of a claimed item, releasing its slot to the producer.
+    \param wq Pointer to the work queue control block
+    \param position Position of the item, as returned by work_queue_pop
+    \param status Completion status to report to the producer
+*/
+static inline void work_queue_complete(work_queue_cb_t *wq, uint64_t position, int64_t status)
+{
+    work_queue_slot_t *slot = work_queue_get_slot(wq, position);
+
+    atomic_store_signed_global_64(&slot->status, status);
+    asm volatile("fence\n" ::: "memory");
+    atomic_store_global_64(&slot->done, position + 1);
+    atomic_add_global_64(&wq->completed, 1);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WORK_QUEUE_H */
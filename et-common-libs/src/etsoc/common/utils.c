@@ -1,4 +1,7 @@
+#include <stdint.h>
+
 #include "etsoc/common/utils.h"
+#include "etsoc/isa/cacheops-umode.h"
 #include "etsoc/isa/syscall.h"
 
 #ifdef __clang__
@@ -7,13 +10,78 @@
 #define inhibit_loop_to_libcall __attribute__((__optimize__("-fno-tree-loop-distribute-patterns")))
 #endif
 
+/* Copies and sets run in 64-bit words once the buffers allow it, and in whole cache lines with
+   the vector unit once the destination is cache line aligned. Unaligned heads and tails, and
+   buffers whose misalignment differs, still go byte by byte. */
+#define WORD_SIZE       8U
+#define VECTOR_SIZE     32U
+#define CACHE_LINE_SIZE 64U
+
+/* Cache ops take a 4 bit line count, evict in chunks of 8 lines */
+#define EVICT_CHUNK_SIZE (8U * CACHE_LINE_SIZE)
+
+static inline void copy_cache_line(uint8_t *d, const uint8_t *s)
+{
+    __asm__ __volatile__("flq2 f0, 0(%[s])\n"
+                         "flq2 f1, 32(%[s])\n"
+                         "fsq2 f0, 0(%[d])\n"
+                         "fsq2 f1, 32(%[d])\n"
+                         :
+                         : [s] "r"(s), [d] "r"(d)
+                         : "f0", "f1", "memory");
+}
+
+static inline void evict_range(enum cop_dest dest_level, const void *address, size_t n)
+{
+    const uint8_t *p = address;
+
+    /* The stores must be done before their lines are evicted */
+    FENCE;
+    for (size_t done = 0; done < n; done += EVICT_CHUNK_SIZE)
+    {
+        cache_ops_evict(dest_level, p + done,
+            ((n - done) < EVICT_CHUNK_SIZE) ? (n - done) : EVICT_CHUNK_SIZE);
+    }
+    WAIT_CACHEOPS;
+}
+
 void *inhibit_loop_to_libcall et_memset(void *s, int c, size_t n)
 {
-    unsigned char *p = s;
+    uint8_t *p = s;
+    uint64_t pattern = (uint8_t)c * 0x0101010101010101ULL;
+
+    while ((n > 0) && (((uintptr_t)p & (WORD_SIZE - 1)) != 0))
+    {
+        *p++ = (uint8_t)c;
+        n--;
+    }
+
+    if (n >= WORD_SIZE)
+    {
+        uint64_t *w = (uint64_t *)(void *)p;
+
+        /* Whole cache lines, unrolled so each iteration fills one */
+        for (; n >= CACHE_LINE_SIZE; n -= CACHE_LINE_SIZE, w += CACHE_LINE_SIZE / WORD_SIZE)
+        {
+            w[0] = pattern;
+            w[1] = pattern;
+            w[2] = pattern;
+            w[3] = pattern;
+            w[4] = pattern;
+            w[5] = pattern;
+            w[6] = pattern;
+            w[7] = pattern;
+        }
+        for (; n >= WORD_SIZE; n -= WORD_SIZE)
+        {
+            *w++ = pattern;
+        }
+        p = (uint8_t *)w;
+    }
 
     while (n-- > 0)
     {
-        *p++ = (char)c;
+        *p++ = (uint8_t)c;
     }
 
     return s;
@@ -21,8 +89,42 @@ void *inhibit_loop_to_libcall et_memset(void *s, int c, size_t n)
 
 void *inhibit_loop_to_libcall et_memcpy(void *dest, const void *src, size_t n)
 {
-    const char *s = src;
-    char *d = dest;
+    const uint8_t *s = src;
+    uint8_t *d = dest;
+
+    if ((((uintptr_t)d ^ (uintptr_t)s) & (WORD_SIZE - 1)) == 0)
+    {
+        while ((n > 0) && (((uintptr_t)d & (WORD_SIZE - 1)) != 0))
+        {
+            *d++ = *s++;
+            n--;
+        }
+
+        /* The vector loads and stores need both buffers 32 bytes aligned */
+        if ((((uintptr_t)d ^ (uintptr_t)s) & (VECTOR_SIZE - 1)) == 0)
+        {
+            while ((n >= WORD_SIZE) && (((uintptr_t)d & (CACHE_LINE_SIZE - 1)) != 0))
+            {
+                *(uint64_t *)(void *)d = *(const uint64_t *)(const void *)s;
+                d += WORD_SIZE;
+                s += WORD_SIZE;
+                n -= WORD_SIZE;
+            }
+            for (; n >= CACHE_LINE_SIZE; n -= CACHE_LINE_SIZE)
+            {
+                copy_cache_line(d, s);
+                d += CACHE_LINE_SIZE;
+                s += CACHE_LINE_SIZE;
+            }
+        }
+
+        for (; n >= WORD_SIZE; n -= WORD_SIZE)
+        {
+            *(uint64_t *)(void *)d = *(const uint64_t *)(const void *)s;
+            d += WORD_SIZE;
+            s += WORD_SIZE;
+        }
+    }
 
     while (n)
     {
@@ -33,19 +135,51 @@ void *inhibit_loop_to_libcall et_memcpy(void *dest, const void *src, size_t n)
     return dest;
 }
 
+void *et_memcpy_evict(void *dest, const void *src, size_t n, enum cop_dest dest_level)
+{
+    et_memcpy(dest, src, n);
+    evict_range(dest_level, dest, n);
+
+    return dest;
+}
+
+void *et_memset_evict(void *s, int c, size_t n, enum cop_dest dest_level)
+{
+    et_memset(s, c, n);
+    evict_range(dest_level, s, n);
+
+    return s;
+}
+
 int inhibit_loop_to_libcall et_memcmp(const void *s1, const void *s2, size_t n)
 {
-    const char *p_s1 = s1;
-    const char *p_s2 = s2;
-    unsigned char u1;
-    unsigned char u2;
+    const uint8_t *p_s1 = s1;
+    const uint8_t *p_s2 = s2;
+
+    /* Skip the equal words, the first difference is then found byte by byte */
+    if ((((uintptr_t)p_s1 ^ (uintptr_t)p_s2) & (WORD_SIZE - 1)) == 0)
+    {
+        while ((n > 0) && (((uintptr_t)p_s1 & (WORD_SIZE - 1)) != 0))
+        {
+            if (*p_s1 != *p_s2)
+                return *p_s1 - *p_s2;
+            p_s1++;
+            p_s2++;
+            n--;
+        }
+        while ((n >= WORD_SIZE) &&
+               (*(const uint64_t *)(const void *)p_s1 == *(const uint64_t *)(const void *)p_s2))
+        {
+            p_s1 += WORD_SIZE;
+            p_s2 += WORD_SIZE;
+            n -= WORD_SIZE;
+        }
+    }
 
-    for (size_t count = n; count > 0; count--, p_s1++, p_s2++)
+    for (; n > 0; n--, p_s1++, p_s2++)
     {
-        u1 = *p_s1;
-        u2 = *p_s2;
-        if (u1 != u2)
-            return u1 - u2;
+        if (*p_s1 != *p_s2)
+            return *p_s1 - *p_s2;
     }
 
     return 0;
@@ -126,6 +126,17 @@ static void pcie_cb_init(void)
     ETSOC_RT_MEM_WRITE_32(&PCIE_CB.initialized, temp32);
 }
 
+uint32_t pcie_get_interrupt_vectors(void)
+{
+    /* The first time this function is called, only then initialize the PCIE CB */
+    if(ETSOC_RT_MEM_READ_32(&PCIE_CB.initialized) == 0)
+    {
+        pcie_cb_init();
+    }
+
+    return pcie_cb_get_int_vecs();
+}
+
 int pcie_interrupt_host(uint32_t vec)
 {
     /* The first time this function is called, only then initialize the PCIE CB */
@@ -82,6 +82,21 @@ static inline void io_write_64(volatile uint64_t *addr, uint64_t val)
     const uint8_t *byte_src_ptr = src_ptr;                                                          \
     uint8_t *byte_dest_ptr = dst_ptr;                                                               \
                                                                                                     \
+    /* If 256-bit primitive is available and both addresses have the same 256-bit misalignment,     \
+       read 64-bit words up to the 256-bit boundary so the rest can use the 256-bit primitive */    \
+    if ((length >= 32) && (read_256_available) && !((uintptr_t)byte_src_ptr & 0x7) &&               \
+        (((uintptr_t)byte_src_ptr & 0x1F) == ((uintptr_t)byte_dest_ptr & 0x1F)))                    \
+    {                                                                                               \
+        while ((uintptr_t)byte_src_ptr & 0x1F)                                                      \
+        {                                                                                           \
+            *(uint64_t *)(void *)byte_dest_ptr =                                                    \
+                read_64((const uint64_t *)(const void *)byte_src_ptr);                              \
+            byte_src_ptr += 8;                                                                      \
+            byte_dest_ptr += 8;                                                                     \
+            length -= 8;                                                                            \
+        }                                                                                           \
+    }                                                                                               \
+                                                                                                    \
     /* If 256-bit primitive is available and the addresses are 256-bit aligned */                   \
     if ((length >= 32) && (read_256_available) &&                                                   \
         !((uintptr_t)byte_src_ptr & 0x1F) && !((uintptr_t)byte_dest_ptr & 0x1F))                    \
@@ -10,6 +10,7 @@
 /***********************************************************************/
 
 #include "etsoc/drivers/pmu/pmu.h"
+#include "etsoc/isa/cacheops.h"
 #include "etsoc/isa/etsoc_memory.h"
 #include "etsoc/isa/hart.h"
 #include "etsoc/isa/syscall.h"
@@ -42,6 +43,11 @@ extern size_t et_strlen(const char *str);
 #define ET_TRACE_GET_MSHIRE_COUNTER(id, ms_id)        trace_umode_sample_ms_pmc(id, ms_id)
 #define ET_TRACE_GET_HART_ID()                        get_hart_id()
 #define ET_TRACE_STRING_MAX_SIZE                      128
+#define ET_TRACE_BUFFER_RESERVED(cb, head, size)      trace_umode_buffer_reserved(cb, head, size)
+
+struct trace_control_block_t;
+static inline void trace_umode_buffer_reserved(
+    struct trace_control_block_t *cb, const void *head, uint64_t size);
 
 #define ET_TRACE_ENCODER_IMPL
 
@@ -50,6 +56,102 @@ extern size_t et_strlen(const char *str);
 #include <stdarg.h>
 #include <stdio.h>
 
+/*! \def TRACE_UMODE_LINE_OFFSET
+    \brief Offset of the cache line holding the given buffer offset.
+*/
+#define TRACE_UMODE_LINE_OFFSET(offset) ((offset) & ~((uint32_t)CACHE_LINE_SIZE - 1U))
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       trace_umode_evict_lines
+*
+*   DESCRIPTION
+*
+*       Starts the eviction to L3 of the given buffer lines, without
+*       waiting for it to complete.
+*
+*   INPUTS
+*
+*       address     Address of the first line
+*       num_lines   Number of lines to evict
+*
+*   OUTPUTS
+*
+*       None
+*
+***********************************************************************/
+static inline void trace_umode_evict_lines(uint64_t address, uint32_t num_lines)
+{
+    /* The stores to the lines must be done before they are evicted */
+    asm volatile("fence");
+
+    for (uint32_t line = 0; line < num_lines; line += 16)
+    {
+        uint32_t count = ((num_lines - line) < 16) ? (num_lines - line) : 16;
+
+        evict_va(0, to_L3, address + (line * CACHE_LINE_SIZE), count - 1, CACHE_LINE_SIZE, 0);
+    }
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       trace_umode_buffer_reserved
+*
+*   DESCRIPTION
+*
+*       Called with each reserved trace entry. Once an entry starts in a
+*       new cache line, all the lines before it are complete: they are
+*       evicted to L3 so the trace doesn't take the L1 from the kernel,
+*       and the line after the entry is prefetched so the next entries
+*       don't stall filling it. The flush then only evicts the header and
+*       tail lines.
+*
+*   INPUTS
+*
+*       cb          Trace control block of the hart
+*       head        Start of the reserved entry
+*       size        Size of the reserved entry
+*
+*   OUTPUTS
+*
+*       None
+*
+***********************************************************************/
+static inline void trace_umode_buffer_reserved(
+    struct trace_control_block_t *cb, const void *head, uint64_t size)
+{
+    const uint32_t offset = (uint32_t)((uintptr_t)head - cb->base_per_hart);
+    const uint32_t line = TRACE_UMODE_LINE_OFFSET(offset);
+    uint32_t evicted = cb->evict_offset;
+
+    /* The buffer was reset, it is written again from the start */
+    if (offset < evicted)
+    {
+        evicted = 0;
+    }
+
+    if (line > evicted)
+    {
+        const uint32_t next_line = TRACE_UMODE_LINE_OFFSET(offset + (uint32_t)size - 1U) +
+                                   CACHE_LINE_SIZE;
+
+        trace_umode_evict_lines(
+            cb->base_per_hart + evicted, (line - evicted) / (uint32_t)CACHE_LINE_SIZE);
+
+        if ((next_line + CACHE_LINE_SIZE) <= cb->size_per_hart)
+        {
+            prefetch_va(0, to_L1, cb->base_per_hart + next_line, 0, CACHE_LINE_SIZE, 0);
+        }
+        evicted = line;
+    }
+
+    cb->evict_offset = evicted;
+}
+
 /************************************************************************
 *
 *   FUNCTION
@@ -90,7 +192,15 @@ void et_trace_flush_buffer(void)
             size_header->data_size = cb->offset_per_hart;
         }
 
-        /* Flush the buffer to L3. */
-        ETSOC_MEM_EVICT((uint64_t *)cb->base_per_hart, cb->offset_per_hart, to_L3)
+        /* Flush the header line and the lines not evicted yet to L3 */
+        const uint32_t evicted =
+            (cb->evict_offset > CACHE_LINE_SIZE) ? cb->evict_offset : CACHE_LINE_SIZE;
+
+        ETSOC_MEM_EVICT((uint64_t *)cb->base_per_hart, CACHE_LINE_SIZE, to_L3)
+        if (cb->offset_per_hart > evicted)
+        {
+            ETSOC_MEM_EVICT((uint64_t *)(cb->base_per_hart + evicted),
+                cb->offset_per_hart - evicted, to_L3)
+        }
     }
 }
@@ -49,6 +49,9 @@ int8_t Circbuffer_Init(circ_buff_cb_t *circ_buff_cb_ptr, uint64_t buffer_length,
     /* Set the buffer length */
     circ_buff.length = buffer_length;
 
+    /* Notify the consumer on each entry till it sets a threshold */
+    circ_buff.notify_threshold = 0;
+
     /* Write the circular buffer CB to memory */
     ETSOC_Memory_Write(&circ_buff, circ_buff_cb_ptr, sizeof(circ_buff), flags)
 
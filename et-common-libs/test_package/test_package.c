@@ -61,6 +61,7 @@
 #include <etsoc/isa/utils.h>
 #include <trace/trace_umode.h>
 #include <trace/trace_umode_cb.h>
+#include <transports/work_queue/work_queue.h>
 
 #include <etsoc/common/utils.h>
 #include <etsoc/drivers/pmu/pmu.h>
@@ -11,6 +11,7 @@
 #include <linux/delay.h>
 #include <linux/device.h>
 #include <linux/errno.h>
+#include <linux/eventfd.h>
 #include <linux/fs.h>
 #include <linux/init.h>
 #include <linux/jiffies.h>
@@ -28,9 +29,21 @@
 #include <linux/string.h>
 #include <linux/types.h>
 #include <linux/uaccess.h>
+#include <linux/version.h>
 #include <uapi/linux/pci_regs.h>
 
+// io_uring passthrough of the ops device SQ pushes and CQ pops
+#if (LINUX_VERSION_CODE >= KERNEL_VERSION(6, 0, 0))
+#define ET_URING_CMD
+#if (LINUX_VERSION_CODE >= KERNEL_VERSION(6, 7, 0))
+#include <linux/io_uring/cmd.h>
+#else
+#include <linux/io_uring.h>
+#endif
+#endif
+
 #include "et_dma.h"
+#include "et_dmabuf.h"
 #include "et_event_handler.h"
 #include "et_fw_update.h"
 #include "et_io.h"
@@ -73,6 +86,23 @@ module_param(mgmt_discovery_timeout, uint, 0);
 static uint ops_discovery_timeout = 100;
 module_param(ops_discovery_timeout, uint, 0);
 
+/**
+ * Allows ops device users with CAP_SYS_RAWIO to mmap the SQ/CQ circular buffers
+ * with ETSOC1_IOCTL_MAP_VQS. The commands written directly on the SQs bypass
+ * the driver checks, DMA commands included, so this is disabled by default
+ */
+static bool user_vq;
+module_param(user_vq, bool, 0);
+
+/**
+ * Allows ops device users with CAP_SYS_RAWIO to mmap the host managed DRAM
+ * write-combined at ETSOC1_MMAP_OFFSET_DEVICE_DRAM. The stores through the
+ * mapping reach any address of that DRAM, not only the buffers allocated by
+ * the process, so this is disabled by default
+ */
+static bool user_dram;
+module_param(user_dram, bool, 0);
+
 /* Device bitmap representing initialized device nodes */
 DECLARE_BITMAP(dev_bitmap, ET_MAX_DEVS) = { 0 };
 
@@ -113,16 +143,14 @@ static __poll_t esperanto_pcie_ops_poll(struct file *fp, poll_table *wait)
 
 	poll_wait(fp, &ops->vq_data.vq_common.waitqueue, wait);
 
-	mutex_lock(&ops->vq_data.vq_common.sq_bitmap_mutex);
-	mutex_lock(&ops->vq_data.vq_common.cq_bitmap_mutex);
-
 	mask = 0;
-	// Generate EPOLLOUT event if any SQ has space more than its threshold
+	// Generate EPOLLOUT event if any SQ has space more than its threshold,
+	// the SQ bitmap is updated lock-free
 	if (!bitmap_empty(ops->vq_data.vq_common.sq_bitmap,
 			  ops->vq_data.vq_common.sq_count))
 		mask |= EPOLLOUT;
 
-	mutex_unlock(&ops->vq_data.vq_common.sq_bitmap_mutex);
+	mutex_lock(&ops->vq_data.vq_common.cq_bitmap_mutex);
 
 	// Generate EPOLLIN event if any CQ msg is saved for userspace
 	if (!bitmap_empty(ops->vq_data.vq_common.cq_bitmap,
@@ -134,6 +162,336 @@ static __poll_t esperanto_pcie_ops_poll(struct file *fp, poll_table *wait)
 	return mask;
 }
 
+/**
+ * esperanto_pcie_ops_map_vqs() - Hands over the ops SQs and CQs to user-space
+ * @et_dev: Pointer to struct et_pci_dev
+ * @uinfo: Pointer to struct vq_map_desc in user-space
+ *
+ * Return: 0 on success, negative error on failure
+ */
+static long esperanto_pcie_ops_map_vqs(struct et_pci_dev *et_dev,
+				       struct vq_map_desc __user *uinfo)
+{
+	struct vq_map_desc info;
+	struct eventfd_ctx *cq_eventfd;
+	struct et_vq_common *vq_common = &et_dev->ops.vq_data.vq_common;
+	struct et_mapped_region *vq_region =
+		&et_dev->ops.regions[OPS_MEM_REGION_TYPE_VQ_BUFFER];
+	struct et_mapped_region *intrpt_region =
+		&et_dev->mgmt.regions[MGMT_MEM_REGION_TYPE_VQ_INTRPT_TRG];
+	u64 page_offset;
+	long rv = 0;
+
+	if (!user_vq || !capable(CAP_SYS_RAWIO))
+		return -EPERM;
+
+	if (copy_from_user(&info, uinfo, sizeof(info))) {
+		dev_err(&et_dev->pdev->dev,
+			"map_vqs: failed to copy from user!\n");
+		return -EFAULT;
+	}
+
+	cq_eventfd = eventfd_ctx_fdget(info.eventfd);
+	if (IS_ERR(cq_eventfd))
+		return PTR_ERR(cq_eventfd);
+
+	mutex_lock(&et_dev->ops.init_mutex);
+
+	if (!et_dev->ops.is_initialized) {
+		rv = -ENODEV;
+		goto error_unlock_init_mutex;
+	}
+
+	if (vq_common->user_owned) {
+		rv = -EBUSY;
+		goto error_unlock_init_mutex;
+	}
+
+	// BAR regions may not be page aligned, offsets are relative to the
+	// first mapped page
+	page_offset = offset_in_page(vq_region->io.host_phys_addr);
+	info.vq_buf_size = PAGE_ALIGN(page_offset + vq_region->size);
+	info.sq_offset = page_offset + et_dev->ops.dir_vq.sq_offset;
+	info.cq_offset = page_offset + et_dev->ops.dir_vq.cq_offset;
+	info.sq_size = vq_common->sq_size;
+	info.cq_size = vq_common->cq_size;
+	info.sq_count = vq_common->sq_count;
+	info.cq_count = vq_common->cq_count;
+	info.doorbell_offset =
+		offset_in_page(intrpt_region->io.host_phys_addr +
+			       et_dev->ops.dir_vq.intrpt_trg_offset);
+	info.doorbell_value = vq_common->intrpt_id;
+	info.doorbell_size = vq_common->intrpt_trg_size;
+
+	if (copy_to_user(uinfo, &info, sizeof(info))) {
+		dev_err(&et_dev->pdev->dev,
+			"map_vqs: failed to copy to user!\n");
+		rv = -EFAULT;
+		goto error_unlock_init_mutex;
+	}
+
+	et_vqueue_user_own(&et_dev->ops.vq_data, cq_eventfd);
+	mutex_unlock(&et_dev->ops.init_mutex);
+
+	return 0;
+
+error_unlock_init_mutex:
+	mutex_unlock(&et_dev->ops.init_mutex);
+	eventfd_ctx_put(cq_eventfd);
+
+	return rv;
+}
+
+/**
+ * esperanto_pcie_read_trace_buffer() - Reads a part of a trace buffer region
+ * @et_dev: Pointer to struct et_pci_dev
+ * @uinfo: Pointer to struct trace_read_desc in user-space
+ *
+ * Lets user-space follow a trace buffer by reading its header and then only
+ * the data added since the last read, instead of the whole region.
+ *
+ * Return: Number of bytes read on success, negative error on failure
+ */
+static long esperanto_pcie_read_trace_buffer(struct et_pci_dev *et_dev,
+					     struct trace_read_desc __user *uinfo)
+{
+	struct et_mgmt_dev *mgmt = &et_dev->mgmt;
+	struct trace_read_desc info;
+	struct et_mapped_region *region;
+	void *trace_buf;
+	size_t size;
+
+	if (copy_from_user(&info, uinfo, sizeof(info))) {
+		dev_err(&et_dev->pdev->dev,
+			"read_trace_buffer: failed to copy from user!\n");
+		return -EFAULT;
+	}
+
+	if (!info.buf)
+		return -EINVAL;
+
+	switch (info.trace_type) {
+	case TRACE_BUFFER_SP:
+		region = &mgmt->regions[MGMT_MEM_REGION_TYPE_SPFW_TRACE];
+		break;
+	case TRACE_BUFFER_MM:
+		region = &mgmt->regions[MGMT_MEM_REGION_TYPE_MMFW_TRACE];
+		break;
+	case TRACE_BUFFER_CM:
+		region = &mgmt->regions[MGMT_MEM_REGION_TYPE_CMFW_TRACE];
+		break;
+	case TRACE_BUFFER_SP_STATS:
+		region = &mgmt->regions[MGMT_MEM_REGION_TYPE_SP_STATS];
+		break;
+	case TRACE_BUFFER_MM_STATS:
+		region = &mgmt->regions[MGMT_MEM_REGION_TYPE_MM_STATS];
+		break;
+	default:
+		dev_err(&et_dev->pdev->dev,
+			"read_trace_buffer: invalid trace region type!\n");
+		return -EINVAL;
+	}
+
+	if (!region->is_valid ||
+	    !(region->access.node_access & MEM_REGION_NODE_ACCESSIBLE_MGMT))
+		return -EACCES;
+
+	if (info.offset >= region->size)
+		return 0;
+
+	size = min_t(size_t, info.size, region->size - info.offset);
+	if (!size)
+		return 0;
+
+	trace_buf = kvmalloc(size, GFP_KERNEL);
+	if (!trace_buf)
+		return -ENOMEM;
+
+	et_ioread(region->io.mapped_baseaddr, info.offset, trace_buf, size);
+	if (copy_to_user((char __user __force *)info.buf, trace_buf, size)) {
+		kvfree(trace_buf);
+		dev_err(&et_dev->pdev->dev,
+			"read_trace_buffer: failed to copy to user!\n");
+		return -EFAULT;
+	}
+
+	kvfree(trace_buf);
+	return size;
+}
+
+/**
+ * esperanto_pcie_set_vq_eventfd() - Sets the eventfd signaled on availability
+ * of a CQ or of the SQs
+ * @et_dev: Pointer to struct et_pci_dev
+ * @vq_data: Pointer to struct et_vq_data of mgmt or ops device
+ * @uinfo: Pointer to struct vq_eventfd_desc in user-space
+ *
+ * Return: 0 on success, negative error on failure
+ */
+static long esperanto_pcie_set_vq_eventfd(struct et_pci_dev *et_dev,
+					  struct et_vq_data *vq_data,
+					  struct vq_eventfd_desc __user *uinfo)
+{
+	struct vq_eventfd_desc info;
+	struct eventfd_ctx *eventfd = NULL;
+	long rv;
+
+	if (copy_from_user(&info, uinfo, sizeof(info))) {
+		dev_err(&et_dev->pdev->dev,
+			"set_vq_eventfd: failed to copy from user!\n");
+		return -EFAULT;
+	}
+
+	if (info.eventfd >= 0) {
+		eventfd = eventfd_ctx_fdget(info.eventfd);
+		if (IS_ERR(eventfd))
+			return PTR_ERR(eventfd);
+	}
+
+	rv = et_vqueue_set_eventfd(vq_data, info.type, info.cq_index, eventfd);
+	if (rv && eventfd)
+		eventfd_ctx_put(eventfd);
+
+	return rv;
+}
+
+/**
+ * esperanto_pcie_ops_push_sq() - Forwards a user command on SQ
+ * @et_dev: Pointer to struct et_pci_dev
+ * @cmd_info: Descriptor of ETSOC1_IOCTL_PUSH_SQ
+ *
+ * Return: Number of bytes written on success, negative error on failure
+ */
+static long esperanto_pcie_ops_push_sq(struct et_pci_dev *et_dev,
+				       const struct cmd_desc *cmd_info)
+{
+	struct et_ops_dev *ops = &et_dev->ops;
+
+	if (!cmd_info->cmd || !cmd_info->size ||
+	    cmd_info->flags & CMD_DESC_FLAG_MM_RESET ||
+	    cmd_info->flags & CMD_DESC_FLAG_ETSOC_RESET ||
+	    ((cmd_info->flags & CMD_DESC_FLAG_DMA ||
+	      cmd_info->flags & CMD_DESC_FLAG_P2PDMA ||
+	      cmd_info->flags & CMD_DESC_FLAG_DMA_CHAIN) &&
+	     cmd_info->flags & CMD_DESC_FLAG_HIGH_PRIORITY))
+		return -EINVAL;
+
+	if (cmd_info->flags & CMD_DESC_FLAG_HIGH_PRIORITY) {
+		if (cmd_info->sq_index >= ops->vq_data.vq_common.hp_sq_count)
+			return -EINVAL;
+
+		return et_squeue_copy_from_user(
+			et_dev, false /* ops_dev */,
+			true /* high priority SQ */, cmd_info->sq_index,
+			(char __user __force *)cmd_info->cmd, cmd_info->size);
+	}
+
+	if (cmd_info->sq_index >= ops->vq_data.vq_common.sq_count)
+		return -EINVAL;
+
+	if (cmd_info->flags & CMD_DESC_FLAG_P2PDMA)
+		return et_p2pdma_move_data(et_dev, cmd_info->sq_index,
+					   (char __user __force *)cmd_info->cmd,
+					   cmd_info->size, NULL, 0);
+
+	if (cmd_info->flags & CMD_DESC_FLAG_DMA)
+		return et_dma_move_data(et_dev, cmd_info->sq_index,
+					(char __user __force *)cmd_info->cmd,
+					cmd_info->size, NULL, 0);
+
+	if (cmd_info->flags & CMD_DESC_FLAG_DMA_CHAIN)
+		return et_dma_chain_move_data(
+			et_dev, cmd_info->sq_index,
+			(char __user __force *)cmd_info->cmd, cmd_info->size,
+			NULL, 0);
+
+	return et_squeue_copy_from_user(et_dev, false /* ops_dev */,
+					false /* normal SQ */,
+					cmd_info->sq_index,
+					(char __user __force *)cmd_info->cmd,
+					cmd_info->size);
+}
+
+/**
+ * esperanto_pcie_ops_push_sq_batch() - Forwards several user commands on SQ
+ * with a single device notification
+ * @et_dev: Pointer to struct et_pci_dev
+ * @cmd_batch_info: Descriptor of ETSOC1_IOCTL_PUSH_SQ_BATCH
+ *
+ * Return: Number of bytes written on success, negative error on failure
+ */
+static long
+esperanto_pcie_ops_push_sq_batch(struct et_pci_dev *et_dev,
+				 const struct cmd_batch_desc *cmd_batch_info)
+{
+	struct et_ops_dev *ops = &et_dev->ops;
+
+	// DMA commands need their host addresses translated one by one
+	if (!cmd_batch_info->cmds || !cmd_batch_info->size ||
+	    cmd_batch_info->flags & ~CMD_DESC_FLAG_HIGH_PRIORITY)
+		return -EINVAL;
+
+	if (cmd_batch_info->flags & CMD_DESC_FLAG_HIGH_PRIORITY) {
+		if (cmd_batch_info->sq_index >=
+		    ops->vq_data.vq_common.hp_sq_count)
+			return -EINVAL;
+	} else if (cmd_batch_info->sq_index >=
+		   ops->vq_data.vq_common.sq_count) {
+		return -EINVAL;
+	}
+
+	return et_squeue_copy_batch_from_user(
+		et_dev, false /* ops_dev */,
+		cmd_batch_info->flags & CMD_DESC_FLAG_HIGH_PRIORITY,
+		cmd_batch_info->sq_index,
+		(char __user __force *)cmd_batch_info->cmds,
+		cmd_batch_info->size);
+}
+
+/**
+ * esperanto_pcie_ops_pop_cq() - Pops out a response message from CQ to user
+ * @et_dev: Pointer to struct et_pci_dev
+ * @rsp_info: Descriptor of ETSOC1_IOCTL_POP_CQ
+ *
+ * Return: Number of bytes of the response on success, negative error on
+ * failure
+ */
+static long esperanto_pcie_ops_pop_cq(struct et_pci_dev *et_dev,
+				      const struct rsp_desc *rsp_info)
+{
+	if (rsp_info->cq_index >= et_dev->ops.vq_data.vq_common.cq_count ||
+	    !rsp_info->rsp || !rsp_info->size)
+		return -EINVAL;
+
+	return et_cqueue_copy_to_user(et_dev, false /* ops_dev */,
+				      rsp_info->cq_index,
+				      (char __user __force *)rsp_info->rsp,
+				      rsp_info->size);
+}
+
+/**
+ * esperanto_pcie_ops_pop_cq_batch() - Pops out multiple response messages from
+ * CQ to user
+ * @et_dev: Pointer to struct et_pci_dev
+ * @rsp_batch_info: Descriptor of ETSOC1_IOCTL_POP_CQ_BATCH
+ *
+ * Return: Number of responses popped on success, negative error on failure
+ */
+static long
+esperanto_pcie_ops_pop_cq_batch(struct et_pci_dev *et_dev,
+				const struct rsp_batch_desc *rsp_batch_info)
+{
+	if (rsp_batch_info->cq_index >=
+		    et_dev->ops.vq_data.vq_common.cq_count ||
+	    !rsp_batch_info->rsps || !rsp_batch_info->count)
+		return -EINVAL;
+
+	return et_cqueue_copy_batch_to_user(
+		et_dev, false /* ops_dev */, rsp_batch_info->cq_index,
+		(struct rsp_desc __user __force *)rsp_batch_info->rsps,
+		rsp_batch_info->count);
+}
+
 /**
  * esperanto_pcie_ops_ioctl() - Ops device IOCTLs
  * @cmd: IOCTL commands
@@ -149,16 +507,38 @@ static __poll_t esperanto_pcie_ops_poll(struct file *fp, poll_table *wait)
  * - ETSOC1_IOCTL_GET_TRACE_BUFFER_SIZE: Provies size trace buffer regions
  *   {MM, CM, MM_STATS} if regions defined by device
  * - ETSOC1_IOCTL_GET_SQ_COUNT: Provides ops device SQ count
+ * - ETSOC1_IOCTL_GET_CQ_COUNT: Provides ops device CQ count
  * - ETSOC1_IOCTL_GET_SQ_MAX_MSG_SIZE: Provides ops device SQ size
  * - ETSOC1_IOCTL_GET_DEVICE_CONFIGURATION: Provides general device
  *   configuration received from the device in DIRs
  * - ETSOC1_IOCTL_PUSH_SQ: Forwards user command on SQ
+ * - ETSOC1_IOCTL_PUSH_SQ_BATCH: Forwards several user commands on SQ with a
+ *   single device notification
  * - ETSOC1_IOCTL_POP_CQ: Pops out the response message from CQ to user
+ * - ETSOC1_IOCTL_POP_CQ_BATCH: Pops out multiple response messages from CQ to
+ *   user in a single call
+ * - ETSOC1_IOCTL_REGISTER_HOST_MEM: Pins user memory so it can be used
+ *   directly in DMA list commands. Returns the number of DMA contiguous
+ *   segments backing the memory
+ * - ETSOC1_IOCTL_UNREGISTER_HOST_MEM: Unpins user memory previously pinned,
+ *   or releases a dma-buf previously imported
+ * - ETSOC1_IOCTL_EXPORT_DMABUF: Exports a CMA buffer, or a range of the host
+ *   managed DRAM, as a dma-buf other drivers (e.g. a NIC) can DMA to
+ * - ETSOC1_IOCTL_IMPORT_DMABUF: Imports a dma-buf of another driver so it can
+ *   be used directly in DMA list commands. Returns the number of DMA
+ *   contiguous segments backing the dma-buf
  * - ETSOC1_IOCTL_GET_SQ_AVAIL_BITMAP: Provides SQ availability bitmap
  * - ETSOC1_IOCTL_GET_CQ_AVAIL_BITMAP: Provides CQ availability bitmap
  * - ETSOC1_IOCTL_SET_SQ_THRESHOLD: Sets SQ threshold for SQ availability
  * - ETSOC1_IOCTL_GET_P2PDMA_DEVICE_COMPAT_BITMAP: P2PDMA bitmap for its
  *   compatibility with other devices
+ * - ETSOC1_IOCTL_MAP_VQS: Hands over the SQs (HPSQs excepted) and CQs to
+ *   user-space, which pushes and pops them through mmap(). Needs the user_vq
+ *   module parameter and CAP_SYS_RAWIO
+ * - ETSOC1_IOCTL_TRANSLATE_CMD: Translates the host addresses of a DMA or
+ *   P2PDMA list command for user-space to push it on its own SQ
+ * - ETSOC1_IOCTL_SET_VQ_EVENTFD: Sets an eventfd signaled when a CQ has a
+ *   response to pop or when SQs get space available
  *
  * Return: Non-negative value on success, negative error on failure
  */
@@ -170,7 +550,13 @@ static long esperanto_pcie_ops_ioctl(struct file *fp, unsigned int cmd,
 	struct et_ops_dev *ops;
 	struct dram_info user_dram;
 	struct cmd_desc cmd_info;
+	struct cmd_batch_desc cmd_batch_info;
 	struct rsp_desc rsp_info;
+	struct rsp_batch_desc rsp_batch_info;
+	struct host_mem_desc host_mem_info;
+	struct dmabuf_export_desc dmabuf_export_info;
+	struct dmabuf_import_desc dmabuf_import_info;
+	struct cmd_translate_desc translate_info;
 	struct sq_threshold sq_threshold_info;
 	struct et_mapped_region *region;
 	void __user *usr_arg = (void __user *)arg;
@@ -330,6 +716,17 @@ static long esperanto_pcie_ops_ioctl(struct file *fp, unsigned int cmd,
 
 		break;
 
+	case ETSOC1_IOCTL_GET_CQ_COUNT:
+		if (copy_to_user(usr_arg, &ops->vq_data.vq_common.cq_count,
+				 _IOC_SIZE(cmd))) {
+			dev_err(&et_dev->pdev->dev,
+				"ops_ioctl[%u]: failed to copy to user!\n",
+				_IOC_NR(cmd));
+			return -EFAULT;
+		}
+
+		break;
+
 	case ETSOC1_IOCTL_GET_SQ_MAX_MSG_SIZE:
 		max_size = ops->vq_data.vq_common.sq_size -
 			   sizeof(struct et_circbuffer);
@@ -360,48 +757,18 @@ static long esperanto_pcie_ops_ioctl(struct file *fp, unsigned int cmd,
 			return -EFAULT;
 		}
 
-		if (!cmd_info.cmd || !cmd_info.size ||
-		    cmd_info.flags & CMD_DESC_FLAG_MM_RESET ||
-		    cmd_info.flags & CMD_DESC_FLAG_ETSOC_RESET ||
-		    ((cmd_info.flags & CMD_DESC_FLAG_DMA ||
-		      cmd_info.flags & CMD_DESC_FLAG_P2PDMA) &&
-		     cmd_info.flags & CMD_DESC_FLAG_HIGH_PRIORITY))
-			return -EINVAL;
-
-		if (cmd_info.flags & CMD_DESC_FLAG_HIGH_PRIORITY) {
-			if (cmd_info.sq_index >=
-			    ops->vq_data.vq_common.hp_sq_count)
-				return -EINVAL;
+		rv = esperanto_pcie_ops_push_sq(et_dev, &cmd_info);
+		break;
 
-			rv = et_squeue_copy_from_user(
-				et_dev, false /* ops_dev */,
-				true /* high priority SQ */, cmd_info.sq_index,
-				(char __user __force *)cmd_info.cmd,
-				cmd_info.size);
-		} else {
-			if (cmd_info.sq_index >=
-			    ops->vq_data.vq_common.sq_count)
-				return -EINVAL;
-
-			if (cmd_info.flags & CMD_DESC_FLAG_P2PDMA)
-				rv = et_p2pdma_move_data(
-					et_dev, cmd_info.sq_index,
-					(char __user __force *)cmd_info.cmd,
-					cmd_info.size);
-			else if (cmd_info.flags & CMD_DESC_FLAG_DMA)
-				rv = et_dma_move_data(
-					et_dev, cmd_info.sq_index,
-					(char __user __force *)cmd_info.cmd,
-					cmd_info.size);
-			else
-				rv = et_squeue_copy_from_user(
-					et_dev, false /* ops_dev */,
-					false /* normal SQ */,
-					cmd_info.sq_index,
-					(char __user __force *)cmd_info.cmd,
-					cmd_info.size);
+	case ETSOC1_IOCTL_PUSH_SQ_BATCH:
+		if (copy_from_user(&cmd_batch_info, usr_arg, _IOC_SIZE(cmd))) {
+			dev_err(&et_dev->pdev->dev,
+				"ops_ioctl[%u]: failed to copy from user!\n",
+				_IOC_NR(cmd));
+			return -EFAULT;
 		}
 
+		rv = esperanto_pcie_ops_push_sq_batch(et_dev, &cmd_batch_info);
 		break;
 
 	case ETSOC1_IOCTL_POP_CQ:
@@ -412,14 +779,136 @@ static long esperanto_pcie_ops_ioctl(struct file *fp, unsigned int cmd,
 			return -EFAULT;
 		}
 
-		if (rsp_info.cq_index >= ops->vq_data.vq_common.cq_count ||
-		    !rsp_info.rsp || !rsp_info.size)
+		rv = esperanto_pcie_ops_pop_cq(et_dev, &rsp_info);
+		break;
+
+	case ETSOC1_IOCTL_POP_CQ_BATCH:
+		if (copy_from_user(&rsp_batch_info, usr_arg, _IOC_SIZE(cmd))) {
+			dev_err(&et_dev->pdev->dev,
+				"ops_ioctl[%u]: failed to copy from user!\n",
+				_IOC_NR(cmd));
+			return -EFAULT;
+		}
+
+		rv = esperanto_pcie_ops_pop_cq_batch(et_dev, &rsp_batch_info);
+		break;
+
+	case ETSOC1_IOCTL_REGISTER_HOST_MEM:
+		if (copy_from_user(&host_mem_info, usr_arg, _IOC_SIZE(cmd))) {
+			dev_err(&et_dev->pdev->dev,
+				"ops_ioctl[%u]: failed to copy from user!\n",
+				_IOC_NR(cmd));
+			return -EFAULT;
+		}
+
+		rv = et_dma_pin_user_mem(et_dev, host_mem_info.addr,
+					 host_mem_info.size,
+					 host_mem_info.flags);
+		break;
+
+	case ETSOC1_IOCTL_UNREGISTER_HOST_MEM:
+		if (copy_from_user(&host_mem_info, usr_arg, _IOC_SIZE(cmd))) {
+			dev_err(&et_dev->pdev->dev,
+				"ops_ioctl[%u]: failed to copy from user!\n",
+				_IOC_NR(cmd));
+			return -EFAULT;
+		}
+
+		rv = et_dma_unpin_user_mem(et_dev, host_mem_info.addr);
+		break;
+
+	case ETSOC1_IOCTL_EXPORT_DMABUF:
+		if (copy_from_user(&dmabuf_export_info, usr_arg,
+				   _IOC_SIZE(cmd))) {
+			dev_err(&et_dev->pdev->dev,
+				"ops_ioctl[%u]: failed to copy from user!\n",
+				_IOC_NR(cmd));
+			return -EFAULT;
+		}
+
+		rv = et_dmabuf_export(et_dev, &dmabuf_export_info);
+		if (rv)
+			break;
+
+		// The dma-buf fd stays installed, user-space closes it
+		if (copy_to_user(usr_arg, &dmabuf_export_info,
+				 _IOC_SIZE(cmd))) {
+			dev_err(&et_dev->pdev->dev,
+				"ops_ioctl[%u]: failed to copy to user!\n",
+				_IOC_NR(cmd));
+			rv = -EFAULT;
+		}
+		break;
+
+	case ETSOC1_IOCTL_IMPORT_DMABUF:
+		if (copy_from_user(&dmabuf_import_info, usr_arg,
+				   _IOC_SIZE(cmd))) {
+			dev_err(&et_dev->pdev->dev,
+				"ops_ioctl[%u]: failed to copy from user!\n",
+				_IOC_NR(cmd));
+			return -EFAULT;
+		}
+
+		rv = et_dmabuf_import(et_dev, &dmabuf_import_info);
+		if (rv < 0)
+			break;
+
+		if (copy_to_user(usr_arg, &dmabuf_import_info,
+				 _IOC_SIZE(cmd))) {
+			dev_err(&et_dev->pdev->dev,
+				"ops_ioctl[%u]: failed to copy to user!\n",
+				_IOC_NR(cmd));
+			et_dma_unpin_user_mem(et_dev, dmabuf_import_info.addr);
+			rv = -EFAULT;
+		}
+		break;
+
+	case ETSOC1_IOCTL_MAP_VQS:
+		rv = esperanto_pcie_ops_map_vqs(
+			et_dev, (struct vq_map_desc __user *)usr_arg);
+		break;
+
+	case ETSOC1_IOCTL_TRANSLATE_CMD:
+		if (copy_from_user(&translate_info, usr_arg, _IOC_SIZE(cmd))) {
+			dev_err(&et_dev->pdev->dev,
+				"ops_ioctl[%u]: failed to copy from user!\n",
+				_IOC_NR(cmd));
+			return -EFAULT;
+		}
+
+		// Translated commands are only pushed by user-space on its SQs
+		if (!ops->vq_data.vq_common.user_owned)
+			return -EPERM;
+
+		if (!translate_info.cmd || !translate_info.size ||
+		    !translate_info.out || !translate_info.out_size)
+			return -EINVAL;
+
+		// The queue index is only used to push the command
+		if (translate_info.flags == CMD_DESC_FLAG_P2PDMA)
+			rv = et_p2pdma_move_data(
+				et_dev, 0,
+				(char __user __force *)translate_info.cmd,
+				translate_info.size,
+				(char __user __force *)translate_info.out,
+				translate_info.out_size);
+		else if (translate_info.flags == CMD_DESC_FLAG_DMA)
+			rv = et_dma_move_data(
+				et_dev, 0,
+				(char __user __force *)translate_info.cmd,
+				translate_info.size,
+				(char __user __force *)translate_info.out,
+				translate_info.out_size);
+		else if (translate_info.flags == CMD_DESC_FLAG_DMA_CHAIN)
+			rv = et_dma_chain_move_data(
+				et_dev, 0,
+				(char __user __force *)translate_info.cmd,
+				translate_info.size,
+				(char __user __force *)translate_info.out,
+				translate_info.out_size);
+		else
 			return -EINVAL;
 
-		rv = et_cqueue_copy_to_user(et_dev, false /* ops_dev */,
-					    rsp_info.cq_index,
-					    (char __user __force *)rsp_info.rsp,
-					    rsp_info.size);
 		break;
 
 	case ETSOC1_IOCTL_GET_SQ_AVAIL_BITMAP:
@@ -471,6 +960,10 @@ static long esperanto_pcie_ops_ioctl(struct file *fp, unsigned int cmd,
 
 		break;
 
+	case ETSOC1_IOCTL_SET_VQ_EVENTFD:
+		return esperanto_pcie_set_vq_eventfd(et_dev, &ops->vq_data,
+						     usr_arg);
+
 	case ETSOC1_IOCTL_GET_P2PDMA_DEVICE_COMPAT_BITMAP:
 		dev_compat_bitmap = et_p2pdma_get_compat_bitmap(et_dev->devnum);
 		if (copy_to_user(usr_arg, &dev_compat_bitmap, _IOC_SIZE(cmd))) {
@@ -491,6 +984,85 @@ static long esperanto_pcie_ops_ioctl(struct file *fp, unsigned int cmd,
 	return rv;
 }
 
+#ifdef ET_URING_CMD
+/**
+ * esperanto_pcie_ops_uring_cmd() - Ops device io_uring passthrough
+ * @ioucmd: Pointer to struct io_uring_cmd
+ * @issue_flags: io_uring issue flags
+ *
+ * The SQE cmd_op is ETSOC1_IOCTL_PUSH_SQ, ETSOC1_IOCTL_PUSH_SQ_BATCH,
+ * ETSOC1_IOCTL_POP_CQ or ETSOC1_IOCTL_POP_CQ_BATCH, and the SQE cmd area holds
+ * the descriptor of the IOCTL itself instead of a pointer to it, so several
+ * pushes and pops can be submitted and reaped with a single io_uring_enter().
+ * The CQE res is what the IOCTL would return, except that a full SQ or an
+ * empty CQ completes with -EBUSY: io_uring retries an -EAGAIN from a worker.
+ * DMA and P2PDMA commands, which pin user memory, are punted to a worker when
+ * issued non-blocking
+ *
+ * Return: Non-negative value on success, negative error on failure
+ */
+static int esperanto_pcie_ops_uring_cmd(struct io_uring_cmd *ioucmd,
+					unsigned int issue_flags)
+{
+	struct et_pci_dev *et_dev;
+	struct et_ops_dev *ops;
+	union {
+		struct cmd_desc cmd;
+		struct cmd_batch_desc cmd_batch;
+		struct rsp_desc rsp;
+		struct rsp_batch_desc rsp_batch;
+	} desc;
+	long rv;
+
+	// The cmd area of a 64 bytes SQE is 16 bytes long
+	BUILD_BUG_ON(sizeof(desc) > 16);
+
+	ops = container_of(ioucmd->file->private_data, struct et_ops_dev,
+			   misc_dev);
+	et_dev = container_of(ops, struct et_pci_dev, ops);
+
+	if (ops->is_resetting)
+		return -EUCLEAN;
+	else if (!ops->is_initialized)
+		return -ENODEV;
+
+	// The SQE may still be in memory shared with user-space, read it once
+#if (LINUX_VERSION_CODE < KERNEL_VERSION(6, 6, 0))
+	memcpy(&desc, ioucmd->cmd, sizeof(desc));
+#else
+	memcpy(&desc, io_uring_sqe_cmd(ioucmd->sqe), sizeof(desc));
+#endif
+
+	switch (ioucmd->cmd_op) {
+	case ETSOC1_IOCTL_PUSH_SQ:
+		if (issue_flags & IO_URING_F_NONBLOCK &&
+		    desc.cmd.flags & (CMD_DESC_FLAG_DMA | CMD_DESC_FLAG_P2PDMA |
+				      CMD_DESC_FLAG_DMA_CHAIN))
+			return -EAGAIN;
+
+		rv = esperanto_pcie_ops_push_sq(et_dev, &desc.cmd);
+		break;
+
+	case ETSOC1_IOCTL_PUSH_SQ_BATCH:
+		rv = esperanto_pcie_ops_push_sq_batch(et_dev, &desc.cmd_batch);
+		break;
+
+	case ETSOC1_IOCTL_POP_CQ:
+		rv = esperanto_pcie_ops_pop_cq(et_dev, &desc.rsp);
+		break;
+
+	case ETSOC1_IOCTL_POP_CQ_BATCH:
+		rv = esperanto_pcie_ops_pop_cq_batch(et_dev, &desc.rsp_batch);
+		break;
+
+	default:
+		return -EINVAL;
+	}
+
+	return rv == -EAGAIN ? -EBUSY : rv;
+}
+#endif
+
 /**
  * esperanto_pcie_mgmt_poll() - Mgmt device poll operation
  *
@@ -511,16 +1083,14 @@ static __poll_t esperanto_pcie_mgmt_poll(struct file *fp, poll_table *wait)
 
 	poll_wait(fp, &mgmt->vq_data.vq_common.waitqueue, wait);
 
-	mutex_lock(&mgmt->vq_data.vq_common.sq_bitmap_mutex);
-	mutex_lock(&mgmt->vq_data.vq_common.cq_bitmap_mutex);
-
 	mask = 0;
-	// Generate EPOLLOUT event if any SQ has space more than its threshold
+	// Generate EPOLLOUT event if any SQ has space more than its threshold,
+	// the SQ bitmap is updated lock-free
 	if (!bitmap_empty(mgmt->vq_data.vq_common.sq_bitmap,
 			  mgmt->vq_data.vq_common.sq_count))
 		mask |= EPOLLOUT;
 
-	mutex_unlock(&mgmt->vq_data.vq_common.sq_bitmap_mutex);
+	mutex_lock(&mgmt->vq_data.vq_common.cq_bitmap_mutex);
 
 	// Generate EPOLLIN event if any CQ msg is saved for userspace
 	if (!bitmap_empty(mgmt->vq_data.vq_common.cq_bitmap,
@@ -538,7 +1108,6 @@ static __poll_t esperanto_pcie_mgmt_poll(struct file *fp, poll_table *wait)
 static void esperanto_pcie_vm_open(struct vm_area_struct *vma)
 {
 	struct et_dma_mapping *map = vma->vm_private_data;
-	struct et_pci_dev *et_dev;
 
 	if (!map)
 		return;
@@ -546,18 +1115,7 @@ static void esperanto_pcie_vm_open(struct vm_area_struct *vma)
 	dev_dbg(&map->pdev->dev, "vm_open: %p, [size=%lu,vma=%08lx-%08lx]\n",
 		map, map->size, vma->vm_start, vma->vm_end);
 
-	map->ref_count++;
-	if (map->ref_count == 1) {
-		et_dev = pci_get_drvdata(map->pdev);
-		atomic64_add(
-			map->size,
-			&et_dev->ops.mem_stats
-				 .counters[ET_MEM_COUNTER_STATS_CMA_ALLOCATED]);
-		et_rate_entry_update(
-			map->size,
-			&et_dev->ops.mem_stats
-				 .rates[ET_MEM_RATE_STATS_CMA_ALLOCATION_RATE]);
-	}
+	et_dma_mapping_get(map);
 }
 
 /**
@@ -566,7 +1124,6 @@ static void esperanto_pcie_vm_open(struct vm_area_struct *vma)
 static void esperanto_pcie_vm_close(struct vm_area_struct *vma)
 {
 	struct et_dma_mapping *map = vma->vm_private_data;
-	struct et_pci_dev *et_dev;
 
 	if (!map)
 		return;
@@ -574,18 +1131,7 @@ static void esperanto_pcie_vm_close(struct vm_area_struct *vma)
 	dev_dbg(&map->pdev->dev, "vm_close: %p, [size=%lu,vma=%08lx-%08lx]\n",
 		map, map->size, vma->vm_start, vma->vm_end);
 
-	map->ref_count--;
-	if (map->ref_count == 0) {
-		dma_free_coherent(&map->pdev->dev, map->size, map->kern_vaddr,
-				  map->dma_addr);
-		et_dev = pci_get_drvdata(map->pdev);
-		atomic64_sub(
-			map->size,
-			&et_dev->ops.mem_stats
-				 .counters[ET_MEM_COUNTER_STATS_CMA_ALLOCATED]);
-
-		kfree(map);
-	}
+	et_dma_mapping_put(map);
 }
 
 // clang-format off
@@ -622,11 +1168,140 @@ struct vm_area_struct *et_find_vma(struct et_pci_dev *et_dev,
 	return vma;
 }
 
+/**
+ * et_get_dma_mapping() - Find the CMA buffer mapping of a virtual address
+ * @et_dev: Pointer to struct et_pci_dev
+ * @vaddr: User virtual address mapped by a CMA buffer VMA
+ * @offset: Returns the offset of the virtual address in the CMA buffer
+ *
+ * The reference taken on the mapping keeps the CMA buffer allocated after it's
+ * unmapped, until et_dma_mapping_put() is called.
+ *
+ * Return: Pointer to struct et_dma_mapping on success, NULL if the address
+ * isn't in a CMA buffer of the device
+ */
+struct et_dma_mapping *et_get_dma_mapping(struct et_pci_dev *et_dev,
+					  unsigned long vaddr, u64 *offset)
+{
+	struct vm_area_struct *vma;
+	struct et_dma_mapping *map = NULL;
+
+	mmap_read_lock(current->mm);
+
+	vma = find_vma(current->mm, vaddr);
+	if (vma && vma->vm_start <= vaddr &&
+	    vma->vm_ops == &esperanto_pcie_vm_ops) {
+		map = vma->vm_private_data;
+		if (map->pdev == et_dev->pdev) {
+			et_dma_mapping_get(map);
+			*offset = vaddr - vma->vm_start +
+				  (vma->vm_pgoff << PAGE_SHIFT);
+		} else {
+			map = NULL;
+		}
+	}
+
+	mmap_read_unlock(current->mm);
+
+	return map;
+}
+
+/**
+ * esperanto_pcie_ops_mmap_vqs() - mmap the VQ buffer region or the doorbell
+ * @et_dev: Pointer to struct et_pci_dev
+ * @vma: VMA of the mapping, at ETSOC1_MMAP_OFFSET_VQ_BUFFER or
+ *	 ETSOC1_MMAP_OFFSET_DOORBELL offset
+ *
+ * Return: 0 on success, negative error on failure
+ */
+static int esperanto_pcie_ops_mmap_vqs(struct et_pci_dev *et_dev,
+				       struct vm_area_struct *vma)
+{
+	struct et_mapped_region *region;
+	phys_addr_t phys_addr;
+	size_t size = vma->vm_end - vma->vm_start;
+	size_t max_size;
+
+	if (!READ_ONCE(et_dev->ops.vq_data.vq_common.user_owned)) {
+		dev_err(&et_dev->pdev->dev,
+			"mmap() of VQs needs ETSOC1_IOCTL_MAP_VQS first.\n");
+		return -EPERM;
+	}
+
+	if (vma->vm_pgoff == ETSOC1_MMAP_OFFSET_VQ_BUFFER >> PAGE_SHIFT) {
+		region = &et_dev->ops.regions[OPS_MEM_REGION_TYPE_VQ_BUFFER];
+		phys_addr = region->io.host_phys_addr;
+		max_size = PAGE_ALIGN(offset_in_page(phys_addr) + region->size);
+	} else {
+		region = &et_dev->mgmt
+				  .regions[MGMT_MEM_REGION_TYPE_VQ_INTRPT_TRG];
+		phys_addr = region->io.host_phys_addr +
+			    et_dev->ops.dir_vq.intrpt_trg_offset;
+		max_size = PAGE_SIZE;
+	}
+
+	if (size > max_size)
+		return -EINVAL;
+
+#if (LINUX_VERSION_CODE < KERNEL_VERSION(6, 3, 0)) && (!defined(RHEL_MAJOR) || (RHEL_MAJOR < 9))
+	vma->vm_flags |= VM_IO | VM_DONTCOPY | VM_DONTEXPAND | VM_DONTDUMP;
+#else
+	vm_flags_set(vma, VM_IO | VM_DONTCOPY | VM_DONTEXPAND | VM_DONTDUMP);
+#endif
+	vma->vm_page_prot = pgprot_noncached(vma->vm_page_prot);
+
+	return io_remap_pfn_range(vma, vma->vm_start, PHYS_PFN(phys_addr),
+				  size, vma->vm_page_prot);
+}
+
+/**
+ * esperanto_pcie_ops_mmap_dram() - mmap the host managed DRAM write-combined
+ * @et_dev: Pointer to struct et_pci_dev
+ * @vma: VMA of the mapping, at ETSOC1_MMAP_OFFSET_DEVICE_DRAM offset
+ *
+ * The mapping starts at the DRAM base given by ETSOC1_IOCTL_GET_USER_DRAM_INFO.
+ * Stores are combined and posted, user-space must fence them before notifying
+ * the device about commands using that memory. Loads are uncached.
+ *
+ * Return: 0 on success, negative error on failure
+ */
+static int esperanto_pcie_ops_mmap_dram(struct et_pci_dev *et_dev,
+					struct vm_area_struct *vma)
+{
+	struct et_mapped_region *region;
+	size_t size = vma->vm_end - vma->vm_start;
+
+	if (!user_dram || !capable(CAP_SYS_RAWIO))
+		return -EPERM;
+
+	region = &et_dev->ops.regions[OPS_MEM_REGION_TYPE_HOST_MANAGED];
+	if (!region->is_valid || !region->bar_phys_addr ||
+	    !(region->access.node_access & MEM_REGION_NODE_ACCESSIBLE_OPS))
+		return -EACCES;
+
+	if (offset_in_page(region->bar_phys_addr) ||
+	    size > PAGE_ALIGN(region->size))
+		return -EINVAL;
+
+#if (LINUX_VERSION_CODE < KERNEL_VERSION(6, 3, 0)) && (!defined(RHEL_MAJOR) || (RHEL_MAJOR < 9))
+	vma->vm_flags |= VM_IO | VM_DONTCOPY | VM_DONTEXPAND | VM_DONTDUMP;
+#else
+	vm_flags_set(vma, VM_IO | VM_DONTCOPY | VM_DONTEXPAND | VM_DONTDUMP);
+#endif
+	vma->vm_page_prot = pgprot_writecombine(vma->vm_page_prot);
+
+	return io_remap_pfn_range(vma, vma->vm_start,
+				  PHYS_PFN(region->bar_phys_addr), size,
+				  vma->vm_page_prot);
+}
+
 /**
  * esperanto_pcie_ops_mmap() - Esperanto PCIe mmap operation
  *
  * Allocates CMA buffer for the et_dev and mmap it into user virtual address
- * space
+ * space. The ETSOC1_MMAP_OFFSET_VQ_BUFFER and ETSOC1_MMAP_OFFSET_DOORBELL
+ * offsets map the VQs handed over with ETSOC1_IOCTL_MAP_VQS instead, and the
+ * ETSOC1_MMAP_OFFSET_DEVICE_DRAM offset maps the host managed DRAM
  *
  * Return: 0 on success, negative error on failure
  */
@@ -643,6 +1318,13 @@ static int esperanto_pcie_ops_mmap(struct file *fp, struct vm_area_struct *vma)
 	ops = container_of(fp->private_data, struct et_ops_dev, misc_dev);
 	et_dev = container_of(ops, struct et_pci_dev, ops);
 
+	if (vma->vm_pgoff == ETSOC1_MMAP_OFFSET_VQ_BUFFER >> PAGE_SHIFT ||
+	    vma->vm_pgoff == ETSOC1_MMAP_OFFSET_DOORBELL >> PAGE_SHIFT)
+		return esperanto_pcie_ops_mmap_vqs(et_dev, vma);
+
+	if (vma->vm_pgoff == ETSOC1_MMAP_OFFSET_DEVICE_DRAM >> PAGE_SHIFT)
+		return esperanto_pcie_ops_mmap_dram(et_dev, vma);
+
 	if (vma->vm_pgoff != 0) {
 		dev_err(&et_dev->pdev->dev, "mmap() offset must be 0.\n");
 		return -EINVAL;
@@ -680,10 +1362,15 @@ static int esperanto_pcie_ops_mmap(struct file *fp, struct vm_area_struct *vma)
 	map->kern_vaddr = kern_vaddr;
 	map->dma_addr = dma_addr;
 	map->size = size;
-	map->ref_count = 0;
+	kref_init(&map->ref);
 	vma->vm_private_data = map;
 
-	esperanto_pcie_vm_open(vma);
+	atomic64_add(
+		size,
+		&et_dev->ops.mem_stats.counters[ET_MEM_COUNTER_STATS_CMA_ALLOCATED]);
+	et_rate_entry_update(
+		size,
+		&et_dev->ops.mem_stats.rates[ET_MEM_RATE_STATS_CMA_ALLOCATION_RATE]);
 
 	return 0;
 
@@ -714,10 +1401,14 @@ error_dma_free_coherent:
  * - ETSOC1_IOCTL_GET_SQ_AVAIL_BITMAP: Provides SQ availability bitmap
  * - ETSOC1_IOCTL_GET_CQ_AVAIL_BITMAP: Provides CQ availability bitmap
  * - ETSOC1_IOCTL_SET_SQ_THRESHOLD: Sets SQ threshold for SQ availability
+ * - ETSOC1_IOCTL_SET_VQ_EVENTFD: Sets an eventfd signaled when a CQ has a
+ *   response to pop or when SQs get space available
  * - ETSOC1_IOCTL_GET_TRACE_BUFFER_SIZE: Provies size trace buffer regions
  *   {SP, MM, CM, SP_STATS, MM_STATS} if region is defined by device
  * - ETSOC1_IOCTL_EXTRACT_TRACE_BUFFER: Extracts trace buffer regions using
  *   MMIOs for {SP, MM, CM, SP_STATS, MM_STATS} if region is defined by device
+ * - ETSOC1_IOCTL_READ_TRACE_BUFFER: Reads a range of one of these trace buffer
+ *   regions, so that only new trace data is copied to user
  *
  * Return: Non-negative value on success, negative error on failure
  */
@@ -865,7 +1556,8 @@ static long esperanto_pcie_mgmt_ioctl(struct file *fp, unsigned int cmd,
 		if (cmd_info.sq_index >= mgmt->vq_data.vq_common.sq_count ||
 		    !cmd_info.cmd || !cmd_info.size ||
 		    cmd_info.flags &
-			    (CMD_DESC_FLAG_DMA | CMD_DESC_FLAG_HIGH_PRIORITY))
+			    (CMD_DESC_FLAG_DMA | CMD_DESC_FLAG_DMA_CHAIN |
+			     CMD_DESC_FLAG_HIGH_PRIORITY))
 			return -EINVAL;
 
 		if (cmd_info.flags & CMD_DESC_FLAG_ETSOC_RESET) {
@@ -977,6 +1669,10 @@ static long esperanto_pcie_mgmt_ioctl(struct file *fp, unsigned int cmd,
 
 		break;
 
+	case ETSOC1_IOCTL_SET_VQ_EVENTFD:
+		return esperanto_pcie_set_vq_eventfd(et_dev, &mgmt->vq_data,
+						     usr_arg);
+
 	case ETSOC1_IOCTL_GET_TRACE_BUFFER_SIZE:
 		if (copy_from_user(&trace_type, usr_arg, _IOC_SIZE(cmd))) {
 			dev_err(&et_dev->pdev->dev,
@@ -1076,6 +1772,9 @@ static long esperanto_pcie_mgmt_ioctl(struct file *fp, unsigned int cmd,
 		kvfree(trace_buf);
 		break;
 
+	case ETSOC1_IOCTL_READ_TRACE_BUFFER:
+		return esperanto_pcie_read_trace_buffer(et_dev, usr_arg);
+
 	default:
 		dev_err(&et_dev->pdev->dev, "ops_ioctl: unknown cmd: 0x%x\n",
 			cmd);
@@ -1181,6 +1880,21 @@ static int esperanto_pcie_ops_release(struct inode *inode, struct file *fp)
 	struct et_ops_dev *ops;
 
 	ops = container_of(fp->private_data, struct et_ops_dev, misc_dev);
+	// Memory pinned by the process is not reachable anymore
+	et_dma_unpin_all_user_mem(container_of(ops, struct et_pci_dev, ops));
+
+	// The VQ mappings are gone too since they hold a reference on the file
+	mutex_lock(&ops->init_mutex);
+	if (ops->is_initialized) {
+		et_vqueue_clear_eventfds(&ops->vq_data);
+		et_vqueue_user_release(&ops->vq_data);
+	} else if (ops->vq_data.vq_common.user_owned) {
+		ops->vq_data.vq_common.user_owned = false;
+		eventfd_ctx_put(ops->vq_data.vq_common.cq_eventfd);
+		ops->vq_data.vq_common.cq_eventfd = NULL;
+	}
+	mutex_unlock(&ops->init_mutex);
+
 	spin_lock(&ops->open_lock);
 	ops->is_open = false;
 	spin_unlock(&ops->open_lock);
@@ -1202,6 +1916,12 @@ static int esperanto_pcie_mgmt_release(struct inode *inode, struct file *fp)
 	struct et_pci_dev *et_dev;
 
 	mgmt = container_of(fp->private_data, struct et_mgmt_dev, misc_dev);
+
+	mutex_lock(&mgmt->init_mutex);
+	if (mgmt->is_initialized)
+		et_vqueue_clear_eventfds(&mgmt->vq_data);
+	mutex_unlock(&mgmt->init_mutex);
+
 	spin_lock(&mgmt->open_lock);
 	mgmt->is_open = false;
 	spin_unlock(&mgmt->open_lock);
@@ -1222,6 +1942,9 @@ static const struct file_operations et_pcie_ops_fops = {
 	.owner			= THIS_MODULE,
 	.poll			= esperanto_pcie_ops_poll,
 	.unlocked_ioctl		= esperanto_pcie_ops_ioctl,
+#ifdef ET_URING_CMD
+	.uring_cmd		= esperanto_pcie_ops_uring_cmd,
+#endif
 	.mmap			= esperanto_pcie_ops_mmap,
 	.open			= esperanto_pcie_ops_open,
 	.release		= esperanto_pcie_ops_release,
@@ -1380,6 +2103,11 @@ static int create_et_pci_dev(struct et_pci_dev **new_dev, struct pci_dev *pdev)
 	mutex_init(&et_dev->ops.init_mutex);
 	et_dev->ops.is_resetting = false;
 	mutex_init(&et_dev->ops.reset_mutex);
+	INIT_LIST_HEAD(&et_dev->ops.pinned_mem_list);
+	mutex_init(&et_dev->ops.pinned_mem_mutex);
+	INIT_LIST_HEAD(&et_dev->ops.stream_mem_list);
+	mutex_init(&et_dev->ops.stream_mem_mutex);
+	atomic_set(&et_dev->ops.stream_mem_count, 0);
 	et_dev->ops.miscdev_created = false;
 
 	return 0;
@@ -1571,6 +2299,10 @@ static ssize_t et_map_discovered_regions(struct et_pci_dev *et_dev,
 			goto error_unmap_discovered_regions;
 		}
 
+		regions[dir_mem_region->type].bar_phys_addr =
+			pci_resource_start(et_dev->pdev, dir_mem_region->bar) +
+			dir_mem_region->bar_offset;
+
 		// Skip BAR mapping of region if IO/P2P access is disabled by
 		// device
 		if (!dir_mem_region->access.io_access &&
@@ -2589,6 +3321,11 @@ static int init_et_pci_dev(struct et_pci_dev *et_dev, bool miscdev_create)
 		goto error_disable_dev;
 	}
 
+	// DMA list nodes are split at DMA segment boundaries, so let the DMA
+	// mapping merge pinned memory in segments as big as possible; with the
+	// 64KB default, a 2MB hugepage would take 32 segments (and nodes)
+	dma_set_max_seg_size(&pdev->dev, UINT_MAX);
+
 	pci_set_master(pdev);
 
 	// Device Management:
@@ -2596,14 +3333,16 @@ static int init_et_pci_dev(struct et_pci_dev *et_dev, bool miscdev_create)
 	//  - Vector[1] - Mgmt CQ(s)
 	// Device Operations:
 	//  - Vector[2] - Ops SQ(s)
-	//  - Vector[3] - Ops CQ(s)
-	rv = pci_alloc_irq_vectors(pdev, ET_MAX_MSI_VECS, ET_MAX_MSI_VECS,
+	//  - Vector[3..N] - Ops CQ(s), one vector per CQ when the device and the
+	//    platform allow it, the last vector is shared by the remaining CQs
+	rv = pci_alloc_irq_vectors(pdev, ET_MIN_MSI_VECS, ET_MAX_MSI_VECS,
 				   PCI_IRQ_MSI);
-	if (rv != ET_MAX_MSI_VECS) {
+	if (rv < ET_MIN_MSI_VECS) {
 		dev_err(&pdev->dev, "msi vectors=%d alloc failed\n",
-			ET_MAX_MSI_VECS);
+			ET_MIN_MSI_VECS);
 		goto error_clear_master;
 	}
+	et_dev->num_msi_vecs = rv;
 
 	rv = pci_request_regions(pdev, DRIVER_NAME);
 	if (rv) {
@@ -2816,18 +3555,29 @@ static int esperanto_pcie_probe(struct pci_dev *pdev,
 		goto error_sysfs_remove_group;
 	}
 
+	rv = et_sysfs_add_file(et_dev, ET_SYSFS_FID_STATS_SNAPSHOT);
+	if (rv) {
+		dev_err(&et_dev->pdev->dev,
+			"et_sysfs_add_file() failed, file_id: %d\n",
+			ET_SYSFS_FID_STATS_SNAPSHOT);
+		goto error_sysfs_remove_file;
+	}
+
 	et_dev->reset_workqueue =
 		alloc_workqueue("%s:et%d_rstwq", WQ_MEM_RECLAIM | WQ_UNBOUND, 1,
 				dev_name(&et_dev->pdev->dev), et_dev->devnum);
 	if (!et_dev->reset_workqueue) {
 		dev_err(&pdev->dev, "Mgmt device initialization failed\n");
 		rv = -ENOMEM;
-		goto error_sysfs_remove_file;
+		goto error_sysfs_remove_files;
 	}
 	INIT_WORK(&et_dev->isr_work, et_reset_isr_work);
 
 	return rv;
 
+error_sysfs_remove_files:
+	et_sysfs_remove_file(et_dev, ET_SYSFS_FID_STATS_SNAPSHOT);
+
 error_sysfs_remove_file:
 	et_sysfs_remove_file(et_dev, ET_SYSFS_FID_DEVNUM);
 
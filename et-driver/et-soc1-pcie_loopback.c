@@ -10,6 +10,7 @@
 #include <linux/delay.h>
 #include <linux/device.h>
 #include <linux/errno.h>
+#include <linux/eventfd.h>
 #include <linux/fs.h>
 #include <linux/init.h>
 #include <linux/jiffies.h>
@@ -29,6 +30,7 @@
 #include <uapi/linux/pci_regs.h>
 
 #include "et_dma.h"
+#include "et_dmabuf.h"
 #include "et_event_handler.h"
 #include "et_fw_update.h"
 #include "et_io.h"
@@ -97,15 +99,13 @@ static __poll_t esperanto_pcie_ops_poll(struct file *fp, poll_table *wait)
 
 	poll_wait(fp, &ops->vq_data.vq_common.waitqueue, wait);
 
-	mutex_lock(&ops->vq_data.vq_common.sq_bitmap_mutex);
-	mutex_lock(&ops->vq_data.vq_common.cq_bitmap_mutex);
-
-	// Generate EPOLLOUT event if any SQ has space more than its threshold
+	// Generate EPOLLOUT event if any SQ has space more than its threshold,
+	// the SQ bitmap is updated lock-free
 	if (!bitmap_empty(ops->vq_data.vq_common.sq_bitmap,
 			  ops->vq_data.vq_common.sq_count))
 		mask |= EPOLLOUT;
 
-	mutex_unlock(&ops->vq_data.vq_common.sq_bitmap_mutex);
+	mutex_lock(&ops->vq_data.vq_common.cq_bitmap_mutex);
 
 	// Generate EPOLLIN event if any CQ msg is saved for userspace
 	if (!bitmap_empty(ops->vq_data.vq_common.cq_bitmap,
@@ -117,6 +117,33 @@ static __poll_t esperanto_pcie_ops_poll(struct file *fp, poll_table *wait)
 	return mask;
 }
 
+static long esperanto_pcie_set_vq_eventfd(struct et_pci_dev *et_dev,
+					  struct et_vq_data *vq_data,
+					  struct vq_eventfd_desc __user *uinfo)
+{
+	struct vq_eventfd_desc info;
+	struct eventfd_ctx *eventfd = NULL;
+	long rv;
+
+	if (copy_from_user(&info, uinfo, sizeof(info))) {
+		dev_err(&et_dev->pdev->dev,
+			"set_vq_eventfd: failed to copy from user!\n");
+		return -EFAULT;
+	}
+
+	if (info.eventfd >= 0) {
+		eventfd = eventfd_ctx_fdget(info.eventfd);
+		if (IS_ERR(eventfd))
+			return PTR_ERR(eventfd);
+	}
+
+	rv = et_vqueue_set_eventfd(vq_data, info.type, info.cq_index, eventfd);
+	if (rv && eventfd)
+		eventfd_ctx_put(eventfd);
+
+	return rv;
+}
+
 static long esperanto_pcie_ops_ioctl(struct file *fp, unsigned int cmd,
 				     unsigned long arg)
 {
@@ -125,7 +152,12 @@ static long esperanto_pcie_ops_ioctl(struct file *fp, unsigned int cmd,
 	struct et_ops_dev *ops;
 	struct dram_info user_dram;
 	struct cmd_desc cmd_info;
+	struct cmd_batch_desc cmd_batch_info;
 	struct rsp_desc rsp_info;
+	struct rsp_batch_desc rsp_batch_info;
+	struct host_mem_desc host_mem_info;
+	struct dmabuf_export_desc dmabuf_export_info;
+	struct dmabuf_import_desc dmabuf_import_info;
 	struct sq_threshold sq_threshold_info;
 	void __user *usr_arg = (void __user *)arg;
 	u16 sq_idx;
@@ -252,6 +284,17 @@ static long esperanto_pcie_ops_ioctl(struct file *fp, unsigned int cmd,
 
 		break;
 
+	case ETSOC1_IOCTL_GET_CQ_COUNT:
+		if (copy_to_user(usr_arg, &ops->vq_data.vq_common.cq_count,
+				 _IOC_SIZE(cmd))) {
+			dev_err(&et_dev->pdev->dev,
+				"ops_ioctl[%u]: failed to copy to user!\n",
+				_IOC_NR(cmd));
+			return -EFAULT;
+		}
+
+		break;
+
 	case ETSOC1_IOCTL_GET_SQ_MAX_MSG_SIZE:
 		max_size = ops->vq_data.vq_common.sq_size -
 			   sizeof(struct et_circbuffer);
@@ -286,7 +329,8 @@ static long esperanto_pcie_ops_ioctl(struct file *fp, unsigned int cmd,
 		    cmd_info.flags & CMD_DESC_FLAG_MM_RESET ||
 		    cmd_info.flags & CMD_DESC_FLAG_ETSOC_RESET ||
 		    ((cmd_info.flags & CMD_DESC_FLAG_DMA ||
-		      cmd_info.flags & CMD_DESC_FLAG_P2PDMA) &&
+		      cmd_info.flags & CMD_DESC_FLAG_P2PDMA ||
+		      cmd_info.flags & CMD_DESC_FLAG_DMA_CHAIN) &&
 		     cmd_info.flags & CMD_DESC_FLAG_HIGH_PRIORITY))
 			return -EINVAL;
 
@@ -309,12 +353,17 @@ static long esperanto_pcie_ops_ioctl(struct file *fp, unsigned int cmd,
 				rv = et_p2pdma_move_data(
 					et_dev, cmd_info.sq_index,
 					(char __user __force *)cmd_info.cmd,
-					cmd_info.size);
+					cmd_info.size, NULL, 0);
 			else if (cmd_info.flags & CMD_DESC_FLAG_DMA)
 				rv = et_dma_move_data(
 					et_dev, cmd_info.sq_index,
 					(char __user __force *)cmd_info.cmd,
-					cmd_info.size);
+					cmd_info.size, NULL, 0);
+			else if (cmd_info.flags & CMD_DESC_FLAG_DMA_CHAIN)
+				rv = et_dma_chain_move_data(
+					et_dev, cmd_info.sq_index,
+					(char __user __force *)cmd_info.cmd,
+					cmd_info.size, NULL, 0);
 			else
 				rv = et_squeue_copy_from_user(
 					et_dev, false /* ops_dev */,
@@ -326,6 +375,36 @@ static long esperanto_pcie_ops_ioctl(struct file *fp, unsigned int cmd,
 
 		break;
 
+	case ETSOC1_IOCTL_PUSH_SQ_BATCH:
+		if (copy_from_user(&cmd_batch_info, usr_arg, _IOC_SIZE(cmd))) {
+			dev_err(&et_dev->pdev->dev,
+				"ops_ioctl[%u]: failed to copy from user!\n",
+				_IOC_NR(cmd));
+			return -EFAULT;
+		}
+
+		// DMA commands need their host addresses translated one by one
+		if (!cmd_batch_info.cmds || !cmd_batch_info.size ||
+		    cmd_batch_info.flags & ~CMD_DESC_FLAG_HIGH_PRIORITY)
+			return -EINVAL;
+
+		if (cmd_batch_info.flags & CMD_DESC_FLAG_HIGH_PRIORITY) {
+			if (cmd_batch_info.sq_index >=
+			    ops->vq_data.vq_common.hp_sq_count)
+				return -EINVAL;
+		} else if (cmd_batch_info.sq_index >=
+			   ops->vq_data.vq_common.sq_count) {
+			return -EINVAL;
+		}
+
+		rv = et_squeue_copy_batch_from_user(
+			et_dev, false /* ops_dev */,
+			cmd_batch_info.flags & CMD_DESC_FLAG_HIGH_PRIORITY,
+			cmd_batch_info.sq_index,
+			(char __user __force *)cmd_batch_info.cmds,
+			cmd_batch_info.size);
+		break;
+
 	case ETSOC1_IOCTL_POP_CQ:
 		if (copy_from_user(&rsp_info, usr_arg, _IOC_SIZE(cmd))) {
 			dev_err(&et_dev->pdev->dev,
@@ -344,6 +423,95 @@ static long esperanto_pcie_ops_ioctl(struct file *fp, unsigned int cmd,
 					    rsp_info.size);
 		break;
 
+	case ETSOC1_IOCTL_POP_CQ_BATCH:
+		if (copy_from_user(&rsp_batch_info, usr_arg, _IOC_SIZE(cmd))) {
+			dev_err(&et_dev->pdev->dev,
+				"ops_ioctl[%u]: failed to copy from user!\n",
+				_IOC_NR(cmd));
+			return -EFAULT;
+		}
+
+		if (rsp_batch_info.cq_index >=
+			    ops->vq_data.vq_common.cq_count ||
+		    !rsp_batch_info.rsps || !rsp_batch_info.count)
+			return -EINVAL;
+
+		rv = et_cqueue_copy_batch_to_user(
+			et_dev, false /* ops_dev */, rsp_batch_info.cq_index,
+			(struct rsp_desc __user __force *)rsp_batch_info.rsps,
+			rsp_batch_info.count);
+		break;
+
+	case ETSOC1_IOCTL_REGISTER_HOST_MEM:
+		if (copy_from_user(&host_mem_info, usr_arg, _IOC_SIZE(cmd))) {
+			dev_err(&et_dev->pdev->dev,
+				"ops_ioctl[%u]: failed to copy from user!\n",
+				_IOC_NR(cmd));
+			return -EFAULT;
+		}
+
+		rv = et_dma_pin_user_mem(et_dev, host_mem_info.addr,
+					 host_mem_info.size,
+					 host_mem_info.flags);
+		break;
+
+	case ETSOC1_IOCTL_UNREGISTER_HOST_MEM:
+		if (copy_from_user(&host_mem_info, usr_arg, _IOC_SIZE(cmd))) {
+			dev_err(&et_dev->pdev->dev,
+				"ops_ioctl[%u]: failed to copy from user!\n",
+				_IOC_NR(cmd));
+			return -EFAULT;
+		}
+
+		rv = et_dma_unpin_user_mem(et_dev, host_mem_info.addr);
+		break;
+
+	case ETSOC1_IOCTL_EXPORT_DMABUF:
+		if (copy_from_user(&dmabuf_export_info, usr_arg,
+				   _IOC_SIZE(cmd))) {
+			dev_err(&et_dev->pdev->dev,
+				"ops_ioctl[%u]: failed to copy from user!\n",
+				_IOC_NR(cmd));
+			return -EFAULT;
+		}
+
+		rv = et_dmabuf_export(et_dev, &dmabuf_export_info);
+		if (rv)
+			break;
+
+		// The dma-buf fd stays installed, user-space closes it
+		if (copy_to_user(usr_arg, &dmabuf_export_info,
+				 _IOC_SIZE(cmd))) {
+			dev_err(&et_dev->pdev->dev,
+				"ops_ioctl[%u]: failed to copy to user!\n",
+				_IOC_NR(cmd));
+			rv = -EFAULT;
+		}
+		break;
+
+	case ETSOC1_IOCTL_IMPORT_DMABUF:
+		if (copy_from_user(&dmabuf_import_info, usr_arg,
+				   _IOC_SIZE(cmd))) {
+			dev_err(&et_dev->pdev->dev,
+				"ops_ioctl[%u]: failed to copy from user!\n",
+				_IOC_NR(cmd));
+			return -EFAULT;
+		}
+
+		rv = et_dmabuf_import(et_dev, &dmabuf_import_info);
+		if (rv < 0)
+			break;
+
+		if (copy_to_user(usr_arg, &dmabuf_import_info,
+				 _IOC_SIZE(cmd))) {
+			dev_err(&et_dev->pdev->dev,
+				"ops_ioctl[%u]: failed to copy to user!\n",
+				_IOC_NR(cmd));
+			et_dma_unpin_user_mem(et_dev, dmabuf_import_info.addr);
+			rv = -EFAULT;
+		}
+		break;
+
 	case ETSOC1_IOCTL_GET_SQ_AVAIL_BITMAP:
 		if (copy_to_user(usr_arg, ops->vq_data.vq_common.sq_bitmap,
 				 _IOC_SIZE(cmd))) {
@@ -393,6 +561,10 @@ static long esperanto_pcie_ops_ioctl(struct file *fp, unsigned int cmd,
 
 		break;
 
+	case ETSOC1_IOCTL_SET_VQ_EVENTFD:
+		return esperanto_pcie_set_vq_eventfd(et_dev, &ops->vq_data,
+						     usr_arg);
+
 	case ETSOC1_IOCTL_GET_P2PDMA_DEVICE_COMPAT_BITMAP:
 		dev_compat_bitmap = et_p2pdma_get_compat_bitmap(et_dev->devnum);
 		if (copy_to_user(usr_arg, &dev_compat_bitmap, _IOC_SIZE(cmd))) {
@@ -422,15 +594,13 @@ static __poll_t esperanto_pcie_mgmt_poll(struct file *fp, poll_table *wait)
 
 	poll_wait(fp, &mgmt->vq_data.vq_common.waitqueue, wait);
 
-	mutex_lock(&mgmt->vq_data.vq_common.sq_bitmap_mutex);
-	mutex_lock(&mgmt->vq_data.vq_common.cq_bitmap_mutex);
-
-	// Generate EPOLLOUT event if any SQ has space more than its threshold
+	// Generate EPOLLOUT event if any SQ has space more than its threshold,
+	// the SQ bitmap is updated lock-free
 	if (!bitmap_empty(mgmt->vq_data.vq_common.sq_bitmap,
 			  mgmt->vq_data.vq_common.sq_count))
 		mask |= EPOLLOUT;
 
-	mutex_unlock(&mgmt->vq_data.vq_common.sq_bitmap_mutex);
+	mutex_lock(&mgmt->vq_data.vq_common.cq_bitmap_mutex);
 
 	// Generate EPOLLIN event if any CQ msg is saved for userspace
 	if (!bitmap_empty(mgmt->vq_data.vq_common.cq_bitmap,
@@ -445,7 +615,6 @@ static __poll_t esperanto_pcie_mgmt_poll(struct file *fp, poll_table *wait)
 static void esperanto_pcie_vm_open(struct vm_area_struct *vma)
 {
 	struct et_dma_mapping *map = vma->vm_private_data;
-	struct et_pci_dev *et_dev;
 
 	if (!map)
 		return;
@@ -453,24 +622,12 @@ static void esperanto_pcie_vm_open(struct vm_area_struct *vma)
 	dev_dbg(&map->pdev->dev, "vm_open: %p, [size=%lu,vma=%08lx-%08lx]\n",
 		map, map->size, vma->vm_start, vma->vm_end);
 
-	map->ref_count++;
-	if (map->ref_count == 1) {
-		et_dev = pci_get_drvdata(map->pdev);
-		atomic64_add(
-			map->size,
-			&et_dev->ops.mem_stats
-				 .counters[ET_MEM_COUNTER_STATS_CMA_ALLOCATED]);
-		et_rate_entry_update(
-			map->size,
-			&et_dev->ops.mem_stats
-				 .rates[ET_MEM_RATE_STATS_CMA_ALLOCATION_RATE]);
-	}
+	et_dma_mapping_get(map);
 }
 
 static void esperanto_pcie_vm_close(struct vm_area_struct *vma)
 {
 	struct et_dma_mapping *map = vma->vm_private_data;
-	struct et_pci_dev *et_dev;
 
 	if (!map)
 		return;
@@ -478,18 +635,7 @@ static void esperanto_pcie_vm_close(struct vm_area_struct *vma)
 	dev_dbg(&map->pdev->dev, "vm_close: %p, [size=%lu,vma=%08lx-%08lx]\n",
 		map, map->size, vma->vm_start, vma->vm_end);
 
-	map->ref_count--;
-	if (map->ref_count == 0) {
-		dma_free_coherent(&map->pdev->dev, map->size, map->kern_vaddr,
-				  map->dma_addr);
-		et_dev = pci_get_drvdata(map->pdev);
-		atomic64_sub(
-			map->size,
-			&et_dev->ops.mem_stats
-				 .counters[ET_MEM_COUNTER_STATS_CMA_ALLOCATED]);
-
-		kfree(map);
-	}
+	et_dma_mapping_put(map);
 }
 
 // clang-format off
@@ -518,6 +664,32 @@ struct vm_area_struct *et_find_vma(struct et_pci_dev *et_dev,
 	return vma;
 }
 
+struct et_dma_mapping *et_get_dma_mapping(struct et_pci_dev *et_dev,
+					  unsigned long vaddr, u64 *offset)
+{
+	struct vm_area_struct *vma;
+	struct et_dma_mapping *map = NULL;
+
+	mmap_read_lock(current->mm);
+
+	vma = find_vma(current->mm, vaddr);
+	if (vma && vma->vm_start <= vaddr &&
+	    vma->vm_ops == &esperanto_pcie_vm_ops) {
+		map = vma->vm_private_data;
+		if (map->pdev == et_dev->pdev) {
+			et_dma_mapping_get(map);
+			*offset = vaddr - vma->vm_start +
+				  (vma->vm_pgoff << PAGE_SHIFT);
+		} else {
+			map = NULL;
+		}
+	}
+
+	mmap_read_unlock(current->mm);
+
+	return map;
+}
+
 static int esperanto_pcie_ops_mmap(struct file *fp, struct vm_area_struct *vma)
 {
 	struct et_ops_dev *ops;
@@ -568,10 +740,15 @@ static int esperanto_pcie_ops_mmap(struct file *fp, struct vm_area_struct *vma)
 	map->kern_vaddr = kern_vaddr;
 	map->dma_addr = dma_addr;
 	map->size = size;
-	map->ref_count = 0;
+	kref_init(&map->ref);
 	vma->vm_private_data = map;
 
-	esperanto_pcie_vm_open(vma);
+	atomic64_add(
+		size,
+		&et_dev->ops.mem_stats.counters[ET_MEM_COUNTER_STATS_CMA_ALLOCATED]);
+	et_rate_entry_update(
+		size,
+		&et_dev->ops.mem_stats.rates[ET_MEM_RATE_STATS_CMA_ALLOCATION_RATE]);
 
 	return 0;
 
@@ -721,7 +898,8 @@ static long esperanto_pcie_mgmt_ioctl(struct file *fp, unsigned int cmd,
 		if (cmd_info.sq_index >= mgmt->vq_data.vq_common.sq_count ||
 		    !cmd_info.cmd || !cmd_info.size ||
 		    cmd_info.flags &
-			    (CMD_DESC_FLAG_DMA | CMD_DESC_FLAG_HIGH_PRIORITY))
+			    (CMD_DESC_FLAG_DMA | CMD_DESC_FLAG_DMA_CHAIN |
+			     CMD_DESC_FLAG_HIGH_PRIORITY))
 			return -EINVAL;
 
 		if (cmd_info.flags & CMD_DESC_FLAG_ETSOC_RESET) {
@@ -784,6 +962,10 @@ static long esperanto_pcie_mgmt_ioctl(struct file *fp, unsigned int cmd,
 					    rsp_info.size);
 		break;
 
+	case ETSOC1_IOCTL_SET_VQ_EVENTFD:
+		return esperanto_pcie_set_vq_eventfd(et_dev, &mgmt->vq_data,
+						     usr_arg);
+
 	case ETSOC1_IOCTL_GET_SQ_AVAIL_BITMAP:
 		if (copy_to_user(usr_arg, mgmt->vq_data.vq_common.sq_bitmap,
 				 _IOC_SIZE(cmd))) {
@@ -913,6 +1095,14 @@ static int esperanto_pcie_ops_release(struct inode *inode, struct file *fp)
 	struct et_ops_dev *ops;
 
 	ops = container_of(fp->private_data, struct et_ops_dev, misc_dev);
+	// Memory pinned by the process is not reachable anymore
+	et_dma_unpin_all_user_mem(container_of(ops, struct et_pci_dev, ops));
+
+	mutex_lock(&ops->init_mutex);
+	if (ops->is_initialized)
+		et_vqueue_clear_eventfds(&ops->vq_data);
+	mutex_unlock(&ops->init_mutex);
+
 	spin_lock(&ops->open_lock);
 	ops->is_open = false;
 	spin_unlock(&ops->open_lock);
@@ -926,6 +1116,12 @@ static int esperanto_pcie_mgmt_release(struct inode *inode, struct file *fp)
 	struct et_pci_dev *et_dev;
 
 	mgmt = container_of(fp->private_data, struct et_mgmt_dev, misc_dev);
+
+	mutex_lock(&mgmt->init_mutex);
+	if (mgmt->is_initialized)
+		et_vqueue_clear_eventfds(&mgmt->vq_data);
+	mutex_unlock(&mgmt->init_mutex);
+
 	spin_lock(&mgmt->open_lock);
 	mgmt->is_open = false;
 	spin_unlock(&mgmt->open_lock);
@@ -991,6 +1187,11 @@ static int create_et_pci_dev(struct et_pci_dev **new_dev, struct pci_dev *pdev)
 	mutex_init(&et_dev->ops.init_mutex);
 	et_dev->ops.is_resetting = false;
 	mutex_init(&et_dev->ops.reset_mutex);
+	INIT_LIST_HEAD(&et_dev->ops.pinned_mem_list);
+	mutex_init(&et_dev->ops.pinned_mem_mutex);
+	INIT_LIST_HEAD(&et_dev->ops.stream_mem_list);
+	mutex_init(&et_dev->ops.stream_mem_mutex);
+	atomic_set(&et_dev->ops.stream_mem_count, 0);
 	et_dev->ops.miscdev_created = false;
 
 	return 0;
@@ -1478,18 +1679,29 @@ static int esperanto_pcie_probe(struct pci_dev *pdev,
 		goto error_sysfs_remove_group;
 	}
 
+	rv = et_sysfs_add_file(et_dev, ET_SYSFS_FID_STATS_SNAPSHOT);
+	if (rv) {
+		dev_err(&et_dev->pdev->dev,
+			"et_sysfs_add_file() failed, file_id: %d\n",
+			ET_SYSFS_FID_STATS_SNAPSHOT);
+		goto error_sysfs_remove_file;
+	}
+
 	et_dev->reset_workqueue =
 		alloc_workqueue("%s:et%d_rstwq", WQ_MEM_RECLAIM | WQ_UNBOUND, 1,
 				dev_name(&et_dev->pdev->dev), et_dev->devnum);
 	if (!et_dev->reset_workqueue) {
 		dev_err(&pdev->dev, "Mgmt device initialization failed\n");
 		rv = -ENOMEM;
-		goto error_sysfs_remove_file;
+		goto error_sysfs_remove_files;
 	}
 	INIT_WORK(&et_dev->isr_work, et_reset_isr_work);
 
 	return rv;
 
+error_sysfs_remove_files:
+	et_sysfs_remove_file(et_dev, ET_SYSFS_FID_STATS_SNAPSHOT);
+
 error_sysfs_remove_file:
 	et_sysfs_remove_file(et_dev, ET_SYSFS_FID_DEVNUM);
 
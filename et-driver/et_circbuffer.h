@@ -20,14 +20,15 @@
  * @head: Offset of the circular buffer to write data to
  * @tail: Offset of the circular buffer to read data from
  * @len: Total length (in bytes) of the circular buffer
- * @pad: Padding for alignment
+ * @notify_threshold: Number of responses the device coalesces per interrupt,
+ * written by the host (CQs only, 0 or 1 notifies on each response)
  * @buf: Flexible array to access circular buffer memory
  */
 struct et_circbuffer {
 	u64 head;
 	u64 tail;
 	u64 len;
-	u64 pad;
+	u64 notify_threshold;
 	u8 __iomem buf[];
 } __packed __aligned(8);
 
@@ -294,6 +294,8 @@ struct et_mgmt_dir {
  *	addresses
  * @p2p: DIR region mapped as P2P-region with device-resource ID, kernel
  *	virtual base address and PCI bus address (DMAable)
+ * @bar_phys_addr: Host physical address of the region in its BAR, whatever the
+ *	access type, used to mmap() it to user-space
  * @dev_phys_addr: Device physical/SOC base address
  * @size: Total size of the mapped region
  */
@@ -311,6 +313,7 @@ struct et_mapped_region {
 			pci_bus_addr_t pci_bus_addr;
 		} p2p;
 	};
+	phys_addr_t bar_phys_addr;
 	u64 dev_phys_addr;
 	u64 size;
 };
@@ -79,6 +79,7 @@ enum device_mgmt_api_msg_e {
 	DEV_MGMT_API_MID_SP_RUNTIME_ERROR_EVENT,
 	DEV_MGMT_API_MID_SP_WATCHDOG_RESET_EVENT,
 	DEV_MGMT_API_MID_SP_TRACE_BUFFER_FULL_EVENT,
+	DEV_MGMT_API_MID_SP_EVENT_SUMMARY_EVENT,
 	/* Device Mgmt Event IDs reserved */
 	DEV_MGMT_API_MID_EVENTS_END = 511,
 };
@@ -159,6 +160,32 @@ struct device_ops_p2pdma_list_cmd_t {
 	struct p2pdma_node list[];
 } __packed __aligned(8);
 
+/**
+ * struct device_ops_dma_chain_cmd_t - Command running a DMA chain
+ * @command_info: Command header information
+ * @chain_device_phys_addr: Device SOC address of the chain of DMA elements
+ * @host_virt_addr: Host virtual address of the buffer the elements refer to
+ * @host_phys_addr: Host bus address of the buffer, filled in by driver
+ * @host_size: Size of the host buffer in bytes
+ * @elem_count: Number of data elements of the chain
+ * @direction: 0 for host to device, 1 for device to host
+ * @pad: Padding for alignment
+ *
+ * The host side address of the chain elements is an offset in the host
+ * buffer, checked against host_size by the device. Hence, the buffer must be
+ * contiguous in DMA address space.
+ */
+struct device_ops_dma_chain_cmd_t {
+	struct cmd_header_t command_info;
+	u64 chain_device_phys_addr;
+	u64 host_virt_addr;
+	u64 host_phys_addr;
+	u64 host_size;
+	u32 elem_count;
+	u8 direction;
+	u8 pad[3];
+} __packed __aligned(8);
+
 /**
  * struct device_ops_dma_list_rsp_t - DMA/P2PDMA list command response
  * @response_info: Response header information
@@ -6,32 +6,175 @@
  *
  **********************************************************************/
 
+#include <linux/dma-mapping.h>
+#include <linux/mm.h>
+#include <linux/overflow.h>
+#include <linux/slab.h>
+
 #include "et_dma.h"
 #include "et_device_api.h"
+#include "et_dmabuf.h"
 #include "et_vma.h"
 #include "et_vqueue.h"
 
+static void et_dma_release_pinned_mem(struct et_pci_dev *et_dev,
+				      struct et_pinned_mem *pmem);
+static struct et_pinned_mem *et_dma_map_user_pages(struct et_pci_dev *et_dev,
+						   u64 uaddr, u64 size,
+						   bool long_term,
+						   bool to_device);
+
+/**
+ * et_dma_mapping_get() - Take a reference on a CMA buffer mapping
+ * @map: pointer to et_dma_mapping structure
+ */
+void et_dma_mapping_get(struct et_dma_mapping *map)
+{
+	kref_get(&map->ref);
+}
+
+static void et_dma_mapping_release(struct kref *ref)
+{
+	struct et_dma_mapping *map =
+		container_of(ref, struct et_dma_mapping, ref);
+	struct et_pci_dev *et_dev = pci_get_drvdata(map->pdev);
+
+	dma_free_coherent(&map->pdev->dev, map->size, map->kern_vaddr,
+			  map->dma_addr);
+	atomic64_sub(
+		map->size,
+		&et_dev->ops.mem_stats.counters[ET_MEM_COUNTER_STATS_CMA_ALLOCATED]);
+
+	kfree(map);
+}
+
+/**
+ * et_dma_mapping_put() - Drop a reference on a CMA buffer mapping
+ * @map: pointer to et_dma_mapping structure
+ *
+ * The CMA buffer is freed with its last reference
+ */
+void et_dma_mapping_put(struct et_dma_mapping *map)
+{
+	kref_put(&map->ref, et_dma_mapping_release);
+}
+
+/**
+ * et_dma_find_pinned_mem() - Find pinned memory containing a user range
+ * @et_dev: pointer to et_pci_dev structure
+ * @uaddr: start virtual address of the range in user-space
+ * @size: size of the range in bytes
+ *
+ * Caller must hold et_dev->ops.pinned_mem_mutex
+ *
+ * Return: pointer to struct et_pinned_mem on success, NULL if the range is
+ * not fully contained in a pinned memory
+ */
+static struct et_pinned_mem *et_dma_find_pinned_mem(struct et_pci_dev *et_dev,
+						    u64 uaddr, u64 size)
+{
+	struct et_pinned_mem *pmem;
+
+	list_for_each_entry(pmem, &et_dev->ops.pinned_mem_list, list) {
+		if (uaddr >= pmem->uaddr &&
+		    uaddr + size <= pmem->uaddr + pmem->size)
+			return pmem;
+	}
+
+	return NULL;
+}
+
+/**
+ * et_dma_pinned_mem_fill_nodes() - Translate a DMA node into pinned memory
+ * @pmem: pointer to pinned memory containing the node host range
+ * @node: DMA node coming from user-space
+ * @out: array of DMA nodes to fill in
+ * @capacity: number of entries available in out array
+ *
+ * Pinned pages are not necessarily contiguous in DMA address space, so a user
+ * node is split at DMA segment boundaries of the pinned memory.
+ *
+ * Return: number of nodes filled in on success, negative value for error
+ */
+static int et_dma_pinned_mem_fill_nodes(struct et_pinned_mem *pmem,
+					const struct dma_node *node,
+					struct dma_node *out, u32 capacity)
+{
+	struct scatterlist *sg;
+	u64 offset = node->host_virt_addr - pmem->uaddr;
+	u64 remaining = node->size;
+	u64 seg_start = 0;
+	u64 seg_len, chunk;
+	u32 count = 0;
+	int i;
+
+	for_each_sgtable_dma_sg(pmem->attach ? pmem->dmabuf_sgt : &pmem->sgt,
+				sg, i) {
+		seg_len = sg_dma_len(sg);
+		if (offset >= seg_start + seg_len) {
+			seg_start += seg_len;
+			continue;
+		}
+
+		if (count >= capacity)
+			return -E2BIG;
+
+		chunk = min(remaining, seg_start + seg_len - offset);
+		out[count].host_virt_addr = pmem->uaddr + offset;
+		out[count].host_phys_addr =
+			sg_dma_address(sg) + offset - seg_start;
+		out[count].device_phys_addr =
+			node->device_phys_addr + node->size - remaining;
+		out[count].size = chunk;
+		count++;
+
+		offset += chunk;
+		remaining -= chunk;
+		seg_start += seg_len;
+		if (!remaining)
+			break;
+	}
+
+	return remaining ? -EINVAL : count;
+}
+
 /**
  * et_dma_move_data() - Forward DMA read/write request on SQ
  * @et_dev: pointer to et_pci_dev structure
  * @queue_index: SQ index
  * @ucmd: user pointer to command coming from user-space
  * @ucmd_size: size of user command
+ * @uout: user pointer receiving the translated command instead of pushing it
+ *	  on SQ, NULL to push it
+ * @uout_size: size of uout buffer
  *
  * Searches for coherent memory against mmapped virtual address and fills in
  * the device address of each node in DMA list command and pushes the command
- * on SQ.
+ * on SQ. Host addresses outside of the mmapped coherent memory are looked up
+ * in the user memory pinned with ETSOC1_IOCTL_REGISTER_HOST_MEM, in which
+ * case a node may be split in several nodes if the pinned pages are not
+ * contiguous in DMA address space. Other user memory is pinned and mapped for
+ * streaming DMA until the response of the command is received, if the command
+ * is pushed on SQ.
  *
- * Return: number of bytes written on SQ on success, negative value for error
+ * Return: number of bytes of user command written on SQ (or of translated
+ * command copied to uout) on success, negative value for error
  */
 ssize_t et_dma_move_data(struct et_pci_dev *et_dev, u16 queue_index,
-			 char __user *ucmd, size_t cmd_size)
+			 char __user *ucmd, size_t cmd_size, char __user *uout,
+			 size_t uout_size)
 {
 	ssize_t rv;
-	u32 node_num, nodes_count = 0;
+	u32 node_num, nodes_count = 0, out_count = 0, out_capacity;
+	size_t out_size;
+	u64 max_node_size;
 	struct et_dma_mapping *map;
+	struct et_pinned_mem *pmem;
 	struct vm_area_struct *vma;
-	struct device_ops_dma_list_cmd_t *cmd;
+	struct device_ops_dma_list_cmd_t *cmd, *out_cmd;
+	struct et_pinned_mem *tmp;
+	LIST_HEAD(stream_list);
+	u32 stream_count = 0;
 
 	nodes_count = (cmd_size - sizeof(*cmd)) / sizeof(cmd->list[0]);
 
@@ -52,13 +195,32 @@ ssize_t et_dma_move_data(struct et_pci_dev *et_dev, u16 queue_index,
 		goto free_cmd_mem;
 	}
 
+	// Nodes on pinned memory can be split, let them grow up to the number
+	// of nodes supported by device
+	out_capacity = max_t(
+		u32, nodes_count,
+		et_dev->ops.regions[OPS_MEM_REGION_TYPE_HOST_MANAGED]
+			.access.dma_elem_count);
+	out_cmd = kzalloc(struct_size(out_cmd, list, out_capacity), GFP_KERNEL);
+	if (!out_cmd) {
+		rv = -ENOMEM;
+		goto free_cmd_mem;
+	}
+	out_cmd->command_info = cmd->command_info;
+
+	max_node_size = et_dev->ops.regions[OPS_MEM_REGION_TYPE_HOST_MANAGED]
+				.access.dma_elem_size *
+			MEM_REGION_DMA_ELEMENT_STEP_SIZE;
+
+	mutex_lock(&et_dev->ops.pinned_mem_mutex);
+
 	for (node_num = 0; node_num < nodes_count; node_num++) {
 		if (!cmd->list[node_num].host_virt_addr) {
 			dev_err(&et_dev->pdev->dev,
 				"Invalid DMA list[%u].host_virt_addr: 0x%llx!",
 				node_num, cmd->list[node_num].host_virt_addr);
 			rv = -EINVAL;
-			goto free_cmd_mem;
+			goto unlock_pinned_mem;
 		}
 
 		if (!cmd->list[node_num].size) {
@@ -66,16 +228,63 @@ ssize_t et_dma_move_data(struct et_pci_dev *et_dev, u16 queue_index,
 				"Invalid DMA list[%u].size: %u!", node_num,
 				cmd->list[node_num].size);
 			rv = -EINVAL;
-			goto free_cmd_mem;
+			goto unlock_pinned_mem;
 		}
 
-		vma = et_find_vma(et_dev, cmd->list[node_num].host_virt_addr);
-		if (!vma) {
+		if (cmd->list[node_num].size > max_node_size) {
 			dev_err(&et_dev->pdev->dev,
-				"mapping for DMA list[%u].host_virt_addr not found!",
-				node_num);
+				"DMA list[%u].size out of bound (0x%x/0x%llx)!",
+				node_num, cmd->list[node_num].size,
+				max_node_size);
 			rv = -EINVAL;
-			goto free_cmd_mem;
+			goto unlock_pinned_mem;
+		}
+
+		vma = et_find_vma(et_dev, cmd->list[node_num].host_virt_addr);
+		if (!vma) {
+			pmem = et_dma_find_pinned_mem(
+				et_dev, cmd->list[node_num].host_virt_addr,
+				cmd->list[node_num].size);
+			// Translated commands are pushed by user-space, the
+			// driver can't tell when the mapping can be released
+			if (!pmem && !uout) {
+				pmem = et_dma_map_user_pages(
+					et_dev,
+					cmd->list[node_num].host_virt_addr,
+					cmd->list[node_num].size, false, false);
+				if (IS_ERR(pmem)) {
+					rv = PTR_ERR(pmem);
+					dev_err(&et_dev->pdev->dev,
+						"DMA list[%u].host_virt_addr can't be mapped (%zd)!",
+						node_num, rv);
+					goto unlock_pinned_mem;
+				}
+				pmem->tag_id =
+					cmd->command_info.cmd_hdr.tag_id;
+				list_add_tail(&pmem->list, &stream_list);
+				stream_count++;
+			}
+			if (!pmem) {
+				dev_err(&et_dev->pdev->dev,
+					"mapping for DMA list[%u].host_virt_addr not found!",
+					node_num);
+				rv = -EINVAL;
+				goto unlock_pinned_mem;
+			}
+
+			rv = et_dma_pinned_mem_fill_nodes(
+				pmem, &cmd->list[node_num],
+				&out_cmd->list[out_count],
+				out_capacity - out_count);
+			if (rv < 0) {
+				dev_err(&et_dev->pdev->dev,
+					"DMA list[%u] can't be mapped on pinned memory (%zd)!",
+					node_num, rv);
+				goto unlock_pinned_mem;
+			}
+
+			out_count += rv;
+			continue;
 		}
 
 		map = vma->vm_private_data;
@@ -84,22 +293,7 @@ ssize_t et_dma_move_data(struct et_pci_dev *et_dev, u16 queue_index,
 				"mapping for DMA list[%u].host_virt_addr is corrupted!",
 				node_num);
 			rv = -EINVAL;
-			goto free_cmd_mem;
-		}
-
-		if (cmd->list[node_num].size >
-		    et_dev->ops.regions[OPS_MEM_REGION_TYPE_HOST_MANAGED]
-				    .access.dma_elem_size *
-			    MEM_REGION_DMA_ELEMENT_STEP_SIZE) {
-			dev_err(&et_dev->pdev->dev,
-				"DMA list[%u].size out of bound (0x%x/0x%x)!",
-				node_num, cmd->list[node_num].size,
-				et_dev->ops.regions
-						[OPS_MEM_REGION_TYPE_HOST_MANAGED]
-							.access.dma_elem_size *
-					MEM_REGION_DMA_ELEMENT_STEP_SIZE);
-			rv = -EINVAL;
-			goto free_cmd_mem;
+			goto unlock_pinned_mem;
 		}
 
 		if (cmd->list[node_num].host_virt_addr +
@@ -109,27 +303,488 @@ ssize_t et_dma_move_data(struct et_pci_dev *et_dev, u16 queue_index,
 				"DMA list[%u]{.host_virt_addr + .size} out of bound!",
 				node_num);
 			rv = -EINVAL;
-			goto free_cmd_mem;
+			goto unlock_pinned_mem;
+		}
+
+		if (out_count >= out_capacity) {
+			dev_err(&et_dev->pdev->dev,
+				"DMA list: too many nodes after splitting!");
+			rv = -E2BIG;
+			goto unlock_pinned_mem;
 		}
 
-		cmd->list[node_num].host_phys_addr =
+		out_cmd->list[out_count] = cmd->list[node_num];
+		out_cmd->list[out_count].host_phys_addr =
 			map->dma_addr + cmd->list[node_num].host_virt_addr -
 			vma->vm_start;
+		out_count++;
 	}
 
-	rv = et_squeue_push(&et_dev->ops.vq_data.sqs[queue_index], cmd,
-			    cmd_size);
-	if (rv < 0)
-		goto free_cmd_mem;
+	out_size = struct_size(out_cmd, list, out_count);
+	out_cmd->command_info.cmd_hdr.size = out_size;
+
+	if (uout) {
+		if (out_size > uout_size) {
+			rv = -ENOSPC;
+			goto unlock_pinned_mem;
+		}
+		if (copy_to_user(uout, out_cmd, out_size)) {
+			dev_err(&et_dev->pdev->dev,
+				"DMA list: copy_to_user failed!");
+			rv = -EFAULT;
+			goto unlock_pinned_mem;
+		}
+		rv = out_size;
+		goto unlock_pinned_mem;
+	}
 
-	if (rv != cmd_size) {
+	// The response may be received as soon as the command is pushed
+	if (stream_count) {
+		mutex_lock(&et_dev->ops.stream_mem_mutex);
+		list_splice_tail_init(&stream_list,
+				      &et_dev->ops.stream_mem_list);
+		atomic_add(stream_count, &et_dev->ops.stream_mem_count);
+		mutex_unlock(&et_dev->ops.stream_mem_mutex);
+	}
+
+	rv = et_squeue_push(&et_dev->ops.vq_data.sqs[queue_index], out_cmd,
+			    out_size);
+	if (rv >= 0 && rv != out_size) {
 		dev_err(&et_dev->pdev->dev,
 			"DMA list: vqueue write didn't send all bytes\n");
 		rv = -EIO;
 	}
+	if (rv < 0) {
+		if (stream_count)
+			et_dma_release_stream_mem(
+				et_dev, cmd->command_info.cmd_hdr.tag_id);
+		goto unlock_pinned_mem;
+	}
+
+	rv = cmd_size;
+
+unlock_pinned_mem:
+	mutex_unlock(&et_dev->ops.pinned_mem_mutex);
+	kfree(out_cmd);
+
+	list_for_each_entry_safe(pmem, tmp, &stream_list, list) {
+		list_del(&pmem->list);
+		et_dma_release_pinned_mem(et_dev, pmem);
+	}
 
 free_cmd_mem:
 	kfree(cmd);
 
 	return rv;
 }
+
+/**
+ * et_dma_pinned_mem_contig_addr() - Find the DMA address of a pinned range
+ * @pmem: pointer to pinned memory containing the range
+ * @uaddr: start virtual address of the range in user-space
+ * @size: size of the range in bytes
+ * @dma_addr: pointer receiving the DMA address of the range
+ *
+ * Return: 0 on success, -EINVAL if the range spans several DMA segments of
+ * the pinned memory
+ */
+static int et_dma_pinned_mem_contig_addr(struct et_pinned_mem *pmem, u64 uaddr,
+					 u64 size, u64 *dma_addr)
+{
+	struct scatterlist *sg;
+	u64 offset = uaddr - pmem->uaddr;
+	u64 seg_start = 0;
+	u64 seg_len;
+	int i;
+
+	for_each_sgtable_dma_sg(pmem->attach ? pmem->dmabuf_sgt : &pmem->sgt,
+				sg, i) {
+		seg_len = sg_dma_len(sg);
+		if (offset >= seg_start + seg_len) {
+			seg_start += seg_len;
+			continue;
+		}
+
+		if (offset + size > seg_start + seg_len)
+			return -EINVAL;
+
+		*dma_addr = sg_dma_address(sg) + offset - seg_start;
+		return 0;
+	}
+
+	return -EINVAL;
+}
+
+/**
+ * et_dma_chain_move_data() - Forward DMA chain request on SQ
+ * @et_dev: pointer to et_pci_dev structure
+ * @queue_index: SQ index
+ * @ucmd: user pointer to command coming from user-space
+ * @cmd_size: size of user command
+ * @uout: user pointer receiving the translated command instead of pushing it
+ *	  on SQ, NULL to push it
+ * @uout_size: size of uout buffer
+ *
+ * The host side address of the chain elements is an offset in the host
+ * buffer of the command, so the buffer must be contiguous in DMA address
+ * space: it's either in mmapped coherent memory, or in a single DMA segment
+ * of the user memory pinned with ETSOC1_IOCTL_REGISTER_HOST_MEM. Fills in the
+ * DMA address of the buffer and pushes the command on SQ. The device checks
+ * every chain element against the buffer size.
+ *
+ * Return: number of bytes of user command written on SQ (or of translated
+ * command copied to uout) on success, negative value for error
+ */
+ssize_t et_dma_chain_move_data(struct et_pci_dev *et_dev, u16 queue_index,
+			       char __user *ucmd, size_t cmd_size,
+			       char __user *uout, size_t uout_size)
+{
+	ssize_t rv;
+	u64 dma_addr;
+	struct et_dma_mapping *map;
+	struct et_pinned_mem *pmem;
+	struct vm_area_struct *vma;
+	struct device_ops_dma_chain_cmd_t cmd;
+
+	if (cmd_size != sizeof(cmd)) {
+		dev_err(&et_dev->pdev->dev, "Invalid DMA chain cmd (size %zu)!",
+			cmd_size);
+		return -EINVAL;
+	}
+
+	if (copy_from_user(&cmd, ucmd, cmd_size)) {
+		dev_err(&et_dev->pdev->dev,
+			"DMA chain: copy_from_user failed!");
+		return -EFAULT;
+	}
+
+	if (!cmd.host_virt_addr || !cmd.host_size ||
+	    cmd.host_virt_addr + cmd.host_size < cmd.host_virt_addr) {
+		dev_err(&et_dev->pdev->dev,
+			"Invalid DMA chain host buffer (0x%llx, 0x%llx)!",
+			cmd.host_virt_addr, cmd.host_size);
+		return -EINVAL;
+	}
+
+	mutex_lock(&et_dev->ops.pinned_mem_mutex);
+
+	vma = et_find_vma(et_dev, cmd.host_virt_addr);
+	if (vma) {
+		map = vma->vm_private_data;
+		if (!map ||
+		    cmd.host_virt_addr + cmd.host_size > vma->vm_end) {
+			dev_err(&et_dev->pdev->dev,
+				"DMA chain host buffer out of bound!");
+			rv = -EINVAL;
+			goto unlock_pinned_mem;
+		}
+		dma_addr = map->dma_addr + cmd.host_virt_addr - vma->vm_start;
+	} else {
+		// Other user memory can't be mapped contiguous in DMA address
+		// space
+		pmem = et_dma_find_pinned_mem(et_dev, cmd.host_virt_addr,
+					      cmd.host_size);
+		if (!pmem ||
+		    et_dma_pinned_mem_contig_addr(pmem, cmd.host_virt_addr,
+						  cmd.host_size, &dma_addr)) {
+			dev_err(&et_dev->pdev->dev,
+				"DMA chain host buffer isn't DMA contiguous!");
+			rv = -EINVAL;
+			goto unlock_pinned_mem;
+		}
+	}
+	cmd.host_phys_addr = dma_addr;
+
+	if (uout) {
+		if (cmd_size > uout_size) {
+			rv = -ENOSPC;
+			goto unlock_pinned_mem;
+		}
+		if (copy_to_user(uout, &cmd, cmd_size)) {
+			dev_err(&et_dev->pdev->dev,
+				"DMA chain: copy_to_user failed!");
+			rv = -EFAULT;
+			goto unlock_pinned_mem;
+		}
+		rv = cmd_size;
+		goto unlock_pinned_mem;
+	}
+
+	rv = et_squeue_push(&et_dev->ops.vq_data.sqs[queue_index], &cmd,
+			    cmd_size);
+	if (rv >= 0 && rv != cmd_size) {
+		dev_err(&et_dev->pdev->dev,
+			"DMA chain: vqueue write didn't send all bytes\n");
+		rv = -EIO;
+	}
+
+unlock_pinned_mem:
+	mutex_unlock(&et_dev->ops.pinned_mem_mutex);
+
+	return rv;
+}
+
+/**
+ * et_dma_map_user_pages() - Pin user pages and map them for DMA
+ * @et_dev: pointer to et_pci_dev structure
+ * @uaddr: start virtual address of the range in user-space
+ * @size: size of the range in bytes
+ * @long_term: the range stays pinned until it's unpinned explicitly, otherwise
+ *	       only while a DMA command using it is in flight
+ * @to_device: the range is only read by the device
+ *
+ * Pages are pinned writeable since the memory can be used as DMA destination,
+ * unless @to_device is set, in which case they are pinned read-only and mapped
+ * for DMA to device only. Short-term ranges which can't be pinned writeable
+ * (i.e. read-only memory) are pinned read-only too.
+ *
+ * Return: pointer to struct et_pinned_mem on success, ERR_PTR() on failure
+ */
+static struct et_pinned_mem *et_dma_map_user_pages(struct et_pci_dev *et_dev,
+						   u64 uaddr, u64 size,
+						   bool long_term,
+						   bool to_device)
+{
+	int rv;
+	long pinned;
+	unsigned int gup_flags;
+	struct et_pinned_mem *pmem;
+
+	if (!uaddr || !size || uaddr + size < uaddr)
+		return ERR_PTR(-EINVAL);
+
+	pmem = kzalloc(sizeof(*pmem), GFP_KERNEL);
+	if (!pmem)
+		return ERR_PTR(-ENOMEM);
+
+	pmem->uaddr = uaddr;
+	pmem->size = size;
+	pmem->dir = to_device ? DMA_TO_DEVICE : DMA_BIDIRECTIONAL;
+	pmem->nr_pages = (PAGE_ALIGN(uaddr + size) - (uaddr & PAGE_MASK)) >>
+			 PAGE_SHIFT;
+	pmem->pages =
+		kvmalloc_array(pmem->nr_pages, sizeof(*pmem->pages), GFP_KERNEL);
+	if (!pmem->pages) {
+		rv = -ENOMEM;
+		goto free_pmem;
+	}
+
+	gup_flags = long_term ? FOLL_LONGTERM : 0;
+	if (!to_device)
+		gup_flags |= FOLL_WRITE;
+	pinned = pin_user_pages_fast(uaddr & PAGE_MASK, pmem->nr_pages,
+				     gup_flags, pmem->pages);
+	if (pinned == -EFAULT && !long_term && !to_device) {
+		pmem->dir = DMA_TO_DEVICE;
+		pinned = pin_user_pages_fast(uaddr & PAGE_MASK, pmem->nr_pages,
+					     0, pmem->pages);
+	}
+	if (pinned < 0) {
+		rv = pinned;
+		goto free_pages;
+	}
+
+	if (pinned != pmem->nr_pages) {
+		dev_err(&et_dev->pdev->dev,
+			"pin user mem: pinned %ld/%lu pages!", pinned,
+			pmem->nr_pages);
+		unpin_user_pages(pmem->pages, pinned);
+		rv = -EFAULT;
+		goto free_pages;
+	}
+
+	rv = sg_alloc_table_from_pages(&pmem->sgt, pmem->pages, pmem->nr_pages,
+				       offset_in_page(uaddr), size, GFP_KERNEL);
+	if (rv)
+		goto unpin_pages;
+
+	// Contiguous pages, or pages made contiguous by the IOMMU, are merged
+	// into a single DMA segment
+	rv = dma_map_sgtable(&et_dev->pdev->dev, &pmem->sgt, pmem->dir, 0);
+	if (rv)
+		goto free_sgt;
+
+	return pmem;
+
+free_sgt:
+	sg_free_table(&pmem->sgt);
+unpin_pages:
+	unpin_user_pages(pmem->pages, pmem->nr_pages);
+free_pages:
+	kvfree(pmem->pages);
+free_pmem:
+	kfree(pmem);
+
+	return ERR_PTR(rv);
+}
+
+/**
+ * et_dma_pin_user_mem() - Pin user memory and map it for DMA
+ * @et_dev: pointer to et_pci_dev structure
+ * @uaddr: start virtual address of the range in user-space
+ * @size: size of the range in bytes
+ * @flags: ETSOC1_HOST_MEM_FLAG_* flags
+ *
+ * Pages are pinned long-term, and writeable since the memory can be used as
+ * DMA destination at any time until it's unpinned, unless
+ * ETSOC1_HOST_MEM_FLAG_TO_DEVICE is set.
+ *
+ * Return: number of DMA contiguous segments backing the range on success,
+ * negative value for error
+ */
+int et_dma_pin_user_mem(struct et_pci_dev *et_dev, u64 uaddr, u64 size,
+			u32 flags)
+{
+	struct et_pinned_mem *pmem;
+	int nents, rv;
+
+	if (flags & ~ETSOC1_HOST_MEM_FLAG_TO_DEVICE)
+		return -EINVAL;
+
+	pmem = et_dma_map_user_pages(et_dev, uaddr, size, true,
+				     flags & ETSOC1_HOST_MEM_FLAG_TO_DEVICE);
+	if (IS_ERR(pmem))
+		return PTR_ERR(pmem);
+
+	nents = pmem->sgt.nents;
+	rv = et_dma_register_pinned_mem(et_dev, pmem);
+
+	return rv ? rv : nents;
+}
+
+/**
+ * et_dma_register_pinned_mem() - Add a pinned memory to the pinned memory list
+ * @et_dev: pointer to et_pci_dev structure
+ * @pmem: pinned memory, either pinned user pages or an imported dma-buf
+ *
+ * The pinned memory is released if its range overlaps with another one.
+ *
+ * Return: 0 on success, negative value for error
+ */
+int et_dma_register_pinned_mem(struct et_pci_dev *et_dev,
+			       struct et_pinned_mem *pmem)
+{
+	struct et_pinned_mem *other;
+
+	mutex_lock(&et_dev->ops.pinned_mem_mutex);
+	list_for_each_entry(other, &et_dev->ops.pinned_mem_list, list) {
+		if (pmem->uaddr < other->uaddr + other->size &&
+		    other->uaddr < pmem->uaddr + pmem->size) {
+			mutex_unlock(&et_dev->ops.pinned_mem_mutex);
+			dev_err(&et_dev->pdev->dev,
+				"pin user mem: range overlaps with pinned memory!");
+			et_dma_release_pinned_mem(et_dev, pmem);
+			return -EEXIST;
+		}
+	}
+	list_add(&pmem->list, &et_dev->ops.pinned_mem_list);
+	mutex_unlock(&et_dev->ops.pinned_mem_mutex);
+
+	return 0;
+}
+
+/**
+ * et_dma_release_pinned_mem() - Unmap and unpin a pinned memory
+ * @et_dev: pointer to et_pci_dev structure
+ * @pmem: pinned memory, already removed from the pinned memory list
+ *
+ * Imported dma-bufs are unmapped and detached instead.
+ */
+static void et_dma_release_pinned_mem(struct et_pci_dev *et_dev,
+				      struct et_pinned_mem *pmem)
+{
+	if (pmem->attach) {
+		et_dmabuf_release_import(pmem);
+		kfree(pmem);
+		return;
+	}
+
+	dma_unmap_sgtable(&et_dev->pdev->dev, &pmem->sgt, pmem->dir, 0);
+	sg_free_table(&pmem->sgt);
+	unpin_user_pages_dirty_lock(pmem->pages, pmem->nr_pages,
+				    pmem->dir != DMA_TO_DEVICE);
+	kvfree(pmem->pages);
+	kfree(pmem);
+}
+
+/**
+ * et_dma_unpin_user_mem() - Unpin user memory previously pinned
+ * @et_dev: pointer to et_pci_dev structure
+ * @uaddr: start virtual address used to pin the memory
+ *
+ * Return: 0 on success, negative value for error
+ */
+int et_dma_unpin_user_mem(struct et_pci_dev *et_dev, u64 uaddr)
+{
+	struct et_pinned_mem *pmem;
+
+	mutex_lock(&et_dev->ops.pinned_mem_mutex);
+	list_for_each_entry(pmem, &et_dev->ops.pinned_mem_list, list) {
+		if (pmem->uaddr == uaddr) {
+			list_del(&pmem->list);
+			mutex_unlock(&et_dev->ops.pinned_mem_mutex);
+			et_dma_release_pinned_mem(et_dev, pmem);
+			return 0;
+		}
+	}
+	mutex_unlock(&et_dev->ops.pinned_mem_mutex);
+
+	return -EINVAL;
+}
+
+/**
+ * et_dma_unpin_all_user_mem() - Unpin all user memory pinned on the device
+ * @et_dev: pointer to et_pci_dev structure
+ *
+ * Includes the memory mapped for DMA commands whose response wasn't received
+ */
+void et_dma_unpin_all_user_mem(struct et_pci_dev *et_dev)
+{
+	struct et_pinned_mem *pmem, *tmp;
+	LIST_HEAD(pinned_mem_list);
+
+	mutex_lock(&et_dev->ops.pinned_mem_mutex);
+	list_splice_init(&et_dev->ops.pinned_mem_list, &pinned_mem_list);
+	mutex_unlock(&et_dev->ops.pinned_mem_mutex);
+
+	mutex_lock(&et_dev->ops.stream_mem_mutex);
+	list_splice_tail_init(&et_dev->ops.stream_mem_list, &pinned_mem_list);
+	atomic_set(&et_dev->ops.stream_mem_count, 0);
+	mutex_unlock(&et_dev->ops.stream_mem_mutex);
+
+	list_for_each_entry_safe(pmem, tmp, &pinned_mem_list, list) {
+		list_del(&pmem->list);
+		et_dma_release_pinned_mem(et_dev, pmem);
+	}
+}
+
+/**
+ * et_dma_release_stream_mem() - Unmap and unpin the user memory mapped for a
+ * DMA command
+ * @et_dev: pointer to et_pci_dev structure
+ * @tag_id: tag ID of the DMA command, called with the tag ID of each ops
+ *	    device response
+ */
+void et_dma_release_stream_mem(struct et_pci_dev *et_dev, u16 tag_id)
+{
+	struct et_pinned_mem *pmem, *tmp;
+	LIST_HEAD(release_list);
+
+	if (!atomic_read(&et_dev->ops.stream_mem_count))
+		return;
+
+	mutex_lock(&et_dev->ops.stream_mem_mutex);
+	list_for_each_entry_safe(pmem, tmp, &et_dev->ops.stream_mem_list,
+				 list) {
+		if (pmem->tag_id == tag_id) {
+			list_move_tail(&pmem->list, &release_list);
+			atomic_dec(&et_dev->ops.stream_mem_count);
+		}
+	}
+	mutex_unlock(&et_dev->ops.stream_mem_mutex);
+
+	list_for_each_entry_safe(pmem, tmp, &release_list, list) {
+		list_del(&pmem->list);
+		et_dma_release_pinned_mem(et_dev, pmem);
+	}
+}
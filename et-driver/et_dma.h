@@ -9,8 +9,13 @@
 #ifndef __ET_DMA_H
 #define __ET_DMA_H
 
+#include <linux/dma-buf.h>
+#include <linux/dma-direction.h>
 #include <linux/kernel.h>
+#include <linux/kref.h>
+#include <linux/list.h>
 #include <linux/pci.h>
+#include <linux/scatterlist.h>
 
 #include "et_pci_dev.h"
 
@@ -21,7 +26,8 @@
  * @kern_vaddr: virtual address pointer in kernel-space
  * @dma_addr: DMA address to be used by DMA engine
  * @size: size of mapping in bytes
- * @ref_count: reference count of mapping
+ * @ref: references of the mapping, one per VMA mapping it and one per dma-buf
+ *	 exporting it
  */
 struct et_dma_mapping {
 	void *usr_vaddr;
@@ -29,10 +35,55 @@ struct et_dma_mapping {
 	void *kern_vaddr;
 	dma_addr_t dma_addr;
 	size_t size;
-	size_t ref_count;
+	struct kref ref;
 };
 
+/**
+ * struct et_pinned_mem - User memory pinned and mapped for zero-copy DMA
+ * @list: Entry in et_ops_dev.pinned_mem_list
+ * @uaddr: Start virtual address of the range in user-space
+ * @size: Size of the range in bytes
+ * @pages: Pinned pages backing the range
+ * @nr_pages: Number of pinned pages
+ * @sgt: Scatter-gather table of the range, mapped for DMA
+ * @dir: DMA direction the range is mapped for
+ * @attach: Attachment of the imported dma-buf backing the range instead of
+ *	    pinned pages, NULL for user memory
+ * @dmabuf_sgt: DMA mapped scatter-gather table of the attachment, used
+ *		instead of @sgt
+ * @tag_id: Tag ID of the DMA command the range is mapped for, only for ranges
+ *	    in et_ops_dev.stream_mem_list
+ */
+struct et_pinned_mem {
+	struct list_head list;
+	unsigned long uaddr;
+	size_t size;
+	struct page **pages;
+	unsigned long nr_pages;
+	struct sg_table sgt;
+	enum dma_data_direction dir;
+	struct dma_buf_attachment *attach;
+	struct sg_table *dmabuf_sgt;
+	u16 tag_id;
+};
+
+void et_dma_mapping_get(struct et_dma_mapping *map);
+void et_dma_mapping_put(struct et_dma_mapping *map);
+
 ssize_t et_dma_move_data(struct et_pci_dev *et_dev, u16 queue_index,
-			 char __user *ucmd, size_t ucmd_size);
+			 char __user *ucmd, size_t ucmd_size, char __user *uout,
+			 size_t uout_size);
+
+ssize_t et_dma_chain_move_data(struct et_pci_dev *et_dev, u16 queue_index,
+			       char __user *ucmd, size_t ucmd_size,
+			       char __user *uout, size_t uout_size);
+
+int et_dma_pin_user_mem(struct et_pci_dev *et_dev, u64 uaddr, u64 size,
+			u32 flags);
+int et_dma_register_pinned_mem(struct et_pci_dev *et_dev,
+			       struct et_pinned_mem *pmem);
+int et_dma_unpin_user_mem(struct et_pci_dev *et_dev, u64 uaddr);
+void et_dma_unpin_all_user_mem(struct et_pci_dev *et_dev);
+void et_dma_release_stream_mem(struct et_pci_dev *et_dev, u16 tag_id);
 
 #endif
@@ -0,0 +1,437 @@
+// SPDX-License-Identifier: GPL-2.0
+
+/***********************************************************************
+ *
+ * Copyright (c) 2025 Ainekko, Co.
+ *
+ **********************************************************************/
+
+#include <linux/capability.h>
+#include <linux/dma-mapping.h>
+#include <linux/dma-resv.h>
+#include <linux/module.h>
+#include <linux/pci-p2pdma.h>
+#include <linux/sizes.h>
+#include <linux/slab.h>
+#include <linux/version.h>
+
+#include "et_dmabuf.h"
+#include "et_device_api.h"
+#include "et_vma.h"
+
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6, 13, 0)
+MODULE_IMPORT_NS("DMA_BUF");
+#elif LINUX_VERSION_CODE >= KERNEL_VERSION(5, 16, 0)
+MODULE_IMPORT_NS(DMA_BUF);
+#endif
+
+/* Max size of a scatterlist entry of an exported DRAM range */
+#define ET_DMABUF_DRAM_SEG_SIZE SZ_1G
+
+/**
+ * et_dmabuf_attach() - Check that an importer can reach the exported range
+ * @dmabuf: exported dma-buf
+ * @attach: attachment of the importer device
+ *
+ * Host managed DRAM ranges are only reachable peer-to-peer, by importers
+ * allowing it and having a P2P DMA path to the device.
+ *
+ * Return: 0 on success, negative value for error
+ */
+static int et_dmabuf_attach(struct dma_buf *dmabuf,
+			    struct dma_buf_attachment *attach)
+{
+	struct et_dmabuf_export *exp = dmabuf->priv;
+
+	if (exp->map)
+		return 0;
+
+	if (!attach->peer2peer ||
+	    pci_p2pdma_distance(exp->pdev, attach->dev, true) < 0)
+		return -EOPNOTSUPP;
+
+	return 0;
+}
+
+static struct sg_table *et_dmabuf_map_cma(struct et_dmabuf_export *exp,
+					  struct dma_buf_attachment *attach,
+					  enum dma_data_direction dir)
+{
+	struct sg_table *sgt;
+	int rv;
+
+	sgt = kzalloc(sizeof(*sgt), GFP_KERNEL);
+	if (!sgt)
+		return ERR_PTR(-ENOMEM);
+
+	rv = dma_get_sgtable(&exp->pdev->dev, sgt, exp->map->kern_vaddr,
+			     exp->map->dma_addr, exp->map->size);
+	if (rv)
+		goto free_sgt;
+
+	rv = dma_map_sgtable(attach->dev, sgt, dir, 0);
+	if (rv)
+		goto free_table;
+
+	return sgt;
+
+free_table:
+	sg_free_table(sgt);
+free_sgt:
+	kfree(sgt);
+
+	return ERR_PTR(rv);
+}
+
+static struct sg_table *et_dmabuf_map_dram(struct et_dmabuf_export *exp,
+					   struct dma_buf_attachment *attach,
+					   enum dma_data_direction dir)
+{
+	struct sg_table *sgt;
+	struct scatterlist *sg;
+	size_t offset = 0, len;
+	dma_addr_t addr;
+	int i, rv;
+
+	sgt = kzalloc(sizeof(*sgt), GFP_KERNEL);
+	if (!sgt)
+		return ERR_PTR(-ENOMEM);
+
+	rv = sg_alloc_table(sgt,
+			    DIV_ROUND_UP(exp->size, ET_DMABUF_DRAM_SEG_SIZE),
+			    GFP_KERNEL);
+	if (rv)
+		goto free_sgt;
+
+	// BAR memory has no struct page, only the DMA addresses of the
+	// entries are filled in
+	for_each_sgtable_sg(sgt, sg, i) {
+		len = min_t(size_t, exp->size - offset,
+			    ET_DMABUF_DRAM_SEG_SIZE);
+		addr = dma_map_resource(attach->dev, exp->phys_addr + offset,
+					len, dir, DMA_ATTR_SKIP_CPU_SYNC);
+		if (dma_mapping_error(attach->dev, addr)) {
+			rv = -EIO;
+			goto unmap_sg;
+		}
+		sg->length = len;
+		sg_dma_address(sg) = addr;
+		sg_dma_len(sg) = len;
+		offset += len;
+	}
+
+	return sgt;
+
+unmap_sg:
+	for_each_sgtable_sg(sgt, sg, i) {
+		if (!sg_dma_len(sg))
+			break;
+		dma_unmap_resource(attach->dev, sg_dma_address(sg),
+				   sg_dma_len(sg), dir, DMA_ATTR_SKIP_CPU_SYNC);
+	}
+	sg_free_table(sgt);
+free_sgt:
+	kfree(sgt);
+
+	return ERR_PTR(rv);
+}
+
+static struct sg_table *et_dmabuf_map(struct dma_buf_attachment *attach,
+				      enum dma_data_direction dir)
+{
+	struct et_dmabuf_export *exp = attach->dmabuf->priv;
+
+	if (exp->map)
+		return et_dmabuf_map_cma(exp, attach, dir);
+
+	return et_dmabuf_map_dram(exp, attach, dir);
+}
+
+static void et_dmabuf_unmap(struct dma_buf_attachment *attach,
+			    struct sg_table *sgt, enum dma_data_direction dir)
+{
+	struct et_dmabuf_export *exp = attach->dmabuf->priv;
+	struct scatterlist *sg;
+	int i;
+
+	if (exp->map) {
+		dma_unmap_sgtable(attach->dev, sgt, dir, 0);
+	} else {
+		for_each_sgtable_sg(sgt, sg, i)
+			dma_unmap_resource(attach->dev, sg_dma_address(sg),
+					   sg_dma_len(sg), dir,
+					   DMA_ATTR_SKIP_CPU_SYNC);
+	}
+
+	sg_free_table(sgt);
+	kfree(sgt);
+}
+
+/**
+ * et_dmabuf_mmap() - mmap an exported CMA buffer
+ * @dmabuf: exported dma-buf
+ * @vma: VMA of the mapping, with its offset in the dma-buf
+ *
+ * Host managed DRAM ranges are mapped with the ETSOC1_MMAP_OFFSET_DEVICE_DRAM
+ * offset of the ops device instead.
+ *
+ * Return: 0 on success, negative value for error
+ */
+static int et_dmabuf_mmap(struct dma_buf *dmabuf, struct vm_area_struct *vma)
+{
+	struct et_dmabuf_export *exp = dmabuf->priv;
+
+	if (!exp->map)
+		return -EINVAL;
+
+	return dma_mmap_coherent(&exp->pdev->dev, vma, exp->map->kern_vaddr,
+				 exp->map->dma_addr, exp->map->size);
+}
+
+static void et_dmabuf_release(struct dma_buf *dmabuf)
+{
+	struct et_dmabuf_export *exp = dmabuf->priv;
+
+	if (exp->map)
+		et_dma_mapping_put(exp->map);
+	pci_dev_put(exp->pdev);
+	kfree(exp);
+}
+
+// clang-format off
+static const struct dma_buf_ops et_dmabuf_ops = {
+	.attach		= et_dmabuf_attach,
+	.map_dma_buf	= et_dmabuf_map,
+	.unmap_dma_buf	= et_dmabuf_unmap,
+	.mmap		= et_dmabuf_mmap,
+	.release	= et_dmabuf_release,
+};
+
+// clang-format on
+
+/**
+ * et_dmabuf_export_dram() - Find the BAR range of a host managed DRAM range
+ * @et_dev: pointer to et_pci_dev structure
+ * @exp: export, its size is the size of the range
+ * @dev_addr: device address of the range
+ *
+ * Needs CAP_SYS_RAWIO since the importer can access the range regardless of
+ * the allocations of the runtime.
+ *
+ * Return: 0 on success, negative value for error
+ */
+static int et_dmabuf_export_dram(struct et_pci_dev *et_dev,
+				 struct et_dmabuf_export *exp, u64 dev_addr)
+{
+	struct et_mapped_region *region;
+
+	if (!capable(CAP_SYS_RAWIO))
+		return -EPERM;
+
+	region = &et_dev->ops.regions[OPS_MEM_REGION_TYPE_HOST_MANAGED];
+	if (!region->is_valid || !region->bar_phys_addr ||
+	    !(region->access.node_access & MEM_REGION_NODE_ACCESSIBLE_OPS))
+		return -EACCES;
+
+	if (dev_addr < region->dev_phys_addr ||
+	    dev_addr - region->dev_phys_addr >= region->size ||
+	    exp->size > region->size - (dev_addr - region->dev_phys_addr))
+		return -EINVAL;
+
+	exp->phys_addr = region->bar_phys_addr + dev_addr -
+			 region->dev_phys_addr;
+
+	return 0;
+}
+
+/**
+ * et_dmabuf_export() - Export a CMA buffer or a host managed DRAM range as a
+ * dma-buf
+ * @et_dev: pointer to et_pci_dev structure
+ * @desc: export descriptor, desc->fd is filled in on success
+ *
+ * A CMA buffer is exported whole: desc->addr must be its start address and
+ * desc->size its size. The dma-buf keeps the buffer allocated after it's
+ * unmapped from user-space, until the dma-buf is released.
+ *
+ * Return: 0 on success, negative value for error
+ */
+int et_dmabuf_export(struct et_pci_dev *et_dev,
+		     struct dmabuf_export_desc *desc)
+{
+	DEFINE_DMA_BUF_EXPORT_INFO(exp_info);
+	struct et_dmabuf_export *exp;
+	struct dma_buf *dmabuf;
+	u64 offset;
+	int rv;
+
+	if (!desc->size || desc->flags & ~ETSOC1_DMABUF_FLAG_DEVICE_DRAM)
+		return -EINVAL;
+
+	exp = kzalloc(sizeof(*exp), GFP_KERNEL);
+	if (!exp)
+		return -ENOMEM;
+
+	exp->size = desc->size;
+	if (desc->flags & ETSOC1_DMABUF_FLAG_DEVICE_DRAM) {
+		rv = et_dmabuf_export_dram(et_dev, exp, desc->addr);
+		if (rv)
+			goto free_exp;
+	} else {
+		exp->map = et_get_dma_mapping(et_dev, desc->addr, &offset);
+		if (!exp->map) {
+			rv = -EINVAL;
+			goto free_exp;
+		}
+		if (offset || desc->size != exp->map->size) {
+			rv = -EINVAL;
+			goto put_map;
+		}
+	}
+	exp->pdev = pci_dev_get(et_dev->pdev);
+
+	exp_info.ops = &et_dmabuf_ops;
+	exp_info.size = exp->size;
+	exp_info.flags = O_RDWR;
+	exp_info.priv = exp;
+	dmabuf = dma_buf_export(&exp_info);
+	if (IS_ERR(dmabuf)) {
+		rv = PTR_ERR(dmabuf);
+		goto put_pdev;
+	}
+
+	// The export is released with the dma-buf from now on
+	rv = dma_buf_fd(dmabuf, O_CLOEXEC);
+	if (rv < 0) {
+		dma_buf_put(dmabuf);
+		return rv;
+	}
+	desc->fd = rv;
+
+	return 0;
+
+put_pdev:
+	pci_dev_put(exp->pdev);
+put_map:
+	if (exp->map)
+		et_dma_mapping_put(exp->map);
+free_exp:
+	kfree(exp);
+
+	return rv;
+}
+
+/*
+ * Imported dma-bufs are pinned, so the exporter never moves them while they
+ * are attached
+ */
+static void et_dmabuf_move_notify(struct dma_buf_attachment *attach)
+{
+}
+
+// clang-format off
+static const struct dma_buf_attach_ops et_dmabuf_importer_ops = {
+	.allow_peer2peer	= true,
+	.move_notify		= et_dmabuf_move_notify,
+};
+
+// clang-format on
+
+/**
+ * et_dmabuf_import() - Import a dma-buf for DMA list commands
+ * @et_dev: pointer to et_pci_dev structure
+ * @desc: import descriptor, desc->size is filled in on success
+ *
+ * The dma-buf is attached, pinned and mapped for DMA by the device, it's
+ * registered like pinned user memory at desc->addr so the nodes of DMA list
+ * commands in [desc->addr, desc->addr + desc->size) are translated to it. The
+ * importer allows peer-to-peer, so it can be device memory of another device
+ * (e.g. a NIC or a GPU) reachable with P2P DMA.
+ *
+ * Return: number of DMA contiguous segments backing the dma-buf on success,
+ * negative value for error
+ */
+int et_dmabuf_import(struct et_pci_dev *et_dev,
+		     struct dmabuf_import_desc *desc)
+{
+	struct et_pinned_mem *pmem;
+	struct dma_buf *dmabuf;
+	int nents, rv;
+
+	if (desc->pad || !desc->addr)
+		return -EINVAL;
+
+	dmabuf = dma_buf_get(desc->fd);
+	if (IS_ERR(dmabuf))
+		return PTR_ERR(dmabuf);
+
+	if (desc->addr + dmabuf->size < desc->addr) {
+		rv = -EINVAL;
+		goto put_dmabuf;
+	}
+
+	pmem = kzalloc(sizeof(*pmem), GFP_KERNEL);
+	if (!pmem) {
+		rv = -ENOMEM;
+		goto put_dmabuf;
+	}
+
+	pmem->uaddr = desc->addr;
+	pmem->size = dmabuf->size;
+	pmem->dir = DMA_BIDIRECTIONAL;
+	pmem->attach = dma_buf_dynamic_attach(dmabuf, &et_dev->pdev->dev,
+					      &et_dmabuf_importer_ops, pmem);
+	if (IS_ERR(pmem->attach)) {
+		rv = PTR_ERR(pmem->attach);
+		goto free_pmem;
+	}
+
+	dma_resv_lock(dmabuf->resv, NULL);
+	rv = dma_buf_pin(pmem->attach);
+	if (!rv) {
+		pmem->dmabuf_sgt =
+			dma_buf_map_attachment(pmem->attach, pmem->dir);
+		if (IS_ERR(pmem->dmabuf_sgt)) {
+			rv = PTR_ERR(pmem->dmabuf_sgt);
+			dma_buf_unpin(pmem->attach);
+		}
+	}
+	dma_resv_unlock(dmabuf->resv);
+	if (rv)
+		goto detach;
+
+	desc->size = pmem->size;
+	nents = pmem->dmabuf_sgt->nents;
+
+	// The dma-buf is released with the pinned memory from now on
+	rv = et_dma_register_pinned_mem(et_dev, pmem);
+
+	return rv ? rv : nents;
+
+detach:
+	dma_buf_detach(dmabuf, pmem->attach);
+free_pmem:
+	kfree(pmem);
+put_dmabuf:
+	dma_buf_put(dmabuf);
+
+	return rv;
+}
+
+/**
+ * et_dmabuf_release_import() - Unmap, unpin, detach and put an imported
+ * dma-buf
+ * @pmem: pinned memory of the imported dma-buf, pmem itself isn't freed
+ */
+void et_dmabuf_release_import(struct et_pinned_mem *pmem)
+{
+	struct dma_buf *dmabuf = pmem->attach->dmabuf;
+
+	dma_resv_lock(dmabuf->resv, NULL);
+	dma_buf_unmap_attachment(pmem->attach, pmem->dmabuf_sgt, pmem->dir);
+	dma_buf_unpin(pmem->attach);
+	dma_resv_unlock(dmabuf->resv);
+
+	dma_buf_detach(dmabuf, pmem->attach);
+	dma_buf_put(dmabuf);
+}
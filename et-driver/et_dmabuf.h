@@ -0,0 +1,39 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+
+/***********************************************************************
+ *
+ * Copyright (c) 2025 Ainekko, Co.
+ *
+ **********************************************************************/
+
+#ifndef __ET_DMABUF_H
+#define __ET_DMABUF_H
+
+#include <linux/dma-buf.h>
+#include <linux/kernel.h>
+
+#include "et_dma.h"
+#include "et_ioctl.h"
+#include "et_pci_dev.h"
+
+/**
+ * struct et_dmabuf_export - Range of the device exported as a dma-buf
+ * @pdev: pointer to pci_dev structure, referenced while the dma-buf exists
+ * @map: CMA buffer exported, NULL for a host managed DRAM range
+ * @phys_addr: CPU physical address of the host managed DRAM range in the BAR
+ * @size: size of the range in bytes
+ */
+struct et_dmabuf_export {
+	struct pci_dev *pdev;
+	struct et_dma_mapping *map;
+	phys_addr_t phys_addr;
+	size_t size;
+};
+
+int et_dmabuf_export(struct et_pci_dev *et_dev,
+		     struct dmabuf_export_desc *desc);
+int et_dmabuf_import(struct et_pci_dev *et_dev,
+		     struct dmabuf_import_desc *desc);
+void et_dmabuf_release_import(struct et_pinned_mem *pmem);
+
+#endif
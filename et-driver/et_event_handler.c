@@ -566,6 +566,62 @@ parse_trace_buffer_event_syndrome(struct device_mgmt_event_msg_t *event_msg,
 		event_msg->event_syndrome[0], event_msg->event_syndrome[1]);
 }
 
+/**
+ * parse_event_summary_syndrome() - Parses event summary syndrome
+ * @event_msg: Raw event information
+ * @dbg_msg: Parsed event information in string form
+ * @stats: Error statistics to account the coalesced events in
+ *
+ * The device coalesces bursts of events: only the first event of a kind in a
+ * time window is sent, the following ones are counted and their detail is
+ * logged to the SP trace buffer.
+ */
+static void
+parse_event_summary_syndrome(struct device_mgmt_event_msg_t *event_msg,
+			     struct event_dbg_msg *dbg_msg,
+			     struct et_err_stats *stats)
+{
+	/* See the device, in the order of their counts in the syndrome */
+	static const struct {
+		const char *desc;
+		int counter;
+	} coalesced[] = {
+		{ "PCIe CE", ET_ERR_COUNTER_STATS_PCIE_CE_COUNT },
+		{ "DRAM CE", ET_ERR_COUNTER_STATS_DRAM_CE_COUNT },
+		{ "SRAM CE", ET_ERR_COUNTER_STATS_SRAM_CE_COUNT },
+		{ "Temperature Overshoot",
+		  ET_ERR_COUNTER_STATS_THERM_OVERSHOOT_CE_COUNT },
+		{ "PCIe UCE", ET_ERR_COUNTER_STATS_PCIE_UCE_COUNT },
+		{ "DRAM UCE", ET_ERR_COUNTER_STATS_DRAM_UCE_COUNT },
+		{ "SRAM UCE", ET_ERR_COUNTER_STATS_SRAM_UCE_COUNT },
+	};
+	char value_str[VALUE_STR_MAX_LEN];
+	u64 count;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(coalesced); i++) {
+		count = (event_msg->event_syndrome[i /
+						   EVENT_SUMMARY_COUNTS_PER_WORD] >>
+			 (EVENT_SUMMARY_COUNT_BITS *
+			  (i % EVENT_SUMMARY_COUNTS_PER_WORD))) &
+			EVENT_SUMMARY_COUNT_MASK;
+		if (!count)
+			continue;
+		atomic64_add(count, &stats->counters[coalesced[i].counter]);
+		snprintf(value_str, VALUE_STR_MAX_LEN, "%s: %llu\n",
+			 coalesced[i].desc, count);
+		strlcat(dbg_msg->syndrome, value_str, ET_EVENT_SYNDROME_LEN);
+	}
+
+	count = (event_msg->event_syndrome[1] >> EVENT_SUMMARY_DROPPED_SHIFT) &
+		EVENT_SUMMARY_COUNT_MASK;
+	if (count) {
+		snprintf(value_str, VALUE_STR_MAX_LEN, "Dropped: %llu\n",
+			 count);
+		strlcat(dbg_msg->syndrome, value_str, ET_EVENT_SYNDROME_LEN);
+	}
+}
+
 /**
  * et_handle_device_event() - Handle processing of all types of events from CQ
  * @cq: Pointer to struct et_cqueue
@@ -718,6 +774,10 @@ int et_handle_device_event(struct et_cqueue *cq,
 			&stats->counters
 				 [ET_ERR_COUNTER_STATS_SP_TRACE_FULL_CE_COUNT]);
 		break;
+	case DEV_MGMT_API_MID_SP_EVENT_SUMMARY_EVENT:
+		dbg_msg.desc = "Coalesced Events Summary";
+		parse_event_summary_syndrome(event_msg, &dbg_msg, stats);
+		break;
 	default:
 		dbg_msg.desc = "Un-Supported Event MSG ID";
 		dev_err(&pdev->dev, "Event MSG ID [%d] is invalid\n",
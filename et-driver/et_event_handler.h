@@ -135,6 +135,15 @@ enum error_type { CORRECTABLE, UNCORRETABLE };
 #define GET_OVER_THROTTLE_DURATION_BITS(reg)		\
 	((reg) & 0x00000000FFFFFFFFULL)
 
+/*
+ * Event summary syndrome: 16-bit counts of the coalesced events, four per
+ * syndrome word, and the events dropped by the device in syndrome[1][63:48]
+ */
+#define EVENT_SUMMARY_COUNT_BITS	16
+#define EVENT_SUMMARY_COUNT_MASK	0xFFFFULL
+#define EVENT_SUMMARY_COUNTS_PER_WORD	4
+#define EVENT_SUMMARY_DROPPED_SHIFT	48
+
 // clang-format on
 
 /**
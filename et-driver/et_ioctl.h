@@ -23,7 +23,18 @@ enum cmd_desc_flag {
 	CMD_DESC_FLAG_MM_RESET = 0x1 << 1,
 	CMD_DESC_FLAG_HIGH_PRIORITY = 0x1 << 2,
 	CMD_DESC_FLAG_ETSOC_RESET = 0x1 << 3,
-	CMD_DESC_FLAG_P2PDMA = 0x1 << 4
+	CMD_DESC_FLAG_P2PDMA = 0x1 << 4,
+	CMD_DESC_FLAG_DMA_CHAIN = 0x1 << 5
+};
+
+/**
+ * enum vq_eventfd_type - Type values for struct vq_eventfd_desc
+ * @VQ_EVENTFD_CQ_AVAIL: Signaled when a response can be popped from the CQ
+ * @VQ_EVENTFD_SQ_AVAIL: Signaled when any SQ has space for its threshold
+ */
+enum vq_eventfd_type {
+	VQ_EVENTFD_CQ_AVAIL = 0,
+	VQ_EVENTFD_SQ_AVAIL
 };
 
 /**
@@ -111,6 +122,21 @@ struct cmd_desc {
 	__u8 flags;
 };
 
+/**
+ * struct cmd_batch_desc - Descriptor for ETSOC1_IOCTL_PUSH_SQ_BATCH
+ * @cmds: Pointer to command memory in user-space, holding several commands
+ * back to back. The size of each command is taken from its header
+ * @size: Size of the buffer in bytes
+ * @sq_index: SQ index
+ * @flags: value of enum cmd_desc_flag, DMA and P2PDMA commands can't be batched
+ */
+struct cmd_batch_desc {
+	void *cmds;
+	__u32 size;
+	__u16 sq_index;
+	__u8 flags;
+};
+
 /**
  * struct rsp_desc - Descriptor for ETSOC1_IOCTL_POP_CQ
  * @rsp: Pointer to response memory in user-space
@@ -123,6 +149,140 @@ struct rsp_desc {
 	__u16 cq_index;
 };
 
+/**
+ * struct rsp_batch_desc - Descriptor for ETSOC1_IOCTL_POP_CQ_BATCH
+ * @rsps: Pointer to an array of struct rsp_desc in user-space. On return, the
+ * size of each popped entry is updated with the size of its response
+ * @count: Number of entries in rsps array
+ * @cq_index: CQ index, rsp_desc.cq_index of the entries is ignored
+ */
+struct rsp_batch_desc {
+	struct rsp_desc *rsps;
+	__u16 count;
+	__u16 cq_index;
+};
+
+/**
+ * struct host_mem_desc - Descriptor for ETSOC1_IOCTL_REGISTER_HOST_MEM and
+ * ETSOC1_IOCTL_UNREGISTER_HOST_MEM
+ * @addr: Start virtual address of the user-space memory range
+ * @size: Size of the memory range in bytes, ignored on unregister
+ * @flags: ETSOC1_HOST_MEM_FLAG_* flags, ignored on unregister
+ * @pad: Reserved, must be 0
+ */
+struct host_mem_desc {
+	__u64 addr;
+	__u64 size;
+	__u32 flags;
+	__u32 pad;
+};
+
+/*
+ * The memory is only read by the device (host to device DMA), it's pinned
+ * without write access so read-only mappings can be registered too
+ */
+#define ETSOC1_HOST_MEM_FLAG_TO_DEVICE (1U << 0)
+
+/* Exports a range of the host managed DRAM instead of a CMA buffer */
+#define ETSOC1_DMABUF_FLAG_DEVICE_DRAM (1U << 0)
+
+/**
+ * struct dmabuf_export_desc - Descriptor for ETSOC1_IOCTL_EXPORT_DMABUF
+ * @addr: Start virtual address of a CMA buffer mmapped from the ops device,
+ * or device address of a host managed DRAM range with
+ * ETSOC1_DMABUF_FLAG_DEVICE_DRAM
+ * @size: Size of the range in bytes, the whole CMA buffer is exported
+ * @flags: ETSOC1_DMABUF_FLAG_* flags
+ * @fd: Returned dma-buf file descriptor, filled in by the driver
+ */
+struct dmabuf_export_desc {
+	__u64 addr;
+	__u64 size;
+	__u32 flags;
+	__s32 fd;
+};
+
+/**
+ * struct dmabuf_import_desc - Descriptor for ETSOC1_IOCTL_IMPORT_DMABUF
+ * @fd: dma-buf file descriptor exported by another driver
+ * @pad: Reserved, must be 0
+ * @addr: Address the dma-buf is registered at, DMA list command nodes use a
+ * host address in [addr, addr + size) to reach it. Must not overlap memory
+ * registered with ETSOC1_IOCTL_REGISTER_HOST_MEM
+ * @size: Returned size of the dma-buf in bytes, filled in by the driver
+ *
+ * The dma-buf is released with ETSOC1_IOCTL_UNREGISTER_HOST_MEM on @addr.
+ */
+struct dmabuf_import_desc {
+	__s32 fd;
+	__u32 pad;
+	__u64 addr;
+	__u64 size;
+};
+
+/**
+ * struct vq_map_desc - Descriptor for ETSOC1_IOCTL_MAP_VQS
+ * @eventfd: eventfd signaled by the driver on every CQ interrupt
+ * @vq_buf_size: Size in bytes to mmap at ETSOC1_MMAP_OFFSET_VQ_BUFFER
+ * @sq_offset: Offset of SQ[0] circular buffer in the VQ buffer mapping, SQ[i]
+ * is at sq_offset + i * sq_size
+ * @cq_offset: Offset of CQ[0] circular buffer in the VQ buffer mapping, CQ[i]
+ * is at cq_offset + i * cq_size
+ * @sq_size: Size of a SQ in bytes, circular buffer header included
+ * @cq_size: Size of a CQ in bytes, circular buffer header included
+ * @sq_count: Number of SQs
+ * @cq_count: Number of CQs
+ * @doorbell_offset: Offset of the interrupt trigger register in the doorbell
+ * page mapped at ETSOC1_MMAP_OFFSET_DOORBELL
+ * @doorbell_value: Value to write on the interrupt trigger register to notify
+ * the device about new commands
+ * @doorbell_size: Size of the interrupt trigger register in bytes
+ *
+ * @eventfd is filled in by user, all other fields by the driver.
+ */
+struct vq_map_desc {
+	__s32 eventfd;
+	__u64 vq_buf_size;
+	__u64 sq_offset;
+	__u64 cq_offset;
+	__u16 sq_size;
+	__u16 cq_size;
+	__u16 sq_count;
+	__u16 cq_count;
+	__u32 doorbell_offset;
+	__u8 doorbell_value;
+	__u8 doorbell_size;
+};
+
+/**
+ * struct cmd_translate_desc - Descriptor for ETSOC1_IOCTL_TRANSLATE_CMD
+ * @cmd: Pointer to DMA list, P2PDMA list or DMA chain command memory in
+ *	 user-space
+ * @out: Pointer to memory in user-space receiving the translated command
+ * @size: Size of the command in bytes
+ * @out_size: Size of out buffer in bytes
+ * @flags: CMD_DESC_FLAG_DMA, CMD_DESC_FLAG_P2PDMA or CMD_DESC_FLAG_DMA_CHAIN
+ */
+struct cmd_translate_desc {
+	void *cmd;
+	void *out;
+	__u16 size;
+	__u16 out_size;
+	__u8 flags;
+};
+
+/**
+ * struct vq_eventfd_desc - Descriptor for ETSOC1_IOCTL_SET_VQ_EVENTFD
+ * @eventfd: eventfd to signal, -1 to unregister the eventfd set before
+ * @cq_index: CQ index, ignored for VQ_EVENTFD_SQ_AVAIL
+ * @type: enum vq_eventfd_type
+ */
+struct vq_eventfd_desc {
+	__s32 eventfd;
+	__u16 cq_index;
+	__u8 type;
+};
+
 /**
  * struct sq_threshold - Descriptor for ETSOC1_IOCTL_SET_SQ_THRESHOLD
  * @bytes_needed: Free bytes needed for the threshold
@@ -191,6 +351,122 @@ struct trace_desc {
 	void *buf;
 };
 
+/**
+ * struct trace_read_desc - Descriptor for ETSOC1_IOCTL_READ_TRACE_BUFFER
+ * @trace_type: value of enum trace_buffer_type type
+ * @offset: Offset in bytes from the start of the trace buffer region
+ * @size: Size in bytes of buf
+ * @buf: Pointer to memory buffer in user-space
+ */
+struct trace_read_desc {
+	__u8 trace_type;
+	__u32 offset;
+	__u32 size;
+	void *buf;
+};
+
+/*
+ * Layout of the binary SysFS attribute stats_snapshot, read in one read() of
+ * up to ET_STATS_SNAPSHOT_MAX_SIZE bytes:
+ *   struct et_stats_snapshot_header
+ *   __u64 err_counters[err_count], see enum et_stats_err_counter
+ *   __u64 mem_stats[mem_count], see enum et_stats_mem_stat
+ *   struct et_stats_snapshot_vq vqs[vq_count]
+ * The counts let readers skip the entries added by later versions
+ */
+#define ET_STATS_SNAPSHOT_VERSION  1
+#define ET_STATS_SNAPSHOT_MAX_SIZE 4096
+
+/**
+ * enum et_stats_err_counter - Error counters of the stats snapshot, same
+ * counters as SysFS group err_stats
+ *
+ * NOTE: Must be kept in sync with enum et_err_counter_stats
+ */
+enum et_stats_err_counter {
+	ET_STATS_ERR_DRAM_CE = 0,
+	ET_STATS_ERR_MINION_CE,
+	ET_STATS_ERR_PCIE_CE,
+	ET_STATS_ERR_PMIC_CE,
+	ET_STATS_ERR_SP_CE,
+	ET_STATS_ERR_SP_EXCEPT_CE,
+	ET_STATS_ERR_SRAM_CE,
+	ET_STATS_ERR_THERM_OVERSHOOT_CE,
+	ET_STATS_ERR_THERM_THROTTLE_CE,
+	ET_STATS_ERR_DRAM_UCE,
+	ET_STATS_ERR_MINION_HANG_UCE,
+	ET_STATS_ERR_PCIE_UCE,
+	ET_STATS_ERR_SP_HANG_UCE,
+	ET_STATS_ERR_SP_WDOG_UCE,
+	ET_STATS_ERR_SRAM_UCE,
+	ET_STATS_ERR_SP_TRACE_FULL_CE,
+	ET_STATS_ERR_COUNTERS,
+};
+
+/**
+ * enum et_stats_mem_stat - Memory statistics of the stats snapshot
+ * @ET_STATS_MEM_CMA_ALLOCATED: CMA allocated in bytes
+ * @ET_STATS_MEM_CMA_ALLOCATION_RATE: CMA allocation rate in bytes/sec
+ */
+enum et_stats_mem_stat {
+	ET_STATS_MEM_CMA_ALLOCATED = 0,
+	ET_STATS_MEM_CMA_ALLOCATION_RATE,
+	ET_STATS_MEM_STATS,
+};
+
+/**
+ * enum et_stats_vq_type - Type values for struct et_stats_snapshot_vq
+ */
+enum et_stats_vq_type {
+	ET_STATS_VQ_MGMT_SQ = 0,
+	ET_STATS_VQ_MGMT_CQ,
+	ET_STATS_VQ_OPS_HP_SQ,
+	ET_STATS_VQ_OPS_SQ,
+	ET_STATS_VQ_OPS_CQ,
+};
+
+/**
+ * struct et_stats_snapshot_header - Header of the stats snapshot
+ * @version: ET_STATS_SNAPSHOT_VERSION of the layout
+ * @size: Size in bytes of the snapshot, header included
+ * @timestamp_ns: Monotonic time of the snapshot
+ * @err_count: Number of error counters
+ * @mem_count: Number of memory statistics
+ * @vq_count: Number of VQ entries, only initialized devices have entries
+ * @vq_entry_size: Size in bytes of a VQ entry
+ */
+struct et_stats_snapshot_header {
+	__u32 version;
+	__u32 size;
+	__u64 timestamp_ns;
+	__u16 err_count;
+	__u16 mem_count;
+	__u16 vq_count;
+	__u16 vq_entry_size;
+};
+
+/**
+ * struct et_stats_snapshot_vq - Statistics of a VQ in the stats snapshot
+ * @type: Value of enum et_stats_vq_type
+ * @index: Index of the VQ in its device
+ * @utilization_percent: Used space of the VQ circular buffer
+ * @msg_count: Messages sent/received
+ * @byte_count: Bytes sent/received
+ * @msg_rate: Messages per sec
+ * @byte_rate: Bytes per sec
+ * @overflow_count: Responses held back, CQs only
+ */
+struct et_stats_snapshot_vq {
+	__u16 type;
+	__u16 index;
+	__u32 utilization_percent;
+	__u64 msg_count;
+	__u64 byte_count;
+	__u64 msg_rate;
+	__u64 byte_rate;
+	__u64 overflow_count;
+};
+
 #define ETSOC1_IOCTL_GET_USER_DRAM_INFO                                        \
 	_IOR(ESPERANTO_PCIE_IOCTL_MAGIC, 1, struct dram_info)
 
@@ -205,6 +481,13 @@ struct trace_desc {
 #define ETSOC1_IOCTL_GET_DEVICE_CONFIGURATION                                  \
 	_IOR(ESPERANTO_PCIE_IOCTL_MAGIC, 5, struct dev_config)
 
+/*
+ * ETSOC1_IOCTL_PUSH_SQ, ETSOC1_IOCTL_PUSH_SQ_BATCH, ETSOC1_IOCTL_POP_CQ and
+ * ETSOC1_IOCTL_POP_CQ_BATCH can also be submitted to the ops device through
+ * io_uring (IORING_OP_URING_CMD, kernels 6.0 and later): the SQE cmd_op is the
+ * IOCTL and the SQE cmd area holds its descriptor, not a pointer to it. A full
+ * SQ or an empty CQ completes with -EBUSY instead of -EAGAIN
+ */
 #define ETSOC1_IOCTL_PUSH_SQ                                                   \
 	_IOW(ESPERANTO_PCIE_IOCTL_MAGIC, 6, struct cmd_desc)
 
@@ -235,4 +518,56 @@ struct trace_desc {
 #define ETSOC1_IOCTL_GET_P2PDMA_DEVICE_COMPAT_BITMAP                           \
 	_IOR(ESPERANTO_PCIE_IOCTL_MAGIC, 15, __u64)
 
+#define ETSOC1_IOCTL_POP_CQ_BATCH                                              \
+	_IOWR(ESPERANTO_PCIE_IOCTL_MAGIC, 16, struct rsp_batch_desc)
+
+#define ETSOC1_IOCTL_REGISTER_HOST_MEM                                         \
+	_IOW(ESPERANTO_PCIE_IOCTL_MAGIC, 17, struct host_mem_desc)
+
+#define ETSOC1_IOCTL_UNREGISTER_HOST_MEM                                       \
+	_IOW(ESPERANTO_PCIE_IOCTL_MAGIC, 18, struct host_mem_desc)
+
+#define ETSOC1_IOCTL_PUSH_SQ_BATCH                                             \
+	_IOW(ESPERANTO_PCIE_IOCTL_MAGIC, 19, struct cmd_batch_desc)
+
+#define ETSOC1_IOCTL_MAP_VQS                                                   \
+	_IOWR(ESPERANTO_PCIE_IOCTL_MAGIC, 20, struct vq_map_desc)
+
+#define ETSOC1_IOCTL_TRANSLATE_CMD                                             \
+	_IOW(ESPERANTO_PCIE_IOCTL_MAGIC, 21, struct cmd_translate_desc)
+
+#define ETSOC1_IOCTL_SET_VQ_EVENTFD                                            \
+	_IOW(ESPERANTO_PCIE_IOCTL_MAGIC, 22, struct vq_eventfd_desc)
+
+#define ETSOC1_IOCTL_GET_CQ_COUNT _IOR(ESPERANTO_PCIE_IOCTL_MAGIC, 23, __u16)
+
+#define ETSOC1_IOCTL_READ_TRACE_BUFFER                                         \
+	_IOW(ESPERANTO_PCIE_IOCTL_MAGIC, 24, struct trace_read_desc)
+
+#define ETSOC1_IOCTL_EXPORT_DMABUF                                             \
+	_IOWR(ESPERANTO_PCIE_IOCTL_MAGIC, 25, struct dmabuf_export_desc)
+
+#define ETSOC1_IOCTL_IMPORT_DMABUF                                             \
+	_IOWR(ESPERANTO_PCIE_IOCTL_MAGIC, 26, struct dmabuf_import_desc)
+
+/* Max number of responses that can be popped with one ETSOC1_IOCTL_POP_CQ_BATCH */
+#define ETSOC1_POP_CQ_BATCH_MAX_COUNT 64
+
+/* Max size in bytes of the commands pushed with one ETSOC1_IOCTL_PUSH_SQ_BATCH */
+#define ETSOC1_PUSH_SQ_BATCH_MAX_SIZE (64 * 1024)
+
+/*
+ * mmap() offsets of the ops device once ETSOC1_IOCTL_MAP_VQS succeeded. The
+ * offset 0 keeps allocating CMA memory for DMA
+ */
+#define ETSOC1_MMAP_OFFSET_VQ_BUFFER 0x100000000ULL
+#define ETSOC1_MMAP_OFFSET_DOORBELL  0x200000000ULL
+
+/*
+ * mmap() offset of the ops device mapping the host managed DRAM (see
+ * ETSOC1_IOCTL_GET_USER_DRAM_INFO) write-combined. Needs the user_dram module
+ * parameter and CAP_SYS_RAWIO
+ */
+#define ETSOC1_MMAP_OFFSET_DEVICE_DRAM 0x300000000ULL
+
 #endif
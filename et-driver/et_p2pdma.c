@@ -255,15 +255,20 @@ void et_p2pdma_release_resource(struct et_pci_dev *et_dev,
  * @queue_index: SQ index
  * @ucmd: user pointer to command coming from user-space
  * @ucmd_size: size of user command
+ * @uout: user pointer receiving the translated command instead of pushing it
+ *	  on SQ, NULL to push it
+ * @uout_size: size of uout buffer
  *
  * Searches for P2P memory for perr_devnum against peer device physical address
  * and fills in the corresponding PCI bus address of each node in P2P DMA list
  * command and pushes the command on SQ.
  *
- * Return: number of bytes written on SQ on success, negative value for error
+ * Return: number of bytes written on SQ (or copied to uout) on success,
+ * negative value for error
  */
 ssize_t et_p2pdma_move_data(struct et_pci_dev *et_dev, u16 queue_index,
-			    char __user *ucmd, size_t cmd_size)
+			    char __user *ucmd, size_t cmd_size,
+			    char __user *uout, size_t uout_size)
 {
 	ssize_t rv;
 	u32 node_num, nodes_count = 0;
@@ -369,6 +374,21 @@ ssize_t et_p2pdma_move_data(struct et_pci_dev *et_dev, u16 queue_index,
 		up_read(&map->rwsem);
 	}
 
+	if (uout) {
+		if (cmd_size > uout_size) {
+			rv = -ENOSPC;
+			goto free_cmd_mem;
+		}
+		if (copy_to_user(uout, cmd, cmd_size)) {
+			dev_err(&et_dev->pdev->dev,
+				"P2PDMA list: copy_to_user failed!");
+			rv = -EFAULT;
+			goto free_cmd_mem;
+		}
+		rv = cmd_size;
+		goto free_cmd_mem;
+	}
+
 	rv = et_squeue_push(&et_dev->ops.vq_data.sqs[queue_index], cmd,
 			    cmd_size);
 	if (rv < 0)
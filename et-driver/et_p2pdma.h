@@ -52,6 +52,7 @@ int et_p2pdma_add_resource(struct et_pci_dev *et_dev,
 void et_p2pdma_release_resource(struct et_pci_dev *et_dev,
 				struct et_mapped_region *region);
 ssize_t et_p2pdma_move_data(struct et_pci_dev *et_dev, u16 queue_index,
-			    char __user *ucmd, size_t ucmd_size);
+			    char __user *ucmd, size_t ucmd_size,
+			    char __user *uout, size_t uout_size);
 
 #endif
@@ -154,7 +154,8 @@ void et_p2pdma_release_resource(struct et_pci_dev *et_dev,
 }
 
 ssize_t et_p2pdma_move_data(struct et_pci_dev *et_dev, u16 queue_index,
-			    char __user *ucmd, size_t cmd_size)
+			    char __user *ucmd, size_t cmd_size,
+			    char __user *uout, size_t uout_size)
 {
 	ssize_t rv;
 	u32 node_num, nodes_count = 0;
@@ -260,6 +261,21 @@ ssize_t et_p2pdma_move_data(struct et_pci_dev *et_dev, u16 queue_index,
 		up_read(&map->rwsem);
 	}
 
+	if (uout) {
+		if (cmd_size > uout_size) {
+			rv = -ENOSPC;
+			goto free_cmd_mem;
+		}
+		if (copy_to_user(uout, cmd, cmd_size)) {
+			dev_err(&et_dev->pdev->dev,
+				"P2PDMA list: copy_to_user failed!");
+			rv = -EFAULT;
+			goto free_cmd_mem;
+		}
+		rv = cmd_size;
+		goto free_cmd_mem;
+	}
+
 	rv = et_squeue_push(&et_dev->ops.vq_data.sqs[queue_index], cmd,
 			    cmd_size);
 	if (rv < 0)
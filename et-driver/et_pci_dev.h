@@ -29,13 +29,17 @@ enum et_iomem_r { IOMEM_R_DIR_OPS = 0, IOMEM_R_DIR_MGMT, IOMEM_REGIONS };
 
 /**
  * enum et_msi_vec_idx - MSI vector IDs
+ *
+ * Ops CQ[i] is notified on vector ET_OPS_CQ_VEC_IDX + i, the last allocated
+ * vector is shared by all the remaining ops CQs.
  */
 enum et_msi_vec_idx {
 	ET_MGMT_SQ_VEC_IDX = 0,
 	ET_MGMT_CQ_VEC_IDX,
 	ET_OPS_SQ_VEC_IDX,
 	ET_OPS_CQ_VEC_IDX,
-	ET_MAX_MSI_VECS
+	ET_MIN_MSI_VECS,
+	ET_MAX_MSI_VECS = 8
 };
 
 /**
@@ -80,6 +84,10 @@ struct et_bar_region {
  * @dir_vq: VQ information discovered from ops DIRs
  * @vq_data: VQ data other than the ops DIRs VQ information
  * @mem_stats: Memory statistics for ops device
+ * @pinned_mem_list: List of user memory ranges pinned for zero-copy DMA
+ * @stream_mem_list: List of user memory ranges pinned and mapped only while the
+ *		     DMA command using them is in flight
+ * @stream_mem_count: Number of entries in stream_mem_list
  */
 struct et_ops_dev {
 	bool is_initialized;
@@ -104,6 +112,17 @@ struct et_ops_dev {
 	struct et_ops_dir_vqueue dir_vq;
 	struct et_vq_data vq_data;
 	struct et_mem_stats mem_stats;
+	struct list_head pinned_mem_list;
+	/**
+	 * @pinned_mem_mutex: serializes access to pinned_mem_list
+	 */
+	struct mutex pinned_mem_mutex;
+	struct list_head stream_mem_list;
+	/**
+	 * @stream_mem_mutex: serializes access to stream_mem_list
+	 */
+	struct mutex stream_mem_mutex;
+	atomic_t stream_mem_count;
 };
 
 /**
@@ -150,6 +169,7 @@ struct et_mgmt_dev {
  * @is_initialized: ETSoC1 device as whole is initialized
  * @is_err_reporting: AER error reporting is enabled
  * @pdev: Pointer to struct pci_dev
+ * @num_msi_vecs: Number of MSI vectors allocated
  * @pstate: Pointer to struct pci_saved_state - holds PCIe config space state
  * @cfg: Device configuration received from DIRs
  * @ops: Ops device information
@@ -167,6 +187,7 @@ struct et_pci_dev {
 	bool is_err_reporting;
 #endif
 	struct pci_dev *pdev;
+	int num_msi_vecs;
 	struct pci_saved_state *pstate;
 	struct dev_config cfg;
 	struct et_ops_dev ops;
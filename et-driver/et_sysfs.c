@@ -135,11 +135,15 @@ int et_sysfs_add_file(struct et_pci_dev *et_dev, int file_id)
 {
 	int rv;
 	struct device_attribute *dev_attr = NULL;
+	struct bin_attribute *bin_attr = NULL;
 
 	switch (file_id) {
 	case ET_SYSFS_FID_DEVNUM:
 		dev_attr = &dev_attr_devnum;
 		break;
+	case ET_SYSFS_FID_STATS_SNAPSHOT:
+		bin_attr = &et_sysfs_stats_snapshot_attr;
+		break;
 	default:
 		return -EINVAL;
 	}
@@ -147,10 +151,13 @@ int et_sysfs_add_file(struct et_pci_dev *et_dev, int file_id)
 	if (et_dev->sysfs_data.is_file_created[file_id])
 		return -EEXIST;
 
-	rv = device_create_file(&et_dev->pdev->dev, dev_attr);
+	if (bin_attr)
+		rv = device_create_bin_file(&et_dev->pdev->dev, bin_attr);
+	else
+		rv = device_create_file(&et_dev->pdev->dev, dev_attr);
 	if (rv)
 		dev_err(&et_dev->pdev->dev, "Failed to create %s attribute!\n",
-			dev_attr->attr.name);
+			bin_attr ? bin_attr->attr.name : dev_attr->attr.name);
 	else
 		et_dev->sysfs_data.is_file_created[file_id] = true;
 
@@ -165,11 +172,15 @@ int et_sysfs_add_file(struct et_pci_dev *et_dev, int file_id)
 void et_sysfs_remove_file(struct et_pci_dev *et_dev, int file_id)
 {
 	struct device_attribute *dev_attr = NULL;
+	struct bin_attribute *bin_attr = NULL;
 
 	switch (file_id) {
 	case ET_SYSFS_FID_DEVNUM:
 		dev_attr = &dev_attr_devnum;
 		break;
+	case ET_SYSFS_FID_STATS_SNAPSHOT:
+		bin_attr = &et_sysfs_stats_snapshot_attr;
+		break;
 	default:
 		return;
 	}
@@ -177,7 +188,10 @@ void et_sysfs_remove_file(struct et_pci_dev *et_dev, int file_id)
 	if (!et_dev->sysfs_data.is_file_created[file_id])
 		return;
 
-	device_remove_file(&et_dev->pdev->dev, dev_attr);
+	if (bin_attr)
+		device_remove_bin_file(&et_dev->pdev->dev, bin_attr);
+	else
+		device_remove_file(&et_dev->pdev->dev, dev_attr);
 	et_dev->sysfs_data.is_file_created[file_id] = false;
 }
 
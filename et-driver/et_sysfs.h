@@ -12,6 +12,7 @@
 #include "et_sysfs_err_stats.h"
 #include "et_sysfs_mem_stats.h"
 #include "et_sysfs_soc_reset.h"
+#include "et_sysfs_stats_snapshot.h"
 #include "et_sysfs_vq_stats.h"
 
 /**
@@ -46,7 +47,8 @@
  *
  * To add a new singular attribute which cannot be part of any attribute group
  * 1.  Add entry to enum et_sysfs_fid_e with name ET_SYSFS_FID_<name>
- * 2.  Add case statements for new attribute in et_sysfs.c
+ * 2.  Add case statements for new attribute in et_sysfs.c, binary attributes
+ *     set bin_attr instead of dev_attr
  * 3.  Define device attribute (preferrably using kernel provided macro
  *     DEVICE_ATTR*)
  * 4.  For read-only device attribute, define a show function
@@ -72,6 +74,7 @@ enum et_sysfs_gid_e {
  */
 enum et_sysfs_fid_e {
 	ET_SYSFS_FID_DEVNUM = 0,
+	ET_SYSFS_FID_STATS_SNAPSHOT,
 	ET_SYSFS_FILES,
 };
 
@@ -217,6 +217,41 @@ static ssize_t utilization_percent_show(struct device *dev,
 	return bytes;
 }
 
+/**
+ * overflow_count_show() - Show function for SysFS attribute overflow_count
+ * @dev: Pointer to struct device
+ * @attr: Pointer to struct device_attribute
+ * @buf: buffer memory for the attribute
+ *
+ * Number of responses held back in mgmt device CQs because the ring of messages
+ * saved for user-space was full. A held back response stops the CQ until
+ * user-space pops from it
+ * mgmt_vq_stats/overflow_count
+ *
+ * Return: number of bytes written in buf, negative value on failure
+ */
+static ssize_t overflow_count_show(struct device *dev,
+				   struct device_attribute *attr, char *buf)
+{
+	unsigned int i;
+	ssize_t bytes = 0;
+	struct et_pci_dev *et_dev = dev_get_drvdata(dev);
+	struct et_vq_data *vq_data = &et_dev->mgmt.vq_data;
+	struct et_vq_stats *stats;
+
+	for (i = 0; i < vq_data->vq_common.cq_count; i++) {
+		stats = &vq_data->cqs[i].stats;
+		bytes += sysfs_emit_at(
+			buf, bytes, "CQ%u: %20llu msg(s)\n",
+			vq_data->cqs[i].index,
+			atomic64_read(
+				&stats->counters
+					 [ET_VQ_COUNTER_STATS_OVERFLOW_COUNT]));
+	}
+
+	return bytes;
+}
+
 /**
  * clear_store() - Store function for SysFS attribute clear
  * @dev: Pointer to struct device
@@ -260,6 +295,7 @@ static DEVICE_ATTR_RO(byte_count);
 static DEVICE_ATTR_RO(msg_rate);
 static DEVICE_ATTR_RO(byte_rate);
 static DEVICE_ATTR_RO(utilization_percent);
+static DEVICE_ATTR_RO(overflow_count);
 static DEVICE_ATTR_WO(clear);
 
 static struct attribute *mgmt_vq_stats_attrs[] = {
@@ -268,6 +304,7 @@ static struct attribute *mgmt_vq_stats_attrs[] = {
 	&dev_attr_msg_rate.attr,
 	&dev_attr_byte_rate.attr,
 	&dev_attr_utilization_percent.attr,
+	&dev_attr_overflow_count.attr,
 	&dev_attr_clear.attr,
 	NULL,
 };
@@ -264,6 +264,41 @@ static ssize_t utilization_percent_show(struct device *dev,
 	return bytes;
 }
 
+/**
+ * overflow_count_show() - Show function for SysFS attribute overflow_count
+ * @dev: Pointer to struct device
+ * @attr: Pointer to struct device_attribute
+ * @buf: buffer memory for the attribute
+ *
+ * Number of responses held back in ops device CQs because the ring of messages
+ * saved for user-space was full. A held back response stops the CQ until
+ * user-space pops from it
+ * ops_vq_stats/overflow_count
+ *
+ * Return: number of bytes written in buf, negative value on failure
+ */
+static ssize_t overflow_count_show(struct device *dev,
+				   struct device_attribute *attr, char *buf)
+{
+	unsigned int i;
+	ssize_t bytes = 0;
+	struct et_pci_dev *et_dev = dev_get_drvdata(dev);
+	struct et_vq_data *vq_data = &et_dev->ops.vq_data;
+	struct et_vq_stats *stats;
+
+	for (i = 0; i < vq_data->vq_common.cq_count; i++) {
+		stats = &vq_data->cqs[i].stats;
+		bytes += sysfs_emit_at(
+			buf, bytes, "CQ%u:   %20llu msg(s)\n",
+			vq_data->cqs[i].index,
+			atomic64_read(
+				&stats->counters
+					 [ET_VQ_COUNTER_STATS_OVERFLOW_COUNT]));
+	}
+
+	return bytes;
+}
+
 /**
  * clear_store() - Store function for SysFS attribute clear
  * @dev: Pointer to struct device
@@ -304,13 +339,135 @@ static ssize_t clear_store(struct device *dev, struct device_attribute *attr,
 	return count;
 }
 
+/**
+ * cq_coalesce_max_msgs_show() - Show function for SysFS attribute
+ * cq_coalesce_max_msgs
+ * @dev: Pointer to struct device
+ * @attr: Pointer to struct device_attribute
+ * @buf: buffer memory for the attribute
+ *
+ * Number of responses the device pushes in an ops device CQ before raising the
+ * CQ interrupt, 0 or 1 when interrupt coalescing is disabled
+ * ops_vq_stats/cq_coalesce_max_msgs
+ *
+ * Return: number of bytes written in buf, negative value on failure
+ */
+static ssize_t cq_coalesce_max_msgs_show(struct device *dev,
+					 struct device_attribute *attr,
+					 char *buf)
+{
+	struct et_pci_dev *et_dev = dev_get_drvdata(dev);
+
+	return sysfs_emit(
+		buf, "%u\n",
+		READ_ONCE(et_dev->ops.vq_data.vq_common.cq_coalesce_max_msgs));
+}
+
+/**
+ * cq_coalesce_max_msgs_store() - Store function for SysFS attribute
+ * cq_coalesce_max_msgs
+ * @dev: Pointer to struct device
+ * @attr: Pointer to struct device_attribute
+ * @buf: Buffer memory for the attribute
+ * @count: Number of bytes received in buf
+ *
+ * Responses below the threshold are popped at the latest cq_coalesce_timeout_us
+ * after being pushed. For example:
+ * echo 8 > \
+ *   /sys/bus/pci/devices/<bus:function:device>/ops_vq_stats/cq_coalesce_max_msgs
+ *
+ * Return: number of bytes read/processed from buf, negative value on failure
+ */
+static ssize_t cq_coalesce_max_msgs_store(struct device *dev,
+					  struct device_attribute *attr,
+					  const char *buf, size_t count)
+{
+	ssize_t rv;
+	u16 value;
+	struct et_pci_dev *et_dev = dev_get_drvdata(dev);
+	struct et_vq_data *vq_data = &et_dev->ops.vq_data;
+
+	rv = kstrtou16(buf, 0, &value);
+	if (rv)
+		return rv;
+
+	rv = et_vqueue_set_cq_coalescing(
+		vq_data, value,
+		READ_ONCE(vq_data->vq_common.cq_coalesce_timeout_us));
+	if (rv)
+		return rv;
+
+	return count;
+}
+
+/**
+ * cq_coalesce_timeout_us_show() - Show function for SysFS attribute
+ * cq_coalesce_timeout_us
+ * @dev: Pointer to struct device
+ * @attr: Pointer to struct device_attribute
+ * @buf: buffer memory for the attribute
+ *
+ * Maximum time in microseconds a response held back by the ops device CQ
+ * interrupt coalescing waits before being popped
+ * ops_vq_stats/cq_coalesce_timeout_us
+ *
+ * Return: number of bytes written in buf, negative value on failure
+ */
+static ssize_t cq_coalesce_timeout_us_show(struct device *dev,
+					   struct device_attribute *attr,
+					   char *buf)
+{
+	struct et_pci_dev *et_dev = dev_get_drvdata(dev);
+
+	return sysfs_emit(
+		buf, "%u\n",
+		READ_ONCE(et_dev->ops.vq_data.vq_common.cq_coalesce_timeout_us));
+}
+
+/**
+ * cq_coalesce_timeout_us_store() - Store function for SysFS attribute
+ * cq_coalesce_timeout_us
+ * @dev: Pointer to struct device
+ * @attr: Pointer to struct device_attribute
+ * @buf: Buffer memory for the attribute
+ * @count: Number of bytes received in buf
+ *
+ * Accepts up to one second, 0 restores the default timeout
+ *
+ * Return: number of bytes read/processed from buf, negative value on failure
+ */
+static ssize_t cq_coalesce_timeout_us_store(struct device *dev,
+					    struct device_attribute *attr,
+					    const char *buf, size_t count)
+{
+	ssize_t rv;
+	u32 value;
+	struct et_pci_dev *et_dev = dev_get_drvdata(dev);
+	struct et_vq_data *vq_data = &et_dev->ops.vq_data;
+
+	rv = kstrtou32(buf, 0, &value);
+	if (rv)
+		return rv;
+
+	rv = et_vqueue_set_cq_coalescing(
+		vq_data, READ_ONCE(vq_data->vq_common.cq_coalesce_max_msgs),
+		value);
+	if (rv)
+		return rv;
+
+	return count;
+}
+
 /* SysFS attributes in group ops_vq_stats */
 static DEVICE_ATTR_RO(msg_count);
 static DEVICE_ATTR_RO(byte_count);
 static DEVICE_ATTR_RO(msg_rate);
 static DEVICE_ATTR_RO(byte_rate);
 static DEVICE_ATTR_RO(utilization_percent);
+static DEVICE_ATTR_RO(overflow_count);
 static DEVICE_ATTR_WO(clear);
+static DEVICE_ATTR_RW(cq_coalesce_max_msgs);
+static DEVICE_ATTR_RW(cq_coalesce_timeout_us);
 
 static struct attribute *ops_vq_stats_attrs[] = {
 	&dev_attr_msg_count.attr,
@@ -318,7 +475,10 @@ static struct attribute *ops_vq_stats_attrs[] = {
 	&dev_attr_msg_rate.attr,
 	&dev_attr_byte_rate.attr,
 	&dev_attr_utilization_percent.attr,
+	&dev_attr_overflow_count.attr,
 	&dev_attr_clear.attr,
+	&dev_attr_cq_coalesce_max_msgs.attr,
+	&dev_attr_cq_coalesce_timeout_us.attr,
 	NULL,
 };
 
@@ -0,0 +1,182 @@
+// SPDX-License-Identifier: GPL-2.0
+
+/*-----------------------------------------------------------------------------
+ * Copyright (c) 2025 Ainekko, Co.
+ *-----------------------------------------------------------------------------
+ */
+
+#include <linux/build_bug.h>
+#include <linux/ktime.h>
+#include <linux/slab.h>
+#include <linux/sysfs.h>
+
+#include "et_ioctl.h"
+#include "et_pci_dev.h"
+#include "et_sysfs_stats_snapshot.h"
+
+static_assert(ET_STATS_ERR_COUNTERS == ET_ERR_COUNTER_STATS_MAX_COUNTERS);
+static_assert(ET_STATS_MEM_STATS == ET_MEM_COUNTER_STATS_MAX_COUNTERS +
+					    ET_MEM_RATE_STATS_MAX_RATES);
+
+/**
+ * snapshot_vq() - Fill the stats snapshot entry of a VQ
+ * @entry: Pointer to struct et_stats_snapshot_vq
+ * @type: Value of enum et_stats_vq_type
+ * @index: Index of the VQ
+ * @stats: Pointer to VQ statistics
+ * @cb: Pointer to VQ circular buffer, synced for host
+ */
+static void snapshot_vq(struct et_stats_snapshot_vq *entry, u16 type,
+			u16 index, struct et_vq_stats *stats,
+			struct et_circbuffer *cb)
+{
+	entry->type = type;
+	entry->index = index;
+	entry->utilization_percent = 100 * et_circbuffer_used(cb) / cb->len;
+	entry->msg_count =
+		atomic64_read(&stats->counters[ET_VQ_COUNTER_STATS_MSG_COUNT]);
+	entry->byte_count =
+		atomic64_read(&stats->counters[ET_VQ_COUNTER_STATS_BYTE_COUNT]);
+	entry->overflow_count = atomic64_read(
+		&stats->counters[ET_VQ_COUNTER_STATS_OVERFLOW_COUNT]);
+	entry->msg_rate =
+		et_rate_entry_calculate(&stats->rates[ET_VQ_RATE_STATS_MSG_RATE]);
+	entry->byte_rate = et_rate_entry_calculate(
+		&stats->rates[ET_VQ_RATE_STATS_BYTE_RATE]);
+}
+
+/**
+ * snapshot_vqs() - Fill the stats snapshot entries of the VQs of a device
+ * @vq_data: Pointer to struct et_vq_data of mgmt or ops device
+ * @is_mgmt: Mgmt device VQs
+ * @vqs: Array of entries to fill
+ * @max_vqs: Size of vqs
+ *
+ * Return: number of entries filled
+ */
+static u16 snapshot_vqs(struct et_vq_data *vq_data, bool is_mgmt,
+			struct et_stats_snapshot_vq *vqs, u16 max_vqs)
+{
+	u16 count = 0;
+	u16 i;
+
+	for (i = 0; i < vq_data->vq_common.hp_sq_count && count < max_vqs;
+	     i++) {
+		et_squeue_sync_cb_for_host(&vq_data->hp_sqs[i]);
+		snapshot_vq(&vqs[count++], ET_STATS_VQ_OPS_HP_SQ,
+			    vq_data->hp_sqs[i].index, &vq_data->hp_sqs[i].stats,
+			    &vq_data->hp_sqs[i].cb);
+	}
+
+	for (i = 0; i < vq_data->vq_common.sq_count && count < max_vqs; i++) {
+		et_squeue_sync_cb_for_host(&vq_data->sqs[i]);
+		snapshot_vq(&vqs[count++],
+			    is_mgmt ? ET_STATS_VQ_MGMT_SQ : ET_STATS_VQ_OPS_SQ,
+			    vq_data->sqs[i].index, &vq_data->sqs[i].stats,
+			    &vq_data->sqs[i].cb);
+	}
+
+	for (i = 0; i < vq_data->vq_common.cq_count && count < max_vqs; i++) {
+		et_cqueue_sync_cb_for_host(&vq_data->cqs[i]);
+		snapshot_vq(&vqs[count++],
+			    is_mgmt ? ET_STATS_VQ_MGMT_CQ : ET_STATS_VQ_OPS_CQ,
+			    vq_data->cqs[i].index, &vq_data->cqs[i].stats,
+			    &vq_data->cqs[i].cb);
+	}
+
+	return count;
+}
+
+/**
+ * stats_snapshot_read() - Read function for SysFS binary attribute
+ * stats_snapshot
+ * @filp: Pointer to struct file
+ * @kobj: Pointer to struct kobject of the device
+ * @attr: Pointer to struct bin_attribute
+ * @buf: buffer memory for the attribute
+ * @off: Offset in the snapshot
+ * @count: Size of buf
+ *
+ * All the VQ, memory and error statistics of the device in one read, in the
+ * binary layout of struct et_stats_snapshot_header. The snapshot is taken
+ * again on every read, so it must be read in one read() from offset 0
+ * stats_snapshot
+ *
+ * Return: number of bytes written in buf, negative value on failure
+ */
+static ssize_t stats_snapshot_read(struct file *filp, struct kobject *kobj,
+				   struct bin_attribute *attr, char *buf,
+				   loff_t off, size_t count)
+{
+	struct et_pci_dev *et_dev = dev_get_drvdata(kobj_to_dev(kobj));
+	struct et_stats_snapshot_header *header;
+	struct et_stats_snapshot_vq *vqs;
+	u64 *err_counters, *mem_stats;
+	u16 max_vqs;
+	void *snapshot;
+	ssize_t rv;
+	int i;
+
+	if (off >= ET_STATS_SNAPSHOT_MAX_SIZE)
+		return 0;
+
+	snapshot = kzalloc(ET_STATS_SNAPSHOT_MAX_SIZE, GFP_KERNEL);
+	if (!snapshot)
+		return -ENOMEM;
+
+	header = snapshot;
+	err_counters = (u64 *)(header + 1);
+	mem_stats = err_counters + ET_STATS_ERR_COUNTERS;
+	vqs = (struct et_stats_snapshot_vq *)(mem_stats + ET_STATS_MEM_STATS);
+	max_vqs = ((u8 *)snapshot + ET_STATS_SNAPSHOT_MAX_SIZE - (u8 *)vqs) /
+		  sizeof(*vqs);
+
+	header->version = ET_STATS_SNAPSHOT_VERSION;
+	header->timestamp_ns = ktime_get_ns();
+	header->err_count = ET_STATS_ERR_COUNTERS;
+	header->mem_count = ET_STATS_MEM_STATS;
+	header->vq_entry_size = sizeof(*vqs);
+
+	mutex_lock(&et_dev->mgmt.init_mutex);
+	if (et_dev->mgmt.is_initialized) {
+		for (i = 0; i < ET_STATS_ERR_COUNTERS; i++)
+			err_counters[i] = atomic64_read(
+				&et_dev->mgmt.err_stats.counters[i]);
+		header->vq_count = snapshot_vqs(&et_dev->mgmt.vq_data, true,
+						vqs, max_vqs);
+	}
+	mutex_unlock(&et_dev->mgmt.init_mutex);
+
+	mutex_lock(&et_dev->ops.init_mutex);
+	if (et_dev->ops.is_initialized) {
+		mem_stats[ET_STATS_MEM_CMA_ALLOCATED] = atomic64_read(
+			&et_dev->ops.mem_stats
+				 .counters[ET_MEM_COUNTER_STATS_CMA_ALLOCATED]);
+		mem_stats[ET_STATS_MEM_CMA_ALLOCATION_RATE] =
+			et_rate_entry_calculate(
+				&et_dev->ops.mem_stats.rates
+					 [ET_MEM_RATE_STATS_CMA_ALLOCATION_RATE]);
+		header->vq_count += snapshot_vqs(&et_dev->ops.vq_data, false,
+						 vqs + header->vq_count,
+						 max_vqs - header->vq_count);
+	}
+	mutex_unlock(&et_dev->ops.init_mutex);
+
+	header->size = (u8 *)(vqs + header->vq_count) - (u8 *)snapshot;
+
+	if (off >= header->size) {
+		rv = 0;
+	} else {
+		rv = min_t(size_t, count, header->size - off);
+		memcpy(buf, (u8 *)snapshot + off, rv);
+	}
+
+	kfree(snapshot);
+
+	return rv;
+}
+
+struct bin_attribute et_sysfs_stats_snapshot_attr = {
+	.attr = { .name = "stats_snapshot", .mode = 0444 },
+	.read = stats_snapshot_read,
+};
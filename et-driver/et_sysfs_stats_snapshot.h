@@ -0,0 +1,16 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+
+/*-----------------------------------------------------------------------------
+ * Copyright (c) 2025 Ainekko, Co.
+ *-----------------------------------------------------------------------------
+ */
+
+#ifndef __ET_SYSFS_STATS_SNAPSHOT_H
+#define __ET_SYSFS_STATS_SNAPSHOT_H
+
+#include <linux/sysfs.h>
+
+/* SysFS binary attribute stats_snapshot, see struct et_stats_snapshot_header */
+extern struct bin_attribute et_sysfs_stats_snapshot_attr;
+
+#endif
@@ -18,6 +18,7 @@
 enum et_vq_counter_stats {
 	ET_VQ_COUNTER_STATS_MSG_COUNT = 0,
 	ET_VQ_COUNTER_STATS_BYTE_COUNT,
+	ET_VQ_COUNTER_STATS_OVERFLOW_COUNT,
 	ET_VQ_COUNTER_STATS_MAX_COUNTERS,
 };
 
@@ -8,9 +8,14 @@
 #ifndef __ET_VMA_H
 #define __ET_VMA_H
 
+#include <linux/types.h>
+
 struct et_pci_dev;
+struct et_dma_mapping;
 
 struct vm_area_struct *et_find_vma(struct et_pci_dev *et_dev,
 				   unsigned long vaddr);
+struct et_dma_mapping *et_get_dma_mapping(struct et_pci_dev *et_dev,
+					  unsigned long vaddr, u64 *offset);
 
 #endif
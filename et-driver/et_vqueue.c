@@ -9,110 +9,183 @@
 #include <linux/delay.h>
 #include <linux/errno.h>
 #include <linux/kernel.h>
+#include <linux/kfifo.h>
+#include <linux/log2.h>
 #include <linux/slab.h>
 #include <linux/uaccess.h>
+#include <linux/version.h>
 
+#include "et_dma.h"
 #include "et_event_handler.h"
 #include "et_io.h"
 #include "et_pci_dev.h"
 #include "et_vqueue.h"
 
 /**
- * create_msg_node() - Performs memory allocations to create the message node
- * @msg_size: Size of message to be saved in the message node
+ * create_msg_fifo() - Preallocates the ring of CQ's user messages
+ * @cq: Pointer to struct et_cqueue
+ * @cq_size: Size of the device CQ in bytes
+ *
+ * The ring is twice the device CQ, so that a full device CQ always fits in it
+ * despite the size of the record headers. No memory is allocated afterwards
+ * while receiving responses.
  *
- * Return: Pointer to struct et_msg_node on success, NULL on failure
+ * Return: 0 on success, negative error on failure
  */
-static struct et_msg_node *create_msg_node(u32 msg_size)
+static int create_msg_fifo(struct et_cqueue *cq, u16 cq_size)
 {
-	struct et_msg_node *new_node;
+	int rv;
 
-	//Build node
-	new_node = kmalloc(sizeof(*new_node), GFP_KERNEL);
-	if (IS_ERR(new_node)) {
-		pr_err("Failed to allocate msg node, error %ld\n",
-		       PTR_ERR(new_node));
-		return NULL;
-	}
+	cq->msg_stage = kmalloc(cq_size, GFP_KERNEL);
+	if (!cq->msg_stage)
+		return -ENOMEM;
+	cq->msg_stage_size = 0;
 
-	new_node->msg = kmalloc(msg_size, GFP_KERNEL);
-	if (IS_ERR(new_node->msg)) {
-		pr_err("Failed to allocate msg buffer, error %ld\n",
-		       PTR_ERR(new_node->msg));
-		kfree(new_node);
-		return NULL;
+	rv = kfifo_alloc(&cq->msg_fifo, roundup_pow_of_two(2 * cq_size),
+			 GFP_KERNEL);
+	if (rv) {
+		kfree(cq->msg_stage);
+		cq->msg_stage = NULL;
+		return rv;
 	}
 
-	new_node->msg_size = msg_size;
+	mutex_init(&cq->msg_fifo_mutex);
 
-	return new_node;
+	return 0;
 }
 
 /**
- * enqueue_msg_node() - Enqueue the message node in CQ's user message list
+ * destroy_msg_fifo() - Free-up the ring of CQ's user messages
  * @cq: Pointer to struct et_cqueue
- * @msg: Message to be enqueued
  */
-static void enqueue_msg_node(struct et_cqueue *cq, struct et_msg_node *msg)
+static void destroy_msg_fifo(struct et_cqueue *cq)
 {
-	mutex_lock(&cq->msg_list_mutex);
-	list_add_tail(&msg->list, &cq->msg_list);
-	mutex_unlock(&cq->msg_list_mutex);
+	int count = 0;
+
+	mutex_lock(&cq->msg_fifo_mutex);
+	while (!kfifo_is_empty(&cq->msg_fifo)) {
+		kfifo_skip(&cq->msg_fifo);
+		count++;
+	}
+	if (cq->msg_stage_size)
+		count++;
+	mutex_unlock(&cq->msg_fifo_mutex);
+
+	if (count)
+		pr_warn("Discarded (%d) CQ user messages", count);
+
+	kfifo_free(&cq->msg_fifo);
+	kfree(cq->msg_stage);
+	cq->msg_stage = NULL;
+	cq->msg_stage_size = 0;
+	mutex_destroy(&cq->msg_fifo_mutex);
 }
 
 /**
- * dequeue_msg_node() - Dequeue message node from CQ's user message list
+ * push_msg_stage() - Queue the staged message in CQ's user message ring
  * @cq: Pointer to struct et_cqueue
  *
- * Return: Pointer to struct et_msg_node on success, NULL on failure
+ * Must be called with pop_mutex held, the CQ work being the only producer.
+ *
+ * Return: true if the message is queued, false if the ring is full and the
+ * message is left in msg_stage
  */
-static struct et_msg_node *dequeue_msg_node(struct et_cqueue *cq)
+static bool push_msg_stage(struct et_cqueue *cq)
 {
-	struct et_msg_node *msg;
+	// Pairs with the barrier in et_cqueue_copy_to_user(): either the ring
+	// has room by now, or the consumer sees msg_stage_size and requeues
+	// the CQ work
+	smp_mb();
+	if (!kfifo_in(&cq->msg_fifo, cq->msg_stage, cq->msg_stage_size))
+		return false;
 
-	mutex_lock(&cq->msg_list_mutex);
-	msg = list_first_entry_or_null(&cq->msg_list, struct et_msg_node, list);
-	if (msg)
-		list_del(&msg->list);
+	WRITE_ONCE(cq->msg_stage_size, 0);
 
-	mutex_unlock(&cq->msg_list_mutex);
+	return true;
+}
+
+/**
+ * et_eventfd_signal() - Signals an eventfd
+ * @eventfd: Pointer to struct eventfd_ctx, nothing is done if NULL
+ */
+static void et_eventfd_signal(struct eventfd_ctx *eventfd)
+{
+	if (!eventfd)
+		return;
 
-	return msg;
+#if (LINUX_VERSION_CODE < KERNEL_VERSION(6, 8, 0))
+	eventfd_signal(eventfd, 1);
+#else
+	eventfd_signal(eventfd);
+#endif
 }
 
 /**
- * destroy_msg_node() - Performs memory de-allocations to free the message node
- * @node: Message node to be destroyed
+ * et_squeue_free() - Get number of free bytes in SQ circular buffer
+ * @sq: Pointer to struct et_squeue
+ *
+ * The local circular buffer copy may be moved meanwhile by a push or a sync,
+ * so each field is read once.
+ *
+ * Return: Free space in bytes
  */
-static void destroy_msg_node(struct et_msg_node *node)
+static u64 et_squeue_free(struct et_squeue *sq)
 {
-	if (node) {
-		kfree(node->msg);
-		kfree(node);
-	}
+	u64 head = READ_ONCE(sq->cb.head);
+	u64 tail = READ_ONCE(sq->cb.tail);
+
+	if (head >= tail)
+		return (sq->cb.len - 1U) - (head - tail);
+	return tail - head - 1U;
 }
 
 /**
- * destroy_msg_list() - Free-up CQ's complete message list
- * @cq: Pointer to struct et_cqueue
+ * et_squeue_update_avail() - Updates the SQ bit in the SQ availability bitmap
+ * @sq: Pointer to struct et_squeue
+ *
+ * The pushers and the SQ ISR work update the bit without any lock. The free
+ * space is read again once the bit is changed: if it crossed the threshold
+ * meanwhile, the bit is evaluated again, so the last one to change the bit
+ * always leaves it matching the free space. The SQ availability eventfd is
+ * signaled when the bit gets set.
+ *
+ * Return: true if the SQ has more free space than its threshold
  */
-static void destroy_msg_list(struct et_cqueue *cq)
+static bool et_squeue_update_avail(struct et_squeue *sq)
 {
-	struct list_head *pos, *next;
-	struct et_msg_node *node;
-	int count = 0;
+	struct et_vq_common *vq_common = sq->vq_common;
+	bool avail = et_squeue_free(sq) >= atomic_read(&sq->sq_threshold);
+
+	for (;;) {
+		if (!avail) {
+			clear_bit(sq->index, vq_common->sq_bitmap);
+		} else if (!test_and_set_bit(sq->index, vq_common->sq_bitmap)) {
+			mutex_lock(&vq_common->sq_eventfd_mutex);
+			et_eventfd_signal(vq_common->sq_avail_eventfd);
+			mutex_unlock(&vq_common->sq_eventfd_mutex);
+		}
+		smp_mb__after_atomic();
 
-	mutex_lock(&cq->msg_list_mutex);
-	list_for_each_safe (pos, next, &cq->msg_list) {
-		node = list_entry(pos, struct et_msg_node, list);
-		list_del(pos);
-		destroy_msg_node(node);
-		count++;
+		if (avail ==
+		    (et_squeue_free(sq) >= atomic_read(&sq->sq_threshold)))
+			return avail;
+		avail = !avail;
 	}
-	mutex_unlock(&cq->msg_list_mutex);
+}
 
-	if (count)
-		pr_warn("Discarded (%d) CQ user messages", count);
+/**
+ * notify_msg_available() - Flags CQ's user messages availability
+ * @cq: Pointer to struct et_cqueue
+ */
+static void notify_msg_available(struct et_cqueue *cq)
+{
+	mutex_lock(&cq->vq_common->cq_bitmap_mutex);
+	if (!test_and_set_bit(cq->index, cq->vq_common->cq_bitmap))
+		et_eventfd_signal(
+			cq->vq_common->cq_avail_eventfds[cq->index]);
+	mutex_unlock(&cq->vq_common->cq_bitmap_mutex);
+
+	wake_up_interruptible(&cq->vq_common->waitqueue);
 }
 
 /**
@@ -153,20 +226,14 @@ unlock_reset_mutex:
 }
 
 /**
- * et_cqueue_msg_available() - Check for message in CQ's user message list
+ * et_cqueue_msg_available() - Check for message in CQ's user message ring
  * @cq: Pointer to struct et_cqueue
  *
  * Return: true if message found, else false
  */
 bool et_cqueue_msg_available(struct et_cqueue *cq)
 {
-	struct et_msg_node *msg;
-
-	mutex_lock(&cq->msg_list_mutex);
-	msg = list_first_entry_or_null(&cq->msg_list, struct et_msg_node, list);
-	mutex_unlock(&cq->msg_list_mutex);
-
-	return !!(msg);
+	return !kfifo_is_empty(&cq->msg_fifo);
 }
 
 /**
@@ -226,36 +293,111 @@ static void et_sq_isr_work(struct work_struct *work)
 	et_squeue_sync_cb_for_host(sq);
 
 update_sq_bitmap:
-	// Update sq_bitmap
-	mutex_lock(&sq->vq_common->sq_bitmap_mutex);
-
-	if (et_circbuffer_free(&sq->cb) >= atomic_read(&sq->sq_threshold)) {
-		set_bit(sq->index, sq->vq_common->sq_bitmap);
+	if (et_squeue_update_avail(sq))
 		wake_up_interruptible(&sq->vq_common->waitqueue);
-	}
-
-	mutex_unlock(&sq->vq_common->sq_bitmap_mutex);
 }
 
 /**
  * et_pcie_cq_isr() - CQ interrupt service routine
- * @sq_id: Base address of CQ information / CQ[0] address
+ * @cq_id: Address of the first CQ notified on this vector
  *
  * This interrupt is generated by device when it pushes response(s) into the CQ
- * i.e. CQ is non-empty. This queues work to pop-out the responses from CQ(s)
+ * i.e. CQ is non-empty. This queues work to pop-out the responses from the
+ * CQ(s) of the vector, or only signals the user eventfd if the CQs are popped
+ * by user-space. The last vector notifies all the remaining CQs.
  */
 static irqreturn_t et_pcie_cq_isr(int irq, void *cq_id)
 {
-	int i;
-	struct et_cqueue *cqs = (struct et_cqueue *)cq_id;
-	struct et_vq_common *vq_common = cqs[0].vq_common;
+	int i, last;
+	struct et_cqueue *cq = (struct et_cqueue *)cq_id;
+	struct et_vq_common *vq_common = cq->vq_common;
 
-	for (i = 0; i < vq_common->cq_count; i++)
-		queue_work(vq_common->cq_workqueue, &cqs[i].isr_work);
+	if (smp_load_acquire(&vq_common->user_owned)) {
+		et_eventfd_signal(vq_common->cq_eventfd);
+		return IRQ_HANDLED;
+	}
+
+	last = (cq->index == vq_common->cq_vec_count - 1) ?
+		       vq_common->cq_count - 1 :
+		       cq->index;
+	for (i = 0; i <= last - cq->index; i++)
+		queue_work(vq_common->cq_workqueue, &cq[i].isr_work);
 
 	return IRQ_HANDLED;
 }
 
+/**
+ * et_cqueue_coalesce_timer_cb() - Polls the CQs for the responses held back by
+ * the interrupt coalescing
+ * @timer: Pointer to struct hrtimer of vq_common
+ *
+ * The device raises the CQ interrupt once cq_coalesce_max_msgs responses are
+ * pushed, the responses below this threshold are picked up here, at the latest
+ * cq_coalesce_timeout_us after they were pushed.
+ *
+ * Return: HRTIMER_RESTART
+ */
+static enum hrtimer_restart et_cqueue_coalesce_timer_cb(struct hrtimer *timer)
+{
+	int i;
+	u64 head, tail;
+	struct et_vq_common *vq_common =
+		container_of(timer, struct et_vq_common, cq_coalesce_timer);
+	struct et_vq_data *vq_data =
+		container_of(vq_common, struct et_vq_data, vq_common);
+
+	for (i = 0; i < vq_common->cq_count; i++) {
+		et_ioread(vq_data->cqs[i].cb_mem,
+			  offsetof(struct et_circbuffer, head), (u8 *)&head,
+			  sizeof(head));
+		et_ioread(vq_data->cqs[i].cb_mem,
+			  offsetof(struct et_circbuffer, tail), (u8 *)&tail,
+			  sizeof(tail));
+		if (head == tail)
+			continue;
+
+		if (smp_load_acquire(&vq_common->user_owned)) {
+			et_eventfd_signal(vq_common->cq_eventfd);
+			break;
+		}
+		queue_work(vq_common->cq_workqueue, &vq_data->cqs[i].isr_work);
+	}
+
+	hrtimer_forward_now(timer,
+			    us_to_ktime(vq_common->cq_coalesce_timeout_us));
+
+	return HRTIMER_RESTART;
+}
+
+/**
+ * et_cqueue_coalesce_apply() - Applies the interrupt coalescing settings
+ * @vq_data: Pointer to struct et_vq_data
+ *
+ * Hands the threshold over to the device through the CQ circular buffers and
+ * (re)starts the polling timer. Expects cq_coalesce_mutex to be held.
+ */
+static void et_cqueue_coalesce_apply(struct et_vq_data *vq_data)
+{
+	int i;
+	u64 threshold;
+	struct et_vq_common *vq_common = &vq_data->vq_common;
+
+	hrtimer_cancel(&vq_common->cq_coalesce_timer);
+	if (!vq_common->cq_coalesce_active)
+		return;
+
+	threshold = vq_common->cq_coalesce_max_msgs;
+	for (i = 0; i < vq_common->cq_count; i++)
+		et_iowrite(vq_data->cqs[i].cb_mem,
+			   offsetof(struct et_circbuffer, notify_threshold),
+			   (u8 *)&threshold, sizeof(threshold));
+
+	if (threshold > 1)
+		hrtimer_start(&vq_common->cq_coalesce_timer,
+			      us_to_ktime(vq_common->cq_coalesce_timeout_us),
+			      HRTIMER_MODE_REL);
+}
+
 /**
  * et_cq_isr_work() - CQ work ISR to receive responses from CQ
  * @work: Pointer to struct work_struct specific to a CQ
@@ -472,6 +614,7 @@ error_destroy_sq_workqueue:
 static ssize_t et_cqueue_init_all(struct et_pci_dev *et_dev, bool is_mgmt)
 {
 	ssize_t i, rv;
+	int v;
 	unsigned long vec_idx;
 	struct et_mapped_region *vq_region;
 	struct et_vq_data *vq_data;
@@ -522,6 +665,13 @@ static ssize_t et_cqueue_init_all(struct et_pci_dev *et_dev, bool is_mgmt)
 	}
 
 	for (i = 0; i < vq_data->vq_common.cq_count; i++) {
+		rv = create_msg_fifo(&vq_data->cqs[i], cq_size);
+		if (rv) {
+			dev_err(&et_dev->pdev->dev,
+				"CQ[%ld] message ring allocation failed\n", i);
+			goto error_destroy_msg_fifos;
+		}
+
 		vq_data->cqs[i].index = i;
 		vq_data->cqs[i].vq_common = &vq_data->vq_common;
 		vq_data->cqs[i].cb_mem =
@@ -532,8 +682,6 @@ static ssize_t et_cqueue_init_all(struct et_pci_dev *et_dev, bool is_mgmt)
 		cq_baseaddr += cq_size;
 
 		mutex_init(&vq_data->cqs[i].pop_mutex);
-		INIT_LIST_HEAD(&vq_data->cqs[i].msg_list);
-		mutex_init(&vq_data->cqs[i].msg_list_mutex);
 
 		// Init statistics before work handler
 		et_vq_stats_init(&vq_data->cqs[i].stats);
@@ -544,20 +692,44 @@ static ssize_t et_cqueue_init_all(struct et_pci_dev *et_dev, bool is_mgmt)
 		flush_workqueue(vq_data->vq_common.cq_workqueue);
 	}
 
-	rv = request_irq(pci_irq_vector(et_dev->pdev, vec_idx), et_pcie_cq_isr,
-			 0,
-			 devm_kasprintf(&et_dev->pdev->dev, GFP_KERNEL,
-					"%s%d_irq%ld", is_mgmt ? "mgmt" : "ops",
-					et_dev->devnum, vec_idx),
-			 (void *)vq_data->cqs);
-	if (rv) {
-		dev_err(&et_dev->pdev->dev, "request irq failed\n");
-		goto error_free_cqs;
+	// One vector per CQ, as many as allocated past ET_OPS_CQ_VEC_IDX
+	vq_data->vq_common.cq_vec_count =
+		is_mgmt ? 1 :
+			  clamp_t(int, et_dev->num_msi_vecs - ET_OPS_CQ_VEC_IDX,
+				  1, vq_data->vq_common.cq_count);
+	for (v = 0; v < vq_data->vq_common.cq_vec_count; v++) {
+		rv = request_irq(pci_irq_vector(et_dev->pdev, vec_idx + v),
+				 et_pcie_cq_isr, 0,
+				 devm_kasprintf(&et_dev->pdev->dev, GFP_KERNEL,
+						"%s%d_irq%ld",
+						is_mgmt ? "mgmt" : "ops",
+						et_dev->devnum, vec_idx + v),
+				 (void *)&vq_data->cqs[v]);
+		if (rv) {
+			dev_err(&et_dev->pdev->dev, "request irq failed\n");
+			goto error_free_irqs;
+		}
 	}
 
+	// Re-apply coalescing, the device resets the CQ circular buffers
+	mutex_lock(&vq_data->vq_common.cq_coalesce_mutex);
+	vq_data->vq_common.cq_coalesce_active = true;
+	et_cqueue_coalesce_apply(vq_data);
+	mutex_unlock(&vq_data->vq_common.cq_coalesce_mutex);
+
 	return 0;
 
-error_free_cqs:
+error_free_irqs:
+	while (v--)
+		free_irq(pci_irq_vector(et_dev->pdev, vec_idx + v),
+			 (void *)&vq_data->cqs[v]);
+
+error_destroy_msg_fifos:
+	while (i--) {
+		cancel_work_sync(&vq_data->cqs[i].isr_work);
+		mutex_destroy(&vq_data->cqs[i].pop_mutex);
+		destroy_msg_fifo(&vq_data->cqs[i]);
+	}
 	kfree(vq_data->cqs);
 
 error_destroy_cq_workqueue:
@@ -630,12 +802,28 @@ ssize_t et_vqueue_init_all(struct et_pci_dev *et_dev, bool is_mgmt)
 	}
 
 	bitmap_zero(vq_common->sq_bitmap, ET_MAX_QUEUES);
-	mutex_init(&vq_common->sq_bitmap_mutex);
+	mutex_init(&vq_common->sq_eventfd_mutex);
 	bitmap_zero(vq_common->cq_bitmap, ET_MAX_QUEUES);
 	mutex_init(&vq_common->cq_bitmap_mutex);
 	init_waitqueue_head(&vq_common->waitqueue);
 	vq_common->pdev = et_dev->pdev;
 
+	// Coalescing settings are kept across the re-initializations
+	mutex_init(&vq_common->cq_coalesce_mutex);
+	vq_common->cq_coalesce_active = false;
+	if (!vq_common->cq_coalesce_timeout_us)
+		vq_common->cq_coalesce_timeout_us =
+			ET_CQ_COALESCE_DEF_TIMEOUT_US;
+#if (LINUX_VERSION_CODE < KERNEL_VERSION(6, 13, 0))
+	hrtimer_init(&vq_common->cq_coalesce_timer, CLOCK_MONOTONIC,
+		     HRTIMER_MODE_REL);
+	vq_common->cq_coalesce_timer.function = et_cqueue_coalesce_timer_cb;
+#else
+	hrtimer_setup(&vq_common->cq_coalesce_timer,
+		      et_cqueue_coalesce_timer_cb, CLOCK_MONOTONIC,
+		      HRTIMER_MODE_REL);
+#endif
+
 	rv = et_sysfs_add_group(et_dev, vq_stats_gid);
 	if (rv)
 		return rv;
@@ -741,13 +929,19 @@ static void et_cqueue_destroy_all(struct et_pci_dev *et_dev, bool is_mgmt)
 		vq_data = &et_dev->ops.vq_data;
 	}
 
-	free_irq(pci_irq_vector(et_dev->pdev, vec_idx), (void *)vq_data->cqs);
+	mutex_lock(&vq_data->vq_common.cq_coalesce_mutex);
+	vq_data->vq_common.cq_coalesce_active = false;
+	hrtimer_cancel(&vq_data->vq_common.cq_coalesce_timer);
+	mutex_unlock(&vq_data->vq_common.cq_coalesce_mutex);
+
+	for (i = 0; i < vq_data->vq_common.cq_vec_count; i++)
+		free_irq(pci_irq_vector(et_dev->pdev, vec_idx + i),
+			 (void *)&vq_data->cqs[i]);
 
 	for (i = 0; i < vq_data->vq_common.cq_count; i++) {
 		cancel_work_sync(&vq_data->cqs[i].isr_work);
 		mutex_destroy(&vq_data->cqs[i].pop_mutex);
-		destroy_msg_list(&vq_data->cqs[i]);
-		mutex_destroy(&vq_data->cqs[i].msg_list_mutex);
+		destroy_msg_fifo(&vq_data->cqs[i]);
 		vq_data->cqs[i].cb_mem = NULL;
 		vq_data->cqs[i].vq_common = NULL;
 	}
@@ -783,8 +977,218 @@ void et_vqueue_destroy_all(struct et_pci_dev *et_dev, bool is_mgmt)
 
 	et_sysfs_remove_group(et_dev, vq_stats_gid);
 
-	mutex_destroy(&vq_data->vq_common.sq_bitmap_mutex);
+	et_vqueue_clear_eventfds(vq_data);
+	mutex_destroy(&vq_data->vq_common.sq_eventfd_mutex);
 	mutex_destroy(&vq_data->vq_common.cq_bitmap_mutex);
+	mutex_destroy(&vq_data->vq_common.cq_coalesce_mutex);
+}
+
+/**
+ * et_vqueue_user_own() - Hands over the SQs and CQs to user-space
+ * @vq_data: Pointer to struct et_vq_data of ops device
+ * @cq_eventfd: eventfd context signaled on CQ interrupts, the reference is
+ *		released by et_vqueue_user_release()
+ *
+ * User-space pushes on the SQs and pops from the CQs directly through their
+ * mmap()ed memory. The driver stops pushing on the SQs (HPSQs excepted) and
+ * popping from the CQs, it only keeps the SQ bitmap up to date and signals the
+ * eventfd on CQ interrupts.
+ */
+void et_vqueue_user_own(struct et_vq_data *vq_data,
+			struct eventfd_ctx *cq_eventfd)
+{
+	int i;
+
+	vq_data->vq_common.cq_eventfd = cq_eventfd;
+	smp_store_release(&vq_data->vq_common.user_owned, true);
+
+	// Wait for the pushes and pops in progress, next ones see the flag
+	for (i = 0; i < vq_data->vq_common.sq_count; i++) {
+		mutex_lock(&vq_data->sqs[i].push_mutex);
+		mutex_unlock(&vq_data->sqs[i].push_mutex);
+	}
+	for (i = 0; i < vq_data->vq_common.cq_count; i++) {
+		mutex_lock(&vq_data->cqs[i].pop_mutex);
+		mutex_unlock(&vq_data->cqs[i].pop_mutex);
+	}
+}
+
+/**
+ * et_vqueue_user_release() - Takes back the SQs and CQs from user-space
+ * @vq_data: Pointer to struct et_vq_data of ops device
+ *
+ * The local copies of the circular buffers are re-synced with the ones moved
+ * by user-space and the responses left in the CQs are popped by the driver.
+ */
+void et_vqueue_user_release(struct et_vq_data *vq_data)
+{
+	int i;
+	struct et_vq_common *vq_common = &vq_data->vq_common;
+
+	if (!vq_common->user_owned)
+		return;
+
+	for (i = 0; i < vq_common->sq_count; i++) {
+		mutex_lock(&vq_data->sqs[i].push_mutex);
+		et_ioread(vq_data->sqs[i].cb_mem, 0, (u8 *)&vq_data->sqs[i].cb,
+			  sizeof(vq_data->sqs[i].cb));
+		vq_data->sqs[i].cb_mismatched = false;
+		mutex_unlock(&vq_data->sqs[i].push_mutex);
+	}
+	for (i = 0; i < vq_common->cq_count; i++) {
+		mutex_lock(&vq_data->cqs[i].pop_mutex);
+		et_ioread(vq_data->cqs[i].cb_mem, 0, (u8 *)&vq_data->cqs[i].cb,
+			  sizeof(vq_data->cqs[i].cb));
+		vq_data->cqs[i].cb_mismatched = false;
+		mutex_unlock(&vq_data->cqs[i].pop_mutex);
+	}
+
+	WRITE_ONCE(vq_common->user_owned, false);
+	// The CQ ISR and the coalescing timer may still be signaling the eventfd
+	for (i = 0; i < vq_common->cq_vec_count; i++)
+		synchronize_irq(pci_irq_vector(vq_common->pdev,
+					       ET_OPS_CQ_VEC_IDX + i));
+	mutex_lock(&vq_common->cq_coalesce_mutex);
+	hrtimer_cancel(&vq_common->cq_coalesce_timer);
+	eventfd_ctx_put(vq_common->cq_eventfd);
+	vq_common->cq_eventfd = NULL;
+	et_cqueue_coalesce_apply(vq_data);
+	mutex_unlock(&vq_common->cq_coalesce_mutex);
+
+	for (i = 0; i < vq_common->cq_count; i++)
+		queue_work(vq_common->cq_workqueue, &vq_data->cqs[i].isr_work);
+}
+
+/**
+ * et_vqueue_set_eventfd() - Sets the eventfd signaled on VQ availability
+ * @vq_data: Pointer to struct et_vq_data
+ * @type: enum vq_eventfd_type
+ * @cq_index: CQ index, ignored for VQ_EVENTFD_SQ_AVAIL
+ * @eventfd: eventfd context, NULL to unset it. On success the reference is
+ *	     released when the eventfd is replaced, unset or by
+ *	     et_vqueue_clear_eventfds()
+ *
+ * The eventfd is signaled when the CQ bit (or any SQ bit) of the availability
+ * bitmaps gets set, i.e. together with the EPOLLIN (EPOLLOUT) condition of
+ * poll(). It is signaled right away if the bit is already set.
+ *
+ * Return: 0 on success, negative error on failure
+ */
+int et_vqueue_set_eventfd(struct et_vq_data *vq_data, u8 type, u16 cq_index,
+			  struct eventfd_ctx *eventfd)
+{
+	struct et_vq_common *vq_common = &vq_data->vq_common;
+	struct eventfd_ctx *old;
+
+	switch (type) {
+	case VQ_EVENTFD_CQ_AVAIL:
+		if (cq_index >= vq_common->cq_count)
+			return -EINVAL;
+
+		mutex_lock(&vq_common->cq_bitmap_mutex);
+		old = vq_common->cq_avail_eventfds[cq_index];
+		vq_common->cq_avail_eventfds[cq_index] = eventfd;
+		if (test_bit(cq_index, vq_common->cq_bitmap))
+			et_eventfd_signal(eventfd);
+		mutex_unlock(&vq_common->cq_bitmap_mutex);
+		break;
+
+	case VQ_EVENTFD_SQ_AVAIL:
+		mutex_lock(&vq_common->sq_eventfd_mutex);
+		old = vq_common->sq_avail_eventfd;
+		vq_common->sq_avail_eventfd = eventfd;
+		if (!bitmap_empty(vq_common->sq_bitmap, vq_common->sq_count))
+			et_eventfd_signal(eventfd);
+		mutex_unlock(&vq_common->sq_eventfd_mutex);
+		break;
+
+	default:
+		return -EINVAL;
+	}
+
+	if (old)
+		eventfd_ctx_put(old);
+
+	return 0;
+}
+
+/**
+ * et_vqueue_clear_eventfds() - Unsets all the eventfds signaled on VQ
+ * availability
+ * @vq_data: Pointer to struct et_vq_data
+ */
+void et_vqueue_clear_eventfds(struct et_vq_data *vq_data)
+{
+	int i;
+	struct et_vq_common *vq_common = &vq_data->vq_common;
+
+	mutex_lock(&vq_common->cq_bitmap_mutex);
+	for (i = 0; i < ARRAY_SIZE(vq_common->cq_avail_eventfds); i++) {
+		if (vq_common->cq_avail_eventfds[i]) {
+			eventfd_ctx_put(vq_common->cq_avail_eventfds[i]);
+			vq_common->cq_avail_eventfds[i] = NULL;
+		}
+	}
+	mutex_unlock(&vq_common->cq_bitmap_mutex);
+
+	mutex_lock(&vq_common->sq_eventfd_mutex);
+	if (vq_common->sq_avail_eventfd) {
+		eventfd_ctx_put(vq_common->sq_avail_eventfd);
+		vq_common->sq_avail_eventfd = NULL;
+	}
+	mutex_unlock(&vq_common->sq_eventfd_mutex);
+}
+
+/**
+ * et_vqueue_set_cq_coalescing() - Sets the CQ interrupt coalescing
+ * @vq_data: Pointer to struct et_vq_data
+ * @max_msgs: Number of responses the device pushes in a CQ before raising the
+ *	      CQ interrupt, 0 or 1 raises it on each response
+ * @timeout_us: Maximum time in microseconds a response held back by the
+ *		coalescing waits before being popped, 0 for the default
+ *
+ * The settings are kept across the VQs re-initializations (i.e. MM reset).
+ *
+ * Return: 0 on success, negative error on failure
+ */
+int et_vqueue_set_cq_coalescing(struct et_vq_data *vq_data, u16 max_msgs,
+				u32 timeout_us)
+{
+	int i;
+	struct et_vq_common *vq_common = &vq_data->vq_common;
+
+	if (timeout_us > USEC_PER_SEC)
+		return -EINVAL;
+
+	mutex_lock(&vq_common->cq_coalesce_mutex);
+	vq_common->cq_coalesce_max_msgs = max_msgs;
+	vq_common->cq_coalesce_timeout_us =
+		timeout_us ? timeout_us : ET_CQ_COALESCE_DEF_TIMEOUT_US;
+	et_cqueue_coalesce_apply(vq_data);
+
+	// Pop the responses held back with the previous threshold
+	if (vq_common->cq_coalesce_active && max_msgs <= 1 &&
+	    !vq_common->user_owned) {
+		for (i = 0; i < vq_common->cq_count; i++)
+			queue_work(vq_common->cq_workqueue,
+				   &vq_data->cqs[i].isr_work);
+	}
+	mutex_unlock(&vq_common->cq_coalesce_mutex);
+
+	return 0;
+}
+
+/**
+ * et_squeue_update_bitmap() - Re-evaluates the SQ availability bit after a push
+ * @sq: Pointer to struct et_squeue
+ */
+static void et_squeue_update_bitmap(struct et_squeue *sq)
+{
+	if (sq->is_hp_sq)
+		return;
+
+	if (!et_squeue_update_avail(sq))
+		wake_up_interruptible(&sq->vq_common->waitqueue);
 }
 
 /**
@@ -817,6 +1221,12 @@ ssize_t et_squeue_push(struct et_squeue *sq, void *buf, size_t count)
 
 	mutex_lock(&sq->push_mutex);
 
+	// User-space is the only producer of its SQs
+	if (!sq->is_hp_sq && READ_ONCE(sq->vq_common->user_owned)) {
+		mutex_unlock(&sq->push_mutex);
+		return -EBUSY;
+	}
+
 	if (!et_circbuffer_push(&sq->cb, sq->cb_mem, buf, header->size,
 				ET_CB_SYNC_FOR_HOST | ET_CB_SYNC_FOR_DEVICE)) {
 		// Full; no room for message, returning EAGAIN
@@ -837,20 +1247,91 @@ ssize_t et_squeue_push(struct et_squeue *sq, void *buf, size_t count)
 update_sq_bitmap:
 	mutex_unlock(&sq->push_mutex);
 
-	if (sq->is_hp_sq)
-		return rv;
+	et_squeue_update_bitmap(sq);
 
-	// Update sq_bitmap
-	mutex_lock(&sq->vq_common->sq_bitmap_mutex);
+	return rv;
+}
 
-	if (et_circbuffer_free(&sq->cb) < atomic_read(&sq->sq_threshold)) {
-		clear_bit(sq->index, sq->vq_common->sq_bitmap);
-		wake_up_interruptible(&sq->vq_common->waitqueue);
+/**
+ * et_squeue_push_batch() - Push several commands on SQ circular buffer
+ * @sq: Pointer to struct et_squeue
+ * @buf: Memory buffer holding the commands back to back
+ * @count: Number of bytes of the memory buffer
+ *
+ * The commands are pushed in order until the first one which doesn't fit. The
+ * circular buffer head is published and the device is interrupted only once
+ * for all of them.
+ *
+ * Return: Number of commands pushed on success, negative error on failure.
+ * -EAGAIN is returned if there was no room for the first command
+ */
+ssize_t et_squeue_push_batch(struct et_squeue *sq, void *buf, size_t count)
+{
+	struct cmn_header_t *header;
+	size_t offset, bytes = 0;
+	ssize_t pushed = 0;
+	u8 sync = ET_CB_SYNC_FOR_HOST;
+
+	// Validate all headers before pushing anything
+	for (offset = 0; offset < count; offset += header->size) {
+		header = (struct cmn_header_t *)((u8 *)buf + offset);
+		if (count - offset < sizeof(*header) ||
+		    header->size < sizeof(*header) ||
+		    header->size > count - offset) {
+			pr_err("SQ[%d]: batch contains invalid cmd size",
+			       sq->index);
+			return -EINVAL;
+		}
+	}
+
+	if (sq->cb_mismatched) {
+		pr_err("SQ[%d] corrupt: circbuffer header invalid!", sq->index);
+		return -ENOTRECOVERABLE;
 	}
 
-	mutex_unlock(&sq->vq_common->sq_bitmap_mutex);
+	mutex_lock(&sq->push_mutex);
 
-	return rv;
+	if (!sq->is_hp_sq && READ_ONCE(sq->vq_common->user_owned)) {
+		mutex_unlock(&sq->push_mutex);
+		return -EBUSY;
+	}
+
+	for (offset = 0; offset < count; offset += header->size) {
+		header = (struct cmn_header_t *)((u8 *)buf + offset);
+		// Only the first push syncs the tail, the head is published
+		// once all commands are written
+		if (!et_circbuffer_push(&sq->cb, sq->cb_mem, (u8 *)header,
+					header->size, sync))
+			break;
+		sync = 0;
+		pushed++;
+		bytes += header->size;
+	}
+
+	if (!pushed) {
+		// Full; no room for message, returning EAGAIN
+		mutex_unlock(&sq->push_mutex);
+		et_squeue_update_bitmap(sq);
+		return -EAGAIN;
+	}
+
+	iowrite64(sq->cb.head, &sq->cb_mem->head);
+
+	// Inform device that messages have been pushed to SQ
+	interrupt_device(sq);
+
+	atomic64_add(pushed, &sq->stats.counters[ET_VQ_COUNTER_STATS_MSG_COUNT]);
+	et_rate_entry_update(pushed,
+			     &sq->stats.rates[ET_VQ_RATE_STATS_MSG_RATE]);
+	atomic64_add(bytes, &sq->stats.counters[ET_VQ_COUNTER_STATS_BYTE_COUNT]);
+	et_rate_entry_update(bytes,
+			     &sq->stats.rates[ET_VQ_RATE_STATS_BYTE_RATE]);
+
+	mutex_unlock(&sq->push_mutex);
+
+	et_squeue_update_bitmap(sq);
+
+	return pushed;
 }
 
 /**
@@ -900,6 +1381,54 @@ free_kern_buf:
 	return rv;
 }
 
+/**
+ * et_squeue_copy_batch_from_user() - Copies several commands from user and
+ * forwards them on SQ with a single device notification
+ * @et_dev: Pointer to struct et_pci_dev
+ * @is_mgmt: indicates if mgmt or ops device
+ * @is_hp_sq: Should be pushed on HPSQ or normal SQ
+ * @sq_index: SQ index
+ * @ubuf: Memory buffer in user-space holding the commands back to back
+ * @count: Number of bytes of the memory buffer
+ *
+ * Return: Number of commands pushed on success, negative error on failure
+ */
+ssize_t et_squeue_copy_batch_from_user(struct et_pci_dev *et_dev, bool is_mgmt,
+				       bool is_hp_sq, u16 sq_index,
+				       const char __user *ubuf, size_t count)
+{
+	struct et_vq_data *vq_data;
+	struct et_squeue *sq;
+	u8 *kern_buf;
+	ssize_t rv;
+
+	vq_data = (is_mgmt) ? &et_dev->mgmt.vq_data : &et_dev->ops.vq_data;
+	sq = (is_hp_sq) ? &vq_data->hp_sqs[sq_index] : &vq_data->sqs[sq_index];
+
+	if (!count || count > ETSOC1_PUSH_SQ_BATCH_MAX_SIZE) {
+		pr_err("invalid batch size: %ld", count);
+		return -EINVAL;
+	}
+
+	kern_buf = kzalloc(count, GFP_KERNEL);
+	if (!kern_buf)
+		return -ENOMEM;
+
+	rv = copy_from_user(kern_buf, ubuf, count);
+	if (rv) {
+		pr_err("copy_from_user failed\n");
+		rv = -EFAULT;
+		goto free_kern_buf;
+	}
+
+	rv = et_squeue_push_batch(sq, kern_buf, count);
+
+free_kern_buf:
+	kfree(kern_buf);
+
+	return rv;
+}
+
 /**
  * et_squeue_sync_cb_for_host() - Sync circular buffer local copy with remote
  * @sq: Pointer to struct et_squeue
@@ -912,7 +1441,9 @@ void et_squeue_sync_cb_for_host(struct et_squeue *sq)
 	head_local = sq->cb.head;
 	et_ioread(sq->cb_mem, 0, (u8 *)&sq->cb, sizeof(sq->cb));
 
-	if (head_local != sq->cb.head) {
+	// The head is moved by user-space on the SQs it owns
+	if (head_local != sq->cb.head &&
+	    (sq->is_hp_sq || !READ_ONCE(sq->vq_common->user_owned))) {
 		pr_err("SQ[%d] sync: head mismatched, head_local: %lld, head_remote: %lld",
 		       sq->index, head_local, sq->cb.head);
 		sq->cb_mismatched = true;
@@ -932,16 +1463,8 @@ void et_squeue_sync_bitmap(struct et_squeue *sq)
 {
 	et_squeue_sync_cb_for_host(sq);
 
-	// Update sq_bitmap
-	mutex_lock(&sq->vq_common->sq_bitmap_mutex);
-
-	if (et_circbuffer_free(&sq->cb) >= atomic_read(&sq->sq_threshold))
-		set_bit(sq->index, sq->vq_common->sq_bitmap);
-	else
-		clear_bit(sq->index, sq->vq_common->sq_bitmap);
+	et_squeue_update_avail(sq);
 	wake_up_interruptible(&sq->vq_common->waitqueue);
-
-	mutex_unlock(&sq->vq_common->sq_bitmap_mutex);
 }
 
 /**
@@ -967,22 +1490,26 @@ bool et_squeue_empty(struct et_squeue *sq)
 }
 
 /**
- * et_cqueue_copy_to_user() - Copies saved response from the CQ, to the user
+ * copy_msg_to_user() - Copies the next saved response of the CQ to the user
  * @et_dev: Pointer to struct et_pci_dev
  * @is_mgmt: indicates if mgmt or ops device
  * @cq_index: CQ index
  * @ubuf: Response memory buffer in user-space
  * @count: Number of bytes of response memory buffer
+ * @usize: Response size in user-space, written before the response is popped,
+ * NULL if not needed. If set, the response stays queued when it can't be
+ * copied to the user
  *
  * Return: Number of bytes used from response memory buffer on success,
  * negative error on failure
  */
-ssize_t et_cqueue_copy_to_user(struct et_pci_dev *et_dev, bool is_mgmt,
-			       u16 cq_index, char __user *ubuf, size_t count)
+static ssize_t copy_msg_to_user(struct et_pci_dev *et_dev, bool is_mgmt,
+				u16 cq_index, char __user *ubuf, size_t count,
+				u16 __user *usize)
 {
 	struct et_vq_data *vq_data;
 	struct et_cqueue *cq;
-	struct et_msg_node *msg = NULL;
+	unsigned int size, copied;
 	ssize_t rv;
 
 	if (!ubuf || !count)
@@ -995,31 +1522,46 @@ ssize_t et_cqueue_copy_to_user(struct et_pci_dev *et_dev, bool is_mgmt,
 		return -ENOTRECOVERABLE;
 	}
 
-	msg = dequeue_msg_node(cq);
-	if (!msg || !(msg->msg)) {
+	mutex_lock(&cq->msg_fifo_mutex);
+
+	if (kfifo_is_empty(&cq->msg_fifo)) {
+		mutex_unlock(&cq->msg_fifo_mutex);
 		// Empty; no message to POP, returning EAGAIN
 		rv = -EAGAIN;
 		goto update_cq_bitmap;
 	}
 
-	if (count < msg->msg_size) {
+	size = kfifo_peek_len(&cq->msg_fifo);
+	if (count < size) {
+		mutex_unlock(&cq->msg_fifo_mutex);
 		pr_err("User buffer not large enough\n");
-		// Enqueue the msg again so the userspace can retry with a
+		// The msg stays queued so the userspace can retry with a
 		// larger buffer
-		enqueue_msg_node(cq, msg);
 		return -EINVAL;
 	}
 
-	if (copy_to_user(ubuf, msg->msg, msg->msg_size)) {
+	if (usize && put_user((u16)size, usize)) {
+		mutex_unlock(&cq->msg_fifo_mutex);
+		return -EFAULT;
+	}
+
+	if (kfifo_to_user(&cq->msg_fifo, ubuf, size, &copied)) {
 		pr_err("failed to copy to user\n");
+		// kfifo_to_user() leaves the msg queued on failure
+		if (!usize)
+			kfifo_skip(&cq->msg_fifo);
 		rv = -EFAULT;
-		goto free_msg_node;
+	} else {
+		rv = copied;
 	}
 
-	rv = msg->msg_size;
+	mutex_unlock(&cq->msg_fifo_mutex);
 
-free_msg_node:
-	destroy_msg_node(msg);
+	// Pairs with the barrier in push_msg_stage(). The CQ work stops popping
+	// the device CQ when the ring is full, resume it now there is room
+	smp_mb();
+	if (READ_ONCE(cq->msg_stage_size))
+		queue_work(cq->vq_common->cq_workqueue, &cq->isr_work);
 
 update_cq_bitmap:
 	// Update cq_bitmap
@@ -1035,19 +1577,91 @@ update_cq_bitmap:
 	return rv;
 }
 
+/**
+ * et_cqueue_copy_to_user() - Copies saved response from the CQ, to the user
+ * @et_dev: Pointer to struct et_pci_dev
+ * @is_mgmt: indicates if mgmt or ops device
+ * @cq_index: CQ index
+ * @ubuf: Response memory buffer in user-space
+ * @count: Number of bytes of response memory buffer
+ *
+ * Return: Number of bytes used from response memory buffer on success,
+ * negative error on failure
+ */
+ssize_t et_cqueue_copy_to_user(struct et_pci_dev *et_dev, bool is_mgmt,
+			       u16 cq_index, char __user *ubuf, size_t count)
+{
+	return copy_msg_to_user(et_dev, is_mgmt, cq_index, ubuf, count, NULL);
+}
+
+/**
+ * et_cqueue_copy_batch_to_user() - Copies up to count saved responses from the
+ * CQ, to the user
+ * @et_dev: Pointer to struct et_pci_dev
+ * @is_mgmt: indicates if mgmt or ops device
+ * @cq_index: CQ index
+ * @ursps: Array of response descriptors in user-space, the size field of each
+ * popped descriptor is updated with the size of the response copied
+ * @count: Number of descriptors in ursps
+ *
+ * Return: Number of responses copied on success, negative error on failure.
+ * -EAGAIN is returned if there was no response to pop
+ */
+ssize_t et_cqueue_copy_batch_to_user(struct et_pci_dev *et_dev, bool is_mgmt,
+				     u16 cq_index,
+				     struct rsp_desc __user *ursps, u16 count)
+{
+	struct rsp_desc rsp_info;
+	ssize_t rv = 0;
+	u16 i;
+
+	if (!ursps || !count || count > ETSOC1_POP_CQ_BATCH_MAX_COUNT)
+		return -EINVAL;
+
+	for (i = 0; i < count; i++) {
+		if (copy_from_user(&rsp_info, &ursps[i], sizeof(rsp_info))) {
+			rv = -EFAULT;
+			break;
+		}
+
+		// The size is written before the response is popped, so a
+		// response is never lost on a faulting descriptor
+		rv = copy_msg_to_user(et_dev, is_mgmt, cq_index,
+				      (char __user __force *)rsp_info.rsp,
+				      rsp_info.size, &ursps[i].size);
+		if (rv < 0)
+			break;
+	}
+
+	// Report the responses already popped, the error (if any) will be
+	// reported again in the next call
+	if (i > 0)
+		return i;
+
+	return rv;
+}
+
 /**
  * et_cqueue_pop() - Pop response from CQ circular buffer
  * @sq: Pointer to struct et_cqueue
  * @buf: Command memory buffer to be written on the circular buffer
  * @count: Number of bytes of command memory buffer
  *
- * Return: Response size in bytes on success, negative error on failure
+ * Responses for user-space are queued in the preallocated msg_fifo. If it is
+ * full, the response is held in msg_stage and counted as an overflow, and the
+ * device CQ is not popped any further (so back-pressure reaches the device)
+ * until user-space pops a response and the CQ work is requeued.
+ *
+ * Return: Response size in bytes on success, negative error on failure.
+ * -ENOSPC is returned if the user message ring is full
  */
 ssize_t et_cqueue_pop(struct et_cqueue *cq, bool sync_for_host)
 {
 	struct cmn_header_t header;
-	struct et_msg_node *msg_node;
 	struct device_mgmt_event_msg_t mgmt_event;
+	struct device_mgmt_rsp_hdr_t reset_rsp = {};
+	struct et_pci_dev *et_dev;
+	bool overflow;
 	ssize_t rv;
 
 	if (cq->cb_mismatched) {
@@ -1058,6 +1672,21 @@ ssize_t et_cqueue_pop(struct et_cqueue *cq, bool sync_for_host)
 
 	mutex_lock(&cq->pop_mutex);
 
+	// User-space is the only consumer of its CQs
+	if (READ_ONCE(cq->vq_common->user_owned)) {
+		rv = -EBUSY;
+		goto error_unlock_mutex;
+	}
+
+	// A response held back by a full ring goes first, to keep the order
+	if (cq->msg_stage_size) {
+		if (!push_msg_stage(cq)) {
+			rv = -ENOSPC;
+			goto error_unlock_mutex;
+		}
+		notify_msg_available(cq);
+	}
+
 	// Read the message header
 	if (!et_circbuffer_pop(&cq->cb, cq->cb_mem, (u8 *)&header,
 			       sizeof(header),
@@ -1107,25 +1736,46 @@ ssize_t et_cqueue_pop(struct et_cqueue *cq, bool sync_for_host)
 	}
 
 	// Message is for user mode. Save it off.
-	msg_node = create_msg_node(header.size + sizeof(header));
-	if (!msg_node) {
-		rv = -ENOMEM;
+	if (header.size + sizeof(header) > cq->vq_common->cq_size) {
+		pr_err("%s: CQ[%d]: invalid size!", __func__, cq->index);
+		rv = -ENOTRECOVERABLE;
 		goto error_unlock_mutex;
 	}
 
-	memcpy(msg_node->msg, (u8 *)&header, sizeof(header));
+	memcpy(cq->msg_stage, (u8 *)&header, sizeof(header));
 
-	// MMIO msg payload into node memory
+	// MMIO msg payload into the staging buffer
 	if (!et_circbuffer_pop(&cq->cb, cq->cb_mem,
-			       (u8 *)msg_node->msg + sizeof(header),
-			       header.size, ET_CB_SYNC_FOR_DEVICE)) {
-		destroy_msg_node(msg_node);
+			       cq->msg_stage + sizeof(header), header.size,
+			       ET_CB_SYNC_FOR_DEVICE)) {
 		rv = -EAGAIN;
 		goto error_unlock_mutex;
 	}
 
+	if (header.msg_id == DEV_MGMT_API_MID_MM_RESET)
+		memcpy(&reset_rsp, cq->msg_stage,
+		       min_t(size_t, sizeof(reset_rsp),
+			     header.size + sizeof(header)));
+
+	WRITE_ONCE(cq->msg_stage_size, header.size + sizeof(header));
+	overflow = !push_msg_stage(cq);
+
 	mutex_unlock(&cq->pop_mutex);
 
+	// Release the user memory mapped for the DMA command, before user-space
+	// can see its response
+	et_dev = pci_get_drvdata(cq->vq_common->pdev);
+	if (cq->vq_common == &et_dev->ops.vq_data.vq_common)
+		et_dma_release_stream_mem(et_dev, header.tag_id);
+
+	if (overflow) {
+		atomic64_inc(
+			&cq->stats.counters[ET_VQ_COUNTER_STATS_OVERFLOW_COUNT]);
+		pr_warn_ratelimited(
+			"%s: CQ[%d]: user message ring full, response held back\n",
+			__func__, cq->index);
+	}
+
 	atomic64_inc(&cq->stats.counters[ET_VQ_COUNTER_STATS_MSG_COUNT]);
 	et_rate_entry_update(1, &cq->stats.rates[ET_VQ_RATE_STATS_MSG_RATE]);
 	atomic64_add(header.size + sizeof(header),
@@ -1135,17 +1785,12 @@ ssize_t et_cqueue_pop(struct et_cqueue *cq, bool sync_for_host)
 
 	// Check for MM reset command and complete post reset steps
 	if (header.msg_id == DEV_MGMT_API_MID_MM_RESET)
-		mm_reset_completion_callback(
-			cq, (struct device_mgmt_rsp_hdr_t *)msg_node->msg);
+		mm_reset_completion_callback(cq, &reset_rsp);
 
-	// Enqueue msg node to user msg_list of CQ
-	enqueue_msg_node(cq, msg_node);
+	if (overflow)
+		return -ENOSPC;
 
-	mutex_lock(&cq->vq_common->cq_bitmap_mutex);
-	set_bit(cq->index, cq->vq_common->cq_bitmap);
-	mutex_unlock(&cq->vq_common->cq_bitmap_mutex);
-
-	wake_up_interruptible(&cq->vq_common->waitqueue);
+	notify_msg_available(cq);
 
 	return header.size;
 
@@ -1167,7 +1812,9 @@ void et_cqueue_sync_cb_for_host(struct et_cqueue *cq)
 	tail_local = cq->cb.tail;
 	et_ioread(cq->cb_mem, 0, (u8 *)&cq->cb, sizeof(cq->cb));
 
-	if (tail_local != cq->cb.tail) {
+	// The tail is moved by user-space on the CQs it owns
+	if (tail_local != cq->cb.tail &&
+	    !READ_ONCE(cq->vq_common->user_owned)) {
 		pr_err("CQ[%d] sync: tail mismatched, tail_local: %lld, tail_remote: %lld",
 		       cq->index, tail_local, cq->cb.tail);
 		cq->cb_mismatched = true;
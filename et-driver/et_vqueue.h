@@ -10,6 +10,9 @@
 #define __ET_VQUEUE_H
 
 #include <linux/atomic.h>
+#include <linux/eventfd.h>
+#include <linux/hrtimer.h>
+#include <linux/kfifo.h>
 #include <linux/list.h>
 #include <linux/mutex.h>
 #include <linux/types.h>
@@ -24,19 +27,11 @@
 /* Maximum allowed number of VQs */
 #define ET_MAX_QUEUES 64
 
-struct et_pci_dev;
+/* Default timeout of the CQ interrupt coalescing in microseconds */
+#define ET_CQ_COALESCE_DEF_TIMEOUT_US 100
 
-/**
- * struct et_msg_node - CQ message node struct
- * @list: struct list_head node / glue logic for lists
- * @msg: Pointer to msg buffer
- * @msg_size: Size of msg buffer in bytes
- */
-struct et_msg_node {
-	struct list_head list;
-	u8 *msg;
-	u32 msg_size;
-};
+struct et_pci_dev;
+struct et_lb_model;
 
 /**
  * struct et_vq_common - Common information of all VQs
@@ -44,12 +39,15 @@ struct et_msg_node {
  * @sq_size: Size of a SQ in bytes
  * @hp_sq_count: Number of HPSQs
  * @hp_sq_size: Size of an HPSQ in bytes
- * @sq_bitmap: SQ availability bitmap (set bit indicates free space in SQ)
+ * @sq_bitmap: SQ availability bitmap (set bit indicates free space in SQ),
+ *	       updated lock-free with atomic bit operations
  * @sq_workqueue: Workqueue to process SQ work items
  * @cq_count: Number of SQs
  * @cq_cize: Size of a SQ in bytes
  * @cq_bitmap: CQ availability bitmap (set bit indicates filled space in CQ)
  * @cq_workqueue: Workqueue to process CQ work items
+ * @cq_vec_count: Number of MSI vectors notifying the CQs, CQ[i] is notified
+ *		  on the i-th one and the last one notifies the remaining CQs
  * @intrpt_id: MBox interrupt ID
  * @intrpt_trg_size: Size of interrupt trigger register in bits
  * @intrpt_addr: IOMEM address that triggers MBox interrupt when written
@@ -57,6 +55,20 @@ struct et_msg_node {
  *	       EPOLL thread
  * @pdev: Pointer to struct pci_dev
  * @trace_region: Pointer to a BAR mapped region of SP traces
+ * @user_owned: SQs (HPSQs excepted) and CQs are pushed and popped by user-space
+ *		through their mmap()ed memory, see ETSOC1_IOCTL_MAP_VQS
+ * @cq_eventfd: eventfd signaled on CQ interrupts while user_owned is set
+ * @cq_avail_eventfds: eventfds signaled, per CQ, when a response is available
+ *		       (protected by cq_bitmap_mutex)
+ * @sq_avail_eventfd: eventfd signaled when a SQ gets space available
+ *		      (protected by sq_eventfd_mutex)
+ * @cq_coalesce_max_msgs: Number of responses the device pushes in a CQ before
+ *			  raising the CQ interrupt, 0 or 1 disables coalescing
+ * @cq_coalesce_timeout_us: Period in microseconds of the CQs polling for the
+ *			    responses held back by the coalescing
+ * @cq_coalesce_timer: Timer polling the CQs while coalescing is enabled
+ * @cq_coalesce_active: CQs are initialized, coalescing settings are applied
+ * @lb_model: Timing model of the device in the loopback driver, NULL otherwise
  */
 struct et_vq_common {
 	u16 sq_count;
@@ -65,9 +77,9 @@ struct et_vq_common {
 	u16 hp_sq_size;
 	DECLARE_BITMAP(sq_bitmap, ET_MAX_QUEUES);
 	/**
-	 * @sq_bitmap_mutex: Serializes access to sq_bitmap
+	 * @sq_eventfd_mutex: Serializes access to sq_avail_eventfd
 	 */
-	struct mutex sq_bitmap_mutex;
+	struct mutex sq_eventfd_mutex;
 	struct workqueue_struct *sq_workqueue;
 
 	u16 cq_count;
@@ -78,6 +90,7 @@ struct et_vq_common {
 	 */
 	struct mutex cq_bitmap_mutex;
 	struct workqueue_struct *cq_workqueue;
+	u16 cq_vec_count;
 
 	u8 intrpt_id;
 	u8 intrpt_trg_size;
@@ -86,6 +99,23 @@ struct et_vq_common {
 	wait_queue_head_t waitqueue;
 	struct pci_dev *pdev;
 	struct et_mapped_region *trace_region;
+
+	bool user_owned;
+	struct eventfd_ctx *cq_eventfd;
+	struct eventfd_ctx *cq_avail_eventfds[ET_MAX_QUEUES];
+	struct eventfd_ctx *sq_avail_eventfd;
+
+	u16 cq_coalesce_max_msgs;
+	u32 cq_coalesce_timeout_us;
+	struct hrtimer cq_coalesce_timer;
+	/**
+	 * @cq_coalesce_mutex: Serializes access to the coalescing settings
+	 * and cq_coalesce_timer
+	 */
+	struct mutex cq_coalesce_mutex;
+	bool cq_coalesce_active;
+
+	struct et_lb_model *lb_model;
 };
 
 /**
@@ -124,7 +154,14 @@ struct et_squeue {
  * @cb_mismatched: Tracks mismatch between cb and cb_mem
  * @vq_common: Pointer to struct vq_common
  * @isr_work: Work ISR for this CQ
- * @msg_list: list of pointer of message nodes
+ * @msg_fifo: Preallocated ring of the responses saved for user-space, each
+ * record holds one response with its header. Single producer (CQ work, under
+ * pop_mutex) and single consumer (under msg_fifo_mutex), lock-free between them
+ * @msg_stage: Buffer the response is popped into before it is queued in
+ * msg_fifo, cq_size bytes
+ * @msg_stage_size: Size of the response held in msg_stage because msg_fifo was
+ * full, 0 if none. Once set, the device CQ is not popped further until the
+ * response is queued
  * @stats: CQ statistics for SysFS
  */
 struct et_cqueue {
@@ -138,11 +175,13 @@ struct et_cqueue {
 	struct mutex pop_mutex;
 	struct et_vq_common *vq_common;
 	struct work_struct isr_work;
-	struct list_head msg_list;
+	struct kfifo_rec_ptr_2 msg_fifo;
 	/**
-	 * @msg_list_mutex: serializes access to msg_list
+	 * @msg_fifo_mutex: serializes the consumers of msg_fifo
 	 */
-	struct mutex msg_list_mutex;
+	struct mutex msg_fifo_mutex;
+	u8 *msg_stage;
+	u32 msg_stage_size;
 	struct et_vq_stats stats;
 };
 
@@ -163,18 +202,34 @@ struct et_vq_data {
 ssize_t et_squeue_copy_from_user(struct et_pci_dev *et_dev, bool is_mgmt,
 				 bool is_hp_sq, u16 sq_index,
 				 const char __user *ubuf, size_t count);
+ssize_t et_squeue_copy_batch_from_user(struct et_pci_dev *et_dev, bool is_mgmt,
+				       bool is_hp_sq, u16 sq_index,
+				       const char __user *ubuf, size_t count);
 ssize_t et_squeue_push(struct et_squeue *sq, void *buf, size_t count);
+ssize_t et_squeue_push_batch(struct et_squeue *sq, void *buf, size_t count);
 void et_squeue_sync_cb_for_host(struct et_squeue *sq);
 void et_squeue_sync_bitmap(struct et_squeue *sq);
 bool et_squeue_empty(struct et_squeue *sq);
 
 ssize_t et_cqueue_copy_to_user(struct et_pci_dev *et_dev, bool is_mgmt,
 			       u16 cq_index, char __user *ubuf, size_t count);
+struct rsp_desc;
+ssize_t et_cqueue_copy_batch_to_user(struct et_pci_dev *et_dev, bool is_mgmt,
+				     u16 cq_index,
+				     struct rsp_desc __user *ursps, u16 count);
 ssize_t et_cqueue_pop(struct et_cqueue *cq, bool sync_for_host);
 void et_cqueue_sync_cb_for_host(struct et_cqueue *cq);
 bool et_cqueue_msg_available(struct et_cqueue *cq);
 
 ssize_t et_vqueue_init_all(struct et_pci_dev *et_dev, bool is_mgmt);
 void et_vqueue_destroy_all(struct et_pci_dev *et_dev, bool is_mgmt);
+void et_vqueue_user_own(struct et_vq_data *vq_data,
+			struct eventfd_ctx *cq_eventfd);
+void et_vqueue_user_release(struct et_vq_data *vq_data);
+int et_vqueue_set_eventfd(struct et_vq_data *vq_data, u8 type, u16 cq_index,
+			  struct eventfd_ctx *eventfd);
+void et_vqueue_clear_eventfds(struct et_vq_data *vq_data);
+int et_vqueue_set_cq_coalescing(struct et_vq_data *vq_data, u16 max_msgs,
+				u32 timeout_us);
 
 #endif
@@ -8,9 +8,14 @@
 #include <linux/delay.h>
 #include <linux/errno.h>
 #include <linux/kernel.h>
+#include <linux/kfifo.h>
+#include <linux/log2.h>
+#include <linux/random.h>
 #include <linux/slab.h>
 #include <linux/uaccess.h>
+#include <linux/version.h>
 
+#include "et_dma.h"
 #include "et_event_handler.h"
 #include "et_io.h"
 #include "et_pci_dev.h"
@@ -659,77 +664,120 @@ struct device_ops_kernel_abort_rsp_t {
 	u32 pad;
 } __packed __aligned(8);
 
-static struct et_msg_node *create_msg_node(u32 msg_size)
+static int create_msg_fifo(struct et_cqueue *cq, u16 cq_size)
 {
-	struct et_msg_node *new_node;
-
-	//Build node
-	new_node = kmalloc(sizeof(*new_node), GFP_KERNEL);
-	if (IS_ERR(new_node)) {
-		pr_err("Failed to allocate msg node, error %ld\n",
-		       PTR_ERR(new_node));
-		return NULL;
-	}
+	int rv;
+
+	cq->msg_stage = kmalloc(cq_size, GFP_KERNEL);
+	if (!cq->msg_stage)
+		return -ENOMEM;
+	cq->msg_stage_size = 0;
 
-	new_node->msg = kmalloc(msg_size, GFP_KERNEL);
-	if (IS_ERR(new_node->msg)) {
-		pr_err("Failed to allocate msg buffer, error %ld\n",
-		       PTR_ERR(new_node->msg));
-		kfree(new_node);
-		return NULL;
+	rv = kfifo_alloc(&cq->msg_fifo, roundup_pow_of_two(2 * cq_size),
+			 GFP_KERNEL);
+	if (rv) {
+		kfree(cq->msg_stage);
+		cq->msg_stage = NULL;
+		return rv;
 	}
 
-	new_node->msg_size = msg_size;
+	mutex_init(&cq->msg_fifo_mutex);
 
-	return new_node;
+	return 0;
 }
 
-static void enqueue_msg_node(struct et_cqueue *cq, struct et_msg_node *msg)
+static void destroy_msg_fifo(struct et_cqueue *cq)
 {
-	mutex_lock(&cq->msg_list_mutex);
-	list_add_tail(&msg->list, &cq->msg_list);
-	mutex_unlock(&cq->msg_list_mutex);
+	int count = 0;
+
+	mutex_lock(&cq->msg_fifo_mutex);
+	while (!kfifo_is_empty(&cq->msg_fifo)) {
+		kfifo_skip(&cq->msg_fifo);
+		count++;
+	}
+	if (cq->msg_stage_size)
+		count++;
+	mutex_unlock(&cq->msg_fifo_mutex);
+
+	if (count)
+		pr_warn("Discarded (%d) CQ user messages", count);
+
+	kfifo_free(&cq->msg_fifo);
+	kfree(cq->msg_stage);
+	cq->msg_stage = NULL;
+	cq->msg_stage_size = 0;
+	mutex_destroy(&cq->msg_fifo_mutex);
 }
 
-static struct et_msg_node *dequeue_msg_node(struct et_cqueue *cq)
+static bool push_msg_stage(struct et_cqueue *cq)
 {
-	struct et_msg_node *msg;
+	// Pairs with the barrier in et_cqueue_copy_to_user(): either the ring
+	// has room by now, or the consumer sees msg_stage_size and requeues
+	// the CQ work
+	smp_mb();
+	if (!kfifo_in(&cq->msg_fifo, cq->msg_stage, cq->msg_stage_size))
+		return false;
 
-	mutex_lock(&cq->msg_list_mutex);
-	msg = list_first_entry_or_null(&cq->msg_list, struct et_msg_node, list);
-	if (msg)
-		list_del(&msg->list);
+	WRITE_ONCE(cq->msg_stage_size, 0);
 
-	mutex_unlock(&cq->msg_list_mutex);
+	return true;
+}
 
-	return msg;
+static void et_eventfd_signal(struct eventfd_ctx *eventfd)
+{
+	if (!eventfd)
+		return;
+
+#if (LINUX_VERSION_CODE < KERNEL_VERSION(6, 8, 0))
+	eventfd_signal(eventfd, 1);
+#else
+	eventfd_signal(eventfd);
+#endif
 }
 
-static void destroy_msg_node(struct et_msg_node *node)
+static u64 et_squeue_free(struct et_squeue *sq)
 {
-	if (node) {
-		kfree(node->msg);
-		kfree(node);
-	}
+	u64 head = READ_ONCE(sq->cb.head);
+	u64 tail = READ_ONCE(sq->cb.tail);
+
+	if (head >= tail)
+		return (sq->cb.len - 1U) - (head - tail);
+	return tail - head - 1U;
 }
 
-static void destroy_msg_list(struct et_cqueue *cq)
+// Lock-free update of the SQ bit in sq_bitmap, the free space is checked again
+// once the bit is changed, see et_vqueue.c
+static bool et_squeue_update_avail(struct et_squeue *sq)
 {
-	struct list_head *pos, *next;
-	struct et_msg_node *node;
-	int count = 0;
+	struct et_vq_common *vq_common = sq->vq_common;
+	bool avail = et_squeue_free(sq) >= atomic_read(&sq->sq_threshold);
+
+	for (;;) {
+		if (!avail) {
+			clear_bit(sq->index, vq_common->sq_bitmap);
+		} else if (!test_and_set_bit(sq->index, vq_common->sq_bitmap)) {
+			mutex_lock(&vq_common->sq_eventfd_mutex);
+			et_eventfd_signal(vq_common->sq_avail_eventfd);
+			mutex_unlock(&vq_common->sq_eventfd_mutex);
+		}
+		smp_mb__after_atomic();
 
-	mutex_lock(&cq->msg_list_mutex);
-	list_for_each_safe (pos, next, &cq->msg_list) {
-		node = list_entry(pos, struct et_msg_node, list);
-		list_del(pos);
-		destroy_msg_node(node);
-		count++;
+		if (avail ==
+		    (et_squeue_free(sq) >= atomic_read(&sq->sq_threshold)))
+			return avail;
+		avail = !avail;
 	}
-	mutex_unlock(&cq->msg_list_mutex);
+}
 
-	if (count)
-		pr_warn("Discarded (%d) CQ user messages", count);
+static void notify_msg_available(struct et_cqueue *cq)
+{
+	mutex_lock(&cq->vq_common->cq_bitmap_mutex);
+	if (!test_and_set_bit(cq->index, cq->vq_common->cq_bitmap))
+		et_eventfd_signal(
+			cq->vq_common->cq_avail_eventfds[cq->index]);
+	mutex_unlock(&cq->vq_common->cq_bitmap_mutex);
+
+	wake_up_interruptible(&cq->vq_common->waitqueue);
 }
 
 static void mm_reset_completion_callback(struct et_cqueue *cq,
@@ -766,13 +814,7 @@ unlock_reset_mutex:
 
 bool et_cqueue_msg_available(struct et_cqueue *cq)
 {
-	struct et_msg_node *msg;
-
-	mutex_lock(&cq->msg_list_mutex);
-	msg = list_first_entry_or_null(&cq->msg_list, struct et_msg_node, list);
-	mutex_unlock(&cq->msg_list_mutex);
-
-	return !!(msg);
+	return !kfifo_is_empty(&cq->msg_fifo);
 }
 
 void et_squeue_sync_cb_for_host(struct et_squeue *sq);
@@ -788,15 +830,8 @@ static void et_sq_isr_work(struct work_struct *work)
 	et_squeue_sync_cb_for_host(sq);
 
 update_sq_bitmap:
-	// Update sq_bitmap
-	mutex_lock(&sq->vq_common->sq_bitmap_mutex);
-
-	if (et_circbuffer_free(&sq->cb) >= atomic_read(&sq->sq_threshold)) {
-		set_bit(sq->index, sq->vq_common->sq_bitmap);
+	if (et_squeue_update_avail(sq))
 		wake_up_interruptible(&sq->vq_common->waitqueue);
-	}
-
-	mutex_unlock(&sq->vq_common->sq_bitmap_mutex);
 }
 
 static void et_cq_isr_work(struct work_struct *work)
@@ -812,6 +847,329 @@ static void et_cq_isr_work(struct work_struct *work)
 	}
 }
 
+static enum hrtimer_restart et_cqueue_coalesce_timer_cb(struct hrtimer *timer)
+{
+	int i;
+	u64 head, tail;
+	struct et_vq_common *vq_common =
+		container_of(timer, struct et_vq_common, cq_coalesce_timer);
+	struct et_vq_data *vq_data =
+		container_of(vq_common, struct et_vq_data, vq_common);
+
+	for (i = 0; i < vq_common->cq_count; i++) {
+		et_ioread(vq_data->cqs[i].cb_mem,
+			  offsetof(struct et_circbuffer, head), (u8 *)&head,
+			  sizeof(head));
+		et_ioread(vq_data->cqs[i].cb_mem,
+			  offsetof(struct et_circbuffer, tail), (u8 *)&tail,
+			  sizeof(tail));
+		if (head != tail)
+			queue_work(vq_common->cq_workqueue,
+				   &vq_data->cqs[i].isr_work);
+	}
+
+	hrtimer_forward_now(timer,
+			    us_to_ktime(vq_common->cq_coalesce_timeout_us));
+
+	return HRTIMER_RESTART;
+}
+
+static void et_cqueue_coalesce_apply(struct et_vq_data *vq_data)
+{
+	int i;
+	u64 threshold;
+	struct et_vq_common *vq_common = &vq_data->vq_common;
+
+	hrtimer_cancel(&vq_common->cq_coalesce_timer);
+	if (!vq_common->cq_coalesce_active)
+		return;
+
+	threshold = vq_common->cq_coalesce_max_msgs;
+	for (i = 0; i < vq_common->cq_count; i++)
+		et_iowrite(vq_data->cqs[i].cb_mem,
+			   offsetof(struct et_circbuffer, notify_threshold),
+			   (u8 *)&threshold, sizeof(threshold));
+
+	if (threshold > 1)
+		hrtimer_start(&vq_common->cq_coalesce_timer,
+			      us_to_ktime(vq_common->cq_coalesce_timeout_us),
+			      HRTIMER_MODE_REL);
+}
+
+/*
+ * Timing model of the loopback device, to benchmark the host stack against the
+ * real kernel interface. With all the parameters at 0, the response of each
+ * command is pushed in the CQ as soon as the command is popped. Otherwise, the
+ * response is held back until the time given by the model, then pushed in the
+ * CQ and notified through the CQ ISR work, like the responses of the device.
+ * The parameters can be changed at any time through
+ * /sys/module/et_soc1/parameters/.
+ *
+ * The CQ interrupts are coalesced like the device does, following the
+ * notify_threshold of the CQ, see cq_coalesce_max_msgs in ops_vq_stats.
+ */
+static uint lb_cmd_latency_us;
+module_param(lb_cmd_latency_us, uint, 0644);
+MODULE_PARM_DESC(lb_cmd_latency_us,
+		 "Loopback device latency of each command in us, default 0");
+
+static uint lb_jitter_us;
+module_param(lb_jitter_us, uint, 0644);
+MODULE_PARM_DESC(lb_jitter_us,
+		 "Loopback device random extra latency, up to this in us, default 0");
+
+static uint lb_dma_mbps;
+module_param(lb_dma_mbps, uint, 0644);
+MODULE_PARM_DESC(lb_dma_mbps,
+		 "Loopback device DMA bandwidth in MB/s, DMA commands run one after another; 0 (default) for unlimited");
+
+/* Delay before pushing again the responses which didn't fit in the CQ */
+#define ET_LB_CQ_FULL_RETRY_US 10
+
+struct et_lb_rsp {
+	struct list_head list;
+	ktime_t due;
+	struct et_cqueue *cq;
+	u16 size;
+	u8 data[];
+};
+
+struct et_lb_model {
+	// Protects all the fields below
+	spinlock_t lock;
+	// Responses held back, by due time
+	struct list_head rsps;
+	// Time the DMA engine ends the last DMA command queued
+	ktime_t dma_free_at;
+	// Responses pushed in the CQs since the last CQ interrupt
+	u64 unnotified;
+	bool stopping;
+	struct hrtimer timer;
+	struct work_struct work;
+};
+
+static u64 et_lb_dma_bytes(struct cmn_header_t *header, u8 *cmd)
+{
+	struct device_ops_dma_list_cmd_t *dma_cmd;
+	struct device_ops_p2pdma_list_cmd_t *p2pdma_cmd;
+	size_t i, count;
+	u64 bytes = 0;
+
+	switch (header->msg_id) {
+	case DEV_OPS_API_MID_DMA_READLIST_CMD:
+	case DEV_OPS_API_MID_DMA_WRITELIST_CMD:
+		dma_cmd = (struct device_ops_dma_list_cmd_t *)cmd;
+		count = (header->size -
+			 offsetof(struct device_ops_dma_list_cmd_t, list)) /
+			sizeof(dma_cmd->list[0]);
+		for (i = 0; i < count; i++)
+			bytes += dma_cmd->list[i].size;
+		break;
+	case DEV_OPS_API_MID_P2PDMA_READLIST_CMD:
+	case DEV_OPS_API_MID_P2PDMA_WRITELIST_CMD:
+		p2pdma_cmd = (struct device_ops_p2pdma_list_cmd_t *)cmd;
+		count = (header->size -
+			 offsetof(struct device_ops_p2pdma_list_cmd_t, list)) /
+			sizeof(p2pdma_cmd->list[0]);
+		for (i = 0; i < count; i++)
+			bytes += p2pdma_cmd->list[i].size;
+		break;
+	}
+
+	return bytes;
+}
+
+// Returns when the response of the command is due, 0 if it's right away
+static ktime_t et_lb_model_due(struct et_lb_model *model,
+			       struct cmn_header_t *header, u8 *cmd)
+{
+	u32 latency_us = READ_ONCE(lb_cmd_latency_us);
+	u32 jitter_us = READ_ONCE(lb_jitter_us);
+	u32 dma_mbps = READ_ONCE(lb_dma_mbps);
+	u64 bytes = 0;
+	ktime_t due;
+
+	if (!latency_us && !jitter_us && !dma_mbps)
+		return 0;
+
+	if (jitter_us)
+		latency_us += get_random_u32() % (jitter_us + 1);
+	due = ktime_add_us(ktime_get(), latency_us);
+
+	if (dma_mbps)
+		bytes = et_lb_dma_bytes(header, cmd);
+	if (bytes) {
+		// The DMA starts once the command latency elapsed and the
+		// previous DMA is done, 1 MB/s moves 1 byte per us
+		spin_lock_bh(&model->lock);
+		if (ktime_before(due, model->dma_free_at))
+			due = model->dma_free_at;
+		due = ktime_add_ns(due, div_u64(bytes * NSEC_PER_USEC,
+						dma_mbps));
+		model->dma_free_at = due;
+		spin_unlock_bh(&model->lock);
+	}
+
+	return due;
+}
+
+// Raises the CQ interrupt once notify_threshold responses are pushed, the CQs
+// are polled meanwhile by the host. Called with model->lock held
+static void et_lb_cq_notify_locked(struct et_lb_model *model,
+				   struct et_cqueue *cq)
+{
+	u64 threshold;
+
+	et_ioread(cq->cb_mem, offsetof(struct et_circbuffer, notify_threshold),
+		  (u8 *)&threshold, sizeof(threshold));
+	if (++model->unnotified < threshold)
+		return;
+
+	model->unnotified = 0;
+	queue_work(cq->vq_common->cq_workqueue, &cq->isr_work);
+}
+
+static void et_lb_cq_notify(struct et_cqueue *cq)
+{
+	struct et_lb_model *model = cq->vq_common->lb_model;
+
+	spin_lock_bh(&model->lock);
+	et_lb_cq_notify_locked(model, cq);
+	spin_unlock_bh(&model->lock);
+}
+
+// Pushes the response in the CQ, or holds it back until due if not 0
+static bool et_lb_rsp_push(struct et_cqueue *cq, u8 *rsp, u16 size,
+			   ktime_t due)
+{
+	struct et_lb_model *model = cq->vq_common->lb_model;
+	struct et_lb_rsp *lb_rsp, *pos;
+
+	if (!due)
+		return et_circbuffer_push(&cq->cb, cq->cb_mem, rsp, size,
+					  ET_CB_SYNC_FOR_HOST |
+						  ET_CB_SYNC_FOR_DEVICE);
+
+	lb_rsp = kmalloc(struct_size(lb_rsp, data, size), GFP_KERNEL);
+	if (!lb_rsp)
+		return false;
+
+	lb_rsp->due = due;
+	lb_rsp->cq = cq;
+	lb_rsp->size = size;
+	memcpy(lb_rsp->data, rsp, size);
+
+	spin_lock_bh(&model->lock);
+	// The responses mostly come in order, look for their place from the end
+	list_for_each_entry_reverse(pos, &model->rsps, list) {
+		if (!ktime_after(pos->due, due))
+			break;
+	}
+	list_add(&lb_rsp->list, &pos->list);
+	if (!model->stopping && list_is_first(&lb_rsp->list, &model->rsps))
+		hrtimer_start(&model->timer, due, HRTIMER_MODE_ABS);
+	spin_unlock_bh(&model->lock);
+
+	return true;
+}
+
+static enum hrtimer_restart et_lb_model_timer_cb(struct hrtimer *timer)
+{
+	struct et_lb_model *model =
+		container_of(timer, struct et_lb_model, timer);
+
+	// The timer plays the device interrupt, the responses are pushed from
+	// a work as the CQ pop_mutex is needed
+	queue_work(system_highpri_wq, &model->work);
+
+	return HRTIMER_NORESTART;
+}
+
+static void et_lb_model_work(struct work_struct *work)
+{
+	struct et_lb_model *model =
+		container_of(work, struct et_lb_model, work);
+	struct et_lb_rsp *lb_rsp;
+	ktime_t now = ktime_get();
+	bool pushed;
+
+	spin_lock_bh(&model->lock);
+	while (!model->stopping && !list_empty(&model->rsps)) {
+		lb_rsp = list_first_entry(&model->rsps, struct et_lb_rsp, list);
+		if (ktime_after(lb_rsp->due, now)) {
+			hrtimer_start(&model->timer, lb_rsp->due,
+				      HRTIMER_MODE_ABS);
+			break;
+		}
+		list_del(&lb_rsp->list);
+		spin_unlock_bh(&model->lock);
+
+		mutex_lock(&lb_rsp->cq->pop_mutex);
+		pushed = et_circbuffer_push(&lb_rsp->cq->cb, lb_rsp->cq->cb_mem,
+					    lb_rsp->data, lb_rsp->size,
+					    ET_CB_SYNC_FOR_HOST |
+						    ET_CB_SYNC_FOR_DEVICE);
+		mutex_unlock(&lb_rsp->cq->pop_mutex);
+
+		spin_lock_bh(&model->lock);
+		if (!pushed) {
+			// CQ full, retry once the host popped some responses
+			list_add(&lb_rsp->list, &model->rsps);
+			hrtimer_start(&model->timer,
+				      ktime_add_us(now, ET_LB_CQ_FULL_RETRY_US),
+				      HRTIMER_MODE_ABS);
+			break;
+		}
+		et_lb_cq_notify_locked(model, lb_rsp->cq);
+		kfree(lb_rsp);
+	}
+	spin_unlock_bh(&model->lock);
+}
+
+static int et_lb_model_init(struct et_vq_common *vq_common)
+{
+	struct et_lb_model *model;
+
+	model = kzalloc(sizeof(*model), GFP_KERNEL);
+	if (!model)
+		return -ENOMEM;
+
+	spin_lock_init(&model->lock);
+	INIT_LIST_HEAD(&model->rsps);
+	INIT_WORK(&model->work, et_lb_model_work);
+#if (LINUX_VERSION_CODE < KERNEL_VERSION(6, 13, 0))
+	hrtimer_init(&model->timer, CLOCK_MONOTONIC, HRTIMER_MODE_ABS);
+	model->timer.function = et_lb_model_timer_cb;
+#else
+	hrtimer_setup(&model->timer, et_lb_model_timer_cb, CLOCK_MONOTONIC,
+		      HRTIMER_MODE_ABS);
+#endif
+	vq_common->lb_model = model;
+
+	return 0;
+}
+
+static void et_lb_model_destroy(struct et_vq_common *vq_common)
+{
+	struct et_lb_model *model = vq_common->lb_model;
+	struct et_lb_rsp *lb_rsp, *tmp;
+
+	if (!model)
+		return;
+
+	// The responses held back are dropped, like on a device reset
+	spin_lock_bh(&model->lock);
+	model->stopping = true;
+	spin_unlock_bh(&model->lock);
+	hrtimer_cancel(&model->timer);
+	cancel_work_sync(&model->work);
+
+	list_for_each_entry_safe(lb_rsp, tmp, &model->rsps, list)
+		kfree(lb_rsp);
+	kfree(model);
+	vq_common->lb_model = NULL;
+}
+
 static ssize_t et_high_priority_squeue_init_all(struct et_pci_dev *et_dev,
 						bool is_mgmt)
 {
@@ -991,6 +1349,13 @@ static ssize_t et_cqueue_init_all(struct et_pci_dev *et_dev, bool is_mgmt)
 	}
 
 	for (i = 0; i < vq_data->vq_common.cq_count; i++) {
+		rv = create_msg_fifo(&vq_data->cqs[i], cq_size);
+		if (rv) {
+			dev_err(&et_dev->pdev->dev,
+				"CQ[%ld] message ring allocation failed\n", i);
+			goto error_destroy_msg_fifos;
+		}
+
 		vq_data->cqs[i].index = i;
 		vq_data->cqs[i].vq_common = &vq_data->vq_common;
 		vq_data->cqs[i].cb_mem =
@@ -1003,8 +1368,6 @@ static ssize_t et_cqueue_init_all(struct et_pci_dev *et_dev, bool is_mgmt)
 		cq_baseaddr += cq_size;
 
 		mutex_init(&vq_data->cqs[i].pop_mutex);
-		INIT_LIST_HEAD(&vq_data->cqs[i].msg_list);
-		mutex_init(&vq_data->cqs[i].msg_list_mutex);
 
 		// Init statistics before work handler
 		et_vq_stats_init(&vq_data->cqs[i].stats);
@@ -1017,8 +1380,21 @@ static ssize_t et_cqueue_init_all(struct et_pci_dev *et_dev, bool is_mgmt)
 
 	vq_data->vq_common.intrpt_addr = (void __iomem __force *)vq_data->cqs;
 
+	mutex_lock(&vq_data->vq_common.cq_coalesce_mutex);
+	vq_data->vq_common.cq_coalesce_active = true;
+	et_cqueue_coalesce_apply(vq_data);
+	mutex_unlock(&vq_data->vq_common.cq_coalesce_mutex);
+
 	return 0;
 
+error_destroy_msg_fifos:
+	while (i--) {
+		cancel_work_sync(&vq_data->cqs[i].isr_work);
+		mutex_destroy(&vq_data->cqs[i].pop_mutex);
+		destroy_msg_fifo(&vq_data->cqs[i]);
+	}
+	kfree(vq_data->cqs);
+
 error_destroy_cq_workqueue:
 	destroy_workqueue(vq_data->vq_common.cq_workqueue);
 
@@ -1058,12 +1434,27 @@ ssize_t et_vqueue_init_all(struct et_pci_dev *et_dev, bool is_mgmt)
 	}
 
 	bitmap_zero(vq_common->sq_bitmap, ET_MAX_QUEUES);
-	mutex_init(&vq_common->sq_bitmap_mutex);
+	mutex_init(&vq_common->sq_eventfd_mutex);
 	bitmap_zero(vq_common->cq_bitmap, ET_MAX_QUEUES);
 	mutex_init(&vq_common->cq_bitmap_mutex);
 	init_waitqueue_head(&vq_common->waitqueue);
 	vq_common->pdev = et_dev->pdev;
 
+	mutex_init(&vq_common->cq_coalesce_mutex);
+	vq_common->cq_coalesce_active = false;
+	if (!vq_common->cq_coalesce_timeout_us)
+		vq_common->cq_coalesce_timeout_us =
+			ET_CQ_COALESCE_DEF_TIMEOUT_US;
+#if (LINUX_VERSION_CODE < KERNEL_VERSION(6, 13, 0))
+	hrtimer_init(&vq_common->cq_coalesce_timer, CLOCK_MONOTONIC,
+		     HRTIMER_MODE_REL);
+	vq_common->cq_coalesce_timer.function = et_cqueue_coalesce_timer_cb;
+#else
+	hrtimer_setup(&vq_common->cq_coalesce_timer,
+		      et_cqueue_coalesce_timer_cb, CLOCK_MONOTONIC,
+		      HRTIMER_MODE_REL);
+#endif
+
 	rv = et_sysfs_add_group(et_dev, vq_stats_gid);
 	if (rv)
 		return rv;
@@ -1080,8 +1471,15 @@ ssize_t et_vqueue_init_all(struct et_pci_dev *et_dev, bool is_mgmt)
 	if (rv)
 		goto error_squeue_destroy_all;
 
+	rv = et_lb_model_init(vq_common);
+	if (rv)
+		goto error_cqueue_destroy_all;
+
 	return rv;
 
+error_cqueue_destroy_all:
+	et_cqueue_destroy_all(et_dev, is_mgmt);
+
 error_squeue_destroy_all:
 	et_squeue_destroy_all(et_dev, is_mgmt);
 
@@ -1136,11 +1534,16 @@ static void et_cqueue_destroy_all(struct et_pci_dev *et_dev, bool is_mgmt)
 	struct et_vq_data *vq_data;
 
 	vq_data = is_mgmt ? &et_dev->mgmt.vq_data : &et_dev->ops.vq_data;
+
+	mutex_lock(&vq_data->vq_common.cq_coalesce_mutex);
+	vq_data->vq_common.cq_coalesce_active = false;
+	hrtimer_cancel(&vq_data->vq_common.cq_coalesce_timer);
+	mutex_unlock(&vq_data->vq_common.cq_coalesce_mutex);
+
 	for (i = 0; i < vq_data->vq_common.cq_count; i++) {
 		cancel_work_sync(&vq_data->cqs[i].isr_work);
 		mutex_destroy(&vq_data->cqs[i].pop_mutex);
-		destroy_msg_list(&vq_data->cqs[i]);
-		mutex_destroy(&vq_data->cqs[i].msg_list_mutex);
+		destroy_msg_fifo(&vq_data->cqs[i]);
 		vq_data->cqs[i].cb_mem = NULL;
 		vq_data->cqs[i].vq_common = NULL;
 	}
@@ -1165,21 +1568,111 @@ void et_vqueue_destroy_all(struct et_pci_dev *et_dev, bool is_mgmt)
 	while (waitqueue_active(&vq_data->vq_common.waitqueue))
 		msleep(50);
 
+	et_lb_model_destroy(&vq_data->vq_common);
 	et_cqueue_destroy_all(et_dev, is_mgmt);
 	et_squeue_destroy_all(et_dev, is_mgmt);
 	et_high_priority_squeue_destroy_all(et_dev, is_mgmt);
 
 	et_sysfs_remove_group(et_dev, vq_stats_gid);
 
-	mutex_destroy(&vq_data->vq_common.sq_bitmap_mutex);
+	et_vqueue_clear_eventfds(vq_data);
+	mutex_destroy(&vq_data->vq_common.sq_eventfd_mutex);
 	mutex_destroy(&vq_data->vq_common.cq_bitmap_mutex);
+	mutex_destroy(&vq_data->vq_common.cq_coalesce_mutex);
+}
+
+int et_vqueue_set_eventfd(struct et_vq_data *vq_data, u8 type, u16 cq_index,
+			  struct eventfd_ctx *eventfd)
+{
+	struct et_vq_common *vq_common = &vq_data->vq_common;
+	struct eventfd_ctx *old;
+
+	switch (type) {
+	case VQ_EVENTFD_CQ_AVAIL:
+		if (cq_index >= vq_common->cq_count)
+			return -EINVAL;
+
+		mutex_lock(&vq_common->cq_bitmap_mutex);
+		old = vq_common->cq_avail_eventfds[cq_index];
+		vq_common->cq_avail_eventfds[cq_index] = eventfd;
+		if (test_bit(cq_index, vq_common->cq_bitmap))
+			et_eventfd_signal(eventfd);
+		mutex_unlock(&vq_common->cq_bitmap_mutex);
+		break;
+
+	case VQ_EVENTFD_SQ_AVAIL:
+		mutex_lock(&vq_common->sq_eventfd_mutex);
+		old = vq_common->sq_avail_eventfd;
+		vq_common->sq_avail_eventfd = eventfd;
+		if (!bitmap_empty(vq_common->sq_bitmap, vq_common->sq_count))
+			et_eventfd_signal(eventfd);
+		mutex_unlock(&vq_common->sq_eventfd_mutex);
+		break;
+
+	default:
+		return -EINVAL;
+	}
+
+	if (old)
+		eventfd_ctx_put(old);
+
+	return 0;
+}
+
+void et_vqueue_clear_eventfds(struct et_vq_data *vq_data)
+{
+	int i;
+	struct et_vq_common *vq_common = &vq_data->vq_common;
+
+	mutex_lock(&vq_common->cq_bitmap_mutex);
+	for (i = 0; i < ARRAY_SIZE(vq_common->cq_avail_eventfds); i++) {
+		if (vq_common->cq_avail_eventfds[i]) {
+			eventfd_ctx_put(vq_common->cq_avail_eventfds[i]);
+			vq_common->cq_avail_eventfds[i] = NULL;
+		}
+	}
+	mutex_unlock(&vq_common->cq_bitmap_mutex);
+
+	mutex_lock(&vq_common->sq_eventfd_mutex);
+	if (vq_common->sq_avail_eventfd) {
+		eventfd_ctx_put(vq_common->sq_avail_eventfd);
+		vq_common->sq_avail_eventfd = NULL;
+	}
+	mutex_unlock(&vq_common->sq_eventfd_mutex);
+}
+
+int et_vqueue_set_cq_coalescing(struct et_vq_data *vq_data, u16 max_msgs,
+				u32 timeout_us)
+{
+	int i;
+	struct et_vq_common *vq_common = &vq_data->vq_common;
+
+	if (timeout_us > USEC_PER_SEC)
+		return -EINVAL;
+
+	mutex_lock(&vq_common->cq_coalesce_mutex);
+	vq_common->cq_coalesce_max_msgs = max_msgs;
+	vq_common->cq_coalesce_timeout_us =
+		timeout_us ? timeout_us : ET_CQ_COALESCE_DEF_TIMEOUT_US;
+	et_cqueue_coalesce_apply(vq_data);
+
+	if (vq_common->cq_coalesce_active && max_msgs <= 1) {
+		for (i = 0; i < vq_common->cq_count; i++)
+			queue_work(vq_common->cq_workqueue,
+				   &vq_data->cqs[i].isr_work);
+	}
+	mutex_unlock(&vq_common->cq_coalesce_mutex);
+
+	return 0;
 }
 
 static inline void loopback_interrupt(struct et_squeue *sq,
-				      struct et_cqueue *cq)
+				      struct et_cqueue *cq, bool rsp_pushed)
 {
 	queue_work(sq->vq_common->sq_workqueue, &sq->isr_work);
-	queue_work(cq->vq_common->cq_workqueue, &cq->isr_work);
+	// A deferred response is notified once it's pushed in the CQ
+	if (rsp_pushed)
+		et_lb_cq_notify(cq);
 }
 
 static ssize_t cmd_loopback_handler(struct et_squeue *sq)
@@ -1229,6 +1722,7 @@ static ssize_t cmd_loopback_handler(struct et_squeue *sq)
 	struct et_cqueue *cqs =
 		(struct et_cqueue __force *)sq->vq_common->intrpt_addr;
 	struct et_cqueue *cq = &cqs[0];
+	ktime_t due;
 
 	// Read the message header
 	if (!et_circbuffer_pop(&sq->cb, sq->cb_mem, (u8 *)&header,
@@ -1246,6 +1740,8 @@ static ssize_t cmd_loopback_handler(struct et_squeue *sq)
 		goto error_free_cmd_mem;
 	}
 
+	due = et_lb_model_due(sq->vq_common->lb_model, &header, cmd);
+
 	mutex_lock(&cq->pop_mutex);
 	switch (header.msg_id) {
 	case DEV_OPS_API_MID_ECHO_CMD:
@@ -1258,10 +1754,7 @@ static ssize_t cmd_loopback_handler(struct et_squeue *sq)
 			DEV_OPS_API_MID_ECHO_RSP;
 		// send dummy timestamp
 		echo_rsp.device_cmd_start_ts = 0xdeadbeef;
-		if (!et_circbuffer_push(&cq->cb, cq->cb_mem, (u8 *)&echo_rsp,
-					sizeof(echo_rsp),
-					ET_CB_SYNC_FOR_HOST |
-						ET_CB_SYNC_FOR_DEVICE))
+		if (!et_lb_rsp_push(cq, (u8 *)&echo_rsp, sizeof(echo_rsp), due))
 			rv = -EAGAIN;
 		break;
 
@@ -1276,10 +1769,8 @@ static ssize_t cmd_loopback_handler(struct et_squeue *sq)
 		compat_rsp.major = 0;
 		compat_rsp.minor = 1;
 		compat_rsp.patch = 0;
-		if (!et_circbuffer_push(&cq->cb, cq->cb_mem, (u8 *)&compat_rsp,
-					sizeof(compat_rsp),
-					ET_CB_SYNC_FOR_HOST |
-						ET_CB_SYNC_FOR_DEVICE))
+		if (!et_lb_rsp_push(cq, (u8 *)&compat_rsp,
+				    sizeof(compat_rsp), due))
 			rv = -EAGAIN;
 		break;
 
@@ -1294,10 +1785,8 @@ static ssize_t cmd_loopback_handler(struct et_squeue *sq)
 		fw_version_rsp.major = 0;
 		fw_version_rsp.minor = 0;
 		fw_version_rsp.patch = 0;
-		if (!et_circbuffer_push(
-			    &cq->cb, cq->cb_mem, (u8 *)&fw_version_rsp,
-			    sizeof(fw_version_rsp),
-			    ET_CB_SYNC_FOR_HOST | ET_CB_SYNC_FOR_DEVICE))
+		if (!et_lb_rsp_push(cq, (u8 *)&fw_version_rsp,
+				    sizeof(fw_version_rsp), due))
 			rv = -EAGAIN;
 		break;
 
@@ -1311,10 +1800,8 @@ static ssize_t cmd_loopback_handler(struct et_squeue *sq)
 		dma_list_rsp.response_info.rsp_hdr.msg_id =
 			dma_list_cmd->command_info.cmd_hdr.msg_id + 1;
 		dma_list_rsp.status = DEV_OPS_API_DMA_RESPONSE_COMPLETE;
-		if (!et_circbuffer_push(
-			    &cq->cb, cq->cb_mem, (u8 *)&dma_list_rsp,
-			    sizeof(dma_list_rsp),
-			    ET_CB_SYNC_FOR_HOST | ET_CB_SYNC_FOR_DEVICE))
+		if (!et_lb_rsp_push(cq, (u8 *)&dma_list_rsp,
+				    sizeof(dma_list_rsp), due))
 			rv = -EAGAIN;
 		break;
 
@@ -1328,10 +1815,8 @@ static ssize_t cmd_loopback_handler(struct et_squeue *sq)
 		p2pdma_list_rsp.response_info.rsp_hdr.msg_id =
 			p2pdma_list_cmd->command_info.cmd_hdr.msg_id + 1;
 		p2pdma_list_rsp.status = DEV_OPS_API_DMA_RESPONSE_COMPLETE;
-		if (!et_circbuffer_push(
-			    &cq->cb, cq->cb_mem, (u8 *)&p2pdma_list_rsp,
-			    sizeof(p2pdma_list_rsp),
-			    ET_CB_SYNC_FOR_HOST | ET_CB_SYNC_FOR_DEVICE))
+		if (!et_lb_rsp_push(cq, (u8 *)&p2pdma_list_rsp,
+				    sizeof(p2pdma_list_rsp), due))
 			rv = -EAGAIN;
 		break;
 
@@ -1346,10 +1831,8 @@ static ssize_t cmd_loopback_handler(struct et_squeue *sq)
 			DEV_OPS_API_MID_KERNEL_LAUNCH_RSP;
 		kernel_launch_rsp.status =
 			DEV_OPS_API_KERNEL_LAUNCH_RESPONSE_KERNEL_COMPLETED;
-		if (!et_circbuffer_push(
-			    &cq->cb, cq->cb_mem, (u8 *)&kernel_launch_rsp,
-			    sizeof(kernel_launch_rsp),
-			    ET_CB_SYNC_FOR_HOST | ET_CB_SYNC_FOR_DEVICE))
+		if (!et_lb_rsp_push(cq, (u8 *)&kernel_launch_rsp,
+				    sizeof(kernel_launch_rsp), due))
 			rv = -EAGAIN;
 		break;
 
@@ -1363,20 +1846,16 @@ static ssize_t cmd_loopback_handler(struct et_squeue *sq)
 			DEV_OPS_API_MID_KERNEL_ABORT_RSP;
 		kernel_abort_rsp.status =
 			DEV_OPS_API_KERNEL_ABORT_RESPONSE_SUCCESS;
-		if (!et_circbuffer_push(
-			    &cq->cb, cq->cb_mem, (u8 *)&kernel_abort_rsp,
-			    sizeof(kernel_abort_rsp),
-			    ET_CB_SYNC_FOR_HOST | ET_CB_SYNC_FOR_DEVICE))
+		if (!et_lb_rsp_push(cq, (u8 *)&kernel_abort_rsp,
+				    sizeof(kernel_abort_rsp), due))
 			rv = -EAGAIN;
 		break;
 
 	case DM_CMD_SET_PCIE_RESET:
 		FILL_RSP_HEADER(dm_def_rsp, header.tag_id,
 				DM_CMD_SET_PCIE_RESET, 0, DM_STATUS_SUCCESS);
-		if (!et_circbuffer_push(&cq->cb, cq->cb_mem, (u8 *)&dm_def_rsp,
-					sizeof(dm_def_rsp),
-					ET_CB_SYNC_FOR_HOST |
-						ET_CB_SYNC_FOR_DEVICE))
+		if (!et_lb_rsp_push(cq, (u8 *)&dm_def_rsp,
+				    sizeof(dm_def_rsp), due))
 			rv = -EAGAIN;
 		break;
 
@@ -1384,10 +1863,8 @@ static ssize_t cmd_loopback_handler(struct et_squeue *sq)
 		FILL_RSP_HEADER(dm_def_rsp, header.tag_id,
 				DM_CMD_SET_PCIE_MAX_LINK_SPEED, 0,
 				DM_STATUS_SUCCESS);
-		if (!et_circbuffer_push(&cq->cb, cq->cb_mem, (u8 *)&dm_def_rsp,
-					sizeof(dm_def_rsp),
-					ET_CB_SYNC_FOR_HOST |
-						ET_CB_SYNC_FOR_DEVICE))
+		if (!et_lb_rsp_push(cq, (u8 *)&dm_def_rsp,
+				    sizeof(dm_def_rsp), due))
 			rv = -EAGAIN;
 		break;
 
@@ -1395,10 +1872,8 @@ static ssize_t cmd_loopback_handler(struct et_squeue *sq)
 		FILL_RSP_HEADER(dm_def_rsp, header.tag_id,
 				DM_CMD_SET_PCIE_LANE_WIDTH, 0,
 				DM_STATUS_SUCCESS);
-		if (!et_circbuffer_push(&cq->cb, cq->cb_mem, (u8 *)&dm_def_rsp,
-					sizeof(dm_def_rsp),
-					ET_CB_SYNC_FOR_HOST |
-						ET_CB_SYNC_FOR_DEVICE))
+		if (!et_lb_rsp_push(cq, (u8 *)&dm_def_rsp,
+				    sizeof(dm_def_rsp), due))
 			rv = -EAGAIN;
 		break;
 
@@ -1406,10 +1881,8 @@ static ssize_t cmd_loopback_handler(struct et_squeue *sq)
 		FILL_RSP_HEADER(dm_def_rsp, header.tag_id,
 				DM_CMD_SET_PCIE_RETRAIN_PHY, 0,
 				DM_STATUS_SUCCESS);
-		if (!et_circbuffer_push(&cq->cb, cq->cb_mem, (u8 *)&dm_def_rsp,
-					sizeof(dm_def_rsp),
-					ET_CB_SYNC_FOR_HOST |
-						ET_CB_SYNC_FOR_DEVICE))
+		if (!et_lb_rsp_push(cq, (u8 *)&dm_def_rsp,
+				    sizeof(dm_def_rsp), due))
 			rv = -EAGAIN;
 		break;
 
@@ -1417,10 +1890,8 @@ static ssize_t cmd_loopback_handler(struct et_squeue *sq)
 		FILL_RSP_HEADER(dm_gec_rsp, header.tag_id,
 				DM_CMD_GET_MODULE_PCIE_ECC_UECC, 0,
 				DM_STATUS_SUCCESS);
-		if (!et_circbuffer_push(&cq->cb, cq->cb_mem, (u8 *)&dm_gec_rsp,
-					sizeof(dm_gec_rsp),
-					ET_CB_SYNC_FOR_HOST |
-						ET_CB_SYNC_FOR_DEVICE))
+		if (!et_lb_rsp_push(cq, (u8 *)&dm_gec_rsp,
+				    sizeof(dm_gec_rsp), due))
 			rv = -EAGAIN;
 		break;
 
@@ -1428,10 +1899,8 @@ static ssize_t cmd_loopback_handler(struct et_squeue *sq)
 		FILL_RSP_HEADER(dm_gec_rsp, header.tag_id,
 				DM_CMD_GET_MODULE_DDR_ECC_UECC, 0,
 				DM_STATUS_SUCCESS);
-		if (!et_circbuffer_push(&cq->cb, cq->cb_mem, (u8 *)&dm_gec_rsp,
-					sizeof(dm_gec_rsp),
-					ET_CB_SYNC_FOR_HOST |
-						ET_CB_SYNC_FOR_DEVICE))
+		if (!et_lb_rsp_push(cq, (u8 *)&dm_gec_rsp,
+				    sizeof(dm_gec_rsp), due))
 			rv = -EAGAIN;
 		break;
 
@@ -1439,10 +1908,8 @@ static ssize_t cmd_loopback_handler(struct et_squeue *sq)
 		FILL_RSP_HEADER(dm_gec_rsp, header.tag_id,
 				DM_CMD_GET_MODULE_SRAM_ECC_UECC, 0,
 				DM_STATUS_SUCCESS);
-		if (!et_circbuffer_push(&cq->cb, cq->cb_mem, (u8 *)&dm_gec_rsp,
-					sizeof(dm_gec_rsp),
-					ET_CB_SYNC_FOR_HOST |
-						ET_CB_SYNC_FOR_DEVICE))
+		if (!et_lb_rsp_push(cq, (u8 *)&dm_gec_rsp,
+				    sizeof(dm_gec_rsp), due))
 			rv = -EAGAIN;
 		break;
 
@@ -1450,20 +1917,16 @@ static ssize_t cmd_loopback_handler(struct et_squeue *sq)
 		FILL_RSP_HEADER(dm_dbc_rsp, header.tag_id,
 				DM_CMD_GET_MODULE_DDR_BW_COUNTER, 0,
 				DM_STATUS_SUCCESS);
-		if (!et_circbuffer_push(&cq->cb, cq->cb_mem, (u8 *)&dm_dbc_rsp,
-					sizeof(dm_dbc_rsp),
-					ET_CB_SYNC_FOR_HOST |
-						ET_CB_SYNC_FOR_DEVICE))
+		if (!et_lb_rsp_push(cq, (u8 *)&dm_dbc_rsp,
+				    sizeof(dm_dbc_rsp), due))
 			rv = -EAGAIN;
 		break;
 
 	case DM_CMD_SET_DDR_ECC_COUNT:
 		FILL_RSP_HEADER(dm_def_rsp, header.tag_id,
 				DM_CMD_SET_DDR_ECC_COUNT, 0, DM_STATUS_SUCCESS);
-		if (!et_circbuffer_push(&cq->cb, cq->cb_mem, (u8 *)&dm_def_rsp,
-					sizeof(dm_def_rsp),
-					ET_CB_SYNC_FOR_HOST |
-						ET_CB_SYNC_FOR_DEVICE))
+		if (!et_lb_rsp_push(cq, (u8 *)&dm_def_rsp,
+				    sizeof(dm_def_rsp), due))
 			rv = -EAGAIN;
 		break;
 
@@ -1471,10 +1934,8 @@ static ssize_t cmd_loopback_handler(struct et_squeue *sq)
 		FILL_RSP_HEADER(dm_def_rsp, header.tag_id,
 				DM_CMD_SET_PCIE_ECC_COUNT, 0,
 				DM_STATUS_SUCCESS);
-		if (!et_circbuffer_push(&cq->cb, cq->cb_mem, (u8 *)&dm_def_rsp,
-					sizeof(dm_def_rsp),
-					ET_CB_SYNC_FOR_HOST |
-						ET_CB_SYNC_FOR_DEVICE))
+		if (!et_lb_rsp_push(cq, (u8 *)&dm_def_rsp,
+				    sizeof(dm_def_rsp), due))
 			rv = -EAGAIN;
 		break;
 
@@ -1482,10 +1943,8 @@ static ssize_t cmd_loopback_handler(struct et_squeue *sq)
 		FILL_RSP_HEADER(dm_def_rsp, header.tag_id,
 				DM_CMD_SET_SRAM_ECC_COUNT, 0,
 				DM_STATUS_SUCCESS);
-		if (!et_circbuffer_push(&cq->cb, cq->cb_mem, (u8 *)&dm_def_rsp,
-					sizeof(dm_def_rsp),
-					ET_CB_SYNC_FOR_HOST |
-						ET_CB_SYNC_FOR_DEVICE))
+		if (!et_lb_rsp_push(cq, (u8 *)&dm_def_rsp,
+				    sizeof(dm_def_rsp), due))
 			rv = -EAGAIN;
 		break;
 
@@ -1493,10 +1952,8 @@ static ssize_t cmd_loopback_handler(struct et_squeue *sq)
 		FILL_RSP_HEADER(dm_mme_rsp, header.tag_id,
 				DM_CMD_GET_MAX_MEMORY_ERROR, 0,
 				DM_STATUS_SUCCESS);
-		if (!et_circbuffer_push(&cq->cb, cq->cb_mem, (u8 *)&dm_mme_rsp,
-					sizeof(dm_mme_rsp),
-					ET_CB_SYNC_FOR_HOST |
-						ET_CB_SYNC_FOR_DEVICE))
+		if (!et_lb_rsp_push(cq, (u8 *)&dm_mme_rsp,
+				    sizeof(dm_mme_rsp), due))
 			rv = -EAGAIN;
 		break;
 
@@ -1504,10 +1961,8 @@ static ssize_t cmd_loopback_handler(struct et_squeue *sq)
 		FILL_RSP_HEADER(dm_mdb_rsp, header.tag_id,
 				DM_CMD_GET_MODULE_MAX_DDR_BW, 0,
 				DM_STATUS_SUCCESS);
-		if (!et_circbuffer_push(&cq->cb, cq->cb_mem, (u8 *)&dm_mdb_rsp,
-					sizeof(dm_mdb_rsp),
-					ET_CB_SYNC_FOR_HOST |
-						ET_CB_SYNC_FOR_DEVICE))
+		if (!et_lb_rsp_push(cq, (u8 *)&dm_mdb_rsp,
+				    sizeof(dm_mdb_rsp), due))
 			rv = -EAGAIN;
 		break;
 
@@ -1515,10 +1970,8 @@ static ssize_t cmd_loopback_handler(struct et_squeue *sq)
 		FILL_RSP_HEADER(dm_mt_rsp, header.tag_id,
 				DM_CMD_GET_MODULE_MAX_TEMPERATURE, 0,
 				DM_STATUS_SUCCESS);
-		if (!et_circbuffer_push(&cq->cb, cq->cb_mem, (u8 *)&dm_mt_rsp,
-					sizeof(dm_mt_rsp),
-					ET_CB_SYNC_FOR_HOST |
-						ET_CB_SYNC_FOR_DEVICE))
+		if (!et_lb_rsp_push(cq, (u8 *)&dm_mt_rsp,
+				    sizeof(dm_mt_rsp), due))
 			rv = -EAGAIN;
 		break;
 
@@ -1526,10 +1979,8 @@ static ssize_t cmd_loopback_handler(struct et_squeue *sq)
 		FILL_RSP_HEADER(dm_def_rsp, header.tag_id,
 				DM_CMD_SET_FIRMWARE_UPDATE, 0,
 				DM_STATUS_SUCCESS);
-		if (!et_circbuffer_push(&cq->cb, cq->cb_mem, (u8 *)&dm_def_rsp,
-					sizeof(dm_def_rsp),
-					ET_CB_SYNC_FOR_HOST |
-						ET_CB_SYNC_FOR_DEVICE))
+		if (!et_lb_rsp_push(cq, (u8 *)&dm_def_rsp,
+				    sizeof(dm_def_rsp), due))
 			rv = -EAGAIN;
 		break;
 
@@ -1537,10 +1988,8 @@ static ssize_t cmd_loopback_handler(struct et_squeue *sq)
 		FILL_RSP_HEADER(dm_fv_rsp, header.tag_id,
 				DM_CMD_GET_MODULE_FIRMWARE_REVISIONS, 0,
 				DM_STATUS_SUCCESS);
-		if (!et_circbuffer_push(&cq->cb, cq->cb_mem, (u8 *)&dm_fv_rsp,
-					sizeof(dm_fv_rsp),
-					ET_CB_SYNC_FOR_HOST |
-						ET_CB_SYNC_FOR_DEVICE))
+		if (!et_lb_rsp_push(cq, (u8 *)&dm_fv_rsp,
+				    sizeof(dm_fv_rsp), due))
 			rv = -EAGAIN;
 		break;
 
@@ -1548,10 +1997,8 @@ static ssize_t cmd_loopback_handler(struct et_squeue *sq)
 		FILL_RSP_HEADER(dm_def_rsp, header.tag_id,
 				DM_CMD_GET_FIRMWARE_BOOT_STATUS, 0,
 				DM_STATUS_SUCCESS);
-		if (!et_circbuffer_push(&cq->cb, cq->cb_mem, (u8 *)&dm_def_rsp,
-					sizeof(dm_def_rsp),
-					ET_CB_SYNC_FOR_HOST |
-						ET_CB_SYNC_FOR_DEVICE))
+		if (!et_lb_rsp_push(cq, (u8 *)&dm_def_rsp,
+				    sizeof(dm_def_rsp), due))
 			rv = -EAGAIN;
 		break;
 
@@ -1559,10 +2006,8 @@ static ssize_t cmd_loopback_handler(struct et_squeue *sq)
 		FILL_RSP_HEADER(dm_def_rsp, header.tag_id,
 				DM_CMD_SET_SP_BOOT_ROOT_CERT, 0,
 				DM_STATUS_SUCCESS);
-		if (!et_circbuffer_push(&cq->cb, cq->cb_mem, (u8 *)&dm_def_rsp,
-					sizeof(dm_def_rsp),
-					ET_CB_SYNC_FOR_HOST |
-						ET_CB_SYNC_FOR_DEVICE))
+		if (!et_lb_rsp_push(cq, (u8 *)&dm_def_rsp,
+				    sizeof(dm_def_rsp), due))
 			rv = -EAGAIN;
 		break;
 
@@ -1575,10 +2020,8 @@ static ssize_t cmd_loopback_handler(struct et_squeue *sq)
 				DM_CMD_GET_MODULE_MANUFACTURE_NAME, 0,
 				DM_STATUS_SUCCESS);
 		sprintf(dm_at_rsp.asset_info.asset, "%s", "Esperan");
-		if (!et_circbuffer_push(&cq->cb, cq->cb_mem, (u8 *)&dm_at_rsp,
-					sizeof(dm_at_rsp),
-					ET_CB_SYNC_FOR_HOST |
-						ET_CB_SYNC_FOR_DEVICE))
+		if (!et_lb_rsp_push(cq, (u8 *)&dm_at_rsp,
+				    sizeof(dm_at_rsp), due))
 			rv = -EAGAIN;
 		break;
 
@@ -1587,10 +2030,8 @@ static ssize_t cmd_loopback_handler(struct et_squeue *sq)
 				DM_CMD_GET_MODULE_PART_NUMBER, 0,
 				DM_STATUS_SUCCESS);
 		sprintf(dm_at_rsp.asset_info.asset, "%s", "ETPART1");
-		if (!et_circbuffer_push(&cq->cb, cq->cb_mem, (u8 *)&dm_at_rsp,
-					sizeof(dm_at_rsp),
-					ET_CB_SYNC_FOR_HOST |
-						ET_CB_SYNC_FOR_DEVICE))
+		if (!et_lb_rsp_push(cq, (u8 *)&dm_at_rsp,
+				    sizeof(dm_at_rsp), due))
 			rv = -EAGAIN;
 		break;
 
@@ -1599,10 +2040,8 @@ static ssize_t cmd_loopback_handler(struct et_squeue *sq)
 				DM_CMD_GET_MODULE_SERIAL_NUMBER, 0,
 				DM_STATUS_SUCCESS);
 		sprintf(dm_at_rsp.asset_info.asset, "%s", "ETSER_1");
-		if (!et_circbuffer_push(&cq->cb, cq->cb_mem, (u8 *)&dm_at_rsp,
-					sizeof(dm_at_rsp),
-					ET_CB_SYNC_FOR_HOST |
-						ET_CB_SYNC_FOR_DEVICE))
+		if (!et_lb_rsp_push(cq, (u8 *)&dm_at_rsp,
+				    sizeof(dm_at_rsp), due))
 			rv = -EAGAIN;
 		break;
 
@@ -1610,10 +2049,8 @@ static ssize_t cmd_loopback_handler(struct et_squeue *sq)
 		FILL_RSP_HEADER(dm_at_rsp, header.tag_id,
 				DM_CMD_GET_ASIC_CHIP_REVISION, 0,
 				DM_STATUS_SUCCESS);
-		if (!et_circbuffer_push(&cq->cb, cq->cb_mem, (u8 *)&dm_at_rsp,
-					sizeof(dm_at_rsp),
-					ET_CB_SYNC_FOR_HOST |
-						ET_CB_SYNC_FOR_DEVICE))
+		if (!et_lb_rsp_push(cq, (u8 *)&dm_at_rsp,
+				    sizeof(dm_at_rsp), due))
 			rv = -EAGAIN;
 		break;
 
@@ -1621,10 +2058,8 @@ static ssize_t cmd_loopback_handler(struct et_squeue *sq)
 		FILL_RSP_HEADER(dm_at_rsp, header.tag_id,
 				DM_CMD_GET_MODULE_PCIE_NUM_PORTS_MAX_SPEED, 0,
 				DM_STATUS_SUCCESS);
-		if (!et_circbuffer_push(&cq->cb, cq->cb_mem, (u8 *)&dm_at_rsp,
-					sizeof(dm_at_rsp),
-					ET_CB_SYNC_FOR_HOST |
-						ET_CB_SYNC_FOR_DEVICE))
+		if (!et_lb_rsp_push(cq, (u8 *)&dm_at_rsp,
+				    sizeof(dm_at_rsp), due))
 			rv = -EAGAIN;
 		break;
 
@@ -1633,10 +2068,8 @@ static ssize_t cmd_loopback_handler(struct et_squeue *sq)
 				DM_CMD_GET_MODULE_REVISION, 0,
 				DM_STATUS_SUCCESS);
 		sprintf(dm_at_rsp.asset_info.asset, "%d", 1);
-		if (!et_circbuffer_push(&cq->cb, cq->cb_mem, (u8 *)&dm_at_rsp,
-					sizeof(dm_at_rsp),
-					ET_CB_SYNC_FOR_HOST |
-						ET_CB_SYNC_FOR_DEVICE))
+		if (!et_lb_rsp_push(cq, (u8 *)&dm_at_rsp,
+				    sizeof(dm_at_rsp), due))
 			rv = -EAGAIN;
 		break;
 
@@ -1645,10 +2078,8 @@ static ssize_t cmd_loopback_handler(struct et_squeue *sq)
 				DM_CMD_GET_MODULE_FORM_FACTOR, 0,
 				DM_STATUS_SUCCESS);
 		sprintf(dm_at_rsp.asset_info.asset, "%s", "Dual_M2");
-		if (!et_circbuffer_push(&cq->cb, cq->cb_mem, (u8 *)&dm_at_rsp,
-					sizeof(dm_at_rsp),
-					ET_CB_SYNC_FOR_HOST |
-						ET_CB_SYNC_FOR_DEVICE))
+		if (!et_lb_rsp_push(cq, (u8 *)&dm_at_rsp,
+				    sizeof(dm_at_rsp), due))
 			rv = -EAGAIN;
 		break;
 
@@ -1657,10 +2088,8 @@ static ssize_t cmd_loopback_handler(struct et_squeue *sq)
 				DM_CMD_GET_MODULE_MEMORY_VENDOR_PART_NUMBER, 0,
 				DM_STATUS_SUCCESS);
 		sprintf(dm_at_rsp.asset_info.asset, "%s", "Unknown");
-		if (!et_circbuffer_push(&cq->cb, cq->cb_mem, (u8 *)&dm_at_rsp,
-					sizeof(dm_at_rsp),
-					ET_CB_SYNC_FOR_HOST |
-						ET_CB_SYNC_FOR_DEVICE))
+		if (!et_lb_rsp_push(cq, (u8 *)&dm_at_rsp,
+				    sizeof(dm_at_rsp), due))
 			rv = -EAGAIN;
 		break;
 
@@ -1669,10 +2098,8 @@ static ssize_t cmd_loopback_handler(struct et_squeue *sq)
 				DM_CMD_GET_MODULE_MEMORY_SIZE_MB, 0,
 				DM_STATUS_SUCCESS);
 		sprintf(dm_at_rsp.asset_info.asset, "%d", 16 * 1024);
-		if (!et_circbuffer_push(&cq->cb, cq->cb_mem, (u8 *)&dm_at_rsp,
-					sizeof(dm_at_rsp),
-					ET_CB_SYNC_FOR_HOST |
-						ET_CB_SYNC_FOR_DEVICE))
+		if (!et_lb_rsp_push(cq, (u8 *)&dm_at_rsp,
+				    sizeof(dm_at_rsp), due))
 			rv = -EAGAIN;
 		break;
 
@@ -1681,10 +2108,8 @@ static ssize_t cmd_loopback_handler(struct et_squeue *sq)
 				DM_CMD_GET_MODULE_MEMORY_TYPE, 0,
 				DM_STATUS_SUCCESS);
 		sprintf(dm_at_rsp.asset_info.asset, "%s", "LPDDR4X");
-		if (!et_circbuffer_push(&cq->cb, cq->cb_mem, (u8 *)&dm_at_rsp,
-					sizeof(dm_at_rsp),
-					ET_CB_SYNC_FOR_HOST |
-						ET_CB_SYNC_FOR_DEVICE))
+		if (!et_lb_rsp_push(cq, (u8 *)&dm_at_rsp,
+				    sizeof(dm_at_rsp), due))
 			rv = -EAGAIN;
 		break;
 
@@ -1692,10 +2117,8 @@ static ssize_t cmd_loopback_handler(struct et_squeue *sq)
 		FILL_RSP_HEADER(dm_ps_rsp, header.tag_id,
 				DM_CMD_GET_MODULE_POWER_STATE, 0,
 				DM_STATUS_SUCCESS);
-		if (!et_circbuffer_push(&cq->cb, cq->cb_mem, (u8 *)&dm_ps_rsp,
-					sizeof(dm_ps_rsp),
-					ET_CB_SYNC_FOR_HOST |
-						ET_CB_SYNC_FOR_DEVICE))
+		if (!et_lb_rsp_push(cq, (u8 *)&dm_ps_rsp,
+				    sizeof(dm_ps_rsp), due))
 			rv = -EAGAIN;
 		break;
 
@@ -1703,10 +2126,8 @@ static ssize_t cmd_loopback_handler(struct et_squeue *sq)
 		FILL_RSP_HEADER(dm_def_rsp, header.tag_id,
 				DM_CMD_SET_MODULE_ACTIVE_POWER_MANAGEMENT, 0,
 				DM_STATUS_SUCCESS);
-		if (!et_circbuffer_push(&cq->cb, cq->cb_mem, (u8 *)&dm_def_rsp,
-					sizeof(dm_def_rsp),
-					ET_CB_SYNC_FOR_HOST |
-						ET_CB_SYNC_FOR_DEVICE))
+		if (!et_lb_rsp_push(cq, (u8 *)&dm_def_rsp,
+				    sizeof(dm_def_rsp), due))
 			rv = -EAGAIN;
 		break;
 
@@ -1714,10 +2135,8 @@ static ssize_t cmd_loopback_handler(struct et_squeue *sq)
 		FILL_RSP_HEADER(dm_tl_rsp, header.tag_id,
 				DM_CMD_GET_MODULE_STATIC_TDP_LEVEL, 0,
 				DM_STATUS_SUCCESS);
-		if (!et_circbuffer_push(&cq->cb, cq->cb_mem, (u8 *)&dm_tl_rsp,
-					sizeof(dm_tl_rsp),
-					ET_CB_SYNC_FOR_HOST |
-						ET_CB_SYNC_FOR_DEVICE))
+		if (!et_lb_rsp_push(cq, (u8 *)&dm_tl_rsp,
+				    sizeof(dm_tl_rsp), due))
 			rv = -EAGAIN;
 		break;
 
@@ -1725,10 +2144,8 @@ static ssize_t cmd_loopback_handler(struct et_squeue *sq)
 		FILL_RSP_HEADER(dm_def_rsp, header.tag_id,
 				DM_CMD_SET_MODULE_STATIC_TDP_LEVEL, 0,
 				DM_STATUS_SUCCESS);
-		if (!et_circbuffer_push(&cq->cb, cq->cb_mem, (u8 *)&dm_def_rsp,
-					sizeof(dm_def_rsp),
-					ET_CB_SYNC_FOR_HOST |
-						ET_CB_SYNC_FOR_DEVICE))
+		if (!et_lb_rsp_push(cq, (u8 *)&dm_def_rsp,
+				    sizeof(dm_def_rsp), due))
 			rv = -EAGAIN;
 		break;
 
@@ -1736,10 +2153,8 @@ static ssize_t cmd_loopback_handler(struct et_squeue *sq)
 		FILL_RSP_HEADER(dm_tt_rsp, header.tag_id,
 				DM_CMD_GET_MODULE_TEMPERATURE_THRESHOLDS, 0,
 				DM_STATUS_SUCCESS);
-		if (!et_circbuffer_push(&cq->cb, cq->cb_mem, (u8 *)&dm_tt_rsp,
-					sizeof(dm_tt_rsp),
-					ET_CB_SYNC_FOR_HOST |
-						ET_CB_SYNC_FOR_DEVICE))
+		if (!et_lb_rsp_push(cq, (u8 *)&dm_tt_rsp,
+				    sizeof(dm_tt_rsp), due))
 			rv = -EAGAIN;
 		break;
 
@@ -1747,10 +2162,8 @@ static ssize_t cmd_loopback_handler(struct et_squeue *sq)
 		FILL_RSP_HEADER(dm_def_rsp, header.tag_id,
 				DM_CMD_SET_MODULE_TEMPERATURE_THRESHOLDS, 0,
 				DM_STATUS_SUCCESS);
-		if (!et_circbuffer_push(&cq->cb, cq->cb_mem, (u8 *)&dm_def_rsp,
-					sizeof(dm_def_rsp),
-					ET_CB_SYNC_FOR_HOST |
-						ET_CB_SYNC_FOR_DEVICE))
+		if (!et_lb_rsp_push(cq, (u8 *)&dm_def_rsp,
+				    sizeof(dm_def_rsp), due))
 			rv = -EAGAIN;
 		break;
 
@@ -1758,10 +2171,8 @@ static ssize_t cmd_loopback_handler(struct et_squeue *sq)
 		FILL_RSP_HEADER(dm_ct_rsp, header.tag_id,
 				DM_CMD_GET_MODULE_CURRENT_TEMPERATURE, 0,
 				DM_STATUS_SUCCESS);
-		if (!et_circbuffer_push(&cq->cb, cq->cb_mem, (u8 *)&dm_ct_rsp,
-					sizeof(dm_ct_rsp),
-					ET_CB_SYNC_FOR_HOST |
-						ET_CB_SYNC_FOR_DEVICE))
+		if (!et_lb_rsp_push(cq, (u8 *)&dm_ct_rsp,
+				    sizeof(dm_ct_rsp), due))
 			rv = -EAGAIN;
 		break;
 
@@ -1769,10 +2180,8 @@ static ssize_t cmd_loopback_handler(struct et_squeue *sq)
 		FILL_RSP_HEADER(dm_tht_rsp, header.tag_id,
 				DM_CMD_GET_MODULE_RESIDENCY_THROTTLE_STATES, 0,
 				DM_STATUS_SUCCESS);
-		if (!et_circbuffer_push(&cq->cb, cq->cb_mem, (u8 *)&dm_tht_rsp,
-					sizeof(dm_tht_rsp),
-					ET_CB_SYNC_FOR_HOST |
-						ET_CB_SYNC_FOR_DEVICE))
+		if (!et_lb_rsp_push(cq, (u8 *)&dm_tht_rsp,
+				    sizeof(dm_tht_rsp), due))
 			rv = -EAGAIN;
 		break;
 
@@ -1780,20 +2189,16 @@ static ssize_t cmd_loopback_handler(struct et_squeue *sq)
 		FILL_RSP_HEADER(dm_mtt_rsp, header.tag_id,
 				DM_CMD_GET_MODULE_RESIDENCY_POWER_STATES, 0,
 				DM_STATUS_SUCCESS);
-		if (!et_circbuffer_push(&cq->cb, cq->cb_mem, (u8 *)&dm_mtt_rsp,
-					sizeof(dm_mtt_rsp),
-					ET_CB_SYNC_FOR_HOST |
-						ET_CB_SYNC_FOR_DEVICE))
+		if (!et_lb_rsp_push(cq, (u8 *)&dm_mtt_rsp,
+				    sizeof(dm_mtt_rsp), due))
 			rv = -EAGAIN;
 		break;
 
 	case DM_CMD_GET_MODULE_POWER:
 		FILL_RSP_HEADER(dm_mp_rsp, header.tag_id,
 				DM_CMD_GET_MODULE_POWER, 0, DM_STATUS_SUCCESS);
-		if (!et_circbuffer_push(&cq->cb, cq->cb_mem, (u8 *)&dm_mp_rsp,
-					sizeof(dm_mp_rsp),
-					ET_CB_SYNC_FOR_HOST |
-						ET_CB_SYNC_FOR_DEVICE))
+		if (!et_lb_rsp_push(cq, (u8 *)&dm_mp_rsp,
+				    sizeof(dm_mp_rsp), due))
 			rv = -EAGAIN;
 		break;
 
@@ -1801,30 +2206,24 @@ static ssize_t cmd_loopback_handler(struct et_squeue *sq)
 		FILL_RSP_HEADER(dm_mv_rsp, header.tag_id,
 				DM_CMD_GET_MODULE_VOLTAGE, 0,
 				DM_STATUS_SUCCESS);
-		if (!et_circbuffer_push(&cq->cb, cq->cb_mem, (u8 *)&dm_mv_rsp,
-					sizeof(dm_mv_rsp),
-					ET_CB_SYNC_FOR_HOST |
-						ET_CB_SYNC_FOR_DEVICE))
+		if (!et_lb_rsp_push(cq, (u8 *)&dm_mv_rsp,
+				    sizeof(dm_mv_rsp), due))
 			rv = -EAGAIN;
 		break;
 
 	case DM_CMD_GET_ASIC_VOLTAGE:
 		FILL_RSP_HEADER(dm_av_rsp, header.tag_id,
 				DM_CMD_GET_ASIC_VOLTAGE, 0, DM_STATUS_SUCCESS);
-		if (!et_circbuffer_push(&cq->cb, cq->cb_mem, (u8 *)&dm_av_rsp,
-					sizeof(dm_av_rsp),
-					ET_CB_SYNC_FOR_HOST |
-						ET_CB_SYNC_FOR_DEVICE))
+		if (!et_lb_rsp_push(cq, (u8 *)&dm_av_rsp,
+				    sizeof(dm_av_rsp), due))
 			rv = -EAGAIN;
 		break;
 
 	case DM_CMD_GET_MODULE_UPTIME:
 		FILL_RSP_HEADER(dm_mu_rsp, header.tag_id,
 				DM_CMD_GET_MODULE_UPTIME, 0, DM_STATUS_SUCCESS);
-		if (!et_circbuffer_push(&cq->cb, cq->cb_mem, (u8 *)&dm_mu_rsp,
-					sizeof(dm_mu_rsp),
-					ET_CB_SYNC_FOR_HOST |
-						ET_CB_SYNC_FOR_DEVICE))
+		if (!et_lb_rsp_push(cq, (u8 *)&dm_mu_rsp,
+				    sizeof(dm_mu_rsp), due))
 			rv = -EAGAIN;
 		break;
 
@@ -1832,10 +2231,8 @@ static ssize_t cmd_loopback_handler(struct et_squeue *sq)
 		FILL_RSP_HEADER(dm_af_rsp, header.tag_id,
 				DM_CMD_GET_ASIC_FREQUENCIES, 0,
 				DM_STATUS_SUCCESS);
-		if (!et_circbuffer_push(&cq->cb, cq->cb_mem, (u8 *)&dm_af_rsp,
-					sizeof(dm_af_rsp),
-					ET_CB_SYNC_FOR_HOST |
-						ET_CB_SYNC_FOR_DEVICE))
+		if (!et_lb_rsp_push(cq, (u8 *)&dm_af_rsp,
+				    sizeof(dm_af_rsp), due))
 			rv = -EAGAIN;
 		break;
 
@@ -1843,10 +2240,8 @@ static ssize_t cmd_loopback_handler(struct et_squeue *sq)
 		FILL_RSP_HEADER(dm_db_rsp, header.tag_id,
 				DM_CMD_GET_DRAM_BANDWIDTH, 0,
 				DM_STATUS_SUCCESS);
-		if (!et_circbuffer_push(&cq->cb, cq->cb_mem, (u8 *)&dm_db_rsp,
-					sizeof(dm_db_rsp),
-					ET_CB_SYNC_FOR_HOST |
-						ET_CB_SYNC_FOR_DEVICE))
+		if (!et_lb_rsp_push(cq, (u8 *)&dm_db_rsp,
+				    sizeof(dm_db_rsp), due))
 			rv = -EAGAIN;
 		break;
 
@@ -1854,10 +2249,8 @@ static ssize_t cmd_loopback_handler(struct et_squeue *sq)
 		FILL_RSP_HEADER(dm_dc_rsp, header.tag_id,
 				DM_CMD_GET_DRAM_CAPACITY_UTILIZATION, 0,
 				DM_STATUS_SUCCESS);
-		if (!et_circbuffer_push(&cq->cb, cq->cb_mem, (u8 *)&dm_dc_rsp,
-					sizeof(dm_dc_rsp),
-					ET_CB_SYNC_FOR_HOST |
-						ET_CB_SYNC_FOR_DEVICE))
+		if (!et_lb_rsp_push(cq, (u8 *)&dm_dc_rsp,
+				    sizeof(dm_dc_rsp), due))
 			rv = -EAGAIN;
 		break;
 
@@ -1865,10 +2258,8 @@ static ssize_t cmd_loopback_handler(struct et_squeue *sq)
 		FILL_RSP_HEADER(dm_apcu_rsp, header.tag_id,
 				DM_CMD_GET_ASIC_PER_CORE_DATAPATH_UTILIZATION,
 				0, DM_STATUS_SUCCESS);
-		if (!et_circbuffer_push(&cq->cb, cq->cb_mem, (u8 *)&dm_apcu_rsp,
-					sizeof(dm_apcu_rsp),
-					ET_CB_SYNC_FOR_HOST |
-						ET_CB_SYNC_FOR_DEVICE))
+		if (!et_lb_rsp_push(cq, (u8 *)&dm_apcu_rsp,
+				    sizeof(dm_apcu_rsp), due))
 			rv = -EAGAIN;
 		break;
 
@@ -1876,30 +2267,24 @@ static ssize_t cmd_loopback_handler(struct et_squeue *sq)
 		FILL_RSP_HEADER(dm_apcu_rsp, header.tag_id,
 				DM_CMD_GET_ASIC_UTILIZATION, 0,
 				DM_STATUS_SUCCESS);
-		if (!et_circbuffer_push(&cq->cb, cq->cb_mem, (u8 *)&dm_apcu_rsp,
-					sizeof(dm_apcu_rsp),
-					ET_CB_SYNC_FOR_HOST |
-						ET_CB_SYNC_FOR_DEVICE))
+		if (!et_lb_rsp_push(cq, (u8 *)&dm_apcu_rsp,
+				    sizeof(dm_apcu_rsp), due))
 			rv = -EAGAIN;
 		break;
 
 	case DM_CMD_GET_ASIC_STALLS:
 		FILL_RSP_HEADER(dm_as_rsp, header.tag_id,
 				DM_CMD_GET_ASIC_STALLS, 0, DM_STATUS_SUCCESS);
-		if (!et_circbuffer_push(&cq->cb, cq->cb_mem, (u8 *)&dm_as_rsp,
-					sizeof(dm_as_rsp),
-					ET_CB_SYNC_FOR_HOST |
-						ET_CB_SYNC_FOR_DEVICE))
+		if (!et_lb_rsp_push(cq, (u8 *)&dm_as_rsp,
+				    sizeof(dm_as_rsp), due))
 			rv = -EAGAIN;
 		break;
 
 	case DM_CMD_GET_ASIC_LATENCY:
 		FILL_RSP_HEADER(dm_al_rsp, header.tag_id,
 				DM_CMD_GET_ASIC_LATENCY, 0, DM_STATUS_SUCCESS);
-		if (!et_circbuffer_push(&cq->cb, cq->cb_mem, (u8 *)&dm_al_rsp,
-					sizeof(dm_al_rsp),
-					ET_CB_SYNC_FOR_HOST |
-						ET_CB_SYNC_FOR_DEVICE))
+		if (!et_lb_rsp_push(cq, (u8 *)&dm_al_rsp,
+				    sizeof(dm_al_rsp), due))
 			rv = -EAGAIN;
 		break;
 
@@ -1907,20 +2292,16 @@ static ssize_t cmd_loopback_handler(struct et_squeue *sq)
 		FILL_RSP_HEADER(dm_ms_rsp, header.tag_id,
 				DM_CMD_GET_MM_ERROR_COUNT, 0,
 				DM_STATUS_SUCCESS);
-		if (!et_circbuffer_push(&cq->cb, cq->cb_mem, (u8 *)&dm_ms_rsp,
-					sizeof(dm_ms_rsp),
-					ET_CB_SYNC_FOR_HOST |
-						ET_CB_SYNC_FOR_DEVICE))
+		if (!et_lb_rsp_push(cq, (u8 *)&dm_ms_rsp,
+				    sizeof(dm_ms_rsp), due))
 			rv = -EAGAIN;
 		break;
 
 	case DM_CMD_MM_RESET:
 		FILL_RSP_HEADER(dm_ms_rsp, header.tag_id, DM_CMD_MM_RESET, 0,
 				DM_STATUS_SUCCESS);
-		if (!et_circbuffer_push(&cq->cb, cq->cb_mem, (u8 *)&dm_ms_rsp,
-					sizeof(dm_ms_rsp),
-					ET_CB_SYNC_FOR_HOST |
-						ET_CB_SYNC_FOR_DEVICE))
+		if (!et_lb_rsp_push(cq, (u8 *)&dm_ms_rsp,
+				    sizeof(dm_ms_rsp), due))
 			rv = -EAGAIN;
 		break;
 
@@ -1928,10 +2309,8 @@ static ssize_t cmd_loopback_handler(struct et_squeue *sq)
 		FILL_RSP_HEADER(dm_def_rsp, header.tag_id,
 				DM_CMD_GET_DEVICE_ERROR_EVENTS, 0,
 				DM_STATUS_SUCCESS);
-		if (!et_circbuffer_push(&cq->cb, cq->cb_mem, (u8 *)&dm_def_rsp,
-					sizeof(dm_def_rsp),
-					ET_CB_SYNC_FOR_HOST |
-						ET_CB_SYNC_FOR_DEVICE))
+		if (!et_lb_rsp_push(cq, (u8 *)&dm_def_rsp,
+				    sizeof(dm_def_rsp), due))
 			rv = -EAGAIN;
 		break;
 
@@ -1939,10 +2318,8 @@ static ssize_t cmd_loopback_handler(struct et_squeue *sq)
 		FILL_RSP_HEADER(dm_def_rsp, header.tag_id,
 				DM_CMD_SET_DM_TRACE_RUN_CONTROL, 0,
 				DM_STATUS_SUCCESS);
-		if (!et_circbuffer_push(&cq->cb, cq->cb_mem, (u8 *)&dm_def_rsp,
-					sizeof(dm_def_rsp),
-					ET_CB_SYNC_FOR_HOST |
-						ET_CB_SYNC_FOR_DEVICE))
+		if (!et_lb_rsp_push(cq, (u8 *)&dm_def_rsp,
+				    sizeof(dm_def_rsp), due))
 			rv = -EAGAIN;
 		break;
 
@@ -1950,10 +2327,8 @@ static ssize_t cmd_loopback_handler(struct et_squeue *sq)
 		FILL_RSP_HEADER(dm_def_rsp, header.tag_id,
 				DM_CMD_SET_DM_TRACE_CONFIG, 0,
 				DM_STATUS_SUCCESS);
-		if (!et_circbuffer_push(&cq->cb, cq->cb_mem, (u8 *)&dm_def_rsp,
-					sizeof(dm_def_rsp),
-					ET_CB_SYNC_FOR_HOST |
-						ET_CB_SYNC_FOR_DEVICE))
+		if (!et_lb_rsp_push(cq, (u8 *)&dm_def_rsp,
+				    sizeof(dm_def_rsp), due))
 			rv = -EAGAIN;
 		break;
 
@@ -1961,10 +2336,8 @@ static ssize_t cmd_loopback_handler(struct et_squeue *sq)
 		FILL_RSP_HEADER(dm_def_rsp, header.tag_id,
 				DM_CMD_SET_MODULE_VOLTAGE, 0,
 				DM_STATUS_SUCCESS);
-		if (!et_circbuffer_push(&cq->cb, cq->cb_mem, (u8 *)&dm_def_rsp,
-					sizeof(dm_def_rsp),
-					ET_CB_SYNC_FOR_HOST |
-						ET_CB_SYNC_FOR_DEVICE))
+		if (!et_lb_rsp_push(cq, (u8 *)&dm_def_rsp,
+				    sizeof(dm_def_rsp), due))
 			rv = -EAGAIN;
 		break;
 
@@ -1972,26 +2345,22 @@ static ssize_t cmd_loopback_handler(struct et_squeue *sq)
 		FILL_RSP_HEADER(dm_def_rsp, header.tag_id,
 				DM_CMD_SET_THROTTLE_POWER_STATE_TEST, 0,
 				DM_STATUS_SUCCESS);
-		if (!et_circbuffer_push(&cq->cb, cq->cb_mem, (u8 *)&dm_def_rsp,
-					sizeof(dm_def_rsp),
-					ET_CB_SYNC_FOR_HOST |
-						ET_CB_SYNC_FOR_DEVICE))
+		if (!et_lb_rsp_push(cq, (u8 *)&dm_def_rsp,
+				    sizeof(dm_def_rsp), due))
 			rv = -EAGAIN;
 		break;
 
 	case DM_CMD_SET_FREQUENCY:
 		FILL_RSP_HEADER(dm_def_rsp, header.tag_id, DM_CMD_SET_FREQUENCY,
 				0, DM_STATUS_SUCCESS);
-		if (!et_circbuffer_push(&cq->cb, cq->cb_mem, (u8 *)&dm_def_rsp,
-					sizeof(dm_def_rsp),
-					ET_CB_SYNC_FOR_HOST |
-						ET_CB_SYNC_FOR_DEVICE))
+		if (!et_lb_rsp_push(cq, (u8 *)&dm_def_rsp,
+				    sizeof(dm_def_rsp), due))
 			rv = -EAGAIN;
 		break;
 	}
 	mutex_unlock(&cq->pop_mutex);
 
-	loopback_interrupt(sq, cq);
+	loopback_interrupt(sq, cq, !due && !rv);
 
 error_free_cmd_mem:
 	kfree(cmd);
@@ -2044,15 +2413,8 @@ update_sq_bitmap:
 	if (sq->is_hp_sq)
 		return rv;
 
-	// Update sq_bitmap
-	mutex_lock(&sq->vq_common->sq_bitmap_mutex);
-
-	if (et_circbuffer_free(&sq->cb) < atomic_read(&sq->sq_threshold)) {
-		clear_bit(sq->index, sq->vq_common->sq_bitmap);
+	if (!et_squeue_update_avail(sq))
 		wake_up_interruptible(&sq->vq_common->waitqueue);
-	}
-
-	mutex_unlock(&sq->vq_common->sq_bitmap_mutex);
 
 	return rv;
 }
@@ -2094,6 +2456,80 @@ error:
 	return rv;
 }
 
+/**
+ * et_squeue_push_batch() - Push several commands on SQ circular buffer
+ * @sq: Pointer to struct et_squeue
+ * @buf: Memory buffer holding the commands back to back
+ * @count: Number of bytes of the memory buffer
+ *
+ * In loopback mode each command is handled as it's pushed, so this is the same
+ * as pushing the commands one by one.
+ *
+ * Return: Number of commands pushed on success, negative error on failure
+ */
+ssize_t et_squeue_push_batch(struct et_squeue *sq, void *buf, size_t count)
+{
+	struct cmn_header_t *header;
+	size_t offset;
+	ssize_t pushed = 0;
+	ssize_t rv = 0;
+
+	for (offset = 0; offset < count; offset += header->size) {
+		header = (struct cmn_header_t *)((u8 *)buf + offset);
+		if (count - offset < sizeof(*header) ||
+		    header->size < sizeof(*header)) {
+			rv = -EINVAL;
+			break;
+		}
+		rv = et_squeue_push(sq, header, count - offset);
+		if (rv < 0)
+			break;
+		pushed++;
+	}
+
+	if (pushed > 0)
+		return pushed;
+
+	return rv;
+}
+
+ssize_t et_squeue_copy_batch_from_user(struct et_pci_dev *et_dev, bool is_mgmt,
+				       bool is_hp_sq, u16 sq_index,
+				       const char __user *ubuf, size_t count)
+{
+	struct et_vq_data *vq_data;
+	struct et_squeue *sq;
+	u8 *kern_buf;
+	ssize_t rv;
+
+	vq_data = (is_mgmt) ? &et_dev->mgmt.vq_data : &et_dev->ops.vq_data;
+	sq = (is_hp_sq) ? &vq_data->hp_sqs[sq_index] : &vq_data->sqs[sq_index];
+
+	if (!count || count > ETSOC1_PUSH_SQ_BATCH_MAX_SIZE) {
+		pr_err("invalid batch size: %ld", count);
+		return -EINVAL;
+	}
+
+	kern_buf = kzalloc(count, GFP_KERNEL);
+
+	if (!kern_buf)
+		return -ENOMEM;
+
+	rv = copy_from_user(kern_buf, ubuf, count);
+	if (rv) {
+		pr_err("copy_from_user failed\n");
+		rv = -ENOMEM;
+		goto error;
+	}
+
+	rv = et_squeue_push_batch(sq, kern_buf, count);
+
+error:
+	kfree(kern_buf);
+
+	return rv;
+}
+
 void et_squeue_sync_cb_for_host(struct et_squeue *sq)
 {
 	u64 head_local;
@@ -2113,16 +2549,8 @@ void et_squeue_sync_bitmap(struct et_squeue *sq)
 {
 	et_squeue_sync_cb_for_host(sq);
 
-	// Update sq_bitmap
-	mutex_lock(&sq->vq_common->sq_bitmap_mutex);
-
-	if (et_circbuffer_free(&sq->cb) >= atomic_read(&sq->sq_threshold))
-		set_bit(sq->index, sq->vq_common->sq_bitmap);
-	else
-		clear_bit(sq->index, sq->vq_common->sq_bitmap);
+	et_squeue_update_avail(sq);
 	wake_up_interruptible(&sq->vq_common->waitqueue);
-
-	mutex_unlock(&sq->vq_common->sq_bitmap_mutex);
 }
 
 bool et_squeue_empty(struct et_squeue *sq)
@@ -2138,12 +2566,27 @@ bool et_squeue_empty(struct et_squeue *sq)
 	return true;
 }
 
-ssize_t et_cqueue_copy_to_user(struct et_pci_dev *et_dev, bool is_mgmt,
-			       u16 cq_index, char __user *ubuf, size_t count)
+/**
+ * copy_msg_to_user() - Copies the next saved response of the CQ to the user
+ * @et_dev: Pointer to struct et_pci_dev
+ * @is_mgmt: indicates if mgmt or ops device
+ * @cq_index: CQ index
+ * @ubuf: Response memory buffer in user-space
+ * @count: Number of bytes of response memory buffer
+ * @usize: Response size in user-space, written before the response is popped,
+ * NULL if not needed. If set, the response stays queued when it can't be
+ * copied to the user
+ *
+ * Return: Number of bytes used from response memory buffer on success,
+ * negative error on failure
+ */
+static ssize_t copy_msg_to_user(struct et_pci_dev *et_dev, bool is_mgmt,
+				u16 cq_index, char __user *ubuf, size_t count,
+				u16 __user *usize)
 {
 	struct et_vq_data *vq_data;
 	struct et_cqueue *cq;
-	struct et_msg_node *msg = NULL;
+	unsigned int size, copied;
 	ssize_t rv;
 
 	vq_data = is_mgmt ? &et_dev->mgmt.vq_data : &et_dev->ops.vq_data;
@@ -2152,30 +2595,45 @@ ssize_t et_cqueue_copy_to_user(struct et_pci_dev *et_dev, bool is_mgmt,
 	if (!ubuf || !count)
 		return -EINVAL;
 
-	msg = dequeue_msg_node(cq);
-	if (!msg || !(msg->msg)) {
+	mutex_lock(&cq->msg_fifo_mutex);
+
+	if (kfifo_is_empty(&cq->msg_fifo)) {
+		mutex_unlock(&cq->msg_fifo_mutex);
 		// Empty; no message to POP, returning EAGAIN
 		rv = -EAGAIN;
 		goto update_cq_bitmap;
 	}
 
-	if (count < msg->msg_size) {
+	size = kfifo_peek_len(&cq->msg_fifo);
+	if (count < size) {
+		mutex_unlock(&cq->msg_fifo_mutex);
 		pr_err("User buffer not large enough\n");
-		// Enqueue the msg again so the userspace can retry with a larger buffer
-		enqueue_msg_node(cq, msg);
+		// The msg stays queued so the userspace can retry with a larger buffer
 		return -EINVAL;
 	}
 
-	if (copy_to_user(ubuf, msg->msg, msg->msg_size)) {
+	if (usize && put_user((u16)size, usize)) {
+		mutex_unlock(&cq->msg_fifo_mutex);
+		return -EFAULT;
+	}
+
+	if (kfifo_to_user(&cq->msg_fifo, ubuf, size, &copied)) {
 		pr_err("failed to copy to user\n");
+		// kfifo_to_user() leaves the msg queued on failure
+		if (!usize)
+			kfifo_skip(&cq->msg_fifo);
 		rv = -EFAULT;
-		goto free_msg_node;
+	} else {
+		rv = copied;
 	}
 
-	rv = msg->msg_size;
+	mutex_unlock(&cq->msg_fifo_mutex);
 
-free_msg_node:
-	destroy_msg_node(msg);
+	// Pairs with the barrier in push_msg_stage(). The CQ work stops popping
+	// the device CQ when the ring is full, resume it now there is room
+	smp_mb();
+	if (READ_ONCE(cq->msg_stage_size))
+		queue_work(cq->vq_common->cq_workqueue, &cq->isr_work);
 
 update_cq_bitmap:
 	// Update cq_bitmap
@@ -2191,15 +2649,79 @@ update_cq_bitmap:
 	return rv;
 }
 
+ssize_t et_cqueue_copy_to_user(struct et_pci_dev *et_dev, bool is_mgmt,
+			       u16 cq_index, char __user *ubuf, size_t count)
+{
+	return copy_msg_to_user(et_dev, is_mgmt, cq_index, ubuf, count, NULL);
+}
+
+/**
+ * et_cqueue_copy_batch_to_user() - Copies up to count saved responses from the
+ * CQ, to the user
+ * @et_dev: Pointer to struct et_pci_dev
+ * @is_mgmt: indicates if mgmt or ops device
+ * @cq_index: CQ index
+ * @ursps: Array of response descriptors in user-space, the size field of each
+ * popped descriptor is updated with the size of the response copied
+ * @count: Number of descriptors in ursps
+ *
+ * Return: Number of responses copied on success, negative error on failure.
+ * -EAGAIN is returned if there was no response to pop
+ */
+ssize_t et_cqueue_copy_batch_to_user(struct et_pci_dev *et_dev, bool is_mgmt,
+				     u16 cq_index,
+				     struct rsp_desc __user *ursps, u16 count)
+{
+	struct rsp_desc rsp_info;
+	ssize_t rv = 0;
+	u16 i;
+
+	if (!ursps || !count || count > ETSOC1_POP_CQ_BATCH_MAX_COUNT)
+		return -EINVAL;
+
+	for (i = 0; i < count; i++) {
+		if (copy_from_user(&rsp_info, &ursps[i], sizeof(rsp_info))) {
+			rv = -EFAULT;
+			break;
+		}
+
+		// The size is written before the response is popped, so a
+		// response is never lost on a faulting descriptor
+		rv = copy_msg_to_user(et_dev, is_mgmt, cq_index,
+				      (char __user __force *)rsp_info.rsp,
+				      rsp_info.size, &ursps[i].size);
+		if (rv < 0)
+			break;
+	}
+
+	// Report the responses already popped, the error (if any) will be
+	// reported again in the next call
+	if (i > 0)
+		return i;
+
+	return rv;
+}
+
 ssize_t et_cqueue_pop(struct et_cqueue *cq, bool sync_for_host)
 {
 	struct cmn_header_t header;
-	struct et_msg_node *msg_node;
 	struct device_mgmt_event_msg_t mgmt_event;
+	struct device_mgmt_rsp_hdr_t reset_rsp = {};
+	struct et_pci_dev *et_dev;
+	bool overflow;
 	ssize_t rv;
 
 	mutex_lock(&cq->pop_mutex);
 
+	// A response held back by a full ring goes first, to keep the order
+	if (cq->msg_stage_size) {
+		if (!push_msg_stage(cq)) {
+			rv = -ENOSPC;
+			goto error_unlock_mutex;
+		}
+		notify_msg_available(cq);
+	}
+
 	// Read the message header
 	if (!et_circbuffer_pop(&cq->cb, cq->cb_mem, (u8 *)&header,
 			       sizeof(header),
@@ -2249,25 +2771,46 @@ ssize_t et_cqueue_pop(struct et_cqueue *cq, bool sync_for_host)
 	}
 
 	// Message is for user mode. Save it off.
-	msg_node = create_msg_node(header.size + sizeof(header));
-	if (!msg_node) {
-		rv = -ENOMEM;
+	if (header.size + sizeof(header) > cq->vq_common->cq_size) {
+		pr_err("%s: CQ[%d]: invalid size!", __func__, cq->index);
+		rv = -ENOTRECOVERABLE;
 		goto error_unlock_mutex;
 	}
 
-	memcpy(msg_node->msg, (u8 *)&header, sizeof(header));
+	memcpy(cq->msg_stage, (u8 *)&header, sizeof(header));
 
-	// MMIO msg payload into node memory
+	// MMIO msg payload into the staging buffer
 	if (!et_circbuffer_pop(&cq->cb, cq->cb_mem,
-			       (u8 *)msg_node->msg + sizeof(header),
-			       header.size, ET_CB_SYNC_FOR_DEVICE)) {
-		destroy_msg_node(msg_node);
+			       cq->msg_stage + sizeof(header), header.size,
+			       ET_CB_SYNC_FOR_DEVICE)) {
 		rv = -EAGAIN;
 		goto error_unlock_mutex;
 	}
 
+	if (header.msg_id == DEV_MGMT_API_MID_MM_RESET)
+		memcpy(&reset_rsp, cq->msg_stage,
+		       min_t(size_t, sizeof(reset_rsp),
+			     header.size + sizeof(header)));
+
+	WRITE_ONCE(cq->msg_stage_size, header.size + sizeof(header));
+	overflow = !push_msg_stage(cq);
+
 	mutex_unlock(&cq->pop_mutex);
 
+	// Release the user memory mapped for the DMA command, before user-space
+	// can see its response
+	et_dev = pci_get_drvdata(cq->vq_common->pdev);
+	if (cq->vq_common == &et_dev->ops.vq_data.vq_common)
+		et_dma_release_stream_mem(et_dev, header.tag_id);
+
+	if (overflow) {
+		atomic64_inc(
+			&cq->stats.counters[ET_VQ_COUNTER_STATS_OVERFLOW_COUNT]);
+		pr_warn_ratelimited(
+			"%s: CQ[%d]: user message ring full, response held back\n",
+			__func__, cq->index);
+	}
+
 	atomic64_inc(&cq->stats.counters[ET_VQ_COUNTER_STATS_MSG_COUNT]);
 	et_rate_entry_update(1, &cq->stats.rates[ET_VQ_RATE_STATS_MSG_RATE]);
 	atomic64_add(header.size + sizeof(header),
@@ -2277,17 +2820,12 @@ ssize_t et_cqueue_pop(struct et_cqueue *cq, bool sync_for_host)
 
 	// Check for MM reset command and complete post reset steps
 	if (header.msg_id == DEV_MGMT_API_MID_MM_RESET)
-		mm_reset_completion_callback(
-			cq, (struct device_mgmt_rsp_hdr_t *)msg_node->msg);
+		mm_reset_completion_callback(cq, &reset_rsp);
 
-	// Enqueue msg node to user msg_list of CQ
-	enqueue_msg_node(cq, msg_node);
+	if (overflow)
+		return -ENOSPC;
 
-	mutex_lock(&cq->vq_common->cq_bitmap_mutex);
-	set_bit(cq->index, cq->vq_common->cq_bitmap);
-	mutex_unlock(&cq->vq_common->cq_bitmap_mutex);
-
-	wake_up_interruptible(&cq->vq_common->waitqueue);
+	notify_msg_available(cq);
 
 	return header.size;
 
@@ -35,6 +35,28 @@
  *        .. process entry here ..
  *     }
  *
+ * Entries a lock-free encoder did not commit yet (see et-trace/encoder.h)
+ * are skipped.
+ *
+ * Deferred strings (TRACE_TYPE_STRING_DEFERRED) are formatted with
+ * Trace_Format_Deferred_String, given a function reading the strings of
+ * the image which logged them:
+ *
+ *     const char* resolve(uint64_t address, void* user) { ... }
+ *     char str[TRACE_STRING_MAX_SIZE];
+ *     Trace_Format_Deferred_String(
+ *         (const struct trace_string_deferred_t*)entry, resolve, user, str, sizeof(str));
+ *
+ * Buffers of compact records (see et-trace/layout.h) are decoded with
+ * Trace_Decode_Compact instead, which expands each record to its standard
+ * entry in the decoder state. The entry is valid till the next call:
+ *
+ *     struct trace_compact_decoder_t decoder = { 0 };
+ *     const struct trace_entry_header_t* entry;
+ *     while ((entry = Trace_Decode_Compact(trace_buf, &decoder))) {
+ *        .. process entry here ..
+ *     }
+ *
  ***********************************************************************/
 
 #ifndef ET_TRACE_DECODER_H
@@ -44,7 +66,24 @@
 extern "C" {
 #endif
 
-struct trace_buffer_std_header_t;
+#include <stddef.h>
+
+#include "layout.h"
+
+/*
+ * State of Trace_Decode_Compact, zero it before decoding a buffer.
+ */
+struct trace_compact_decoder_t {
+    const uint8_t *next;   /*!< Next record, NULL before the first one */
+    const uint8_t *end;    /*!< End of the valid data of the current (sub-)buffer */
+    uint16_t buf_index;    /*!< Index of the current sub-buffer */
+    uint8_t done;          /*!< Set once the end of the buffer is reached */
+    uint64_t cycle;        /*!< Cycle of the last compact record */
+    const uint8_t *strings[TRACE_COMPACT_STRINGS]; /*!< Strings defined in the (sub-)buffer */
+    uint32_t string_sizes[TRACE_COMPACT_STRINGS];
+    uint64_t entry[(sizeof(struct trace_string_t) + TRACE_STRING_MAX_SIZE) / sizeof(uint64_t)];
+                           /*!< Standard entry of the last compact record */
+};
 
 /***********************************************************************
  *
@@ -105,17 +144,96 @@ const struct trace_entry_header_t *Trace_Decode(const struct trace_buffer_std_he
 const struct trace_entry_header_t *Trace_Decode_Sub(const struct trace_buffer_size_header_t *tb,
                 const struct trace_entry_header_t *prev);
 
-#ifdef ET_TRACE_DECODER_IMPL
+/***********************************************************************
+ *
+ *   FUNCTION
+ *
+ *       Trace_Decode_Compact
+ *
+ *   DESCRIPTION
+ *
+ *       This function decodes a trace buffer of compact records one
+ *       entry at a time, sub-buffers included. Records of standard entries
+ *       are returned in place, the others are expanded to their standard
+ *       entry in the decoder state.
+ *
+ *   INPUTS
+ *
+ *       tb     Pointer to the trace buffer standard header.
+ *       dec    Decoder state, zeroed before the first call.
+ *
+ *   OUTPUTS
+ *
+ *       const struct trace_entry_header_t*  Pointer to the next entry, or
+ *              NULL if the end of the trace buffer has been reached.
+ *              On decoder errors or wrong inputs, the function returns NULL.
+ *
+ ***********************************************************************/
+const struct trace_entry_header_t *Trace_Decode_Compact(const struct trace_buffer_std_header_t *tb,
+                struct trace_compact_decoder_t *dec);
 
-#include "layout.h"
+/*
+ * Returns the NUL terminated string at a device address of the image which
+ * logged a deferred string, or NULL if the address is not in the image.
+ */
+typedef const char *(*trace_string_resolver_t)(uint64_t address, void *user);
 
+/***********************************************************************
+ *
+ *   FUNCTION
+ *
+ *       Trace_Format_Deferred_String
+ *
+ *   DESCRIPTION
+ *
+ *       This function formats a deferred string entry (see Trace_Deferred_String
+ *       in et-trace/encoder.h) like snprintf. The conversions after the
+ *       recorded arguments are written as is, and so is the rest of the
+ *       format after an unknown conversion. %s arguments which can not be
+ *       resolved are written as their address, %n ones are ignored.
+ *
+ *   INPUTS
+ *
+ *       entry    Deferred string entry.
+ *       resolve  Function reading the format string and the %s arguments.
+ *       user     Passed to resolve.
+ *       buf      Output buffer, always NUL terminated if size is not 0.
+ *       size     Size of the output buffer.
+ *
+ *   OUTPUTS
+ *
+ *       size_t   Length of the formatted string, which is truncated if it
+ *                is not lower than size.
+ *
+ ***********************************************************************/
+size_t Trace_Format_Deferred_String(const struct trace_string_deferred_t *entry,
+                trace_string_resolver_t resolve, void *user, char *buf, size_t size);
+
+#ifdef ET_TRACE_DECODER_IMPL
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+
+/*! \fn trace_layout_is_compact
+    \brief Buffers of compact records have a major version of their own.
+*/
+static inline bool trace_layout_is_compact(const struct trace_version_t *buf_version)
+{
+    return buf_version->major == TRACE_COMPACT_VERSION_MAJOR;
+}
 
 static inline bool check_trace_layout_version(const struct trace_version_t *buf_version)
 {
     /* et_traces adhere to semantic versioning. a traces is compatible if:
      * same major and same minor  or
-     * same major and trace_minor < decoder_minor */
+     * same major and trace_minor < decoder_minor
+     * for the standard and the compact layouts alike. */
+    if (trace_layout_is_compact(buf_version))
+        return buf_version->minor <= TRACE_COMPACT_VERSION_MINOR;
+
     bool same_major = buf_version->major == TRACE_VERSION_MAJOR;
     bool backwards_compatible_minor = buf_version->minor <= TRACE_VERSION_MINOR;
 
@@ -162,8 +280,17 @@ static inline const struct trace_entry_header_t *decode_next_valid_sub_buffer(
     return next;
 }
 
-const struct trace_entry_header_t *Trace_Decode(const struct trace_buffer_std_header_t *tb,
-                const struct trace_entry_header_t *prev)
+/*! \fn trace_entry_is_committed
+    \brief Entries a lock-free encoder is still writing are flagged with TRACE_TYPE_UNCOMMITTED.
+*/
+static inline bool trace_entry_is_committed(const struct trace_entry_header_t *entry)
+{
+    return (entry->type & TRACE_TYPE_UNCOMMITTED) == 0;
+}
+
+static inline const struct trace_entry_header_t *decode_next_entry(
+    const struct trace_buffer_std_header_t *tb,
+    const struct trace_entry_header_t *prev)
 {
     if (tb == NULL)
         return NULL;
@@ -174,7 +301,8 @@ const struct trace_entry_header_t *Trace_Decode(const struct trace_buffer_std_he
 
     if (prev == NULL) {
         /* Check if valid trace buffer */
-        if ((tb->magic_header != TRACE_MAGIC_HEADER) || !(check_trace_layout_version(&tb->version)))
+        if ((tb->magic_header != TRACE_MAGIC_HEADER) || !(check_trace_layout_version(&tb->version)) ||
+            trace_layout_is_compact(&tb->version))
         {
             return NULL;
         }
@@ -233,8 +361,21 @@ const struct trace_entry_header_t *Trace_Decode(const struct trace_buffer_std_he
 }
 
 
-const struct trace_entry_header_t *Trace_Decode_Sub(const struct trace_buffer_size_header_t *tb,
+const struct trace_entry_header_t *Trace_Decode(const struct trace_buffer_std_header_t *tb,
                 const struct trace_entry_header_t *prev)
+{
+    const struct trace_entry_header_t *next = decode_next_entry(tb, prev);
+
+    /* Skip the entries which are not committed yet */
+    while ((next != NULL) && !trace_entry_is_committed(next))
+        next = decode_next_entry(tb, next);
+
+    return next;
+}
+
+static inline const struct trace_entry_header_t *decode_next_sub_entry(
+    const struct trace_buffer_size_header_t *tb,
+    const struct trace_entry_header_t *prev)
 {
     if (tb == NULL)
         return NULL;
@@ -263,6 +404,415 @@ const struct trace_entry_header_t *Trace_Decode_Sub(const struct trace_buffer_si
     return next;
 }
 
+const struct trace_entry_header_t *Trace_Decode_Sub(const struct trace_buffer_size_header_t *tb,
+                const struct trace_entry_header_t *prev)
+{
+    const struct trace_entry_header_t *next = decode_next_sub_entry(tb, prev);
+
+    /* Skip the entries which are not committed yet */
+    while ((next != NULL) && !trace_entry_is_committed(next))
+        next = decode_next_sub_entry(tb, next);
+
+    return next;
+}
+
+/*! \fn decode_compact_varint
+    \brief Reads a varint at *p, not going past end. Returns false on truncated data.
+*/
+static inline bool decode_compact_varint(const uint8_t **p, const uint8_t *end, uint64_t *value)
+{
+    *value = 0;
+    for (uint32_t shift = 0; (*p < end) && (shift < 64); shift += 7)
+    {
+        const uint8_t byte = *(*p)++;
+        *value |= (uint64_t)(byte & 0x7FU) << shift;
+        if ((byte & 0x80U) == 0)
+            return true;
+    }
+
+    return false;
+}
+
+/*! \fn decode_compact_open
+    \brief Makes the decoder continue with the data in [begin, end) of a (sub-)buffer.
+*/
+static inline void decode_compact_open(struct trace_compact_decoder_t *dec, const uint8_t *begin,
+    const uint8_t *end)
+{
+    dec->next = begin;
+    dec->end = end;
+    dec->cycle = 0;
+    memset(dec->strings, 0, sizeof(dec->strings));
+    memset(dec->string_sizes, 0, sizeof(dec->string_sizes));
+}
+
+/*! \fn decode_compact_next_buffer
+    \brief Opens the first sub-buffer after the current one which has data. Returns false if none.
+*/
+static inline bool decode_compact_next_buffer(const struct trace_buffer_std_header_t *tb,
+    struct trace_compact_decoder_t *dec)
+{
+    for (size_t i = (dec->buf_index + 1U); i < tb->sub_buffer_count; i++)
+    {
+        const struct trace_buffer_size_header_t *base = (const struct trace_buffer_size_header_t *)
+            ((uint64_t)tb + (uint64_t)(i * tb->sub_buffer_size));
+
+        if ((base->data_size > sizeof(struct trace_buffer_size_header_t)) &&
+            (base->data_size <= tb->sub_buffer_size))
+        {
+            dec->buf_index = (uint16_t)i;
+            decode_compact_open(dec, (const uint8_t *)(base + 1), (const uint8_t *)base + base->data_size);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*! \fn decode_compact_record
+    \brief Expands the compact record at dec->next to the standard entry of the decoder.
+*/
+static inline const struct trace_entry_header_t *decode_compact_record(
+    struct trace_compact_decoder_t *dec)
+{
+    struct trace_entry_header_t *header = (struct trace_entry_header_t *)dec->entry;
+    const uint8_t *p = dec->next;
+    const uint8_t type = *p++;
+    uint64_t delta;
+    uint64_t hart_id = 0;
+    uint64_t tag;
+    uint64_t value;
+
+    if (type == TRACE_COMPACT_STD_ENTRY)
+    {
+        const struct trace_entry_header_t *entry = (const struct trace_entry_header_t *)p;
+
+        if (((size_t)(dec->end - p) < sizeof(*entry)) ||
+            ((size_t)(dec->end - p) - sizeof(*entry) < entry->payload_size))
+            return NULL;
+        dec->next = p + sizeof(*entry) + entry->payload_size;
+        return entry;
+    }
+
+    if (!decode_compact_varint(&p, dec->end, &delta) ||
+        (((type & TRACE_COMPACT_HART_ID) != 0) && !decode_compact_varint(&p, dec->end, &hart_id)))
+        return NULL;
+
+    /* Zigzag decode the delta */
+    dec->cycle += (delta >> 1) ^ (0 - (delta & 1));
+
+    memset(dec->entry, 0, sizeof(struct trace_value_u64_t));
+    header->cycle = dec->cycle;
+    header->hart_id = (uint16_t)hart_id;
+    header->type = (trace_type_e)(type & TRACE_COMPACT_TYPE_MASK);
+
+    switch (header->type)
+    {
+        case TRACE_TYPE_VALUE_U64:
+        case TRACE_TYPE_VALUE_U32:
+        case TRACE_TYPE_VALUE_U16:
+        case TRACE_TYPE_VALUE_U8:
+        {
+            if (!decode_compact_varint(&p, dec->end, &tag) || !decode_compact_varint(&p, dec->end, &value))
+                return NULL;
+            if (header->type == TRACE_TYPE_VALUE_U64)
+            {
+                struct trace_value_u64_t *entry = (struct trace_value_u64_t *)dec->entry;
+                entry->tag = (uint32_t)tag;
+                entry->value = value;
+                header->payload_size = sizeof(*entry) - sizeof(*header);
+            }
+            else if (header->type == TRACE_TYPE_VALUE_U32)
+            {
+                struct trace_value_u32_t *entry = (struct trace_value_u32_t *)dec->entry;
+                entry->tag = (uint32_t)tag;
+                entry->value = (uint32_t)value;
+                header->payload_size = sizeof(*entry) - sizeof(*header);
+            }
+            else if (header->type == TRACE_TYPE_VALUE_U16)
+            {
+                struct trace_value_u16_t *entry = (struct trace_value_u16_t *)dec->entry;
+                entry->tag = (uint32_t)tag;
+                entry->value = (uint16_t)value;
+                header->payload_size = sizeof(*entry) - sizeof(*header);
+            }
+            else
+            {
+                struct trace_value_u8_t *entry = (struct trace_value_u8_t *)dec->entry;
+                entry->tag = (uint32_t)tag;
+                entry->value = (uint8_t)value;
+                header->payload_size = sizeof(*entry) - sizeof(*header);
+            }
+            break;
+        }
+        case TRACE_TYPE_VALUE_FLOAT:
+        {
+            struct trace_value_float_t *entry = (struct trace_value_float_t *)dec->entry;
+            uint32_t bits = 0;
+
+            if (!decode_compact_varint(&p, dec->end, &tag) || ((size_t)(dec->end - p) < sizeof(bits)))
+                return NULL;
+            for (uint32_t i = 0; i < sizeof(bits); i++)
+                bits |= (uint32_t)*p++ << (8 * i);
+            entry->tag = (uint32_t)tag;
+            memcpy(&entry->value, &bits, sizeof(bits));
+            header->payload_size = sizeof(*entry) - sizeof(*header);
+            break;
+        }
+        case TRACE_TYPE_STRING:
+        {
+            struct trace_string_t *entry = (struct trace_string_t *)dec->entry;
+            uint64_t ref;
+            uint64_t size;
+
+            if (!decode_compact_varint(&p, dec->end, &ref) || ((ref >> 1) >= TRACE_COMPACT_STRINGS))
+                return NULL;
+            if ((ref & 1) != 0)
+            {
+                /* Definition of the string ID */
+                if (!decode_compact_varint(&p, dec->end, &size) || ((uint64_t)(dec->end - p) < size))
+                    return NULL;
+                dec->strings[ref >> 1] = p;
+                dec->string_sizes[ref >> 1] = (uint32_t)size;
+                p += size;
+            }
+            else if (dec->strings[ref >> 1] == NULL)
+            {
+                return NULL;
+            }
+
+            size = dec->string_sizes[ref >> 1];
+            if (size >= TRACE_STRING_MAX_SIZE)
+                size = TRACE_STRING_MAX_SIZE - 1;
+            header->payload_size = (uint32_t)TRACE_STRING_SIZE_ALIGN(size + 1);
+            memcpy(entry->string, dec->strings[ref >> 1], size);
+            memset(entry->string + size, 0, header->payload_size - size);
+            break;
+        }
+        case TRACE_TYPE_CMD_STATUS:
+        {
+            struct trace_cmd_status_t *entry = (struct trace_cmd_status_t *)dec->entry;
+            uint64_t mesg_id;
+            uint64_t trans_id;
+
+            if (!decode_compact_varint(&p, dec->end, &mesg_id) || ((dec->end - p) < 2))
+                return NULL;
+            entry->cmd.mesg_id = (uint16_t)mesg_id;
+            entry->cmd.cmd_status = p[0];
+            entry->cmd.queue_slot_id = p[1];
+            p += 2;
+            if (!decode_compact_varint(&p, dec->end, &trans_id))
+                return NULL;
+            entry->cmd.trans_id = (uint16_t)trans_id;
+            header->payload_size = sizeof(*entry) - sizeof(*header);
+            break;
+        }
+        default:
+            return NULL;
+    }
+
+    dec->next = p;
+    return header;
+}
+
+const struct trace_entry_header_t *Trace_Decode_Compact(const struct trace_buffer_std_header_t *tb,
+                struct trace_compact_decoder_t *dec)
+{
+    if ((tb == NULL) || (dec == NULL) || dec->done)
+        return NULL;
+
+    if (dec->next == NULL)
+    {
+        /* Check if valid trace buffer of compact records */
+        if ((tb->magic_header != TRACE_MAGIC_HEADER) || !check_trace_layout_version(&tb->version) ||
+            !trace_layout_is_compact(&tb->version) ||
+            (tb->data_size < sizeof(struct trace_buffer_std_header_t)) ||
+            ((tb->sub_buffer_count > 1) && (tb->data_size > tb->sub_buffer_size)))
+        {
+            dec->done = 1;
+            return NULL;
+        }
+        dec->buf_index = 0;
+        decode_compact_open(dec, (const uint8_t *)(tb + 1), (const uint8_t *)tb + tb->data_size);
+    }
+
+    /* End of current buffer? Get next sub-buffer which has data. */
+    while (dec->next >= dec->end)
+    {
+        if (!decode_compact_next_buffer(tb, dec))
+        {
+            dec->done = 1;
+            return NULL;
+        }
+    }
+
+    const struct trace_entry_header_t *entry = decode_compact_record(dec);
+    if (entry == NULL)
+        dec->done = 1;
+
+    return entry;
+}
+
+/*! \fn format_deferred_append
+    \brief Appends to the output of Trace_Format_Deferred_String, like snprintf.
+*/
+static inline void format_deferred_append(char *buf, size_t size, size_t *len, const char *spec, ...)
+    __attribute__((format(__printf__, 4, 5)));
+
+static inline void format_deferred_append(char *buf, size_t size, size_t *len, const char *spec, ...)
+{
+    va_list va;
+    int n;
+
+    va_start(va, spec);
+    n = (*len < size) ? vsnprintf(buf + *len, size - *len, spec, va) : vsnprintf(NULL, 0, spec, va);
+    va_end(va);
+
+    if (n > 0)
+        *len += (size_t)n;
+}
+
+size_t Trace_Format_Deferred_String(const struct trace_string_deferred_t *entry,
+                trace_string_resolver_t resolve, void *user, char *buf, size_t size)
+{
+    const char *format = resolve(entry->format, user);
+    size_t arg_count = (entry->arg_count < TRACE_STRING_DEFERRED_MAX_ARGS) ?
+                       entry->arg_count : TRACE_STRING_DEFERRED_MAX_ARGS;
+    size_t arg = 0;
+    size_t len = 0;
+
+    if (size > 0)
+        buf[0] = '\0';
+
+    if (format == NULL)
+    {
+        format_deferred_append(buf, size, &len, "<format 0x%llx>", (unsigned long long)entry->format);
+        return len;
+    }
+
+    for (const char *p = format; *p != '\0';)
+    {
+        const char *conversion = p;
+        char spec[32];
+        size_t spec_len = 1;
+        unsigned longs = 0;
+        unsigned shorts = 0;
+        bool valid = true;
+        double value_f;
+
+        if (*p != '%')
+        {
+            const char *next = strchr(p, '%');
+            size_t n = (next != NULL) ? (size_t)(next - p) : strlen(p);
+            format_deferred_append(buf, size, &len, "%.*s", (int)n, p);
+            p += n;
+            continue;
+        }
+
+        /* Rebuild the conversion with the widths taken, and without its length modifiers */
+        spec[0] = '%';
+        for (p++; (*p != '\0') && (strchr("-+ #0123456789.*hlLqjzt", *p) != NULL); p++)
+        {
+            if (*p == '*')
+            {
+                valid = (arg < arg_count) && (spec_len < sizeof(spec) - 24);
+                if (!valid)
+                    break;
+                spec_len += (size_t)snprintf(spec + spec_len, sizeof(spec) - spec_len, "%d",
+                                             (int)entry->args[arg++]);
+            }
+            else if (*p == 'h')
+                shorts++;
+            else if ((*p == 'l') || (*p == 'q') || (*p == 'j') || (*p == 'z') || (*p == 't'))
+                longs++;
+            else if (*p != 'L')
+            {
+                valid = spec_len < sizeof(spec) - 4;
+                if (!valid)
+                    break;
+                spec[spec_len++] = *p;
+            }
+        }
+
+        if (valid && (*p == '%'))
+        {
+            format_deferred_append(buf, size, &len, "%%");
+            p++;
+            continue;
+        }
+
+        valid = valid && (*p != '\0') && (strchr("dicuxXosnpfFeEgGaA", *p) != NULL) &&
+                (arg < arg_count);
+        if (!valid)
+        {
+            format_deferred_append(buf, size, &len, "%s", conversion);
+            break;
+        }
+
+        const uint64_t value = entry->args[arg++];
+        const char type = *p++;
+        switch (type)
+        {
+            case 'c':
+                memcpy(spec + spec_len, "c", 2);
+                format_deferred_append(buf, size, &len, spec, (int)value);
+                break;
+            case 'd':
+            case 'i':
+                memcpy(spec + spec_len, "lld", 4);
+                if (shorts > 1)
+                    format_deferred_append(buf, size, &len, spec, (long long)(signed char)value);
+                else if (shorts == 1)
+                    format_deferred_append(buf, size, &len, spec, (long long)(short)value);
+                else if (longs == 0)
+                    format_deferred_append(buf, size, &len, spec, (long long)(int)value);
+                else
+                    format_deferred_append(buf, size, &len, spec, (long long)value);
+                break;
+            case 'u':
+            case 'x':
+            case 'X':
+            case 'o':
+                spec[spec_len] = 'l';
+                spec[spec_len + 1] = 'l';
+                spec[spec_len + 2] = type;
+                spec[spec_len + 3] = '\0';
+                if (shorts > 1)
+                    format_deferred_append(buf, size, &len, spec, (unsigned long long)(uint8_t)value);
+                else if (shorts == 1)
+                    format_deferred_append(buf, size, &len, spec, (unsigned long long)(uint16_t)value);
+                else if (longs == 0)
+                    format_deferred_append(buf, size, &len, spec, (unsigned long long)(uint32_t)value);
+                else
+                    format_deferred_append(buf, size, &len, spec, (unsigned long long)value);
+                break;
+            case 's':
+            {
+                const char *str = resolve(value, user);
+                memcpy(spec + spec_len, "s", 2);
+                if (str != NULL)
+                    format_deferred_append(buf, size, &len, spec, str);
+                else
+                    format_deferred_append(buf, size, &len, "<0x%llx>", (unsigned long long)value);
+                break;
+            }
+            case 'p':
+                format_deferred_append(buf, size, &len, "0x%llx", (unsigned long long)value);
+                break;
+            case 'n':
+                break;
+            default:
+                spec[spec_len] = type;
+                spec[spec_len + 1] = '\0';
+                memcpy(&value_f, &value, sizeof(value_f));
+                format_deferred_append(buf, size, &len, spec, value_f);
+                break;
+        }
+    }
+
+    return len;
+}
+
 #endif /* ET_TRACE_DECODER_IMPL */
 
 #ifdef __cplusplus
@@ -33,10 +33,13 @@
  *     Trace_String
  *     Trace_Format_String
  *     Trace_Format_String_V
+ *     Trace_Deferred_String
+ *     Trace_Deferred_String_V
  *     Trace_PMC_Counters_Compute
  *     Trace_PMC_Counters_SC
  *     Trace_PMC_Counters_MS
  *     Trace_PMC_Counter
+ *     Trace_PC_Sample
  *     Trace_Value_u64
  *     Trace_Value_u32
  *     Trace_Value_u16
@@ -49,6 +52,7 @@
  *     Trace_Custom_Event
  *     Trace_Event_Copy
  *     Trace_User_Profile_Event
+ *     Trace_Is_Enabled
  * The trace buffer itself is accessed via a control block.
  * This data structure has to be filled with a pointer to the
  * memory buffer that allocates the trace buffer.
@@ -111,6 +115,10 @@
  *     ET_TRACE_BUFFER_LOCK_ACQUIRE       Acquires the lock for a shared trace buffer
  *     ET_TRACE_BUFFER_LOCK_RELEASE       Releases the lock for a shared trace bufer
  *
+ *     // Lock-free reservation (used when ET_TRACE_LOCK_FREE is defined)
+ *     ET_TRACE_ATOMIC_FETCH_ADD_U32(Location, Value)  Adds <value> to <location>, returns the old value
+ *     ET_TRACE_COMMIT_FENCE()            Orders the entry payload writes before its commit
+ *
  *     // Hardware features
  *     ET_TRACE_GET_TIMESTAMP()           Returns current cycle time
  *     ET_TRACE_GET_HART_ID()             Returns ID of executing hart
@@ -122,6 +130,8 @@
  *     ET_TRACE_MESSAGE_HEADER(Entry, Type)
  *       Write information to header of <entry> that contains payload of <type>
  *
+ * A custom ET_TRACE_MESSAGE_HEADER must write the type as ET_TRACE_ENTRY_TYPE(Type).
+ *
  * By default the hart_id is not written to the trace entry header.
  * You can change this behavior by defining `ET_TRACE_WITH_HART_ID`:
  *
@@ -129,6 +139,74 @@
  *     #define ET_TRACE_WITH_HART_ID
  *     #include <et-trace/encoder.h>
  *
+ *
+ * LOCK-FREE RESERVATION
+ *
+ * Defining `ET_TRACE_LOCK_FREE` makes harts sharing a buffer reserve space
+ * with an atomic fetch-add on the buffer offset instead of taking the buffer
+ * lock, which is then never called. Each entry is marked with
+ * TRACE_TYPE_UNCOMMITTED till its payload is written, and the decoder skips
+ * the entries still marked. The reservation crossing the end of the buffer
+ * wraps it, the ones after it wait for the wrap. The reservation crossing the
+ * threshold calls threshold_notify, like the locked mode does. The callback
+ * must not switch base_per_hart, as the reservations read it after reserving.
+ *
+ *
+ * COMPACT RECORDS
+ *
+ * Defining `ET_TRACE_COMPACT` writes the compact records described in
+ * et-trace/layout.h: scalar values, strings and command statuses get a
+ * varint encoding with the cycle relative to the previous record, and
+ * repeated strings are written once per buffer and then referred to by ID.
+ * The other events keep their standard layout. The buffer header must then
+ * carry the TRACE_COMPACT_VERSION_* layout version, and be decoded with
+ * Trace_Decode_Compact. ET_TRACE_COMPACT adds fields to the control block,
+ * so it must be defined in every file using it, and it can not be combined
+ * with ET_TRACE_LOCK_FREE as the records are chained in buffer order.
+ *
+ *
+ * DEFERRED STRINGS
+ *
+ * Trace_Deferred_String records the address of the format string and the
+ * raw arguments (TRACE_TYPE_STRING_DEFERRED) instead of formatting them,
+ * which costs a scan of the format string instead of a vsnprintf and a
+ * ET_TRACE_STRING_MAX_SIZE buffer on the stack. The host formats them,
+ * reading the format string from the image that logged it, so the format
+ * and the %s arguments must be literals of that image. Defining
+ * `ET_TRACE_DEFERRED_FORMAT` makes Trace_Format_String and
+ * Trace_Format_String_V record deferred strings too. The compact layout
+ * has no deferred record, there Trace_Deferred_String formats the string
+ * like Trace_Format_String.
+ *
+ *
+ * GUARDS
+ *
+ * The Trace_* functions check at runtime if trace is enabled, which still
+ * costs a function call per trace point. The TRACE_* macros (TRACE_STRING,
+ * TRACE_VALUE_U32, TRACE_CMD_STATUS ...) take the same arguments, but first
+ * test the enable byte of the control block inline, so a trace point of a
+ * disabled control block is a load and a branch. Their arguments, the
+ * control block included, are not evaluated then. The event and filter
+ * masks are still checked by the functions.
+ *
+ * Classes of trace points can also be removed at compile time, by defining
+ * before including et-trace/encoder.h:
+ *
+ *     ET_TRACE_DISABLE_STRING     TRACE_STRING, TRACE_FORMAT_STRING, TRACE_DEFERRED_STRING
+ *     ET_TRACE_DISABLE_PMC        TRACE_PMC_COUNTERS_*, TRACE_PMC_COUNTER, TRACE_PC_SAMPLE
+ *     ET_TRACE_DISABLE_VALUE      TRACE_VALUE_*
+ *     ET_TRACE_DISABLE_CMD_STATUS TRACE_CMD_STATUS
+ *     ET_TRACE_DISABLE_POWER      TRACE_POWER_STATUS
+ *     ET_TRACE_DISABLE_MEMORY     TRACE_MEMORY, TRACE_EXECUTION_STACK
+ *     ET_TRACE_DISABLE_CUSTOM     TRACE_CUSTOM_EVENT
+ *     ET_TRACE_DISABLE_PROFILE    TRACE_USER_PROFILE_EVENT
+ *     ET_TRACE_STRING_MAX_LEVEL   Highest trace_string_event level kept
+ *
+ * Removed trace points generate no code, their arguments are still type
+ * checked. The enable byte is read with ET_TRACE_READ_ENABLE(Location),
+ * a relaxed atomic load by default, which must be defined the same way in
+ * every file using the macros.
+ *
  ***********************************************************************/
 
 #ifndef ET_TRACE_ENCODER_H
@@ -232,6 +310,11 @@ struct trace_control_block_t {
     uint8_t threshold_notified; /* !< Boolean to check if threshold notification is generated or not */
     uint8_t enable; /*!< Enable/Disable Trace. */
     uint8_t header; /*!< Buffer header type of value trace_header_type_e */
+    uint32_t evict_offset; /*!< Offset up to which ET_TRACE_BUFFER_RESERVED evicted the buffer, if it does */
+#ifdef ET_TRACE_COMPACT
+    uint64_t compact_cycle; /*!< Cycle of the last compact record */
+    uint64_t compact_strings[TRACE_COMPACT_STRINGS]; /*!< Hash of the strings defined in the buffer */
+#endif
 } __attribute__((aligned(64)));
 
 int32_t Trace_Init(const struct trace_init_info_t *init_info, struct trace_control_block_t *cb,
@@ -243,10 +326,15 @@ int32_t Trace_Format_String(trace_string_event_e log_level, struct trace_control
                             const char *format, ...) __attribute__((format(__printf__, 3, 4)));
 int32_t Trace_Format_String_V(trace_string_event_e log_level, struct trace_control_block_t *cb,
                               const char *format, va_list va);
+int32_t Trace_Deferred_String(trace_string_event_e log_level, struct trace_control_block_t *cb,
+                              const char *format, ...) __attribute__((format(__printf__, 3, 4)));
+int32_t Trace_Deferred_String_V(trace_string_event_e log_level, struct trace_control_block_t *cb,
+                                const char *format, va_list va);
 void Trace_PMC_Counters_Compute(struct trace_control_block_t *cb);
 void Trace_PMC_Counters_SC(struct trace_control_block_t *cb);
 void Trace_PMC_Counters_MS(struct trace_control_block_t *cb, uint8_t ms_id);
 void Trace_PMC_Counter(struct trace_control_block_t *cb, pmc_counter_e counter);
+void Trace_PC_Sample(struct trace_control_block_t *cb, uint64_t pc);
 void Trace_Value_u64(struct trace_control_block_t *cb, uint32_t tag, uint64_t value);
 void Trace_Value_u32(struct trace_control_block_t *cb, uint32_t tag, uint32_t value);
 void Trace_Value_u16(struct trace_control_block_t *cb, uint32_t tag, uint16_t value);
@@ -265,6 +353,137 @@ int32_t Trace_Event_Copy(struct trace_control_block_t *cb, struct trace_entry_he
                          void *dst_entry, const uint32_t dst_size);
 void Trace_User_Profile_Event(struct trace_control_block_t *cb, uint16_t regionId, bool start,
                               const char *func, uint32_t line, const char *regionName);
+
+/* Inline guards, see GUARDS. */
+#ifndef ET_TRACE_READ_ENABLE
+#define ET_TRACE_READ_ENABLE(var) __atomic_load_n(&(var), __ATOMIC_RELAXED)
+#endif
+
+#ifndef ET_TRACE_STRING_MAX_LEVEL
+#define ET_TRACE_STRING_MAX_LEVEL TRACE_EVENT_STRING_DEBUG
+#endif
+
+#ifdef ET_TRACE_DISABLE_STRING
+#define ET_TRACE_CLASS_STRING 0
+#else
+#define ET_TRACE_CLASS_STRING 1
+#endif
+
+#ifdef ET_TRACE_DISABLE_PMC
+#define ET_TRACE_CLASS_PMC 0
+#else
+#define ET_TRACE_CLASS_PMC 1
+#endif
+
+#ifdef ET_TRACE_DISABLE_VALUE
+#define ET_TRACE_CLASS_VALUE 0
+#else
+#define ET_TRACE_CLASS_VALUE 1
+#endif
+
+#ifdef ET_TRACE_DISABLE_CMD_STATUS
+#define ET_TRACE_CLASS_CMD_STATUS 0
+#else
+#define ET_TRACE_CLASS_CMD_STATUS 1
+#endif
+
+#ifdef ET_TRACE_DISABLE_POWER
+#define ET_TRACE_CLASS_POWER 0
+#else
+#define ET_TRACE_CLASS_POWER 1
+#endif
+
+#ifdef ET_TRACE_DISABLE_MEMORY
+#define ET_TRACE_CLASS_MEMORY 0
+#else
+#define ET_TRACE_CLASS_MEMORY 1
+#endif
+
+#ifdef ET_TRACE_DISABLE_CUSTOM
+#define ET_TRACE_CLASS_CUSTOM 0
+#else
+#define ET_TRACE_CLASS_CUSTOM 1
+#endif
+
+#ifdef ET_TRACE_DISABLE_PROFILE
+#define ET_TRACE_CLASS_PROFILE 0
+#else
+#define ET_TRACE_CLASS_PROFILE 1
+#endif
+
+/* Check if Trace is enabled for given control block, with a single load. */
+static inline bool Trace_Is_Enabled(const struct trace_control_block_t *cb)
+{
+    return ET_TRACE_READ_ENABLE(cb->enable) == TRACE_ENABLE;
+}
+
+/* Calls func(cb, ...) if the class is compiled in and trace is enabled for cb.
+   Removed classes are compiled as dead code, to keep their arguments type checked. */
+#define ET_TRACE_GUARD(class_enabled, func, cb, ...)                   \
+    do {                                                               \
+        if (class_enabled) {                                           \
+            struct trace_control_block_t *const et_trace_cb_ = (cb);   \
+            if (Trace_Is_Enabled(et_trace_cb_)) {                      \
+                (void)func(et_trace_cb_, __VA_ARGS__);                 \
+            }                                                          \
+        }                                                              \
+    } while (0)
+
+#define ET_TRACE_GUARD_STRING(func, log_level, cb, ...)                                          \
+    do {                                                                                         \
+        if (ET_TRACE_CLASS_STRING && ((log_level) <= ET_TRACE_STRING_MAX_LEVEL)) {               \
+            struct trace_control_block_t *const et_trace_cb_ = (cb);                             \
+            if (Trace_Is_Enabled(et_trace_cb_)) {                                                \
+                (void)func(log_level, et_trace_cb_, __VA_ARGS__);                                \
+            }                                                                                    \
+        }                                                                                        \
+    } while (0)
+
+#define TRACE_STRING(log_level, cb, str) ET_TRACE_GUARD_STRING(Trace_String, log_level, cb, str)
+#define TRACE_FORMAT_STRING(log_level, cb, ...) \
+    ET_TRACE_GUARD_STRING(Trace_Format_String, log_level, cb, __VA_ARGS__)
+#define TRACE_DEFERRED_STRING(log_level, cb, ...) \
+    ET_TRACE_GUARD_STRING(Trace_Deferred_String, log_level, cb, __VA_ARGS__)
+#define TRACE_PMC_COUNTERS_COMPUTE(cb)                                                     \
+    do {                                                                                   \
+        if (ET_TRACE_CLASS_PMC) {                                                          \
+            struct trace_control_block_t *const et_trace_cb_ = (cb);                       \
+            if (Trace_Is_Enabled(et_trace_cb_)) {                                          \
+                Trace_PMC_Counters_Compute(et_trace_cb_);                                  \
+            }                                                                              \
+        }                                                                                  \
+    } while (0)
+#define TRACE_PMC_COUNTERS_SC(cb)                                                          \
+    do {                                                                                   \
+        if (ET_TRACE_CLASS_PMC) {                                                          \
+            struct trace_control_block_t *const et_trace_cb_ = (cb);                       \
+            if (Trace_Is_Enabled(et_trace_cb_)) {                                          \
+                Trace_PMC_Counters_SC(et_trace_cb_);                                       \
+            }                                                                              \
+        }                                                                                  \
+    } while (0)
+#define TRACE_PMC_COUNTERS_MS(cb, ms_id) ET_TRACE_GUARD(ET_TRACE_CLASS_PMC, Trace_PMC_Counters_MS, cb, ms_id)
+#define TRACE_PMC_COUNTER(cb, counter) ET_TRACE_GUARD(ET_TRACE_CLASS_PMC, Trace_PMC_Counter, cb, counter)
+#define TRACE_PC_SAMPLE(cb, pc) ET_TRACE_GUARD(ET_TRACE_CLASS_PMC, Trace_PC_Sample, cb, pc)
+#define TRACE_VALUE_U64(cb, tag, value) ET_TRACE_GUARD(ET_TRACE_CLASS_VALUE, Trace_Value_u64, cb, tag, value)
+#define TRACE_VALUE_U32(cb, tag, value) ET_TRACE_GUARD(ET_TRACE_CLASS_VALUE, Trace_Value_u32, cb, tag, value)
+#define TRACE_VALUE_U16(cb, tag, value) ET_TRACE_GUARD(ET_TRACE_CLASS_VALUE, Trace_Value_u16, cb, tag, value)
+#define TRACE_VALUE_U8(cb, tag, value) ET_TRACE_GUARD(ET_TRACE_CLASS_VALUE, Trace_Value_u8, cb, tag, value)
+#define TRACE_VALUE_FLOAT(cb, tag, value) \
+    ET_TRACE_GUARD(ET_TRACE_CLASS_VALUE, Trace_Value_float, cb, tag, value)
+#define TRACE_MEMORY(cb, src, size) ET_TRACE_GUARD(ET_TRACE_CLASS_MEMORY, Trace_Memory, cb, src, size)
+#define TRACE_CMD_STATUS(cb, cmd_data) \
+    ET_TRACE_GUARD(ET_TRACE_CLASS_CMD_STATUS, Trace_Cmd_Status, cb, cmd_data)
+#define TRACE_POWER_STATUS(cb, power_data) \
+    ET_TRACE_GUARD(ET_TRACE_CLASS_POWER, Trace_Power_Status, cb, power_data)
+#define TRACE_EXECUTION_STACK(cb, regs) \
+    ET_TRACE_GUARD(ET_TRACE_CLASS_MEMORY, Trace_Execution_Stack, cb, regs)
+#define TRACE_CUSTOM_EVENT(cb, custom_type, payload, payload_size) \
+    ET_TRACE_GUARD(ET_TRACE_CLASS_CUSTOM, Trace_Custom_Event, cb, custom_type, payload, payload_size)
+#define TRACE_USER_PROFILE_EVENT(cb, regionId, start, func, line, regionName)                  \
+    ET_TRACE_GUARD(ET_TRACE_CLASS_PROFILE, Trace_User_Profile_Event, cb, regionId, start, func, \
+                   line, regionName)
+
 #ifdef ET_TRACE_ENCODER_IMPL
 
 #include <stdio.h>
@@ -319,6 +538,35 @@ void Trace_User_Profile_Event(struct trace_control_block_t *cb, uint16_t regionI
 #define ET_TRACE_WRITE_MEM(dest, src, size) memcpy(dest, src, size)
 #endif
 
+/* Called with each reserved entry, once the control block is updated. Encoders writing to
+   cacheable memory can use it to evict the buffer lines as they are completed */
+#ifndef ET_TRACE_BUFFER_RESERVED
+#define ET_TRACE_BUFFER_RESERVED(cb, head, size)
+#endif
+
+#ifndef ET_TRACE_ATOMIC_FETCH_ADD_U32
+#define ET_TRACE_ATOMIC_FETCH_ADD_U32(var, val) __atomic_fetch_add(&(var), val, __ATOMIC_RELAXED)
+#endif
+
+#ifndef ET_TRACE_COMMIT_FENCE
+#define ET_TRACE_COMMIT_FENCE() __atomic_thread_fence(__ATOMIC_RELEASE)
+#endif
+
+/* Entries are written uncommitted in lock-free mode, trace_entry_commit() clears the flag */
+#ifdef ET_TRACE_LOCK_FREE
+#define ET_TRACE_ENTRY_TYPE(id) ((trace_type_e)((id) | TRACE_TYPE_UNCOMMITTED))
+#else
+#define ET_TRACE_ENTRY_TYPE(id) (id)
+#endif
+
+#if defined(ET_TRACE_COMPACT) && defined(ET_TRACE_LOCK_FREE)
+#error "ET_TRACE_COMPACT can not be used with ET_TRACE_LOCK_FREE"
+#endif
+
+#if defined(ET_TRACE_COMPACT) && defined(ET_TRACE_DEFERRED_FORMAT)
+#error "ET_TRACE_COMPACT can not be used with ET_TRACE_DEFERRED_FORMAT"
+#endif
+
 #ifndef ET_TRACE_STRLEN
 #define ET_TRACE_STRLEN(str) strlen(str)
 #endif
@@ -361,7 +609,7 @@ void Trace_User_Profile_Event(struct trace_control_block_t *cb, uint16_t regionI
         ET_TRACE_WRITE_U64(msg->header.cycle, ET_TRACE_GET_TIMESTAMP()); \
         ET_TRACE_WRITE_U32(msg->header.payload_size, size);              \
         ET_TRACE_WRITE_HART_ID(msg);                                     \
-        ET_TRACE_WRITE_U16(msg->header.type, id);                        \
+        ET_TRACE_WRITE_U16(msg->header.type, ET_TRACE_ENTRY_TYPE(id));   \
     }
 #endif
 
@@ -506,6 +754,381 @@ inline static bool trace_check_buffer_threshold(const struct trace_control_block
     }
 }
 
+#ifdef ET_TRACE_COMPACT
+/*
+ * String of a compact string record, see trace_compact_string().
+ */
+struct trace_compact_string_t {
+    const char *str; /*!< Characters, not NULL terminated */
+    uint32_t size;   /*!< Number of characters */
+    uint32_t id;     /*!< String ID, the hash slot */
+    uint64_t hash;   /*!< FNV-1a hash of the characters, never 0 */
+    bool define;     /*!< Set by trace_compact_reserve() if the record must define the ID */
+};
+
+/* Number of bytes of value encoded as varint */
+inline static uint32_t trace_varint_size(uint64_t value)
+{
+    uint32_t size = 1;
+
+    while (value >= 0x80U) {
+        value >>= 7;
+        size++;
+    }
+
+    return size;
+}
+
+/* Writes value as varint to dst, returns the byte after it */
+inline static uint8_t *trace_varint_write(uint8_t *dst, uint64_t value)
+{
+    while (value >= 0x80U) {
+        ET_TRACE_WRITE_U8(*dst, (uint8_t)(value | 0x80U));
+        value >>= 7;
+        dst++;
+    }
+    ET_TRACE_WRITE_U8(*dst, (uint8_t)value);
+
+    return dst + 1;
+}
+
+/* Zigzag encoding of a cycle delta, the cycles of different harts may not be in order */
+inline static uint64_t trace_compact_delta(uint64_t cycle, uint64_t prev_cycle)
+{
+    int64_t delta = (int64_t)(cycle - prev_cycle);
+
+    return ((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63);
+}
+
+/* Starts a new chain of compact records, at the beginning of the buffer */
+inline static void trace_compact_reset(struct trace_control_block_t *cb)
+{
+    ET_TRACE_WRITE_U64(cb->compact_cycle, 0);
+    for (uint32_t i = 0; i < TRACE_COMPACT_STRINGS; i++) {
+        ET_TRACE_WRITE_U64(cb->compact_strings[i], 0);
+    }
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       trace_compact_record_size
+*
+*   DESCRIPTION
+*
+*       This function computes the size of a compact record logged at
+*       the given cycle, after the last record of the control block.
+*       For strings it decides whether the record defines the string ID.
+*
+*   INPUTS
+*
+*       trace_control_block_t   Trace control block.
+*       uint64_t                Cycle of the record.
+*       uint32_t                Size of the payload (not including the string).
+*       trace_compact_string_t  String of the record, or NULL.
+*
+*   OUTPUTS
+*
+*       uint32_t                Size of the record.
+*
+***********************************************************************/
+inline static uint32_t trace_compact_record_size(const struct trace_control_block_t *cb,
+                                                 uint64_t cycle, uint32_t payload_size,
+                                                 struct trace_compact_string_t *str)
+{
+    uint32_t size = 1 + trace_varint_size(trace_compact_delta(cycle, ET_TRACE_READ_U64(cb->compact_cycle)));
+
+#ifdef ET_TRACE_GET_HART_ID
+    size += trace_varint_size((uint64_t)ET_TRACE_GET_HART_ID());
+#endif
+
+    if (str != NULL) {
+        str->define = (ET_TRACE_READ_U64(cb->compact_strings[str->id]) != str->hash);
+        size += trace_varint_size(((uint64_t)str->id << 1) | str->define);
+        if (str->define) {
+            size += trace_varint_size(str->size) + str->size;
+        }
+    }
+
+    return size + payload_size;
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       trace_compact_reserve
+*
+*   DESCRIPTION
+*
+*       This function reserves a compact record and writes its type,
+*       cycle delta and hart ID. Like trace_buffer_reserve() it notifies
+*       the Host at the threshold and resets the buffer once full. The
+*       cycle is sampled under the lock, so that the buffer order is the
+*       order of the chain of deltas.
+*
+*   INPUTS
+*
+*       trace_control_block_t   Trace control block.
+*       trace_type_e            Type of the record.
+*       uint32_t                Size of the payload (not including the string).
+*       trace_compact_string_t  String of the record, or NULL.
+*
+*   OUTPUTS
+*
+*       uint8_t*                Pointer to the payload of the record.
+*
+***********************************************************************/
+static inline uint8_t *trace_compact_reserve(struct trace_control_block_t *cb, trace_type_e type,
+                                             uint32_t payload_size,
+                                             struct trace_compact_string_t *str)
+{
+    uint8_t *head;
+    void (*lock_acquire)(void) = NULL;
+    void (*lock_release)(void) = NULL;
+    const uint32_t header_size = trace_get_header_size(cb);
+    uint32_t current_offset;
+    uint32_t size;
+    uint64_t cycle;
+    uint64_t delta;
+    bool generate_notification = false;
+
+    /* Load function ptr for buffer lock acquire */
+    lock_acquire = (void (*)(void))(uintptr_t)ET_TRACE_READ_U64_PTR(cb->buffer_lock_acquire);
+
+    /* Acquire the lock and load release lock function ptr if lock acquire function is defined */
+    if (lock_acquire != NULL) {
+        lock_release = (void (*)(void))(uintptr_t)ET_TRACE_READ_U64_PTR(cb->buffer_lock_release);
+        lock_acquire();
+    }
+
+    /* Read the current offset value of trace buffer */
+    current_offset = ET_TRACE_READ_U32(cb->offset_per_hart);
+
+    /* The buffer was initialized, or switched by the threshold notification */
+    if (current_offset == header_size) {
+        trace_compact_reset(cb);
+    }
+
+    cycle = ET_TRACE_GET_TIMESTAMP();
+    size = trace_compact_record_size(cb, cycle, payload_size, str);
+
+    /* Same threshold and full buffer handling as trace_buffer_reserve() */
+    if (trace_check_buffer_threshold(cb, size, current_offset)) {
+        if (!ET_TRACE_READ_U8(cb->threshold_notified)) {
+            ET_TRACE_WRITE_U8(cb->threshold_notified, 1);
+            generate_notification = true;
+        }
+
+        if (trace_check_buffer_full(cb, size, current_offset)) {
+            current_offset = header_size;
+            ET_TRACE_WRITE_U8(cb->threshold_notified, 0);
+            trace_compact_reset(cb);
+            size = trace_compact_record_size(cb, cycle, payload_size, str);
+        }
+    }
+
+    /* Update offset and the chain. */
+    ET_TRACE_WRITE_U32(cb->offset_per_hart, current_offset + size);
+    delta = trace_compact_delta(cycle, ET_TRACE_READ_U64(cb->compact_cycle));
+    ET_TRACE_WRITE_U64(cb->compact_cycle, cycle);
+    if ((str != NULL) && str->define) {
+        ET_TRACE_WRITE_U64(cb->compact_strings[str->id], str->hash);
+    }
+
+    head = (uint8_t *)(ET_TRACE_READ_U64(cb->base_per_hart) + current_offset);
+
+    /* Release the lock */
+    if (lock_release != NULL) {
+        lock_release();
+    }
+
+    /* Generate the notification after releasing the lock */
+    if (generate_notification) {
+        void (*threshold_notify)(struct trace_control_block_t *cb) =
+            (void (*)(struct trace_control_block_t *cb))(uintptr_t)ET_TRACE_READ_U64_PTR(cb->threshold_notify);
+
+        if (threshold_notify != NULL) {
+            threshold_notify(cb);
+        }
+    }
+
+    ET_TRACE_BUFFER_RESERVED(cb, head, size);
+
+#ifdef ET_TRACE_GET_HART_ID
+    ET_TRACE_WRITE_U8(*head, (uint8_t)(type | TRACE_COMPACT_HART_ID));
+    return trace_varint_write(trace_varint_write(head + 1, delta), (uint64_t)ET_TRACE_GET_HART_ID());
+#else
+    ET_TRACE_WRITE_U8(*head, (uint8_t)type);
+    return trace_varint_write(head + 1, delta);
+#endif
+}
+
+/* Logs a scalar value as compact record */
+inline static void trace_compact_value(struct trace_control_block_t *cb, trace_type_e type,
+                                       uint32_t tag, uint64_t value)
+{
+    uint8_t *payload = trace_compact_reserve(
+        cb, type, trace_varint_size(tag) + trace_varint_size(value), NULL);
+
+    trace_varint_write(trace_varint_write(payload, tag), value);
+}
+
+/* Logs a float value as compact record */
+inline static void trace_compact_float(struct trace_control_block_t *cb, uint32_t tag, float value)
+{
+    uint32_t bits;
+    uint8_t *payload = trace_compact_reserve(
+        cb, TRACE_TYPE_VALUE_FLOAT, trace_varint_size(tag) + sizeof(bits), NULL);
+
+    memcpy(&bits, &value, sizeof(bits));
+    payload = trace_varint_write(payload, tag);
+    for (uint32_t i = 0; i < sizeof(bits); i++) {
+        ET_TRACE_WRITE_U8(payload[i], (uint8_t)(bits >> (8 * i)));
+    }
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       trace_compact_string
+*
+*   DESCRIPTION
+*
+*       This function logs a string as compact record. The string ID is
+*       the slot of its hash: if the string is the last one defined with
+*       that ID in the buffer, only the ID is logged.
+*
+*   INPUTS
+*
+*       trace_control_block_t   Trace control block.
+*       const char              String to log.
+*       uint32_t                Number of characters to log.
+*
+*   OUTPUTS
+*
+*       None
+*
+***********************************************************************/
+inline static void trace_compact_string(struct trace_control_block_t *cb, const char *str,
+                                        uint32_t size)
+{
+    struct trace_compact_string_t string = { .str = str, .size = size };
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    uint8_t *payload;
+
+    for (uint32_t i = 0; i < size; i++) {
+        hash = (hash ^ (uint8_t)str[i]) * 0x100000001B3ULL;
+    }
+    string.hash = (hash != 0) ? hash : 1;
+    string.id = (uint32_t)(string.hash % TRACE_COMPACT_STRINGS);
+
+    payload = trace_compact_reserve(cb, TRACE_TYPE_STRING, 0, &string);
+    payload = trace_varint_write(payload, ((uint64_t)string.id << 1) | string.define);
+    if (string.define) {
+        payload = trace_varint_write(payload, size);
+        ET_TRACE_WRITE_MEM(payload, str, size);
+    }
+}
+
+/* Logs a command status as compact record */
+inline static void trace_compact_cmd_status(struct trace_control_block_t *cb,
+                                            const struct trace_event_cmd_status_t *cmd_data)
+{
+    uint8_t *payload = trace_compact_reserve(cb, TRACE_TYPE_CMD_STATUS,
+        trace_varint_size(cmd_data->mesg_id) + 2 + trace_varint_size(cmd_data->trans_id), NULL);
+
+    payload = trace_varint_write(payload, cmd_data->mesg_id);
+    ET_TRACE_WRITE_U8(payload[0], cmd_data->cmd_status);
+    ET_TRACE_WRITE_U8(payload[1], cmd_data->queue_slot_id);
+    trace_varint_write(payload + 2, cmd_data->trans_id);
+}
+#endif /* ET_TRACE_COMPACT */
+
+#ifdef ET_TRACE_LOCK_FREE
+/************************************************************************
+*
+*   FUNCTION
+*
+*       trace_buffer_reserve
+*
+*   DESCRIPTION
+*
+*       Lock-free version of the buffer reservation. The space is reserved
+*       with an atomic fetch-add on the buffer offset. The one reservation
+*       crossing the end of the buffer wraps it and takes its first entry,
+*       the reservations after it wait for the wrap and retry. The one
+*       reservation crossing the threshold notifies the Host.
+*       The entry is returned sized and uncommitted, so decoders can skip
+*       it till trace_entry_commit() is called.
+*
+*   INPUTS
+*
+*       trace_control_block_t   Trace control block.
+*       uint64_t                Size of buffer to be reserved.
+*
+*   OUTPUTS
+*
+*       void*                   Pointer to buffer head.
+*
+***********************************************************************/
+static inline void *trace_buffer_reserve(struct trace_control_block_t *cb, uint64_t size)
+{
+    struct trace_entry_header_t *head;
+    const uint32_t buffer_size = ET_TRACE_READ_U32(cb->size_per_hart);
+    const uint32_t threshold = ET_TRACE_READ_U32(cb->threshold);
+    uint32_t current_offset;
+    bool generate_notification = false;
+
+    while (true) {
+        current_offset = ET_TRACE_ATOMIC_FETCH_ADD_U32(cb->offset_per_hart, (uint32_t)size);
+
+        /* Only one reservation can cross the threshold before the buffer wraps */
+        if ((current_offset <= threshold) && ((current_offset + size) > threshold) &&
+            !ET_TRACE_READ_U8(cb->threshold_notified)) {
+            ET_TRACE_WRITE_U8(cb->threshold_notified, 1);
+            generate_notification = true;
+        }
+
+        if (!trace_check_buffer_full(cb, size, current_offset)) {
+            break;
+        } else if (current_offset <= buffer_size) {
+            /* This reservation crossed the end of the buffer: wrap it, taking the first entry.
+               The reservations done since then are dropped by the store and retried. */
+            current_offset = trace_get_header_size(cb);
+            ET_TRACE_WRITE_U8(cb->threshold_notified, 0);
+            ET_TRACE_WRITE_U32(cb->offset_per_hart, (uint32_t)(current_offset + size));
+            break;
+        }
+
+        /* Wait for the reservation crossing the end to wrap the buffer */
+        while (ET_TRACE_READ_U32(cb->offset_per_hart) > buffer_size) {
+        }
+    }
+
+    head = (struct trace_entry_header_t *)(ET_TRACE_READ_U64(cb->base_per_hart) + current_offset);
+
+    /* Size the entry right away so decoders can skip it till it is committed */
+    ET_TRACE_WRITE_U32(head->payload_size,
+                       (uint32_t)(size - sizeof(struct trace_entry_header_t)));
+    ET_TRACE_WRITE_U16(head->type, (trace_type_e)TRACE_TYPE_UNCOMMITTED);
+
+    if (generate_notification) {
+        void (*threshold_notify)(struct trace_control_block_t *cb) =
+            (void (*)(struct trace_control_block_t *cb))(uintptr_t)ET_TRACE_READ_U64_PTR(cb->threshold_notify);
+
+        if (threshold_notify != NULL) {
+            threshold_notify(cb);
+        }
+    }
+
+    ET_TRACE_BUFFER_RESERVED(cb, head, size);
+
+    return head;
+}
+#else
 /************************************************************************
 *
 *   FUNCTION
@@ -548,6 +1171,11 @@ static inline void *trace_buffer_reserve(struct trace_control_block_t *cb, uint6
         lock_acquire();
     }
 
+#ifdef ET_TRACE_COMPACT
+    /* Room for the TRACE_COMPACT_STD_ENTRY type */
+    size += 1;
+#endif
+
     /* Read the current offset value of trace buffer */
     current_offset = ET_TRACE_READ_U32(cb->offset_per_hart);
 
@@ -572,9 +1200,20 @@ static inline void *trace_buffer_reserve(struct trace_control_block_t *cb, uint6
         }
     }
 
+#ifdef ET_TRACE_COMPACT
+    /* A standard entry does not take part in the chain, but it can start the buffer */
+    if (current_offset == trace_get_header_size(cb)) {
+        trace_compact_reset(cb);
+    }
+#endif
+
     /* Update offset. */
     ET_TRACE_WRITE_U32(cb->offset_per_hart, (uint32_t)(current_offset + size));
 
+    /* Update the head pointer to write to. The base is read under the lock, as the threshold
+       notification may switch the buffer once it is released. */
+    head = (void *)(ET_TRACE_READ_U64(cb->base_per_hart) + current_offset);
+
     /* Release the lock */
     if (lock_release != NULL) {
         lock_release();
@@ -590,11 +1229,47 @@ static inline void *trace_buffer_reserve(struct trace_control_block_t *cb, uint6
         }
     }
 
-    /* Update the head pointer to write to */
-    head = (void *)(ET_TRACE_READ_U64(cb->base_per_hart) + current_offset);
+    ET_TRACE_BUFFER_RESERVED(cb, head, size);
+
+#ifdef ET_TRACE_COMPACT
+    ET_TRACE_WRITE_U8(*(uint8_t *)head, TRACE_COMPACT_STD_ENTRY);
+    head = (uint8_t *)head + 1;
+#endif
 
     return head;
 }
+#endif
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       trace_entry_commit
+*
+*   DESCRIPTION
+*
+*       This function commits an entry once its header and payload are
+*       written. It only has something to do in lock-free mode.
+*
+*   INPUTS
+*
+*       trace_entry_header_t    Header of the entry.
+*
+*   OUTPUTS
+*
+*       None
+*
+***********************************************************************/
+static inline void trace_entry_commit(struct trace_entry_header_t *header)
+{
+#ifdef ET_TRACE_LOCK_FREE
+    ET_TRACE_COMMIT_FENCE();
+    ET_TRACE_WRITE_U16(header->type,
+                       (trace_type_e)(ET_TRACE_READ_U16(header->type) & ~TRACE_TYPE_UNCOMMITTED));
+#else
+    (void)header;
+#endif
+}
 
 /************************************************************************
 *
@@ -750,11 +1425,18 @@ int32_t Trace_String(trace_string_event_e log_level, struct trace_control_block_
         str_length = TRACE_STRING_SIZE_ALIGN(ET_TRACE_STRLEN(str) + 1);
         str_length = (str_length < ET_TRACE_STRING_MAX_SIZE) ? str_length: ET_TRACE_STRING_MAX_SIZE;
 
+#ifdef ET_TRACE_COMPACT
+        size_t size = ET_TRACE_STRLEN(str);
+        trace_compact_string(cb, str,
+            (uint32_t)((size < ET_TRACE_STRING_MAX_SIZE) ? size : (ET_TRACE_STRING_MAX_SIZE - 1)));
+#else
         struct trace_string_t *entry =
             (struct trace_string_t *)trace_buffer_reserve(cb, (sizeof(*entry) + str_length));
 
         ET_TRACE_MESSAGE_HEADER(entry, (uint32_t)str_length, TRACE_TYPE_STRING)
         ET_TRACE_WRITE_MEM(entry->string, str, str_length);
+        trace_entry_commit(&entry->header);
+#endif
     }
 
     return str_length;
@@ -787,6 +1469,12 @@ int32_t Trace_Format_String(trace_string_event_e log_level, struct trace_control
 {
     int32_t str_length = 0;
 
+#ifdef ET_TRACE_DEFERRED_FORMAT
+    va_list args;
+    va_start(args, format);
+    str_length = Trace_Deferred_String_V(log_level, cb, format, args);
+    va_end(args);
+#else
     if (trace_is_str_enabled(cb, log_level)) {
         char buff[ET_TRACE_STRING_MAX_SIZE] __attribute__((aligned(8)));
         va_list args;
@@ -795,19 +1483,27 @@ int32_t Trace_Format_String(trace_string_event_e log_level, struct trace_control
         va_end(args);
 
         if (str_length > 0) {
+#ifdef ET_TRACE_COMPACT
+            trace_compact_string(cb, buff, (uint32_t)((str_length < ET_TRACE_STRING_MAX_SIZE) ?
+                                                      str_length : (ET_TRACE_STRING_MAX_SIZE - 1)));
+#endif
             /* Add size of null character, align and check for max size */
             str_length = TRACE_STRING_SIZE_ALIGN(str_length + 1);
             if (str_length > ET_TRACE_STRING_MAX_SIZE) {
                 str_length = ET_TRACE_STRING_MAX_SIZE;
             }
 
+#ifndef ET_TRACE_COMPACT
             struct trace_string_t *entry =
                 (struct trace_string_t *)trace_buffer_reserve(cb, (sizeof(*entry) + str_length));
 
             ET_TRACE_MESSAGE_HEADER(entry, (uint32_t)str_length, TRACE_TYPE_STRING)
             ET_TRACE_WRITE_MEM(entry->string, buff, str_length);
+            trace_entry_commit(&entry->header);
+#endif
         }
     }
+#endif
 
     return str_length;
 }
@@ -840,28 +1536,231 @@ int32_t Trace_Format_String_V(trace_string_event_e log_level, struct trace_contr
 {
     int32_t str_length = 0;
 
+#ifdef ET_TRACE_DEFERRED_FORMAT
+    str_length = Trace_Deferred_String_V(log_level, cb, format, va);
+#else
     if (trace_is_str_enabled(cb, log_level)) {
         char buff[ET_TRACE_STRING_MAX_SIZE] __attribute__((aligned(8)));
         str_length = ET_TRACE_VSNPRINTF(buff, ET_TRACE_STRING_MAX_SIZE, format, va);
 
         if (str_length > 0) {
+#ifdef ET_TRACE_COMPACT
+            trace_compact_string(cb, buff, (uint32_t)((str_length < ET_TRACE_STRING_MAX_SIZE) ?
+                                                      str_length : (ET_TRACE_STRING_MAX_SIZE - 1)));
+#endif
             /* Add size of null character, align and check for max size */
             str_length = TRACE_STRING_SIZE_ALIGN(str_length + 1);
             if (str_length > ET_TRACE_STRING_MAX_SIZE) {
                 str_length = ET_TRACE_STRING_MAX_SIZE;
             }
 
+#ifndef ET_TRACE_COMPACT
             struct trace_string_t *entry =
                 (struct trace_string_t *)trace_buffer_reserve(cb, (sizeof(*entry) + str_length));
 
             ET_TRACE_MESSAGE_HEADER(entry, (uint32_t)str_length, TRACE_TYPE_STRING)
             ET_TRACE_WRITE_MEM(entry->string, buff, str_length);
+            trace_entry_commit(&entry->header);
+#endif
         }
     }
+#endif
 
     return str_length;
 }
 
+/************************************************************************
+*
+*   FUNCTION
+*
+*       trace_deferred_args
+*
+*   DESCRIPTION
+*
+*       This function takes the arguments of the printf conversions of a
+*       format string, up to TRACE_STRING_DEFERRED_MAX_ARGS. Integers are
+*       widened to 64 bits and floating point values are kept as double
+*       bit patterns, so the host can take them back with the format.
+*       The parsing stops at the first unknown conversion, as the type of
+*       its argument (and of the next ones) is not known.
+*
+*   INPUTS
+*
+*       const char                Log message string format.
+*       va_list                   Variable arguments list, consumed.
+*       uint64_t                  Arguments taken.
+*
+*   OUTPUTS
+*
+*       uint8_t                   Number of arguments taken.
+*
+***********************************************************************/
+static inline uint8_t trace_deferred_args(const char *format, va_list *va, uint64_t *args)
+{
+    uint8_t count = 0;
+
+    for (const char *ptr = format; (*ptr != '\0') && (count < TRACE_STRING_DEFERRED_MAX_ARGS); ptr++) {
+        uint8_t longs = 0;
+        bool long_double = false;
+        double value_f;
+
+        if (*ptr != '%') {
+            continue;
+        }
+
+        /* Flags, width, precision and length modifiers, '*' takes an int */
+        for (ptr++; (*ptr != '\0') && (strchr("-+ #0123456789.*hlLqjzt", *ptr) != NULL); ptr++) {
+            if (*ptr == '*') {
+                args[count++] = (uint64_t)(int64_t)va_arg(*va, int);
+                if (count == TRACE_STRING_DEFERRED_MAX_ARGS) {
+                    return count;
+                }
+            } else if ((*ptr == 'l') || (*ptr == 'q') || (*ptr == 'j') || (*ptr == 'z') ||
+                       (*ptr == 't')) {
+                /* Also 64 bits wide on LP64 targets */
+                longs++;
+            } else if (*ptr == 'L') {
+                long_double = true;
+            }
+        }
+
+        switch (*ptr) {
+        case '%':
+            break;
+        case 'd':
+        case 'i':
+            args[count++] = (longs > 0) ? (uint64_t)va_arg(*va, long long) :
+                                          (uint64_t)(int64_t)va_arg(*va, int);
+            break;
+        case 'c':
+            args[count++] = (uint64_t)(int64_t)va_arg(*va, int);
+            break;
+        case 'u':
+        case 'x':
+        case 'X':
+        case 'o':
+            args[count++] = (longs > 0) ? (uint64_t)va_arg(*va, unsigned long long) :
+                                          (uint64_t)va_arg(*va, unsigned int);
+            break;
+        case 's':
+        case 'p':
+        case 'n':
+            args[count++] = (uint64_t)(uintptr_t)va_arg(*va, void *);
+            break;
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+            value_f = long_double ? (double)va_arg(*va, long double) : va_arg(*va, double);
+            memcpy(&args[count++], &value_f, sizeof(value_f));
+            break;
+        default:
+            return count;
+        }
+    }
+
+    return count;
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       Trace_Deferred_String
+*
+*   DESCRIPTION
+*
+*       A function to log Trace string message to be formatted by the
+*       host (see DEFERRED STRINGS).
+*
+*   INPUTS
+*
+*       trace_string_event        Trace String event type.
+*       trace_control_block_t     Trace control block of logging Thread/Hart.
+*       const char                Log message string format, a literal.
+*       ...                       Variable arguments
+*
+*   OUTPUTS
+*
+*       int32_t                   Bytes written or error
+*
+***********************************************************************/
+int32_t Trace_Deferred_String(trace_string_event_e log_level, struct trace_control_block_t *cb,
+                              const char *format, ...)
+{
+    int32_t size;
+    va_list args;
+
+    va_start(args, format);
+    size = Trace_Deferred_String_V(log_level, cb, format, args);
+    va_end(args);
+
+    return size;
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       Trace_Deferred_String_V
+*
+*   DESCRIPTION
+*
+*       A function to log Trace string message to be formatted by the
+*       host (see DEFERRED STRINGS), with variable arguments list.
+*
+*   INPUTS
+*
+*       trace_string_event        Trace String event type.
+*       trace_control_block_t     Trace control block of logging Thread/Hart.
+*       const char                Log message string format, a literal.
+*       va_list                   Variable arguments list.
+*
+*   OUTPUTS
+*
+*       int32_t                   Bytes written or error
+*
+***********************************************************************/
+int32_t Trace_Deferred_String_V(trace_string_event_e log_level, struct trace_control_block_t *cb,
+                                const char *format, va_list va)
+{
+#ifdef ET_TRACE_COMPACT
+    return Trace_Format_String_V(log_level, cb, format, va);
+#else
+    int32_t size = 0;
+
+    if (trace_is_str_enabled(cb, log_level)) {
+        uint64_t args[TRACE_STRING_DEFERRED_MAX_ARGS];
+        uint8_t arg_count;
+        va_list va_args;
+
+        /* Taken from a copy, the va_list can not be passed by address */
+        va_copy(va_args, va);
+        arg_count = trace_deferred_args(format, &va_args, args);
+        va_end(va_args);
+
+        struct trace_string_deferred_t *entry = (struct trace_string_deferred_t *)trace_buffer_reserve(
+            cb, (sizeof(*entry) + (arg_count * sizeof(uint64_t))));
+
+        size = (int32_t)(ET_TRACE_GET_PAYLOAD_SIZE(sizeof(*entry)) + (arg_count * sizeof(uint64_t)));
+        ET_TRACE_MESSAGE_HEADER(entry, (uint32_t)size, TRACE_TYPE_STRING_DEFERRED)
+        ET_TRACE_WRITE_U64(entry->format, (uint64_t)(uintptr_t)format);
+        ET_TRACE_WRITE_U8(entry->log_level, log_level);
+        ET_TRACE_WRITE_U8(entry->arg_count, arg_count);
+        for (uint8_t i = 0; i < arg_count; i++) {
+            ET_TRACE_WRITE_U64(entry->args[i], args[i]);
+        }
+        trace_entry_commit(&entry->header);
+    }
+
+    return size;
+#endif
+}
+
 /************************************************************************
 *
 *   FUNCTION
@@ -886,11 +1785,16 @@ void Trace_Cmd_Status(struct trace_control_block_t *cb,
                       const struct trace_event_cmd_status_t *cmd_data)
 {
     if (trace_is_enabled(cb)) {
+#ifdef ET_TRACE_COMPACT
+        trace_compact_cmd_status(cb, cmd_data);
+#else
         struct trace_cmd_status_t *entry =
             (struct trace_cmd_status_t *)trace_buffer_reserve(cb, sizeof(*entry));
 
         ET_TRACE_MESSAGE_HEADER(entry, (uint32_t)ET_TRACE_GET_PAYLOAD_SIZE(sizeof(*entry)), TRACE_TYPE_CMD_STATUS)
         ET_TRACE_WRITE_U64(entry->cmd.raw_cmd, cmd_data->raw_cmd);
+        trace_entry_commit(&entry->header);
+#endif
     }
 }
 
@@ -925,6 +1829,7 @@ void Trace_Power_Status(struct trace_control_block_t *cb,
                                 TRACE_TYPE_POWER_STATUS)
         ET_TRACE_WRITE_U64(entry->power.raw_bits_64, pwr_data->raw_bits_64);
         ET_TRACE_WRITE_U32(entry->power.raw_bits_32, pwr_data->raw_bits_32);
+        trace_entry_commit(&entry->header);
     }
 }
 
@@ -960,6 +1865,49 @@ void Trace_PMC_Counters_Compute(struct trace_control_block_t *cb)
         ET_TRACE_WRITE_U64(entry->hpmcounter6, ET_TRACE_GET_HPM_COUNTER(PMC_COUNTER_HPMCOUNTER6));
         ET_TRACE_WRITE_U64(entry->hpmcounter7, ET_TRACE_GET_HPM_COUNTER(PMC_COUNTER_HPMCOUNTER7));
         ET_TRACE_WRITE_U64(entry->hpmcounter8, ET_TRACE_GET_HPM_COUNTER(PMC_COUNTER_HPMCOUNTER8));
+        trace_entry_commit(&entry->header);
+    }
+}
+
+/************************************************************************
+*
+*   FUNCTION
+*
+*       Trace_PC_Sample
+*
+*   DESCRIPTION
+*
+*       A function to log a statistical sample of the calling hart: the
+*       given program counter and all its Minion and Neighborhood PMC
+*       counters. It is meant to be called from a trap handler with the
+*       PC the hart was interrupted at (sepc), so it only writes to the
+*       trace buffer of the hart and does not log any string.
+*
+*   INPUTS
+*
+*       trace_control_block_t     Trace control block of logging Thread/Hart.
+*       uint64_t                  Program counter of the sample.
+*
+*   OUTPUTS
+*
+*       None
+*
+***********************************************************************/
+void Trace_PC_Sample(struct trace_control_block_t *cb, uint64_t pc)
+{
+    if (trace_is_enabled(cb)) {
+        struct trace_pc_sample_t *entry =
+            (struct trace_pc_sample_t *)trace_buffer_reserve(cb, sizeof(*entry));
+
+        ET_TRACE_MESSAGE_HEADER(entry, (uint32_t)ET_TRACE_GET_PAYLOAD_SIZE(sizeof(*entry)), TRACE_TYPE_PC_SAMPLE)
+        ET_TRACE_WRITE_U64(entry->pc, pc);
+        ET_TRACE_WRITE_U64(entry->hpmcounter3, ET_TRACE_GET_HPM_COUNTER(PMC_COUNTER_HPMCOUNTER3));
+        ET_TRACE_WRITE_U64(entry->hpmcounter4, ET_TRACE_GET_HPM_COUNTER(PMC_COUNTER_HPMCOUNTER4));
+        ET_TRACE_WRITE_U64(entry->hpmcounter5, ET_TRACE_GET_HPM_COUNTER(PMC_COUNTER_HPMCOUNTER5));
+        ET_TRACE_WRITE_U64(entry->hpmcounter6, ET_TRACE_GET_HPM_COUNTER(PMC_COUNTER_HPMCOUNTER6));
+        ET_TRACE_WRITE_U64(entry->hpmcounter7, ET_TRACE_GET_HPM_COUNTER(PMC_COUNTER_HPMCOUNTER7));
+        ET_TRACE_WRITE_U64(entry->hpmcounter8, ET_TRACE_GET_HPM_COUNTER(PMC_COUNTER_HPMCOUNTER8));
+        trace_entry_commit(&entry->header);
     }
 }
 
@@ -993,6 +1941,7 @@ void Trace_PMC_Counters_SC(struct trace_control_block_t *cb)
             ET_TRACE_GET_SHIRE_CACHE_COUNTER(PMC_COUNTER_SHIRE_CACHE_1 - PMC_COUNTER_SHIRE_CACHE_CYCLE));
         ET_TRACE_WRITE_U64(entry->sc_pmc1,
             ET_TRACE_GET_SHIRE_CACHE_COUNTER(PMC_COUNTER_SHIRE_CACHE_2 - PMC_COUNTER_SHIRE_CACHE_CYCLE));
+        trace_entry_commit(&entry->header);
     }
 }
 
@@ -1027,6 +1976,7 @@ void Trace_PMC_Counters_MS(struct trace_control_block_t *cb, uint8_t ms_id)
         ET_TRACE_WRITE_U64(entry->ms_pmc1,
             ET_TRACE_GET_MSHIRE_COUNTER(2, ms_id));
         ET_TRACE_WRITE_U8(entry->ms_id, ms_id);
+        trace_entry_commit(&entry->header);
     }
 }
 
@@ -1120,6 +2070,7 @@ void Trace_PMC_Counter(struct trace_control_block_t *cb, pmc_counter_e counter)
                 ET_TRACE_WRITE_U64(entry->value, ET_TRACE_GET_HPM_COUNTER(counter));
                 break;
         }
+        trace_entry_commit(&entry->header);
     }
 }
 
@@ -1147,6 +2098,9 @@ void Trace_PMC_Counter(struct trace_control_block_t *cb, pmc_counter_e counter)
 void Trace_Value_u64(struct trace_control_block_t *cb, uint32_t tag, uint64_t value)
 {
     if (trace_is_enabled(cb)) {
+#ifdef ET_TRACE_COMPACT
+        trace_compact_value(cb, TRACE_TYPE_VALUE_U64, tag, value);
+#else
         struct trace_value_u64_t *entry =
             (struct trace_value_u64_t *)trace_buffer_reserve(cb, sizeof(*entry));
 
@@ -1154,6 +2108,8 @@ void Trace_Value_u64(struct trace_control_block_t *cb, uint32_t tag, uint64_t va
 
         ET_TRACE_WRITE_U32(entry->tag, tag);
         ET_TRACE_WRITE_U64(entry->value, value);
+        trace_entry_commit(&entry->header);
+#endif
     }
 }
 
@@ -1181,6 +2137,9 @@ void Trace_Value_u64(struct trace_control_block_t *cb, uint32_t tag, uint64_t va
 void Trace_Value_u32(struct trace_control_block_t *cb, uint32_t tag, uint32_t value)
 {
     if (trace_is_enabled(cb)) {
+#ifdef ET_TRACE_COMPACT
+        trace_compact_value(cb, TRACE_TYPE_VALUE_U32, tag, value);
+#else
         struct trace_value_u32_t *entry =
             (struct trace_value_u32_t *)trace_buffer_reserve(cb, sizeof(*entry));
 
@@ -1188,6 +2147,8 @@ void Trace_Value_u32(struct trace_control_block_t *cb, uint32_t tag, uint32_t va
 
         ET_TRACE_WRITE_U32(entry->tag, tag);
         ET_TRACE_WRITE_U32(entry->value, value);
+        trace_entry_commit(&entry->header);
+#endif
     }
 }
 
@@ -1215,6 +2176,9 @@ void Trace_Value_u32(struct trace_control_block_t *cb, uint32_t tag, uint32_t va
 void Trace_Value_u16(struct trace_control_block_t *cb, uint32_t tag, uint16_t value)
 {
     if (trace_is_enabled(cb)) {
+#ifdef ET_TRACE_COMPACT
+        trace_compact_value(cb, TRACE_TYPE_VALUE_U16, tag, value);
+#else
         struct trace_value_u16_t *entry =
             (struct trace_value_u16_t *)trace_buffer_reserve(cb, sizeof(*entry));
 
@@ -1222,6 +2186,8 @@ void Trace_Value_u16(struct trace_control_block_t *cb, uint32_t tag, uint16_t va
 
         ET_TRACE_WRITE_U32(entry->tag, tag);
         ET_TRACE_WRITE_U16(entry->value, value);
+        trace_entry_commit(&entry->header);
+#endif
     }
 }
 
@@ -1249,6 +2215,9 @@ void Trace_Value_u16(struct trace_control_block_t *cb, uint32_t tag, uint16_t va
 void Trace_Value_u8(struct trace_control_block_t *cb, uint32_t tag, uint8_t value)
 {
     if (trace_is_enabled(cb)) {
+#ifdef ET_TRACE_COMPACT
+        trace_compact_value(cb, TRACE_TYPE_VALUE_U8, tag, value);
+#else
         struct trace_value_u8_t *entry =
             (struct trace_value_u8_t *)trace_buffer_reserve(cb, sizeof(*entry));
 
@@ -1256,6 +2225,8 @@ void Trace_Value_u8(struct trace_control_block_t *cb, uint32_t tag, uint8_t valu
 
         ET_TRACE_WRITE_U32(entry->tag, tag);
         ET_TRACE_WRITE_U8(entry->value, value);
+        trace_entry_commit(&entry->header);
+#endif
     }
 }
 
@@ -1283,6 +2254,9 @@ void Trace_Value_u8(struct trace_control_block_t *cb, uint32_t tag, uint8_t valu
 void Trace_Value_float(struct trace_control_block_t *cb, uint32_t tag, float value)
 {
     if (trace_is_enabled(cb)) {
+#ifdef ET_TRACE_COMPACT
+        trace_compact_float(cb, tag, value);
+#else
         struct trace_value_float_t *entry =
             (struct trace_value_float_t *)trace_buffer_reserve(cb, sizeof(*entry));
 
@@ -1290,6 +2264,8 @@ void Trace_Value_float(struct trace_control_block_t *cb, uint32_t tag, float val
 
         ET_TRACE_WRITE_U32(entry->tag, tag);
         ET_TRACE_WRITE_FLOAT(entry->value, value);
+        trace_entry_commit(&entry->header);
+#endif
     }
 }
 
@@ -1327,6 +2303,7 @@ void *Trace_Memory(struct trace_control_block_t *cb, const uint8_t *src, uint32_
         ET_TRACE_WRITE_U64(entry->src_addr, (uint64_t)(src));
         ET_TRACE_WRITE_U64(entry->size, size);
         ET_TRACE_WRITE_MEM(entry->data, src, size);
+        trace_entry_commit(&entry->header);
     }
 
     return (void*)entry;
@@ -1362,6 +2339,7 @@ void *Trace_Execution_Stack(struct trace_control_block_t *cb,
 
         ET_TRACE_MESSAGE_HEADER(entry, (uint32_t)ET_TRACE_GET_PAYLOAD_SIZE(sizeof(*entry)), TRACE_TYPE_EXCEPTION)
         ET_TRACE_WRITE_MEM(&entry->registers, regs, sizeof(struct dev_context_registers_t));
+        trace_entry_commit(&entry->header);
     }
 
     return (void*)entry;
@@ -1404,6 +2382,7 @@ void *Trace_Custom_Event(struct trace_control_block_t *cb, uint32_t custom_type,
         ET_TRACE_WRITE_U32(entry->custom_type, custom_type);
         ET_TRACE_WRITE_U32(entry->payload_size, payload_size);
         ET_TRACE_WRITE_MEM(entry->payload, payload, payload_size);
+        trace_entry_commit(&entry->header);
     }
 
     return (void*)entry;
@@ -1523,6 +2502,7 @@ void Trace_User_Profile_Event(struct trace_control_block_t *cb, uint16_t regionI
 
         ET_TRACE_WRITE_U64(entry->line_region_status, value);
         ET_TRACE_WRITE_U64(entry->regionName, (uint64_t)regionName);
+        trace_entry_commit(&entry->header);
     }
 }
 #endif /* !ET_TRACE_GET_HART_ID */
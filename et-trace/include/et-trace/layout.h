@@ -43,6 +43,32 @@
  * The format of the payload depends on the type of data allocated.
  *
  *
+ * COMPACT LAYOUT
+ *
+ * Buffers with the TRACE_COMPACT_VERSION_* layout version hold compact
+ * records instead, written by encoders built with ET_TRACE_COMPACT:
+ *
+ *   +------+-------------+------------------+---------+
+ *   | Type | Cycle delta | Hart ID (option) | Payload |
+ *   +------+-------------+------------------+---------+
+ *      u8     varint          varint
+ *
+ * Varints are unsigned LEB128. The cycle delta is zigzag encoded and relative
+ * to the previous compact record of the (sub-)buffer, the first one being
+ * relative to 0. TRACE_COMPACT_HART_ID in the type tells if the hart ID is
+ * present. The payload depends on the type:
+ *  - TRACE_TYPE_VALUE_U8/U16/U32/U64: varint tag, varint value
+ *  - TRACE_TYPE_VALUE_FLOAT: varint tag, little-endian float
+ *  - TRACE_TYPE_STRING: varint (id << 1) | 1, varint length, characters,
+ *    which defines string id, or varint (id << 1) to repeat the string id
+ *    last defined in the (sub-)buffer
+ *  - TRACE_TYPE_CMD_STATUS: varint mesg_id, u8 cmd_status, u8 queue_slot_id,
+ *    varint trans_id
+ * The other events are written as TRACE_COMPACT_STD_ENTRY records, where
+ * the type byte is directly followed by a standard entry (header and
+ * payload) which does not take part in the cycle deltas.
+ *
+ *
  * NOTES
  *
  *  - All data structures here are defined as packed
@@ -69,6 +95,12 @@ extern "C" {
 */
 #define TRACE_STRING_MAX_SIZE 512
 
+/*! \def TRACE_STRING_DEFERRED_MAX_ARGS
+    \brief Max number of arguments recorded by a deferred string message.
+           The conversions after them are printed as is.
+*/
+#define TRACE_STRING_DEFERRED_MAX_ARGS 16
+
 /*! \def TRACE_STRING_SIZE_ALIGN
     \brief Trace string message alignment. This will keep string packet
            cache line (i.e. 8 bytes) aligned.
@@ -95,6 +127,41 @@ extern "C" {
 */
 #define TRACE_VERSION_PATCH 0
 
+/*! \def TRACE_COMPACT_VERSION_MAJOR
+    \brief This is Trace layout version (major) of buffers holding compact records.
+*/
+#define TRACE_COMPACT_VERSION_MAJOR 1
+
+/*! \def TRACE_COMPACT_VERSION_MINOR
+    \brief This is Trace layout version (minor) of buffers holding compact records.
+*/
+#define TRACE_COMPACT_VERSION_MINOR 0
+
+/*! \def TRACE_COMPACT_VERSION_PATCH
+    \brief This is Trace layout version (patch) of buffers holding compact records.
+*/
+#define TRACE_COMPACT_VERSION_PATCH 0
+
+/*! \def TRACE_COMPACT_HART_ID
+    \brief Set in the type of a compact record followed by the hart ID.
+*/
+#define TRACE_COMPACT_HART_ID 0x80U
+
+/*! \def TRACE_COMPACT_TYPE_MASK
+    \brief Trace packet type bits in the type of a compact record.
+*/
+#define TRACE_COMPACT_TYPE_MASK 0x7FU
+
+/*! \def TRACE_COMPACT_STD_ENTRY
+    \brief Type of a compact record holding a standard entry.
+*/
+#define TRACE_COMPACT_STD_ENTRY 0x7FU
+
+/*! \def TRACE_COMPACT_STRINGS
+    \brief Number of string IDs a compact (sub-)buffer can define.
+*/
+#define TRACE_COMPACT_STRINGS 16
+
 /*! \def TRACE_DEV_CONTEXT_GPRS
     \brief Macro that represents the total number of GPRs in device context.
 */
@@ -128,6 +195,12 @@ enum trace_header_type {
 */
 typedef uint16_t trace_type_e;
 
+/*! \def TRACE_TYPE_UNCOMMITTED
+    \brief Set in trace_entry_header_t::type of an entry a lock-free encoder reserved and did not
+        finish writing yet. Decoders skip these entries.
+*/
+#define TRACE_TYPE_UNCOMMITTED 0x8000U
+
 /*! \enum trace_type
     \brief Trace packet types.
 */
@@ -150,6 +223,8 @@ enum trace_type {
     TRACE_TYPE_POWER_STATUS,
     TRACE_TYPE_CUSTOM_EVENT,
     TRACE_TYPE_USER_PROFILE_EVENT,
+    TRACE_TYPE_PC_SAMPLE,
+    TRACE_TYPE_STRING_DEFERRED,
     TRACE_TYPE_END
 };
 
@@ -162,6 +237,7 @@ enum trace_custom_type_sp {
     TRACE_CUSTOM_TYPE_SP_POWER_GLOBALS,
     TRACE_CUSTOM_TYPE_SP_POWER_STATES_GLOBALS,
     TRACE_CUSTOM_TYPE_SP_OP_STATS,
+    TRACE_CUSTOM_TYPE_SP_DM_EVENT,
     TRACE_CUSTOM_TYPE_SP_COUNT,
     TRACE_CUSTOM_TYPE_SP_END = 999
 };
@@ -172,6 +248,7 @@ enum trace_custom_type_sp {
 enum trace_custom_type_mm {
     TRACE_CUSTOM_TYPE_MM_START = 1000,
     TRACE_CUSTOM_TYPE_MM_COMPUTE_RESOURCES,
+    TRACE_CUSTOM_TYPE_MM_UTILIZATION,
     TRACE_CUSTOM_TYPE_MM_COUNT,
     TRACE_CUSTOM_TYPE_MM_END = 1999
 };
@@ -338,6 +415,21 @@ struct trace_pmc_counters_compute_t {
     uint64_t hpmcounter8;
 } __attribute__((packed));
 
+/*! \struct trace_pc_sample_t
+    \brief A Trace packet strucure for a statistical sample: the program counter of the
+    sampled hart and a snapshot of its compute PMC counters, see Trace_PC_Sample.
+*/
+struct trace_pc_sample_t {
+    struct trace_entry_header_t header;
+    uint64_t pc;
+    uint64_t hpmcounter3;
+    uint64_t hpmcounter4;
+    uint64_t hpmcounter5;
+    uint64_t hpmcounter6;
+    uint64_t hpmcounter7;
+    uint64_t hpmcounter8;
+} __attribute__((packed));
+
 /*! \struct trace_pmc_counters_sc_t
     \brief A Trace packet strucure for all shire cache PMC counters.
 */
@@ -433,6 +525,22 @@ struct trace_string_t {
     char string[];
 } __attribute__((packed));
 
+/*! \struct trace_string_deferred_t
+    \brief A Trace packet strucure for a string message formatted by the host: the device
+    address of the format string and the raw arguments, see Trace_Deferred_String.
+    The host reads the format string (and the %s arguments) from the image that was
+    running on the logging hart.
+*/
+struct trace_string_deferred_t {
+    struct trace_entry_header_t header;
+    uint64_t format;    /**< Device address of the printf format string */
+    uint8_t log_level;  /**< One of enum trace_string_event */
+    uint8_t arg_count;  /**< Number of arguments, up to TRACE_STRING_DEFERRED_MAX_ARGS */
+    uint8_t pad[6];
+    uint64_t args[];    /**< Arguments in format order, integers widened to 64 bits (signed ones
+                             sign-extended), floating point ones as double bit patterns */
+} __attribute__((packed));
+
 /*! \struct trace_entry_header_t
     \brief A Trace packet strucure for a memory dump of variable size.
 */
@@ -516,6 +624,33 @@ struct compute_resources_sample
   struct resource_value l2_l3_write_bw;
 } __attribute__((packed, aligned(8)));
 
+/*! \def TRACE_MM_UTILIZATION_SQ_COUNT
+    \brief Max number of submission queues reported in a MM utilization sample.
+*/
+#define TRACE_MM_UTILIZATION_SQ_COUNT 4
+
+/*! \def TRACE_MM_UTILIZATION_DMA_CHANNEL_COUNT
+    \brief Number of DMA channels of each direction reported in a MM utilization sample.
+*/
+#define TRACE_MM_UTILIZATION_DMA_CHANNEL_COUNT 4
+
+/*! \struct mm_utilization_sample
+    \brief MM utilization over the sampling interval which ends at the event timestamp.
+    DMA directions are from host's perspective, all the cycles are device cycles.
+*/
+struct mm_utilization_sample
+{
+  uint64_t interval_cycles;    /**< Cycles covered by the sample */
+  uint64_t busy_shire_mask;    /**< Shires running a kernel at the end of the interval */
+  uint64_t kernel_busy_cycles; /**< Average cycles the kernels executed in the interval */
+  uint32_t sq_count;           /**< Valid entries of the per SQ arrays */
+  uint32_t pad;
+  uint32_t sq_pending_bytes[TRACE_MM_UTILIZATION_SQ_COUNT]; /**< Bytes waiting in each SQ */
+  uint32_t sq_inflight_cmds[TRACE_MM_UTILIZATION_SQ_COUNT]; /**< Commands of each SQ in execution */
+  uint32_t dma_h2d_busy_cycles[TRACE_MM_UTILIZATION_DMA_CHANNEL_COUNT]; /**< Per channel */
+  uint32_t dma_d2h_busy_cycles[TRACE_MM_UTILIZATION_DMA_CHANNEL_COUNT]; /**< Per channel */
+} __attribute__((packed, aligned(8)));
+
 /*! \struct trace_custom_event_t
     \brief A Trace packet strucure for logging a custom event in trace buffer.
 */
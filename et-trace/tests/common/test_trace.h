@@ -38,9 +38,15 @@ struct trace_buffer_std_header_t *test_trace_create(struct trace_control_block_t
     buf->data_size = sizeof(struct trace_buffer_std_header_t);
     buf->sub_buffer_count = 1;
     buf->sub_buffer_size = (uint32_t)size;
+#ifdef ET_TRACE_COMPACT
+    buf->version.major = TRACE_COMPACT_VERSION_MAJOR;
+    buf->version.minor = TRACE_COMPACT_VERSION_MINOR;
+    buf->version.patch = TRACE_COMPACT_VERSION_PATCH;
+#else
     buf->version.major = TRACE_VERSION_MAJOR;
     buf->version.minor = TRACE_VERSION_MINOR;
     buf->version.patch = TRACE_VERSION_PATCH;
+#endif
 #ifdef MASTER_MINION
     buf->type = TRACE_MM_BUFFER;
 #else
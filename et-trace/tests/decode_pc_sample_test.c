@@ -0,0 +1,73 @@
+/*
+ * Test: decode_pc_sample
+ * Fills a trace with n_entries PC samples, as logged from a trap handler.
+ * This trace is then read and decoded, each sample must hold its PC and
+ * the counters at the time of the sample.
+ */
+
+#include <stdlib.h>
+
+#include <et-trace/encoder.h>
+#include <et-trace/decoder.h>
+#include <et-trace/layout.h>
+
+#include "common/mock_etsoc.h"
+#include "common/test_trace.h"
+#include "common/test_macros.h"
+#include "common/user_args.h"
+
+int main(int argc, const char **argv)
+{
+    static const size_t trace_size = 4096;
+    static const uint64_t n_entries = 10;
+    static const uint64_t pc_base = 0x8005000000ULL;
+
+    struct user_args uargs;
+    parse_args(argc, argv, &uargs);
+
+    struct trace_control_block_t cb = { 0 };
+    struct trace_buffer_std_header_t *buf = test_trace_create(&cb, trace_size);
+
+    printf("-- populating trace buffer\n");
+    for (uint64_t i = 0; i < n_entries; ++i) {
+        reg_hpmcounter3 = 1000 * i;
+        reg_hpmcounter4 = 10 * i;
+        reg_hpmcounter8 = i;
+        TRACE_PC_SAMPLE(&cb, pc_base + 4 * i);
+    }
+
+    test_trace_evict(buf, &cb);
+
+    if (uargs.output) {
+        printf("-- writing to '%s'\n", uargs.output);
+        FILE *fp = fopen(uargs.output, "w");
+        if (fp) {
+            fwrite(buf, trace_size, 1, fp);
+            fclose(fp);
+        }
+    }
+
+    printf("-- decoding trace buffer\n");
+    {
+        const struct trace_entry_header_t *entry_header = NULL;
+        const struct trace_pc_sample_t *entry = NULL;
+        uint64_t i = 0;
+        while ((entry_header = Trace_Decode(buf, entry_header))) {
+            const uint64_t pc = pc_base + 4 * i;
+            const uint64_t cycles = 1000 * i;
+            const uint64_t counter4 = 10 * i;
+            CHECK_EQ(entry_header->type, TRACE_TYPE_PC_SAMPLE);
+            CHECK_EQ(entry_header->cycle, cycles);
+            entry = (const struct trace_pc_sample_t *)entry_header;
+            CHECK_EQ(entry->pc, pc);
+            CHECK_EQ(entry->hpmcounter4, counter4);
+            CHECK_EQ(entry->hpmcounter8, i);
+            ++i;
+        }
+        CHECK_EQ(i, n_entries);
+    }
+
+    test_trace_destroy(buf);
+
+    printf("%s: test passed\n", argv[0]);
+}
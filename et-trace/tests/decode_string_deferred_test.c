@@ -0,0 +1,127 @@
+/*
+ * Test: decode_string_deferred
+ * Fills a trace with deferred strings, holding the address of their format
+ * and their raw arguments. This trace is then read and decoded, and each
+ * string is formatted as the host does. Built with ET_TRACE_DEFERRED_FORMAT,
+ * Trace_Format_String must record deferred strings too.
+ */
+
+#include <stdarg.h>
+#include <stdlib.h>
+
+#include <et-trace/encoder.h>
+#include <et-trace/decoder.h>
+#include <et-trace/layout.h>
+
+#include "common/mock_etsoc.h"
+#include "common/test_trace.h"
+#include "common/test_macros.h"
+#include "common/user_args.h"
+
+static const char unresolved[] = "unresolved";
+
+/* The test is its own image, strings are read in place */
+static const char *resolve(uint64_t address, void *user)
+{
+    (void)user;
+    return (address == (uint64_t)(uintptr_t)unresolved) ? NULL : (const char *)(uintptr_t)address;
+}
+
+/* Without format checking, for conversions the compiler rejects */
+static void log_unchecked(struct trace_control_block_t *cb, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    Trace_Deferred_String_V(TRACE_EVENT_STRING_INFO, cb, format, args);
+    va_end(args);
+}
+
+int main(int argc, const char **argv)
+{
+    static const size_t trace_size = 4096;
+    char expected[][64] = {
+        "launch -3 of kernel: 7%",
+        "00abcdef  3.14 z 44 -1 65535",
+        "    42|ab  |0x1234",
+        "1 2 3 4 5 6 7 8 9 10 11 12 13 14 15 16 %d",
+        "<unresolved> done",
+        "%Q after unknown",
+#ifdef ET_TRACE_DEFERRED_FORMAT
+        "formatted 5 by the host",
+#endif
+    };
+    const size_t n_entries = sizeof(expected) / sizeof(expected[0]);
+
+    struct user_args uargs;
+    parse_args(argc, argv, &uargs);
+
+    snprintf(expected[4], sizeof(expected[4]), "<0x%llx> done",
+             (unsigned long long)(uintptr_t)unresolved);
+
+    struct trace_control_block_t cb = { 0 };
+    struct trace_buffer_std_header_t *buf = test_trace_create(&cb, trace_size);
+
+    printf("-- populating trace buffer\n");
+    TRACE_DEFERRED_STRING(TRACE_EVENT_STRING_INFO, &cb, "launch %d of %s: %u%%", -3, "kernel", 7U);
+    TRACE_DEFERRED_STRING(TRACE_EVENT_STRING_INFO, &cb, "%08lx %5.2f %c %hhd %lld %hu", 0xABCDEFUL,
+                          3.14159, 'z', 300, -1LL, 0xFFFFFFFFU);
+    TRACE_DEFERRED_STRING(TRACE_EVENT_STRING_INFO, &cb, "%*d|%-4s|%p", 6, 42, "ab", (void *)0x1234);
+    TRACE_DEFERRED_STRING(TRACE_EVENT_STRING_INFO, &cb,
+                          "%d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d", 1, 2, 3, 4, 5, 6, 7,
+                          8, 9, 10, 11, 12, 13, 14, 15, 16, 17);
+    TRACE_DEFERRED_STRING(TRACE_EVENT_STRING_INFO, &cb, "%s done", unresolved);
+    log_unchecked(&cb, "%Q after unknown", 1);
+    /* Filtered out */
+    cb.filter_mask = TRACE_EVENT_STRING_WARNING;
+    TRACE_DEFERRED_STRING(TRACE_EVENT_STRING_DEBUG, &cb, "filtered %d", 1);
+    cb.filter_mask = TRACE_FILTER_ENABLE_ALL;
+#ifdef ET_TRACE_DEFERRED_FORMAT
+    TRACE_FORMAT_STRING(TRACE_EVENT_STRING_ERROR, &cb, "formatted %d by the host", 5);
+#endif
+
+    test_trace_evict(buf, &cb);
+
+    if (uargs.output) {
+        printf("-- writing to '%s'\n", uargs.output);
+        FILE *fp = fopen(uargs.output, "w");
+        if (fp) {
+            fwrite(buf, trace_size, 1, fp);
+            fclose(fp);
+        }
+    }
+
+    printf("-- decoding trace buffer\n");
+    {
+        const struct trace_entry_header_t *entry_header = NULL;
+        size_t i = 0;
+        while ((entry_header = Trace_Decode(buf, entry_header))) {
+            const struct trace_string_deferred_t *entry =
+                (const struct trace_string_deferred_t *)entry_header;
+            char str[128];
+            CHECK_EQ(entry_header->type, TRACE_TYPE_STRING_DEFERRED);
+            CHECK_EQ(entry_header->payload_size,
+                     (uint32_t)(sizeof(*entry) - sizeof(*entry_header) +
+                                entry->arg_count * sizeof(uint64_t)));
+            CHECK_LT((uint64_t)i, (uint64_t)n_entries);
+            CHECK_EQ((uint64_t)Trace_Format_Deferred_String(entry, resolve, NULL, str, sizeof(str)),
+                     (uint64_t)strlen(expected[i]));
+            CHECK_STREQ(str, expected[i]);
+            ++i;
+        }
+        CHECK_EQ((uint64_t)i, (uint64_t)n_entries);
+    }
+
+    /* Truncated like snprintf */
+    {
+        const struct trace_string_deferred_t *entry =
+            (const struct trace_string_deferred_t *)Trace_Decode(buf, NULL);
+        char str[8];
+        CHECK_EQ((uint64_t)Trace_Format_Deferred_String(entry, resolve, NULL, str, sizeof(str)),
+                 (uint64_t)strlen(expected[0]));
+        CHECK_STREQ(str, "launch ");
+    }
+
+    test_trace_destroy(buf);
+
+    printf("%s: test passed\n", argv[0]);
+}
@@ -0,0 +1,200 @@
+/*
+ * Test: trace_compact_test
+ * Encoder built with ET_TRACE_COMPACT.
+ * Fills a trace with values, strings, command statuses and memory dumps.
+ * This trace is then decoded with Trace_Decode_Compact, and must take less
+ * than half the bytes of the same trace with standard entries.
+ * Then a small trace is wrapped, strings must be defined again after the wrap.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <et-trace/encoder.h>
+#include <et-trace/decoder.h>
+#include <et-trace/layout.h>
+
+#include "common/mock_etsoc.h"
+#include "common/test_trace.h"
+#include "common/test_macros.h"
+#include "common/user_args.h"
+
+static const char launch_str[] = "kernel launched";
+
+static void trace_log_cmd_status(struct trace_control_block_t *cb, uint16_t i)
+{
+    struct trace_event_cmd_status_t cmd_data = {
+        .queue_slot_id = (uint8_t)(i % 4U),
+        .mesg_id = (uint16_t)(i + 500U),
+        .trans_id = i,
+        .cmd_status = CMD_STATUS_SUCCEEDED,
+    };
+    Trace_Cmd_Status(cb, &cmd_data);
+}
+
+int main(int argc, const char **argv)
+{
+    static const size_t trace_size = 64 * 1024;
+    static const uint16_t n_entries = 200;
+    static const uint64_t cycle_step = 13;
+    static const uint8_t memory[16] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16 };
+    char str[64];
+    uint64_t std_bytes = 0;
+
+    struct user_args uargs;
+    parse_args(argc, argv, &uargs);
+
+    struct trace_control_block_t cb = { 0 };
+    struct trace_buffer_std_header_t *buf = test_trace_create(&cb, trace_size);
+
+    reg_hpmcounter3 = 1000;
+    reg_mhartid = 5;
+
+    printf("-- populating trace buffer\n");
+    for (uint16_t i = 0; i < n_entries; ++i) {
+        reg_hpmcounter3 += cycle_step;
+        Trace_Value_u32(&cb, i % 4U, i * 3U);
+        Trace_Value_u8(&cb, 1, (uint8_t)i);
+        Trace_Value_u64(&cb, 2, (1ULL << 40) + i);
+        Trace_Value_float(&cb, 3, (float)i * 0.5f);
+        Trace_String(TRACE_EVENT_STRING_INFO, &cb, launch_str);
+        Trace_Format_String(TRACE_EVENT_STRING_INFO, &cb, "iteration %u", i);
+        trace_log_cmd_status(&cb, i);
+        std_bytes += sizeof(struct trace_value_u32_t) + sizeof(struct trace_value_u8_t) +
+                     sizeof(struct trace_value_u64_t) + sizeof(struct trace_value_float_t) +
+                     sizeof(struct trace_string_t) + TRACE_STRING_SIZE_ALIGN(sizeof(launch_str)) +
+                     sizeof(struct trace_string_t) +
+                     TRACE_STRING_SIZE_ALIGN((size_t)snprintf(str, sizeof(str), "iteration %u", i) + 1) +
+                     sizeof(struct trace_cmd_status_t);
+        if ((i % 50U) == 0) {
+            Trace_Memory(&cb, memory, sizeof(memory));
+            std_bytes += sizeof(struct trace_memory_t) + sizeof(memory);
+        }
+    }
+
+    test_trace_evict(buf, &cb);
+
+    const uint64_t compact_bytes = cb.offset_per_hart - sizeof(struct trace_buffer_std_header_t);
+    printf("-- %lu bytes of compact records, %lu bytes of standard entries\n",
+           (unsigned long)compact_bytes, (unsigned long)std_bytes);
+    CHECK_LE(compact_bytes * 2, std_bytes);
+
+    /* The standard decoder does not take compact buffers */
+    CHECK_EQ((uint64_t)Trace_Decode(buf, NULL), 0);
+
+    printf("-- decoding trace buffer\n");
+    {
+        struct trace_compact_decoder_t decoder = { 0 };
+        const struct trace_entry_header_t *entry;
+
+        for (uint16_t i = 0; i < n_entries; ++i) {
+            const uint64_t cycle = 1000 + cycle_step * (i + 1U);
+            const uint32_t tag = i % 4U;
+            const uint32_t value = i * 3U;
+            const uint64_t big_value = (1ULL << 40) + i;
+            const float float_value = (float)i * 0.5f;
+            const uint16_t mesg_id = (uint16_t)(i + 500U);
+            const uint8_t queue_slot_id = (uint8_t)(i % 4U);
+
+            entry = Trace_Decode_Compact(buf, &decoder);
+            CHECK_EQ(entry->type, TRACE_TYPE_VALUE_U32);
+            CHECK_EQ(entry->cycle, cycle);
+            CHECK_EQ(entry->hart_id, 5);
+            CHECK_EQ(((const struct trace_value_u32_t *)entry)->tag, tag);
+            CHECK_EQ(((const struct trace_value_u32_t *)entry)->value, value);
+
+            entry = Trace_Decode_Compact(buf, &decoder);
+            CHECK_EQ(entry->type, TRACE_TYPE_VALUE_U8);
+            CHECK_EQ(entry->cycle, cycle);
+            CHECK_EQ(((const struct trace_value_u8_t *)entry)->value, (uint8_t)i);
+
+            entry = Trace_Decode_Compact(buf, &decoder);
+            CHECK_EQ(entry->type, TRACE_TYPE_VALUE_U64);
+            CHECK_EQ(((const struct trace_value_u64_t *)entry)->tag, 2);
+            CHECK_EQ(((const struct trace_value_u64_t *)entry)->value, big_value);
+
+            entry = Trace_Decode_Compact(buf, &decoder);
+            CHECK_EQ(entry->type, TRACE_TYPE_VALUE_FLOAT);
+            CHECK_EQ(((const struct trace_value_float_t *)entry)->value, float_value);
+
+            entry = Trace_Decode_Compact(buf, &decoder);
+            CHECK_EQ(entry->type, TRACE_TYPE_STRING);
+            CHECK_EQ(entry->payload_size, TRACE_STRING_SIZE_ALIGN(sizeof(launch_str)));
+            CHECK_STREQ(((const struct trace_string_t *)entry)->string, launch_str);
+
+            entry = Trace_Decode_Compact(buf, &decoder);
+            CHECK_EQ(entry->type, TRACE_TYPE_STRING);
+            snprintf(str, sizeof(str), "iteration %u", i);
+            CHECK_STREQ(((const struct trace_string_t *)entry)->string, str);
+
+            entry = Trace_Decode_Compact(buf, &decoder);
+            CHECK_EQ(entry->type, TRACE_TYPE_CMD_STATUS);
+            CHECK_EQ(entry->cycle, cycle);
+            CHECK_EQ(((const struct trace_cmd_status_t *)entry)->cmd.mesg_id, mesg_id);
+            CHECK_EQ(((const struct trace_cmd_status_t *)entry)->cmd.trans_id, i);
+            CHECK_EQ(((const struct trace_cmd_status_t *)entry)->cmd.queue_slot_id, queue_slot_id);
+            CHECK_EQ(((const struct trace_cmd_status_t *)entry)->cmd.cmd_status,
+                     CMD_STATUS_SUCCEEDED);
+
+            if ((i % 50U) == 0) {
+                entry = Trace_Decode_Compact(buf, &decoder);
+                CHECK_EQ(entry->type, TRACE_TYPE_MEMORY);
+                CHECK_EQ(entry->cycle, cycle);
+                CHECK_EQ(((const struct trace_memory_t *)entry)->size, sizeof(memory));
+                CHECK_EQ(memcmp(((const struct trace_memory_t *)entry)->data, memory,
+                                sizeof(memory)), 0);
+            }
+        }
+        CHECK_EQ((uint64_t)Trace_Decode_Compact(buf, &decoder), 0);
+    }
+
+    if (uargs.output) {
+        printf("-- writing to '%s'\n", uargs.output);
+        FILE *fp = fopen(uargs.output, "w");
+        if (fp) {
+            fwrite(buf, trace_size, 1, fp);
+            fclose(fp);
+        }
+    }
+
+    test_trace_destroy(buf);
+
+    printf("-- wrapping a small trace buffer\n");
+    {
+        static const size_t small_size = 2048;
+        static const uint32_t n_logged = 1000;
+        buf = test_trace_create(&cb, small_size);
+
+        for (uint32_t i = 0; i < n_logged; ++i) {
+            reg_hpmcounter3 += cycle_step;
+            Trace_String(TRACE_EVENT_STRING_INFO, &cb, launch_str);
+            Trace_Value_u32(&cb, 0, i);
+        }
+
+        test_trace_evict(buf, &cb);
+
+        struct trace_compact_decoder_t decoder = { 0 };
+        const struct trace_entry_header_t *entry;
+        const struct trace_entry_header_t *last = NULL;
+        uint32_t n = 0;
+        while ((entry = Trace_Decode_Compact(buf, &decoder))) {
+            if (entry->type == TRACE_TYPE_STRING) {
+                CHECK_STREQ(((const struct trace_string_t *)entry)->string, launch_str);
+            } else {
+                CHECK_EQ(entry->type, TRACE_TYPE_VALUE_U32);
+            }
+            last = entry;
+            ++n;
+        }
+        /* The whole data was decoded, up to the last value */
+        CHECK_EQ((uint64_t)decoder.next, (uint64_t)decoder.end);
+        CHECK_LT(n, 2 * n_logged);
+        CHECK_EQ(last->type, TRACE_TYPE_VALUE_U32);
+        CHECK_EQ(last->cycle, reg_hpmcounter3);
+        CHECK_EQ(((const struct trace_value_u32_t *)last)->value, n_logged - 1);
+
+        test_trace_destroy(buf);
+    }
+
+    printf("%s: test passed\n", argv[0]);
+}
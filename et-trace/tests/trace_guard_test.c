@@ -0,0 +1,99 @@
+/*
+ * Test: trace_guard_test
+ * Built with the PMC trace points removed, and strings above warnings.
+ * Logs values, strings and PMC counters through the TRACE_* guards, with
+ * trace enabled and then disabled. Only the enabled, compiled in trace
+ * points must be in the trace, and the arguments of the other ones must
+ * not be evaluated.
+ */
+
+#include <stdlib.h>
+
+#define ET_TRACE_DISABLE_PMC
+#define ET_TRACE_STRING_MAX_LEVEL TRACE_EVENT_STRING_WARNING
+
+#include <et-trace/encoder.h>
+#include <et-trace/decoder.h>
+#include <et-trace/layout.h>
+
+#include "common/test_trace.h"
+#include "common/test_macros.h"
+#include "common/user_args.h"
+
+static uint32_t n_evaluated = 0;
+
+static struct trace_control_block_t *get_cb(struct trace_control_block_t *cb)
+{
+    ++n_evaluated;
+    return cb;
+}
+
+int main(int argc, const char **argv)
+{
+    static const size_t trace_size = 4096;
+    static const uint32_t test_tag = 0x5AD;
+
+    struct user_args uargs;
+    parse_args(argc, argv, &uargs);
+
+    struct trace_control_block_t cb = { 0 };
+    struct trace_buffer_std_header_t *buf = test_trace_create(&cb, trace_size);
+
+    printf("-- populating trace buffer\n");
+    TRACE_VALUE_U32(get_cb(&cb), test_tag, 1);
+    TRACE_STRING(TRACE_EVENT_STRING_ERROR, get_cb(&cb), "error");
+    TRACE_FORMAT_STRING(TRACE_EVENT_STRING_WARNING, get_cb(&cb), "warning %d", 2);
+    CHECK_EQ(n_evaluated, 3);
+
+    /* Removed at compile time */
+    TRACE_STRING(TRACE_EVENT_STRING_INFO, get_cb(&cb), "info");
+    TRACE_PMC_COUNTER(get_cb(&cb), PMC_COUNTER_HPMCOUNTER4);
+    TRACE_PMC_COUNTERS_COMPUTE(get_cb(&cb));
+    CHECK_EQ(n_evaluated, 3);
+
+    /* Disabled at runtime */
+    cb.enable = TRACE_DISABLE;
+    CHECK_EQ((uint8_t)Trace_Is_Enabled(&cb), 0);
+    TRACE_VALUE_U32(get_cb(&cb), test_tag, (uint32_t)rand());
+    TRACE_STRING(TRACE_EVENT_STRING_ERROR, get_cb(&cb), "disabled");
+    CHECK_EQ(n_evaluated, 5);
+    cb.enable = TRACE_ENABLE;
+    CHECK_EQ((uint8_t)Trace_Is_Enabled(&cb), 1);
+    TRACE_VALUE_U8(&cb, test_tag, 3);
+
+    test_trace_evict(buf, &cb);
+
+    if (uargs.output) {
+        printf("-- writing to '%s'\n", uargs.output);
+        FILE *fp = fopen(uargs.output, "w");
+        if (fp) {
+            fwrite(buf, trace_size, 1, fp);
+            fclose(fp);
+        }
+    }
+
+    printf("-- decoding trace buffer\n");
+    {
+        const struct trace_entry_header_t *entry = Trace_Decode(buf, NULL);
+        CHECK_EQ(entry->type, TRACE_TYPE_VALUE_U32);
+        CHECK_EQ(((const struct trace_value_u32_t *)entry)->value, 1);
+
+        entry = Trace_Decode(buf, entry);
+        CHECK_EQ(entry->type, TRACE_TYPE_STRING);
+        CHECK_STREQ(((const struct trace_string_t *)entry)->string, "error");
+
+        entry = Trace_Decode(buf, entry);
+        CHECK_EQ(entry->type, TRACE_TYPE_STRING);
+        CHECK_STREQ(((const struct trace_string_t *)entry)->string, "warning 2");
+
+        entry = Trace_Decode(buf, entry);
+        CHECK_EQ(entry->type, TRACE_TYPE_VALUE_U8);
+        CHECK_EQ(((const struct trace_value_u8_t *)entry)->value, 3);
+
+        CHECK_EQ((uint64_t)Trace_Decode(buf, entry), 0);
+    }
+
+    test_trace_destroy(buf);
+
+    printf("%s: test passed\n", argv[0]);
+}
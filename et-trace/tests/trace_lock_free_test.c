@@ -0,0 +1,128 @@
+/*
+ * Test: trace_lock_free_test
+ * Encoder built with ET_TRACE_LOCK_FREE.
+ * N_THREADS threads fill a shared trace with u32 values, without a buffer lock.
+ * The trace is then decoded, every value of every thread must be there once.
+ * Then a single thread wraps the buffer, checks the threshold notifications
+ * and that uncommitted entries are skipped by the decoder.
+ */
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <et-trace/encoder.h>
+#include <et-trace/decoder.h>
+#include <et-trace/layout.h>
+
+#include "common/test_trace.h"
+#include "common/test_macros.h"
+#include "common/user_args.h"
+
+#define N_THREADS 4
+#define N_ENTRIES 100
+
+static struct trace_control_block_t cb = { 0 };
+static uint32_t notifications = 0;
+
+static void threshold_notify(const struct trace_control_block_t *control_block)
+{
+    (void)control_block;
+    __atomic_fetch_add(&notifications, 1, __ATOMIC_RELAXED);
+}
+
+static void *producer(void *arg)
+{
+    const uint32_t tag = (uint32_t)(uintptr_t)arg;
+
+    for (uint32_t i = 0; i < N_ENTRIES; ++i) {
+        Trace_Value_u32(&cb, tag, i);
+    }
+
+    return NULL;
+}
+
+int main(int argc, const char **argv)
+{
+    static const size_t trace_size = 4096 * N_THREADS;
+    uint32_t next_value[N_THREADS] = { 0 };
+    pthread_t threads[N_THREADS];
+
+    struct user_args uargs;
+    parse_args(argc, argv, &uargs);
+
+    struct trace_buffer_std_header_t *buf = test_trace_create(&cb, trace_size);
+
+    printf("-- populating trace buffer from %d threads\n", N_THREADS);
+    for (uintptr_t t = 0; t < N_THREADS; ++t) {
+        CHECK_EQ(pthread_create(&threads[t], NULL, producer, (void *)t), 0);
+    }
+    for (uint32_t t = 0; t < N_THREADS; ++t) {
+        CHECK_EQ(pthread_join(threads[t], NULL), 0);
+    }
+
+    test_trace_evict(buf, &cb);
+
+    printf("-- decoding trace buffer\n");
+    {
+        const struct trace_entry_header_t *entry_header = NULL;
+        uint64_t n = 0;
+        while ((entry_header = Trace_Decode(buf, entry_header))) {
+            CHECK_EQ(entry_header->type, TRACE_TYPE_VALUE_U32);
+            const struct trace_value_u32_t *entry = (const struct trace_value_u32_t *)entry_header;
+            CHECK_LT(entry->tag, N_THREADS);
+            /* The entries of a thread keep their order */
+            CHECK_EQ(entry->value, next_value[entry->tag]);
+            ++next_value[entry->tag];
+            ++n;
+        }
+        CHECK_EQ(n, N_THREADS * N_ENTRIES);
+    }
+
+    printf("-- wrapping the trace buffer\n");
+    {
+        const uint32_t entry_size = sizeof(struct trace_value_u32_t);
+        const uint32_t header_size = sizeof(struct trace_buffer_std_header_t);
+        const uint32_t capacity = (uint32_t)(trace_size - header_size) / entry_size;
+
+        struct trace_config_info_t config = { 0 };
+        config.event_mask = TRACE_EVENT_ENABLE_ALL;
+        config.filter_mask = TRACE_FILTER_ENABLE_ALL;
+        config.threshold = (uint32_t)(trace_size / 4 * 3);
+        CHECK_EQ(Trace_Config(&config, &cb), TRACE_STATUS_SUCCESS);
+        cb.threshold_notify = threshold_notify;
+
+        /* Fill what is left, then two entries past the end of the buffer */
+        const uint32_t logged = N_THREADS * N_ENTRIES;
+        for (uint32_t i = logged; i < capacity + 2; ++i) {
+            Trace_Value_u32(&cb, 0, i);
+        }
+        CHECK_EQ(cb.offset_per_hart, header_size + 2 * entry_size);
+        CHECK_EQ(notifications, 1);
+
+        /* Uncommitted entries are skipped */
+        struct trace_entry_header_t *second =
+            (struct trace_entry_header_t *)((uint8_t *)buf + header_size + entry_size);
+        second->type |= TRACE_TYPE_UNCOMMITTED;
+
+        test_trace_evict(buf, &cb);
+
+        const struct trace_entry_header_t *entry_header = Trace_Decode(buf, NULL);
+        CHECK_NE((uint64_t)entry_header, 0);
+        CHECK_EQ(((const struct trace_value_u32_t *)entry_header)->value, capacity);
+        CHECK_EQ((uint64_t)Trace_Decode(buf, entry_header), 0);
+    }
+
+    if (uargs.output) {
+        printf("-- writing to '%s'\n", uargs.output);
+        FILE *fp = fopen(uargs.output, "w");
+        if (fp) {
+            fwrite(buf, trace_size, 1, fp);
+            fclose(fp);
+        }
+    }
+
+    test_trace_destroy(buf);
+
+    printf("%s: test passed\n", argv[0]);
+}
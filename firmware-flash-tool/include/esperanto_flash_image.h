@@ -75,4 +75,34 @@ typedef struct ESPERANTO_FILE_INFO {
 
 static_assert(16 == sizeof(ESPERANATO_FILE_INFO_t), "sizeof(ESPERANATO_FILE_INFO_t) is not 16!");
 
+// A patch turns a base partition into a new partition by replacing the pages of the regions that changed.
+// It is laid out as the header followed by the chunks, each chunk info followed by its chunk_size pages of data.
+// The chunks are sorted by offset and do not overlap. The pages of the partition which are not replaced must match
+// base_partition_crc, the regions the SP rewrites at runtime (priority designator, boot counters, configuration
+// data) are always replaced.
+
+#define ESPERANTO_PATCH_TAG 0x48435450 // "PTCH"
+
+typedef struct ESPERANTO_FLASH_PATCH_HEADER {
+    uint32_t patch_tag;
+    uint32_t patch_header_size;         // size of the patch header (struct ESPERANTO_FLASH_PATCH_HEADER) in bytes
+    uint32_t patch_size;                // size of the whole patch in bytes
+    uint32_t partition_size;            // size of the partition in FLASH_PAGE_SIZE blocks
+    uint32_t base_partition_crc;        // crc32 of the base partition pages which are not replaced
+    uint32_t new_partition_crc;         // crc32 of the whole patched partition
+    uint32_t chunks_count;
+    uint32_t patch_header_checksum;
+} ESPERANTO_FLASH_PATCH_HEADER_t;
+
+static_assert(32 == sizeof(ESPERANTO_FLASH_PATCH_HEADER_t), "sizeof(ESPERANTO_FLASH_PATCH_HEADER_t) is not 32!");
+
+typedef struct ESPERANTO_FLASH_PATCH_CHUNK {
+    ESPERANTO_FLASH_REGION_ID_t region_id; // region of the pages, ESPERANTO_FLASH_REGION_ID_INVALID outside regions
+    uint32_t chunk_offset;              // offset of the pages in the partition in FLASH_PAGE_SIZE blocks
+    uint32_t chunk_size;                // number of FLASH_PAGE_SIZE pages
+    uint32_t chunk_data_crc;            // crc32 of the pages
+} ESPERANTO_FLASH_PATCH_CHUNK_t;
+
+static_assert(16 == sizeof(ESPERANTO_FLASH_PATCH_CHUNK_t), "sizeof(ESPERANTO_FLASH_PATCH_CHUNK_t) is not 16!");
+
 #endif
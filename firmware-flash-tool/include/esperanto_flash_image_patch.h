@@ -0,0 +1,11 @@
+#ifndef __ESPERANTO_FLASH_IMAGE_PATCH_H__
+#define __ESPERANTO_FLASH_IMAGE_PATCH_H__
+
+#include "esperanto_flash_image.h"
+#include "esperanto_flash_tool.h"
+
+int apply_patch_to_partition(uint8_t * partition_data, uint32_t partition_size_in_bytes, const uint8_t * patch_data, uint32_t patch_size);
+int diff_images(const ARGUMENTS_t * arguments);
+int patch_image(const ARGUMENTS_t * arguments);
+
+#endif
@@ -5,6 +5,7 @@
 #include <stdlib.h>
 
 uint32_t crc32_sum(const void *data, size_t size);
+uint32_t crc32_update(uint32_t crc, const void *data, size_t size); // crc32_sum of the data appended to what crc sums
 int load_file(const char * file_path, char ** buffer, size_t * buffer_size);
 int save_image(const char * filename, const uint8_t * image_data, uint32_t image_size);
 void dumphex(const void * data, uint32_t data_size, uint32_t max_line_length);
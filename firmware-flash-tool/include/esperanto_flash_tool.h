@@ -12,7 +12,9 @@ typedef enum ESPERANTO_FLASH_TOOL_COMMAND {
     ESPERANTO_FLASH_TOOL_COMMAND_VIEW,
     ESPERANTO_FLASH_TOOL_COMMAND_EXTRACT_FILE,
     ESPERANTO_FLASH_TOOL_COMMAND_EXTRACT_ALL_FILES,
-    ESPERANTO_FLASH_TOOL_COMMAND_REPLACE
+    ESPERANTO_FLASH_TOOL_COMMAND_REPLACE,
+    ESPERANTO_FLASH_TOOL_COMMAND_DIFF,
+    ESPERANTO_FLASH_TOOL_COMMAND_PATCH
 } ESPERANTO_FLASH_TOOL_COMMAND_t;
 
 typedef enum CREATE_IMAGE_ARGS {
@@ -47,6 +49,21 @@ typedef enum REPLACE_FILE_ARGS {
     REPLACE_FILE_ARGS_BASE_COUNT
 } REPLACE_FILE_ARGS_t;
 
+typedef enum DIFF_IMAGES_ARGS {
+    DIFF_IMAGES_ARGS_COMMAND,
+    DIFF_IMAGES_ARGS_BASE_IMAGE_FILE_PATH,
+    DIFF_IMAGES_ARGS_NEW_IMAGE_FILE_PATH,
+    DIFF_IMAGES_ARGS_PATCH_FILE_PATH,
+    DIFF_IMAGES_ARGS_TOTAL_COUNT
+} DIFF_IMAGES_ARGS_t;
+
+typedef enum PATCH_IMAGE_ARGS {
+    PATCH_IMAGE_ARGS_COMMAND,
+    PATCH_IMAGE_ARGS_IMAGE_FILE_PATH,
+    PATCH_IMAGE_ARGS_PATCH_FILE_PATH,
+    PATCH_IMAGE_ARGS_TOTAL_COUNT
+} PATCH_IMAGE_ARGS_t;
+
 typedef struct ARGUMENTS {
     ESPERANTO_FLASH_TOOL_COMMAND_t command;
     uint32_t args_max_count;
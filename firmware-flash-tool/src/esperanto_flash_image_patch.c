@@ -0,0 +1,465 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <stdlib.h>
+#include <stddef.h>
+
+#include "esperanto_flash_image.h"
+#include "esperanto_flash_tool.h"
+#include "parse_template_file.h"
+#include "esperanto_flash_image_patch.h"
+#include "esperanto_flash_image_util.h"
+#include "esperanto_flash_image_view.h"
+
+// regions the SP rewrites at runtime, so their content on the device does not match any image file
+static bool is_runtime_region(ESPERANTO_FLASH_REGION_ID_t region_id) {
+    switch (region_id) {
+    case ESPERANTO_FLASH_REGION_ID_PRIORITY_DESIGNATOR:
+    case ESPERANTO_FLASH_REGION_ID_BOOT_COUNTERS:
+    case ESPERANTO_FLASH_REGION_ID_CONFIGURATION_DATA:
+        return true;
+    default:
+        return false;
+    }
+}
+
+static int get_partition_index(const ARGUMENTS_t * arguments, uint32_t * partition_index) {
+    unsigned long int ul;
+    char * endptr;
+
+    *partition_index = 0;
+    if (NULL != arguments->partition_index) {
+        ul = strtoul(arguments->partition_index, &endptr, 0);
+        if (0 != *endptr) {
+            fprintf(stderr, "Error in get_partition_index: invalid partition index value '%s'!\n", arguments->partition_index);
+            return -1;
+        }
+        if (ul < 1 || ul > 2) {
+            fprintf(stderr, "Error in get_partition_index: partition index (%lu) not in valid range (1 <= index <= 2)!\n", ul);
+            return -1;
+        }
+        *partition_index = (uint32_t)ul;
+    }
+
+    return 0;
+}
+
+// Returns the partition of an image or partition file. The 1st partition of an image is used unless the index is 2,
+// as it is the one the SP programs on a firmware update.
+static ESPERANTO_FLASH_PARTITION_HEADER_t * select_partition(uint8_t * file_data, size_t file_size, uint32_t partition_index, const char * file_path) {
+    ESPERANTO_FLASH_PARTITION_HEADER_t * partition_header;
+    size_t partition_size_in_bytes;
+
+    if (file_size < FLASH_PAGE_SIZE || 0 != (file_size & (FLASH_PAGE_SIZE - 1))) {
+        fprintf(stderr, "Error in select_partition: size of '%s' is not a multiple of 4KB!\n", file_path);
+        return NULL;
+    }
+
+    partition_header = (ESPERANTO_FLASH_PARTITION_HEADER_t*)file_data;
+    if (0 != verify_partition_header(partition_header)) {
+        fprintf(stderr, "Error in select_partition: verify_partition_header() failed on '%s'!\n", file_path);
+        return NULL;
+    }
+
+    partition_size_in_bytes = (size_t)partition_header->partition_size * FLASH_PAGE_SIZE;
+    if (file_size == partition_size_in_bytes) {
+        if (2 == partition_index) {
+            fprintf(stderr, "Error in select_partition: partition index 2 was specified, but '%s' contains only one partition!\n", file_path);
+            return NULL;
+        }
+    } else if (file_size == 2 * partition_size_in_bytes) {
+        if (2 == partition_index) {
+            partition_header = (ESPERANTO_FLASH_PARTITION_HEADER_t*)(file_data + partition_size_in_bytes);
+            if (0 != verify_partition_header(partition_header)) {
+                fprintf(stderr, "Error in select_partition: verify_partition_header() failed on 2nd partition of '%s'!\n", file_path);
+                return NULL;
+            }
+        }
+    } else {
+        fprintf(stderr, "Error in select_partition: invalid image file size of '%s'!\n", file_path);
+        return NULL;
+    }
+
+    return partition_header;
+}
+
+static int verify_patch(const uint8_t * patch_data, uint32_t patch_size, uint32_t partition_size_in_bytes) {
+    const ESPERANTO_FLASH_PATCH_HEADER_t * patch_header = (const ESPERANTO_FLASH_PATCH_HEADER_t*)patch_data;
+    const ESPERANTO_FLASH_PATCH_CHUNK_t * chunk;
+    uint32_t n, offset, chunk_end, partition_end;
+
+    if (patch_size < sizeof(ESPERANTO_FLASH_PATCH_HEADER_t) || ESPERANTO_PATCH_TAG != patch_header->patch_tag) {
+        fprintf(stderr, "Error in verify_patch: not a valid patch header!\n");
+        return -1;
+    }
+    if (sizeof(ESPERANTO_FLASH_PATCH_HEADER_t) != patch_header->patch_header_size) {
+        fprintf(stderr, "Error in verify_patch: invalid or not supported patch header size!\n");
+        return -1;
+    }
+    if (patch_header->patch_header_checksum != crc32_sum(patch_header, offsetof(ESPERANTO_FLASH_PATCH_HEADER_t, patch_header_checksum))) {
+        fprintf(stderr, "Error in verify_patch: patch header checksum mismatch!\n");
+        return -1;
+    }
+    if (patch_header->patch_size != patch_size) {
+        fprintf(stderr, "Error in verify_patch: patch size mismatch!\n");
+        return -1;
+    }
+    if ((uint64_t)patch_header->partition_size * FLASH_PAGE_SIZE != partition_size_in_bytes) {
+        fprintf(stderr, "Error in verify_patch: the patch is for a partition of %u pages, not %u!\n",
+                patch_header->partition_size, partition_size_in_bytes / FLASH_PAGE_SIZE);
+        return -1;
+    }
+
+    offset = sizeof(ESPERANTO_FLASH_PATCH_HEADER_t);
+    partition_end = 0;
+    for (n = 0; n < patch_header->chunks_count; n++) {
+        if (patch_size - offset < sizeof(ESPERANTO_FLASH_PATCH_CHUNK_t)) {
+            fprintf(stderr, "Error in verify_patch: chunk %u is truncated!\n", n);
+            return -1;
+        }
+        chunk = (const ESPERANTO_FLASH_PATCH_CHUNK_t*)(patch_data + offset);
+        offset += (uint32_t)sizeof(ESPERANTO_FLASH_PATCH_CHUNK_t);
+        chunk_end = chunk->chunk_offset + chunk->chunk_size;
+        if (0 == chunk->chunk_size || chunk_end < chunk->chunk_offset || chunk->chunk_offset < partition_end ||
+            chunk_end > patch_header->partition_size) {
+            fprintf(stderr, "Error in verify_patch: chunk %u offset or size is invalid!\n", n);
+            return -1;
+        }
+        if ((patch_size - offset) / FLASH_PAGE_SIZE < chunk->chunk_size) {
+            fprintf(stderr, "Error in verify_patch: chunk %u data is truncated!\n", n);
+            return -1;
+        }
+        if (chunk->chunk_data_crc != crc32_sum(chunk + 1, (size_t)chunk->chunk_size * FLASH_PAGE_SIZE)) {
+            fprintf(stderr, "Error in verify_patch: chunk %u data checksum mismatch!\n", n);
+            return -1;
+        }
+        offset += chunk->chunk_size * FLASH_PAGE_SIZE;
+        partition_end = chunk_end;
+    }
+    if (offset != patch_size) {
+        fprintf(stderr, "Error in verify_patch: %u bytes of trailing data!\n", patch_size - offset);
+        return -1;
+    }
+
+    return 0;
+}
+
+// crc32 of the pages of a partition which are not replaced by a (verified) patch
+static uint32_t patch_base_crc(const uint8_t * patch_data, const uint8_t * partition_data) {
+    const ESPERANTO_FLASH_PATCH_HEADER_t * patch_header = (const ESPERANTO_FLASH_PATCH_HEADER_t*)patch_data;
+    const ESPERANTO_FLASH_PATCH_CHUNK_t * chunk;
+    const uint8_t * ptr = patch_data + sizeof(ESPERANTO_FLASH_PATCH_HEADER_t);
+    uint32_t n, page = 0, crc = 0;
+
+    for (n = 0; n < patch_header->chunks_count; n++) {
+        chunk = (const ESPERANTO_FLASH_PATCH_CHUNK_t*)ptr;
+        crc = crc32_update(crc, partition_data + (size_t)page * FLASH_PAGE_SIZE, (size_t)(chunk->chunk_offset - page) * FLASH_PAGE_SIZE);
+        page = chunk->chunk_offset + chunk->chunk_size;
+        ptr += sizeof(ESPERANTO_FLASH_PATCH_CHUNK_t) + (size_t)chunk->chunk_size * FLASH_PAGE_SIZE;
+    }
+    return crc32_update(crc, partition_data + (size_t)page * FLASH_PAGE_SIZE, (size_t)(patch_header->partition_size - page) * FLASH_PAGE_SIZE);
+}
+
+int apply_patch_to_partition(uint8_t * partition_data, uint32_t partition_size_in_bytes, const uint8_t * patch_data, uint32_t patch_size) {
+    const ESPERANTO_FLASH_PATCH_HEADER_t * patch_header = (const ESPERANTO_FLASH_PATCH_HEADER_t*)patch_data;
+    const ESPERANTO_FLASH_PATCH_CHUNK_t * chunk;
+    const uint8_t * ptr;
+    uint32_t n;
+
+    if (0 != verify_patch(patch_data, patch_size, partition_size_in_bytes)) {
+        fprintf(stderr, "Error in apply_patch_to_partition: verify_patch() failed!\n");
+        return -1;
+    }
+    if (patch_header->base_partition_crc != patch_base_crc(patch_data, partition_data)) {
+        fprintf(stderr, "Error in apply_patch_to_partition: the partition is not the one the patch was made from!\n");
+        return -1;
+    }
+
+    ptr = patch_data + sizeof(ESPERANTO_FLASH_PATCH_HEADER_t);
+    for (n = 0; n < patch_header->chunks_count; n++) {
+        chunk = (const ESPERANTO_FLASH_PATCH_CHUNK_t*)ptr;
+        memcpy(partition_data + (size_t)chunk->chunk_offset * FLASH_PAGE_SIZE, chunk + 1, (size_t)chunk->chunk_size * FLASH_PAGE_SIZE);
+        ptr += sizeof(ESPERANTO_FLASH_PATCH_CHUNK_t) + (size_t)chunk->chunk_size * FLASH_PAGE_SIZE;
+    }
+
+    if (patch_header->new_partition_crc != crc32_sum(partition_data, partition_size_in_bytes)) {
+        fprintf(stderr, "Error in apply_patch_to_partition: patched partition checksum mismatch!\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+static void mark_pages(bool * replaced, ESPERANTO_FLASH_REGION_ID_t * page_regions, uint32_t first_page, uint32_t pages_count, ESPERANTO_FLASH_REGION_ID_t region_id) {
+    uint32_t page;
+
+    for (page = first_page; page < first_page + pages_count; page++) {
+        replaced[page] = true;
+        page_regions[page] = region_id;
+    }
+}
+
+int diff_images(const ARGUMENTS_t * arguments) {
+    int rv;
+    uint32_t n, page, first_page, pages_count, partition_index, partition_size_in_bytes;
+    uint32_t chunks_count, replaced_pages, patch_size;
+    size_t base_file_size, new_file_size;
+    uint8_t * base_file_data = NULL;
+    uint8_t * new_file_data = NULL;
+    uint8_t * patch_data = NULL;
+    uint8_t * check_data = NULL;
+    bool * replaced = NULL;
+    ESPERANTO_FLASH_REGION_ID_t * page_regions = NULL;
+    const ESPERANTO_FLASH_PARTITION_HEADER_t * base_partition;
+    const ESPERANTO_FLASH_PARTITION_HEADER_t * new_partition;
+    const ESPERANATO_REGION_INFO_t * regions;
+    const uint8_t * base_data;
+    const uint8_t * new_data;
+    ESPERANTO_FLASH_PATCH_HEADER_t * patch_header;
+    ESPERANTO_FLASH_PATCH_CHUNK_t * chunk;
+    uint8_t * ptr;
+    const char * region_name;
+
+    if (0 != get_partition_index(arguments, &partition_index)) {
+        rv = -1;
+        goto DONE;
+    }
+
+    if (!arguments->silent) {
+        printf("Command: DIFF\n");
+        printf("Base image/partition path: '%s'\n", arguments->args[DIFF_IMAGES_ARGS_BASE_IMAGE_FILE_PATH]);
+        printf("New image/partition path: '%s'\n", arguments->args[DIFF_IMAGES_ARGS_NEW_IMAGE_FILE_PATH]);
+        printf("Patch path: '%s'\n", arguments->args[DIFF_IMAGES_ARGS_PATCH_FILE_PATH]);
+        if (0 != partition_index) {
+            printf("Partiton index: %u\n", partition_index);
+        }
+    }
+
+    if (0 != load_file(arguments->args[DIFF_IMAGES_ARGS_BASE_IMAGE_FILE_PATH], (char**)&base_file_data, &base_file_size)) {
+        fprintf(stderr, "Error in diff_images: Failed to open/read file '%s'!\n", arguments->args[DIFF_IMAGES_ARGS_BASE_IMAGE_FILE_PATH]);
+        rv = -1;
+        goto DONE;
+    }
+    if (0 != load_file(arguments->args[DIFF_IMAGES_ARGS_NEW_IMAGE_FILE_PATH], (char**)&new_file_data, &new_file_size)) {
+        fprintf(stderr, "Error in diff_images: Failed to open/read file '%s'!\n", arguments->args[DIFF_IMAGES_ARGS_NEW_IMAGE_FILE_PATH]);
+        rv = -1;
+        goto DONE;
+    }
+
+    base_partition = select_partition(base_file_data, base_file_size, partition_index, arguments->args[DIFF_IMAGES_ARGS_BASE_IMAGE_FILE_PATH]);
+    new_partition = select_partition(new_file_data, new_file_size, partition_index, arguments->args[DIFF_IMAGES_ARGS_NEW_IMAGE_FILE_PATH]);
+    if (NULL == base_partition || NULL == new_partition) {
+        rv = -1;
+        goto DONE;
+    }
+    if (base_partition->partition_size != new_partition->partition_size) {
+        fprintf(stderr, "Error in diff_images: the partitions sizes differ (%u and %u pages)!\n", base_partition->partition_size, new_partition->partition_size);
+        rv = -1;
+        goto DONE;
+    }
+    pages_count = new_partition->partition_size;
+    partition_size_in_bytes = pages_count * FLASH_PAGE_SIZE;
+    base_data = (const uint8_t*)base_partition;
+    new_data = (const uint8_t*)new_partition;
+
+    replaced = (bool*)calloc(pages_count, sizeof(bool));
+    page_regions = (ESPERANTO_FLASH_REGION_ID_t*)calloc(pages_count, sizeof(ESPERANTO_FLASH_REGION_ID_t));
+    if (NULL == replaced || NULL == page_regions) {
+        fprintf(stderr, "Error in diff_images: calloc() failed!\n");
+        rv = -1;
+        goto DONE;
+    }
+
+    // The regions which changed are replaced as a whole, the regions rewritten by the SP always
+    if (new_partition->regions_count > ESPERANTO_MAX_REGIONS_COUNT) {
+        fprintf(stderr, "Error in diff_images: invalid regions count!\n");
+        rv = -1;
+        goto DONE;
+    }
+    regions = (const ESPERANATO_REGION_INFO_t*)(new_partition + 1);
+    for (n = 0; n < new_partition->regions_count; n++) {
+        if (regions[n].region_info_checksum != crc32_sum(&regions[n], offsetof(ESPERANATO_REGION_INFO_t, region_info_checksum))) {
+            fprintf(stderr, "Error in diff_images: region %u header CRC checksum is invalid!\n", n);
+            rv = -1;
+            goto DONE;
+        }
+        first_page = regions[n].region_offset;
+        if (first_page > pages_count || regions[n].region_reserved_size > pages_count - first_page) {
+            fprintf(stderr, "Error in diff_images: region %u offset or size is invalid!\n", n);
+            rv = -1;
+            goto DONE;
+        }
+        if (is_runtime_region(regions[n].region_id) ||
+            0 != memcmp(base_data + (size_t)first_page * FLASH_PAGE_SIZE, new_data + (size_t)first_page * FLASH_PAGE_SIZE,
+                        (size_t)regions[n].region_reserved_size * FLASH_PAGE_SIZE)) {
+            mark_pages(replaced, page_regions, first_page, regions[n].region_reserved_size, regions[n].region_id);
+        }
+    }
+
+    // Then whatever else changed, e.g. the partition header and regions table
+    for (page = 0; page < pages_count; page++) {
+        if (!replaced[page] &&
+            0 != memcmp(base_data + (size_t)page * FLASH_PAGE_SIZE, new_data + (size_t)page * FLASH_PAGE_SIZE, FLASH_PAGE_SIZE)) {
+            mark_pages(replaced, page_regions, page, 1, ESPERANTO_FLASH_REGION_ID_INVALID);
+        }
+    }
+
+    chunks_count = 0;
+    replaced_pages = 0;
+    for (page = 0; page < pages_count; page++) {
+        if (replaced[page]) {
+            replaced_pages++;
+            if (0 == page || !replaced[page - 1] || page_regions[page] != page_regions[page - 1]) {
+                chunks_count++;
+            }
+        }
+    }
+
+    patch_size = (uint32_t)(sizeof(ESPERANTO_FLASH_PATCH_HEADER_t) + chunks_count * sizeof(ESPERANTO_FLASH_PATCH_CHUNK_t)) +
+                 replaced_pages * FLASH_PAGE_SIZE;
+    if (patch_size > partition_size_in_bytes) {
+        fprintf(stderr, "Error in diff_images: the patch (%u bytes) would be larger than the partition, use the new image instead!\n", patch_size);
+        rv = -1;
+        goto DONE;
+    }
+    patch_data = (uint8_t*)malloc(patch_size);
+    if (NULL == patch_data) {
+        fprintf(stderr, "Error in diff_images: malloc(%u) failed!\n", patch_size);
+        rv = -1;
+        goto DONE;
+    }
+
+    patch_header = (ESPERANTO_FLASH_PATCH_HEADER_t*)patch_data;
+    ptr = patch_data + sizeof(ESPERANTO_FLASH_PATCH_HEADER_t);
+    for (page = 0; page < pages_count; page++) {
+        if (!replaced[page]) {
+            continue;
+        }
+        first_page = page;
+        while (page + 1 < pages_count && replaced[page + 1] && page_regions[page + 1] == page_regions[first_page]) {
+            page++;
+        }
+
+        chunk = (ESPERANTO_FLASH_PATCH_CHUNK_t*)ptr;
+        chunk->region_id = page_regions[first_page];
+        chunk->chunk_offset = first_page;
+        chunk->chunk_size = page + 1 - first_page;
+        memcpy(chunk + 1, new_data + (size_t)first_page * FLASH_PAGE_SIZE, (size_t)chunk->chunk_size * FLASH_PAGE_SIZE);
+        chunk->chunk_data_crc = crc32_sum(chunk + 1, (size_t)chunk->chunk_size * FLASH_PAGE_SIZE);
+        ptr += sizeof(ESPERANTO_FLASH_PATCH_CHUNK_t) + (size_t)chunk->chunk_size * FLASH_PAGE_SIZE;
+
+        if (arguments->verbose) {
+            region_name = region_id_to_name(chunk->region_id);
+            printf("Pages %u..%u: region 0x%x (%s)\n", chunk->chunk_offset, page, chunk->region_id,
+                   ESPERANTO_FLASH_REGION_ID_INVALID == chunk->region_id ? "outside regions" : (region_name ? region_name : "unknown"));
+        }
+    }
+
+    patch_header->patch_tag = ESPERANTO_PATCH_TAG;
+    patch_header->patch_header_size = sizeof(ESPERANTO_FLASH_PATCH_HEADER_t);
+    patch_header->patch_size = patch_size;
+    patch_header->partition_size = pages_count;
+    patch_header->chunks_count = chunks_count;
+    patch_header->base_partition_crc = patch_base_crc(patch_data, base_data);
+    patch_header->new_partition_crc = crc32_sum(new_data, partition_size_in_bytes);
+    patch_header->patch_header_checksum = crc32_sum(patch_header, offsetof(ESPERANTO_FLASH_PATCH_HEADER_t, patch_header_checksum));
+
+    // Check the patch turns the base partition into the new one, as the SP will do
+    check_data = (uint8_t*)malloc(partition_size_in_bytes);
+    if (NULL == check_data) {
+        fprintf(stderr, "Error in diff_images: malloc(%u) failed!\n", partition_size_in_bytes);
+        rv = -1;
+        goto DONE;
+    }
+    memcpy(check_data, base_data, partition_size_in_bytes);
+    if (0 != apply_patch_to_partition(check_data, partition_size_in_bytes, patch_data, patch_size) ||
+        0 != memcmp(check_data, new_data, partition_size_in_bytes)) {
+        fprintf(stderr, "Error in diff_images: the patch does not reproduce the new partition!\n");
+        rv = -1;
+        goto DONE;
+    }
+
+    if (0 != save_image(arguments->args[DIFF_IMAGES_ARGS_PATCH_FILE_PATH], patch_data, patch_size)) {
+        fprintf(stderr, "Error in diff_images: save_image() failed!\n");
+        rv = -1;
+        goto DONE;
+    }
+
+    if (!arguments->silent) {
+        printf("Saved patch of %u pages in %u chunks (%u bytes, partition is %u bytes) to file '%s'.\n", replaced_pages,
+               chunks_count, patch_size, partition_size_in_bytes, arguments->args[DIFF_IMAGES_ARGS_PATCH_FILE_PATH]);
+    }
+    rv = 0;
+
+DONE:
+    free(check_data);
+    free(patch_data);
+    free(page_regions);
+    free(replaced);
+    free(new_file_data);
+    free(base_file_data);
+    return rv;
+}
+
+int patch_image(const ARGUMENTS_t * arguments) {
+    int rv;
+    uint32_t partition_index;
+    size_t file_size, patch_size;
+    uint8_t * file_data = NULL;
+    uint8_t * patch_data = NULL;
+    ESPERANTO_FLASH_PARTITION_HEADER_t * partition_header;
+    const char * output_path = arguments->output_path ? arguments->output_path : arguments->args[PATCH_IMAGE_ARGS_IMAGE_FILE_PATH];
+
+    if (0 != get_partition_index(arguments, &partition_index)) {
+        rv = -1;
+        goto DONE;
+    }
+
+    if (!arguments->silent) {
+        printf("Command: PATCH\n");
+        printf("Image/partition path: '%s'\n", arguments->args[PATCH_IMAGE_ARGS_IMAGE_FILE_PATH]);
+        printf("Patch path: '%s'\n", arguments->args[PATCH_IMAGE_ARGS_PATCH_FILE_PATH]);
+        if (0 != partition_index) {
+            printf("Partiton index: %u\n", partition_index);
+        }
+    }
+
+    if (0 != load_file(arguments->args[PATCH_IMAGE_ARGS_IMAGE_FILE_PATH], (char**)&file_data, &file_size)) {
+        fprintf(stderr, "Error in patch_image: Failed to open/read file '%s'!\n", arguments->args[PATCH_IMAGE_ARGS_IMAGE_FILE_PATH]);
+        rv = -1;
+        goto DONE;
+    }
+    if (0 != load_file(arguments->args[PATCH_IMAGE_ARGS_PATCH_FILE_PATH], (char**)&patch_data, &patch_size)) {
+        fprintf(stderr, "Error in patch_image: Failed to open/read file '%s'!\n", arguments->args[PATCH_IMAGE_ARGS_PATCH_FILE_PATH]);
+        rv = -1;
+        goto DONE;
+    }
+
+    partition_header = select_partition(file_data, file_size, partition_index, arguments->args[PATCH_IMAGE_ARGS_IMAGE_FILE_PATH]);
+    if (NULL == partition_header || patch_size > UINT32_MAX) {
+        rv = -1;
+        goto DONE;
+    }
+    if (0 != apply_patch_to_partition((uint8_t*)partition_header, partition_header->partition_size * FLASH_PAGE_SIZE, patch_data, (uint32_t)patch_size)) {
+        fprintf(stderr, "Error in patch_image: apply_patch_to_partition() failed!\n");
+        rv = -1;
+        goto DONE;
+    }
+
+    if (0 != save_image(output_path, file_data, (uint32_t)file_size)) {
+        fprintf(stderr, "Error in patch_image: save_image() failed!\n");
+        rv = -1;
+        goto DONE;
+    }
+
+    if (!arguments->silent) {
+        printf("Saved patched image to file '%s'.\n", output_path);
+    }
+    rv = 0;
+
+DONE:
+    free(patch_data);
+    free(file_data);
+    return rv;
+}
@@ -49,9 +49,13 @@ static const uint32_t crc32Table[256] = {
 };
 
 uint32_t crc32_sum(const void *data, size_t size) {
+    return crc32_update(0, data, size);
+}
+
+uint32_t crc32_update(uint32_t crc, const void *data, size_t size) {
 	const uint8_t *p = (const uint8_t*)data;
-    uint32_t crc = ~0U;
 
+    crc = ~crc;
 	while (size) {
 		crc = crc32Table[(crc ^ *p++) & 0xff] ^ (crc >> 8);
         size--;
@@ -12,6 +12,7 @@
 #include "esperanto_flash_image_view.h"
 #include "esperanto_flash_image_replace.h"
 #include "esperanto_flash_image_extract_all.h"
+#include "esperanto_flash_image_patch.h"
 #include "esperanto_flash_image_util.h"
 
 #include "parse_template_file.h"
@@ -23,14 +24,16 @@ const char *argp_program_version = "esperanto_flash_tool 1.0";
 const char *argp_program_bug_address = "problems@esperantotech.com";
 
 // short program documentation
-static char doc[] = "Generates, views, updates or extracts files from flash image or partition";
+static char doc[] = "Generates, views, updates, patches or extracts files from flash image or partition";
 
 // arguments description
 static char args_doc[] = "create      <image_file> <template_file>\n" \
                          "view        <image_file>\n" \
                          "extract     <image_file> <region_index> <extracted_file_path> [<region_index_2> <extracted_file_2_path> ... [<region_index_n> <extracted_file_n_path>]]\n" \
                          "extract_all <image_file> <extracted_files_folder_path>\n" \
-                         "replace     <image_file> <region_index> <file_path> [<region_index_2> <file_2_path> ... [<region_index_n> <file_n_path>]]\n";
+                         "replace     <image_file> <region_index> <file_path> [<region_index_2> <file_2_path> ... [<region_index_n> <file_n_path>]]\n" \
+                         "diff        <base_image_file> <new_image_file> <patch_file>\n" \
+                         "patch       <image_file> <patch_file>\n";
 // options
 static struct argp_option options[] = {
     { "verbose",    'v', NULL,                  0,                      "Produce verbose output",                                           0 },
@@ -38,7 +41,7 @@ static struct argp_option options[] = {
     { "silent",     's', NULL,                  OPTION_ALIAS,           NULL,                                                               0 },
     { "partition",  'P', "partition_index",     OPTION_ARG_OPTIONAL,    "Create partition instead of image, or\nUse specified partition",   0 },
     { "id",         'I', NULL,                  0,                      "Use region IDs instead of indexes",                                0 },
-    { "output",     'O', "output_path",         0,                      "Write the image to specified path (REPLACE command only)",         0 },
+    { "output",     'O', "output_path",         0,                      "Write the image to specified path (REPLACE and PATCH commands only)", 0 },
     { 0 }
 };
 
@@ -77,6 +80,10 @@ static error_t parse_opt(int key, char * arg, struct argp_state * state) {
                 arguments->command = ESPERANTO_FLASH_TOOL_COMMAND_EXTRACT_ALL_FILES;
             } else if (0 == strcasecmp(arg, "replace")) {
                 arguments->command = ESPERANTO_FLASH_TOOL_COMMAND_REPLACE;
+            } else if (0 == strcasecmp(arg, "diff")) {
+                arguments->command = ESPERANTO_FLASH_TOOL_COMMAND_DIFF;
+            } else if (0 == strcasecmp(arg, "patch")) {
+                arguments->command = ESPERANTO_FLASH_TOOL_COMMAND_PATCH;
             } else {
                 fprintf(stderr, "Invalid command '%s'!\n", arg);
                 argp_usage(state);
@@ -101,6 +108,18 @@ static error_t parse_opt(int key, char * arg, struct argp_state * state) {
                     argp_usage(state);
                 }
                 break;
+            case ESPERANTO_FLASH_TOOL_COMMAND_DIFF:
+                if (state->arg_num > DIFF_IMAGES_ARGS_TOTAL_COUNT) {
+                    // too many arguments
+                    argp_usage(state);
+                }
+                break;
+            case ESPERANTO_FLASH_TOOL_COMMAND_PATCH:
+                if (state->arg_num > PATCH_IMAGE_ARGS_TOTAL_COUNT) {
+                    // too many arguments
+                    argp_usage(state);
+                }
+                break;
             case ESPERANTO_FLASH_TOOL_COMMAND_EXTRACT_FILE:
             case ESPERANTO_FLASH_TOOL_COMMAND_REPLACE:
                 break;
@@ -159,6 +178,18 @@ static error_t parse_opt(int key, char * arg, struct argp_state * state) {
                 argp_usage(state);
             }
             break;
+        case ESPERANTO_FLASH_TOOL_COMMAND_DIFF:
+            if (state->arg_num < DIFF_IMAGES_ARGS_TOTAL_COUNT) {
+                // not enough arguments
+                argp_usage(state);
+            }
+            break;
+        case ESPERANTO_FLASH_TOOL_COMMAND_PATCH:
+            if (state->arg_num < PATCH_IMAGE_ARGS_TOTAL_COUNT) {
+                // not enough arguments
+                argp_usage(state);
+            }
+            break;
         default:
             // we should never get here
             argp_usage(state);
@@ -207,6 +238,10 @@ int main(int argc, char ** argv) {
         return extract_all_files(&g_arguments);
     case ESPERANTO_FLASH_TOOL_COMMAND_REPLACE:
         return replace_files(&g_arguments);
+    case ESPERANTO_FLASH_TOOL_COMMAND_DIFF:
+        return diff_images(&g_arguments);
+    case ESPERANTO_FLASH_TOOL_COMMAND_PATCH:
+        return patch_image(&g_arguments);
     default:
         // we should never get here
         return -1;
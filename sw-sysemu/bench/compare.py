@@ -0,0 +1,67 @@
+#!/usr/bin/env python3
+
+# Copyright (c) 2025 Ainekko, Co.
+# SPDX-License-Identifier: Apache-2.0
+
+'''Compare two runs of the benchmark saved with --benchmark_out_format=json
+and fail when a benchmark got slower than the threshold'''
+
+import argparse
+import json
+import sys
+
+
+def LoadRates(filename, counter):
+    '''Map benchmark name to counter, means only when there are repetitions'''
+
+    with open(filename, "r") as f:
+        runs = json.load(f)["benchmarks"]
+    aggregates = any(run.get("run_type") == "aggregate" for run in runs)
+    rates = {}
+    for run in runs:
+        if run.get("error_occurred") or counter not in run:
+            continue
+        if aggregates:
+            if run.get("aggregate_name") != "mean":
+                continue
+            name = run["run_name"]
+        else:
+            name = run["name"]
+        rates[name] = run[counter]
+    return rates
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("baseline", help="JSON output of the reference run")
+    parser.add_argument("current", help="JSON output of the run to check")
+    parser.add_argument("--counter", default="ips",
+                        help="rate to compare, higher is better (default: ips)")
+    parser.add_argument("--threshold", type=float, default=5.0,
+                        help="slowdown in percent that fails (default: 5)")
+    args = parser.parse_args()
+
+    baseline = LoadRates(args.baseline, args.counter)
+    current = LoadRates(args.current, args.counter)
+
+    regressions = 0
+    for name in sorted(baseline.keys() | current.keys()):
+        if name not in current:
+            print(f"{'MISSING':>10}  {name}")
+            regressions += 1
+            continue
+        if name not in baseline:
+            print(f"{'NEW':>10}  {name}")
+            continue
+        change = 100.0 * (current[name] - baseline[name]) / baseline[name]
+        slower = change < -args.threshold
+        print(f"{change:+9.2f}%  {name}{'  REGRESSION' if slower else ''}")
+        regressions += slower
+
+    if regressions:
+        print(f"{regressions} benchmark(s) slower than {args.threshold}% or missing")
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
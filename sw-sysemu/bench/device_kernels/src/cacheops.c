@@ -0,0 +1,25 @@
+#include "macros.h"
+#include "etsoc/isa/cacheops.h"
+#include "etsoc/isa/hart.h"
+
+/* Cache operations: dirty a buffer, then flush and evict it by VA so that
+ * every round refills the L1 from the L2 */
+#define LINES 64
+
+static volatile uint64_t buffer[LINES * 8] __attribute__((aligned(64)));
+
+int main() {
+	uint64_t sum = 0;
+	for (unsigned long i = 0; i < 500; i++) {
+		for (unsigned long line = 0; line < LINES; line++) {
+			buffer[line * 8] += i;
+		}
+		flush_va(0, to_L2, (uint64_t)buffer, 15, 64, 0);
+		evict(to_L2, buffer, sizeof(buffer));
+		WAIT_CACHEOPS;
+		for (unsigned long line = 0; line < LINES; line++) {
+			sum += buffer[line * 8];
+		}
+	}
+	(void)sum;
+}
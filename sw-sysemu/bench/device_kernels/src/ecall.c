@@ -0,0 +1,19 @@
+#include "macros.h"
+#include "etsoc/isa/hart.h"
+
+/* Trap heavy code: every ecall traps to a handler that only skips it */
+static void __attribute__((naked, aligned(4))) trap_handler(void) {
+	asm volatile ("csrw mscratch, t0");
+	asm volatile ("csrr t0, mepc");
+	asm volatile ("addi t0, t0, 4");
+	asm volatile ("csrw mepc, t0");
+	asm volatile ("csrr t0, mscratch");
+	asm volatile ("mret");
+}
+
+int main() {
+	asm volatile ("csrw mtvec, %0" : : "r"(trap_handler));
+	for (int i = 0; i < 10000; i++) {
+		asm volatile ("ecall");
+	}
+}
@@ -0,0 +1,18 @@
+#include "macros.h"
+#include "etsoc/isa/hart.h"
+
+/* Hot loops, the code is executed many times instead of once */
+int main() {
+	volatile unsigned long sink = 0;
+	unsigned long acc = 0x9E3779B97F4A7C15UL;
+	for (unsigned long i = 0; i < 100000; i++) {
+		acc ^= acc << 13;
+		acc ^= acc >> 7;
+		acc ^= acc << 17;
+		acc += i * 3;
+		if (acc & 1)
+			acc = (acc >> 1) | (acc << 63);
+	}
+	sink = acc;
+	(void)sink;
+}
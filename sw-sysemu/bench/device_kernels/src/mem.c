@@ -0,0 +1,27 @@
+#include "macros.h"
+#include "etsoc/isa/hart.h"
+
+/* Loads and stores: unit stride over a buffer that fits in the L1, then a
+ * line stride over one that does not */
+#define SMALL_WORDS 1024
+#define LARGE_WORDS (64 * 1024)
+
+static uint64_t small[SMALL_WORDS] __attribute__((aligned(64)));
+static uint64_t large[LARGE_WORDS] __attribute__((aligned(64)));
+
+int main() {
+	volatile uint64_t sink = 0;
+	uint64_t acc = 0;
+	for (unsigned long i = 0; i < 50; i++) {
+		for (unsigned long j = 0; j < SMALL_WORDS; j++) {
+			small[j] = acc + j;
+			acc += small[(j * 7) % SMALL_WORDS];
+		}
+		for (unsigned long j = 0; j < LARGE_WORDS; j += 8) {
+			large[j] += acc;
+			acc ^= large[(j + 4096) % LARGE_WORDS];
+		}
+	}
+	sink = acc;
+	(void)sink;
+}
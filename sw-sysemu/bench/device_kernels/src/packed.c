@@ -0,0 +1,19 @@
+#include "macros.h"
+#include "etsoc/isa/hart.h"
+
+/* Packed single: 8-wide FP operations on the f registers under mask m0,
+ * executed in a loop */
+int main() {
+	/* Enable all the lanes, broadcast 1.0f and 0.5f */
+	asm volatile ("mov.m.x m0, zero, 0xff");
+	asm volatile ("fbcx.ps f10, %0" : : "r" (0x3F800000) : "f10");
+	asm volatile ("fbcx.ps f11, %0" : : "r" (0x3F000000) : "f11");
+	for (unsigned long i = 0; i < 10000; i++) {
+		asm volatile ("fmadd.ps f12, f10, f11, f12" : : : "f12");
+		asm volatile ("fadd.ps f13, f12, f10" : : : "f13");
+		asm volatile ("fmul.ps f14, f13, f11" : : : "f14");
+		asm volatile ("fsub.ps f15, f14, f12" : : : "f15");
+		asm volatile ("fmax.ps f16, f15, f13" : : : "f16");
+		asm volatile ("fcvt.pw.ps f17, f16" : : : "f17");
+	}
+}
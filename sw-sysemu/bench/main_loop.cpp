@@ -36,6 +36,9 @@ public:
         for (const auto& elf_file : elfs_to_preload) {
             cmd_options.elf_files.push_back(elf_file);
         }
+        configure(cmd_options, state);
+        harts = __builtin_popcountll(cmd_options.minions_en) * __builtin_popcountll(cmd_options.shires_en) *
+                (cmd_options.second_thread ? 2 : 1);
         emu = std::make_unique<sys_emu>(cmd_options);
     }
 
@@ -46,33 +49,49 @@ public:
         state.counters.insert({{"cycles", num_inst}, {"cycles/s", cycles_p_s}, {"total_time", total_exe_time}});
         // ips (instructions per second), same as 'cycles/s' but with google benchmark average time
         state.counters["ips"] = benchmark::Counter(num_inst, benchmark::Counter::kIsRate);
+        // Retired instructions of all the harts, assuming none of them waits
+        state.counters["harts"] = harts;
+        state.counters["hart_ips"] = benchmark::Counter(num_inst * harts, benchmark::Counter::kIsRate);
     }
 
 protected:
+    void run(benchmark::State& state) {
+        int status = EXIT_SUCCESS;
+        for (auto _ : state) {
+            // Run the benchmark
+            benchmark::DoNotOptimize(status = emu->main_internal());
+            benchmark::ClobberMemory();
+            if (status != EXIT_SUCCESS) {
+                state.SkipWithError("Failed to run emulator!");
+                break; // Needed to skip the rest of the iteration.
+            }
+        }
+    }
+
+    // Extra options of a benchmark, from its own arguments
+    virtual void configure(sys_emu_cmd_options&, const benchmark::State&) {}
+
     std::vector<std::string> elfs_to_preload;
     std::unique_ptr<sys_emu> emu;
+    uint64_t harts = 1;
 };
 
 class FWBenchmark : public SysEmuBenchmark {
 public:
     FWBenchmark() : SysEmuBenchmark(fw_elfs) {}
+
+protected:
+    void configure(sys_emu_cmd_options& cmd_options, const benchmark::State& state) override {
+        cmd_options.quantum = state.range(2);
+    }
 };
 
 BENCHMARK_DEFINE_F(FWBenchmark, BM_main_internal_fw_boot)(benchmark::State& state) {
-     int status = EXIT_SUCCESS;
-     for (auto _ : state) {
-         // Run the benchmark
-         benchmark::DoNotOptimize(status = emu->main_internal());
-         benchmark::ClobberMemory();
-         if (status != EXIT_SUCCESS) {
-             state.SkipWithError("Failed to run emulator!");
-             break; // Needed to skip the rest of the iteration.
-         }
-     }
- };
- BENCHMARK_REGISTER_F(FWBenchmark, BM_main_internal_fw_boot)
-     ->ArgsProduct({{false, true}, {false, true}})
-     ->ArgNames({"mem_check+l1_scp_check+l2_scp_check+flb_check", "tstore_check"});
+    run(state);
+};
+BENCHMARK_REGISTER_F(FWBenchmark, BM_main_internal_fw_boot)
+    ->ArgsProduct({{false, true}, {false, true}, {1, 16, 256}})
+    ->ArgNames({"mem_check+l1_scp_check+l2_scp_check+flb_check", "tstore_check", "quantum"});
 
 
 /* RISCV Instructions: rv64f*/
@@ -84,16 +103,7 @@ public:
 };
 
 BENCHMARK_DEFINE_F(Inst_RV64F_Benchmark, BM_main_internal_inst_seq)(benchmark::State& state) {
-    int status = EXIT_SUCCESS;
-    for (auto _ : state) {
-        // Run the benchmark
-        benchmark::DoNotOptimize(status = emu->main_internal());
-        benchmark::ClobberMemory();
-        if (status != EXIT_SUCCESS) {
-            state.SkipWithError("Failed to run emulator!");
-            break; // Needed to skip the rest of the iteration.
-        }
-    }
+    run(state);
 };
 
 
@@ -110,16 +120,7 @@ public:
 };
 
 BENCHMARK_DEFINE_F(Inst_RV64I_Benchmark, BM_main_internal_inst_seq)(benchmark::State& state) {
-    int status = EXIT_SUCCESS;
-    for (auto _ : state) {
-        // Run the benchmark
-        benchmark::DoNotOptimize(status = emu->main_internal());
-        benchmark::ClobberMemory();
-        if (status != EXIT_SUCCESS) {
-            state.SkipWithError("Failed to run emulator!");
-            break; // Needed to skip the rest of the iteration.
-        }
-    }
+    run(state);
 };
 
 BENCHMARK_REGISTER_F(Inst_RV64I_Benchmark, BM_main_internal_inst_seq)
@@ -135,16 +136,7 @@ public:
 };
 
 BENCHMARK_DEFINE_F(Inst_RV64M_Benchmark, BM_main_internal_inst_seq)(benchmark::State& state) {
-    int status = EXIT_SUCCESS;
-    for (auto _ : state) {
-        // Run the benchmark
-        benchmark::DoNotOptimize(status = emu->main_internal());
-        benchmark::ClobberMemory();
-        if (status != EXIT_SUCCESS) {
-            state.SkipWithError("Failed to run emulator!");
-            break; // Needed to skip the rest of the iteration.
-        }
-    }
+    run(state);
 };
 
 BENCHMARK_REGISTER_F(Inst_RV64M_Benchmark, BM_main_internal_inst_seq)
@@ -160,16 +152,7 @@ public:
 };
 
 BENCHMARK_DEFINE_F(Inst_RV64D_Benchmark, BM_main_internal_inst_seq)(benchmark::State& state) {
-    int status = EXIT_SUCCESS;
-    for (auto _ : state) {
-        // Run the benchmark
-        benchmark::DoNotOptimize(status = emu->main_internal());
-        benchmark::ClobberMemory();
-        if (status != EXIT_SUCCESS) {
-            state.SkipWithError("Failed to run emulator!");
-            break; // Needed to skip the rest of the iteration.
-        }
-    }
+    run(state);
 };
 
 BENCHMARK_REGISTER_F(Inst_RV64D_Benchmark, BM_main_internal_inst_seq)
@@ -185,46 +168,142 @@ public:
 };
 
 BENCHMARK_DEFINE_F(Inst_TENSORS_Benchmark, BM_main_internal_inst_seq)(benchmark::State& state) {
-    int status = EXIT_SUCCESS;
-    for (auto _ : state) {
-        // Run the benchmark
-        benchmark::DoNotOptimize(status = emu->main_internal());
-        benchmark::ClobberMemory();
-        if (status != EXIT_SUCCESS) {
-            state.SkipWithError("Failed to run emulator!");
-            break; // Needed to skip the rest of the iteration.
-        }
-    }
+    run(state);
 };
 
 BENCHMARK_REGISTER_F(Inst_TENSORS_Benchmark, BM_main_internal_inst_seq)
     ->ArgsProduct({{false, true}, {false, true}})
     ->ArgNames({"mem_check+l1_scp_check+l2_scp_check+flb_check", "tstore_check"});
 
-/* RISCV Instructions: rv64a*/
-// class Inst_RV64A_Benchmark : public SysEmuBenchmark {
-// public:
-//     Inst_RV64A_Benchmark()
-//         : SysEmuBenchmark({std::string{DEVICE_KERNELS_DIR} + std::string{"rv64a.elf"}})
-//     {}
-// };
-
-// BENCHMARK_DEFINE_F(Inst_RV64A_Benchmark, BM_main_internal_inst_seq)(benchmark::State& state) {
-//     int status = EXIT_SUCCESS;
-//     for (auto _ : state) {
-//         // Run the benchmark
-//         benchmark::DoNotOptimize(status = emu->main_internal());
-//         benchmark::ClobberMemory();
-//         if (status != EXIT_SUCCESS) {
-//             state.SkipWithError("Failed to run emulator!");
-//             break; // Needed to skip the rest of the iteration.
-//         }
-//     }
-// };
-
-// BENCHMARK_REGISTER_F(Inst_RV64A_Benchmark, BM_main_internal_inst_seq)
-//     ->ArgsProduct({{false, true}, {false, true}})
-//     ->ArgNames({"mem_check+l1_scp_check+l2_scp_check+flb_check", "tstore_check"});
+/* Hot loops: the same instructions executed many times */
+class Inst_LOOP_Benchmark : public SysEmuBenchmark {
+public:
+    Inst_LOOP_Benchmark()
+        : SysEmuBenchmark({std::string{DEVICE_KERNELS_DIR} + std::string{"loop.elf"}})
+    {}
+
+protected:
+    void configure(sys_emu_cmd_options& cmd_options, const benchmark::State& state) override {
+        cmd_options.translate = state.range(2);
+        cmd_options.quantum = state.range(3);
+    }
+};
+
+BENCHMARK_DEFINE_F(Inst_LOOP_Benchmark, BM_main_internal_inst_seq)(benchmark::State& state) {
+    run(state);
+};
+
+BENCHMARK_REGISTER_F(Inst_LOOP_Benchmark, BM_main_internal_inst_seq)
+    ->ArgsProduct({{false, true}, {false, true}, {false, true}, {1, 256}})
+    ->ArgNames({"mem_check+l1_scp_check+l2_scp_check+flb_check", "tstore_check", "translate", "quantum"});
+
+/* Traps: ecall and return to the next instruction */
+class Inst_ECALL_Benchmark : public SysEmuBenchmark {
+public:
+    Inst_ECALL_Benchmark()
+        : SysEmuBenchmark({std::string{DEVICE_KERNELS_DIR} + std::string{"ecall.elf"}})
+    {}
+};
+
+BENCHMARK_DEFINE_F(Inst_ECALL_Benchmark, BM_main_internal_inst_seq)(benchmark::State& state) {
+    run(state);
+};
+
+BENCHMARK_REGISTER_F(Inst_ECALL_Benchmark, BM_main_internal_inst_seq)
+    ->ArgsProduct({{false, true}, {false, true}})
+    ->ArgNames({"mem_check+l1_scp_check+l2_scp_check+flb_check", "tstore_check"});
+
+/* Atomics: local and global AMOs */
+class Inst_RV64A_Benchmark : public SysEmuBenchmark {
+public:
+    Inst_RV64A_Benchmark()
+        : SysEmuBenchmark({std::string{DEVICE_KERNELS_DIR} + std::string{"rv64a.elf"}})
+    {}
+};
+
+BENCHMARK_DEFINE_F(Inst_RV64A_Benchmark, BM_main_internal_inst_seq)(benchmark::State& state) {
+    run(state);
+};
+
+BENCHMARK_REGISTER_F(Inst_RV64A_Benchmark, BM_main_internal_inst_seq)
+    ->ArgsProduct({{false, true}, {false, true}})
+    ->ArgNames({"mem_check+l1_scp_check+l2_scp_check+flb_check", "tstore_check"});
+
+/* Packed single instructions */
+class Inst_PACKED_Benchmark : public SysEmuBenchmark {
+public:
+    Inst_PACKED_Benchmark()
+        : SysEmuBenchmark({std::string{DEVICE_KERNELS_DIR} + std::string{"packed.elf"}})
+    {}
+};
+
+BENCHMARK_DEFINE_F(Inst_PACKED_Benchmark, BM_main_internal_inst_seq)(benchmark::State& state) {
+    run(state);
+};
+
+BENCHMARK_REGISTER_F(Inst_PACKED_Benchmark, BM_main_internal_inst_seq)
+    ->ArgsProduct({{false, true}, {false, true}})
+    ->ArgNames({"mem_check+l1_scp_check+l2_scp_check+flb_check", "tstore_check"});
+
+/* Cache operations: flushes and evictions by VA */
+class Inst_CACHEOPS_Benchmark : public SysEmuBenchmark {
+public:
+    Inst_CACHEOPS_Benchmark()
+        : SysEmuBenchmark({std::string{DEVICE_KERNELS_DIR} + std::string{"cacheops.elf"}})
+    {}
+};
+
+BENCHMARK_DEFINE_F(Inst_CACHEOPS_Benchmark, BM_main_internal_inst_seq)(benchmark::State& state) {
+    run(state);
+};
+
+BENCHMARK_REGISTER_F(Inst_CACHEOPS_Benchmark, BM_main_internal_inst_seq)
+    ->ArgsProduct({{false, true}, {false, true}})
+    ->ArgNames({"mem_check+l1_scp_check+l2_scp_check+flb_check", "tstore_check"});
+
+/* Loads and stores, with and without the timing model */
+class Inst_MEM_Benchmark : public SysEmuBenchmark {
+public:
+    Inst_MEM_Benchmark()
+        : SysEmuBenchmark({std::string{DEVICE_KERNELS_DIR} + std::string{"mem.elf"}})
+    {}
+
+protected:
+    void configure(sys_emu_cmd_options& cmd_options, const benchmark::State& state) override {
+        cmd_options.timing_model = state.range(2);
+    }
+};
+
+BENCHMARK_DEFINE_F(Inst_MEM_Benchmark, BM_main_internal_inst_seq)(benchmark::State& state) {
+    run(state);
+};
+
+BENCHMARK_REGISTER_F(Inst_MEM_Benchmark, BM_main_internal_inst_seq)
+    ->ArgsProduct({{false, true}, {false, true}, {false, true}})
+    ->ArgNames({"mem_check+l1_scp_check+l2_scp_check+flb_check", "tstore_check", "timing_model"});
+
+/* Scaling: the atomics on more harts, all of them adding to the same global
+ * counter. Compare hart_ips, ips only counts the cycles of the main loop */
+class Scaling_Benchmark : public SysEmuBenchmark {
+public:
+    Scaling_Benchmark()
+        : SysEmuBenchmark({std::string{DEVICE_KERNELS_DIR} + std::string{"rv64a.elf"}})
+    {}
+
+protected:
+    void configure(sys_emu_cmd_options& cmd_options, const benchmark::State& state) override {
+        cmd_options.minions_en = (1ull << state.range(2)) - 1;
+        cmd_options.shires_en = (1ull << state.range(3)) - 1;
+    }
+};
+
+BENCHMARK_DEFINE_F(Scaling_Benchmark, BM_main_internal_harts)(benchmark::State& state) {
+    run(state);
+};
+
+BENCHMARK_REGISTER_F(Scaling_Benchmark, BM_main_internal_harts)
+    ->ArgsProduct({{false, true}, {false}, {1, 8, 32}, {1, 4}})
+    ->ArgNames({"mem_check+l1_scp_check+l2_scp_check+flb_check", "tstore_check", "minions", "shires"});
 
 }  // end anonymous namespace
 
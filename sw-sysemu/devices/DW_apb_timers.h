@@ -6,8 +6,10 @@
 #ifndef BEMU_DW_APB_TIMERS_H
 #define BEMU_DW_APB_TIMERS_H
 
+#include <algorithm>
 #include <array>
 #include <cstdint>
+#include <limits>
 #include "literals.h"
 #include "memory/memory_error.h"
 #include "memory/memory_region.h"
@@ -172,6 +174,27 @@ struct DW_apb_timers : public MemoryRegion {
         }
     }
 
+    // Ticks until the next one zeroes a timer, or the maximum value if all
+    // the timers are disabled
+    uint64_t ticks_to_event() const {
+        uint64_t ticks = std::numeric_limits<uint64_t>::max();
+        for (size_type i = 0; i < NUM_TIMERS; i++) {
+            if (CONTROLREG_TIMER_ENABLE_GET(controlreg[i])) {
+                ticks = std::min<uint64_t>(ticks, currentvalue[i]);
+            }
+        }
+        return ticks;
+    }
+
+    // Advances the timers by @n ticks, less than ticks_to_event()
+    void skip_ticks(uint64_t n) {
+        for (size_type i = 0; i < NUM_TIMERS; i++) {
+            if (CONTROLREG_TIMER_ENABLE_GET(controlreg[i])) {
+                currentvalue[i] -= n;
+            }
+        }
+    }
+
     void clock_tick(System& chip) {
         for (size_type i = 0; i < NUM_TIMERS; i++) {
             if (!CONTROLREG_TIMER_ENABLE_GET(controlreg[i])) {
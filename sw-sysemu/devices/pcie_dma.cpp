@@ -3,6 +3,8 @@
 * SPDX-License-Identifier: Apache-2.0
 *-------------------------------------------------------------------------*/
 
+#include <algorithm>
+#include <limits>
 #include "agent.h"
 #include "emu_gio.h"
 #include "pcie_dma.h"
@@ -68,6 +70,14 @@ void PcieDma<wrch>::go(const Agent& agent)
     // Element pointer
     uint64_t elem_ptr = (uint64_t)llp_high << 32 | llp_low;
 
+    // With the bandwidth model the channel runs its transfers one after the
+    // other, and each of them takes size / bandwidth cycles (1 cycle = 1 ns)
+    const uint64_t bandwidth = agent.chip->pcie_dma_bandwidth;
+    uint64_t cycle = 0;
+    if (bandwidth) {
+        cycle = std::max(agent.chip->emu_cycle(), busy_until) + agent.chip->pcie_dma_latency;
+    }
+
     // TODO: Check dma_{read/write}_engine_en, check handshake mode, check linked-list mode (LLE)
 
     do {
@@ -112,7 +122,7 @@ void PcieDma<wrch>::go(const Agent& agent)
             // Trigger interrupt if it was pending
             if (liep) {
                 liep = false; // Clear LIEP
-                trigger_done_int(agent);
+                raise_done_int(agent, cycle);
             }
 
             // Transfer block of data
@@ -121,6 +131,9 @@ void PcieDma<wrch>::go(const Agent& agent)
             } else {
                 agent.chip->copy_memory_from_host_to_device(de.sar, de.dar, de.size);
             }
+            if (bandwidth) {
+                cycle += (uint64_t(de.size) * 1000 + bandwidth - 1) / bandwidth;
+            }
 
             // Local interrupt
             if (de.ctrl.B.LIE) {
@@ -137,15 +150,44 @@ dma_done:
         // Trigger interrupt if it was pending
         if (liep) {
             liep = false; // Clear LIEP
-            trigger_done_int(agent);
+            raise_done_int(agent, cycle);
         }
         // Terminate the complete DMA process
         break;
     } while (1);
 
+    busy_until = cycle;
+
     LOG_AGENT(DEBUG, agent, "PcieDma%d<%s>::go() FINISHED", chan_id, wrch ? "Write" : "Read");
 }
 
+template<bool wrch>
+void PcieDma<wrch>::raise_done_int(const Agent& agent, uint64_t cycle)
+{
+    if (!agent.chip->pcie_dma_bandwidth) {
+        trigger_done_int(agent);
+        return;
+    }
+    LOG_AGENT(DEBUG, agent, "PcieDma%d<%s>::raise_done_int() at cycle %" PRIu64,
+              chan_id, wrch ? "Write" : "Read", cycle);
+    done_int_cycles.push_back(cycle);
+    agent.chip->pcie_dma_next_event = std::min(agent.chip->pcie_dma_next_event, cycle);
+}
+
+template<bool wrch>
+uint64_t PcieDma<wrch>::tick(const Agent& agent, uint64_t cycle)
+{
+    // The interrupt status is a bit per channel, so the interrupts due
+    // together are raised once
+    if (!done_int_cycles.empty() && (done_int_cycles.front() <= cycle)) {
+        while (!done_int_cycles.empty() && (done_int_cycles.front() <= cycle)) {
+            done_int_cycles.pop_front();
+        }
+        trigger_done_int(agent);
+    }
+    return done_int_cycles.empty() ? std::numeric_limits<uint64_t>::max() : done_int_cycles.front();
+}
+
 template<bool wrch>
 void PcieDma<wrch>::trigger_done_int(const Agent& agent)
 {
@@ -8,6 +8,7 @@
 
 #include <array>
 #include <cstdint>
+#include <deque>
 #include "agent.h"
 #include "emu_defines.h"
 
@@ -17,6 +18,10 @@ template<bool wrch>
 struct PcieDma {
     void go(const Agent& agent);
 
+    // Raises the done interrupts delayed by the bandwidth model that are due
+    // at @cycle, and returns the cycle of the next one (or the maximum value)
+    uint64_t tick(const Agent& agent, uint64_t cycle);
+
     int chan_id;
     uint32_t ch_control1 = 0;
     uint32_t llp_low = 0;
@@ -25,8 +30,14 @@ struct PcieDma {
 
 private:
     void trigger_done_int(const Agent& agent);
+    void raise_done_int(const Agent& agent, uint64_t cycle);
 
     bool liep = false;
+
+    // Bandwidth model: cycle at which the last transfer list finishes, and
+    // cycles of the done interrupts not raised yet
+    uint64_t busy_until = 0;
+    std::deque<uint64_t> done_int_cycles;
 };
 
 } // namespace bemu
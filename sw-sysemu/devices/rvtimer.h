@@ -57,6 +57,19 @@ struct RVTimer
         }
     }
 
+    // Ticks until the next one raises the interrupt, or the maximum value
+    // if no tick will
+    uint64_t ticks_to_event() const {
+        if (!is_active() || interrupt)
+            return std::numeric_limits<uint64_t>::max();
+        return (mtime >= mtimecmp) ? 1 : mtimecmp - mtime;
+    }
+
+    // Advances the timer by @n ticks, less than ticks_to_event()
+    void skip_ticks(uint64_t n) {
+        mtime += n;
+    }
+
     void clock_tick(const Agent& agent)
     {
         if (++mtime >= mtimecmp) {
@@ -54,6 +54,8 @@ struct SysregsEr : public MemoryRegion {
     void dump_data(const Agent&, std::ostream&, size_type, size_type) const override { }
 
     void wdt_clock_tick(const Agent& agent, uint64_t cycle);
+    uint64_t wdt_cycles_to_event(uint64_t cycle) const { return watchdog.cycles_to_event(cycle); }
+    void wdt_skip_cycles(uint64_t cycle, uint64_t n) { watchdog.skip_cycles(cycle, n); }
 
 private:
 
@@ -8,6 +8,7 @@
 
 #include <cstdint>
 #include "agent.h"
+#include "utility.h"
 
 namespace bemu {
 
@@ -68,6 +69,22 @@ public:
         }
     }
     
+    // Cycles from @cycle before the tick that times out, or the maximum
+    // value if the watchdog is stopped
+    uint64_t cycles_to_event(uint64_t cycle) const {
+        if (!enabled || (current_value == 0)) {
+            return std::numeric_limits<uint64_t>::max();
+        }
+        return cycles_before_tick(cycle, ClockDivider, current_value);
+    }
+
+    // Advances the watchdog over @n cycles from @cycle, less than cycles_to_event()
+    void skip_cycles(uint64_t cycle, uint64_t n) {
+        if (enabled && (current_value > 0)) {
+            current_value -= ticks_in_cycles(cycle, ClockDivider, n);
+        }
+    }
+
     uint32_t get_current_value() const { return current_value; }
     
     uint32_t get_count_from() const { return count_from; }
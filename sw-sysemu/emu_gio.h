@@ -23,11 +23,20 @@
     (hart).chip->log_thread[bemu::hart_index(hart)]
 #endif
 
+// Lowest severity compiled in: fast builds drop the debug messages, so
+// that instruction handlers do not even check the log level for them
+#ifdef SYSEMU_FAST
+#define LOG_MIN_SEVERITY LOG_INFO
+#else
+#define LOG_MIN_SEVERITY LOG_DEBUG
+#endif
+
 //! Log for a given hart, if enabled.
 #define LOG_HART(severity, hart, format, ...)                           \
     do {                                                                \
         assert((hart).chip);                                            \
-        if (LOG_##severity >= (hart).chip->log.getLogLevel()            \
+        if (LOG_##severity >= LOG_MIN_SEVERITY                          \
+            && LOG_##severity >= (hart).chip->log.getLogLevel()         \
             && HART_LOG_EN(hart))                                       \
             bemu::lprintf(LOG_##severity, (hart), format, __VA_ARGS__); \
     } while (0)
@@ -36,7 +45,8 @@
 #define LOG_AGENT(severity, agent, format, ...)                          \
     do {                                                                 \
         assert((agent).chip);                                            \
-        if (LOG_##severity >= (agent).chip->log.getLogLevel())           \
+        if (LOG_##severity >= LOG_MIN_SEVERITY                           \
+            && LOG_##severity >= (agent).chip->log.getLogLevel())        \
             bemu::lprintf(LOG_##severity, (agent), format, __VA_ARGS__); \
     } while (0)
 
@@ -0,0 +1,46 @@
+/*-------------------------------------------------------------------------
+* Copyright (c) 2025 Ainekko, Co.
+* SPDX-License-Identifier: Apache-2.0
+*-------------------------------------------------------------------------*/
+
+#include "f32_host.h"
+
+
+// Same as f32_add() but computed with the host FPU when the result is known
+// to be identical, under the conditions of f32_mulAdd_host()
+float32_t f32_add_host(float32_t a, float32_t b)
+{
+    const uint32_t uiA = fpu::UI32(a);
+    const uint32_t uiB = fpu::UI32(b);
+    if ((softfloat_roundingMode == softfloat_round_near_even)
+        && isZeroOrNormalF32UI(uiA) && isZeroOrNormalF32UI(uiB))
+    {
+        const float fa = fpu::FLT(uiA);
+        const float fb = fpu::FLT(uiB);
+        const float fz = fa + fb;
+        const uint32_t uiZ = fpu::UI32(fpu::F2F32(fz));
+        // a+b is exactly z+e (two-sum) when z does not overflow
+        const float bp = fz - fa;
+        const float e = (fa - (fz - bp)) + (fb - bp);
+        const bool inexact = (e != 0.0f);
+        if (isSafeResultF32UI(uiZ, inexact)) {
+            checkHostF32(uiZ, inexact, [&] { return f32_add(a, b); },
+                         "f32_add_host() does not match f32_add()");
+            if (inexact)
+                softfloat_raiseFlags(softfloat_flag_inexact);
+            return fpu::F2F32(fz);
+        }
+    }
+    return f32_add(a, b);
+}
+
+
+// a-b is a+(-b) also for softfloat: the sign of an exact zero follows the
+// rounding mode, and NaNs never get here
+float32_t f32_sub_host(float32_t a, float32_t b)
+{
+    const uint32_t uiB = fpu::UI32(b);
+    if ((softfloat_roundingMode == softfloat_round_near_even) && isZeroOrNormalF32UI(uiB))
+        return f32_add_host(a, fpu::F2F32(fpu::FLT(uiB ^ 0x80000000)));
+    return f32_sub(a, b);
+}
@@ -0,0 +1,60 @@
+/*-------------------------------------------------------------------------
+* Copyright (c) 2025 Ainekko, Co.
+* SPDX-License-Identifier: Apache-2.0
+*-------------------------------------------------------------------------*/
+
+#ifndef BEMU_FPU_F32_HOST_H
+#define BEMU_FPU_F32_HOST_H
+
+// Helpers of the host FPU fast paths (f32_*_host), which compute with the
+// host FPU whatever softfloat would compute identically
+
+#include <cstdint>
+#ifdef HOST_FMA_CHECK
+#include <stdexcept>
+#endif
+#include "fpu.h"
+#include "fpu_casts.h"
+#include "softfloat/platform.h"
+#include "softfloat/internals.h"
+
+
+// Zero or normal: neither softfloat's denormals-to-zero nor NaN
+// propagation apply to them
+static inline bool isZeroOrNormalF32UI(uint32_t ui)
+{
+    return (expF32UI(ui) != 0xFF) && ((expF32UI(ui) != 0) || !fracF32UI(ui));
+}
+
+
+// A normal result at least twice the smallest normal, so tininess and
+// flushing to zero never come into play, or an exact zero
+static inline bool isSafeResultF32UI(uint32_t ui, bool inexact)
+{
+    return ((expF32UI(ui) >= 2) && (expF32UI(ui) != 0xFF)) || (!(ui << 1) && !inexact);
+}
+
+
+// With HOST_FMA_CHECK compare the fast path result against softfloat's,
+// without touching the accumulated exception flags
+template<typename Softfloat>
+static inline void checkHostF32(uint32_t uiZ, bool inexact, Softfloat softfloat, const char* what)
+{
+#ifdef HOST_FMA_CHECK
+    const uint_fast8_t flags = softfloat_exceptionFlags;
+    softfloat_exceptionFlags = 0;
+    const float32_t z = softfloat();
+    const bool mismatch = (fpu::UI32(z) != uiZ)
+        || (softfloat_exceptionFlags != (inexact ? softfloat_flag_inexact : 0));
+    softfloat_exceptionFlags = flags;
+    if (mismatch)
+        throw std::logic_error(what);
+#else
+    (void) uiZ;
+    (void) inexact;
+    (void) softfloat;
+    (void) what;
+#endif
+}
+
+#endif // BEMU_FPU_F32_HOST_H
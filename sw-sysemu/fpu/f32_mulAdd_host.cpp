@@ -0,0 +1,43 @@
+/*-------------------------------------------------------------------------
+* Copyright (c) 2025 Ainekko, Co.
+* SPDX-License-Identifier: Apache-2.0
+*-------------------------------------------------------------------------*/
+
+#include <cmath>
+#include "f32_host.h"
+
+
+// Same as f32_mulAdd() but computed with the host FPU when the result is
+// known to be identical: round to nearest even, zero or normal operands and
+// a safe result (see isSafeResultF32UI), so inexact is the only possible
+// exception. Everything else goes to softfloat.
+float32_t f32_mulAdd_host(float32_t a, float32_t b, float32_t c)
+{
+    const uint32_t uiA = fpu::UI32(a);
+    const uint32_t uiB = fpu::UI32(b);
+    const uint32_t uiC = fpu::UI32(c);
+    if ((softfloat_roundingMode == softfloat_round_near_even)
+        && isZeroOrNormalF32UI(uiA) && isZeroOrNormalF32UI(uiB) && isZeroOrNormalF32UI(uiC))
+    {
+        const float fa = fpu::FLT(uiA);
+        const float fb = fpu::FLT(uiB);
+        const float fc = fpu::FLT(uiC);
+        const float fz = std::fma(fa, fb, fc);
+        const uint32_t uiZ = fpu::UI32(fpu::F2F32(fz));
+        // The product is exact in double precision, and a*b+c is exactly
+        // s+e (two-sum), so the result is exact iff it is equal to both
+        const double p = double(fa) * double(fb);
+        const double s = p + double(fc);
+        const double bp = s - p;
+        const double e = (p - (s - bp)) + (double(fc) - bp);
+        const bool inexact = (s != double(fz)) || (e != 0.0);
+        if (isSafeResultF32UI(uiZ, inexact)) {
+            checkHostF32(uiZ, inexact, [&] { return f32_mulAdd(a, b, c); },
+                         "f32_mulAdd_host() does not match f32_mulAdd()");
+            if (inexact)
+                softfloat_raiseFlags(softfloat_flag_inexact);
+            return fpu::F2F32(fz);
+        }
+    }
+    return f32_mulAdd(a, b, c);
+}
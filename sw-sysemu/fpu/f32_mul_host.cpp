@@ -0,0 +1,33 @@
+/*-------------------------------------------------------------------------
+* Copyright (c) 2025 Ainekko, Co.
+* SPDX-License-Identifier: Apache-2.0
+*-------------------------------------------------------------------------*/
+
+#include "f32_host.h"
+
+
+// Same as f32_mul() but computed with the host FPU when the result is known
+// to be identical, under the conditions of f32_mulAdd_host()
+float32_t f32_mul_host(float32_t a, float32_t b)
+{
+    const uint32_t uiA = fpu::UI32(a);
+    const uint32_t uiB = fpu::UI32(b);
+    if ((softfloat_roundingMode == softfloat_round_near_even)
+        && isZeroOrNormalF32UI(uiA) && isZeroOrNormalF32UI(uiB))
+    {
+        const float fa = fpu::FLT(uiA);
+        const float fb = fpu::FLT(uiB);
+        const float fz = fa * fb;
+        const uint32_t uiZ = fpu::UI32(fpu::F2F32(fz));
+        // The product is exact in double precision
+        const bool inexact = (double(fa) * double(fb) != double(fz));
+        if (isSafeResultF32UI(uiZ, inexact)) {
+            checkHostF32(uiZ, inexact, [&] { return f32_mul(a, b); },
+                         "f32_mul_host() does not match f32_mul()");
+            if (inexact)
+                softfloat_raiseFlags(softfloat_flag_inexact);
+            return fpu::F2F32(fz);
+        }
+    }
+    return f32_mul(a, b);
+}
@@ -44,6 +44,11 @@ extern "C" float32_t f32_mulSub(float32_t, float32_t, float32_t);
 extern "C" float32_t f32_subMulAdd(float32_t, float32_t, float32_t);
 extern "C" float32_t f32_subMulSub(float32_t, float32_t, float32_t);
 
+float32_t f32_add_host(float32_t, float32_t);
+float32_t f32_sub_host(float32_t, float32_t);
+float32_t f32_mul_host(float32_t, float32_t);
+float32_t f32_mulAdd_host(float32_t, float32_t, float32_t);
+
 float32_t f1632_mulAdd2(float16_t, float16_t, float16_t, float16_t);
 float32_t f1632_mulAdd3(float16_t, float16_t, float16_t, float16_t, float32_t);
 
@@ -56,6 +61,7 @@ namespace fpu {
 
 
 using ::f32_add;
+using ::f32_add_host;
 using ::f32_classify;
 using ::f32_copySign;
 using ::f32_copySignNot;
@@ -69,10 +75,13 @@ using ::f32_maximumNumber;
 using ::f32_minNum;
 using ::f32_minimumNumber;
 using ::f32_mul;
+using ::f32_mul_host;
 using ::f32_mulAdd;
+using ::f32_mulAdd_host;
 using ::f32_mulSub;
 using ::f32_sqrt;
 using ::f32_sub;
+using ::f32_sub_host;
 using ::f32_subMulAdd;
 using ::f32_subMulSub;
 using ::i32_to_f32;
@@ -3,6 +3,7 @@
 
 fpu_hdrs := \
 	fpu/debug.h \
+	fpu/f32_host.h \
 	fpu/fpu.h \
 	fpu/fpu_casts.h \
 	fpu/fpu_types.h \
@@ -16,10 +17,13 @@ fpu_cpp_srcs := \
 	fpu/cvt.cpp \
 	fpu/f10_to_f32.cpp \
 	fpu/f11_to_f32.cpp \
+	fpu/f32_add_host.cpp \
 	fpu/f32_cubeFaceIdx.cpp \
 	fpu/f32_cubeFaceSignS.cpp \
 	fpu/f32_cubeFaceSignT.cpp \
 	fpu/f32_frac.cpp \
+	fpu/f32_mul_host.cpp \
+	fpu/f32_mulAdd_host.cpp \
 	fpu/f32_to_f10.cpp \
 	fpu/f32_to_f11.cpp \
 	fpu/f32_to_fxp1714.cpp \
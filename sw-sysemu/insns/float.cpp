@@ -23,7 +23,7 @@ void insn_fadd_s(Hart& cpu)
     require_fp_active();
     DISASM_FD_FS1_FS2_RM("fadd.s");
     set_rounding_mode(cpu, RM);
-    WRITE_FD( fpu::f32_add(FS1.f32[0], FS2.f32[0]) );
+    WRITE_FD( fpu::f32_add_host(FS1.f32[0], FS2.f32[0]) );
     set_fp_exceptions(cpu);
 }
 
@@ -31,7 +31,7 @@ void insn_fadd_s(Hart& cpu)
 void insn_fdiv_s(Hart& cpu)
 {
     DISASM_FD_FS1_FS2_RM("fdiv.s");
-    throw trap_mcode_instruction(cpu.inst.bits);
+    cpu.signal_trap(trap_mcode_instruction(cpu.inst.bits));
 }
 
 
@@ -40,7 +40,7 @@ void insn_fmadd_s(Hart& cpu)
     require_fp_active();
     DISASM_FD_FS1_FS2_FS3_RM("fmadd.s");
     set_rounding_mode(cpu, RM);
-    WRITE_FD( fpu::f32_mulAdd(FS1.f32[0], FS2.f32[0], FS3.f32[0]) );
+    WRITE_FD( fpu::f32_mulAdd_host(FS1.f32[0], FS2.f32[0], FS3.f32[0]) );
     set_fp_exceptions(cpu);
 }
 
@@ -78,7 +78,7 @@ void insn_fmul_s(Hart& cpu)
     require_fp_active();
     DISASM_FD_FS1_FS2_RM("fmul.s");
     set_rounding_mode(cpu, RM);
-    WRITE_FD( fpu::f32_mul(FS1.f32[0], FS2.f32[0]) );
+    WRITE_FD( fpu::f32_mul_host(FS1.f32[0], FS2.f32[0]) );
     set_fp_exceptions(cpu);
 }
 
@@ -106,7 +106,7 @@ void insn_fnmsub_s(Hart& cpu)
 void insn_fsqrt_s(Hart& cpu)
 {
     DISASM_FD_FS1_RM("fsqrt.s");
-    throw trap_mcode_instruction(cpu.inst.bits);
+    cpu.signal_trap(trap_mcode_instruction(cpu.inst.bits));
 }
 
 
@@ -115,7 +115,7 @@ void insn_fsub_s(Hart& cpu)
     require_fp_active();
     DISASM_FD_FS1_FS2_RM("fsub.s");
     set_rounding_mode(cpu, RM);
-    WRITE_FD( fpu::f32_sub(FS1.f32[0], FS2.f32[0]) );
+    WRITE_FD( fpu::f32_sub_host(FS1.f32[0], FS2.f32[0]) );
     set_fp_exceptions(cpu);
 }
 
@@ -123,14 +123,14 @@ void insn_fsub_s(Hart& cpu)
 void insn_fcvt_l_s(Hart& cpu)
 {
     DISASM_RD_FS1_RM("fcvt.l.s");
-    throw trap_mcode_instruction(cpu.inst.bits);
+    cpu.signal_trap(trap_mcode_instruction(cpu.inst.bits));
 }
 
 
 void insn_fcvt_lu_s(Hart& cpu)
 {
     DISASM_RD_FS1_RM("fcvt.lu.s");
-    throw trap_mcode_instruction(cpu.inst.bits);
+    cpu.signal_trap(trap_mcode_instruction(cpu.inst.bits));
 }
 
 
@@ -159,14 +159,14 @@ void insn_fcvt_wu_s(Hart& cpu)
 void insn_fcvt_s_l(Hart& cpu)
 {
     DISASM_FD_RS1_RM("fcvt.s.l");
-    throw trap_mcode_instruction(cpu.inst.bits);
+    cpu.signal_trap(trap_mcode_instruction(cpu.inst.bits));
 }
 
 
 void insn_fcvt_s_lu(Hart& cpu)
 {
     DISASM_FD_RS1_RM("fcvt.s.lu");
-    throw trap_mcode_instruction(cpu.inst.bits);
+    cpu.signal_trap(trap_mcode_instruction(cpu.inst.bits));
 }
 
 
@@ -70,14 +70,14 @@ void insn_fbci_pi(Hart& cpu)
 void insn_fdiv_pi(Hart& cpu)
 {
     DISASM_FD_FS1_FS2("fdiv.pi");
-    throw trap_mcode_instruction(cpu.inst.bits);
+    cpu.signal_trap(trap_mcode_instruction(cpu.inst.bits));
 }
 
 
 void insn_fdivu_pi(Hart& cpu)
 {
     DISASM_FD_FS1_FS2("fdivu.pi");
-    throw trap_mcode_instruction(cpu.inst.bits);
+    cpu.signal_trap(trap_mcode_instruction(cpu.inst.bits));
 }
 
 
@@ -218,14 +218,14 @@ void insn_fpackreph_pi(Hart& cpu)
 void insn_frem_pi(Hart& cpu)
 {
     DISASM_FD_FS1_FS2("frem.pi");
-    throw trap_mcode_instruction(cpu.inst.bits);
+    cpu.signal_trap(trap_mcode_instruction(cpu.inst.bits));
 }
 
 
 void insn_fremu_pi(Hart& cpu)
 {
     DISASM_FD_FS1_FS2("fremu.pi");
-    throw trap_mcode_instruction(cpu.inst.bits);
+    cpu.signal_trap(trap_mcode_instruction(cpu.inst.bits));
 }
 
 
@@ -23,7 +23,7 @@ void insn_fadd_ps(Hart& cpu)
     require_fp_active();
     DISASM_FD_FS1_FS2_RM("fadd.ps");
     set_rounding_mode(cpu, RM);
-    WRITE_VD( fpu::f32_add(FS1.f32[e], FS2.f32[e]) );
+    WRITE_VD( fpu::f32_add_host(FS1.f32[e], FS2.f32[e]) );
     set_fp_exceptions(cpu);
 }
 
@@ -131,7 +131,7 @@ void insn_fcvt_pwu_ps(Hart& cpu)
 void insn_fdiv_ps(Hart& cpu)
 {
     DISASM_FD_FS1_FS2_RM("fdiv.ps");
-    throw trap_mcode_instruction(cpu.inst.bits);
+    cpu.signal_trap(trap_mcode_instruction(cpu.inst.bits));
 }
 
 
@@ -203,7 +203,7 @@ void insn_fmadd_ps(Hart& cpu)
     require_fp_active();
     DISASM_FD_FS1_FS2_FS3_RM("fmadd.ps");
     set_rounding_mode(cpu, RM);
-    WRITE_VD( fpu::f32_mulAdd(FS1.f32[e], FS2.f32[e], FS3.f32[e]) );
+    WRITE_VD( fpu::f32_mulAdd_host(FS1.f32[e], FS2.f32[e], FS3.f32[e]) );
     set_fp_exceptions(cpu);
 }
 
@@ -241,7 +241,7 @@ void insn_fmul_ps(Hart& cpu)
     require_fp_active();
     DISASM_FD_FS1_FS2_RM("fmul.ps");
     set_rounding_mode(cpu, RM);
-    WRITE_VD( fpu::f32_mul(FS1.f32[e], FS2.f32[e]) );
+    WRITE_VD( fpu::f32_mul_host(FS1.f32[e], FS2.f32[e]) );
     set_fp_exceptions(cpu);
 }
 
@@ -319,7 +319,7 @@ void insn_fsgnjx_ps(Hart& cpu)
 void insn_fsqrt_ps(Hart& cpu)
 {
     DISASM_FD_FS1_RM("fsqrt.ps");
-    throw trap_mcode_instruction(cpu.inst.bits);
+    cpu.signal_trap(trap_mcode_instruction(cpu.inst.bits));
 }
 
 
@@ -328,7 +328,7 @@ void insn_fsub_ps(Hart& cpu)
     require_fp_active();
     DISASM_FD_FS1_FS2_RM("fsub.ps");
     set_rounding_mode(cpu, RM);
-    WRITE_VD( fpu::f32_sub(FS1.f32[e], FS2.f32[e]) );
+    WRITE_VD( fpu::f32_sub_host(FS1.f32[e], FS2.f32[e]) );
     set_fp_exceptions(cpu);
 }
 
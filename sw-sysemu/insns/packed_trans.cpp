@@ -124,7 +124,7 @@ void insn_frsq_ps(Hart& cpu)
     set_fp_exceptions(cpu);
 #else
     DISASM_FD_FS1("frsq.ps");
-    throw trap_mcode_instruction(cpu.inst.bits);
+    cpu.signal_trap(trap_mcode_instruction(cpu.inst.bits));
 #endif
 }
 
@@ -138,7 +138,7 @@ void insn_fsin_ps(Hart& cpu)
     set_fp_exceptions(cpu);
 #else
     DISASM_FD_FS1("fsin.ps");
-    throw trap_mcode_instruction(cpu.inst.bits);
+    cpu.signal_trap(trap_mcode_instruction(cpu.inst.bits));
 #endif
 }
 
@@ -66,9 +66,9 @@ void insn_ecall(Hart& cpu)
     DISASM_NOARG("ecall");
 
     switch (PRV) {
-    case Privilege::U: throw trap_user_ecall();
-    case Privilege::S: throw trap_supervisor_ecall();
-    case Privilege::M: throw trap_machine_ecall();
+    case Privilege::U: cpu.signal_trap(trap_user_ecall()); break;
+    case Privilege::S: cpu.signal_trap(trap_supervisor_ecall()); break;
+    case Privilege::M: cpu.signal_trap(trap_machine_ecall()); break;
     }
 }
 
@@ -81,7 +81,7 @@ void insn_mret(Hart& cpu)
         throw trap_illegal_instruction(cpu.inst.bits);
 
     // Invalidate the fetch buffer when changing VM mode or permissions
-    cpu.fetch_pc = -1;
+    cpu.invalidate_fetch();
 
     // Take mpie and mpp
     uint64_t mstatus = cpu.mstatus;
@@ -106,7 +106,10 @@ void insn_sfence_vma(Hart& cpu)
 {
     DISASM_RS1_RS2("sfence.vma");
 
-    throw trap_mcode_instruction(cpu.inst.bits);
+    // The M-code emulates it, but the software TLBs have no ASIDs or global
+    // entries to keep, so they can be flushed right away
+    cpu.core->flush_tlbs();
+    cpu.signal_trap(trap_mcode_instruction(cpu.inst.bits));
 }
 
 
@@ -120,7 +123,7 @@ void insn_sret(Hart& cpu)
         throw trap_illegal_instruction(cpu.inst.bits);
 
     // Invalidate the fetch buffer when changing VM mode or permissions
-    cpu.fetch_pc = -1;
+    cpu.invalidate_fetch();
 
     // Take spie and spp
     uint64_t spie = (mstatus >> 5) & 0x1;
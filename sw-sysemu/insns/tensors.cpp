@@ -1300,7 +1300,7 @@ static void tensor_fma32_execute(Hart& cpu)
                     if (fpu::UI32(b)==0)
                         continue;
                     float32_t c0 = FREGS[i*TFMA_REGS_PER_ROW+j/VLENW].f32[j%VLENW];
-                    float32_t c = fpu::f32_mulAdd(a, b, c0);
+                    float32_t c = fpu::f32_mulAdd_host(a, b, c0);
                     FREGS[i*TFMA_REGS_PER_ROW+j/VLENW].u32[j%VLENW] = fpu::UI32(c);
                     notify_tensor_fma_write(cpu, k, true, i*TFMA_REGS_PER_ROW+j/VLENW, j%VLENW, FREGS[i*TFMA_REGS_PER_ROW+j/VLENW].u32[j%VLENW]);
                     written[j/VLENW] = true;
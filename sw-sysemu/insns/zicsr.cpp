@@ -600,7 +600,7 @@ static uint64_t csrset(Hart& cpu, uint16_t csr, uint64_t val)
         }
         // Invalidate the fetch buffer when changing VM mode or permissions
         if ((cpu.mstatus & 0xE0000) != (val & 0xE0000)) {
-            cpu.fetch_pc = -1;
+            cpu.invalidate_fetch();
         }
         cpu.mstatus = val;
         // Return 'sstatus' view of 'mstatus'
@@ -656,6 +656,7 @@ static uint64_t csrset(Hart& cpu, uint16_t csr, uint64_t val)
         case SATP_MODE_SV39:
         case SATP_MODE_SV48:
             cpu.core->satp = val;
+            cpu.core->flush_tlbs();
             break;
         default: // reserved
             // do not write the register if attempting to set an unsupported mode
@@ -679,7 +680,7 @@ static uint64_t csrset(Hart& cpu, uint16_t csr, uint64_t val)
             val &= ~(0x3ULL << 11);
         // Invalidate the fetch buffer when changing VM mode or permissions
         if ((cpu.mstatus & 0xE0000) != (val & 0xE0000)) {
-            cpu.fetch_pc = -1;
+            cpu.invalidate_fetch();
         }
         cpu.mstatus = val;
         break;
@@ -928,6 +929,7 @@ static uint64_t csrset(Hart& cpu, uint16_t csr, uint64_t val)
             case MATP_MODE_MV39:
             case MATP_MODE_MV48:
                 cpu.core->matp = val;
+                cpu.core->flush_tlbs();
                 break;
             default: // reserved
                 // do not write the register if attempting to set an unsupported mode
@@ -951,9 +953,13 @@ static uint64_t csrset(Hart& cpu, uint16_t csr, uint64_t val)
             int first_hart = EMU_THREADS_PER_NEIGH * neigh_index(cpu);
             int last_hart = std::min(first_hart + EMU_THREADS_PER_NEIGH, EMU_NUM_THREADS);
             for (int i = first_hart; i < last_hart; ++i) {
-                cpu.chip->cpu[i].fetch_pc = -1;
+                cpu.chip->cpu[i].invalidate_fetch();
             }
         }
+        if (val & 2) {
+            // invalidate the TLBs of the core
+            cpu.core->flush_tlbs();
+        }
         break;
     case CSR_MENABLE_SHADOWS:
         val &= 1;
@@ -17,7 +17,7 @@ namespace bemu {
 void insn_fence_i(Hart& cpu)
 {
     DISASM_NOARG("fence.i");
-    throw trap_mcode_instruction(cpu.inst.bits);
+    cpu.signal_trap(trap_mcode_instruction(cpu.inst.bits));
 }
 
 
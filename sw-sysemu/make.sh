@@ -3,3 +3,9 @@ make -C bench/device_kernels TARGET=rv64f SRC=rv64f
 make -C bench/device_kernels TARGET=rv64m SRC=rv64m
 make -C bench/device_kernels TARGET=tensors SRC=tensors
 make -C bench/device_kernels TARGET=rv64d SRC=rv64d
+make -C bench/device_kernels TARGET=loop SRC=loop
+make -C bench/device_kernels TARGET=ecall SRC=ecall
+make -C bench/device_kernels TARGET=rv64a SRC=rv64a
+make -C bench/device_kernels TARGET=packed SRC=packed
+make -C bench/device_kernels TARGET=cacheops SRC=cacheops
+make -C bench/device_kernels TARGET=mem SRC=mem
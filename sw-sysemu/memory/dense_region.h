@@ -8,10 +8,13 @@
 
 #include <algorithm>
 #include <array>
+#include <istream>
+#include <ostream>
 #include "support/lazy_array.h"
 #include "memory/dump_data.h"
 #include "memory/memory_error.h"
 #include "memory/memory_region.h"
+#include "memory/shared_image.h"
 
 namespace bemu {
 
@@ -59,6 +62,40 @@ struct DenseRegion : public MemoryRegion {
         bemu::dump_data(os, storage, pos, n, agent.chip->memory_reset_value[0]);
     }
 
+    pointer host_pointer(const Agent& agent, size_type pos, size_type n) override {
+        if (!Writeable || (pos + n > N))
+            return nullptr;
+        if (storage.empty()) {
+            storage.allocate();
+            storage.fill_pattern(agent.chip->memory_reset_value, MEM_RESET_PATTERN_SIZE);
+        }
+        return &*(storage.begin() + pos);
+    }
+
+    void save(std::ostream& os) const override {
+        const char allocated = !storage.empty();
+        os.write(&allocated, 1);
+        if (allocated)
+            os.write(reinterpret_cast<const char*>(&*storage.cbegin()), N);
+    }
+
+    void restore(std::istream& is) override {
+        char allocated = 0;
+        if (!is.read(&allocated, 1) || !allocated)
+            return;
+        if (storage.empty())
+            storage.allocate();
+        is.read(reinterpret_cast<char*>(&*storage.begin()), N);
+    }
+
+    void publish(Shared_image& image) override {
+        bemu::publish(image, storage);
+    }
+
+    void adopt(const Shared_image& image, size_t& next) override {
+        bemu::adopt(image, next, storage);
+    }
+
     // For exposition only
     storage_type  storage;
 };
@@ -21,6 +21,10 @@ void MainMemory::reset()
     regions[pos++].reset(new DenseRegion<dram_base, 16_MiB>());
     // TODO:
     // regions[pos++].reset(new SysregRegion<sysreg_base, 16_MiB>());
+
+    for (auto& page : pages) {
+        page.base = page_invalid;
+    }
 }
 
 void MainMemory::wdt_clock_tick(const Agent& agent, uint64_t cycle)
@@ -29,4 +33,16 @@ void MainMemory::wdt_clock_tick(const Agent& agent, uint64_t cycle)
     ptr->wdt_clock_tick(agent, cycle);
 }
 
+uint64_t MainMemory::wdt_cycles_to_event(uint64_t cycle) const
+{
+    auto ptr = dynamic_cast<SysregsEr<erbreg_base>*>(regions[0].get());
+    return ptr->wdt_cycles_to_event(cycle);
+}
+
+void MainMemory::wdt_skip_cycles(uint64_t cycle, uint64_t n)
+{
+    auto ptr = dynamic_cast<SysregsEr<erbreg_base>*>(regions[0].get());
+    ptr->wdt_skip_cycles(cycle, n);
+}
+
 } // namespace bemu
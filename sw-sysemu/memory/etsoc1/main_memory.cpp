@@ -5,10 +5,10 @@
 
 #include "emu_defines.h"
 #include "memory/mailbox_region.h"
+#include "memory/mapped_region.h"
 #include "memory/maxion_region.h"
 #include "memory/peripheral_region.h"
 #include "memory/scratch_region.h"
-#include "memory/sparse_region.h"
 #include "memory/svcproc_region.h"
 #include "memory/sysreg_region.h"
 #ifdef SYS_EMU
@@ -30,7 +30,14 @@ void MainMemory::reset()
 #ifdef SYS_EMU
     regions[pos++].reset(new PcieRegion<pcie_base, 256_GiB>());
 #endif
-    regions[pos++].reset(new SparseRegion<dram_base, EMU_DRAM_SIZE, 16_MiB>());
+    auto dram = new MappedRegion<dram_base, EMU_DRAM_SIZE, dram_bucket_size>();
+    regions[pos++].reset(dram);
+    dram_storage = dram->storage;
+    dram_allocated = dram->allocated.data();
+
+    for (auto& page : pages) {
+        page.base = page_invalid;
+    }
 }
 
 
@@ -259,6 +266,35 @@ void MainMemory::spio_apb_timers_clock_tick(System& chip)
 }
 
 
+uint64_t MainMemory::timers_ticks_to_event() const
+{
+    auto sysreg = dynamic_cast<SysregRegion<sysreg_base, 4_GiB>*>(regions[5].get());
+    uint64_t ticks = sysreg->ioshire_pu_rvtimer.ticks_to_event();
+#ifdef SYS_EMU
+    auto pu_io = dynamic_cast<PeripheralRegion<pu_io_base, 256_MiB>*>(regions[1].get());
+    auto spio = dynamic_cast<SvcProcRegion<spio_base>*>(regions[3].get());
+    ticks = std::min(ticks, spio->sp_rvtim.rvtimer.ticks_to_event());
+    ticks = std::min(ticks, pu_io->pu_timer.ticks_to_event());
+    ticks = std::min(ticks, spio->sp_timer.ticks_to_event());
+#endif
+    return ticks;
+}
+
+
+void MainMemory::timers_skip_ticks(uint64_t ticks)
+{
+    auto sysreg = dynamic_cast<SysregRegion<sysreg_base, 4_GiB>*>(regions[5].get());
+    sysreg->ioshire_pu_rvtimer.skip_ticks(ticks);
+#ifdef SYS_EMU
+    auto pu_io = dynamic_cast<PeripheralRegion<pu_io_base, 256_MiB>*>(regions[1].get());
+    auto spio = dynamic_cast<SvcProcRegion<spio_base>*>(regions[3].get());
+    spio->sp_rvtim.rvtimer.skip_ticks(ticks);
+    pu_io->pu_timer.skip_ticks(ticks);
+    spio->sp_timer.skip_ticks(ticks);
+#endif
+}
+
+
 void MainMemory::pc_mm_mailbox_read(const Agent& agent, addr_type offset, size_type n, void* result)
 {
     read(agent, pu_mbox_base + MailboxRegion<pu_mbox_base, 512_MiB>::pu_mbox_pc_mm_pos + offset, n, result);
@@ -312,6 +348,19 @@ void MainMemory::pcie0_dbi_slv_trigger_done_int(const Agent& agent, bool wrch, i
 }
 
 
+uint64_t MainMemory::pcie_dma_tick(const Agent& agent, uint64_t cycle)
+{
+#ifdef SYS_EMU
+    auto ptr = dynamic_cast<PcieRegion<pcie_base, 256_GiB>*>(regions[6].get());
+    return ptr->dma_tick(agent, cycle);
+#else
+    (void) agent;
+    (void) cycle;
+    return std::numeric_limits<uint64_t>::max();
+#endif
+}
+
+
 #ifdef SYS_EMU
 std::array<MainMemory::pcie_iatu_info_t, ETSOC_CX_ATU_NUM_INBOUND_REGIONS>& MainMemory::pcie0_get_iatus()
 {
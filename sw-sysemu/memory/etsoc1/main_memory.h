@@ -9,12 +9,14 @@
 #include <algorithm>
 #include <array>
 #include <cstdint>
+#include <cstring>
 #include <memory>
 #include <stdexcept>
 #include "agent.h"
 #include "literals.h"
 #include "memory/memory_error.h"
 #include "memory/memory_region.h"
+#include "memory/shared_image.h"
 
 namespace bemu {
 
@@ -102,16 +104,35 @@ struct MainMemory {
         dram_base           = 0x8000000000ULL,
     };
 
+    // bucket size of the DRAM region, see MappedRegion
+    static constexpr size_type dram_bucket_size = 16_MiB;
+
     // ----- Public methods -----
 
     void reset();
 
     void read(const Agent& agent, addr_type addr, size_type n, void* result) {
+        if (const auto ptr = dram_pointer(addr, n)) {
+            std::memcpy(result, ptr, n);
+            return;
+        }
+        if (const auto ptr = page_pointer(agent, addr, n)) {
+            std::memcpy(result, ptr, n);
+            return;
+        }
         const auto elem = search(addr, n);
         elem->read(agent, addr - elem->first(), n, reinterpret_cast<pointer>(result));
     }
 
     void write(const Agent& agent, addr_type addr, size_type n, const void* source) {
+        if (const auto ptr = dram_pointer(addr, n)) {
+            std::memcpy(ptr, source, n);
+            return;
+        }
+        if (const auto ptr = page_pointer(agent, addr, n)) {
+            std::memcpy(ptr, source, n);
+            return;
+        }
         auto elem = search(addr, n);
         elem->write(agent, addr - elem->first(), n, reinterpret_cast<const_pointer>(source));
     }
@@ -121,6 +142,12 @@ struct MainMemory {
         elem->init(agent, addr - elem->first(), n, reinterpret_cast<const_pointer>(source));
     }
 
+    // Returns a pointer to the storage of @n bytes at @addr, see MemoryRegion::host_pointer()
+    pointer host_pointer(const Agent& agent, addr_type addr, size_type n) {
+        auto elem = search(addr, n);
+        return elem->host_pointer(agent, addr - elem->first(), n);
+    }
+
     addr_type first() const { return regions.front()->first(); }
     addr_type last() const { return regions.back()->last(); }
 
@@ -140,6 +167,48 @@ struct MainMemory {
         (*lo)->dump_data(agent, os, pos, addr + n - (*lo)->first() - pos);
     }
 
+    // Snapshot of the plain memory of all the regions, see MemoryRegion::save()
+    void save(std::ostream& os) const {
+        for (const auto& region : regions)
+            region->save(os);
+    }
+
+    void restore(std::istream& is) {
+        for (auto& region : regions)
+            region->restore(is);
+        for (auto& page : pages)
+            page.base = page_invalid;
+    }
+
+    // Shares the plain memory of all the regions with other systems, see
+    // MemoryRegion::publish()
+    void publish(Shared_image& image) {
+        for (auto& region : regions)
+            region->publish(image);
+        for (auto& page : pages)
+            page.base = page_invalid;
+    }
+
+    void adopt(const Shared_image& image) {
+        size_t next = 0;
+        for (auto& region : regions)
+            region->adopt(image, next);
+        if (next != image.blocks.size())
+            throw std::invalid_argument("bemu::MainMemory::adopt(): image layout mismatch");
+        for (auto& page : pages)
+            page.base = page_invalid;
+    }
+
+    // Initializes @n bytes at @addr with the file @fd from @offset, see
+    // MemoryRegion::load_file()
+    void load_file(const Agent& agent, addr_type addr, size_type n, int fd, off_t offset) {
+        auto elem = search(addr, n);
+        elem->load_file(agent, addr - elem->first(), n, fd, offset);
+        // Mapped buckets replace the storage the pages point to
+        for (auto& page : pages)
+            page.base = page_invalid;
+    }
+
     // Access the PLICs
     void pu_plic_interrupt_pending_set(const Agent&, uint32_t source);
     void pu_plic_interrupt_pending_clear(const Agent&, uint32_t source);
@@ -178,6 +247,11 @@ struct MainMemory {
     void pu_apb_timers_clock_tick(System& chip);
     void spio_apb_timers_clock_tick(System& chip);
 
+    // Ticks until one of the RISC-V or DW APB timers can raise an interrupt,
+    // and advances all of them by fewer ticks than that
+    uint64_t timers_ticks_to_event() const;
+    void timers_skip_ticks(uint64_t ticks);
+
     // Access the Mailboxes
     void pc_mm_mailbox_read(const Agent& agent, addr_type offset, size_type n, void* result);
     void pc_mm_mailbox_write(const Agent& agent, addr_type addr, size_type n, const void* source);
@@ -188,11 +262,24 @@ struct MainMemory {
     void pu_trg_pcie_mmm_int_inc(const Agent& agent);
     void pu_trg_pcie_ipi_trigger(const Agent& agent);
     void pcie0_dbi_slv_trigger_done_int(const Agent&, bool wrch, int channel);
+    // Raises the PCIe DMA done interrupts delayed until @cycle, returns the
+    // cycle of the next one (or the maximum value)
+    uint64_t pcie_dma_tick(const Agent&, uint64_t cycle);
 #ifdef SYS_EMU
     std::array<pcie_iatu_info_t, ETSOC_CX_ATU_NUM_INBOUND_REGIONS>& pcie0_get_iatus();
 #endif
 
 protected:
+    // A page of plain memory and a pointer to its storage, or nullptr if the
+    // page is not backed by plain memory
+    struct Page {
+        addr_type  base;
+        pointer    data;
+    };
+
+    static constexpr size_type page_size = 4_KiB;
+    static constexpr addr_type page_invalid = ~0ull;
+
     static inline bool above(const std::unique_ptr<MemoryRegion>& lhs, addr_type rhs) {
         return lhs->last() < rhs;
     }
@@ -206,6 +293,49 @@ protected:
         return lo->get();
     }
 
+    // Returns a pointer to the storage of @n bytes at @addr if they are in a
+    // page backed by plain memory, so the access can skip search() and the
+    // region methods. Regions with side effects return no host_pointer(), so
+    // they take the slow path.
+    pointer page_pointer(const Agent& agent, addr_type addr, size_type n) {
+        const addr_type base = addr & ~(page_size - 1);
+        if (addr + n > base + page_size)
+            return nullptr;
+        Page& page = pages[(base / page_size) % pages.size()];
+        if (page.base != base) {
+            page.base = base;
+            page.data = nullptr;
+            auto lo = std::lower_bound(regions.cbegin(), regions.cend(), base, above);
+            if ((lo != regions.cend()) && ((*lo)->first() <= base)
+                && ((*lo)->last() >= base + page_size - 1))
+            {
+                page.data = (*lo)->host_pointer(agent, base - (*lo)->first(), page_size);
+            }
+        }
+        return page.data ? page.data + (addr - base) : nullptr;
+    }
+
+    // Returns a pointer to the storage of @n bytes at @addr if they are in
+    // allocated buckets of the DRAM region, which is a single mapping, so
+    // the access is a direct offset that skips search() and the page cache
+    pointer dram_pointer(addr_type addr, size_type n) const {
+        const addr_type pos = addr - dram_base;
+        if ((pos >= EMU_DRAM_SIZE) || (n > EMU_DRAM_SIZE - pos) || (n == 0))
+            return nullptr;
+        for (size_type bucket = pos / dram_bucket_size; bucket <= (pos + n - 1) / dram_bucket_size; ++bucket) {
+            if (!dram_allocated[bucket])
+                return nullptr;
+        }
+        return dram_storage + pos;
+    }
+
+    // Direct-mapped cache of page pointers, cleared by reset()
+    std::array<Page, 4096> pages{};
+
+    // Storage and allocated buckets of the DRAM region, set by reset()
+    pointer     dram_storage = nullptr;
+    const bool* dram_allocated = nullptr;
+
     // This array must be sorted by region base address
 #ifdef SYS_EMU
     std::array<std::unique_ptr<MemoryRegion>, 8> regions{};
@@ -345,11 +345,36 @@ struct MailboxRegion : public MemoryRegion, public IMailboxInterrupts
         elem->init(agent, pos - elem->first(), n, source);
     }
 
+    pointer host_pointer(const Agent& agent, size_type pos, size_type n) override {
+        const auto elem = search(agent, pos, n);
+        return elem ? elem->host_pointer(agent, pos - elem->first(), n) : nullptr;
+    }
+
     addr_type first() const override { return Base; }
     addr_type last() const override { return Base + N - 1; }
 
     void dump_data(const Agent&, std::ostream&, size_type, size_type) const override { }
 
+    void save(std::ostream& os) const override {
+        for (const MemoryRegion* elem : plain_regions)
+            elem->save(os);
+    }
+
+    void restore(std::istream& is) override {
+        for (MemoryRegion* elem : plain_regions)
+            elem->restore(is);
+    }
+
+    void publish(Shared_image& image) override {
+        for (MemoryRegion* elem : plain_regions)
+            elem->publish(image);
+    }
+
+    void adopt(const Shared_image& image, size_t& next) override {
+        for (MemoryRegion* elem : plain_regions)
+            elem->adopt(image, next);
+    }
+
     void pcie_interrupt_counter_inc(System* system) override {
         pcie_interrupt_counter++;
         pcie_interrupt_check_trigger(system);
@@ -528,6 +553,21 @@ protected:
         &pu_trg_pcie,
     }};
 
+    // Regions backed by plain memory, see save()
+    std::array<MemoryRegion*,11> plain_regions = {{
+        &pu_sram_mm_mx,
+        &pu_mbox_mm_mx,
+        &pu_mbox_mm_sp,
+        &pu_mbox_pc_mm,
+        &pu_sram,
+        &pu_mbox_mx_sp,
+        &pu_mbox_pc_mx,
+        &pu_mbox_spare,
+        &pu_mbox_pc_sp,
+        &pu_trg_max,
+        &pu_trg_max_sp,
+    }};
+
     std::atomic<uint32_t> pcie_interrupt_counter{0};
     std::atomic<uint32_t> mm_to_sp_interrupt_reg{0};
     std::atomic<uint32_t> host_to_sp_interrupt_reg{0};
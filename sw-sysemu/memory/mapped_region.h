@@ -0,0 +1,244 @@
+/*-------------------------------------------------------------------------
+* Copyright (c) 2025 Ainekko, Co.
+* SPDX-License-Identifier: Apache-2.0
+*-------------------------------------------------------------------------*/
+
+#ifndef BEMU_MAPPED_REGION_H
+#define BEMU_MAPPED_REGION_H
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <system_error>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include "memory/memory_region.h"
+#include "memory/shared_image.h"
+
+namespace bemu {
+
+
+// Plain memory backed by a single anonymous MAP_NORESERVE mapping of the
+// whole region, so the host only commits the pages that are touched and an
+// address is a direct offset into the mapping. The region is tracked in
+// buckets of M bytes: a bucket becomes allocated when it is written (or its
+// host_pointer() is taken), and then it holds the reset pattern, which the
+// kernel zero pages provide when the pattern is all zeros. Reads of buckets
+// that were not allocated return the reset pattern without touching them.
+template <unsigned long long Base, unsigned long long N, unsigned long long M>
+struct MappedRegion : public MemoryRegion
+{
+    using addr_type     = typename MemoryRegion::addr_type;
+    using size_type     = typename MemoryRegion::size_type;
+    using value_type    = typename MemoryRegion::value_type;
+    using pointer       = typename MemoryRegion::pointer;
+    using const_pointer = typename MemoryRegion::const_pointer;
+
+    static_assert(!(Base % 64),
+                  "bemu::MappedRegion must be aligned to 64");
+    static_assert((M & (M - 1)) == 0,
+                  "bemu::MappedRegion bucket size must be a power of 2");
+    static_assert((M > 0) && !(M % 4096),
+                  "bemu::MappedRegion bucket size must be a multiple of 4KiB");
+    static_assert((N > 0) && !(N % M),
+                  "bemu::MappedRegion size must be a multiple of bucket size");
+
+    MappedRegion() {
+        void* addr = mmap(nullptr, N, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (addr == MAP_FAILED)
+            throw std::system_error(errno, std::generic_category(), "bemu::MappedRegion()");
+        storage = static_cast<pointer>(addr);
+    }
+
+    ~MappedRegion() {
+        munmap(storage, N);
+    }
+
+    MappedRegion(const MappedRegion&) = delete;
+    MappedRegion& operator=(const MappedRegion&) = delete;
+
+    void read(const Agent& agent, size_type pos, size_type n, pointer result) override {
+        size_type bucket = pos / M;
+        size_type offset = pos % M;
+        size_type count = std::min(n, M - offset);
+        n -= read_bucket(agent.chip, bucket, offset, count, result);
+        while (n > 0) {
+            result += count;
+            count = std::min(n, M);
+            n -= read_bucket(agent.chip, ++bucket, 0, count, result);
+        }
+    }
+
+    void write(const Agent& agent, size_type pos, size_type n, const_pointer source) override {
+        init(agent, pos, n, source);
+    }
+
+    void init(const Agent& agent, size_type pos, size_type n, const_pointer source) override {
+        allocate(agent.chip, pos, n);
+        std::copy_n(source, n, storage + pos);
+    }
+
+    addr_type first() const override { return Base; }
+    addr_type last() const override { return Base + N - 1; }
+
+    void dump_data(const Agent& agent, std::ostream& os, size_type pos, size_type n) const override {
+        const value_type reset = agent.chip->memory_reset_value[0];
+        while (n > 0) {
+            const size_type count = std::min(n, M - pos % M);
+            if (allocated[pos / M]) {
+                os.write(reinterpret_cast<const char*>(storage + pos), count);
+            } else {
+                for (size_type i = 0; i < count; ++i)
+                    os.write(reinterpret_cast<const char*>(&reset), 1);
+            }
+            pos += count;
+            n -= count;
+        }
+    }
+
+    // The whole region is contiguous, so any range within it has a pointer
+    pointer host_pointer(const Agent& agent, size_type pos, size_type n) override {
+        if ((pos >= N) || (n > N - pos))
+            return nullptr;
+        allocate(agent.chip, pos, n);
+        return storage + pos;
+    }
+
+    // Only the allocated buckets are saved, each one preceded by its index.
+    // The list ends with an out of range index.
+    void save(std::ostream& os) const override {
+        for (size_type bucket = 0; bucket < N/M; ++bucket) {
+            if (!allocated[bucket])
+                continue;
+            os.write(reinterpret_cast<const char*>(&bucket), sizeof(bucket));
+            os.write(reinterpret_cast<const char*>(storage + bucket * M), M);
+        }
+        const size_type end = N/M;
+        os.write(reinterpret_cast<const char*>(&end), sizeof(end));
+    }
+
+    void restore(std::istream& is) override {
+        size_type bucket;
+        while (is.read(reinterpret_cast<char*>(&bucket), sizeof(bucket)) && (bucket < N/M)) {
+            allocated[bucket] = true;
+            is.read(reinterpret_cast<char*>(storage + bucket * M), M);
+        }
+    }
+
+    // One block per bucket, unallocated buckets are not mapped
+    void publish(Shared_image& image) override {
+        for (size_type bucket = 0; bucket < N/M; ++bucket) {
+            if (!allocated[bucket]) {
+                image.blocks.push_back(-1);
+                continue;
+            }
+            const off_t offset = image.append(storage + bucket * M, M);
+            image.blocks.push_back(offset);
+            if (!map_bucket(bucket, image.fd, offset))
+                throw std::system_error(errno, std::generic_category(), "bemu::MappedRegion::publish()");
+        }
+    }
+
+    void adopt(const Shared_image& image, size_t& next) override {
+        for (size_type bucket = 0; bucket < N/M; ++bucket) {
+            if (next >= image.blocks.size())
+                throw std::out_of_range("bemu::MappedRegion::adopt()");
+            const off_t offset = image.blocks[next++];
+            if (offset < 0) {
+                if (allocated[bucket])
+                    release_bucket(bucket);
+            } else if (!map_bucket(bucket, image.fd, offset)) {
+                throw std::system_error(errno, std::generic_category(), "bemu::MappedRegion::adopt()");
+            } else {
+                allocated[bucket] = true;
+            }
+        }
+    }
+
+    // Buckets fully covered by the file are mapped copy-on-write when the
+    // file offset is page aligned, the rest is read in place
+    void load_file(const Agent& agent, size_type pos, size_type n, int fd, off_t offset) override {
+        const off_t page = sysconf(_SC_PAGESIZE);
+        while (n > 0) {
+            size_type bucket = pos / M;
+            size_type start = pos % M;
+            size_type count = std::min(n, M - start);
+            if ((count == M) && !(offset % page) && map_bucket(bucket, fd, offset)) {
+                allocated[bucket] = true;
+            } else {
+                // A failed mapping may have dropped the bucket, which the
+                // file overwrites anyway when it covers all of it
+                if (count == M)
+                    release_bucket(bucket);
+                allocate(agent.chip, pos, count);
+                read_file(fd, offset, count, storage + pos);
+            }
+            pos += count;
+            offset += count;
+            n -= count;
+        }
+    }
+
+    // Also read by MainMemory to access the allocated buckets directly
+    pointer                    storage = nullptr;
+    std::array<bool, N/M>      allocated{};
+
+protected:
+    size_type read_bucket(System* system, size_type bucket, size_type pos,
+                          size_type count, pointer result) const
+    {
+        if (!allocated[bucket]) {
+            default_value(result, count, system->memory_reset_value, pos);
+        } else {
+            std::copy_n(storage + bucket * M + pos, count, result);
+        }
+        return count;
+    }
+
+    // Allocates the buckets of the @n bytes at offset @pos, filling them
+    // with the reset pattern unless the zero pages already are
+    void allocate(System* system, size_type pos, size_type n) {
+        if (n == 0)
+            return;
+        const auto& pattern = system->memory_reset_value;
+        const bool zero = std::all_of(pattern, pattern + MEM_RESET_PATTERN_SIZE,
+                                      [](value_type v) { return v == 0; });
+        for (size_type bucket = pos / M; bucket <= (pos + n - 1) / M; ++bucket) {
+            if (allocated[bucket])
+                continue;
+            allocated[bucket] = true;
+            if (!zero) {
+                pointer data = storage + bucket * M;
+                for (size_type i = 0; i < M; ++i)
+                    data[i] = pattern[i % MEM_RESET_PATTERN_SIZE];
+            }
+        }
+    }
+
+    // Replaces the bucket with a copy-on-write mapping of the file @fd from
+    // @offset, which must be page aligned
+    bool map_bucket(size_type bucket, int fd, off_t offset) {
+        void* addr = mmap(storage + bucket * M, M, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_FIXED, fd, offset);
+        return addr != MAP_FAILED;
+    }
+
+    // Gives the pages of the bucket back to the host, leaving it unallocated
+    void release_bucket(size_type bucket) {
+        void* addr = mmap(storage + bucket * M, M, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_FIXED, -1, 0);
+        if (addr == MAP_FAILED)
+            throw std::system_error(errno, std::generic_category(), "bemu::MappedRegion::release_bucket()");
+        allocated[bucket] = false;
+    }
+};
+
+
+} // namespace bemu
+
+#endif // BEMU_MAPPED_REGION_H
@@ -6,14 +6,21 @@
 #ifndef BEMU_MEMORY_REGION_H
 #define BEMU_MEMORY_REGION_H
 
+#include <algorithm>
+#include <cerrno>
 #include <cstddef>
 #include <iosfwd>
+#include <system_error>
+#include <unistd.h>
 #include "agent.h"
 #include "emu_defines.h"
 
 namespace bemu {
 
 
+struct Shared_image;
+
+
 struct MemoryRegion
 {
     using addr_type         = unsigned long long;
@@ -43,6 +50,54 @@ struct MemoryRegion
     // Outputs region data to a stream
     virtual void dump_data(const Agent& agent, std::ostream& os, size_type pos, size_type n) const = 0;
 
+    // Returns a pointer to the storage of @n bytes starting at offset @pos,
+    // so they can be accessed without going through read() and write(), or
+    // nullptr if they are not backed by plain memory
+    virtual pointer host_pointer(const Agent&, size_type, size_type) { return nullptr; }
+
+    // Writes the plain memory backing this region to a snapshot stream;
+    // regions that only model devices write nothing
+    virtual void save(std::ostream&) const { }
+
+    // Reads back from a snapshot stream what save() wrote
+    virtual void restore(std::istream&) { }
+
+    // Moves the plain memory backing this region to @image and maps it back
+    // from there copy-on-write, so that the same region of other systems
+    // can adopt() it
+    virtual void publish(Shared_image&) { }
+
+    // Maps copy-on-write what the same region of another system published,
+    // starting from block @next of @image, and advances @next past it
+    virtual void adopt(const Shared_image&, size_t&) { }
+
+    // Initializes @n bytes starting at offset @pos with the contents of the
+    // file @fd from @offset; regions backed by plain memory may map the file
+    // copy-on-write instead of reading it
+    virtual void load_file(const Agent& agent, size_type pos, size_type n, int fd, off_t offset) {
+        value_type buf[65536];
+        while (n > 0) {
+            const size_type count = std::min(n, size_type(sizeof(buf)));
+            read_file(fd, offset, count, buf);
+            init(agent, pos, count, buf);
+            pos += count;
+            offset += count;
+            n -= count;
+        }
+    }
+
+    // Reads exactly @n bytes of the file @fd from @offset into @result
+    static void read_file(int fd, off_t offset, size_type n, pointer result) {
+        while (n > 0) {
+            const ssize_t count = pread(fd, result, n, offset);
+            if (count <= 0)
+                throw std::system_error(count ? errno : EIO, std::generic_category(), "bemu::MemoryRegion::read_file()");
+            result += count;
+            offset += count;
+            n -= count;
+        }
+    }
+
     static void default_value(pointer result, size_type n,
                               const reset_value_type& pattern, size_type offset)
     {
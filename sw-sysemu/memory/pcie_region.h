@@ -10,6 +10,7 @@
 #include <array>
 #include <cstdint>
 #include <cstring>
+#include <limits>
 #include "emu_gio.h"
 #include "literals.h"
 #include "system.h"
@@ -107,6 +108,17 @@ struct PcieRegion : public MemoryRegion {
 
     void dump_data(const Agent&, std::ostream&, size_type, size_type) const override { }
 
+    // Raises the delayed DMA done interrupts due at @cycle, and returns the
+    // cycle of the next one of any channel (or the maximum value)
+    uint64_t dma_tick(const Agent& agent, uint64_t cycle) {
+        uint64_t next = std::numeric_limits<uint64_t>::max();
+        for (auto& ch : pcie0_dma_wrch) next = std::min(next, ch.tick(agent, cycle));
+        for (auto& ch : pcie1_dma_wrch) next = std::min(next, ch.tick(agent, cycle));
+        for (auto& ch : pcie0_dma_rdch) next = std::min(next, ch.tick(agent, cycle));
+        for (auto& ch : pcie1_dma_rdch) next = std::min(next, ch.tick(agent, cycle));
+        return next;
+    }
+
     // Members
     NullRegion          <r_pcie0_slv_pos,   128_GiB>  pcie0_slv{};
     NullRegion          <r_pcie1_slv_pos,   122_GiB>  pcie1_slv{};
@@ -0,0 +1,93 @@
+/*-------------------------------------------------------------------------
+* Copyright (c) 2025 Ainekko, Co.
+* SPDX-License-Identifier: Apache-2.0
+*-------------------------------------------------------------------------*/
+
+#ifndef BEMU_SHARED_IMAGE_H
+#define BEMU_SHARED_IMAGE_H
+
+#include <cerrno>
+#include <cstddef>
+#include <stdexcept>
+#include <system_error>
+#include <vector>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include "support/lazy_array.h"
+
+namespace bemu {
+
+
+// Plain memory contents written once to an anonymous file, so that the
+// memory of other systems starting from the same images can be mapped
+// copy-on-write from it instead of being loaded again. Blocks are recorded
+// in the order the regions publish them, see MemoryRegion::publish().
+struct Shared_image
+{
+    Shared_image() {
+        fd = memfd_create("bemu_shared_image", MFD_CLOEXEC);
+        if (fd < 0)
+            throw std::system_error(errno, std::generic_category(), "bemu::Shared_image()");
+    }
+
+    ~Shared_image() {
+        close(fd);
+    }
+
+    Shared_image(const Shared_image&) = delete;
+    Shared_image& operator=(const Shared_image&) = delete;
+
+    // Writes @n bytes to a new page aligned block of the file and returns
+    // its offset
+    off_t append(const void* data, size_t n) {
+        const off_t page = sysconf(_SC_PAGESIZE);
+        const off_t offset = size;
+        const off_t end = offset + ((off_t(n) + page - 1) / page) * page;
+        if ((ftruncate(fd, end) != 0) || (pwrite(fd, data, n, offset) != ssize_t(n)))
+            throw std::system_error(errno, std::generic_category(), "bemu::Shared_image::append()");
+        size = end;
+        return offset;
+    }
+
+    int                 fd = -1;
+    off_t               size = 0;
+    std::vector<off_t>  blocks;     // offset of each block, -1 if not allocated
+};
+
+
+// Moves the contents of @block to @image and maps them back from there
+template<typename Tp, size_t N>
+inline void publish(Shared_image& image, lazy_array<Tp,N>& block)
+{
+    if (block.empty()) {
+        image.blocks.push_back(-1);
+        return;
+    }
+    const off_t offset = image.append(block.data(), sizeof(Tp) * N);
+    image.blocks.push_back(offset);
+    // On failure the block keeps its private copy
+    block.map_private(image.fd, offset);
+}
+
+
+// Maps the block @next of @image into @block and moves to the next one. A
+// block that was not allocated when published is released.
+template<typename Tp, size_t N>
+inline void adopt(const Shared_image& image, size_t& next, lazy_array<Tp,N>& block)
+{
+    if (next >= image.blocks.size())
+        throw std::out_of_range("bemu::adopt()");
+    const off_t offset = image.blocks[next++];
+    if (offset < 0) {
+        block.release();
+        return;
+    }
+    if (!block.map_private(image.fd, offset))
+        throw std::system_error(errno, std::generic_category(), "bemu::adopt()");
+}
+
+
+} // namespace bemu
+
+#endif // BEMU_SHARED_IMAGE_H
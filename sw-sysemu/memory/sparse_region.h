@@ -8,10 +8,13 @@
 
 #include <algorithm>
 #include <array>
+#include <istream>
+#include <ostream>
 #include "support/lazy_array.h"
 #include "memory/dump_data.h"
 #include "memory/memory_error.h"
 #include "memory/memory_region.h"
+#include "memory/shared_image.h"
 
 namespace bemu {
 
@@ -84,6 +87,72 @@ struct SparseRegion : public MemoryRegion
                         1 + ((pos + n - 1) % M) - offset, agent.chip->memory_reset_value[0]);
     }
 
+    pointer host_pointer(const Agent& agent, size_type pos, size_type n) override {
+        // buckets are allocated independently, only ranges within a bucket are contiguous
+        if (!Writeable || (pos + n > N) || (pos / M != (pos + n - 1) / M))
+            return nullptr;
+        auto& bucket = storage[pos / M];
+        if (bucket.empty()) {
+            bucket.allocate();
+            bucket.fill_pattern(agent.chip->memory_reset_value, MEM_RESET_PATTERN_SIZE);
+        }
+        return &*(bucket.begin() + pos % M);
+    }
+
+    // Only the allocated buckets are saved, each one preceded by its index.
+    // The list ends with an out of range index.
+    void save(std::ostream& os) const override {
+        for (size_type bucket = 0; bucket < N/M; ++bucket) {
+            if (storage[bucket].empty())
+                continue;
+            os.write(reinterpret_cast<const char*>(&bucket), sizeof(bucket));
+            os.write(reinterpret_cast<const char*>(&*storage[bucket].cbegin()), M);
+        }
+        const size_type end = N/M;
+        os.write(reinterpret_cast<const char*>(&end), sizeof(end));
+    }
+
+    void restore(std::istream& is) override {
+        size_type bucket;
+        while (is.read(reinterpret_cast<char*>(&bucket), sizeof(bucket)) && (bucket < N/M)) {
+            if (storage[bucket].empty())
+                storage[bucket].allocate();
+            is.read(reinterpret_cast<char*>(&*storage[bucket].begin()), M);
+        }
+    }
+
+    // One block per bucket, unallocated buckets are not mapped
+    void publish(Shared_image& image) override {
+        for (auto& bucket : storage)
+            bemu::publish(image, bucket);
+    }
+
+    void adopt(const Shared_image& image, size_t& next) override {
+        for (auto& bucket : storage)
+            bemu::adopt(image, next, bucket);
+    }
+
+    // Buckets fully covered by the file are mapped copy-on-write when the
+    // file offset is page aligned, the rest is read in place
+    void load_file(const Agent& agent, size_type pos, size_type n, int fd, off_t offset) override {
+        const off_t page = sysconf(_SC_PAGESIZE);
+        while (n > 0) {
+            size_type bucket = pos / M;
+            size_type start = pos % M;
+            size_type count = std::min(n, M - start);
+            if ((count < M) || (offset % page) || !storage[bucket].map_private(fd, offset)) {
+                if (storage[bucket].empty()) {
+                    storage[bucket].allocate();
+                    storage[bucket].fill_pattern(agent.chip->memory_reset_value, MEM_RESET_PATTERN_SIZE);
+                }
+                read_file(fd, offset, count, &*(storage[bucket].begin() + start));
+            }
+            pos += count;
+            offset += count;
+            n -= count;
+        }
+    }
+
     // For exposition only
     storage_type  storage;
 
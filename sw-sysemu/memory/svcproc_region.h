@@ -112,6 +112,26 @@ struct SvcProcRegion : public MemoryRegion {
 
     void dump_data(const Agent&, std::ostream&, size_type, size_type) const override { }
 
+    void save(std::ostream& os) const override {
+        sp_rom.save(os);
+        sp_sram.save(os);
+    }
+
+    void restore(std::istream& is) override {
+        sp_rom.restore(is);
+        sp_sram.restore(is);
+    }
+
+    void publish(Shared_image& image) override {
+        sp_rom.publish(image);
+        sp_sram.publish(image);
+    }
+
+    void adopt(const Shared_image& image, size_t& next) override {
+        sp_rom.adopt(image, next);
+        sp_sram.adopt(image, next);
+    }
+
     // Members
     DenseRegion   <sp_rom_base, 128_KiB, false>  sp_rom{};
     SparseRegion  <sp_sram_base, 1_MiB, 64_KiB>  sp_sram{};
@@ -147,6 +147,85 @@ static inline void check_store_breakpoint(const Hart& cpu, uint64_t addr)
 }
 
 
+// Check the permissions of a leaf PTE for an access, see vmemtranslate()
+static void check_pte_permissions(const Hart& cpu, uint64_t vaddr, mem_access_type macc,
+                                  Privilege curprv, uint8_t pte)
+{
+    // Read mstatus
+    const uint64_t mstatus = cpu.mstatus;
+    const int      mxr     = (mstatus >> MSTATUS_MXR ) & 0x1;
+    const int      sum     = (mstatus >> MSTATUS_SUM ) & 0x1;
+
+    // Read PTE fields
+    const bool pte_r = (pte >> PTE_R_OFFSET) & 0x1;
+    const bool pte_w = (pte >> PTE_W_OFFSET) & 0x1;
+    const bool pte_x = (pte >> PTE_X_OFFSET) & 0x1;
+    const bool pte_u = (pte >> PTE_U_OFFSET) & 0x1;
+    const bool pte_a = (pte >> PTE_A_OFFSET) & 0x1;
+    const bool pte_d = (pte >> PTE_D_OFFSET) & 0x1;
+
+    // Check permissions. This is different for each access type.
+    // Load accesses are permitted iff all the following are true:
+    // - the page has read permissions or the page has execute permissions and
+    //   mstatus.mxr is set
+    // - if the effective execution mode is user, then the page permits
+    //   user-mode access (U=1)
+    // - if the effective execution mode is system, then the page permits
+    //   system-mode access (U=0 or SUM=1)
+    // Store accesses are permitted iff all the following are true:
+    // - the page has write permissions
+    // - if the effective execution mode is user, then the page permits
+    //   user-mode access (U=1)
+    // - if the effective execution mode is system, then the page permits
+    //   system-mode access (U=0 or SUM=1)
+    // Instruction fetches are permitted iff all the following are true:
+    // - the page has execute permissions
+    // - if the execution mode is user, then the page permits user-mode access
+    //   (U=1)
+    // - if the execution mode is system, then the page does not permit
+    //   user-mode access (U=0)
+    switch (macc)
+    {
+    case Mem_Access_Load:
+    case Mem_Access_LoadL:
+    case Mem_Access_LoadG:
+    case Mem_Access_TxLoad:
+    case Mem_Access_TxLoadL2Scp:
+    case Mem_Access_Prefetch:
+        if (!(pte_r || (mxr && pte_x))
+            || ((curprv == Privilege::U) && !pte_u)
+            || ((curprv == Privilege::S) && pte_u && !sum))
+            throw_page_fault(vaddr, macc);
+        break;
+    case Mem_Access_Store:
+    case Mem_Access_StoreL:
+    case Mem_Access_StoreG:
+    case Mem_Access_TxStore:
+    case Mem_Access_AtomicL:
+    case Mem_Access_AtomicG:
+    case Mem_Access_CacheOp:
+        if (!pte_w
+            || ((curprv == Privilege::U) && !pte_u)
+            || ((curprv == Privilege::S) && pte_u && !sum))
+            throw_page_fault(vaddr, macc);
+        break;
+    case Mem_Access_Fetch:
+        if (!pte_x
+            || ((curprv == Privilege::U) && !pte_u)
+            || ((curprv == Privilege::S) && pte_u))
+            throw_page_fault(vaddr, macc);
+        break;
+    case Mem_Access_PTW:
+        assert(0);
+        break;
+    }
+
+    // Check if A/D bit should be updated
+    if (!pte_a || ((macc == Mem_Access_Store) && !pte_d))
+        throw_page_fault(vaddr, macc);
+}
+
+
 uint64_t vmemtranslate(const Hart& cpu, uint64_t vaddr, size_t size,
                               mem_access_type macc)
 {
@@ -154,11 +233,6 @@ uint64_t vmemtranslate(const Hart& cpu, uint64_t vaddr, size_t size,
     // operand too) to detect page split faults
     (void) size;
 
-    // Read mstatus
-    const uint64_t mstatus = cpu.mstatus;
-    const int      mxr     = (mstatus >> MSTATUS_MXR ) & 0x1;
-    const int      sum     = (mstatus >> MSTATUS_SUM ) & 0x1;
-
     // Calculate effective privilege level
     const Privilege curprv = effective_execution_mode(cpu, macc);
 
@@ -183,6 +257,18 @@ uint64_t vmemtranslate(const Hart& cpu, uint64_t vaddr, size_t size,
     throw std::runtime_error("PTW not supported, only BARE mode available");
 #endif
 
+    // Look up the software TLB. Permissions are checked on every access, so
+    // changes of privilege or mstatus need no flush. A non-canonical address
+    // always misses and faults in the page walk.
+    const uint64_t tag = ((vaddr >> PG_OFFSET_SIZE) << 1) | (curprv == Privilege::M);
+    Tlb_entry& entry = (macc == Mem_Access_Fetch)
+            ? cpu.core->itlb[(vaddr >> PG_OFFSET_SIZE) % Core::tlb_size]
+            : cpu.core->dtlb[(vaddr >> PG_OFFSET_SIZE) % Core::tlb_size];
+    if (entry.tag == tag) {
+        check_pte_permissions(cpu, vaddr, macc, curprv, entry.pte);
+        return ((entry.ppn << PG_OFFSET_SIZE) | (vaddr & PG_OFFSET_M)) & PA_M;
+    }
+
     int64_t sign = 0;
     int Num_Levels = 0;
     int PTE_top_Idx_Size = 0;
@@ -219,7 +305,7 @@ uint64_t vmemtranslate(const Hart& cpu, uint64_t vaddr, size_t size,
     // for the access type of the original access, setting tval to the
     // original virtual address.
     uint64_t pte_addr, pte;
-    bool pte_v, pte_r, pte_w, pte_x, pte_u, pte_a, pte_d;
+    bool pte_v, pte_r, pte_w, pte_x;
     int level    = Num_Levels;
     uint64_t ppn = atp_ppn;
     do {
@@ -243,9 +329,6 @@ uint64_t vmemtranslate(const Hart& cpu, uint64_t vaddr, size_t size,
         pte_r = (pte >> PTE_R_OFFSET) & 0x1;
         pte_w = (pte >> PTE_W_OFFSET) & 0x1;
         pte_x = (pte >> PTE_X_OFFSET) & 0x1;
-        pte_u = (pte >> PTE_U_OFFSET) & 0x1;
-        pte_a = (pte >> PTE_A_OFFSET) & 0x1;
-        pte_d = (pte >> PTE_D_OFFSET) & 0x1;
         // Read PPN
         ppn = (pte >> PTE_PPN_OFFSET) & PPN_M;
 
@@ -258,70 +341,12 @@ uint64_t vmemtranslate(const Hart& cpu, uint64_t vaddr, size_t size,
 
     // A leaf PTE has been found
 
-    // Check permissions. This is different for each access type.
-    // Load accesses are permitted iff all the following are true:
-    // - the page has read permissions or the page has execute permissions and
-    //   mstatus.mxr is set
-    // - if the effective execution mode is user, then the page permits
-    //   user-mode access (U=1)
-    // - if the effective execution mode is system, then the page permits
-    //   system-mode access (U=0 or SUM=1)
-    // Store accesses are permitted iff all the following are true:
-    // - the page has write permissions
-    // - if the effective execution mode is user, then the page permits
-    //   user-mode access (U=1)
-    // - if the effective execution mode is system, then the page permits
-    //   system-mode access (U=0 or SUM=1)
-    // Instruction fetches are permitted iff all the following are true:
-    // - the page has execute permissions
-    // - if the execution mode is user, then the page permits user-mode access
-    //   (U=1)
-    // - if the execution mode is system, then the page does not permit
-    //   user-mode access (U=0)
-    switch (macc)
-    {
-    case Mem_Access_Load:
-    case Mem_Access_LoadL:
-    case Mem_Access_LoadG:
-    case Mem_Access_TxLoad:
-    case Mem_Access_TxLoadL2Scp:
-    case Mem_Access_Prefetch:
-        if (!(pte_r || (mxr && pte_x))
-            || ((curprv == Privilege::U) && !pte_u)
-            || ((curprv == Privilege::S) && pte_u && !sum))
-            throw_page_fault(vaddr, macc);
-        break;
-    case Mem_Access_Store:
-    case Mem_Access_StoreL:
-    case Mem_Access_StoreG:
-    case Mem_Access_TxStore:
-    case Mem_Access_AtomicL:
-    case Mem_Access_AtomicG:
-    case Mem_Access_CacheOp:
-        if (!pte_w
-            || ((curprv == Privilege::U) && !pte_u)
-            || ((curprv == Privilege::S) && pte_u && !sum))
-            throw_page_fault(vaddr, macc);
-        break;
-    case Mem_Access_Fetch:
-        if (!pte_x
-            || ((curprv == Privilege::U) && !pte_u)
-            || ((curprv == Privilege::S) && pte_u))
-            throw_page_fault(vaddr, macc);
-        break;
-    case Mem_Access_PTW:
-        assert(0);
-        break;
-    }
+    check_pte_permissions(cpu, vaddr, macc, curprv, uint8_t(pte));
 
     // Check if it is a misaligned superpage
     if ((level > 0) && ((ppn & ((1<<(PTE_Idx_Size*level))-1)) != 0))
         throw_page_fault(vaddr, macc);
 
-    // Check if A/D bit should be updated
-    if (!pte_a || ((macc == Mem_Access_Store) && !pte_d))
-        throw_page_fault(vaddr, macc);
-
     // Obtain physical address
 
     // Copy page offset
@@ -344,6 +369,11 @@ uint64_t vmemtranslate(const Hart& cpu, uint64_t vaddr, size_t size,
     // Final physical address only uses 40 bits
     paddr &= PA_M;
     LOG_HART(DEBUG, cpu, "\tPTW: Paddr = 0x%016" PRIx64, paddr);
+
+    // Keep the translation of the 4KiB page, superpages are fractured
+    entry.tag = tag;
+    entry.ppn = paddr >> PG_OFFSET_SIZE;
+    entry.pte = uint8_t(pte);
     return paddr;
 }
 
@@ -415,6 +445,29 @@ uint32_t mmu_fetch(Hart& cpu, uint64_t vaddr)
 }
 
 
+// Reads @bytes of code at @vaddr, which must not cross a 64B boundary, and
+// returns their physical address. Unlike mmu_fetch() it does not check the
+// fetch breakpoints nor touch the fetch buffer.
+uint64_t mmu_fetch_code(const Hart& cpu, uint64_t vaddr, size_t bytes, void* data)
+{
+    try {
+        uint64_t paddr = vmemtranslate(cpu, vaddr, bytes, Mem_Access_Fetch);
+        uint64_t addr = pma_check_fetch_access(cpu, vaddr, paddr, bytes);
+        cpu.chip->memory.read(cpu, addr, bytes, data);
+        return addr;
+    }
+    catch (const trap_instruction_access_fault&) {
+        throw trap_instruction_access_fault(vaddr);
+    }
+    catch (const trap_instruction_page_fault&) {
+        throw trap_instruction_page_fault(vaddr);
+    }
+    catch (const memory_error&) {
+        throw trap_instruction_bus_error();
+    }
+}
+
+
 template<typename T>
 static T mmu_load_impl(const Hart& cpu, uint64_t eaddr, mem_access_type macc)
 {
@@ -35,15 +35,11 @@ void System::write_msg_port_data_to_scp(Hart& cpu, unsigned id, uint32_t *data,
     uint64_t base_addr = cpu.core->scp_addr[cpu.portctrl[id].scp_set][cpu.portctrl[id].scp_way];
     base_addr += cpu.portctrl[id].wr_ptr << cpu.portctrl[id].logsize;
 
-    cpu.portctrl[id].stall = false;
-    if (cpu.is_waiting(Hart::Waiting::message)) {
-        bool stall = false;
-        for (int i = 0; i < 4; ++i) {
-            stall = stall || cpu.portctrl[id].stall;
-        }
-        if (!stall) {
-            cpu.stop_waiting(Hart::Waiting::message);
-        }
+    // Only wake the hart up if it is blocked reading this port, a write to
+    // another port would just make it retry the read and block again
+    if (cpu.portctrl[id].stall) {
+        cpu.portctrl[id].stall = false;
+        cpu.stop_waiting(Hart::Waiting::message);
     }
 
     unsigned nwords = (1ULL << cpu.portctrl[id].logsize) / 4;
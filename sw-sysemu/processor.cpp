@@ -3,6 +3,8 @@
 * SPDX-License-Identifier: Apache-2.0
 *-------------------------------------------------------------------------*/
 
+#include <cstring>
+
 #include "emu_gio.h"
 #include "esrs.h"
 #include "insn.h"
@@ -1231,22 +1233,217 @@ uintptr_t decode(uint32_t bits)
 
 void Hart::execute()
 {
-    // Decode the fetched bits
-    insn_exec_funct_t exec_fn = nullptr;
-    if ((inst.bits & 0x3) == 0x3) {
-        int idx = ((inst.bits >> 2) & 0x1f);
-        exec_fn = functab32b[idx](inst.bits, inst.flags);
-        npc = sextVA(pc + 4);
+    // Decode the fetched bits, unless they were decoded the last time this
+    // PC slot was executed. The entry is tagged by the bits, so rewritten
+    // code, fence.i or a different mapping of the PC just miss.
+    trap_signalled = false;
+    Decoded& entry = decode_cache[(pc >> 1) % decode_cache_size];
+    if (entry.bits != inst.bits) {
+        if ((inst.bits & 0x3) == 0x3) {
+            int idx = ((inst.bits >> 2) & 0x1f);
+            entry.exec_fn = functab32b[idx](inst.bits, inst.flags);
+            entry.size = 4;
+        } else {
+            int idx = ((inst.bits >> 11) & 0x1c) | (inst.bits & 0x03);
+            entry.exec_fn = functab16b[idx](inst.bits, inst.flags);
+            entry.size = 2;
+        }
+        entry.bits = inst.bits;
+        entry.flags = inst.flags;
     } else {
-        int idx = ((inst.bits >> 11) & 0x1c) | (inst.bits & 0x03);
-        exec_fn = functab16b[idx](inst.bits, inst.flags);
-        npc = sextVA(pc + 2);
+        inst.flags = entry.flags;
     }
+    npc = sextVA(pc + entry.size);
+    // Checked on every execution, so minstmask/minstmatch writes need no
+    // invalidation of the decoded instruction cache
     if ((minstmask >> 32) != 0) {
-        if (((inst.bits ^ minstmatch) & uint32_t(minstmask)) == 0)
-            throw trap_mcode_instruction(inst.bits);
+        if (((inst.bits ^ minstmatch) & uint32_t(minstmask)) == 0) {
+            signal_trap(trap_mcode_instruction(inst.bits));
+            return;
+        }
+    }
+    (entry.exec_fn)(*this);
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// Translated blocks
+//
+// -----------------------------------------------------------------------------
+
+// How an instruction takes part in a translated block
+enum class Block_insn {
+    unsupported,    // goes through fetch() and execute(), ends the block before it
+    body,           // cannot change the PC but by trapping
+    last,           // control transfer, ends the block after it
+};
+
+
+// Only the scalar RV64IMFC instructions are translated. The tensor, packed,
+// atomic, CSR, fence, cache control and system instructions can change state
+// that the block does not check, so they always go through execute().
+static Block_insn block_insn_32b(uint32_t bits)
+{
+    unsigned funct3 = (bits >> 12) & 7;
+    switch ((bits >> 2) & 0x1f) {
+    case 0x00: // load
+    case 0x04: // op-imm
+    case 0x05: // auipc
+    case 0x06: // op-imm-32
+    case 0x08: // store
+    case 0x0c: // op
+    case 0x0d: // lui
+    case 0x10: // fmadd
+    case 0x11: // fmsub
+    case 0x12: // fnmsub
+    case 0x13: // fnmadd
+    case 0x14: // op-fp
+        return Block_insn::body;
+    case 0x01: // load-fp, flw but not the packed flq2
+    case 0x09: // store-fp, fsw but not the packed fsq2
+        return (funct3 == 0x2) ? Block_insn::body : Block_insn::unsupported;
+    case 0x0e: // op-32, but not the AMOs
+        return ((funct3 == 0x2) || (funct3 == 0x3)) ? Block_insn::unsupported : Block_insn::body;
+    case 0x18: // branch
+    case 0x19: // jalr
+    case 0x1b: // jal
+        return Block_insn::last;
+    default:
+        return Block_insn::unsupported;
+    }
+}
+
+
+static Block_insn block_insn_16b(uint32_t bits)
+{
+    switch (((bits >> 11) & 0x1c) | (bits & 0x03)) {
+    case 0x12: // c.jr, c.jalr and c.ebreak, but not c.mv and c.add
+        return ((bits >> 2) & 31) ? Block_insn::body : Block_insn::last;
+    case 0x15: // c.j
+    case 0x19: // c.beqz
+    case 0x1d: // c.bnez
+        return Block_insn::last;
+    default:
+        return Block_insn::body;
+    }
+}
+
+
+// Returns the translated block at the PC. The code is read again on every
+// entry, so a block whose code was rewritten or mapped elsewhere is
+// translated again; that costs one translation and one read of the window
+// instead of one fetch per instruction.
+static const Hart::Block& translate_block(Hart& cpu)
+{
+    if (cpu.block_cache.empty()) {
+        cpu.block_cache.resize(Hart::block_cache_size);
+        for (auto& entry : cpu.block_cache) {
+            entry.pc = -1;
+        }
+    }
+
+    std::array<uint8_t, Hart::block_window> code;
+    const size_t window = Hart::block_window - (cpu.pc % Hart::block_window);
+    const uint64_t paddr = mmu_fetch_code(cpu, cpu.pc, window, code.data());
+
+    Hart::Block& block = cpu.block_cache[(cpu.pc >> 1) % Hart::block_cache_size];
+    if ((block.pc == cpu.pc) && (block.paddr == paddr)
+        && (memcmp(block.code.data(), code.data(), block.bytes) == 0)) {
+        return block;
+    }
+
+    block.pc = cpu.pc;
+    block.paddr = paddr;
+    block.count = 0;
+    size_t offset = 0;
+    Block_insn kind = Block_insn::body;
+    while ((kind != Block_insn::last) && (offset + 2 <= window)) {
+        Hart::Decoded& entry = block.insns[block.count];
+        uint32_t bits = code[offset] | (uint32_t(code[offset + 1]) << 8);
+        entry.flags = 0;
+        if ((bits & 0x3) == 0x3) {
+            if (offset + 4 > window) {
+                break;
+            }
+            bits |= (uint32_t(code[offset + 2]) << 16) | (uint32_t(code[offset + 3]) << 24);
+            kind = block_insn_32b(bits);
+            if (kind == Block_insn::unsupported) {
+                break;
+            }
+            entry.exec_fn = functab32b[(bits >> 2) & 0x1f](bits, entry.flags);
+            entry.size = 4;
+        } else {
+            kind = block_insn_16b(bits);
+            entry.exec_fn = functab16b[((bits >> 11) & 0x1c) | (bits & 0x03)](bits, entry.flags);
+            entry.size = 2;
+        }
+        entry.bits = bits;
+        offset += entry.size;
+        ++block.count;
+    }
+    block.bytes = offset;
+    std::copy_n(code.begin(), offset, block.code.begin());
+    return block;
+}
+
+
+// Executes the instructions of the translated block at the PC, the first one
+// at @step, while the quantum lasts and nothing that the main loop checks
+// between instructions happens. On return @step is the step of the last
+// instruction executed, which can have signalled a trap. Instructions that
+// are not translated, and all of them while a fetch breakpoint is set, go
+// through fetch() and execute() one at a time.
+void Hart::execute_block(uint64_t& step, uint64_t last_step)
+{
+    const uint8_t retired_event = PMU_MINION_EVENT_RETIRED_INST0 + (mhartid % EMU_THREADS_PER_MINION);
+
+    if ((pc != block_pc) || break_on_fetch) {
+        block_pc = -1;
+        if (!break_on_fetch) {
+            block = &translate_block(*this);
+            block_index = 0;
+        }
+        if (break_on_fetch || (block->count == 0)) {
+            fetch();
+            execute();
+            if (!trap_signalled) {
+                notify_pmu_minion_event(retired_event);
+                advance_pc();
+            }
+            return;
+        }
+    }
+
+    for (;;) {
+        const Decoded& entry = block->insns[block_index++];
+        block_pc = -1;
+        trap_signalled = false;
+        inst.bits = entry.bits;
+        inst.flags = entry.flags;
+        npc = sextVA(pc + entry.size);
+        if ((minstmask >> 32) != 0) {
+            if (((inst.bits ^ minstmatch) & uint32_t(minstmask)) == 0) {
+                signal_trap(trap_mcode_instruction(inst.bits));
+                return;
+            }
+        }
+        (entry.exec_fn)(*this);
+        if (trap_signalled) {
+            return;
+        }
+        notify_pmu_minion_event(retired_event);
+        advance_pc();
+        if (block_index == block->count) {
+            return;
+        }
+        block_pc = pc;
+        if ((step + 1 == last_step) || !is_active() || is_halted() || is_blocked() || is_waiting()
+            || has_active_coprocessor() || (pending_interrupt() != 0)) {
+            return;
+        }
+        ++step;
     }
-    (exec_fn)(*this);
 }
 
 
@@ -1381,11 +1578,17 @@ static void trap_to_mmode(Hart& cpu, uint64_t cause, uint64_t val)
 
 
 void Hart::take_trap(const Trap& t)
+{
+    take_trap(t.cause(), t.tval());
+}
+
+
+void Hart::take_trap(uint64_t cause, uint64_t tval)
 {
     // Invalidate the fetch buffer when changing VM mode or permissions
-    fetch_pc = -1;
+    invalidate_fetch();
 
-    trap_to_mmode(*this, t.cause(), t.tval());
+    trap_to_mmode(*this, cause, tval);
 }
 
 
@@ -1511,7 +1714,7 @@ void Hart::clear_interrupt(int cause)
 //
 // -----------------------------------------------------------------------------
 
-void Hart::notify_pmu_minion_event(uint8_t event)
+void Hart::notify_pmu_minion_event(uint8_t event) const
 {
     // The first four counters count Minion-related events
     for (int i = 0; i < 4; i++) {
@@ -1818,9 +2021,20 @@ void Hart::warm_reset()
 
     // Currently executing instruction
     inst = Instruction { 0, 0 };
+    trap_signalled = false;
 
     // Fetch buffer
-    fetch_pc = -1;
+    invalidate_fetch();
+
+    // Decoded instruction cache
+    for (auto& entry : decode_cache) {
+        entry.bits = decode_cache_invalid;
+    }
+
+    // Translated blocks
+    for (auto& entry : block_cache) {
+        entry.pc = -1;
+    }
 
     // RISCV control and status registers
     scounteren = 0;
@@ -1868,6 +2082,7 @@ void Hart::warm_reset()
     // Reset core-shared state
     if (index_in_core(*this) == 0) {
         core->matp = 0;
+        core->flush_tlbs();
         core->menable_shadows = 0;
         core->excl_mode = 0;
         core->mcache_control = 0;
@@ -13,6 +13,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <sstream>
+#include <vector>
 
 #include "support/intrusive/list.h"
 #include "agent.h"
@@ -210,6 +211,22 @@ private:
 };
 
 
+//==------------------------------------------------------------------------==//
+//
+// Software TLB entry, the translation of a 4KiB page found by the page walker
+//
+//==------------------------------------------------------------------------==//
+
+struct Tlb_entry {
+    // VA[63:12] and whether the translation came from matp, in bit 0
+    uint64_t  tag;
+    // PA[39:12]
+    uint64_t  ppn;
+    // R/W/X/U/A/D bits of the leaf PTE
+    uint8_t   pte;
+};
+
+
 //==------------------------------------------------------------------------==//
 //
 // A processing core
@@ -248,6 +265,22 @@ struct Core {
     std::array<TLoad, 2>  tload_a;
     TLoad                 tload_b;
     TQueue                tqueue;
+
+    // Software TLBs, direct-mapped
+    static constexpr size_t tlb_size = 64;
+    static constexpr uint64_t tlb_invalid = ~0ull;
+
+    std::array<Tlb_entry, tlb_size>  itlb;
+    std::array<Tlb_entry, tlb_size>  dtlb;
+
+    void flush_tlbs() {
+        for (auto& entry : itlb) {
+            entry.tag = tlb_invalid;
+        }
+        for (auto& entry : dtlb) {
+            entry.tag = tlb_invalid;
+        }
+    }
 };
 
 
@@ -276,6 +309,41 @@ struct Hart : public Agent {
         std::bitset<16> oob_data;
     };
 
+    // Decoded instruction cache entry. Decoding only depends on the
+    // instruction bits, so the entry is tagged by them.
+    struct Decoded {
+        uint32_t  bits;
+        uint16_t  flags;
+        uint8_t   size;
+        void    (*exec_fn)(Hart&);
+    };
+
+    // Entries in the decoded instruction cache, indexed by PC[10:1]
+    static constexpr size_t decode_cache_size = 1024;
+
+    // Tag that cannot match any fetch: compressed instructions are
+    // fetched with the upper 16 bits clear
+    static constexpr uint32_t decode_cache_invalid = 0xFFFF0000;
+
+    // Translated block: the instructions decoded from an aligned window of
+    // code, up to the first control transfer or the first instruction that
+    // has to go through fetch() and execute(). The code bytes are kept to
+    // check that the same code is still mapped each time the block is
+    // entered.
+    static constexpr size_t block_window = 64;
+
+    struct Block {
+        uint64_t  pc;
+        uint64_t  paddr;
+        uint8_t   count;
+        uint8_t   bytes;
+        std::array<Decoded, block_window / 2>  insns;
+        std::array<uint8_t, block_window>      code;
+    };
+
+    // Translated blocks per hart, indexed by PC[5:1]
+    static constexpr size_t block_cache_size = 32;
+
     // Current thread state
     enum class State {
         nonexistent,        // Non-simulating
@@ -324,14 +392,18 @@ struct Hart : public Agent {
     void activate_breakpoints();
     void set_prv(Privilege value);
     void set_tdata1(uint64_t value);
-    void check_pending_interrupts() const;
+    uint64_t pending_interrupt() const;
     void fetch();
     void async_execute();
     void execute();
+    void execute_block(uint64_t& step, uint64_t last_step);
+    void invalidate_fetch();
+    void signal_trap(const Trap&);
     void take_trap(const Trap&);
+    void take_trap(uint64_t cause, uint64_t tval);
     void raise_interrupt(int cause, uint64_t data = 0);
     void clear_interrupt(int cause);
-    void notify_pmu_minion_event(uint8_t event);
+    void notify_pmu_minion_event(uint8_t event) const;
 
     // Program buffer
     void reset_progbuf();
@@ -389,6 +461,11 @@ struct Hart : public Agent {
     // Instruction being executed
     Instruction inst;
 
+    // Trap raised by the instruction without throwing, see signal_trap()
+    bool        trap_signalled;
+    uint64_t    signalled_cause;
+    uint64_t    signalled_tval;
+
     // Fetch buffer
     uint64_t              fetch_pc;
     std::array<char, 32>  fetch_cache;
@@ -457,6 +534,19 @@ struct Hart : public Agent {
 
     // validation1 CSR emulation needs this
     std::ostringstream uart_stream;
+
+    // Decoded instruction cache. It is kept last so that the 16KiB it
+    // takes do not sit between the PC and the CSRs and privilege that the
+    // main loop checks on every step of every active hart.
+    std::array<Decoded, decode_cache_size>  decode_cache;
+
+    // Translated blocks, only allocated once execute_block() runs. The
+    // hart resumes the block at block_pc without checking its code again,
+    // the same way it keeps using the fetch buffer.
+    std::vector<Block>  block_cache;
+    const Block*        block;
+    uint8_t             block_index;
+    uint64_t            block_pc;
 };
 
 
@@ -557,7 +647,8 @@ inline void Hart::set_tdata1(uint64_t value)
 }
 
 
-inline void Hart::check_pending_interrupts() const
+// Returns the cause of the interrupt to take, or 0 if there is none
+inline uint64_t Hart::pending_interrupt() const
 {
     // Are there any non-masked pending interrupts? If excl_mode != 0 this
     // thread is either in exclusive mode or blocked, but either way it cannot
@@ -565,7 +656,7 @@ inline void Hart::check_pending_interrupts() const
     uint_fast32_t xip = (mip | ext_seip) & mie;
 
     if (!xip || core->excl_mode) {
-        return;
+        return 0;
     }
 
     // If there are any pending interrupts for the current privilege level
@@ -580,13 +671,13 @@ inline void Hart::check_pending_interrupts() const
     switch (prv) {
     case Privilege::M:
         if (!mip || !mie) {
-            return;
+            return 0;
         }
         xip = mip;
         break;
     case Privilege::S:
         if (!mip && !sie) {
-            return;
+            return 0;
         }
         xip = mip | (sie ? sip : 0);
         break;
@@ -596,32 +687,54 @@ inline void Hart::check_pending_interrupts() const
     }
 
     if (xip & (1 << MACHINE_EXTERNAL_INTERRUPT)) {
-        throw trap_machine_external_interrupt();
+        return trap_machine_external_interrupt().cause();
     }
     if (xip & (1 << MACHINE_SOFTWARE_INTERRUPT)) {
-        throw trap_machine_software_interrupt();
+        return trap_machine_software_interrupt().cause();
     }
     if (xip & (1 << MACHINE_TIMER_INTERRUPT)) {
-        throw trap_machine_timer_interrupt();
+        return trap_machine_timer_interrupt().cause();
     }
     if (xip & (1 << SUPERVISOR_EXTERNAL_INTERRUPT)) {
-        throw trap_supervisor_external_interrupt();
+        return trap_supervisor_external_interrupt().cause();
     }
     if (xip & (1 << SUPERVISOR_SOFTWARE_INTERRUPT)) {
-        throw trap_supervisor_software_interrupt();
+        return trap_supervisor_software_interrupt().cause();
     }
     if (xip & (1 << SUPERVISOR_TIMER_INTERRUPT)) {
-        throw trap_supervisor_timer_interrupt();
+        return trap_supervisor_timer_interrupt().cause();
     }
     if (xip & (1 << BAD_IPI_REDIRECT_INTERRUPT)) {
-        throw trap_bad_ipi_redirect_interrupt();
+        return trap_bad_ipi_redirect_interrupt().cause();
     }
     if (xip & (1 << ICACHE_ECC_COUNTER_OVERFLOW_INTERRUPT)) {
-        throw trap_icache_ecc_counter_overflow_interrupt();
+        return trap_icache_ecc_counter_overflow_interrupt().cause();
     }
     if (xip & (1 << BUS_ERROR_INTERRUPT)) {
-        throw trap_bus_error_interrupt();
+        return trap_bus_error_interrupt().cause();
     }
+    return 0;
+}
+
+
+// Ends the instruction being executed with trap @t, which is taken once
+// execute() returns. The instruction must return right after, with no other
+// side effects. This is much cheaper than throwing @t for the traps that
+// some code takes all the time (ecall, instructions emulated by M-code).
+inline void Hart::signal_trap(const Trap& t)
+{
+    trap_signalled = true;
+    signalled_cause = t.cause();
+    signalled_tval = t.tval();
+}
+
+
+// Drops the fetch buffer and the translated block being run, so the next
+// instruction is fetched again
+inline void Hart::invalidate_fetch()
+{
+    fetch_pc = -1;
+    block_pc = -1;
 }
 
 
@@ -4,4 +4,8 @@ cmake --preset release -G Ninja
 
 cmake --build --preset release
 
-./build/Release/bench/bench
+./build/Release/bench/bench --benchmark_out=bench.json --benchmark_out_format=json || exit 1
+
+if [ -n "$BASELINE" ]; then
+    bench/compare.py "$BASELINE" bench.json --threshold "${THRESHOLD:-5}"
+fi
@@ -9,6 +9,8 @@
 #include <cstddef>
 #include <array>
 #include <memory>
+#include <sys/mman.h>
+#include <sys/types.h>
 
 namespace bemu {
 
@@ -16,7 +18,20 @@ namespace bemu {
 template<typename Tp, size_t N>
 struct lazy_array {
     using array_type            = std::array<Tp,N>;
-    using array_pointer         = std::unique_ptr<array_type>;
+
+    // Frees the array, or unmaps it if it was mapped with map_private()
+    struct deleter {
+        void operator()(array_type* a) const noexcept {
+            if (mapped) {
+                munmap(a, sizeof(array_type));
+            } else {
+                delete a;
+            }
+        }
+        bool mapped = false;
+    };
+
+    using array_pointer         = std::unique_ptr<array_type, deleter>;
 
     using value_type            = typename array_type::value_type;
     using reference             = typename array_type::reference;
@@ -32,6 +47,24 @@ struct lazy_array {
 
     void allocate() {
         p.reset(new array_type);
+        p.get_deleter().mapped = false;
+    }
+
+    // Frees the array, or unmaps it, leaving it empty
+    void release() noexcept {
+        p.reset();
+    }
+
+    // Replaces the array with a copy-on-write mapping of the file @fd from
+    // @offset, which must be page aligned. Returns false if it cannot be
+    // mapped, leaving the array untouched.
+    bool map_private(int fd, off_t offset) {
+        void* addr = mmap(nullptr, sizeof(array_type), PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, offset);
+        if (addr == MAP_FAILED)
+            return false;
+        p.reset(static_cast<array_type*>(addr));
+        p.get_deleter().mapped = true;
+        return true;
     }
 
     // Iterators
@@ -90,7 +123,7 @@ struct lazy_array {
 
     // Members
 
-    std::unique_ptr<array_type> p{};
+    array_pointer p{};
 };
 
 
@@ -212,6 +212,11 @@ void SysEmuImp::process() {
   }
 }
 
+void SysEmuImp::wait_for_command(std::chrono::milliseconds timeout) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  condVar_.wait_for(lock, timeout, [this]() { return !requests_.empty() || !running_; });
+}
+
 void SysEmuImp::mmioRead(uint64_t address, size_t size, std::byte* dst) {
   resume();
   std::promise<void> p;
@@ -231,6 +236,9 @@ void SysEmuImp::mmioRead(uint64_t address, size_t size, std::byte* dst) {
         break;
       }
 
+      if (recorder_) {
+        recorder_->record(api_event::Type::mem_read, chip_->emu_cycle(), device_addr, access_size);
+      }
       try {
         chip_->memory.read(agent_, device_addr, access_size, dst + host_access_offset);
       } catch (...) {
@@ -253,6 +261,7 @@ void SysEmuImp::mmioRead(uint64_t address, size_t size, std::byte* dst) {
   };
   std::unique_lock<std::mutex> lock(mutex_);
   requests_.emplace(std::move(request));
+  condVar_.notify_all();
   lock.unlock();
   p.get_future().get();
 }
@@ -273,6 +282,10 @@ void SysEmuImp::mmioWrite(uint64_t address, size_t size, const std::byte* src) {
         iatusPrint(chip_);
         break;
       }
+      if (recorder_) {
+        recorder_->record(api_event::Type::mem_write, chip_->emu_cycle(), device_addr, access_size,
+                          src + host_access_offset);
+      }
       try {
         chip_->memory.write(agent_, device_addr, access_size, src + host_access_offset);
       } catch (...) {
@@ -294,19 +307,53 @@ void SysEmuImp::mmioWrite(uint64_t address, size_t size, const std::byte* src) {
   };
   std::unique_lock<std::mutex> lock(mutex_);
   requests_.emplace(std::move(request));
+  condVar_.notify_all();
   lock.unlock();
   p.get_future().get();
 }
 
+std::byte* SysEmuImp::mapMmio(uint64_t address, size_t size) {
+  // accesses through the mapping would not be recorded
+  if (recorder_) {
+    return nullptr;
+  }
+  resume();
+  std::promise<std::byte*> p;
+  // done by the sysemu thread, as the memory could be lazily allocated
+  auto request = [=, &p]() {
+    SE_LOG(INFO) << "Device memory map at: " << std::hex << address << " size: " << size;
+    uint64_t device_addr, access_size;
+    if (!iatuTranslate(chip_, address, size, device_addr, access_size) || access_size != size) {
+      LOG_AGENT(WARN, agent_, "iATU: Could not map host address: 0x%" PRIx64 ", size: 0x%zx", address, size);
+      p.set_value(nullptr);
+      return;
+    }
+    try {
+      p.set_value(reinterpret_cast<std::byte*>(chip_->memory.host_pointer(agent_, device_addr, size)));
+    } catch (...) {
+      p.set_exception(std::current_exception());
+    }
+  };
+  std::unique_lock<std::mutex> lock(mutex_);
+  requests_.emplace(std::move(request));
+  condVar_.notify_all();
+  lock.unlock();
+  return p.get_future().get();
+}
+
 void SysEmuImp::raiseDevicePuPlicPcieMessageInterrupt() {
   resume();
   auto request = [=]() {
     SE_LOG(INFO) << "raiseDevicePuPlicPcieMessageInterrupt";
     LOG_AGENT(INFO, agent_, "raise_device_interrupt(type = %s)", "PU");
+    if (recorder_) {
+      recorder_->record(api_event::Type::pu_interrupt, chip_->emu_cycle());
+    }
     chip_->memory.pu_trg_pcie_mmm_int_inc(agent_);
   };
   std::lock_guard<std::mutex> lock(mutex_);
   requests_.emplace(std::move(request));
+  condVar_.notify_all();
 }
 
 uint32_t SysEmuImp::waitForInterrupt(uint32_t bitmap) {
@@ -336,10 +383,14 @@ void SysEmuImp::raiseDeviceSpioPlicPcieMessageInterrupt() {
   auto request = [=]() {
     SE_LOG(INFO) << "raiseDeviceSpioPlicPcieMessageInterrupt";
     LOG_AGENT(INFO, agent_, "raise_device_interrupt(type = %s)", "SP");
+    if (recorder_) {
+      recorder_->record(api_event::Type::sp_interrupt, chip_->emu_cycle());
+    }
     chip_->memory.pu_trg_pcie_ipi_trigger(agent_);
   };
   std::lock_guard<std::mutex> lock(mutex_);
   requests_.emplace(std::move(request));
+  condVar_.notify_all();
 }
 
 bool SysEmuImp::host_memory_read(uint64_t host_addr, uint64_t size, void* data) {
@@ -348,6 +399,9 @@ bool SysEmuImp::host_memory_read(uint64_t host_addr, uint64_t size, void* data)
     return false;
   }
   hostListener_->memoryReadFromHost(host_addr, size, reinterpret_cast<std::byte*>(data));
+  if (recorder_) {
+    recorder_->record(api_event::Type::host_read, chip_->emu_cycle(), host_addr, size, data);
+  }
   return true;
 }
 
@@ -360,6 +414,14 @@ bool SysEmuImp::host_memory_write(uint64_t host_addr, uint64_t size, const void*
   return true;
 }
 
+void* SysEmuImp::host_memory_map(uint64_t host_addr, uint64_t size) {
+  // the reads through the mapping would not be recorded for the replay
+  if (!hostListener_ || recorder_) {
+    return nullptr;
+  }
+  return hostListener_->mapHostMemory(host_addr, size);
+}
+
 void SysEmuImp::notify_iatu_ctrl_2_reg_write(int pcie_id, uint32_t iatu, uint32_t value) {
   LOG_AGENT(DEBUG, agent_, "notify_iatu_ctrl_2_reg_write: %d, 0x%x, 0x%x", pcie_id, iatu, value);
   // We only care about PCIE0
@@ -374,6 +436,9 @@ SysEmuImp::~SysEmuImp() {
   std::promise<void> p;
   auto request = [=, &p]() {
     try {
+      if (recorder_) {
+        recorder_->record(api_event::Type::done, chip_->emu_cycle());
+      }
       chip_->set_emu_done(true);
       p.set_value();
     } catch (...) {
@@ -442,6 +507,13 @@ SysEmuImp::SysEmuImp(const SysEmuOptions& options, const std::array<uint64_t, 8>
   opts.shires_en = options.minionShiresMask | (1ull << 34); // always enable Service Processor
   opts.max_cycles = options.maxCycles;
   opts.gdb |= options.startGdb;
+  if (!options.snapshotLoadPath.empty()) {
+    opts.snapshot_load = options.snapshotLoadPath;
+  }
+  if (!options.snapshotSavePath.empty()) {
+    opts.snapshot_save = options.snapshotSavePath;
+  }
+  opts.share_images = options.shareImages;
 
   /* Route PU UART0 output to log file */
   opts.pu_uart0_tx_file = options.puUart0Path.empty() ? options.runDir + "/" + "pu_uart0_tx.log" : options.puUart0Path;
@@ -501,6 +573,14 @@ SysEmuImp::SysEmuImp(const SysEmuOptions& options, const std::array<uint64_t, 8>
   opts.tstore_check |= options.tstoreCheck;
   opts.log_path = options.logFile;
 
+  if (!options.apiRecordPath.empty()) {
+    try {
+      recorder_ = std::make_unique<api_recorder>(options.apiRecordPath);
+    } catch (const std::exception& e) {
+      throw Exception(e.what());
+    }
+  }
+
   sysEmuThread_ = std::thread(runMain, opts, this, &sysEmuError_); // FIXME Passing `this` like this is dangerous..
 
   // Wait until all the iATUs configured by BL2 have been enabled
@@ -5,6 +5,7 @@
 
 #pragma once
 #include "api_communicate.h"
+#include "api_replay.h"
 #include "sw-sysemu/ISysEmu.h"
 #include "sys_emu.h"
 #include "system.h"
@@ -28,6 +29,7 @@ public:
   // ISysEmu interface
   void mmioRead(uint64_t address, size_t size, std::byte* dst) override;
   void mmioWrite(uint64_t address, size_t size, const std::byte* src) override;
+  std::byte* mapMmio(uint64_t address, size_t size) override;
   void raiseDevicePuPlicPcieMessageInterrupt() override;
   void raiseDeviceSpioPlicPcieMessageInterrupt() override;
   uint32_t waitForInterrupt(uint32_t bitmask) override;
@@ -39,9 +41,11 @@ public:
   // api_communicate interface
   void set_system(bemu::System* system) override;
   void process() override;
+  void wait_for_command(std::chrono::milliseconds timeout) override;
   bool raise_host_interrupt(uint32_t bitmap) override;
   bool host_memory_read(uint64_t host_addr, uint64_t size, void* data) override;
   bool host_memory_write(uint64_t host_addr, uint64_t size, const void* data) override;
+  void* host_memory_map(uint64_t host_addr, uint64_t size) override;
   void notify_iatu_ctrl_2_reg_write(int pcie_id, uint32_t iatu, uint32_t value) override;
   void notify_fatal_error(const std::string& error) override;
 
@@ -64,5 +68,6 @@ private:
   IHostListener* hostListener_ = nullptr;
   std::queue<std::function<void()>> requests_;
   std::promise<void> iatusReady_;
+  std::unique_ptr<api_recorder> recorder_;
 };
 } // namespace emu
@@ -26,6 +26,12 @@ public:
     // we provide a simple implementation of read and write functions
     virtual void memoryReadFromHost(uint64_t address, size_t size, std::byte* dst);
     virtual void memoryWriteFromHost(uint64_t address, size_t size, const std::byte* src);
+    // returns a pointer to the given range of host memory, for the device DMAs to copy from or to it directly
+    // instead of going through memoryReadFromHost/memoryWriteFromHost; nullptr (the default) if it can't be mapped.
+    // Called from the sysemu thread
+    virtual std::byte* mapHostMemory(uint64_t, size_t) {
+      return nullptr;
+    }
     virtual void onSysemuFatalError(const std::string& error);
     virtual ~IHostListener() = default;
   };
@@ -33,6 +39,11 @@ public:
   virtual uint32_t waitForInterrupt(uint32_t bitmask) = 0;
   virtual void mmioRead(uint64_t address, size_t size, std::byte* dst) = 0;
   virtual void mmioWrite(uint64_t address, size_t size, const std::byte* src) = 0;
+  // returns a host pointer to the device memory behind the given range of the BARs, so it can be accessed directly
+  // instead of through mmioRead/mmioWrite; nullptr if the range can't be mapped (ie. it's not backed by plain memory)
+  virtual std::byte* mapMmio(uint64_t, size_t) {
+    return nullptr;
+  }
   virtual void raiseDevicePuPlicPcieMessageInterrupt() = 0;
   virtual void raiseDeviceSpioPlicPcieMessageInterrupt() = 0;
   virtual void stop() = 0;
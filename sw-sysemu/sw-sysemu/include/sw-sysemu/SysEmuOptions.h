@@ -67,6 +67,16 @@ struct SysEmuOptions {
   bool tstoreCheck = true;
   /// \brief Defaults memory to this value
   uint32_t mem_reset32 = 0xDEADBEEF;
+  /// \brief Snapshot to restore before starting, skips the firmware boot (optional)
+  std::string snapshotLoadPath;
+  /// \brief File where to save a snapshot when the simulation finishes (optional)
+  std::string snapshotSavePath;
+  /// \brief Map the loaded firmware images copy-on-write from other instances in this process that loaded the
+  /// same ones, instead of keeping a private copy each
+  bool shareImages = false;
+  /// \brief File where to record the host interactions, so sys_emu -api_replay can run them again without a host
+  /// (optional)
+  std::string apiRecordPath;
   /// \brief Hyperparameters to pass to SysEmu, might override default values
   std::vector<std::string> additionalOptions;
 };
@@ -10,6 +10,7 @@
 #include <vector>
 #include <memory>
 
+#include "api_replay.h"
 #include "sys_emu.h"
 
 int main(int argc, char *argv[])
@@ -62,6 +63,16 @@ int main(int argc, char *argv[])
         return EXIT_FAILURE;
     }
 
+    if (!cmd_options.api_replay.empty()) {
+        try {
+            api_comm = std::unique_ptr<api_communicate>(new api_replayer(cmd_options.api_replay));
+        }
+        catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
     auto emu = std::make_unique<sys_emu>(cmd_options, api_comm.get());
     return emu.get()->main_internal();
 }
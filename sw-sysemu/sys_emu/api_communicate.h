@@ -6,7 +6,9 @@
 #ifndef _API_COMMUNICATE_
 #define _API_COMMUNICATE_
 
+#include <chrono>
 #include <cstdint>
+#include <limits>
 #include <string>
 
 // Forward declaration
@@ -20,9 +22,27 @@ public:
     virtual ~api_communicate() = default;
     virtual void set_system(bemu::System*) = 0;
     virtual void process(void) = 0;
+    // Blocks until there is a command to process or @timeout expires.
+    // Listeners that cannot block return at once and are just polled.
+    virtual void wait_for_command(std::chrono::milliseconds timeout) { (void) timeout; }
+    // Cycles from @cycle until the next command is due, for listeners that
+    // know it in advance; the others are waited for with wait_for_command()
+    virtual uint64_t cycles_to_command(uint64_t cycle) const {
+        (void) cycle;
+        return std::numeric_limits<uint64_t>::max();
+    }
     virtual bool raise_host_interrupt(uint32_t bitmap) = 0;
     virtual bool host_memory_read(uint64_t host_addr, uint64_t size, void *data) = 0;
     virtual bool host_memory_write(uint64_t host_addr, uint64_t size, const void *data) = 0;
+    // Returns a pointer through which the @size bytes of host memory at
+    // @host_addr can be accessed directly, so DMAs copy them to or from the
+    // device memory without going through host_memory_read/write(), or
+    // nullptr if they are not mappable
+    virtual void* host_memory_map(uint64_t host_addr, uint64_t size) {
+        (void) host_addr;
+        (void) size;
+        return nullptr;
+    }
     virtual void notify_iatu_ctrl_2_reg_write(int pcie_id, uint32_t iatu, uint32_t value) = 0;
     virtual void notify_fatal_error(const std::string& = "") = 0;
 };
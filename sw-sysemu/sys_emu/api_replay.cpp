@@ -0,0 +1,158 @@
+/*-------------------------------------------------------------------------
+* Copyright (c) 2025 Ainekko, Co.
+* SPDX-License-Identifier: Apache-2.0
+*-------------------------------------------------------------------------*/
+
+#include "api_replay.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#include "emu_gio.h"
+#include "system.h"
+
+// The file starts with a magic string, followed by one record per event:
+// type (1 byte), cycle, address and size (8 bytes each) and, for the events
+// that carry it, size bytes of data.
+static const char api_magic[8] = {'B', 'E', 'M', 'U', 'A', 'P', 'I', '1'};
+
+
+static bool has_data(api_event::Type type)
+{
+    return (type == api_event::Type::mem_write) || (type == api_event::Type::host_read);
+}
+
+
+api_recorder::api_recorder(const std::string& path)
+{
+    file.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        throw std::runtime_error("Cannot create API recording " + path);
+    }
+    file.write(api_magic, sizeof(api_magic));
+}
+
+
+void api_recorder::record(api_event::Type type, uint64_t cycle, uint64_t addr, uint64_t size, const void* data)
+{
+    file.put(static_cast<char>(type));
+    file.write(reinterpret_cast<const char*>(&cycle), sizeof(cycle));
+    file.write(reinterpret_cast<const char*>(&addr), sizeof(addr));
+    file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+    if (has_data(type)) {
+        file.write(static_cast<const char*>(data), size);
+    }
+    // A run that ends in a crash is the one worth replaying
+    file.flush();
+}
+
+
+api_replayer::api_replayer(const std::string& path)
+{
+    std::ifstream file(path, std::ios::in | std::ios::binary);
+    char magic[sizeof(api_magic)];
+    if (!file.read(magic, sizeof(magic)) || memcmp(magic, api_magic, sizeof(magic))) {
+        throw std::runtime_error("Cannot read API recording " + path);
+    }
+    char type;
+    while (file.get(type)) {
+        api_event event;
+        event.type = static_cast<api_event::Type>(type);
+        file.read(reinterpret_cast<char*>(&event.cycle), sizeof(event.cycle));
+        file.read(reinterpret_cast<char*>(&event.addr), sizeof(event.addr));
+        file.read(reinterpret_cast<char*>(&event.size), sizeof(event.size));
+        if (has_data(event.type)) {
+            event.data.resize(event.size);
+            file.read(event.data.data(), event.size);
+        }
+        if (!file) {
+            throw std::runtime_error("Truncated API recording " + path);
+        }
+        auto& queue = (event.type == api_event::Type::host_read) ? host_reads : requests;
+        queue.push_back(std::move(event));
+    }
+}
+
+
+void api_replayer::set_system(bemu::System* system)
+{
+    chip = system;
+    agent.chip = system;
+}
+
+
+void api_replayer::process()
+{
+    const uint64_t cycle = chip->emu_cycle();
+    while (!requests.empty() && (requests.front().cycle <= cycle)) {
+        const api_event& event = requests.front();
+        try {
+            switch (event.type) {
+            case api_event::Type::mem_read: {
+                // Reads can have side effects on device registers
+                std::vector<bemu::MainMemory::value_type> buffer(event.size);
+                chip->memory.read(agent, event.addr, event.size, buffer.data());
+                break;
+            }
+            case api_event::Type::mem_write:
+                chip->memory.write(agent, event.addr, event.size,
+                                   reinterpret_cast<bemu::MainMemory::const_pointer>(event.data.data()));
+                break;
+#if EMU_HAS_PU
+            case api_event::Type::pu_interrupt:
+                chip->memory.pu_trg_pcie_mmm_int_inc(agent);
+                break;
+            case api_event::Type::sp_interrupt:
+                chip->memory.pu_trg_pcie_ipi_trigger(agent);
+                break;
+#endif
+            case api_event::Type::done:
+                chip->set_emu_done(true);
+                break;
+            default:
+                LOG_AGENT(FTL, agent, "Unexpected API event %d at cycle %" PRIu64, int(event.type), event.cycle);
+                break;
+            }
+        }
+        catch (const std::exception& e) {
+            LOG_AGENT(WARN, agent, "API event %d at cycle %" PRIu64 " failed: %s", int(event.type), event.cycle,
+                      e.what());
+        }
+        requests.pop_front();
+    }
+}
+
+
+void api_replayer::wait_for_command(std::chrono::milliseconds)
+{
+    // Called when all the harts sleep with nothing scheduled; with no
+    // request left nothing will ever wake them up
+    if (requests.empty()) {
+        LOG_AGENT(INFO, agent, "%s", "API recording replayed");
+        chip->set_emu_done(true);
+    }
+}
+
+
+uint64_t api_replayer::cycles_to_command(uint64_t cycle) const
+{
+    if (requests.empty()) {
+        return std::numeric_limits<uint64_t>::max();
+    }
+    return (requests.front().cycle > cycle) ? (requests.front().cycle - cycle) : 0;
+}
+
+
+bool api_replayer::host_memory_read(uint64_t host_addr, uint64_t size, void* data)
+{
+    if (host_reads.empty() || (host_reads.front().addr != host_addr) || (host_reads.front().size != size)) {
+        LOG_AGENT(FTL, agent, "Replay diverged: unexpected host memory read at 0x%" PRIx64 ", size 0x%" PRIx64,
+                  host_addr, size);
+        return false;
+    }
+    memcpy(data, host_reads.front().data.data(), size);
+    host_reads.pop_front();
+    return true;
+}
@@ -0,0 +1,79 @@
+/*-------------------------------------------------------------------------
+* Copyright (c) 2025 Ainekko, Co.
+* SPDX-License-Identifier: Apache-2.0
+*-------------------------------------------------------------------------*/
+
+#ifndef _API_REPLAY_H_
+#define _API_REPLAY_H_
+
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "agent.h"
+#include "api_communicate.h"
+
+// Host interaction with the device, as written by api_recorder and fed back
+// by api_replayer. Device addresses are the ones after the iATU translation.
+struct api_event
+{
+    enum class Type : uint8_t {
+        mem_read,       // Host read of device memory, the data is not kept
+        mem_write,      // Host write to device memory
+        pu_interrupt,   // PU PLIC PCIe message interrupt
+        sp_interrupt,   // SPIO PLIC PCIe message interrupt
+        host_read,      // Device read of host memory, with the data returned
+        done,           // The host stopped the emulation
+    };
+
+    Type                type;
+    uint64_t            cycle;  // Emulated cycle at which it was processed
+    uint64_t            addr;
+    uint64_t            size;
+    std::vector<char>   data;
+};
+
+// Writes the host interactions of a run to a file, in the order they were
+// processed. Only the sysemu thread may call record().
+class api_recorder
+{
+public:
+    // Throws std::runtime_error if @path cannot be created
+    explicit api_recorder(const std::string& path);
+
+    void record(api_event::Type type, uint64_t cycle, uint64_t addr = 0, uint64_t size = 0,
+                const void* data = nullptr);
+
+private:
+    std::ofstream file;
+};
+
+// Runs a recording made by api_recorder with no host attached: host requests
+// are applied at the cycle they were processed in the recorded run, and
+// device reads of host memory return the recorded data.
+class api_replayer : public api_communicate
+{
+public:
+    // Throws std::runtime_error if @path cannot be read
+    explicit api_replayer(const std::string& path);
+
+    void set_system(bemu::System* system) override;
+    void process() override;
+    void wait_for_command(std::chrono::milliseconds timeout) override;
+    uint64_t cycles_to_command(uint64_t cycle) const override;
+    bool raise_host_interrupt(uint32_t) override { return true; }
+    bool host_memory_read(uint64_t host_addr, uint64_t size, void* data) override;
+    bool host_memory_write(uint64_t, uint64_t, const void*) override { return true; }
+    void notify_iatu_ctrl_2_reg_write(int, uint32_t, uint32_t) override { }
+    void notify_fatal_error(const std::string&) override { }
+
+private:
+    bemu::System*           chip = nullptr;
+    bemu::Noagent           agent{nullptr, "API-Replay"};
+    std::deque<api_event>   requests;       // Everything but host_read
+    std::deque<api_event>   host_reads;
+};
+
+#endif // _API_REPLAY_H_
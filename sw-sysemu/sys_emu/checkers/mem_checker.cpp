@@ -816,30 +816,30 @@ bool mem_checker::is_global_clean(global_directory_map_t::iterator it_global)
 }
 
 // Dumps the contents of a minion entry
-void mem_checker::dump_minion(minion_mem_info_t * minion_info, std::string func, std::string op, uint64_t addr, uint32_t shire_id, uint32_t minion_id, uint32_t thread_id)
+void mem_checker::dump_minion(minion_mem_info_t * minion_info, const char* func, const char* op, uint64_t addr, uint32_t shire_id, uint32_t minion_id, uint32_t thread_id)
 {
     uint32_t minion = shire_id * EMU_MINIONS_PER_SHIRE + minion_id;
     uint32_t adjusted_thread_id = (l1_minion_control[minion] == 0) ? 0 : thread_id;
 
     MD_LOG(addr, minion, LOG_AGENT(DEBUG, *this, "mem_checker::%s %s minion directory => addr %016llX, shire_id %i, minion_id %i, thread_id %i, mask_write: 0x%X, mask_read: 0x%X, set: 0x%X, time_stamp: [ %llu, %llu ]",
-          func.c_str(), op.c_str(), (long long unsigned int) addr, shire_id, minion_id, thread_id, (int32_t) bool_array_to_int(minion_info->thread_mask_write, EMU_THREADS_PER_MINION),
+          func, op, (long long unsigned int) addr, shire_id, minion_id, thread_id, (int32_t) bool_array_to_int(minion_info->thread_mask_write, EMU_THREADS_PER_MINION),
           (int32_t) bool_array_to_int(minion_info->thread_mask_read, EMU_THREADS_PER_MINION), minion_info->thread_set[adjusted_thread_id], (long long unsigned int) minion_info->time_stamp[0],
           (long long unsigned int) minion_info->time_stamp[1]));
 }
 
 // Dumps the contents of a shire entry
-void mem_checker::dump_shire(shire_mem_info_t * shire_info, std::string func, std::string op, uint64_t addr, uint32_t shire_id, uint32_t minion)
+void mem_checker::dump_shire(shire_mem_info_t * shire_info, const char* func, const char* op, uint64_t addr, uint32_t shire_id, uint32_t minion)
 {
     MD_LOG(addr, minion, LOG_AGENT(DEBUG, *this, "mem_checker::%s %s shire directory => addr %016llX, shire_id %i, l2: %i, l2_dirty: %i, l2_dirty_minion_id: %i, cb_dirty: %i, cb_quarter: 0x%X, minion_mask: 0x%X, time_stamp: %llu",
-          func.c_str(), op.c_str(), (long long unsigned int) addr, shire_id, shire_info->l2, shire_info->l2_dirty, shire_info->l2_dirty_minion_id,
+          func, op, (long long unsigned int) addr, shire_id, shire_info->l2, shire_info->l2_dirty, shire_info->l2_dirty_minion_id,
           shire_info->cb_dirty, (int32_t) bool_array_to_int(shire_info->cb_dirty_quarter, 4), (int32_t) bool_array_to_int(shire_info->minion_mask, 32), (long long unsigned int) shire_info->time_stamp));
 }
 
 // Dumps the contents of a global entry
-void mem_checker::dump_global(global_mem_info_t * global_info, std::string func, std::string op, uint64_t addr, uint32_t minion)
+void mem_checker::dump_global(global_mem_info_t * global_info, const char* func, const char* op, uint64_t addr, uint32_t minion)
 {
     MD_LOG(addr, minion, LOG_AGENT(DEBUG, *this, "mem_checker::%s %s global directory => addr %016llX, l2_dirty_shire_id: %i, shire_mask: 0x%llX, cb_dirty: %i, cb_quarter: 0x%X, time_stamp: %llu, latest_time_stamp: %llu",
-          func.c_str(), op.c_str(), (long long unsigned int) addr, global_info->l2_dirty_shire_id, (long long unsigned int) bool_array_to_int(global_info->shire_mask, EMU_NUM_SHIRES),
+          func, op, (long long unsigned int) addr, global_info->l2_dirty_shire_id, (long long unsigned int) bool_array_to_int(global_info->shire_mask, EMU_NUM_SHIRES),
           global_info->cb_dirty, (uint32_t) bool_array_to_int(global_info->cb_dirty_quarter, 4), (long long unsigned int) global_info->time_stamp, (long long unsigned int) global_info->latest_time_stamp));
 }
 
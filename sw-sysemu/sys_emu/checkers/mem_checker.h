@@ -6,7 +6,8 @@
 #ifndef _MEM_CHECKER_H_
 #define _MEM_CHECKER_H_
 
-#include <map>
+#include <string>
+#include <unordered_map>
 
 #include <cassert>
 
@@ -45,9 +46,11 @@ struct minion_mem_info_t
     uint64_t time_stamp[EMU_THREADS_PER_MINION];        // Time stamp of the value
 };
 
-typedef std::map<uint64_t, global_mem_info_t> global_directory_map_t;
-typedef std::map<uint64_t, shire_mem_info_t>  shire_directory_map_t;
-typedef std::map<uint64_t, minion_mem_info_t> minion_directory_map_t;
+// Directories are hashed by cache line address: every access looks up the
+// three levels, and their order is never relied upon
+typedef std::unordered_map<uint64_t, global_mem_info_t> global_directory_map_t;
+typedef std::unordered_map<uint64_t, shire_mem_info_t>  shire_directory_map_t;
+typedef std::unordered_map<uint64_t, minion_mem_info_t> minion_directory_map_t;
 
 class mem_checker : public bemu::Agent
 {
@@ -79,9 +82,9 @@ private:
     bool is_shire_dirty (shire_directory_map_t::iterator  it_shire);
     bool is_global_clean(global_directory_map_t::iterator it_global);
 
-    void dump_minion(minion_mem_info_t * minion_info, std::string func, std::string op, uint64_t addr, uint32_t shire_id, uint32_t minion_id, uint32_t thread_id);
-    void dump_shire (shire_mem_info_t  * shire_info,  std::string func, std::string op, uint64_t addr, uint32_t shire_id, uint32_t minion);
-    void dump_global(global_mem_info_t * global_info, std::string func, std::string op, uint64_t addr, uint32_t minion);
+    void dump_minion(minion_mem_info_t * minion_info, const char* func, const char* op, uint64_t addr, uint32_t shire_id, uint32_t minion_id, uint32_t thread_id);
+    void dump_shire (shire_mem_info_t  * shire_info,  const char* func, const char* op, uint64_t addr, uint32_t shire_id, uint32_t minion);
+    void dump_global(global_mem_info_t * global_info, const char* func, const char* op, uint64_t addr, uint32_t minion);
 
     void dump_state(global_directory_map_t::iterator it_global, shire_directory_map_t::iterator it_shire, minion_directory_map_t::iterator it_minion, uint32_t shire_id, uint32_t minion);
 
@@ -6,8 +6,11 @@
 #ifndef _LOG_H
 #define _LOG_H
 
+#include <bitset>
 #include <cstdint>
 #include "processor.h"
+#include "system.h"
+#include "timing_model.h"
 
 // Run control
 void notify_pc_update(const bemu::Hart&, uint64_t);
@@ -23,10 +26,18 @@ void notify_freg_intmv(const bemu::Hart&, uint8_t, const bemu::mreg_t&, const be
 void notify_freg_write(const bemu::Hart&, uint8_t, const bemu::mreg_t&, const bemu::freg_t&);
 void notify_freg_read(const bemu::Hart&, uint8_t);
 
-// Memory write backs
-inline void notify_mem_write(const bemu::Hart&, bool, int, uint64_t, uint64_t, uint64_t) {}
-inline void notify_mem_read(const bemu::Hart&, bool, int, uint64_t, uint64_t) {}
-inline void notify_mem_read_write(const bemu::Hart&, bool, int, uint64_t, uint64_t, uint64_t) {}
+// Memory write backs, timed when the timing model is on
+inline void notify_mem_access(const bemu::Hart& cpu, bool valid, uint64_t paddr)
+{
+    if (valid && cpu.chip->timing_model)
+        cpu.chip->timing_model->mem_access(cpu, paddr);
+}
+inline void notify_mem_write(const bemu::Hart& cpu, bool valid, int, uint64_t, uint64_t paddr, uint64_t)
+{ notify_mem_access(cpu, valid, paddr); }
+inline void notify_mem_read(const bemu::Hart& cpu, bool valid, int, uint64_t, uint64_t paddr)
+{ notify_mem_access(cpu, valid, paddr); }
+inline void notify_mem_read_write(const bemu::Hart& cpu, bool valid, int, uint64_t, uint64_t paddr, uint64_t)
+{ notify_mem_access(cpu, valid, paddr); }
 
 // Mask registers and misc CSRs
 inline void notify_mreg_write(const bemu::Hart&, uint8_t, const bemu::mreg_t&) {}
@@ -36,24 +47,39 @@ inline void notify_gsc_progress(const bemu::Hart&, uint64_t) {}
 // TensorError
 inline void notify_tensor_error_value(const bemu::Hart&, uint16_t) {}
 
+// Tensor FSM occupancy for the timing model
+inline void notify_tensor_busy(const bemu::Hart& cpu, uint8_t event, uint64_t Timing_config::*latency, uint64_t n)
+{
+    if (cpu.chip->timing_model) {
+        if (event != PMU_MINION_EVENT_NONE)
+            cpu.notify_pmu_minion_event(event);
+        cpu.chip->timing_model->tensor_op(cpu, n * (cpu.chip->timing_model->latencies().*latency));
+    }
+}
+
 // TensorLoad
-inline void notify_tensor_load(const bemu::Hart&, uint8_t, uint8_t, uint8_t, uint64_t) {}
+inline void notify_tensor_load(const bemu::Hart& cpu, uint8_t, uint8_t, uint8_t, uint64_t tmask)
+{ notify_tensor_busy(cpu, PMU_MINION_EVENT_TL_INST, &Timing_config::tload_line, std::bitset<64>(tmask).count()); }
 inline void notify_tensor_load_scp_write(const bemu::Hart&, uint8_t, const uint64_t*) {}
 
 // TensorFMA
-inline void notify_tensor_fma_new_pass(const bemu::Hart&) {}
+inline void notify_tensor_fma_new_pass(const bemu::Hart& cpu)
+{ notify_tensor_busy(cpu, PMU_MINION_EVENT_NONE, &Timing_config::tfma_pass, 1); }
 inline void notify_tensor_fma_write(const bemu::Hart&, uint8_t, bool, uint8_t, int, uint32_t) {}
 
 // TensorQuant
-inline void notify_tensor_quant_new_transform(const bemu::Hart&, bool = false) {}
+inline void notify_tensor_quant_new_transform(const bemu::Hart& cpu, bool = false)
+{ notify_tensor_busy(cpu, PMU_MINION_EVENT_NONE, &Timing_config::tquant_step, 1); }
 inline void notify_tensor_quant_write(const bemu::Hart&, uint8_t, uint8_t, const bemu::mreg_t&, const bemu::freg_t&) {}
 
 // TensorReduce
-inline void notify_tensor_reduce(const bemu::Hart&, bool, uint8_t, uint8_t) {}
+inline void notify_tensor_reduce(const bemu::Hart& cpu, bool, uint8_t, uint8_t count)
+{ notify_tensor_busy(cpu, PMU_MINION_EVENT_TREDUCE_INST, &Timing_config::treduce_reg, count); }
 inline void notify_tensor_reduce_write(const bemu::Hart&, uint8_t, const bemu::freg_t&) {}
 
 // TensorStore
-inline void notify_tensor_store(const bemu::Hart&, bool, uint8_t, uint8_t, uint8_t) {}
+inline void notify_tensor_store(const bemu::Hart& cpu, bool, uint8_t rows, uint8_t, uint8_t)
+{ notify_tensor_busy(cpu, PMU_MINION_EVENT_TS_INST, &Timing_config::tstore_line, rows); }
 inline void notify_tensor_store_write(const bemu::Hart&, uint64_t, uint32_t) {}
 inline void notify_tensor_store_error(const bemu::Hart&, uint16_t) {}
 
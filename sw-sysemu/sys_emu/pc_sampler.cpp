@@ -0,0 +1,115 @@
+/*-------------------------------------------------------------------------
+* Copyright (c) 2025 Ainekko, Co.
+* SPDX-License-Identifier: Apache-2.0
+*-------------------------------------------------------------------------*/
+
+#include "pc_sampler.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <tuple>
+#include "elfio/elfio.hpp"
+#include "elfio/elfio_symbols.hpp"
+
+namespace {
+
+struct Symbol {
+    uint64_t    addr;
+    uint64_t    size;
+    std::string name;
+};
+
+
+// Function symbols of all the ELF files, sorted by address
+std::vector<Symbol> read_symbols(const std::vector<std::string>& elf_files)
+{
+    std::vector<Symbol> symbols;
+    for (const auto& path : elf_files) {
+        ELFIO::elfio elf;
+        if (!elf.load(path)) {
+            std::cerr << "Profiling: Cannot read symbols from " << path << std::endl;
+            continue;
+        }
+        for (const ELFIO::section* sec : elf.sections) {
+            if (sec->get_type() != SHT_SYMTAB)
+                continue;
+            ELFIO::const_symbol_section_accessor accessor(elf, sec);
+            for (ELFIO::Elf_Xword i = 0; i < accessor.get_symbols_num(); ++i) {
+                std::string name;
+                ELFIO::Elf64_Addr value;
+                ELFIO::Elf_Xword size;
+                unsigned char bind, type, other;
+                ELFIO::Elf_Half section_index;
+                accessor.get_symbol(i, name, value, size, bind, type, section_index, other);
+                if ((type == STT_FUNC) && (section_index != SHN_UNDEF) && !name.empty())
+                    symbols.push_back(Symbol{value, size, name});
+            }
+        }
+    }
+    std::sort(symbols.begin(), symbols.end(), [](const Symbol& a, const Symbol& b) {
+        return std::tie(a.addr, a.size) < std::tie(b.addr, b.size);
+    });
+    return symbols;
+}
+
+
+// Name of the function at @pc; symbols without a size extend to the next one
+std::string symbolize(const std::vector<Symbol>& symbols, uint64_t pc)
+{
+    auto it = std::upper_bound(symbols.begin(), symbols.end(), pc,
+                               [](uint64_t addr, const Symbol& sym) { return addr < sym.addr; });
+    if (it != symbols.begin()) {
+        const Symbol& sym = *std::prev(it);
+        if ((sym.size == 0 && it != symbols.end()) || (pc - sym.addr < sym.size))
+            return sym.name;
+    }
+    std::ostringstream os;
+    os << "0x" << std::hex << pc;
+    return os.str();
+}
+
+} // namespace
+
+
+Pc_sampler::Pc_sampler(uint64_t period, size_t buffer_size)
+    : period(std::max<uint64_t>(period, 1)),
+      buffer_size(std::max<size_t>(buffer_size, 1)),
+      samples(EMU_NUM_THREADS),
+      counts(EMU_NUM_THREADS)
+{
+}
+
+
+void Pc_sampler::fold(unsigned hart)
+{
+    for (uint64_t pc : samples[hart])
+        counts[hart][pc]++;
+    samples[hart].clear();
+}
+
+
+void Pc_sampler::dump(const std::string& filename, const std::vector<std::string>& elf_files)
+{
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Profiling: Cannot open " << filename << std::endl;
+        return;
+    }
+
+    const std::vector<Symbol> symbols = read_symbols(elf_files);
+    for (unsigned hart = 0; hart < EMU_NUM_THREADS; ++hart) {
+        fold(hart);
+        // PCs of the same function are merged into one stack
+        std::map<std::string, uint64_t> stacks;
+        for (const auto& entry : counts[hart])
+            stacks[symbolize(symbols, entry.first)] += entry.second;
+        for (const auto& stack : stacks) {
+            file << "shire" << (hart / EMU_THREADS_PER_SHIRE) << ";hart" << hart << ';'
+                 << stack.first << ' ' << stack.second << '\n';
+        }
+    }
+}
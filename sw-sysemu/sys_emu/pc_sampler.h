@@ -0,0 +1,58 @@
+/*-------------------------------------------------------------------------
+* Copyright (c) 2025 Ainekko, Co.
+* SPDX-License-Identifier: Apache-2.0
+*-------------------------------------------------------------------------*/
+
+#ifndef BEMU_PC_SAMPLER_H
+#define BEMU_PC_SAMPLER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "emu_defines.h"
+
+// Statistical PC profiler. Every so many cycles the main loop records the
+// PC of each active hart in a per hart buffer; the samples are only counted
+// when a buffer fills up, so the emulation pays one store per active hart
+// and sample. Unlike profiling.cpp it needs no rebuild and can be left on
+// during long runs.
+class Pc_sampler
+{
+public:
+    explicit Pc_sampler(uint64_t period, size_t buffer_size = 512);
+
+    // Whether the harts should be sampled at @cycle
+    bool due(uint64_t cycle) const { return cycle >= next_sample; }
+
+    void record(unsigned hart, uint64_t pc) {
+        auto& buffer = samples[hart];
+        if (buffer.capacity() == 0)
+            buffer.reserve(buffer_size);
+        buffer.push_back(pc);
+        if (buffer.size() == buffer_size)
+            fold(hart);
+    }
+
+    // Done sampling at @cycle
+    void advance(uint64_t cycle) { next_sample = cycle + period; }
+
+    // Writes the samples in folded stacks format ("frame;frame;... count"
+    // lines, as read by flamegraph.pl, inferno or speedscope), one stack of
+    // shire, hart and function per sampled PC. Functions are named after
+    // the symbols in @elf_files, unknown PCs are written in hex.
+    void dump(const std::string& filename, const std::vector<std::string>& elf_files);
+
+private:
+    void fold(unsigned hart);
+
+    uint64_t    period;
+    size_t      buffer_size;
+    uint64_t    next_sample = 0;
+
+    std::vector<std::vector<uint64_t>>                      samples;
+    std::vector<std::unordered_map<uint64_t, uint64_t>>     counts;
+};
+
+#endif // BEMU_PC_SAMPLER_H
@@ -12,23 +12,35 @@
 #include <cstring>
 #include <exception>
 #include <fcntl.h>
+#include <fstream>
+#include <future>
 #include <iostream>
+#include <limits>
 #include <list>
 #include <locale>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <streambuf>
+#include <string_view>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/wait.h>
 #include <tuple>
 #include <unistd.h>
 
 #include "api_communicate.h"
 #include "checkers/l2_scp_checker.h"
 #include "devices/rvtimer.h"
+#include "elfio/elfio.hpp"
 #include "emu_gio.h"
 #include "gdbstub.h"
 #include "insn.h"
 #include "log.h"
 #include "memory/dump_data.h"
 #include "memory/main_memory.h"
+#include "memory/shared_image.h"
 #include "mmu.h"
 #include "processor.h"
 #include "profiling.h"
@@ -40,6 +52,15 @@
 #endif
 
 
+// Fast builds leave the debugger and the dump/log triggers out of the
+// main loop
+#ifdef SYSEMU_FAST
+static constexpr bool debug_support = false;
+#else
+static constexpr bool debug_support = true;
+#endif
+
+
 static void
 halt_all_threads(bemu::System& chip)
 {
@@ -53,6 +74,197 @@ halt_all_threads(bemu::System& chip)
 }
 
 
+static void
+take_trap(bemu::Hart& hart, uint64_t cause, uint64_t tval)
+{
+    uint64_t old_pc = hart.pc;
+    hart.take_trap(cause, tval);
+    hart.advance_pc();
+    if (hart.pc == old_pc) {
+        LOG_AGENT(FTL, hart, "Trapping to the same address that "
+                  "caused a trap (0x%" PRIx64 "). Avoiding "
+                  "infinite trap recursion.", hart.pc);
+    }
+}
+
+
+// Seekable read-only stream buffer over memory it does not own, so the
+// preloaded images can be parsed without copying them first
+class view_streambuf : public std::streambuf
+{
+public:
+    explicit view_streambuf(std::string_view data) {
+        char* begin = const_cast<char*>(data.data());
+        setg(begin, begin, begin + data.size());
+    }
+
+protected:
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override {
+        char* base = (dir == std::ios_base::beg) ? eback() : (dir == std::ios_base::cur) ? gptr() : egptr();
+        if (!(which & std::ios_base::in) || (off < eback() - base) || (off > egptr() - base))
+            return pos_type(off_type(-1));
+        setg(eback(), base + off, egptr());
+        return pos_type(gptr() - eback());
+    }
+
+    pos_type seekpos(pos_type pos, std::ios_base::openmode which) override {
+        return seekoff(off_type(pos), std::ios_base::beg, which);
+    }
+};
+
+
+static std::unique_ptr<ELFIO::elfio>
+parse_preload(std::string_view image)
+{
+    auto elf = std::make_unique<ELFIO::elfio>();
+    view_streambuf view{image};
+    std::istream buf{&view};
+#ifdef PRELOAD_LZ4
+    lz4_stream::istream decomp{buf};
+    // NB: There seems to be a bug in either lz4_stream or elfio...
+    // Filtering through an extra stringstream works though :)
+    std::stringstream buf2;
+    buf2 << decomp.rdbuf();
+    elf->load(buf2);
+#else
+    elf->load(buf);
+#endif
+    return elf;
+}
+
+
+static std::unique_ptr<ELFIO::elfio>
+parse_elf(const std::string& path)
+{
+    auto elf = std::make_unique<ELFIO::elfio>();
+    if (!elf->load(path)) {
+        throw std::runtime_error(path);
+    }
+    return elf;
+}
+
+
+void
+sys_emu::load_images()
+{
+    // The ELF files are read and parsed in parallel, then copied to memory
+    // in order, so later images still overwrite earlier ones
+    using Parsed = std::future<std::unique_ptr<ELFIO::elfio>>;
+    std::vector<Parsed> preloads;
+    std::vector<Parsed> elfs;
+    for (int i = 0; !g_preload[i].empty(); ++i) {
+        preloads.push_back(std::async(std::launch::async, parse_preload, g_preload[i]));
+    }
+    for (const auto &elf: cmd_options.elf_files) {
+        elfs.push_back(std::async(std::launch::async, parse_elf, elf));
+    }
+
+    for (size_t i = 0; i < preloads.size(); ++i) {
+        LOG_AGENT(INFO, agent, "Preloading ELF[%zu]", i);
+        try {
+            chip.load_elf(*preloads[i].get());
+        }
+        catch (...) {
+            LOG_AGENT(FTL, agent, "Error preloading ELF[%zu]", i);
+        }
+    }
+
+    // Parses the ELF files and memory description
+    for (size_t i = 0; i < elfs.size(); ++i) {
+        const auto& elf = cmd_options.elf_files[i];
+        LOG_AGENT(INFO, agent, "Loading ELF: \"%s\"", elf.c_str());
+        try {
+            chip.load_elf(*elfs[i].get());
+        }
+        catch (...) {
+            LOG_AGENT(FTL, agent, "Error loading ELF \"%s\"", elf.c_str());
+        }
+    }
+    if (!cmd_options.mem_desc_file.empty()) {
+        parse_mem_file(cmd_options.mem_desc_file.c_str());
+    }
+
+    // Load files
+    for (const auto &info: cmd_options.file_load_files) {
+        LOG_AGENT(INFO, agent, "Loading file @ 0x%" PRIx64 ": \"%s\"", info.addr, info.file.c_str());
+        try {
+            chip.load_raw(info.file.c_str(), info.addr);
+        }
+        catch (...) {
+            LOG_AGENT(FTL, agent, "Error loading file \"%s\"", info.file.c_str());
+        }
+    }
+}
+
+
+// Images loaded by the instances of this process with share_images set, by
+// the options they were loaded from
+static std::mutex shared_images_mutex;
+static std::map<std::string, std::shared_ptr<bemu::Shared_image>> shared_images;
+
+
+// Identifies the memory images of @cmd_options. Files are identified by their
+// path, size and modification time, preloads are the same for the whole process.
+static std::string
+shared_image_key(const sys_emu_cmd_options& cmd_options)
+{
+    std::ostringstream key;
+    auto file_id = [&key](const std::string& path) {
+        struct stat st;
+        key << path << '\0';
+        if (stat(path.c_str(), &st) == 0) {
+            key << st.st_dev << ':' << st.st_ino << ':' << st.st_size << ':'
+                << st.st_mtim.tv_sec << '.' << st.st_mtim.tv_nsec;
+        }
+        key << '\0';
+    };
+    key << std::hex << cmd_options.mem_reset << '\0';
+    for (const auto& elf : cmd_options.elf_files) {
+        key << "elf" << '\0';
+        file_id(elf);
+    }
+    if (!cmd_options.mem_desc_file.empty()) {
+        key << "mem_desc" << '\0';
+        file_id(cmd_options.mem_desc_file);
+    }
+    for (const auto& info : cmd_options.file_load_files) {
+        key << "file" << '\0' << info.addr << '\0';
+        file_id(info.file);
+    }
+    return key.str();
+}
+
+
+void
+sys_emu::load_shared_images()
+{
+    const std::string key = shared_image_key(cmd_options);
+    // Held while loading, so that instances starting together load once
+    std::lock_guard<std::mutex> lock(shared_images_mutex);
+    auto it = shared_images.find(key);
+    if (it != shared_images.end()) {
+        LOG_AGENT(INFO, agent, "%s", "Mapping memory images shared with another instance");
+        try {
+            chip.memory.adopt(*it->second);
+            return;
+        }
+        catch (const std::exception& e) {
+            LOG_AGENT(FTL, agent, "Error mapping shared memory images: %s", e.what());
+        }
+    }
+    load_images();
+    try {
+        auto image = std::make_shared<bemu::Shared_image>();
+        chip.memory.publish(*image);
+        shared_images.emplace(key, std::move(image));
+    }
+    catch (const std::exception& e) {
+        // The images stay private to this instance
+        LOG_AGENT(WARN, agent, "Cannot share memory images: %s", e.what());
+    }
+}
+
+
 void
 sys_emu::raise_timer_interrupt(uint64_t shire_mask)
 {
@@ -201,6 +413,11 @@ sys_emu::sys_emu(const sys_emu_cmd_options &cmd_options, api_communicate *api_co
     chip.log_trigger_count = 0;
     chip.log_dynamic = (chip.log_trigger_insn != 0) && (chip.log_trigger_stop > chip.log_trigger_start) && (chip.log_trigger_hart < EMU_NUM_THREADS);
 
+    if (!debug_support && (cmd_options.gdb || chip.log_dynamic || !cmd_options.dump_at_pc.empty() ||
+                           (cmd_options.log_at_pc != ~0ull) || (cmd_options.stop_log_at_pc != ~0ull))) {
+        LOG_AGENT(FTL, agent, "%s", "The debugger, the log triggers and -dump_at_pc are not available in fast builds");
+    }
+
     chip.log.setLogLevel(cmd_options.log_en && (!chip.log_dynamic || (chip.log_trigger_start == 0)) ? LOG_DEBUG : default_log_level);
     chip.log_thread = cmd_options.log_thread;
     chip.warning = cmd_options.warning;
@@ -246,60 +463,35 @@ sys_emu::sys_emu(const sys_emu_cmd_options &cmd_options, api_communicate *api_co
     tstore_checker_.log_thread = cmd_options.tstore_checker_log_thread;
     breakpoints.clear();
     single_step.reset();
+    if (!cmd_options.prof_sample_file.empty()) {
+        pc_sampler.reset(new Pc_sampler(cmd_options.prof_sample_period));
+    }
+    if (cmd_options.timing_model) {
+        Timing_config latencies;
+        std::string error;
+        if (!cmd_options.timing_config.empty() && !latencies.load(cmd_options.timing_config, error)) {
+            LOG_AGENT(FTL, agent, "%s", error.c_str());
+        }
+        timing_model.reset(new Timing_model(latencies));
+        chip.timing_model = timing_model.get();
+    }
+    chip.pcie_dma_bandwidth = cmd_options.pcie_dma_bandwidth;
+    chip.pcie_dma_latency = cmd_options.pcie_dma_latency;
 
     if (cmd_options.elf_files.empty() && cmd_options.file_load_files.empty() &&
-        cmd_options.mem_desc_file.empty() && cmd_options.api_comm_path.empty() && g_preload->empty()) {
-        LOG_AGENT(FTL, agent, "%s", "Need an ELF file, a file load, a mem_desc file or runtime API!");
+        cmd_options.mem_desc_file.empty() && cmd_options.api_comm_path.empty() && g_preload->empty() &&
+        cmd_options.snapshot_load.empty() && cmd_options.batch_file.empty()) {
+        LOG_AGENT(FTL, agent, "%s", "Need an ELF file, a file load, a mem_desc file, a snapshot or runtime API!");
     }
 
     // Init emu
     chip.init(bemu::System::Stepping::A0);
     memcpy(&chip.memory_reset_value, &cmd_options.mem_reset, MEM_RESET_PATTERN_SIZE);
 
-    for (int i = 0; !g_preload[i].empty(); ++i) {
-        LOG_AGENT(INFO, agent, "Preloading ELF[%d]", i);
-        try {
-            std::string str{g_preload[i]};
-            std::istringstream buf{str};
-#ifdef PRELOAD_LZ4
-            lz4_stream::istream decomp{buf};
-            // NB: There seems to be a bug in either lz4_stream or elfio...
-            // Filtering through an extra stringstream works though :)
-            std::stringstream buf2;
-            buf2 << decomp.rdbuf();
-            chip.load_elf(buf2);
-#else
-            chip.load_elf(buf);
-#endif
-        }
-        catch (...) {
-            LOG_AGENT(FTL, agent, "Error preloading ELF[%d]", i);
-        }
-    }
-
-    // Parses the ELF files and memory description
-    for (const auto &elf: cmd_options.elf_files) {
-        LOG_AGENT(INFO, agent, "Loading ELF: \"%s\"", elf.c_str());
-        try {
-            chip.load_elf(elf.c_str());
-        }
-        catch (...) {
-            LOG_AGENT(FTL, agent, "Error loading ELF \"%s\"", elf.c_str());
-        }
-    }
-    if (!cmd_options.mem_desc_file.empty()) {
-        parse_mem_file(cmd_options.mem_desc_file.c_str());
-    }
-
-    // Load files
-    for (const auto &info: cmd_options.file_load_files) {
-        LOG_AGENT(INFO, agent, "Loading file @ 0x%" PRIx64 ": \"%s\"", info.addr, info.file.c_str());
-        try {
-            chip.load_raw(info.file.c_str(), info.addr);
-        }
-        catch (...) {
-            LOG_AGENT(FTL, agent, "Error loading file \"%s\"", info.file.c_str());
-        }
+    if (cmd_options.share_images) {
+        load_shared_images();
+    } else {
+        load_images();
     }
 
     // Perform 32 bit writes
@@ -444,30 +636,48 @@ sys_emu::sys_emu(const sys_emu_cmd_options &cmd_options, api_communicate *api_co
     for (auto &info: cmd_options.set_xreg) {
         chip.cpu[info.thread].xregs[info.xreg] = info.value;
     }
+
+    // Restore a snapshot on top of the reset state
+    if (!cmd_options.snapshot_load.empty()) {
+        LOG_AGENT(INFO, agent, "Loading snapshot: \"%s\"", cmd_options.snapshot_load.c_str());
+        try {
+            std::ifstream file;
+            file.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+            file.open(cmd_options.snapshot_load, std::ios::in | std::ios::binary);
+            file.exceptions(std::ifstream::badbit);
+            lz4_stream::istream decomp{file};
+            decomp.read(reinterpret_cast<char*>(&emu_cycle), sizeof(emu_cycle));
+            chip.restore_snapshot(decomp);
+        }
+        catch (const std::exception& e) {
+            LOG_AGENT(FTL, agent, "Error loading snapshot \"%s\": %s", cmd_options.snapshot_load.c_str(), e.what());
+        }
+    }
 }
 
 
 ////////////////////////////////////////////////////////////////////////////////
-// Main function implementation
+// Runs the system till it is done, returns the exit status
 ////////////////////////////////////////////////////////////////////////////////
 
-int sys_emu::main_internal() {
-#ifdef HAVE_BACKTRACE
-    Crash_handler __crash_handler;
-#endif
-
-#ifdef SYSEMU_PROFILING
-    profiling_init(this);
-#endif
-
+int
+sys_emu::run()
+{
     int rv = EXIT_SUCCESS;
 
     bool gdb_enabled = cmd_options.gdb && (cmd_options.gdb_at_pc == ~0ull) &&
       !cmd_options.gdb_on_umode;
 
-    if (cmd_options.gdb) {
-        gdbstub_init(this, &chip);
-    }
+    // The per instruction dump and logging triggers are rarely used, decide
+    // once whether they have to be checked at all
+    const bool pc_triggers = !cmd_options.dump_at_pc.empty() || (cmd_options.log_at_pc != ~0ull) ||
+        (cmd_options.stop_log_at_pc != ~0ull);
+
+    // Translated blocks skip the per instruction checks of the debugger, the
+    // timing model and the PC and dynamic logging triggers, so they are only
+    // used without them
+    const bool translate = cmd_options.translate && !cmd_options.gdb && !timing_model
+        && !(debug_support && (pc_triggers || chip.log_dynamic));
 
     LOG_AGENT(INFO, agent, "%s", "Starting emulation");
 
@@ -482,7 +692,7 @@ int sys_emu::main_internal() {
                    && ((api_listener != nullptr)
                        || chip.timers_active()))))
     {
-        if (gdb_enabled) {
+        if (debug_support && gdb_enabled) {
             switch (gdbstub_get_status()) {
             case GDBSTUB_STATUS_WAITING_CLIENT:
                 gdbstub_accept_client();
@@ -501,7 +711,7 @@ int sys_emu::main_internal() {
         }
 
         // Dynamic logging
-        if (chip.log_dynamic) {
+        if (debug_support && chip.log_dynamic) {
             auto& hart = chip.cpu[chip.log_trigger_hart];
             if ((hart.state == bemu::Hart::State::active) && (hart.inst.bits == chip.log_trigger_insn)) {
                 chip.log_trigger_count++;
@@ -519,11 +729,49 @@ int sys_emu::main_internal() {
             api_listener->process();
         }
 
+        // When all the harts sleep only a peripheral or the host can wake
+        // them up: jump to the cycle before the next peripheral event, or
+        // wait for the host if there is none
+        if (!cmd_options.gdb && !chip.has_active_harts()) {
+            uint64_t idle = chip.peripherals_idle_cycles(emu_cycle);
+            if (api_listener) {
+                idle = std::min(idle, api_listener->cycles_to_command(emu_cycle));
+            }
+            if ((idle == std::numeric_limits<uint64_t>::max()) && api_listener) {
+                api_listener->wait_for_command(std::chrono::milliseconds(10));
+                continue;
+            }
+            const uint64_t skip = std::min(idle, cmd_options.max_cycles - emu_cycle);
+            if (skip > 0) {
+                chip.skip_peripherals(emu_cycle, skip);
+                emu_cycle += skip;
+                continue;
+            }
+        }
+
+        // Harts run in turn for a quantum of cycles each, a hart woken up
+        // by another one joins at the next quantum. The peripherals are
+        // ticked for the whole quantum before the harts run, so the harts see
+        // their events up to a quantum early and the peripherals see the hart
+        // accesses up to a quantum late. The debugger steps the harts one
+        // cycle at a time. See "Running in quanta" in the README.
+        const uint64_t quantum = cmd_options.gdb ? 1
+            : std::min(cmd_options.quantum, cmd_options.max_cycles - emu_cycle);
+
         // Update peripherals/devices
-        chip.tick_peripherals(emu_cycle);
+        for (uint64_t step = 0; step < quantum; ++step) {
+            chip.tick_peripherals(emu_cycle + step);
+        }
 
         chip.active.splice(chip.active.cend(), chip.awaking);
 
+        if (pc_sampler && pc_sampler->due(emu_cycle)) {
+            for (const auto& hart : chip.active) {
+                pc_sampler->record(hart_index(hart), hart.pc);
+            }
+            pc_sampler->advance(emu_cycle);
+        }
+
         auto current_hart = chip.active.begin();
         while (current_hart != chip.active.end()) {
             auto hart = current_hart++;
@@ -533,7 +781,7 @@ int sys_emu::main_internal() {
             hart->async_execute();
 
             //GDB server can be enabled by PC or by the first transition to user mode.
-            if (!gdb_enabled && cmd_options.gdb &&
+            if (debug_support && !gdb_enabled && cmd_options.gdb &&
                 ((hart->pc == cmd_options.gdb_at_pc) ||
                  (cmd_options.gdb_on_umode && (hart->prv == bemu::Privilege::U)))) {
                 // Break and connect the debugger in the next iteration!
@@ -541,110 +789,145 @@ int sys_emu::main_internal() {
                 break;
             }
 
-            // Fetch and interrupts are blocked because another hart of this core is in exclusive mode
-            if (hart->is_blocked()) {
-                continue;
-            }
+            for (uint64_t step = 0; step < quantum; ++step) {
+                if (step != 0) {
+                    // Stop the quantum once the hart goes to sleep
+                    if (hart->state != bemu::Hart::State::active) {
+                        break;
+                    }
+                    hart->async_execute();
+                }
+
+                // Fetch and interrupts are blocked because another hart of this core is in exclusive mode
+                if (hart->is_blocked()) {
+                    break;
+                }
+
+                // If the hart is halted either do nothing or fetch and execute from the program buffer
+                if (hart->is_halted()) {
+                    if (!hart->in_progbuf()) {
+                        break;
+                    }
+                    using Progbuf = bemu::Hart::Progbuf;
+                    try {
+                        hart->fetch_progbuf();
+                        hart->execute();
+                        if (hart->trap_signalled) {
+                            WARN_AGENT(debug, *hart, "Program buffer trapped with cause 0x%" PRIx64,
+                                       hart->signalled_cause);
+                            hart->exit_progbuf(Progbuf::exception);
+                        } else {
+                            hart->advance_progbuf();
+                        }
+                    }
+                    catch (const bemu::Trap& t) {
+                        WARN_AGENT(debug, *hart, "Program buffer trapped: %s", t.what());
+                        hart->exit_progbuf(Progbuf::exception);
+                    }
+                    catch (const bemu::instruction_restart) {
+                        LOG_AGENT(DEBUG, *hart, "%s", "Instruction killed and will be restarted");
+                    }
+                    catch (const bemu::memory_error& e) {
+                        WARN_AGENT(debug, *hart, "Program buffer bus error: 0x%" PRIx64, e.addr);
+                        hart->exit_progbuf(Progbuf::exception);
+                    }
+                    catch (const std::exception& e) {
+                        LOG_AGENT(FTL, *hart, "%s", e.what());
+                    }
+                    break;
+                }
 
-            // If the hart is halted either do nothing or fetch and execute from the program buffer
-            if (hart->is_halted()) {
-                if (!hart->in_progbuf()) {
+                // The timing model holds the hart until its last instruction is done
+                if (timing_model && !timing_model->issue(thread_id, emu_cycle + step)) {
                     continue;
                 }
-                using Progbuf = bemu::Hart::Progbuf;
+
                 try {
-                    hart->fetch_progbuf();
-                    hart->execute();
-                    hart->advance_progbuf();
+                    // A pending interrupt is taken in place of the next instruction
+                    const uint64_t interrupt = hart->pending_interrupt();
+                    if (interrupt != 0) {
+                        take_trap(*hart, interrupt, 0);
+                    } else if (translate && !hart->is_waiting()) {
+                        // Runs as many instructions of the block as the
+                        // quantum takes, leaves step at the last one
+                        hart->execute_block(step, quantum);
+                        if (hart->trap_signalled) {
+                            take_trap(*hart, hart->signalled_cause, hart->signalled_tval);
+                        }
+                    } else if (!hart->is_waiting()) {
+                        // Gets instruction and sets state
+                        hart->fetch();
+
+                        // Check for breakpoints
+                        if (debug_support && cmd_options.gdb && (gdbstub_get_status() == GDBSTUB_STATUS_RUNNING)
+                            && breakpoint_exists(hart->pc)) {
+                            LOG_AGENT(DEBUG, *hart, "Hit breakpoint at address 0x%" PRIx64, hart->pc);
+                            gdbstub_signal_break(thread_id);
+                            halt_all_threads(chip);
+                            break;
+                        }
+
+                        if (debug_support && pc_triggers) {
+                            // Dumping when M0:T0 reaches a PC
+                            auto range = cmd_options.dump_at_pc.equal_range(thread_get_pc(0));
+                            for (auto it = range.first; it != range.second; ++it) {
+                                bemu::dump_data(chip.memory, agent,
+                                                it->second.file.c_str(), it->second.addr, it->second.size);
+                            }
+
+                            // Logging
+                            if (thread_get_pc(0) == cmd_options.log_at_pc) {
+                                get_logger().setLogLevel(LOG_DEBUG);
+                            } else if (thread_get_pc(0) == cmd_options.stop_log_at_pc) {
+                                get_logger().setLogLevel(LOG_INFO);
+                            }
+                        }
+
+                        // Executes the instruction
+                        hart->execute();
+                        if (hart->trap_signalled) {
+                            take_trap(*hart, hart->signalled_cause, hart->signalled_tval);
+                        } else {
+                            hart->notify_pmu_minion_event(PMU_MINION_EVENT_RETIRED_INST0 + (thread_id & 1));
+                            if (timing_model) {
+                                timing_model->retire(*hart);
+                            }
+                            hart->advance_pc();
+                        }
+                    }
+                }
+                catch (const bemu::Debug_entry& e) {
+                    hart->enter_debug_mode(e.cause);
                 }
                 catch (const bemu::Trap& t) {
-                    WARN_AGENT(debug, *hart, "Program buffer trapped: %s", t.what());
-                    hart->exit_progbuf(Progbuf::exception);
+                    take_trap(*hart, t.cause(), t.tval());
                 }
                 catch (const bemu::instruction_restart) {
                     LOG_AGENT(DEBUG, *hart, "%s", "Instruction killed and will be restarted");
                 }
                 catch (const bemu::memory_error& e) {
-                    WARN_AGENT(debug, *hart, "Program buffer bus error: 0x%" PRIx64, e.addr);
-                    hart->exit_progbuf(Progbuf::exception);
+                    hart->advance_pc();
+                    hart->raise_interrupt(BUS_ERROR_INTERRUPT, e.addr);
                 }
                 catch (const std::exception& e) {
                     LOG_AGENT(FTL, *hart, "%s", e.what());
                 }
-                continue;
-            }
 
-            try {
-                hart->check_pending_interrupts();
-                if (!hart->is_waiting()) {
-                    // Gets instruction and sets state
-                    hart->fetch();
-
-                    // Check for breakpoints
-                    if ((gdbstub_get_status() == GDBSTUB_STATUS_RUNNING) && breakpoint_exists(hart->pc)) {
-                        LOG_AGENT(DEBUG, *hart, "Hit breakpoint at address 0x%" PRIx64, hart->pc);
+                // Check for single-step mode
+                if (debug_support && cmd_options.gdb && (gdbstub_get_status() == GDBSTUB_STATUS_RUNNING)
+                    && single_step[thread_id]) {
+                    if (!step_range[thread_id].contains(hart->pc)) {
+                        LOG_AGENT(DEBUG, *hart, "%s", "Single-step done");
                         gdbstub_signal_break(thread_id);
-                        halt_all_threads(chip);
-                        continue;
-                    }
-
-                    // Dumping when M0:T0 reaches a PC
-                    auto range = cmd_options.dump_at_pc.equal_range(thread_get_pc(0));
-                    for (auto it = range.first; it != range.second; ++it) {
-                        bemu::dump_data(chip.memory, agent,
-                                        it->second.file.c_str(), it->second.addr, it->second.size);
+                        single_step[thread_id] = false;
+                        hart->enter_debug_mode(bemu::Debug_entry::Cause::haltreq);
+                        break;
                     }
-
-                    // Logging
-                    if (thread_get_pc(0) == cmd_options.log_at_pc) {
-                        get_logger().setLogLevel(LOG_DEBUG);
-                    } else if (thread_get_pc(0) == cmd_options.stop_log_at_pc) {
-                        get_logger().setLogLevel(LOG_INFO);
-                    }
-
-                    // Executes the instruction
-                    hart->execute();
-                    hart->notify_pmu_minion_event(PMU_MINION_EVENT_RETIRED_INST0 + (thread_id & 1));
-                    hart->advance_pc();
-                }
-            }
-            catch (const bemu::Debug_entry& e) {
-                hart->enter_debug_mode(e.cause);
-            }
-            catch (const bemu::Trap& t) {
-                uint64_t old_pc = hart->pc;
-                hart->take_trap(t);
-                hart->advance_pc();
-                if (hart->pc == old_pc) {
-                    LOG_AGENT(FTL, *hart, "Trapping to the same address that "
-                              "caused a trap (0x%" PRIx64 "). Avoiding "
-                              "infinite trap recursion.", hart->pc);
-                }
-            }
-            catch (const bemu::instruction_restart) {
-                LOG_AGENT(DEBUG, *hart, "%s", "Instruction killed and will be restarted");
-            }
-            catch (const bemu::memory_error& e) {
-                hart->advance_pc();
-                hart->raise_interrupt(BUS_ERROR_INTERRUPT, e.addr);
-            }
-            catch (const std::exception& e) {
-                LOG_AGENT(FTL, *hart, "%s", e.what());
-            }
-
-            // Check for single-step mode
-            if ((gdbstub_get_status() == GDBSTUB_STATUS_RUNNING) && single_step[thread_id]) {
-                if (!step_range[thread_id].contains(hart->pc)) {
-                    LOG_AGENT(DEBUG, *hart, "%s", "Single-step done");
-                    gdbstub_signal_break(thread_id);
-                    single_step[thread_id] = false;
-                    hart->enter_debug_mode(bemu::Debug_entry::Cause::haltreq);
-                    continue;
                 }
             }
         }
 
-        ++emu_cycle;
+        emu_cycle += quantum;
     }
 
     const auto elapsed = std::chrono::high_resolution_clock::now() - start_time;
@@ -757,6 +1040,152 @@ int sys_emu::main_internal() {
         rv = EXIT_FAILURE;
     }
 
+    return rv;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Batch of tests run from a snapshot of the system after the reset and the
+// images loading, so each one only pays for loading its own ELF files. The
+// memory is restored copy-on-write (see bemu::System::take_snapshot()), the
+// state of the peripherals is not restored.
+////////////////////////////////////////////////////////////////////////////////
+
+int
+sys_emu::run_batch()
+{
+    if (cmd_options.gdb || api_listener) {
+        LOG_AGENT(FTL, agent, "%s", "-batch can't be used with the debugger or the runtime API");
+    }
+
+    // One test per line, the ELF files to load separated by spaces
+    std::vector<std::vector<std::string>> tests;
+    std::ifstream file(cmd_options.batch_file);
+    if (!file.is_open()) {
+        LOG_AGENT(FTL, agent, "Error opening batch file \"%s\"", cmd_options.batch_file.c_str());
+    }
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream ss(line);
+        std::vector<std::string> elfs;
+        std::string elf;
+        while (ss >> elf) {
+            elfs.push_back(elf);
+        }
+        if (!elfs.empty() && (elfs.front()[0] != '#')) {
+            tests.push_back(std::move(elfs));
+        }
+    }
+
+    bemu::System::Snapshot snapshot;
+    try {
+        chip.take_snapshot(snapshot);
+    }
+    catch (const std::exception& e) {
+        LOG_AGENT(FTL, agent, "Error taking the batch snapshot: %s", e.what());
+    }
+    const uint64_t start_cycle = emu_cycle;
+
+    const size_t jobs = std::min<size_t>(std::max(cmd_options.batch_jobs, 1u), tests.size());
+    if (jobs <= 1) {
+        return run_batch_tests(tests, snapshot, start_cycle, 0, 1);
+    }
+
+    // The children inherit what is buffered
+    std::cout.flush();
+    log_file.flush();
+    std::vector<pid_t> children;
+    for (size_t job = 0; job < jobs; ++job) {
+        const pid_t pid = fork();
+        if (pid < 0) {
+            LOG_AGENT(FTL, agent, "%s", "Error forking the batch jobs");
+        }
+        if (pid == 0) {
+            const int rv = run_batch_tests(tests, snapshot, start_cycle, job, jobs);
+            std::cout.flush();
+            log_file.flush();
+            _exit(rv);
+        }
+        children.push_back(pid);
+    }
+
+    int rv = EXIT_SUCCESS;
+    for (pid_t pid : children) {
+        int status = 0;
+        if ((waitpid(pid, &status, 0) != pid) || !WIFEXITED(status) || (WEXITSTATUS(status) != EXIT_SUCCESS)) {
+            rv = EXIT_FAILURE;
+        }
+    }
+    return rv;
+}
+
+
+int
+sys_emu::run_batch_tests(const std::vector<std::vector<std::string>>& tests,
+                         const bemu::System::Snapshot& snapshot, uint64_t start_cycle,
+                         size_t first, size_t stride)
+{
+    size_t count = 0;
+    size_t failures = 0;
+    for (size_t i = first; i < tests.size(); i += stride) {
+        const auto start_time = std::chrono::steady_clock::now();
+        try {
+            chip.restore_snapshot(snapshot);
+        }
+        catch (const std::exception& e) {
+            LOG_AGENT(FTL, agent, "Error restoring the batch snapshot: %s", e.what());
+        }
+        emu_cycle = start_cycle;
+
+        std::string name;
+        bool loaded = true;
+        for (const auto& elf : tests[i]) {
+            name += (name.empty() ? "" : " ") + elf;
+            try {
+                chip.load_elf(elf.c_str());
+            }
+            catch (const std::exception& e) {
+                LOG_AGENT(ERR, agent, "Error loading ELF \"%s\": %s", elf.c_str(), e.what());
+                loaded = false;
+                break;
+            }
+        }
+
+        const int rv = loaded ? run() : EXIT_FAILURE;
+        const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time);
+        LOG_AGENT(INFO, agent, "Batch test %zu %s (%" PRIu64 " cycles, %lf sec): %s", i,
+                  (rv == EXIT_SUCCESS) ? "PASS" : "FAIL", emu_cycle - start_cycle, elapsed.count(), name.c_str());
+        ++count;
+        failures += (rv != EXIT_SUCCESS);
+    }
+    LOG_AGENT(INFO, agent, "Batch tests: %zu passed, %zu failed", count - failures, failures);
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Main function implementation
+////////////////////////////////////////////////////////////////////////////////
+
+int sys_emu::main_internal() {
+#ifdef HAVE_BACKTRACE
+    Crash_handler __crash_handler;
+#endif
+
+#ifdef SYSEMU_PROFILING
+    profiling_init(this);
+#endif
+
+    if (!cmd_options.batch_file.empty()) {
+        return run_batch();
+    }
+
+    if (cmd_options.gdb) {
+        gdbstub_init(this, &chip);
+    }
+
+    int rv = run();
+
     // Checks that the tensor store are drained
     if(tstore_check)
         tstore_checker_.is_empty();
@@ -777,6 +1206,23 @@ int sys_emu::main_internal() {
                         cmd_options.dump_mem.c_str(), chip.memory.first(),
                         (chip.memory.last() - chip.memory.first()) + 1);
     }
+
+    if (!cmd_options.snapshot_save.empty()) {
+        LOG_AGENT(INFO, agent, "Saving snapshot: \"%s\"", cmd_options.snapshot_save.c_str());
+        try {
+            std::ofstream file;
+            file.exceptions(std::ofstream::failbit | std::ofstream::badbit);
+            file.open(cmd_options.snapshot_save, std::ios::out | std::ios::binary | std::ios::trunc);
+            lz4_stream::ostream comp{file};
+            comp.write(reinterpret_cast<const char*>(&emu_cycle), sizeof(emu_cycle));
+            chip.save_snapshot(comp);
+            comp.close();
+        }
+        catch (const std::exception& e) {
+            LOG_AGENT(ERR, agent, "Error saving snapshot \"%s\": %s", cmd_options.snapshot_save.c_str(), e.what());
+            rv = EXIT_FAILURE;
+        }
+    }
 #if EMU_HAS_PU
     if (!cmd_options.pu_uart0_rx_file.empty()) {
         close(chip.pu_uart0_get_rx_fd());
@@ -806,6 +1252,9 @@ int sys_emu::main_internal() {
         close(chip.spio_uart1_get_tx_fd());
     }
 #endif // EMU_HAS_SPIO
+    if (pc_sampler) {
+        pc_sampler->dump(cmd_options.prof_sample_file, cmd_options.elf_files);
+    }
 #ifdef SYSEMU_PROFILING
     if (!cmd_options.dump_prof_file.empty()) {
         profiling_flush();
@@ -25,6 +25,8 @@
 #include "checkers/l2_scp_checker.h"
 #include "checkers/mem_checker.h"
 #include "checkers/tstore_checker.h"
+#include "pc_sampler.h"
+#include "timing_model.h"
 #ifndef SDK_RELEASE
 #include "checkers/vpurf_checker.h"
 #endif
@@ -91,6 +93,12 @@ struct sys_emu_cmd_options {
     std::vector<dump_info> dump_at_end;
     std::unordered_multimap<uint64_t, dump_info> dump_at_pc;
     std::string dump_mem;
+    std::string snapshot_load;
+    std::string snapshot_save;
+    bool        share_images                 = false;
+    std::string batch_file;
+    unsigned    batch_jobs                   = 1;
+    std::string api_replay;
 
     uint64_t    reset_pc                     = RESET_PC;
 
@@ -102,6 +110,8 @@ struct sys_emu_cmd_options {
 
     bool        coherency_check              = false;
     uint64_t    max_cycles                   = 10000000;
+    uint64_t    quantum                      = 1;
+    bool        translate                    = false;
     bool        mins_dis                     = false;
     bool        sp_dis                       = false; // SVCPROC
     uint32_t    mem_reset                    = 0;
@@ -140,6 +150,15 @@ struct sys_emu_cmd_options {
     uint64_t    tstore_checker_log_addr      = 1;
     uint32_t    tstore_checker_log_thread    = 4096;
 
+    std::string prof_sample_file;
+    uint64_t    prof_sample_period           = 10000;
+
+    bool        timing_model                 = false;
+    std::string timing_config;
+
+    uint64_t    pcie_dma_bandwidth           = 0;
+    uint64_t    pcie_dma_latency             = 0;
+
 #ifdef SYSEMU_PROFILING
     std::string dump_prof_file;
 #endif
@@ -240,6 +259,11 @@ public:
 
     bool parse_mem_file(const char* filename);
 
+    // Loads the preloads, ELF files, memory description and files to memory
+    void load_images();
+    // Same, or maps them from another instance of this process that loaded the same ones
+    void load_shared_images();
+
     api_communicate* get_api_communicate() { return api_listener; }
 
     testLog& get_logger() { return chip.log; }
@@ -265,6 +289,15 @@ private:
         }
     };
 
+    // Runs the system till it is done, returns the exit status
+    int run();
+    // Runs the tests of the batch file from a snapshot of the system
+    int run_batch();
+    // Runs the batch tests from @first every @stride
+    int run_batch_tests(const std::vector<std::vector<std::string>>& tests,
+                        const bemu::System::Snapshot& snapshot, uint64_t start_cycle,
+                        size_t first, size_t stride);
+
     bemu::System    chip;
 
     std::ofstream   log_file;
@@ -286,6 +319,8 @@ private:
     std::unordered_set<uint64_t> breakpoints;
     std::bitset<EMU_NUM_THREADS> single_step;
     std::array<Addr_range, EMU_NUM_THREADS> step_range;
+    std::unique_ptr<Pc_sampler> pc_sampler;
+    std::unique_ptr<Timing_model> timing_model;
 
     bemu::Noagent   agent{&chip, "SYS-EMU"};
 
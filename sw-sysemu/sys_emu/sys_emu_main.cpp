@@ -3,6 +3,7 @@
 * SPDX-License-Identifier: Apache-2.0
 *-------------------------------------------------------------------------*/
 
+#include "api_replay.h"
 #include "sys_emu.h"
 
 #include <cstdlib>
@@ -26,6 +27,17 @@ int main(int argc, char * argv[])
         return EXIT_FAILURE;
     }
 
-    std::unique_ptr<sys_emu> emu(new sys_emu(cmd_options));
+    std::unique_ptr<api_communicate> api_comm;
+    if (!cmd_options.api_replay.empty()) {
+        try {
+            api_comm = std::unique_ptr<api_communicate>(new api_replayer(cmd_options.api_replay));
+        }
+        catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::unique_ptr<sys_emu> emu(new sys_emu(cmd_options, api_comm.get()));
     return emu.get()->main_internal();
 }
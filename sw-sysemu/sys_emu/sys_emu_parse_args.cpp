@@ -51,6 +51,8 @@ static const char * help_msg =
 "     -set_xreg <t>,<r>,<val>  Sets the xregister (integer) <r> of thread <t> to value <val>. <t> can be 'sp' for the Service Processor\n"
 #endif // SDK_RELEASE
 "     -max_cycles <cycles>     Stops execution after provided number of cycles (default: 10M)\n"
+"     -quantum <cycles>        Cycles each hart runs before the next one, on a single host thread; skews the hart wakeups and the peripherals by up to <cycles>, ignored with -gdb (default: 1)\n"
+"     -translate               Run the scalar code as translated blocks of pre-decoded instructions, ignored with -gdb, -timing_model and the logging/dump triggers\n"
 #ifndef SDK_RELEASE
 "     -mem_reset <byte>        Reset value of main memory (default: 0)\n"
 "     -mem_reset32 <uint32>    Reset value of main memory (default: 0)\n"
@@ -78,6 +80,12 @@ static const char * help_msg =
 "     -dump_size <size>        At the end of simulation, size of the dump. Only valid if -dump_file is used\n"
 "     -dump_file <path>        At the end of simulation, file in which to dump\n"
 "     -dump_mem <path>         At the end of simulation, file where to dump ALL the memory content\n"
+"     -snapshot_load <path>    Restore the harts, system registers and memory from a snapshot before starting\n"
+"     -snapshot_save <path>    At the end of simulation, save the harts, system registers and memory to a snapshot\n"
+"     -api_replay <path>       Replay the host interactions recorded by a runtime run (SysEmuOptions::apiRecordPath) with no host attached\n"
+"     -share_images            Map the loaded memory images copy-on-write from other instances of this process that loaded the same ones\n"
+"     -batch <path>            Run the tests listed in a file, one per line with the ELF files to load, each one from a snapshot taken after the reset and the images loading\n"
+"     -batch_jobs <n>          Run the -batch tests in n processes forked from the snapshot (default: 1)\n"
 "     -dump_at_pc_pc <PC>      Dump when PC M0:T0 reaches this PC\n"
 "     -dump_at_pc_addr <addr>  Address where to start the dump\n"
 "     -dump_at_pc_size <size>  Size of the dump\n"
@@ -104,6 +112,12 @@ static const char * help_msg =
 "     -gdb                     Start the GDB stub for remote debugging at the start of simulation\n"
 "     -gdb_at_pc <PC>          Start the GDB stub for remote debugging at a given PC\n"
 "     -gdb_on_umode            Start the GDB stub once any hart enters in user mode\n"
+"     -prof_sample <path>      Sample the PC of the active harts and write them as folded stacks at the end of the simulation\n"
+"     -prof_sample_period <cycles> Cycles between PC samples (default: 10000)\n"
+"     -timing_model            Stall the harts for the estimated latency of each instruction so cycle counts approximate the device\n"
+"     -timing_config <path>    File of '<latency name> <cycles>' lines overriding the latencies of -timing_model\n"
+"     -pcie_dma_bandwidth <MB/s> Delay the PCIe DMA done interrupts as if the transfers ran at this bandwidth (default: 0 [no delay])\n"
+"     -pcie_dma_latency <cycles> Cycles added to each PCIe DMA transfer list with -pcie_dma_bandwidth (default: 0)\n"
 #ifdef SYSEMU_PROFILING
 "     -dump_prof <path>        Path to the file in which to dump the profiling content at the end of the simulation\n"
 #endif
@@ -184,6 +198,8 @@ sys_emu::parse_command_line_arguments(int argc, char* argv[])
         {"set_xreg",               required_argument, nullptr, 0},
 #endif
         {"max_cycles",             required_argument, nullptr, 0},
+        {"quantum",                required_argument, nullptr, 0},
+        {"translate",              no_argument,       nullptr, 0},
 #ifndef SDK_RELEASE
         {"mem_reset",              required_argument, nullptr, 0},
         {"mem_reset32",            required_argument, nullptr, 0},
@@ -212,6 +228,12 @@ sys_emu::parse_command_line_arguments(int argc, char* argv[])
         {"dump_size",              required_argument, nullptr, 0},
         {"dump_file",              required_argument, nullptr, 0},
         {"dump_mem",               required_argument, nullptr, 0},
+        {"snapshot_load",          required_argument, nullptr, 0},
+        {"snapshot_save",          required_argument, nullptr, 0},
+        {"share_images",           no_argument,       nullptr, 0},
+        {"batch",                  required_argument, nullptr, 0},
+        {"batch_jobs",             required_argument, nullptr, 0},
+        {"api_replay",             required_argument, nullptr, 0},
         {"dump_at_pc_pc",          required_argument, nullptr, 0},
         {"dump_at_pc_addr",        required_argument, nullptr, 0},
         {"dump_at_pc_size",        required_argument, nullptr, 0},
@@ -239,6 +261,12 @@ sys_emu::parse_command_line_arguments(int argc, char* argv[])
         {"gdb_at_pc",              required_argument, nullptr, 0},
         {"gdb_on_umode",           no_argument,       nullptr, 0},   
         {"m",                      no_argument,       nullptr, 0},
+        {"prof_sample",            required_argument, nullptr, 0},
+        {"prof_sample_period",     required_argument, nullptr, 0},
+        {"timing_model",           no_argument,       nullptr, 0},
+        {"timing_config",          required_argument, nullptr, 0},
+        {"pcie_dma_bandwidth",     required_argument, nullptr, 0},
+        {"pcie_dma_latency",       required_argument, nullptr, 0},
 #ifdef SYSEMU_PROFILING
         {"dump_prof",              required_argument, nullptr, 0},
 #endif
@@ -417,6 +445,17 @@ sys_emu::parse_command_line_arguments(int argc, char* argv[])
         {
             sscanf(optarg, "%" SCNu64, &cmd_options.max_cycles);
         }
+        else if (!strcmp(name, "quantum"))
+        {
+            sscanf(optarg, "%" SCNu64, &cmd_options.quantum);
+            if (cmd_options.quantum == 0) {
+                SE_ERROR("Command line option '-quantum': Must be at least 1");
+            }
+        }
+        else if (!strcmp(name, "translate"))
+        {
+            cmd_options.translate = true;
+        }
         else if (!strcmp(name, "mem_reset"))
         {
           cmd_options.mem_reset = strtol(optarg, NULL, 0) & 0xFF;
@@ -501,6 +540,30 @@ sys_emu::parse_command_line_arguments(int argc, char* argv[])
         {
             cmd_options.dump_mem = optarg;
         }
+        else if (!strcmp(name, "snapshot_load"))
+        {
+            cmd_options.snapshot_load = optarg;
+        }
+        else if (!strcmp(name, "snapshot_save"))
+        {
+            cmd_options.snapshot_save = optarg;
+        }
+        else if (!strcmp(name, "share_images"))
+        {
+            cmd_options.share_images = true;
+        }
+        else if (!strcmp(name, "batch"))
+        {
+            cmd_options.batch_file = optarg;
+        }
+        else if (!strcmp(name, "batch_jobs"))
+        {
+            sscanf(optarg, "%u", &cmd_options.batch_jobs);
+        }
+        else if (!strcmp(name, "api_replay"))
+        {
+            cmd_options.api_replay = optarg;
+        }
         else if (!strcmp(name, "dump_at_pc_pc"))
         {
             sscanf(optarg, "%" PRIx64, &dump_at_pc_pc);
@@ -608,6 +671,33 @@ sys_emu::parse_command_line_arguments(int argc, char* argv[])
         {
             SE_WARN("Ignoring deprecated option '-m'");
         }
+        else if (!strcmp(name, "prof_sample"))
+        {
+            cmd_options.prof_sample_file = optarg;
+        }
+        else if (!strcmp(name, "prof_sample_period"))
+        {
+            sscanf(optarg, "%" SCNu64, &cmd_options.prof_sample_period);
+            if (cmd_options.prof_sample_period == 0) {
+                SE_ERROR("Command line option '-prof_sample_period': Must be at least 1");
+            }
+        }
+        else if (!strcmp(name, "timing_model"))
+        {
+            cmd_options.timing_model = true;
+        }
+        else if (!strcmp(name, "timing_config"))
+        {
+            cmd_options.timing_config = optarg;
+        }
+        else if (!strcmp(name, "pcie_dma_bandwidth"))
+        {
+            sscanf(optarg, "%" SCNu64, &cmd_options.pcie_dma_bandwidth);
+        }
+        else if (!strcmp(name, "pcie_dma_latency"))
+        {
+            sscanf(optarg, "%" SCNu64, &cmd_options.pcie_dma_latency);
+        }
 #ifdef SYSEMU_PROFILING
         else if (!strcmp(name, "dump_prof"))
         {
@@ -3,6 +3,7 @@
 
 sysemu_hdrs := \
     sys_emu/api_communicate.h \
+    sys_emu/api_replay.h \
     sys_emu/checkers/flb_checker.h \
     sys_emu/checkers/l1_scp_checker.h \
     sys_emu/checkers/l2_scp_checker.h \
@@ -11,11 +12,14 @@ sysemu_hdrs := \
     sys_emu/checkers/vpurf_checker.h \
     sys_emu/gdbstub.h \
     sys_emu/log.h \
+    sys_emu/pc_sampler.h \
     sys_emu/sys_emu.h \
     sys_emu/testLog.h \
+    sys_emu/timing_model.h \
     sys_emu/utils.h
 
 sysemu_cpp_srcs := \
+    sys_emu/api_replay.cpp \
     sys_emu/checkers/flb_checker.cpp \
     sys_emu/checkers/l1_scp_checker.cpp \
     sys_emu/checkers/l2_scp_checker.cpp \
@@ -24,10 +28,12 @@ sysemu_cpp_srcs := \
     sys_emu/checkers/vpurf_checker.cpp \
     sys_emu/gdbstub.cpp \
 	sys_emu/log.cpp \
+    sys_emu/pc_sampler.cpp \
     sys_emu/sys_emu.cpp \
     sys_emu/sys_emu_main.cpp \
     sys_emu/sys_emu_parse_args.cpp \
     sys_emu/testLog.cpp \
+    sys_emu/timing_model.cpp \
     sys_emu/utils.cpp
 
 ifneq ($(PROFILING),0)
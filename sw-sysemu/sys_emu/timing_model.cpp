@@ -0,0 +1,196 @@
+/*-------------------------------------------------------------------------
+* Copyright (c) 2025 Ainekko, Co.
+* SPDX-License-Identifier: Apache-2.0
+*-------------------------------------------------------------------------*/
+
+#include "timing_model.h"
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include "memmap.h"
+#include "processor.h"
+
+namespace {
+
+// RISC-V major opcodes (bits 6:0) the model tells apart
+constexpr uint32_t opcode_op     = 0x33;
+constexpr uint32_t opcode_op_32  = 0x3B;
+constexpr uint32_t opcode_op_fp  = 0x53;
+constexpr uint32_t opcode_branch = 0x63;
+constexpr uint32_t opcode_jalr   = 0x67;
+constexpr uint32_t opcode_jal    = 0x6F;
+constexpr uint32_t opcode_system = 0x73;
+
+constexpr uint32_t csr_tensor_wait = 0x830;
+
+constexpr uint64_t scratchpad_base = 0x0080000000ULL;
+
+} // namespace
+
+
+bool Timing_config::load(const std::string& filename, std::string& error)
+{
+    const std::map<std::string, uint64_t*> fields = {
+        {"alu", &alu}, {"mul", &mul}, {"div", &div}, {"fp", &fp}, {"fp_div", &fp_div},
+        {"branch", &branch}, {"l1", &l1}, {"l2_scp", &l2_scp}, {"noc_hop", &noc_hop},
+        {"dram", &dram}, {"dram_busy", &dram_busy}, {"io", &io}, {"tload_line", &tload_line},
+        {"tfma_pass", &tfma_pass}, {"tquant_step", &tquant_step}, {"tstore_line", &tstore_line},
+        {"treduce_reg", &treduce_reg},
+    };
+
+    std::ifstream file(filename);
+    if (!file) {
+        error = "Cannot open " + filename;
+        return false;
+    }
+    std::string line;
+    for (unsigned number = 1; std::getline(file, line); ++number) {
+        line = line.substr(0, line.find('#'));
+        std::istringstream is(line);
+        std::string name;
+        uint64_t value;
+        if (!(is >> name)) {
+            continue;
+        }
+        auto field = fields.find(name);
+        if ((field == fields.end()) || !(is >> value)) {
+            error = filename + ":" + std::to_string(number) + ": Expected '<latency name> <cycles>'";
+            return false;
+        }
+        *field->second = value;
+    }
+    return true;
+}
+
+
+Timing_model::Timing_model(const Timing_config& config)
+    : config(config),
+      ready(EMU_NUM_THREADS, 0),
+      mem_pending(EMU_NUM_THREADS, 0),
+      tensor_pending(EMU_NUM_MINIONS, 0),
+      tensor_free(EMU_NUM_MINIONS, 0),
+      l1(EMU_NUM_MINIONS * L1D_NUM_SETS)
+{
+}
+
+
+unsigned Timing_model::core(const bemu::Hart& cpu)
+{
+    return bemu::core_index(cpu);
+}
+
+
+bool Timing_model::l1_lookup(unsigned core, uint64_t paddr)
+{
+    // Tag 0 marks an empty way, so store the line number plus one
+    const uint64_t tag = paddr / L1D_LINE_SIZE + 1;
+    auto& tags = l1[core * L1D_NUM_SETS + (tag - 1) % L1D_NUM_SETS].tags;
+    auto way = std::find(tags.begin(), tags.end(), tag);
+    const bool hit = (way != tags.end());
+    if (!hit) {
+        way = tags.end() - 1;
+    }
+    std::rotate(tags.begin(), way, way + 1);
+    tags.front() = tag;
+    return hit;
+}
+
+
+void Timing_model::mem_access(const bemu::Hart& cpu, uint64_t paddr)
+{
+    const unsigned thread = bemu::hart_index(cpu);
+    const uint8_t  odd = bemu::index_in_core(cpu) & 1;
+
+    if (bemu::paddr_is_io_space(paddr) || bemu::paddr_is_esr_space(paddr) ||
+        bemu::paddr_is_pcie_space(paddr) || bemu::paddr_is_dram_uncacheable(paddr)) {
+        mem_pending[thread] += config.io;
+        return;
+    }
+
+    cpu.notify_pmu_minion_event(PMU_MINION_EVENT_DCACHE_ACCESS0 + odd);
+    if (l1_lookup(core(cpu), paddr)) {
+        mem_pending[thread] += config.l1;
+        return;
+    }
+    cpu.notify_pmu_minion_event(PMU_MINION_EVENT_DCACHE_MISSES0 + odd);
+
+    if (bemu::paddr_is_scratchpad(paddr)) {
+        // Shire 255 is the local shire
+        const unsigned shire = ((paddr - scratchpad_base) >> 23) & 255;
+        const bool local = (shire == 255) || (bemu::shireindex(shire) == bemu::shire_index(cpu));
+        mem_pending[thread] += config.l2_scp + (local ? 0 : config.noc_hop);
+        return;
+    }
+
+    // DRAM, and everything else the L2 forwards to the memshires
+    cpu.notify_pmu_minion_event(PMU_MINION_EVENT_L2_MISS_REQ);
+    auto& free = memshire_free[(paddr / L1D_LINE_SIZE) % TIMING_MEM_CHANNELS];
+    const uint64_t start = std::max(now, free);
+    free = start + config.dram_busy;
+    mem_pending[thread] += (start - now) + config.dram;
+}
+
+
+void Timing_model::retire(const bemu::Hart& cpu)
+{
+    const unsigned thread = bemu::hart_index(cpu);
+    const unsigned minion = core(cpu);
+    const uint32_t bits = cpu.inst.bits;
+
+    uint64_t latency = config.alu;
+    if ((bits & 3) != 3) {
+        // Compressed: only the branches and jumps of quadrant 1 and c.jr/c.jalr stand out
+        const uint32_t funct3 = (bits >> 13) & 7;
+        const uint32_t quadrant = bits & 3;
+        if (((quadrant == 1) && (funct3 >= 5)) ||
+            ((quadrant == 2) && (funct3 == 4) && (((bits >> 2) & 0x1F) == 0) && (((bits >> 7) & 0x1F) != 0))) {
+            latency = config.branch;
+            cpu.notify_pmu_minion_event(PMU_MINION_EVENT_BRANCHES0 + (bemu::index_in_core(cpu) & 1));
+        }
+    } else {
+        const uint32_t opcode = bits & 0x7F;
+        const uint32_t funct3 = (bits >> 12) & 7;
+        const uint32_t funct7 = bits >> 25;
+        switch (opcode) {
+        case opcode_op:
+        case opcode_op_32:
+            if (funct7 == 1) {
+                latency = (funct3 >= 4) ? config.div : config.mul;
+            }
+            break;
+        case opcode_op_fp:
+            // fdiv and fsqrt
+            latency = (((funct7 >> 2) == 0x03) || ((funct7 >> 2) == 0x0B)) ? config.fp_div : config.fp;
+            break;
+        case 0x43: case 0x47: case 0x4B: case 0x4F: // fused multiply-add
+        case 0x0B: case 0x2B: case 0x5B: case 0x7B: // custom, the packed instructions
+            latency = config.fp;
+            break;
+        case opcode_branch:
+        case opcode_jal:
+        case opcode_jalr:
+            latency = config.branch;
+            cpu.notify_pmu_minion_event(PMU_MINION_EVENT_BRANCHES0 + (bemu::index_in_core(cpu) & 1));
+            break;
+        default:
+            break;
+        }
+    }
+
+    // A memory access takes the place of the pipeline latency, tensor
+    // operations only keep the tensor FSMs busy
+    latency = std::max(latency, mem_pending[thread]);
+    mem_pending[thread] = 0;
+    if (tensor_pending[minion] != 0) {
+        tensor_free[minion] = std::max(now, tensor_free[minion]) + tensor_pending[minion];
+        tensor_pending[minion] = 0;
+    }
+
+    uint64_t done = now + latency;
+    if (((bits & 0x7F) == opcode_system) && ((bits >> 20) == csr_tensor_wait) && (((bits >> 12) & 3) != 0)) {
+        done = std::max(done, tensor_free[minion]);
+    }
+    ready[thread] = done;
+}
@@ -0,0 +1,107 @@
+/*-------------------------------------------------------------------------
+* Copyright (c) 2025 Ainekko, Co.
+* SPDX-License-Identifier: Apache-2.0
+*-------------------------------------------------------------------------*/
+
+#ifndef BEMU_TIMING_MODEL_H
+#define BEMU_TIMING_MODEL_H
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "cache.h"
+#include "emu_defines.h"
+
+namespace bemu {
+struct Hart;
+}
+
+// Memory controllers the DRAM lines are interleaved over
+#ifdef NUM_MEM_SHIRES
+#define TIMING_MEM_CHANNELS NUM_MEM_SHIRES
+#else
+#define TIMING_MEM_CHANNELS 1
+#endif
+
+// Latencies of the timing model, in cycles. The defaults are ballpark
+// figures for kernel tuning, not measurements of the silicon; a file of
+// "name value" lines given with -timing_config overrides them.
+struct Timing_config
+{
+    uint64_t alu          = 1;  // integer and control instructions
+    uint64_t mul          = 3;
+    uint64_t div          = 20;
+    uint64_t fp           = 4;  // scalar and packed FP/vector instructions
+    uint64_t fp_div       = 20; // fdiv and fsqrt
+    uint64_t branch       = 2;
+    uint64_t l1           = 3;  // L1 data cache hit
+    uint64_t l2_scp       = 30; // L2 scratchpad of the own shire
+    uint64_t noc_hop      = 10; // added to L2 scratchpad accesses of other shires
+    uint64_t dram         = 150;
+    uint64_t dram_busy    = 8;  // cycles a memshire is busy with each line
+    uint64_t io           = 300; // ESRs, PCIe and SP space
+    uint64_t tload_line   = 4;  // tensor FSM occupancy per line or pass
+    uint64_t tfma_pass    = 16;
+    uint64_t tquant_step  = 8;
+    uint64_t tstore_line  = 4;
+    uint64_t treduce_reg  = 10;
+
+    // Returns false naming the offending line in @error
+    bool load(const std::string& filename, std::string& error);
+};
+
+
+// Cycle-approximate timing of the harts. Every retired instruction costs
+// its latency, or that of the memory level it accessed, and the
+// hart stalls in the main loop until those cycles have passed, so emu_cycle
+// (and with it mcycle, PMU_MINION_EVENT_CYCLES and the timestamps of the
+// firmware traces) advances like an in-order core would.
+//
+// Approximations: the L1 is a per minion 16x4 LRU tag array that ignores
+// the L1 scratchpad split; DRAM lines are interleaved over the memshires,
+// each one serving a line every dram_busy cycles, which is all there is of
+// NoC contention; the tensor FSMs of a minion are a single pipeline that
+// only a TensorWait stalls on. The harts run a quantum at a time, so the
+// memshires see the accesses out of order by up to a quantum: use
+// -quantum 1 when contention matters.
+class Timing_model
+{
+public:
+    explicit Timing_model(const Timing_config& config);
+
+    // Whether hart @thread is done with its last instruction and can issue
+    // the next one at @cycle
+    bool issue(unsigned thread, uint64_t cycle) {
+        now = cycle;
+        return cycle >= ready[thread];
+    }
+
+    // @cpu retired the instruction it issued last
+    void retire(const bemu::Hart& cpu);
+
+    // Called from the checker hooks while the instruction executes
+    void mem_access(const bemu::Hart& cpu, uint64_t paddr);
+    void tensor_op(const bemu::Hart& cpu, uint64_t cycles) { tensor_pending[core(cpu)] += cycles; }
+
+    const Timing_config& latencies() const { return config; }
+
+private:
+    static unsigned core(const bemu::Hart& cpu);
+    bool l1_lookup(unsigned core, uint64_t paddr);
+
+    struct L1_set {
+        std::array<uint64_t, L1D_NUM_WAYS> tags {};  // most recently used first, 0 is invalid
+    };
+
+    Timing_config                       config;
+    std::vector<uint64_t>               ready;          // per hart
+    std::vector<uint64_t>               mem_pending;    // per hart, memory cycles of the instruction
+    std::vector<uint64_t>               tensor_pending; // per minion, cycles to queue in the tensor FSMs
+    std::vector<uint64_t>               tensor_free;    // per minion
+    std::vector<L1_set>                 l1;             // per minion
+    std::array<uint64_t, TIMING_MEM_CHANNELS> memshire_free {};
+    uint64_t                            now = 0;        // cycle of the last issue
+};
+
+#endif // BEMU_TIMING_MODEL_H
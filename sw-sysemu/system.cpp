@@ -7,6 +7,13 @@
 #include <cfenv>        // FIXME: remove this when we purge std::fesetround() from the code!
 #include <cstring>
 #include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include "elfio/elfio.hpp"
 #include "emu_gio.h"
@@ -19,6 +26,116 @@
 namespace bemu {
 
 
+namespace {
+
+constexpr uint32_t snapshot_magic = 0x50414e53;  // "SNAP"
+
+// Bump it when the saved state changes
+constexpr uint32_t snapshot_version = 1;
+
+struct Snapshot_writer {
+    template<typename T>
+    void operator()(const T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshot state must be trivially copyable");
+        os.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+    std::ostream& os;
+};
+
+struct Snapshot_reader {
+    template<typename T>
+    void operator()(T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshot state must be trivially copyable");
+        is.read(reinterpret_cast<char*>(&value), sizeof(value));
+    }
+    std::istream& is;
+};
+
+// Architectural state of a hart. The run state and privilege level are
+// handled by the caller because they have side effects.
+template<typename Archive, typename HartType>
+void snapshot_hart_state(Archive& ar, HartType& cpu)
+{
+    ar(cpu.pc);
+    ar(cpu.xregs);
+    ar(cpu.fregs);
+    ar(cpu.mregs);
+    ar(cpu.fcsr);
+    ar(cpu.stvec);
+    ar(cpu.scounteren);
+    ar(cpu.sscratch);
+    ar(cpu.sepc);
+    ar(cpu.scause);
+    ar(cpu.stval);
+    ar(cpu.mstatus);
+    ar(cpu.medeleg);
+    ar(cpu.mideleg);
+    ar(cpu.mie);
+    ar(cpu.mtvec);
+    ar(cpu.mcounteren);
+    ar(cpu.mscratch);
+    ar(cpu.mepc);
+    ar(cpu.mcause);
+    ar(cpu.mtval);
+    ar(cpu.mip);
+    ar(cpu.tdata1);
+    ar(cpu.tdata2);
+    ar(cpu.dcsr);
+    ar(cpu.dpc);
+    ar(cpu.ddata0);
+    ar(cpu.minstmask);
+    ar(cpu.minstmatch);
+    ar(cpu.mbusaddr);
+    ar(cpu.tensor_conv_size);
+    ar(cpu.tensor_conv_ctrl);
+    ar(cpu.tensor_coop);
+    ar(cpu.tensor_mask);
+    ar(cpu.tensor_error);
+    ar(cpu.gsc_progress);
+    ar(cpu.validation0);
+    ar(cpu.validation1);
+    ar(cpu.validation2);
+    ar(cpu.validation3);
+    ar(cpu.portctrl);
+    ar(cpu.fcc);
+    ar(cpu.ext_seip);
+    ar(cpu.progbuf);
+}
+
+// State shared by the harts of a core. The tensor coprocessors are not
+// saved, snapshots must be taken with them idle.
+template<typename Archive, typename CoreType>
+void snapshot_core_state(Archive& ar, CoreType& core)
+{
+    ar(core.tenc);
+    ar(core.scp);
+    ar(core.scp_lock);
+    ar(core.scp_addr);
+    ar(core.satp);
+    ar(core.matp);
+    ar(core.menable_shadows);
+    ar(core.excl_mode);
+    ar(core.mcache_control);
+    ar(core.ucache_control);
+}
+
+template<typename Archive, typename SystemType>
+void snapshot_system_registers(Archive& ar, SystemType& chip)
+{
+    ar(chip.neigh_pmu_counters);
+    ar(chip.neigh_pmu_events);
+    ar(chip.neigh_esrs);
+    ar(chip.shire_cache_esrs);
+    ar(chip.shire_other_esrs);
+    ar(chip.broadcast_esrs);
+#if EMU_HAS_MEMSHIRE
+    ar(chip.mem_shire_esrs);
+#endif
+}
+
+} // namespace
+
+
 void System::init(Stepping ver)
 {
     stepping = ver;
@@ -374,10 +491,13 @@ void System::copy_memory_from_host_to_device(uint64_t from_addr, uint64_t to_add
 #ifdef SYS_EMU
     api_communicate *api_comm = emu()->get_api_communicate();
     if (api_comm) {
-        uint8_t *buff = new uint8_t[size];
-        api_comm->host_memory_read(from_addr, size, buff);
-        memory.write(noagent, to_addr, size, buff);
-        delete[] buff;
+        if (const void* src = api_comm->host_memory_map(from_addr, size)) {
+            memory.write(noagent, to_addr, size, src);
+        } else {
+            host_dma_buffer.resize(size);
+            api_comm->host_memory_read(from_addr, size, host_dma_buffer.data());
+            memory.write(noagent, to_addr, size, host_dma_buffer.data());
+        }
     } else {
         WARN_AGENT(other, noagent, "%s", "API Communicate is NULL!");
     }
@@ -394,10 +514,13 @@ void System::copy_memory_from_device_to_host(uint64_t from_addr, uint64_t to_add
 #ifdef SYS_EMU
     api_communicate *api_comm = emu()->get_api_communicate();
     if (api_comm) {
-        uint8_t *buff = new uint8_t[size];
-        memory.read(noagent, from_addr, size, buff);
-        api_comm->host_memory_write(to_addr, size, buff);
-        delete[] buff;
+        if (void* dst = api_comm->host_memory_map(to_addr, size)) {
+            memory.read(noagent, from_addr, size, dst);
+        } else {
+            host_dma_buffer.resize(size);
+            memory.read(noagent, from_addr, size, host_dma_buffer.data());
+            api_comm->host_memory_write(to_addr, size, host_dma_buffer.data());
+        }
     } else {
         WARN_AGENT(other, noagent, "%s", "API Communicate is NULL!");
     }
@@ -565,6 +688,12 @@ void System::load_elf(std::istream& stream)
 {
     ELFIO::elfio elf;
     elf.load(stream);
+    load_elf(elf);
+}
+
+
+void System::load_elf(const ELFIO::elfio& elf)
+{
     for (const ELFIO::segment* seg : elf.segments) {
         if (seg->get_type() != PT_LOAD)
             continue;
@@ -613,22 +742,145 @@ void System::load_elf(const char* filename)
 
 void System::load_raw(const char* filename, unsigned long long addr)
 {
-    std::ifstream file;
-    file.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-    file.open(filename, std::ios::in | std::ios::binary);
-    file.exceptions(std::ifstream::badbit);
-
-    char fbuf[65536];
-    while (true) {
-        file.read(fbuf, 65536);
-        std::streamsize count = file.gcount();
-        if (count <= 0)
-            break;
+    // Large test data goes through MainMemory::load_file(), which maps the
+    // file instead of copying it where the memory allows
+    const int fd = open(filename, O_RDONLY | O_CLOEXEC);
+    struct stat st;
+    if ((fd < 0) || (fstat(fd, &st) != 0)) {
+        const int error = errno;
+        if (fd >= 0)
+            close(fd);
+        throw std::system_error(error, std::generic_category(), filename);
+    }
+    try {
         if (addr >= MainMemory::dram_base)
             addr &= ~0x4000000000ULL;
-        memory.init(noagent, addr, count, reinterpret_cast<MainMemory::const_pointer>(fbuf));
-        addr += count;
+        if (st.st_size > 0)
+            memory.load_file(noagent, addr, st.st_size, fd, 0);
+    }
+    catch (...) {
+        close(fd);
+        throw;
+    }
+    close(fd);
+}
+
+
+void System::save_snapshot(std::ostream& os) const
+{
+    save_state(os);
+    memory.save(os);
+    if (!os) {
+        throw std::runtime_error("bemu::System::save_snapshot()");
+    }
+}
+
+
+void System::restore_snapshot(std::istream& is)
+{
+    restore_state(is, false);
+    memory.restore(is);
+    if (!is) {
+        throw std::runtime_error("bemu::System::restore_snapshot(): truncated snapshot");
+    }
+}
+
+
+void System::take_snapshot(Snapshot& snapshot)
+{
+    std::ostringstream os;
+    save_state(os);
+    if (!os) {
+        throw std::runtime_error("bemu::System::take_snapshot()");
+    }
+    snapshot.state = os.str();
+    memory.publish(snapshot.memory);
+}
+
+
+void System::restore_snapshot(const Snapshot& snapshot)
+{
+    std::istringstream is(snapshot.state);
+    restore_state(is, true);
+    if (!is) {
+        throw std::runtime_error("bemu::System::restore_snapshot(): truncated snapshot");
+    }
+    memory.adopt(snapshot.memory);
+    m_emu_done = false;
+    m_emu_fail = false;
+}
+
+
+void System::save_state(std::ostream& os) const
+{
+    Snapshot_writer ar{os};
+    ar(snapshot_magic);
+    ar(snapshot_version);
+    ar(static_cast<uint32_t>(EMU_NUM_THREADS));
+
+    for (const Hart& hart : cpu) {
+        if (hart.has_active_coprocessor()) {
+            LOG_HART(WARN, hart, "%s", "Saving a snapshot with an active coprocessor");
+        }
+        ar(hart.state);
+        ar(hart.waits);
+        ar(hart.prv);
+        snapshot_hart_state(ar, hart);
+    }
+    for (const Core& c : core) {
+        snapshot_core_state(ar, c);
+    }
+    snapshot_system_registers(ar, *this);
+}
+
+
+void System::restore_state(std::istream& is, bool same_system)
+{
+    // Only the waits that the rest of the system can end are restored, the
+    // tensor coprocessors are not part of the snapshot
+    const Hart::Waiting restored_waits = Hart::Waiting::interrupt | Hart::Waiting::message
+        | Hart::Waiting::credit0 | Hart::Waiting::credit1;
+
+    Snapshot_reader ar{is};
+    uint32_t magic = 0, version = 0, num_threads = 0;
+    ar(magic);
+    ar(version);
+    ar(num_threads);
+    if ((magic != snapshot_magic) || (version != snapshot_version) || (num_threads != EMU_NUM_THREADS)) {
+        throw std::runtime_error("bemu::System::restore_snapshot(): incompatible snapshot");
+    }
+
+    for (Hart& hart : cpu) {
+        Hart::State state;
+        Hart::Waiting waits;
+        Privilege prv;
+        ar(state);
+        ar(waits);
+        ar(prv);
+        snapshot_hart_state(ar, hart);
+        // The code under the fetch buffer and the translated blocks changes
+        hart.invalidate_fetch();
+        if (same_system && (state == Hart::State::nonexistent)) {
+            hart.become_nonexistent();
+            continue;
+        }
+        if (!same_system && hart.is_nonexistent()) {
+            continue;
+        }
+        // Harts halted in debug mode when saved restart running
+        hart.become_unavailable();
+        hart.debug_mode = false;
+        hart.set_prv(prv);
+        if (state >= Hart::State::active) {
+            hart.waits = waits & restored_waits;
+            hart.start_running();
+        }
+    }
+    for (Core& c : core) {
+        snapshot_core_state(ar, c);
+        c.flush_tlbs();
     }
+    snapshot_system_registers(ar, *this);
 }
 
 
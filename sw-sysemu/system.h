@@ -8,18 +8,28 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <algorithm>
 #include <array>
+#include <limits>
+#include <string>
 #include <vector>
 #include <bitset>
 
 #include "support/intrusive/list.h"
 #include "memory/main_memory.h"
+#include "memory/shared_image.h"
 #include "emu_defines.h"
 #include "esrs.h"
 #include "processor.h"
 #include "testLog.h"
+#include "utility.h"
 
 class sys_emu;
+class Timing_model;
+
+namespace ELFIO {
+class elfio;
+}
 
 namespace bemu {
 
@@ -117,8 +127,26 @@ public:
     // Preload memory
     void load_elf(std::istream&);
     void load_elf(const char* filename);
+    void load_elf(const ELFIO::elfio&);
     void load_raw(const char* filename, unsigned long long addr);
 
+    // Snapshots of the harts, cores, system registers and plain memory
+    void save_snapshot(std::ostream&) const;
+    void restore_snapshot(std::istream&);
+
+    // Snapshot kept in memory, see take_snapshot()
+    struct Snapshot {
+        std::string     state;      // harts, cores and system registers
+        Shared_image    memory;
+    };
+
+    // Same as save_snapshot(), but the plain memory is shared copy-on-write
+    // with the snapshot instead of copied, so restoring it only remaps the
+    // memory, dropping what was written since. Only this system can restore
+    // it, harts get back the existence they had when it was taken.
+    void take_snapshot(Snapshot&);
+    void restore_snapshot(const Snapshot&);
+
     // Reset state
     void debug_reset(unsigned shire);
     void begin_warm_reset(unsigned shire);
@@ -158,6 +186,8 @@ public:
     //
 
     void tick_peripherals(uint64_t cycle);
+    uint64_t peripherals_idle_cycles(uint64_t cycle) const;
+    void skip_peripherals(uint64_t cycle, uint64_t n);
     bool timers_active(void);
 
 #if EMU_HAS_SVCPROC
@@ -270,6 +300,17 @@ public:
     std::array<neigh_pmu_counters_t, EMU_NUM_NEIGHS>  neigh_pmu_counters {};
     std::array<neigh_pmu_events_t, EMU_NUM_NEIGHS>    neigh_pmu_events {};
 
+    // Optional timing model of the harts (sys_emu -timing_model), owned by sys_emu
+    Timing_model* timing_model = nullptr;
+
+    // PCIe DMA bandwidth model (sys_emu -pcie_dma_bandwidth): the done
+    // interrupts are delayed as if the transfers ran at this many MB/s, plus
+    // the latency in cycles per transfer list; 0 raises them at once
+    uint64_t pcie_dma_bandwidth = 0;
+    uint64_t pcie_dma_latency = 0;
+    // Cycle of the next delayed PCIe DMA done interrupt
+    uint64_t pcie_dma_next_event = std::numeric_limits<uint64_t>::max();
+
     // Cooperative tensor load tracking
     std::array<Coop_tload_table, EMU_NUM_NEIGHS>    coop_tloads {};
 
@@ -315,6 +356,12 @@ private:
     // Reset helpers
     void cold_reset_shire(unsigned shire);
 
+    // The snapshots but the plain memory. When @same_system is set the
+    // harts take the existence they had when saved, otherwise they keep
+    // the current one.
+    void save_state(std::ostream&) const;
+    void restore_state(std::istream&, bool same_system);
+
     // Message ports
     void write_msg_port_data_to_scp(Hart& cpu, unsigned id, uint32_t *data, uint8_t oob);
 
@@ -327,6 +374,9 @@ private:
     // Minionshire debug module
     uint32_t dmctrl;
 
+    // Bounce buffer of the DMAs from or to host memory that can't be mapped
+    std::vector<uint8_t> host_dma_buffer;
+
 #if EMU_HAS_SVCPROC
     // Service processor debug module
     uint32_t spdmctrl;
@@ -529,8 +579,47 @@ inline void System::tick_peripherals(uint64_t cycle)
 #endif
 
     }
+
+#if EMU_ETSOC1
+    if (cycle >= pcie_dma_next_event) {
+        pcie_dma_next_event = memory.pcie_dma_tick(noagent, cycle);
+    }
+#endif
 }
 
+// Cycles from @cycle before tick_peripherals() can raise an interrupt, or
+// the maximum value if no peripheral has an event scheduled
+inline uint64_t System::peripherals_idle_cycles(uint64_t cycle) const
+{
+    uint64_t cycles = std::numeric_limits<uint64_t>::max();
+#if EMU_HAS_WDT
+    cycles = std::min(cycles, memory.wdt_cycles_to_event(cycle));
+#endif
+#if EMU_HAS_PU || EMU_HAS_SPIO
+    cycles = std::min(cycles, cycles_before_tick(cycle, 100, memory.timers_ticks_to_event()));
+#endif
+#if EMU_ETSOC1
+    if (pcie_dma_next_event != std::numeric_limits<uint64_t>::max()) {
+        cycles = std::min(cycles, (pcie_dma_next_event > cycle) ? (pcie_dma_next_event - cycle) : 0);
+    }
+#endif
+    return cycles;
+}
+
+
+// Same as calling tick_peripherals() for the @n cycles from @cycle, for @n
+// not above peripherals_idle_cycles()
+inline void System::skip_peripherals(uint64_t cycle, uint64_t n)
+{
+#if EMU_HAS_WDT
+    memory.wdt_skip_cycles(cycle, n);
+#endif
+#if EMU_HAS_PU || EMU_HAS_SPIO
+    memory.timers_skip_ticks(ticks_in_cycles(cycle, 100, n));
+#endif
+}
+
+
 inline bool System::timers_active(void)
 {
 #if EMU_HAS_SPIO
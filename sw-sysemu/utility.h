@@ -7,6 +7,7 @@
 #define BEMU_UTILITY_H
 
 #include <cstdint>
+#include <limits>
 
 namespace bemu {
 
@@ -48,6 +49,26 @@ inline bool addr_is_size_aligned(uint64_t addr, size_t size)
 }
 
 
+// Clocks divided by @div tick on the cycles that are a multiple of @div.
+// Returns the number of cycles from @cycle before the @ticks-th tick, or the
+// maximum value if @ticks is the maximum value (no tick is expected).
+inline uint64_t cycles_before_tick(uint64_t cycle, uint64_t div, uint64_t ticks)
+{
+    constexpr uint64_t never = std::numeric_limits<uint64_t>::max();
+    const uint64_t first = (div - cycle % div) % div;
+    if ((ticks == never) || (ticks - 1 > (never - first) / div))
+        return never;
+    return first + (ticks - 1) * div;
+}
+
+
+// Number of ticks of a clock divided by @div in the @n cycles from @cycle
+inline uint64_t ticks_in_cycles(uint64_t cycle, uint64_t div, uint64_t n)
+{
+    return (cycle + n + div - 1) / div - (cycle + div - 1) / div;
+}
+
+
 } // namespace bemu
 
 #endif // BEMU_UTILITY_H
@@ -0,0 +1,121 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) 2025 Ainekko, Co.
+ * SPDX-License-Identifier: Apache-2.0
+ *-------------------------------------------------------------------------
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "etsoc/isa/hart.h"
+#include "etsoc/isa/atomic.h"
+#include "etsoc/common/collectives.h"
+#include "etsoc/common/utils.h"
+
+// Barrier latency against shire count.
+// Launched on the first num_shires shires with all the harts. For 1, 2, 4 ... num_shires shires
+// it times iterations barriers of all the harts of those shires, once with the hierarchical
+// barrier of collectives.h and once with a flat barrier (one global atomic counter all the harts
+// add to and spin on, gatomic_test_allt_same_addr style). Hart 0 writes one Result per shire count.
+// The coll_mem and flat_mem buffers must be zeroed before the launch.
+
+#define ALL_MINIONS 0xFFFFFFFFU
+#define FLB_ALL     0U
+#define FLB_SUBSET  8U
+
+typedef struct {
+  uint64_t shires;
+  uint64_t hier_cycles;  // per barrier
+  uint64_t flat_cycles;  // per barrier
+  uint64_t reserved[5];
+} Result;
+
+typedef struct {
+  uint32_t count;
+  uint8_t pad0[60];
+  uint32_t generation;
+  uint8_t pad1[60];
+} Flat_barrier;
+
+typedef struct {
+  et_coll_mem_t* coll_mem;  // 2 x sizeof(et_coll_mem_t)
+  Flat_barrier* flat_mem;
+  uint64_t num_shires;
+  uint64_t iterations;
+  Result* out_data;  // log2(num_shires) + 2 entries at most
+} Parameters;
+
+int64_t entry_point(const Parameters*);
+
+static inline void flat_barrier(Flat_barrier* barrier, uint32_t harts) {
+  uint32_t generation = atomic_load_global_32(&barrier->generation);
+
+  if (atomic_add_global_32(&barrier->count, 1) == (harts - 1)) {
+    atomic_store_global_32(&barrier->count, 0);
+    asm volatile("fence\n" ::: "memory");
+    atomic_add_global_32(&barrier->generation, 1);
+  } else {
+    while (atomic_load_global_32(&barrier->generation) == generation) {
+    }
+  }
+}
+
+int64_t entry_point(const Parameters* const params) {
+  if (params == NULL || params->coll_mem == NULL || params->flat_mem == NULL || params->out_data == NULL ||
+      params->num_shires == 0 || params->num_shires > ET_COLL_MAX_SHIRES || params->iterations == 0) {
+    // Bad arguments
+    return -1;
+  }
+
+  const uint64_t hart_id = get_hart_id();
+  const uint64_t shire = hart_id >> 6;
+  const uint64_t all_shires = (1ULL << params->num_shires) - 1;
+  et_coll_t all;
+
+  if (et_coll_init(&all, &params->coll_mem[0], all_shires, ALL_MINIONS, ALL_MINIONS, FLB_ALL, FCC_0) !=
+      ET_COLL_OPERATION_SUCCESS) {
+    return -1;
+  }
+
+  uint64_t phase = 0;
+  for (uint64_t shires = 1; shires <= params->num_shires; phase++) {
+    uint64_t hier_cycles = 0;
+    uint64_t flat_cycles = 0;
+
+    if (shire < shires) {
+      et_coll_t subset;
+      et_coll_init(&subset, &params->coll_mem[1], (1ULL << shires) - 1, ALL_MINIONS, ALL_MINIONS, FLB_SUBSET,
+                   FCC_1);
+
+      // Warm up, then time
+      et_coll_barrier(&subset);
+      uint64_t start = et_get_timestamp();
+      for (uint64_t i = 0; i < params->iterations; i++) {
+        et_coll_barrier(&subset);
+      }
+      hier_cycles = et_get_delta_timestamp(start);
+
+      flat_barrier(params->flat_mem, (uint32_t)(shires * 64));
+      start = et_get_timestamp();
+      for (uint64_t i = 0; i < params->iterations; i++) {
+        flat_barrier(params->flat_mem, (uint32_t)(shires * 64));
+      }
+      flat_cycles = et_get_delta_timestamp(start);
+    }
+
+    if (hart_id == 0) {
+      Result* result = &params->out_data[phase];
+      result->shires = shires;
+      result->hier_cycles = hier_cycles / params->iterations;
+      result->flat_cycles = flat_cycles / params->iterations;
+    }
+
+    // Keep the shires out of the subset waiting for the next shire count
+    et_coll_barrier(&all);
+
+    shires = ((shires < params->num_shires) && ((shires * 2) > params->num_shires)) ? params->num_shires
+                                                                                      : (shires * 2);
+  }
+
+  return 0;
+}
@@ -0,0 +1,56 @@
+#include "crc32.h"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <etsoc/isa/hart.h>
+#include <system/abi.h>
+
+// Check kernel of IRuntime::memcpyHostToDeviceChecked, loaded by the runtime
+// itself; the layout of the args must match the one it builds. The data is
+// split in chunks of chunk_size bytes (the last one may be shorter), the CRC32
+// of each one is computed by a single hart and written to crcs, which the
+// runtime compares with the host ones. The chunks are spread over the harts of
+// the shire mask
+typedef struct {
+  uint64_t data;
+  uint64_t size;
+  uint64_t chunk_size;
+  uint64_t chunk_count;
+  uint32_t* crcs;
+} Parameters;
+
+int64_t entry_point(const Parameters*, const kernel_environment_t*);
+
+int64_t entry_point(const Parameters* const params, const kernel_environment_t* const env)
+{
+    uint64_t shire = get_shire_id();
+    uint64_t shire_mask = env->shire_mask;
+
+    if (((shire_mask >> shire) & 1) == 0)
+    {
+        return 0;
+    }
+
+    if ((params->data % 4) || (params->chunk_size % 8))
+    {
+        // Insufficiently aligned data
+        return -2;
+    }
+
+    // index of the hart among the ones of the shire mask
+    uint64_t lower_shires = shire_mask & ((1ULL << shire) - 1);
+    uint64_t worker = (uint64_t)__builtin_popcountll(lower_shires) * 64 + (get_hart_id() & 63);
+    uint64_t num_workers = (uint64_t)__builtin_popcountll(shire_mask) * 64;
+
+    for (uint64_t i = worker; i < params->chunk_count; i += num_workers)
+    {
+        uint64_t offset = i * params->chunk_size;
+        uint64_t length = params->size - offset;
+        if (length > params->chunk_size)
+        {
+            length = params->chunk_size;
+        }
+        params->crcs[i] = crc32_8bytes((const void*)(params->data + offset), length, 0);
+    }
+    return 0;
+}
@@ -0,0 +1,86 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) 2025 Ainekko, Co.
+ * SPDX-License-Identifier: Apache-2.0
+ *-------------------------------------------------------------------------
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include "etsoc/isa/hart.h"
+#include "etsoc/common/gemm.h"
+#include "etsoc/common/utils.h"
+
+// GEMM benchmark.
+// Runs the GEMM (or implicit GEMM convolution) described by the parameters iterations times
+// on the shires of the launch, with the gemm.h library. The first hart of every minion reports
+// the cycles it took and the ops of the tiles it computed, so the host can add them up per
+// shire: achieved TOPS of a shire = sum(ops) / max(cycles) * minion clock / 1e12.
+
+// one cache line per hart in out_data
+typedef struct {
+  uint64_t hart_id;
+  uint64_t cycles;
+  uint64_t ops;
+  int64_t status;
+  uint64_t reserved[4];
+} Result;
+
+typedef struct {
+  et_gemm_t gemm;
+  et_gemm_conv_t conv;
+  uint64_t use_conv;
+  uint64_t num_shires;
+  uint64_t coop_loads;
+  uint64_t iterations;
+  Result* out_data;
+} Parameters;
+
+int64_t entry_point(const Parameters*);
+
+int64_t entry_point(const Parameters* const params) {
+  if (params == NULL || params->out_data == NULL || params->num_shires == 0 || params->iterations == 0) {
+    // Bad arguments
+    return -1;
+  }
+
+  uint64_t hart_id = get_hart_id();
+  if ((hart_id & 1) || ((hart_id >> 6) >= params->num_shires)) {
+    return 0;
+  }
+
+  et_gemm_t gemm = params->gemm;
+  gemm.conv = params->use_conv ? &params->conv : NULL;
+  et_gemm_workers_t workers = {
+    .first_shire = 0, .num_shires = (uint32_t)params->num_shires, .coop_loads = params->coop_loads != 0};
+
+  int64_t status = ET_GEMM_OPERATION_SUCCESS;
+  uint64_t start = et_get_timestamp();
+  for (uint64_t i = 0; (i < params->iterations) && (status == ET_GEMM_OPERATION_SUCCESS); i++) {
+    status = et_gemm(&gemm, &workers);
+  }
+  uint64_t cycles = et_get_delta_timestamp(start);
+
+  // ops of the tiles this minion computed, the same split et_gemm does
+  if (gemm.conv != NULL) {
+    et_gemm_from_conv(&gemm);
+  }
+  uint64_t minions = params->num_shires * ET_GEMM_NEIGHS_PER_SHIRE * ET_GEMM_MINIONS_PER_NEIGH;
+  uint64_t minion = hart_id >> 1;
+  uint64_t neigh = minion / ET_GEMM_MINIONS_PER_NEIGH;
+  uint64_t neighs = minions / ET_GEMM_MINIONS_PER_NEIGH;
+  uint64_t tile_rows = gemm.m / ET_GEMM_TILE_M;
+  uint64_t tile_cols = gemm.n / ET_GEMM_TILE_N;
+  uint64_t rows = (tile_rows > neigh) ? ((tile_rows - neigh + neighs - 1) / neighs) : 0;
+  uint64_t neigh_minion = minion % ET_GEMM_MINIONS_PER_NEIGH;
+  uint64_t cols = (tile_cols > neigh_minion)
+                    ? ((tile_cols - neigh_minion + ET_GEMM_MINIONS_PER_NEIGH - 1) / ET_GEMM_MINIONS_PER_NEIGH)
+                    : 0;
+
+  Result* result = &params->out_data[hart_id >> 1];
+  result->hart_id = hart_id;
+  result->cycles = cycles;
+  result->ops = rows * cols * 2 * ET_GEMM_TILE_M * ET_GEMM_TILE_N * gemm.k * params->iterations;
+  result->status = status;
+
+  return (status == ET_GEMM_OPERATION_SUCCESS) ? 0 : -1;
+}
@@ -0,0 +1,57 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <etsoc/common/heap.h>
+#include <etsoc/isa/hart.h>
+#include <system/abi.h>
+
+typedef struct {
+  uint64_t heap_base;   /* heap region set by the host, 0 if none */
+  uint64_t heap_size;
+  uint64_t block_size;  /* bytes allocated by each hart */
+  uint64_t *blocks;     /* block allocated by each hart, indexed by hart id */
+} kernel_args_t;
+
+int64_t entry_point(const kernel_args_t*, const kernel_environment_t*);
+
+int64_t entry_point(const kernel_args_t *kernel_args, const kernel_environment_t *kernel_env)
+{
+    uint64_t hart = get_hart_id();
+    uint64_t shire = hart >> 6;
+    uint64_t arena;
+    uint64_t address;
+    uint8_t *block;
+
+    /* The environment must describe the heap the host set */
+    if (kernel_env->heap_base != kernel_args->heap_base)
+    {
+        return -1;
+    }
+
+    block = et_heap_alloc(kernel_env, kernel_args->block_size);
+    if (kernel_args->heap_base == 0)
+    {
+        /* No heap, nothing to allocate from */
+        kernel_args->blocks[hart] = (uint64_t)(uintptr_t)block;
+        return (block == NULL) ? 0 : -1;
+    }
+    if ((kernel_env->heap_arena_size * KERNEL_HEAP_ARENA_COUNT) > kernel_args->heap_size)
+    {
+        return -1;
+    }
+
+    /* The block must be in the arena of the hart shire, the host checks they don't overlap */
+    arena = kernel_env->heap_base + (shire * kernel_env->heap_arena_size);
+    address = (uint64_t)(uintptr_t)block;
+    if ((block == NULL) || (address < arena + KERNEL_HEAP_ARENA_HEADER_SIZE) ||
+        ((address + kernel_args->block_size) > (arena + kernel_env->heap_arena_size)))
+    {
+        return -1;
+    }
+    for (uint64_t i = 0; i < kernel_args->block_size; i++)
+    {
+        block[i] = (uint8_t)hart;
+    }
+    kernel_args->blocks[hart] = address;
+
+    return 0;
+}
@@ -0,0 +1,51 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <etsoc/common/lz4.h>
+#include <etsoc/isa/hart.h>
+#include <system/abi.h>
+
+// Decompression kernel of IRuntime::memcpyHostToDeviceCompressed, loaded by the
+// runtime itself; the layout of the args must match the one it builds. Each
+// chunk is an LZ4 block expanded by a single hart, the chunks are spread over
+// the harts of the shire mask
+typedef struct {
+  uint64_t src;
+  uint64_t src_size;
+  uint64_t dst;
+  uint64_t dst_size;
+} Chunk;
+
+typedef struct {
+  uint64_t chunk_count;
+  Chunk chunks[];
+} Parameters;
+
+int64_t entry_point(const Parameters*, const kernel_environment_t*);
+
+int64_t entry_point(const Parameters* const params, const kernel_environment_t* const env)
+{
+    uint64_t shire = get_shire_id();
+    uint64_t shire_mask = env->shire_mask;
+
+    if (((shire_mask >> shire) & 1) == 0)
+    {
+        return 0;
+    }
+
+    // index of the hart among the ones of the shire mask
+    uint64_t lower_shires = shire_mask & ((1ULL << shire) - 1);
+    uint64_t worker = (uint64_t)__builtin_popcountll(lower_shires) * 64 + (get_hart_id() & 63);
+    uint64_t num_workers = (uint64_t)__builtin_popcountll(shire_mask) * 64;
+
+    for (uint64_t i = worker; i < params->chunk_count; i += num_workers)
+    {
+        const Chunk* chunk = &params->chunks[i];
+        int64_t size = et_lz4_decompress_block((const void*)chunk->src, chunk->src_size,
+                                               (void*)chunk->dst, chunk->dst_size);
+        if (size != (int64_t)chunk->dst_size)
+        {
+            return -1;
+        }
+    }
+    return 0;
+}
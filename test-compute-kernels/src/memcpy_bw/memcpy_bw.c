@@ -0,0 +1,87 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) 2025 Ainekko, Co.
+ * SPDX-License-Identifier: Apache-2.0
+ *-------------------------------------------------------------------------
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include "etsoc/isa/hart.h"
+#include "etsoc/common/utils.h"
+
+// Memcpy BW test.
+// Each hart copies its own chunk of src into dst with et_memcpy, sets it with et_memset and
+// compares it with et_memcmp, and reports the cycles each of them took. A plain byte loop copy
+// of the same chunk is timed too, as the baseline the word and vector paths are compared with.
+// srcOffset and dstOffset misalign the chunks, to time the unaligned paths as well.
+
+// Cycles of each operation, one cache line per hart in out_data
+typedef struct {
+  uint64_t hart_id;
+  uint64_t bytes;
+  uint64_t byte_loop_cycles;
+  uint64_t memcpy_cycles;
+  uint64_t memset_cycles;
+  uint64_t memcmp_cycles;
+  uint64_t memcmp_result;
+  uint64_t reserved;
+} Result;
+
+typedef struct {
+  const uint8_t* src;
+  uint8_t* dst;
+  uint64_t bytes_per_hart;
+  uint64_t src_offset;
+  uint64_t dst_offset;
+  uint64_t num_harts;
+  Result* out_data;
+} Parameters;
+
+int64_t entry_point(const Parameters*);
+
+__attribute__((__optimize__("-fno-tree-loop-distribute-patterns"))) static void byte_loop_copy(
+  uint8_t* dst, const uint8_t* src, uint64_t n) {
+  for (uint64_t i = 0; i < n; i++) {
+    dst[i] = src[i];
+  }
+}
+
+int64_t entry_point(const Parameters* const params) {
+  if (params == NULL || params->src == NULL || params->dst == NULL || params->out_data == NULL ||
+      params->bytes_per_hart == 0) {
+    // Bad arguments
+    return -1;
+  }
+
+  uint64_t hart_id = get_hart_id();
+  if (hart_id >= params->num_harts) {
+    return 0;
+  }
+
+  // chunks are padded by a cache line, so the offsets can't make them overlap
+  uint64_t stride = params->bytes_per_hart + 64;
+  const uint8_t* src = params->src + hart_id * stride + (params->src_offset & 63);
+  uint8_t* dst = params->dst + hart_id * stride + (params->dst_offset & 63);
+  uint64_t bytes = params->bytes_per_hart;
+  Result* result = &params->out_data[hart_id];
+
+  uint64_t start = et_get_timestamp();
+  byte_loop_copy(dst, src, bytes);
+  result->byte_loop_cycles = et_get_delta_timestamp(start);
+
+  start = et_get_timestamp();
+  et_memcpy(dst, src, bytes);
+  result->memcpy_cycles = et_get_delta_timestamp(start);
+
+  start = et_get_timestamp();
+  result->memcmp_result = (uint64_t)(int64_t)et_memcmp(dst, src, bytes);
+  result->memcmp_cycles = et_get_delta_timestamp(start);
+
+  start = et_get_timestamp();
+  et_memset(dst, (int)hart_id, bytes);
+  result->memset_cycles = et_get_delta_timestamp(start);
+
+  result->hart_id = hart_id;
+  result->bytes = bytes;
+  return 0;
+}
@@ -0,0 +1,273 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) 2025 Ainekko, Co.
+ * SPDX-License-Identifier: Apache-2.0
+ *-------------------------------------------------------------------------
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "etsoc/isa/hart.h"
+#include "etsoc/isa/atomic.h"
+#include "etsoc/isa/cacheops.h"
+#include "etsoc/common/collectives.h"
+#include "etsoc/common/utils.h"
+
+// Roofline microbenchmarks, one test per launch, driven by the roofline scenario of the runtime
+// benchmark suite which sweeps the shires, strides and working sets.
+// The first hart of every minion of the shires in shire_mask takes part, it writes the cycles of
+// the timed part and the operations it did to its Result (one per minion, indexed by hart_id >> 1):
+//  - ROOFLINE_LOAD_BW: loads of 8 bytes every stride bytes of the first working_set bytes of buffer,
+//    swept iterations times after a warm up sweep. If partitioned each minion sweeps its slice of
+//    the working set, otherwise all of them sweep the whole of it, from different offsets.
+//  - ROOFLINE_LOAD_LAT: the minions build a pointer chain in the working set, one element every
+//    stride bytes visited out of order, then the first minion chases it iterations times.
+//  - ROOFLINE_ATOMIC: iterations global atomic adds, to a cache line per minion if partitioned,
+//    otherwise all of them to the same one.
+//  - ROOFLINE_FMA: iterations blocks of ROOFLINE_FMA_BLOCK independent fmadd.ps (8 lanes).
+// The stride must be a power of two of at least 8 bytes and the working set a multiple of it. The
+// coll_mem buffer must be zeroed before the launch.
+
+#define ROOFLINE_LOAD_BW  0
+#define ROOFLINE_LOAD_LAT 1
+#define ROOFLINE_ATOMIC   2
+#define ROOFLINE_FMA      3
+
+#define ROOFLINE_FMA_BLOCK 24
+#define MINIONS_PER_SHIRE  32
+#define LINE_SIZE          64
+#define ALL_MINIONS        0xFFFFFFFFU
+
+// one cache line per minion in out_data
+typedef struct {
+  uint64_t hart_id;
+  uint64_t cycles;
+  uint64_t ops;  // loads, atomics or fmadd.ps
+  uint64_t checksum;
+  uint64_t reserved[4];
+} Result;
+
+typedef struct {
+  uint64_t test;
+  uint64_t shire_mask;
+  uint64_t partitioned;
+  uint64_t buffer;
+  uint64_t working_set;
+  uint64_t stride;
+  uint64_t iterations;
+  et_coll_mem_t* coll_mem;
+  Result* out_data;  // MINIONS_PER_SHIRE x ET_COLL_MAX_SHIRES entries
+} Parameters;
+
+int64_t entry_point(const Parameters*);
+
+static uint64_t gcd(uint64_t a, uint64_t b) {
+  while (b != 0) {
+    uint64_t t = a % b;
+    a = b;
+    b = t;
+  }
+  return a;
+}
+
+// loads every stride bytes of count elements from first, starting at element offset
+static uint64_t sweep(uint64_t buffer, uint64_t first, uint64_t count, uint64_t offset, uint64_t stride) {
+  uint64_t sum = 0;
+  uint64_t base = buffer + first * stride;
+  for (uint64_t addr = base + offset * stride; addr < base + count * stride; addr += stride) {
+    sum += *(volatile uint64_t*)addr;
+  }
+  for (uint64_t addr = base; addr < base + offset * stride; addr += stride) {
+    sum += *(volatile uint64_t*)addr;
+  }
+  return sum;
+}
+
+static uint64_t run_load_bw(const Parameters* params, et_coll_t* coll, uint64_t rank, uint64_t minions,
+                            uint64_t* cycles, uint64_t* checksum) {
+  uint64_t elements = params->working_set / params->stride;
+  uint64_t first = 0;
+  uint64_t count = elements;
+  if (params->partitioned) {
+    first = rank * (elements / minions);
+    count = elements / minions;
+  }
+  // spread the minions sweeping the whole working set, so they don't load the same lines at once
+  uint64_t offset = params->partitioned ? 0 : (rank * (elements / minions));
+  uint64_t sum = sweep(params->buffer, first, count, offset, params->stride);
+  et_coll_barrier(coll);
+
+  uint64_t start = et_get_timestamp();
+  for (uint64_t it = 0; it < params->iterations; it++) {
+    sum += sweep(params->buffer, first, count, offset, params->stride);
+  }
+  *cycles = et_get_delta_timestamp(start);
+  *checksum = sum;
+  return count * params->iterations;
+}
+
+static uint64_t run_load_lat(const Parameters* params, et_coll_t* coll, uint64_t rank, uint64_t minions,
+                             uint64_t* cycles, uint64_t* checksum) {
+  uint64_t elements = params->working_set / params->stride;
+  // element i points to element i + step, a full cycle because step and elements are coprime
+  uint64_t step = elements / 2 + 1;
+  while (gcd(step, elements) != 1) {
+    step++;
+  }
+  uint64_t first = rank * elements / minions;
+  uint64_t last = (rank + 1) * elements / minions;
+  for (uint64_t i = first; i < last; i++) {
+    *(volatile uint64_t*)(params->buffer + i * params->stride) =
+      params->buffer + ((i + step) % elements) * params->stride;
+  }
+  // write the chain back to memory so the minions of the other shires see it
+  uint64_t line_stride = (params->stride < LINE_SIZE) ? LINE_SIZE : params->stride;
+  uint64_t begin = (params->buffer + first * params->stride) & ~(uint64_t)(LINE_SIZE - 1);
+  uint64_t lines = (params->buffer + last * params->stride - begin + line_stride - 1) / line_stride;
+  for (uint64_t l = 0; l < lines; l += 16) {
+    uint64_t repeat = ((lines - l) > 16) ? 15 : (lines - l - 1);
+    evict_va(0, to_Mem, begin + l * line_stride, repeat, line_stride, 0);
+  }
+  WAIT_CACHEOPS;
+  __asm__ __volatile__("fence\n" ::: "memory");
+  et_coll_barrier(coll);
+
+  if (rank != 0) {
+    *cycles = 0;
+    *checksum = 0;
+    return 0;
+  }
+  uint64_t p = params->buffer;
+  for (uint64_t i = 0; i < elements; i++) {
+    p = *(volatile uint64_t*)p;
+  }
+  uint64_t start = et_get_timestamp();
+  for (uint64_t i = 0; i < elements * params->iterations; i++) {
+    p = *(volatile uint64_t*)p;
+  }
+  *cycles = et_get_delta_timestamp(start);
+  *checksum = p;
+  return elements * params->iterations;
+}
+
+static uint64_t run_atomic(const Parameters* params, et_coll_t* coll, uint64_t rank, uint64_t* cycles,
+                           uint64_t* checksum) {
+  volatile uint64_t* address =
+    (volatile uint64_t*)(params->buffer + (params->partitioned ? (rank * LINE_SIZE) : 0));
+  uint64_t sum = 0;
+  et_coll_barrier(coll);
+
+  uint64_t start = et_get_timestamp();
+  for (uint64_t i = 0; i < params->iterations; i++) {
+    sum += atomic_add_global_64(address, 1);
+  }
+  *cycles = et_get_delta_timestamp(start);
+  *checksum = sum;
+  return params->iterations;
+}
+
+static uint64_t run_fma(const Parameters* params, et_coll_t* coll, uint64_t* cycles) {
+  volatile uint32_t ones[8] = {0x3f800000, 0x3f800000, 0x3f800000, 0x3f800000,
+                               0x3f800000, 0x3f800000, 0x3f800000, 0x3f800000};
+  uint64_t all_lanes = 0xffffffffff;
+  __asm__ __volatile__("mova.m.x %[m]\n"
+                       "flq2 f1, 0(%[p])\n"
+                       "flq2 f2, 0(%[p])\n"
+                       "flq2 f3, 0(%[p])\n"
+                       :
+                       : [m] "r"(all_lanes), [p] "r"(ones)
+                       : "memory");
+  et_coll_barrier(coll);
+
+  uint64_t start = et_get_timestamp();
+  for (uint64_t i = 0; i < params->iterations; i++) {
+    __asm__ __volatile__("fmadd.ps  f4, f1, f2, f3\n"
+                         "fmadd.ps  f5, f1, f2, f3\n"
+                         "fmadd.ps  f6, f1, f2, f3\n"
+                         "fmadd.ps  f7, f1, f2, f3\n"
+                         "fmadd.ps  f8, f1, f2, f3\n"
+                         "fmadd.ps  f9, f1, f2, f3\n"
+                         "fmadd.ps f10, f1, f2, f3\n"
+                         "fmadd.ps f11, f1, f2, f3\n"
+                         "fmadd.ps f12, f1, f2, f3\n"
+                         "fmadd.ps f13, f1, f2, f3\n"
+                         "fmadd.ps f14, f1, f2, f3\n"
+                         "fmadd.ps f15, f1, f2, f3\n"
+                         "fmadd.ps f16, f1, f2, f3\n"
+                         "fmadd.ps f17, f1, f2, f3\n"
+                         "fmadd.ps f18, f1, f2, f3\n"
+                         "fmadd.ps f19, f1, f2, f3\n"
+                         "fmadd.ps f20, f1, f2, f3\n"
+                         "fmadd.ps f21, f1, f2, f3\n"
+                         "fmadd.ps f22, f1, f2, f3\n"
+                         "fmadd.ps f23, f1, f2, f3\n"
+                         "fmadd.ps f24, f1, f2, f3\n"
+                         "fmadd.ps f25, f1, f2, f3\n"
+                         "fmadd.ps f26, f1, f2, f3\n"
+                         "fmadd.ps f27, f1, f2, f3\n");
+  }
+  *cycles = et_get_delta_timestamp(start);
+  return params->iterations * ROOFLINE_FMA_BLOCK;
+}
+
+int64_t entry_point(const Parameters* const params) {
+  if (params == NULL || params->out_data == NULL || params->coll_mem == NULL || params->shire_mask == 0 ||
+      params->iterations == 0) {
+    // Bad arguments
+    return -1;
+  }
+
+  uint64_t hart_id = get_hart_id();
+  uint64_t shire = hart_id >> 6;
+  if ((hart_id & 1) || (shire >= ET_COLL_MAX_SHIRES) || !((params->shire_mask >> shire) & 1)) {
+    return 0;
+  }
+
+  uint64_t minions = (uint64_t)__builtin_popcountll(params->shire_mask) * MINIONS_PER_SHIRE;
+  uint64_t rank = (uint64_t)__builtin_popcountll(params->shire_mask & ((1ULL << shire) - 1)) * MINIONS_PER_SHIRE +
+                  ((hart_id >> 1) % MINIONS_PER_SHIRE);
+  if (params->test == ROOFLINE_LOAD_BW || params->test == ROOFLINE_LOAD_LAT) {
+    uint64_t stride = params->stride;
+    if (params->buffer == 0 || stride < 8 || (stride & (stride - 1)) != 0 || (params->working_set % stride) != 0 ||
+        (params->working_set / stride) < minions) {
+      return -1;
+    }
+  } else if (params->test == ROOFLINE_ATOMIC) {
+    if (params->buffer == 0) {
+      return -1;
+    }
+  } else if (params->test != ROOFLINE_FMA) {
+    return -1;
+  }
+
+  et_coll_t coll;
+  if (et_coll_init(&coll, params->coll_mem, params->shire_mask, ALL_MINIONS, 0, 0, FCC_0) !=
+      ET_COLL_OPERATION_SUCCESS) {
+    return -1;
+  }
+
+  uint64_t cycles = 0;
+  uint64_t checksum = 0;
+  uint64_t ops = 0;
+  switch (params->test) {
+  case ROOFLINE_LOAD_BW:
+    ops = run_load_bw(params, &coll, rank, minions, &cycles, &checksum);
+    break;
+  case ROOFLINE_LOAD_LAT:
+    ops = run_load_lat(params, &coll, rank, minions, &cycles, &checksum);
+    break;
+  case ROOFLINE_ATOMIC:
+    ops = run_atomic(params, &coll, rank, &cycles, &checksum);
+    break;
+  default:
+    ops = run_fma(params, &coll, &cycles);
+    break;
+  }
+
+  Result* result = &params->out_data[hart_id >> 1];
+  result->hart_id = hart_id;
+  result->cycles = cycles;
+  result->ops = ops;
+  result->checksum = checksum;
+  return 0;
+}
@@ -0,0 +1,126 @@
+/*-------------------------------------------------------------------------
+ * Copyright (c) 2025 Ainekko, Co.
+ * SPDX-License-Identifier: Apache-2.0
+ *-------------------------------------------------------------------------
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "etsoc/isa/hart.h"
+#include "etsoc/common/collectives.h"
+#include "etsoc/common/task.h"
+#include "etsoc/common/utils.h"
+
+// Load balance of a sparse matrix vector product, y = A * x with A in CSR.
+// Launched on the first num_shires shires with all the harts. It times iterations products
+// once with the rows split statically by hart id and once with et_task_parallel_for of task.h,
+// in grains of grain rows. With skewed row lengths (generated by the host) the static split
+// leaves most harts waiting for the ones holding the long rows. Every hart writes one Result,
+// the host compares the max of static_cycles and task_cycles over all the harts.
+// The task_mem and coll_mem buffers must be zeroed before the launch.
+
+#define ALL_MINIONS 0xFFFFFFFFU
+#define FLB_COLL    0U
+
+// one cache line per hart in out_data
+typedef struct {
+  uint64_t hart_id;
+  uint64_t static_cycles;  // from the common start to the end of the static products
+  uint64_t task_cycles;    // from the common start to the end of the balanced products
+  uint64_t rows;           // rows computed by the hart in the balanced products
+  uint64_t local_steals;
+  uint64_t remote_steals;
+  uint64_t reserved[2];
+} Result;
+
+typedef struct {
+  const uint32_t* row_ptr;  // rows + 1 entries
+  const uint32_t* col_idx;
+  const float* values;
+  const float* x;
+  float* y;
+  uint64_t rows;
+  uint64_t grain;
+  uint64_t num_shires;
+  uint64_t iterations;
+  et_task_mem_t* task_mem;
+  et_coll_mem_t* coll_mem;
+  Result* out_data;  // num_shires * 64 entries
+} Parameters;
+
+typedef struct {
+  const Parameters* params;
+  uint64_t rows;
+} Body_args;
+
+int64_t entry_point(const Parameters*);
+
+static inline void spmv_rows(const Parameters* params, uint64_t begin, uint64_t end) {
+  for (uint64_t row = begin; row < end; row++) {
+    float sum = 0.0f;
+    for (uint32_t i = params->row_ptr[row]; i < params->row_ptr[row + 1]; i++) {
+      sum += params->values[i] * params->x[params->col_idx[i]];
+    }
+    params->y[row] = sum;
+  }
+}
+
+static void spmv_body(uint64_t begin, uint64_t end, void* arg) {
+  Body_args* args = (Body_args*)arg;
+  spmv_rows(args->params, begin, end);
+  args->rows += end - begin;
+}
+
+int64_t entry_point(const Parameters* const params) {
+  if (params == NULL || params->row_ptr == NULL || params->col_idx == NULL || params->values == NULL ||
+      params->x == NULL || params->y == NULL || params->task_mem == NULL || params->coll_mem == NULL ||
+      params->out_data == NULL || params->grain == 0 || params->num_shires == 0 ||
+      params->num_shires > ET_TASK_MAX_SHIRES || params->iterations == 0) {
+    // Bad arguments
+    return -1;
+  }
+
+  const uint64_t hart_id = get_hart_id();
+  const uint64_t shire_mask = (1ULL << params->num_shires) - 1;
+  const uint64_t harts = params->num_shires * 64;
+  et_coll_t coll;
+  et_task_t task;
+
+  if (et_coll_init(&coll, params->coll_mem, shire_mask, ALL_MINIONS, ALL_MINIONS, FLB_COLL, FCC_0) !=
+          ET_COLL_OPERATION_SUCCESS ||
+      et_task_init(&task, params->task_mem, shire_mask, ALL_MINIONS, ALL_MINIONS, FCC_1) !=
+          ET_TASK_OPERATION_SUCCESS) {
+    return -1;
+  }
+
+  // Static split by hart id
+  const uint64_t begin = (params->rows * hart_id) / harts;
+  const uint64_t end = (params->rows * (hart_id + 1)) / harts;
+  et_coll_barrier(&coll);
+  uint64_t start = et_get_timestamp();
+  for (uint64_t i = 0; i < params->iterations; i++) {
+    spmv_rows(params, begin, end);
+  }
+  uint64_t static_cycles = et_get_delta_timestamp(start);
+
+  // Balanced with work stealing
+  Body_args args = {.params = params, .rows = 0};
+  int64_t status = ET_TASK_OPERATION_SUCCESS;
+  et_coll_barrier(&coll);
+  start = et_get_timestamp();
+  for (uint64_t i = 0; (i < params->iterations) && (status == ET_TASK_OPERATION_SUCCESS); i++) {
+    status = et_task_parallel_for(&task, params->rows, params->grain, spmv_body, &args);
+  }
+  uint64_t task_cycles = et_get_delta_timestamp(start);
+
+  Result* result = &params->out_data[hart_id];
+  result->hart_id = hart_id;
+  result->static_cycles = static_cycles;
+  result->task_cycles = task_cycles;
+  result->rows = args.rows;
+  result->local_steals = task.local_steals;
+  result->remote_steals = task.remote_steals;
+
+  return (status == ET_TASK_OPERATION_SUCCESS) ? 0 : -1;
+}
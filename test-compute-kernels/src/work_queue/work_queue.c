@@ -0,0 +1,42 @@
+#include <etsoc/isa/cacheops-umode.h>
+#include <etsoc/isa/hart.h>
+#include <transports/work_queue/work_queue.h>
+
+typedef struct {
+  work_queue_cb_t* wq;
+} WorkQueueParams;
+
+// each work item adds two vectors, items are independent so any hart can run them
+typedef struct {
+  const int* a;
+  const int* b;
+  int* result;
+  uint64_t numElements;
+} WorkItem;
+
+int entry_point(const WorkQueueParams*);
+
+// evict in chunks of 8 lines, a single evict op takes a 4 bit line count
+static void evict_to_l3(const void* address, uint64_t size) {
+  const uint8_t* ptr = (const uint8_t*)address;
+  for (uint64_t done = 0; done < size; done += 512) {
+    uint64_t chunk = (size - done) < 512 ? (size - done) : 512;
+    cache_ops_evict(to_L3, ptr + done, chunk);
+  }
+}
+
+// persistent kernel: stays resident running the items pushed to the work queue till it's stopped
+int entry_point(const WorkQueueParams* const params) {
+  WorkItem item;
+  uint64_t position;
+
+  while (work_queue_pop(params->wq, &item, &position) == WORK_QUEUE_OPERATION_SUCCESS) {
+    for (uint64_t i = 0; i < item.numElements; ++i) {
+      item.result[i] = item.a[i] + item.b[i];
+    }
+    // results must leave the shire caches before the producer sees the item completed
+    evict_to_l3(item.result, item.numElements * sizeof(int));
+    work_queue_complete(params->wq, position, 0);
+  }
+  return 0;
+}